@@ -27,6 +27,8 @@
  */
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
 
 #include "helpers/helpers.h"
 
@@ -35,8 +37,26 @@ namespace py = pybind11;
 namespace forte {
 /// Export the ambit class
 void export_ambit(py::module& m) {
-    // export ambit::Tensor
-    py::class_<ambit::Tensor>(m, "ambitTensor");
+    // export ambit::Tensor. The buffer protocol gives numpy direct access to the data of core
+    // tensors, so np.asarray(t) does not copy
+    py::class_<ambit::Tensor>(m, "ambitTensor", py::buffer_protocol())
+        .def_buffer([](ambit::Tensor& t) -> py::buffer_info {
+            const auto& dims = t.dims();
+            std::vector<py::ssize_t> shape(dims.begin(), dims.end());
+            std::vector<py::ssize_t> strides(dims.size());
+            py::ssize_t stride = sizeof(double);
+            for (size_t i = dims.size(); i-- > 0;) {
+                strides[i] = stride;
+                stride *= static_cast<py::ssize_t>(dims[i]);
+            }
+            return py::buffer_info(t.data().data(), sizeof(double),
+                                   py::format_descriptor<double>::format(),
+                                   static_cast<py::ssize_t>(dims.size()), shape, strides);
+        })
+        .def("dims", &ambit::Tensor::dims, "Return the dimensions of the tensor")
+        .def(
+            "array", [](ambit::Tensor& t) { return ambit_to_np_view(t); },
+            "Return a numpy array that shares the memory of the tensor");
 
     m.def(
         "test_ambit_3d",
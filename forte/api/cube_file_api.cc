@@ -31,8 +31,10 @@
 
 #include "helpers/helpers.h"
 #include "helpers/cube_file.h"
+#include "helpers/cube_grid.h"
 
 namespace py = pybind11;
+using namespace pybind11::literals;
 
 namespace forte {
 
@@ -62,6 +64,12 @@ void export_ForteCubeFile(py::module& m) {
              "Add to each grid point the value of another cube file times a scaling factor")
         .def("pointwise_product", &CubeFile::pointwise_product,
              " Multiply each grid point by the value of another cube file");
+
+    m.def("make_cube_files", &make_cube_files, "wfn"_a, "C"_a, "densities"_a, "spacing"_a = 0.2,
+          "overage"_a = 4.0, "block_size"_a = 1000,
+          "Evaluate orbitals (AO basis columns of C) and AO densities on a cubic grid");
+    m.def("save_cube_files", &save_cube_files, "cubes"_a, "filenames"_a,
+          "Save a list of cube files");
 }
 
 } // namespace forte
@@ -0,0 +1,71 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "helpers/helpers.h"
+#include "helpers/fcidump.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace forte {
+
+/// Export the FCIDUMP class
+void export_FCIDUMP(py::module& m) {
+    py::class_<FCIDUMP, std::shared_ptr<FCIDUMP>>(m, "FCIDUMP")
+        .def(py::init<const std::string&>(), "filename"_a,
+             "Read a FCIDUMP file (text or binary format)")
+        .def("load", &FCIDUMP::load, "Load a FCIDUMP file (text or binary format)")
+        .def("save_binary", &FCIDUMP::save_binary, "Save the integrals in the binary format")
+        .def("norb", &FCIDUMP::norb, "The number of orbitals")
+        .def("nelec", &FCIDUMP::nelec, "The number of electrons")
+        .def("ms2", &FCIDUMP::ms2, "Twice the spin projection")
+        .def("isym", &FCIDUMP::isym, "The symmetry of the state")
+        .def("uhf", &FCIDUMP::uhf, "Are the orbitals unrestricted?")
+        .def("pntgrp", &FCIDUMP::pntgrp, "The point group (empty if not in the file)")
+        .def("orbsym", &FCIDUMP::orbsym, "The symmetry label of each orbital")
+        .def("enuc", &FCIDUMP::enuc, "The nuclear repulsion plus frozen core energy")
+        .def(
+            "epsilon", [](FCIDUMP& f) { return vector_to_np(f.epsilon(), std::vector<size_t>{f.epsilon().size()}); },
+            "The orbital energies stored as a numpy array (empty if not in the file)")
+        .def(
+            "hcore", [](FCIDUMP& f) { return vector_to_np(f.hcore(), std::vector<size_t>{f.norb(), f.norb()}); },
+            "The core Hamiltonian stored as a numpy array")
+        .def("eri", &FCIDUMP::eri, "The two-electron integral (ij|kl) in chemists' notation")
+        .def(
+            "__getitem__",
+            [](FCIDUMP& f, std::tuple<size_t, size_t, size_t, size_t> ijkl) {
+                auto [i, j, k, l] = ijkl;
+                return f.eri(i, j, k, l);
+            },
+            "The two-electron integral eri[i, j, k, l] = (ij|kl) in chemists' notation");
+}
+
+} // namespace forte
@@ -33,8 +33,13 @@
 #include "psi4/libpsi4util/process.h"
 #include "psi4/libmints/wavefunction.h"
 
+#include "helpers/fcidump.h"
+#include "helpers/helpers.h"
 #include "helpers/printing.h"
 #include "helpers/lbfgs/rosenbrock.h"
+#include "helpers/memory_manager.h"
+#include "helpers/numa_memory.h"
+#include "helpers/profiler.h"
 #include "helpers/symmetry.h"
 
 #include "base_classes/active_space_solver.h"
@@ -80,6 +85,7 @@ void export_StateInfo(py::module& m);
 void export_SigmaVector(py::module& m);
 void export_SparseCISolver(py::module& m);
 void export_ForteCubeFile(py::module& m);
+void export_FCIDUMP(py::module& m);
 void export_OrbitalTransform(py::module& m);
 void export_Localize(py::module& m);
 
@@ -89,20 +95,22 @@ double get_master_screen_threshold();
 /// Export the ActiveSpaceMethod class
 void export_ActiveSpaceMethod(py::module& m) {
     py::class_<ActiveSpaceMethod>(m, "ActiveSpaceMethod")
-        .def("compute_energy", &ActiveSpaceMethod::compute_energy)
+        .def("compute_energy", &ActiveSpaceMethod::compute_energy,
+             py::call_guard<py::gil_scoped_release>())
         .def("dump_wave_function", &ActiveSpaceMethod::dump_wave_function)
         .def("read_wave_function", &ActiveSpaceMethod::read_wave_function);
 }
 
 void export_ActiveSpaceSolver(py::module& m) {
     py::class_<ActiveSpaceSolver>(m, "ActiveSpaceSolver")
-        .def("compute_energy", &ActiveSpaceSolver::compute_energy)
+        .def("compute_energy", &ActiveSpaceSolver::compute_energy,
+             py::call_guard<py::gil_scoped_release>())
         .def("rdms", &ActiveSpaceSolver::rdms)
         .def("compute_contracted_energy", &ActiveSpaceSolver::compute_contracted_energy,
              "as_ints"_a, "max_body"_a,
              "Solve the contracted CI eigenvalue problem using given integrals")
         .def("compute_average_rdms", &ActiveSpaceSolver::compute_average_rdms,
-             "Compute the weighted average reference")
+             "Compute the weighted average reference", py::call_guard<py::gil_scoped_release>())
         .def("set_active_space_integrals", &ActiveSpaceSolver::set_active_space_integrals,
              "Set the active space integrals manually")
         .def("compute_fosc_same_orbs", &ActiveSpaceSolver::compute_fosc_same_orbs)
@@ -115,13 +123,16 @@ void export_ActiveSpaceSolver(py::module& m) {
 
 void export_CASSCF(py::module& m) {
     py::class_<CASSCF>(m, "CASSCF")
-        .def("compute_energy", &CASSCF::compute_energy, "Compute the CASSCF energy")
-        .def("compute_gradient", &CASSCF::compute_gradient, "Compute the CASSCF gradient");
+        .def("compute_energy", &CASSCF::compute_energy, "Compute the CASSCF energy",
+             py::call_guard<py::gil_scoped_release>())
+        .def("compute_gradient", &CASSCF::compute_gradient, "Compute the CASSCF gradient",
+             py::call_guard<py::gil_scoped_release>());
 }
 
 void export_MCSCF_2STEP(py::module& m) {
     py::class_<MCSCF_2STEP>(m, "MCSCF_2STEP")
-        .def("compute_energy", &MCSCF_2STEP::compute_energy, "Compute the MCSCF energy");
+        .def("compute_energy", &MCSCF_2STEP::compute_energy, "Compute the MCSCF energy",
+             py::call_guard<py::gil_scoped_release>());
 }
 
 void export_Symmetry(py::module& m) {
@@ -164,6 +175,9 @@ PYBIND11_MODULE(forte, m) {
     m.def("make_embedding", &make_embedding, "Apply fragment projector to embed");
     m.def("make_custom_ints", &make_custom_forte_integrals,
           "Make a custom Forte integral object from arrays");
+    m.def("make_custom_ints_from_fcidump", &make_custom_forte_integrals_from_fcidump, "options"_a,
+          "mo_space_info"_a, "fcidump"_a,
+          "Make a custom Forte integral object from the integrals of a FCIDUMP object");
     m.def("make_ints_from_psi4", &make_forte_integrals_from_psi4, "ref_wfn"_a, "options"_a,
           "mo_space_info"_a, "int_type"_a = "", "Make a Forte integral object from psi4");
     m.def("make_active_space_method", &make_active_space_method, "Make an active space method");
@@ -179,9 +193,31 @@ PYBIND11_MODULE(forte, m) {
           "Make a list of target states with their weigth");
     m.def("make_active_space_ints", &make_active_space_ints,
           "Make an object that holds the molecular orbital integrals for the active orbitals");
+    m.def("detach_active_space_ints", &detach_active_space_ints,
+          "Return a copy of an ActiveSpaceIntegrals object if it is shared with other methods");
     m.def("make_dynamic_correlation_solver", &make_dynamic_correlation_solver,
           "Make a dynamical correlation solver");
     m.def("perform_spin_analysis", &perform_spin_analysis, "Do spin analysis");
+    m.def(
+        "compute_spin_correlation",
+        [](RDMs& rdms) {
+            auto sc = compute_spin_correlation(rdms);
+            return py::make_tuple(ambit_to_np(sc.spin_corr), ambit_to_np(sc.spin_fluct),
+                                  ambit_to_np(sc.spin_z));
+        },
+        "rdms"_a,
+        "Return the spin correlation <S_i.S_j>, the spin fluctuation, and the spin-z correlation "
+        "of all pairs of active orbitals computed from the 1- and 2-RDMs (NumPy arrays)");
+    m.def(
+        "compute_spin_correlation_from_state",
+        [](const StateVector& state, size_t nact) {
+            auto sc = compute_spin_correlation(state, nact);
+            return py::make_tuple(ambit_to_np(sc.spin_corr), ambit_to_np(sc.spin_fluct),
+                                  ambit_to_np(sc.spin_z));
+        },
+        "state"_a, "nact"_a,
+        "Return the spin correlation <S_i.S_j>, the spin fluctuation, and the spin-z correlation "
+        "of all pairs of active orbitals computed directly from a normalized CI vector");
     m.def("make_dsrg_method", &make_dsrg_method,
           "Make a DSRG method (spin-integrated implementation)");
     m.def("make_sadsrg_method", &make_sadsrg_method,
@@ -192,6 +228,39 @@ PYBIND11_MODULE(forte, m) {
           "Make a DSRG pointer (spin-adapted implementation)");
     m.def("make_casscf", &make_casscf, "Make a CASSCF object");
     m.def("make_mcscf_two_step", &make_mcscf_two_step, "Make a 2-step MCSCF object");
+    m.def(
+        "memory_begin_phase",
+        [](const std::string& name) { MemoryManager::instance().begin_phase(name); },
+        "name"_a, "Start a phase whose peak memory usage is recorded by the memory manager");
+    m.def(
+        "memory_end_phase", []() { MemoryManager::instance().end_phase(); },
+        "End the current memory manager phase");
+    m.def(
+        "print_memory_summary", []() { MemoryManager::instance().print_summary(); },
+        "Print the memory used by each Forte subsystem and the peak usage of each phase");
+    m.def("set_numa_memory_options", &set_numa_memory_options, "first_touch"_a, "huge_pages"_a,
+          "huge_pages_min_bytes"_a,
+          "Set the NUMA placement and huge page options of the large Forte arrays");
+    m.def(
+        "profiler_enable", [](bool value) { Profiler::instance().enable(value); }, "value"_a,
+        "Enable or disable the Forte profiler");
+    m.def(
+        "profiler_enable_counters",
+        [](bool value) { return Profiler::instance().enable_counters(value); }, "value"_a,
+        "Enable or disable the hardware counters of the Forte profiler");
+    m.def(
+        "profiler_begin", [](const std::string& name) { return Profiler::instance().begin(name); },
+        "name"_a, "Open a profiler region and return its index");
+    m.def(
+        "profiler_end", [](size_t index) { Profiler::instance().end(index); }, "index"_a,
+        "Close a profiler region");
+    m.def(
+        "profiler_print_summary", []() { Profiler::instance().print_summary(); },
+        "Print the total time and number of calls of each profiled region");
+    m.def(
+        "profiler_write_chrome_trace",
+        [](const std::string& filename) { Profiler::instance().write_chrome_trace(filename); },
+        "filename"_a, "Write the profiled regions in the Chrome trace event format");
     m.def("test_lbfgs_rosenbrock", &test_lbfgs_rosenbrock, "Test L-BFGS on Rosenbrock function");
 
     export_ambit(m);
@@ -219,6 +288,7 @@ PYBIND11_MODULE(forte, m) {
     export_SparseCISolver(m);
 
     export_ForteCubeFile(m);
+    export_FCIDUMP(m);
 
     export_MOSpaceInfo(m);
 
@@ -237,7 +307,8 @@ PYBIND11_MODULE(forte, m) {
     // export DynamicCorrelationSolver
     py::class_<DynamicCorrelationSolver, std::shared_ptr<DynamicCorrelationSolver>>(
         m, "DynamicCorrelationSolver")
-        .def("compute_energy", &DynamicCorrelationSolver::compute_energy);
+        .def("compute_energy", &DynamicCorrelationSolver::compute_energy,
+             py::call_guard<py::gil_scoped_release>());
 
     // export ActiveSpaceIntegrals
     py::class_<ActiveSpaceIntegrals, std::shared_ptr<ActiveSpaceIntegrals>>(m,
@@ -256,6 +327,58 @@ PYBIND11_MODULE(forte, m) {
         .def("tei_aa", &ActiveSpaceIntegrals::tei_aa, "alpha-alpha two-electron integral <pq||rs>")
         .def("tei_ab", &ActiveSpaceIntegrals::tei_ab, "alpha-beta two-electron integral <pq|rs>")
         .def("tei_bb", &ActiveSpaceIntegrals::tei_bb, "beta-beta two-electron integral <pq||rs>")
+        .def(
+            "oei_a_array",
+            [](py::object self) {
+                const auto& ints = self.cast<const ActiveSpaceIntegrals&>();
+                size_t n = ints.nmo();
+                return vector_to_np_view(ints.oei_a_vector(), {n, n}, self);
+            },
+            "Return a read-only numpy view (no copy) of the alpha one-electron integrals")
+        .def(
+            "oei_b_array",
+            [](py::object self) {
+                const auto& ints = self.cast<const ActiveSpaceIntegrals&>();
+                size_t n = ints.nmo();
+                return vector_to_np_view(ints.oei_b_vector(), {n, n}, self);
+            },
+            "Return a read-only numpy view (no copy) of the beta one-electron integrals")
+        .def(
+            "tei_aa_array",
+            [](py::object self) {
+                const auto& ints = self.cast<const ActiveSpaceIntegrals&>();
+                size_t n = ints.nmo();
+                return vector_to_np_view(ints.tei_aa_vector(), {n, n, n, n}, self);
+            },
+            "Return a read-only numpy view (no copy) of the integrals <pq||rs> (alpha-alpha)")
+        .def(
+            "tei_ab_array",
+            [](py::object self) {
+                const auto& ints = self.cast<const ActiveSpaceIntegrals&>();
+                size_t n = ints.nmo();
+                return vector_to_np_view(ints.tei_ab_vector(), {n, n, n, n}, self);
+            },
+            "Return a read-only numpy view (no copy) of the integrals <pq|rs> (alpha-beta)")
+        .def(
+            "tei_bb_array",
+            [](py::object self) {
+                const auto& ints = self.cast<const ActiveSpaceIntegrals&>();
+                size_t n = ints.nmo();
+                return vector_to_np_view(ints.tei_bb_vector(), {n, n, n, n}, self);
+            },
+            "Return a read-only numpy view (no copy) of the integrals <pq||rs> (beta-beta)")
+        .def("tei_chem", &ActiveSpaceIntegrals::tei_chem,
+             "spatial two-electron integral (pq|rs) in chemist notation")
+        .def("pack_integrals", &ActiveSpaceIntegrals::pack_integrals,
+             "Store the two-electron integrals in symmetry-packed form")
+        .def("packed", &ActiveSpaceIntegrals::packed,
+             "Are the two-electron integrals stored in packed form?")
+        .def("factorize_integrals", &ActiveSpaceIntegrals::factorize_integrals, "tolerance"_a,
+             "Store the two-electron integrals as low-rank (Cholesky) vectors")
+        .def("low_rank", &ActiveSpaceIntegrals::low_rank,
+             "Are the two-electron integrals stored in low-rank form?")
+        .def("low_rank_nvec", &ActiveSpaceIntegrals::low_rank_nvec,
+             "The number of low-rank vectors of the two-electron integrals")
         .def("print", &ActiveSpaceIntegrals::print, "Print the integrals (alpha-alpha case)");
 
     // export SemiCanonical
@@ -273,9 +396,11 @@ PYBIND11_MODULE(forte, m) {
 
     // export MASTER_DSRG
     py::class_<MASTER_DSRG>(m, "MASTER_DSRG")
-        .def("compute_energy", &MASTER_DSRG::compute_energy, "Compute the DSRG energy")
+        .def("compute_energy", &MASTER_DSRG::compute_energy, "Compute the DSRG energy",
+             py::call_guard<py::gil_scoped_release>())
         .def("compute_Heff_actv", &MASTER_DSRG::compute_Heff_actv,
-             "Return the DSRG dressed ActiveSpaceIntegrals")
+             "Return the DSRG dressed ActiveSpaceIntegrals",
+             py::call_guard<py::gil_scoped_release>())
         .def("deGNO_DMbar_actv", &MASTER_DSRG::deGNO_DMbar_actv,
              "Return the DSRG dressed dipole integrals")
         .def("nuclear_dipole", &MASTER_DSRG::nuclear_dipole,
@@ -289,9 +414,27 @@ PYBIND11_MODULE(forte, m) {
 
     // export SADSRG
     py::class_<SADSRG>(m, "SADSRG")
-        .def("compute_energy", &SADSRG::compute_energy, "Compute the DSRG energy")
+        .def("compute_energy", &SADSRG::compute_energy, "Compute the DSRG energy",
+             py::call_guard<py::gil_scoped_release>())
+        .def(
+            "compute_energy_pipelined",
+            [](SADSRG& self, ActiveSpaceSolver& as_solver,
+               const std::map<StateInfo, std::vector<double>>& state_weights_map,
+               SemiCanonical& semi, int max_rdm_level) {
+                auto Ua = semi.Ua_t();
+                auto Ub = semi.Ub_t();
+                return self.compute_energy_pipelined([&]() {
+                    auto rdms = as_solver.compute_average_rdms(state_weights_map, max_rdm_level);
+                    return semi.transform_rdms(Ua, Ub, rdms, max_rdm_level);
+                });
+            },
+            "as_solver"_a, "state_weights_map"_a, "semi"_a, "max_rdm_level"_a,
+            "Compute the DSRG energy while the RDMs of the active space solver are built and "
+            "transformed to the semicanonical basis of semi",
+            py::call_guard<py::gil_scoped_release>())
         .def("compute_Heff_actv", &SADSRG::compute_Heff_actv,
-             "Return the DSRG dressed ActiveSpaceIntegrals")
+             "Return the DSRG dressed ActiveSpaceIntegrals",
+             py::call_guard<py::gil_scoped_release>())
         .def("set_Uactv", &SADSRG::set_Uactv, "Ua"_a,
              "Set active part orbital rotation matrix (from original to semicanonical)")
         .def("set_read_cwd_amps", &SADSRG::set_read_amps_cwd,
@@ -300,26 +443,33 @@ PYBIND11_MODULE(forte, m) {
 
     // export MRDSRG_SO
     py::class_<MRDSRG_SO>(m, "MRDSRG_SO")
-        .def("compute_energy", &MRDSRG_SO::compute_energy, "Compute DSRG energy")
+        .def("compute_energy", &MRDSRG_SO::compute_energy, "Compute DSRG energy",
+             py::call_guard<py::gil_scoped_release>())
         .def("compute_Heff_actv", &MRDSRG_SO::compute_Heff_actv,
-             "Return the DSRG dressed ActiveSpaceIntegrals");
+             "Return the DSRG dressed ActiveSpaceIntegrals",
+             py::call_guard<py::gil_scoped_release>());
 
     // export SOMRDSRG
     py::class_<SOMRDSRG>(m, "SOMRDSRG")
-        .def("compute_energy", &SOMRDSRG::compute_energy, "Compute DSRG energy")
+        .def("compute_energy", &SOMRDSRG::compute_energy, "Compute DSRG energy",
+             py::call_guard<py::gil_scoped_release>())
         .def("compute_Heff_actv", &SOMRDSRG::compute_Heff_actv,
-             "Return the DSRG dressed ActiveSpaceIntegrals");
+             "Return the DSRG dressed ActiveSpaceIntegrals",
+             py::call_guard<py::gil_scoped_release>());
 
     // export DSRG_MRPT spin-adapted code
     py::class_<DSRG_MRPT>(m, "DSRG_MRPT")
-        .def("compute_energy", &DSRG_MRPT::compute_energy, "Compute DSRG energy")
+        .def("compute_energy", &DSRG_MRPT::compute_energy, "Compute DSRG energy",
+             py::call_guard<py::gil_scoped_release>())
         .def("compute_Heff_actv", &DSRG_MRPT::compute_Heff_actv,
-             "Return the DSRG dressed ActiveSpaceIntegrals");
+             "Return the DSRG dressed ActiveSpaceIntegrals",
+             py::call_guard<py::gil_scoped_release>());
 
     py::class_<MCSRGPT2_MO>(m, "MCSRGPT2_MO")
         .def(py::init<RDMs, std::shared_ptr<ForteOptions>, std::shared_ptr<ForteIntegrals>,
                       std::shared_ptr<MOSpaceInfo>>())
-        .def("compute_energy", &MCSRGPT2_MO::compute_energy, "Compute DSRG energy");
+        .def("compute_energy", &MCSRGPT2_MO::compute_energy, "Compute DSRG energy",
+             py::call_guard<py::gil_scoped_release>());
 
     // export DressedQuantity for dipole moments
     py::class_<DressedQuantity>(m, "DressedQuantity")
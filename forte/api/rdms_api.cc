@@ -42,55 +42,55 @@ void export_RDMs(py::module& m) {
     py::class_<RDMs>(m, "RDMs")
         .def("max_rdm_level", &RDMs::max_rdm_level, "Return the max RDM level")
         .def(
-            "g1a", [](RDMs& rdm) { return ambit_to_np(rdm.g1a()); },
-            "Return the alpha 1RDM as a numpy array")
+            "g1a", [](RDMs& rdm) { return ambit_to_np_view(rdm.g1a()); },
+            "Return the alpha 1RDM as a numpy array (no copy)")
         .def(
-            "g1b", [](RDMs& rdm) { return ambit_to_np(rdm.g1b()); },
-            "Return the beta 1RDM as a numpy array")
+            "g1b", [](RDMs& rdm) { return ambit_to_np_view(rdm.g1b()); },
+            "Return the beta 1RDM as a numpy array (no copy)")
         .def(
-            "g2aa", [](RDMs& rdm) { return ambit_to_np(rdm.g2aa()); },
-            "Return the alpha-alpha 2RDM as a numpy array")
+            "g2aa", [](RDMs& rdm) { return ambit_to_np_view(rdm.g2aa()); },
+            "Return the alpha-alpha 2RDM as a numpy array (no copy)")
         .def(
-            "g2ab", [](RDMs& rdm) { return ambit_to_np(rdm.g2ab()); },
-            "Return the alpha-beta 2RDM as a numpy array")
+            "g2ab", [](RDMs& rdm) { return ambit_to_np_view(rdm.g2ab()); },
+            "Return the alpha-beta 2RDM as a numpy array (no copy)")
         .def(
-            "g2bb", [](RDMs& rdm) { return ambit_to_np(rdm.g2bb()); },
-            "Return the beta-beta 2RDM as a numpy array")
+            "g2bb", [](RDMs& rdm) { return ambit_to_np_view(rdm.g2bb()); },
+            "Return the beta-beta 2RDM as a numpy array (no copy)")
         .def(
-            "g3aaa", [](RDMs& rdm) { return ambit_to_np(rdm.g3aaa()); },
-            "Return the alpha-alpha-alpha 3RDM as a numpy array")
+            "g3aaa", [](RDMs& rdm) { return ambit_to_np_view(rdm.g3aaa()); },
+            "Return the alpha-alpha-alpha 3RDM as a numpy array (no copy)")
         .def(
-            "g3aab", [](RDMs& rdm) { return ambit_to_np(rdm.g3aab()); },
-            "Return the alpha-alpha-beta 3RDM as a numpy array")
+            "g3aab", [](RDMs& rdm) { return ambit_to_np_view(rdm.g3aab()); },
+            "Return the alpha-alpha-beta 3RDM as a numpy array (no copy)")
         .def(
-            "g3abb", [](RDMs& rdm) { return ambit_to_np(rdm.g3abb()); },
-            "Return the alpha-beta-beta 3RDM as a numpy array")
+            "g3abb", [](RDMs& rdm) { return ambit_to_np_view(rdm.g3abb()); },
+            "Return the alpha-beta-beta 3RDM as a numpy array (no copy)")
         .def(
-            "g3bbb", [](RDMs& rdm) { return ambit_to_np(rdm.g3bbb()); },
-            "Return the beta-beta-beta 3RDM as a numpy array")
+            "g3bbb", [](RDMs& rdm) { return ambit_to_np_view(rdm.g3bbb()); },
+            "Return the beta-beta-beta 3RDM as a numpy array (no copy)")
         .def(
-            "SFg2_data", [](RDMs& rdm) { return ambit_to_np(rdm.SFg2()); },
-            "Return the spin-free 2-RDM as a numpy array")
+            "SFg2_data", [](RDMs& rdm) { return ambit_to_np_view(rdm.SFg2()); },
+            "Return the spin-free 2-RDM as a numpy array (no copy)")
         .def(
-            "L2aa", [](RDMs& rdm) { return ambit_to_np(rdm.L2aa()); },
-            "Return the alpha-alpha 2-cumulant as a numpy array")
+            "L2aa", [](RDMs& rdm) { return ambit_to_np_view(rdm.L2aa()); },
+            "Return the alpha-alpha 2-cumulant as a numpy array (no copy)")
         .def(
-            "L2ab", [](RDMs& rdm) { return ambit_to_np(rdm.L2ab()); },
-            "Return the alpha-beta 2-cumulant as a numpy array")
+            "L2ab", [](RDMs& rdm) { return ambit_to_np_view(rdm.L2ab()); },
+            "Return the alpha-beta 2-cumulant as a numpy array (no copy)")
         .def(
-            "L2bb", [](RDMs& rdm) { return ambit_to_np(rdm.L2bb()); },
-            "Return the beta-beta 2-cumulant as a numpy array")
+            "L2bb", [](RDMs& rdm) { return ambit_to_np_view(rdm.L2bb()); },
+            "Return the beta-beta 2-cumulant as a numpy array (no copy)")
         .def(
-            "L3aaa", [](RDMs& rdm) { return ambit_to_np(rdm.L3aaa()); },
-            "Return the alpha-alpha-alpha 3-cumulant as a numpy array")
+            "L3aaa", [](RDMs& rdm) { return ambit_to_np_view(rdm.L3aaa()); },
+            "Return the alpha-alpha-alpha 3-cumulant as a numpy array (no copy)")
         .def(
-            "L3aab", [](RDMs& rdm) { return ambit_to_np(rdm.L3aab()); },
-            "Return the alpha-alpha-beta 3-cumulant as a numpy array")
+            "L3aab", [](RDMs& rdm) { return ambit_to_np_view(rdm.L3aab()); },
+            "Return the alpha-alpha-beta 3-cumulant as a numpy array (no copy)")
         .def(
-            "L3abb", [](RDMs& rdm) { return ambit_to_np(rdm.L3abb()); },
-            "Return the alpha-beta-beta 3-cumulant as a numpy array")
+            "L3abb", [](RDMs& rdm) { return ambit_to_np_view(rdm.L3abb()); },
+            "Return the alpha-beta-beta 3-cumulant as a numpy array (no copy)")
         .def(
-            "L3bbb", [](RDMs& rdm) { return ambit_to_np(rdm.L3bbb()); },
-            "Return the beta-beta-beta 3-cumulant as a numpy array");
+            "L3bbb", [](RDMs& rdm) { return ambit_to_np_view(rdm.L3bbb()); },
+            "Return the beta-beta-beta 3-cumulant as a numpy array (no copy)");
 }
 } // namespace forte
@@ -27,6 +27,7 @@
  */
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
 #include "psi4/libmints/vector.h"
@@ -40,9 +41,11 @@
 #include "sparse_ci/determinant_hashvector.h"
 #include "sparse_ci/sparse_state_vector.h"
 #include "sparse_ci/sparse_operator.h"
+#include "sparse_ci/compiled_sparse_operator.h"
 #include "sparse_ci/sparse_fact_exp.h"
 #include "sparse_ci/sparse_exp.h"
 #include "sparse_ci/sparse_hamiltonian.h"
+#include "sparse_ci/sparse_cc_solver.h"
 
 namespace py = pybind11;
 using namespace pybind11::literals;
@@ -152,6 +155,22 @@ void export_Determinant(py::module& m) {
         .def("latex", &SparseOperator::latex)
         .def("adjoint", &SparseOperator::adjoint);
 
+    py::class_<CompiledSparseOperator>(m, "CompiledSparseOperator")
+        .def(py::init<const SparseOperator&>(), "sop"_a)
+        .def("update_coefficients", &CompiledSparseOperator::update_coefficients, "sop"_a,
+             "Copy the coefficients of an operator with the same terms")
+        .def("apply",
+             py::overload_cast<const StateVector&, double>(&CompiledSparseOperator::apply,
+                                                           py::const_),
+             "state"_a, "screen_thresh"_a = 1.0e-12, "Apply this operator to a state")
+        .def("apply",
+             py::overload_cast<const std::vector<StateVector>&, double>(
+                 &CompiledSparseOperator::apply, py::const_),
+             "states"_a, "screen_thresh"_a = 1.0e-12, "Apply this operator to a list of states")
+        .def("size", &CompiledSparseOperator::size, "The number of compiled terms")
+        .def("num_groups", &CompiledSparseOperator::num_groups,
+             "The number of groups of terms with the same annihilation operators");
+
     py::class_<SQOperator>(m, "SQOperator")
         .def(py::init<double, const Determinant&, const Determinant&>())
         .def("coefficient", &SQOperator::coefficient)
@@ -175,29 +194,103 @@ void export_Determinant(py::module& m) {
         .def("__getitem__", [](StateVector& v, const Determinant& d) { return v[d]; })
         .def("__setitem__",
              [](StateVector& v, const Determinant& d, const double val) { v[d] = val; })
-        .def("__contains__", [](StateVector& v, const Determinant& d) { return v.map().count(d); });
+        .def("__contains__", [](StateVector& v, const Determinant& d) { return v.count(d); })
+        .def(
+            "coefficients",
+            [](py::object self) {
+                auto& v = self.cast<StateVector&>();
+                if (v.size() == 0)
+                    return py::array_t<double>(0);
+                // a strided view of the coefficients stored next to each determinant
+                using element = StateVector::container::value_type;
+                std::vector<py::ssize_t> shape{static_cast<py::ssize_t>(v.size())};
+                std::vector<py::ssize_t> strides{static_cast<py::ssize_t>(sizeof(element))};
+                return py::array_t<double>(shape, strides, &v.begin()->second, self);
+            },
+            "Return a numpy view (no copy) of the coefficients in the order of items(). The view "
+            "is invalidated when determinants are added to the state");
+
+    py::class_<SortedStateVector>(m, "SortedStateVector")
+        .def(py::init<const StateVector&>())
+        .def(py::init<const std::vector<Determinant>&, const std::vector<double>&>(), "dets"_a,
+             "coefficients"_a)
+        .def("to_state_vector", &SortedStateVector::to_state_vector,
+             "Return a StateVector with the same terms")
+        .def("dets", &SortedStateVector::dets, "Return the sorted determinants")
+        .def(
+            "coefficients",
+            [](py::object self) {
+                auto& v = self.cast<SortedStateVector&>();
+                return py::array_t<double>(v.size(), v.coefficients().data(), self);
+            },
+            "Return the coefficients as a numpy array that shares memory with this object")
+        .def("coefficient", &SortedStateVector::coefficient,
+             "Return the coefficient of a determinant")
+        .def("norm", &SortedStateVector::norm, "Return the 2-norm")
+        .def("scale", &SortedStateVector::scale, "Multiply by a scalar")
+        .def("axpy", &SortedStateVector::axpy, "a"_a, "x"_a, "Compute this += a * x")
+        .def("prune", &SortedStateVector::prune, "threshold"_a,
+             "Remove terms with absolute coefficient smaller than or equal to threshold")
+        .def("save", &SortedStateVector::save, "filename"_a, "Save to a binary file")
+        .def_static("load", &SortedStateVector::load, "filename"_a, "Read from a binary file")
+        .def("__len__", &SortedStateVector::size);
 
     py::class_<SparseHamiltonian>(m, "SparseHamiltonian")
         .def(py::init<std::shared_ptr<ActiveSpaceIntegrals>>())
         .def("compute", &SparseHamiltonian::compute)
         .def("compute_on_the_fly", &SparseHamiltonian::compute_on_the_fly)
+        .def("set_max_cached_couplings", &SparseHamiltonian::set_max_cached_couplings,
+             "Set the maximum number of couplings kept in the cache (0 = no limit)")
+        .def("num_cached_couplings", &SparseHamiltonian::num_cached_couplings)
+        .def("clear_cache", &SparseHamiltonian::clear_cache)
         .def("timings", &SparseHamiltonian::timings);
 
     py::class_<SparseExp>(m, "SparseExp")
         .def(py::init<>())
         .def("compute", &SparseExp::compute, "sop"_a, "state"_a, "algorithm"_a = "cached",
-             "scaling_factor"_a = 1.0, "maxk"_a = 19, "screen_thresh"_a = 1.0e-12)
+             "scaling_factor"_a = 1.0, "maxk"_a = 19, "screen_thresh"_a = 1.0e-12,
+             py::call_guard<py::gil_scoped_release>())
         .def("timings", &SparseExp::timings);
 
     py::class_<SparseFactExp>(m, "SparseFactExp")
         .def(py::init<bool>(), "phaseless"_a = false)
         .def("compute", &SparseFactExp::compute, "sop"_a, "state"_a, "algorithm"_a = "cached",
-             "inverse"_a = false, "screen_thresh"_a = 1.0e-13)
+             "inverse"_a = false, "screen_thresh"_a = 1.0e-13,
+             py::call_guard<py::gil_scoped_release>())
         .def("timings", &SparseFactExp::timings);
 
+    py::class_<SparseCCSolver>(m, "SparseCCSolver")
+        .def(py::init<std::shared_ptr<ActiveSpaceIntegrals>, const std::string&,
+                      const SparseOperator&, const std::vector<double>&, const StateVector&>(),
+             "as_ints"_a, "cc_type"_a, "op"_a, "denominators"_a, "ref"_a)
+        .def("compute_energy", &SparseCCSolver::compute_energy,
+             "Solve the CC equations and return the energy",
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_compute_threshold", &SparseCCSolver::set_compute_threshold)
+        .def("set_e_convergence", &SparseCCSolver::set_e_convergence)
+        .def("set_r_convergence", &SparseCCSolver::set_r_convergence)
+        .def("set_on_the_fly", &SparseCCSolver::set_on_the_fly)
+        .def("set_linked", &SparseCCSolver::set_linked)
+        .def("set_maxk", &SparseCCSolver::set_maxk)
+        .def("set_diis_start", &SparseCCSolver::set_diis_start)
+        .def("set_diis_max_vec", &SparseCCSolver::set_diis_max_vec)
+        .def("set_maxiter", &SparseCCSolver::set_maxiter)
+        .def("set_amplitudes", &SparseCCSolver::set_amplitudes)
+        .def("amplitudes", &SparseCCSolver::amplitudes)
+        .def("energy", &SparseCCSolver::energy)
+        .def("proj_energy", &SparseCCSolver::proj_energy)
+        .def("residual_norm", &SparseCCSolver::residual_norm)
+        .def("iterations", &SparseCCSolver::iterations)
+        .def("timings", &SparseCCSolver::timings);
+
     m.def("apply_operator",
           py::overload_cast<SparseOperator&, const StateVector&, double>(&apply_operator), "sop"_a,
-          "state0"_a, "screen_thresh"_a = 1.0e-12);
+          "state0"_a, "screen_thresh"_a = 1.0e-12, py::call_guard<py::gil_scoped_release>());
+    m.def("apply_operator",
+          py::overload_cast<const SparseOperator&, const std::vector<StateVector>&, double>(
+              &apply_operator),
+          "sop"_a, "states"_a, "screen_thresh"_a = 1.0e-12, "Apply an operator to a list of states",
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("apply_operator_safe",
           py::overload_cast<SparseOperator&, const StateVector&>(&apply_operator_safe), "sop"_a,
@@ -206,6 +299,9 @@ void export_Determinant(py::module& m) {
     m.def("apply_number_projector", &apply_number_projector);
     m.def("get_projection", &get_projection);
     m.def("overlap", &overlap);
+    m.def("dot", py::overload_cast<const SortedStateVector&, const SortedStateVector&>(&dot),
+          "Compute the overlap of two sorted states by merging them");
+    m.def("add", &add, "a"_a, "x"_a, "b"_a, "y"_a, "Compute a * x + b * y of two sorted states");
     m.def("spin2", &spin2<Determinant::nbits>);
 }
 
@@ -223,6 +319,8 @@ void export_SigmaVector(py::module& m) {
         .value("Full", SigmaVectorType::Full)
         .value("Dynamic", SigmaVectorType::Dynamic)
         .value("SparseList", SigmaVectorType::SparseList)
+        .value("GPU", SigmaVectorType::GPU)
+        .value("Incremental", SigmaVectorType::Incremental)
         .export_values();
 }
 
@@ -235,7 +333,7 @@ void export_SparseCISolver(py::module& m) {
                                     std::shared_ptr<SigmaVector> sigma_vec, int nroot,
                                     int multiplicity)) &
                  SparseCISolver::diagonalize_hamiltonian,
-             "Diagonalize the Hamiltonian")
+             "Diagonalize the Hamiltonian", py::call_guard<py::gil_scoped_release>())
         .def("diagonalize_hamiltonian_full", &SparseCISolver::diagonalize_hamiltonian_full,
              "Diagonalize the full Hamiltonian matrix")
         .def("spin", &SparseCISolver::spin,
@@ -34,8 +34,10 @@
 #include "base_classes/active_space_method.h"
 #include "base_classes/mo_space_info.h"
 #include "base_classes/forte_options.h"
+#include "base_classes/wave_function_file.h"
 #include "helpers/printing.h"
 #include "helpers/string_algorithms.h"
+#include "sparse_ci/determinant.h"
 #include "fci/fci_solver.h"
 #include "casscf/casscf.h"
 #include "sci/aci.h"
@@ -73,8 +75,18 @@ void ActiveSpaceMethod::set_read_wfn_guess(bool read) { read_wfn_guess_ = read;
 
 void ActiveSpaceMethod::set_dump_wfn(bool dump) { dump_wfn_ = dump; }
 
+void ActiveSpaceMethod::set_dl_checkpoint(bool checkpoint) { dl_checkpoint_ = checkpoint; }
+
+void ActiveSpaceMethod::set_rdm_truncation(double weight) { rdm_truncation_ = weight; }
+
 void ActiveSpaceMethod::set_wfn_filename(const std::string& name) { wfn_filename_ = name; }
 
+std::tuple<size_t, std::vector<Determinant>, psi::SharedMatrix>
+ActiveSpaceMethod::read_wave_function(const std::string& filename) {
+    auto wfn = read_wave_function_file(filename);
+    return {wfn.norbs, std::move(wfn.dets), wfn.evecs};
+}
+
 void ActiveSpaceMethod::set_root(int value) { root_ = value; }
 
 void ActiveSpaceMethod::set_print(int level) { print_ = level; }
@@ -245,6 +257,16 @@ std::unique_ptr<ActiveSpaceMethod> make_active_space_method(
     std::shared_ptr<MOSpaceInfo> mo_space_info, std::shared_ptr<ActiveSpaceIntegrals> as_ints,
     std::shared_ptr<ForteOptions> options) {
 
+    // The determinant-based solvers need determinants wide enough for the active space
+    auto nactv = mo_space_info->size("ACTIVE");
+    if (type != "FCI") {
+        try {
+            determinant_width(nactv);
+        } catch (const std::runtime_error& e) {
+            throw psi::PSIEXCEPTION("make_active_space_method: " + std::string(e.what()));
+        }
+    }
+
     std::unique_ptr<ActiveSpaceMethod> method;
     if (type == "FCI") {
         method = std::make_unique<FCISolver>(state, nroot, mo_space_info, as_ints);
@@ -272,10 +294,9 @@ std::unique_ptr<ActiveSpaceMethod> make_active_space_method(
     method->set_options(options);
 
     // set default file name if dump wave function to disk
-    auto nactv = mo_space_info->size("ACTIVE");
     std::string prefix = "forte." + lower_string(type) + ".o" + std::to_string(nactv) + ".";
     std::string state_str = method->state().str_short();
-    method->set_wfn_filename(prefix + state_str + ".txt");
+    method->set_wfn_filename(prefix + state_str + ".wfn");
 
     return method;
 }
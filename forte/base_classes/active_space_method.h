@@ -149,13 +149,11 @@ class ActiveSpaceMethod {
         throw std::runtime_error("Not yet implemented!");
     }
 
-    /// Read the wave function from file
+    /// Read the wave function from a file written by dump_wave_function (see WaveFunctionFile)
     /// @param file name
     /// @return the number of active orbitals, the set of determinants, CI coefficients
     virtual std::tuple<size_t, std::vector<Determinant>, psi::SharedMatrix>
-    read_wave_function(const std::string&) {
-        throw std::runtime_error("Not yet implemented!");
-    }
+    read_wave_function(const std::string& filename);
 
     // ==> Base Class Functionality (inherited by derived classes) <==
 
@@ -203,6 +201,13 @@ class ActiveSpaceMethod {
     /// Set if we dump the wave function to disk
     void set_dump_wfn(bool dump);
 
+    /// Set if we save the Davidson-Liu subspace to disk and restart from it
+    void set_dl_checkpoint(bool checkpoint);
+
+    /// Set the weight of the wave function discarded when computing RDMs
+    /// (used by selected CI methods, 0 = use the full wave function)
+    void set_rdm_truncation(double weight);
+
     /// Set the file name for stroing wave function on disk
     /// @param name the wave function file name
     void set_wfn_filename(const std::string& name);
@@ -270,6 +275,10 @@ class ActiveSpaceMethod {
     bool read_wfn_guess_ = false;
     /// Dump wave function to disk?
     bool dump_wfn_ = false;
+    /// Save the Davidson-Liu subspace to disk and restart from it?
+    bool dl_checkpoint_ = false;
+    /// The weight of the wave function discarded when computing RDMs
+    double rdm_truncation_ = 0.0;
     /// The file name for storing wave function (determinants, CI coefficients)
     std::string wfn_filename_;
 };
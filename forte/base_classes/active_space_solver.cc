@@ -27,10 +27,14 @@
  */
 
 #include <algorithm>
+#include <exception>
+#include <functional>
 #include <numeric>
 #include <iomanip>
 #include <tuple>
 
+#include <omp.h>
+
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/molecule.h"
@@ -65,12 +69,14 @@ ActiveSpaceSolver::ActiveSpaceSolver(const std::string& method,
     e_convergence_ = options->get_double("E_CONVERGENCE");
     r_convergence_ = options->get_double("R_CONVERGENCE");
     read_initial_guess_ = options->get_bool("READ_ACTIVE_WFN_GUESS");
+    concurrent_ = options->get_bool("ACTIVE_SPACE_SOLVER_CONCURRENT");
 }
 
 void ActiveSpaceSolver::set_print(int level) { print_ = level; }
 
 const std::map<StateInfo, std::vector<double>>& ActiveSpaceSolver::compute_energy() {
     state_energies_map_.clear();
+    std::vector<StateInfo> states_to_solve;
     for (const auto& state_nroot : state_nroots_map_) {
         const auto& state = state_nroot.first;
         size_t nroot = state_nroot.second;
@@ -80,6 +86,8 @@ const std::map<StateInfo, std::vector<double>>& ActiveSpaceSolver::compute_energ
         method->set_print(print_);
         method->set_e_convergence(e_convergence_);
         method->set_r_convergence(r_convergence_);
+        if (dl_checkpoint_)
+            method->set_dl_checkpoint(true);
         state_method_map_[state] = method;
 
         int twice_ms = state.twice_ms();
@@ -91,12 +99,20 @@ const std::map<StateInfo, std::vector<double>>& ActiveSpaceSolver::compute_energ
             continue;
         }
 
+        // the file names are also needed to dump the wave functions after this solve
+        state_filename_map_[state] = method->wfn_filename();
         if (read_initial_guess_) {
-            state_filename_map_[state] = method->wfn_filename();
             method->set_read_wfn_guess(read_initial_guess_);
         }
+        states_to_solve.push_back(state);
+    }
+
+    // the CI problems of different symmetries are independent
+    for_each_state(states_to_solve,
+                   [&](const StateInfo& state) { state_method_map_.at(state)->compute_energy(); });
 
-        method->compute_energy();
+    for (const auto& state : states_to_solve) {
+        const auto& method = state_method_map_[state];
         const auto& energies = method->energies();
         state_energies_map_[state] = energies;
         const auto& spin2 = method->spin2();
@@ -106,6 +122,7 @@ const std::map<StateInfo, std::vector<double>>& ActiveSpaceSolver::compute_energ
         state_spin2_map_[state] = spin2;
 
         // save energies for ms < 0 states (same in energy as ms > 0) to ensure correct averaging
+        int twice_ms = state.twice_ms();
         if (twice_ms > 0 and ms_avg_) {
             StateInfo state_spin(state.nb(), state.na(), state.multiplicity(), -twice_ms,
                                  state.irrep(), state.irrep_label(), state.gas_min(),
@@ -123,6 +140,60 @@ const std::map<StateInfo, std::vector<double>>& ActiveSpaceSolver::compute_energ
     return state_energies_map_;
 }
 
+size_t ActiveSpaceSolver::concurrent_groups(size_t nstates) const {
+    size_t nthreads = omp_get_max_threads();
+    if (concurrent_ and method_ == "FCI" and nstates > 1 and nthreads > 1) {
+        return std::min(nthreads, nstates);
+    }
+    return 1;
+}
+
+void ActiveSpaceSolver::for_each_state(const std::vector<StateInfo>& states,
+                                       const std::function<void(const StateInfo&)>& task) {
+    int nstates = states.size();
+    int ngroups = concurrent_groups(states.size());
+    if (ngroups == 1) {
+        for (const auto& state : states) {
+            task(state);
+        }
+        return;
+    }
+    int nthreads_group = std::max(1, omp_get_max_threads() / ngroups);
+
+    psi::outfile->Printf("\n  Processing %d state symmetries concurrently: %d group(s) of %d "
+                         "thread(s).",
+                         nstates, ngroups, nthreads_group);
+
+    // the output file is shared by all solvers
+    for (const auto& state : states) {
+        state_method_map_[state]->set_print(0);
+    }
+
+    int max_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(max_levels, 2));
+
+    std::vector<std::exception_ptr> errors(nstates);
+#pragma omp parallel for num_threads(ngroups) schedule(dynamic, 1)
+    for (int i = 0; i < nstates; ++i) {
+        omp_set_num_threads(nthreads_group);
+        try {
+            task(states[i]);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    }
+
+    omp_set_max_active_levels(max_levels);
+
+    for (const auto& state : states) {
+        state_method_map_[state]->set_print(print_);
+    }
+    for (const auto& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
 void ActiveSpaceSolver::validate_spin(const std::vector<double>& spin2, const StateInfo& state) {
     if (spin2.size() != 0) {
         double S_tolerance = options_->get_double("S_TOLERANCE");
@@ -552,12 +623,51 @@ RDMs ActiveSpaceSolver::compute_average_rdms(
     return compute_avg_rdms(state_weights_map, max_rdm_level);
 }
 
+std::map<StateInfo, std::vector<RDMs>> ActiveSpaceSolver::compute_state_rdms_concurrent(
+    const std::map<StateInfo, std::vector<double>>& state_weights_map, int max_rdm_level) {
+    std::vector<StateInfo> states;
+    for (const auto& state_nroot : state_nroots_map_) {
+        const auto& state = state_nroot.first;
+        if (not(ms_avg_ and state.twice_ms() < 0)) {
+            states.push_back(state);
+        }
+    }
+    std::map<StateInfo, std::vector<RDMs>> state_rdms;
+    if (concurrent_groups(states.size()) == 1) {
+        return state_rdms;
+    }
+
+    // allocate the entries first so that the map is not modified by the tasks
+    for (const auto& state : states) {
+        state_rdms[state] = std::vector<RDMs>(state_nroots_map_.at(state));
+    }
+    for_each_state(states, [&](const StateInfo& state) {
+        const auto& weights = state_weights_map.at(state);
+        std::vector<std::pair<size_t, size_t>> state_ids;
+        for (size_t r = 0, nroot = state_nroots_map_.at(state); r < nroot; r++) {
+            if (weights[r] > 1e-15)
+                state_ids.push_back(std::make_pair(r, r));
+        }
+        if (state_ids.empty())
+            return;
+        auto rdms = state_method_map_.at(state)->rdms(state_ids, max_rdm_level);
+        auto& out = state_rdms.at(state);
+        for (size_t n = 0; n < state_ids.size(); ++n) {
+            out[state_ids[n].first] = rdms[n];
+        }
+    });
+    return state_rdms;
+}
+
 RDMs ActiveSpaceSolver::compute_avg_rdms(
     const std::map<StateInfo, std::vector<double>>& state_weights_map, int max_rdm_level) {
     if (max_rdm_level <= 0) {
         return RDMs();
     }
 
+    // the RDMs of each state (empty unless the states are processed concurrently)
+    auto state_rdms = compute_state_rdms_concurrent(state_weights_map, max_rdm_level);
+
     size_t na = mo_space_info_->size("ACTIVE");
 
     auto g1a = ambit::Tensor::build(ambit::CoreTensor, "g1a", {na, na});
@@ -598,9 +708,14 @@ RDMs ActiveSpaceSolver::compute_avg_rdms(
                 continue;
 
             // Get the RDMs
-            std::vector<std::pair<size_t, size_t>> state_ids;
-            state_ids.push_back(std::make_pair(r, r));
-            RDMs method_rdms = method->rdms(state_ids, max_rdm_level)[0];
+            RDMs method_rdms;
+            if (state_rdms.count(state)) {
+                method_rdms = state_rdms.at(state)[r];
+            } else {
+                std::vector<std::pair<size_t, size_t>> state_ids;
+                state_ids.push_back(std::make_pair(r, r));
+                method_rdms = method->rdms(state_ids, max_rdm_level)[0];
+            }
 
             // Average the RDMs
             g1a("pq") += weight * method_rdms.g1a()("pq");
@@ -638,6 +753,9 @@ RDMs ActiveSpaceSolver::compute_avg_rdms_ms_avg(
         return RDMs();
     }
 
+    // the RDMs of each state (empty unless the states are processed concurrently)
+    auto state_rdms = compute_state_rdms_concurrent(state_weights_map, max_rdm_level);
+
     size_t na = mo_space_info_->size("ACTIVE");
 
     auto g1a = ambit::Tensor::build(ambit::CoreTensor, "g1a", {na, na});
@@ -677,9 +795,14 @@ RDMs ActiveSpaceSolver::compute_avg_rdms_ms_avg(
                 continue;
 
             // Get the RDMs
-            std::vector<std::pair<size_t, size_t>> state_ids;
-            state_ids.push_back(std::make_pair(r, r));
-            RDMs method_rdms = method->rdms(state_ids, max_rdm_level)[0];
+            RDMs method_rdms;
+            if (state_rdms.count(state)) {
+                method_rdms = state_rdms.at(state)[r];
+            } else {
+                std::vector<std::pair<size_t, size_t>> state_ids;
+                state_ids.push_back(std::make_pair(r, r));
+                method_rdms = method->rdms(state_ids, max_rdm_level)[0];
+            }
 
             // Average the RDMs
             g1a("pq") += weight * method_rdms.g1a()("pq");
@@ -718,6 +841,12 @@ RDMs ActiveSpaceSolver::compute_avg_rdms_ms_avg(
     return RDMs(true, g1a, g2ab, g3aab);
 }
 
+void ActiveSpaceSolver::set_rdm_truncation(double weight) {
+    for (const auto& state_method : state_method_map_) {
+        state_method.second->set_rdm_truncation(weight);
+    }
+}
+
 void ActiveSpaceSolver::dump_wave_function() {
     const auto& state_filenames = state_filename_map();
     for (const auto& state_filename : state_filenames) {
@@ -756,28 +885,61 @@ ActiveSpaceSolver::compute_contracted_energy(std::shared_ptr<ActiveSpaceIntegral
 
     DressedQuantity ints(0.0, oei_a, oei_b, tei_aa, tei_ab, tei_bb);
 
+    // number of (transition) RDMs that fit in a quarter of the memory, each set holds the
+    // spin components of all levels up to max_rdm_level
+    size_t rdm_size = 0, nactv_k = 1;
+    for (int level = 1; level <= max_rdm_level; ++level) {
+        nactv_k *= nactv * nactv;
+        rdm_size += (level + 1) * nactv_k;
+    }
+    size_t rdm_batch = psi::Process::environment.get_memory() / 4 /
+                       (std::max(rdm_size, size_t(1)) * sizeof(double));
+
+    std::vector<StateInfo> states;
     for (const auto& state_nroots : state_nroots_map_) {
-        const auto& state = state_nroots.first;
-        size_t nroots = state_nroots.second;
+        if (not(state_nroots.first.twice_ms() < 0 and ms_avg_)) {
+            states.push_back(state_nroots.first);
+        }
+    }
+
+    // the states processed concurrently share the memory
+    size_t ngroups = concurrent_groups(states.size());
+    rdm_batch = std::max(rdm_batch / ngroups, size_t(1));
+
+    // form the Hermitian effective Hamiltonian of each state
+    std::map<StateInfo, std::shared_ptr<psi::Matrix>> state_Heff;
+    for (const auto& state : states) {
+        size_t nroots = state_nroots_map_.at(state);
         std::string state_name = state.multiplicity_label() + " " + state.irrep_label();
+        state_Heff[state] = std::make_shared<psi::Matrix>("Heff " + state_name, nroots, nroots);
+    }
+    for_each_state(states, [&](const StateInfo& state) {
+        size_t nroots = state_nroots_map_.at(state);
         auto method = state_method_map_.at(state);
-
-        int twice_ms = state.twice_ms();
-        if (twice_ms < 0 and ms_avg_) {
-            continue;
+        auto& Heff = *state_Heff.at(state);
+        if (ngroups == 1) {
+            print_h2("Building Effective Hamiltonian for " + state.multiplicity_label() + " " +
+                     state.irrep_label());
         }
 
-        // form the Hermitian effective Hamiltonian
-        print_h2("Building Effective Hamiltonian for " + state_name);
-        psi::Matrix Heff("Heff " + state_name, nroots, nroots);
-
+        // the dressed integrals are shared by all states, the (transition) rdms of <A|sqop|B>
+        // are computed in batches so that the solver can form them in one pass
+        std::vector<std::pair<size_t, size_t>> root_list;
         for (size_t A = 0; A < nroots; ++A) {
             for (size_t B = A; B < nroots; ++B) {
-                // just compute transition rdms of <A|sqop|B>
-                std::vector<std::pair<size_t, size_t>> root_list{std::make_pair(A, B)};
-                RDMs rdms = method->rdms(root_list, max_rdm_level)[0];
+                root_list.emplace_back(A, B);
+            }
+        }
 
-                double H_AB = ints.contract_with_rdms(rdms);
+        for (size_t start = 0; start < root_list.size(); start += rdm_batch) {
+            size_t end = std::min(start + rdm_batch, root_list.size());
+            std::vector<std::pair<size_t, size_t>> batch(root_list.begin() + start,
+                                                         root_list.begin() + end);
+            std::vector<RDMs> rdms = method->rdms(batch, max_rdm_level);
+
+            for (size_t n = 0; n < batch.size(); ++n) {
+                auto [A, B] = batch[n];
+                double H_AB = ints.contract_with_rdms(rdms[n]);
                 if (A == B) {
                     H_AB += as_ints->nuclear_repulsion_energy() + as_ints->scalar_energy() +
                             as_ints->frozen_core_energy();
@@ -788,6 +950,13 @@ ActiveSpaceSolver::compute_contracted_energy(std::shared_ptr<ActiveSpaceIntegral
                 }
             }
         }
+    });
+
+    for (const auto& state : states) {
+        size_t nroots = state_nroots_map_.at(state);
+        std::string state_name = state.multiplicity_label() + " " + state.irrep_label();
+        auto& Heff = *state_Heff.at(state);
+        int twice_ms = state.twice_ms();
 
         print_h2("Effective Hamiltonian for " + state_name);
         psi::outfile->Printf("\n");
@@ -29,6 +29,7 @@
 #ifndef _active_space_solver_h_
 #define _active_space_solver_h_
 
+#include <functional>
 #include <map>
 #include <vector>
 #include <string>
@@ -130,6 +131,13 @@ class ActiveSpaceSolver {
     /// Set if read wave function from file as initial guess
     void set_read_initial_guess(bool read_guess) { read_initial_guess_ = read_guess; }
 
+    /// Save the Davidson-Liu subspaces of the solvers to disk and restart from them if available
+    void set_dl_checkpoint(bool checkpoint) { dl_checkpoint_ = checkpoint; }
+
+    /// Compute the RDMs of the solved states from truncated wave functions (selected CI only)
+    /// @param weight the weight of each wave function discarded (0 = full wave function)
+    void set_rdm_truncation(double weight);
+
   protected:
     /// a string that specifies the method used (e.g. "FCI", "ACI", ...)
     std::string method_;
@@ -198,6 +206,26 @@ class ActiveSpaceSolver {
     /// Read wave function from disk as initial guess
     bool read_initial_guess_;
 
+    /// Force the solvers to checkpoint (and restart from) their Davidson-Liu subspaces
+    bool dl_checkpoint_ = false;
+
+    /// Process the different state symmetries concurrently (FCI only)
+    bool concurrent_ = false;
+
+    /// The number of groups of threads used to process nstates states (1 = sequential)
+    size_t concurrent_groups(size_t nstates) const;
+
+    /// Call task for each state, concurrently if requested, each with a subgroup of the OpenMP
+    /// threads. The first exception thrown by a task is rethrown after all tasks are done
+    void for_each_state(const std::vector<StateInfo>& states,
+                        const std::function<void(const StateInfo&)>& task);
+
+    /// The RDMs of the roots with nonzero weight of each state, computed concurrently.
+    /// Returns an empty map if the states are not processed concurrently
+    std::map<StateInfo, std::vector<RDMs>>
+    compute_state_rdms_concurrent(const std::map<StateInfo, std::vector<double>>& state_weights_map,
+                                  int max_rdm_level);
+
     /// Pairs of state info and the contracted CI eigen vectors
     std::map<StateInfo, std::shared_ptr<psi::Matrix>>
         state_contracted_evecs_map_; // TODO move outside?
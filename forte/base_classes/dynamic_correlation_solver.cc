@@ -36,6 +36,8 @@ void DynamicCorrelationSolver::startup() {
     if (diis_freq_ < 1) {
         diis_freq_ = 1;
     }
+    diis_storage_ = foptions_->get_str("DSRG_DIIS_STORAGE");
+    diis_out_of_core_ = foptions_->get_bool("DSRG_DIIS_OUT_OF_CORE");
 }
 
 void DynamicCorrelationSolver::clean_checkpoints() {
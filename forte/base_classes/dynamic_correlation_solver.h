@@ -84,6 +84,10 @@ class DynamicCorrelationSolver {
     int diis_max_vec_;
     /// Frequency of extrapolating the current DIIS vectors
     int diis_freq_;
+    /// Storage of the DIIS vectors: PSI4 (DIISManager), DOUBLE, or FLOAT (CompressedDIIS)
+    std::string diis_storage_;
+    /// Keep the CompressedDIIS history in a scratch file?
+    bool diis_out_of_core_;
 
     // ==> amplitudes file names <==
 
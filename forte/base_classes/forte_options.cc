@@ -224,6 +224,7 @@ void ForteOptions::set_from_dict(const pybind11::dict& dict) {
 }
 
 void ForteOptions::set_dict(const pybind11::dict& dict) {
+    py::gil_scoped_acquire gil;
     dict_ = py::module::import("copy").attr("deepcopy")(dict);
 }
 
@@ -243,16 +244,19 @@ void throw_options_get_error(const std::string& correct_type, const std::string&
 }
 
 bool ForteOptions::exists(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     std::string label_uc = upper_string(label);
     return dict_.contains(label_uc.c_str());
 }
 
 bool ForteOptions::is_none(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     return value_type.first.is_none();
 }
 
 bool ForteOptions::get_bool(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     if (value_type.second == "bool") {
         return py::cast<bool>(value_type.first);
@@ -262,6 +266,7 @@ bool ForteOptions::get_bool(const std::string& label) const {
 }
 
 int ForteOptions::get_int(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     check_options_none(value_type.first, "int", label);
     if (value_type.second == "int") {
@@ -272,6 +277,7 @@ int ForteOptions::get_int(const std::string& label) const {
 }
 
 double ForteOptions::get_double(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     check_options_none(value_type.first, "double", label);
     if (value_type.second == "float") {
@@ -282,6 +288,7 @@ double ForteOptions::get_double(const std::string& label) const {
 }
 
 std::string ForteOptions::get_str(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     check_options_none(value_type.first, "str", label);
     if (value_type.second == "str") {
@@ -292,6 +299,7 @@ std::string ForteOptions::get_str(const std::string& label) const {
 }
 
 py::list ForteOptions::get_gen_list(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     check_options_none(value_type.first, "gen_list", label);
     if (value_type.second == "gen_list") {
@@ -302,6 +310,7 @@ py::list ForteOptions::get_gen_list(const std::string& label) const {
 }
 
 std::vector<int> ForteOptions::get_int_list(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     std::vector<int> result;
     auto value_type = get(label);
     check_options_none(value_type.first, "int_vec", label);
@@ -316,6 +325,7 @@ std::vector<int> ForteOptions::get_int_list(const std::string& label) const {
 }
 
 std::vector<double> ForteOptions::get_double_list(const std::string& label) const {
+    py::gil_scoped_acquire gil;
     std::vector<double> result;
     auto value_type = get(label);
     check_options_none(value_type.first, "double_vec", label);
@@ -335,6 +345,7 @@ void set_int_list(const std::string& label);
 void set_double_list(const std::string& label, const std::vector<double>& val);
 
 void ForteOptions::set_bool(const std::string& label, bool val) {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     if (value_type.second == "bool") {
         set(label, py::bool_(val));
@@ -346,6 +357,7 @@ void ForteOptions::set_bool(const std::string& label, bool val) {
 }
 
 void ForteOptions::set_int(const std::string& label, int val) {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     if (value_type.second == "int") {
         set(label, py::int_(val));
@@ -357,6 +369,7 @@ void ForteOptions::set_int(const std::string& label, int val) {
 }
 
 void ForteOptions::set_double(const std::string& label, double val) {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     if (value_type.second == "float") {
         set(label, py::float_(val));
@@ -368,6 +381,7 @@ void ForteOptions::set_double(const std::string& label, double val) {
 }
 
 void ForteOptions::set_str(const std::string& label, const std::string& val) {
+    py::gil_scoped_acquire gil;
     auto value_type = get(label);
     if (value_type.second == "str") {
         // capitalize the string
@@ -392,6 +406,7 @@ void ForteOptions::set_gen_list(const std::string& label, py::list val) {
 }
 
 void ForteOptions::set_int_list(const std::string& label, const std::vector<int>& val) {
+    py::gil_scoped_acquire gil;
     std::vector<int> result;
     auto value_type = get(label);
     if (value_type.second == "int_list") {
@@ -404,6 +419,7 @@ void ForteOptions::set_int_list(const std::string& label, const std::vector<int>
 }
 
 void ForteOptions::set_double_list(const std::string& label, const std::vector<double>& val) {
+    py::gil_scoped_acquire gil;
     std::vector<double> result;
     auto value_type = get(label);
     if (value_type.second == "float_list") {
@@ -416,6 +432,7 @@ void ForteOptions::set_double_list(const std::string& label, const std::vector<d
 }
 
 void ForteOptions::push_options_to_psi4(psi::Options& options) const {
+    py::gil_scoped_acquire gil;
     for (auto item : dict_) {
         auto label = py::cast<std::string>(item.first);
         auto type = py::cast<std::string>(item.second["type"]);
@@ -554,6 +571,7 @@ py::object process_psi4_array_data(psi::Data& data) {
 }
 
 std::string ForteOptions::str() const {
+    py::gil_scoped_acquire gil;
     std::string s;
     for (auto item : dict_) {
         auto label = py::cast<std::string>(item.first);
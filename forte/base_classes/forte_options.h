@@ -59,6 +59,10 @@ namespace forte {
  * - value: the value of the option
  * - default_value: the default value given to the option
  * - description: a description of the option and what it controlss
+ *
+ * The getters and setters that take or return C++ types acquire the Python GIL, so they can be
+ * called from code that runs with the GIL released (see the bindings of compute_energy).
+ * Functions that return Python objects (e.g., get_gen_list) must be called with the GIL held.
  */
 class ForteOptions {
   public:
@@ -231,6 +235,7 @@ class ForteOptions {
      * @brief Get a general python list
      * @param label
      * @return a py list
+     * @note The caller must hold the GIL (py::gil_scoped_acquire) while using the list
      */
     py::list get_gen_list(const std::string& label) const;
 
@@ -32,6 +32,8 @@
 #include <vector>
 #include <ambit/tensor.h>
 
+#include "base_classes/sparse_rdm3.h"
+
 namespace forte {
 
 class ForteIntegrals;
@@ -144,6 +146,19 @@ class RDMs {
     /// @return the spin-free 3-cumulant
     ambit::Tensor SF_L3();
 
+    // Sparse 3-body density cumulants, keeping only the elements with |value| > threshold
+
+    /// @return the sparse alpha-alpha-alpha 3-RDC
+    SparseRDM3 sparse_L3aaa(double threshold) { return SparseRDM3(L3aaa(), threshold); }
+    /// @return the sparse alpha-alpha-beta 3-RDC
+    SparseRDM3 sparse_L3aab(double threshold) { return SparseRDM3(L3aab(), threshold); }
+    /// @return the sparse alpha-beta-beta 3-RDC
+    SparseRDM3 sparse_L3abb(double threshold) { return SparseRDM3(L3abb(), threshold); }
+    /// @return the sparse beta-beta-beta 3-RDC
+    SparseRDM3 sparse_L3bbb(double threshold) { return SparseRDM3(L3bbb(), threshold); }
+    /// @return the sparse spin-free 3-cumulant
+    SparseRDM3 sparse_SF_L3(double threshold) { return SparseRDM3(SF_L3(), threshold); }
+
     // class variables
 
     size_t max_rdm_level() { return max_rdm_; }
@@ -0,0 +1,178 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "helpers/disk_io.h"
+#include "base_classes/sparse_rdm3.h"
+
+namespace forte {
+
+SparseRDM3::SparseRDM3(const ambit::Tensor& dense, double threshold) : threshold_(threshold) {
+    const auto& dims = dense.dims();
+    if (dense.rank() != 6 or dims != std::vector<size_t>(6, dims[0])) {
+        throw std::runtime_error("SparseRDM3: the tensor must be of rank 6 with equal dimensions");
+    }
+    nact_ = dims[0];
+    const size_t block_size = nact_ * nact_ * nact_ * nact_ * nact_;
+    const auto& data = dense.data();
+
+    // count the elements of each block, then fill the blocks in parallel
+    offsets_.assign(nact_ + 1, 0);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t p = 0; p < nact_; ++p) {
+        const double* block = data.data() + p * block_size;
+        size_t count = 0;
+        for (size_t k = 0; k < block_size; ++k) {
+            count += std::fabs(block[k]) > threshold;
+        }
+        offsets_[p + 1] = count;
+    }
+    for (size_t p = 0; p < nact_; ++p) {
+        offsets_[p + 1] += offsets_[p];
+    }
+
+    indices_.resize(offsets_[nact_]);
+    values_.resize(offsets_[nact_]);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t p = 0; p < nact_; ++p) {
+        const double* block = data.data() + p * block_size;
+        size_t n = offsets_[p];
+        for (size_t k = 0; k < block_size; ++k) {
+            if (std::fabs(block[k]) > threshold) {
+                indices_[n] = k;
+                values_[n] = block[k];
+                n++;
+            }
+        }
+    }
+}
+
+SparseRDM3::SparseRDM3(TensorBlockReader& reader, double threshold) : threshold_(threshold) {
+    const auto& dims = reader.dims();
+    if (dims.size() != 6 or dims != std::vector<size_t>(6, dims[0])) {
+        throw std::runtime_error("SparseRDM3: the tensor must be of rank 6 with equal dimensions");
+    }
+    nact_ = dims[0];
+    offsets_.assign(1, 0);
+    std::vector<double> block;
+    for (size_t p = 0; p < nact_; ++p) {
+        reader.read_block(p, block);
+        push_block(block.data(), block.size());
+    }
+    indices_.shrink_to_fit();
+    values_.shrink_to_fit();
+}
+
+void SparseRDM3::push_block(const double* block, size_t block_size) {
+    for (size_t k = 0; k < block_size; ++k) {
+        if (std::fabs(block[k]) > threshold_) {
+            indices_.push_back(k);
+            values_.push_back(block[k]);
+        }
+    }
+    offsets_.push_back(values_.size());
+}
+
+double
+SparseRDM3::contract_blocked(const std::function<void(size_t, ambit::Tensor&)>& build_block) const {
+    auto block = ambit::Tensor::build(ambit::CoreTensor, "SparseRDM3 block",
+                                      std::vector<size_t>(5, nact_));
+    double result = 0.0;
+    for (size_t p = 0; p < nact_; ++p) {
+        const size_t begin = offsets_[p];
+        const size_t end = offsets_[p + 1];
+        if (begin == end) {
+            continue;
+        }
+        block.zero();
+        build_block(p, block);
+
+        const double* A = block.data().data();
+        double sum = 0.0;
+#pragma omp parallel for reduction(+ : sum)
+        for (size_t n = begin; n < end; ++n) {
+            sum += A[indices_[n]] * values_[n];
+        }
+        result += sum;
+    }
+    return result;
+}
+
+double SparseRDM3::dot_block(size_t p, const double* A) const {
+    double sum = 0.0;
+    for (size_t n = offsets_[p], end = offsets_[p + 1]; n < end; ++n) {
+        sum += A[indices_[n]] * values_[n];
+    }
+    return sum;
+}
+
+ambit::Tensor SparseRDM3::to_dense() const {
+    auto dense =
+        ambit::Tensor::build(ambit::CoreTensor, "SparseRDM3", std::vector<size_t>(6, nact_));
+    auto& data = dense.data();
+    const size_t block_size = nact_ * nact_ * nact_ * nact_ * nact_;
+    for (size_t p = 0; p < nact_; ++p) {
+        for (size_t n = offsets_[p]; n < offsets_[p + 1]; ++n) {
+            data[p * block_size + indices_[n]] = values_[n];
+        }
+    }
+    return dense;
+}
+
+ambit::Tensor fix_tensor_index(const ambit::Tensor& t, size_t axis, size_t value) {
+    const auto& dims = t.dims();
+    if (axis >= dims.size() or value >= dims[axis]) {
+        throw std::runtime_error("fix_tensor_index: index out of range");
+    }
+    size_t outer = 1;
+    for (size_t i = 0; i < axis; ++i) {
+        outer *= dims[i];
+    }
+    size_t inner = 1;
+    for (size_t i = axis + 1; i < dims.size(); ++i) {
+        inner *= dims[i];
+    }
+
+    std::vector<size_t> slice_dims(dims);
+    slice_dims.erase(slice_dims.begin() + axis);
+    auto slice = ambit::Tensor::build(ambit::CoreTensor, t.name() + " slice", slice_dims);
+
+    const auto& data = t.data();
+    auto& slice_data = slice.data();
+    for (size_t o = 0; o < outer; ++o) {
+        const size_t offset = (o * dims[axis] + value) * inner;
+        std::copy(data.begin() + offset, data.begin() + offset + inner,
+                  slice_data.begin() + o * inner);
+    }
+    return slice;
+}
+
+} // namespace forte
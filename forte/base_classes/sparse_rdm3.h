@@ -0,0 +1,122 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _sparse_rdm3_h_
+#define _sparse_rdm3_h_
+
+#include <functional>
+#include <vector>
+
+#include <ambit/tensor.h>
+
+namespace forte {
+
+class TensorBlockReader;
+
+/**
+ * @class SparseRDM3
+ *
+ * @brief Thresholded sparse storage of a rank-6 tensor of active indices, such as a 3-RDM or a
+ *        3-body density cumulant.
+ *
+ * Only the elements with |value| > threshold are stored, sorted by compound index. The elements
+ * that share the leading index p form one block, so that a contraction
+ *
+ *   E = sum_{pqrstu} A(pqrstu) L(pqrstu)
+ *
+ * can build A one slice A(p, ...) at a time (contract_blocked). The dense rank-6 intermediate is
+ * then never formed and the memory cost is nact^5 plus 16 bytes per stored element.
+ *
+ * The dense tensor may also be streamed from disk (see TensorBlockWriter) so that it is never
+ * held in memory as a whole.
+ */
+class SparseRDM3 {
+  public:
+    /// Build an empty tensor
+    SparseRDM3() = default;
+    /// Store the elements of the dense (CoreTensor) rank-6 tensor with |value| > threshold
+    SparseRDM3(const ambit::Tensor& dense, double threshold);
+    /**
+     * @brief Store the elements with |value| > threshold of a rank-6 tensor saved on disk
+     * @param reader the file written by TensorBlockWriter, read one block T(p, ...) at a time,
+     *        so that the peak memory is nact^5 plus the stored elements
+     */
+    SparseRDM3(TensorBlockReader& reader, double threshold);
+
+    /// @return the number of active orbitals
+    size_t nact() const { return nact_; }
+    /// @return the number of stored elements
+    size_t nnz() const { return values_.size(); }
+    /// @return the threshold used to discard the small elements
+    double threshold() const { return threshold_; }
+
+    /**
+     * @brief Contract with a tensor built one leading-index slice at a time
+     * @param build_block a function that adds A(p, ...) to block, a zeroed rank-5 CoreTensor of
+     *        dimension nact^5. It is called only for the values of p with stored elements
+     * @return sum_{pqrstu} A(pqrstu) L(pqrstu)
+     */
+    double contract_blocked(const std::function<void(size_t, ambit::Tensor&)>& build_block) const;
+
+    /// @return true if no element with leading index p is stored
+    bool empty_block(size_t p) const { return offsets_[p] == offsets_[p + 1]; }
+    /// @return sum_{qrstu} A(qrstu) L(pqrstu) for a dense slice A of dimension nact^5 (serial, so
+    ///         that different slices can be contracted by different threads)
+    double dot_block(size_t p, const double* A) const;
+
+    /// @return the dense tensor
+    ambit::Tensor to_dense() const;
+
+  private:
+    /// The number of active orbitals
+    size_t nact_ = 0;
+    /// The threshold used to discard the small elements
+    double threshold_ = 0.0;
+    /// The elements with leading index p are stored in [offsets_[p], offsets_[p + 1])
+    std::vector<size_t> offsets_;
+    /// The compound index qrstu of each element within its block
+    std::vector<size_t> indices_;
+    /// The value of each element
+    std::vector<double> values_;
+
+    /// Append the elements of the next block with |value| > threshold_ and close its offset range
+    void push_block(const double* block, size_t block_size);
+};
+
+/**
+ * @brief Copy the slice of a CoreTensor with one index fixed
+ * @param t the tensor
+ * @param axis the position of the fixed index
+ * @param value the value of the fixed index
+ * @return a CoreTensor of rank t.rank() - 1
+ */
+ambit::Tensor fix_tensor_index(const ambit::Tensor& t, size_t axis, size_t value);
+
+} // namespace forte
+
+#endif // _sparse_rdm3_h_
@@ -0,0 +1,257 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "wave_function_file.h"
+
+namespace forte {
+
+namespace {
+/// The file signature and format version
+constexpr char wave_function_file_magic[8] = {'F', 'O', 'R', 'T', 'E', 'W', 'F', 'N'};
+constexpr uint64_t wave_function_file_version = 1;
+
+/// The fields of the header, after the signature
+enum WaveFunctionFileHeader : size_t {
+    Version,
+    Norbs,
+    Nwords,
+    Nroot,
+    Ndets,
+    StateSize,
+    HeaderSize
+};
+
+/// The number of determinants packed and written at once
+constexpr size_t wave_function_file_batch = 65536;
+
+using word_t = Determinant::word_t;
+
+size_t padded_size(size_t n) { return sizeof(uint64_t) * ((n + 7) / sizeof(uint64_t)); }
+
+/// Read the text format of previous versions of Forte: two header lines, then one determinant
+/// (e.g., |220ab002>) and its coefficients per line
+WaveFunctionFile read_wave_function_text(const std::string& filename) {
+    std::ifstream file(filename);
+    std::string line;
+
+    WaveFunctionFile wfn;
+    std::getline(file, line);
+    wfn.state = line.substr(line.find(':') == std::string::npos ? 0 : line.find(':') + 2);
+
+    size_t ndets = 0, nroots = 0;
+    std::getline(file, line);
+    if (std::sscanf(line.c_str(), "%zu %zu", &ndets, &nroots) != 2) {
+        throw std::runtime_error("read_wave_function_file: " + filename +
+                                 " is not a wave function file");
+    }
+    wfn.dets.reserve(ndets);
+    wfn.evecs = std::make_shared<psi::Matrix>("evecs " + filename, ndets, nroots);
+
+    const std::string delimiter = ", ";
+    size_t I = 0;
+    while (std::getline(file, line) and (I < ndets)) {
+        size_t next = line.find(delimiter);
+        auto det_str = line.substr(0, next);
+        wfn.norbs = det_str.size() - 2;
+
+        std::vector<bool> alpha(wfn.norbs, false), beta(wfn.norbs, false);
+        for (size_t i = 0; i < wfn.norbs; ++i) {
+            char x = det_str[i + 1];
+            alpha[i] = (x == '2' or x == '+');
+            beta[i] = (x == '2' or x == '-');
+        }
+        wfn.dets.emplace_back(alpha, beta);
+
+        size_t last = next + 1, n = 0;
+        while ((next = line.find(delimiter, last)) != std::string::npos) {
+            wfn.evecs->set(I, n, std::stod(line.substr(last, next - last)));
+            n++;
+            last = next + 1;
+        }
+        wfn.evecs->set(I, n, std::stod(line.substr(last)));
+        I++;
+    }
+    return wfn;
+}
+} // namespace
+
+void write_wave_function_file(const std::string& filename, size_t norbs, const std::string& state,
+                              const std::vector<Determinant>& dets, size_t nroot,
+                              const std::function<void(size_t root, double* column)>& column) {
+    if (norbs > Determinant::nbits_half) {
+        throw std::runtime_error("write_wave_function_file: too many orbitals");
+    }
+    size_t ndets = dets.size();
+    size_t nwords = (norbs + Determinant::bits_per_word - 1) / Determinant::bits_per_word;
+    uint64_t header[HeaderSize];
+    header[Version] = wave_function_file_version;
+    header[Norbs] = norbs;
+    header[Nwords] = nwords;
+    header[Nroot] = nroot;
+    header[Ndets] = ndets;
+    header[StateSize] = state.size();
+
+    // write to a temporary file first, so that an interrupted write does not corrupt the file
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream out(tmp_filename, std::ios_base::binary);
+    out.write(wave_function_file_magic, sizeof(wave_function_file_magic));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    std::vector<char> label(padded_size(state.size()), '\0');
+    std::copy(state.begin(), state.end(), label.begin());
+    out.write(label.data(), label.size());
+
+    // the determinants, packed in batches
+    std::vector<word_t> words(2 * nwords * std::min(ndets, wave_function_file_batch));
+    for (size_t start = 0; start < ndets; start += wave_function_file_batch) {
+        size_t end = std::min(ndets, start + wave_function_file_batch);
+#pragma omp parallel for
+        for (size_t I = start; I < end; ++I) {
+            word_t* w = words.data() + 2 * nwords * (I - start);
+            for (size_t k = 0; k < nwords; ++k) {
+                w[k] = dets[I].get_word(k);
+                w[nwords + k] = dets[I].get_word(Determinant::nwords_half + k);
+            }
+        }
+        out.write(reinterpret_cast<const char*>(words.data()),
+                  2 * nwords * (end - start) * sizeof(word_t));
+    }
+
+    // the coefficients, one root at a time
+    std::vector<double> coefficients(ndets);
+    for (size_t n = 0; n < nroot; ++n) {
+        column(n, coefficients.data());
+        out.write(reinterpret_cast<const char*>(coefficients.data()), ndets * sizeof(double));
+    }
+    out.close();
+    if (not out or (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)) {
+        throw std::runtime_error("write_wave_function_file: cannot write " + filename);
+    }
+}
+
+void write_wave_function_file(const std::string& filename, size_t norbs, const std::string& state,
+                              const std::vector<Determinant>& dets, psi::SharedMatrix evecs) {
+    size_t ndets = dets.size();
+    size_t nroot = evecs->coldim();
+    write_wave_function_file(filename, norbs, state, dets, nroot, [&](size_t n, double* column) {
+        double** C = evecs->pointer();
+        for (size_t I = 0; I < ndets; ++I) {
+            column[I] = C[I][n];
+        }
+    });
+}
+
+WaveFunctionFile read_wave_function_file(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("read_wave_function_file: cannot open " + filename);
+    }
+    struct stat buf;
+    fstat(fd, &buf);
+    size_t file_size = static_cast<size_t>(buf.st_size);
+    const size_t header_bytes = sizeof(wave_function_file_magic) + HeaderSize * sizeof(uint64_t);
+    char magic[sizeof(wave_function_file_magic)];
+    if ((file_size < header_bytes) or (::read(fd, magic, sizeof(magic)) != sizeof(magic)) or
+        (std::memcmp(magic, wave_function_file_magic, sizeof(magic)) != 0)) {
+        // not a binary file, try the text format
+        ::close(fd);
+        return read_wave_function_text(filename);
+    }
+    void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("read_wave_function_file: cannot map " + filename);
+    }
+    madvise(addr, file_size, MADV_SEQUENTIAL);
+    const char* base = static_cast<const char*>(addr);
+    auto unmap = [&]() { munmap(addr, file_size); };
+
+    uint64_t header[HeaderSize];
+    std::memcpy(header, base + sizeof(wave_function_file_magic), sizeof(header));
+    size_t norbs = header[Norbs];
+    size_t nwords = header[Nwords];
+    size_t nroot = header[Nroot];
+    size_t ndets = header[Ndets];
+    size_t state_bytes = padded_size(header[StateSize]);
+    if (header[Version] != wave_function_file_version) {
+        unmap();
+        throw std::runtime_error("read_wave_function_file: " + filename +
+                                 " was written by an incompatible version of Forte");
+    }
+    if ((norbs > Determinant::nbits_half) or (nwords > Determinant::nwords_half)) {
+        unmap();
+        throw std::runtime_error("read_wave_function_file: " + filename +
+                                 " has more orbitals than allowed by MAX_DET_ORB");
+    }
+    if (file_size != header_bytes + state_bytes +
+                         ndets * (2 * nwords * sizeof(word_t) + nroot * sizeof(double))) {
+        unmap();
+        throw std::runtime_error("read_wave_function_file: " + filename + " is truncated");
+    }
+
+    WaveFunctionFile wfn;
+    wfn.norbs = norbs;
+    wfn.state = std::string(base + header_bytes, header[StateSize]);
+
+    const word_t* words = reinterpret_cast<const word_t*>(base + header_bytes + state_bytes);
+    wfn.dets.resize(ndets);
+#pragma omp parallel for
+    for (size_t I = 0; I < ndets; ++I) {
+        const word_t* w = words + 2 * nwords * I;
+        Determinant& d = wfn.dets[I];
+        for (size_t k = 0; k < nwords; ++k) {
+            d.set_word(k, w[k]);
+            d.set_word(Determinant::nwords_half + k, w[nwords + k]);
+        }
+    }
+
+    const double* coefficients = reinterpret_cast<const double*>(words + 2 * nwords * ndets);
+    wfn.evecs = std::make_shared<psi::Matrix>("evecs " + filename, ndets, nroot);
+    double** C = wfn.evecs->pointer();
+    for (size_t n = 0; n < nroot; ++n) {
+        const double* column = coefficients + n * ndets;
+#pragma omp parallel for
+        for (size_t I = 0; I < ndets; ++I) {
+            C[I][n] = column[I];
+        }
+    }
+    unmap();
+    return wfn;
+}
+
+} // namespace forte
@@ -0,0 +1,86 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _wave_function_file_h_
+#define _wave_function_file_h_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "psi4/libmints/matrix.h"
+
+#include "sparse_ci/determinant.h"
+
+namespace forte {
+
+/**
+ * @brief The content of a wave function file written by an ActiveSpaceMethod
+ *
+ * The file is a signature and a header of 64-bit integers (format version, number of orbitals,
+ * number of words per spin string, number of roots, number of determinants, length of the state
+ * label), followed by the state label (padded to 8 bytes), the determinants, and the
+ * coefficients. Each determinant is stored as the ceil(norbs / 64) words of its alpha string
+ * followed by those of its beta string, so the file does not depend on MAX_DET_ORB. The
+ * coefficients are stored root by root, each root as a contiguous column of ndets doubles.
+ * Every section is a multiple of 8 bytes and the file is read with mmap.
+ */
+struct WaveFunctionFile {
+    /// The number of active orbitals
+    size_t norbs = 0;
+    /// The label of the state (e.g., StateInfo::str())
+    std::string state;
+    /// The determinants
+    std::vector<Determinant> dets;
+    /// The coefficients, stored as a ndets x nroot matrix
+    psi::SharedMatrix evecs;
+};
+
+/// Write a wave function to a file. The file is replaced atomically.
+/// @param filename the name of the file
+/// @param norbs the number of active orbitals
+/// @param state the label of the state
+/// @param dets the determinants
+/// @param nroot the number of roots
+/// @param column a function that fills column (of size dets.size()) with the coefficients of a root
+void write_wave_function_file(const std::string& filename, size_t norbs, const std::string& state,
+                              const std::vector<Determinant>& dets, size_t nroot,
+                              const std::function<void(size_t root, double* column)>& column);
+
+/// Write a wave function to a file, with the coefficients stored as a ndets x nroot matrix
+void write_wave_function_file(const std::string& filename, size_t norbs, const std::string& state,
+                              const std::vector<Determinant>& dets, psi::SharedMatrix evecs);
+
+/// Read a wave function from a file. Files in the text format of previous versions of Forte (one
+/// determinant and its coefficients per line) are also accepted. Throws if the file cannot be
+/// read or if its determinants do not fit in this build (MAX_DET_ORB)
+WaveFunctionFile read_wave_function_file(const std::string& filename);
+
+} // namespace forte
+
+#endif // _wave_function_file_h_
@@ -50,6 +50,7 @@
 #include "sci/fci_mo.h"
 #include "orbital-helpers/mp2_nos.h"
 #include "orbital-helpers/orbitaloptimizer.h"
+#include "casscf/casscf_orb_grad.h"
 #include "orbital-helpers/semi_canonicalize.h"
 
 #ifdef HAVE_CHEMPS2
@@ -138,10 +139,10 @@ void CASSCF::startup() {
 
     Hcore_ = SharedMatrix(ints_->wfn()->H()->clone());
 
+    JK_ = ints_->jk();
     if (ints_->jk_status() != ForteIntegrals::JKStatus::initialized) {
         throw PSIEXCEPTION("CASSCF only supports Psi4 integrals. JK not initialized.");
     }
-    JK_ = ints_->jk();
     JK_->C_left().clear();
     JK_->C_right().clear();
 }
@@ -200,6 +201,18 @@ double CASSCF::compute_energy() {
 
     psi::SharedMatrix Ca = ints_->Ca();
 
+    // second-order orbital steps using the rotation kernel of CASSCF_ORB_GRAD
+    // (its orbitals are those of ForteIntegrals, i.e., Ca is updated in place)
+    bool do_ah = options_->get_str("ORB_ROTATION_ALGORITHM") == "AUGMENTED_HESSIAN";
+    int ah_maxiter = options_->get_int("CASSCF_AH_MICRO_MAXITER");
+    std::unique_ptr<CASSCF_ORB_GRAD> cas_grad;
+    psi::SharedVector R_ah, g_ah;
+    if (do_ah) {
+        cas_grad = std::make_unique<CASSCF_ORB_GRAD>(options_, mo_space_info_, ints_);
+        R_ah = std::make_shared<psi::Vector>("Orbital Rotation", cas_grad->nrot());
+        g_ah = std::make_shared<psi::Vector>("Orbital Gradient", cas_grad->nrot());
+    }
+
     print_h2("CASSCF Iteration");
     outfile->Printf("\n  iter    ||g||           Delta_E            E_CASSCF       CONV_TYPE");
 
@@ -234,6 +247,28 @@ double CASSCF::compute_energy() {
             outfile->Printf("\n\n CAS took %8.6f seconds.", cas_timer.get());
         }
 
+        if (do_ah) {
+            cas_grad->set_rdms(cas_ref_);
+            cas_grad->evaluate(R_ah, g_ah);
+            double g_norm = g_ah->rms();
+
+            Ediff = E_casscf_ - E_casscf_old;
+            if (iter > 1 && std::fabs(Ediff) < econv && g_norm < gconv) {
+                outfile->Printf("\n  %4d   %10.12f   %10.12f   %10.12f  %10.6f s", iter, g_norm,
+                                Ediff, E_casscf_, casscf_total_iter.get());
+                outfile->Printf("\n\n  A miracle has come to pass: "
+                                "CASSCF iterations have converged.");
+                break;
+            }
+
+            // Newton steps for the current RDMs, the orbitals are updated on exit
+            cas_grad->ah_minimize(R_ah, g_ah, 0.1 * gconv, ah_maxiter, rotation_max_value);
+
+            outfile->Printf("\n %4d %14.12f %18.12f %18.12f %6.1f s  %4s ~", iter, g_norm, Ediff,
+                            E_casscf_, casscf_total_iter.get(), "AH");
+            continue;
+        }
+
         CASSCFOrbitalOptimizer orbital_optimizer(gamma1_, gamma2_, tei_gaaa_, options_,
                                                  mo_space_info_, ints_);
 
@@ -659,12 +694,70 @@ std::shared_ptr<psi::Matrix> CASSCF::semicanonicalize(std::shared_ptr<psi::Matri
 }
 
 std::shared_ptr<psi::Matrix> CASSCF::build_fock(std::shared_ptr<psi::Matrix> Ca) {
-    auto F_i = build_fock_inactive(Ca);
-    auto F_a = build_fock_active(Ca);
+    // Implementation Notes (in AO basis)
+    // Same as build_fock_inactive + build_fock_active, but the inactive and the active densities
+    // are passed to a single JK build such that the integrals are traversed only once.
+
+    // grab part of Ca for inactive docc and active
+    auto Cdocc = std::make_shared<psi::Matrix>("C_INACTIVE", nirrep_, nsopi_, inactive_docc_dim_);
+    auto Cactv = std::make_shared<psi::Matrix>("C_ACTIVE", nirrep_, nsopi_, active_dim_);
+    for (size_t h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < inactive_docc_dim_[h]; i++) {
+            Cdocc->set_column(h, i, Ca->get_column(h, i));
+        }
+        int offset = frozen_docc_dim_[h] + restricted_docc_dim_[h];
+        for (int i = 0; i < active_dim_[h]; i++) {
+            Cactv->set_column(h, i, Ca->get_column(h, i + offset));
+        }
+    }
+
+    // put one-density to SharedMatrix form
+    auto Gamma1 = std::make_shared<psi::Matrix>("Gamma1", active_dim_, active_dim_);
+    const auto& gamma1_data = gamma1_.data();
+
+    for (size_t h = 0, offset = 0; h < nirrep_; ++h) {
+        for (int u = 0; u < active_dim_[h]; ++u) {
+            size_t nu = u + offset;
+            for (int v = 0; v < active_dim_[h]; ++v) {
+                size_t nv = v + offset;
+                Gamma1->set(h, u, v, gamma1_data[nu * nactv_ + nv]);
+            }
+        }
+        offset += active_dim_[h];
+    }
+
+    // dress Cactv by one-density, which will the C_right for JK
+    auto Cactv_dressed = linalg::doublet(Cactv, Gamma1, false, false);
+
+    // JK build
+    std::vector<std::shared_ptr<psi::Matrix>>& Cl = JK_->C_left();
+    std::vector<std::shared_ptr<psi::Matrix>>& Cr = JK_->C_right();
+
+    JK_->set_do_K(true);
+    Cl.clear();
+    Cr.clear();
+    Cl.push_back(Cdocc);
+    Cr.push_back(Cdocc);
+    Cl.push_back(Cactv);
+    Cr.push_back(Cactv_dressed);
+    JK_->compute();
+
+    // F = Hcore + 2 J[docc] - K[docc] + J[actv] - 0.5 K[actv]
+    std::shared_ptr<psi::Matrix> Fock = (JK_->J()[0])->clone();
+    Fock->scale(2.0);
+    Fock->subtract(JK_->K()[0]);
+    Fock->add(JK_->J()[1]);
+    Fock->axpy(-0.5, JK_->K()[1]);
+    Fock->add(Hcore_);
 
-    auto Fock = F_i->clone();
-    Fock->add(F_a);
+    // transform to MO
+    Fock->transform(Ca);
     Fock->set_name("Fock");
+
+    if (casscf_debug_print_) {
+        Fock->print();
+    }
+
     return Fock;
 }
 
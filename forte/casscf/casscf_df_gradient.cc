@@ -0,0 +1,451 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <array>
+#include <map>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
+#include "psi4/libmints/basisset.h"
+#include "psi4/libmints/integral.h"
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/mintshelper.h"
+#include "psi4/libmints/molecule.h"
+#include "psi4/libmints/twobody.h"
+#include "psi4/libmints/wavefunction.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libpsi4util/process.h"
+#include "psi4/libqt/qt.h"
+
+#include "helpers/timer.h"
+
+#include "casscf_df_gradient.h"
+
+using namespace psi;
+
+namespace forte {
+
+namespace {
+
+/// Back-transform the given columns (absolute MO indices) of C to the C1 AO basis
+SharedMatrix ao_orbitals(std::shared_ptr<Wavefunction> wfn, SharedMatrix C,
+                         const std::vector<size_t>& mos, const std::string& name) {
+    auto aotoso = wfn->aotoso();
+    int nao = aotoso->rowspi()[0];
+    int ncol = mos.size();
+
+    std::vector<std::pair<int, int>> mos_rel;
+    for (int h = 0; h < C->nirrep(); ++h) {
+        for (int i = 0; i < C->colspi()[h]; ++i) {
+            mos_rel.emplace_back(h, i);
+        }
+    }
+
+    auto Cao = std::make_shared<Matrix>(name, nao, ncol);
+    for (int k = 0; k < ncol; ++k) {
+        auto [h, i] = mos_rel[mos[k]];
+        int nso_h = aotoso->colspi()[h];
+        if (!nso_h)
+            continue;
+        C_DGEMV('N', nao, nso_h, 1.0, aotoso->pointer(h)[0], nso_h, &C->pointer(h)[0][i],
+                C->colspi()[h], 0.0, &Cao->pointer()[0][k], ncol);
+    }
+    return Cao;
+}
+
+/// Back-transform a totally symmetric SO-basis matrix to the C1 AO basis
+SharedMatrix ao_matrix(std::shared_ptr<Wavefunction> wfn, SharedMatrix M) {
+    auto aotoso = wfn->aotoso();
+    int nao = aotoso->rowspi()[0];
+
+    auto Mao = std::make_shared<Matrix>(M->name() + " (AO)", nao, nao);
+    for (int h = 0; h < M->nirrep(); ++h) {
+        int nso_h = M->rowspi()[h];
+        if (!nso_h)
+            continue;
+        std::vector<double> T(nao * nso_h);
+        C_DGEMM('N', 'N', nao, nso_h, nso_h, 1.0, aotoso->pointer(h)[0], nso_h, M->pointer(h)[0],
+                nso_h, 0.0, T.data(), nso_h);
+        C_DGEMM('N', 'T', nao, nao, nso_h, 1.0, T.data(), nso_h, aotoso->pointer(h)[0], nso_h,
+                1.0, Mao->pointer()[0], nao);
+    }
+    return Mao;
+}
+
+/**
+ * The two-electron gradient E2^x for E2 = sum_pqrs G_pqrs (pq|rs) with DF integrals
+ * (pq|rs) = sum_PQ (pq|P) [J^-1]_PQ (Q|rs) over the occupied (docc + active) orbitals:
+ *   E2^x = 2 sum_Pmn (P|mn)^x G_P^mn - sum_PQ (P|Q)^x V_PQ,
+ * where c_P^rs = sum_Q [J^-1]_PQ (Q|rs), G_P^pq = sum_rs G_pqrs c_P^rs, V_PQ = c_P . G_Q.
+ */
+SharedMatrix df_tei_gradient(std::shared_ptr<BasisSet> primary,
+                             std::shared_ptr<BasisSet> auxiliary, SharedMatrix Cocc,
+                             size_t ndocc, const std::vector<double>& D1,
+                             const std::vector<double>& D2, double& e2) {
+    size_t nao = primary->nbf();
+    size_t naux = auxiliary->nbf();
+    size_t nocc = Cocc->coldim();
+    size_t nactv = nocc - ndocc;
+    size_t nocc2 = nocc * nocc;
+    size_t na2 = nactv * nactv;
+    int natom = primary->molecule()->natom();
+    int nthread = omp_get_max_threads();
+    int max_nP = auxiliary->max_function_per_shell();
+    auto zero = BasisSet::zero_ao_basis_set();
+    double** Cp = Cocc->pointer();
+
+    // => (P|oo') <=
+    std::vector<double> b(naux * nocc2);
+    {
+        IntegralFactory factory(auxiliary, zero, primary, primary);
+        std::vector<std::shared_ptr<TwoBodyAOInt>> eri(nthread);
+        for (int t = 0; t < nthread; ++t) {
+            eri[t] = std::shared_ptr<TwoBodyAOInt>(factory.eri());
+        }
+
+#pragma omp parallel num_threads(nthread)
+        {
+            int thread = omp_get_thread_num();
+            std::vector<double> A(max_nP * nao * nao);
+            std::vector<double> AC(max_nP * nao * nocc);
+
+#pragma omp for schedule(dynamic)
+            for (int P = 0; P < auxiliary->nshell(); ++P) {
+                int nP = auxiliary->shell(P).nfunction();
+                int oP = auxiliary->shell(P).function_index();
+                for (int M = 0; M < primary->nshell(); ++M) {
+                    int nM = primary->shell(M).nfunction();
+                    int oM = primary->shell(M).function_index();
+                    for (int N = 0; N <= M; ++N) {
+                        int nN = primary->shell(N).nfunction();
+                        int oN = primary->shell(N).function_index();
+                        eri[thread]->compute_shell(P, 0, M, N);
+                        const double* buffer = eri[thread]->buffer();
+                        for (int p = 0; p < nP; ++p) {
+                            double* Ap = A.data() + p * nao * nao;
+                            for (int m = oM; m < oM + nM; ++m) {
+                                for (int n = oN; n < oN + nN; ++n) {
+                                    Ap[m * nao + n] = Ap[n * nao + m] = *buffer++;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                C_DGEMM('N', 'N', nP * nao, nocc, nao, 1.0, A.data(), nao, Cp[0], nocc, 0.0,
+                        AC.data(), nocc);
+                for (int p = 0; p < nP; ++p) {
+                    C_DGEMM('T', 'N', nocc, nocc, nao, 1.0, Cp[0], nocc, &AC[p * nao * nocc], nocc,
+                            0.0, &b[(p + oP) * nocc2], nocc);
+                }
+            }
+        }
+    }
+
+    // => fitting metric (P|Q) and c = J^-1 b <=
+    auto Jinv = std::make_shared<Matrix>("J^-1", naux, naux);
+    {
+        IntegralFactory factory(auxiliary, zero, auxiliary, zero);
+        std::vector<std::shared_ptr<TwoBodyAOInt>> eri(nthread);
+        for (int t = 0; t < nthread; ++t) {
+            eri[t] = std::shared_ptr<TwoBodyAOInt>(factory.eri());
+        }
+        double** Jp = Jinv->pointer();
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthread)
+        for (int P = 0; P < auxiliary->nshell(); ++P) {
+            int thread = omp_get_thread_num();
+            int nP = auxiliary->shell(P).nfunction();
+            int oP = auxiliary->shell(P).function_index();
+            for (int Q = 0; Q <= P; ++Q) {
+                int nQ = auxiliary->shell(Q).nfunction();
+                int oQ = auxiliary->shell(Q).function_index();
+                eri[thread]->compute_shell(P, 0, Q, 0);
+                const double* buffer = eri[thread]->buffer();
+                for (int p = oP; p < oP + nP; ++p) {
+                    for (int q = oQ; q < oQ + nQ; ++q) {
+                        Jp[p][q] = Jp[q][p] = *buffer++;
+                    }
+                }
+            }
+        }
+    }
+    Jinv->power(-1.0, 1.0e-10);
+
+    std::vector<double> c(naux * nocc2);
+    C_DGEMM('N', 'N', naux, nocc2, naux, 1.0, Jinv->pointer()[0], naux, b.data(), nocc2, 0.0,
+            c.data(), nocc2);
+    Jinv.reset();
+
+    // => G_P^pq <=
+    // G_pqrs = 1/2 (Dt_pq Dt_rs - Da_pq Da_rs) - 1/2 (Dc_qr Dm_ps + Dm_qr Dc_ps) + 1/2 D2_pqrs,
+    // with Dc the docc projector, Da the active 1-RDM, Dm = Dc + Da, and Dt = 2 Dc + Da
+    std::vector<double> Dc(nocc2, 0.0), Da(nocc2, 0.0);
+    for (size_t i = 0; i < ndocc; ++i) {
+        Dc[i * nocc + i] = 1.0;
+    }
+    for (size_t u = 0; u < nactv; ++u) {
+        for (size_t v = 0; v < nactv; ++v) {
+            Da[(u + ndocc) * nocc + v + ndocc] = D1[u * nactv + v];
+        }
+    }
+    std::vector<double> Dm(nocc2), Dt(nocc2);
+    for (size_t pq = 0; pq < nocc2; ++pq) {
+        Dm[pq] = Dc[pq] + Da[pq];
+        Dt[pq] = 2.0 * Dc[pq] + Da[pq];
+    }
+
+    std::vector<double> G(naux * nocc2);
+#pragma omp parallel num_threads(nthread)
+    {
+        std::vector<double> T(nocc2), ca(na2), ga(na2);
+
+#pragma omp for schedule(static)
+        for (size_t P = 0; P < naux; ++P) {
+            double* cP = &c[P * nocc2];
+            double* GP = &G[P * nocc2];
+
+            double gt = 0.0, gd = 0.0;
+            for (size_t rs = 0; rs < nocc2; ++rs) {
+                gt += Dt[rs] * cP[rs];
+                gd += Da[rs] * cP[rs];
+            }
+            for (size_t pq = 0; pq < nocc2; ++pq) {
+                GP[pq] = 0.5 * (Dt[pq] * gt - Da[pq] * gd);
+            }
+
+            C_DGEMM('N', 'N', nocc, nocc, nocc, 1.0, Dm.data(), nocc, cP, nocc, 0.0, T.data(),
+                    nocc);
+            C_DGEMM('N', 'N', nocc, nocc, nocc, -0.5, T.data(), nocc, Dc.data(), nocc, 1.0, GP,
+                    nocc);
+            C_DGEMM('N', 'N', nocc, nocc, nocc, 1.0, Dc.data(), nocc, cP, nocc, 0.0, T.data(),
+                    nocc);
+            C_DGEMM('N', 'N', nocc, nocc, nocc, -0.5, T.data(), nocc, Dm.data(), nocc, 1.0, GP,
+                    nocc);
+
+            if (nactv) {
+                for (size_t x = 0; x < nactv; ++x) {
+                    for (size_t y = 0; y < nactv; ++y) {
+                        ca[x * nactv + y] = cP[(x + ndocc) * nocc + y + ndocc];
+                    }
+                }
+                C_DGEMV('N', na2, na2, 0.5, const_cast<double*>(D2.data()), na2, ca.data(), 1, 0.0,
+                        ga.data(), 1);
+                for (size_t u = 0; u < nactv; ++u) {
+                    for (size_t v = 0; v < nactv; ++v) {
+                        GP[(u + ndocc) * nocc + v + ndocc] += ga[u * nactv + v];
+                    }
+                }
+            }
+        }
+    }
+
+    e2 = C_DDOT(naux * nocc2, b.data(), 1, G.data(), 1);
+    b.clear();
+    b.shrink_to_fit();
+
+    std::vector<double> V(naux * naux);
+    C_DGEMM('N', 'T', naux, naux, nocc2, 1.0, c.data(), nocc2, G.data(), nocc2, 0.0, V.data(),
+            naux);
+    c.clear();
+    c.shrink_to_fit();
+
+    std::vector<std::vector<double>> grad_t(nthread, std::vector<double>(3 * natom, 0.0));
+
+    // => 2 sum_Pmn (P|mn)^x G_P^mn <=
+    {
+        IntegralFactory factory(auxiliary, zero, primary, primary);
+        std::vector<std::shared_ptr<TwoBodyAOInt>> eri(nthread);
+        for (int t = 0; t < nthread; ++t) {
+            eri[t] = std::shared_ptr<TwoBodyAOInt>(factory.eri(1));
+        }
+
+#pragma omp parallel num_threads(nthread)
+        {
+            int thread = omp_get_thread_num();
+            auto& gr = grad_t[thread];
+            std::vector<double> GC(nao * nocc);
+            std::vector<double> Gao(max_nP * nao * nao);
+
+#pragma omp for schedule(dynamic)
+            for (int P = 0; P < auxiliary->nshell(); ++P) {
+                int nP = auxiliary->shell(P).nfunction();
+                int oP = auxiliary->shell(P).function_index();
+                int aP = auxiliary->shell(P).ncenter();
+
+                // G_p^mn = C_mo G_p^oo' C_no'
+                for (int p = 0; p < nP; ++p) {
+                    C_DGEMM('N', 'N', nao, nocc, nocc, 1.0, Cp[0], nocc, &G[(p + oP) * nocc2],
+                            nocc, 0.0, GC.data(), nocc);
+                    C_DGEMM('N', 'T', nao, nao, nocc, 1.0, GC.data(), nocc, Cp[0], nocc, 0.0,
+                            &Gao[p * nao * nao], nao);
+                }
+
+                for (int M = 0; M < primary->nshell(); ++M) {
+                    int nM = primary->shell(M).nfunction();
+                    int oM = primary->shell(M).function_index();
+                    int aM = primary->shell(M).ncenter();
+                    for (int N = 0; N <= M; ++N) {
+                        int nN = primary->shell(N).nfunction();
+                        int oN = primary->shell(N).function_index();
+                        int aN = primary->shell(N).ncenter();
+
+                        eri[thread]->compute_shell_deriv1(P, 0, M, N);
+                        const double* buffer = eri[thread]->buffer();
+                        size_t delta = nP * nM * nN;
+                        double perm = (M == N) ? 2.0 : 4.0;
+
+                        std::array<double, 9> d{};
+                        for (int p = 0, pmn = 0; p < nP; ++p) {
+                            const double* Gp = &Gao[p * nao * nao];
+                            for (int m = oM; m < oM + nM; ++m) {
+                                for (int n = oN; n < oN + nN; ++n, ++pmn) {
+                                    double g = perm * Gp[m * nao + n];
+                                    for (int k = 0; k < 9; ++k) {
+                                        d[k] += g * buffer[k * delta + pmn];
+                                    }
+                                }
+                            }
+                        }
+                        for (int k = 0; k < 3; ++k) {
+                            gr[3 * aP + k] += d[k];
+                            gr[3 * aM + k] += d[3 + k];
+                            gr[3 * aN + k] += d[6 + k];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // => - sum_PQ (P|Q)^x V_PQ <=
+    {
+        IntegralFactory factory(auxiliary, zero, auxiliary, zero);
+        std::vector<std::shared_ptr<TwoBodyAOInt>> eri(nthread);
+        for (int t = 0; t < nthread; ++t) {
+            eri[t] = std::shared_ptr<TwoBodyAOInt>(factory.eri(1));
+        }
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthread)
+        for (int P = 0; P < auxiliary->nshell(); ++P) {
+            int thread = omp_get_thread_num();
+            auto& gr = grad_t[thread];
+            int nP = auxiliary->shell(P).nfunction();
+            int oP = auxiliary->shell(P).function_index();
+            int aP = auxiliary->shell(P).ncenter();
+            for (int Q = 0; Q <= P; ++Q) {
+                int nQ = auxiliary->shell(Q).nfunction();
+                int oQ = auxiliary->shell(Q).function_index();
+                int aQ = auxiliary->shell(Q).ncenter();
+
+                eri[thread]->compute_shell_deriv1(P, 0, Q, 0);
+                const double* buffer = eri[thread]->buffer();
+                size_t delta = nP * nQ;
+                double perm = (P == Q) ? -1.0 : -2.0;
+
+                std::array<double, 6> d{};
+                for (int p = oP, pq = 0; p < oP + nP; ++p) {
+                    for (int q = oQ; q < oQ + nQ; ++q, ++pq) {
+                        double v = perm * V[p * naux + q];
+                        for (int k = 0; k < 6; ++k) {
+                            d[k] += v * buffer[k * delta + pq];
+                        }
+                    }
+                }
+                for (int k = 0; k < 3; ++k) {
+                    gr[3 * aP + k] += d[k];
+                    gr[3 * aQ + k] += d[3 + k];
+                }
+            }
+        }
+    }
+
+    auto grad = std::make_shared<Matrix>("Two-Electron Gradient (DF)", natom, 3);
+    for (int t = 0; t < nthread; ++t) {
+        for (int A = 0; A < natom; ++A) {
+            for (int k = 0; k < 3; ++k) {
+                grad->add(A, k, grad_t[t][3 * A + k]);
+            }
+        }
+    }
+    return grad;
+}
+} // namespace
+
+SharedMatrix compute_df_casscf_gradient(std::shared_ptr<Wavefunction> wfn, SharedMatrix C,
+                                        const std::vector<size_t>& docc_mos,
+                                        const std::vector<size_t>& actv_mos,
+                                        const std::vector<double>& D1,
+                                        const std::vector<double>& D2, int print) {
+    local_timer timer;
+    outfile->Printf("\n    Computing DF gradient in core ...");
+
+    std::vector<size_t> occ_mos(docc_mos);
+    occ_mos.insert(occ_mos.end(), actv_mos.begin(), actv_mos.end());
+    auto Cocc = ao_orbitals(wfn, C, occ_mos, "C occupied (AO)");
+
+    auto primary = wfn->basisset();
+    auto auxiliary = wfn->get_basisset("DF_BASIS_MP2");
+    auto molecule = primary->molecule();
+
+    // one-electron parts: Dt = Da + Db and the Lagrangian W (both total densities)
+    auto Dt = ao_matrix(wfn, wfn->Da());
+    Dt->add(ao_matrix(wfn, wfn->Db()));
+    auto W = ao_matrix(wfn, wfn->lagrangian());
+
+    MintsHelper mints(primary);
+    std::map<std::string, SharedMatrix> grads;
+    grads["Nuclear"] = std::make_shared<Matrix>(
+        molecule->nuclear_repulsion_energy_deriv1(std::array<double, 3>{0.0, 0.0, 0.0}));
+    grads["Kinetic"] = mints.kinetic_grad(Dt);
+    grads["Potential"] = mints.potential_grad(Dt);
+    grads["Overlap"] = mints.overlap_grad(W);
+    grads["Overlap"]->scale(-1.0);
+
+    double e2 = 0.0;
+    grads["Two-Electron"] =
+        df_tei_gradient(primary, auxiliary, Cocc, docc_mos.size(), D1, D2, e2);
+
+    auto grad = std::make_shared<Matrix>("Total Gradient", molecule->natom(), 3);
+    for (const auto& pair : grads) {
+        grad->add(pair.second);
+        if (print > 1)
+            pair.second->print();
+    }
+    outfile->Printf(" Done. Timing %15.6f s", timer.get());
+    outfile->Printf("\n    Two-electron energy from the DF gradient densities: %20.12f", e2);
+
+    return grad;
+}
+} // namespace forte
@@ -0,0 +1,66 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _casscf_df_gradient_h_
+#define _casscf_df_gradient_h_
+
+#include <memory>
+#include <vector>
+
+namespace psi {
+class Matrix;
+class Wavefunction;
+} // namespace psi
+
+namespace forte {
+
+/**
+ * Compute the CASSCF nuclear gradient in core with density-fitted two-electron integrals.
+ *
+ * The two-electron part contracts the core (separable) and active 2-RDM contributions with the
+ * three-index derivative integrals (A|mn)^x and the metric derivative (A|B)^x, so no MO TPDM
+ * is written, sorted, or back-transformed on disk. The one-electron, overlap, and nuclear
+ * repulsion parts use the densities and the Lagrangian already pushed to the wave function.
+ * Frozen orbitals (Z-vector contributions) are not supported.
+ * @param wfn the Psi4 wave function holding Da, Db, and the (SO basis) Lagrangian
+ * @param C the MO coefficients in the SO basis
+ * @param docc_mos the absolute indices of the doubly occupied orbitals
+ * @param actv_mos the absolute indices of the active orbitals
+ * @param D1 the spin-summed active 1-RDM
+ * @param D2 the spin-summed active 2-RDM in chemists' notation: E = 1/2 D2_uvxy (uv|xy)
+ * @param print the print level
+ * @return the total gradient (natom x 3)
+ */
+std::shared_ptr<psi::Matrix>
+compute_df_casscf_gradient(std::shared_ptr<psi::Wavefunction> wfn, std::shared_ptr<psi::Matrix> C,
+                           const std::vector<size_t>& docc_mos, const std::vector<size_t>& actv_mos,
+                           const std::vector<double>& D1, const std::vector<double>& D2,
+                           int print);
+} // namespace forte
+
+#endif // _casscf_df_gradient_h_
@@ -16,11 +16,13 @@
 #include "psi4/psifiles.h"
 #include "psi4/libpsio/psio.hpp"
 #include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libpsi4util/process.h"
 
 #include "helpers/printing.h"
 #include "base_classes/active_space_solver.h"
 
 #include "casscf/casscf.h"
+#include "casscf/casscf_df_gradient.h"
 #include "gradient_tpdm/backtransform_tpdm.h"
 
 using namespace ambit;
@@ -229,9 +231,34 @@ void CASSCF::tpdm_backtransform() {
  */
 SharedMatrix CASSCF::compute_gradient() {
     print_method_banner({"Complete Active Space Self Consistent Field Gradient", "Shuhe Wang"});
+    psi::Process::environment.arrays.erase("FORTE DF GRADIENT");
     set_all_variables();
     write_lagrangian();
     write_1rdm_spin_dependent();
+
+    // contract the densities with DF derivative integrals in core, no TPDM on disk
+    auto int_type = ints_->integral_type();
+    if (options_->get_bool("CASSCF_DF_GRADIENT") and (int_type == DF or int_type == DiskDF) and
+        nfdocc_ == 0 and mo_space_info_->size("FROZEN_UOCC") == 0) {
+        auto D1 = ambit::Tensor::build(CoreTensor, "D1", {nactv_, nactv_});
+        D1("pq") = cas_ref_.g1a()("pq");
+        D1("pq") += cas_ref_.g1b()("pq");
+
+        // chemists' notation, E = 1/2 D2_uvxy (uv|xy)
+        auto D2 = ambit::Tensor::build(CoreTensor, "D2", {nactv_, nactv_, nactv_, nactv_});
+        D2("pqrs") = cas_ref_.SFg2()("prqs");
+        D2("pqrs") += cas_ref_.SFg2()("qrps");
+        D2.scale(0.5);
+
+        auto grad = compute_df_casscf_gradient(ints_->wfn(), ints_->Ca(), core_mos_abs_,
+                                               actv_mos_abs_, D1.data(), D2.data(), print_);
+        ints_->wfn()->set_gradient(grad);
+        psi::Process::environment.arrays["FORTE DF GRADIENT"] = grad;
+
+        outfile->Printf("\n    Computing Gradient .............................. Done\n");
+        return grad;
+    }
+
     write_2rdm_spin_dependent();
     tpdm_backtransform();
 
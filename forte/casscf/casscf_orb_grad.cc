@@ -26,7 +26,10 @@
  * @END LICENSE
  */
 
+#include <cmath>
 #include <ctype.h>
+#include <numeric>
+#include <set>
 
 #include "psi4/psi4-dec.h"
 #include "psi4/psifiles.h"
@@ -170,6 +173,12 @@ void CASSCF_ORB_GRAD::read_options() {
     debug_print_ = options_->get_bool("CASSCF_DEBUG_PRINTING");
 
     g_conv_ = options_->get_double("CASSCF_G_CONVERGENCE");
+    hess_vec_step_ = options_->get_double("CASSCF_HESS_VEC_STEP");
+
+    auto int_type = ints_->integral_type();
+    df_tei_ = options_->get_bool("CASSCF_DF_TEI") and
+              (int_type == DF or int_type == DiskDF or int_type == Cholesky);
+    df_grad_ = options_->get_bool("CASSCF_DF_GRADIENT") and (int_type == DF or int_type == DiskDF);
 
     internal_rot_ = options_->get_bool("CASSCF_INTERNAL_ROT");
 
@@ -177,6 +186,7 @@ void CASSCF_ORB_GRAD::read_options() {
 
     // zero rotations
     zero_rots_.resize(nirrep_);
+    py::gil_scoped_acquire gil;
     auto zero_rots = options_->get_gen_list("CASSCF_ZERO_ROT");
 
     if (zero_rots.size() != 0) {
@@ -375,6 +385,17 @@ void CASSCF_ORB_GRAD::nonredundant_pairs() {
 
     nrot_ = rot_mos_irrep_.size();
 
+    // orbitals involved in the rotations, all other orbitals are never changed
+    std::vector<std::set<size_t>> rot_orbs(nirrep_);
+    for (const auto& hij : rot_mos_irrep_) {
+        rot_orbs[std::get<0>(hij)].insert(std::get<1>(hij));
+        rot_orbs[std::get<0>(hij)].insert(std::get<2>(hij));
+    }
+    rot_orbs_irrep_.resize(nirrep_);
+    for (int h = 0; h < nirrep_; ++h) {
+        rot_orbs_irrep_[h].assign(rot_orbs[h].begin(), rot_orbs[h].end());
+    }
+
     // printing
     std::map<std::string, std::string> space_map{
         {"c", "RESTRICTED_DOCC"}, {"a", "ACTIVE"}, {"v", "RESTRICTED_UOCC"}};
@@ -446,12 +467,14 @@ void CASSCF_ORB_GRAD::init_tensors() {
 }
 
 void CASSCF_ORB_GRAD::build_mo_integrals() {
-    // form closed-shell Fock matrix
-    build_fock_inactive();
+    // form closed-shell and active Fock matrices
+    build_fock_inactive_active();
 
     // form the MO 2e-integrals
     if (ints_->integral_type() == Custom) {
         fill_tei_custom(V_);
+    } else if (df_tei_) {
+        build_tei_from_df();
     } else {
         build_tei_from_ao();
     }
@@ -591,13 +614,109 @@ void CASSCF_ORB_GRAD::build_tei_from_ao() {
     timer_off("Build (pu|xy) integrals");
 }
 
+void CASSCF_ORB_GRAD::build_tei_from_df() {
+    // This function builds (pu|xy) = sum_Q B'(Q|pu) B'(Q|xy) from the three-index integrals,
+    // where B'(Q|pq) = sum_rs U_rp U_sq B(Q|rs) and B is in the initial correlated MO basis.
+    // Only B and U are needed: no AO integrals or JK builds in every macro iteration.
+    timer_on("Build (pu|xy) integrals");
+
+    // correlated block of U in C1 symmetry (frozen orbitals are not rotated)
+    auto Uc = std::make_shared<psi::Matrix>("U correlated", ncmo_, ncmo_);
+    for (int h = 0, offset = 0; h < nirrep_; ++h) {
+        for (int r = 0; r < ncmopi_[h]; ++r) {
+            for (int p = 0; p < ncmopi_[h]; ++p) {
+                Uc->set(r + offset, p + offset, U_->get(h, r + nfrzcpi_[h], p + nfrzcpi_[h]));
+            }
+        }
+        offset += ncmopi_[h];
+    }
+
+    const auto& actv_cmos = label_to_cmos_["a"];
+    auto Ua = std::make_shared<psi::Matrix>("U active", ncmo_, nactv_);
+    for (size_t r = 0; r < ncmo_; ++r) {
+        for (size_t u = 0; u < nactv_; ++u) {
+            Ua->set(r, u, Uc->get(r, actv_cmos[u]));
+        }
+    }
+
+    size_t naux = ints_->nthree();
+    size_t nactv2 = nactv_ * nactv_;
+    size_t nactv3 = nactv2 * nactv_;
+    size_t ngu = ncmo_ * nactv_;
+
+    // figure out the batch size of auxiliary indices
+    size_t mem_sys = psi::Process::environment.get_memory() * 0.85;
+    size_t mem_fixed = ngu * nactv2 * sizeof(double);
+    size_t mem_per_aux = (ncmo_ * ncmo_ + 2 * ngu + nactv2) * sizeof(double);
+    if (mem_sys < mem_fixed + mem_per_aux) {
+        outfile->Printf("\n  Error: Not enough memory to build (pu|xy) from DF integrals.");
+        throw std::runtime_error("Not enough memory for DF (pu|xy). Try CASSCF_DF_TEI false.");
+    }
+    size_t aux_batch = std::min(naux, (mem_sys - mem_fixed) / mem_per_aux);
+
+    std::vector<size_t> cmos(ncmo_);
+    std::iota(cmos.begin(), cmos.end(), 0);
+
+    std::vector<double> W(ngu * nactv2, 0.0);
+    std::vector<double> T, Bp, Bxy;
+
+    for (size_t Q0 = 0; Q0 < naux; Q0 += aux_batch) {
+        size_t nQ = std::min(aux_batch, naux - Q0);
+        std::vector<size_t> Qs(nQ);
+        std::iota(Qs.begin(), Qs.end(), Q0);
+
+        // T(Qr,u) = sum_s B(Qr,s) U(s,u)
+        T.resize(nQ * ngu);
+        {
+            auto B = ints_->three_integral_block(Qs, cmos, cmos);
+            C_DGEMM('N', 'N', nQ * ncmo_, nactv_, ncmo_, 1.0, B.data().data(), ncmo_,
+                    Ua->pointer()[0], nactv_, 0.0, T.data(), nactv_);
+        }
+
+        // B'(Q,pu) = sum_r U(r,p) T(Qr,u)
+        Bp.resize(nQ * ngu);
+        Bxy.resize(nQ * nactv2);
+#pragma omp parallel for
+        for (size_t Q = 0; Q < nQ; ++Q) {
+            C_DGEMM('T', 'N', ncmo_, nactv_, ncmo_, 1.0, Uc->pointer()[0], ncmo_, &T[Q * ngu],
+                    nactv_, 0.0, &Bp[Q * ngu], nactv_);
+            for (size_t x = 0; x < nactv_; ++x) {
+                auto start = Bp.begin() + Q * ngu + actv_cmos[x] * nactv_;
+                std::copy(start, start + nactv_, Bxy.begin() + Q * nactv2 + x * nactv_);
+            }
+        }
+
+        // (pu|xy) += sum_Q B'(Q,pu) B'(Q,xy)
+        C_DGEMM('T', 'N', ngu, nactv2, nQ, 1.0, Bp.data(), ngu, Bxy.data(), nactv2, 1.0,
+                W.data(), nactv2);
+    }
+
+    // fill V_, frozen orbitals are not included in B
+    for (const std::string& space : {"c", "a", "v"}) {
+        const auto& mos = label_to_cmos_[space];
+        if (mos.empty())
+            continue;
+        auto& data = V_.block(space + "aaa").data();
+        for (size_t i = 0, size = mos.size(); i < size; ++i) {
+            auto start = W.begin() + mos[i] * nactv3;
+            std::copy(start, start + nactv3, data.begin() + i * nactv3);
+        }
+    }
+
+    timer_off("Build (pu|xy) integrals");
+}
+
 void CASSCF_ORB_GRAD::build_fock(bool rebuild_inactive) {
     if (rebuild_inactive) {
-        build_fock_inactive();
+        build_fock_inactive_active();
     }
 
-    build_fock_active();
+    // the active Fock is reused if neither the orbitals nor the 1RDM have changed
+    if (not fock_active_valid_) {
+        build_fock_active();
+    }
 
+    Fock_ = F_active_->clone();
     Fock_->add(F_closed_);
     Fock_->set_name("Fock_MO");
 
@@ -648,11 +767,32 @@ void CASSCF_ORB_GRAD::build_fock_active() {
     // F_active = D_{uv}^{active} * ( (uv|rs) - 0.5 * (us|rv) )
     // D_{uv}^{active} = \sum_{xy}^{active} C_{ux} * C_{vy} * Gamma1_{xy}
 
-    Fock_ = ints_->make_fock_active_restricted(rdm1_);
-    Fock_->set_name("Fock_active");
+    F_active_ = ints_->make_fock_active_restricted(rdm1_);
+    F_active_->set_name("Fock_active");
+    fock_active_valid_ = true;
 
     if (debug_print_) {
-        Fock_->print();
+        F_active_->print();
+    }
+}
+
+void CASSCF_ORB_GRAD::build_fock_inactive_active() {
+    // same as build_fock_inactive and build_fock_active, but both densities go to one JK build
+    auto Ftuple = ints_->make_fock_inactive_active_restricted(psi::Dimension(nirrep_), ndoccpi_,
+                                                              rdm1_);
+    std::tie(F_closed_, F_active_, e_closed_) = Ftuple;
+    F_closed_->set_name("Fock_inactive");
+    F_active_->set_name("Fock_active");
+    fock_active_valid_ = true;
+
+    // put into Ambit BlockedTensor format
+    format_fock(F_closed_, Fc_);
+
+    if (debug_print_) {
+        F_closed_->print();
+        F_active_->print();
+        outfile->Printf("\n  Frozen-core energy   %20.15f", ints_->frozen_core_energy());
+        outfile->Printf("\n  Closed-shell energy  %20.15f", e_closed_);
     }
 }
 
@@ -713,7 +853,7 @@ bool CASSCF_ORB_GRAD::update_orbitals(psi::SharedVector x) {
     R_->add(dR);
 
     // U_new = U_old * exp(dR)
-    U_ = psi::linalg::doublet(U_, matrix_exponential(dR, 3), false, false);
+    U_ = psi::linalg::doublet(U_, matrix_exponential(dR), false, false);
     U_->set_name("Orthogonal Transformation");
 
     // update orbitals
@@ -732,24 +872,49 @@ bool CASSCF_ORB_GRAD::update_orbitals(psi::SharedVector x) {
     return true;
 }
 
-psi::SharedMatrix CASSCF_ORB_GRAD::matrix_exponential(psi::SharedMatrix A, int n) {
+psi::SharedMatrix CASSCF_ORB_GRAD::matrix_exponential(psi::SharedMatrix A) {
+    /* exp(A) ~ D^{-1} N, where N = 1 + A / 2 + A^2 / 12 and D = 1 - A / 2 + A^2 / 12.
+     * The error is O(A^5) (compared to O(A^4) for the third-order Taylor series) and, since
+     * D = N^T commutes with N for a skew-symmetric A, D^{-1} N is orthogonal by construction.
+     * Only the block of orbitals involved in the nonredundant rotations is exponentiated.
+     */
     auto U = std::make_shared<psi::Matrix>("U = exp(A)", A->rowspi(), A->colspi());
     U->identity();
-    U->add(A);
 
-    if (n > 1) {
-        auto M = A->clone();
-        M->set_name("M");
+    for (int h = 0; h < nirrep_; ++h) {
+        const auto& orbs = rot_orbs_irrep_[h];
+        int n = orbs.size();
+        if (n == 0)
+            continue;
+
+        auto Ah = std::make_shared<psi::Matrix>("A", n, n);
+        for (int p = 0; p < n; ++p) {
+            for (int q = 0; q < n; ++q) {
+                Ah->set(p, q, A->get(h, orbs[p], orbs[q]));
+            }
+        }
+        if (Ah->absmax() == 0.0)
+            continue;
+
+        auto N = psi::linalg::doublet(Ah, Ah, false, false);
+        N->scale(1.0 / 12.0);
+        auto D = N->clone();
+        N->axpy(0.5, Ah);
+        D->axpy(-0.5, Ah);
+        for (int p = 0; p < n; ++p) {
+            N->add(p, p, 1.0);
+            D->add(p, p, 1.0);
+        }
+        D->general_invert();
 
-        for (int i = 1; i < n; ++i) {
-            auto B = psi::linalg::doublet(M, A, false, false);
-            B->scale(1.0 / (i + 1));
-            U->add(B);
-            M->copy(B);
+        auto Uh = psi::linalg::doublet(D, N, false, false);
+        for (int p = 0; p < n; ++p) {
+            for (int q = 0; q < n; ++q) {
+                U->set(h, orbs[p], orbs[q], Uh->get(p, q));
+            }
         }
     }
 
-    U->schmidt();
     return U;
 }
 
@@ -787,6 +952,185 @@ void CASSCF_ORB_GRAD::hess_diag(psi::SharedVector, psi::SharedVector h0) {
     h0->copy(*hess_diag_);
 }
 
+void CASSCF_ORB_GRAD::hess_vec(psi::SharedVector v, psi::SharedVector hv) {
+    hv->zero();
+    double v_norm = v->norm();
+    if (v_norm == 0.0)
+        return;
+    double delta = hess_vec_step_ / v_norm;
+
+    // save the current orbital rotation
+    auto R0 = R_->clone();
+    auto U0 = U_->clone();
+
+    auto x0 = std::make_shared<psi::Vector>("x0", nrot_);
+    for (size_t n = 0; n < nrot_; ++n) {
+        int h, i, j;
+        std::tie(h, i, j) = rot_mos_irrep_[n];
+        x0->set(n, R0->get(h, i, j));
+    }
+
+    // H * v = [g(x + delta * v) - g(x - delta * v)] / (2 * delta)
+    auto x = std::make_shared<psi::Vector>("x", nrot_);
+    auto g = std::make_shared<psi::Vector>("g", nrot_);
+    for (double sign : {1.0, -1.0}) {
+        R_->copy(R0);
+        U_->copy(U0);
+        x->copy(*x0);
+        x->axpy(sign * delta, *v);
+        evaluate(x, g);
+        hv->axpy(0.5 * sign / delta, *g);
+    }
+
+    // restore the orbitals and the quantities that depend on them
+    R_->copy(R0);
+    U_->copy(U0);
+    C_->gemm(false, false, 1.0, C0_, U_, 0.0);
+    if (ints_->integral_type() == Custom)
+        ints_->update_orbitals(C_, C_);
+    build_mo_integrals();
+    compute_reference_energy();
+    build_fock();
+    compute_orbital_grad();
+}
+
+std::tuple<double, int, bool> CASSCF_ORB_GRAD::ah_minimize(psi::SharedVector R,
+                                                           psi::SharedVector g, double epsilon,
+                                                           int maxiter, double max_rot) {
+    const size_t nrot = nrot_;
+    const size_t max_subspace = 10;
+
+    auto h0 = std::make_shared<psi::Vector>("Diagonal Hessian", nrot);
+    auto step = std::make_shared<psi::Vector>("AH Step", nrot);
+    auto hstep = std::make_shared<psi::Vector>("H * Step", nrot);
+    auto residual = std::make_shared<psi::Vector>("AH Residual", nrot);
+    auto R_old = std::make_shared<psi::Vector>("R Old", nrot);
+
+    double energy = evaluate(R, g);
+    double trust = max_rot;
+    int n_hv = 0;
+    bool converged = false;
+
+    for (int iter = 0; iter < maxiter; ++iter) {
+        double g_norm = g->norm();
+        if (g_norm <= epsilon * std::max(1.0, R->norm())) {
+            converged = true;
+            break;
+        }
+
+        hess_diag(R, h0);
+        auto precondition = [&](size_t k, double shift) {
+            double denom = h0->get(k) - shift;
+            return std::fabs(denom) > 1.0e-4 ? denom : (denom < 0.0 ? -1.0e-4 : 1.0e-4);
+        };
+
+        // Davidson iterations for the lowest root of the augmented Hessian
+        std::vector<psi::SharedVector> bs, sigmas;
+        auto b = std::make_shared<psi::Vector>("b", nrot);
+        for (size_t k = 0; k < nrot; ++k) {
+            b->set(k, -g->get(k) / precondition(k, 0.0));
+        }
+        b->scale(1.0 / b->norm());
+
+        for (size_t n = 0; n < max_subspace; ++n) {
+            auto sigma = std::make_shared<psi::Vector>("sigma", nrot);
+            hess_vec(b, sigma);
+            n_hv += 1;
+            bs.push_back(b);
+            sigmas.push_back(sigma);
+
+            size_t m = bs.size();
+            auto M = std::make_shared<psi::Matrix>("Augmented Hessian", m + 1, m + 1);
+            for (size_t i = 0; i < m; ++i) {
+                double gb = g->vector_dot(*bs[i]);
+                M->set(0, i + 1, gb);
+                M->set(i + 1, 0, gb);
+                for (size_t j = 0; j <= i; ++j) {
+                    double hij = bs[i]->vector_dot(*sigmas[j]) + bs[j]->vector_dot(*sigmas[i]);
+                    hij *= 0.5;
+                    M->set(i + 1, j + 1, hij);
+                    M->set(j + 1, i + 1, hij);
+                }
+            }
+            auto evecs = std::make_shared<psi::Matrix>("AH Eigenvectors", m + 1, m + 1);
+            auto evals = std::make_shared<psi::Vector>("AH Eigenvalues", m + 1);
+            M->diagonalize(evecs, evals);
+
+            // step = sum_i c_i b_i / c_0, residual = H * step + g - lambda * step
+            double lambda = evals->get(0);
+            double c0 = evecs->get(0, 0);
+            step->zero();
+            hstep->zero();
+            for (size_t i = 0; i < m; ++i) {
+                step->axpy(evecs->get(i + 1, 0) / c0, *bs[i]);
+                hstep->axpy(evecs->get(i + 1, 0) / c0, *sigmas[i]);
+            }
+            residual->copy(*hstep);
+            residual->add(*g);
+            residual->axpy(-lambda, *step);
+
+            double r_norm = residual->norm();
+            if (debug_print_) {
+                psi::outfile->Printf("\n    AH Davidson %2zu: lambda = %13.6e; |r| = %10.3e", m,
+                                     lambda, r_norm);
+            }
+            if (r_norm < 0.1 * g_norm or r_norm < epsilon or m == max_subspace)
+                break;
+
+            // new trial vector from the preconditioned residual
+            b = std::make_shared<psi::Vector>("b", nrot);
+            for (size_t k = 0; k < nrot; ++k) {
+                b->set(k, -residual->get(k) / precondition(k, lambda));
+            }
+            for (int pass = 0; pass < 2; ++pass) {
+                for (const auto& bi : bs) {
+                    b->axpy(-bi->vector_dot(*b), *bi);
+                }
+            }
+            double b_norm = b->norm();
+            if (b_norm < 1.0e-8)
+                break;
+            b->scale(1.0 / b_norm);
+        }
+
+        // restrict the step to the trust region
+        double max_step = 0.0;
+        for (size_t k = 0; k < nrot; ++k) {
+            max_step = std::max(max_step, std::fabs(step->get(k)));
+        }
+        double scale = max_step > trust ? trust / max_step : 1.0;
+        step->scale(scale);
+        hstep->scale(scale);
+        double de_pred = g->vector_dot(*step) + 0.5 * step->vector_dot(*hstep);
+
+        // take the step and adjust the trust radius
+        R_old->copy(*R);
+        R->add(*step);
+        double e_new = evaluate(R, g);
+        double de = e_new - energy;
+        if (print_ > 0) {
+            psi::outfile->Printf("\n  AH Iter:%3d; fx = %20.15f; g_norm = %12.6e; step = %9.3e",
+                                 iter + 1, e_new, g->norm(), scale * max_step);
+        }
+
+        if (de > 0.0) {
+            // reject the step
+            trust *= 0.5;
+            R->copy(*R_old);
+            energy = evaluate(R, g);
+            continue;
+        }
+        if (de_pred < 0.0 and de / de_pred > 0.75 and scale < 1.0)
+            trust = std::min(2.0 * trust, max_rot);
+        energy = e_new;
+    }
+
+    if (not converged)
+        converged = g->norm() <= epsilon * std::max(1.0, R->norm());
+
+    return {energy, n_hv, converged};
+}
+
 void CASSCF_ORB_GRAD::compute_orbital_hess_diag() {
     // modified diagonal Hessian from Theor. Chem. Acc. 97, 88-95 (1997)
 
@@ -928,6 +1272,7 @@ void CASSCF_ORB_GRAD::format_1rdm() {
         }
         offset += nactvpi_[h];
     }
+    fock_active_valid_ = false;
 
     if (debug_print_) {
         rdm1_->print();
@@ -30,6 +30,7 @@
 #define _casscf_orb_grad_h_
 
 #include <map>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -69,6 +70,33 @@ class CASSCF_ORB_GRAD {
     /// Evaluate the diagonal orbital Hessian
     void hess_diag(psi::SharedVector x, psi::SharedVector h0);
 
+    /**
+     * @brief Evaluate the orbital Hessian-vector product for fixed RDMs
+     * @param v: the trial orbital rotation vector
+     * @param hv: the Hessian-vector product
+     *
+     * The product is obtained by central differences of the analytic gradient along v, where
+     * each gradient requires the JK builds for the Fock matrices and the (pu|xy) integrals.
+     * The current orbitals, integrals, and gradient are restored on exit.
+     */
+    void hess_vec(psi::SharedVector v, psi::SharedVector hv);
+
+    /**
+     * @brief Optimize orbitals for fixed RDMs using augmented-Hessian Newton steps
+     * @param R: the orbital rotation vector, updated on exit
+     * @param g: the orbital gradient at the final R
+     * @param epsilon: the gradient convergence criterion (same as L-BFGS)
+     * @param maxiter: the max number of augmented-Hessian steps
+     * @param max_rot: the max element of a step (initial trust radius)
+     * @return <energy, number of Hessian-vector products, converged or not>
+     *
+     * The lowest root of the augmented Hessian [[0, g^T], [g, H]] is found by Davidson
+     * iterations preconditioned with the diagonal Hessian, using exact Hessian-vector products.
+     * This is the second-order kernel shared by MCSCF_2STEP and the CASSCF driver.
+     */
+    std::tuple<double, int, bool> ah_minimize(psi::SharedVector R, psi::SharedVector g,
+                                              double epsilon, int maxiter, double max_rot);
+
     /// Set RDMs used for orbital optimization
     void set_rdms(RDMs& rdms);
 
@@ -171,6 +199,8 @@ class CASSCF_ORB_GRAD {
     size_t nrot_;
     /// List of rotation pairs in <irrep, index1, index2> format
     std::vector<std::tuple<int, size_t, size_t>> rot_mos_irrep_;
+    /// Orbitals (relative indices per irrep) that appear in any rotation pair
+    std::vector<std::vector<size_t>> rot_orbs_irrep_;
     /// List of rotation pairs in <block, index1, index2> format
     std::vector<std::tuple<std::string, size_t, size_t>> rot_mos_block_;
 
@@ -184,6 +214,13 @@ class CASSCF_ORB_GRAD {
     /// Orbital gradient convergence criteria
     double g_conv_;
 
+    /// Step size (norm of the orbital displacement) for Hessian-vector products
+    double hess_vec_step_;
+    /// Build (pu|xy) from the MO three-index integrals instead of JK
+    bool df_tei_;
+    /// Compute the nuclear gradient in core with DF derivative integrals
+    bool df_grad_;
+
     /// Keep internal (GASn-GASn) rotations
     bool internal_rot_;
     /// If the active space is from GAS
@@ -206,6 +243,10 @@ class CASSCF_ORB_GRAD {
     /// The inactive Fock matrix in MO basis
     psi::SharedMatrix F_closed_; // nmo x nmo
     ambit::BlockedTensor Fc_;    // ncmo x ncmo
+    /// The active Fock matrix in MO basis
+    psi::SharedMatrix F_active_; // nmo x nmo
+    /// If F_active_ is consistent with the current orbitals and 1RDM
+    bool fock_active_valid_ = false;
     /// The generalized Fock matrix in MO basis
     psi::SharedMatrix Fock_; // nmo x nmo
     ambit::BlockedTensor F_; // ncmo x ncmo
@@ -252,6 +293,8 @@ class CASSCF_ORB_GRAD {
 
     /// Build two-electron integrals
     void build_tei_from_ao();
+    /// Build two-electron integrals from the three-index integrals (DF/CD only)
+    void build_tei_from_df();
 
     /// Fill two-electron integrals for custom integrals
     void fill_tei_custom(ambit::BlockedTensor V);
@@ -265,6 +308,8 @@ class CASSCF_ORB_GRAD {
     void build_fock_inactive();
     /// Build the active Fock (does depend on 1RDM)
     void build_fock_active();
+    /// Build the inactive and the active Fock matrices using a single JK build
+    void build_fock_inactive_active();
 
     /// Compute the energy for given sets of orbitals and density
     void compute_reference_energy();
@@ -348,8 +393,9 @@ class CASSCF_ORB_GRAD {
     /// Fix redundant orbitals and return the rotation matrix
     std::shared_ptr<psi::Matrix> canonicalize();
 
-    /// Compute the exponential of a skew-symmetric matrix
-    psi::SharedMatrix matrix_exponential(psi::SharedMatrix A, int n);
+    /// Compute the exponential of a skew-symmetric rotation matrix using the [2/2] Pade
+    /// approximant, which is exactly orthogonal. Only the rotated orbitals are included.
+    psi::SharedMatrix matrix_exponential(psi::SharedMatrix A);
 
     /// Grab part of the orbital coefficients
     psi::SharedMatrix C_subset(const std::string& name, psi::SharedMatrix C,
@@ -29,12 +29,14 @@
 #include "psi4/libiwl/iwl.hpp"
 #include "psi4/libmints/wavefunction.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libpsi4util/process.h"
 #include "psi4/psifiles.h"
 
 #include "helpers/printing.h"
 #include "helpers/lbfgs/lbfgs.h"
 
 #include "gradient_tpdm/backtransform_tpdm.h"
+#include "casscf/casscf_df_gradient.h"
 #include "casscf/casscf_orb_grad.h"
 #include "casscf/cpscf.h"
 
@@ -45,6 +47,7 @@ namespace forte {
 
 void CASSCF_ORB_GRAD::compute_nuclear_gradient() {
     print_h2("MCSCF Gradient");
+    psi::Process::environment.arrays.erase("FORTE DF GRADIENT");
 
     // format A to SharedMatrix
     Am_ = std::make_shared<psi::Matrix>("A (MCSCF)", nmopi_, nmopi_);
@@ -58,6 +61,11 @@ void CASSCF_ORB_GRAD::compute_nuclear_gradient() {
         // setup MOs and sanity check
         setup_grad_frozen();
 
+        // frozen rows of (pu|xy) are not available from the correlated DF integrals
+        if (df_tei_) {
+            build_tei_from_ao();
+        }
+
         // compute frozen part of the A matrix
         build_Am_frozen();
 
@@ -77,6 +85,16 @@ void CASSCF_ORB_GRAD::compute_nuclear_gradient() {
     // back-transform 1-RDM
     compute_opdm_ao();
 
+    // contract the densities with DF derivative integrals in core, no TPDM on disk
+    if (df_grad_ and not is_frozen_orbs_) {
+        auto grad = compute_df_casscf_gradient(ints_->wfn(), C_, core_mos_, actv_mos_,
+                                               D1_.block("aa").data(), D2_.block("aaaa").data(),
+                                               debug_print_ ? 2 : print_);
+        ints_->wfn()->set_gradient(grad);
+        psi::Process::environment.arrays["FORTE DF GRADIENT"] = grad;
+        return;
+    }
+
     // dump 2-RDM to disk
     dump_tpdm_iwl();
 
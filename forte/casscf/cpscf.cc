@@ -26,6 +26,8 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 
@@ -64,15 +66,147 @@ bool CPSCF_SOLVER::solve() {
 
 psi::SharedMatrix CPSCF_SOLVER::x() { return cpscf_.vec_to_mat(x_); }
 
+CPSCF_BLOCK_SOLVER::CPSCF_BLOCK_SOLVER(std::shared_ptr<ForteOptions> options,
+                                       std::shared_ptr<psi::JK> JK, psi::SharedMatrix C,
+                                       const std::vector<psi::SharedMatrix>& bs,
+                                       psi::SharedVector edocc, psi::SharedVector euocc)
+    : options_(options), cpscf_(JK, C, edocc, euocc) {
+    for (const auto& b : bs) {
+        bs_.push_back(cpscf_.mat_to_vec(b));
+    }
+}
+
+bool CPSCF_BLOCK_SOLVER::solve() {
+    // preconditioned conjugate gradient for all R.H.S., A is symmetric positive definite
+    double epsilon = options_->get_double("CPSCF_CONVERGENCE");
+    int maxiter = options_->get_int("CPSCF_MAXITER");
+    int print = options_->get_int("PRINT");
+
+    print_h2("Solving CP-SCF Equations (" + std::to_string(bs_.size()) + " R.H.S.)");
+
+    size_t nrhs = bs_.size();
+    auto h0 = std::make_shared<psi::Vector>("CPSCF Hessian diagonal", cpscf_.vdimpi());
+    cpscf_.hess_diag(h0, h0);
+
+    auto precondition = [&](psi::SharedVector r) {
+        auto z = std::make_shared<psi::Vector>(*r);
+        for (int h = 0; h < z->nirrep(); ++h) {
+            for (int i = 0; i < z->dimpi()[h]; ++i) {
+                z->set(h, i, r->get(h, i) / h0->get(h, i));
+            }
+        }
+        return z;
+    };
+
+    // x = 0, r = b, z = D^-1 r, p = z
+    std::vector<psi::SharedVector> rs, zs, ps;
+    std::vector<double> rzs(nrhs);
+    xs_.clear();
+    for (size_t n = 0; n < nrhs; ++n) {
+        auto x = std::make_shared<psi::Vector>("CPSCF x " + std::to_string(n), cpscf_.vdimpi());
+        xs_.push_back(x);
+        auto r = std::make_shared<psi::Vector>(*bs_[n]);
+        auto z = precondition(r);
+        rzs[n] = r->vector_dot(*z);
+        rs.push_back(r);
+        zs.push_back(z);
+        ps.push_back(std::make_shared<psi::Vector>(*z));
+    }
+
+    std::vector<bool> converged(nrhs, false);
+    auto test_convergence = [&](size_t n) {
+        double r_norm = rs[n]->norm();
+        double x_norm = xs_[n]->norm();
+        return r_norm <= epsilon * std::max(1.0, x_norm);
+    };
+    for (size_t n = 0; n < nrhs; ++n) {
+        converged[n] = test_convergence(n);
+    }
+
+    if (print > 0) {
+        psi::outfile->Printf("\n    Iter.   Max. Residual   Converged");
+        psi::outfile->Printf("\n    --------------------------------");
+    }
+
+    int iter = 1;
+    for (; iter <= maxiter; ++iter) {
+        std::vector<size_t> active;
+        for (size_t n = 0; n < nrhs; ++n) {
+            if (not converged[n])
+                active.push_back(n);
+        }
+        if (active.empty())
+            break;
+
+        // one JK build for all unconverged R.H.S.
+        std::vector<psi::SharedMatrix> Ps;
+        for (size_t n : active) {
+            Ps.push_back(cpscf_.vec_to_mat(ps[n]));
+        }
+        auto APs = cpscf_.compute_Ax(Ps);
+
+        double max_r = 0.0;
+        for (size_t k = 0, nk = active.size(); k < nk; ++k) {
+            size_t n = active[k];
+            auto ap = cpscf_.mat_to_vec(APs[k]);
+
+            double alpha = rzs[n] / ps[n]->vector_dot(*ap);
+            xs_[n]->axpy(alpha, *ps[n]);
+            rs[n]->axpy(-alpha, *ap);
+
+            converged[n] = test_convergence(n);
+            max_r = std::max(max_r, rs[n]->norm());
+            if (converged[n])
+                continue;
+
+            zs[n] = precondition(rs[n]);
+            double rz = rs[n]->vector_dot(*zs[n]);
+            double beta = rz / rzs[n];
+            rzs[n] = rz;
+
+            ps[n]->scale(beta);
+            ps[n]->add(*zs[n]);
+        }
+
+        if (print > 0) {
+            int nconv = std::count(converged.begin(), converged.end(), true);
+            psi::outfile->Printf("\n    %4d   %13.6e   %4d/%-4zu", iter, max_r, nconv, nrhs);
+        }
+    }
+
+    bool all_converged = std::all_of(converged.begin(), converged.end(), [](bool c) { return c; });
+    if (all_converged) {
+        psi::outfile->Printf("\n  CP-SCF converged in %d iterations.", iter - 1);
+    } else {
+        psi::outfile->Printf("\n  CP-SCF did not converge in %d iterations!", maxiter);
+    }
+
+    return all_converged;
+}
+
+std::vector<psi::SharedMatrix> CPSCF_BLOCK_SOLVER::x() {
+    std::vector<psi::SharedMatrix> out;
+    for (const auto& x : xs_) {
+        out.push_back(cpscf_.vec_to_mat(x));
+    }
+    return out;
+}
+
 CPSCF::CPSCF(std::shared_ptr<psi::JK> JK, psi::SharedMatrix C, psi::SharedMatrix b,
              psi::SharedVector edocc, psi::SharedVector euocc)
+    : CPSCF(JK, C, edocc, euocc) {
+    if (b->nirrep() != nirrep_)
+        throw std::runtime_error("Inconsistent nirrep for b vector");
+    b_ = mat_to_vec(b);
+}
+
+CPSCF::CPSCF(std::shared_ptr<psi::JK> JK, psi::SharedMatrix C, psi::SharedVector edocc,
+             psi::SharedVector euocc)
     : JK_(JK), C_(C), edocc_(edocc), euocc_(euocc) {
 
     // set up basic stuff
     nirrep_ = C->nirrep();
 
-    if (b->nirrep() != nirrep_)
-        throw std::runtime_error("Inconsistent nirrep for b vector");
     if (edocc->nirrep() != nirrep_ or euocc->nirrep() != nirrep_)
         throw std::runtime_error("Inconsistent nirrep for orbital energies vectors");
 
@@ -98,43 +232,50 @@ CPSCF::CPSCF(std::shared_ptr<psi::JK> JK, psi::SharedMatrix C, psi::SharedMatrix
         dims.push_back(ndoccpi_[h] * nuoccpi_[h]);
     }
     vdims_ = psi::Dimension(dims);
-
-    b_ = mat_to_vec(b);
 }
 
-double CPSCF::evaluate(psi::SharedVector x, psi::SharedVector g, bool do_g) {
-    auto X = vec_to_mat(x);
-
+std::vector<psi::SharedMatrix> CPSCF::compute_Ax(const std::vector<psi::SharedMatrix>& Xs) {
     // contract X with Roothaan-Bagus supermatrix
     // AX_{ai} = [4 * (ai|bj) - (ab|ji) - (aj|bi)] * X_{bj}
-    auto Cdressed = psi::linalg::doublet(Cuocc_, X, false, false);
-
+    // all X share one JK build
     JK_->set_do_K(true);
     std::vector<std::shared_ptr<psi::Matrix>>& Cls = JK_->C_left();
     std::vector<std::shared_ptr<psi::Matrix>>& Crs = JK_->C_right();
     Cls.clear();
     Crs.clear();
-    Cls.push_back(Cdressed);
-    Crs.push_back(Cdocc_);
+    for (const auto& X : Xs) {
+        Cls.push_back(psi::linalg::doublet(Cuocc_, X, false, false));
+        Crs.push_back(Cdocc_);
+    }
     JK_->compute();
 
-    auto J = JK_->J()[0];
-    J->scale(4.0);
-    J->subtract(JK_->K()[0]);
-    J->subtract((JK_->K()[0])->transpose());
-
-    auto AX = psi::linalg::triplet(Cuocc_, J, Cdocc_, true, false, false);
-
-    // add contribution of orbital energy difference: AX_{ai} += (e_a - e_i) * X_{ai}
-    for (int h = 0; h < nirrep_; ++h) {
-        for (int a = 0; a < nuoccpi_[h]; ++a) {
-            for (int i = 0; i < ndoccpi_[h]; ++i) {
-                double value = (euocc_->get(h, a) - edocc_->get(h, i)) * X->get(h, a, i);
-                AX->add(h, a, i, value);
+    std::vector<psi::SharedMatrix> AXs;
+    for (size_t n = 0, nX = Xs.size(); n < nX; ++n) {
+        auto J = JK_->J()[n];
+        J->scale(4.0);
+        J->subtract(JK_->K()[n]);
+        J->subtract((JK_->K()[n])->transpose());
+
+        auto AX = psi::linalg::triplet(Cuocc_, J, Cdocc_, true, false, false);
+
+        // add contribution of orbital energy difference: AX_{ai} += (e_a - e_i) * X_{ai}
+        for (int h = 0; h < nirrep_; ++h) {
+            for (int a = 0; a < nuoccpi_[h]; ++a) {
+                for (int i = 0; i < ndoccpi_[h]; ++i) {
+                    double value = (euocc_->get(h, a) - edocc_->get(h, i)) * Xs[n]->get(h, a, i);
+                    AX->add(h, a, i, value);
+                }
             }
         }
+        AXs.push_back(AX);
     }
 
+    return AXs;
+}
+
+double CPSCF::evaluate(psi::SharedVector x, psi::SharedVector g, bool do_g) {
+    auto AX = compute_Ax({vec_to_mat(x)})[0];
+
     // reshape Ax to vector
     auto ax = mat_to_vec(AX);
 
@@ -29,6 +29,8 @@
 #ifndef _cpscf_h_
 #define _cpscf_h_
 
+#include <vector>
+
 #include "psi4/libfock/jk.h"
 #include "psi4/libmints/matrix.h"
 #include "psi4/libmints/vector.h"
@@ -50,6 +52,19 @@ class CPSCF {
     CPSCF(std::shared_ptr<psi::JK> JK, psi::SharedMatrix C, psi::SharedMatrix b,
           psi::SharedVector edocc, psi::SharedVector euocc);
 
+    /**
+     * @brief Constructor of CPSCF_FUNCTOR without a R.H.S. (for compute_Ax only)
+     * @param JK: The pointer to a Psi4 JK object
+     * @param C: The Hartree-Fock orbital coefficients
+     * @param edocc: The occupied orbital energies
+     * @param euocc: The unoccupied orbital energies
+     */
+    CPSCF(std::shared_ptr<psi::JK> JK, psi::SharedMatrix C, psi::SharedVector edocc,
+          psi::SharedVector euocc);
+
+    /// Compute A * X for a set of trial matrices (nuocc x ndocc) with a single JK build
+    std::vector<psi::SharedMatrix> compute_Ax(const std::vector<psi::SharedMatrix>& Xs);
+
     /// Evaluate the scalar and gradient
     double evaluate(psi::SharedVector x, psi::SharedVector g, bool do_g = true);
 
@@ -129,6 +144,44 @@ class CPSCF_SOLVER {
     /// The CPSCF object
     CPSCF cpscf_;
 };
+
+class CPSCF_BLOCK_SOLVER {
+  public:
+    /**
+     * @brief Constructor of CPSCF_BLOCK_SOLVER
+     *
+     * Solve Ax = b for several R.H.S. (e.g., perturbations or states) with preconditioned
+     * conjugate gradient, where the A * p products of all R.H.S. share one JK build.
+     *
+     * @param options: The ForteOptions pointer
+     * @param JK: The pointer to a Psi4 JK object
+     * @param C: The Hartree-Fock orbital coefficients
+     * @param bs: The R.H.S. of CPSCF equations Ax = b (nuocc x ndocc)
+     * @param edocc: The occupied orbital energies
+     * @param euocc: The unoccupied orbital energies
+     */
+    CPSCF_BLOCK_SOLVER(std::shared_ptr<ForteOptions> options, std::shared_ptr<psi::JK> JK,
+                       psi::SharedMatrix C, const std::vector<psi::SharedMatrix>& bs,
+                       psi::SharedVector edocc, psi::SharedVector euocc);
+
+    /// Solve CPSCF equations and return if all equations are converged or not
+    bool solve();
+
+    /// Return the unknowns in matrix form
+    std::vector<psi::SharedMatrix> x();
+
+  private:
+    /// The R.H.S. in vector form
+    std::vector<psi::SharedVector> bs_;
+    /// The unknowns in vector form
+    std::vector<psi::SharedVector> xs_;
+
+    /// The Forte options
+    std::shared_ptr<ForteOptions> options_;
+
+    /// The CPSCF object
+    CPSCF cpscf_;
+};
 } // namespace forte
 
 #endif // _cpscf_h_
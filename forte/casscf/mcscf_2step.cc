@@ -26,6 +26,10 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsi4util/process.h"
@@ -37,6 +41,7 @@
 
 #include "base_classes/rdms.h"
 #include "integrals/integrals.h"
+#include "helpers/compressed_diis.h"
 #include "helpers/printing.h"
 #include "helpers/lbfgs/lbfgs.h"
 #include "helpers/lbfgs/lbfgs_param.h"
@@ -92,9 +97,14 @@ void MCSCF_2STEP::read_options() {
     orb_type_redundant_ = options_->get_str("CASSCF_FINAL_ORBITAL");
 
     ci_type_ = options_->get_str("CASSCF_CI_SOLVER");
+    ci_warm_start_ = options_->get_bool("CASSCF_CI_WARM_START");
+    ci_conv_factor_ = options_->get_double("CASSCF_CI_CONV_FACTOR");
+    sci_rdm_truncation_ = options_->get_double("CASSCF_SCI_RDM_TRUNCATION");
 
     opt_orbs_ = not options_->get_bool("CASSCF_NO_ORBOPT");
     max_rot_ = options_->get_double("CASSCF_MAX_ROTATION");
+    orb_rot_algorithm_ = options_->get_str("ORB_ROTATION_ALGORITHM");
+    ah_maxiter_ = options_->get_int("CASSCF_AH_MICRO_MAXITER");
     internal_rot_ = options_->get_bool("CASSCF_INTERNAL_ROT");
 
     // DIIS options
@@ -102,6 +112,7 @@ void MCSCF_2STEP::read_options() {
     diis_start_ = options_->get_int("CASSCF_DIIS_START");
     diis_max_vec_ = options_->get_int("CASSCF_DIIS_MAX_VEC");
     diis_min_vec_ = options_->get_int("CASSCF_DIIS_MIN_VEC");
+    diis_storage_ = options_->get_str("CASSCF_DIIS_STORAGE");
     do_diis_ = (diis_start_ < 1) ? false : true;
 }
 
@@ -113,26 +124,36 @@ void MCSCF_2STEP::print_options() {
         {"Max number of micro iterations", micro_maxiter_},
         {"Min number of micro iterations", micro_miniter_}};
 
-    std::vector<std::pair<std::string, double>> info_double{{"Energy convergence", e_conv_},
-                                                            {"Gradient convergence", g_conv_},
-                                                            {"Max value for rotation", max_rot_}};
+    std::vector<std::pair<std::string, double>> info_double{
+        {"Energy convergence", e_conv_},
+        {"Gradient convergence", g_conv_},
+        {"CI convergence factor", ci_conv_factor_},
+        {"SCI RDM truncation", sci_rdm_truncation_},
+        {"Max value for rotation", max_rot_}};
 
     std::vector<std::pair<std::string, std::string>> info_string{
         {"Integral type", int_type_},
         {"CI solver type", ci_type_},
         {"Final orbital type", orb_type_redundant_},
+        {"Orbital rotation algorithm", orb_rot_algorithm_},
         {"Derivative type", der_type_}};
 
     std::vector<std::pair<std::string, bool>> info_bool{
         {"Optimize orbitals", opt_orbs_},
         {"Include internal rotations", internal_rot_},
+        {"Warm start CI", ci_warm_start_},
         {"Debug printing", debug_print_}};
 
+    if (orb_rot_algorithm_ == "AUGMENTED_HESSIAN") {
+        info_int.push_back({"Max number of AH steps", ah_maxiter_});
+    }
+
     if (do_diis_) {
         info_int.push_back({"DIIS start", diis_start_});
         info_int.push_back({"Min DIIS vectors", diis_min_vec_});
         info_int.push_back({"Max DIIS vectors", diis_max_vec_});
         info_int.push_back({"Frequency of DIIS extrapolation", diis_freq_});
+        info_string.push_back({"DIIS storage", diis_storage_});
     }
 
     // print some information
@@ -145,6 +166,7 @@ double MCSCF_2STEP::compute_energy() {
     CASSCF_ORB_GRAD cas_grad(options_, mo_space_info_, ints_);
     auto nrot = cas_grad.nrot();
     auto dG = std::make_shared<psi::Vector>("dG", nrot);
+    auto g = std::make_shared<psi::Vector>("g", nrot);
 
     // set up initial guess for rotation matrix (R = 0)
     auto R = std::make_shared<psi::Vector>("R", nrot);
@@ -156,7 +178,7 @@ double MCSCF_2STEP::compute_energy() {
 
     if (not opt_orbs_ or nrot == 0) {
         std::tie(as_solver, energy_) = diagonalize_hamiltonian(
-            cas_grad.active_space_ints(), {print_, e_conv_, r_conv, false, false});
+            cas_grad.active_space_ints(), {print_, e_conv_, r_conv, false, false, false});
         auto rdms = as_solver->compute_average_rdms(state_weights_map_, 2);
         cas_grad.set_rdms(rdms);
         cas_grad.evaluate(R, dG);
@@ -169,11 +191,22 @@ double MCSCF_2STEP::compute_energy() {
     // DIIS extropolation for macro iteration
     psi::DIISManager diis_manager(do_diis_ ? diis_max_vec_ : 0, "MCSCF DIIS",
                                   psi::DIISManager::RemovalPolicy::OldestAdded, psi::DIISManager::StoragePolicy::OnDisk);
+    std::unique_ptr<CompressedDIIS> compressed_diis;
     if (do_diis_) {
         dR = std::make_shared<psi::Vector>("dR", nrot);
-        diis_manager.set_error_vector_size(1, psi::DIISEntry::InputType::Vector, dR.get());
-        diis_manager.set_vector_size(1, psi::DIISEntry::InputType::Vector, R.get());
+        if (diis_storage_ == "PSI4") {
+            diis_manager.set_error_vector_size(1, psi::DIISEntry::InputType::Vector, dR.get());
+            diis_manager.set_vector_size(1, psi::DIISEntry::InputType::Vector, R.get());
+        } else {
+            auto precision = CompressedDIIS::precision_from_string(diis_storage_);
+            compressed_diis = std::make_unique<CompressedDIIS>(
+                "mcscf.diis", diis_max_vec_, std::vector<size_t>{nrot}, precision,
+                CompressedDIIS::RemovalPolicy::OldestAdded, false);
+        }
     }
+    auto diis_subspace_size = [&]() {
+        return compressed_diis ? compressed_diis->subspace_size() : diis_manager.subspace_size();
+    };
 
     // set up L-BFGS solver and its parameters for micro iteration
     auto lbfgs_param = std::make_shared<LBFGS_PARAM>();
@@ -194,7 +227,8 @@ double MCSCF_2STEP::compute_energy() {
     double e_c;
     RDMs rdms;
     std::vector<CASSCF_HISTORY> history;
-    bool dump_wfn = ci_type_ == "DETCI";
+    // selected CI reuses the P space of the previous macro iteration as the initial guess
+    bool dump_wfn = ci_type_ == "DETCI" or (ci_warm_start_ and ci_type_ == "ACI");
 
     for (int macro = 1; macro <= maxiter_; ++macro) {
         // solve CI problem
@@ -203,7 +237,13 @@ double MCSCF_2STEP::compute_energy() {
             auto print_level = debug_print_ ? print_ : 0;
             bool read_wfn_guess = dump_wfn and macro != 1;
             std::tie(as_solver, e_c) = diagonalize_hamiltonian(
-                fci_ints, {print_level, dl_e_conv, dl_r_conv, read_wfn_guess, dump_wfn});
+                fci_ints,
+                {print_level, dl_e_conv, dl_r_conv, read_wfn_guess, dump_wfn, ci_warm_start_});
+
+            // truncated selected CI RDMs until the orbital gradient is close to convergence
+            if (sci_rdm_truncation_ > 0.0 and (macro == 1 or g->rms() > 10.0 * g_conv_)) {
+                as_solver->set_rdm_truncation(sci_rdm_truncation_);
+            }
             rdms = as_solver->compute_average_rdms(state_weights_map_, 2);
         }
         double de_c = (macro > 1) ? e_c - history[macro - 2].e_c : e_c;
@@ -217,15 +257,25 @@ double MCSCF_2STEP::compute_energy() {
         }
 
         print_h2("Optimizing Orbitals for Current RDMs");
-        double e_o = lbfgs.minimize(cas_grad, R);
+        double e_o;
+        int n_micro;
+        bool orb_conv;
+        if (orb_rot_algorithm_ == "AUGMENTED_HESSIAN") {
+            std::tie(e_o, n_micro, orb_conv) =
+                cas_grad.ah_minimize(R, g, lbfgs_param->epsilon, ah_maxiter_, max_rot_);
+        } else {
+            e_o = lbfgs.minimize(cas_grad, R);
+            g->copy(*lbfgs.g());
+            n_micro = lbfgs.iter();
+            orb_conv = lbfgs.converged();
+        }
 
         // info for orbital optimization
-        dG->subtract(lbfgs.g());
+        dG->subtract(g);
         double g_rms = dG->rms();
-        dG->copy(*lbfgs.g());
+        dG->copy(*g);
 
-        int n_micro = lbfgs.iter();
-        char o_conv = lbfgs.converged() ? 'Y' : 'N';
+        char o_conv = orb_conv ? 'Y' : 'N';
 
         // save data for this macro iteration
         CASSCF_HISTORY hist(e_c, e_o, g_rms, n_micro);
@@ -248,9 +298,9 @@ double MCSCF_2STEP::compute_energy() {
         // test convergence
         bool is_e_conv =
             std::fabs(de) < e_conv_ and std::fabs(de_c) < e_conv_ and std::fabs(de_o) < e_conv_;
-        bool is_g_conv = g_rms < g_conv_ or lbfgs.converged();
+        bool is_g_conv = g_rms < g_conv_ or orb_conv;
         // at convergence, DIIS should not be just reset
-        bool is_diis_conv = do_diis_ ? (diis_manager.subspace_size() > 1) : true;
+        bool is_diis_conv = do_diis_ ? (diis_subspace_size() > 1) : true;
         if (is_e_conv and is_g_conv and is_diis_conv) {
             std::string msg = "A miracle has come to pass: MCSCF iterations have converged!";
             psi::outfile->Printf("\n\n  %s", msg.c_str());
@@ -261,8 +311,14 @@ double MCSCF_2STEP::compute_energy() {
 
         // set convergence thresholds for Davidson-Liu solver
         if (macro > 1) {
-            dl_e_conv = 0.1 * std::fabs(de);
-            dl_r_conv = 0.5 * std::sqrt(dl_e_conv);
+            if (ci_conv_factor_ > 0.0) {
+                // CI errors enter the orbital gradient linearly and the energy quadratically
+                dl_r_conv = std::min(std::max(ci_conv_factor_ * g->rms(), r_conv), 1.0e-3);
+                dl_e_conv = std::max(dl_r_conv * dl_r_conv, e_conv_);
+            } else {
+                dl_e_conv = 0.1 * std::fabs(de);
+                dl_r_conv = 0.5 * std::sqrt(dl_e_conv);
+            }
             if (0.01 * g_rms < g_conv_ or dl_e_conv < e_conv_) {
                 dl_e_conv = e_conv_;
                 dl_r_conv = r_conv;
@@ -275,7 +331,11 @@ double MCSCF_2STEP::compute_energy() {
                 // reset DIIS if current orbital update unreasonable
                 if (de_c > 0.0 or (de > 0.0 and de_o > 0.0)) {
                     psi::outfile->Printf("   R/");
-                    diis_manager.reset_subspace();
+                    if (compressed_diis) {
+                        compressed_diis->reset_subspace();
+                    } else {
+                        diis_manager.reset_subspace();
+                    }
                 } else {
                     psi::outfile->Printf("   ");
                 }
@@ -283,13 +343,21 @@ double MCSCF_2STEP::compute_energy() {
                 dR->subtract(R);
                 dR->scale(-1.0);
 
-                diis_manager.add_entry(2, dR.get(), R.get());
+                if (compressed_diis) {
+                    compressed_diis->add_entry({dR->pointer()}, {R->pointer()});
+                } else {
+                    diis_manager.add_entry(2, dR.get(), R.get());
+                }
                 psi::outfile->Printf("S");
             }
 
             if ((macro - diis_start_) % diis_freq_ == 0 and
-                diis_manager.subspace_size() > diis_min_vec_) {
-                diis_manager.extrapolate(1, R.get());
+                diis_subspace_size() > diis_min_vec_) {
+                if (compressed_diis) {
+                    compressed_diis->extrapolate({R->pointer()});
+                } else {
+                    diis_manager.extrapolate(1, R.get());
+                }
                 psi::outfile->Printf("/E");
 
                 // update the actual integrals for CI, skip gradient computation
@@ -347,7 +415,7 @@ double MCSCF_2STEP::compute_energy() {
         auto fci_ints = cas_grad.active_space_ints();
         auto dump_wfn_new = dump_wfn and options_->get_bool("DUMP_ACTIVE_WFN");
         std::tie(as_solver, energy_) = diagonalize_hamiltonian(
-            fci_ints, {print_, dl_e_conv, dl_r_conv, dump_wfn, dump_wfn_new});
+            fci_ints, {print_, dl_e_conv, dl_r_conv, dump_wfn, dump_wfn_new, false});
 
         // pass to wave function
         auto Ca = cas_grad.Ca();
@@ -376,21 +444,23 @@ double MCSCF_2STEP::compute_energy() {
 }
 
 std::tuple<std::unique_ptr<ActiveSpaceSolver>, double>
-MCSCF_2STEP::diagonalize_hamiltonian(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
-                                     const std::tuple<int, double, double, bool, bool>& params) {
+MCSCF_2STEP::diagonalize_hamiltonian(
+    std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+    const std::tuple<int, double, double, bool, bool, bool>& params) {
     auto state_map = to_state_nroots_map(state_weights_map_);
     auto active_space_solver = make_active_space_solver(ci_type_, state_map, scf_info_,
                                                         mo_space_info_, fci_ints, options_);
 
     int print;
     double e_conv, r_conv;
-    bool read_wfn_guess, dump_wfn;
-    std::tie(print, e_conv, r_conv, read_wfn_guess, dump_wfn) = params;
+    bool read_wfn_guess, dump_wfn, dl_checkpoint;
+    std::tie(print, e_conv, r_conv, read_wfn_guess, dump_wfn, dl_checkpoint) = params;
 
     active_space_solver->set_print(print);
     active_space_solver->set_e_convergence(e_conv);
     active_space_solver->set_r_convergence(r_conv);
     active_space_solver->set_read_initial_guess(read_wfn_guess);
+    active_space_solver->set_dl_checkpoint(dl_checkpoint);
 
     const auto state_energies_map = active_space_solver->compute_energy();
 
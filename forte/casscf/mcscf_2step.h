@@ -113,6 +113,11 @@ class MCSCF_2STEP {
     /// Max allowed value for orbital rotation
     double max_rot_;
 
+    /// Orbital rotation algorithm: DIAGONAL (L-BFGS) or AUGMENTED_HESSIAN
+    std::string orb_rot_algorithm_;
+    /// Max number of augmented-Hessian steps per macro iteration
+    int ah_maxiter_;
+
     /// Keep internal (active-active) rotations
     bool internal_rot_;
 
@@ -129,6 +134,8 @@ class MCSCF_2STEP {
     int diis_max_vec_;
     /// DIIS extrapolation frequency
     int diis_freq_;
+    /// Storage of the DIIS vectors: PSI4 (DIISManager), DOUBLE, or FLOAT (CompressedDIIS)
+    std::string diis_storage_;
 
     /// Energy convergence criteria
     double e_conv_;
@@ -138,16 +145,24 @@ class MCSCF_2STEP {
     /// The name of CI solver
     std::string ci_type_;
 
+    /// Restart the Davidson-Liu solver from the subspace of the previous macro iteration
+    bool ci_warm_start_;
+    /// Ratio of the CI residual threshold to the orbital gradient RMS (0 = energy-based)
+    double ci_conv_factor_;
+    /// Weight of the selected CI wave functions discarded for the RDMs of early macro iterations
+    double sci_rdm_truncation_;
+
     /// Final total energy
     double energy_;
 
     /// Solve CI coefficients for the current orbitals
     /// @param fci_ints the pointer of ActiveSpaceIntegrals
-    /// @param params the parameters <print level, e_conv, r_conv, read_wfn_guess, dump_wfn>
+    /// @param params the parameters
+    ///        <print level, e_conv, r_conv, read_wfn_guess, dump_wfn, dl_checkpoint>
     /// @return <ActiveSpaceSolver, averaged energy>
     std::tuple<std::unique_ptr<ActiveSpaceSolver>, double>
     diagonalize_hamiltonian(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
-                            const std::tuple<int, double, double, bool, bool>& params);
+                            const std::tuple<int, double, double, bool, bool, bool>& params);
 
     /// Class to store iteration data
     struct CASSCF_HISTORY {
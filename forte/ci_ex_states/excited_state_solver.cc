@@ -26,6 +26,7 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <cmath>
@@ -35,7 +36,9 @@
 #include "psi4/physconst.h"
 
 #include "base_classes/mo_space_info.h"
+#include "base_classes/wave_function_file.h"
 #include "sci/sci.h"
+#include "sci/sci_checkpoint.h"
 #include "sparse_ci/determinant_substitution_lists.h"
 #include "helpers/helpers.h"
 #include "helpers/printing.h"
@@ -80,6 +83,7 @@ void ExcitedStateSolver::set_options(std::shared_ptr<ForteOptions> options) {
     quiet_mode_ = options->get_bool("SCI_QUIET_MODE");
     direct_rdms_ = options->get_bool("SCI_DIRECT_RDMS");
     test_rdms_ = options->get_bool("SCI_TEST_RDMS");
+    ms_avg_rdms_ = options->get_bool("SPIN_AVG_DENSITY") and (state_.twice_ms() == 0);
     save_final_wfn_ = options->get_bool("SCI_SAVE_FINAL_WFN");
     first_iter_roots_ = options->get_bool("SCI_FIRST_ITER_ROOTS");
     sparse_solver_ = std::make_shared<SparseCISolver>();
@@ -154,6 +158,28 @@ double ExcitedStateSolver::compute_energy() {
     psi::SharedMatrix PQ_evecs;
     psi::SharedVector PQ_evals;
 
+    // seed the P space with the wave function on disk (e.g., from the previous MCSCF iteration)
+    if (read_wfn_guess_ and (not multi_state) and (not wfn_filename_.empty())) {
+        try {
+            auto wfn = read_wave_function_file(wfn_filename_);
+            auto guess = std::make_shared<SCICheckpoint>();
+            guess->nact = wfn.norbs;
+            guess->nroot = wfn.evecs->coldim();
+            guess->dets = std::move(wfn.dets);
+            size_t ndets = guess->dets.size();
+            guess->coefficients.resize(ndets * guess->nroot);
+            for (size_t n = 0; n < guess->nroot; ++n) {
+                for (size_t I = 0; I < ndets; ++I) {
+                    guess->coefficients[n * ndets + I] = wfn.evecs->get(I, n);
+                }
+            }
+            sci_->set_initial_guess(guess);
+        } catch (const std::exception&) {
+            psi::outfile->Printf("\n  Cannot read the initial guess from %s",
+                                 wfn_filename_.c_str());
+        }
+    }
+
     for (int i = 0; i < nrun; ++i) {
         if (!quiet_mode_)
             psi::outfile->Printf("\n  Computing wavefunction for root %d", i);
@@ -460,12 +486,89 @@ std::vector<RDMs> ExcitedStateSolver::rdms(const std::vector<std::pair<size_t, s
     std::vector<RDMs> refs;
 
     for (const auto& root_pair : root_list) {
+        if (rdm_truncation_ > 0.0) {
+            auto dets_evecs = truncate_wfn(root_pair.first, root_pair.second);
+            refs.push_back(compute_rdms(as_ints_, dets_evecs.first, dets_evecs.second,
+                                        root_pair.first, root_pair.second, max_rdm_level));
+            continue;
+        }
         refs.push_back(compute_rdms(as_ints_, final_wfn_, evecs_, root_pair.first, root_pair.second,
                                     max_rdm_level));
     }
     return refs;
 }
 
+std::pair<DeterminantHashVec, psi::SharedMatrix> ExcitedStateSolver::truncate_wfn(int root1,
+                                                                                 int root2) {
+    size_t ndets = final_wfn_.size();
+    size_t nroots = evecs_->coldim();
+
+    // sort the determinants by their (averaged) weight in the two roots
+    std::vector<std::pair<double, size_t>> weights(ndets);
+    for (size_t I = 0; I < ndets; ++I) {
+        double c1 = evecs_->get(I, root1);
+        double c2 = evecs_->get(I, root2);
+        weights[I] = std::make_pair(0.5 * (c1 * c1 + c2 * c2), I);
+    }
+    std::sort(weights.begin(), weights.end(), std::greater<std::pair<double, size_t>>());
+
+    size_t nkeep = 0;
+    double kept = 0.0;
+    while (nkeep < ndets and kept < 1.0 - rdm_truncation_) {
+        kept += weights[nkeep].first;
+        nkeep++;
+    }
+
+    DeterminantHashVec dets;
+    auto evecs = std::make_shared<psi::Matrix>("Truncated evecs", nkeep, nroots);
+    for (size_t k = 0; k < nkeep; ++k) {
+        size_t I = weights[k].second;
+        dets.add(final_wfn_.get_det(I));
+        for (size_t n = 0; n < nroots; ++n) {
+            evecs->set(k, n, evecs_->get(I, n));
+        }
+    }
+
+    // renormalize the coefficients
+    for (size_t n = 0; n < nroots; ++n) {
+        double norm = 0.0;
+        for (size_t k = 0; k < nkeep; ++k) {
+            norm += evecs->get(k, n) * evecs->get(k, n);
+        }
+        if (norm > 0.0) {
+            norm = 1.0 / std::sqrt(norm);
+            for (size_t k = 0; k < nkeep; ++k) {
+                evecs->set(k, n, evecs->get(k, n) * norm);
+            }
+        }
+    }
+
+    if (!quiet_mode_) {
+        psi::outfile->Printf("\n  RDMs of roots (%d, %d) from %zu of %zu determinants", root1,
+                             root2, nkeep, ndets);
+    }
+
+    return std::make_pair(dets, evecs);
+}
+
+void ExcitedStateSolver::dump_wave_function(const std::string& filename) {
+    // the P space of the last cycle and its coefficients
+    SCICheckpoint checkpoint;
+    checkpoint.nact = nact_;
+    try {
+        sci_->save_checkpoint(checkpoint);
+    } catch (const std::runtime_error&) {
+        psi::outfile->Printf("\n  This selected CI method cannot save its wave function.");
+        return;
+    }
+    size_t ndets = checkpoint.dets.size();
+    write_wave_function_file(filename, nact_, "SCI: " + state_.str(), checkpoint.dets,
+                             checkpoint.nroot, [&](size_t n, double* column) {
+                                 const double* C = checkpoint.coefficients.data() + n * ndets;
+                                 std::copy(C, C + ndets, column);
+                             });
+}
+
 std::vector<RDMs>
 ExcitedStateSolver::transition_rdms(const std::vector<std::pair<size_t, size_t>>& /*root_list*/,
                                     std::shared_ptr<ActiveSpaceMethod> /*method2*/,
@@ -513,6 +616,24 @@ RDMs ExcitedStateSolver::compute_rdms(std::shared_ptr<ActiveSpaceIntegrals> fci_
     ambit::Tensor trdm_abb;
     ambit::Tensor trdm_bbb;
 
+    if (direct_rdms_ and ms_avg_rdms_ and (not test_rdms_)) {
+        // For Ms = 0 only the a, ab, and aab blocks are needed, the rest follows from spin symmetry
+        ordm_a = ambit::Tensor::build(ambit::CoreTensor, "g1a", {nact_, nact_});
+        trdm_ab = ambit::Tensor::build(ambit::CoreTensor, "g2ab", {nact_, nact_, nact_, nact_});
+        trdm_aab = ambit::Tensor::build(ambit::CoreTensor, "g2aab",
+                                        {nact_, nact_, nact_, nact_, nact_, nact_});
+
+        ci_rdms.compute_rdms_dynamic_ms_avg(ordm_a.data(), trdm_ab.data(), trdm_aab.data());
+
+        if (max_rdm_level == 1) {
+            return RDMs(true, ordm_a);
+        }
+        if (max_rdm_level == 2) {
+            return RDMs(true, ordm_a, trdm_ab);
+        }
+        return RDMs(true, ordm_a, trdm_ab, trdm_aab);
+    }
+
     if (direct_rdms_) {
         // TODO: Implemente order-by-order version of direct algorithm
         ordm_a = ambit::Tensor::build(ambit::CoreTensor, "g1a", {nact_, nact_});
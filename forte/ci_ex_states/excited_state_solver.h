@@ -70,6 +70,10 @@ class ExcitedStateSolver : public ActiveSpaceMethod {
     /// @param options the options passed in
     virtual void set_options(std::shared_ptr<ForteOptions> options) override;
 
+    /// Dump the P space of the last selected CI cycle and its coefficients to file (see
+    /// WaveFunctionFile), which is used as the initial P space when reading the wave function guess
+    void dump_wave_function(const std::string& filename) override;
+
     //    void add_external_excitations(DeterminantHashVec& ref);
 
     /// Set excitation algorithm
@@ -104,6 +108,8 @@ class ExcitedStateSolver : public ActiveSpaceMethod {
     bool direct_rdms_ = false;
     /// Run test for the RDMs
     bool test_rdms_ = false;
+    /// Compute only the spin blocks of the RDMs needed for Ms = 0 spin-averaged densities
+    bool ms_avg_rdms_ = false;
     /// Print final wavefunction to file
     bool save_final_wfn_ = false;
     /// Compute all roots on first iteration?
@@ -128,6 +134,10 @@ class ExcitedStateSolver : public ActiveSpaceMethod {
     /// Print a wave function
     void print_wfn(DeterminantHashVec& space, std::shared_ptr<psi::Matrix> evecs, int nroot);
 
+    /// Truncate the final wave function to the determinants carrying a weight of at least
+    /// 1 - rdm_truncation_ in roots root1 and root2, with renormalized coefficients
+    std::pair<DeterminantHashVec, std::shared_ptr<psi::Matrix>> truncate_wfn(int root1, int root2);
+
     /// Compute the RDMs
     RDMs compute_rdms(std::shared_ptr<ActiveSpaceIntegrals> fci_ints, DeterminantHashVec& dets,
                       std::shared_ptr<psi::Matrix>& PQ_evecs, int root1, int root2,
@@ -26,6 +26,7 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <cmath>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
@@ -36,6 +37,13 @@
 
 #include "ci_rdms.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
 using namespace psi;
 
 namespace forte {
@@ -146,6 +154,7 @@ double CI_RDMS::get_energy(std::vector<double>& oprdm_a, std::vector<double>& op
 }
 
 void CI_RDMS::compute_1rdm(std::vector<double>& oprdm_a, std::vector<double>& oprdm_b) {
+    ProfileRegion region("CI_RDMS::compute_1rdm");
     local_timer one;
     get_one_map();
     if (print_)
@@ -185,6 +194,7 @@ void CI_RDMS::compute_1rdm(std::vector<double>& oprdm_a, std::vector<double>& op
 }
 
 void CI_RDMS::compute_1rdm_op(std::vector<double>& oprdm_a, std::vector<double>& oprdm_b) {
+    ProfileRegion region("CI_RDMS::compute_1rdm_op");
 
     auto op = std::make_shared<DeterminantSubstitutionLists>(fci_ints_);
     op->set_quiet_mode(not print_);
@@ -192,8 +202,8 @@ void CI_RDMS::compute_1rdm_op(std::vector<double>& oprdm_a, std::vector<double>&
     op->op_s_lists(wfn_);
 
     // Get the references to the coupling lists
-    std::vector<std::vector<std::pair<size_t, short>>>& a_list = op->a_list_;
-    std::vector<std::vector<std::pair<size_t, short>>>& b_list = op->b_list_;
+    const auto& a_list = op->a_list_;
+    const auto& b_list = op->b_list_;
 
     local_timer build;
     oprdm_a.assign(ncmo2_, 0.0);
@@ -219,17 +229,17 @@ void CI_RDMS::compute_1rdm_op(std::vector<double>& oprdm_a, std::vector<double>&
         }
     }
     for (size_t K = 0, max_K = a_list.size(); K < max_K; ++K) {
-        std::vector<std::pair<size_t, short>>& coupled_dets = a_list[K];
+        const auto coupled_dets = a_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
             auto& detI = coupled_dets[a];
-            const size_t& I = detI.first;
-            const size_t& p = std::abs(detI.second) - 1;
-            const double& sign_p = detI.second > 0 ? 1.0 : -1.0;
+            const size_t& I = detI.index;
+            const size_t& p = detI.p();
+            const double& sign_p = detI.sign();
             for (size_t b = a + 1, max_b = coupled_dets.size(); b < max_b; ++b) {
                 auto& detJ = coupled_dets[b];
-                const size_t& q = std::abs(detJ.second) - 1;
-                const double& sign_q = detJ.second > 0 ? 1.0 : -1.0;
-                const size_t& J = detJ.first;
+                const size_t& q = detJ.p();
+                const double& sign_q = detJ.sign();
+                const size_t& J = detJ.index;
                 oprdm_a[p * ncmo_ + q] +=
                     evecs_->get(I, root1_) * evecs_->get(J, root2_) * sign_p * sign_q;
                 oprdm_a[q * ncmo_ + p] +=
@@ -238,17 +248,17 @@ void CI_RDMS::compute_1rdm_op(std::vector<double>& oprdm_a, std::vector<double>&
         }
     }
     for (size_t K = 0, max_K = b_list.size(); K < max_K; ++K) {
-        std::vector<std::pair<size_t, short>>& coupled_dets = b_list[K];
+        const auto coupled_dets = b_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
             auto& detI = coupled_dets[a];
-            const size_t& I = detI.first;
-            const size_t& p = std::abs(detI.second) - 1;
-            const double& sign_p = detI.second > 0 ? 1.0 : -1.0;
+            const size_t& I = detI.index;
+            const size_t& p = detI.p();
+            const double& sign_p = detI.sign();
             for (size_t b = a + 1, max_b = coupled_dets.size(); b < max_b; ++b) {
                 auto& detJ = coupled_dets[b];
-                const size_t& q = std::abs(detJ.second) - 1;
-                const double& sign_q = detJ.second > 0 ? 1.0 : -1.0;
-                const size_t& J = detJ.first;
+                const size_t& q = detJ.p();
+                const double& sign_q = detJ.sign();
+                const size_t& J = detJ.index;
                 oprdm_b[p * ncmo_ + q] +=
                     evecs_->get(I, root1_) * evecs_->get(J, root2_) * sign_p * sign_q;
                 oprdm_b[q * ncmo_ + p] +=
@@ -264,6 +274,7 @@ void CI_RDMS::compute_1rdm_op(std::vector<double>& oprdm_a, std::vector<double>&
 
 void CI_RDMS::compute_2rdm(std::vector<double>& tprdm_aa, std::vector<double>& tprdm_ab,
                            std::vector<double>& tprdm_bb) {
+    ProfileRegion region("CI_RDMS::compute_2rdm");
     tprdm_aa.assign(ncmo4_, 0.0);
     tprdm_ab.assign(ncmo4_, 0.0);
     tprdm_bb.assign(ncmo4_, 0.0);
@@ -346,6 +357,7 @@ void CI_RDMS::compute_2rdm(std::vector<double>& tprdm_aa, std::vector<double>& t
 
 void CI_RDMS::compute_2rdm_op(std::vector<double>& tprdm_aa, std::vector<double>& tprdm_ab,
                               std::vector<double>& tprdm_bb) {
+    ProfileRegion region("CI_RDMS::compute_2rdm_op");
     auto op = std::make_shared<DeterminantSubstitutionLists>(fci_ints_);
     op->set_quiet_mode(not print_);
     op->build_strings(wfn_);
@@ -358,9 +370,9 @@ void CI_RDMS::compute_2rdm_op(std::vector<double>& tprdm_aa, std::vector<double>
     tprdm_ab.assign(ncmo4_, 0.0);
     tprdm_bb.assign(ncmo4_, 0.0);
 
-    std::vector<std::vector<std::tuple<size_t, short, short>>>& aa_list = op->aa_list_;
-    std::vector<std::vector<std::tuple<size_t, short, short>>>& ab_list = op->ab_list_;
-    std::vector<std::vector<std::tuple<size_t, short, short>>>& bb_list = op->bb_list_;
+    const auto& aa_list = op->aa_list_;
+    const auto& ab_list = op->ab_list_;
+    const auto& bb_list = op->bb_list_;
 
     for (size_t J = 0; J < dim_space_; ++J) {
         double cJ_sq = evecs_->get(J, root1_) * evecs_->get(J, root2_);
@@ -405,24 +417,24 @@ void CI_RDMS::compute_2rdm_op(std::vector<double>& tprdm_aa, std::vector<double>
 
     // aaaa
     for (size_t K = 0, max_K = aa_list.size(); K < max_K; ++K) {
-        std::vector<std::tuple<size_t, short, short>>& coupled_dets = aa_list[K];
+        const auto coupled_dets = aa_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
 
             auto& detJ = coupled_dets[a];
 
-            const size_t& J = std::get<0>(detJ);
-            const size_t& p = std::abs(std::get<1>(detJ)) - 1;
-            const size_t& q = std::get<2>(detJ);
-            const double& sign_pq = std::get<1>(detJ) > 0.0 ? 1.0 : -1.0;
+            const size_t& J = detJ.index;
+            const size_t& p = detJ.p();
+            const size_t& q = detJ.q;
+            const double& sign_pq = detJ.sign();
 
             for (size_t b = a + 1, max_b = coupled_dets.size(); b < max_b; ++b) {
 
                 auto& detI = coupled_dets[b];
 
-                const size_t& r = std::abs(std::get<1>(detI)) - 1;
-                const size_t& s = std::get<2>(detI);
-                const double& sign_rs = std::get<1>(detI) > 0.0 ? 1.0 : -1.0;
-                const size_t& I = std::get<0>(detI);
+                const size_t& r = detI.p();
+                const size_t& s = detI.q;
+                const double& sign_rs = detI.sign();
+                const size_t& I = detI.index;
                 double rdm_element =
                     evecs_->get(J, root1_) * evecs_->get(I, root2_) * sign_pq * sign_rs;
 
@@ -443,24 +455,24 @@ void CI_RDMS::compute_2rdm_op(std::vector<double>& tprdm_aa, std::vector<double>
 
     // bbbb
     for (size_t K = 0, max_K = bb_list.size(); K < max_K; ++K) {
-        std::vector<std::tuple<size_t, short, short>>& coupled_dets = bb_list[K];
+        const auto coupled_dets = bb_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
 
             auto& detJ = coupled_dets[a];
 
-            const size_t& J = std::get<0>(detJ);
-            const size_t& p = std::abs(std::get<1>(detJ)) - 1;
-            const size_t& q = std::get<2>(detJ);
-            const double& sign_pq = std::get<1>(detJ) > 0.0 ? 1.0 : -1.0;
+            const size_t& J = detJ.index;
+            const size_t& p = detJ.p();
+            const size_t& q = detJ.q;
+            const double& sign_pq = detJ.sign();
 
             for (size_t b = a + 1, max_b = coupled_dets.size(); b < max_b; ++b) {
 
                 auto& detI = coupled_dets[b];
 
-                const size_t& r = std::abs(std::get<1>(detI)) - 1;
-                const size_t& s = std::get<2>(detI);
-                const double& sign_rs = std::get<1>(detI) > 0.0 ? 1.0 : -1.0;
-                const size_t& I = std::get<0>(detI);
+                const size_t& r = detI.p();
+                const size_t& s = detI.q;
+                const double& sign_rs = detI.sign();
+                const size_t& I = detI.index;
                 double rdm_element =
                     evecs_->get(J, root1_) * evecs_->get(I, root2_) * sign_pq * sign_rs;
 
@@ -480,24 +492,24 @@ void CI_RDMS::compute_2rdm_op(std::vector<double>& tprdm_aa, std::vector<double>
     }
     // aabb
     for (size_t K = 0, max_K = ab_list.size(); K < max_K; ++K) {
-        std::vector<std::tuple<size_t, short, short>>& coupled_dets = ab_list[K];
+        const auto coupled_dets = ab_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
 
             auto& detJ = coupled_dets[a];
 
-            const size_t& J = std::get<0>(detJ);
-            const size_t& p = std::abs(std::get<1>(detJ)) - 1;
-            const size_t& q = std::get<2>(detJ);
-            const double& sign_pq = std::get<1>(detJ) > 0.0 ? 1.0 : -1.0;
+            const size_t& J = detJ.index;
+            const size_t& p = detJ.p();
+            const size_t& q = detJ.q;
+            const double& sign_pq = detJ.sign();
 
             for (size_t b = a + 1, max_b = coupled_dets.size(); b < max_b; ++b) {
 
                 auto& detI = coupled_dets[b];
 
-                const size_t& r = std::abs(std::get<1>(detI)) - 1;
-                const size_t& s = std::get<2>(detI);
-                const double& sign_rs = std::get<1>(detI) > 0.0 ? 1.0 : -1.0;
-                const size_t& I = std::get<0>(detI);
+                const size_t& r = detI.p();
+                const size_t& s = detI.q;
+                const double& sign_rs = detI.sign();
+                const size_t& I = detI.index;
 
                 double rdm_element =
                     evecs_->get(J, root1_) * evecs_->get(I, root2_) * sign_pq * sign_rs;
@@ -514,8 +526,215 @@ void CI_RDMS::compute_2rdm_op(std::vector<double>& tprdm_aa, std::vector<double>
     }
 }
 
+void CI_RDMS::compute_rdms_op_root_pairs(const std::vector<std::pair<size_t, size_t>>& root_pairs,
+                                         int max_rdm_level,
+                                         std::vector<std::array<std::vector<double>, 5>>& rdms) {
+    ProfileRegion region("CI_RDMS::compute_rdms_op_root_pairs");
+    if (max_rdm_level < 1 or max_rdm_level > 2) {
+        throw std::runtime_error(
+            "CI_RDMS::compute_rdms_op_root_pairs: max_rdm_level must be 1 or 2");
+    }
+    const bool do_2rdm = max_rdm_level == 2;
+
+    // build the coupling lists once for all the root pairs
+    auto op = std::make_shared<DeterminantSubstitutionLists>(fci_ints_);
+    op->set_quiet_mode(not print_);
+    op->build_strings(wfn_);
+    op->op_s_lists(wfn_);
+    if (do_2rdm) {
+        op->tp_s_lists(wfn_);
+    }
+
+    local_timer build;
+
+    // gather the coefficients of the bra (C1) and ket (C2) roots of each pair so that the loops
+    // over the pairs run over contiguous memory
+    const size_t npairs = root_pairs.size();
+    std::vector<double> C1(dim_space_ * npairs);
+    std::vector<double> C2(dim_space_ * npairs);
+    for (size_t I = 0; I < dim_space_; ++I) {
+        for (size_t n = 0; n < npairs; ++n) {
+            C1[I * npairs + n] = evecs_->get(I, root_pairs[n].first);
+            C2[I * npairs + n] = evecs_->get(I, root_pairs[n].second);
+        }
+    }
+
+    // each pair owns the blocks a, b, aa, ab, bb of a flat buffer, one buffer (tile) per thread
+    const size_t offsets[5] = {0, ncmo2_, 2 * ncmo2_, 2 * ncmo2_ + ncmo4_,
+                               2 * ncmo2_ + 2 * ncmo4_};
+    const size_t sizes[5] = {ncmo2_, ncmo2_, do_2rdm ? ncmo4_ : 0, do_2rdm ? ncmo4_ : 0,
+                             do_2rdm ? ncmo4_ : 0};
+    const size_t pair_size = offsets[2] + (do_2rdm ? 3 * ncmo4_ : 0);
+    const size_t tile_bytes = std::max(size_t(1), npairs * pair_size * sizeof(double));
+    const size_t max_tiles =
+        std::max(size_t(1), psi::Process::environment.get_memory() / 2 / tile_bytes);
+    const int ntiles =
+        static_cast<int>(std::min(static_cast<size_t>(omp_get_max_threads()), max_tiles));
+    std::vector<std::vector<double>> tiles(ntiles);
+
+    const det_hashvec& dets = wfn_.wfn_hash();
+    const auto& a_list = op->a_list_;
+    const auto& b_list = op->b_list_;
+    const auto& aa_list = op->aa_list_;
+    const auto& ab_list = op->ab_list_;
+    const auto& bb_list = op->bb_list_;
+
+#pragma omp parallel num_threads(ntiles)
+    {
+        auto& tile = tiles[omp_get_thread_num()];
+        tile.assign(npairs * pair_size, 0.0);
+        double* a = tile.data() + offsets[0];
+        double* b = tile.data() + offsets[1];
+        double* aa = tile.data() + offsets[2];
+        double* ab = tile.data() + offsets[3];
+        double* bb = tile.data() + offsets[4];
+
+        // diagonal contributions
+#pragma omp for schedule(dynamic, 64)
+        for (size_t J = 0; J < dim_space_; ++J) {
+            const double* cJ1 = &C1[J * npairs];
+            const double* cJ2 = &C2[J * npairs];
+            std::vector<int> aocc = dets[J].get_alfa_occ(ncmo_);
+            std::vector<int> bocc = dets[J].get_beta_occ(ncmo_);
+            for (size_t n = 0; n < npairs; ++n) {
+                const double cJ_sq = cJ1[n] * cJ2[n];
+                const size_t shift = n * pair_size;
+                for (int p : aocc) {
+                    a[shift + p * ncmo_ + p] += cJ_sq;
+                }
+                for (int p : bocc) {
+                    b[shift + p * ncmo_ + p] += cJ_sq;
+                }
+                if (not do_2rdm) {
+                    continue;
+                }
+                for (size_t i = 0; i < aocc.size(); ++i) {
+                    const size_t p = aocc[i];
+                    for (size_t j = i + 1; j < aocc.size(); ++j) {
+                        const size_t q = aocc[j];
+                        aa[shift + p * ncmo3_ + q * ncmo2_ + p * ncmo_ + q] += cJ_sq;
+                        aa[shift + q * ncmo3_ + p * ncmo2_ + p * ncmo_ + q] -= cJ_sq;
+                        aa[shift + q * ncmo3_ + p * ncmo2_ + q * ncmo_ + p] += cJ_sq;
+                        aa[shift + p * ncmo3_ + q * ncmo2_ + q * ncmo_ + p] -= cJ_sq;
+                    }
+                }
+                for (size_t i = 0; i < bocc.size(); ++i) {
+                    const size_t p = bocc[i];
+                    for (size_t j = i + 1; j < bocc.size(); ++j) {
+                        const size_t q = bocc[j];
+                        bb[shift + p * ncmo3_ + q * ncmo2_ + p * ncmo_ + q] += cJ_sq;
+                        bb[shift + q * ncmo3_ + p * ncmo2_ + p * ncmo_ + q] -= cJ_sq;
+                        bb[shift + q * ncmo3_ + p * ncmo2_ + q * ncmo_ + p] += cJ_sq;
+                        bb[shift + p * ncmo3_ + q * ncmo2_ + q * ncmo_ + p] -= cJ_sq;
+                    }
+                }
+                for (int p : aocc) {
+                    for (int q : bocc) {
+                        ab[shift + p * ncmo3_ + q * ncmo2_ + p * ncmo_ + q] += cJ_sq;
+                    }
+                }
+            }
+        }
+
+        // one-particle couplings: <I| a+_p a_q |J> for determinants sharing an N-1 string
+        auto add_1rdm = [&](const auto& list, double* rdm) {
+#pragma omp for schedule(dynamic)
+            for (size_t K = 0; K < list.size(); ++K) {
+                const auto& coupled_dets = list[K];
+                for (size_t i = 0, max_i = coupled_dets.size(); i < max_i; ++i) {
+                    const auto& detI = coupled_dets[i];
+                    const size_t I = detI.index;
+                    const size_t p = detI.p();
+                    const double sign_p = detI.sign();
+                    for (size_t j = i + 1; j < max_i; ++j) {
+                        const auto& detJ = coupled_dets[j];
+                        const size_t J = detJ.index;
+                        const size_t q = detJ.p();
+                        const double sign = sign_p * detJ.sign();
+                        for (size_t n = 0; n < npairs; ++n) {
+                            const size_t shift = n * pair_size;
+                            rdm[shift + p * ncmo_ + q] +=
+                                C1[I * npairs + n] * C2[J * npairs + n] * sign;
+                            rdm[shift + q * ncmo_ + p] +=
+                                C1[J * npairs + n] * C2[I * npairs + n] * sign;
+                        }
+                    }
+                }
+            }
+        };
+        add_1rdm(a_list, a);
+        add_1rdm(b_list, b);
+
+        // two-particle couplings, same-spin lists are antisymmetrized
+        auto add_2rdm = [&](const auto& list, double* rdm, bool antisymmetrize) {
+#pragma omp for schedule(dynamic)
+            for (size_t K = 0; K < list.size(); ++K) {
+                const auto& coupled_dets = list[K];
+                for (size_t i = 0, max_i = coupled_dets.size(); i < max_i; ++i) {
+                    const auto& detJ = coupled_dets[i];
+                    const size_t J = detJ.index;
+                    const size_t p = detJ.p();
+                    const size_t q = detJ.q;
+                    const double sign_pq = detJ.sign();
+                    for (size_t j = i + 1; j < max_i; ++j) {
+                        const auto& detI = coupled_dets[j];
+                        const size_t I = detI.index;
+                        const size_t r = detI.p();
+                        const size_t s = detI.q;
+                        const double sign = sign_pq * detI.sign();
+                        for (size_t n = 0; n < npairs; ++n) {
+                            double* rdm_n = rdm + n * pair_size;
+                            const double JI = C1[J * npairs + n] * C2[I * npairs + n] * sign;
+                            const double IJ = C1[I * npairs + n] * C2[J * npairs + n] * sign;
+                            rdm_n[p * ncmo3_ + q * ncmo2_ + r * ncmo_ + s] += JI;
+                            rdm_n[r * ncmo3_ + s * ncmo2_ + p * ncmo_ + q] += IJ;
+                            if (antisymmetrize) {
+                                rdm_n[p * ncmo3_ + q * ncmo2_ + s * ncmo_ + r] -= JI;
+                                rdm_n[q * ncmo3_ + p * ncmo2_ + r * ncmo_ + s] -= JI;
+                                rdm_n[q * ncmo3_ + p * ncmo2_ + s * ncmo_ + r] += JI;
+                                rdm_n[s * ncmo3_ + r * ncmo2_ + p * ncmo_ + q] -= IJ;
+                                rdm_n[r * ncmo3_ + s * ncmo2_ + q * ncmo_ + p] -= IJ;
+                                rdm_n[s * ncmo3_ + r * ncmo2_ + q * ncmo_ + p] += IJ;
+                            }
+                        }
+                    }
+                }
+            }
+        };
+        if (do_2rdm) {
+            add_2rdm(aa_list, aa, true);
+            add_2rdm(bb_list, bb, true);
+            add_2rdm(ab_list, ab, false);
+        }
+    }
+
+    // sum the tiles into the output, one root pair and block at a time
+    rdms.resize(npairs);
+    for (size_t n = 0; n < npairs; ++n) {
+        for (int blk = 0; blk < 5; ++blk) {
+            auto& rdm = rdms[n][blk];
+            rdm.assign(sizes[blk], 0.0);
+            const size_t shift = n * pair_size + offsets[blk];
+#pragma omp parallel for schedule(static)
+            for (size_t k = 0; k < sizes[blk]; ++k) {
+                double sum = 0.0;
+                for (const auto& tile : tiles) {
+                    sum += tile[shift + k];
+                }
+                rdm[k] = sum;
+            }
+        }
+    }
+
+    if (print_) {
+        outfile->Printf("\n  Time spent building the RDMs of %zu root pairs (%d threads): %.3e s",
+                        npairs, ntiles, build.get());
+    }
+}
+
 void CI_RDMS::compute_3rdm(std::vector<double>& tprdm_aaa, std::vector<double>& tprdm_aab,
                            std::vector<double>& tprdm_abb, std::vector<double>& tprdm_bbb) {
+    ProfileRegion region("CI_RDMS::compute_3rdm");
     size_t ncmo5 = ncmo4_ * ncmo_;
     size_t ncmo6 = ncmo3_ * ncmo3_;
 
@@ -709,12 +928,42 @@ void CI_RDMS::compute_3rdm(std::vector<double>& tprdm_aaa, std::vector<double>&
 
 void CI_RDMS::compute_3rdm_op(std::vector<double>& tprdm_aaa, std::vector<double>& tprdm_aab,
                               std::vector<double>& tprdm_abb, std::vector<double>& tprdm_bbb) {
+    ProfileRegion region("CI_RDMS::compute_3rdm_op");
 
-    auto op = std::make_shared<DeterminantSubstitutionLists>(fci_ints_);
-    op->set_quiet_mode(not print_);
-    op->build_strings(wfn_);
-    op->three_s_lists(wfn_);
+    DeterminantSubstitutionLists op(fci_ints_);
+    op.set_quiet_mode(not print_);
+    op.build_strings(wfn_);
+    op.three_s_lists(wfn_);
 
+    compute_3rdm_op(op, tprdm_aaa, tprdm_aab, tprdm_abb, tprdm_bbb);
+}
+
+void CI_RDMS::compute_3rdm_op_root_pairs(
+    const std::vector<std::pair<size_t, size_t>>& root_pairs,
+    std::vector<std::array<std::vector<double>, 4>>& rdms) {
+    ProfileRegion region("CI_RDMS::compute_3rdm_op_root_pairs");
+
+    // build the coupling lists once for all the root pairs
+    DeterminantSubstitutionLists op(fci_ints_);
+    op.set_quiet_mode(not print_);
+    op.build_strings(wfn_);
+    op.three_s_lists(wfn_);
+
+    int root1 = root1_;
+    int root2 = root2_;
+    rdms.resize(root_pairs.size());
+    for (size_t n = 0, npairs = root_pairs.size(); n < npairs; ++n) {
+        root1_ = root_pairs[n].first;
+        root2_ = root_pairs[n].second;
+        compute_3rdm_op(op, rdms[n][0], rdms[n][1], rdms[n][2], rdms[n][3]);
+    }
+    root1_ = root1;
+    root2_ = root2;
+}
+
+void CI_RDMS::compute_3rdm_op(const DeterminantSubstitutionLists& op,
+                              std::vector<double>& tprdm_aaa, std::vector<double>& tprdm_aab,
+                              std::vector<double>& tprdm_abb, std::vector<double>& tprdm_bbb) {
     local_timer build;
     size_t ncmo5 = ncmo4_ * ncmo_;
     size_t ncmo6 = ncmo3_ * ncmo3_;
@@ -724,10 +973,10 @@ void CI_RDMS::compute_3rdm_op(std::vector<double>& tprdm_aaa, std::vector<double
     tprdm_abb.assign(ncmo6, 0.0);
     tprdm_bbb.assign(ncmo6, 0.0);
 
-    std::vector<std::vector<std::tuple<size_t, short, short, short>>>& aaa_list = op->aaa_list_;
-    std::vector<std::vector<std::tuple<size_t, short, short, short>>>& aab_list = op->aab_list_;
-    std::vector<std::vector<std::tuple<size_t, short, short, short>>>& abb_list = op->abb_list_;
-    std::vector<std::vector<std::tuple<size_t, short, short, short>>>& bbb_list = op->bbb_list_;
+    const auto& aaa_list = op.aaa_list_;
+    const auto& aab_list = op.aab_list_;
+    const auto& abb_list = op.abb_list_;
+    const auto& bbb_list = op.bbb_list_;
 
     // Build the diagonal part
     const det_hashvec& dets = wfn_.wfn_hash();
@@ -957,7 +1206,7 @@ void CI_RDMS::compute_3rdm_op(std::vector<double>& tprdm_aaa, std::vector<double
 
     for (size_t K = 0, max_K = aaa_list.size(); K < max_K; ++K) {
         // aaa aaa
-        std::vector<std::tuple<size_t, short, short, short>>& coupled_dets = aaa_list[K];
+        const std::vector<std::tuple<size_t, short, short, short>>& coupled_dets = aaa_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
 
             auto& detJ = coupled_dets[a];
@@ -1071,7 +1320,7 @@ void CI_RDMS::compute_3rdm_op(std::vector<double>& tprdm_aaa, std::vector<double
 
     for (size_t K = 0, max_K = aab_list.size(); K < max_K; ++K) {
         // aab aab
-        std::vector<std::tuple<size_t, short, short, short>>& coupled_dets = aab_list[K];
+        const std::vector<std::tuple<size_t, short, short, short>>& coupled_dets = aab_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
 
             auto& detJ = coupled_dets[a];
@@ -1109,7 +1358,7 @@ void CI_RDMS::compute_3rdm_op(std::vector<double>& tprdm_aaa, std::vector<double
 
     // abb abb
     for (size_t K = 0, max_K = abb_list.size(); K < max_K; ++K) {
-        std::vector<std::tuple<size_t, short, short, short>>& coupled_dets = abb_list[K];
+        const std::vector<std::tuple<size_t, short, short, short>>& coupled_dets = abb_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
 
             auto& detJ = coupled_dets[a];
@@ -1147,7 +1396,7 @@ void CI_RDMS::compute_3rdm_op(std::vector<double>& tprdm_aaa, std::vector<double
 
     for (size_t K = 0, max_K = bbb_list.size(); K < max_K; ++K) {
         // bbb bbb
-        std::vector<std::tuple<size_t, short, short, short>>& coupled_dets = bbb_list[K];
+        const std::vector<std::tuple<size_t, short, short, short>>& coupled_dets = bbb_list[K];
         for (size_t a = 0, max_a = coupled_dets.size(); a < max_a; ++a) {
 
             auto& detJ = coupled_dets[a];
@@ -1265,6 +1514,9 @@ void CI_RDMS::compute_3rdm_op(std::vector<double>& tprdm_aaa, std::vector<double
 }
 
 void CI_RDMS::get_one_map() {
+    if (one_map_done_)
+        return;
+
     // The alpha and beta annihilation lists
     a_ann_list_.resize(dim_space_);
     b_ann_list_.resize(dim_space_);
@@ -1360,6 +1612,9 @@ void CI_RDMS::get_one_map() {
 }
 
 void CI_RDMS::get_two_map() {
+    if (two_map_done_)
+        return;
+
     aa_ann_list_.resize(dim_space_);
     ab_ann_list_.resize(dim_space_);
     bb_ann_list_.resize(dim_space_);
@@ -1497,9 +1752,13 @@ void CI_RDMS::get_two_map() {
             ab_cre_list_[J].push_back(std::make_tuple(I, i, j));
         }
     }
+    two_map_done_ = true;
 }
 
 void CI_RDMS::get_three_map() {
+    if (three_map_done_)
+        return;
+
     aaa_ann_list_.resize(dim_space_);
     aab_ann_list_.resize(dim_space_);
     abb_ann_list_.resize(dim_space_);
@@ -1716,6 +1975,7 @@ void CI_RDMS::get_three_map() {
             bbb_cre_list_[J].push_back(std::make_tuple(I, i, j, k));
         }
     }
+    three_map_done_ = true;
 }
 
 void CI_RDMS::rdm_test(std::vector<double>& oprdm_a, std::vector<double>& oprdm_b,
@@ -29,6 +29,8 @@
 #ifndef _ci_rdms_h_
 #define _ci_rdms_h_
 
+#include <array>
+
 #include "psi4/libmints/matrix.h"
 
 #include "integrals/active_space_integrals.h"
@@ -38,6 +40,8 @@
 
 namespace forte {
 
+class DeterminantSubstitutionLists;
+
 class CI_RDMS {
   public:
     using det_hash = std::unordered_map<Determinant, size_t, Determinant::Hash>;
@@ -85,18 +89,38 @@ class CI_RDMS {
     void compute_2rdm_op(std::vector<double>& tprdm_aa, std::vector<double>& tprdm_ab,
                          std::vector<double>& tprdm_bb);
 
+    /// Compute the (transition) 1-RDMs, or 1- and 2-RDMs if max_rdm_level = 2, of several pairs
+    /// of roots (bra, ket) in a single parallel sweep over coupling lists that are built once.
+    /// On return rdms[n] holds the a, b, aa, ab, and bb blocks of root_pairs[n] (the 2-RDM blocks
+    /// are empty if max_rdm_level = 1)
+    void compute_rdms_op_root_pairs(const std::vector<std::pair<size_t, size_t>>& root_pairs,
+                                    int max_rdm_level,
+                                    std::vector<std::array<std::vector<double>, 5>>& rdms);
+
     void compute_3rdm(std::vector<double>& tprdm_aaa, std::vector<double>& tprdm_aab,
                       std::vector<double>& tprdm_abb, std::vector<double>& tprdm_bbb);
 
     void compute_3rdm_op(std::vector<double>& tprdm_aaa, std::vector<double>& tprdm_aab,
                          std::vector<double>& tprdm_abb, std::vector<double>& tprdm_bbb);
 
+    /// Compute the (transition) 3-RDMs of several pairs of roots (bra, ket) from three-body
+    /// coupling lists that are built once. On return rdms[n] holds the aaa, aab, abb, and bbb
+    /// blocks of root_pairs[n]
+    void compute_3rdm_op_root_pairs(const std::vector<std::pair<size_t, size_t>>& root_pairs,
+                                    std::vector<std::array<std::vector<double>, 4>>& rdms);
+
     void compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<double>& oprdm_b,
                               std::vector<double>& tprdm_aa, std::vector<double>& tprdm_ab,
                               std::vector<double>& tprdm_bb, std::vector<double>& tprdm_aaa,
                               std::vector<double>& tprdm_aab, std::vector<double>& tprdm_abb,
                               std::vector<double>& tprdm_bbb);
 
+    /// Compute only the a, ab, and aab blocks of the 1-, 2-, and 3-RDMs with the dynamic
+    /// algorithm. Valid for Ms = 0 states, where the other blocks follow from spin symmetry (see
+    /// the ms_avg constructors of RDMs). Saves three quarters of the 3-RDM memory
+    void compute_rdms_dynamic_ms_avg(std::vector<double>& oprdm_a, std::vector<double>& tprdm_ab,
+                                     std::vector<double>& tprdm_aab);
+
     double get_energy(std::vector<double>& oprdm_a, std::vector<double>& oprdm_b,
                       std::vector<double>& tprdm_aa, std::vector<double>& tprdm_bb,
                       std::vector<double>& tprdm_ab);
@@ -109,6 +133,13 @@ class CI_RDMS {
 
     void set_print(bool print) { print_ = print; }
 
+    /// Change the bra (root1) and ket (root2) roots. The coupling maps only depend on the
+    /// determinant space and are reused by the following calls.
+    void set_roots(int root1, int root2) {
+        root1_ = root1;
+        root2_ = root2;
+    }
+
     void set_max_rdm(int rdm);
 
     // Convert to strings
@@ -158,6 +189,9 @@ class CI_RDMS {
 
     // Has the one-map been constructed?
     bool one_map_done_;
+    // Have the two- and three-maps been constructed?
+    bool two_map_done_ = false;
+    bool three_map_done_ = false;
 
     bool print_;
 
@@ -213,6 +247,11 @@ class CI_RDMS {
     // Startup function, mostly just gathering all variables
     void startup();
 
+    /// Compute the 3-RDMs of the pair (root1_, root2_) from the three-body coupling lists of op
+    void compute_3rdm_op(const DeterminantSubstitutionLists& op, std::vector<double>& tprdm_aaa,
+                         std::vector<double>& tprdm_aab, std::vector<double>& tprdm_abb,
+                         std::vector<double>& tprdm_bbb);
+
     // Generate one-particle map
     void get_one_map();
 
@@ -229,9 +268,24 @@ class CI_RDMS {
                    int u, bool half = false);
 
     // Function to build non-trivial mixed-spin components of 1-, 2-, and 3- RDMs
-    void make_ab(SortedStringList a_sorted_string_list_, const std::vector<String>& sorted_astr,
+    void make_ab(bool ms_avg, const SortedStringList& a_sorted_string_list_,
+                 const std::vector<String>& sorted_astr,
                  const std::vector<Determinant>& sorted_a_dets, std::vector<double>& tprdm_ab,
                  std::vector<double>& tprdm_aab, std::vector<double>& tprdm_abb);
+
+    // Build the RDM blocks (a, b, aa, ab, bb, aaa, aab, abb, bbb) with the dynamic algorithm. If
+    // ms_avg is true only the a, ab, and aab blocks are computed and the others are not touched
+    void build_rdms_dynamic(bool ms_avg, const std::array<std::vector<double>*, 9>& rdms);
+
+    // Add the contributions of the strings assigned to this thread to one tile of the RDMs. Must
+    // be called by all the threads of a parallel region
+    void compute_rdms_dynamic_tile(
+        bool ms_avg, const SortedStringList& a_sorted_string_list_,
+        const SortedStringList& b_sorted_string_list_, std::vector<double>& oprdm_a,
+        std::vector<double>& oprdm_b, std::vector<double>& tprdm_aa,
+        std::vector<double>& tprdm_ab, std::vector<double>& tprdm_bb,
+        std::vector<double>& tprdm_aaa, std::vector<double>& tprdm_aab,
+        std::vector<double>& tprdm_abb, std::vector<double>& tprdm_bbb);
 };
 } // namespace forte
 
@@ -26,17 +26,28 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+#include <array>
+
 #include "psi4/libmints/molecule.h"
 #include "psi4/libmints/wavefunction.h"
 
 #include "psi4/libpsi4util/process.h"
 
+#include "helpers/memory_manager.h"
 #include "helpers/timer.h"
 #include "ci_rdms.h"
 #include "base_classes/mo_space_info.h"
 #include "base_classes/rdms.h"
 #include "sparse_ci/determinant.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
 using namespace psi;
 
 namespace forte {
@@ -46,27 +57,108 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                                    std::vector<double>& tprdm_bb, std::vector<double>& tprdm_aaa,
                                    std::vector<double>& tprdm_aab, std::vector<double>& tprdm_abb,
                                    std::vector<double>& tprdm_bbb) {
+    build_rdms_dynamic(false, {&oprdm_a, &oprdm_b, &tprdm_aa, &tprdm_ab, &tprdm_bb, &tprdm_aaa,
+                               &tprdm_aab, &tprdm_abb, &tprdm_bbb});
+}
 
-    oprdm_a.resize(ncmo2_, 0.0);
-    oprdm_b.resize(ncmo2_, 0.0);
+void CI_RDMS::compute_rdms_dynamic_ms_avg(std::vector<double>& oprdm_a,
+                                          std::vector<double>& tprdm_ab,
+                                          std::vector<double>& tprdm_aab) {
+    // the blocks that are not accumulated are never touched and stay empty
+    std::vector<double> unused;
+    build_rdms_dynamic(true, {&oprdm_a, &unused, &unused, &tprdm_ab, &unused, &unused,
+                              &tprdm_aab, &unused, &unused});
+}
 
-    tprdm_aa.resize(ncmo4_, 0.0);
-    tprdm_ab.resize(ncmo4_, 0.0);
-    tprdm_bb.resize(ncmo4_, 0.0);
+void CI_RDMS::build_rdms_dynamic(bool ms_avg, const std::array<std::vector<double>*, 9>& rdms) {
+    ProfileRegion region("CI_RDMS::build_rdms_dynamic");
+    // The blocks are ordered as a, b, aa, ab, bb, aaa, aab, abb, bbb. With ms_avg only a, ab, and
+    // aab are accumulated, the other blocks follow from spin symmetry (see RDMs)
+    const size_t ncmo6 = ncmo5_ * ncmo_;
+    const size_t sizes[9] = {ncmo2_, ncmo2_, ncmo4_, ncmo4_, ncmo4_, ncmo6, ncmo6, ncmo6, ncmo6};
+    bool accumulate[9];
+    size_t tile_size = 0;
+    for (int n = 0; n < 9; ++n) {
+        accumulate[n] = (not ms_avg) or (n == 0) or (n == 3) or (n == 6);
+        if (accumulate[n]) {
+            rdms[n]->resize(sizes[n], 0.0);
+            tile_size += sizes[n];
+        }
+    }
+
+    SortedStringList a_sorted_string_list(wfn_, fci_ints_, DetSpinType::Alpha);
+    SortedStringList b_sorted_string_list(wfn_, fci_ints_, DetSpinType::Beta);
+
+    // Each thread accumulates into its own copy (tile) of the RDMs, as many as fit in half of the
+    // memory. Thread 0 accumulates directly into the output
+    const size_t tile_bytes = tile_size * sizeof(double);
+    const size_t max_tiles =
+        1 + MemoryManager::instance().budget(0.5) / std::max(size_t(1), tile_bytes);
+    const int ntiles = static_cast<int>(
+        std::min(static_cast<size_t>(omp_get_max_threads()), std::max(size_t(1), max_tiles)));
+    std::vector<std::array<std::vector<double>, 9>> tiles(ntiles - 1);
+    MemoryReservation tiles_reservation("RDMs", (ntiles - 1) * tile_bytes);
+
+    local_timer build;
+#pragma omp parallel num_threads(ntiles)
+    {
+        const int t = omp_get_thread_num();
+        if (t == 0) {
+            compute_rdms_dynamic_tile(ms_avg, a_sorted_string_list, b_sorted_string_list,
+                                      *rdms[0], *rdms[1], *rdms[2], *rdms[3], *rdms[4], *rdms[5],
+                                      *rdms[6], *rdms[7], *rdms[8]);
+        } else {
+            auto& tile = tiles[t - 1];
+            for (int n = 0; n < 9; ++n) {
+                if (accumulate[n]) {
+                    tile[n].assign(sizes[n], 0.0);
+                }
+            }
+            compute_rdms_dynamic_tile(ms_avg, a_sorted_string_list, b_sorted_string_list,
+                                      tile[0], tile[1], tile[2], tile[3], tile[4], tile[5],
+                                      tile[6], tile[7], tile[8]);
+        }
+    }
 
-    tprdm_aaa.resize(ncmo5_ * ncmo_, 0.0);
-    tprdm_aab.resize(ncmo5_ * ncmo_, 0.0);
-    tprdm_abb.resize(ncmo5_ * ncmo_, 0.0);
-    tprdm_bbb.resize(ncmo5_ * ncmo_, 0.0);
+    // Add the tiles to the output, in blocks of elements distributed over the threads
+    local_timer reduce;
+    constexpr size_t block_size = 4096;
+    for (int n = 0; n < 9 and ntiles > 1; ++n) {
+        if (not accumulate[n]) {
+            continue;
+        }
+        double* rdm = rdms[n]->data();
+        const size_t size = rdms[n]->size();
+        const size_t nblocks = (size + block_size - 1) / block_size;
+#pragma omp parallel for schedule(static)
+        for (size_t block = 0; block < nblocks; ++block) {
+            const size_t begin = block * block_size;
+            const size_t end = std::min(size, begin + block_size);
+            for (const auto& tile : tiles) {
+                const double* tile_rdm = tile[n].data();
+                for (size_t k = begin; k < end; ++k) {
+                    rdm[k] += tile_rdm[k];
+                }
+            }
+        }
+    }
+    outfile->Printf("\n  Built the RDMs with %d thread(s) in %1.6f s (reduction: %1.6f s)", ntiles,
+                    build.get(), reduce.get());
+}
 
-    SortedStringList a_sorted_string_list_(wfn_, fci_ints_, DetSpinType::Alpha);
-    SortedStringList b_sorted_string_list_(wfn_, fci_ints_, DetSpinType::Beta);
+void CI_RDMS::compute_rdms_dynamic_tile(
+    bool ms_avg, const SortedStringList& a_sorted_string_list_,
+    const SortedStringList& b_sorted_string_list_, std::vector<double>& oprdm_a,
+    std::vector<double>& oprdm_b, std::vector<double>& tprdm_aa, std::vector<double>& tprdm_ab,
+    std::vector<double>& tprdm_bb, std::vector<double>& tprdm_aaa, std::vector<double>& tprdm_aab,
+    std::vector<double>& tprdm_abb, std::vector<double>& tprdm_bbb) {
     const std::vector<String>& sorted_bstr = b_sorted_string_list_.sorted_half_dets();
     size_t num_bstr = sorted_bstr.size();
     const auto& sorted_b_dets = b_sorted_string_list_.sorted_dets();
     const auto& sorted_a_dets = a_sorted_string_list_.sorted_dets();
     local_timer diag;
     //*-  Diagonal Contributions  -*//
+#pragma omp for schedule(dynamic, 64)
     for (size_t I = 0; I < dim_space_; ++I) {
         size_t Ia = b_sorted_string_list_.add(I);
         double CIa = evecs_->get(Ia, root1_) * evecs_->get(Ia, root2_);
@@ -81,19 +173,21 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
             det_a.clear_first_one();
             for (size_t ndaa = nda; ndaa < na_; ++ndaa) {
                 int q = det_ac.find_first_one();
-                // aa 2-rdm
-                tprdm_aa[p * ncmo3_ + q * ncmo2_ + p * ncmo_ + q] += CIa;
-                tprdm_aa[q * ncmo3_ + p * ncmo2_ + q * ncmo_ + p] += CIa;
-                tprdm_aa[p * ncmo3_ + q * ncmo2_ + q * ncmo_ + p] -= CIa;
-                tprdm_aa[q * ncmo3_ + p * ncmo2_ + p * ncmo_ + q] -= CIa;
-
                 det_ac.clear_first_one();
-                // aaa 3rdm
-                String det_acc(det_ac);
-                for (size_t ndaaa = ndaa + 1; ndaaa < na_; ++ndaaa) {
-                    size_t r = det_acc.find_first_one();
-                    fill_3rdm(tprdm_aaa, CIa, p, q, r, p, q, r, true);
-                    det_acc.clear_first_one();
+                if (not ms_avg) {
+                    // aa 2-rdm
+                    tprdm_aa[p * ncmo3_ + q * ncmo2_ + p * ncmo_ + q] += CIa;
+                    tprdm_aa[q * ncmo3_ + p * ncmo2_ + q * ncmo_ + p] += CIa;
+                    tprdm_aa[p * ncmo3_ + q * ncmo2_ + q * ncmo_ + p] -= CIa;
+                    tprdm_aa[q * ncmo3_ + p * ncmo2_ + p * ncmo_ + q] -= CIa;
+
+                    // aaa 3rdm
+                    String det_acc(det_ac);
+                    for (size_t ndaaa = ndaa + 1; ndaaa < na_; ++ndaaa) {
+                        size_t r = det_acc.find_first_one();
+                        fill_3rdm(tprdm_aaa, CIa, p, q, r, p, q, r, true);
+                        det_acc.clear_first_one();
+                    }
                 }
 
                 // aab 3rdm
@@ -120,6 +214,10 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                 det_bc.clear_first_one();
             }
         }
+        // the diagonal contributions of the beta strings only enter b, bb, abb, and bbb
+        if (ms_avg) {
+            continue;
+        }
         det_a = sorted_b_dets[I].get_alfa_bits();
         det_b = sorted_b_dets[I].get_beta_bits();
         size_t Ib = a_sorted_string_list_.add(I);
@@ -166,12 +264,14 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
             det_b.clear_first_one();
         }
     }
+#pragma omp master
     outfile->Printf("\n  Diag takes %1.6f", diag.get());
 
     local_timer aaa;
     //-* All Alpha RDMs *-//
 
-    // loop through all beta strings
+    // loop through all beta strings, distributing the strings over the threads
+#pragma omp for schedule(dynamic)
     for (size_t bstr = 0; bstr < num_bstr; ++bstr) {
         const String& Ib = sorted_bstr[bstr];
         const auto& range_I = b_sorted_string_list_.range(Ib);
@@ -208,15 +308,17 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                     Iac ^= Ia_sub;
                     for (size_t nbit_a = 1; nbit_a < na_; nbit_a++) {
                         uint64_t m = Iac.find_first_one();
-                        tprdm_aa[p * ncmo3_ + m * ncmo2_ + q * ncmo_ + m] += value;
-                        tprdm_aa[m * ncmo3_ + p * ncmo2_ + q * ncmo_ + m] -= value;
-                        tprdm_aa[m * ncmo3_ + p * ncmo2_ + m * ncmo_ + q] += value;
-                        tprdm_aa[p * ncmo3_ + m * ncmo2_ + m * ncmo_ + q] -= value;
-
-                        tprdm_aa[q * ncmo3_ + m * ncmo2_ + p * ncmo_ + m] += value;
-                        tprdm_aa[m * ncmo3_ + q * ncmo2_ + p * ncmo_ + m] -= value;
-                        tprdm_aa[m * ncmo3_ + q * ncmo2_ + m * ncmo_ + p] += value;
-                        tprdm_aa[q * ncmo3_ + m * ncmo2_ + m * ncmo_ + p] -= value;
+                        if (not ms_avg) {
+                            tprdm_aa[p * ncmo3_ + m * ncmo2_ + q * ncmo_ + m] += value;
+                            tprdm_aa[m * ncmo3_ + p * ncmo2_ + q * ncmo_ + m] -= value;
+                            tprdm_aa[m * ncmo3_ + p * ncmo2_ + m * ncmo_ + q] += value;
+                            tprdm_aa[p * ncmo3_ + m * ncmo2_ + m * ncmo_ + q] -= value;
+
+                            tprdm_aa[q * ncmo3_ + m * ncmo2_ + p * ncmo_ + m] += value;
+                            tprdm_aa[m * ncmo3_ + q * ncmo2_ + p * ncmo_ + m] -= value;
+                            tprdm_aa[m * ncmo3_ + q * ncmo2_ + m * ncmo_ + p] += value;
+                            tprdm_aa[q * ncmo3_ + m * ncmo2_ + m * ncmo_ + p] -= value;
+                        }
 
                         Iac.clear_first_one();
 
@@ -251,7 +353,7 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                         Ibc.clear_first_one();
 
                         String Ibcc = Ibc;
-                        for (size_t idx = nidx + 1; idx < nb_; ++idx) {
+                        for (size_t idx = nidx + 1; idx < nb_ and not ms_avg; ++idx) {
                             uint64_t m = Ibcc.find_first_one();
                             tprdm_abb[p * ncmo5_ + m * ncmo4_ + n * ncmo3_ + q * ncmo2_ +
                                       m * ncmo_ + n] += value;
@@ -275,7 +377,7 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                     }
                     // 3-rdm
                     String Iacc = Ia ^ Ia_sub;
-                    for (size_t id = 1; id < na_; ++id) {
+                    for (size_t id = 1; id < na_ and not ms_avg; ++id) {
                         uint64_t n = Iacc.find_first_one();
                         String I_n(Iacc);
                         I_n.clear_first_one(); // TODO: not clear what is going on here (Francesco)
@@ -303,23 +405,25 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                     double Csq = CI * evecs_->get(b_sorted_string_list_.add(J), root2_);
                     double value = Csq * Ia.slater_sign(p, q) * Ja.slater_sign(r, s);
 
-                    tprdm_aa[p * ncmo3_ + q * ncmo2_ + r * ncmo_ + s] += value;
-                    tprdm_aa[p * ncmo3_ + q * ncmo2_ + s * ncmo_ + r] -= value;
-                    tprdm_aa[q * ncmo3_ + p * ncmo2_ + r * ncmo_ + s] -= value;
-                    tprdm_aa[q * ncmo3_ + p * ncmo2_ + s * ncmo_ + r] += value;
-
-                    tprdm_aa[r * ncmo3_ + s * ncmo2_ + p * ncmo_ + q] += value;
-                    tprdm_aa[s * ncmo3_ + r * ncmo2_ + p * ncmo_ + q] -= value;
-                    tprdm_aa[r * ncmo3_ + s * ncmo2_ + q * ncmo_ + p] -= value;
-                    tprdm_aa[s * ncmo3_ + r * ncmo2_ + q * ncmo_ + p] += value;
-
-                    // 3-rdm
-                    String Iac(Ia);
-                    Iac ^= Ia_sub;
-                    for (size_t nda = 1; nda < na_; ++nda) {
-                        uint64_t n = Iac.find_first_one();
-                        fill_3rdm(tprdm_aaa, value, p, q, n, r, s, n, false);
-                        Iac.clear_first_one();
+                    if (not ms_avg) {
+                        tprdm_aa[p * ncmo3_ + q * ncmo2_ + r * ncmo_ + s] += value;
+                        tprdm_aa[p * ncmo3_ + q * ncmo2_ + s * ncmo_ + r] -= value;
+                        tprdm_aa[q * ncmo3_ + p * ncmo2_ + r * ncmo_ + s] -= value;
+                        tprdm_aa[q * ncmo3_ + p * ncmo2_ + s * ncmo_ + r] += value;
+
+                        tprdm_aa[r * ncmo3_ + s * ncmo2_ + p * ncmo_ + q] += value;
+                        tprdm_aa[s * ncmo3_ + r * ncmo2_ + p * ncmo_ + q] -= value;
+                        tprdm_aa[r * ncmo3_ + s * ncmo2_ + q * ncmo_ + p] -= value;
+                        tprdm_aa[s * ncmo3_ + r * ncmo2_ + q * ncmo_ + p] += value;
+
+                        // 3-rdm
+                        String Iac(Ia);
+                        Iac ^= Ia_sub;
+                        for (size_t nda = 1; nda < na_; ++nda) {
+                            uint64_t n = Iac.find_first_one();
+                            fill_3rdm(tprdm_aaa, value, p, q, n, r, s, n, false);
+                            Iac.clear_first_one();
+                        }
                     }
 
                     String Ibc = Ib;
@@ -345,7 +449,7 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                         Ibc.clear_first_one();
                     }
 
-                } else if (ndiff == 6) {
+                } else if (ndiff == 6 and not ms_avg) {
                     auto Ia_sub = Ia & IJa;
                     uint64_t p = Ia_sub.find_first_one();
                     Ia_sub.clear_first_one();
@@ -367,6 +471,7 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
             }
         }
     }
+#pragma omp master
     outfile->Printf("\n all alpha takes %1.6f", aaa.get());
 
     //- All beta RDMs -//
@@ -374,6 +479,7 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
     // loop through all alpha strings
     const std::vector<String>& sorted_astr = a_sorted_string_list_.sorted_half_dets();
     size_t num_astr = sorted_astr.size();
+#pragma omp for schedule(dynamic)
     for (size_t astr = 0; astr < num_astr; ++astr) {
         const String& Ia = sorted_astr[astr];
         const auto& range_I = a_sorted_string_list_.range(Ia);
@@ -401,11 +507,13 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                     double Csq = CI * evecs_->get(a_sorted_string_list_.add(J), root2_);
 
                     double value = Csq * Ib.slater_sign(p, q);
-                    oprdm_b[p * ncmo_ + q] += value;
-                    oprdm_b[q * ncmo_ + p] += value;
                     auto Ibc = Ib;
                     Ibc ^= Ib_sub;
-                    for (size_t ndb = 1; ndb < nb_; ++ndb) {
+                    if (not ms_avg) {
+                        oprdm_b[p * ncmo_ + q] += value;
+                        oprdm_b[q * ncmo_ + p] += value;
+                    }
+                    for (size_t ndb = 1; ndb < nb_ and not ms_avg; ++ndb) {
                         uint64_t m = Ibc.find_first_one();
                         tprdm_bb[p * ncmo3_ + m * ncmo2_ + q * ncmo_ + m] += value;
                         tprdm_bb[m * ncmo3_ + p * ncmo2_ + q * ncmo_ + m] -= value;
@@ -475,7 +583,7 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                     // 3-rdm
                     String Ibcc(Ib);
                     Ibcc ^= Ib_sub;
-                    for (size_t ndb = 1; ndb < nb_; ++ndb) {
+                    for (size_t ndb = 1; ndb < nb_ and not ms_avg; ++ndb) {
                         // while(Ibcc >0){
                         uint64_t n = Ibcc.find_first_one();
                         Ibcc.clear_first_one();
@@ -487,7 +595,7 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
                             I_n.clear_first_one();
                         }
                     }
-                } else if (ndiff == 4) {
+                } else if (ndiff == 4 and not ms_avg) {
                     auto Ib_sub = Ib & IJb;
                     uint64_t p = Ib_sub.find_first_one();
                     Ib_sub.clear_first_one();
@@ -541,7 +649,7 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
 
                         Iac.clear_first_one();
                     }
-                } else if (ndiff == 6) {
+                } else if (ndiff == 6 and not ms_avg) {
                     auto Ib_sub = Ib & IJb;
                     uint64_t p = Ib_sub.find_first_one();
                     Ib_sub.clear_first_one();
@@ -563,18 +671,22 @@ void CI_RDMS::compute_rdms_dynamic(std::vector<double>& oprdm_a, std::vector<dou
             }
         }
     }
+#pragma omp master
     outfile->Printf("\n all beta takes %1.6f", bbb.get());
-    make_ab(a_sorted_string_list_, sorted_astr, sorted_a_dets, tprdm_ab, tprdm_aab, tprdm_abb);
+    make_ab(ms_avg, a_sorted_string_list_, sorted_astr, sorted_a_dets, tprdm_ab, tprdm_aab,
+            tprdm_abb);
 }
 //*- Alpha/Beta  -*//
-void CI_RDMS::make_ab(SortedStringList a_sorted_string_list_,
+void CI_RDMS::make_ab(bool ms_avg, const SortedStringList& a_sorted_string_list_,
                       const std::vector<String>& sorted_astr,
                       const std::vector<Determinant>& sorted_a_dets, std::vector<double>& tprdm_ab,
                       std::vector<double>& tprdm_aab, std::vector<double>& tprdm_abb) {
     local_timer mix;
     double d2 = 0.0;
     double d4 = 0.0;
-    for (auto& detIa : sorted_astr) {
+#pragma omp for schedule(dynamic)
+    for (size_t astr = 0; astr < sorted_astr.size(); ++astr) {
+        const String& detIa = sorted_astr[astr];
         const auto& range_I = a_sorted_string_list_.range(detIa);
         String detIJa_common;
         String Ib;
@@ -632,7 +744,7 @@ void CI_RDMS::make_ab(SortedStringList a_sorted_string_list_,
                             }
                             auto Ibc(Ib);
                             Ibc ^= Ib_sub;
-                            for (size_t d = 1; d < nb_; ++d) {
+                            for (size_t d = 1; d < nb_ and not ms_avg; ++d) {
                                 uint64_t n = Ibc.find_first_one();
                                 tprdm_abb[p * ncmo5_ + q * ncmo4_ + n * ncmo3_ + s * ncmo2_ +
                                           r * ncmo_ + n] += value;
@@ -645,7 +757,7 @@ void CI_RDMS::make_ab(SortedStringList a_sorted_string_list_,
 
                                 Ibc.clear_first_one();
                             }
-                        } else if (nbdiff == 4) {
+                        } else if (nbdiff == 4 and not ms_avg) {
                             double Csq = CI * evecs_->get(a_sorted_string_list_.add(J), root2_);
                             auto Ib_sub = Ib & IJb;
                             uint64_t q = Ib_sub.find_first_one();
@@ -726,8 +838,11 @@ void CI_RDMS::make_ab(SortedStringList a_sorted_string_list_,
             }
         }
     }
-    outfile->Printf("\n  2dif: %1.6f  \n  4dif: %1.6f", d2, d4);
-    outfile->Printf("\n all alpha/beta takes %1.6f", mix.get());
+#pragma omp master
+    {
+        outfile->Printf("\n  2dif: %1.6f  \n  4dif: %1.6f", d2, d4);
+        outfile->Printf("\n all alpha/beta takes %1.6f", mix.get());
+    }
 }
 
 void CI_RDMS::fill_3rdm(std::vector<double>& tprdm, double el, int p, int q, int r, int s, int t,
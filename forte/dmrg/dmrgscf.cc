@@ -48,6 +48,7 @@
 #include <iostream>
 #include <stdlib.h>
 #include <cmath>
+#include <cstdio>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -504,6 +505,7 @@ double DMRGSCF::compute_energy() {
     const int ndmrg_noiseprefactors = options_->get_double_list("DMRG_NOISEPREFACTORS").size();
     const bool dmrg_print_corr = options_->get_bool("DMRG_PRINT_CORR");
     const bool mps_chkpt = options_->get_bool("DMRG_CHKPT");
+    const bool reuse_mps = options_->get_bool("DMRG_REUSE_MPS");
     // int * frozen_docc                 =
     // options_->get_int_array("FROZEN_DOCC");
     // int * active                      = options_->get_int_array("ACTIVE");
@@ -609,6 +611,32 @@ double DMRGSCF::compute_energy() {
         }
     }
 
+    // When the DMRG sweeps restart from the MPS of the previous macroiteration the warm-up
+    // instructions (small bond dimensions) are skipped and only the last one is repeated
+    const int last = ndmrg_states - 1;
+    CheMPS2::ConvergenceScheme* RestartScheme = new CheMPS2::ConvergenceScheme(1);
+    if (ndmrg_davidson_tol != ndmrg_states) {
+        RestartScheme->setInstruction(0, dmrg_states[last], dmrg_econv[last],
+                                      dmrg_maxsweeps[last], dmrg_noiseprefactors[last]);
+    } else {
+        RestartScheme->set_instruction(0, dmrg_states[last], dmrg_econv[last],
+                                       dmrg_maxsweeps[last], dmrg_noiseprefactors[last],
+                                       dmrg_davidson_tol[last]);
+    }
+
+    // The MPS of each root is stored by CheMPS2 in the working directory
+    auto remove_mps_files = [&]() {
+        for (int root = 0; root < dmrgscf_which_root; root++) {
+            std::remove(
+                (CheMPS2::DMRG_MPS_storage_prefix + std::to_string(root) + ".h5").c_str());
+        }
+    };
+    // An MPS left over by another computation is not used unless DMRG_CHKPT is set
+    if (reuse_mps and (not mps_chkpt)) {
+        remove_mps_files();
+    }
+    bool mps_available = false;
+
     /******************************************************************************
      *   Print orbital information; check consistency of frozen_docc and active
      **
@@ -954,6 +982,8 @@ double DMRGSCF::compute_energy() {
             buildHamDMRG(ints, Aorbs_ptr, theTmatrix, theQmatOCC, iHandler, HamDMRG, psio);
             outfile->Printf("\n  Rotated the active space to localized orbitals, sorted according "
                             "to the exchange matrix.");
+            // the MPS of the previous iteration is not a good guess for the rotated orbitals
+            mps_available = false;
         }
 
         // Do the DMRG sweeps, and calculate the 2DM
@@ -971,7 +1001,14 @@ double DMRGSCF::compute_energy() {
                 DMRG2DM[cnt] = 0.0;
             } // Clear the 2-RDM (to allow for state-averaged calculations)
             const string psi4TMPpath = psi::PSIOManager::shared_object()->get_default_path();
-            CheMPS2::DMRG* theDMRG = new CheMPS2::DMRG(Prob, OptScheme, mps_chkpt, psi4TMPpath);
+            const bool restart = reuse_mps and mps_available;
+            if (restart) {
+                outfile->Printf("\n  Restarting the DMRG sweeps from the MPS of the previous "
+                                "iteration (D = %d).",
+                                dmrg_states[last]);
+            }
+            CheMPS2::DMRG* theDMRG = new CheMPS2::DMRG(Prob, restart ? RestartScheme : OptScheme,
+                                                       mps_chkpt or reuse_mps, psi4TMPpath);
             for (int state = 0; state < dmrgscf_which_root; state++) {
                 if (state > 0) {
                     theDMRG->newExcitation(std::fabs(Energy));
@@ -1009,6 +1046,7 @@ double DMRGSCF::compute_energy() {
                 theDMRG->get3DM()->fill_ham_index(1.0, false, DMRG3DM, 0, nOrbDMRG);
             }
             delete theDMRG;
+            mps_available = reuse_mps;
 
             std::cout.rdbuf(cout_buffer);
             capturing.close();
@@ -1037,6 +1075,7 @@ double DMRGSCF::compute_energy() {
             buildQmatOCC(theQmatOCC, iHandler, work1, work2, ints_->Ca(), myJK);
             outfile->Printf(
                 "\n  Rotated the active space to natural orbitals, sorted according to the NOON.");
+            mps_available = false;
         }
 
         if (dmrg_iterations_ == nIterations) {
@@ -1117,13 +1156,17 @@ double DMRGSCF::compute_energy() {
     delete iHandler;
 
     delete OptScheme;
+    delete RestartScheme;
+    if (reuse_mps and (not mps_chkpt)) {
+        remove_mps_files();
+    }
     delete Prob;
     delete HamDMRG;
 
     outfile->Printf("The DMRG-SCF energy = %3.10f \n", Energy);
     psi::Process::environment.globals["CURRENT ENERGY"] = Energy;
     psi::Process::environment.globals["DMRGSCF ENERGY"] = Energy;
-    dmrg_ref_.set_Eref(Energy);
+    dmrg_rdms_.set_Eref(Energy);
     return Energy;
 }
 void DMRGSCF::compute_reference(double* one_rdm, double* two_rdm, double* three_rdm,
@@ -1272,7 +1315,7 @@ void DMRGSCF::compute_reference(double* one_rdm, double* two_rdm, double* three_
         dmrg_ref.set_L3abb(gamma3_abb);
         dmrg_ref.set_L3bbb(gamma3_aaa);
     }
-    dmrg_ref_ = dmrg_ref;
+    dmrg_rdms_ = dmrg_ref;
 }
 } // namespace forte
 
@@ -41,6 +41,7 @@
 #include "psi4/libtrans/integraltransform.h"
 #include "psi4/psi4-dec.h"
 #include "psi4/psifiles.h"
+#include "psi4/libpsi4util/process.h"
 // Header above this comment contains typedef std::shared_ptr<psi::Matrix>
 // psi::SharedMatrix;
 #include "psi4/libciomr/libciomr.h"
@@ -49,6 +50,7 @@
 // Header above allows to obtain "filename.moleculename" with
 // psi::get_writer_file_prefix()
 
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <stdlib.h>
@@ -228,7 +230,7 @@ void DMRGSolver::compute_reference(double* one_rdm, double* two_rdm, double* thr
         dmrg_ref.set_L3abb(gamma3_abb);
         dmrg_ref.set_L3bbb(gamma3_aaa);
     }
-    dmrg_ref_ = dmrg_ref;
+    dmrg_rdms_ = dmrg_ref;
 }
 void DMRGSolver::compute_energy() {
     const int wfn_irrep = options_->get_int("ROOT_SYM");
@@ -429,9 +431,16 @@ void DMRGSolver::compute_energy() {
     /// DMRG can compute the 2DM pretty simply.  Always compute it
     double* DMRG1DM = new double[nOrbDMRG * nOrbDMRG];
     double* DMRG2DM = new double[nOrbDMRG * nOrbDMRG * nOrbDMRG * nOrbDMRG];
-    if (nOrbDMRG > 30) {
-        outfile->Printf("\n  Using a disk based 3 rdm storage");
-        disk_3_rdm_ = true;
+    // The 3-RDM is handed over in memory through the RDMs object. CheMPS2 keeps it on disk only
+    // when the spin-free 3-RDM and its four spin components do not fit in memory
+    if (max_rdm_ > 2 and not disk_3_rdm_) {
+        const double n6 = std::pow(static_cast<double>(nOrbDMRG), 6);
+        const double rdm3_memory = 6.0 * n6 * sizeof(double);
+        if (rdm3_memory > 0.8 * static_cast<double>(psi::Process::environment.get_memory())) {
+            outfile->Printf("\n  Using a disk based 3 rdm storage (%.2f GB required in memory)",
+                            rdm3_memory / 1073741824.0);
+            disk_3_rdm_ = true;
+        }
     }
     double* DMRG3DM;
     if (max_rdm_ > 2 && !disk_3_rdm_)
@@ -505,12 +514,12 @@ void DMRGSolver::compute_energy() {
     if (options_->get_bool("PRINT_NO")) {
         print_natural_orbitals(DMRG1DM);
     }
-    dmrg_ref_.set_Eref(Energy);
+    dmrg_rdms_.set_Eref(Energy);
 
     delete[] DMRG1DM;
     delete[] DMRG2DM;
     delete[] orbitalIrreps;
-    if (max_rdm_ > 2) {
+    if (max_rdm_ > 2 && !disk_3_rdm_) {
         delete[] DMRG3DM;
     }
 }
@@ -10,7 +10,11 @@
  *
  */
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 //#define BIN_GRAPH_TEST
@@ -106,7 +110,7 @@ class BinaryGraph {
                 add += weight0[n][h][k];
             }
         }
-        return (add + offset[h]);
+        return (compact_add(h, add) + offset[h]);
     }
 
     size_t abs_add(std::vector<bool>& string) {
@@ -123,7 +127,7 @@ class BinaryGraph {
                 add += weight0[n][h][k];
             }
         }
-        return (add + offset[h]);
+        return (compact_add(h, add) + offset[h]);
     }
 
     size_t rel_add(bool* string) {
@@ -140,7 +144,7 @@ class BinaryGraph {
                 add += weight0[n][h][k];
             }
         }
-        return add;
+        return compact_add(h, add);
     }
 
     size_t rel_add(std::vector<bool>& string) {
@@ -157,7 +161,7 @@ class BinaryGraph {
                 add += weight0[n][h][k];
             }
         }
-        return add;
+        return compact_add(h, add);
     }
 
     int sym(bool* string) {
@@ -199,7 +203,77 @@ class BinaryGraph {
     int nones() const { return nones_; }
     int nirrep() const { return nirrep_; }
 
+    /// The address returned for strings excluded by the restrictions
+    static constexpr size_t excluded = std::numeric_limits<size_t>::max();
+    /// The maximum number of restricted spaces
+    static constexpr size_t max_spaces = 8;
+
+    /**
+     * @brief Restrict the strings to those with between gas_min[g] and gas_max[g] ones in the
+     *        bits of each space g (e.g., the electrons of one spin in each GAS)
+     *
+     * After this call the strings are numbered within the allowed ones: strpi() returns the
+     * number of allowed strings and abs_add()/rel_add() their compact addresses. The address of
+     * a string that is not allowed is BinaryGraph::excluded, use allowed() to test a string.
+     * @param bit_space the space of each bit (-1 for bits with no restrictions)
+     */
+    void set_restrictions(const std::vector<int>& bit_space, const std::vector<int>& gas_min,
+                          const std::vector<int>& gas_max) {
+        if ((gas_min.size() != gas_max.size()) or (gas_min.size() > max_spaces) or
+            (static_cast<int>(bit_space.size()) != nbits_)) {
+            throw std::runtime_error("BinaryGraph::set_restrictions: inconsistent restrictions");
+        }
+        restricted_ = false;
+        bit_space_ = bit_space;
+        gas_min_ = gas_min;
+        gas_max_ = gas_max;
+        std::vector<std::vector<size_t>> compact(nirrep_);
+        for (int h = 0; h < nirrep_; ++h) {
+            compact[h].assign(strpi_[h], excluded);
+        }
+        std::vector<size_t> nallowed(nirrep_, 0);
+        std::vector<bool> I(nbits_, false);
+        std::fill(I.begin() + std::max(0, nbits_ - nones_), I.end(), true);
+        do {
+            if (allowed(I)) {
+                const int h = sym(I);
+                compact[h][rel_add(I)] = nallowed[h]++;
+            }
+        } while (std::next_permutation(I.begin(), I.end()));
+
+        compact_add_ = std::move(compact);
+        restricted_ = true;
+        for (int h = 0; h < nirrep_; ++h) {
+            strpi_[h] = nallowed[h];
+            offset[h] = (h == 0) ? 0 : offset[h - 1] + strpi_[h - 1];
+        }
+    }
+
+    /// Are the strings restricted?
+    bool restricted() const { return restricted_; }
+
+    /// Is a string allowed by the restrictions?
+    template <typename String> bool allowed(const String& string) const {
+        if (gas_min_.empty())
+            return true;
+        std::array<int, max_spaces> count{};
+        for (int n = 0; n < nbits_; ++n) {
+            if (string[n] and bit_space_[n] >= 0)
+                count[bit_space_[n]] += 1;
+        }
+        for (size_t g = 0; g < gas_min_.size(); ++g) {
+            if ((count[g] < gas_min_[g]) or (count[g] > gas_max_[g]))
+                return false;
+        }
+        return true;
+    }
+
   private:
+    /// Map the address of a string in the full graph to its compact address
+    size_t compact_add(int h, size_t add) const {
+        return restricted_ ? compact_add_[h][add] : add;
+    }
+
     void startup() {
         if ((nbits_ != 0) and (nones_ > 0)) {
             // Allocate the weight tensors
@@ -306,6 +380,12 @@ class BinaryGraph {
     size_t* offset;            // irrep offset
     size_t*** weight0;         // weights of 1 vertices
     size_t*** weight1;         // weights of 0 vertices
+
+    bool restricted_ = false;          // are the strings restricted?
+    std::vector<int> bit_space_;       // the restricted space of each bit (-1 if none)
+    std::vector<int> gas_min_;         // minimum number of ones in each space
+    std::vector<int> gas_max_;         // maximum number of ones in each space
+    std::vector<std::vector<size_t>> compact_add_; // compact address of each string [h][add]
 };
 
 } // namespace forte
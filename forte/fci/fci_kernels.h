@@ -0,0 +1,211 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _fci_kernels_h_
+#define _fci_kernels_h_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace forte {
+
+/**
+ * @brief Gather the elements of a vector with a sign: out[k] = sign[k] * c[I[k]]
+ * @param n the number of elements to gather
+ * @param sign the signs of each element (+1.0 or -1.0)
+ * @param I the addresses of the elements to gather
+ * @param c the source vector
+ * @param out the destination vector
+ *
+ * If available, this function uses AVX-512 or AVX2 gather instructions.
+ */
+inline void fci_gather_signed(size_t n, const double* sign, const size_t* I, const double* c,
+                              double* out) {
+    size_t k = 0;
+#if defined(__AVX512F__)
+    for (; k + 8 <= n; k += 8) {
+        __m512i idx = _mm512_loadu_si512(reinterpret_cast<const void*>(I + k));
+        __m512d val = _mm512_i64gather_pd(idx, c, sizeof(double));
+        _mm512_storeu_pd(out + k, _mm512_mul_pd(val, _mm512_loadu_pd(sign + k)));
+    }
+#elif defined(__AVX2__)
+    for (; k + 4 <= n; k += 4) {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(I + k));
+        __m256d val = _mm256_i64gather_pd(reinterpret_cast<const double*>(c), idx, sizeof(double));
+        _mm256_storeu_pd(out + k, _mm256_mul_pd(val, _mm256_loadu_pd(sign + k)));
+    }
+#endif
+    for (; k < n; ++k) {
+        out[k] = sign[k] * c[I[k]];
+    }
+}
+
+/**
+ * @brief Scatter and accumulate the elements of a vector: y[J[k]] += x[k]
+ * @param n the number of elements to scatter
+ * @param J the addresses of the destination elements. These must be unique.
+ * @param x the source vector
+ * @param y the destination vector
+ *
+ * If available, this function uses AVX-512 scatter instructions. This function is not
+ * thread safe: two threads must not scatter into the same y at the same time.
+ */
+inline void fci_scatter_add(size_t n, const size_t* J, const double* x, double* y) {
+    size_t k = 0;
+#if defined(__AVX512F__)
+    for (; k + 8 <= n; k += 8) {
+        __m512i idx = _mm512_loadu_si512(reinterpret_cast<const void*>(J + k));
+        __m512d val = _mm512_i64gather_pd(idx, y, sizeof(double));
+        val = _mm512_add_pd(val, _mm512_loadu_pd(x + k));
+        _mm512_i64scatter_pd(y, idx, val, sizeof(double));
+    }
+#endif
+    for (; k < n; ++k) {
+        y[J[k]] += x[k];
+    }
+}
+
+/**
+ * @brief Scatter and accumulate the elements of a vector with atomic updates: y[J[k]] += x[k]
+ * @param n the number of elements to scatter
+ * @param J the addresses of the destination elements
+ * @param x the source vector
+ * @param y the destination vector
+ *
+ * This version can be called by several threads that write to the same y.
+ */
+inline void fci_scatter_add_atomic(size_t n, const size_t* J, const double* x, double* y) {
+    for (size_t k = 0; k < n; ++k) {
+#pragma omp atomic
+        y[J[k]] += x[k];
+    }
+}
+
+// Single precision versions of the kernels used by the mixed precision sigma build. The
+// gathered columns are stored in single precision and accumulated into double precision
+// vectors.
+
+/// @brief Gather the elements of a vector with a sign and convert them to single precision:
+///        out[k] = sign[k] * c[I[k]]
+inline void fci_gather_signed(size_t n, const double* sign, const size_t* I, const double* c,
+                              float* out) {
+    for (size_t k = 0; k < n; ++k) {
+        out[k] = static_cast<float>(sign[k] * c[I[k]]);
+    }
+}
+
+/// @brief Single precision y += a * x
+inline void fci_axpy(size_t n, float a, const float* x, float* y) {
+#pragma omp simd
+    for (size_t k = 0; k < n; ++k) {
+        y[k] += a * x[k];
+    }
+}
+
+/// @brief Scatter and accumulate the elements of a single precision vector: y[J[k]] += x[k]
+inline void fci_scatter_add(size_t n, const size_t* J, const float* x, double* y) {
+    for (size_t k = 0; k < n; ++k) {
+        y[J[k]] += static_cast<double>(x[k]);
+    }
+}
+
+/// @brief Scatter and accumulate the elements of a single precision vector with atomic updates:
+///        y[J[k]] += x[k]
+inline void fci_scatter_add_atomic(size_t n, const size_t* J, const float* x, double* y) {
+    for (size_t k = 0; k < n; ++k) {
+#pragma omp atomic
+        y[J[k]] += static_cast<double>(x[k]);
+    }
+}
+
+/**
+ * @brief Copy the blocks C_n (nrow x ncol) of a set of vectors side by side into a scratch matrix
+ * @param C the row pointers of the blocks
+ * @param nrow the number of rows of each block
+ * @param ncol the number of columns of each block
+ * @param transpose if false S[I][n * ncol + L] = C_n[I][L],
+ *                  otherwise S[L][n * nrow + I] = C_n[I][L]
+ * @param S the scratch matrix
+ * @param Y if not null, the part of this scratch matrix with the same layout as S is zeroed
+ */
+inline void fci_stack_blocks(const std::vector<double**>& C, size_t nrow, size_t ncol,
+                             bool transpose, double** S, double** Y = nullptr) {
+    size_t nvec = C.size();
+    if (transpose) {
+#pragma omp parallel for
+        for (size_t L = 0; L < ncol; ++L) {
+            for (size_t n = 0; n < nvec; ++n) {
+                double* s = S[L] + n * nrow;
+                for (size_t I = 0; I < nrow; ++I)
+                    s[I] = C[n][I][L];
+            }
+            if (Y != nullptr)
+                std::fill_n(Y[L], nvec * nrow, 0.0);
+        }
+    } else {
+#pragma omp parallel for
+        for (size_t I = 0; I < nrow; ++I) {
+            for (size_t n = 0; n < nvec; ++n) {
+                std::copy_n(C[n][I], ncol, S[I] + n * ncol);
+            }
+            if (Y != nullptr)
+                std::fill_n(Y[I], nvec * ncol, 0.0);
+        }
+    }
+}
+
+/**
+ * @brief Add a scratch matrix Y, stored in the layout produced by fci_stack_blocks, to the
+ *        blocks HC_n (nrow x ncol) of a set of vectors
+ */
+inline void fci_add_stacked_blocks(double** Y, size_t nrow, size_t ncol, bool transpose,
+                                   const std::vector<double**>& HC) {
+    size_t nvec = HC.size();
+#pragma omp parallel for
+    for (size_t I = 0; I < nrow; ++I) {
+        for (size_t n = 0; n < nvec; ++n) {
+            double* hc = HC[n][I];
+            if (transpose) {
+                for (size_t L = 0; L < ncol; ++L)
+                    hc[L] += Y[L][n * nrow + I];
+            } else {
+                const double* y = Y[I] + n * ncol;
+                for (size_t L = 0; L < ncol; ++L)
+                    hc[L] += y[L];
+            }
+        }
+    }
+}
+} // namespace forte
+
+#endif // _fci_kernels_h_
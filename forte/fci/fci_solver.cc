@@ -26,14 +26,21 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+
 #include "psi4/libpsi4util/process.h"
 #include "psi4/libmints/molecule.h"
+#include "psi4/libqt/qt.h"
 
 #include "boost/format.hpp"
 
 #include "base_classes/rdms.h"
 #include "base_classes/forte_options.h"
 #include "base_classes/mo_space_info.h"
+#include "base_classes/wave_function_file.h"
 
 #include "integrals/active_space_integrals.h"
 #include "sparse_ci/determinant.h"
@@ -42,10 +49,12 @@
 
 #include "fci_solver.h"
 #include "fci_vector.h"
+#include "fci_workspace.h"
 #include "string_lists.h"
 #include "helpers/helpers.h"
 #include "helpers/printing.h"
 #include "helpers/string_algorithms.h"
+#include "forte-def.h"
 
 #ifdef HAVE_GA
 #include <ga.h>
@@ -62,6 +71,25 @@ namespace forte {
 
 class MOSpaceInfo;
 
+namespace {
+/// The string lists and the converged Davidson-Liu subspaces of the last computation, reused by
+/// the next one when REUSE_SETUP is true (e.g., by the points of a scan with the same active
+/// space). The lists depend only on the orbital spaces and the number of electrons.
+/// The lists of the last computation are also shared, without REUSE_SETUP, with any computation
+/// that starts while they are still in use (e.g., the next macroiteration of a two-step MCSCF).
+struct FCISetupCache {
+    std::vector<size_t> key;
+    std::shared_ptr<StringLists> lists;
+    std::vector<size_t> shared_key;
+    std::weak_ptr<StringLists> shared_lists;
+    /// the subspace of each (symmetry, multiplicity, number of roots)
+    std::map<std::tuple<int, int, size_t>, DavidsonLiuSubspace> subspaces;
+    /// serializes the calls that read and update the cache
+    std::mutex mutex;
+};
+FCISetupCache setup_cache;
+} // namespace
+
 FCISolver::FCISolver(StateInfo state, size_t nroot, std::shared_ptr<MOSpaceInfo> mo_space_info,
                      std::shared_ptr<ActiveSpaceIntegrals> as_ints)
     : ActiveSpaceMethod(state, nroot, mo_space_info, as_ints),
@@ -81,9 +109,59 @@ void FCISolver::set_collapse_per_root(int value) { collapse_per_root_ = value; }
 void FCISolver::set_subspace_per_root(int value) { subspace_per_root_ = value; }
 
 void FCISolver::startup() {
-    // Create the string lists
-    lists_ = std::shared_ptr<StringLists>(
-        new StringLists(twoSubstituitionVVOO, active_dim_, core_mo_, active_mo_, na_, nb_, print_));
+    // Restrictions on the number of electrons in the GAS spaces (only those that exclude some
+    // determinants are passed to the string lists)
+    StringRestrictions restrictions;
+    const auto& gas_min = state_.gas_min();
+    const auto& gas_max = state_.gas_max();
+    std::vector<int> orbital_space(active_dim_.sum(), -1);
+    for (size_t g = 0; g < gas_min.size(); ++g) {
+        const std::string space = "GAS" + std::to_string(g + 1);
+        const size_t size = mo_space_info_->size(space);
+        if ((size == 0) or ((gas_min[g] == 0) and (gas_max[g] >= std::min(2 * size, na_ + nb_))))
+            continue;
+        const int index = restrictions.space_min.size();
+        for (size_t p : mo_space_info_->pos_in_space(space, "ACTIVE")) {
+            orbital_space[p] = index;
+        }
+        restrictions.space_min.push_back(gas_min[g]);
+        restrictions.space_max.push_back(gas_max[g]);
+    }
+    if (not restrictions.space_min.empty()) {
+        restrictions.orbital_space = orbital_space;
+    }
+
+    // Create the string lists or reuse those of the previous computation
+    std::vector<size_t> key{na_, nb_, hole_lists_max_memory_};
+    for (int h = 0; h < active_dim_.n(); ++h) {
+        key.push_back(active_dim_[h]);
+    }
+    key.insert(key.end(), core_mo_.begin(), core_mo_.end());
+    key.insert(key.end(), active_mo_.begin(), active_mo_.end());
+    key.insert(key.end(), orbital_space.begin(), orbital_space.end());
+    key.insert(key.end(), restrictions.space_min.begin(), restrictions.space_min.end());
+    key.insert(key.end(), restrictions.space_max.begin(), restrictions.space_max.end());
+    {
+        std::lock_guard<std::mutex> lock(setup_cache.mutex);
+        if (reuse_setup_ and setup_cache.lists and (setup_cache.key == key)) {
+            lists_ = setup_cache.lists;
+        } else if (auto shared = setup_cache.shared_lists.lock();
+                   shared and (setup_cache.shared_key == key)) {
+            lists_ = shared;
+        } else {
+            lists_ = std::shared_ptr<StringLists>(new StringLists(
+                twoSubstituitionVVOO, active_dim_, core_mo_, active_mo_, na_, nb_, print_,
+                restrictions));
+            lists_->set_hole_lists_max_memory(hole_lists_max_memory_);
+            setup_cache.shared_key = key;
+            setup_cache.shared_lists = lists_;
+            if (reuse_setup_) {
+                setup_cache.key = key;
+                setup_cache.lists = lists_;
+                setup_cache.subspaces.clear();
+            }
+        }
+    }
 
     size_t ndfci = 0;
     for (int h = 0; h < nirrep_; ++h) {
@@ -91,6 +169,21 @@ void FCISolver::startup() {
         size_t nbstr = lists_->beta_graph()->strpi(h ^ symmetry_);
         ndfci += nastr * nbstr;
     }
+    // count only the allowed determinants
+    if (lists_->restricted_determinants()) {
+        size_t nexcluded = 0;
+        for (int h = 0; h < nirrep_; ++h) {
+            size_t nastr = lists_->alfa_graph()->strpi(h);
+            size_t nbstr = lists_->beta_graph()->strpi(h ^ symmetry_);
+            for (size_t Ia = 0; Ia < nastr; ++Ia) {
+                for (size_t Ib = 0; Ib < nbstr; ++Ib) {
+                    if (not lists_->allowed_determinant(h, Ia, h ^ symmetry_, Ib))
+                        nexcluded += 1;
+                }
+            }
+        }
+        ndfci -= nexcluded;
+    }
 
     if (print_) {
         // Print a summary of options
@@ -116,10 +209,19 @@ void FCISolver::set_options(std::shared_ptr<ForteOptions> options) {
     set_fci_iterations(options->get_int("FCI_MAXITER"));
     set_collapse_per_root(options->get_int("DL_COLLAPSE_PER_ROOT"));
     set_subspace_per_root(options->get_int("DL_SUBSPACE_PER_ROOT"));
+    dl_out_of_core_ = options->get_bool("DL_OUT_OF_CORE");
+    dl_checkpoint_ = options->get_bool("DL_CHECKPOINT");
     set_ntrial_per_root(options->get_int("NTRIAL_PER_ROOT"));
     set_print(options->get_int("PRINT"));
     set_e_convergence(options->get_double("E_CONVERGENCE"));
     set_r_convergence(options->get_double("R_CONVERGENCE"));
+    sigma_dgemm_ = (options->get_str("FCI_SIGMA_ALGORITHM") == "DGEMM");
+    sigma_max_memory_ = options->get_int("SIGMA_VECTOR_MAX_MEMORY");
+    sigma_mixed_precision_ = (options->get_str("FCI_SIGMA_PRECISION") == "MIXED");
+    mixed_precision_switch_ = options->get_double("FCI_MIXED_PRECISION_SWITCH");
+    hole_lists_max_memory_ =
+        static_cast<size_t>(options->get_double("FCI_HOLE_LISTS_MAX_MEM") * 1073741824.0);
+    reuse_setup_ = options->get_bool("REUSE_SETUP");
 }
 
 /*
@@ -129,12 +231,20 @@ double FCISolver::compute_energy() {
     local_timer t;
     startup();
 
-    FCIVector::allocate_temp_space(lists_, print_);
+    // Allocate the workspace or grow it if the previous one is too small
+    size_t nthreads = omp_get_max_threads();
+    if (workspace_) {
+        workspace_->resize(lists_, nthreads);
+    } else {
+        workspace_ = std::make_shared<FCIWorkspace>(lists_, nthreads, print_);
+    }
 
-    FCIVector Hdiag(lists_, symmetry_);
-    C_ = std::make_shared<FCIVector>(lists_, symmetry_);
-    FCIVector HC(lists_, symmetry_);
+    FCIVector Hdiag(lists_, symmetry_, workspace_);
+    C_ = std::make_shared<FCIVector>(lists_, symmetry_, workspace_);
+    FCIVector HC(lists_, symmetry_, workspace_);
     C_->set_print(print_);
+    C_->set_sigma_algorithm(sigma_dgemm_ ? FCISigmaAlgorithm::DGEMM : FCISigmaAlgorithm::Lists,
+                            sigma_max_memory_);
 
     size_t fci_size = Hdiag.size();
     Hdiag.form_H_diagonal(as_ints_);
@@ -150,6 +260,7 @@ double FCISolver::compute_energy() {
     dls.set_print_level(print_);
     dls.set_collapse_per_root(collapse_per_root_);
     dls.set_subspace_per_root(subspace_per_root_);
+    dls.set_out_of_core(dl_out_of_core_);
     dls.startup(sigma);
 
     size_t guess_size = dls.collapse_size();
@@ -169,10 +280,37 @@ double FCISolver::compute_energy() {
                                 "multiplicity.\n\n");
     }
 
-    for (size_t n = 0; n < nguess; ++n) {
-        HC.set(guess[guess_list[n]].second);
-        HC.copy_to(sigma);
-        dls.add_guess(sigma);
+    // restart from the subspace saved by a previous computation or use the guess
+    std::string dl_checkpoint_file;
+    if (dl_checkpoint_ and (not wfn_filename().empty())) {
+        dl_checkpoint_file = wfn_filename().substr(0, wfn_filename().find_last_of('.')) + ".dl";
+    }
+    size_t nrestart = dl_checkpoint_file.empty() ? 0 : dls.load_subspace(dl_checkpoint_file);
+    auto subspace_key = std::make_tuple(symmetry_, multiplicity_, nroot_);
+    size_t nreuse = 0;
+    if ((nrestart == 0) and reuse_setup_) {
+        std::lock_guard<std::mutex> lock(setup_cache.mutex);
+        auto it = setup_cache.subspaces.find(subspace_key);
+        if ((setup_cache.lists == lists_) and (it != setup_cache.subspaces.end()) and
+            it->second.b and (static_cast<size_t>(it->second.b->coldim()) == fci_size)) {
+            nreuse = dls.set_subspace(it->second);
+        }
+    }
+    if (nrestart > 0) {
+        if (print_) {
+            outfile->Printf("\n  Restarting from %zu vectors read from %s", nrestart,
+                            dl_checkpoint_file.c_str());
+        }
+    } else if (nreuse > 0) {
+        if (print_) {
+            outfile->Printf("\n  Using %zu vectors of the previous computation as guess", nreuse);
+        }
+    } else {
+        for (size_t n = 0; n < nguess; ++n) {
+            HC.set(guess[guess_list[n]].second);
+            HC.copy_to(sigma);
+            dls.add_guess(sigma);
+        }
     }
 
     // Prepare a list of bad roots to project out and pass them to the solver
@@ -208,20 +346,54 @@ double FCISolver::compute_energy() {
         outfile->Printf("\n  -----------------------------------------------------");
     }
 
+    // The sigma vectors are built in blocks. The number of vectors in a block is limited by
+    // the memory required to store them side by side in the workspace.
+    size_t block_memory = 2 * nthreads * workspace_->dim() * workspace_->dim();
+    size_t max_block_size =
+        std::min(dls.collapse_size(), sigma_max_memory_ / std::max(size_t(1), block_memory));
+    max_block_size = std::max(size_t(1), max_block_size);
+    std::vector<std::shared_ptr<FCIVector>> b_block{C_};
+    std::vector<std::shared_ptr<FCIVector>> sigma_block{
+        std::make_shared<FCIVector>(lists_, symmetry_, workspace_)};
+
+    // With mixed precision the sigma vectors are built with single precision intermediates until
+    // the residual drops below mixed_precision_switch_. At that point the sigma vectors of the
+    // whole subspace are recomputed in double precision, so the final energies are not affected.
+    bool mixed_precision = sigma_mixed_precision_;
+
     double old_avg_energy = 0.0;
     int real_cycle = 1;
     for (int cycle = 0; cycle < fci_iterations_; ++cycle) {
         bool add_sigma = true;
         do {
-            dls.get_b(b);
-            C_->copy(b);
-            C_->Hamiltonian(HC, as_ints_);
-            HC.copy_to(sigma);
-            add_sigma = dls.add_sigma(sigma);
+            size_t block_size = std::min(max_block_size, dls.num_pending_sigma());
+            while (b_block.size() < block_size) {
+                b_block.push_back(std::make_shared<FCIVector>(lists_, symmetry_, workspace_));
+                sigma_block.push_back(std::make_shared<FCIVector>(lists_, symmetry_, workspace_));
+            }
+            std::vector<std::shared_ptr<FCIVector>> C_block(b_block.begin(),
+                                                            b_block.begin() + block_size);
+            std::vector<std::shared_ptr<FCIVector>> HC_block(sigma_block.begin(),
+                                                             sigma_block.begin() + block_size);
+            for (size_t n = 0; n < block_size; ++n) {
+                dls.get_b(b, n);
+                C_block[n]->copy(b);
+            }
+            C_block[0]->set_sigma_precision(mixed_precision ? FCISigmaPrecision::Mixed
+                                                            : FCISigmaPrecision::Double);
+            FCIVector::Hamiltonian(C_block, HC_block, as_ints_);
+            for (size_t n = 0; n < block_size; ++n) {
+                HC_block[n]->copy_to(sigma);
+                add_sigma = dls.add_sigma(sigma);
+            }
         } while (add_sigma);
 
         converged = dls.update();
 
+        if (not dl_checkpoint_file.empty()) {
+            dls.save_subspace(dl_checkpoint_file);
+        }
+
         if (converged != SolverStatus::Collapse) {
             // compute the average energy
             double avg_energy = 0.0;
@@ -241,6 +413,17 @@ double FCISolver::compute_energy() {
             }
             old_avg_energy = avg_energy;
             real_cycle++;
+
+            double max_residual = *std::max_element(r.begin(), r.end());
+            if (mixed_precision and ((converged == SolverStatus::Converged) or
+                                     (max_residual < mixed_precision_switch_))) {
+                mixed_precision = false;
+                converged = SolverStatus::NotConverged;
+                dls.reset_sigma();
+                if (print_) {
+                    outfile->Printf("\n  Switching to double precision sigma vectors.");
+                }
+            }
         }
 
         if (converged == SolverStatus::Converged)
@@ -260,6 +443,14 @@ double FCISolver::compute_energy() {
         throw psi::PSIEXCEPTION("FCI did not converge. Try increasing FCI_MAXITER.");
     }
 
+    // Keep the subspace as guess for the next computation
+    if (reuse_setup_) {
+        std::lock_guard<std::mutex> lock(setup_cache.mutex);
+        if (setup_cache.lists == lists_) {
+            setup_cache.subspaces[subspace_key] = dls.get_subspace();
+        }
+    }
+
     // Compute final eigenvectors
     dls.get_results();
 
@@ -388,6 +579,14 @@ FCISolver::initial_guess(FCIVector& diag, size_t n,
 
     // Get the list of most important determinants
     std::vector<std::tuple<double, size_t, size_t, size_t>> dets = diag.min_elements(ntrial);
+    // drop the determinants excluded by the restrictions on the strings
+    dets.erase(std::remove_if(dets.begin(), dets.end(),
+                              [&](const std::tuple<double, size_t, size_t, size_t>& d) {
+                                  const int h = std::get<1>(d);
+                                  return not lists_->allowed_determinant(
+                                      h, std::get<2>(d), h ^ symmetry_, std::get<3>(d));
+                              }),
+               dets.end());
 
     size_t num_dets = dets.size();
 
@@ -448,7 +647,9 @@ FCISolver::initial_guess(FCIVector& diag, size_t n,
     Matrix H("H", num_dets, num_dets);
     Matrix evecs("Evecs", num_dets, num_dets);
     Vector evals("Evals", num_dets);
+    std::vector<double> S2_mat(num_dets * num_dets);
 
+#pragma omp parallel for schedule(dynamic)
     for (size_t I = 0; I < num_dets; ++I) {
         for (size_t J = I; J < num_dets; ++J) {
             double HIJ = fci_ints->slater_rules(bsdets[I], bsdets[J]);
@@ -456,11 +657,20 @@ FCISolver::initial_guess(FCIVector& diag, size_t n,
                 HIJ += scalar_energy;
             H.set(I, J, HIJ);
             H.set(J, I, HIJ);
+            const double S2IJ = ::forte::spin2(bsdets[I], bsdets[J]);
+            S2_mat[I * num_dets + J] = S2_mat[J * num_dets + I] = S2IJ;
         }
     }
 
     H.diagonalize(evecs, evals);
 
+    // S2_evecs = S^2 evecs, so that <S^2> of root r is sum_I evecs[I][r] S2_evecs[I][r]
+    std::vector<double> S2_evecs(num_dets * num_dets);
+    if (num_dets > 0) {
+        C_DGEMM('N', 'N', num_dets, num_dets, num_dets, 1.0, S2_mat.data(), num_dets,
+                evecs.pointer()[0], num_dets, 0.0, S2_evecs.data(), num_dets);
+    }
+
     std::vector<std::pair<int, std::vector<std::tuple<size_t, size_t, size_t, double>>>> guess;
 
     std::vector<std::string> s2_labels(
@@ -474,10 +684,7 @@ FCISolver::initial_guess(FCIVector& diag, size_t n,
         double norm = 0.0;
         double S2 = 0.0;
         for (size_t I = 0; I < num_dets; ++I) {
-            for (size_t J = 0; J < num_dets; ++J) {
-                const double S2IJ = ::forte::spin2(bsdets[I], bsdets[J]);
-                S2 += evecs.get(I, r) * evecs.get(J, r) * S2IJ;
-            }
+            S2 += evecs.get(I, r) * S2_evecs[I * num_dets + r];
             norm += std::pow(evecs.get(I, r), 2.0);
         }
         S2 /= norm;
@@ -517,12 +724,24 @@ std::vector<RDMs> FCISolver::rdms(const std::vector<std::pair<size_t, size_t>>&
     if (max_rdm_level <= 0)
         return refs;
 
+    // the transition RDMs are computed together in one pass over the string lists
+    std::vector<std::pair<size_t, size_t>> transition_list;
+    for (auto& roots : root_list) {
+        if (roots.first != roots.second)
+            transition_list.push_back(roots);
+    }
+    std::vector<RDMs> transition_refs;
+    if (not transition_list.empty()) {
+        transition_refs = compute_transition_rdms(transition_list, *this, max_rdm_level);
+    }
+    size_t ntransition = 0;
+
     // loop over all the pairs of references
     for (auto& roots : root_list) {
 
         if (roots.first != roots.second) {
-            throw psi::PSIEXCEPTION(
-                "FCISolver::rdms(): cannot compute transition RDMs within the same symmetry.");
+            refs.push_back(transition_refs[ntransition++]);
+            continue;
         }
 
         compute_rdms_root(roots.first, roots.second, max_rdm_level);
@@ -634,10 +853,126 @@ std::vector<RDMs> FCISolver::rdms(const std::vector<std::pair<size_t, size_t>>&
 }
 
 std::vector<RDMs>
-FCISolver::transition_rdms(const std::vector<std::pair<size_t, size_t>>& /*root_list*/,
-                           std::shared_ptr<ActiveSpaceMethod> /*method2*/, int /*max_rdm_level*/) {
+FCISolver::transition_rdms(const std::vector<std::pair<size_t, size_t>>& root_list,
+                           std::shared_ptr<ActiveSpaceMethod> method2, int max_rdm_level) {
+    std::vector<RDMs> refs;
+    if ((max_rdm_level <= 0) or root_list.empty())
+        return refs;
+
+    auto fci2 = std::dynamic_pointer_cast<FCISolver>(method2);
+    if (not fci2) {
+        throw std::runtime_error(
+            "FCISolver::transition_rdms: the second method must also be a FCISolver.");
+    }
+    return compute_transition_rdms(root_list, *fci2, max_rdm_level);
+}
+
+std::vector<RDMs>
+FCISolver::compute_transition_rdms(const std::vector<std::pair<size_t, size_t>>& root_list,
+                                   FCISolver& ket_solver, int max_rdm_level) {
+    if (max_rdm_level > 2) {
+        throw psi::PSIEXCEPTION(
+            "FCISolver: the transition RDMs are only available up to max_rdm_level = 2.");
+    }
+    if (not C_ or not ket_solver.C_) {
+        throw psi::PSIEXCEPTION("FCIVector is not assigned. Cannot compute transition RDMs.");
+    }
+
+    // Build the bra (this solver) and ket (ket_solver) vectors that appear in the list
+    std::map<size_t, size_t> bra_index, ket_index;
+    for (const auto& roots : root_list) {
+        if ((roots.first >= nroot_) or (roots.second >= ket_solver.nroot_)) {
+            std::string error = "Cannot compute the transition RDMs of roots " +
+                                std::to_string(roots.first) + " and " +
+                                std::to_string(roots.second) + " (0-based)";
+            throw psi::PSIEXCEPTION(error);
+        }
+        bra_index.emplace(roots.first, bra_index.size());
+        ket_index.emplace(roots.second, ket_index.size());
+    }
+
+    std::vector<std::shared_ptr<FCIVector>> bras(bra_index.size()), kets(ket_index.size());
+    for (const auto& root_n : bra_index) {
+        bras[root_n.second] = std::make_shared<FCIVector>(lists_, symmetry_, workspace_);
+        bras[root_n.second]->copy(eigen_vecs_->get_row(0, root_n.first));
+    }
+    for (const auto& root_n : ket_index) {
+        kets[root_n.second] = std::make_shared<FCIVector>(ket_solver.lists_, ket_solver.symmetry_,
+                                                          ket_solver.workspace_);
+        kets[root_n.second]->copy(ket_solver.eigen_vecs_->get_row(0, root_n.first));
+    }
+    kets[0]->set_print(print_);
+
+    // Distinct (bra, ket) pairs, repeated pairs share the same result
+    std::map<std::pair<size_t, size_t>, size_t> pair_index;
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (const auto& roots : root_list) {
+        std::pair<size_t, size_t> pair(bra_index[roots.first], ket_index[roots.second]);
+        if (pair_index.emplace(pair, pairs.size()).second)
+            pairs.push_back(pair);
+    }
+
+    if (print_) {
+        print_h2("Computing Transition RDMs for " + std::to_string(pairs.size()) + " Pairs");
+    }
+    auto trdms = FCIVector::compute_transition_rdms(bras, kets, pairs, max_rdm_level);
+
+    size_t nact = active_dim_.sum();
+    auto to_tensor = [&](const std::string& label, const std::vector<double>& data, size_t rank) {
+        ambit::Tensor t =
+            ambit::Tensor::build(ambit::CoreTensor, label, std::vector<size_t>(rank, nact));
+        t.data() = data;
+        return t;
+    };
+
     std::vector<RDMs> refs;
-    throw std::runtime_error("FCISolver::transition_rdms is not implemented!");
+    for (const auto& roots : root_list) {
+        const auto& trdm =
+            trdms[pair_index[std::make_pair(bra_index[roots.first], ket_index[roots.second])]];
+        ambit::Tensor g1a = to_tensor("g1a", trdm.opdm_a, 2);
+        ambit::Tensor g1b = to_tensor("g1b", trdm.opdm_b, 2);
+        if (max_rdm_level == 1) {
+            refs.emplace_back(g1a, g1b);
+        } else {
+            refs.emplace_back(g1a, g1b, to_tensor("g2aa", trdm.tpdm_aa, 4),
+                              to_tensor("g2ab", trdm.tpdm_ab, 4),
+                              to_tensor("g2bb", trdm.tpdm_bb, 4));
+        }
+    }
     return refs;
 }
+void FCISolver::dump_wave_function(const std::string& filename) {
+    if (not eigen_vecs_) {
+        throw std::runtime_error("FCISolver::dump_wave_function: no wave function to dump. Call "
+                                 "compute_energy() first.");
+    }
+    // the determinants in the order of the FCIVector (alpha irrep, alpha string, beta string)
+    size_t nact = active_mo_.size();
+    std::vector<Determinant> dets;
+    dets.reserve(eigen_vecs_->coldim());
+    for (int ha = 0; ha < nirrep_; ++ha) {
+        int hb = ha ^ symmetry_;
+        size_t maxIa = lists_->alfa_graph()->strpi(ha);
+        size_t maxIb = lists_->beta_graph()->strpi(hb);
+        for (size_t Ia = 0; Ia < maxIa; ++Ia) {
+            std::bitset<Determinant::nbits_half> Ia_v = lists_->alfa_str(ha, Ia);
+            for (size_t Ib = 0; Ib < maxIb; ++Ib) {
+                std::bitset<Determinant::nbits_half> Ib_v = lists_->beta_str(hb, Ib);
+                Determinant det;
+                for (size_t i = 0; i < nact; ++i) {
+                    det.set_alfa_bit(i, Ia_v[i]);
+                    det.set_beta_bit(i, Ib_v[i]);
+                }
+                dets.push_back(det);
+            }
+        }
+    }
+    // the eigenvectors are stored as rows
+    write_wave_function_file(filename, nact, "FCI: " + state_.str(), dets, eigen_vecs_->rowdim(),
+                             [&](size_t n, double* column) {
+                                 const double* C = eigen_vecs_->pointer()[n];
+                                 std::copy(C, C + dets.size(), column);
+                             });
+}
+
 } // namespace forte
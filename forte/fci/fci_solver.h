@@ -35,6 +35,7 @@
 namespace forte {
 
 class FCIVector;
+class FCIWorkspace;
 class StringLists;
 
 /**
@@ -66,8 +67,9 @@ class FCISolver : public ActiveSpaceMethod {
     std::vector<RDMs> rdms(const std::vector<std::pair<size_t, size_t>>& root_list,
                            int max_rdm_level) override;
 
-    /// Returns the transition reduced density matrices between roots of different symmetry up to a
-    /// given level (max_rdm_level)
+    /// Returns the transition reduced density matrices between the roots of this solver (bra) and
+    /// those of method2 (ket), another FCISolver, up to a given level (max_rdm_level <= 2).
+    /// All the pairs are computed in one pass over the string lists
     std::vector<RDMs> transition_rdms(const std::vector<std::pair<size_t, size_t>>& root_list,
                                       std::shared_ptr<ActiveSpaceMethod> method2,
                                       int max_rdm_level) override;
@@ -75,6 +77,9 @@ class FCISolver : public ActiveSpaceMethod {
     /// Set the options
     void set_options(std::shared_ptr<ForteOptions> options) override;
 
+    /// Dump the wave function to disk (see WaveFunctionFile)
+    void dump_wave_function(const std::string& filename) override;
+
     /// Compute RDMs on a given root
     void compute_rdms_root(size_t root1, size_t root2, int max_rdm_level);
 
@@ -115,6 +120,9 @@ class FCISolver : public ActiveSpaceMethod {
     /// The FCI wave function
     std::shared_ptr<FCIVector> C_;
 
+    /// The scratch memory used by the sigma and RDM builds. This is kept between computations
+    std::shared_ptr<FCIWorkspace> workspace_;
+
     /// Eigen vectors
     psi::SharedMatrix eigen_vecs_;
 
@@ -135,18 +143,38 @@ class FCISolver : public ActiveSpaceMethod {
     size_t collapse_per_root_ = 2;
     /// The maximum subspace size for each root
     size_t subspace_per_root_ = 4;
+    /// Store the Davidson-Liu subspace vectors in scratch files?
+    bool dl_out_of_core_ = false;
     /// Iterations for FCI
     int fci_iterations_ = 30;
     /// Test the RDMs?
     bool test_rdms_ = false;
     /// Print the NO from the 1-RDM
     bool print_no_ = false;
+    /// Use the DGEMM algorithm for the alpha-beta term of the sigma vector?
+    bool sigma_dgemm_ = false;
+    /// The maximum number of doubles stored by the sigma vector algorithm
+    size_t sigma_max_memory_ = 67108864;
+    /// Build the sigma vectors with single precision intermediates in the first iterations?
+    bool sigma_mixed_precision_ = false;
+    /// The residual norm below which the sigma vectors are built in double precision
+    double mixed_precision_switch_ = 1.0e-4;
+    /// The maximum memory (in bytes) used by the hole string lists
+    size_t hole_lists_max_memory_ = 1073741824;
+    /// Reuse the string lists and the Davidson-Liu subspace of the previous computation?
+    bool reuse_setup_ = false;
 
     // ==> Class functions <==
 
     /// All that happens before we compute the energy
     void startup();
 
+    /// Compute the transition RDMs <root1|...|root2> of a list of (root1, root2) pairs, where
+    /// root1 is a root of this solver and root2 is a root of ket_solver
+    std::vector<RDMs>
+    compute_transition_rdms(const std::vector<std::pair<size_t, size_t>>& root_list,
+                            FCISolver& ket_solver, int max_rdm_level);
+
     /// Initial CI wave function guess
     std::vector<std::pair<int, std::vector<std::tuple<size_t, size_t, size_t, double>>>>
     initial_guess(FCIVector& diag, size_t n, std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
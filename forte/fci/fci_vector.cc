@@ -30,64 +30,42 @@
 #include "psi4/libmints/matrix.h"
 #include "psi4/libmints/molecule.h"
 #include "helpers/helpers.h"
+#include "helpers/numa_memory.h"
 #include "helpers/printing.h"
+#include "forte-def.h"
 
 #include "base_classes/mo_space_info.h"
 #include "fci_vector.h"
+#include "fci_workspace.h"
 #include "string_lists.h"
 
 using namespace psi;
 
 namespace forte {
 
-psi::SharedMatrix FCIVector::C1;
-psi::SharedMatrix FCIVector::Y1;
-size_t FCIVector::sizeC1 = 0;
-// FCIVector* FCIVector::tmp_wfn1 = nullptr;
-// FCIVector* FCIVector::tmp_wfn2 = nullptr;
-
-double FCIVector::hdiag_timer = 0.0;
-double FCIVector::h1_aa_timer = 0.0;
-double FCIVector::h1_bb_timer = 0.0;
-double FCIVector::h2_aaaa_timer = 0.0;
-double FCIVector::h2_aabb_timer = 0.0;
-double FCIVector::h2_bbbb_timer = 0.0;
-
-void FCIVector::allocate_temp_space(std::shared_ptr<StringLists> lists_, int print_) {
-    size_t nirreps = lists_->nirrep();
-
-    // if C1 is already allocated (e.g., because we computed several roots) make sure
-    // we do not allocate a matrix of smaller size. So let's find out the size of the current C1
-    size_t current_maxC1 = C1 ? C1->rowdim() : 0;
-
-    size_t maxC1 = 0;
-    for (size_t Ia_sym = 0; Ia_sym < nirreps; ++Ia_sym) {
-        maxC1 = std::max(maxC1, lists_->alfa_graph()->strpi(Ia_sym));
-    }
-    for (size_t Ib_sym = 0; Ib_sym < nirreps; ++Ib_sym) {
-        maxC1 = std::max(maxC1, lists_->beta_graph()->strpi(Ib_sym));
-    }
-
-    // Allocate the temporary arrays C1 and Y1 with the largest sizes
-    if (maxC1 > current_maxC1) {
-        C1 = std::make_shared<psi::Matrix>("C1", maxC1, maxC1);
-        Y1 = std::make_shared<psi::Matrix>("Y1", maxC1, maxC1);
-    }
-
-    if (print_)
-        outfile->Printf("\n  Allocating memory for the Hamiltonian algorithm. "
-                        "Size: 2 x %zu x %zu.   Memory: %8.6f GB",
-                        maxC1, maxC1, to_gb(2 * maxC1 * maxC1));
-
-    sizeC1 = maxC1 * maxC1 * static_cast<size_t>(sizeof(double));
+thread_local double FCIVector::hdiag_timer = 0.0;
+thread_local double FCIVector::h1_aa_timer = 0.0;
+thread_local double FCIVector::h1_bb_timer = 0.0;
+thread_local double FCIVector::h2_aaaa_timer = 0.0;
+thread_local double FCIVector::h2_aabb_timer = 0.0;
+thread_local double FCIVector::h2_bbbb_timer = 0.0;
+
+FCIVector::FCIVector(std::shared_ptr<StringLists> lists, size_t symmetry,
+                     std::shared_ptr<FCIWorkspace> workspace)
+    : symmetry_(symmetry), lists_(lists), workspace_(workspace),
+      alfa_graph_(lists_->alfa_graph()), beta_graph_(lists_->beta_graph()) {
+    startup();
 }
 
-void FCIVector::release_temp_space() {}
-
-FCIVector::FCIVector(std::shared_ptr<StringLists> lists, size_t symmetry)
-    : symmetry_(symmetry), lists_(lists), alfa_graph_(lists_->alfa_graph()),
-      beta_graph_(lists_->beta_graph()) {
-    startup();
+FCIWorkspace& FCIVector::workspace(size_t nvec) {
+    size_t nthreads = omp_get_max_threads();
+    if (workspace_) {
+        workspace_->resize(lists_, nthreads, nvec);
+    } else {
+        workspace_ = std::make_shared<FCIWorkspace>(lists_, nthreads, print_);
+        workspace_->resize(lists_, nthreads, nvec);
+    }
+    return *workspace_;
 }
 
 FCIVector::~FCIVector() { cleanup(); }
@@ -118,6 +96,8 @@ void FCIVector::startup() {
         //    %d",alfa_sym,(int)alfa_graph_->strpi(alfa_sym),(int)beta_graph_->strpi(beta_sym));
         C_.push_back(psi::SharedMatrix(
             new psi::Matrix("C", alfa_graph_->strpi(alfa_sym), beta_graph_->strpi(beta_sym))));
+        // the sigma builds split the alpha strings (rows) of each block among the threads
+        place_pages(C_.back()->get_pointer(), 1, detpi_[alfa_sym] * sizeof(double));
     }
 }
 
@@ -186,6 +166,24 @@ void FCIVector::copy_to(psi::SharedVector vec) {
     }
 }
 
+void FCIVector::set_excluded_determinants(double value) {
+    if (not lists_->restricted_determinants())
+        return;
+    for (int alfa_sym = 0; alfa_sym < nirrep_; ++alfa_sym) {
+        int beta_sym = alfa_sym ^ symmetry_;
+        size_t maxIa = alfa_graph_->strpi(alfa_sym);
+        size_t maxIb = beta_graph_->strpi(beta_sym);
+        double** C_ha = C_[alfa_sym]->pointer();
+#pragma omp parallel for
+        for (size_t Ia = 0; Ia < maxIa; ++Ia) {
+            for (size_t Ib = 0; Ib < maxIb; ++Ib) {
+                if (not lists_->allowed_determinant(alfa_sym, Ia, beta_sym, Ib))
+                    C_ha[Ia][Ib] = value;
+            }
+        }
+    }
+}
+
 void FCIVector::set(std::vector<std::tuple<size_t, size_t, size_t, double>>& sparse_vec) {
     zero();
     double C;
@@ -44,12 +44,48 @@ class Vector;
 namespace forte {
 class ActiveSpaceIntegrals;
 class BinaryGraph;
+class FCIWorkspace;
 class MOSpaceInfo;
 class StringLists;
 
+/// The algorithm used to compute the alpha-beta two-electron term of the sigma vector
+enum class FCISigmaAlgorithm {
+    /// loop over the alpha and beta substitution lists (default)
+    Lists,
+    /// gather C into D[rs] intermediates, contract with (pq|rs) using DGEMM, and scatter
+    DGEMM
+};
+
+/// The floating point precision used to build the sigma vector
+enum class FCISigmaPrecision {
+    /// all the intermediates are stored in double precision (default)
+    Double,
+    /// the intermediates of the alpha-beta term (Lists algorithm) are stored in single precision
+    /// and accumulated into the double precision sigma vector
+    Mixed
+};
+
+/// The transition density matrices <B|...|K> between a bra and a ket FCI vector.
+/// These are stored in the same format as the RDMs of a FCIVector
+struct FCITransitionRDMs {
+    std::vector<double> opdm_a;
+    std::vector<double> opdm_b;
+    std::vector<double> tpdm_aa;
+    std::vector<double> tpdm_ab;
+    std::vector<double> tpdm_bb;
+};
+
 class FCIVector {
   public:
-    FCIVector(std::shared_ptr<StringLists> lists, size_t symmetry);
+    /**
+     * @brief FCIVector
+     * @param lists the string lists
+     * @param symmetry the symmetry of this vector
+     * @param workspace the scratch memory used by the sigma and RDM builds. If not provided, a
+     *        private workspace is allocated the first time it is needed.
+     */
+    FCIVector(std::shared_ptr<StringLists> lists, size_t symmetry,
+              std::shared_ptr<FCIWorkspace> workspace = nullptr);
     ~FCIVector();
 
     //    // Simple operation
@@ -68,6 +104,10 @@ class FCIVector {
     /// Form the diagonal part of the Hamiltonian
     void form_H_diagonal(std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
 
+    /// Set the elements of the determinants excluded by the restrictions of the string lists
+    /// (e.g., GAS) to a given value
+    void set_excluded_determinants(double value = 0.0);
+
     //    double approximate_spin(double )
 
     //    /// Initial guess
@@ -96,10 +136,32 @@ class FCIVector {
 
     // Operations on the wave function
     void Hamiltonian(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    /// Apply the Hamiltonian to a block of vectors, HC[n] = H C[n].
+    /// All the vectors must share the same string lists and symmetry. The settings (algorithm,
+    /// workspace) of C[0] are used for the whole block.
+    static void Hamiltonian(const std::vector<std::shared_ptr<FCIVector>>& C,
+                            const std::vector<std::shared_ptr<FCIVector>>& HC,
+                            std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
 
     double energy_from_rdms(std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
 
     void compute_rdms(int max_order = 2);
+
+    /**
+     * @brief Compute the transition RDMs between a set of bra and ket vectors.
+     *        Each term is computed for all the (bra, ket) pairs in one pass over the string lists.
+     * @param bras the bra vectors (all with the same symmetry)
+     * @param kets the ket vectors (all with the same symmetry). The string lists and the
+     *        workspace of kets[0] are used for all the vectors
+     * @param pairs the distinct (bra, ket) index pairs to return
+     * @param max_order the maximum RDM order (1 or 2). The 2-body transition RDMs are only
+     *        available for bras and kets with the same symmetry
+     * @return the transition RDMs of each pair, in the order of pairs
+     */
+    static std::vector<FCITransitionRDMs>
+    compute_transition_rdms(const std::vector<std::shared_ptr<FCIVector>>& bras,
+                            const std::vector<std::shared_ptr<FCIVector>>& kets,
+                            const std::vector<std::pair<size_t, size_t>>& pairs, int max_order);
     void rdm_test();
 
     /// Compute the expectation value of the S^2 operator
@@ -117,10 +179,18 @@ class FCIVector {
     std::vector<std::tuple<double, double, size_t, size_t, size_t>>
     max_abs_elements(size_t num_dets);
 
-    // Temporary memory allocation
-    static void allocate_temp_space(std::shared_ptr<StringLists> lists_, int print_);
-    static void release_temp_space();
+    /// Set the workspace used by the sigma and RDM builds
+    void set_workspace(std::shared_ptr<FCIWorkspace> workspace) { workspace_ = workspace; }
     void set_print(int print) { print_ = print; }
+    /// Select the algorithm for the alpha-beta term of the sigma vector
+    /// @param algorithm the algorithm
+    /// @param max_memory the maximum number of doubles used by the DGEMM intermediates
+    void set_sigma_algorithm(FCISigmaAlgorithm algorithm, size_t max_memory) {
+        sigma_algorithm_ = algorithm;
+        sigma_max_memory_ = max_memory;
+    }
+    /// Select the precision of the sigma vector intermediates
+    void set_sigma_precision(FCISigmaPrecision precision) { sigma_precision_ = precision; }
 
   private:
     // ==> Class Data <==
@@ -141,9 +211,17 @@ class FCIVector {
     std::vector<size_t> detpi_;
     /// The print level
     int print_ = 0;
+    /// The algorithm used for the alpha-beta term of the sigma vector
+    FCISigmaAlgorithm sigma_algorithm_ = FCISigmaAlgorithm::Lists;
+    /// The precision of the sigma vector intermediates
+    FCISigmaPrecision sigma_precision_ = FCISigmaPrecision::Double;
+    /// The maximum number of doubles used by the DGEMM algorithm intermediates
+    size_t sigma_max_memory_ = 67108864;
 
     /// The string list
     std::shared_ptr<StringLists> lists_;
+    /// The scratch memory
+    std::shared_ptr<FCIWorkspace> workspace_;
     // Graphs
     /// The alpha string graph
     std::shared_ptr<BinaryGraph> alfa_graph_;
@@ -163,26 +241,22 @@ class FCIVector {
 
     // ==> Class Static Data <==
 
-    static std::shared_ptr<psi::Matrix> C1;
-    static std::shared_ptr<psi::Matrix> Y1;
-    static size_t sizeC1;
-
-    // Timers
-    static double hdiag_timer;
-    static double h1_aa_timer;
-    static double h1_bb_timer;
-    static double h2_aaaa_timer;
-    static double h2_aabb_timer;
-    static double h2_bbbb_timer;
+    // Timers (thread local for concurrent solvers)
+    static thread_local double hdiag_timer;
+    static thread_local double h1_aa_timer;
+    static thread_local double h1_bb_timer;
+    static thread_local double h2_aaaa_timer;
+    static thread_local double h2_aabb_timer;
+    static thread_local double h2_bbbb_timer;
 
     // ==> Class Public Functions <==
 
     void startup();
     void cleanup();
 
-    /// Compute the energy of a determinant
-    double determinant_energy(bool*& Ia, bool*& Ib, int n,
-                              std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    /// Return the workspace, allocating one if this vector does not have it
+    /// @param nvec the number of vectors processed at the same time
+    FCIWorkspace& workspace(size_t nvec = 1);
 
     // ==> Class Private Functions <==
 
@@ -195,10 +269,20 @@ class FCIVector {
                 ncmo_ * ncmo_ * ncmo_ * r + ncmo_ * ncmo_ * s + ncmo_ * t + u);
     }
 
-    void H0(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
-    void H1(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints, bool alfa);
-    void H2_aabb(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
-    void H2_aaaa2(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints, bool alfa);
+    // The sigma build kernels act on a block of vectors C (this vector provides the string
+    // lists and the symmetry) and add the result to the block HC
+    void Hamiltonian_block(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                           std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    void H0(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+            std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    void H1(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+            std::shared_ptr<ActiveSpaceIntegrals> fci_ints, bool alfa);
+    void H2_aabb(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                 std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    void H2_aabb_dgemm(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                       std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    void H2_aaaa2(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                  std::shared_ptr<ActiveSpaceIntegrals> fci_ints, bool alfa);
 
     // 1-RDM elements are stored in the format
     // <a^+_{pa} a^+_{qb} a_{sb} a_ra> -> rdm[oei_index(p,q)]    
@@ -217,6 +301,22 @@ class FCIVector {
     // 3-RDM elements are stored in the format
     // <a^+_p a^+_q a^+_r a_u a_t a_s> -> rdm[six_index(p,q,r,s,t,u)]
 
+    // The transition RDM kernels act on a set of bras B and kets K (this vector is K[0]). The
+    // element <B_a|...|K_b> is added to *rdms[a * K.size() + b], pairs with a null pointer are
+    // skipped
+
+    /// Compute the transition 1-RDMs <B|a^+_{p} a_{q}|K>
+    void compute_transition_1rdm(const std::vector<FCIVector*>& B, const std::vector<FCIVector*>& K,
+                                 const std::vector<std::vector<double>*>& rdms, bool alfa);
+    /// Compute the same spin transition 2-RDMs <B|a^+_p a^+_q a_s a_r|K>
+    void compute_transition_2rdm_aa(const std::vector<FCIVector*>& B,
+                                    const std::vector<FCIVector*>& K,
+                                    const std::vector<std::vector<double>*>& rdms, bool alfa);
+    /// Compute the alpha-beta transition 2-RDMs <B|a^+_{pa} a^+_{qb} a_{sb} a_{ra}|K>
+    void compute_transition_2rdm_ab(const std::vector<FCIVector*>& B,
+                                    const std::vector<FCIVector*>& K,
+                                    const std::vector<std::vector<double>*>& rdms);
+
     /// Compute the matrix elements of the same spin 3-RDM <a^+_p a^+_q a_s a_r> (with all indices alpha or beta)
     void compute_3rdm_aaa(std::vector<double>& rdm, bool alfa);
     /// Compute the matrix elements of the alpha-alpha-beta 3-RDM <a^+_{pa} a^+_{qa} a^+_{rb} a_{ub} a_{ta} a_{sa}>
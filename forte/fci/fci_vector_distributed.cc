@@ -0,0 +1,528 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifdef HAVE_GA
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "psi4/libmints/vector.h"
+#include "psi4/libpsi4util/exception.h"
+#include "psi4/libqt/qt.h"
+
+#include "integrals/active_space_integrals.h"
+#include "fci_vector_distributed.h"
+#include "string_lists.h"
+
+#include <ga.h>
+#include <macdecls.h>
+
+namespace forte {
+
+namespace {
+/// @return the index of the first element of each group of consecutive elements with the same
+/// J, followed by the size of the list
+template <typename T> std::vector<size_t> group_starts(const std::vector<T>& list) {
+    std::vector<size_t> starts;
+    for (size_t n = 0; n < list.size(); ++n) {
+        if ((n == 0) or (list[n].J != list[n - 1].J))
+            starts.push_back(n);
+    }
+    starts.push_back(list.size());
+    return starts;
+}
+} // namespace
+
+DistributedFCIVector::DistributedFCIVector(std::shared_ptr<StringLists> lists, size_t symmetry)
+    : lists_(lists), symmetry_(symmetry), nirrep_(lists->nirrep()) {
+    const int nproc = GA_Nnodes();
+    for (int h = 0; h < nirrep_; ++h) {
+        const size_t na = lists_->alfa_graph()->strpi(h);
+        const size_t nb = lists_->beta_graph()->strpi(h ^ symmetry_);
+        block_size_.emplace_back(na, nb);
+        ndet_ += na * nb;
+        if (na * nb == 0) {
+            ga_.push_back(0);
+            local_rows_.emplace_back(0, 0);
+            continue;
+        }
+        // the rows are split in contiguous blocks, each process stores all the columns of its rows
+        int nblock[2] = {static_cast<int>(std::min(static_cast<size_t>(nproc), na)), 1};
+        std::vector<int> map(nblock[0] + 1);
+        for (int b = 0; b < nblock[0]; ++b) {
+            map[b] = static_cast<int>((b * na) / nblock[0]);
+        }
+        map[nblock[0]] = 0;
+        int dims[2] = {static_cast<int>(na), static_cast<int>(nb)};
+        std::string name = "FCI C[" + std::to_string(h) + "]";
+        int g =
+            NGA_Create_irreg(C_DBL, 2, dims, const_cast<char*>(name.c_str()), nblock, map.data());
+        if (not g) {
+            throw psi::PSIEXCEPTION("DistributedFCIVector: GA failed to create the block " + name);
+        }
+        ga_.push_back(g);
+        local_rows_.push_back(rows_of(h, GA_Nodeid()));
+    }
+    zero();
+}
+
+DistributedFCIVector::~DistributedFCIVector() {
+    for (int g : ga_) {
+        if (g)
+            GA_Destroy(g);
+    }
+}
+
+size_t DistributedFCIVector::local_size() const {
+    size_t n = 0;
+    for (int h = 0; h < nirrep_; ++h) {
+        n += (local_rows_[h].second - local_rows_[h].first) * block_size_[h].second;
+    }
+    return n;
+}
+
+std::pair<size_t, size_t> DistributedFCIVector::rows_of(int h, int proc) const {
+    if (ga_[h] == 0)
+        return {0, 0};
+    int lo[2], hi[2];
+    NGA_Distribution(ga_[h], proc, lo, hi);
+    if ((lo[0] < 0) or (hi[0] < lo[0]))
+        return {0, 0};
+    return {static_cast<size_t>(lo[0]), static_cast<size_t>(hi[0]) + 1};
+}
+
+double* DistributedFCIVector::access(int h) const {
+    const auto [begin, end] = local_rows_[h];
+    if (begin == end)
+        return nullptr;
+    int lo[2] = {static_cast<int>(begin), 0};
+    int hi[2] = {static_cast<int>(end) - 1, static_cast<int>(block_size_[h].second) - 1};
+    double* ptr = nullptr;
+    int ld[1];
+    NGA_Access(ga_[h], lo, hi, &ptr, ld);
+    if (static_cast<size_t>(ld[0]) != block_size_[h].second) {
+        throw psi::PSIEXCEPTION("DistributedFCIVector: the local rows are not contiguous");
+    }
+    return ptr;
+}
+
+void DistributedFCIVector::release(int h, bool update) const {
+    const auto [begin, end] = local_rows_[h];
+    if (begin == end)
+        return;
+    int lo[2] = {static_cast<int>(begin), 0};
+    int hi[2] = {static_cast<int>(end) - 1, static_cast<int>(block_size_[h].second) - 1};
+    if (update) {
+        NGA_Release_update(ga_[h], lo, hi);
+    } else {
+        NGA_Release(ga_[h], lo, hi);
+    }
+}
+
+void DistributedFCIVector::get_rows(int h, std::pair<size_t, size_t> rows,
+                                    std::vector<double>& buffer) const {
+    const size_t nb = block_size_[h].second;
+    buffer.resize((rows.second - rows.first) * nb);
+    if (buffer.empty())
+        return;
+    int lo[2] = {static_cast<int>(rows.first), 0};
+    int hi[2] = {static_cast<int>(rows.second) - 1, static_cast<int>(nb) - 1};
+    int ld[1] = {static_cast<int>(nb)};
+    NGA_Get(ga_[h], lo, hi, buffer.data(), ld);
+}
+
+void DistributedFCIVector::zero() {
+    for (int g : ga_) {
+        if (g)
+            GA_Zero(g);
+    }
+}
+
+void DistributedFCIVector::copy(const DistributedFCIVector& wfn) {
+    for (int h = 0; h < nirrep_; ++h) {
+        if (ga_[h])
+            GA_Copy(wfn.ga_[h], ga_[h]);
+    }
+}
+
+void DistributedFCIVector::copy(std::shared_ptr<psi::Vector> vec) {
+    size_t offset = 0;
+    for (int h = 0; h < nirrep_; ++h) {
+        const auto [na, nb] = block_size_[h];
+        if (double* c = access(h)) {
+            const auto [begin, end] = local_rows_[h];
+            for (size_t Ia = begin; Ia < end; ++Ia) {
+                for (size_t Ib = 0; Ib < nb; ++Ib) {
+                    c[(Ia - begin) * nb + Ib] = vec->get(offset + Ia * nb + Ib);
+                }
+            }
+            release(h, true);
+        }
+        offset += na * nb;
+    }
+    GA_Sync();
+}
+
+void DistributedFCIVector::copy_to(std::shared_ptr<psi::Vector> vec) {
+    GA_Sync();
+    size_t offset = 0;
+    std::vector<double> buffer;
+    for (int h = 0; h < nirrep_; ++h) {
+        const auto [na, nb] = block_size_[h];
+        get_rows(h, {0, na * nb > 0 ? na : 0}, buffer);
+        for (size_t I = 0; I < buffer.size(); ++I) {
+            vec->set(offset + I, buffer[I]);
+        }
+        offset += na * nb;
+    }
+}
+
+double DistributedFCIVector::dot(const DistributedFCIVector& wfn) const {
+    double result = 0.0;
+    for (int h = 0; h < nirrep_; ++h) {
+        if (ga_[h])
+            result += GA_Ddot(ga_[h], wfn.ga_[h]);
+    }
+    return result;
+}
+
+double DistributedFCIVector::norm() const { return std::sqrt(dot(*this)); }
+
+void DistributedFCIVector::scale(double factor) {
+    for (int g : ga_) {
+        if (g)
+            GA_Scale(g, &factor);
+    }
+}
+
+void DistributedFCIVector::axpy(double factor, const DistributedFCIVector& x) {
+    double one = 1.0;
+    for (int h = 0; h < nirrep_; ++h) {
+        if (ga_[h])
+            GA_Add(&one, ga_[h], &factor, x.ga_[h], ga_[h]);
+    }
+}
+
+void DistributedFCIVector::set_excluded_determinants(double value) {
+    if (not lists_->restricted_determinants())
+        return;
+    for (int h = 0; h < nirrep_; ++h) {
+        const int hb = h ^ symmetry_;
+        const size_t nb = block_size_[h].second;
+        if (double* c = access(h)) {
+            const auto [begin, end] = local_rows_[h];
+#pragma omp parallel for
+            for (size_t Ia = begin; Ia < end; ++Ia) {
+                for (size_t Ib = 0; Ib < nb; ++Ib) {
+                    if (not lists_->allowed_determinant(h, Ia, hb, Ib))
+                        c[(Ia - begin) * nb + Ib] = value;
+                }
+            }
+            release(h, true);
+        }
+    }
+}
+
+void DistributedFCIVector::form_H_diagonal(std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
+    const size_t n = lists_->ncmo();
+    const double E0 = fci_ints->scalar_energy() + fci_ints->frozen_core_energy() +
+                      fci_ints->nuclear_repulsion_energy();
+    std::vector<double> D_ab(n * n);
+    for (size_t p = 0; p < n; ++p) {
+        for (size_t q = 0; q < n; ++q) {
+            D_ab[p * n + q] = fci_ints->diag_tei_ab(p, q);
+        }
+    }
+
+    // The occupation numbers and the one-electron plus same-spin energies of the strings
+    // [begin, end) of irrep h, as in FCIVector::form_H_diagonal
+    auto string_energies = [&](bool alfa, int h, size_t begin, size_t end,
+                               std::vector<double>& occ, std::vector<double>& energy) {
+        occ.assign((end - begin) * n, 0.0);
+        energy.assign(end - begin, 0.0);
+#pragma omp parallel for
+        for (size_t I = begin; I < end; ++I) {
+            const auto str = alfa ? lists_->alfa_str(h, I) : lists_->beta_str(h, I);
+            double* occ_I = occ.data() + (I - begin) * n;
+            double e = 0.0;
+            for (size_t p = 0; p < n; ++p) {
+                if (not str[p])
+                    continue;
+                occ_I[p] = 1.0;
+                e += alfa ? fci_ints->oei_a(p, p) : fci_ints->oei_b(p, p);
+                for (size_t q = p + 1; q < n; ++q) {
+                    if (str[q])
+                        e += alfa ? fci_ints->diag_tei_aa(p, q) : fci_ints->diag_tei_bb(p, q);
+                }
+            }
+            energy[I - begin] = e;
+        }
+    };
+
+    std::vector<double> occ_a, occ_b, E_a, E_b, W;
+    for (int h = 0; h < nirrep_; ++h) {
+        const auto [begin, end] = local_rows_[h];
+        const size_t maxIa = end - begin;
+        const size_t maxIb = block_size_[h].second;
+        if (maxIa * maxIb == 0)
+            continue;
+        string_energies(true, h, begin, end, occ_a, E_a);
+        string_energies(false, h ^ symmetry_, 0, maxIb, occ_b, E_b);
+
+        double* c = access(h);
+        W.resize(maxIa * n);
+        C_DGEMM('N', 'N', maxIa, n, n, 1.0, occ_a.data(), n, D_ab.data(), n, 0.0, W.data(), n);
+        C_DGEMM('N', 'T', maxIa, maxIb, n, 1.0, W.data(), n, occ_b.data(), n, 0.0, c, maxIb);
+#pragma omp parallel for
+        for (size_t Ia = 0; Ia < maxIa; ++Ia) {
+            const double E_Ia = E0 + E_a[Ia];
+            double* c_Ia = c + Ia * maxIb;
+#pragma omp simd
+            for (size_t Ib = 0; Ib < maxIb; ++Ib) {
+                c_Ia[Ib] += E_Ia + E_b[Ib];
+            }
+        }
+        release(h, true);
+    }
+    set_excluded_determinants(1.0e10);
+    GA_Sync();
+}
+
+std::vector<DistributedFCIVector::Coupling>
+DistributedFCIVector::same_spin_couplings(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                                          bool alfa, int h) const {
+    std::vector<Coupling> couplings;
+    auto add = [&](const std::vector<StringSubstitution>& list, double integral) {
+        for (const auto& s : list) {
+            couplings.push_back({s.J, s.I, static_cast<double>(s.sign) * integral});
+        }
+    };
+    const auto cmopi = lists_->cmopi();
+    const auto offset = lists_->cmopi_offset();
+    // one-body part (see FCIVector::H1)
+    for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
+        for (int p_rel = 0; p_rel < cmopi[p_sym]; ++p_rel) {
+            for (int q_rel = 0; q_rel < cmopi[p_sym]; ++q_rel) {
+                const size_t p = p_rel + offset[p_sym];
+                const size_t q = q_rel + offset[p_sym];
+                add(alfa ? lists_->get_alfa_vo_list(p, q, h) : lists_->get_beta_vo_list(p, q, h),
+                    alfa ? fci_ints->oei_a(p, q) : fci_ints->oei_b(p, q));
+            }
+        }
+    }
+    // same-spin two-body part (see FCIVector::H2_aaaa2)
+    auto tei = [&](size_t p, size_t q, size_t r, size_t s) {
+        return alfa ? fci_ints->tei_aa(p, q, r, s) : fci_ints->tei_bb(p, q, r, s);
+    };
+    for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
+        const size_t max_pq = lists_->pairpi(pq_sym);
+        for (size_t pq = 0; pq < max_pq; ++pq) {
+            const auto [p, q] = lists_->get_nn_list_pair(pq_sym, pq);
+            add(alfa ? lists_->get_alfa_oo_list(pq_sym, pq, h)
+                     : lists_->get_beta_oo_list(pq_sym, pq, h),
+                tei(p, q, p, q));
+            for (size_t rs = 0; rs < pq; ++rs) {
+                const auto [r, s] = lists_->get_nn_list_pair(pq_sym, rs);
+                const double integral = tei(p, q, r, s);
+                add(alfa ? lists_->get_alfa_vvoo_list(p, q, r, s, h)
+                         : lists_->get_beta_vvoo_list(p, q, r, s, h),
+                    integral);
+                add(alfa ? lists_->get_alfa_vvoo_list(r, s, p, q, h)
+                         : lists_->get_beta_vvoo_list(r, s, p, q, h),
+                    integral);
+            }
+        }
+    }
+    return couplings;
+}
+
+void DistributedFCIVector::apply_alfa_couplings(const std::vector<Coupling>& couplings, int h,
+                                                double* y) const {
+    const auto [begin, end] = local_rows_[h];
+    const size_t nb = block_size_[h].second;
+    // keep the couplings that update the rows J stored on this process, grouped by J
+    std::vector<Coupling> local;
+    std::copy_if(couplings.begin(), couplings.end(), std::back_inserter(local),
+                 [&](const Coupling& c) { return (c.J >= begin) and (c.J < end); });
+    std::stable_sort(local.begin(), local.end(),
+                     [](const Coupling& a, const Coupling& b) { return a.J < b.J; });
+
+    std::vector<double> buffer;
+    std::vector<Coupling> block;
+    for (int proc = 0; proc < GA_Nnodes(); ++proc) {
+        const auto rows = rows_of(h, proc);
+        block.clear();
+        std::copy_if(local.begin(), local.end(), std::back_inserter(block), [&](const Coupling& c) {
+            return (c.I >= rows.first) and (c.I < rows.second);
+        });
+        if (block.empty())
+            continue;
+        get_rows(h, rows, buffer);
+        const auto starts = group_starts(block);
+#pragma omp parallel for schedule(dynamic)
+        for (size_t g = 0; g < starts.size() - 1; ++g) {
+            double* y_J = y + (block[starts[g]].J - begin) * nb;
+            for (size_t n = starts[g]; n < starts[g + 1]; ++n) {
+                C_DAXPY(nb, block[n].value, &buffer[(block[n].I - rows.first) * nb], 1, y_J, 1);
+            }
+        }
+    }
+}
+
+void DistributedFCIVector::apply_aabb(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                                      DistributedFCIVector& result) const {
+    // An alpha substitution J = sign E^a_pq I
+    struct AlfaTerm {
+        size_t J;
+        size_t I;
+        double sign;
+        size_t p;
+        size_t q;
+    };
+    const auto cmopi = lists_->cmopi();
+    const auto offset = lists_->cmopi_offset();
+    std::vector<double> buffer;
+    for (int ha = 0; ha < nirrep_; ++ha) {
+        const int hb = ha ^ symmetry_;
+        if (ga_[ha] == 0)
+            continue;
+        const size_t nbI = block_size_[ha].second;
+        for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
+            const int Ja_sym = ha ^ pq_sym;
+            const auto [begin, end] = result.local_rows_[Ja_sym];
+            if ((result.ga_[Ja_sym] == 0) or (begin == end))
+                continue;
+            const size_t nbJ = result.block_size_[Ja_sym].second;
+
+            // the (r,s) pairs with the symmetry of (p,q)
+            std::vector<std::pair<size_t, size_t>> rs_list;
+            for (int r_sym = 0; r_sym < nirrep_; ++r_sym) {
+                const int s_sym = pq_sym ^ r_sym;
+                for (int r_rel = 0; r_rel < cmopi[r_sym]; ++r_rel) {
+                    for (int s_rel = 0; s_rel < cmopi[s_sym]; ++s_rel) {
+                        rs_list.emplace_back(r_rel + offset[r_sym], s_rel + offset[s_sym]);
+                    }
+                }
+            }
+
+            // the alpha substitutions that update the rows stored on this process
+            std::vector<AlfaTerm> terms;
+            for (const auto& [p, q] : rs_list) {
+                for (const auto& s : lists_->get_alfa_vo_list(p, q, ha)) {
+                    if ((s.J >= begin) and (s.J < end))
+                        terms.push_back({s.J, s.I, static_cast<double>(s.sign), p, q});
+                }
+            }
+            if (terms.empty())
+                continue;
+            std::stable_sort(terms.begin(), terms.end(),
+                             [](const AlfaTerm& a, const AlfaTerm& b) { return a.J < b.J; });
+
+            double* y = result.access(Ja_sym);
+            std::vector<AlfaTerm> block;
+            for (int proc = 0; proc < GA_Nnodes(); ++proc) {
+                const auto rows = rows_of(ha, proc);
+                block.clear();
+                std::copy_if(terms.begin(), terms.end(), std::back_inserter(block),
+                             [&](const AlfaTerm& t) {
+                                 return (t.I >= rows.first) and (t.I < rows.second);
+                             });
+                if (block.empty())
+                    continue;
+                get_rows(ha, rows, buffer);
+                const auto starts = group_starts(block);
+#pragma omp parallel for schedule(dynamic)
+                for (size_t g = 0; g < starts.size() - 1; ++g) {
+                    double* y_J = y + (block[starts[g]].J - begin) * nbJ;
+                    for (size_t n = starts[g]; n < starts[g + 1]; ++n) {
+                        const AlfaTerm& t = block[n];
+                        const double* c_I = &buffer[(t.I - rows.first) * nbI];
+                        for (const auto& [r, s] : rs_list) {
+                            const double V = t.sign * fci_ints->tei_ab(t.p, r, t.q, s);
+                            if (V == 0.0)
+                                continue;
+                            const StringSubstitutionSoA& vo_beta =
+                                lists_->get_beta_vo_soa(r, s, hb);
+                            const size_t maxSSb = vo_beta.size();
+                            for (size_t k = 0; k < maxSSb; ++k) {
+                                y_J[vo_beta.J[k]] += V * vo_beta.sign[k] * c_I[vo_beta.I[k]];
+                            }
+                        }
+                    }
+                }
+            }
+            result.release(Ja_sym, true);
+        }
+    }
+}
+
+void DistributedFCIVector::Hamiltonian(DistributedFCIVector& result,
+                                       std::shared_ptr<ActiveSpaceIntegrals> fci_ints) const {
+    // all the processes must have finished writing C before it is read
+    GA_Sync();
+    const double E0 = fci_ints->scalar_energy() + fci_ints->frozen_core_energy() +
+                      fci_ints->nuclear_repulsion_energy();
+    for (int h = 0; h < nirrep_; ++h) {
+        if (ga_[h] == 0)
+            continue;
+        const auto [begin, end] = local_rows_[h];
+        const size_t nb = block_size_[h].second;
+        const double* c = access(h);
+        double* y = result.access(h);
+        if (c != nullptr) {
+            // H0 and the beta part, which only couples the determinants within each row
+            const auto beta_couplings = same_spin_couplings(fci_ints, false, h ^ symmetry_);
+#pragma omp parallel for schedule(dynamic)
+            for (size_t Ia = 0; Ia < end - begin; ++Ia) {
+                const double* c_Ia = c + Ia * nb;
+                double* y_Ia = y + Ia * nb;
+                for (size_t Ib = 0; Ib < nb; ++Ib) {
+                    y_Ia[Ib] = E0 * c_Ia[Ib];
+                }
+                for (const auto& t : beta_couplings) {
+                    y_Ia[t.J] += t.value * c_Ia[t.I];
+                }
+            }
+        }
+        release(h, false);
+        // the alpha part, which reads the rows of C stored on all the processes
+        if (y != nullptr) {
+            apply_alfa_couplings(same_spin_couplings(fci_ints, true, h), h, y);
+        }
+        result.release(h, true);
+    }
+    apply_aabb(fci_ints, result);
+    result.set_excluded_determinants();
+    // the rows of sigma are complete
+    GA_Sync();
+}
+
+} // namespace forte
+
+#endif // HAVE_GA
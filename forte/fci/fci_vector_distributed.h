@@ -0,0 +1,147 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _fci_vector_distributed_
+#define _fci_vector_distributed_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace psi {
+class Vector;
+}
+
+namespace forte {
+
+class ActiveSpaceIntegrals;
+class StringLists;
+
+#ifdef HAVE_GA
+/**
+ * @brief The DistributedFCIVector class
+ *
+ * An FCI vector stored in Global Arrays, one array C[Ia][Ib] for each symmetry of the alpha
+ * strings. The alpha strings (rows) are block-distributed across the processes and each process
+ * stores all the beta strings of its rows, so that the beta parts of the Hamiltonian are applied
+ * locally by the OpenMP threads of each process. The alpha and alpha-beta parts read the rows of
+ * C stored on the other processes one process block at a time with one-sided gets, and each
+ * process only writes to the rows of sigma that it stores.
+ *
+ * The determinants are ordered as in FCIVector, so that a vector can be moved between the two
+ * representations with copy()/copy_to().
+ */
+class DistributedFCIVector {
+  public:
+    DistributedFCIVector(std::shared_ptr<StringLists> lists, size_t symmetry);
+    ~DistributedFCIVector();
+
+    DistributedFCIVector(const DistributedFCIVector&) = delete;
+    DistributedFCIVector& operator=(const DistributedFCIVector&) = delete;
+
+    /// @return the number of determinants
+    size_t size() const { return ndet_; }
+    /// @return the number of determinants stored on this process
+    size_t local_size() const;
+    /// @return the alpha strings [begin, end) of irrep h stored on this process
+    std::pair<size_t, size_t> local_rows(int h) const { return local_rows_[h]; }
+
+    /// Set all the elements to zero
+    void zero();
+    /// Set this vector to another distributed vector with the same symmetry
+    void copy(const DistributedFCIVector& wfn);
+    /// Set the local rows from a vector with all the determinants (in the order of FCIVector)
+    void copy(std::shared_ptr<psi::Vector> vec);
+    /// Gather all the determinants in a vector (collective)
+    void copy_to(std::shared_ptr<psi::Vector> vec);
+    /// @return the dot product with another distributed vector (collective)
+    double dot(const DistributedFCIVector& wfn) const;
+    /// @return the 2-norm of the vector (collective)
+    double norm() const;
+    /// Scale the vector (collective)
+    void scale(double factor);
+    /// Add factor * x to this vector (collective)
+    void axpy(double factor, const DistributedFCIVector& x);
+
+    /// Set the local rows to the diagonal of the Hamiltonian
+    void form_H_diagonal(std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    /// Compute result = H this (collective)
+    void Hamiltonian(DistributedFCIVector& result,
+                     std::shared_ptr<ActiveSpaceIntegrals> fci_ints) const;
+
+  private:
+    /// A term c <J|O|I> of a string operator O
+    struct Coupling {
+        size_t J;
+        size_t I;
+        double value;
+    };
+
+    /// The string lists
+    std::shared_ptr<StringLists> lists_;
+    /// The symmetry of the vector
+    size_t symmetry_;
+    /// The number of irreps
+    int nirrep_;
+    /// The number of determinants
+    size_t ndet_ = 0;
+    /// The number of alpha and beta strings of each symmetry block
+    std::vector<std::pair<size_t, size_t>> block_size_;
+    /// The GA handle of each symmetry block (0 for empty blocks)
+    std::vector<int> ga_;
+    /// The rows of each symmetry block stored on this process
+    std::vector<std::pair<size_t, size_t>> local_rows_;
+
+    /// @return a pointer to the local rows of block h (nullptr if there are none). The rows are
+    /// contiguous, each one of length block_size_[h].second. Must be paired with release()
+    double* access(int h) const;
+    /// Release the local rows of block h, update = true if they were modified
+    void release(int h, bool update) const;
+    /// @return the rows [begin, end) of block h stored on process proc
+    std::pair<size_t, size_t> rows_of(int h, int proc) const;
+    /// Read the rows [begin, end) of block h into buffer (one-sided)
+    void get_rows(int h, std::pair<size_t, size_t> rows, std::vector<double>& buffer) const;
+
+    /// The couplings <J|O|I> of the one-body and same-spin two-body operators for the strings of
+    /// irrep h (alpha or beta)
+    std::vector<Coupling> same_spin_couplings(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                                              bool alfa, int h) const;
+    /// Add the alpha couplings of the strings of irrep h to the local rows y of sigma:
+    /// y[J][Ib] += v c[I][Ib], where the rows I are read from all the processes
+    void apply_alfa_couplings(const std::vector<Coupling>& couplings, int h, double* y) const;
+    /// Add the alpha-beta two-body operator to the local rows of result
+    void apply_aabb(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                    DistributedFCIVector& result) const;
+    /// Set the determinants excluded by the restrictions of the string lists to a value
+    void set_excluded_determinants(double value = 0.0);
+};
+#endif // HAVE_GA
+
+} // namespace forte
+
+#endif // _fci_vector_distributed_
@@ -33,12 +33,14 @@
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/psi4-dec.h"
 #include "psi4/libmints/matrix.h"
+#include "psi4/libqt/qt.h"
 
 #include "helpers/timer.h"
 #include "base_classes/mo_space_info.h"
 #include "integrals/active_space_integrals.h"
 #include "fci_vector.h"
 #include "binary_graph.hpp"
+#include "string_lists.h"
 
 using namespace psi;
 
@@ -47,49 +49,74 @@ namespace forte {
 void FCIVector::form_H_diagonal(std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
     local_timer t;
 
-    int wfn_sym = symmetry_;
-    int n = ncmo_;
-    int ka = alfa_graph_->nones();
-    int kb = beta_graph_->nones();
-
-    bool* Ia = new bool[n];
-    bool* Ib = new bool[n];
-
-    // Generate the alfa string 1111000000
-    //                          {ka}{n-ka}
-    for (int i = 0; i < n - ka; ++i)
-        Ia[i] = false; // 0
-    for (int i = n - ka; i < n; ++i)
-        Ia[i] = true; // 1
-    // Loop over all alfa strings
-    do {
-        // Compute irrep
-        int alfa_sym = alfa_graph_->sym(Ia);
-        int beta_sym = alfa_sym ^ wfn_sym;
+    const size_t n = ncmo_;
+    const double E0 = fci_ints->scalar_energy() + fci_ints->frozen_core_energy() +
+                      fci_ints->nuclear_repulsion_energy();
 
-        double** C_ha = C_[alfa_sym]->pointer();
+    // The energy of |Ia Ib> is E0 + E_a(Ia) + E_b(Ib) + sum_pq n_p(Ia) <pq|pq> n_q(Ib), where E_a
+    // and E_b contain the one-electron and same-spin terms of each string. For each symmetry
+    // block, the alpha-beta term is computed as the matrix product N_a D_ab N_b^T
+    std::vector<double> D_ab(n * n);
+    for (size_t p = 0; p < n; ++p) {
+        for (size_t q = 0; q < n; ++q) {
+            D_ab[p * n + q] = fci_ints->diag_tei_ab(p, q);
+        }
+    }
 
-        // Generate the beta string 1111000000
-        //                          {kb}{n-kb}
-        for (int i = 0; i < n - kb; ++i)
-            Ib[i] = false; // 0
-        for (int i = n - kb; i < n; ++i)
-            Ib[i] = true; // 1
-        // Loop over all beta strings
-        do {
-            // Check if the product of strings gives the right irrep
-            if (beta_graph_->sym(Ib) == beta_sym) {
-                size_t addIa = alfa_graph_->rel_add(Ia);
-                size_t addIb = beta_graph_->rel_add(Ib);
-                C_ha[addIa][addIb] = determinant_energy(Ia, Ib, n, fci_ints);
-                //        outfile->Printf("\n |[%1d][%3d][%3d]> energy =
-                //        %20.12f",alfa_sym,static_cast<int> (addIa),
-                //                                                                         static_cast<int>
-                //                                                                         (addIb),coefficients[alfa_sym][addIa][addIb]);
+    // The occupation numbers (one row per string) and the energies E_a (E_b) of the strings of
+    // irrep h
+    auto string_energies = [&](bool alfa, int h, std::vector<double>& occ,
+                               std::vector<double>& energy) {
+        const size_t nstr = (alfa ? alfa_graph_ : beta_graph_)->strpi(h);
+        occ.assign(nstr * n, 0.0);
+        energy.assign(nstr, 0.0);
+#pragma omp parallel for
+        for (size_t I = 0; I < nstr; ++I) {
+            const auto str = alfa ? lists_->alfa_str(h, I) : lists_->beta_str(h, I);
+            double* occ_I = occ.data() + I * n;
+            double e = 0.0;
+            for (size_t p = 0; p < n; ++p) {
+                if (not str[p])
+                    continue;
+                occ_I[p] = 1.0;
+                e += alfa ? fci_ints->oei_a(p, p) : fci_ints->oei_b(p, p);
+                for (size_t q = p + 1; q < n; ++q) {
+                    if (str[q])
+                        e += alfa ? fci_ints->diag_tei_aa(p, q) : fci_ints->diag_tei_bb(p, q);
+                }
             }
-        } while (std::next_permutation(Ib, Ib + n));
+            energy[I] = e;
+        }
+    };
 
-    } while (std::next_permutation(Ia, Ia + n));
+    std::vector<double> occ_a, occ_b, E_a, E_b, W;
+    for (int alfa_sym = 0; alfa_sym < nirrep_; ++alfa_sym) {
+        int beta_sym = alfa_sym ^ symmetry_;
+        string_energies(true, alfa_sym, occ_a, E_a);
+        string_energies(false, beta_sym, occ_b, E_b);
+        const size_t maxIa = E_a.size();
+        const size_t maxIb = E_b.size();
+        if (maxIa * maxIb == 0)
+            continue;
+
+        // W = N_a D_ab and C = W N_b^T
+        double** C_ha = C_[alfa_sym]->pointer();
+        W.resize(maxIa * n);
+        C_DGEMM('N', 'N', maxIa, n, n, 1.0, occ_a.data(), n, D_ab.data(), n, 0.0, W.data(), n);
+        C_DGEMM('N', 'T', maxIa, maxIb, n, 1.0, W.data(), n, occ_b.data(), n, 0.0, C_ha[0],
+                maxIb);
+#pragma omp parallel for
+        for (size_t Ia = 0; Ia < maxIa; ++Ia) {
+            const double E_Ia = E0 + E_a[Ia];
+            double* C_Ia = C_ha[Ia];
+#pragma omp simd
+            for (size_t Ib = 0; Ib < maxIb; ++Ib) {
+                C_Ia[Ib] += E_Ia + E_b[Ib];
+            }
+        }
+    }
+    // keep the determinants excluded by the restrictions out of the guess and the corrections
+    set_excluded_determinants(1.0e10);
 
     hdiag_timer += t.get();
     if (print_) {
@@ -97,62 +124,48 @@ void FCIVector::form_H_diagonal(std::shared_ptr<ActiveSpaceIntegrals> fci_ints)
     }
 }
 
-double FCIVector::determinant_energy(bool*& Ia, bool*& Ib, int n,
-                                     std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
-    double energy(fci_ints->scalar_energy() + fci_ints->frozen_core_energy() +
-                  fci_ints->nuclear_repulsion_energy());
-
-    for (int p = 0; p < n; ++p) {
-        if (Ia[p])
-            energy += fci_ints->oei_a(p, p);
-        if (Ib[p])
-            energy += fci_ints->oei_b(p, p);
-        for (int q = 0; q < n; ++q) {
-            if (Ia[p] && Ia[q])
-                energy += 0.5 * fci_ints->tei_aa(p, q, p, q);
-            if (Ib[p] && Ib[q])
-                energy += 0.5 * fci_ints->tei_bb(p, q, p, q);
-            if (Ia[p] && Ib[q])
-                energy += fci_ints->tei_ab(p, q, p, q);
-        }
-    }
-    return (energy);
-}
-
 std::vector<std::tuple<double, size_t, size_t, size_t>> FCIVector::min_elements(size_t num_dets) {
+    using Element = std::tuple<double, size_t, size_t, size_t>;
     num_dets = std::min(num_dets, ndet_);
+    if (num_dets == 0)
+        return {};
 
-    double emax = std::numeric_limits<double>::max();
-    size_t added = 0;
-
-    std::vector<std::tuple<double, size_t, size_t, size_t>> dets(num_dets);
-    for (auto& det : dets) {
-        std::get<0>(det) = emax;
+    std::vector<std::pair<int, size_t>> rows;
+    for (int alfa_sym = 0; alfa_sym < nirrep_; ++alfa_sym) {
+        for (size_t Ia = 0, maxIa = alfa_graph_->strpi(alfa_sym); Ia < maxIa; ++Ia) {
+            rows.emplace_back(alfa_sym, Ia);
+        }
     }
 
-    for (int alfa_sym = 0; alfa_sym < nirrep_; ++alfa_sym) {
-        int beta_sym = alfa_sym ^ symmetry_;
-        size_t maxIa = alfa_graph_->strpi(alfa_sym);
-        size_t maxIb = beta_graph_->strpi(beta_sym);
-        double** C_ha = C_[alfa_sym]->pointer();
-        for (size_t Ia = 0; Ia < maxIa; ++Ia) {
+    // Each thread keeps the num_dets smallest elements of its rows in a max-heap. The elements
+    // are compared as tuples, so that equal values are ordered by address independently of the
+    // number of threads
+    std::vector<Element> dets;
+#pragma omp parallel
+    {
+        std::vector<Element> heap;
+#pragma omp for schedule(dynamic, 16) nowait
+        for (size_t row = 0; row < rows.size(); ++row) {
+            const auto [alfa_sym, Ia] = rows[row];
+            const size_t maxIb = beta_graph_->strpi(alfa_sym ^ symmetry_);
+            const double* C_Ia = C_[alfa_sym]->pointer()[Ia];
             for (size_t Ib = 0; Ib < maxIb; ++Ib) {
-                double e = C_ha[Ia][Ib];
-                if ((e < emax) or (added < num_dets)) {
-                    // Find where to inser this determinant
-                    dets.pop_back();
-                    auto it =
-                        std::find_if(dets.begin(), dets.end(),
-                                     [&e](const std::tuple<double, size_t, size_t, size_t>& t) {
-                                         return e < std::get<0>(t);
-                                     });
-                    dets.insert(it, std::make_tuple(e, alfa_sym, Ia, Ib));
-                    emax = std::get<0>(dets.back());
-                    added++;
+                Element det(C_Ia[Ib], alfa_sym, Ia, Ib);
+                if (heap.size() < num_dets) {
+                    heap.push_back(det);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (det < heap.front()) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = det;
+                    std::push_heap(heap.begin(), heap.end());
                 }
             }
         }
+#pragma omp critical
+        dets.insert(dets.end(), heap.begin(), heap.end());
     }
+    std::partial_sort(dets.begin(), dets.begin() + num_dets, dets.end());
+    dets.resize(num_dets);
     return dets;
 }
 
@@ -26,12 +26,20 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+
 #include "psi4/libqt/qt.h"
 #include "psi4/libmints/matrix.h"
+#include "psi4/libpsi4util/exception.h"
 
 #include "integrals/active_space_integrals.h"
 #include "helpers/timer.h"
+#include "forte-def.h"
 #include "fci_vector.h"
+#include "fci_kernels.h"
+#include "fci_workspace.h"
 #include "binary_graph.hpp"
 #include "string_lists.h"
 
@@ -44,124 +52,200 @@ namespace forte {
  * @param result Wave function object which stores the resulting vector
  */
 void FCIVector::Hamiltonian(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
-    //    check_temp_space();
-    result.zero();
+    std::vector<FCIVector*> C{this};
+    std::vector<FCIVector*> HC{&result};
+    Hamiltonian_block(C, HC, fci_ints);
+}
+
+/**
+ * Apply the Hamiltonian to a block of wave functions
+ * @param C the vectors to which the Hamiltonian is applied
+ * @param HC the vectors which store the results
+ */
+void FCIVector::Hamiltonian(const std::vector<std::shared_ptr<FCIVector>>& C,
+                            const std::vector<std::shared_ptr<FCIVector>>& HC,
+                            std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
+    if (C.size() != HC.size()) {
+        throw psi::PSIEXCEPTION("FCIVector::Hamiltonian: the number of input and output "
+                                "vectors is different.");
+    }
+    if (C.empty())
+        return;
+    std::vector<FCIVector*> Cp, HCp;
+    for (size_t n = 0; n < C.size(); ++n) {
+        if ((C[n]->lists_ != C[0]->lists_) or (HC[n]->lists_ != C[0]->lists_) or
+            (C[n]->symmetry_ != C[0]->symmetry_) or (HC[n]->symmetry_ != C[0]->symmetry_)) {
+            throw psi::PSIEXCEPTION("FCIVector::Hamiltonian: all the vectors in a block must "
+                                    "share the same string lists and symmetry.");
+        }
+        Cp.push_back(C[n].get());
+        HCp.push_back(HC[n].get());
+    }
+    C[0]->Hamiltonian_block(Cp, HCp, fci_ints);
+}
+
+/**
+ * Apply the Hamiltonian to a block of wave functions. Each pass over the substitution lists
+ * updates all the vectors in the block, so the cost of traversing the lists and fetching the
+ * integrals is shared by all the vectors.
+ */
+void FCIVector::Hamiltonian_block(const std::vector<FCIVector*>& C,
+                                  const std::vector<FCIVector*>& HC,
+                                  std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
+    ProfileRegion region("FCIVector::Hamiltonian");
+    for (FCIVector* result : HC) {
+        result->zero();
+    }
 
     // H0
-    { H0(result, fci_ints); }
+    { H0(C, HC, fci_ints); }
     // H1_aa
     {
         local_timer t;
-        H1(result, fci_ints, true);
+        ProfileRegion kernel("H1_aa");
+        H1(C, HC, fci_ints, true);
         h1_aa_timer += t.get();
     }
     // H1_bb
     {
         local_timer t;
-        H1(result, fci_ints, false);
+        ProfileRegion kernel("H1_bb");
+        H1(C, HC, fci_ints, false);
         h1_bb_timer += t.get();
     }
     // H2_aabb
     {
         local_timer t;
-        H2_aabb(result, fci_ints);
+        ProfileRegion kernel("H2_aabb");
+        if (sigma_algorithm_ == FCISigmaAlgorithm::DGEMM) {
+            H2_aabb_dgemm(C, HC, fci_ints);
+        } else {
+            H2_aabb(C, HC, fci_ints);
+        }
         h2_aabb_timer += t.get();
     }
     // H2_aaaa
     {
         local_timer t;
-        H2_aaaa2(result, fci_ints, true);
+        ProfileRegion kernel("H2_aaaa");
+        H2_aaaa2(C, HC, fci_ints, true);
         h2_aaaa_timer += t.get();
     }
     // H2_bbbb
     {
         local_timer t;
-        H2_aaaa2(result, fci_ints, false);
+        ProfileRegion kernel("H2_bbbb");
+        H2_aaaa2(C, HC, fci_ints, false);
         h2_bbbb_timer += t.get();
     }
+    // project out the determinants excluded by the restrictions on the strings
+    for (FCIVector* result : HC) {
+        result->set_excluded_determinants();
+    }
 }
 
 /**
  * Apply the scalar part of the Hamiltonian to the wave function
  */
-void FCIVector::H0(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
+void FCIVector::H0(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                   std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
     double core_energy = fci_ints->scalar_energy() + fci_ints->frozen_core_energy() +
                          fci_ints->nuclear_repulsion_energy();
-    for (int alfa_sym = 0; alfa_sym < nirrep_; ++alfa_sym) {
-        result.C_[alfa_sym]->copy(C_[alfa_sym]);
-        result.C_[alfa_sym]->scale(core_energy);
+    for (size_t n = 0; n < C.size(); ++n) {
+        for (int alfa_sym = 0; alfa_sym < nirrep_; ++alfa_sym) {
+            HC[n]->C_[alfa_sym]->copy(C[n]->C_[alfa_sym]);
+            HC[n]->C_[alfa_sym]->scale(core_energy);
+        }
     }
 }
 
+/**
+ * Return the range [L0, L1) of columns assigned to thread tid when maxL columns are
+ * distributed among nthreads threads
+ */
+static std::pair<size_t, size_t> thread_column_range(size_t maxL, size_t tid, size_t nthreads) {
+    size_t L0 = (tid * maxL) / nthreads;
+    size_t L1 = ((tid + 1) * maxL) / nthreads;
+    return std::make_pair(L0, L1);
+}
+
 /**
  * Apply the one-particle Hamiltonian to the wave function
  * @param alfa flag for alfa or beta component, true = alfa, false = beta
+ *
+ * The blocks of all the vectors are placed side by side in the C1/Y1 scratch matrices of
+ * thread 0 (the beta part works on the transpose of each block). A single vector is
+ * processed in place for the alpha part.
+ * The work is distributed among threads by splitting the columns (L index) of each block,
+ * so that every thread writes to a disjoint part of Y.
  */
-void FCIVector::H1(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints, bool alfa) {
+void FCIVector::H1(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                   std::shared_ptr<ActiveSpaceIntegrals> fci_ints, bool alfa) {
+    size_t nvec = C.size();
+    FCIWorkspace& ws = workspace(nvec);
     for (int alfa_sym = 0; alfa_sym < nirrep_; ++alfa_sym) {
         int beta_sym = alfa_sym ^ symmetry_;
         if (detpi_[alfa_sym] > 0) {
-            psi::SharedMatrix C = alfa ? C_[alfa_sym] : C1;
-            psi::SharedMatrix Y = alfa ? result.C_[alfa_sym] : Y1;
-            double** Ch = C->pointer();
-            double** Yh = Y->pointer();
-
-            if (!alfa) {
-                C->zero();
-                Y->zero();
-                size_t maxIa = alfa_graph_->strpi(alfa_sym);
-                size_t maxIb = beta_graph_->strpi(beta_sym);
-
-                double** C0h = C_[alfa_sym]->pointer();
-
-                // Copy C0 transposed in C1
-                for (size_t Ia = 0; Ia < maxIa; ++Ia)
-                    for (size_t Ib = 0; Ib < maxIb; ++Ib)
-                        Ch[Ib][Ia] = C0h[Ia][Ib];
+            size_t maxIa = alfa_graph_->strpi(alfa_sym);
+            size_t maxIb = beta_graph_->strpi(beta_sym);
+
+            std::vector<double**> C0h(nvec), HC0h(nvec);
+            for (size_t n = 0; n < nvec; ++n) {
+                C0h[n] = C[n]->C_[alfa_sym]->pointer();
+                HC0h[n] = HC[n]->C_[alfa_sym]->pointer();
             }
 
-            size_t maxL = alfa ? beta_graph_->strpi(beta_sym) : alfa_graph_->strpi(alfa_sym);
+            bool in_place = alfa and (nvec == 1);
+            double** Ch = in_place ? C0h[0] : ws.C1(0);
+            double** Yh = in_place ? HC0h[0] : ws.Y1(0);
+            if (!in_place) {
+                fci_stack_blocks(C0h, maxIa, maxIb, !alfa, Ch, Yh);
+            }
 
-            for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
-                int q_sym = p_sym; // Select the totat symmetric irrep
-                for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
-                    for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
-                        int p_abs = p_rel + cmopi_offset_[p_sym];
-                        int q_abs = q_rel + cmopi_offset_[q_sym];
-
-                        double Hpq = alfa ? fci_ints->oei_a(p_abs, q_abs)
-                                          : fci_ints->oei_b(p_abs,
-                                                            q_abs); // Grab the integral
-                        std::vector<StringSubstitution>& vo =
-                            alfa ? lists_->get_alfa_vo_list(p_abs, q_abs, alfa_sym)
-                                 : lists_->get_beta_vo_list(p_abs, q_abs, beta_sym);
-                        // TODO loop in a differen way
-                        int maxss = vo.size();
-
-                        for (int ss = 0; ss < maxss; ++ss) {
+            size_t maxL = nvec * (alfa ? maxIb : maxIa);
+
+#pragma omp parallel
+            {
+                size_t L0, L1;
+                std::tie(L0, L1) =
+                    thread_column_range(maxL, omp_get_thread_num(), omp_get_num_threads());
+                size_t nL = L1 - L0;
+                if (nL > 0) {
+                    for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
+                        int q_sym = p_sym; // Select the totat symmetric irrep
+                        for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
+                            for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
+                                int p_abs = p_rel + cmopi_offset_[p_sym];
+                                int q_abs = q_rel + cmopi_offset_[q_sym];
+
+                                double Hpq = alfa ? fci_ints->oei_a(p_abs, q_abs)
+                                                  : fci_ints->oei_b(p_abs,
+                                                                    q_abs); // Grab the integral
+                                const std::vector<StringSubstitution>& vo =
+                                    alfa ? lists_->get_alfa_vo_list(p_abs, q_abs, alfa_sym)
+                                         : lists_->get_beta_vo_list(p_abs, q_abs, beta_sym);
+                                // TODO loop in a differen way
+                                int maxss = vo.size();
+
+                                for (int ss = 0; ss < maxss; ++ss) {
 #if CAPRICCIO_USE_DAXPY
-                            C_DAXPY(maxL, static_cast<double>(vo[ss].sign) * Hpq,
-                                    &(Ch[vo[ss].I][0]), 1, &(Yh[vo[ss].J][0]), 1);
+                                    C_DAXPY(nL, static_cast<double>(vo[ss].sign) * Hpq,
+                                            &(Ch[vo[ss].I][L0]), 1, &(Yh[vo[ss].J][L0]), 1);
 #else
-                            double H = static_cast<double>(vo[ss].sign) * Hpq;
-                            double* y = &Y[vo[ss].J][0];
-                            double* c = &C[vo[ss].I][0];
-                            for (size_t L = 0; L < maxL; ++L)
-                                y[L] += c[L] * H;
+                                    double H = static_cast<double>(vo[ss].sign) * Hpq;
+                                    double* y = &Yh[vo[ss].J][L0];
+                                    double* c = &Ch[vo[ss].I][L0];
+                                    for (size_t L = 0; L < nL; ++L)
+                                        y[L] += c[L] * H;
 #endif
+                                }
+                            }
                         }
                     }
                 }
             }
-            if (!alfa) {
-                size_t maxIa = alfa_graph_->strpi(alfa_sym);
-                size_t maxIb = beta_graph_->strpi(beta_sym);
-
-                double** HC = result.C_[alfa_sym]->pointer();
-                // Add Y1 transposed to Y
-                for (size_t Ia = 0; Ia < maxIa; ++Ia)
-                    for (size_t Ib = 0; Ib < maxIb; ++Ib)
-                        HC[Ia][Ib] += Yh[Ib][Ia];
+            if (!in_place) {
+                fci_add_stacked_blocks(Yh, maxIa, maxIb, !alfa, HC0h);
             }
         }
     } // End loop over h
@@ -170,105 +254,115 @@ void FCIVector::H1(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_
 /**
  * Apply the same-spin two-particle Hamiltonian to the wave function
  * @param alfa flag for alfa or beta component, true = alfa, false = beta
+ *
+ * Like H1, the blocks are placed side by side and the work is distributed among threads by
+ * splitting the columns of each block.
  */
-void FCIVector::H2_aaaa2(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
-                         bool alfa) {
+void FCIVector::H2_aaaa2(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                         std::shared_ptr<ActiveSpaceIntegrals> fci_ints, bool alfa) {
+    size_t nvec = C.size();
+    FCIWorkspace& ws = workspace(nvec);
     // Notation
     // ha - symmetry of alpha strings
     // hb - symmetry of beta strings
     for (int ha = 0; ha < nirrep_; ++ha) {
         int hb = ha ^ symmetry_;
         if (detpi_[ha] > 0) {
-            psi::SharedMatrix C = alfa ? C_[ha] : C1;
-            psi::SharedMatrix Y = alfa ? result.C_[ha] : Y1;
-            double** Ch = C->pointer();
-            double** Yh = Y->pointer();
-
-            if (!alfa) {
-                C->zero();
-                Y->zero();
-                size_t maxIa = alfa_graph_->strpi(ha);
-                size_t maxIb = beta_graph_->strpi(hb);
-
-                double** C0h = C_[ha]->pointer();
-
-                // Copy C0 transposed in C1
-                for (size_t Ia = 0; Ia < maxIa; ++Ia)
-                    for (size_t Ib = 0; Ib < maxIb; ++Ib)
-                        Ch[Ib][Ia] = C0h[Ia][Ib];
+            size_t maxIa = alfa_graph_->strpi(ha);
+            size_t maxIb = beta_graph_->strpi(hb);
+
+            std::vector<double**> C0h(nvec), HC0h(nvec);
+            for (size_t n = 0; n < nvec; ++n) {
+                C0h[n] = C[n]->C_[ha]->pointer();
+                HC0h[n] = HC[n]->C_[ha]->pointer();
             }
 
-            size_t maxL = alfa ? beta_graph_->strpi(hb) : alfa_graph_->strpi(ha);
-            // Loop over (p>q) == (p>q)
-            for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
-                size_t max_pq = lists_->pairpi(pq_sym);
-                for (size_t pq = 0; pq < max_pq; ++pq) {
-                    const Pair& pq_pair = lists_->get_nn_list_pair(pq_sym, pq);
-                    int p_abs = pq_pair.first;
-                    int q_abs = pq_pair.second;
-
-                    double integral = alfa ? fci_ints->tei_aa(p_abs, q_abs, p_abs, q_abs)
-                                           : fci_ints->tei_bb(p_abs, q_abs, p_abs, q_abs);
-
-                    std::vector<StringSubstitution>& OO =
-                        alfa ? lists_->get_alfa_oo_list(pq_sym, pq, ha)
-                             : lists_->get_beta_oo_list(pq_sym, pq, hb);
-
-                    size_t maxss = OO.size();
-                    for (size_t ss = 0; ss < maxss; ++ss)
-                        C_DAXPY(maxL, static_cast<double>(OO[ss].sign) * integral,
-                                &(C->pointer()[OO[ss].I][0]), 1, &(Y->pointer()[OO[ss].J][0]), 1);
-                }
+            bool in_place = alfa and (nvec == 1);
+            double** Ch = in_place ? C0h[0] : ws.C1(0);
+            double** Yh = in_place ? HC0h[0] : ws.Y1(0);
+            if (!in_place) {
+                fci_stack_blocks(C0h, maxIa, maxIb, !alfa, Ch, Yh);
             }
-            // Loop over (p>q) > (r>s)
-            for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
-                size_t max_pq = lists_->pairpi(pq_sym);
-                for (size_t pq = 0; pq < max_pq; ++pq) {
-                    const Pair& pq_pair = lists_->get_nn_list_pair(pq_sym, pq);
-                    int p_abs = pq_pair.first;
-                    int q_abs = pq_pair.second;
-                    for (size_t rs = 0; rs < pq; ++rs) {
-                        const Pair& rs_pair = lists_->get_nn_list_pair(pq_sym, rs);
-                        int r_abs = rs_pair.first;
-                        int s_abs = rs_pair.second;
-                        double integral = alfa ? fci_ints->tei_aa(p_abs, q_abs, r_abs, s_abs)
-                                               : fci_ints->tei_bb(p_abs, q_abs, r_abs, s_abs);
-
-                        {
-                            std::vector<StringSubstitution>& VVOO =
-                                alfa ? lists_->get_alfa_vvoo_list(p_abs, q_abs, r_abs, s_abs, ha)
-                                     : lists_->get_beta_vvoo_list(p_abs, q_abs, r_abs, s_abs, hb);
-                            // TODO loop in a differen way
-                            size_t maxss = VVOO.size();
+
+            size_t maxL = nvec * (alfa ? maxIb : maxIa);
+
+
+#pragma omp parallel
+            {
+                size_t L0, L1;
+                std::tie(L0, L1) =
+                    thread_column_range(maxL, omp_get_thread_num(), omp_get_num_threads());
+                size_t nL = L1 - L0;
+                if (nL > 0) {
+                    // Loop over (p>q) == (p>q)
+                    for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
+                        size_t max_pq = lists_->pairpi(pq_sym);
+                        for (size_t pq = 0; pq < max_pq; ++pq) {
+                            const Pair& pq_pair = lists_->get_nn_list_pair(pq_sym, pq);
+                            int p_abs = pq_pair.first;
+                            int q_abs = pq_pair.second;
+
+                            double integral = alfa ? fci_ints->tei_aa(p_abs, q_abs, p_abs, q_abs)
+                                                   : fci_ints->tei_bb(p_abs, q_abs, p_abs, q_abs);
+
+                            const std::vector<StringSubstitution>& OO =
+                                alfa ? lists_->get_alfa_oo_list(pq_sym, pq, ha)
+                                     : lists_->get_beta_oo_list(pq_sym, pq, hb);
+
+                            size_t maxss = OO.size();
                             for (size_t ss = 0; ss < maxss; ++ss)
-                                C_DAXPY(maxL, static_cast<double>(VVOO[ss].sign) * integral,
-                                        &(C->pointer()[VVOO[ss].I][0]), 1,
-                                        &(Y->pointer()[VVOO[ss].J][0]), 1);
+                                C_DAXPY(nL, static_cast<double>(OO[ss].sign) * integral,
+                                        &(Ch[OO[ss].I][L0]), 1, &(Yh[OO[ss].J][L0]), 1);
                         }
-                        {
-                            std::vector<StringSubstitution>& VVOO =
-                                alfa ? lists_->get_alfa_vvoo_list(r_abs, s_abs, p_abs, q_abs, ha)
-                                     : lists_->get_beta_vvoo_list(r_abs, s_abs, p_abs, q_abs, hb);
-                            // TODO loop in a differen way
-                            size_t maxss = VVOO.size();
-                            for (size_t ss = 0; ss < maxss; ++ss)
-                                C_DAXPY(maxL, static_cast<double>(VVOO[ss].sign) * integral,
-                                        &(C->pointer()[VVOO[ss].I][0]), 1,
-                                        &(Y->pointer()[VVOO[ss].J][0]), 1);
+                    }
+                    // Loop over (p>q) > (r>s)
+                    for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
+                        size_t max_pq = lists_->pairpi(pq_sym);
+                        for (size_t pq = 0; pq < max_pq; ++pq) {
+                            const Pair& pq_pair = lists_->get_nn_list_pair(pq_sym, pq);
+                            int p_abs = pq_pair.first;
+                            int q_abs = pq_pair.second;
+                            for (size_t rs = 0; rs < pq; ++rs) {
+                                const Pair& rs_pair = lists_->get_nn_list_pair(pq_sym, rs);
+                                int r_abs = rs_pair.first;
+                                int s_abs = rs_pair.second;
+                                double integral =
+                                    alfa ? fci_ints->tei_aa(p_abs, q_abs, r_abs, s_abs)
+                                         : fci_ints->tei_bb(p_abs, q_abs, r_abs, s_abs);
+
+                                {
+                                    const std::vector<StringSubstitution>& VVOO =
+                                        alfa ? lists_->get_alfa_vvoo_list(p_abs, q_abs, r_abs,
+                                                                          s_abs, ha)
+                                             : lists_->get_beta_vvoo_list(p_abs, q_abs, r_abs,
+                                                                          s_abs, hb);
+                                    // TODO loop in a differen way
+                                    size_t maxss = VVOO.size();
+                                    for (size_t ss = 0; ss < maxss; ++ss)
+                                        C_DAXPY(nL, static_cast<double>(VVOO[ss].sign) * integral,
+                                                &(Ch[VVOO[ss].I][L0]), 1, &(Yh[VVOO[ss].J][L0]),
+                                                1);
+                                }
+                                {
+                                    const std::vector<StringSubstitution>& VVOO =
+                                        alfa ? lists_->get_alfa_vvoo_list(r_abs, s_abs, p_abs,
+                                                                          q_abs, ha)
+                                             : lists_->get_beta_vvoo_list(r_abs, s_abs, p_abs,
+                                                                          q_abs, hb);
+                                    // TODO loop in a differen way
+                                    size_t maxss = VVOO.size();
+                                    for (size_t ss = 0; ss < maxss; ++ss)
+                                        C_DAXPY(nL, static_cast<double>(VVOO[ss].sign) * integral,
+                                                &(Ch[VVOO[ss].I][L0]), 1, &(Yh[VVOO[ss].J][L0]),
+                                                1);
+                                }
+                            }
                         }
                     }
                 }
             }
-            if (!alfa) {
-                size_t maxIa = alfa_graph_->strpi(ha);
-                size_t maxIb = beta_graph_->strpi(hb);
-
-                double** HC = result.C_[ha]->pointer();
-
-                // Add Y1 transposed to Y
-                for (size_t Ia = 0; Ia < maxIa; ++Ia)
-                    for (size_t Ib = 0; Ib < maxIb; ++Ib)
-                        HC[Ia][Ib] += Yh[Ib][Ia];
+            if (!in_place) {
+                fci_add_stacked_blocks(Yh, maxIa, maxIb, !alfa, HC0h);
             }
         }
     } // End loop over h
@@ -277,13 +371,28 @@ void FCIVector::H2_aaaa2(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals
 /**
  * Apply the different-spin component of two-particle Hamiltonian to the wave
  * function
+ *
+ * The (r,s) beta substitutions are distributed among threads. Each thread gathers
+ * into and accumulates on its own C1/Y1 scratch matrices; the scatter back to the
+ * sigma vector is the only step that touches shared data. The gather and scatter steps
+ * use the structure-of-arrays beta lists and the vectorized kernels in fci_kernels.h.
+ * The gathered columns of all the vectors are placed side by side, so that each alpha
+ * substitution updates the whole block with a single DAXPY.
+ * With the mixed precision setting the scratch matrices are stored in single precision and
+ * the result is accumulated in the double precision sigma vector.
  */
-void FCIVector::H2_aabb(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
+void FCIVector::H2_aabb(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                        std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
+    size_t nvec = C.size();
+    FCIWorkspace& ws = workspace(nvec);
     // Loop over blocks of matrix C
     for (int Ia_sym = 0; Ia_sym < nirrep_; ++Ia_sym) {
         size_t maxIa = alfa_graph_->strpi(Ia_sym);
         int Ib_sym = Ia_sym ^ symmetry_;
-        double** C = C_[Ia_sym]->pointer();
+        std::vector<double**> Ch(nvec);
+        for (size_t v = 0; v < nvec; ++v) {
+            Ch[v] = C[v]->C_[Ia_sym]->pointer();
+        }
 
         // Loop over all r,s
         for (int rs_sym = 0; rs_sym < nirrep_; ++rs_sym) {
@@ -296,80 +405,238 @@ void FCIVector::H2_aabb(FCIVector& result, std::shared_ptr<ActiveSpaceIntegrals>
             //            should fail for states with symmetry != A1  URGENT
 
             size_t maxJa = alfa_graph_->strpi(Ja_sym);
-            double** Y = result.C_[Ja_sym]->pointer();
+            std::vector<double**> Yh(nvec);
+            for (size_t v = 0; v < nvec; ++v) {
+                Yh[v] = HC[v]->C_[Ja_sym]->pointer();
+            }
+
+            // Collect the (r,s) pairs with symmetry rs_sym
+            std::vector<std::pair<int, int>> rs_list;
             for (int r_sym = 0; r_sym < nirrep_; ++r_sym) {
                 int s_sym = rs_sym ^ r_sym;
-
                 for (int r_rel = 0; r_rel < cmopi_[r_sym]; ++r_rel) {
                     for (int s_rel = 0; s_rel < cmopi_[s_sym]; ++s_rel) {
                         int r_abs = r_rel + cmopi_offset_[r_sym];
                         int s_abs = s_rel + cmopi_offset_[s_sym];
+                        rs_list.push_back(std::make_pair(r_abs, s_abs));
+                    }
+                }
+            }
+            int max_rs = rs_list.size();
+
+            // The (r,s) term, with scratch matrices C1h/Y1h of type double or float
+            auto rs_term = [&](int r_abs, int s_abs, auto** C1h, auto** Y1h) {
+                using T = std::remove_pointer_t<std::remove_pointer_t<decltype(C1h)>>;
+
+                // Grab list (r,s,Ib_sym) in the structure-of-arrays format
+                const StringSubstitutionSoA& vo_beta =
+                    lists_->get_beta_vo_soa(r_abs, s_abs, Ib_sym);
+                size_t maxSSb = vo_beta.size();
+                if (maxSSb == 0)
+                    return;
+                size_t ncol = nvec * maxSSb;
+
+                // Gather cols of C into C1
+                for (size_t Ia = 0; Ia < maxIa; ++Ia) {
+                    for (size_t v = 0; v < nvec; ++v) {
+                        fci_gather_signed(maxSSb, vo_beta.sign.data(), vo_beta.I.data(),
+                                          Ch[v][Ia], C1h[Ia] + v * maxSSb);
+                    }
+                }
+                for (size_t Ja = 0; Ja < maxJa; ++Ja) {
+                    std::fill_n(Y1h[Ja], ncol, T(0));
+                }
 
-                        // Grab list (r,s,Ib_sym)
-                        std::vector<StringSubstitution>& vo_beta =
-                            lists_->get_beta_vo_list(r_abs, s_abs, Ib_sym);
-                        size_t maxSSb = vo_beta.size();
-
-                        C1->zero();
-                        Y1->zero();
-
-                        // Gather cols of C into C1
-                        for (size_t Ia = 0; Ia < maxIa; ++Ia) {
-                            if (maxSSb > 0) {
-                                double* c1 = &(C1->pointer()[Ia][0]); //&C1[Ia][0];
-                                double* c = &(C[Ia][0]);
-                                for (size_t SSb = 0; SSb < maxSSb; ++SSb) {
-                                    c1[SSb] =
-                                        c[vo_beta[SSb].I] * static_cast<double>(vo_beta[SSb].sign);
+                // Loop over all p,q
+                int pq_sym = rs_sym;
+                for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
+                    int q_sym = pq_sym ^ p_sym;
+                    for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
+                        int p_abs = p_rel + cmopi_offset_[p_sym];
+                        for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
+                            int q_abs = q_rel + cmopi_offset_[q_sym];
+                            // Grab the integral
+                            double integral = fci_ints->tei_ab(p_abs, r_abs, q_abs, s_abs);
+
+                            const std::vector<StringSubstitution>& vo_alfa =
+                                lists_->get_alfa_vo_list(p_abs, q_abs, Ia_sym);
+
+                            // ORIGINAL CODE
+                            size_t maxSSa = vo_alfa.size();
+                            for (size_t SSa = 0; SSa < maxSSa; ++SSa) {
+                                T V = static_cast<T>(integral *
+                                                     static_cast<double>(vo_alfa[SSa].sign));
+                                if constexpr (std::is_same_v<T, float>) {
+                                    fci_axpy(ncol, V, C1h[vo_alfa[SSa].I], Y1h[vo_alfa[SSa].J]);
+                                } else {
+#if CAPRICCIO_USE_DAXPY
+                                    C_DAXPY(ncol, V, &(C1h[vo_alfa[SSa].I][0]), 1,
+                                            &(Y1h[vo_alfa[SSa].J][0]), 1);
+#else
+                                    for (size_t SSb = 0; SSb < ncol; ++SSb) {
+                                        Y1h[vo_alfa[SSa].J][SSb] += C1h[vo_alfa[SSa].I][SSb] * V;
+                                    }
+#endif
                                 }
                             }
                         }
+                    }
+                } // End loop over p,q
+                // Scatter cols of Y1 into Y
+                bool serial = (omp_get_num_threads() == 1);
+                for (size_t Ja = 0; Ja < maxJa; ++Ja) {
+                    for (size_t v = 0; v < nvec; ++v) {
+                        if (serial) {
+                            fci_scatter_add(maxSSb, vo_beta.J.data(), Y1h[Ja] + v * maxSSb,
+                                            Yh[v][Ja]);
+                        } else {
+                            fci_scatter_add_atomic(maxSSb, vo_beta.J.data(),
+                                                   Y1h[Ja] + v * maxSSb, Yh[v][Ja]);
+                        }
+                    }
+                }
+            };
+
+#pragma omp parallel for schedule(dynamic)
+            for (int n = 0; n < max_rs; ++n) {
+                int tid = omp_get_thread_num();
+                if (sigma_precision_ == FCISigmaPrecision::Mixed) {
+                    rs_term(rs_list[n].first, rs_list[n].second, ws.C1f(tid), ws.Y1f(tid));
+                } else {
+                    rs_term(rs_list[n].first, rs_list[n].second, ws.C1(tid), ws.Y1(tid));
+                }
+            } // End loop over r_abs,s_abs
+        }
+    }
+}
 
-                        // Loop over all p,q
-                        int pq_sym = rs_sym;
-                        for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
-                            int q_sym = pq_sym ^ p_sym;
-                            for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
-                                int p_abs = p_rel + cmopi_offset_[p_sym];
-                                for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
-                                    int q_abs = q_rel + cmopi_offset_[q_sym];
-                                    // Grab the integral
-                                    double integral = fci_ints->tei_ab(p_abs, r_abs, q_abs, s_abs);
+/**
+ * Apply the different-spin component of two-particle Hamiltonian to the wave
+ * function using matrix multiplications (see J. Olsen et al., J. Chem. Phys. 89, 2185 (1988)
+ * and P. J. Knowles and N. C. Handy, Chem. Phys. Lett. 111, 315 (1984))
+ *
+ * For each block of alpha strings Ia and each symmetry of the pair rs we form:
+ * 1. D[rs][n][Ia][Jb] = sum_Ib <Jb|E^b_rs|Ib> C_n[Ia][Ib]               (gather)
+ * 2. E[pq][n][Ia][Jb] = sum_rs (pq|rs) D[rs][n][Ia][Jb]                 (DGEMM)
+ * 3. sigma_n[Ja][Jb] += sum_pq sum_Ia <Ja|E^a_pq|Ia> E[pq][n][Ia][Jb]   (scatter)
+ * where n runs over the vectors of the block.
+ *
+ * The alpha strings are processed in batches so that D and E use at most
+ * sigma_max_memory_ doubles.
+ */
+void FCIVector::H2_aabb_dgemm(const std::vector<FCIVector*>& C, const std::vector<FCIVector*>& HC,
+                              std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
+    size_t nvec = C.size();
+    for (int rs_sym = 0; rs_sym < nirrep_; ++rs_sym) {
+        int pq_sym = rs_sym;
+
+        // Collect the (p,q) pairs with symmetry pq_sym. The same list is used for (r,s)
+        std::vector<std::pair<int, int>> pq_list;
+        for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
+            int q_sym = pq_sym ^ p_sym;
+            for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
+                for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
+                    pq_list.push_back(std::make_pair(p_rel + cmopi_offset_[p_sym],
+                                                     q_rel + cmopi_offset_[q_sym]));
+                }
+            }
+        }
+        size_t npq = pq_list.size();
+        if (npq == 0)
+            continue;
+
+        // Build the integral matrix V[pq][rs] = (pq|rs)
+        std::vector<double> V(npq * npq);
+        for (size_t pq = 0; pq < npq; ++pq) {
+            int p = pq_list[pq].first;
+            int q = pq_list[pq].second;
+            for (size_t rs = 0; rs < npq; ++rs) {
+                int r = pq_list[rs].first;
+                int s = pq_list[rs].second;
+                V[pq * npq + rs] = fci_ints->tei_ab(p, r, q, s);
+            }
+        }
 
-                                    std::vector<StringSubstitution>& vo_alfa =
-                                        lists_->get_alfa_vo_list(p_abs, q_abs, Ia_sym);
+        for (int Ia_sym = 0; Ia_sym < nirrep_; ++Ia_sym) {
+            int Ib_sym = Ia_sym ^ symmetry_;
+            int Jb_sym = Ib_sym ^ rs_sym;
+            int Ja_sym = Jb_sym ^ symmetry_;
+            size_t maxIa = alfa_graph_->strpi(Ia_sym);
+            size_t maxJb = beta_graph_->strpi(Jb_sym);
+            if ((maxIa == 0) or (maxJb == 0) or (detpi_[Ia_sym] == 0))
+                continue;
+
+            std::vector<double**> Ch(nvec), Yh(nvec);
+            for (size_t v = 0; v < nvec; ++v) {
+                Ch[v] = C[v]->C_[Ia_sym]->pointer();
+                Yh[v] = HC[v]->C_[Ja_sym]->pointer();
+            }
 
-                                    // ORIGINAL CODE
-                                    size_t maxSSa = vo_alfa.size();
-                                    for (size_t SSa = 0; SSa < maxSSa; ++SSa) {
-#if CAPRICCIO_USE_DAXPY
-                                        C_DAXPY(maxSSb,
-                                                integral * static_cast<double>(vo_alfa[SSa].sign),
-                                                &(C1->pointer()[vo_alfa[SSa].I][0]), 1,
-                                                &(Y1->pointer()[vo_alfa[SSa].J][0]), 1);
-#else
-                                        double V =
-                                            integral * static_cast<double>(vo_alfa[SSa].sign);
-                                        for (size_t SSb = 0; SSb < maxSSb; ++SSb) {
-                                            Y1[vo_alfa[SSa].J][SSb] += C1[vo_alfa[SSa].I][SSb] * V;
-                                        }
-#endif
-                                    }
-                                }
+            // Find the number of alpha strings that fit in memory
+            size_t batch_size = sigma_max_memory_ / (2 * npq * maxJb * nvec);
+            batch_size = std::max(size_t(1), std::min(batch_size, maxIa));
+
+            std::vector<double> D(npq * nvec * batch_size * maxJb);
+            std::vector<double> E(npq * nvec * batch_size * maxJb);
+
+            for (size_t Ia_begin = 0; Ia_begin < maxIa; Ia_begin += batch_size) {
+                size_t Ia_end = std::min(Ia_begin + batch_size, maxIa);
+                size_t nIa = Ia_end - Ia_begin;
+                size_t ncol = nvec * nIa * maxJb;
+
+                // 1. Gather C into D
+#pragma omp parallel for schedule(dynamic)
+                for (size_t rs = 0; rs < npq; ++rs) {
+                    double* Drs = &D[rs * ncol];
+                    std::fill_n(Drs, ncol, 0.0);
+                    const StringSubstitutionSoA& vo_beta =
+                        lists_->get_beta_vo_soa(pq_list[rs].first, pq_list[rs].second, Ib_sym);
+                    size_t maxSSb = vo_beta.size();
+                    for (size_t v = 0; v < nvec; ++v) {
+                        for (size_t Ia = Ia_begin; Ia < Ia_end; ++Ia) {
+                            double* d = Drs + (v * nIa + Ia - Ia_begin) * maxJb;
+                            const double* c = Ch[v][Ia];
+                            for (size_t SSb = 0; SSb < maxSSb; ++SSb) {
+                                d[vo_beta.J[SSb]] += vo_beta.sign[SSb] * c[vo_beta.I[SSb]];
                             }
-                        } // End loop over p,q
-                        // Scatter cols of Y1 into Y
-                        for (size_t Ja = 0; Ja < maxJa; ++Ja) {
-                            if (maxSSb > 0) {
-                                double* y = &Y[Ja][0];
-                                double* y1 = &(Y1->pointer()[Ja][0]);
-                                for (size_t SSb = 0; SSb < maxSSb; ++SSb) {
-                                    y[vo_beta[SSb].J] += y1[SSb];
+                        }
+                    }
+                }
+
+                // 2. E[pq][n,Ia,Jb] = sum_rs V[pq][rs] D[rs][n,Ia,Jb]
+                C_DGEMM('N', 'N', npq, ncol, npq, 1.0, V.data(), npq, D.data(), ncol, 0.0,
+                        E.data(), ncol);
+
+                // 3. Scatter E into sigma. The columns (Jb) are split among threads.
+#pragma omp parallel
+                {
+                    size_t L0, L1;
+                    std::tie(L0, L1) =
+                        thread_column_range(maxJb, omp_get_thread_num(), omp_get_num_threads());
+                    size_t nL = L1 - L0;
+                    if (nL > 0) {
+                        for (size_t pq = 0; pq < npq; ++pq) {
+                            const StringSubstitutionSoA& vo_alfa = lists_->get_alfa_vo_soa(
+                                pq_list[pq].first, pq_list[pq].second, Ia_sym);
+                            // the lists are sorted by I, so find the range of this batch
+                            auto first = std::lower_bound(vo_alfa.I.begin(), vo_alfa.I.end(),
+                                                          Ia_begin);
+                            auto last = std::lower_bound(first, vo_alfa.I.end(), Ia_end);
+                            size_t SSa_begin = std::distance(vo_alfa.I.begin(), first);
+                            size_t SSa_end = std::distance(vo_alfa.I.begin(), last);
+                            double* Epq = &E[pq * ncol];
+                            for (size_t SSa = SSa_begin; SSa < SSa_end; ++SSa) {
+                                size_t Ia = vo_alfa.I[SSa];
+                                size_t Ja = vo_alfa.J[SSa];
+                                for (size_t v = 0; v < nvec; ++v) {
+                                    C_DAXPY(nL, vo_alfa.sign[SSa],
+                                            Epq + (v * nIa + Ia - Ia_begin) * maxJb + L0, 1,
+                                            &(Yh[v][Ja][L0]), 1);
                                 }
                             }
                         }
                     }
-                } // End loop over r_rel,s_rel
+                }
             }
         }
     }
@@ -33,13 +33,17 @@
 #include "psi4/libmints/molecule.h"
 #include "psi4/libmints/matrix.h"
 #include "psi4/libqt/qt.h"
+#include "psi4/libpsi4util/exception.h"
 
 #include "base_classes/mo_space_info.h"
 #include "integrals/active_space_integrals.h"
 #include "helpers/timer.h"
 #include "sparse_ci/determinant.h"
+#include "forte-def.h"
 
+#include "fci_kernels.h"
 #include "fci_vector.h"
+#include "fci_workspace.h"
 #include "fci_solver.h"
 #include "binary_graph.hpp"
 #include "string_lists.h"
@@ -96,6 +100,9 @@ void FCIVector::compute_rdms(int max_order) {
     if (max_order >= 4) {
     }
 
+    // The hole lists are only needed by the 3-RDMs. Free them if they are over budget
+    lists_->release_hole_lists(true);
+
     // Print RDM timings
     if (print_ > 0) {
         for (size_t n = 0; n < rdm_timing.size(); ++n) {
@@ -156,47 +163,53 @@ double FCIVector::energy_from_rdms(std::shared_ptr<ActiveSpaceIntegrals> fci_int
 void FCIVector::compute_1rdm(std::vector<double>& rdm, bool alfa) {
     rdm.assign(ncmo_ * ncmo_, 0.0);
 
+    // The totally symmetric pairs (p,q). Each thread computes a different set of elements
+    std::vector<std::pair<int, int>> pq_list;
+    for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
+        int q_sym = p_sym; // Select the totat symmetric irrep
+        for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
+            for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
+                pq_list.push_back(
+                    std::make_pair(p_rel + cmopi_offset_[p_sym], q_rel + cmopi_offset_[q_sym]));
+            }
+        }
+    }
+    int max_pq = pq_list.size();
+
     for (int alfa_sym = 0; alfa_sym < nirrep_; ++alfa_sym) {
         int beta_sym = alfa_sym ^ symmetry_;
         if (detpi_[alfa_sym] > 0) {
-            psi::SharedMatrix C = alfa ? C_[alfa_sym] : C1;
-            double** Ch = C->pointer();
+            double** Ch = alfa ? C_[alfa_sym]->pointer() : workspace().C1(0);
 
             if (!alfa) {
-                C->zero();
                 size_t maxIa = alfa_graph_->strpi(alfa_sym);
                 size_t maxIb = beta_graph_->strpi(beta_sym);
 
                 double** C0h = C_[alfa_sym]->pointer();
 
                 // Copy C0 transposed in C1
-                for (size_t Ia = 0; Ia < maxIa; ++Ia)
-                    for (size_t Ib = 0; Ib < maxIb; ++Ib)
+#pragma omp parallel for
+                for (size_t Ib = 0; Ib < maxIb; ++Ib)
+                    for (size_t Ia = 0; Ia < maxIa; ++Ia)
                         Ch[Ib][Ia] = C0h[Ia][Ib];
             }
 
             size_t maxL = alfa ? beta_graph_->strpi(beta_sym) : alfa_graph_->strpi(alfa_sym);
 
-            for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
-                int q_sym = p_sym; // Select the totat symmetric irrep
-                for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
-                    for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
-                        int p_abs = p_rel + cmopi_offset_[p_sym];
-                        int q_abs = q_rel + cmopi_offset_[q_sym];
-                        std::vector<StringSubstitution>& vo =
-                            alfa ? lists_->get_alfa_vo_list(p_abs, q_abs, alfa_sym)
-                                 : lists_->get_beta_vo_list(p_abs, q_abs, beta_sym);
-                        int maxss = vo.size();
-                        for (int ss = 0; ss < maxss; ++ss) {
-                            double H = static_cast<double>(vo[ss].sign);
-                            double* y = &(Ch[vo[ss].J][0]);
-                            double* c = &(Ch[vo[ss].I][0]);
-                            for (size_t L = 0; L < maxL; ++L) {
-                                rdm[p_abs * ncmo_ + q_abs] += c[L] * y[L] * H;
-                            }
-                        }
-                    }
+#pragma omp parallel for schedule(dynamic)
+            for (int pq = 0; pq < max_pq; ++pq) {
+                int p_abs = pq_list[pq].first;
+                int q_abs = pq_list[pq].second;
+                std::vector<StringSubstitution>& vo =
+                    alfa ? lists_->get_alfa_vo_list(p_abs, q_abs, alfa_sym)
+                         : lists_->get_beta_vo_list(p_abs, q_abs, beta_sym);
+                double rdm_element = 0.0;
+                int maxss = vo.size();
+                for (int ss = 0; ss < maxss; ++ss) {
+                    rdm_element += static_cast<double>(vo[ss].sign) *
+                                   C_DDOT(maxL, &(Ch[vo[ss].I][0]), 1, &(Ch[vo[ss].J][0]), 1);
                 }
+                rdm[p_abs * ncmo_ + q_abs] += rdm_element;
             }
         }
     } // End loop over h
@@ -224,27 +237,29 @@ void FCIVector::compute_2rdm_aa(std::vector<double>& rdm, bool alfa) {
     for (int ha = 0; ha < nirrep_; ++ha) {
         int hb = ha ^ symmetry_;
         if (detpi_[ha] > 0) {
-            psi::SharedMatrix C = alfa ? C_[ha] : C1;
-            double** Ch = C->pointer();
+            double** Ch = alfa ? C_[ha]->pointer() : workspace().C1(0);
 
             if (!alfa) {
-                C->zero();
                 size_t maxIa = alfa_graph_->strpi(ha);
                 size_t maxIb = beta_graph_->strpi(hb);
 
                 double** C0h = C_[ha]->pointer();
 
                 // Copy C0 transposed in C1
-                for (size_t Ia = 0; Ia < maxIa; ++Ia)
-                    for (size_t Ib = 0; Ib < maxIb; ++Ib)
+#pragma omp parallel for
+                for (size_t Ib = 0; Ib < maxIb; ++Ib)
+                    for (size_t Ia = 0; Ia < maxIa; ++Ia)
                         Ch[Ib][Ia] = C0h[Ia][Ib];
             }
 
             size_t maxL = alfa ? beta_graph_->strpi(hb) : alfa_graph_->strpi(ha);
+            // The pairs (p>q) are distributed among threads. Each pair (p>q) >= (r>s) updates a
+            // distinct set of elements, so no reduction is needed
             // Loop over (p>q) == (p>q)
             for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
-                size_t max_pq = lists_->pairpi(pq_sym);
-                for (size_t pq = 0; pq < max_pq; ++pq) {
+                int max_pq = lists_->pairpi(pq_sym);
+#pragma omp parallel for schedule(dynamic)
+                for (int pq = 0; pq < max_pq; ++pq) {
                     const Pair& pq_pair = lists_->get_nn_list_pair(pq_sym, pq);
                     int p_abs = pq_pair.first;
                     int q_abs = pq_pair.second;
@@ -255,12 +270,8 @@ void FCIVector::compute_2rdm_aa(std::vector<double>& rdm, bool alfa) {
                     double rdm_element = 0.0;
                     size_t maxss = OO.size();
                     for (size_t ss = 0; ss < maxss; ++ss) {
-                        double H = static_cast<double>(OO[ss].sign);
-                        double* y = &(Ch[OO[ss].J][0]);
-                        double* c = &(Ch[OO[ss].I][0]);
-                        for (size_t L = 0; L < maxL; ++L) {
-                            rdm_element += c[L] * y[L] * H;
-                        }
+                        rdm_element += static_cast<double>(OO[ss].sign) *
+                                       C_DDOT(maxL, &(Ch[OO[ss].I][0]), 1, &(Ch[OO[ss].J][0]), 1);
                     }
 
                     rdm[tei_index(p_abs, q_abs, p_abs, q_abs)] += rdm_element;
@@ -271,12 +282,13 @@ void FCIVector::compute_2rdm_aa(std::vector<double>& rdm, bool alfa) {
             }
             // Loop over (p>q) > (r>s)
             for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
-                size_t max_pq = lists_->pairpi(pq_sym);
-                for (size_t pq = 0; pq < max_pq; ++pq) {
+                int max_pq = lists_->pairpi(pq_sym);
+#pragma omp parallel for schedule(dynamic)
+                for (int pq = 0; pq < max_pq; ++pq) {
                     const Pair& pq_pair = lists_->get_nn_list_pair(pq_sym, pq);
                     int p_abs = pq_pair.first;
                     int q_abs = pq_pair.second;
-                    for (size_t rs = 0; rs < pq; ++rs) {
+                    for (int rs = 0; rs < pq; ++rs) {
                         const Pair& rs_pair = lists_->get_nn_list_pair(pq_sym, rs);
                         int r_abs = rs_pair.first;
                         int s_abs = rs_pair.second;
@@ -289,12 +301,9 @@ void FCIVector::compute_2rdm_aa(std::vector<double>& rdm, bool alfa) {
                         // TODO loop in a differen way
                         size_t maxss = VVOO.size();
                         for (size_t ss = 0; ss < maxss; ++ss) {
-                            double H = static_cast<double>(VVOO[ss].sign);
-                            double* y = &(Ch[VVOO[ss].J][0]);
-                            double* c = &(Ch[VVOO[ss].I][0]);
-                            for (size_t L = 0; L < maxL; ++L) {
-                                rdm_element += c[L] * y[L] * H;
-                            }
+                            rdm_element +=
+                                static_cast<double>(VVOO[ss].sign) *
+                                C_DDOT(maxL, &(Ch[VVOO[ss].I][0]), 1, &(Ch[VVOO[ss].J][0]), 1);
                         }
 
                         rdm[tei_index(p_abs, q_abs, r_abs, s_abs)] += rdm_element;
@@ -344,47 +353,62 @@ void FCIVector::compute_2rdm_ab(std::vector<double>& rdm) {
             int Jb_sym = Ib_sym ^ rs_sym;
             int Ja_sym = Jb_sym ^ symmetry_;
             double** Y = C_[Ja_sym]->pointer();
+
+            // Collect the (r,s) pairs with symmetry rs_sym. Each pair updates a distinct set of
+            // elements, so the pairs can be distributed among threads
+            std::vector<std::pair<int, int>> rs_list;
             for (int r_sym = 0; r_sym < nirrep_; ++r_sym) {
                 int s_sym = rs_sym ^ r_sym;
-
                 for (int r_rel = 0; r_rel < cmopi_[r_sym]; ++r_rel) {
                     for (int s_rel = 0; s_rel < cmopi_[s_sym]; ++s_rel) {
-                        int r_abs = r_rel + cmopi_offset_[r_sym];
-                        int s_abs = s_rel + cmopi_offset_[s_sym];
-
-                        // Grab list (r,s,Ib_sym)
-                        std::vector<StringSubstitution>& vo_beta =
-                            lists_->get_beta_vo_list(r_abs, s_abs, Ib_sym);
-                        size_t maxSSb = vo_beta.size();
-
-                        // Loop over all p,q
-                        int pq_sym = rs_sym;
-                        for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
-                            int q_sym = pq_sym ^ p_sym;
-                            for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
-                                int p_abs = p_rel + cmopi_offset_[p_sym];
-                                for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
-                                    int q_abs = q_rel + cmopi_offset_[q_sym];
-
-                                    std::vector<StringSubstitution>& vo_alfa =
-                                        lists_->get_alfa_vo_list(p_abs, q_abs, Ia_sym);
-
-                                    size_t maxSSa = vo_alfa.size();
-                                    for (size_t SSa = 0; SSa < maxSSa; ++SSa) {
-                                        for (size_t SSb = 0; SSb < maxSSb; ++SSb) {
-                                            double V = static_cast<double>(vo_alfa[SSa].sign *
-                                                                           vo_beta[SSb].sign);
-                                            rdm[tei_index(p_abs, r_abs, q_abs, s_abs)] +=
-                                                Y[vo_alfa[SSa].J][vo_beta[SSb].J] *
-                                                C[vo_alfa[SSa].I][vo_beta[SSb].I] * V;
-                                        }
-                                    }
+                        rs_list.push_back(std::make_pair(r_rel + cmopi_offset_[r_sym],
+                                                         s_rel + cmopi_offset_[s_sym]));
+                    }
+                }
+            }
+            int max_rs = rs_list.size();
+
+#pragma omp parallel for schedule(dynamic)
+            for (int rs = 0; rs < max_rs; ++rs) {
+                int r_abs = rs_list[rs].first;
+                int s_abs = rs_list[rs].second;
+
+                // Grab list (r,s,Ib_sym)
+                std::vector<StringSubstitution>& vo_beta =
+                    lists_->get_beta_vo_list(r_abs, s_abs, Ib_sym);
+                size_t maxSSb = vo_beta.size();
+                if (maxSSb == 0)
+                    continue;
+
+                // Loop over all p,q
+                int pq_sym = rs_sym;
+                for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
+                    int q_sym = pq_sym ^ p_sym;
+                    for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
+                        int p_abs = p_rel + cmopi_offset_[p_sym];
+                        for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
+                            int q_abs = q_rel + cmopi_offset_[q_sym];
+
+                            std::vector<StringSubstitution>& vo_alfa =
+                                lists_->get_alfa_vo_list(p_abs, q_abs, Ia_sym);
+
+                            double rdm_element = 0.0;
+                            size_t maxSSa = vo_alfa.size();
+                            for (size_t SSa = 0; SSa < maxSSa; ++SSa) {
+                                const double* y = Y[vo_alfa[SSa].J];
+                                const double* c = C[vo_alfa[SSa].I];
+                                double sum = 0.0;
+                                for (size_t SSb = 0; SSb < maxSSb; ++SSb) {
+                                    sum += static_cast<double>(vo_beta[SSb].sign) *
+                                           y[vo_beta[SSb].J] * c[vo_beta[SSb].I];
                                 }
+                                rdm_element += static_cast<double>(vo_alfa[SSa].sign) * sum;
                             }
-                        } // End loop over p,q
+                            rdm[tei_index(p_abs, r_abs, q_abs, s_abs)] += rdm_element;
+                        }
                     }
-                } // End loop over r_rel,s_rel
-            }
+                } // End loop over p,q
+            } // End loop over r_abs,s_abs
         }
     }
 #if 0
@@ -404,8 +428,36 @@ void FCIVector::compute_2rdm_ab(std::vector<double>& rdm) {
 #endif
 }
 
+/**
+ * Add the contribution sum_k A[x][k] A[y][k] to a 3-RDM stored as a n^3 x n^3 matrix
+ * @param n3 the number of rows of A (n^3)
+ * @param ncol the number of columns of A
+ * @param A the matrix A stored by rows
+ * @param rdm the 3-RDM
+ */
+static void add_3rdm_contribution(size_t n3, size_t ncol, std::vector<double>& A,
+                                  std::vector<double>& rdm) {
+    if (ncol == 0)
+        return;
+    C_DGEMM('N', 'T', n3, n3, ncol, 1.0, A.data(), ncol, A.data(), ncol, 1.0, rdm.data(), n3);
+}
+
+/**
+ * Compute the aaa/bbb three-particle density matrix for a given wave function
+ * @param alfa flag for alfa or beta component, true = aaa, false = bbb
+ *
+ * The 3-RDM is computed as
+ *   rdm[pqr][stu] = sum_{K,L} A[pqr][KL] A[stu][KL],
+ * where A[pqr][KL] = sum_I <K|a_p a_q a_r|I> C[I][L] is built from the 3-hole lists.
+ * The columns of A are distributed among threads, and the contraction is a DGEMM.
+ * The 3-hole strings K are processed in batches so that A uses at most
+ * sigma_max_memory_ doubles.
+ */
 void FCIVector::compute_3rdm_aaa(std::vector<double>& rdm, bool alfa) {
-    rdm.assign(ncmo_ * ncmo_ * ncmo_ * ncmo_ * ncmo_ * ncmo_, 0.0);
+    size_t n3 = ncmo_ * ncmo_ * ncmo_;
+    rdm.assign(n3 * n3, 0.0);
+    size_t max_col = std::max(size_t(1), sigma_max_memory_ / std::max(size_t(1), n3));
+    std::vector<double> A;
 
     for (int h_K = 0; h_K < nirrep_; ++h_K) {
         size_t maxK =
@@ -413,157 +465,170 @@ void FCIVector::compute_3rdm_aaa(std::vector<double>& rdm, bool alfa) {
         for (int h_I = 0; h_I < nirrep_; ++h_I) {
             int h_Ib = h_I ^ symmetry_;
             int h_J = h_I;
-            psi::SharedMatrix C = alfa ? C_[h_J] : C1;
-            double** Ch = C->pointer();
+            double** Ch = alfa ? C_[h_J]->pointer() : workspace().C1(0);
 
             if (!alfa) {
-                C->zero();
                 size_t maxIa = alfa_graph_->strpi(h_I);
                 size_t maxIb = beta_graph_->strpi(h_Ib);
 
                 double** C0h = C_[h_I]->pointer();
 
                 // Copy C0 transposed in C1
-                for (size_t Ia = 0; Ia < maxIa; ++Ia)
-                    for (size_t Ib = 0; Ib < maxIb; ++Ib)
+#pragma omp parallel for
+                for (size_t Ib = 0; Ib < maxIb; ++Ib)
+                    for (size_t Ia = 0; Ia < maxIa; ++Ia)
                         Ch[Ib][Ia] = C0h[Ia][Ib];
             }
 
             size_t maxL = alfa ? beta_graph_->strpi(h_Ib) : alfa_graph_->strpi(h_I);
-            if (maxL > 0) {
-                for (size_t K = 0; K < maxK; ++K) {
+            if ((maxL == 0) or (maxK == 0))
+                continue;
+
+            size_t batch_size = std::max(size_t(1), std::min(maxK, max_col / maxL));
+            for (size_t K_begin = 0; K_begin < maxK; K_begin += batch_size) {
+                size_t K_end = std::min(K_begin + batch_size, maxK);
+                size_t ncol = (K_end - K_begin) * maxL;
+                A.assign(n3 * ncol, 0.0);
+
+#pragma omp parallel for schedule(dynamic)
+                for (size_t K = K_begin; K < K_end; ++K) {
                     std::vector<H3StringSubstitution>& Klist =
                         alfa ? lists_->get_alfa_3h_list(h_K, K, h_I)
                              : lists_->get_beta_3h_list(h_K, K, h_Ib);
+                    size_t col = (K - K_begin) * maxL;
                     for (const auto& Kel : Klist) {
-                        size_t p = Kel.p;
-                        size_t q = Kel.q;
-                        size_t r = Kel.r;
-                        size_t I = Kel.J;
-                        for (const auto& Lel : Klist) {
-                            size_t s = Lel.p;
-                            size_t t = Lel.q;
-                            size_t u = Lel.r;
-                            short sign = Kel.sign * Lel.sign;
-                            size_t J = Lel.J;
-
-                            double rdm_value = 0.0;
-                            rdm_value = C_DDOT(maxL, &(Ch[J][0]), 1, &(Ch[I][0]), 1);
-
-                            rdm_value *= sign;
-
-                            rdm[six_index(p, q, r, s, t, u)] += rdm_value;
-                        }
+                        size_t pqr = (Kel.p * ncmo_ + Kel.q) * ncmo_ + Kel.r;
+                        C_DAXPY(maxL, static_cast<double>(Kel.sign), &(Ch[Kel.J][0]), 1,
+                                &(A[pqr * ncol + col]), 1);
                     }
                 }
+                add_3rdm_contribution(n3, ncol, A, rdm);
             }
         }
     }
 }
 
+/**
+ * Compute the aab three-particle density matrix for a given wave function
+ *
+ * The 3-RDM is computed as
+ *   rdm[pqr][sta] = sum_{K,L} A[pqr][KL] A[sta][KL],
+ * where A[pqr][KL] = sum_{Ia,Ib} <K|a_q a_p|Ia> <L|a_r|Ib> C[Ia][Ib] is built from
+ * the 2-hole (alpha) and 1-hole (beta) lists.
+ * The columns of A are distributed among threads, and the contraction is a DGEMM.
+ */
 void FCIVector::compute_3rdm_aab(std::vector<double>& rdm) {
-    rdm.assign(ncmo_ * ncmo_ * ncmo_ * ncmo_ * ncmo_ * ncmo_, 0.0);
+    size_t n3 = ncmo_ * ncmo_ * ncmo_;
+    rdm.assign(n3 * n3, 0.0);
+    size_t max_col = std::max(size_t(1), sigma_max_memory_ / std::max(size_t(1), n3));
+    std::vector<double> A;
 
     for (int h_K = 0; h_K < nirrep_; ++h_K) {
         size_t maxK = lists_->alfa_graph_2h()->strpi(h_K);
         for (int h_L = 0; h_L < nirrep_; ++h_L) {
             size_t maxL = lists_->beta_graph_1h()->strpi(h_L);
-            // I and J refer to the 2h part of the operator
-            for (int h_Ia = 0; h_Ia < nirrep_; ++h_Ia) {
-                int h_Mb = h_Ia ^ symmetry_;
-                double** C_I_p = C_[h_Ia]->pointer();
-                for (int h_Ja = 0; h_Ja < nirrep_; ++h_Ja) {
-                    int h_Nb = h_Ja ^ symmetry_;
-                    double** C_J_p = C_[h_Ja]->pointer();
-                    for (size_t K = 0; K < maxK; ++K) {
+            if ((maxL == 0) or (maxK == 0))
+                continue;
+
+            size_t batch_size = std::max(size_t(1), std::min(maxK, max_col / maxL));
+            for (size_t K_begin = 0; K_begin < maxK; K_begin += batch_size) {
+                size_t K_end = std::min(K_begin + batch_size, maxK);
+                size_t ncol = (K_end - K_begin) * maxL;
+                A.assign(n3 * ncol, 0.0);
+
+#pragma omp parallel for schedule(dynamic)
+                for (size_t K = K_begin; K < K_end; ++K) {
+                    // I refers to the 2h part of the operator
+                    for (int h_Ia = 0; h_Ia < nirrep_; ++h_Ia) {
+                        int h_Mb = h_Ia ^ symmetry_;
+                        double** C_I_p = C_[h_Ia]->pointer();
                         std::vector<H2StringSubstitution>& Ilist =
                             lists_->get_alfa_2h_list(h_K, K, h_Ia);
-                        std::vector<H2StringSubstitution>& Jlist =
-                            lists_->get_alfa_2h_list(h_K, K, h_Ja);
+                        if (Ilist.empty())
+                            continue;
                         for (size_t L = 0; L < maxL; ++L) {
                             std::vector<H1StringSubstitution>& Mlist =
                                 lists_->get_beta_1h_list(h_L, L, h_Mb);
-                            std::vector<H1StringSubstitution>& Nlist =
-                                lists_->get_beta_1h_list(h_L, L, h_Nb);
+                            size_t col = (K - K_begin) * maxL + L;
                             for (const auto& Iel : Ilist) {
                                 size_t q = Iel.p;
                                 size_t p = Iel.q;
                                 size_t I = Iel.J;
-                                for (const auto& Jel : Jlist) {
-                                    size_t t = Jel.p;
-                                    size_t s = Jel.q;
-                                    size_t J = Jel.J;
-                                    for (const auto& Mel : Mlist) {
-                                        size_t r = Mel.p;
-                                        size_t M = Mel.J;
-                                        for (const auto& Nel : Nlist) {
-                                            size_t a = Nel.p;
-                                            size_t N = Nel.J;
-                                            short sign = Iel.sign * Jel.sign * Mel.sign * Nel.sign;
-                                            rdm[six_index(p, q, r, s, t, a)] +=
-                                                sign * C_I_p[I][M] * C_J_p[J][N];
-                                        }
-                                    }
+                                for (const auto& Mel : Mlist) {
+                                    size_t r = Mel.p;
+                                    size_t M = Mel.J;
+                                    size_t pqr = (p * ncmo_ + q) * ncmo_ + r;
+                                    double sign = static_cast<double>(Iel.sign * Mel.sign);
+                                    A[pqr * ncol + col] += sign * C_I_p[I][M];
                                 }
                             }
                         }
                     }
                 }
+                add_3rdm_contribution(n3, ncol, A, rdm);
             }
         }
     }
 }
 
+/**
+ * Compute the abb three-particle density matrix for a given wave function
+ *
+ * The 3-RDM is computed as
+ *   rdm[pqr][sta] = sum_{K,L} A[pqr][KL] A[sta][KL],
+ * where A[pqr][KL] = sum_{Ia,Ib} <K|a_p|Ia> <L|a_r a_q|Ib> C[Ia][Ib] is built from
+ * the 1-hole (alpha) and 2-hole (beta) lists.
+ * The columns of A are distributed among threads, and the contraction is a DGEMM.
+ */
 void FCIVector::compute_3rdm_abb(std::vector<double>& rdm) {
-    rdm.assign(ncmo_ * ncmo_ * ncmo_ * ncmo_ * ncmo_ * ncmo_, 0.0);
+    size_t n3 = ncmo_ * ncmo_ * ncmo_;
+    rdm.assign(n3 * n3, 0.0);
+    size_t max_col = std::max(size_t(1), sigma_max_memory_ / std::max(size_t(1), n3));
+    std::vector<double> A;
 
     for (int h_K = 0; h_K < nirrep_; ++h_K) {
         size_t maxK = lists_->alfa_graph_1h()->strpi(h_K);
         for (int h_L = 0; h_L < nirrep_; ++h_L) {
             size_t maxL = lists_->beta_graph_2h()->strpi(h_L);
-            // I and J refer to the 1h part of the operator
-            for (int h_Ia = 0; h_Ia < nirrep_; ++h_Ia) {
-                int h_Mb = h_Ia ^ symmetry_;
-                double** C_I_p = C_[h_Ia]->pointer();
-                for (int h_Ja = 0; h_Ja < nirrep_; ++h_Ja) {
-                    int h_Nb = h_Ja ^ symmetry_;
-                    double** C_J_p = C_[h_Ja]->pointer();
-                    for (size_t K = 0; K < maxK; ++K) {
+            if ((maxL == 0) or (maxK == 0))
+                continue;
+
+            size_t batch_size = std::max(size_t(1), std::min(maxK, max_col / maxL));
+            for (size_t K_begin = 0; K_begin < maxK; K_begin += batch_size) {
+                size_t K_end = std::min(K_begin + batch_size, maxK);
+                size_t ncol = (K_end - K_begin) * maxL;
+                A.assign(n3 * ncol, 0.0);
+
+#pragma omp parallel for schedule(dynamic)
+                for (size_t K = K_begin; K < K_end; ++K) {
+                    // I refers to the 1h part of the operator
+                    for (int h_Ia = 0; h_Ia < nirrep_; ++h_Ia) {
+                        int h_Mb = h_Ia ^ symmetry_;
+                        double** C_I_p = C_[h_Ia]->pointer();
                         std::vector<H1StringSubstitution>& Ilist =
                             lists_->get_alfa_1h_list(h_K, K, h_Ia);
-                        std::vector<H1StringSubstitution>& Jlist =
-                            lists_->get_alfa_1h_list(h_K, K, h_Ja);
+                        if (Ilist.empty())
+                            continue;
                         for (size_t L = 0; L < maxL; ++L) {
                             std::vector<H2StringSubstitution>& Mlist =
                                 lists_->get_beta_2h_list(h_L, L, h_Mb);
-                            std::vector<H2StringSubstitution>& Nlist =
-                                lists_->get_beta_2h_list(h_L, L, h_Nb);
-                            for (size_t Iel = 0; Iel < Ilist.size(); Iel++) {
-                                size_t p = Ilist[Iel].p;
-                                size_t I = Ilist[Iel].J;
+                            size_t col = (K - K_begin) * maxL + L;
+                            for (const auto& Iel : Ilist) {
+                                size_t p = Iel.p;
+                                size_t I = Iel.J;
                                 for (const auto& Mel : Mlist) {
                                     size_t q = Mel.p;
                                     size_t r = Mel.q;
                                     size_t M = Mel.J;
-                                    for (const auto& Jel : Jlist) {
-                                        size_t s = Jel.p;
-                                        size_t J = Jel.J;
-                                        for (const auto& Nel : Nlist) {
-                                            size_t t = Nel.p;
-                                            size_t a = Nel.q;
-                                            size_t N = Nel.J;
-                                            short sign =
-                                                Ilist[Iel].sign * Jel.sign * Mel.sign * Nel.sign;
-                                            rdm[six_index(p, q, r, s, t, a)] +=
-                                                sign * C_I_p[I][M] * C_J_p[J][N];
-                                            //}//End of if statement
-                                        }
-                                    }
+                                    size_t pqr = (p * ncmo_ + q) * ncmo_ + r;
+                                    double sign = static_cast<double>(Iel.sign * Mel.sign);
+                                    A[pqr * ncol + col] += sign * C_I_p[I][M];
                                 }
                             }
                         }
                     }
                 }
+                add_3rdm_contribution(n3, ncol, A, rdm);
             }
         }
     }
@@ -970,4 +1035,404 @@ double FCIVector::compute_spin2() {
     return -spin2 + 0.25 * std::pow(na - nb, 2.0) + 0.5 * (na + nb);
 }
 
+/**
+ * Add the elements of a nB x nK matrix of transition density matrix elements M[a][b] to the
+ * element index of the transition RDMs of the pairs (a,b)
+ */
+static void add_to_transition_rdms(const std::vector<double>& M,
+                                   const std::vector<std::vector<double>*>& rdms, size_t index,
+                                   double factor) {
+    for (size_t n = 0, maxn = rdms.size(); n < maxn; ++n) {
+        if (rdms[n] != nullptr)
+            (*rdms[n])[index] += factor * M[n];
+    }
+}
+
+std::vector<FCITransitionRDMs>
+FCIVector::compute_transition_rdms(const std::vector<std::shared_ptr<FCIVector>>& bras,
+                                   const std::vector<std::shared_ptr<FCIVector>>& kets,
+                                   const std::vector<std::pair<size_t, size_t>>& pairs,
+                                   int max_order) {
+    if (bras.empty() or kets.empty()) {
+        throw psi::PSIEXCEPTION("FCIVector::compute_transition_rdms: no bra or ket vectors.");
+    }
+    std::vector<FCIVector*> B, K;
+    for (const auto& bra : bras)
+        B.push_back(bra.get());
+    for (const auto& ket : kets)
+        K.push_back(ket.get());
+    FCIVector* K0 = K[0];
+    for (const auto* v : B) {
+        if ((v->symmetry_ != B[0]->symmetry_) or (v->cmopi_ != K0->cmopi_) or
+            (v->alfa_graph_->nones() != B[0]->alfa_graph_->nones()) or
+            (v->beta_graph_->nones() != B[0]->beta_graph_->nones())) {
+            throw psi::PSIEXCEPTION(
+                "FCIVector::compute_transition_rdms: the bra vectors are not compatible.");
+        }
+    }
+    for (const auto* v : K) {
+        if ((v->symmetry_ != K0->symmetry_) or (v->lists_ != K0->lists_)) {
+            throw psi::PSIEXCEPTION(
+                "FCIVector::compute_transition_rdms: the ket vectors are not compatible.");
+        }
+    }
+
+    size_t nB = B.size();
+    size_t nK = K.size();
+    size_t ncmo2 = K0->ncmo_ * K0->ncmo_;
+    size_t na = K0->alfa_graph_->nones();
+    size_t nb = K0->beta_graph_->nones();
+
+    std::vector<FCITransitionRDMs> results(pairs.size());
+    std::vector<bool> requested(nB * nK, false);
+    for (size_t n = 0; n < pairs.size(); ++n) {
+        if ((pairs[n].first >= nB) or (pairs[n].second >= nK) or
+            requested[pairs[n].first * nK + pairs[n].second]) {
+            throw psi::PSIEXCEPTION(
+                "FCIVector::compute_transition_rdms: invalid or repeated (bra, ket) pair.");
+        }
+        requested[pairs[n].first * nK + pairs[n].second] = true;
+        if (max_order >= 1) {
+            results[n].opdm_a.assign(ncmo2, 0.0);
+            results[n].opdm_b.assign(ncmo2, 0.0);
+        }
+        if (max_order >= 2) {
+            results[n].tpdm_aa.assign(ncmo2 * ncmo2, 0.0);
+            results[n].tpdm_ab.assign(ncmo2 * ncmo2, 0.0);
+            results[n].tpdm_bb.assign(ncmo2 * ncmo2, 0.0);
+        }
+    }
+
+    // The operators conserve the number of alpha and beta electrons, so if the bras and the kets
+    // have a different number of electrons all the elements are zero
+    if ((B[0]->alfa_graph_->nones() != na) or (B[0]->beta_graph_->nones() != nb))
+        return results;
+
+    if ((max_order >= 2) and (B[0]->symmetry_ != K0->symmetry_)) {
+        throw psi::PSIEXCEPTION("FCIVector::compute_transition_rdms: the 2-body transition RDMs "
+                                "between states of different symmetry are not available.");
+    }
+
+    // Pointers to the elements of each (bra, ket) pair
+    auto targets = [&](std::vector<double> FCITransitionRDMs::*rdm) {
+        std::vector<std::vector<double>*> t(nB * nK, nullptr);
+        for (size_t n = 0; n < pairs.size(); ++n)
+            t[pairs[n].first * nK + pairs[n].second] = &(results[n].*rdm);
+        return t;
+    };
+
+    std::vector<double> rdm_timing;
+
+    if (max_order >= 1) {
+        local_timer t;
+        if (na >= 1)
+            K0->compute_transition_1rdm(B, K, targets(&FCITransitionRDMs::opdm_a), true);
+        if (nb >= 1)
+            K0->compute_transition_1rdm(B, K, targets(&FCITransitionRDMs::opdm_b), false);
+        rdm_timing.push_back(t.get());
+    }
+
+    if (max_order >= 2) {
+        local_timer t;
+        if (na >= 2)
+            K0->compute_transition_2rdm_aa(B, K, targets(&FCITransitionRDMs::tpdm_aa), true);
+        if (nb >= 2)
+            K0->compute_transition_2rdm_aa(B, K, targets(&FCITransitionRDMs::tpdm_bb), false);
+        if ((na >= 1) and (nb >= 1))
+            K0->compute_transition_2rdm_ab(B, K, targets(&FCITransitionRDMs::tpdm_ab));
+        rdm_timing.push_back(t.get());
+    }
+
+    if (K0->print_ > 0) {
+        for (size_t n = 0; n < rdm_timing.size(); ++n) {
+            outfile->Printf("\n    Timing for %d-TRDM (%zu pairs): %.3f s", n + 1, pairs.size(),
+                            rdm_timing[n]);
+        }
+    }
+    return results;
+}
+
+/**
+ * Compute the transition one-particle density matrices <B|a^+_p a_q|K>
+ * @param alfa flag for alfa or beta component, true = alfa, false = beta
+ */
+void FCIVector::compute_transition_1rdm(const std::vector<FCIVector*>& B,
+                                        const std::vector<FCIVector*>& K,
+                                        const std::vector<std::vector<double>*>& rdms, bool alfa) {
+    size_t nB = B.size();
+    size_t nK = K.size();
+    int bra_sym = B[0]->symmetry_;
+    int op_sym = bra_sym ^ symmetry_;
+    FCIWorkspace& ws = workspace(std::max(nB, nK));
+
+    // The pairs (p,q) with symmetry op_sym. Each thread computes a different set of elements
+    std::vector<std::pair<int, int>> pq_list;
+    for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
+        int q_sym = p_sym ^ op_sym;
+        for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
+            for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
+                pq_list.push_back(
+                    std::make_pair(p_rel + cmopi_offset_[p_sym], q_rel + cmopi_offset_[q_sym]));
+            }
+        }
+    }
+    int max_pq = pq_list.size();
+
+    for (int Ia_sym = 0; Ia_sym < nirrep_; ++Ia_sym) {
+        int Ib_sym = Ia_sym ^ symmetry_;
+        // The operator acts only on the alfa (beta) strings, so the bra block is the one with
+        // the same beta (alfa) strings
+        int Ja_sym = alfa ? Ia_sym ^ op_sym : Ia_sym;
+        int Jb_sym = Ja_sym ^ bra_sym;
+        size_t maxIa = alfa_graph_->strpi(Ia_sym);
+        size_t maxIb = beta_graph_->strpi(Ib_sym);
+        size_t maxJa = alfa_graph_->strpi(Ja_sym);
+        size_t maxJb = beta_graph_->strpi(Jb_sym);
+        if ((maxIa * maxIb == 0) or (maxJa * maxJb == 0))
+            continue;
+
+        // Place the blocks of all the kets (bras) side by side, transposed for the beta case
+        std::vector<double**> Kh, Bh;
+        for (auto* v : K)
+            Kh.push_back(v->C_[Ia_sym]->pointer());
+        for (auto* v : B)
+            Bh.push_back(v->C_[Ja_sym]->pointer());
+        double** Ks = ws.C1(0);
+        double** Bs = ws.Y1(0);
+        fci_stack_blocks(Kh, maxIa, maxIb, !alfa, Ks);
+        fci_stack_blocks(Bh, maxJa, maxJb, !alfa, Bs);
+
+        size_t maxL = alfa ? maxIb : maxIa;
+
+#pragma omp parallel for schedule(dynamic)
+        for (int pq = 0; pq < max_pq; ++pq) {
+            int p_abs = pq_list[pq].first;
+            int q_abs = pq_list[pq].second;
+            std::vector<StringSubstitution>& vo =
+                alfa ? lists_->get_alfa_vo_list(p_abs, q_abs, Ia_sym)
+                     : lists_->get_beta_vo_list(p_abs, q_abs, Ib_sym);
+            size_t maxss = vo.size();
+            if (maxss == 0)
+                continue;
+            // M[a][b] = sum_ss sign B_a[J] . K_b[I]
+            std::vector<double> M(nB * nK, 0.0);
+            for (size_t ss = 0; ss < maxss; ++ss) {
+                C_DGEMM('N', 'T', nB, nK, maxL, static_cast<double>(vo[ss].sign), Bs[vo[ss].J],
+                        maxL, Ks[vo[ss].I], maxL, 1.0, M.data(), nK);
+            }
+            add_to_transition_rdms(M, rdms, oei_index(p_abs, q_abs), 1.0);
+        }
+    }
+}
+
+/**
+ * Compute the aa/bb transition two-particle density matrices <B|a^+_p a^+_q a_s a_r|K>
+ * for bras and kets of the same symmetry
+ * @param alfa flag for alfa or beta component, true = aa, false = bb
+ */
+void FCIVector::compute_transition_2rdm_aa(const std::vector<FCIVector*>& B,
+                                           const std::vector<FCIVector*>& K,
+                                           const std::vector<std::vector<double>*>& rdms,
+                                           bool alfa) {
+    size_t nB = B.size();
+    size_t nK = K.size();
+    FCIWorkspace& ws = workspace(std::max(nB, nK));
+
+    for (int ha = 0; ha < nirrep_; ++ha) {
+        int hb = ha ^ symmetry_;
+        if (detpi_[ha] == 0)
+            continue;
+        size_t maxIa = alfa_graph_->strpi(ha);
+        size_t maxIb = beta_graph_->strpi(hb);
+
+        std::vector<double**> Kh, Bh;
+        for (auto* v : K)
+            Kh.push_back(v->C_[ha]->pointer());
+        for (auto* v : B)
+            Bh.push_back(v->C_[ha]->pointer());
+        double** Ks = ws.C1(0);
+        double** Bs = ws.Y1(0);
+        fci_stack_blocks(Kh, maxIa, maxIb, !alfa, Ks);
+        fci_stack_blocks(Bh, maxIa, maxIb, !alfa, Bs);
+
+        size_t maxL = alfa ? maxIb : maxIa;
+
+        // Loop over (p>q) == (p>q)
+        for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
+            int max_pq = lists_->pairpi(pq_sym);
+#pragma omp parallel for schedule(dynamic)
+            for (int pq = 0; pq < max_pq; ++pq) {
+                const Pair& pq_pair = lists_->get_nn_list_pair(pq_sym, pq);
+                int p_abs = pq_pair.first;
+                int q_abs = pq_pair.second;
+
+                std::vector<StringSubstitution>& OO =
+                    alfa ? lists_->get_alfa_oo_list(pq_sym, pq, ha)
+                         : lists_->get_beta_oo_list(pq_sym, pq, hb);
+                size_t maxss = OO.size();
+                if (maxss == 0)
+                    continue;
+                std::vector<double> M(nB * nK, 0.0);
+                for (size_t ss = 0; ss < maxss; ++ss) {
+                    C_DGEMM('N', 'T', nB, nK, maxL, static_cast<double>(OO[ss].sign),
+                            Bs[OO[ss].J], maxL, Ks[OO[ss].I], maxL, 1.0, M.data(), nK);
+                }
+                add_to_transition_rdms(M, rdms, tei_index(p_abs, q_abs, p_abs, q_abs), 1.0);
+                add_to_transition_rdms(M, rdms, tei_index(p_abs, q_abs, q_abs, p_abs), -1.0);
+                add_to_transition_rdms(M, rdms, tei_index(q_abs, p_abs, p_abs, q_abs), -1.0);
+                add_to_transition_rdms(M, rdms, tei_index(q_abs, p_abs, q_abs, p_abs), 1.0);
+            }
+        }
+        // Loop over (p>q) > (r>s). The list connecting I to J = a^+_p a^+_q a_s a_r I also gives
+        // the elements <B|a^+_r a^+_s a_q a_p|K> from the pairs (B[I], K[J])
+        for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
+            int max_pq = lists_->pairpi(pq_sym);
+#pragma omp parallel for schedule(dynamic)
+            for (int pq = 0; pq < max_pq; ++pq) {
+                const Pair& pq_pair = lists_->get_nn_list_pair(pq_sym, pq);
+                int p_abs = pq_pair.first;
+                int q_abs = pq_pair.second;
+                std::vector<double> M1(nB * nK);
+                std::vector<double> M2(nB * nK);
+                for (int rs = 0; rs < pq; ++rs) {
+                    const Pair& rs_pair = lists_->get_nn_list_pair(pq_sym, rs);
+                    int r_abs = rs_pair.first;
+                    int s_abs = rs_pair.second;
+
+                    std::vector<StringSubstitution>& VVOO =
+                        alfa ? lists_->get_alfa_vvoo_list(p_abs, q_abs, r_abs, s_abs, ha)
+                             : lists_->get_beta_vvoo_list(p_abs, q_abs, r_abs, s_abs, hb);
+                    size_t maxss = VVOO.size();
+                    if (maxss == 0)
+                        continue;
+                    std::fill(M1.begin(), M1.end(), 0.0);
+                    std::fill(M2.begin(), M2.end(), 0.0);
+                    for (size_t ss = 0; ss < maxss; ++ss) {
+                        double sign = static_cast<double>(VVOO[ss].sign);
+                        C_DGEMM('N', 'T', nB, nK, maxL, sign, Bs[VVOO[ss].J], maxL,
+                                Ks[VVOO[ss].I], maxL, 1.0, M1.data(), nK);
+                        C_DGEMM('N', 'T', nB, nK, maxL, sign, Bs[VVOO[ss].I], maxL,
+                                Ks[VVOO[ss].J], maxL, 1.0, M2.data(), nK);
+                    }
+                    add_to_transition_rdms(M1, rdms, tei_index(p_abs, q_abs, r_abs, s_abs), 1.0);
+                    add_to_transition_rdms(M1, rdms, tei_index(q_abs, p_abs, r_abs, s_abs), -1.0);
+                    add_to_transition_rdms(M1, rdms, tei_index(p_abs, q_abs, s_abs, r_abs), -1.0);
+                    add_to_transition_rdms(M1, rdms, tei_index(q_abs, p_abs, s_abs, r_abs), 1.0);
+                    add_to_transition_rdms(M2, rdms, tei_index(r_abs, s_abs, p_abs, q_abs), 1.0);
+                    add_to_transition_rdms(M2, rdms, tei_index(r_abs, s_abs, q_abs, p_abs), -1.0);
+                    add_to_transition_rdms(M2, rdms, tei_index(s_abs, r_abs, p_abs, q_abs), -1.0);
+                    add_to_transition_rdms(M2, rdms, tei_index(s_abs, r_abs, q_abs, p_abs), 1.0);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Compute the ab transition two-particle density matrices <B|a^+_{pa} a^+_{qb} a_{sb} a_{ra}|K>
+ */
+void FCIVector::compute_transition_2rdm_ab(const std::vector<FCIVector*>& B,
+                                           const std::vector<FCIVector*>& K,
+                                           const std::vector<std::vector<double>*>& rdms) {
+    size_t nB = B.size();
+    size_t nK = K.size();
+    int bra_sym = B[0]->symmetry_;
+    FCIWorkspace& ws = workspace(std::max(nB, nK));
+
+    // Loop over the blocks of the kets
+    for (int Ia_sym = 0; Ia_sym < nirrep_; ++Ia_sym) {
+        int Ib_sym = Ia_sym ^ symmetry_;
+        size_t maxIa = alfa_graph_->strpi(Ia_sym);
+        std::vector<double**> Kh;
+        for (auto* v : K)
+            Kh.push_back(v->C_[Ia_sym]->pointer());
+
+        // Loop over all r,s
+        for (int rs_sym = 0; rs_sym < nirrep_; ++rs_sym) {
+            int Jb_sym = Ib_sym ^ rs_sym;
+            int Ja_sym = Jb_sym ^ bra_sym;
+            int pq_sym = Ia_sym ^ Ja_sym;
+            size_t maxJa = alfa_graph_->strpi(Ja_sym);
+            if ((maxIa == 0) or (maxJa == 0))
+                continue;
+            std::vector<double**> Bh;
+            for (auto* v : B)
+                Bh.push_back(v->C_[Ja_sym]->pointer());
+
+            std::vector<std::pair<int, int>> rs_list;
+            for (int r_sym = 0; r_sym < nirrep_; ++r_sym) {
+                int s_sym = rs_sym ^ r_sym;
+                for (int r_rel = 0; r_rel < cmopi_[r_sym]; ++r_rel) {
+                    for (int s_rel = 0; s_rel < cmopi_[s_sym]; ++s_rel) {
+                        rs_list.push_back(std::make_pair(r_rel + cmopi_offset_[r_sym],
+                                                         s_rel + cmopi_offset_[s_sym]));
+                    }
+                }
+            }
+            int max_rs = rs_list.size();
+
+#pragma omp parallel for schedule(dynamic)
+            for (int rs = 0; rs < max_rs; ++rs) {
+                int tid = omp_get_thread_num();
+                int r_abs = rs_list[rs].first;
+                int s_abs = rs_list[rs].second;
+
+                std::vector<StringSubstitution>& vo_beta =
+                    lists_->get_beta_vo_list(r_abs, s_abs, Ib_sym);
+                size_t maxSSb = vo_beta.size();
+                if (maxSSb == 0)
+                    continue;
+
+                // Gather X[Ia][b * maxSSb + SSb] = sign * K_b[Ia][I] and
+                // Y[Ja][a * maxSSb + SSb] = B_a[Ja][J] for the beta strings connected by r,s
+                double** X = ws.C1(tid);
+                double** Y = ws.Y1(tid);
+                for (size_t Ia = 0; Ia < maxIa; ++Ia) {
+                    for (size_t b = 0; b < nK; ++b) {
+                        double* x = X[Ia] + b * maxSSb;
+                        const double* c = Kh[b][Ia];
+                        for (size_t SSb = 0; SSb < maxSSb; ++SSb)
+                            x[SSb] = static_cast<double>(vo_beta[SSb].sign) * c[vo_beta[SSb].I];
+                    }
+                }
+                for (size_t Ja = 0; Ja < maxJa; ++Ja) {
+                    for (size_t a = 0; a < nB; ++a) {
+                        double* y = Y[Ja] + a * maxSSb;
+                        const double* c = Bh[a][Ja];
+                        for (size_t SSb = 0; SSb < maxSSb; ++SSb)
+                            y[SSb] = c[vo_beta[SSb].J];
+                    }
+                }
+
+                // Loop over all p,q
+                std::vector<double> M(nB * nK);
+                for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
+                    int q_sym = pq_sym ^ p_sym;
+                    for (int p_rel = 0; p_rel < cmopi_[p_sym]; ++p_rel) {
+                        int p_abs = p_rel + cmopi_offset_[p_sym];
+                        for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
+                            int q_abs = q_rel + cmopi_offset_[q_sym];
+
+                            std::vector<StringSubstitution>& vo_alfa =
+                                lists_->get_alfa_vo_list(p_abs, q_abs, Ia_sym);
+                            size_t maxSSa = vo_alfa.size();
+                            if (maxSSa == 0)
+                                continue;
+                            std::fill(M.begin(), M.end(), 0.0);
+                            for (size_t SSa = 0; SSa < maxSSa; ++SSa) {
+                                C_DGEMM('N', 'T', nB, nK, maxSSb,
+                                        static_cast<double>(vo_alfa[SSa].sign),
+                                        Y[vo_alfa[SSa].J], maxSSb, X[vo_alfa[SSa].I], maxSSb, 1.0,
+                                        M.data(), nK);
+                            }
+                            add_to_transition_rdms(M, rdms, tei_index(p_abs, r_abs, q_abs, s_abs),
+                                                   1.0);
+                        }
+                    }
+                } // End loop over p,q
+            } // End loop over r_abs,s_abs
+        }
+    }
+}
+
 } // namespace forte
@@ -0,0 +1,109 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <new>
+
+#include "psi4/psi4-dec.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+
+#include "helpers/helpers.h"
+
+#include "fci_workspace.h"
+#include "string_lists.h"
+
+using namespace psi;
+
+namespace forte {
+
+/// The alignment (in bytes) of each row of the scratch matrices
+constexpr size_t fci_workspace_alignment = 64;
+
+FCIWorkspace::FCIWorkspace(std::shared_ptr<StringLists> lists, size_t nthreads, int print)
+    : print_(print) {
+    allocate(required_dim(lists), nthreads, 1);
+}
+
+FCIWorkspace::~FCIWorkspace() { std::free(buffer_); }
+
+void FCIWorkspace::resize(std::shared_ptr<StringLists> lists, size_t nthreads, size_t nvec) {
+    size_t dim = required_dim(lists);
+    if ((dim > dim_) or (nthreads > nthreads_) or (nvec > nvec_)) {
+        allocate(std::max(dim, dim_), std::max(nthreads, nthreads_), std::max(nvec, nvec_));
+    }
+}
+
+size_t FCIWorkspace::required_dim(std::shared_ptr<StringLists> lists) {
+    size_t dim = 0;
+    for (int h = 0; h < lists->nirrep(); ++h) {
+        dim = std::max(dim, lists->alfa_graph()->strpi(h));
+        dim = std::max(dim, lists->beta_graph()->strpi(h));
+    }
+    return dim;
+}
+
+void FCIWorkspace::allocate(size_t dim, size_t nthreads, size_t nvec) {
+    std::free(buffer_);
+    buffer_ = nullptr;
+
+    // pad each row to a multiple of the alignment
+    constexpr size_t doubles_per_line = fci_workspace_alignment / sizeof(double);
+    dim_ = dim;
+    nthreads_ = std::max(nthreads, size_t(1));
+    nvec_ = std::max(nvec, size_t(1));
+    size_t ncol = nvec_ * dim_;
+    ld_ = std::max(size_t(1), (ncol + doubles_per_line - 1) / doubles_per_line) * doubles_per_line;
+
+    size_t bytes = std::max(size() * sizeof(double), fci_workspace_alignment);
+    buffer_ = static_cast<double*>(std::aligned_alloc(fci_workspace_alignment, bytes));
+    if (buffer_ == nullptr) {
+        throw std::bad_alloc();
+    }
+    std::fill_n(buffer_, size(), 0.0);
+
+    C1_rows_.assign(nthreads_, std::vector<double*>(dim_));
+    Y1_rows_.assign(nthreads_, std::vector<double*>(dim_));
+    C1f_rows_.assign(nthreads_, std::vector<float*>(dim_));
+    Y1f_rows_.assign(nthreads_, std::vector<float*>(dim_));
+    for (size_t t = 0; t < nthreads_; ++t) {
+        double* C1_start = buffer_ + 2 * t * dim_ * ld_;
+        double* Y1_start = C1_start + dim_ * ld_;
+        for (size_t i = 0; i < dim_; ++i) {
+            C1_rows_[t][i] = C1_start + i * ld_;
+            Y1_rows_[t][i] = Y1_start + i * ld_;
+            C1f_rows_[t][i] = reinterpret_cast<float*>(C1_start) + i * ld_;
+            Y1f_rows_[t][i] = reinterpret_cast<float*>(Y1_start) + i * ld_;
+        }
+    }
+
+    if (print_)
+        outfile->Printf("\n  Allocating memory for the Hamiltonian algorithm. "
+                        "Size: 2 x %zu x %zu x %zu.   Memory: %8.6f GB",
+                        nthreads_, dim_, ld_, to_gb(size()));
+}
+} // namespace forte
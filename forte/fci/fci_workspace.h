@@ -0,0 +1,128 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _fci_workspace_h_
+#define _fci_workspace_h_
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace forte {
+
+class StringLists;
+
+/**
+ * @brief The FCIWorkspace class
+ *
+ * Holds the scratch matrices (C1 and Y1) used by the FCI sigma build and RDM code.
+ * All the matrices are carved from a single aligned allocation, and each thread gets its own
+ * pair of matrices. Each matrix has room for the blocks of several vectors placed side by side
+ * (see FCIVector::Hamiltonian). A workspace is owned by a FCISolver so that several FCI computations can
+ * run concurrently in the same process. The memory is kept between calls to compute_energy()
+ * and it is only reallocated when a larger size is requested.
+ */
+class FCIWorkspace {
+  public:
+    // ==> Class Constructor and Destructor <==
+
+    /**
+     * @brief FCIWorkspace Allocate a workspace large enough for a set of string lists
+     * @param lists the string lists that determine the size of the scratch matrices
+     * @param nthreads the number of threads that will use the workspace
+     * @param print the print level
+     */
+    FCIWorkspace(std::shared_ptr<StringLists> lists, size_t nthreads, int print = 0);
+
+    ~FCIWorkspace();
+
+    FCIWorkspace(const FCIWorkspace&) = delete;
+    FCIWorkspace& operator=(const FCIWorkspace&) = delete;
+
+    // ==> Class Interface <==
+
+    /// Make sure that the workspace can accommodate a set of string lists, a number of
+    /// threads, and a number of vectors processed at the same time.
+    /// The memory is reallocated only if the current buffer is too small.
+    void resize(std::shared_ptr<StringLists> lists, size_t nthreads, size_t nvec = 1);
+
+    /// The number of threads supported by this workspace
+    size_t nthreads() const { return nthreads_; }
+    /// The number of rows of each scratch matrix
+    size_t dim() const { return dim_; }
+    /// The number of vectors that fit side by side in each scratch matrix
+    size_t nvec() const { return nvec_; }
+    /// The memory used by the workspace (in number of doubles)
+    size_t size() const { return nthreads_ * 2 * dim_ * ld_; }
+
+    /// Return the row pointers to the C1 scratch matrix of a given thread
+    double** C1(size_t thread) { return C1_rows_[thread].data(); }
+    /// Return the row pointers to the Y1 scratch matrix of a given thread
+    double** Y1(size_t thread) { return Y1_rows_[thread].data(); }
+    /// Return the row pointers to a single precision view of the C1 scratch matrix of a given
+    /// thread. This shares the memory of C1 and its rows are packed in the first half of it.
+    float** C1f(size_t thread) { return C1f_rows_[thread].data(); }
+    /// Return the row pointers to a single precision view of the Y1 scratch matrix of a given
+    /// thread. This shares the memory of Y1 and its rows are packed in the first half of it.
+    float** Y1f(size_t thread) { return Y1f_rows_[thread].data(); }
+
+  private:
+    // ==> Class Data <==
+
+    /// The number of threads
+    size_t nthreads_ = 0;
+    /// The number of rows of each matrix
+    size_t dim_ = 0;
+    /// The number of vectors stored in each matrix (each one takes dim_ columns)
+    size_t nvec_ = 1;
+    /// The leading dimension of each matrix (nvec_ * dim_ padded to a cache line)
+    size_t ld_ = 0;
+    /// The print level
+    int print_ = 0;
+    /// The aligned buffer
+    double* buffer_ = nullptr;
+    /// Row pointers for the C1 matrices of each thread
+    std::vector<std::vector<double*>> C1_rows_;
+    /// Row pointers for the Y1 matrices of each thread
+    std::vector<std::vector<double*>> Y1_rows_;
+    /// Row pointers for the single precision views of the C1 matrices of each thread
+    std::vector<std::vector<float*>> C1f_rows_;
+    /// Row pointers for the single precision views of the Y1 matrices of each thread
+    std::vector<std::vector<float*>> Y1f_rows_;
+
+    // ==> Class functions <==
+
+    /// The size of the scratch matrices needed for a set of string lists
+    static size_t required_dim(std::shared_ptr<StringLists> lists);
+
+    /// Allocate the buffer and set up the row pointers
+    void allocate(size_t dim, size_t nthreads, size_t nvec);
+};
+} // namespace forte
+
+#endif // _fci_workspace_h_
@@ -38,131 +38,221 @@
 #include <algorithm>
 
 #include "psi4/psi4-dec.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
 
+#include "helpers/helpers.h"
 #include "string_lists.h"
 
+using namespace psi;
 
 namespace forte {
 
+/**
+ * Generate one block of the hole lists. The blocks are generated the first time they are
+ * requested, which can happen concurrently from several threads.
+ * @param nholes the number of holes (1, 2, or 3)
+ * @param alfa true for the alpha lists, false for the beta lists
+ * @param h_I the symmetry of the N-electron strings
+ */
+void StringLists::make_hole_block(int nholes, bool alfa, int h_I) {
+    std::atomic<bool>& ready = hole_block_ready_[hole_block_index(nholes, alfa, h_I)];
+    if (ready.load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard<std::mutex> lock(hole_block_mutex_);
+    if (ready.load(std::memory_order_relaxed))
+        return;
+
+    local_timer t;
+    GraphPtr graph = alfa ? alfa_graph_ : beta_graph_;
+    size_t memory = 0;
+    if (nholes == 1) {
+        H1List& list = alfa ? alfa_1h_list[h_I] : beta_1h_list[h_I];
+        make_1h_list(graph, alfa ? alfa_graph_1h_ : beta_graph_1h_, list, h_I);
+        shrink_lists(list);
+        memory = list_memory(list);
+    } else if (nholes == 2) {
+        H2List& list = alfa ? alfa_2h_list[h_I] : beta_2h_list[h_I];
+        make_2h_list(graph, alfa ? alfa_graph_2h_ : beta_graph_2h_, list, h_I);
+        shrink_lists(list);
+        memory = list_memory(list);
+    } else {
+        H3List& list = alfa ? alfa_3h_list[h_I] : beta_3h_list[h_I];
+        make_3h_list(graph, alfa ? alfa_graph_3h_ : beta_graph_3h_, list, h_I);
+        shrink_lists(list);
+        memory = list_memory(list);
+    }
+    hole_lists_memory_ += memory;
+    ready.store(true, std::memory_order_release);
+
+    if (print_ > 1) {
+        auto block_mem = to_xb(memory, 1);
+        auto total_mem = to_xb(hole_lists_memory_, 1);
+        outfile->Printf("\n  Generated the %s %d-hole lists for irrep %d: %.3f %s in %.3f s"
+                        " (all hole lists: %.3f %s)",
+                        alfa ? "alpha" : "beta", nholes, h_I, block_mem.first,
+                        block_mem.second.c_str(), t.get(), total_mem.first,
+                        total_mem.second.c_str());
+    }
+    if (print_ and (hole_lists_memory_ > hole_lists_max_memory_) and
+        (hole_lists_memory_ - memory <= hole_lists_max_memory_)) {
+        auto max_mem = to_xb(hole_lists_max_memory_, 1);
+        outfile->Printf("\n  The hole lists use more than %.3f %s. They will be released after "
+                        "use.",
+                        max_mem.first, max_mem.second.c_str());
+    }
+}
+
+void StringLists::release_hole_lists(bool only_if_over_budget) {
+    std::lock_guard<std::mutex> lock(hole_block_mutex_);
+    if (only_if_over_budget and (hole_lists_memory_ <= hole_lists_max_memory_))
+        return;
+    for (int h = 0; h < nirrep_; ++h) {
+        alfa_1h_list[h].clear();
+        beta_1h_list[h].clear();
+        alfa_2h_list[h].clear();
+        beta_2h_list[h].clear();
+        alfa_3h_list[h].clear();
+        beta_3h_list[h].clear();
+    }
+    for (auto& ready : hole_block_ready_) {
+        ready.store(false);
+    }
+    if (print_ > 1) {
+        auto mem = to_xb(hole_lists_memory_, 1);
+        outfile->Printf("\n  Released %.3f %s used by the hole lists", mem.first,
+                        mem.second.c_str());
+    }
+    hole_lists_memory_ = 0;
+}
+
 std::vector<H1StringSubstitution>& StringLists::get_alfa_1h_list(int h_I, size_t add_I, int h_J) {
-    std::tuple<int, size_t, int> I_tuple(h_I, add_I, h_J);
-    return alfa_1h_list[I_tuple];
+    make_hole_block(1, true, h_J);
+    auto& list = alfa_1h_list[h_J];
+    auto it = list.find(std::make_tuple(h_I, add_I, h_J));
+    return it != list.end() ? it->second : empty_1h_list_;
 }
 
 std::vector<H1StringSubstitution>& StringLists::get_beta_1h_list(int h_I, size_t add_I, int h_J) {
-    std::tuple<int, size_t, int> I_tuple(h_I, add_I, h_J);
-    return beta_1h_list[I_tuple];
+    make_hole_block(1, false, h_J);
+    auto& list = beta_1h_list[h_J];
+    auto it = list.find(std::make_tuple(h_I, add_I, h_J));
+    return it != list.end() ? it->second : empty_1h_list_;
 }
 
-void StringLists::make_1h_list(GraphPtr graph, GraphPtr graph_1h, H1List& list) {
+void StringLists::make_1h_list(GraphPtr graph, GraphPtr graph_1h, H1List& list, int h_I) {
     int n = graph->nbits();
     int k = graph->nones();
     bool* I = new bool[ncmo_];
     bool* J = new bool[ncmo_];
 
     if ((k >= 0) and (k <= n)) { // check that (n > 0) makes sense.
-        for (int h_I = 0; h_I < nirrep_; ++h_I) {
-            // Generate the strings 1111100000
-            //                      { k }{n-k}
-            for (int i = 0; i < n - k; ++i)
-                I[i] = false; // 0
-            for (int i = std::max(0, n - k); i < n; ++i)
-                I[i] = true; // 1
-            do {
-                if (graph->sym(I) == h_I) {
-                    size_t add_I = graph->rel_add(I);
-                    for (size_t p = 0; p < ncmo_; ++p) {
-                        // copy I to J
-                        for (int i = 0; i < n; ++i)
-                            J[i] = I[i];
-                        if (J[p]) {
-                            J[p] = false;
-                            short sign = string_sign(J, p);
-
-                            int h_J = graph_1h->sym(J);
-                            size_t add_J = graph_1h->rel_add(J);
-
-                            std::tuple<int, size_t, int> I_tuple(h_J, add_J, h_I);
-                            list[I_tuple].push_back(H1StringSubstitution(sign, p, add_I));
-                        }
+        // Generate the strings 1111100000
+        //                      { k }{n-k}
+        for (int i = 0; i < n - k; ++i)
+            I[i] = false; // 0
+        for (int i = std::max(0, n - k); i < n; ++i)
+            I[i] = true; // 1
+        do {
+            if ((graph->sym(I) == h_I) and graph->allowed(I)) {
+                size_t add_I = graph->rel_add(I);
+                for (size_t p = 0; p < ncmo_; ++p) {
+                    // copy I to J
+                    for (int i = 0; i < n; ++i)
+                        J[i] = I[i];
+                    if (J[p]) {
+                        J[p] = false;
+                        short sign = string_sign(J, p);
+
+                        int h_J = graph_1h->sym(J);
+                        size_t add_J = graph_1h->rel_add(J);
+
+                        std::tuple<int, size_t, int> I_tuple(h_J, add_J, h_I);
+                        list[I_tuple].push_back(H1StringSubstitution(sign, p, add_I));
                     }
                 }
-            } while (std::next_permutation(I, I + n));
-        }
-    } // End loop over h
+            }
+        } while (std::next_permutation(I, I + n));
+    }
     delete[] J;
     delete[] I;
 }
 
 std::vector<H2StringSubstitution>& StringLists::get_alfa_2h_list(int h_I, size_t add_I, int h_J) {
-    std::tuple<int, size_t, int> I_tuple(h_I, add_I, h_J);
-    return alfa_2h_list[I_tuple];
+    make_hole_block(2, true, h_J);
+    auto& list = alfa_2h_list[h_J];
+    auto it = list.find(std::make_tuple(h_I, add_I, h_J));
+    return it != list.end() ? it->second : empty_2h_list_;
 }
 
 std::vector<H2StringSubstitution>& StringLists::get_beta_2h_list(int h_I, size_t add_I, int h_J) {
-    std::tuple<int, size_t, int> I_tuple(h_I, add_I, h_J);
-    return beta_2h_list[I_tuple];
+    make_hole_block(2, false, h_J);
+    auto& list = beta_2h_list[h_J];
+    auto it = list.find(std::make_tuple(h_I, add_I, h_J));
+    return it != list.end() ? it->second : empty_2h_list_;
 }
 
-void StringLists::make_2h_list(GraphPtr graph, GraphPtr graph_2h, H2List& list) {
+void StringLists::make_2h_list(GraphPtr graph, GraphPtr graph_2h, H2List& list, int h_I) {
     int n = graph->nbits();
     int k = graph->nones();
     bool* I = new bool[ncmo_];
     bool* J = new bool[ncmo_];
 
     if ((k >= 0) and (k <= n)) { // check that (n > 0) makes sense.
-        for (int h_I = 0; h_I < nirrep_; ++h_I) {
-            // Generate the strings 1111100000
-            //                      { k }{n-k}
-            for (int i = 0; i < n - k; ++i)
-                I[i] = false; // 0
-            for (int i = std::max(0, n - k); i < n; ++i)
-                I[i] = true; // 1
-            do {
-                if (graph->sym(I) == h_I) {
-                    size_t add_I = graph->rel_add(I);
-                    for (size_t q = 0; q < ncmo_; ++q) {
-                        for (size_t p = 0; p < ncmo_; ++p) {
-                            if (p != q) {
-                                // copy I to J
-                                for (int i = 0; i < n; ++i)
-                                    J[i] = I[i];
-                                if (J[q]) {
-                                    J[q] = false;
-                                    short q_sign = string_sign(J, q);
-                                    if (J[p]) {
-                                        J[p] = false;
-                                        short p_sign = string_sign(J, p);
+        // Generate the strings 1111100000
+        //                      { k }{n-k}
+        for (int i = 0; i < n - k; ++i)
+            I[i] = false; // 0
+        for (int i = std::max(0, n - k); i < n; ++i)
+            I[i] = true; // 1
+        do {
+            if ((graph->sym(I) == h_I) and graph->allowed(I)) {
+                size_t add_I = graph->rel_add(I);
+                for (size_t q = 0; q < ncmo_; ++q) {
+                    for (size_t p = 0; p < ncmo_; ++p) {
+                        if (p != q) {
+                            // copy I to J
+                            for (int i = 0; i < n; ++i)
+                                J[i] = I[i];
+                            if (J[q]) {
+                                J[q] = false;
+                                short q_sign = string_sign(J, q);
+                                if (J[p]) {
+                                    J[p] = false;
+                                    short p_sign = string_sign(J, p);
 
-                                        short sign = p_sign * q_sign;
+                                    short sign = p_sign * q_sign;
 
-                                        int h_J = graph_2h->sym(J);
-                                        size_t add_J = graph_2h->rel_add(J);
+                                    int h_J = graph_2h->sym(J);
+                                    size_t add_J = graph_2h->rel_add(J);
 
-                                        std::tuple<int, size_t, int> I_tuple(h_J, add_J, h_I);
-                                        list[I_tuple].push_back(
-                                            H2StringSubstitution(sign, p, q, add_I));
-                                    }
+                                    std::tuple<int, size_t, int> I_tuple(h_J, add_J, h_I);
+                                    list[I_tuple].push_back(
+                                        H2StringSubstitution(sign, p, q, add_I));
                                 }
                             }
                         }
                     }
                 }
-            } while (std::next_permutation(I, I + n));
-        }
-    } // End loop over h
+            }
+        } while (std::next_permutation(I, I + n));
+    }
     delete[] J;
     delete[] I;
 }
 
 std::vector<H3StringSubstitution>& StringLists::get_alfa_3h_list(int h_I, size_t add_I, int h_J) {
-    std::tuple<int, size_t, int> I_tuple(h_I, add_I, h_J);
-    return alfa_3h_list[I_tuple];
+    make_hole_block(3, true, h_J);
+    auto& list = alfa_3h_list[h_J];
+    auto it = list.find(std::make_tuple(h_I, add_I, h_J));
+    return it != list.end() ? it->second : empty_3h_list_;
 }
 
 std::vector<H3StringSubstitution>& StringLists::get_beta_3h_list(int h_I, size_t add_I, int h_J) {
-    std::tuple<int, size_t, int> I_tuple(h_I, add_I, h_J);
-    return beta_3h_list[I_tuple];
+    make_hole_block(3, false, h_J);
+    auto& list = beta_3h_list[h_J];
+    auto it = list.find(std::make_tuple(h_I, add_I, h_J));
+    return it != list.end() ? it->second : empty_3h_list_;
 }
 
 /**
@@ -171,52 +261,50 @@ std::vector<H3StringSubstitution>& StringLists::get_beta_3h_list(int h_I, size_t
                                * that is: J = ± a^{+}_p a_q I. p and q are
  * absolute indices and I belongs to the irrep h.
                                */
-void StringLists::make_3h_list(GraphPtr graph, GraphPtr graph_3h, H3List& list) {
+void StringLists::make_3h_list(GraphPtr graph, GraphPtr graph_3h, H3List& list, int h_I) {
     int n = graph->nbits();
     int k = graph->nones();
     bool* I = new bool[ncmo_];
     bool* J = new bool[ncmo_];
 
     if ((k >= 0) and (k <= n)) { // check that (n > 0) makes sense.
-        for (int h_I = 0; h_I < nirrep_; ++h_I) {
-            // Generate the strings 1111100000
-            //                      { k }{n-k}
-            for (int i = 0; i < n - k; ++i)
-                I[i] = false; // 0
-            for (int i = std::max(0, n - k); i < n; ++i)
-                I[i] = true; // 1
-            do {
-                if (graph->sym(I) == h_I) {
-                    size_t add_I = graph->rel_add(I);
-
-                    // apply a_r I
-                    for (size_t r = 0; r < ncmo_; ++r) {
-                        for (size_t q = 0; q < ncmo_; ++q) {
-                            for (size_t p = 0; p < ncmo_; ++p) {
-                                if ((p != q) and (p != r) and (q != r)) {
-                                    // copy I to J
-                                    for (int i = 0; i < n; ++i)
-                                        J[i] = I[i];
-                                    if (J[r]) {
-                                        J[r] = false;
-                                        short r_sign = string_sign(J, r);
-                                        if (J[q]) {
-                                            J[q] = false;
-                                            short q_sign = string_sign(J, q);
-                                            if (J[p]) {
-                                                J[p] = false;
-                                                short p_sign = string_sign(J, p);
-
-                                                short sign = p_sign * q_sign * r_sign;
-
-                                                int h_J = graph_3h->sym(J);
-                                                size_t add_J = graph_3h->rel_add(J);
-
-                                                std::tuple<int, size_t, int> I_tuple(h_J, add_J,
-                                                                                     h_I);
-                                                list[I_tuple].push_back(
-                                                    H3StringSubstitution(sign, p, q, r, add_I));
-                                            }
+        // Generate the strings 1111100000
+        //                      { k }{n-k}
+        for (int i = 0; i < n - k; ++i)
+            I[i] = false; // 0
+        for (int i = std::max(0, n - k); i < n; ++i)
+            I[i] = true; // 1
+        do {
+            if ((graph->sym(I) == h_I) and graph->allowed(I)) {
+                size_t add_I = graph->rel_add(I);
+
+                // apply a_r I
+                for (size_t r = 0; r < ncmo_; ++r) {
+                    for (size_t q = 0; q < ncmo_; ++q) {
+                        for (size_t p = 0; p < ncmo_; ++p) {
+                            if ((p != q) and (p != r) and (q != r)) {
+                                // copy I to J
+                                for (int i = 0; i < n; ++i)
+                                    J[i] = I[i];
+                                if (J[r]) {
+                                    J[r] = false;
+                                    short r_sign = string_sign(J, r);
+                                    if (J[q]) {
+                                        J[q] = false;
+                                        short q_sign = string_sign(J, q);
+                                        if (J[p]) {
+                                            J[p] = false;
+                                            short p_sign = string_sign(J, p);
+
+                                            short sign = p_sign * q_sign * r_sign;
+
+                                            int h_J = graph_3h->sym(J);
+                                            size_t add_J = graph_3h->rel_add(J);
+
+                                            std::tuple<int, size_t, int> I_tuple(h_J, add_J,
+                                                                                 h_I);
+                                            list[I_tuple].push_back(
+                                                H3StringSubstitution(sign, p, q, r, add_I));
                                         }
                                     }
                                 }
@@ -224,8 +312,8 @@ void StringLists::make_3h_list(GraphPtr graph, GraphPtr graph_3h, H3List& list)
                         }
                     }
                 }
-            } while (std::next_permutation(I, I + n));
-        } // End loop over h
+            }
+        } while (std::next_permutation(I, I + n));
     }
     delete[] J;
     delete[] I;
@@ -27,10 +27,13 @@
  */
 
 #include <algorithm>
+#include <limits>
 
 #include "psi4/psi4-dec.h"
+#include "psi4/libpsi4util/exception.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 
+#include "helpers/helpers.h"
 #include "string_lists.h"
 
 using namespace psi;
@@ -38,9 +41,10 @@ using namespace psi;
 namespace forte {
 
 StringLists::StringLists(RequiredLists required_lists, psi::Dimension cmopi, std::vector<size_t> core_mo,
-                         std::vector<size_t> cmo_to_mo, size_t na, size_t nb, int print)
+                         std::vector<size_t> cmo_to_mo, size_t na, size_t nb, int print,
+                         StringRestrictions restrictions)
     : required_lists_(required_lists), cmopi_(cmopi), cmo_to_mo_(cmo_to_mo), fomo_to_mo_(core_mo),
-      na_(na), nb_(nb), print_(print) {
+      na_(na), nb_(nb), print_(print), restrictions_(restrictions) {
     startup();
 }
 
@@ -63,6 +67,10 @@ void StringLists::startup() {
     alfa_graph_ = std::shared_ptr<BinaryGraph>(new BinaryGraph(ncmo_, na_, cmopi_int));
     beta_graph_ = std::shared_ptr<BinaryGraph>(new BinaryGraph(ncmo_, nb_, cmopi_int));
     pair_graph_ = std::shared_ptr<BinaryGraph>(new BinaryGraph(ncmo_, 2, cmopi_int));
+    // The hole graphs are not restricted: only the N-electron strings must be allowed
+    if (not restrictions_.empty()) {
+        set_graph_restrictions();
+    }
 
     if (na_ >= 1) {
         alfa_graph_1h_ = std::shared_ptr<BinaryGraph>(new BinaryGraph(ncmo_, na_ - 1, cmopi_int));
@@ -92,14 +100,33 @@ void StringLists::startup() {
         nbs_ += beta_graph_->strpi(h);
     }
 
+    // The lists store orbital indices in one byte and string addresses in a StringAddress
+    if (ncmo_ > std::numeric_limits<uint8_t>::max()) {
+        throw psi::PSIEXCEPTION("StringLists: the number of orbitals exceeds the maximum (255) "
+                                "supported by the string lists.");
+    }
+    for (int h = 0; h < nirrep_; ++h) {
+        if (std::max(alfa_graph_->strpi(h), beta_graph_->strpi(h)) >
+            std::numeric_limits<StringAddress>::max()) {
+            throw psi::PSIEXCEPTION("StringLists: the number of strings per irrep exceeds the "
+                                    "maximum supported by the string lists.");
+        }
+    }
+
+    // The hole lists are generated on demand, one symmetry block at a time
+    alfa_1h_list.resize(nirrep_);
+    beta_1h_list.resize(nirrep_);
+    alfa_2h_list.resize(nirrep_);
+    beta_2h_list.resize(nirrep_);
+    alfa_3h_list.resize(nirrep_);
+    beta_3h_list.resize(nirrep_);
+    hole_block_ready_ = std::vector<std::atomic<bool>>(6 * nirrep_);
+
     // local_timers
     double str_list_timer = 0.0;
     double vo_list_timer = 0.0;
     double nn_list_timer = 0.0;
     double oo_list_timer = 0.0;
-    double h1_list_timer = 0.0;
-    double h2_list_timer = 0.0;
-    double h3_list_timer = 0.0;
     double vovo_list_timer = 0.0;
     double vvoo_list_timer = 0.0;
 
@@ -107,6 +134,7 @@ void StringLists::startup() {
         local_timer t;
         make_strings(alfa_graph_, alfa_list_);
         make_strings(beta_graph_, beta_list_);
+        make_string_classes();
         str_list_timer += t.get();
     }
     {
@@ -118,6 +146,8 @@ void StringLists::startup() {
         local_timer t;
         make_vo_list(alfa_graph_, alfa_vo_list);
         make_vo_list(beta_graph_, beta_vo_list);
+        make_vo_soa(alfa_vo_list, alfa_vo_soa);
+        make_vo_soa(beta_vo_list, beta_vo_soa);
         vo_list_timer += t.get();
     }
     {
@@ -126,24 +156,6 @@ void StringLists::startup() {
         make_oo_list(beta_graph_, beta_oo_list);
         oo_list_timer += t.get();
     }
-    {
-        local_timer t;
-        make_1h_list(alfa_graph_, alfa_graph_1h_, alfa_1h_list);
-        make_1h_list(beta_graph_, beta_graph_1h_, beta_1h_list);
-        h1_list_timer += t.get();
-    }
-    {
-        local_timer t;
-        make_2h_list(alfa_graph_, alfa_graph_2h_, alfa_2h_list);
-        make_2h_list(beta_graph_, beta_graph_2h_, beta_2h_list);
-        h2_list_timer += t.get();
-    }
-    {
-        local_timer t;
-        make_3h_list(alfa_graph_, alfa_graph_3h_, alfa_3h_list);
-        make_3h_list(beta_graph_, beta_graph_3h_, beta_3h_list);
-        h3_list_timer += t.get();
-    }
     if (required_lists_ == twoSubstituitionVVOO) {
         local_timer t;
         make_vvoo_list(alfa_graph_, alfa_vvoo_list);
@@ -159,6 +171,26 @@ void StringLists::startup() {
     double total_time = str_list_timer + nn_list_timer + vo_list_timer + oo_list_timer +
                         vvoo_list_timer + vovo_list_timer;
 
+    // Release the unused capacity of the lists
+    shrink_lists(alfa_vo_list);
+    shrink_lists(beta_vo_list);
+    shrink_lists(alfa_oo_list);
+    shrink_lists(beta_oo_list);
+    shrink_lists(alfa_vvoo_list);
+    shrink_lists(beta_vvoo_list);
+    shrink_lists(alfa_vovo_list);
+    shrink_lists(beta_vovo_list);
+    size_t vo_memory = list_memory(alfa_vo_list) + list_memory(beta_vo_list);
+    for (const VOListSoA* soa : {&alfa_vo_soa, &beta_vo_soa}) {
+        for (const auto& key_list : *soa) {
+            vo_memory += sizeof(key_list) + 4 * sizeof(void*) +
+                         key_list.second.size() * (sizeof(double) + 2 * sizeof(size_t));
+        }
+    }
+    size_t oo_memory = list_memory(alfa_oo_list) + list_memory(beta_oo_list);
+    size_t vvoo_memory = list_memory(alfa_vvoo_list) + list_memory(beta_vvoo_list);
+    size_t vovo_memory = list_memory(alfa_vovo_list) + list_memory(beta_vovo_list);
+
     if (print_) {
         outfile->Printf("\n\n  ==> String Lists <==\n");
         outfile->Printf("\n  Number of alpha electrons     = %zu", na_);
@@ -177,10 +209,20 @@ void StringLists::startup() {
         outfile->Printf("\n  Timing for OO strings     = %10.3f s", oo_list_timer);
         outfile->Printf("\n  Timing for VVOO strings   = %10.3f s", vvoo_list_timer);
         outfile->Printf("\n  Timing for VOVO strings   = %10.3f s", vovo_list_timer);
-        outfile->Printf("\n  Timing for 1-hole strings = %10.3f s", h1_list_timer);
-        outfile->Printf("\n  Timing for 2-hole strings = %10.3f s", h2_list_timer);
-        outfile->Printf("\n  Timing for 3-hole strings = %10.3f s", h3_list_timer);
         outfile->Printf("\n  Total timing              = %10.3f s", total_time);
+        std::vector<std::pair<std::string, size_t>> memory_info{{"VO", vo_memory},
+                                                                {"OO", oo_memory},
+                                                                {"VVOO", vvoo_memory},
+                                                                {"VOVO", vovo_memory}};
+        for (const auto& label_mem : memory_info) {
+            auto mem = to_xb(label_mem.second, 1);
+            outfile->Printf("\n  Memory for %-4s strings   = %10.3f %s", label_mem.first.c_str(),
+                            mem.first, mem.second.c_str());
+        }
+        auto mem = to_xb(hole_lists_max_memory_, 1);
+        outfile->Printf("\n  The 1-, 2-, and 3-hole lists are generated on demand"
+                        " (memory budget: %.3f %s)",
+                        mem.first, mem.second.c_str());
     }
 }
 
@@ -237,6 +279,8 @@ void StringLists::make_strings(GraphPtr graph, StringList& list) {
         for (int i = std::max(0, n - k); i < n; ++i)
             I[i] = true; // 1
         do {
+            if (not graph->allowed(I))
+                continue;
             size_t sym_I = graph->sym(I);
             size_t add_I = graph->rel_add(I);
             // copy I to J
@@ -251,6 +295,83 @@ void StringLists::make_strings(GraphPtr graph, StringList& list) {
     }
 }
 
+void StringLists::set_graph_restrictions() {
+    const auto& space = restrictions_.orbital_space;
+    const size_t nspace = restrictions_.space_min.size();
+    if ((space.size() != ncmo_) or (restrictions_.space_max.size() != nspace)) {
+        throw psi::PSIEXCEPTION("StringLists: the restrictions are inconsistent with the orbitals");
+    }
+    std::vector<int> space_size(nspace, 0);
+    for (int g : space) {
+        if (g >= 0)
+            space_size[g] += 1;
+    }
+    // Bounds on the number of electrons of one spin in each space that follow from the bounds
+    // on the total number (n the number of electrons of this spin, n_other of the other spin)
+    auto spin_bounds = [&](int n, int n_other, std::vector<int>& smin, std::vector<int>& smax) {
+        for (size_t g = 0; g < nspace; ++g) {
+            smin.push_back(
+                std::max(0, restrictions_.space_min[g] - std::min(space_size[g], n_other)));
+            smax.push_back(std::min({restrictions_.space_max[g], space_size[g], n}));
+        }
+    };
+    std::vector<int> alfa_min, alfa_max, beta_min, beta_max;
+    spin_bounds(na_, nb_, alfa_min, alfa_max);
+    spin_bounds(nb_, na_, beta_min, beta_max);
+    alfa_graph_->set_restrictions(space, alfa_min, alfa_max);
+    beta_graph_->set_restrictions(space, beta_min, beta_max);
+}
+
+void StringLists::make_string_classes() {
+    if (restrictions_.empty())
+        return;
+    const auto& space = restrictions_.orbital_space;
+    const size_t nspace = restrictions_.space_min.size();
+    // Number the distinct occupations of the spaces found in a list of strings
+    auto classify = [&](const StringList& list, std::vector<std::vector<int>>& string_class,
+                        std::vector<std::vector<int>>& classes) {
+        std::map<std::vector<int>, int> class_index;
+        string_class.resize(nirrep_);
+        for (int h = 0; h < nirrep_; ++h) {
+            for (const auto& I : list[h]) {
+                std::vector<int> count(nspace, 0);
+                for (size_t p = 0; p < ncmo_; ++p) {
+                    if (I[p] and space[p] >= 0)
+                        count[space[p]] += 1;
+                }
+                auto it = class_index.find(count);
+                if (it == class_index.end()) {
+                    it = class_index.emplace(count, static_cast<int>(classes.size())).first;
+                    classes.push_back(count);
+                }
+                string_class[h].push_back(it->second);
+            }
+        }
+    };
+    std::vector<std::vector<int>> alfa_classes, beta_classes;
+    classify(alfa_list_, alfa_class_, alfa_classes);
+    classify(beta_list_, beta_class_, beta_classes);
+
+    nbeta_classes_ = beta_classes.size();
+    allowed_classes_.assign(alfa_classes.size() * nbeta_classes_, true);
+    bool all_allowed = true;
+    for (size_t ca = 0; ca < alfa_classes.size(); ++ca) {
+        for (size_t cb = 0; cb < nbeta_classes_; ++cb) {
+            for (size_t g = 0; g < nspace; ++g) {
+                int n = alfa_classes[ca][g] + beta_classes[cb][g];
+                if ((n < restrictions_.space_min[g]) or (n > restrictions_.space_max[g])) {
+                    allowed_classes_[ca * nbeta_classes_ + cb] = false;
+                    all_allowed = false;
+                    break;
+                }
+            }
+        }
+    }
+    // the restrictions on the strings are sufficient
+    if (all_allowed)
+        allowed_classes_.clear();
+}
+
 short StringLists::string_sign(const bool* I, size_t n) {
     short sign = 1;
     for (size_t i = 0; i < n; ++i) { // This runs up to the operator before n
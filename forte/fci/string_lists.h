@@ -31,7 +31,10 @@
 
 #include "psi4/libmints/dimension.h"
 
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <utility>
 #include <bitset>
@@ -50,39 +53,65 @@ struct DetAddress {
         : alfa_sym(alfa_sym_), alfa_string(alfa_string_), beta_string(beta_string_) {}
 };
 
+/// The type used to store the address of a string within a symmetry block
+typedef uint32_t StringAddress;
+
+/**
+ * @brief A string substitution J = sign * E_pq I
+ *
+ * The sign and the addresses are packed in 12 bytes (versus 24 bytes for a short and two
+ * size_t). The number of strings per irrep must fit in a StringAddress, which is checked when
+ * the lists are created.
+ */
 struct StringSubstitution {
-    short sign;
-    size_t I;
-    size_t J;
+    int8_t sign;
+    StringAddress I;
+    StringAddress J;
     StringSubstitution(const int& sign_, const size_t& I_, const size_t& J_)
         : sign(sign_), I(I_), J(J_) {}
 };
 
+/**
+ * @brief A list of string substitutions stored as a structure of arrays
+ *
+ * The sign is stored as a double so that it can be loaded directly by the vectorized
+ * gather/scatter kernels in fci_kernels.h. The elements are sorted by the index I.
+ */
+struct StringSubstitutionSoA {
+    std::vector<double> sign;
+    std::vector<size_t> I;
+    std::vector<size_t> J;
+    size_t size() const { return I.size(); }
+};
+
+// The hole substitutions store the sign and the orbital indices in one byte each, so that
+// each element takes 8 bytes
+
 /// 1-hole string substitution
 struct H1StringSubstitution {
-    short sign;
-    short p;
-    size_t J;
+    int8_t sign;
+    uint8_t p;
+    StringAddress J;
     H1StringSubstitution(short sign_, short p_, size_t J_) : sign(sign_), p(p_), J(J_) {}
 };
 
 /// 2-hole string substitution
 struct H2StringSubstitution {
-    short sign;
-    short p;
-    short q;
-    size_t J;
+    int8_t sign;
+    uint8_t p;
+    uint8_t q;
+    StringAddress J;
     H2StringSubstitution(short sign_, short p_, short q_, size_t J_)
         : sign(sign_), p(p_), q(q_), J(J_) {}
 };
 
 /// 3-hole string substitution
 struct H3StringSubstitution {
-    short sign;
-    short p;
-    short q;
-    short r;
-    size_t J;
+    int8_t sign;
+    uint8_t p;
+    uint8_t q;
+    uint8_t r;
+    StringAddress J;
     H3StringSubstitution(short sign_, short p_, short q_, short r_, size_t J_)
         : sign(sign_), p(p_), q(q_), r(r_), J(J_) {}
 };
@@ -90,12 +119,15 @@ struct H3StringSubstitution {
 typedef std::shared_ptr<BinaryGraph> GraphPtr;
 typedef std::vector<std::vector<std::bitset<Determinant::nbits_half>>> StringList;
 typedef std::map<std::tuple<size_t, size_t, int>, std::vector<StringSubstitution>> VOList;
+typedef std::map<std::tuple<size_t, size_t, int>, StringSubstitutionSoA> VOListSoA;
 typedef std::map<std::tuple<size_t, size_t, size_t, size_t, int>, std::vector<StringSubstitution>>
     VOVOList;
 typedef std::map<std::tuple<size_t, size_t, size_t, size_t, int>, std::vector<StringSubstitution>>
     VVOOList;
 typedef std::map<std::tuple<int, size_t, int>, std::vector<StringSubstitution>> OOList;
 
+// The hole lists are stored in one map per symmetry of the N-electron strings, so that each
+// block can be generated independently
 /// 1-hole list
 typedef std::map<std::tuple<int, size_t, int>, std::vector<H1StringSubstitution>> H1List;
 /// 2-hole list
@@ -110,6 +142,20 @@ typedef std::vector<PairList> NNList;
 // Enum for selecting substitution lists with one or one and two substitutions
 enum RequiredLists { oneSubstituition, twoSubstituitionVVOO, twoSubstituitionVOVO };
 
+/**
+ * @brief Restrictions on the total number of electrons in subsets of the orbitals (e.g., the
+ *        spaces of a GAS/RAS wave function)
+ */
+struct StringRestrictions {
+    /// The space of each orbital (-1 for orbitals without restrictions)
+    std::vector<int> orbital_space;
+    /// The minimum number of electrons in each space
+    std::vector<int> space_min;
+    /// The maximum number of electrons in each space
+    std::vector<int> space_max;
+    bool empty() const { return orbital_space.empty(); }
+};
+
 /**
  * @brief The StringLists class
  *
@@ -120,7 +166,8 @@ class StringLists {
     // ==> Constructor and Destructor <==
 
     StringLists(RequiredLists required_lists, psi::Dimension cmopi, std::vector<size_t> core_mo,
-                std::vector<size_t> cmo_to_mo, size_t na, size_t nb, int print);
+                std::vector<size_t> cmo_to_mo, size_t na, size_t nb, int print,
+                StringRestrictions restrictions = StringRestrictions());
     ~StringLists() {}
 
     // ==> Class Public Functions <==
@@ -151,9 +198,26 @@ class StringLists {
         return beta_list_[h][I];
     }
 
+    /// Are the strings restricted?
+    bool restricted() const { return not restrictions_.empty(); }
+    /// Are there restricted determinants made of two allowed strings? When true, the vectors
+    /// must be projected onto the allowed determinants with allowed_determinant()
+    bool restricted_determinants() const { return not allowed_classes_.empty(); }
+    /// Is the determinant made of the alpha string Ia of irrep ha and the beta string Ib of
+    /// irrep hb allowed by the restrictions?
+    bool allowed_determinant(int ha, size_t Ia, int hb, size_t Ib) const {
+        return allowed_classes_.empty() or
+               allowed_classes_[alfa_class_[ha][Ia] * nbeta_classes_ + beta_class_[hb][Ib]];
+    }
+
     std::vector<StringSubstitution>& get_alfa_vo_list(size_t p, size_t q, int h);
     std::vector<StringSubstitution>& get_beta_vo_list(size_t p, size_t q, int h);
 
+    /// Same as get_alfa_vo_list, but returns the list in the structure-of-arrays format
+    const StringSubstitutionSoA& get_alfa_vo_soa(size_t p, size_t q, int h) const;
+    /// Same as get_beta_vo_list, but returns the list in the structure-of-arrays format
+    const StringSubstitutionSoA& get_beta_vo_soa(size_t p, size_t q, int h) const;
+
     std::vector<H1StringSubstitution>& get_alfa_1h_list(int h_I, size_t add_I, int h_J);
     std::vector<H1StringSubstitution>& get_beta_1h_list(int h_I, size_t add_I, int h_J);
 
@@ -178,6 +242,16 @@ class StringLists {
 
     Pair get_nn_list_pair(int h, int n) const { return nn_list[h][n]; }
 
+    /// Set the memory (in bytes) that the hole lists are allowed to use. The hole lists are
+    /// generated the first time they are requested; see release_hole_lists().
+    void set_hole_lists_max_memory(size_t max_memory) { hole_lists_max_memory_ = max_memory; }
+    /// The memory (in bytes) used by the hole lists generated so far
+    size_t hole_lists_memory() const { return hole_lists_memory_; }
+    /// Release the memory held by the hole lists. If only_if_over_budget is true, the lists are
+    /// released only if they use more memory than the budget. This function must not be called
+    /// while references to hole lists are in use.
+    void release_hole_lists(bool only_if_over_budget = false);
+
     //  size_t get_nalfa_strings() const {return nas;}
     //  size_t get_nbeta_strings() const {return nbs;}
   private:
@@ -223,6 +297,9 @@ class StringLists {
     /// The VO string lists
     VOList alfa_vo_list;
     VOList beta_vo_list;
+    /// The VO string lists in structure-of-arrays format
+    VOListSoA alfa_vo_soa;
+    VOListSoA beta_vo_soa;
     /// The OO string lists
     OOList alfa_oo_list;
     OOList beta_oo_list;
@@ -232,15 +309,43 @@ class StringLists {
     /// The VVOO string lists
     VVOOList alfa_vvoo_list;
     VVOOList beta_vvoo_list;
-    /// The 1-hole lists
-    H1List alfa_1h_list;
-    H1List beta_1h_list;
-    /// The 2-hole lists
-    H2List alfa_2h_list;
-    H2List beta_2h_list;
-    /// The 3-hole lists
-    H3List alfa_3h_list;
-    H3List beta_3h_list;
+    /// The 1-hole lists (one map per symmetry of the N-electron strings)
+    std::vector<H1List> alfa_1h_list;
+    std::vector<H1List> beta_1h_list;
+    /// The 2-hole lists (one map per symmetry of the N-electron strings)
+    std::vector<H2List> alfa_2h_list;
+    std::vector<H2List> beta_2h_list;
+    /// The 3-hole lists (one map per symmetry of the N-electron strings)
+    std::vector<H3List> alfa_3h_list;
+    std::vector<H3List> beta_3h_list;
+    /// Flags that mark the hole-list blocks that have been generated. The index of a block is
+    /// given by hole_block_index()
+    std::vector<std::atomic<bool>> hole_block_ready_;
+    /// A mutex that serializes the generation of hole-list blocks
+    std::mutex hole_block_mutex_;
+    /// The memory used by the hole lists (in bytes)
+    size_t hole_lists_memory_ = 0;
+    /// The memory that the hole lists are allowed to use (in bytes)
+    size_t hole_lists_max_memory_ = 1073741824;
+    /// An empty list returned for substitutions with no strings. The getters do not insert
+    /// into the maps, so they can be called concurrently from several threads
+    std::vector<StringSubstitution> empty_list_;
+    StringSubstitutionSoA empty_soa_;
+    std::vector<H1StringSubstitution> empty_1h_list_;
+    std::vector<H2StringSubstitution> empty_2h_list_;
+    std::vector<H3StringSubstitution> empty_3h_list_;
+
+    // Restrictions
+    /// The restrictions on the number of electrons in each space
+    StringRestrictions restrictions_;
+    /// The class (number of electrons in each space) of each alpha string [h][I]
+    std::vector<std::vector<int>> alfa_class_;
+    /// The class (number of electrons in each space) of each beta string [h][I]
+    std::vector<std::vector<int>> beta_class_;
+    /// The number of beta string classes
+    size_t nbeta_classes_ = 0;
+    /// Is the pair (alpha class, beta class) allowed? Empty if all pairs are allowed
+    std::vector<bool> allowed_classes_;
 
     // Graphs
     /// The alpha string graph
@@ -266,21 +371,34 @@ class StringLists {
     void startup();
 
     void make_strings(GraphPtr graph, StringList& list);
+    /// Restrict the alpha and beta graphs to the strings compatible with the restrictions
+    void set_graph_restrictions();
+    /// Find the class of each string and the pairs of classes that are allowed
+    void make_string_classes();
 
     void make_pair_list(NNList& list);
 
     void make_vo_list(GraphPtr graph, VOList& list);
     void make_vo(GraphPtr graph, VOList& list, int p, int q);
+    /// Convert the VO lists to the structure-of-arrays format
+    void make_vo_soa(const VOList& list, VOListSoA& soa);
 
     void make_oo_list(GraphPtr graph, OOList& list);
     void make_oo(GraphPtr graph, OOList& list, int pq_sym, size_t pq);
 
-    /// Make 1-hole lists (I -> a_p I = sgn J)
-    void make_1h_list(GraphPtr graph, GraphPtr graph_1h, H1List& list);
-    /// Make 2-hole lists (I -> a_p a_q I = sgn J)
-    void make_2h_list(GraphPtr graph, GraphPtr graph_2h, H2List& list);
-    /// Make 3-hole lists (I -> a_p a_q a_r I = sgn J)
-    void make_3h_list(GraphPtr graph, GraphPtr graph_3h, H3List& list);
+    /// Make 1-hole lists (I -> a_p I = sgn J) for the strings I of symmetry h_I
+    void make_1h_list(GraphPtr graph, GraphPtr graph_1h, H1List& list, int h_I);
+    /// Make 2-hole lists (I -> a_p a_q I = sgn J) for the strings I of symmetry h_I
+    void make_2h_list(GraphPtr graph, GraphPtr graph_2h, H2List& list, int h_I);
+    /// Make 3-hole lists (I -> a_p a_q a_r I = sgn J) for the strings I of symmetry h_I
+    void make_3h_list(GraphPtr graph, GraphPtr graph_3h, H3List& list, int h_I);
+
+    /// The index of a hole-list block in hole_block_ready_
+    size_t hole_block_index(int nholes, bool alfa, int h_I) const {
+        return (2 * (nholes - 1) + (alfa ? 0 : 1)) * nirrep_ + h_I;
+    }
+    /// Generate a block of a hole list (if it does not exist yet)
+    void make_hole_block(int nholes, bool alfa, int h_I);
 
     void make_vovo_list(GraphPtr graph, VOVOList& list);
     void make_VOVO(GraphPtr graph, VOVOList& list, int p, int q, int r, int s);
@@ -290,6 +408,41 @@ class StringLists {
 
     short string_sign(const bool* I, size_t n);
 
+    /**
+     * @brief Generate a list in parallel, one task at a time
+     *
+     * make_task(task, local) adds to local the entries of one task. The tasks must generate
+     * disjoint sets of keys, so that the local maps can be spliced into list without copying
+     */
+    template <typename List, typename Task, typename Function>
+    static void make_list_parallel(const std::vector<Task>& tasks, List& list,
+                                   Function make_task) {
+#pragma omp parallel for schedule(dynamic, 1)
+        for (size_t n = 0; n < tasks.size(); ++n) {
+            List local;
+            make_task(tasks[n], local);
+#pragma omp critical(string_lists_merge)
+            list.merge(local);
+        }
+    }
+
+    /// The memory (in bytes) used by a map of lists, including an estimate of the map overhead
+    template <typename List> static size_t list_memory(const List& list) {
+        size_t memory = 0;
+        for (const auto& key_list : list) {
+            memory += sizeof(key_list) + 4 * sizeof(void*) +
+                      key_list.second.capacity() *
+                          sizeof(typename List::mapped_type::value_type);
+        }
+        return memory;
+    }
+    /// Release the unused capacity of the vectors in a map of lists
+    template <typename List> static void shrink_lists(List& list) {
+        for (auto& key_list : list) {
+            key_list.second.shrink_to_fit();
+        }
+    }
+
     void print_string(bool* I, size_t n);
 };
 } // namespace forte
@@ -41,7 +41,8 @@ namespace forte {
  */
 std::vector<StringSubstitution>& StringLists::get_alfa_oo_list(int pq_sym, size_t pq, int h) {
     std::tuple<int, size_t, int> pq_pair(pq_sym, pq, h);
-    return alfa_oo_list[pq_pair];
+    auto it = alfa_oo_list.find(pq_pair);
+    return it != alfa_oo_list.end() ? it->second : empty_list_;
 }
 
 /**
@@ -52,7 +53,8 @@ std::vector<StringSubstitution>& StringLists::get_alfa_oo_list(int pq_sym, size_
  */
 std::vector<StringSubstitution>& StringLists::get_beta_oo_list(int pq_sym, size_t pq, int h) {
     std::tuple<int, size_t, int> pq_pair(pq_sym, pq, h);
-    return beta_oo_list[pq_pair];
+    auto it = beta_oo_list.find(pq_pair);
+    return it != beta_oo_list.end() ? it->second : empty_list_;
 }
 
 /**
@@ -62,12 +64,17 @@ std::vector<StringSubstitution>& StringLists::get_beta_oo_list(int pq_sym, size_
  */
 void StringLists::make_oo_list(GraphPtr graph, OOList& list) {
     // Loop over irreps of the pair pq
+    std::vector<std::pair<int, size_t>> pq_list;
     for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
         size_t max_pq = pairpi_[pq_sym];
         for (size_t pq = 0; pq < max_pq; ++pq) {
-            make_oo(graph, list, pq_sym, pq);
+            pq_list.emplace_back(pq_sym, pq);
         }
     }
+    // each pair pq generates the keys (pq_sym, pq, h) for all h
+    make_list_parallel(pq_list, list, [&](const std::pair<int, size_t>& pq, OOList& local) {
+        make_oo(graph, local, pq.first, pq.second);
+    });
 }
 
 /**
@@ -116,7 +123,7 @@ void StringLists::make_oo(GraphPtr graph, OOList& list, int pq_sym, size_t pq) {
                 J[p] = true;
                 J[q] = true;
                 // Add the sting only of irrep(I) is h
-                if (graph->sym(I) == h)
+                if ((graph->sym(I) == h) and graph->allowed(I))
                     list[pq_pair].push_back(
                         StringSubstitution(1, graph->rel_add(I), graph->rel_add(J)));
             } while (std::next_permutation(b, b + n));
@@ -53,7 +53,8 @@ namespace forte {
  */
 std::vector<StringSubstitution>& StringLists::get_alfa_vo_list(size_t p, size_t q, int h) {
     std::tuple<size_t, size_t, int> pq_pair(p, q, h);
-    return alfa_vo_list[pq_pair];
+    auto it = alfa_vo_list.find(pq_pair);
+    return it != alfa_vo_list.end() ? it->second : empty_list_;
 }
 
 /**
@@ -64,11 +65,46 @@ std::vector<StringSubstitution>& StringLists::get_alfa_vo_list(size_t p, size_t
  */
 std::vector<StringSubstitution>& StringLists::get_beta_vo_list(size_t p, size_t q, int h) {
     std::tuple<size_t, size_t, int> pq_pair(p, q, h);
-    return beta_vo_list[pq_pair];
+    auto it = beta_vo_list.find(pq_pair);
+    return it != beta_vo_list.end() ? it->second : empty_list_;
+}
+
+const StringSubstitutionSoA& StringLists::get_alfa_vo_soa(size_t p, size_t q, int h) const {
+    auto it = alfa_vo_soa.find(std::make_tuple(p, q, h));
+    return it != alfa_vo_soa.end() ? it->second : empty_soa_;
+}
+
+const StringSubstitutionSoA& StringLists::get_beta_vo_soa(size_t p, size_t q, int h) const {
+    auto it = beta_vo_soa.find(std::make_tuple(p, q, h));
+    return it != beta_vo_soa.end() ? it->second : empty_soa_;
+}
+
+void StringLists::make_vo_soa(const VOList& list, VOListSoA& soa) {
+    // create the entries serially, then fill them in parallel
+    std::vector<std::pair<const VOList::mapped_type*, StringSubstitutionSoA*>> entries;
+    for (const auto& key_list : list) {
+        entries.emplace_back(&key_list.second, &soa[key_list.first]);
+    }
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t n = 0; n < entries.size(); ++n) {
+        // sort by I so that the gather step reads the source vector in order
+        std::vector<StringSubstitution> sorted_list = *entries[n].first;
+        std::sort(sorted_list.begin(), sorted_list.end(),
+                  [](const StringSubstitution& a, const StringSubstitution& b) {
+                      return a.I < b.I;
+                  });
+        StringSubstitutionSoA& s = *entries[n].second;
+        for (const auto& ss : sorted_list) {
+            s.sign.push_back(static_cast<double>(ss.sign));
+            s.I.push_back(ss.I);
+            s.J.push_back(ss.J);
+        }
+    }
 }
 
 void StringLists::make_vo_list(GraphPtr graph, VOList& list) {
     // Loop over irreps of the pair pq
+    std::vector<std::pair<int, int>> pq_list;
     for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
         // Loop over irreps of p
         for (int p_sym = 0; p_sym < nirrep_; ++p_sym) {
@@ -77,11 +113,15 @@ void StringLists::make_vo_list(GraphPtr graph, VOList& list) {
                 for (int q_rel = 0; q_rel < cmopi_[q_sym]; ++q_rel) {
                     int p_abs = p_rel + cmopi_offset_[p_sym];
                     int q_abs = q_rel + cmopi_offset_[q_sym];
-                    make_vo(graph, list, p_abs, q_abs);
+                    pq_list.emplace_back(p_abs, q_abs);
                 }
             }
         }
     }
+    // each pair pq generates the keys (p, q, h) for all h
+    make_list_parallel(pq_list, list, [&](const std::pair<int, int>& pq, VOList& local) {
+        make_vo(graph, local, pq.first, pq.second);
+    });
 }
 
 /**
@@ -129,7 +169,7 @@ void StringLists::make_vo(GraphPtr graph, VOList& list, int p, int q) {
                 J[p] = 1;
 
                 // Add the sting only of irrep(I) is h
-                if (graph->sym(I) == h)
+                if ((graph->sym(I) == h) and graph->allowed(I) and graph->allowed(J))
                     list[pq_pair].push_back(
                         StringSubstitution(sign, graph->rel_add(I), graph->rel_add(J)));
             } while (std::next_permutation(b, b + n));
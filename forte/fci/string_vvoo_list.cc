@@ -27,6 +27,7 @@
  */
 
 #include <algorithm>
+#include <array>
 
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
@@ -41,7 +42,8 @@ namespace forte {
 std::vector<StringSubstitution>& StringLists::get_alfa_vvoo_list(size_t p, size_t q, size_t r,
                                                                  size_t s, int h) {
     std::tuple<size_t, size_t, size_t, size_t, int> pqrs_pair(p, q, r, s, h);
-    return alfa_vvoo_list[pqrs_pair];
+    auto it = alfa_vvoo_list.find(pqrs_pair);
+    return it != alfa_vvoo_list.end() ? it->second : empty_list_;
 }
 
 /**
@@ -49,11 +51,13 @@ std::vector<StringSubstitution>& StringLists::get_alfa_vvoo_list(size_t p, size_
 std::vector<StringSubstitution>& StringLists::get_beta_vvoo_list(size_t p, size_t q, size_t r,
                                                                  size_t s, int h) {
     std::tuple<size_t, size_t, size_t, size_t, int> pqrs_pair(p, q, r, s, h);
-    return beta_vvoo_list[pqrs_pair];
+    auto it = beta_vvoo_list.find(pqrs_pair);
+    return it != beta_vvoo_list.end() ? it->second : empty_list_;
 }
 
 void StringLists::make_vvoo_list(GraphPtr graph, VVOOList& list) {
     // Loop over irreps of the pair pq
+    std::vector<std::array<int, 4>> pqrs_list;
     for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
         int rs_sym = pq_sym;
         // Loop over irreps of p,r
@@ -72,7 +76,7 @@ void StringLists::make_vvoo_list(GraphPtr graph, VVOOList& list) {
                                 if ((p_abs > q_abs) && (r_abs > s_abs)) {
                                     // Avoid
                                     if (not((p_abs == r_abs) and (q_abs == s_abs))) {
-                                        make_vvoo(graph, list, p_abs, q_abs, r_abs, s_abs);
+                                        pqrs_list.push_back({p_abs, q_abs, r_abs, s_abs});
                                     }
                                 }
                             }
@@ -82,6 +86,10 @@ void StringLists::make_vvoo_list(GraphPtr graph, VVOOList& list) {
             }
         }
     }
+    // each quadruple pqrs generates the keys (p, q, r, s, h) for all h
+    make_list_parallel(pqrs_list, list, [&](const std::array<int, 4>& pqrs, VVOOList& local) {
+        make_vvoo(graph, local, pqrs[0], pqrs[1], pqrs[2], pqrs[3]);
+    });
 }
 
 /**
@@ -188,8 +196,9 @@ void StringLists::make_vvoo(GraphPtr graph, VVOOList& list, int p, int q, int r,
                                 if (J[i])
                                     sign *= -1;
 
-                            list[pqrs_pair].push_back(
-                                StringSubstitution(sign, graph->rel_add(I), graph->rel_add(J)));
+                            if (graph->allowed(I) and graph->allowed(J))
+                                list[pqrs_pair].push_back(StringSubstitution(
+                                    sign, graph->rel_add(I), graph->rel_add(J)));
                         }
                     }
                 }
@@ -203,6 +212,7 @@ void StringLists::make_vvoo(GraphPtr graph, VVOOList& list, int p, int q, int r,
 
 void StringLists::make_vovo_list(GraphPtr graph, VOVOList& list) {
     // Loop over irreps of the pair pq
+    std::vector<std::array<int, 4>> pqrs_list;
     for (int pq_sym = 0; pq_sym < nirrep_; ++pq_sym) {
         int rs_sym = pq_sym;
         // Loop over irreps of p,r
@@ -218,7 +228,7 @@ void StringLists::make_vovo_list(GraphPtr graph, VOVOList& list) {
                                 int q_abs = q_rel + cmopi_offset_[q_sym];
                                 int r_abs = r_rel + cmopi_offset_[r_sym];
                                 int s_abs = s_rel + cmopi_offset_[s_sym];
-                                make_VOVO(graph, list, p_abs, q_abs, r_abs, s_abs);
+                                pqrs_list.push_back({p_abs, q_abs, r_abs, s_abs});
                             }
                         }
                     }
@@ -226,6 +236,9 @@ void StringLists::make_vovo_list(GraphPtr graph, VOVOList& list) {
             }
         }
     }
+    make_list_parallel(pqrs_list, list, [&](const std::array<int, 4>& pqrs, VOVOList& local) {
+        make_VOVO(graph, local, pqrs[0], pqrs[1], pqrs[2], pqrs[3]);
+    });
 }
 
 /**
@@ -277,9 +290,10 @@ void StringLists::make_VOVO(GraphPtr graph, VOVOList& list, int p, int q, int r,
                                 for (int i = 0; i < p; ++i)
                                     if (J[i])
                                         sign *= -1;
-                                // Add the sting only of irrep(I) is h
-                                list[pqrs_pair].push_back(
-                                    StringSubstitution(sign, graph->rel_add(I), graph->rel_add(J)));
+                                // Add the sting only of irrep(I) is h and I, J are allowed
+                                if (graph->allowed(I) and graph->allowed(J))
+                                    list[pqrs_pair].push_back(StringSubstitution(
+                                        sign, graph->rel_add(I), graph->rel_add(J)));
                             }
                         }
                     }
@@ -300,7 +314,8 @@ void StringLists::make_VOVO(GraphPtr graph, VOVOList& list, int p, int q, int r,
 std::vector<StringSubstitution>& StringLists::get_alfa_vovo_list(size_t p, size_t q, size_t r,
                                                                  size_t s, int h) {
     std::tuple<size_t, size_t, size_t, size_t, int> pqrs_pair(p, q, r, s, h);
-    return alfa_vovo_list[pqrs_pair];
+    auto it = alfa_vovo_list.find(pqrs_pair);
+    return it != alfa_vovo_list.end() ? it->second : empty_list_;
 }
 
 /**
@@ -311,7 +326,8 @@ std::vector<StringSubstitution>& StringLists::get_alfa_vovo_list(size_t p, size_
 std::vector<StringSubstitution>& StringLists::get_beta_vovo_list(size_t p, size_t q, size_t r,
                                                                  size_t s, int h) {
     std::tuple<size_t, size_t, size_t, size_t, int> pqrs_pair(p, q, r, s, h);
-    return beta_vovo_list[pqrs_pair];
+    auto it = beta_vovo_list.find(pqrs_pair);
+    return it != beta_vovo_list.end() ? it->second : empty_list_;
 }
 } // namespace forte
 
@@ -68,6 +68,7 @@ void FiniteTemperatureHF::startup() {
     nirrep_ = this->nirrep();
 
     debug_ = options_.get_int("PRINT");
+    temperature_ = options_.get_double("TEMPERATURE");
     psi::SharedMatrix C(this->Ca()->clone());
 }
 
@@ -94,9 +95,28 @@ double FiniteTemperatureHF::compute_energy() {
 
     return scf_energy_;
 }
+std::vector<double>
+FiniteTemperatureHF::compute_energy_sweep(const std::vector<double>& temperatures) {
+    std::vector<double> energies;
+    for (double T : temperatures) {
+        temperature_ = T;
+        if (not energies.empty()) {
+            // start from the orbitals converged at the previous temperature
+            guess_Ca(Ca_->clone());
+            guess_Cb(Ca_->clone());
+        }
+        outfile->Printf("\n  FT-HF at T = %12.4f K", temperature_);
+        energies.push_back(compute_energy());
+    }
+
+    print_h2("FT-HF Temperature Sweep");
+    for (size_t n = 0; n < temperatures.size(); ++n) {
+        outfile->Printf("\n  %12.4f K  %20.12f", temperatures[n], energies[n]);
+    }
+    return energies;
+}
 void FiniteTemperatureHF::frac_occupation() {
-    double T = 0.0;
-    T = options_.get_double("TEMPERATURE");
+    double T = temperature_;
     if (debug_ > 1) {
         outfile->Printf("\n Running a Temperature of %8.8f", T);
     }
@@ -196,7 +216,6 @@ double FiniteTemperatureHF::bisection(std::vector<double>& ni, double T) {
     while (iter < 500) {
         ef = ef1 + (ef2 - ef1) / 2.0;
 
-        sum = 0.0;
         sum = occ_vec(nibisect, ef, T);
 
         if (std::fabs((sum - naelec)) < 1e-2 || std::fabs(ef2 - ef1) / 2.0 < 1e-6) {
@@ -208,10 +227,7 @@ double FiniteTemperatureHF::bisection(std::vector<double>& ni, double T) {
 
         iter++;
 
-        sumef = 0.0;
-        sumef = occ_vec(nibisect, ef, T);
-
-        sumef1 = 0.0;
+        sumef = sum;
         sumef1 = occ_vec(nibisect, ef1, T);
 
         auto sign = [](double a, double b) { return a * b > 0; };
@@ -243,13 +259,19 @@ double FiniteTemperatureHF::bisection(std::vector<double>& ni, double T) {
     return ef;
 }
 double FiniteTemperatureHF::occ_vec(std::vector<double>& nibisect, double ef, double T) {
+    // Fermi Dirac distribution - 1.0 / (1.0 + exp(\beta (e_i - ef))), computed in the order of
+    // the sorted orbital energies so that the loop vectorizes
+    size_t n = nibisect.size();
+    double beta = 1.0 / (0.99994 * T);
+    std::vector<double> fi(n);
     double sum = 0.0;
-    for (size_t i = 0; i < nibisect.size(); i++) {
-        // Fermi Dirac distribution - 1.0 / (1.0 + exp(\beta (e_i - ef)))
-        double fi = 1.0 / (1.0 + exp(1.0 / (0.99994 * T) * (active_orb_energy_[i].first - ef)));
-
-        nibisect[active_orb_energy_[i].second] = fi;
-        sum += nibisect[i];
+#pragma omp simd reduction(+ : sum)
+    for (size_t i = 0; i < n; i++) {
+        fi[i] = 1.0 / (1.0 + std::exp(beta * (active_orb_energy_[i].first - ef)));
+        sum += fi[i];
+    }
+    for (size_t i = 0; i < n; i++) {
+        nibisect[active_orb_energy_[i].second] = fi[i];
     }
 
     return sum;
@@ -260,13 +282,15 @@ void FiniteTemperatureHF::form_G() {
     }
     frac_occupation();
     form_D();
-    std::shared_ptr<JK> JK = JK::build_JK(this->basisset(), get_basisset("DF_BASIS_SCF"), options_);
-    JK->set_memory(psi::Process::environment.get_memory() * 0.8);
-    JK->set_cutoff(options_.get_double("INTEGRAL_SCREENING"));
-    JK->initialize();
+    if (not jk_) {
+        jk_ = JK::build_JK(this->basisset(), get_basisset("DF_BASIS_SCF"), options_);
+        jk_->set_memory(psi::Process::environment.get_memory() * 0.8);
+        jk_->set_cutoff(options_.get_double("INTEGRAL_SCREENING"));
+        jk_->initialize();
+    }
 
-    std::vector<std::shared_ptr<psi::Matrix>>& Cl = JK->C_left();
-    std::vector<std::shared_ptr<psi::Matrix>>& Cr = JK->C_right();
+    std::vector<std::shared_ptr<psi::Matrix>>& Cl = jk_->C_left();
+    std::vector<std::shared_ptr<psi::Matrix>>& Cr = jk_->C_right();
 
     Cl.clear();
     if (nmo_ > 0) {
@@ -278,10 +302,10 @@ void FiniteTemperatureHF::form_G() {
     Cr.clear();
     Cr.push_back(C_occ_a_);
 
-    JK->compute();
+    jk_->compute();
 
-    psi::SharedMatrix J_core = JK->J()[0];
-    psi::SharedMatrix K_core = JK->K()[0];
+    psi::SharedMatrix J_core = jk_->J()[0];
+    psi::SharedMatrix K_core = jk_->K()[0];
 
     J_core->scale(2.0);
     psi::SharedMatrix F_core = J_core->clone();
@@ -32,6 +32,7 @@
 
 #include "psi4/libmints/wavefunction.h"
 #include "psi4/libmints/matrix.h"
+#include "psi4/libfock/jk.h"
 #include <vector>
 #include "psi4/psi4-dec.h"
 
@@ -103,6 +104,10 @@ class FiniteTemperatureHF : public scf::RHF {
     double occ_vec(std::vector<double>& bisect, double ef, double T);
     // The fermi level (n_i = N - solved using bisection method)
     double ef_ = 0.0;
+    /// The current temperature (K)
+    double temperature_ = 0.0;
+    /// The JK object, built once and reused by all the iterations and temperatures
+    std::shared_ptr<psi::JK> jk_;
     double scf_energy_ = 0.0;
     /// A function for computing the SCF iterations
     void scf_iteration(const std::shared_ptr<psi::Matrix> C_left);
@@ -131,6 +136,9 @@ class FiniteTemperatureHF : public scf::RHF {
     double get_scf_energy() { return scf_energy_; }
     std::shared_ptr<psi::Matrix> get_mo_coefficient() { return CMatrix_; }
     double compute_energy();
+    /// Compute the FT-HF energy for a list of temperatures. The JK object and the converged
+    /// orbitals of each temperature (guess for the next one) are reused
+    std::vector<double> compute_energy_sweep(const std::vector<double>& temperatures);
 };
 }
 }
@@ -232,4 +232,40 @@ void BlockedTensorFactory::memory_summary_per_block(ambit::BlockedTensor& tensor
         outfile->Printf("\n %s   %8.8f GB", block.c_str(), memory_per_block);
     }
 }
+ambit::BlockedTensor BlockedTensorPool::build(ambit::TensorType type, const std::string& name,
+                                              const std::vector<std::string>& blocks) {
+    Key key(type, blocks);
+    ambit::BlockedTensor T;
+    auto it = free_.find(key);
+    if (it != free_.end() and !it->second.empty()) {
+        T = it->second.back();
+        it->second.pop_back();
+        T.set_name(name);
+        T.zero();
+    } else {
+        T = ambit::BlockedTensor::build(type, name, blocks);
+        nallocations_++;
+    }
+    in_use_.emplace_back(std::move(key), T);
+    return T;
+}
+
+void BlockedTensorPool::release(size_t begin) {
+    while (in_use_.size() > begin) {
+        auto& entry = in_use_.back();
+        free_[entry.first].push_back(entry.second);
+        in_use_.pop_back();
+    }
+}
+
+size_t BlockedTensorPool::free_numel() const {
+    size_t numel = 0;
+    for (const auto& [key, tensors] : free_) {
+        for (const auto& T : tensors) {
+            numel += T.numel();
+        }
+    }
+    return numel;
+}
+
 } // namespace forte
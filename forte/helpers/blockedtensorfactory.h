@@ -33,6 +33,8 @@
 /// to matrix factory.
 /// All blockedTensor functions with strings should be placed here
 /// Creates MO SPACES
+#include <map>
+#include <string>
 #include <vector>
 #include <tuple>
 
@@ -119,6 +121,56 @@ class BlockedTensorFactory {
                                               int how_many_active);
     std::map<std::string, std::vector<size_t>> get_mo_to_index() { return molabel_to_index_; }
 };
-}
+
+/**
+ * @brief A pool of temporary BlockedTensors
+ *
+ * build() returns a zeroed tensor with the requested blocks and reuses the storage of a tensor
+ * released by a previous Scope with the same type and blocks when there is one. All the tensors
+ * built while a Scope object is alive are returned to the pool when it is destroyed, so they must
+ * not be used after the end of the scope. Scopes must be nested (one per function is the usual
+ * pattern). Tensors built outside of any scope are never recycled.
+ *
+ * In iterative methods the same temporaries are requested at every iteration, so that after the
+ * first one no new tensors are allocated. This class is not thread safe.
+ */
+class BlockedTensorPool {
+  public:
+    /// Returns the tensors built during its lifetime to the pool
+    class Scope {
+      public:
+        explicit Scope(BlockedTensorPool& pool) : pool_(pool), begin_(pool.in_use_.size()) {}
+        ~Scope() { pool_.release(begin_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        BlockedTensorPool& pool_;
+        size_t begin_;
+    };
+
+    /// @return a zeroed tensor with the given type, name, and blocks
+    ambit::BlockedTensor build(ambit::TensorType type, const std::string& name,
+                               const std::vector<std::string>& blocks);
+    /// Free the storage of the tensors that are not in use
+    void clear() { free_.clear(); }
+    /// @return the number of tensors allocated by the pool
+    size_t nallocations() const { return nallocations_; }
+    /// @return the number of elements of the tensors that are not in use
+    size_t free_numel() const;
+
+  private:
+    using Key = std::pair<ambit::TensorType, std::vector<std::string>>;
+    /// The tensors available for reuse
+    std::map<Key, std::vector<ambit::BlockedTensor>> free_;
+    /// The tensors handed out, in the order they were built
+    std::vector<std::pair<Key, ambit::BlockedTensor>> in_use_;
+    /// The number of tensors allocated
+    size_t nallocations_ = 0;
+
+    /// Return the tensors in_use_[begin:] to the pool
+    void release(size_t begin);
+};
+} // namespace forte
 
 #endif // BLOCKEDTENSORFACTORY_H
@@ -0,0 +1,252 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+#include "helpers/subspace_vectors.h"
+
+#include "helpers/compressed_diis.h"
+
+namespace forte {
+
+CompressedDIIS::CompressedDIIS(const std::string& name, size_t max_vec,
+                               const std::vector<size_t>& sizes, Precision precision,
+                               RemovalPolicy policy, bool out_of_core)
+    : sizes_(sizes), max_vec_(max_vec), precision_(precision), policy_(policy) {
+    if (max_vec_ == 0) {
+        throw std::runtime_error("CompressedDIIS: the maximum number of entries must be positive");
+    }
+    for (size_t size : sizes_) {
+        offsets_.push_back(size_);
+        size_ += size;
+    }
+
+    // single-precision entries are packed two per double
+    size_t stored_size = precision_ == Precision::Float ? (size_ + 1) / 2 : size_;
+    errors_ = std::make_unique<SubspaceVectors>(name + ".err", max_vec_, stored_size, out_of_core);
+    vectors_ = std::make_unique<SubspaceVectors>(name + ".vec", max_vec_, stored_size, out_of_core);
+
+    last_vector_.assign(size_, 0.0);
+    B_.assign(max_vec_ * max_vec_, 0.0);
+    age_.assign(max_vec_, 0);
+}
+
+CompressedDIIS::~CompressedDIIS() = default;
+
+size_t CompressedDIIS::memory() const { return errors_->memory() + vectors_->memory(); }
+
+CompressedDIIS::Precision CompressedDIIS::precision_from_string(const std::string& str) {
+    if (str == "DOUBLE") {
+        return Precision::Double;
+    } else if (str == "FLOAT") {
+        return Precision::Float;
+    }
+    throw std::runtime_error("CompressedDIIS: unknown precision " + str);
+}
+
+template <typename T> T* CompressedDIIS::entry(SubspaceVectors& store, size_t n) {
+    return reinterpret_cast<T*>(store[n]);
+}
+
+void CompressedDIIS::add_entry(const std::vector<double*>& error,
+                               const std::vector<double*>& vector) {
+    if (error.size() != sizes_.size() or vector.size() != sizes_.size()) {
+        throw std::runtime_error("CompressedDIIS: inconsistent number of blocks");
+    }
+
+    // pick the slot of the new entry
+    size_t slot = nentry_;
+    if (nentry_ < max_vec_) {
+        nentry_ += 1;
+    } else if (policy_ == RemovalPolicy::LargestError) {
+        slot = 0;
+        for (size_t i = 1; i < nentry_; ++i) {
+            if (B_[i * max_vec_ + i] > B_[slot * max_vec_ + slot])
+                slot = i;
+        }
+    } else {
+        slot = std::min_element(age_.begin(), age_.begin() + nentry_) - age_.begin();
+    }
+    age_[slot] = counter_++;
+
+    if (precision_ == Precision::Float) {
+        add_entry_impl<float>(slot, error, vector);
+    } else {
+        add_entry_impl<double>(slot, error, vector);
+    }
+}
+
+template <typename T>
+void CompressedDIIS::add_entry_impl(size_t slot, const std::vector<double*>& error,
+                                    const std::vector<double*>& vector) {
+    // store the error vector and update the DIIS matrix from the stored values
+    T* e_slot = entry<T>(*errors_, slot);
+    for (size_t b = 0; b < sizes_.size(); ++b) {
+        std::transform(error[b], error[b] + sizes_[b], e_slot + offsets_[b],
+                       [](double x) { return static_cast<T>(x); });
+    }
+    for (size_t i = 0; i < nentry_; ++i) {
+        const T* e_i = entry<T>(*errors_, i);
+        double dot = 0.0;
+#pragma omp parallel for reduction(+ : dot)
+        for (size_t k = 0; k < size_; ++k) {
+            dot += static_cast<double>(e_i[k]) * static_cast<double>(e_slot[k]);
+        }
+        B_[i * max_vec_ + slot] = dot;
+        B_[slot * max_vec_ + i] = dot;
+        if (i != slot)
+            errors_->release(i);
+    }
+    errors_->release(slot);
+
+    // shift the differences of the other entries to the new reference last_vector_ = x_new:
+    // x_i - x_new = (x_i - x_last) + (x_last - x_new)
+    for (size_t b = 0; b < sizes_.size(); ++b) {
+        const double* x_new = vector[b];
+        double* x_last = last_vector_.data() + offsets_[b];
+        for (size_t i = 0; i < nentry_; ++i) {
+            if (i == slot)
+                continue;
+            T* d_i = entry<T>(*vectors_, i) + offsets_[b];
+#pragma omp parallel for
+            for (size_t k = 0; k < sizes_[b]; ++k) {
+                d_i[k] = static_cast<T>(static_cast<double>(d_i[k]) + (x_last[k] - x_new[k]));
+            }
+        }
+        std::copy(x_new, x_new + sizes_[b], x_last);
+        T* d_slot = entry<T>(*vectors_, slot) + offsets_[b];
+        std::fill(d_slot, d_slot + sizes_[b], static_cast<T>(0));
+    }
+    vectors_->release(0, nentry_, 0, vectors_->size());
+}
+
+void CompressedDIIS::extrapolate(const std::vector<double*>& vector) {
+    if (vector.size() != sizes_.size()) {
+        throw std::runtime_error("CompressedDIIS: inconsistent number of blocks");
+    }
+    if (nentry_ == 0) {
+        return;
+    }
+
+    // solve the scaled DIIS equations [B -1; -1 0] [c; l] = [0; -1]
+    size_t n = nentry_ + 1;
+    double scale = 0.0;
+    for (size_t i = 0; i < nentry_; ++i) {
+        scale = std::max(scale, B_[i * max_vec_ + i]);
+    }
+    scale = scale > 0.0 ? 1.0 / scale : 1.0;
+
+    std::vector<double> A(n * n, 0.0), c(n, 0.0);
+    for (size_t i = 0; i < nentry_; ++i) {
+        for (size_t j = 0; j < nentry_; ++j) {
+            A[i * n + j] = scale * B_[i * max_vec_ + j];
+        }
+        A[i * n + nentry_] = -1.0;
+        A[nentry_ * n + i] = -1.0;
+    }
+    c[nentry_] = -1.0;
+
+    // Gaussian elimination with partial pivoting
+    bool singular = false;
+    for (size_t p = 0; p < n and not singular; ++p) {
+        size_t piv = p;
+        for (size_t r = p + 1; r < n; ++r) {
+            if (std::fabs(A[r * n + p]) > std::fabs(A[piv * n + p]))
+                piv = r;
+        }
+        if (std::fabs(A[piv * n + p]) < 1.0e-14) {
+            singular = true;
+            break;
+        }
+        if (piv != p) {
+            std::swap_ranges(A.begin() + p * n, A.begin() + (p + 1) * n, A.begin() + piv * n);
+            std::swap(c[p], c[piv]);
+        }
+        for (size_t r = p + 1; r < n; ++r) {
+            double f = A[r * n + p] / A[p * n + p];
+            for (size_t q = p; q < n; ++q) {
+                A[r * n + q] -= f * A[p * n + q];
+            }
+            c[r] -= f * c[p];
+        }
+    }
+    if (not singular) {
+        for (size_t p = n; p-- > 0;) {
+            for (size_t q = p + 1; q < n; ++q) {
+                c[p] -= A[p * n + q] * c[q];
+            }
+            c[p] /= A[p * n + p];
+        }
+        c.resize(nentry_);
+    } else {
+        // linearly dependent error vectors: keep the most recent vector
+        c.assign(nentry_, 0.0);
+        c[std::max_element(age_.begin(), age_.begin() + nentry_) - age_.begin()] = 1.0;
+    }
+
+    // x = sum_i c_i x_i = x_last + sum_i c_i (x_i - x_last), since sum_i c_i = 1
+    for (size_t b = 0; b < sizes_.size(); ++b) {
+        std::copy(last_vector_.begin() + offsets_[b],
+                  last_vector_.begin() + offsets_[b] + sizes_[b], vector[b]);
+    }
+    if (precision_ == Precision::Float) {
+        extrapolate_impl<float>(c, vector);
+    } else {
+        extrapolate_impl<double>(c, vector);
+    }
+}
+
+template <typename T>
+void CompressedDIIS::extrapolate_impl(const std::vector<double>& c,
+                                      const std::vector<double*>& vector) {
+    for (size_t i = 0; i < nentry_; ++i) {
+        if (c[i] == 0.0)
+            continue;
+        const T* d_i = entry<T>(*vectors_, i);
+        for (size_t b = 0; b < sizes_.size(); ++b) {
+            double* x = vector[b];
+            const T* d = d_i + offsets_[b];
+#pragma omp parallel for
+            for (size_t k = 0; k < sizes_[b]; ++k) {
+                x[k] += c[i] * static_cast<double>(d[k]);
+            }
+        }
+        vectors_->release(i);
+    }
+}
+
+void CompressedDIIS::reset_subspace() {
+    nentry_ = 0;
+    counter_ = 0;
+    std::fill(B_.begin(), B_.end(), 0.0);
+    std::fill(age_.begin(), age_.end(), 0);
+}
+} // namespace forte
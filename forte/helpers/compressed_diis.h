@@ -0,0 +1,129 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _compressed_diis_h_
+#define _compressed_diis_h_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace forte {
+
+class SubspaceVectors;
+
+/**
+ * @brief The CompressedDIIS class
+ * A DIIS extrapolator that stores its history more compactly than psi::DIISManager.
+ *
+ * Only the most recent vector is kept in full (double) precision. The other entries are
+ * stored as their difference from it, which is small close to convergence, and the error
+ * vectors are stored as they are. With Precision::Float both are kept in single precision.
+ * The history can be placed in a scratch file (see SubspaceVectors) so that only the most
+ * recent vector and the small DIIS matrix stay in memory.
+ *
+ * The vectors are given as a list of blocks (pointers to contiguous data) whose sizes are
+ * fixed at construction, the same way the amplitude blocks are passed to psi::DIISManager.
+ */
+class CompressedDIIS {
+  public:
+    enum class Precision { Double, Float };
+    enum class RemovalPolicy { LargestError, OldestAdded };
+
+    // ==> Class Constructor and Destructor <==
+
+    /**
+     * @brief CompressedDIIS
+     * @param name The name used for the scratch files
+     * @param max_vec The maximum number of entries
+     * @param sizes The sizes of the blocks of a vector (and of an error vector)
+     * @param precision The precision of the stored entries
+     * @param policy Which entry is replaced when the history is full
+     * @param out_of_core Store the history in a scratch file?
+     */
+    CompressedDIIS(const std::string& name, size_t max_vec, const std::vector<size_t>& sizes,
+                   Precision precision, RemovalPolicy policy, bool out_of_core);
+
+    /// Destructor
+    ~CompressedDIIS();
+
+    CompressedDIIS(const CompressedDIIS&) = delete;
+    CompressedDIIS& operator=(const CompressedDIIS&) = delete;
+
+    // ==> Class Interface <==
+
+    /// Return the number of stored entries
+    int subspace_size() const { return static_cast<int>(nentry_); }
+    /// Return the number of bytes used by the history, excluding the most recent vector
+    size_t memory() const;
+
+    /// Add an entry, given the blocks of the error vector and of the vector
+    void add_entry(const std::vector<double*>& error, const std::vector<double*>& vector);
+    /// Write the extrapolated vector to the given blocks
+    void extrapolate(const std::vector<double*>& vector);
+    /// Remove all the entries
+    void reset_subspace();
+
+    /// Parse the precision from an option value ("DOUBLE" or "FLOAT")
+    static Precision precision_from_string(const std::string& str);
+
+  private:
+    /// Return a pointer to entry n of the stored error vectors or vectors
+    template <typename T> T* entry(SubspaceVectors& store, size_t n);
+    template <typename T>
+    void add_entry_impl(size_t slot, const std::vector<double*>& error,
+                        const std::vector<double*>& vector);
+    template <typename T>
+    void extrapolate_impl(const std::vector<double>& c, const std::vector<double*>& vector);
+
+    /// The block sizes and their offsets in the full vector
+    std::vector<size_t> sizes_;
+    std::vector<size_t> offsets_;
+    /// The size of the full vector
+    size_t size_ = 0;
+    /// The maximum number of entries
+    size_t max_vec_;
+    Precision precision_;
+    RemovalPolicy policy_;
+
+    /// Stored error vectors and differences of the vectors from last_vector_
+    std::unique_ptr<SubspaceVectors> errors_;
+    std::unique_ptr<SubspaceVectors> vectors_;
+    /// The most recent vector in double precision
+    std::vector<double> last_vector_;
+    /// The DIIS matrix B(i, j) = <e_i|e_j> of the stored entries
+    std::vector<double> B_;
+    /// The number of stored entries
+    size_t nentry_ = 0;
+    /// The order in which the entries were added
+    std::vector<size_t> age_;
+    size_t counter_ = 0;
+};
+} // namespace forte
+
+#endif // _compressed_diis_h_
@@ -32,6 +32,7 @@
 #include <regex>
 #include <cmath>
 #include <numeric>
+#include <stdexcept>
 
 #include "helpers/string_algorithms.h"
 
@@ -41,6 +42,23 @@ namespace forte {
 
 CubeFile::CubeFile(const std::string& filename) { load(filename); }
 
+CubeFile::CubeFile(const std::string& title, const std::string& comments,
+                   const std::vector<int>& atom_numbers,
+                   const std::vector<std::tuple<double, double, double>>& atom_coords,
+                   const std::vector<int>& num, const std::vector<double>& min,
+                   const std::vector<double>& inc, std::vector<double> data)
+    : title_(title), comments_(comments), natoms_(atom_numbers.size()),
+      atom_numbers_(atom_numbers), atom_coords_(atom_coords), num_(num), min_(min), inc_(inc),
+      data_(std::move(data)) {
+    for (int n = 0; n < 3; ++n) {
+        max_.push_back(min_[n] + num_[n] * inc_[n]);
+    }
+    if (data_.size() != static_cast<size_t>(num_[0]) * num_[1] * num_[2]) {
+        throw std::runtime_error(
+            "Number of data points is inconsistent with the grid in Cube file!");
+    }
+}
+
 int CubeFile::natoms() const { return natoms_; }
 const std::vector<int>& CubeFile::num() const { return num_; }
 const std::vector<double>& CubeFile::min() const { return min_; }
@@ -184,11 +202,26 @@ void CubeFile::save(std::string filename) const {
                 std::get<2>(atom_coords_[A]));
     }
 
-    // Data, striped (x, y, z)
-    for (size_t ind = 0, npoints = data_.size(); ind < npoints; ind++) {
-        fprintf(fh, "%12.5E ", data_[ind]);
-        if (ind % 6 == 5)
-            fprintf(fh, "\n");
+    // Data, striped (x, y, z). Lines of six values are formatted concurrently in chunks that
+    // are then written in order
+    const size_t npoints = data_.size();
+    const size_t chunk = 6 * 4096;
+    const size_t nchunks = (npoints + chunk - 1) / chunk;
+    std::vector<std::string> text(nchunks);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < nchunks; ++c) {
+        char buffer[32];
+        std::string& s = text[c];
+        s.reserve(14 * chunk);
+        for (size_t ind = c * chunk, end = std::min(npoints, (c + 1) * chunk); ind < end; ind++) {
+            snprintf(buffer, sizeof(buffer), "%12.5E ", data_[ind]);
+            s += buffer;
+            if (ind % 6 == 5)
+                s += '\n';
+        }
+    }
+    for (const auto& s : text) {
+        fwrite(s.data(), 1, s.size(), fh);
     }
 
     fclose(fh);
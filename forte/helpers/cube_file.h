@@ -30,6 +30,7 @@
 #define _cube_file_h_
 
 #include <string>
+#include <tuple>
 #include <vector>
 #include <utility>
 
@@ -54,6 +55,22 @@ class CubeFile {
      */
     CubeFile(const std::string& filename);
     CubeFile(const CubeFile& cube) = default;
+    /**
+     * @brief Build a CubeFile object from a grid and the values at its points
+     * @param title the title
+     * @param comments a comment
+     * @param atom_numbers the atomic numbers of the atoms
+     * @param atom_coords the (x,y,z) atomic coordinates
+     * @param num the number of grid points in each direction
+     * @param min the origin of the grid
+     * @param inc the grid increment in each direction
+     * @param data the grid points, striped (x, y, z)
+     */
+    CubeFile(const std::string& title, const std::string& comments,
+             const std::vector<int>& atom_numbers,
+             const std::vector<std::tuple<double, double, double>>& atom_coords,
+             const std::vector<int>& num, const std::vector<double>& min,
+             const std::vector<double>& inc, std::vector<double> data);
 
     /// @return the number of atoms
     int natoms() const;
@@ -0,0 +1,158 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "psi4/libmints/basisset.h"
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/molecule.h"
+#include "psi4/libqt/qt.h"
+
+#include "cube_grid.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace forte {
+
+std::vector<CubeFile> make_cube_files(psi::SharedWavefunction wfn, psi::SharedMatrix C,
+                                      const std::vector<psi::SharedMatrix>& densities,
+                                      double spacing, double overage, size_t block_size) {
+    auto basis = wfn->basisset();
+    auto mol = wfn->molecule();
+    const size_t nao = basis->nbf();
+    const size_t norb = C ? C->coldim() : 0;
+    const size_t ndens = densities.size();
+
+    if (C and static_cast<size_t>(C->rowdim()) != nao) {
+        throw std::runtime_error("make_cube_files: the orbitals must be given in the AO basis");
+    }
+    for (const auto& D : densities) {
+        if (static_cast<size_t>(D->rowdim()) != nao or static_cast<size_t>(D->coldim()) != nao) {
+            throw std::runtime_error(
+                "make_cube_files: the densities must be given in the AO basis");
+        }
+    }
+    block_size = std::max(size_t(1), block_size);
+
+    // the grid and the atoms
+    std::vector<int> atom_numbers;
+    std::vector<std::tuple<double, double, double>> atom_coords;
+    std::vector<double> xyz_min(3, 0.0), xyz_max(3, 0.0);
+    for (int A = 0; A < mol->natom(); ++A) {
+        auto r = mol->xyz(A);
+        atom_numbers.push_back(static_cast<int>(mol->Z(A)));
+        atom_coords.emplace_back(r[0], r[1], r[2]);
+        for (int k = 0; k < 3; ++k) {
+            xyz_min[k] = A == 0 ? r[k] : std::min(xyz_min[k], r[k]);
+            xyz_max[k] = A == 0 ? r[k] : std::max(xyz_max[k], r[k]);
+        }
+    }
+    std::vector<int> num(3);
+    std::vector<double> origin(3), inc(3, spacing);
+    for (int k = 0; k < 3; ++k) {
+        origin[k] = xyz_min[k] - overage;
+        double length = xyz_max[k] - xyz_min[k] + 2.0 * overage;
+        num[k] = static_cast<int>(std::ceil(length / spacing)) + 1;
+    }
+    const size_t npoints = static_cast<size_t>(num[0]) * num[1] * num[2];
+    const size_t nyz = static_cast<size_t>(num[1]) * num[2];
+
+    std::vector<std::vector<double>> values(norb + ndens, std::vector<double>(npoints, 0.0));
+
+    const size_t nblocks = (npoints + block_size - 1) / block_size;
+#pragma omp parallel
+    {
+        std::vector<double> phi(block_size * nao);
+        std::vector<double> orb_vals(block_size * std::max(norb, size_t(1)));
+        std::vector<double> DPhi(ndens > 0 ? block_size * nao : 0);
+
+#pragma omp for schedule(dynamic)
+        for (size_t b = 0; b < nblocks; ++b) {
+            const size_t start = b * block_size;
+            const size_t npts = std::min(block_size, npoints - start);
+
+            // the basis functions on all the points of the block, phi[p][mu]
+            for (size_t p = 0; p < npts; ++p) {
+                size_t ind = start + p;
+                size_t ix = ind / nyz;
+                size_t iy = (ind % nyz) / num[2];
+                size_t iz = ind % num[2];
+                basis->compute_phi(&phi[p * nao], origin[0] + ix * inc[0], origin[1] + iy * inc[1],
+                                   origin[2] + iz * inc[2]);
+            }
+
+            // orbitals: psi[p][i] = sum_mu phi[p][mu] C[mu][i]
+            if (norb > 0) {
+                C_DGEMM('N', 'N', npts, norb, nao, 1.0, phi.data(), nao, C->pointer()[0], norb,
+                        0.0, orb_vals.data(), norb);
+                for (size_t i = 0; i < norb; ++i) {
+                    auto& v = values[i];
+                    for (size_t p = 0; p < npts; ++p) {
+                        v[start + p] = orb_vals[p * norb + i];
+                    }
+                }
+            }
+
+            // densities: rho[p] = sum_mu,nu phi[p][mu] D[mu][nu] phi[p][nu]
+            for (size_t d = 0; d < ndens; ++d) {
+                C_DGEMM('N', 'N', npts, nao, nao, 1.0, phi.data(), nao, densities[d]->pointer()[0],
+                        nao, 0.0, DPhi.data(), nao);
+                auto& v = values[norb + d];
+                for (size_t p = 0; p < npts; ++p) {
+                    v[start + p] = C_DDOT(nao, &phi[p * nao], 1, &DPhi[p * nao], 1);
+                }
+            }
+        }
+    }
+
+    std::vector<CubeFile> cubes;
+    for (size_t n = 0; n < norb + ndens; ++n) {
+        std::string title = n < norb ? "Forte orbital " + std::to_string(n)
+                                     : "Forte density " + std::to_string(n - norb);
+        cubes.emplace_back(title, "Generated by Forte", atom_numbers, atom_coords, num, origin, inc,
+                           std::move(values[n]));
+    }
+    return cubes;
+}
+
+void save_cube_files(const std::vector<CubeFile>& cubes,
+                     const std::vector<std::string>& filenames) {
+    if (cubes.size() != filenames.size()) {
+        throw std::runtime_error("save_cube_files: the number of cubes and file names differ");
+    }
+    // each file is formatted in parallel by CubeFile::save, so the files are written in turn
+    for (size_t n = 0; n < cubes.size(); ++n) {
+        cubes[n].save(filenames[n]);
+    }
+}
+
+} // namespace forte
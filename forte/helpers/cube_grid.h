@@ -0,0 +1,69 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _cube_grid_h_
+#define _cube_grid_h_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "psi4/libmints/wavefunction.h"
+
+#include "helpers/cube_file.h"
+
+namespace forte {
+
+/**
+ * @brief Evaluate orbitals and densities on a cubic grid that encloses the molecule
+ *
+ * The grid is split into blocks of consecutive points that are processed concurrently. In each
+ * block the basis functions are evaluated once and contracted with all the orbitals (one DGEMM)
+ * and all the densities.
+ * @param wfn provides the molecule and the basis set
+ * @param C orbital coefficients in the AO basis (nao x norb), one cube per column (may be null)
+ * @param densities density matrices in the AO basis (nao x nao), one cube per matrix
+ * @param spacing the grid spacing in each direction (bohr)
+ * @param overage the extra space around the molecule in each direction (bohr)
+ * @param block_size the number of grid points in a block
+ * @return the orbital cubes followed by the density cubes
+ */
+std::vector<CubeFile> make_cube_files(psi::SharedWavefunction wfn, psi::SharedMatrix C,
+                                      const std::vector<psi::SharedMatrix>& densities,
+                                      double spacing = 0.2, double overage = 4.0,
+                                      size_t block_size = 1000);
+
+/// Save several cube files (the text of each file is formatted in parallel)
+/// @param cubes the cube files
+/// @param filenames the file names, one for each cube
+void save_cube_files(const std::vector<CubeFile>& cubes,
+                     const std::vector<std::string>& filenames);
+
+} // namespace forte
+
+#endif // _cube_grid_h_
@@ -26,10 +26,14 @@
  * @END LICENSE
  */
 
+#include <cstring>
 #include <numeric>
 #include <iostream>
 #include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "psi4/psi4-dec.h"
 
@@ -92,103 +96,435 @@ void read_disk_vector_double(const std::string& filename, std::vector<double>& d
     in.close();
 }
 
-//std::string write_disk_BT(ambit::BlockedTensor& BT, const std::string& name,
-//                          const std::string& file_prefix) {
-//    auto block_labels = BT.block_labels();
-//    std::vector<std::string> block_file_names;
-//    block_file_names.reserve(block_labels.size());
-
-//    for (const std::string& block : block_labels) {
-//        size_t nele = BT.block(block).numel();
-
-//        // need to deal with case insensitivity
-//        std::string block_lowercase, spin;
-//        for (const char& i : block) {
-//            if (isupper(i)) {
-//                block_lowercase += tolower(i);
-//                spin += 'b';
-//            } else {
-//                block_lowercase += i;
-//                spin += 'a';
-//            }
-//        }
-
-//        std::string filename = file_prefix;
-//        for (const std::string& s : {name, block_lowercase, spin, std::string("bin")}) {
-//            filename += "." + s;
-//        }
-//        block_file_names.push_back(block + " " + filename + " " + std::to_string(nele));
-
-//        write_disk_vector_double(filename, BT.block(block).data(), true);
-//    }
-
-//    // write master file
-//    std::ofstream of;
-//    std::string file_path = file_prefix + "." + name + ".master.txt";
-//    of.open(file_path, std::ios::trunc);
-//    for (const std::string& str : block_file_names) {
-//        of << str << std::endl;
-//    }
-//    of.close();
-//    return file_path;
-//}
-
-//void read_disk_BT(ambit::BlockedTensor& BT, const std::string& filename) {
-//    // read master file info for each block
-//    std::ifstream infile(filename);
-//    if (!infile.good()) {
-//        std::string error = "File " + filename + " does not exist.";
-//        throw psi::PSIEXCEPTION(error.c_str());
-//    }
-
-//    std::string line;
-//    while (std::getline(infile, line)) {
-//        std::istringstream iss(line);
-//        std::string block, filename;
-//        size_t nele;
-//        iss >> block >> filename >> nele;
-
-//        // test if sizes match
-//        if (nele != BT.block(block).numel()) {
-//            std::string msg = "Number of elements do NOT match: ";
-//            msg += BT.name() + "(" + std::to_string(BT.block(block).numel()) + "); ";
-//            msg += filename + "(" + std::to_string(nele) + ")";
-//            throw PSIEXCEPTION(msg);
-//        }
-
-//        // read data
-//        read_disk_vector_double(filename, BT.block(block).data());
-//    }
-
-//    infile.close();
-//}
-
-//void delete_disk_BT(const std::string& filename) {
-//    std::ifstream infile(filename);
-//    if (!infile.good()) {
-//        std::string error = "File " + filename + " does not exist.";
-//        throw psi::PSIEXCEPTION(error.c_str());
-//    }
-
-//    // delete every block
-//    std::string line;
-//    while (std::getline(infile, line)) {
-//        std::istringstream iss(line);
-//        std::string block, filename_block;
-//        size_t nele;
-//        iss >> block >> filename_block >> nele;
-
-//        if (remove(filename_block.c_str()) != 0) {
-//            std::string msg = "Error when deleting " + filename_block;
-//            perror(msg.c_str());
-//        }
-//    }
-//    infile.close();
-
-//    // delete the master file
-//    if (remove(filename.c_str()) != 0) {
-//        std::string msg = "Error when deleting " + filename;
-//        perror(msg.c_str());
-//    }
-//}
+TensorBlockWriter::TensorBlockWriter(const std::string& filename, const std::vector<size_t>& dims)
+    : filename_(filename), out_(filename.c_str(), std::ios_base::binary | std::ios_base::trunc) {
+    if (dims.empty()) {
+        throw psi::PSIEXCEPTION("TensorBlockWriter: the tensor must have at least one index");
+    }
+    if (!out_.good()) {
+        std::string error = "Cannot open " + filename + " for writing.";
+        throw psi::PSIEXCEPTION(error.c_str());
+    }
+    nblocks_ = dims[0];
+    block_size_ = std::accumulate(dims.begin() + 1, dims.end(), size_t(1), std::multiplies<>());
+
+    // header: rank and dimensions
+    size_t rank = dims.size();
+    out_.write(reinterpret_cast<const char*>(&rank), sizeof(size_t));
+    out_.write(reinterpret_cast<const char*>(dims.data()), rank * sizeof(size_t));
+}
+
+void TensorBlockWriter::write_block(const double* block) {
+    if (nwritten_ == nblocks_) {
+        std::string error = "TensorBlockWriter: too many blocks written to " + filename_;
+        throw psi::PSIEXCEPTION(error.c_str());
+    }
+    out_.write(reinterpret_cast<const char*>(block), block_size_ * sizeof(double));
+    nwritten_++;
+}
+
+void TensorBlockWriter::close() {
+    if (nwritten_ != nblocks_) {
+        std::string error = "TensorBlockWriter: " + std::to_string(nwritten_) + " of " +
+                            std::to_string(nblocks_) + " blocks written to " + filename_;
+        throw psi::PSIEXCEPTION(error.c_str());
+    }
+    out_.close();
+}
+
+void write_tensor_blocks(const ambit::Tensor& t, const std::string& filename) {
+    TensorBlockWriter writer(filename, t.dims());
+    const auto& data = t.data();
+    for (size_t p = 0, nblocks = t.dim(0); p < nblocks; ++p) {
+        writer.write_block(data.data() + p * writer.block_size());
+    }
+    writer.close();
+}
+
+TensorBlockReader::TensorBlockReader(const std::string& filename)
+    : filename_(filename), in_(filename.c_str(), std::ios_base::binary) {
+    if (!in_.good()) {
+        std::string error = "File " + filename + " does not exist.";
+        throw psi::PSIEXCEPTION(error.c_str());
+    }
+    size_t rank;
+    in_.read(reinterpret_cast<char*>(&rank), sizeof(size_t));
+    dims_.resize(rank);
+    in_.read(reinterpret_cast<char*>(dims_.data()), rank * sizeof(size_t));
+    block_size_ = std::accumulate(dims_.begin() + 1, dims_.end(), size_t(1), std::multiplies<>());
+    data_offset_ = in_.tellg();
+}
+
+void TensorBlockReader::read_block(size_t p, std::vector<double>& block) {
+    if (p >= nblocks()) {
+        throw psi::PSIEXCEPTION("TensorBlockReader: block index out of range");
+    }
+    block.resize(block_size_);
+    in_.seekg(data_offset_ + static_cast<std::streamoff>(p * block_size_ * sizeof(double)));
+    in_.read(reinterpret_cast<char*>(block.data()), block_size_ * sizeof(double));
+    if (!in_.good()) {
+        std::string error = "TensorBlockReader: error reading block of " + filename_;
+        throw psi::PSIEXCEPTION(error.c_str());
+    }
+}
+
+namespace {
+
+constexpr char chunked_file_magic[8] = {'F', 'O', 'R', 'T', 'E', 'C', 'F', '1'};
+
+/// Encode n doubles: each value is XOR-ed with the previous one and stored as a header byte
+/// (number of leading zero bytes << 4 | number of trailing zero bytes) followed by the remaining
+/// bytes. If drop_bits > 0, the mantissa is first rounded to 52 - drop_bits bits.
+void encode_xor(const double* x, size_t n, int drop_bits, std::vector<char>& out) {
+    out.resize(9 * n);
+    const uint64_t round = drop_bits > 0 ? uint64_t(1) << (drop_bits - 1) : 0;
+    const uint64_t mask = drop_bits > 0 ? ~((uint64_t(1) << drop_bits) - 1) : ~uint64_t(0);
+    uint64_t prev = 0;
+    char* p = out.data();
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t u;
+        std::memcpy(&u, x + i, sizeof(uint64_t));
+        // leave infinities and NaNs alone
+        if (drop_bits > 0 and ((u >> 52) & 0x7ff) != 0x7ff) {
+            u = (u + round) & mask;
+        }
+        uint64_t v = u ^ prev;
+        prev = u;
+        if (v == 0) {
+            *p++ = static_cast<char>(8 << 4);
+            continue;
+        }
+        int lz = __builtin_clzll(v) / 8;
+        int tz = __builtin_ctzll(v) / 8;
+        *p++ = static_cast<char>((lz << 4) | tz);
+        for (int b = tz; b < 8 - lz; ++b) {
+            *p++ = static_cast<char>((v >> (8 * b)) & 0xff);
+        }
+    }
+    out.resize(p - out.data());
+}
+
+void decode_xor(const char* in, size_t bytes, double* x, size_t n) {
+    const char* p = in;
+    const char* end = in + bytes;
+    uint64_t prev = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (p >= end) {
+            throw psi::PSIEXCEPTION("ChunkedFileReader: corrupted chunk");
+        }
+        unsigned char h = static_cast<unsigned char>(*p++);
+        int lz = h >> 4;
+        int tz = h & 0xf;
+        uint64_t v = 0;
+        if (lz < 8) {
+            if (p + (8 - lz - tz) > end) {
+                throw psi::PSIEXCEPTION("ChunkedFileReader: corrupted chunk");
+            }
+            for (int b = tz; b < 8 - lz; ++b) {
+                v |= static_cast<uint64_t>(static_cast<unsigned char>(*p++)) << (8 * b);
+            }
+        }
+        prev ^= v;
+        std::memcpy(x + i, &prev, sizeof(uint64_t));
+    }
+}
+
+void write_u64(std::ofstream& out, uint64_t v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(uint64_t));
+}
+
+/// Read an unsigned integer from a mapped file at position pos, checking the bounds
+uint64_t read_u64(const char* base, size_t size, size_t& pos, const std::string& filename) {
+    if (pos + sizeof(uint64_t) > size) {
+        throw psi::PSIEXCEPTION("ChunkedFileReader: truncated index in " + filename);
+    }
+    uint64_t v;
+    std::memcpy(&v, base + pos, sizeof(uint64_t));
+    pos += sizeof(uint64_t);
+    return v;
+}
+
+} // namespace
+
+ChunkedFileWriter::ChunkedFileWriter(const std::string& filename, DiskCompression compression,
+                                     int mantissa_bits, size_t chunk_size)
+    : filename_(filename), out_(filename.c_str(), std::ios_base::binary | std::ios_base::trunc),
+      compression_(compression), mantissa_bits_(mantissa_bits), chunk_size_(chunk_size) {
+    if (!out_.good()) {
+        std::string error = "Cannot open " + filename + " for writing.";
+        throw psi::PSIEXCEPTION(error.c_str());
+    }
+    if (mantissa_bits < 0 or mantissa_bits > 52) {
+        throw psi::PSIEXCEPTION("ChunkedFileWriter: mantissa_bits must be between 0 and 52");
+    }
+    if (chunk_size == 0) {
+        throw psi::PSIEXCEPTION("ChunkedFileWriter: chunk_size must be positive");
+    }
+    out_.write(chunked_file_magic, sizeof(chunked_file_magic));
+    offset_ = sizeof(chunked_file_magic);
+}
+
+ChunkedFileWriter::~ChunkedFileWriter() {
+    if (not closed_) {
+        try {
+            close();
+        } catch (const std::exception& e) {
+            std::cerr << "ChunkedFileWriter: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ChunkedFileWriter::begin_record(const std::string& name) {
+    if (in_record_) {
+        throw psi::PSIEXCEPTION("ChunkedFileWriter: begin_record called twice for " + name);
+    }
+    // the chunk in flight refers to the last record
+    flush();
+    for (const auto& record : records_) {
+        if (record.name == name) {
+            throw psi::PSIEXCEPTION("ChunkedFileWriter: duplicate record " + name + " in " +
+                                    filename_);
+        }
+    }
+    records_.push_back({name, {}});
+    in_record_ = true;
+}
+
+void ChunkedFileWriter::append(const double* data, size_t n) {
+    if (not in_record_) {
+        throw psi::PSIEXCEPTION("ChunkedFileWriter: append called outside of a record");
+    }
+    // double buffering: wait for the previous chunk, then hand over this one
+    flush();
+    pending_data_.assign(data, data + n);
+    pending_ = std::async(std::launch::async, [this, n]() {
+        std::vector<char> encoded;
+        const char* bytes = reinterpret_cast<const char*>(pending_data_.data());
+        size_t nbytes = n * sizeof(double);
+        if (compression_ != DiskCompression::None) {
+            int drop_bits = compression_ == DiskCompression::Truncated ? 52 - mantissa_bits_ : 0;
+            encode_xor(pending_data_.data(), n, drop_bits, encoded);
+            bytes = encoded.data();
+            nbytes = encoded.size();
+        }
+        out_.write(bytes, nbytes);
+        if (not out_.good()) {
+            throw psi::PSIEXCEPTION("ChunkedFileWriter: error writing to " + filename_);
+        }
+        records_.back().chunks.push_back({offset_, nbytes, n});
+        offset_ += nbytes;
+    });
+}
+
+void ChunkedFileWriter::end_record() {
+    if (not in_record_) {
+        throw psi::PSIEXCEPTION("ChunkedFileWriter: end_record called outside of a record");
+    }
+    in_record_ = false;
+}
+
+void ChunkedFileWriter::write(const std::string& name, const double* data, size_t n) {
+    begin_record(name);
+    for (size_t start = 0; start < n; start += chunk_size_) {
+        append(data + start, std::min(chunk_size_, n - start));
+    }
+    end_record();
+}
+
+void ChunkedFileWriter::flush() {
+    if (pending_.valid()) {
+        pending_.get();
+    }
+    out_.flush();
+}
+
+void ChunkedFileWriter::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    if (in_record_) {
+        end_record();
+    }
+    flush();
+
+    // index: compression type, records, and the offset of the index
+    uint64_t index_offset = offset_;
+    write_u64(out_, static_cast<uint64_t>(compression_));
+    write_u64(out_, records_.size());
+    for (const auto& record : records_) {
+        write_u64(out_, record.name.size());
+        out_.write(record.name.data(), record.name.size());
+        write_u64(out_, record.chunks.size());
+        for (const auto& chunk : record.chunks) {
+            write_u64(out_, chunk.offset);
+            write_u64(out_, chunk.bytes);
+            write_u64(out_, chunk.nelem);
+        }
+    }
+    write_u64(out_, index_offset);
+    out_.write(chunked_file_magic, sizeof(chunked_file_magic));
+    out_.close();
+    if (out_.fail()) {
+        throw psi::PSIEXCEPTION("ChunkedFileWriter: error closing " + filename_);
+    }
+}
+
+ChunkedFileReader::ChunkedFileReader(const std::string& filename) : filename_(filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::string error = "File " + filename + " does not exist.";
+        throw psi::PSIEXCEPTION(error.c_str());
+    }
+    struct stat buf;
+    fstat(fd, &buf);
+    file_size_ = static_cast<size_t>(buf.st_size);
+    const size_t trailer = sizeof(uint64_t) + sizeof(chunked_file_magic);
+    if (file_size_ < sizeof(chunked_file_magic) + trailer) {
+        ::close(fd);
+        throw psi::PSIEXCEPTION("ChunkedFileReader: " + filename + " is not a chunked file");
+    }
+    void* addr = mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw psi::PSIEXCEPTION("ChunkedFileReader: cannot map " + filename);
+    }
+    base_ = static_cast<const char*>(addr);
+
+    if (std::memcmp(base_, chunked_file_magic, sizeof(chunked_file_magic)) != 0 or
+        std::memcmp(base_ + file_size_ - sizeof(chunked_file_magic), chunked_file_magic,
+                    sizeof(chunked_file_magic)) != 0) {
+        munmap(const_cast<char*>(base_), file_size_);
+        throw psi::PSIEXCEPTION("ChunkedFileReader: " + filename + " is not a chunked file");
+    }
+
+    size_t pos = file_size_ - trailer;
+    pos = read_u64(base_, file_size_, pos, filename_);
+    compression_ = static_cast<DiskCompression>(read_u64(base_, file_size_, pos, filename_));
+    uint64_t nrecords = read_u64(base_, file_size_, pos, filename_);
+    for (uint64_t r = 0; r < nrecords; ++r) {
+        uint64_t len = read_u64(base_, file_size_, pos, filename_);
+        if (pos + len > file_size_) {
+            throw psi::PSIEXCEPTION("ChunkedFileReader: truncated index in " + filename_);
+        }
+        std::string name(base_ + pos, len);
+        pos += len;
+        uint64_t nchunks = read_u64(base_, file_size_, pos, filename_);
+        std::vector<Chunk> chunks(nchunks);
+        for (auto& chunk : chunks) {
+            chunk.offset = read_u64(base_, file_size_, pos, filename_);
+            chunk.bytes = read_u64(base_, file_size_, pos, filename_);
+            chunk.nelem = read_u64(base_, file_size_, pos, filename_);
+            if (chunk.offset + chunk.bytes > file_size_) {
+                throw psi::PSIEXCEPTION("ChunkedFileReader: corrupted index in " + filename_);
+            }
+        }
+        names_.push_back(name);
+        index_[name] = std::move(chunks);
+    }
+}
+
+ChunkedFileReader::~ChunkedFileReader() {
+    if (base_) {
+        munmap(const_cast<char*>(base_), file_size_);
+    }
+}
+
+std::vector<std::string> ChunkedFileReader::records() const { return names_; }
+
+const std::vector<ChunkedFileReader::Chunk>&
+ChunkedFileReader::chunks(const std::string& name) const {
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+        throw psi::PSIEXCEPTION("ChunkedFileReader: no record " + name + " in " + filename_);
+    }
+    return it->second;
+}
+
+size_t ChunkedFileReader::size(const std::string& name) const {
+    size_t n = 0;
+    for (const auto& chunk : chunks(name)) {
+        n += chunk.nelem;
+    }
+    return n;
+}
+
+size_t ChunkedFileReader::nchunks(const std::string& name) const { return chunks(name).size(); }
+
+size_t ChunkedFileReader::chunk_size(const std::string& name, size_t chunk) const {
+    return chunks(name).at(chunk).nelem;
+}
+
+void ChunkedFileReader::decode_chunk(const Chunk& chunk, double* data) const {
+    if (compression_ == DiskCompression::None) {
+        if (chunk.bytes != chunk.nelem * sizeof(double)) {
+            throw psi::PSIEXCEPTION("ChunkedFileReader: corrupted chunk in " + filename_);
+        }
+        std::memcpy(data, base_ + chunk.offset, chunk.bytes);
+    } else {
+        decode_xor(base_ + chunk.offset, chunk.bytes, data, chunk.nelem);
+    }
+}
+
+void ChunkedFileReader::read(const std::string& name, double* data) const {
+    for (const auto& chunk : chunks(name)) {
+        decode_chunk(chunk, data);
+        data += chunk.nelem;
+    }
+}
+
+void ChunkedFileReader::read(const std::string& name, std::vector<double>& data) const {
+    data.resize(size(name));
+    read(name, data.data());
+}
+
+void ChunkedFileReader::read_chunk(const std::string& name, size_t chunk,
+                                   std::vector<double>& data) const {
+    const auto& c = chunks(name).at(chunk);
+    data.resize(c.nelem);
+    decode_chunk(c, data.data());
+}
+
+const double* ChunkedFileReader::map(const std::string& name) const {
+    const auto& c = chunks(name);
+    if (compression_ != DiskCompression::None or c.empty()) {
+        return nullptr;
+    }
+    // the chunks of a record are contiguous and aligned to 8 bytes in uncompressed files
+    return reinterpret_cast<const double*>(base_ + c.front().offset);
+}
+
+void write_disk_BT(ambit::BlockedTensor& BT, const std::string& filename,
+                   DiskCompression compression, int mantissa_bits) {
+    ChunkedFileWriter writer(filename, compression, mantissa_bits);
+    for (const std::string& block : BT.block_labels()) {
+        writer.write(block, BT.block(block).data());
+    }
+    writer.close();
+}
+
+void read_disk_BT(ambit::BlockedTensor& BT, const std::string& filename) {
+    ChunkedFileReader reader(filename);
+    for (const std::string& block : BT.block_labels()) {
+        if (not reader.has(block)) {
+            continue;
+        }
+        auto& data = BT.block(block).data();
+        if (reader.size(block) != data.size()) {
+            std::string msg = "Number of elements do NOT match: ";
+            msg += BT.name() + "(" + std::to_string(data.size()) + "); ";
+            msg += filename + "(" + std::to_string(reader.size(block)) + ")";
+            throw psi::PSIEXCEPTION(msg);
+        }
+        reader.read(block, data.data());
+    }
+}
+
+void delete_disk_BT(const std::string& filename) {
+    if (remove(filename.c_str()) != 0) {
+        std::string msg = "Error when deleting " + filename;
+        perror(msg.c_str());
+    }
+}
+
 } // namespace forte
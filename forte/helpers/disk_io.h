@@ -32,6 +32,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <fstream>
+#include <future>
 #include <map>
 #include <numeric>
 #include <string>
@@ -67,27 +69,216 @@ void write_disk_vector_double(const std::string& filename, const std::vector<dou
  */
 void read_disk_vector_double(const std::string& filename, std::vector<double>& data);
 
-///**
-// * @brief Save a BlockedTensor to file
-// * @param BT The BlockedTensor to be dumped to files
-// * @param name The abbreviated name of the BlockedTensor BT
-// * @return The master file name (with absolute path) that handles all blocks
-// */
-//std::string write_disk_BT(ambit::BlockedTensor& BT, const std::string& name,
-//                          const std::string& file_prefix);
-
-///**
-// * @brief Read a BlockedTensor from file
-// * @param BT The BlockedTensor to be filled
-// * @param filename The master file name (with absolute path) that stores file names for all blocks
-// */
-//void read_disk_BT(ambit::BlockedTensor& BT, const std::string& filename);
-
-///**
-// * @brief Delete all files written by write_disk_BT
-// * @param filename The master file name (with absolute path) that stores file names for all blocks
-// */
-//void delete_disk_BT(const std::string& filename);
+/**
+ * @brief Stream a dense tensor to file one block of its leading index at a time
+ *
+ * The file stores the dimensions followed by the blocks T(p, ...) for p = 0, 1, ..., each of
+ * size prod(dims[1:]), so that a producer only needs one block in memory. The blocks must be
+ * written in order, exactly dims[0] of them.
+ */
+class TensorBlockWriter {
+  public:
+    /// Open (and overwrite) the file for a tensor of the given dimensions
+    TensorBlockWriter(const std::string& filename, const std::vector<size_t>& dims);
+    /// Append the next block, of size block_size()
+    void write_block(const double* block);
+    /// @return the number of elements of a block
+    size_t block_size() const { return block_size_; }
+    /// Flush and close the file; throws if not all the blocks were written
+    void close();
+
+  private:
+    std::string filename_;
+    std::ofstream out_;
+    size_t nblocks_;
+    size_t block_size_;
+    size_t nwritten_ = 0;
+};
+
+/// Write a CoreTensor to file in the blocked format of TensorBlockWriter
+void write_tensor_blocks(const ambit::Tensor& t, const std::string& filename);
+
+/**
+ * @brief Read back a tensor written by TensorBlockWriter one block at a time
+ */
+class TensorBlockReader {
+  public:
+    explicit TensorBlockReader(const std::string& filename);
+    /// @return the dimensions of the tensor
+    const std::vector<size_t>& dims() const { return dims_; }
+    /// @return the number of blocks, dims()[0]
+    size_t nblocks() const { return dims_[0]; }
+    /// @return the number of elements of a block
+    size_t block_size() const { return block_size_; }
+    /// Read block p (random access) into block, resized to block_size()
+    void read_block(size_t p, std::vector<double>& block);
+
+  private:
+    std::string filename_;
+    std::ifstream in_;
+    std::vector<size_t> dims_;
+    size_t block_size_;
+    std::streamoff data_offset_;
+};
+
+/// The encoding of the chunks of a ChunkedFileWriter
+enum class DiskCompression {
+    /// raw doubles, which can be read in place from a memory-mapped file
+    None,
+    /// each value is XOR-ed with the previous one and its leading and trailing zero bytes are
+    /// dropped; exact, and effective on amplitudes and intermediates with many zeros or
+    /// slowly varying values
+    Lossless,
+    /// like Lossless, after rounding the mantissa of each value to a given number of bits
+    Truncated
+};
+
+/**
+ * @brief A binary file of named double arrays (records) written in chunks
+ *
+ * Each call to append() adds one chunk to the current record. Chunks are encoded according to
+ * the compression mode and written by a background thread, so that the caller can prepare the
+ * next chunk while the previous one is flushed; the data passed to append() is copied and can
+ * be reused immediately. The index of the records is written by close().
+ *
+ * Usage:
+ *     ChunkedFileWriter writer("T2.bin", DiskCompression::Lossless);
+ *     writer.write("T2 aavv", T2.block("aavv").data());
+ *     writer.begin_record("B");
+ *     for (...) writer.append(chunk.data(), chunk.size());
+ *     writer.end_record();
+ *     writer.close();
+ */
+class ChunkedFileWriter {
+  public:
+    /**
+     * @brief Open (and overwrite) a file
+     * @param filename The file name
+     * @param compression The encoding of the chunks
+     * @param mantissa_bits The number of mantissa bits kept by DiskCompression::Truncated (<= 52)
+     * @param chunk_size The maximum number of elements per chunk used by write()
+     */
+    ChunkedFileWriter(const std::string& filename,
+                      DiskCompression compression = DiskCompression::None, int mantissa_bits = 52,
+                      size_t chunk_size = size_t(1) << 22);
+    /// Closes the file if close() was not called
+    ~ChunkedFileWriter();
+
+    ChunkedFileWriter(const ChunkedFileWriter&) = delete;
+    ChunkedFileWriter& operator=(const ChunkedFileWriter&) = delete;
+
+    /// Start a new record; names must be unique within a file
+    void begin_record(const std::string& name);
+    /// Append a chunk of n elements to the current record
+    void append(const double* data, size_t n);
+    /// Finish the current record
+    void end_record();
+    /// Write a whole record, split in chunks of at most chunk_size elements
+    void write(const std::string& name, const double* data, size_t n);
+    void write(const std::string& name, const std::vector<double>& data) {
+        write(name, data.data(), data.size());
+    }
+    /// Wait until all the chunks appended so far are on disk
+    void flush();
+    /// Flush, write the index, and close the file
+    void close();
+
+  private:
+    struct Chunk {
+        uint64_t offset;
+        uint64_t bytes;
+        uint64_t nelem;
+    };
+    struct Record {
+        std::string name;
+        std::vector<Chunk> chunks;
+    };
+    std::string filename_;
+    std::ofstream out_;
+    DiskCompression compression_;
+    int mantissa_bits_;
+    size_t chunk_size_;
+    std::vector<Record> records_;
+    bool in_record_ = false;
+    bool closed_ = false;
+    uint64_t offset_ = 0;
+    /// the chunk being encoded and written in the background
+    std::future<void> pending_;
+    std::vector<double> pending_data_;
+};
+
+/**
+ * @brief Read the records of a file written by ChunkedFileWriter
+ *
+ * The file is memory mapped: chunks are decoded directly from the mapping, and the data of
+ * uncompressed records can be accessed in place with map() without any copy.
+ */
+class ChunkedFileReader {
+  public:
+    explicit ChunkedFileReader(const std::string& filename);
+    ~ChunkedFileReader();
+
+    ChunkedFileReader(const ChunkedFileReader&) = delete;
+    ChunkedFileReader& operator=(const ChunkedFileReader&) = delete;
+
+    /// @return the names of the records in the order they were written
+    std::vector<std::string> records() const;
+    /// @return true if the file contains a record
+    bool has(const std::string& name) const { return index_.count(name) > 0; }
+    /// @return the number of elements of a record
+    size_t size(const std::string& name) const;
+    /// @return the number of chunks of a record
+    size_t nchunks(const std::string& name) const;
+    /// @return the number of elements of a chunk of a record
+    size_t chunk_size(const std::string& name, size_t chunk) const;
+    /// Read a whole record into data, which must hold size(name) elements
+    void read(const std::string& name, double* data) const;
+    void read(const std::string& name, std::vector<double>& data) const;
+    /// Read a chunk of a record into data, resized to chunk_size(name, chunk)
+    void read_chunk(const std::string& name, size_t chunk, std::vector<double>& data) const;
+    /// @return a pointer to the data of an uncompressed record in the mapped file, or nullptr
+    ///         if the record is compressed. Valid for the lifetime of the reader.
+    const double* map(const std::string& name) const;
+
+  private:
+    struct Chunk {
+        uint64_t offset;
+        uint64_t bytes;
+        uint64_t nelem;
+    };
+    const std::vector<Chunk>& chunks(const std::string& name) const;
+    void decode_chunk(const Chunk& chunk, double* data) const;
+
+    std::string filename_;
+    DiskCompression compression_;
+    const char* base_ = nullptr;
+    size_t file_size_ = 0;
+    std::vector<std::string> names_;
+    std::map<std::string, std::vector<Chunk>> index_;
+};
+
+/**
+ * @brief Save all the blocks of a BlockedTensor to one chunked file
+ * @param BT The BlockedTensor to be dumped to file
+ * @param filename The file name
+ * @param compression The encoding of the data
+ * @param mantissa_bits The number of mantissa bits kept by DiskCompression::Truncated
+ */
+void write_disk_BT(ambit::BlockedTensor& BT, const std::string& filename,
+                   DiskCompression compression = DiskCompression::None, int mantissa_bits = 52);
+
+/**
+ * @brief Read a BlockedTensor written by write_disk_BT
+ * @param BT The BlockedTensor to be filled; blocks not found in the file are left untouched
+ * @param filename The file name
+ */
+void read_disk_BT(ambit::BlockedTensor& BT, const std::string& filename);
+
+/**
+ * @brief Delete a file written by write_disk_BT
+ * @param filename The file name
+ */
+void delete_disk_BT(const std::string& filename);
 
 } // namespace forte
 
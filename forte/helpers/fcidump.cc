@@ -0,0 +1,323 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "forte-def.h"
+
+#include "fcidump.h"
+
+namespace forte {
+
+namespace {
+/// the first bytes of a binary FCIDUMP file
+const char binary_magic[8] = {'F', 'C', 'I', 'D', 'B', 'I', 'N', '1'};
+
+/// parse a floating point number, accepting the Fortran exponent 'D'
+inline double parse_double(const char* p, char** end) {
+    double value = std::strtod(p, end);
+    if (**end == 'D' or **end == 'd') {
+        long exponent = std::strtol(*end + 1, end, 10);
+        value *= std::pow(10.0, static_cast<double>(exponent));
+    }
+    return value;
+}
+
+std::string trim(const std::string& s) {
+    auto begin = s.find_first_not_of(" \t\r\n,");
+    if (begin == std::string::npos)
+        return "";
+    auto end = s.find_last_not_of(" \t\r\n,");
+    return s.substr(begin, end - begin + 1);
+}
+} // namespace
+
+FCIDUMP::FCIDUMP(const std::string& filename) { load(filename); }
+
+void FCIDUMP::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (not file) {
+        throw std::runtime_error("FCIDUMP: could not open the file " + filename);
+    }
+    char magic[sizeof(binary_magic)] = {};
+    file.read(magic, sizeof(magic));
+    file.close();
+    if (std::memcmp(magic, binary_magic, sizeof(binary_magic)) == 0) {
+        load_binary(filename);
+    } else {
+        load_text(filename);
+    }
+}
+
+size_t FCIDUMP::parse_header(const std::string& text) {
+    auto start = text.find("&FCI");
+    auto stop = text.find("END", start);
+    if (start == std::string::npos or stop == std::string::npos) {
+        throw std::runtime_error("FCIDUMP: the &FCI ... &END header is missing");
+    }
+    // the header is a namelist of KEY=value entries, split it at the '=' signs
+    std::string header = text.substr(start + 4, stop - start - 4);
+    if (not header.empty() and header.back() == '&')
+        header.pop_back();
+    std::vector<std::pair<size_t, size_t>> keys; // (begin of the key, position of '=')
+    for (size_t eq = header.find('='); eq != std::string::npos; eq = header.find('=', eq + 1)) {
+        size_t k = eq;
+        while (k > 0 and std::isspace(header[k - 1]))
+            k--;
+        while (k > 0 and (std::isalnum(header[k - 1]) or header[k - 1] == '_'))
+            k--;
+        keys.emplace_back(k, eq);
+    }
+    for (size_t n = 0; n < keys.size(); n++) {
+        std::string key = trim(header.substr(keys[n].first, keys[n].second - keys[n].first));
+        size_t value_end = n + 1 < keys.size() ? keys[n + 1].first : header.size();
+        std::string value = trim(header.substr(keys[n].second + 1, value_end - keys[n].second - 1));
+        std::transform(key.begin(), key.end(), key.begin(), ::toupper);
+        if (key == "NORB") {
+            norb_ = std::stoul(value);
+        } else if (key == "NELEC") {
+            nelec_ = std::stoi(value);
+        } else if (key == "MS2") {
+            ms2_ = std::stoi(value);
+        } else if (key == "ISYM") {
+            isym_ = std::stoi(value);
+        } else if (key == "UHF") {
+            std::transform(value.begin(), value.end(), value.begin(), ::toupper);
+            uhf_ = value.find("TRUE") != std::string::npos;
+        } else if (key == "PNTGRP") {
+            pntgrp_ = value;
+        } else if (key == "ORBSYM") {
+            std::replace(value.begin(), value.end(), ',', ' ');
+            std::istringstream ss(value);
+            orbsym_.clear();
+            for (int h; ss >> h;)
+                orbsym_.push_back(h);
+        }
+    }
+    if (norb_ == 0) {
+        throw std::runtime_error("FCIDUMP: NORB is missing from the header");
+    }
+    auto line_end = text.find('\n', stop);
+    return line_end == std::string::npos ? text.size() : line_end + 1;
+}
+
+void FCIDUMP::load_text(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    std::string text(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&text[0], text.size());
+    file.close();
+
+    const size_t offset = parse_header(text);
+    const size_t npair = norb_ * (norb_ + 1) / 2;
+    hcore_.assign(norb_ * norb_, 0.0);
+    eri_.assign(npair * (npair + 1) / 2, 0.0);
+    std::vector<double> epsilon(norb_, 0.0);
+
+    // split the integral lines into one chunk per thread, starting each chunk at a new line
+    const char* data = text.c_str();
+    const size_t size = text.size();
+    const int nthread = omp_get_max_threads();
+    std::vector<size_t> bounds(nthread + 1, size);
+    bounds[0] = offset;
+    for (int t = 1; t < nthread; t++) {
+        size_t b = offset + (size - offset) * t / nthread;
+        b = std::max(b, bounds[t - 1]);
+        while (b < size and data[b - 1] != '\n')
+            b++;
+        bounds[t] = b;
+    }
+
+    // the energy is read from the last line with all indices equal to zero
+    std::vector<double> enuc(nthread, 0.0);
+    std::vector<char> has_enuc(nthread, 0), has_epsilon(nthread, 0), out_of_range(nthread, 0);
+    const long n = static_cast<long>(norb_);
+#pragma omp parallel num_threads(nthread)
+    {
+        const int t = omp_get_thread_num();
+        const char* p = data + bounds[t];
+        const char* end = data + bounds[t + 1];
+        while (p < end) {
+            while (p < end and std::isspace(*p))
+                p++;
+            if (p >= end)
+                break;
+            char* q;
+            double value = parse_double(p, &q);
+            long idx[4] = {0, 0, 0, 0};
+            for (int k = 0; k < 4 and q != p; k++)
+                idx[k] = std::strtol(q, &q, 10);
+            if (q == p) {
+                // not an integral line, skip it
+                while (p < end and *p != '\n')
+                    p++;
+                continue;
+            }
+            p = q;
+            while (p < end and *p != '\n')
+                p++;
+
+            const long i = idx[0], j = idx[1], k = idx[2], l = idx[3];
+            if (i < 0 or j < 0 or k < 0 or l < 0 or i > n or j > n or k > n or l > n) {
+                out_of_range[t] = 1;
+            } else if (i > 0 and j > 0 and k > 0 and l > 0) {
+                eri_[pair_index(pair_index(i - 1, j - 1), pair_index(k - 1, l - 1))] = value;
+            } else if (i > 0 and j > 0) {
+                hcore_[(i - 1) * norb_ + j - 1] = value;
+                hcore_[(j - 1) * norb_ + i - 1] = value;
+            } else if (i > 0) {
+                epsilon[i - 1] = value;
+                has_epsilon[t] = 1;
+            } else {
+                enuc[t] = value;
+                has_enuc[t] = 1;
+            }
+        }
+    }
+
+    if (std::any_of(out_of_range.begin(), out_of_range.end(), [](char c) { return c; })) {
+        throw std::runtime_error("FCIDUMP: found an orbital index larger than NORB in " +
+                                 filename);
+    }
+    enuc_ = 0.0;
+    for (int t = 0; t < nthread; t++) {
+        if (has_enuc[t])
+            enuc_ = enuc[t];
+    }
+    epsilon_.clear();
+    if (std::any_of(has_epsilon.begin(), has_epsilon.end(), [](char c) { return c; })) {
+        epsilon_ = epsilon;
+    }
+}
+
+void FCIDUMP::save_binary(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (not file) {
+        throw std::runtime_error("FCIDUMP: could not open the file " + filename);
+    }
+    auto write_int = [&](int64_t value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(int64_t));
+    };
+    auto write_doubles = [&](const std::vector<double>& v) {
+        file.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(double));
+    };
+    file.write(binary_magic, sizeof(binary_magic));
+    write_int(norb_);
+    write_int(nelec_);
+    write_int(ms2_);
+    write_int(isym_);
+    write_int(uhf_);
+    write_int(pntgrp_.size());
+    write_int(orbsym_.size());
+    write_int(epsilon_.size());
+    file.write(reinterpret_cast<const char*>(&enuc_), sizeof(double));
+    file.write(pntgrp_.data(), pntgrp_.size());
+    for (int h : orbsym_)
+        write_int(h);
+    write_doubles(hcore_);
+    write_doubles(epsilon_);
+    write_doubles(eri_);
+    if (not file) {
+        throw std::runtime_error("FCIDUMP: error writing the file " + filename);
+    }
+}
+
+void FCIDUMP::load_binary(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("FCIDUMP: could not open the file " + filename);
+    }
+    struct stat st;
+    fstat(fd, &st);
+    const size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("FCIDUMP: could not map the file " + filename);
+    }
+
+    const char* p = static_cast<const char*>(map) + sizeof(binary_magic);
+    const char* end = static_cast<const char*>(map) + size;
+    auto check = [&](size_t nbytes) {
+        if (p + nbytes > end) {
+            munmap(map, size);
+            throw std::runtime_error("FCIDUMP: the binary file " + filename + " is truncated");
+        }
+    };
+    auto read_int = [&]() {
+        int64_t value;
+        check(sizeof(int64_t));
+        std::memcpy(&value, p, sizeof(int64_t));
+        p += sizeof(int64_t);
+        return value;
+    };
+    auto read_doubles = [&](std::vector<double>& v, size_t count) {
+        check(count * sizeof(double));
+        v.resize(count);
+        std::memcpy(v.data(), p, count * sizeof(double));
+        p += count * sizeof(double);
+    };
+
+    norb_ = read_int();
+    nelec_ = read_int();
+    ms2_ = read_int();
+    isym_ = read_int();
+    uhf_ = read_int();
+    const size_t npntgrp = read_int();
+    const size_t norbsym = read_int();
+    const size_t nepsilon = read_int();
+    check(sizeof(double));
+    std::memcpy(&enuc_, p, sizeof(double));
+    p += sizeof(double);
+    check(npntgrp);
+    pntgrp_.assign(p, npntgrp);
+    p += npntgrp;
+    orbsym_.resize(norbsym);
+    for (auto& h : orbsym_)
+        h = read_int();
+    const size_t npair = norb_ * (norb_ + 1) / 2;
+    read_doubles(hcore_, norb_ * norb_);
+    read_doubles(epsilon_, nepsilon);
+    read_doubles(eri_, npair * (npair + 1) / 2);
+    munmap(map, size);
+}
+
+} // namespace forte
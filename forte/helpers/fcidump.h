@@ -0,0 +1,134 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _fcidump_h_
+#define _fcidump_h_
+
+#include <string>
+#include <vector>
+
+namespace forte {
+
+/**
+ * @class FCIDUMP
+ *
+ * @brief A class for reading integrals stored in the FCIDUMP format.
+ *
+ * The text format is the one defined in Comp. Phys. Commun. 54 75 (1989) and written by
+ * forte.proc.fcidump. The integral lines are parsed in parallel. The class can also save the
+ * integrals in a compact binary format, which is read back with mmap and is detected
+ * automatically by load().
+ *
+ * The two-electron integrals (ij|kl) (chemists' notation) are stored using the eight-fold
+ * permutational symmetry, with the compound index pair(pair(i,j),pair(k,l)), where
+ * pair(i,j) = i * (i + 1) / 2 + j for i >= j.
+ */
+class FCIDUMP {
+  public:
+    // ==> Class Constructor <==
+    /**
+     * @brief Build a FCIDUMP object from a file stored on disk
+     * @param filename the path to the FCIDUMP file (text or binary)
+     */
+    FCIDUMP(const std::string& filename);
+
+    /// @return the number of orbitals
+    size_t norb() const { return norb_; }
+    /// @return the number of electrons
+    int nelec() const { return nelec_; }
+    /// @return twice the spin projection
+    int ms2() const { return ms2_; }
+    /// @return the symmetry of the state (as written in the file)
+    int isym() const { return isym_; }
+    /// @return true if the file contains unrestricted orbitals
+    bool uhf() const { return uhf_; }
+    /// @return the point group (empty if not present in the file)
+    const std::string& pntgrp() const { return pntgrp_; }
+    /// @return the symmetry label of each orbital (as written in the file)
+    const std::vector<int>& orbsym() const { return orbsym_; }
+    /// @return the nuclear repulsion plus frozen core energy
+    double enuc() const { return enuc_; }
+    /// @return the orbital energies (empty if not present in the file)
+    const std::vector<double>& epsilon() const { return epsilon_; }
+    /// @return the core Hamiltonian stored as a norb x norb matrix
+    const std::vector<double>& hcore() const { return hcore_; }
+    /// @return the symmetry-packed two-electron integrals
+    const std::vector<double>& eri_packed() const { return eri_; }
+    /// @return the two-electron integral (ij|kl) in chemists' notation
+    double eri(size_t i, size_t j, size_t k, size_t l) const {
+        return eri_[pair_index(pair_index(i, j), pair_index(k, l))];
+    }
+
+    // ==> Class Functions <==
+    /// load a FCIDUMP file, the format (text or binary) is detected from the first bytes
+    /// @param filename the FCIDUMP file name
+    void load(const std::string& filename);
+    /// save the integrals in the binary format
+    /// @param filename the binary file name
+    void save_binary(const std::string& filename) const;
+
+    /// @return the index of the pair (i,j) with the two indices in any order
+    static size_t pair_index(size_t i, size_t j) {
+        return i >= j ? i * (i + 1) / 2 + j : j * (j + 1) / 2 + i;
+    }
+
+  private:
+    /// read a text FCIDUMP file
+    void load_text(const std::string& filename);
+    /// read a binary FCIDUMP file
+    void load_binary(const std::string& filename);
+    /// parse the namelist header (&FCI ... &END), return the offset of the first integral line
+    size_t parse_header(const std::string& text);
+
+    /// the number of orbitals
+    size_t norb_ = 0;
+    /// the number of electrons
+    int nelec_ = 0;
+    /// twice the spin projection
+    int ms2_ = 0;
+    /// the symmetry of the state
+    int isym_ = 1;
+    /// unrestricted orbitals?
+    bool uhf_ = false;
+    /// the point group
+    std::string pntgrp_;
+    /// the symmetry label of each orbital
+    std::vector<int> orbsym_;
+    /// the nuclear repulsion plus frozen core energy
+    double enuc_ = 0.0;
+    /// the orbital energies
+    std::vector<double> epsilon_;
+    /// the core Hamiltonian
+    std::vector<double> hcore_;
+    /// the symmetry-packed two-electron integrals
+    std::vector<double> eri_;
+};
+
+} // namespace forte
+
+#endif // _fcidump_h_
@@ -0,0 +1,654 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _flat_hash_vec_h_
+#define _flat_hash_vec_h_
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+#include <tuple>
+#include <functional>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief An insertion-ordered hash vector based on open addressing
+ *
+ * FlatHashVector has the same interface and index semantics as HashVector: keys are stored
+ * contiguously in the order they are added and add()/find() return their position in this
+ * vector. The lookup table is a Swiss-table style open-addressing map. Each slot has one control
+ * byte (empty, deleted, or the 7 high bits of the hash of the key it holds) and the index of the
+ * key. Slots are organized in groups of 16, and the control bytes of a group are compared to the
+ * hash tag with a single SSE2 instruction. The control bytes and the key indices of a group are
+ * stored together, so that a lookup usually touches one group and then only the matching key.
+ * Key indices are 32-bit, which limits the size to UINT32_MAX - 1 keys.
+ */
+template <class Key, class Hash = std::hash<Key>> class FlatHashVector {
+  private:
+    static constexpr size_t GROUP_WIDTH = 16;
+    static constexpr int8_t CTRL_EMPTY = -128;
+    static constexpr int8_t CTRL_DELETED = -2;
+    static constexpr float MAX_MAX_LOAD = 0.875;
+
+    /// The control bytes of a group and the indices of its keys, packed and aligned so that a
+    /// successful lookup usually costs one cache miss for the group and one for the key
+    struct alignas(64) Group {
+        int8_t ctrl[GROUP_WIDTH];
+        uint32_t index[GROUP_WIDTH];
+    };
+    std::vector<Key> vec;
+    std::vector<Group> groups;
+    float max_load = MAX_MAX_LOAD;
+    size_t current_max_load_size;
+    size_t num_group;
+    size_t num_deleted;
+
+    /// Scramble the user hash. Determinant::Hash is the identity for 64 orbitals
+    static inline size_t mix_hash(size_t h) {
+        h *= 0x9E3779B97F4A7C15ULL;
+        return h ^ (h >> 29);
+    }
+    static inline int8_t hash_tag(size_t h) { return static_cast<int8_t>(h >> 57); }
+    /// Bit mask of the slots of a group whose control byte is equal to c
+    static inline uint32_t match_group(const int8_t* group, int8_t c);
+    /// Bit mask of the slots of a group that are empty or deleted
+    static inline uint32_t match_free(const int8_t* group);
+    static inline size_t first_bit(uint32_t mask) { return __builtin_ctz(mask); }
+    int8_t& ctrl_at(size_t slot) { return groups[slot / GROUP_WIDTH].ctrl[slot % GROUP_WIDTH]; }
+    int8_t ctrl_at(size_t slot) const {
+        return groups[slot / GROUP_WIDTH].ctrl[slot % GROUP_WIDTH];
+    }
+    uint32_t& index_at(size_t slot) { return groups[slot / GROUP_WIDTH].index[slot % GROUP_WIDTH]; }
+    uint32_t index_at(size_t slot) const {
+        return groups[slot / GROUP_WIDTH].index[slot % GROUP_WIDTH];
+    }
+
+    static Group empty_group() {
+        Group group;
+        std::fill(group.ctrl, group.ctrl + GROUP_WIDTH, CTRL_EMPTY);
+        std::fill(group.index, group.index + GROUP_WIDTH, UINT32_MAX);
+        return group;
+    }
+    size_t find_slot(const Key& key) const;
+    size_t insert_slot(size_t h, size_t index);
+    void erase_slot(size_t slot);
+    void erase_sorted_indices(const std::vector<size_t>& indices);
+    void rehash(size_t new_num_group);
+    void grow();
+    inline void update_current_max_load_size();
+
+  public:
+    using iterator = typename std::vector<Key>::const_iterator;
+    explicit FlatHashVector();
+    explicit FlatHashVector(const std::vector<Key>& other);
+    template <class Hash_2> explicit FlatHashVector(const std::unordered_set<Key, Hash_2>& other);
+
+    /*- Element access -*/
+    static const size_t npos = SIZE_MAX;
+    const Key& operator[](size_t pos) const { return vec[pos]; }
+    size_t find(const Key& key) const;
+
+    /*- Iterators -*/
+    const iterator begin() const { return this->vec.begin(); }
+    const iterator end() const { return this->vec.end(); }
+
+    /*- Capacity -*/
+    size_t size() const { return vec.size(); }
+    size_t max_size() const;
+    size_t capacity() const { return vec.capacity(); }
+
+    /*- Modifiers -*/
+    void clear();
+    size_t add(const Key& key);
+    void erase_by_key(const Key& key);
+    void erase_by_index(size_t index);
+    void erase_by_key(std::vector<Key> keys);
+    void erase_by_index(std::vector<size_t> indices);
+    std::pair<size_t, size_t> erase_by_key_move_last(const Key& key);
+    std::pair<size_t, size_t> erase_by_index_move_last(size_t index);
+    void swap(FlatHashVector<Key, Hash>& other);
+
+    /*- Operations -*/
+    template <class Hash_2> std::vector<size_t> merge(const FlatHashVector<Key, Hash_2>& source);
+    std::vector<size_t> merge(const std::vector<Key>& source);
+    template <class Hash_2> void merge(const std::unordered_set<Key, Hash_2>& source);
+    void map_order(const std::vector<size_t>& index_map);
+
+    /*- Bucket interface (a bucket is a group of 16 slots) -*/
+    size_t bucket_count() const { return num_group; }
+    size_t max_bucket_count() const;
+    size_t bucket_size(size_t n) const;
+    size_t bucket(const Key& key) const;
+
+    /*- Hash policy -*/
+    float load_factor() const;
+    float max_load_factor() const { return max_load; }
+    void max_load_factor(float ml);
+    void reserve(size_t count);
+    void shrink_to_fit();
+    std::vector<size_t> optimize();
+
+    /*- Convertors -*/
+    std::vector<Key> toVector() const { return vec; }
+    std::vector<std::pair<Key, size_t>> toKeyIndex() const;
+    std::unordered_set<Key, Hash> toUnordered_set() const;
+};
+
+template <class Key, class Hash> const size_t FlatHashVector<Key, Hash>::npos;
+
+namespace std {
+template <class Key, class Hash>
+void swap(FlatHashVector<Key, Hash>& a, FlatHashVector<Key, Hash>& b) {
+    a.swap(b);
+}
+}
+
+template <class Key, class Hash> FlatHashVector<Key, Hash>::FlatHashVector() { this->clear(); }
+
+template <class Key, class Hash>
+FlatHashVector<Key, Hash>::FlatHashVector(const std::vector<Key>& other) {
+    this->clear();
+    this->reserve(other.size());
+    for (const Key& k : other) {
+        this->add(k);
+    }
+}
+
+template <class Key, class Hash>
+template <class Hash_2>
+FlatHashVector<Key, Hash>::FlatHashVector(const std::unordered_set<Key, Hash_2>& other) {
+    this->clear();
+    this->reserve(other.size());
+    for (const Key& k : other) {
+        this->add(k);
+    }
+}
+
+template <class Key, class Hash>
+inline uint32_t FlatHashVector<Key, Hash>::match_group(const int8_t* group, int8_t c) {
+#ifdef __SSE2__
+    __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(c))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+        mask |= static_cast<uint32_t>(group[i] == c) << i;
+    }
+    return mask;
+#endif
+}
+
+template <class Key, class Hash>
+inline uint32_t FlatHashVector<Key, Hash>::match_free(const int8_t* group) {
+#ifdef __SSE2__
+    // empty and deleted slots are the only ones with the sign bit set
+    __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(g));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+        mask |= static_cast<uint32_t>(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+}
+
+template <class Key, class Hash>
+size_t FlatHashVector<Key, Hash>::find_slot(const Key& key) const {
+    const size_t h = mix_hash(Hash()(key));
+    const int8_t tag = hash_tag(h);
+    const size_t group_mask = num_group - 1;
+    size_t g = h & group_mask;
+    // triangular probing visits every group when the number of groups is a power of two
+    for (size_t step = 1; step <= num_group; ++step) {
+        const Group& group = groups[g];
+        uint32_t mask = match_group(group.ctrl, tag);
+        while (mask) {
+            const size_t i = first_bit(mask);
+            if (vec[group.index[i]] == key) {
+                return g * GROUP_WIDTH + i;
+            }
+            mask &= mask - 1;
+        }
+        if (match_group(group.ctrl, CTRL_EMPTY)) {
+            return npos;
+        }
+        g = (g + step) & group_mask;
+    }
+    return npos;
+}
+
+template <class Key, class Hash>
+size_t FlatHashVector<Key, Hash>::insert_slot(size_t h, size_t index) {
+    const size_t group_mask = num_group - 1;
+    size_t g = h & group_mask;
+    for (size_t step = 1;; ++step) {
+        Group& group = groups[g];
+        uint32_t mask = match_free(group.ctrl);
+        if (mask) {
+            const size_t i = first_bit(mask);
+            if (group.ctrl[i] == CTRL_DELETED) {
+                --num_deleted;
+            }
+            group.ctrl[i] = hash_tag(h);
+            group.index[i] = static_cast<uint32_t>(index);
+            return g * GROUP_WIDTH + i;
+        }
+        g = (g + step) & group_mask;
+    }
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::erase_slot(size_t slot) {
+    // A group that still has an empty slot never made a probe sequence move past it, so the
+    // erased slot can be marked empty. Otherwise a tombstone keeps the probe sequences intact.
+    if (match_group(groups[slot / GROUP_WIDTH].ctrl, CTRL_EMPTY)) {
+        ctrl_at(slot) = CTRL_EMPTY;
+    } else {
+        ctrl_at(slot) = CTRL_DELETED;
+        ++num_deleted;
+    }
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::rehash(size_t new_num_group) {
+    num_group = new_num_group;
+    num_deleted = 0;
+    groups.assign(num_group, empty_group());
+    const size_t current_size = vec.size();
+    for (size_t i = 0; i < current_size; ++i) {
+        insert_slot(mix_hash(Hash()(vec[i])), i);
+    }
+    update_current_max_load_size();
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::grow() {
+    // reclaim tombstones in place if they account for a large share of the used slots
+    if (num_deleted > vec.size()) {
+        rehash(num_group);
+    } else {
+        rehash(num_group << 1);
+    }
+}
+
+template <class Key, class Hash>
+inline void FlatHashVector<Key, Hash>::update_current_max_load_size() {
+    // keep at least one empty slot so that unsuccessful lookups terminate
+    const size_t num_slot = num_group * GROUP_WIDTH;
+    this->current_max_load_size = std::min(static_cast<size_t>(max_load * num_slot), num_slot - 1);
+}
+
+template <class Key, class Hash> size_t FlatHashVector<Key, Hash>::find(const Key& key) const {
+    size_t slot = find_slot(key);
+    return slot == npos ? npos : index_at(slot);
+}
+
+template <class Key, class Hash> size_t FlatHashVector<Key, Hash>::max_size() const {
+    // key indices are stored as 32-bit integers
+    size_t vec_max_size = vec.max_size();
+    return vec_max_size < UINT32_MAX ? vec_max_size : UINT32_MAX - 1;
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::clear() {
+    this->vec.clear();
+    this->num_group = 1;
+    this->num_deleted = 0;
+    this->groups.assign(1, empty_group());
+    update_current_max_load_size();
+}
+
+template <class Key, class Hash> size_t FlatHashVector<Key, Hash>::add(const Key& key) {
+    const size_t h = mix_hash(Hash()(key));
+    const int8_t tag = hash_tag(h);
+    const size_t group_mask = num_group - 1;
+    size_t g = h & group_mask;
+    for (size_t step = 1; step <= num_group; ++step) {
+        const Group& group = groups[g];
+        uint32_t mask = match_group(group.ctrl, tag);
+        while (mask) {
+            const size_t i = first_bit(mask);
+            if (vec[group.index[i]] == key) {
+                return group.index[i];
+            }
+            mask &= mask - 1;
+        }
+        if (match_group(group.ctrl, CTRL_EMPTY)) {
+            break;
+        }
+        g = (g + step) & group_mask;
+    }
+    const size_t index = vec.size();
+    if (index + num_deleted + 1 > current_max_load_size) {
+        grow();
+    }
+    vec.push_back(key);
+    insert_slot(h, index);
+    return index;
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::erase_by_key(const Key& key) {
+    size_t slot = find_slot(key);
+    if (slot == npos)
+        return;
+    const size_t key_index = index_at(slot);
+    erase_slot(slot);
+    const size_t num_slot = num_group * GROUP_WIDTH;
+    for (size_t s = 0; s < num_slot; ++s) {
+        if (ctrl_at(s) >= 0 && index_at(s) > key_index) {
+            --index_at(s);
+        }
+    }
+    this->vec.erase(this->vec.begin() + key_index);
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::erase_by_index(size_t index) {
+    return erase_by_key(this->operator[](index));
+}
+
+template <class Key, class Hash>
+void FlatHashVector<Key, Hash>::erase_sorted_indices(const std::vector<size_t>& indices) {
+    const size_t remove_size = indices.size();
+    if (remove_size == 0) {
+        return;
+    }
+    const size_t num_slot = num_group * GROUP_WIDTH;
+    for (size_t s = 0; s < num_slot; ++s) {
+        if (ctrl_at(s) >= 0) {
+            index_at(s) -= std::lower_bound(indices.begin(), indices.end(), size_t(index_at(s))) -
+                           indices.begin();
+        }
+    }
+    const size_t current_size = vec.size();
+    size_t current_move = 1;
+    size_t next_remove = (remove_size >= 2) ? indices[1] : npos;
+    for (size_t i = indices[0] + 1; i < current_size; ++i) {
+        if (i == next_remove) {
+            ++current_move;
+            next_remove = (current_move < remove_size) ? indices[current_move] : npos;
+        } else {
+            this->vec[i - current_move] = std::move(this->vec[i]);
+        }
+    }
+    this->vec.erase(vec.end() - remove_size, vec.end());
+}
+
+template <class Key, class Hash>
+void FlatHashVector<Key, Hash>::erase_by_key(std::vector<Key> keys) {
+    std::vector<size_t> indices;
+    indices.reserve(keys.size());
+    for (const Key& k : keys) {
+        size_t slot = find_slot(k);
+        if (slot == npos)
+            continue;
+        indices.push_back(index_at(slot));
+        erase_slot(slot);
+    }
+    std::sort(indices.begin(), indices.end());
+    erase_sorted_indices(indices);
+}
+
+template <class Key, class Hash>
+void FlatHashVector<Key, Hash>::erase_by_index(std::vector<size_t> indices) {
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    for (size_t i : indices) {
+        erase_slot(find_slot(vec[i]));
+    }
+    erase_sorted_indices(indices);
+}
+
+template <class Key, class Hash>
+std::pair<size_t, size_t> FlatHashVector<Key, Hash>::erase_by_key_move_last(const Key& key) {
+    size_t slot = find_slot(key);
+    if (slot == npos)
+        return std::make_pair(npos, npos);
+    const size_t key_index = index_at(slot);
+    const size_t last_index = vec.size() - 1;
+    erase_slot(slot);
+    if (key_index == last_index) {
+        this->vec.pop_back();
+        return std::make_pair(last_index, npos);
+    }
+    index_at(find_slot(vec[last_index])) = static_cast<uint32_t>(key_index);
+    this->vec[key_index] = std::move(this->vec[last_index]);
+    this->vec.pop_back();
+    return std::make_pair(last_index, key_index);
+}
+
+template <class Key, class Hash>
+std::pair<size_t, size_t> FlatHashVector<Key, Hash>::erase_by_index_move_last(size_t index) {
+    return erase_by_key_move_last(this->operator[](index));
+}
+
+template <class Key, class Hash>
+void FlatHashVector<Key, Hash>::swap(FlatHashVector<Key, Hash>& other) {
+    vec.swap(other.vec);
+    groups.swap(other.groups);
+    std::swap(this->max_load, other.max_load);
+    std::swap(this->current_max_load_size, other.current_max_load_size);
+    std::swap(this->num_group, other.num_group);
+    std::swap(this->num_deleted, other.num_deleted);
+}
+
+template <class Key, class Hash>
+template <class Hash_2>
+std::vector<size_t> FlatHashVector<Key, Hash>::merge(const FlatHashVector<Key, Hash_2>& source) {
+    std::vector<size_t> cur_index;
+    size_t merge_size = source.size();
+    cur_index.reserve(merge_size);
+    for (size_t i = 0; i < merge_size; ++i) {
+        cur_index.push_back(this->add(source[i]));
+    }
+    return cur_index;
+}
+
+template <class Key, class Hash>
+std::vector<size_t> FlatHashVector<Key, Hash>::merge(const std::vector<Key>& source) {
+    std::vector<size_t> cur_index;
+    size_t merge_size = source.size();
+    cur_index.reserve(merge_size);
+    for (size_t i = 0; i < merge_size; ++i) {
+        cur_index.push_back(this->add(source[i]));
+    }
+    return cur_index;
+}
+
+template <class Key, class Hash>
+template <class Hash_2>
+void FlatHashVector<Key, Hash>::merge(const std::unordered_set<Key, Hash_2>& source) {
+    for (const Key& k : source) {
+        this->add(k);
+    }
+}
+
+template <class Key, class Hash>
+void FlatHashVector<Key, Hash>::map_order(const std::vector<size_t>& index_map) {
+    const size_t current_size = vec.size();
+    if (current_size == 0)
+        return;
+    std::vector<Key> new_vec;
+    new_vec.reserve(this->vec.capacity());
+    new_vec.resize(current_size, vec[0]);
+    for (size_t i = 0; i < current_size; ++i) {
+        new_vec[index_map[i]] = std::move(this->vec[i]);
+    }
+    this->vec = std::move(new_vec);
+    const size_t num_slot = num_group * GROUP_WIDTH;
+    for (size_t s = 0; s < num_slot; ++s) {
+        if (ctrl_at(s) >= 0) {
+            index_at(s) = index_map[index_at(s)];
+        }
+    }
+}
+
+template <class Key, class Hash> size_t FlatHashVector<Key, Hash>::max_bucket_count() const {
+    size_t groups_max_size = groups.max_size();
+    return groups_max_size < npos ? groups_max_size : npos - 1;
+}
+
+template <class Key, class Hash> size_t FlatHashVector<Key, Hash>::bucket_size(size_t n) const {
+    if (n >= this->num_group)
+        return npos;
+    return GROUP_WIDTH - __builtin_popcount(match_free(groups[n].ctrl));
+}
+
+template <class Key, class Hash> size_t FlatHashVector<Key, Hash>::bucket(const Key& key) const {
+    size_t slot = find_slot(key);
+    return slot == npos ? npos : slot / GROUP_WIDTH;
+}
+
+template <class Key, class Hash> float FlatHashVector<Key, Hash>::load_factor() const {
+    return ((float)vec.size()) / (num_group * GROUP_WIDTH);
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::max_load_factor(float ml) {
+    this->max_load = std::min(ml, MAX_MAX_LOAD);
+    update_current_max_load_size();
+    size_t new_num_group = num_group;
+    while (vec.size() > std::min(static_cast<size_t>(max_load * new_num_group * GROUP_WIDTH),
+                                 new_num_group * GROUP_WIDTH - 1))
+        new_num_group <<= 1;
+    if (new_num_group != num_group)
+        rehash(new_num_group);
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::reserve(size_t count) {
+    if (count <= vec.size())
+        return;
+    this->vec.reserve(count);
+    size_t new_num_group = num_group;
+    while (count > std::min(static_cast<size_t>(max_load * new_num_group * GROUP_WIDTH),
+                            new_num_group * GROUP_WIDTH - 1))
+        new_num_group <<= 1;
+    if (new_num_group != num_group)
+        rehash(new_num_group);
+}
+
+template <class Key, class Hash> void FlatHashVector<Key, Hash>::shrink_to_fit() {
+    this->vec.shrink_to_fit();
+    size_t new_num_group = num_group;
+    while (new_num_group > 1 &&
+           vec.size() <= std::min(static_cast<size_t>(max_load * new_num_group * GROUP_WIDTH / 2),
+                                  new_num_group * GROUP_WIDTH / 2 - 1))
+        new_num_group >>= 1;
+    if (new_num_group != num_group || num_deleted > 0) {
+        rehash(new_num_group);
+        this->groups.shrink_to_fit();
+    }
+}
+
+template <class Key, class Hash> std::vector<size_t> FlatHashVector<Key, Hash>::optimize() {
+    // store the keys in slot order so that keys that are probed together are close in memory
+    const size_t current_size = vec.size();
+    std::vector<size_t> cur_index(current_size, npos);
+    std::vector<Key> old_vec;
+    this->vec.swap(old_vec);
+    this->vec.reserve(old_vec.capacity());
+    const size_t num_slot = num_group * GROUP_WIDTH;
+    for (size_t s = 0; s < num_slot; ++s) {
+        if (ctrl_at(s) >= 0) {
+            const size_t old_index = index_at(s);
+            cur_index[old_index] = vec.size();
+            index_at(s) = static_cast<uint32_t>(vec.size());
+            this->vec.push_back(std::move(old_vec[old_index]));
+        }
+    }
+    return cur_index;
+}
+
+template <class Key, class Hash>
+std::vector<std::pair<Key, size_t>> FlatHashVector<Key, Hash>::toKeyIndex() const {
+    std::vector<std::pair<Key, size_t>> key_index_pairs;
+    const size_t current_size = vec.size();
+    key_index_pairs.reserve(current_size);
+    for (size_t n = 0; n < current_size; ++n) {
+        key_index_pairs.push_back(std::make_pair(vec[n], n));
+    }
+    return key_index_pairs;
+}
+
+template <class Key, class Hash>
+std::unordered_set<Key, Hash> FlatHashVector<Key, Hash>::toUnordered_set() const {
+    std::unordered_set<Key, Hash> uSet;
+    uSet.reserve(vec.size());
+    for (const Key& k : vec) {
+        uSet.insert(k);
+    }
+    return uSet;
+}
+
+template <class Key, class Hash, class Value>
+void merge(FlatHashVector<Key, Hash>& hvec, std::vector<Value>& values,
+           const std::vector<std::pair<Key, Value>>& source) {
+    size_t original_size = hvec.size();
+    for (const std::pair<Key, Value>& kv : source) {
+        size_t index = hvec.add(kv.first);
+        if (index < original_size) {
+            values[index] = kv.second;
+        } else {
+            values.push_back(kv.second);
+        }
+    }
+}
+
+template <class Key, class Hash, class Value>
+void merge(FlatHashVector<Key, Hash>& hvec, std::vector<Value>& values,
+           const std::vector<std::pair<Key, Value>>& source,
+           const std::function<Value(Value, Value)>& f, const Value& default_value,
+           bool change_this) {
+    size_t original_size = hvec.size();
+    if (change_this) {
+        std::vector<bool> intersects(original_size, false);
+        for (const std::pair<Key, Value>& kv : source) {
+            size_t index = hvec.add(kv.first);
+            if (index < original_size) {
+                values[index] = f(values[index], kv.second);
+                intersects[index] = true;
+            } else {
+                values.push_back(f(default_value, kv.second));
+            }
+        }
+        for (size_t i = 0; i < original_size; ++i) {
+            if (!intersects[i])
+                values[i] = f(values[i], default_value);
+        }
+    } else {
+        for (const std::pair<Key, Value>& kv : source) {
+            size_t index = hvec.add(kv.first);
+            if (index < original_size) {
+                values[index] = f(values[index], kv.second);
+            } else {
+                values.push_back(f(default_value, kv.second));
+            }
+        }
+    }
+}
+
+#endif // _flat_hash_vec_h_
@@ -73,6 +73,24 @@ py::array_t<double> vector_to_np(const std::vector<double>& v, const std::vector
     return py::array_t<double>(dims, &(v.data()[0]));
 }
 
+py::array_t<double> ambit_to_np_view(ambit::Tensor t) {
+    // the capsule owns a handle to the tensor, which shares (and keeps alive) its data
+    auto handle = new ambit::Tensor(t);
+    py::capsule owner(handle, [](void* p) { delete static_cast<ambit::Tensor*>(p); });
+    return py::array_t<double>(t.dims(), handle->data().data(), owner);
+}
+
+py::array_t<double> vector_to_np_view(const std::vector<double>& v,
+                                      const std::vector<size_t>& dims, py::handle base) {
+    size_t size = std::accumulate(dims.begin(), dims.end(), size_t(1), std::multiplies<>());
+    if (size != v.size()) {
+        throw std::runtime_error("vector_to_np_view: the dimensions do not match the vector size");
+    }
+    py::array_t<double> array(dims, v.data(), base);
+    py::detail::array_proxy(array.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    return array;
+}
+
 psi::SharedMatrix tensor_to_matrix(ambit::Tensor t) {
     size_t size1 = t.dim(0);
     size_t size2 = t.dim(1);
@@ -71,6 +71,24 @@ py::array_t<double> ambit_to_np(ambit::Tensor t);
 py::array_t<double> vector_to_np(const std::vector<double>& v, const std::vector<size_t>& dims);
 py::array_t<double> vector_to_np(const std::vector<double>& v, const std::vector<int>& dims);
 
+/**
+ * @brief Return a numpy ndarray that shares the memory of an ambit tensor (no copy).
+ *        The array holds a reference to the tensor data, which stays alive as long as the array.
+ * @param t The input tensor (must be a CoreTensor)
+ * @return A writable numpy array
+ */
+py::array_t<double> ambit_to_np_view(ambit::Tensor t);
+
+/**
+ * @brief Return a read-only numpy ndarray that shares the memory of a std::vector<double>.
+ * @param v The input vector
+ * @param dims The dimensions of the tensor (their product must be equal to v.size())
+ * @param base The Python object that owns v; it is kept alive as long as the array
+ * @return A read-only numpy array
+ */
+py::array_t<double> vector_to_np_view(const std::vector<double>& v,
+                                      const std::vector<size_t>& dims, py::handle base);
+
 /**
  * @brief tensor_to_matrix
  * @param t The input tensor
@@ -26,7 +26,11 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 
@@ -34,6 +38,13 @@
 #include "base_classes/mo_space_info.h"
 #include "helpers/iterative_solvers.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
 #define PRINT_VARS(msg)                                                                            \
     //    std::vector<std::pair<size_t, std::string>> v = {{collapse_size_, "collapse_size_"},           \
 //                                                     {subspace_size_, "subspace_size_"},           \
@@ -49,6 +60,158 @@ using namespace psi;
 
 namespace forte {
 
+namespace {
+/// The number of elements of each vector processed at once by the block operations
+constexpr size_t chunk_size = 32768;
+/// The norm below which an orthogonalized vector is rejected (the same as in psi4's schmidt_add)
+constexpr double linear_dependence_threshold = 1.0e-5;
+/// The smallest denominator used to form the correction vectors
+constexpr double denominator_threshold = 1.0e-6;
+
+/// Call f(begin, end) for the chunks [begin, end) of [0, size). The chunks are distributed
+/// among threads in contiguous blocks, so a thread can prefetch its next chunk
+template <typename F> void for_each_chunk(size_t size, F f) {
+    size_t nchunks = (size + chunk_size - 1) / chunk_size;
+#pragma omp parallel for schedule(static)
+    for (size_t c = 0; c < nchunks; c++) {
+        f(c * chunk_size, std::min(size, (c + 1) * chunk_size));
+    }
+}
+
+/// Sum the n numbers accumulated by f(begin, end, partial) over the chunks of [0, size). Each
+/// thread accumulates into its own buffer and the buffers are added in thread order, so the
+/// result does not depend on the scheduling
+template <typename F> std::vector<double> reduce_chunks(size_t size, size_t n, F f) {
+    std::vector<std::vector<double>> partial(omp_get_max_threads());
+    for_each_chunk(size, [&](size_t begin, size_t end) {
+        auto& partial_t = partial[omp_get_thread_num()];
+        if (partial_t.empty()) {
+            partial_t.assign(n, 0.0);
+        }
+        f(begin, end, partial_t.data());
+    });
+    std::vector<double> result(n, 0.0);
+    for (const auto& partial_t : partial) {
+        for (size_t i = 0, maxi = partial_t.size(); i < maxi; i++) {
+            result[i] += partial_t[i];
+        }
+    }
+    return result;
+}
+
+/// Return the matrix M(i,j) = x_{x0 + i} . y_{y0 + j} (i < nx, j < ny) stored by row
+std::vector<double> overlap(SubspaceVectors& x, size_t x0, size_t nx, SubspaceVectors& y,
+                            size_t y0, size_t ny) {
+    if (nx * ny == 0)
+        return std::vector<double>(nx * ny, 0.0);
+    return reduce_chunks(x.size(), nx * ny, [&](size_t begin, size_t end, double* M) {
+        x.prefetch(x0, x0 + nx, end, end + chunk_size);
+        y.prefetch(y0, y0 + ny, end, end + chunk_size);
+        C_DGEMM('N', 'T', nx, ny, end - begin, 1.0, x[x0] + begin, x.stride(), y[y0] + begin,
+                y.stride(), 1.0, M, ny);
+        x.release(x0, x0 + nx, begin, end);
+        y.release(y0, y0 + ny, begin, end);
+    });
+}
+
+/// Compute y_{y0 + j} <- beta y_{y0 + j} + sum_i C(i,j) x_{x0 + i} (i < nx, j < ny), where C is
+/// stored by row with leading dimension ldc
+void combine(SubspaceVectors& x, size_t x0, size_t nx, const double* C, size_t ldc, double beta,
+             SubspaceVectors& y, size_t y0, size_t ny) {
+    for_each_chunk(y.size(), [&](size_t begin, size_t end) {
+        x.prefetch(x0, x0 + nx, end, end + chunk_size);
+        y.prefetch(y0, y0 + ny, end, end + chunk_size);
+        if (nx > 0) {
+            C_DGEMM('T', 'N', ny, end - begin, nx, 1.0, const_cast<double*>(C), ldc,
+                    x[x0] + begin, x.stride(), beta, y[y0] + begin, y.stride());
+        } else {
+            for (size_t j = 0; j < ny; j++) {
+                C_DSCAL(end - begin, beta, y[y0 + j] + begin, 1);
+            }
+        }
+        x.release(x0, x0 + nx, begin, end);
+        y.release(y0, y0 + ny, begin, end);
+    });
+}
+
+/// Return a hash of the bits of a vector of doubles
+uint64_t hash_vector(const double* v, size_t n) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t I = 0; I < n; I++) {
+        uint64_t word;
+        std::memcpy(&word, &v[I], sizeof(uint64_t));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// Return the 2-norm of the vectors v_{v0}, ..., v_{v0 + n - 1}
+std::vector<double> norms(SubspaceVectors& v, size_t v0, size_t n) {
+    auto v_norm = reduce_chunks(v.size(), n, [&](size_t begin, size_t end, double* norm2) {
+        v.prefetch(v0, v0 + n, end, end + chunk_size);
+        for (size_t k = 0; k < n; k++) {
+            norm2[k] += C_DDOT(end - begin, v[v0 + k] + begin, 1, v[v0 + k] + begin, 1);
+        }
+        v.release(v0, v0 + n, begin, end);
+    });
+    for (auto& norm : v_norm) {
+        norm = std::sqrt(norm);
+    }
+    return v_norm;
+}
+} // namespace
+
+BlockPreconditioner::BlockPreconditioner(const psi::Vector& diagonal,
+                                         const std::vector<size_t>& block,
+                                         psi::SharedMatrix H_block)
+    : block_(block) {
+    size_t size = diagonal.dim();
+    diagonal_.resize(size);
+    for (size_t I = 0; I < size; I++) {
+        diagonal_[I] = diagonal.get(I);
+    }
+    size_t n = block_.size();
+    block_evecs_ = std::make_shared<psi::Matrix>("block evecs", n, n);
+    block_evals_ = std::make_shared<psi::Vector>("block evals", n);
+    if (n > 0) {
+        H_block->diagonalize(block_evecs_, block_evals_);
+    }
+}
+
+void BlockPreconditioner::apply(double lambda, double* r) const {
+    size_t n = block_.size();
+    // transform the block components of r to the eigenbasis of the block Hamiltonian
+    std::vector<double> r_block(n), t(n, 0.0);
+    for (size_t i = 0; i < n; i++) {
+        r_block[i] = r[block_[i]];
+    }
+    if (n > 0) {
+        C_DGEMV('T', n, n, 1.0, block_evecs_->pointer()[0], n, r_block.data(), 1, 0.0, t.data(),
+                1);
+    }
+
+    // the components outside the block use the diagonal
+    for_each_chunk(diagonal_.size(), [&](size_t begin, size_t end) {
+        for (size_t I = begin; I < end; I++) {
+            double denom = lambda - diagonal_[I];
+            r[I] = std::fabs(denom) > denominator_threshold ? r[I] / denom : 0.0;
+        }
+    });
+
+    // the components in the block are (lambda - H_block)^{-1} r_block
+    for (size_t k = 0; k < n; k++) {
+        double denom = lambda - block_evals_->get(k);
+        t[k] = std::fabs(denom) > denominator_threshold ? t[k] / denom : 0.0;
+    }
+    if (n > 0) {
+        C_DGEMV('N', n, n, 1.0, block_evecs_->pointer()[0], n, t.data(), 1, 0.0, r_block.data(),
+                1);
+    }
+    for (size_t i = 0; i < n; i++) {
+        r[block_[i]] = r_block[i];
+    }
+}
+
 DavidsonLiuSolver::DavidsonLiuSolver(size_t size, size_t nroot) : size_(size), nroot_(nroot) {
     if (size_ == 0)
         throw std::runtime_error("DavidsonLiuSolver called with space of dimension zero.");
@@ -62,15 +225,23 @@ void DavidsonLiuSolver::startup(psi::SharedVector diagonal) {
 
     basis_size_ = 0; // start with no vectors
     sigma_size_ = 0; // start with no sigma vectors
+    ritz_size_ = 0;
     iter_ = 0;
     converged_ = 0;
 
-    // store the basis vectors (each row is a vector)
-    b_ = std::make_shared<psi::Matrix>("b", subspace_size_, size_);
-    b_->zero();
-    bnew = std::make_shared<psi::Matrix>("bnew", subspace_size_, size_);
-    f = std::make_shared<psi::Matrix>("f", subspace_size_, size_);
-    sigma_ = std::make_shared<psi::Matrix>("sigma", size_, subspace_size_);
+    // store the basis, sigma, and correction vectors
+    b_ = std::make_unique<SubspaceVectors>("dl_b", subspace_size_, size_, out_of_core_);
+    bnew = std::make_unique<SubspaceVectors>("dl_bnew", std::max(collapse_size_, nroot_), size_,
+                                             out_of_core_);
+    f = std::make_unique<SubspaceVectors>("dl_f", nroot_, size_, out_of_core_);
+    sigma_ = std::make_unique<SubspaceVectors>("dl_sigma", subspace_size_, size_, out_of_core_);
+
+    if (out_of_core_ and (print_level_ > 0)) {
+        double mb = static_cast<double>(b_->memory() + bnew->memory() + f->memory() +
+                                        sigma_->memory()) /
+                    1048576.0;
+        outfile->Printf("\n  Davidson-Liu: storing %.1f MB of vectors in scratch files", mb);
+    }
 
     G = std::make_shared<psi::Matrix>("G", subspace_size_, subspace_size_);
     S = std::make_shared<psi::Matrix>("S", subspace_size_, subspace_size_);
@@ -99,49 +270,231 @@ void DavidsonLiuSolver::set_collapse_per_root(int value) { collapse_per_root_ =
 
 void DavidsonLiuSolver::set_subspace_per_root(int value) { subspace_per_root_ = value; }
 
+void DavidsonLiuSolver::set_out_of_core(bool value) { out_of_core_ = value; }
+
+void DavidsonLiuSolver::set_preconditioner(
+    std::shared_ptr<DavidsonLiuPreconditioner> preconditioner) {
+    preconditioner_ = preconditioner;
+}
+
 size_t DavidsonLiuSolver::collapse_size() const { return collapse_size_; }
 
 void DavidsonLiuSolver::add_guess(psi::SharedVector vec) {
-    // Give the next b that does not have a sigma
-    for (size_t j = 0; j < size_; ++j) {
-        b_->set(basis_size_, j, vec->get(j));
-    }
+    b_->set(basis_size_, vec->pointer());
+    b_->release(basis_size_);
     basis_size_++;
 }
 
+void DavidsonLiuSolver::collapse_ritz_vectors(size_t n, SubspaceVectors& b,
+                                              SubspaceVectors& sigma) const {
+    combine(*b_, 0, ritz_size_, alpha->pointer()[0], subspace_size_, 0.0, b, 0, n);
+    combine(*sigma_, 0, ritz_size_, alpha->pointer()[0], subspace_size_, 0.0, sigma, 0, n);
+}
+
+DavidsonLiuSubspace DavidsonLiuSolver::get_subspace() const {
+    DavidsonLiuSubspace subspace;
+    subspace.h_diag_hash = hash_vector(h_diag->pointer(), size_);
+    if (ritz_size_ == 0) {
+        // the basis changed since the last update, so the sigma vectors are not available
+        subspace.b = std::make_shared<psi::Matrix>("b", basis_size_, size_);
+        for (size_t i = 0; i < basis_size_; i++) {
+            b_->get(i, subspace.b->pointer()[i]);
+            b_->release(i);
+        }
+        return subspace;
+    }
+
+    // the Ritz vectors diagonalize the subspace Hamiltonian
+    size_t n = std::min(collapse_size_, ritz_size_);
+    SubspaceVectors b("dl_b_export", n, size_, out_of_core_);
+    SubspaceVectors sigma("dl_sigma_export", n, size_, out_of_core_);
+    collapse_ritz_vectors(n, b, sigma);
+    subspace.b = std::make_shared<psi::Matrix>("b", n, size_);
+    subspace.sigma = std::make_shared<psi::Matrix>("sigma", n, size_);
+    subspace.G = std::make_shared<psi::Matrix>("G", n, n);
+    for (size_t i = 0; i < n; i++) {
+        b.get(i, subspace.b->pointer()[i]);
+        sigma.get(i, subspace.sigma->pointer()[i]);
+        subspace.G->set(i, i, lambda->get(i));
+    }
+    return subspace;
+}
+
+size_t DavidsonLiuSolver::set_subspace(const DavidsonLiuSubspace& subspace) {
+    if (static_cast<size_t>(subspace.b->coldim()) != size_) {
+        throw std::runtime_error("DavidsonLiuSolver::set_subspace: the subspace vectors have "
+                                 "dimension " +
+                                 std::to_string(subspace.b->coldim()) + " instead of " +
+                                 std::to_string(size_));
+    }
+    size_t n = std::min(static_cast<size_t>(subspace.b->rowdim()), collapse_size_);
+    bool reuse_sigma = subspace.sigma and (subspace.h_diag_hash == hash_vector(h_diag->pointer(),
+                                                                             size_));
+
+    // copy the vectors in the space after the current basis and orthonormalize them
+    SubspaceVectors v("dl_import", n, size_, out_of_core_);
+    for (size_t i = 0; i < n; i++) {
+        v.set(i, subspace.b->pointer()[i]);
+    }
+    size_t old_basis_size = basis_size_;
+    std::vector<size_t> candidates(n);
+    std::iota(candidates.begin(), candidates.end(), 0);
+    add_to_basis(v, candidates);
+
+    // the sigma vectors can be reused only if all the vectors were kept unchanged, which is the
+    // case for the orthonormal Ritz vectors returned by get_subspace()
+    if (reuse_sigma and (old_basis_size == 0) and (basis_size_ == n) and (sigma_size_ == 0)) {
+        double max_error = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            for (size_t I = 0; I < size_; I++) {
+                max_error = std::max(max_error, std::fabs((*b_)[i][I] - subspace.b->get(i, I)));
+            }
+        }
+        if (max_error < 1.0e-10) {
+            for (size_t i = 0; i < n; i++) {
+                sigma_->set(i, subspace.sigma->pointer()[i]);
+                sigma_->release(i);
+            }
+            sigma_size_ = n;
+        }
+    }
+    return basis_size_ - old_basis_size;
+}
+
+void DavidsonLiuSolver::save_subspace(const std::string& filename) const {
+    DavidsonLiuSubspace subspace = get_subspace();
+    uint64_t header[4] = {size_, static_cast<uint64_t>(subspace.b->rowdim()),
+                          subspace.sigma ? 1ULL : 0ULL, subspace.h_diag_hash};
+    size_t n = header[1];
+
+    // write to a temporary file first, so that an interrupted write does not corrupt a checkpoint
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream out(tmp_filename, std::ios_base::binary);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    std::vector<psi::SharedMatrix> mats{subspace.b};
+    if (subspace.sigma) {
+        mats.push_back(subspace.sigma);
+        mats.push_back(subspace.G);
+    }
+    for (const auto& mat : mats) {
+        size_t ncol = mat->coldim();
+        for (size_t i = 0; i < n; i++) {
+            out.write(reinterpret_cast<const char*>(mat->pointer()[i]), ncol * sizeof(double));
+        }
+    }
+    out.close();
+    if (not out or (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)) {
+        throw std::runtime_error("DavidsonLiuSolver::save_subspace: cannot write " + filename);
+    }
+}
+
+size_t DavidsonLiuSolver::load_subspace(const std::string& filename) {
+    std::ifstream in(filename, std::ios_base::binary);
+    if (not in.good())
+        return 0;
+    uint64_t header[4];
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (not in or (header[0] != size_)) {
+        outfile->Printf("\n  The Davidson-Liu subspace in %s has the wrong size. It will not be "
+                        "used.",
+                        filename.c_str());
+        return 0;
+    }
+    size_t n = header[1];
+
+    DavidsonLiuSubspace subspace;
+    subspace.h_diag_hash = header[3];
+    subspace.b = std::make_shared<psi::Matrix>("b", n, size_);
+    std::vector<psi::SharedMatrix> mats{subspace.b};
+    if (header[2] == 1) {
+        subspace.sigma = std::make_shared<psi::Matrix>("sigma", n, size_);
+        subspace.G = std::make_shared<psi::Matrix>("G", n, n);
+        mats.push_back(subspace.sigma);
+        mats.push_back(subspace.G);
+    }
+    for (const auto& mat : mats) {
+        size_t ncol = mat->coldim();
+        for (size_t i = 0; i < n; i++) {
+            in.read(reinterpret_cast<char*>(mat->pointer()[i]), ncol * sizeof(double));
+        }
+    }
+    if (not in) {
+        throw std::runtime_error("DavidsonLiuSolver::load_subspace: cannot read " + filename);
+    }
+    return set_subspace(subspace);
+}
+
 void DavidsonLiuSolver::get_b(psi::SharedVector vec) {
     PRINT_VARS("get_b")
     // Give the next b that does not have a sigma
-    for (size_t j = 0; j < size_; ++j) {
-        vec->set(j, b_->get(sigma_size_, j));
+    b_->get(sigma_size_, vec->pointer());
+    b_->release(sigma_size_);
+}
+
+void DavidsonLiuSolver::get_b(psi::SharedVector vec, size_t n) {
+    PRINT_VARS("get_b")
+    if (sigma_size_ + n >= basis_size_) {
+        throw std::runtime_error("DavidsonLiuSolver::get_b: the requested basis vector does not "
+                                 "exist.");
     }
+    if (sigma_size_ + n + 1 < basis_size_) {
+        b_->prefetch(sigma_size_ + n + 1);
+    }
+    b_->get(sigma_size_ + n, vec->pointer());
+    b_->release(sigma_size_ + n);
 }
 
+void DavidsonLiuSolver::get_b_block(const std::vector<psi::SharedVector>& vecs) {
+    for (size_t n = 0, nvec = vecs.size(); n < nvec; ++n) {
+        get_b(vecs[n], n);
+    }
+}
+
+size_t DavidsonLiuSolver::num_pending_sigma() const { return basis_size_ - sigma_size_; }
+
 bool DavidsonLiuSolver::add_sigma(psi::SharedVector vec) {
     PRINT_VARS("add_sigma")
     // Place the new sigma vector at the end
-    for (size_t j = 0; j < size_; ++j) {
-        sigma_->set(j, sigma_size_, vec->get(j));
-    }
+    sigma_->set(sigma_size_, vec->pointer());
+    sigma_->release(sigma_size_);
     sigma_size_++;
     return (sigma_size_ < basis_size_);
 }
 
+bool DavidsonLiuSolver::add_sigma_block(const std::vector<psi::SharedVector>& vecs) {
+    bool add = sigma_size_ < basis_size_;
+    for (const auto& vec : vecs) {
+        add = add_sigma(vec);
+    }
+    return add;
+}
+
+void DavidsonLiuSolver::reset_sigma() {
+    PRINT_VARS("reset_sigma")
+    sigma_size_ = 0;
+    ritz_size_ = 0;
+    converged_ = 0;
+}
+
 void DavidsonLiuSolver::set_project_out(std::vector<sparse_vec> project_out) {
     project_out_ = project_out;
 }
 
 psi::SharedVector DavidsonLiuSolver::eigenvalues() const { return lambda; }
 
-psi::SharedMatrix DavidsonLiuSolver::eigenvectors() const { return bnew; }
+psi::SharedMatrix DavidsonLiuSolver::eigenvectors() const {
+    auto evecs = std::make_shared<psi::Matrix>("V", nroot_, size_);
+    for (size_t n = 0; n < nroot_; n++) {
+        bnew->get(n, evecs->pointer()[n]);
+        bnew->release(n);
+    }
+    return evecs;
+}
 
 psi::SharedVector DavidsonLiuSolver::eigenvector(size_t n) const {
-    double** v = bnew->pointer();
-
     psi::SharedVector evec(new psi::Vector("V", size_));
-    for (size_t I = 0; I < size_; I++) {
-        evec->set(I, v[n][I]);
-    }
+    bnew->get(n, evec->pointer());
+    bnew->release(n);
     return evec;
 }
 
@@ -160,8 +513,14 @@ SolverStatus DavidsonLiuSolver::update() {
 
     // form and diagonalize mini-matrix
     G->zero();
-    G->gemm(false, false, 1.0, b_, sigma_, 0.0);
+    auto b_sigma = overlap(*b_, 0, basis_size_, *sigma_, 0, basis_size_);
+    for (size_t i = 0; i < basis_size_; i++) {
+        for (size_t j = 0; j < basis_size_; j++) {
+            G->set(i, j, b_sigma[i * basis_size_ + j]);
+        }
+    }
     G->diagonalize(alpha, lambda);
+    ritz_size_ = basis_size_;
 
     bool is_energy_converged = false;
     bool is_residual_converged = false;
@@ -193,27 +552,27 @@ SolverStatus DavidsonLiuSolver::update() {
     form_correction_vectors();
 
     // Step #3b: Project out undesired roots
-    project_out_roots(f);
+    project_out_roots(*f);
 
     // Step #4: Normalize the Correction Vectors
-    auto f_norm = normalize_vectors(f, nroot_);
+    auto f_norm = normalize_vectors(*f, nroot_);
 
-    // schmidt orthogonalize the f[k] against the set of b[i] and add new
-    // vectors
-    size_t num_added = 0;
+    // check that the norm of the correction vectors (before normalization) is "not small"
+    std::vector<size_t> candidates;
     for (size_t k = 0; k < nroot_; k++) {
-        if (basis_size_ < subspace_size_) {
-            // check that the norm of the correction vector (before normalization) is "not small"
-            if (f_norm[k] > 0.01 * r_convergence_) {
-                // Schmidt-orthogonalize the correction vector
-                if (schmidt_add(b_->pointer(), basis_size_, size_, f->pointer()[k])) {
-                    basis_size_++; // <- Increase L if we add one more basis vector
-                    num_added += 1;
-                } else {
-                    outfile->Printf("\n  Rejected new correction vector %d with norm: %f", k,
-                                    f_norm[k]);
-                }
-            }
+        if (f_norm[k] > 0.01 * r_convergence_) {
+            candidates.push_back(k);
+        }
+    }
+
+    // orthogonalize the f[k] against the set of b[i] and add new vectors
+    size_t old_basis_size = basis_size_;
+    auto rejected = add_to_basis(*f, candidates);
+    size_t num_added = basis_size_ - old_basis_size;
+    for (size_t j = 0; j < candidates.size(); j++) {
+        if (rejected[j]) {
+            outfile->Printf("\n  Rejected new correction vector %d with norm: %f", candidates[j],
+                            f_norm[candidates[j]]);
         }
     }
 
@@ -230,87 +589,119 @@ SolverStatus DavidsonLiuSolver::update() {
 }
 
 void DavidsonLiuSolver::form_correction_vectors() {
-    f->zero();
+    // the residual vectors are stored in f
+    compute_residual_norm();
+
     double* lambda_p = lambda->pointer();
     double* Adiag_p = h_diag->pointer();
-    double** b_p = b_->pointer();
-    double** f_p = f->pointer();
-    double** alpha_p = alpha->pointer();
-    double** sigma_p = sigma_->pointer();
-
     for (size_t k = 0; k < nroot_; k++) { // loop over roots
-        residual_[k] = 0.0;
-        for (size_t I = 0; I < size_; I++) { // loop over elements
-            for (size_t i = 0; i < basis_size_; i++) {
-                f_p[k][I] += alpha_p[i][k] * (sigma_p[I][i] - lambda_p[k] * b_p[i][I]);
-            }
-            residual_[k] += std::pow(f_p[k][I], 2.0);
-
-            double denom = lambda_p[k] - Adiag_p[I];
-            if (std::fabs(denom) > 1.0e-6) {
-                f_p[k][I] /= denom;
-            } else {
-                f_p[k][I] = 0.0;
-            }
+        double* f_k = (*f)[k];
+        if (preconditioner_) {
+            preconditioner_->apply(lambda_p[k], f_k);
+            continue;
         }
-        residual_[k] = std::sqrt(residual_[k]);
+        for_each_chunk(size_, [&](size_t begin, size_t end) {
+            for (size_t I = begin; I < end; I++) { // loop over elements
+                double denom = lambda_p[k] - Adiag_p[I];
+                if (std::fabs(denom) > denominator_threshold) {
+                    f_k[I] /= denom;
+                } else {
+                    f_k[I] = 0.0;
+                }
+            }
+        });
     }
 }
 
 void DavidsonLiuSolver::compute_residual_norm() {
     double* lambda_p = lambda->pointer();
-    double** b_p = b_->pointer();
     double** alpha_p = alpha->pointer();
-    double** sigma_p = sigma_->pointer();
 
-    for (size_t k = 0; k < nroot_; k++) { // loop over roots
-        residual_[k] = 0.0;
-        for (size_t I = 0; I < size_; I++) { // loop over elements
-            double r = 0.0;
-            for (size_t i = 0; i < basis_size_; i++) {
-                r += alpha_p[i][k] * (sigma_p[I][i] - lambda_p[k] * b_p[i][I]);
-            }
-            residual_[k] += std::pow(r, 2.0);
+    // form the residual vectors f_k = sum_i alpha_ik (sigma_i - lambda_k b_i)
+    std::vector<double> alpha_lambda(basis_size_ * nroot_);
+    for (size_t i = 0; i < basis_size_; i++) {
+        for (size_t k = 0; k < nroot_; k++) {
+            alpha_lambda[i * nroot_ + k] = -lambda_p[k] * alpha_p[i][k];
         }
-        residual_[k] = std::sqrt(residual_[k]);
     }
+    combine(*sigma_, 0, basis_size_, alpha_p[0], subspace_size_, 0.0, *f, 0, nroot_);
+    combine(*b_, 0, basis_size_, alpha_lambda.data(), nroot_, 1.0, *f, 0, nroot_);
+
+    residual_ = norms(*f, 0, nroot_);
 }
 
-void DavidsonLiuSolver::project_out_roots(psi::SharedMatrix v) {
-    double** v_p = v->pointer();
+void DavidsonLiuSolver::project_out_roots(SubspaceVectors& v) {
     for (size_t k = 0; k < nroot_; k++) {
+        double* v_k = v[k];
         for (auto& bad_root : project_out_) {
             double overlap = 0.0;
             for (auto& I_CI : bad_root) {
                 size_t I = I_CI.first;
                 double CI = I_CI.second;
-                overlap += v_p[k][I] * CI;
+                overlap += v_k[I] * CI;
             }
             for (auto& I_CI : bad_root) {
                 size_t I = I_CI.first;
                 double CI = I_CI.second;
-                v_p[k][I] -= overlap * CI;
+                v_k[I] -= overlap * CI;
             }
         }
     }
 }
 
-std::vector<double> DavidsonLiuSolver::normalize_vectors(psi::SharedMatrix v, size_t n) {
+std::vector<double> DavidsonLiuSolver::normalize_vectors(SubspaceVectors& v, size_t n) {
     // normalize each residual
-    std::vector<double> v_norm;
-    double** v_p = v->pointer();
-    for (size_t k = 0; k < n; k++) {
-        double norm = 0.0;
-        for (size_t I = 0; I < size_; I++) {
-            norm += v_p[k][I] * v_p[k][I];
+    std::vector<double> v_norm = norms(v, 0, n);
+    for_each_chunk(size_, [&](size_t begin, size_t end) {
+        for (size_t k = 0; k < n; k++) {
+            C_DSCAL(end - begin, 1.0 / v_norm[k], v[k] + begin, 1);
         }
-        norm = std::sqrt(norm);
-        v_norm.push_back(norm);
-        for (size_t I = 0; I < size_; I++) {
-            v_p[k][I] /= norm;
+    });
+    return v_norm;
+}
+
+std::vector<bool> DavidsonLiuSolver::add_to_basis(SubspaceVectors& v,
+                                                  const std::vector<size_t>& candidates) {
+    size_t ncand = candidates.size();
+    std::vector<bool> rejected(ncand, false);
+
+    // move the candidates to the beginning of v
+    for (size_t j = 0; j < ncand; j++) {
+        if (candidates[j] != j) {
+            v.set(j, v[candidates[j]]);
         }
     }
-    return v_norm;
+
+    // project the current basis out of the candidates with two passes of block classical
+    // Gram-Schmidt (the second pass restores the orthogonality lost to round-off)
+    size_t old_basis_size = basis_size_;
+    for (int pass = 0; pass < 2; pass++) {
+        auto b_v = overlap(*b_, 0, old_basis_size, v, 0, ncand);
+        for (auto& x : b_v) {
+            x = -x;
+        }
+        combine(*b_, 0, old_basis_size, b_v.data(), ncand, 1.0, v, 0, ncand);
+    }
+
+    // orthonormalize the candidates among themselves and add them to the basis
+    for (size_t j = 0; (j < ncand) and (basis_size_ < subspace_size_); j++) {
+        size_t num_new = basis_size_ - old_basis_size;
+        auto b_v = overlap(*b_, old_basis_size, num_new, v, j, 1);
+        for (auto& x : b_v) {
+            x = -x;
+        }
+        combine(*b_, old_basis_size, num_new, b_v.data(), 1, 1.0, v, j, 1);
+
+        double norm = norms(v, j, 1)[0];
+        if (norm < linear_dependence_threshold) {
+            rejected[j] = true;
+            continue;
+        }
+        double scale = 1.0 / norm;
+        combine(v, j, 1, &scale, 1, 0.0, *b_, basis_size_, 1);
+        basis_size_++; // <- Increase L if we add one more basis vector
+    }
+    return rejected;
 }
 
 bool DavidsonLiuSolver::subspace_collapse() {
@@ -322,20 +713,20 @@ bool DavidsonLiuSolver::subspace_collapse() {
         collapse_vectors();
 
         // normalize new vectors
-        normalize_vectors(bnew, collapse_size_);
+        normalize_vectors(*bnew, collapse_size_);
 
         // Copy them into place
-        b_->zero();
-        basis_size_ = 0;
-        sigma_size_ = 0;
+        auto bnew_norm = norms(*bnew, 0, collapse_size_);
+        std::vector<size_t> candidates;
         for (size_t k = 0; k < collapse_size_; k++) {
-            double norm_bnew_k = std::fabs(bnew->get_row(0, k)->norm());
-            if (norm_bnew_k > schmidt_threshold_) {
-                if (schmidt_add(b_->pointer(), k, size_, bnew->pointer()[k])) {
-                    basis_size_++; // <- Increase L if we add one more basis vector
-                }
+            if (bnew_norm[k] > schmidt_threshold_) {
+                candidates.push_back(k);
             }
         }
+        basis_size_ = 0;
+        sigma_size_ = 0;
+        ritz_size_ = 0;
+        add_to_basis(*bnew, candidates);
         return false;
     }
 
@@ -353,17 +744,15 @@ bool DavidsonLiuSolver::subspace_collapse() {
         collapse_vectors();
 
         // normalize new vectors
-        normalize_vectors(bnew, collapse_size_);
+        normalize_vectors(*bnew, collapse_size_);
 
         // Copy them into place
-        b_->zero();
+        std::vector<size_t> candidates(collapse_size_);
+        std::iota(candidates.begin(), candidates.end(), 0);
         basis_size_ = 0;
         sigma_size_ = 0;
-        for (size_t k = 0; k < collapse_size_; k++) {
-            if (schmidt_add(b_->pointer(), k, size_, bnew->pointer()[k])) {
-                basis_size_++; // <- Increase L if we add one more basis vector
-            }
-        }
+        ritz_size_ = 0;
+        add_to_basis(*bnew, candidates);
 
         /// Need new sigma vectors to continue, so return control to caller
         return true;
@@ -372,17 +761,9 @@ bool DavidsonLiuSolver::subspace_collapse() {
 }
 
 void DavidsonLiuSolver::collapse_vectors() {
-    bnew->zero();
-    double** alpha_p = alpha->pointer();
-    double** b_p = b_->pointer();
-    double** bnew_p = bnew->pointer();
-    for (size_t i = 0; i < collapse_size_; i++) {
-        for (size_t j = 0; j < basis_size_; j++) {
-            for (size_t k = 0; k < size_; k++) {
-                bnew_p[i][k] += alpha_p[j][i] * b_p[j][k];
-            }
-        }
-    }
+    // bnew_i = sum_j alpha_ji b_j
+    combine(*b_, 0, basis_size_, alpha->pointer()[0], subspace_size_, 0.0, *bnew, 0,
+            collapse_size_);
 }
 
 std::pair<bool, bool> DavidsonLiuSolver::check_convergence() {
@@ -425,29 +806,13 @@ std::pair<bool, bool> DavidsonLiuSolver::check_convergence() {
 
 void DavidsonLiuSolver::get_results() {
     /* generate final eigenvalues and eigenvectors */
-    double** alpha_p = alpha->pointer();
-    double** b_p = b_->pointer();
     double* eps = lambda_old->pointer();
-    double** v = bnew->pointer();
-    bnew->zero();
-
     for (size_t i = 0; i < nroot_; i++) {
         eps[i] = lambda->get(i);
-        for (size_t j = 0; j < basis_size_; j++) {
-            for (size_t I = 0; I < size_; I++) {
-                v[i][I] += alpha_p[j][i] * b_p[j][I];
-            }
-        }
-        // Normalize v
-        double norm = 0.0;
-        for (size_t I = 0; I < size_; I++) {
-            norm += v[i][I] * v[i][I];
-        }
-        norm = std::sqrt(norm);
-        for (size_t I = 0; I < size_; I++) {
-            v[i][I] /= norm;
-        }
     }
+    combine(*b_, 0, basis_size_, alpha->pointer()[0], subspace_size_, 0.0, *bnew, 0, nroot_);
+    // Normalize v
+    normalize_vectors(*bnew, nroot_);
     //    if (print_level_){
     //        outfile->Printf("\n  The Davidson-Liu algorithm converged in %d
     //        iterations.", iter_);
@@ -460,7 +825,13 @@ bool DavidsonLiuSolver::check_orthogonality() {
     bool is_orthonormal = true;
 
     // Compute the overlap matrix
-    S->gemm(false, true, 1.0, b_, b_, 0.0);
+    S->zero();
+    auto b_b = overlap(*b_, 0, basis_size_, *b_, 0, basis_size_);
+    for (size_t i = 0; i < basis_size_; ++i) {
+        for (size_t j = 0; j < basis_size_; ++j) {
+            S->set(i, j, b_b[i * basis_size_ + j]);
+        }
+    }
 
     // Check for orthogonality
     for (size_t i = 0; i < basis_size_; ++i) {
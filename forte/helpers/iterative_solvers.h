@@ -29,15 +29,84 @@
 #ifndef _iterative_solvers_h_
 #define _iterative_solvers_h_
 
+#include <cstdint>
+#include <memory>
+#include <string>
+
 #include "psi4/libqt/qt.h"
 #include "psi4/libmints/vector.h"
 #include "psi4/libmints/matrix.h"
 
+#include "helpers/subspace_vectors.h"
+
 namespace forte {
 
 /// Result of the update step
 enum class SolverStatus { Converged, NotConverged, Collapse };
 
+/**
+ * @brief The DavidsonLiuSubspace struct
+ * A copy of the subspace of a Davidson-Liu computation, used to restart the solver.
+ */
+struct DavidsonLiuSubspace {
+    /// The basis vectors, stored by row
+    psi::SharedMatrix b;
+    /// The sigma vectors of the basis vectors, stored by row (nullptr if not available)
+    psi::SharedMatrix sigma;
+    /// The subspace Hamiltonian G_ij = b_i . sigma_j (nullptr if not available)
+    psi::SharedMatrix G;
+    /// A hash of the diagonal of the Hamiltonian used to compute the sigma vectors
+    uint64_t h_diag_hash = 0;
+};
+
+/**
+ * @brief The DavidsonLiuPreconditioner class
+ * Interface for the preconditioner used to form the Davidson-Liu correction vectors.
+ * Given the residual r of an approximate eigenpair with eigenvalue lambda, apply() replaces r
+ * with the correction vector (lambda - H0)^{-1} r, where H0 is an approximation to the
+ * Hamiltonian. Without a preconditioner the solver uses H0 = diag(H).
+ */
+class DavidsonLiuPreconditioner {
+  public:
+    /// Virtual destructor to enable deletion of a Derived* through a Base*
+    virtual ~DavidsonLiuPreconditioner() = default;
+
+    /// Replace the residual r with the correction vector (lambda - H0)^{-1} r
+    virtual void apply(double lambda, double* r) const = 0;
+};
+
+/**
+ * @brief The BlockPreconditioner class
+ * A preconditioner in which H0 is the Hamiltonian in a block of basis vectors and the diagonal
+ * of the Hamiltonian elsewhere. The block Hamiltonian is diagonalized once, so apply() costs
+ * O(N + n^2) for a block of size n.
+ */
+class BlockPreconditioner : public DavidsonLiuPreconditioner {
+  public:
+    /// Constructor
+    /// @param diagonal the diagonal of the Hamiltonian
+    /// @param block the indices of the basis vectors in the block
+    /// @param H_block the Hamiltonian in the block
+    BlockPreconditioner(const psi::Vector& diagonal, const std::vector<size_t>& block,
+                        psi::SharedMatrix H_block);
+
+    /// Replace the residual r with the correction vector (lambda - H0)^{-1} r
+    void apply(double lambda, double* r) const override;
+
+    /// Return the number of basis vectors in the block
+    size_t block_size() const { return block_.size(); }
+
+  private:
+    /// The diagonal of the Hamiltonian
+    std::vector<double> diagonal_;
+    /// The indices of the basis vectors in the block
+    std::vector<size_t> block_;
+    /// The eigenvectors of the block Hamiltonian
+    psi::SharedMatrix block_evecs_;
+    /// The eigenvalues of the block Hamiltonian
+    psi::SharedVector block_evals_;
+};
+
 /**
  * @brief The DavidsonLiuSolver class
  * This class diagonalizes the Hamiltonian in a basis
@@ -64,6 +133,27 @@ enum class SolverStatus { Converged, NotConverged, Collapse };
  *         converged = dls.update();              // check convergence
  *         if (converged == Converged) break;
  *     }
+ *
+ * Several sigma vectors can be computed at once with get_b_block() and add_sigma_block():
+ *
+ *         do{
+ *             size_t k = dls.num_pending_sigma();  // number of vectors without a sigma
+ *             ...                                  // resize b_block and sigma_block to k
+ *             dls.get_b_block(b_block);            // solver provides k vectors b
+ *             ...                                  // code to compute sigma = Hb
+ *             add_sigma = dls.add_sigma_block(sigma_block);
+ *         } while (add_sigma);
+ *
+ * For very large spaces, set_out_of_core(true) stores the basis and sigma vectors in
+ * memory-mapped scratch files. The solver then streams through them one vector at a time.
+ *
+ * The correction vectors are formed with the diagonal of the Hamiltonian passed to startup(),
+ * unless a preconditioner is passed to set_preconditioner().
+ *
+ * The solver can be restarted from the subspace of a previous computation: get_subspace() and
+ * save_subspace() export the lowest Ritz vectors and their sigma vectors, set_subspace() and
+ * load_subspace() use them instead of the guess vectors. The sigma vectors are reused only if
+ * the Hamiltonian has the same diagonal, so after an orbital update only the basis is reused.
  */
 class DavidsonLiuSolver {
     using sparse_vec = std::vector<std::pair<size_t, double>>;
@@ -93,16 +183,48 @@ class DavidsonLiuSolver {
     void set_collapse_per_root(int value);
     /// Set the maximum subspace size for each root
     void set_subspace_per_root(int value);
+    /// Store the basis and sigma vectors in scratch files instead of memory. Must be called
+    /// before startup()
+    void set_out_of_core(bool value);
+    /// Set the preconditioner used to form the correction vectors (nullptr = use the diagonal)
+    void set_preconditioner(std::shared_ptr<DavidsonLiuPreconditioner> preconditioner);
 
     /// Return the size of the collapse vectors
     size_t collapse_size() const;
 
     /// Add a guess basis vector
     void add_guess(psi::SharedVector vec);
+    /// Return the current subspace collapsed to (at most) collapse_size() Ritz vectors. The
+    /// sigma vectors are included if they are available
+    DavidsonLiuSubspace get_subspace() const;
+    /// Use the basis vectors of subspace as guess. Must be called after startup() and instead of
+    /// add_guess(). The sigma vectors are reused if subspace was computed with the same diagonal
+    /// of the Hamiltonian
+    /// @return the number of basis vectors added
+    size_t set_subspace(const DavidsonLiuSubspace& subspace);
+    /// Save the subspace returned by get_subspace() to a binary file
+    void save_subspace(const std::string& filename) const;
+    /// Read a subspace saved by save_subspace() and pass it to set_subspace()
+    /// @return the number of basis vectors added (zero if the file does not exist or contains
+    /// vectors of a different dimension)
+    size_t load_subspace(const std::string& filename);
     /// Get a basis vector
     void get_b(psi::SharedVector vec);
+    /// Get the n-th basis vector that does not have a sigma vector (n = 0 is the one returned
+    /// by get_b(vec)). This allows to form several sigma vectors at once.
+    void get_b(psi::SharedVector vec, size_t n);
+    /// Fill vecs with the first vecs.size() basis vectors that do not have a sigma vector
+    void get_b_block(const std::vector<psi::SharedVector>& vecs);
+    /// Return the number of basis vectors that do not have a sigma vector
+    size_t num_pending_sigma() const;
     /// Add a sigma vector
     bool add_sigma(psi::SharedVector vec);
+    /// Add the sigma vectors of the vectors returned by get_b_block()
+    /// @return true if there are basis vectors that still do not have a sigma vector
+    bool add_sigma_block(const std::vector<psi::SharedVector>& vecs);
+    /// Discard the sigma vectors of the current basis. The basis vectors are kept and returned
+    /// again by get_b(), so that their sigma vectors can be recomputed (e.g. more accurately)
+    void reset_sigma();
 
     void set_project_out(std::vector<sparse_vec> project_out);
 
@@ -138,14 +260,21 @@ class DavidsonLiuSolver {
     /// Compute the 2-norm of the residual
     void compute_residual_norm();
     /// Project out undesired roots
-    void project_out_roots(psi::SharedMatrix v);
+    void project_out_roots(SubspaceVectors& v);
     /// Normalize the correction vectors and return the norm of the vectors before they were
     /// normalized
-    std::vector<double> normalize_vectors(psi::SharedMatrix v, size_t n);
+    std::vector<double> normalize_vectors(SubspaceVectors& v, size_t n);
+    /// Orthonormalize the vectors v[k] (k in candidates) against the basis and among themselves
+    /// and add them to the basis. The candidates are moved to the beginning of v. A candidate is
+    /// rejected if it is linearly dependent on the basis
+    /// @return a vector that is true for the rejected candidates
+    std::vector<bool> add_to_basis(SubspaceVectors& v, const std::vector<size_t>& candidates);
     /// Perform subspace collapse
     bool subspace_collapse();
     /// Collapse the vectors
     void collapse_vectors();
+    /// Collapse the subspace to the first n Ritz vectors and their sigma vectors
+    void collapse_ritz_vectors(size_t n, SubspaceVectors& b, SubspaceVectors& sigma) const;
 
     // ==> Class Private Data <==
 
@@ -169,23 +298,28 @@ class DavidsonLiuSolver {
     size_t collapse_size_;
     /// The maximum subspace size
     size_t subspace_size_;
+    /// Store the basis and sigma vectors in scratch files?
+    bool out_of_core_ = false;
 
     int iter_ = 0;
     size_t basis_size_;
+    /// The number of basis vectors that the eigenvectors of G (alpha) refer to. Zero if the basis
+    /// or the sigma vectors changed since G was diagonalized
+    size_t ritz_size_ = 0;
     /// The size
     size_t sigma_size_;
     size_t converged_ = 0;
     double timing_ = 0.0;
     bool last_update_collapsed_ = false;
 
-    /// Current set of basis vectors stored by row
-    psi::SharedMatrix b_;
-    /// Guess vectors formed from old vectors, stored by row
-    psi::SharedMatrix bnew;
-    /// Residual eigenvectors, stored by row
-    psi::SharedMatrix f;
-    /// Sigma vectors, stored by column
-    psi::SharedMatrix sigma_;
+    /// Current set of basis vectors
+    std::unique_ptr<SubspaceVectors> b_;
+    /// Guess vectors formed from old vectors
+    std::unique_ptr<SubspaceVectors> bnew;
+    /// Residual eigenvectors
+    std::unique_ptr<SubspaceVectors> f;
+    /// Sigma vectors
+    std::unique_ptr<SubspaceVectors> sigma_;
     /// Davidson-Liu mini-Hamitonian
     psi::SharedMatrix G;
     /// Davidson-Liu mini-metric
@@ -204,6 +338,8 @@ class DavidsonLiuSolver {
 
     /// Approximate eigenstates to project out
     std::vector<sparse_vec> project_out_;
+    /// The preconditioner used to form the correction vectors
+    std::shared_ptr<DavidsonLiuPreconditioner> preconditioner_;
 };
 } // namespace forte
 
@@ -26,7 +26,9 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include "psi4/psi4-dec.h"
 #include "psi4/libmints/vector.h"
@@ -48,6 +50,12 @@ LBFGS::LBFGS(std::shared_ptr<LBFGS_PARAM> param) : param_(param) { param_->check
 template <class Foo> double LBFGS::minimize(Foo& func, psi::SharedVector x) {
     nirrep_ = x->nirrep();
     dimpi_ = x->dimpi();
+    n_ = 0;
+    offsets_.resize(nirrep_);
+    for (int h = 0; h < nirrep_; ++h) {
+        offsets_[h] = n_;
+        n_ += dimpi_[h];
+    }
 
     g_ = std::make_shared<psi::Vector>("g", dimpi_);
 
@@ -65,19 +73,28 @@ template <class Foo> double LBFGS::minimize(Foo& func, psi::SharedVector x) {
     // routine of diagonal Hessian
     auto compute_h0 = [&](psi::SharedVector x) {
         func.hess_diag(x, h0_);
+        flatten(h0_, h0_flat_.data());
         if (param_->print > 2) {
             print_h2("Diagonal Hessian at Iter. " + std::to_string(iter_));
             h0_->print();
         }
     };
 
-    // initialize some vectors
+    // allocate all the vectors once
     reset();
+    int nbase = 2 * param_->m + 1;
+    base_.assign(nbase * n_, 0.0);
+    gram_.assign(nbase * nbase, 0.0);
+    delta_.resize(nbase);
+    dots_.resize(nbase);
     p_ = std::make_shared<psi::Vector>("p", dimpi_);
-    x_last_ = std::make_shared<psi::Vector>(*x);
-    g_last_ = std::make_shared<psi::Vector>(*g_);
+    p_flat_.resize(n_);
+    x_last_.resize(n_);
+    flatten(x, x_last_.data());
+    flatten(g_, g_ptr());
     if (param_->h0_freq >= 0) {
         h0_ = std::make_shared<psi::Vector>("h0", dimpi_);
+        h0_flat_.resize(n_);
         compute_h0(x);
     }
 
@@ -116,60 +133,149 @@ template <class Foo> double LBFGS::minimize(Foo& func, psi::SharedVector x) {
         }
 
         // save history
-        int index = (iter_ - 1) % param_->m;
+        save_history(x, (iter_ - 1) % param_->m);
+    } while (iter_ < param_->maxiter);
 
-        if (iter_ <= param_->m) {
-            s_[index] = std::make_shared<psi::Vector>("s", dimpi_);
-            y_[index] = std::make_shared<psi::Vector>("y", dimpi_);
-        }
+    if ((not converged_) and param_->print > 1) {
+        outfile->Printf("\n  Warning: L-BFGS did not converge in %d iterations", iter_);
+    }
 
-        s_[index]->copy(*x);
-        s_[index]->subtract(x_last_);
+    return fx;
+}
 
-        y_[index]->copy(*g_);
-        y_[index]->subtract(g_last_);
+void LBFGS::flatten(psi::SharedVector v, double* out) {
+    for (int h = 0; h < nirrep_; ++h) {
+        if (dimpi_[h] > 0)
+            std::memcpy(out + offsets_[h], v->pointer(h), dimpi_[h] * sizeof(double));
+    }
+}
 
-        rho_[index] = 1.0 / y_[index]->vector_dot(s_[index]);
+void LBFGS::unflatten(const double* in, psi::SharedVector v) {
+    for (int h = 0; h < nirrep_; ++h) {
+        if (dimpi_[h] > 0)
+            std::memcpy(v->pointer(h), in + offsets_[h], dimpi_[h] * sizeof(double));
+    }
+}
 
-        x_last_->copy(*x);
-        g_last_->copy(*g_);
-    } while (iter_ < param_->maxiter);
+void LBFGS::update_gram(int k) {
+    int nbase = 2 * param_->m + 1;
+    C_DGEMV('N', nbase, n_, 1.0, base_.data(), n_, base_.data() + k * n_, 1, 0.0, dots_.data(),
+            1);
+    for (int i = 0; i < nbase; ++i) {
+        gram_[k * nbase + i] = dots_[i];
+        gram_[i * nbase + k] = dots_[i];
+    }
+}
 
-    if ((not converged_) and param_->print > 1) {
-        outfile->Printf("\n  Warning: L-BFGS did not converge in %d iterations", iter_);
+void LBFGS::save_history(psi::SharedVector x, int index) {
+    double* s = s_ptr(index);
+    double* y = y_ptr(index);
+    double* g = g_ptr();
+
+    // s = x - x_last, y = g - g_last; the last values are replaced by the current ones
+#pragma omp parallel for simd
+    for (size_t I = 0; I < n_; ++I) {
+        s[I] = -x_last_[I];
+        y[I] = -g[I];
+    }
+    flatten(x, x_last_.data());
+    flatten(g_, g);
+#pragma omp parallel for simd
+    for (size_t I = 0; I < n_; ++I) {
+        s[I] += x_last_[I];
+        y[I] += g[I];
     }
 
-    return fx;
+    rho_[index] = 1.0 / C_DDOT(n_, y, 1, s, 1);
+
+    // the vector-free recursion needs the dot products of the new vectors with all the others
+    if (param_->h0_freq < 0) {
+        update_gram(index);
+        update_gram(param_->m + index);
+        update_gram(2 * param_->m);
+    }
 }
 
 void LBFGS::update() {
-    p_->copy(*g_);
-
     int m = std::min(iter_, param_->m);
     int end = m ? (iter_ - 1) % m : 0; // skip for the very first iteration
 
+    if (param_->h0_freq < 0) {
+        // the gradient of the first iteration has not been added to gram_ yet
+        if (iter_ == 0)
+            update_gram(2 * param_->m);
+        update_scalar_h0(m, end);
+    } else {
+        update_diagonal_h0(m, end);
+    }
+
+    // for descent
+    unflatten(p_flat_.data(), p_);
+    p_->scale(-1.0);
+
+    if (param_->print > 2)
+        p_->print();
+}
+
+void LBFGS::update_scalar_h0(int m, int end) {
+    int mm = param_->m;
+    int nbase = 2 * mm + 1;
+    auto dot = [&](int k) {
+        double value = 0.0;
+        for (int j = 0; j < nbase; ++j)
+            value += delta_[j] * gram_[k * nbase + j];
+        return value;
+    };
+
+    // p = g
+    std::fill(delta_.begin(), delta_.end(), 0.0);
+    delta_[2 * mm] = 1.0;
+
     // first loop
     for (int k = 0; k < m; ++k) {
         int i = (end - k + m) % m;
-        alpha_[i] = rho_[i] * s_[i]->vector_dot(p_);
-        p_->axpy(-alpha_[i], y_[i]);
+        alpha_[i] = rho_[i] * dot(i);
+        delta_[mm + i] -= alpha_[i];
     }
 
     // apply inverse diagonal Hessian
-    apply_h0(p_);
+    double gamma = compute_gamma();
+    if (param_->print > 2)
+        outfile->Printf("\n  gamma for H0: %.15f", gamma);
+    for (auto& d : delta_)
+        d *= gamma;
 
     // second loop
     for (int k = 0; k < m; ++k) {
         int i = (end + k + 1) % m;
-        double beta = rho_[i] * y_[i]->vector_dot(p_);
-        p_->axpy(alpha_[i] - beta, s_[i]);
+        double beta = rho_[i] * dot(mm + i);
+        delta_[i] += alpha_[i] - beta;
     }
 
-    // for descent
-    p_->scale(-1.0);
+    // p = sum_k delta_k b_k
+    C_DGEMV('T', nbase, n_, 1.0, base_.data(), n_, delta_.data(), 1, 0.0, p_flat_.data(), 1);
+}
 
-    if (param_->print > 2)
-        p_->print();
+void LBFGS::update_diagonal_h0(int m, int end) {
+    double* p = p_flat_.data();
+    std::memcpy(p, g_ptr(), n_ * sizeof(double));
+
+    // first loop
+    for (int k = 0; k < m; ++k) {
+        int i = (end - k + m) % m;
+        alpha_[i] = rho_[i] * C_DDOT(n_, s_ptr(i), 1, p, 1);
+        C_DAXPY(n_, -alpha_[i], y_ptr(i), 1, p, 1);
+    }
+
+    // apply inverse diagonal Hessian
+    apply_h0(p);
+
+    // second loop
+    for (int k = 0; k < m; ++k) {
+        int i = (end + k + 1) % m;
+        double beta = rho_[i] * C_DDOT(n_, y_ptr(i), 1, p, 1);
+        C_DAXPY(n_, alpha_[i] - beta, s_ptr(i), 1, p, 1);
+    }
 }
 
 template <class Foo>
@@ -375,28 +481,18 @@ void LBFGS::line_search_bracketing_zoom(Foo& func, psi::SharedVector x, double&
     }
 }
 
-void LBFGS::apply_h0(psi::SharedVector q) {
-    if (param_->h0_freq < 0) {
-        double gamma = compute_gamma();
-        if (param_->print > 2)
-            outfile->Printf("\n  gamma for H0: %.15f", gamma);
-
-        for (int h = 0; h < nirrep_; ++h) {
-            for (int i = 0; i < dimpi_[h]; ++i) {
-                q->set(h, i, q->get(h, i) * gamma);
-            }
-        }
-    } else {
+void LBFGS::apply_h0(double* q) {
+    const double* h0 = h0_flat_.data();
+#pragma omp parallel for simd
+    for (size_t I = 0; I < n_; ++I) {
+        if (std::fabs(h0[I]) > 1.0e-12)
+            q[I] /= h0[I];
+    }
+    if (param_->print > 1) {
         for (int h = 0; h < nirrep_; ++h) {
             for (int i = 0; i < dimpi_[h]; ++i) {
-                double vh = h0_->get(h, i);
-                if (std::fabs(vh) > 1.0e-12) {
-                    q->set(h, i, q->get(h, i) / vh);
-                } else {
-                    if (param_->print > 1) {
-                        outfile->Printf("\n  Zero diagonal Hessian element (irrep: %d, i: %d)", h, i);
-                    }
-                }
+                if (std::fabs(h0[offsets_[h] + i]) <= 1.0e-12)
+                    outfile->Printf("\n  Zero diagonal Hessian element (irrep: %d, i: %d)", h, i);
             }
         }
     }
@@ -406,14 +502,14 @@ double LBFGS::compute_gamma() {
     double value = 1.0;
     if (iter_) {
         int end = (iter_ - 1) % (std::min(iter_, param_->m));
-        value = s_[end]->vector_dot(y_[end]) / y_[end]->vector_dot(y_[end]);
+        int nbase = 2 * param_->m + 1;
+        int s = end, y = param_->m + end;
+        value = gram_[s * nbase + y] / gram_[y * nbase + y];
     }
     return value;
 }
 
 void LBFGS::resize(int m) {
-    y_ = std::vector<psi::SharedVector>(m, std::make_shared<psi::Vector>());
-    s_ = std::vector<psi::SharedVector>(m, std::make_shared<psi::Vector>());
     alpha_.resize(m);
     rho_.resize(m);
 }
@@ -94,11 +94,25 @@ class LBFGS {
     /// Diagonal elements of Hessian
     psi::SharedVector h0_;
 
-    /// Gradient difference vectors
-    std::vector<psi::SharedVector> y_;
+    /// The total dimension of x
+    size_t n_;
 
-    /// Variable difference vectors
-    std::vector<psi::SharedVector> s_;
+    /// The offset of each irrep of x in the flattened vectors
+    std::vector<size_t> offsets_;
+
+    /// The history block, allocated once: s_0, ..., s_{m-1}, y_0, ..., y_{m-1}, and the current
+    /// gradient g, stored contiguously as flattened vectors of size n_. s_i are the variable
+    /// differences and y_i the gradient differences
+    std::vector<double> base_;
+
+    /// The dot products among the vectors of base_, (2m + 1) x (2m + 1)
+    std::vector<double> gram_;
+
+    /// The coefficients of the direction vector in terms of the vectors of base_
+    std::vector<double> delta_;
+
+    /// A temporary vector of dot products with the vectors of base_
+    std::vector<double> dots_;
 
     /// The rho vectors
     std::vector<double> rho_;
@@ -109,24 +123,50 @@ class LBFGS {
     /// The correction (moving direction) vector
     psi::SharedVector p_;
 
+    /// The flattened correction vector
+    std::vector<double> p_flat_;
+
     /// The current gradient vector
     psi::SharedVector g_;
 
-    /// The last gradient vector
-    psi::SharedVector g_last_;
+    /// The last solution vector (flattened)
+    std::vector<double> x_last_;
+
+    /// The flattened diagonal Hessian
+    std::vector<double> h0_flat_;
 
-    /// The last solution vector
-    psi::SharedVector x_last_;
+    /// Pointers to the history vectors s_i, y_i, and to the current gradient in base_
+    double* s_ptr(int i) { return base_.data() + i * n_; }
+    double* y_ptr(int i) { return base_.data() + (param_->m + i) * n_; }
+    double* g_ptr() { return base_.data() + 2 * param_->m * n_; }
+
+    /// Copy a vector to a flattened array and back
+    void flatten(psi::SharedVector v, double* out);
+    void unflatten(const double* in, psi::SharedVector v);
+
+    /// Compute the dot products of the vector k of base_ with all the vectors (one DGEMV)
+    void update_gram(int k);
+
+    /// Save the step and the gradient change of the last iteration in the history
+    void save_history(psi::SharedVector x, int index);
 
     /// Compute gamma that can be used as inverse of diagonal Hessian
     double compute_gamma();
 
     /// Apply h0_ to some vector
-    void apply_h0(psi::SharedVector q);
+    void apply_h0(double* q);
 
     /// Generate correction (direction) vector
     void update();
 
+    /// The two-loop recursion of update() with a scalar inverse Hessian, done on the coefficients
+    /// delta_ using the dot products in gram_ (vector-free L-BFGS). Only the final direction
+    /// vector touches the history block, as a single DGEMV
+    void update_scalar_h0(int m, int end);
+
+    /// The two-loop recursion of update() with a diagonal Hessian
+    void update_diagonal_h0(int m, int end);
+
     /// Determine step length
     template <class Foo> void next_step(Foo& foo, psi::SharedVector x, double& fx, double& step);
 
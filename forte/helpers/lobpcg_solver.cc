@@ -0,0 +1,352 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "psi4/psi4-dec.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libqt/qt.h"
+
+#include "helpers/lobpcg_solver.h"
+
+using namespace psi;
+
+namespace forte {
+
+namespace {
+/// The smallest denominator used to form the correction vectors
+constexpr double denominator_threshold = 1.0e-6;
+/// Vectors whose norm is reduced by more than these factors by the orthogonalization are removed.
+/// Small updates are tolerated only for the vectors whose sigma vectors are computed afterwards,
+/// since the sigma vectors transformed with the vectors would lose accuracy
+constexpr double drop_threshold = 1.0e-8;
+constexpr double drop_threshold_tracked = 1.0e-4;
+/// The minimum number of elements for which the vector operations run in parallel
+constexpr size_t min_parallel_size = 8192;
+
+double dot(const double* a, const double* b, size_t n) {
+    double result = 0.0;
+#pragma omp parallel for reduction(+ : result) if (n > min_parallel_size)
+    for (size_t I = 0; I < n; ++I) {
+        result += a[I] * b[I];
+    }
+    return result;
+}
+
+/// y += a * x
+void axpy(double a, const double* x, double* y, size_t n) {
+#pragma omp parallel for if (n > min_parallel_size)
+    for (size_t I = 0; I < n; ++I) {
+        y[I] += a * x[I];
+    }
+}
+
+void scale(double a, double* x, size_t n) {
+#pragma omp parallel for if (n > min_parallel_size)
+    for (size_t I = 0; I < n; ++I) {
+        x[I] *= a;
+    }
+}
+} // namespace
+
+LOBPCGSolver::LOBPCGSolver(size_t size, size_t nroot) : size_(size), nroot_(nroot) {
+    if (nroot_ == 0 or nroot_ > size_) {
+        throw std::runtime_error("LOBPCGSolver: the number of roots (" + std::to_string(nroot_) +
+                                 ") must be between 1 and the size of the matrix (" +
+                                 std::to_string(size_) + ")");
+    }
+}
+
+void LOBPCGSolver::startup(psi::SharedVector diagonal) {
+    diagonal_.assign(diagonal->pointer(), diagonal->pointer() + size_);
+}
+
+void LOBPCGSolver::add_guess(psi::SharedVector vec) {
+    guess_.insert(guess_.end(), vec->pointer(), vec->pointer() + size_);
+    nguess_++;
+}
+
+psi::SharedMatrix LOBPCGSolver::eigenvectors() const {
+    auto evecs = std::make_shared<psi::Matrix>("LOBPCG eigenvectors", nroot_, size_);
+    std::copy(X_.begin(), X_.begin() + nroot_ * size_, evecs->pointer()[0]);
+    return evecs;
+}
+
+void LOBPCGSolver::precondition(double lambda, double* r) const {
+    if (preconditioner_) {
+        preconditioner_->apply(lambda, r);
+        return;
+    }
+#pragma omp parallel for if (size_ > min_parallel_size)
+    for (size_t I = 0; I < size_; ++I) {
+        const double denom = lambda - diagonal_[I];
+        r[I] = std::fabs(denom) > denominator_threshold ? r[I] / denom : 0.0;
+    }
+}
+
+void LOBPCGSolver::project_out(double* v) const {
+    for (const auto& bad : project_out_) {
+        double overlap = 0.0;
+        for (const auto& [I, C] : bad) {
+            overlap += C * v[I];
+        }
+        for (const auto& [I, C] : bad) {
+            v[I] -= C * overlap;
+        }
+    }
+}
+
+size_t LOBPCGSolver::orthonormalize(std::vector<double>& V, std::vector<double>* AV, size_t nv,
+                                    const std::vector<double>& S, const std::vector<double>* AS,
+                                    size_t nbasis) const {
+    const size_t n = size_;
+    const double threshold = AV ? drop_threshold_tracked : drop_threshold;
+    size_t nkept = 0;
+    for (size_t i = 0; i < nv; ++i) {
+        double* v = V.data() + i * n;
+        double* Av = AV ? AV->data() + i * n : nullptr;
+        const double norm0 = std::sqrt(dot(v, v, n));
+        if (norm0 == 0.0)
+            continue;
+        // two passes of Gram-Schmidt against the basis and the vectors already kept
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t j = 0; j < nbasis; ++j) {
+                const double c = dot(S.data() + j * n, v, n);
+                axpy(-c, S.data() + j * n, v, n);
+                if (Av)
+                    axpy(-c, AS->data() + j * n, Av, n);
+            }
+            for (size_t j = 0; j < nkept; ++j) {
+                const double c = dot(V.data() + j * n, v, n);
+                axpy(-c, V.data() + j * n, v, n);
+                if (Av)
+                    axpy(-c, AV->data() + j * n, Av, n);
+            }
+        }
+        const double norm = std::sqrt(dot(v, v, n));
+        if (norm < threshold * norm0)
+            continue;
+        // store the vector in the first free row
+        double* v_kept = V.data() + nkept * n;
+        if (v_kept != v)
+            std::copy(v, v + n, v_kept);
+        scale(1.0 / norm, v_kept, n);
+        if (Av) {
+            double* Av_kept = AV->data() + nkept * n;
+            if (Av_kept != Av)
+                std::copy(Av, Av + n, Av_kept);
+            scale(1.0 / norm, Av_kept, n);
+        }
+        nkept++;
+    }
+    return nkept;
+}
+
+void LOBPCGSolver::sigma(const std::vector<double>& V, std::vector<double>& AV, size_t nv,
+                         const sigma_function& compute_sigma) {
+    const size_t n = size_;
+    std::vector<psi::SharedVector> b_block(nv);
+    std::vector<psi::SharedVector> sigma_block(nv);
+    for (size_t i = 0; i < nv; ++i) {
+        b_block[i] = std::make_shared<psi::Vector>("b", n);
+        sigma_block[i] = std::make_shared<psi::Vector>("sigma", n);
+        std::copy(V.begin() + i * n, V.begin() + (i + 1) * n, b_block[i]->pointer());
+    }
+    compute_sigma(sigma_block, b_block);
+    AV.resize(std::max(AV.size(), nv * n));
+    for (size_t i = 0; i < nv; ++i) {
+        std::copy(sigma_block[i]->pointer(), sigma_block[i]->pointer() + n, AV.begin() + i * n);
+    }
+    num_sigma_ += nv;
+}
+
+void LOBPCGSolver::rayleigh_ritz(const std::vector<double>& S, const std::vector<double>& AS,
+                                 size_t m, size_t first_p) {
+    const size_t n = size_;
+    const size_t k = nroot_;
+
+    // the matrix in the space G = S (AS)^T
+    psi::Matrix G("G", m, m);
+    double** G_p = G.pointer();
+    C_DGEMM('N', 'T', m, m, n, 1.0, const_cast<double*>(S.data()), n,
+            const_cast<double*>(AS.data()), n, 0.0, G_p[0], m);
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            const double Gij = 0.5 * (G_p[i][j] + G_p[j][i]);
+            G_p[i][j] = G_p[j][i] = Gij;
+        }
+    }
+    psi::Matrix evecs("C", m, m);
+    psi::Vector evals("lambda", m);
+    G.diagonalize(evecs, evals);
+
+    // the coefficients of the lowest k Ritz vectors, stored by row
+    std::vector<double> Ct(k * m);
+    for (size_t i = 0; i < k; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            Ct[i * m + j] = evecs.get(j, i);
+        }
+    }
+    X_.resize(k * n);
+    AX_.resize(k * n);
+    C_DGEMM('N', 'N', k, n, m, 1.0, Ct.data(), m, const_cast<double*>(S.data()), n, 0.0,
+            X_.data(), n);
+    C_DGEMM('N', 'N', k, n, m, 1.0, Ct.data(), m, const_cast<double*>(AS.data()), n, 0.0,
+            AX_.data(), n);
+    np_ = 0;
+    if (first_p < m) {
+        // the conjugate directions are the components of the update along W and P
+        P_.resize(k * n);
+        AP_.resize(k * n);
+        C_DGEMM('N', 'N', k, n, m - first_p, 1.0, Ct.data() + first_p, m,
+                const_cast<double*>(S.data()) + first_p * n, n, 0.0, P_.data(), n);
+        C_DGEMM('N', 'N', k, n, m - first_p, 1.0, Ct.data() + first_p, m,
+                const_cast<double*>(AS.data()) + first_p * n, n, 0.0, AP_.data(), n);
+        np_ = k;
+    }
+    lambda_.assign(evals.pointer(), evals.pointer() + k);
+}
+
+SolverStatus LOBPCGSolver::solve(const sigma_function& compute_sigma) {
+    const size_t n = size_;
+    const size_t k = nroot_;
+    iter_ = 0;
+    num_sigma_ = 0;
+
+    // form the initial space from the guesses, completed with unit vectors along the smallest
+    // diagonal elements
+    std::vector<double> V(guess_);
+    for (size_t i = 0; i < nguess_; ++i) {
+        project_out(V.data() + i * n);
+    }
+    size_t nv = orthonormalize(V, nullptr, nguess_, {}, nullptr, 0);
+    V.resize(nv * n);
+    if (nv < k) {
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&](size_t I, size_t J) { return diagonal_[I] < diagonal_[J]; });
+        std::vector<double> e(n);
+        for (size_t I : order) {
+            if (nv == k)
+                break;
+            std::fill(e.begin(), e.end(), 0.0);
+            e[I] = 1.0;
+            project_out(e.data());
+            if (orthonormalize(e, nullptr, 1, V, nullptr, nv) == 1) {
+                V.insert(V.end(), e.begin(), e.end());
+                nv++;
+            }
+        }
+    }
+    if (nv < k) {
+        throw std::runtime_error("LOBPCGSolver: could not form " + std::to_string(k) +
+                                 " initial vectors");
+    }
+    std::vector<double> AV;
+    sigma(V, AV, nv, compute_sigma);
+    rayleigh_ritz(V, AV, nv, nv);
+
+    if (print_) {
+        outfile->Printf("\n  Memory used by the LOBPCG vectors: %.2f MB",
+                        static_cast<double>(memory()) / (1024. * 1024.));
+        outfile->Printf("\n  -------------------------------------------------------------");
+        outfile->Printf("\n    Iter.      Avg. Energy       Delta_E     Res. Norm    Sigma");
+        outfile->Printf("\n  -------------------------------------------------------------");
+    }
+
+    std::vector<double> lambda_old(k, std::numeric_limits<double>::max());
+    std::vector<double> S, AS, W, AW;
+    rnorm_.assign(k, 0.0);
+    SolverStatus status = SolverStatus::NotConverged;
+    double old_avg_energy = 0.0;
+    for (iter_ = 1; iter_ <= maxiter_; ++iter_) {
+        // form the residuals r_i = A x_i - lambda_i x_i of the Ritz vectors
+        W.resize(k * n);
+        bool converged = true;
+        size_t nw = 0;
+        for (size_t i = 0; i < k; ++i) {
+            double* r = W.data() + nw * n;
+            std::copy(AX_.begin() + i * n, AX_.begin() + (i + 1) * n, r);
+            axpy(-lambda_[i], X_.data() + i * n, r, n);
+            rnorm_[i] = std::sqrt(dot(r, r, n));
+            const bool r_converged = rnorm_[i] < r_convergence_;
+            converged = converged and r_converged and
+                        (std::fabs(lambda_[i] - lambda_old[i]) < e_convergence_);
+            // soft locking: the residuals of converged roots are not added to the space
+            if (not r_converged) {
+                precondition(lambda_[i], r);
+                project_out(r);
+                nw++;
+            }
+        }
+
+        if (print_) {
+            const double avg_energy = std::accumulate(lambda_.begin(), lambda_.end(), 0.0) / k;
+            const double avg_residual = std::accumulate(rnorm_.begin(), rnorm_.end(), 0.0) / k;
+            outfile->Printf("\n    %3d  %20.12f  %+.3e  %+.3e  %7zu", iter_, avg_energy,
+                            avg_energy - old_avg_energy, avg_residual, num_sigma_);
+            old_avg_energy = avg_energy;
+        }
+
+        nw = orthonormalize(W, nullptr, nw, X_, nullptr, k);
+        // stop when all the roots are converged or when no residual is left to add
+        if (converged or nw == 0) {
+            status = SolverStatus::Converged;
+            break;
+        }
+        lambda_old = lambda_;
+
+        sigma(W, AW, nw, compute_sigma);
+
+        // the space [X, W, P] and its sigma vectors
+        S.assign(X_.begin(), X_.begin() + k * n);
+        AS.assign(AX_.begin(), AX_.begin() + k * n);
+        S.insert(S.end(), W.begin(), W.begin() + nw * n);
+        AS.insert(AS.end(), AW.begin(), AW.begin() + nw * n);
+        size_t np = 0;
+        if (np_ > 0) {
+            np = orthonormalize(P_, &AP_, np_, S, &AS, k + nw);
+            S.insert(S.end(), P_.begin(), P_.begin() + np * n);
+            AS.insert(AS.end(), AP_.begin(), AP_.begin() + np * n);
+        }
+        rayleigh_ritz(S, AS, k + nw + np, k);
+    }
+    iter_ = std::min(iter_, maxiter_);
+
+    if (print_) {
+        outfile->Printf("\n  -------------------------------------------------------------");
+        outfile->Printf("\n  LOBPCG: %d iterations and %zu sigma vectors", iter_, num_sigma_);
+    }
+    return status;
+}
+
+} // namespace forte
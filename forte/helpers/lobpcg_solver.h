@@ -0,0 +1,161 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _lobpcg_solver_h_
+#define _lobpcg_solver_h_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "psi4/libmints/vector.h"
+#include "psi4/libmints/matrix.h"
+
+#include "helpers/iterative_solvers.h"
+
+namespace forte {
+
+/**
+ * @brief The LOBPCGSolver class
+ * Finds the lowest eigenpairs of a symmetric matrix with the locally optimal block
+ * preconditioned conjugate gradient (LOBPCG) method.
+ *
+ * At each iteration the Ritz vectors X are updated with a Rayleigh-Ritz step in the space
+ * spanned by X, the preconditioned residuals W, and the conjugate directions P. The space has at
+ * most 3 nroot vectors, so the memory is fixed (see memory()) and, unlike the Davidson-Liu
+ * method, there is no collapse. The roots whose residual is converged are soft locked: they stay
+ * in the Rayleigh-Ritz step but their residual is not added, which saves one sigma vector per
+ * root and iteration.
+ *
+ * The sigma vectors are computed by a function passed to solve(), with the same signature as
+ * SigmaVector::compute_sigma_block(sigma, b).
+ */
+class LOBPCGSolver {
+  public:
+    using sparse_vec = std::vector<std::pair<size_t, double>>;
+    using sigma_function = std::function<void(const std::vector<psi::SharedVector>&,
+                                              const std::vector<psi::SharedVector>&)>;
+
+    // ==> Class Constructor <==
+
+    /// @param size the dimension of the matrix
+    /// @param nroot the number of eigenpairs to find
+    LOBPCGSolver(size_t size, size_t nroot);
+
+    // ==> Class Interface <==
+
+    /// Set the energy convergence
+    void set_e_convergence(double value) { e_convergence_ = value; }
+    /// Set the residual 2-norm convergence
+    void set_r_convergence(double value) { r_convergence_ = value; }
+    /// Set the maximum number of iterations
+    void set_maxiter(int value) { maxiter_ = value; }
+    /// Print the iterations?
+    void set_print(bool value) { print_ = value; }
+    /// Set the preconditioner (nullptr = use the diagonal)
+    void set_preconditioner(std::shared_ptr<DavidsonLiuPreconditioner> preconditioner) {
+        preconditioner_ = preconditioner;
+    }
+    /// Set the (normalized) vectors that are projected out of the solutions
+    void set_project_out(std::vector<sparse_vec> project_out) { project_out_ = project_out; }
+
+    /// Pass the diagonal of the matrix
+    void startup(psi::SharedVector diagonal);
+    /// Add a guess vector. If fewer than nroot guesses are given, unit vectors along the
+    /// smallest diagonal elements are added
+    void add_guess(psi::SharedVector vec);
+
+    /// Find the eigenpairs
+    /// @param compute_sigma a function that computes sigma[i] = H b[i]
+    /// @return SolverStatus::Converged or SolverStatus::NotConverged
+    SolverStatus solve(const sigma_function& compute_sigma);
+
+    /// @return the eigenvalues
+    const std::vector<double>& eigenvalues() const { return lambda_; }
+    /// @return the eigenvectors, stored by row
+    psi::SharedMatrix eigenvectors() const;
+    /// @return the residual norms
+    const std::vector<double>& residuals() const { return rnorm_; }
+    /// @return the number of iterations
+    int iterations() const { return iter_; }
+    /// @return the number of sigma vectors computed
+    size_t num_sigma() const { return num_sigma_; }
+    /// @return the memory used by the vectors of one LOBPCG iteration in bytes
+    size_t memory() const { return 6 * nroot_ * size_ * sizeof(double); }
+
+  private:
+    /// Apply the preconditioner to a residual
+    void precondition(double lambda, double* r) const;
+    /// Remove the components along the vectors to project out
+    void project_out(double* v) const;
+    /// Orthonormalize the nv vectors stored in V (and apply the same transformation to AV,
+    /// if not null) against the nbasis orthonormal vectors in S and against each other. The
+    /// vectors with a small norm are removed
+    /// @return the number of vectors kept
+    size_t orthonormalize(std::vector<double>& V, std::vector<double>* AV, size_t nv,
+                          const std::vector<double>& S, const std::vector<double>* AS,
+                          size_t nbasis) const;
+    /// Compute the sigma vectors of the nv vectors in V
+    void sigma(const std::vector<double>& V, std::vector<double>& AV, size_t nv,
+               const sigma_function& compute_sigma);
+    /// Rayleigh-Ritz step in the space S (m vectors). The Ritz vectors are stored in X_ and AX_
+    /// and the part of the Ritz vectors along S[first_p:m] is stored in P_ and AP_
+    void rayleigh_ritz(const std::vector<double>& S, const std::vector<double>& AS, size_t m,
+                       size_t first_p);
+
+    /// The dimension of the matrix
+    size_t size_;
+    /// The number of roots
+    size_t nroot_;
+    double e_convergence_ = 1.0e-12;
+    double r_convergence_ = 1.0e-6;
+    int maxiter_ = 100;
+    bool print_ = false;
+    std::shared_ptr<DavidsonLiuPreconditioner> preconditioner_;
+    std::vector<sparse_vec> project_out_;
+    /// The diagonal of the matrix
+    std::vector<double> diagonal_;
+    /// The guess vectors
+    std::vector<double> guess_;
+    size_t nguess_ = 0;
+
+    /// The Ritz vectors, the conjugate directions, and their sigma vectors (stored by row)
+    std::vector<double> X_, AX_, P_, AP_;
+    /// The number of conjugate directions
+    size_t np_ = 0;
+    /// The Ritz values and the residual norms
+    std::vector<double> lambda_;
+    std::vector<double> rnorm_;
+    /// The number of iterations and of sigma vectors computed
+    int iter_ = 0;
+    size_t num_sigma_ = 0;
+};
+
+} // namespace forte
+
+#endif // _lobpcg_solver_h_
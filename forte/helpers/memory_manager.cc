@@ -0,0 +1,174 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libpsi4util/process.h"
+
+#include "helpers/memory_manager.h"
+
+namespace forte {
+
+MemoryManager& MemoryManager::instance() {
+    static MemoryManager manager;
+    return manager;
+}
+
+size_t MemoryManager::total() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_ > 0 ? total_ : psi::Process::environment.get_memory();
+}
+
+void MemoryManager::set_total(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_ = bytes;
+}
+
+void MemoryManager::allocate(const std::string& subsystem, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    usage_[subsystem] += bytes;
+    used_ += bytes;
+    for (size_t phase : open_phases_) {
+        phases_[phase].second = std::max(phases_[phase].second, used_);
+    }
+}
+
+void MemoryManager::release(const std::string& subsystem, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = usage_.find(subsystem);
+    if (it == usage_.end()) {
+        return;
+    }
+    bytes = std::min(bytes, it->second);
+    it->second -= bytes;
+    used_ -= bytes;
+    if (it->second == 0) {
+        usage_.erase(it);
+    }
+}
+
+size_t MemoryManager::used() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+}
+
+size_t MemoryManager::used(const std::string& subsystem) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = usage_.find(subsystem);
+    return it == usage_.end() ? 0 : it->second;
+}
+
+size_t MemoryManager::available() const {
+    size_t tot = total();
+    size_t use = used();
+    return tot > use ? tot - use : 0;
+}
+
+size_t MemoryManager::budget(double fraction) const {
+    return static_cast<size_t>(std::max(0.0, fraction) * static_cast<double>(available()));
+}
+
+void MemoryManager::begin_phase(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_phases_.push_back(phases_.size());
+    phases_.emplace_back(name, used_);
+}
+
+void MemoryManager::end_phase() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (not open_phases_.empty()) {
+        open_phases_.pop_back();
+    }
+}
+
+void MemoryManager::print_summary() const {
+    const double to_mb = 1.0 / (1024.0 * 1024.0);
+    size_t tot = total();
+    std::lock_guard<std::mutex> lock(mutex_);
+    psi::outfile->Printf("\n\n  ==> Forte Memory Summary <==\n");
+    psi::outfile->Printf("\n    Total memory: %12.2f MB", tot * to_mb);
+    psi::outfile->Printf("\n    In use      : %12.2f MB", used_ * to_mb);
+    if (not usage_.empty()) {
+        psi::outfile->Printf("\n\n    %-32s %12s", "Subsystem", "Memory (MB)");
+        psi::outfile->Printf("\n    %s", std::string(45, '-').c_str());
+        for (const auto& [subsystem, bytes] : usage_) {
+            psi::outfile->Printf("\n    %-32s %12.2f", subsystem.c_str(), bytes * to_mb);
+        }
+    }
+    if (not phases_.empty()) {
+        psi::outfile->Printf("\n\n    %-32s %12s", "Phase", "Peak (MB)");
+        psi::outfile->Printf("\n    %s", std::string(45, '-').c_str());
+        for (const auto& [name, peak] : phases_) {
+            psi::outfile->Printf("\n    %-32s %12.2f", name.c_str(), peak * to_mb);
+        }
+    }
+    psi::outfile->Printf("\n");
+}
+
+MemoryReservation::MemoryReservation(const std::string& subsystem, size_t bytes)
+    : subsystem_(subsystem), bytes_(bytes) {
+    MemoryManager::instance().allocate(subsystem_, bytes_);
+}
+
+MemoryReservation::~MemoryReservation() { reset(); }
+
+MemoryReservation::MemoryReservation(MemoryReservation&& other)
+    : subsystem_(std::move(other.subsystem_)), bytes_(other.bytes_) {
+    other.bytes_ = 0;
+}
+
+MemoryReservation& MemoryReservation::operator=(MemoryReservation&& other) {
+    if (this != &other) {
+        reset();
+        subsystem_ = std::move(other.subsystem_);
+        bytes_ = other.bytes_;
+        other.bytes_ = 0;
+    }
+    return *this;
+}
+
+void MemoryReservation::resize(size_t bytes) {
+    auto& manager = MemoryManager::instance();
+    if (bytes > bytes_) {
+        manager.allocate(subsystem_, bytes - bytes_);
+    } else {
+        manager.release(subsystem_, bytes_ - bytes);
+    }
+    bytes_ = bytes;
+}
+
+void MemoryReservation::reset() {
+    if (bytes_ > 0) {
+        MemoryManager::instance().release(subsystem_, bytes_);
+        bytes_ = 0;
+    }
+}
+
+} // namespace forte
@@ -0,0 +1,138 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _memory_manager_h_
+#define _memory_manager_h_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace forte {
+
+/**
+ * @brief A process-wide bookkeeper of the memory used by Forte
+ *
+ * Modules register their large allocations (CI vectors, integrals, RDMs, tensors, ...) under
+ * the name of a subsystem, and query the memory still available out of the total assigned to
+ * Psi4 when they size their algorithms (batches, stored couplings, ...). The peak usage is
+ * recorded for each phase of a calculation (see MemoryPhase).
+ *
+ * The manager only does accounting; the memory itself is allocated by the caller. Use the RAII
+ * class MemoryReservation to tie a registration to the lifetime of an object.
+ */
+class MemoryManager {
+  public:
+    /// Return the process-wide instance
+    static MemoryManager& instance();
+
+    /// The total memory (in bytes) assigned to Forte. Defaults to the Psi4 memory
+    size_t total() const;
+    /// Override the total memory (0 restores the Psi4 memory setting)
+    void set_total(size_t bytes);
+
+    /// Register an allocation of a given number of bytes for a subsystem
+    void allocate(const std::string& subsystem, size_t bytes);
+    /// Release (part of) an allocation registered for a subsystem
+    void release(const std::string& subsystem, size_t bytes);
+
+    /// The memory (in bytes) currently registered by all subsystems
+    size_t used() const;
+    /// The memory (in bytes) currently registered by a subsystem
+    size_t used(const std::string& subsystem) const;
+    /// The memory (in bytes) not registered by any subsystem
+    size_t available() const;
+    /// A budget (in bytes) equal to a fraction of the available memory
+    size_t budget(double fraction = 1.0) const;
+
+    /// Start a new phase (phases may be nested)
+    void begin_phase(const std::string& name);
+    /// End the current phase
+    void end_phase();
+
+    /// Print the current usage by subsystem and the peak usage of each phase
+    void print_summary() const;
+
+  private:
+    MemoryManager() = default;
+
+    mutable std::mutex mutex_;
+    /// A user-defined total memory (0 = use the Psi4 memory)
+    size_t total_ = 0;
+    /// The memory used by each subsystem
+    std::map<std::string, size_t> usage_;
+    /// The memory used by all subsystems
+    size_t used_ = 0;
+    /// The stack of open phases (indices in phases_)
+    std::vector<size_t> open_phases_;
+    /// The name and peak usage of each phase in order of creation
+    std::vector<std::pair<std::string, size_t>> phases_;
+};
+
+/**
+ * @brief Registers an allocation with the MemoryManager for the lifetime of this object
+ */
+class MemoryReservation {
+  public:
+    MemoryReservation() = default;
+    MemoryReservation(const std::string& subsystem, size_t bytes);
+    ~MemoryReservation();
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+    MemoryReservation(MemoryReservation&& other);
+    MemoryReservation& operator=(MemoryReservation&& other);
+
+    /// Change the size of the reservation
+    void resize(size_t bytes);
+    /// Release the reservation
+    void reset();
+    /// The size of the reservation in bytes
+    size_t size() const { return bytes_; }
+
+  private:
+    std::string subsystem_;
+    size_t bytes_ = 0;
+};
+
+/**
+ * @brief Marks a phase of a calculation with the MemoryManager for the lifetime of this object
+ */
+class MemoryPhase {
+  public:
+    MemoryPhase(const std::string& name) { MemoryManager::instance().begin_phase(name); }
+    ~MemoryPhase() { MemoryManager::instance().end_phase(); }
+    MemoryPhase(const MemoryPhase&) = delete;
+    MemoryPhase& operator=(const MemoryPhase&) = delete;
+};
+
+} // namespace forte
+
+#endif // _memory_manager_h_
@@ -0,0 +1,143 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER,
+ * AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_num_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if __has_include(<linux/mempolicy.h>)
+#include <linux/mempolicy.h>
+#define FORTE_HAVE_MBIND
+#endif
+#endif
+
+#include "helpers/numa_memory.h"
+
+namespace forte {
+
+namespace {
+bool first_touch_ = true;
+bool huge_pages_ = false;
+size_t huge_pages_min_bytes_ = 64 * 1024 * 1024;
+
+/// Arrays smaller than this are zeroed by the calling thread and their pages are not moved
+constexpr size_t min_parallel_bytes = 4 * 1024 * 1024;
+
+/// The bytes [begin, end) of a row assigned to thread t by a static schedule
+std::pair<size_t, size_t> static_chunk(size_t row_bytes, int t, int nthreads) {
+    const size_t q = row_bytes / nthreads;
+    const size_t r = row_bytes % nthreads;
+    const size_t begin = t * q + std::min<size_t>(t, r);
+    return {begin, begin + q + (static_cast<size_t>(t) < r ? 1 : 0)};
+}
+
+#ifdef FORTE_HAVE_MBIND
+/// Move the whole pages contained in [begin, end) to the node of the calling thread
+void move_pages_here(char* begin, char* end) {
+    static const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t first = (reinterpret_cast<uintptr_t>(begin) + page_size - 1) & ~(page_size - 1);
+    const uintptr_t last = reinterpret_cast<uintptr_t>(end) & ~(page_size - 1);
+    if (last > first) {
+        // failures (e.g., a kernel without NUMA support) only leave the pages where they are
+        syscall(SYS_mbind, first, last - first, MPOL_LOCAL, nullptr, 0, MPOL_MF_MOVE);
+    }
+}
+#endif
+} // namespace
+
+void set_numa_memory_options(bool first_touch, bool huge_pages, size_t huge_pages_min_bytes) {
+    first_touch_ = first_touch;
+    huge_pages_ = huge_pages;
+    huge_pages_min_bytes_ = huge_pages_min_bytes;
+}
+
+bool numa_first_touch() { return first_touch_; }
+
+bool use_huge_pages(size_t bytes) { return huge_pages_ and bytes >= huge_pages_min_bytes_; }
+
+void first_touch(void* data, size_t nrows, size_t row_bytes) {
+    char* p = static_cast<char*>(data);
+    if (not first_touch_ or nrows * row_bytes < min_parallel_bytes) {
+        std::memset(p, 0, nrows * row_bytes);
+        return;
+    }
+#pragma omp parallel
+    {
+        const auto [begin, end] =
+            static_chunk(row_bytes, omp_get_thread_num(), omp_get_num_threads());
+        for (size_t row = 0; row < nrows; ++row) {
+            std::memset(p + row * row_bytes + begin, 0, end - begin);
+        }
+    }
+}
+
+void place_pages(void* data, size_t nrows, size_t row_bytes) {
+    if (use_huge_pages(nrows * row_bytes))
+        advise_huge_pages(data, nrows * row_bytes);
+#ifdef FORTE_HAVE_MBIND
+    if (not first_touch_ or nrows * row_bytes < min_parallel_bytes)
+        return;
+    char* p = static_cast<char*>(data);
+#pragma omp parallel
+    {
+        const auto [begin, end] =
+            static_chunk(row_bytes, omp_get_thread_num(), omp_get_num_threads());
+        for (size_t row = 0; row < nrows; ++row) {
+            move_pages_here(p + row * row_bytes + begin, p + row * row_bytes + end);
+        }
+    }
+#endif
+}
+
+void advise_huge_pages(void* data, size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    const uintptr_t huge_page = FirstTouchAllocator<double>::huge_page_size;
+    const uintptr_t first = (reinterpret_cast<uintptr_t>(data) + huge_page - 1) & ~(huge_page - 1);
+    const uintptr_t last = (reinterpret_cast<uintptr_t>(data) + bytes) & ~(huge_page - 1);
+    if (last > first) {
+        madvise(reinterpret_cast<void*>(first), last - first, MADV_HUGEPAGE);
+    }
+#else
+    (void)data;
+    (void)bytes;
+#endif
+}
+
+} // namespace forte
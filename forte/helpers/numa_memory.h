@@ -0,0 +1,148 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER,
+ * AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _numa_memory_h_
+#define _numa_memory_h_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace forte {
+
+/**
+ * Placement of large arrays on NUMA machines
+ *
+ * Linux places a page on the NUMA node of the thread that first writes to it. The arrays that
+ * are allocated and zeroed by the master thread therefore end up on one socket, and the threads
+ * running on the other sockets access them through the interconnect. The functions below touch
+ * (or move) the pages of an array so that each part of it is local to the thread that works on
+ * it in a static OpenMP schedule. An array is seen as nrows rows of row_bytes bytes and the
+ * elements of each row are split among the threads as in
+ *
+ *     #pragma omp parallel for schedule(static)
+ *     for (size_t i = 0; i < row_size; ++i)
+ *
+ * so that a single row (nrows = 1) matches a static loop over the whole array and several rows
+ * match a set of vectors that are processed one at a time by all the threads.
+ *
+ * Arrays larger than a threshold can also use 2 MB transparent huge pages. These settings are
+ * process-wide and are set from the options NUMA_FIRST_TOUCH, HUGE_PAGES, and
+ * HUGE_PAGES_MIN_SIZE.
+ */
+
+/// Set the placement options. huge_pages_min_bytes is the smallest array that uses huge pages
+void set_numa_memory_options(bool first_touch, bool huge_pages, size_t huge_pages_min_bytes);
+/// @return true if the pages of large arrays are placed on the node of the threads using them
+bool numa_first_touch();
+/// @return true if huge pages should be used for an array of a given size
+bool use_huge_pages(size_t bytes);
+
+/// Zero an array in parallel so that its pages are first touched by the threads that use them
+void first_touch(void* data, size_t nrows, size_t row_bytes);
+
+/// Move the pages of an array that was already touched to the nodes of the threads that use
+/// them, and request huge pages if they are enabled (Linux only, a no-op elsewhere)
+void place_pages(void* data, size_t nrows, size_t row_bytes);
+
+/// Request transparent huge pages for the aligned 2 MB pages contained in [data, data + bytes)
+void advise_huge_pages(void* data, size_t bytes);
+
+/**
+ * @brief An allocator for std::vector whose storage is zeroed by first_touch()
+ *
+ * Arrays larger than the huge page threshold are aligned to 2 MB. The elements are zeroed at
+ * allocation and left as they are by default construction, so that resize() and the size
+ * constructors of std::vector do not touch the pages again from the calling thread. For this
+ * reason T must be trivial. row_size is the number of elements of a row (0 = one row).
+ */
+template <typename T> class FirstTouchAllocator {
+    static_assert(std::is_trivial<T>::value, "FirstTouchAllocator requires a trivial type");
+
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    FirstTouchAllocator() = default;
+    explicit FirstTouchAllocator(size_t row_size) : row_size_(row_size) {}
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U>& other) : row_size_(other.row_size()) {}
+
+    T* allocate(size_t n) {
+        if (n == 0)
+            return nullptr;
+        const size_t bytes = n * sizeof(T);
+        const size_t alignment = use_huge_pages(bytes) ? huge_page_size : 64;
+        // std::aligned_alloc requires a size multiple of the alignment
+        void* p = std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+        if (p == nullptr)
+            throw std::bad_alloc();
+        if (alignment == huge_page_size)
+            advise_huge_pages(p, bytes);
+        const size_t row_size = (row_size_ == 0 or row_size_ > n) ? n : row_size_;
+        const size_t nrows = row_size == 0 ? 0 : (n + row_size - 1) / row_size;
+        first_touch(p, nrows, row_size * sizeof(T));
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) noexcept { std::free(p); }
+
+    /// Default construction leaves the (zeroed) memory untouched
+    template <typename U> void construct(U* p) noexcept { ::new (static_cast<void*>(p)) U; }
+    template <typename U, typename... Args> void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    size_t row_size() const { return row_size_; }
+
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+  private:
+    size_t row_size_ = 0;
+};
+
+template <typename T, typename U>
+bool operator==(const FirstTouchAllocator<T>& a, const FirstTouchAllocator<U>& b) {
+    return a.row_size() == b.row_size();
+}
+template <typename T, typename U>
+bool operator!=(const FirstTouchAllocator<T>& a, const FirstTouchAllocator<U>& b) {
+    return not(a == b);
+}
+
+/// A vector zeroed by the threads that use it (see FirstTouchAllocator)
+template <typename T> using first_touch_vector = std::vector<T, FirstTouchAllocator<T>>;
+
+} // namespace forte
+
+#endif // _numa_memory_h_
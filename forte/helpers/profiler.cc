@@ -0,0 +1,325 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "psi4/libpsi4util/PsiOutStream.h"
+
+#include "helpers/profiler.h"
+
+namespace forte {
+
+namespace {
+/// Escape a string for a JSON document
+std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '"' or c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+int mpi_rank() {
+    int rank = 0;
+#ifdef HAVE_MPI
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    if (initialized) {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    }
+#endif
+    return rank;
+}
+
+/// Open a perf_event group (cycles, instructions, cache references, cache misses) that counts
+/// the user-space events of the calling thread. Return the group leader or -1 on failure
+int open_counter_group() {
+#ifdef __linux__
+    const uint64_t configs[Profiler::ncounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_REFERENCES,
+        PERF_COUNT_HW_CACHE_MISSES};
+    int leader = -1;
+    for (size_t c = 0; c < Profiler::ncounters; ++c) {
+        perf_event_attr attr{};
+        attr.size = sizeof(perf_event_attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[c];
+        attr.disabled = (c == 0) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0));
+        if (fd < 0) {
+            if (leader >= 0) {
+                close(leader);
+            }
+            return -1;
+        }
+        if (c == 0) {
+            leader = fd;
+        }
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return leader;
+#else
+    return -1;
+#endif
+}
+} // namespace
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : origin_(clock::now()) {}
+
+double Profiler::now() const {
+    return std::chrono::duration<double, std::micro>(clock::now() - origin_).count();
+}
+
+Profiler::ThreadLog& Profiler::thread_log() {
+    // the logs are owned by the profiler and never deleted, so the pointer stays valid
+    thread_local ThreadLog* log = nullptr;
+    if (log == nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto new_log = std::make_unique<ThreadLog>();
+        new_log->tid = static_cast<int>(logs_.size());
+        log = new_log.get();
+        logs_.push_back(std::move(new_log));
+    }
+    return *log;
+}
+
+bool Profiler::enable_counters(bool value) {
+    if (value) {
+        // check that the counters can be opened (perf_event_paranoid may forbid it)
+        std::array<uint64_t, ncounters> values;
+        if (not read_counters(thread_log(), values)) {
+            psi::outfile->Printf("\n  Profiler: the hardware counters are not available.");
+            counters_.store(false, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    counters_.store(value, std::memory_order_relaxed);
+    return true;
+}
+
+bool Profiler::read_counters(ThreadLog& log, std::array<uint64_t, ncounters>& values) {
+    if (not log.counters_opened) {
+        log.counters_opened = true;
+        log.counter_fd = open_counter_group();
+    }
+    if (log.counter_fd < 0) {
+        return false;
+    }
+#ifdef __linux__
+    // PERF_FORMAT_GROUP layout: the number of events followed by their values
+    uint64_t buffer[1 + ncounters];
+    if (read(log.counter_fd, buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer))) {
+        return false;
+    }
+    std::copy(buffer + 1, buffer + 1 + ncounters, values.begin());
+    return true;
+#else
+    return false;
+#endif
+}
+
+size_t Profiler::begin(const std::string& name) {
+    ThreadLog& log = thread_log();
+    std::string path = log.open.empty() ? name : log.events[log.open.back()].path + "/" + name;
+    size_t index = log.events.size();
+    log.open.push_back(index);
+    log.events.push_back({name, std::move(path), 0.0, -1.0, {}, false});
+    Event& event = log.events.back();
+    if (counters_enabled()) {
+        event.has_counters = read_counters(log, event.counters);
+    }
+    event.start = now();
+    return index;
+}
+
+void Profiler::end(size_t index) {
+    ThreadLog& log = thread_log();
+    // the region is usually the last one opened. If the log was cleared it is not found
+    auto it = std::find(log.open.rbegin(), log.open.rend(), index);
+    if (it == log.open.rend()) {
+        return;
+    }
+    Event& event = log.events[index];
+    event.duration = now() - event.start;
+    if (event.has_counters) {
+        std::array<uint64_t, ncounters> values;
+        event.has_counters = read_counters(log, values);
+        for (size_t c = 0; c < ncounters; ++c) {
+            event.counters[c] = values[c] - event.counters[c];
+        }
+    }
+    log.open.erase(std::next(it).base());
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& log : logs_) {
+        log->events.clear();
+        log->open.clear();
+    }
+}
+
+void Profiler::print_summary() const {
+    // path -> (total time, calls, threads)
+    std::map<std::string, std::tuple<double, size_t, size_t>> regions;
+    // path -> (time with counters, summed counters)
+    std::map<std::string, std::pair<double, std::array<uint64_t, ncounters>>> counters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& log : logs_) {
+            std::map<std::string, bool> seen;
+            for (const auto& event : log->events) {
+                if (event.duration < 0.0) {
+                    continue;
+                }
+                auto& [time, calls, threads] = regions[event.path];
+                time += event.duration;
+                calls += 1;
+                if (not seen[event.path]) {
+                    seen[event.path] = true;
+                    threads += 1;
+                }
+                if (event.has_counters) {
+                    auto& [ctime, values] = counters[event.path];
+                    ctime += event.duration;
+                    for (size_t c = 0; c < ncounters; ++c) {
+                        values[c] += event.counters[c];
+                    }
+                }
+            }
+        }
+    }
+    if (regions.empty()) {
+        return;
+    }
+
+    psi::outfile->Printf("\n\n  ==> Forte Profile <==\n");
+    psi::outfile->Printf("\n    %-56s %12s %10s %8s", "Region", "Time (s)", "Calls", "Threads");
+    psi::outfile->Printf("\n    %s", std::string(89, '-').c_str());
+    // the map is sorted by path, so children follow their parents
+    for (const auto& [path, data] : regions) {
+        size_t depth = std::count(path.begin(), path.end(), '/');
+        std::string label = std::string(2 * depth, ' ') + path.substr(path.rfind('/') + 1);
+        psi::outfile->Printf("\n    %-56s %12.3f %10zu %8zu", label.c_str(),
+                             std::get<0>(data) * 1.0e-6, std::get<1>(data), std::get<2>(data));
+    }
+    psi::outfile->Printf("\n    %s\n", std::string(89, '-').c_str());
+
+    if (counters.empty()) {
+        return;
+    }
+    // the bandwidth assumes that each last-level cache miss moves one 64-byte line
+    psi::outfile->Printf("\n  Hardware counters (thread that opened the region)\n");
+    psi::outfile->Printf("\n    %-48s %10s %8s %12s %12s", "Region", "GInstr/s", "IPC",
+                         "LLC miss %", "Mem (GB/s)");
+    psi::outfile->Printf("\n    %s", std::string(93, '-').c_str());
+    for (const auto& [path, data] : counters) {
+        const auto& [ctime, values] = data;
+        double seconds = std::max(ctime * 1.0e-6, 1.0e-12);
+        double cycles = static_cast<double>(values[0]);
+        double instructions = static_cast<double>(values[1]);
+        double references = static_cast<double>(values[2]);
+        double misses = static_cast<double>(values[3]);
+        size_t depth = std::count(path.begin(), path.end(), '/');
+        std::string label = std::string(2 * depth, ' ') + path.substr(path.rfind('/') + 1);
+        psi::outfile->Printf("\n    %-48s %10.3f %8.3f %12.2f %12.3f", label.c_str(),
+                             1.0e-9 * instructions / seconds,
+                             cycles > 0.0 ? instructions / cycles : 0.0,
+                             references > 0.0 ? 100.0 * misses / references : 0.0,
+                             1.0e-9 * 64.0 * misses / seconds);
+    }
+    psi::outfile->Printf("\n    %s\n", std::string(93, '-').c_str());
+}
+
+void Profiler::write_chrome_trace(const std::string& filename) const {
+    int rank = mpi_rank();
+    std::string name = rank == 0 ? filename : filename + "." + std::to_string(rank);
+    std::ofstream file(name);
+    if (not file) {
+        throw std::runtime_error("Profiler: cannot open the file " + name);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& log : logs_) {
+        for (const auto& event : log->events) {
+            if (event.duration < 0.0) {
+                continue;
+            }
+            file << (first ? "\n" : ",\n");
+            file << "{\"name\":\"" << json_escape(event.name) << "\",\"cat\":\"forte\""
+                 << ",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration
+                 << ",\"pid\":" << rank << ",\"tid\":" << log->tid << ",\"args\":{\"path\":\""
+                 << json_escape(event.path) << "\"";
+            if (event.has_counters) {
+                const auto& c = event.counters;
+                file << ",\"cycles\":" << c[0] << ",\"instructions\":" << c[1]
+                     << ",\"cache_references\":" << c[2] << ",\"cache_misses\":" << c[3];
+            }
+            file << "}}";
+            first = false;
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+} // namespace forte
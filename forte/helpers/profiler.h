@@ -0,0 +1,164 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _helpers_profiler_h_
+#define _helpers_profiler_h_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace forte {
+
+/**
+ * @brief A process-wide profiler of nested, named regions
+ *
+ * Each thread records its regions in its own log, so starting and ending a region takes no
+ * lock. When the profiler is disabled (the default) a region costs a single atomic load.
+ * The logs of all threads can be summarized (total time and number of calls of each region,
+ * identified by its path in the region tree) or exported in the Chrome trace event format,
+ * which can be visualized with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Regions are usually created with the RAII class ProfileRegion. The forte::timer class also
+ * opens a region, so all timed sections of Forte appear in the profile.
+ *
+ * On Linux the profiler can also read the hardware counters of the thread that opens a region
+ * (cycles, instructions, last-level cache references and misses) through perf_event. The
+ * summary then reports the instructions per cycle, the cache miss ratio, and the memory
+ * bandwidth implied by the cache misses, which tell memory-bound from compute-bound regions.
+ */
+class Profiler {
+  public:
+    /// Return the process-wide instance
+    static Profiler& instance();
+
+    /// Enable/disable recording
+    void enable(bool value) { enabled_.store(value, std::memory_order_relaxed); }
+    /// Is the profiler recording?
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /// The number of hardware counters recorded per region
+    static constexpr size_t ncounters = 4;
+    /// Enable/disable the hardware counters. Return false if they are not available
+    bool enable_counters(bool value);
+    /// Are the hardware counters recorded?
+    bool counters_enabled() const { return counters_.load(std::memory_order_relaxed); }
+
+    /// Open a region in the current thread and return its index
+    size_t begin(const std::string& name);
+    /// Close a region opened in the current thread (regions may be closed out of order)
+    void end(size_t index);
+
+    /// Discard all the recorded regions
+    void clear();
+
+    /// Print the total time and number of calls of each region (summed over threads)
+    void print_summary() const;
+
+    /// Write the recorded regions to a file in the Chrome trace event (JSON) format. With MPI,
+    /// each rank writes its own file (the rank is appended to the name for ranks > 0)
+    void write_chrome_trace(const std::string& filename) const;
+
+  private:
+    Profiler();
+
+    using clock = std::chrono::steady_clock;
+
+    /// A closed (or open, if duration < 0) region
+    struct Event {
+        std::string name;
+        std::string path;
+        double start;
+        double duration;
+        /// The counter values at the start, replaced by the differences when the region ends
+        std::array<uint64_t, ncounters> counters;
+        bool has_counters;
+    };
+
+    /// The regions recorded by one thread
+    struct ThreadLog {
+        int tid;
+        std::vector<Event> events;
+        /// The indices of the open regions
+        std::vector<size_t> open;
+        /// The perf_event file descriptor of the counter group of this thread (-1 = none)
+        int counter_fd = -1;
+        /// Was the counter group opened (or tried)?
+        bool counters_opened = false;
+    };
+
+    /// Read the counters of a thread. Return false if not available
+    bool read_counters(ThreadLog& log, std::array<uint64_t, ncounters>& values);
+
+    /// Return the log of the calling thread (created on first use)
+    ThreadLog& thread_log();
+    /// The time since the creation of the profiler in microseconds
+    double now() const;
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> counters_{false};
+    clock::time_point origin_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadLog>> logs_;
+};
+
+/**
+ * @brief Profiles a region for the lifetime of this object
+ */
+class ProfileRegion {
+  public:
+    ProfileRegion(const std::string& name) : active_(Profiler::instance().enabled()) {
+        if (active_) {
+            index_ = Profiler::instance().begin(name);
+        }
+    }
+    ~ProfileRegion() { stop(); }
+    ProfileRegion(const ProfileRegion&) = delete;
+    ProfileRegion& operator=(const ProfileRegion&) = delete;
+
+    /// Close the region before the end of the scope
+    void stop() {
+        if (active_) {
+            active_ = false;
+            Profiler::instance().end(index_);
+        }
+    }
+
+  private:
+    bool active_;
+    size_t index_ = 0;
+};
+
+} // namespace forte
+
+#endif // _helpers_profiler_h_
@@ -0,0 +1,147 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER,
+ * AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "psi4/libpsio/psio.hpp"
+
+#include "helpers/subspace_vectors.h"
+
+namespace forte {
+
+namespace {
+void throw_system_error(const std::string& msg) {
+    throw std::runtime_error("SubspaceVectors: " + msg + " (" + std::strerror(errno) + ")");
+}
+} // namespace
+
+SubspaceVectors::SubspaceVectors(const std::string& name, size_t nvec, size_t size,
+                                 bool out_of_core)
+    : name_(name), nvec_(nvec), size_(size), stride_(size), out_of_core_(out_of_core) {
+    if (not out_of_core_) {
+        memory_ = first_touch_vector<double>(nvec_ * stride_, FirstTouchAllocator<double>(stride_));
+        data_ = memory_.data();
+        return;
+    }
+
+    // start each vector on a page boundary so that it can be prefetched and released alone
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE)) / sizeof(double);
+    stride_ = (size_ + page_size - 1) / page_size * page_size;
+
+    // create the scratch file and unlink it right away, so that it is removed when it is closed
+    std::string filename = psi::PSIOManager::shared_object()->get_default_path() + "psi." +
+                           std::to_string(getpid()) + ".forte." + name_ + ".XXXXXX";
+    std::vector<char> filename_buffer(filename.begin(), filename.end());
+    filename_buffer.push_back('\0');
+    fd_ = mkstemp(filename_buffer.data());
+    if (fd_ == -1) {
+        throw_system_error("cannot create the scratch file " + filename);
+    }
+    unlink(filename_buffer.data());
+
+    // the file is extended with zeros, so the vectors start zeroed
+    if (ftruncate(fd_, static_cast<off_t>(memory())) == -1) {
+        close(fd_);
+        throw_system_error("cannot allocate " + std::to_string(memory()) + " bytes on disk");
+    }
+    if (memory() > 0) {
+        void* data = mmap(nullptr, memory(), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED) {
+            close(fd_);
+            throw_system_error("cannot map the scratch file");
+        }
+        data_ = static_cast<double*>(data);
+    }
+}
+
+SubspaceVectors::~SubspaceVectors() {
+    if (out_of_core_) {
+        if (data_ != nullptr) {
+            munmap(data_, memory());
+        }
+        close(fd_);
+    }
+}
+
+std::vector<double*> SubspaceVectors::pointers(size_t n) {
+    std::vector<double*> ptrs(n);
+    for (size_t i = 0; i < n; ++i) {
+        ptrs[i] = (*this)[i];
+    }
+    return ptrs;
+}
+
+void SubspaceVectors::get(size_t n, double* v) const {
+    const double* v_n = (*this)[n];
+    std::copy(v_n, v_n + size_, v);
+}
+
+void SubspaceVectors::set(size_t n, const double* v) { std::copy(v, v + size_, (*this)[n]); }
+
+void SubspaceVectors::zero(size_t n) {
+    double* v_n = (*this)[n];
+    std::fill(v_n, v_n + size_, 0.0);
+}
+
+void SubspaceVectors::prefetch(size_t n) const { prefetch(n, n + 1, 0, size_); }
+
+void SubspaceVectors::release(size_t n) const { release(n, n + 1, 0, size_); }
+
+void SubspaceVectors::prefetch(size_t first, size_t last, size_t begin, size_t end) const {
+    advise(first, last, begin, end, MADV_WILLNEED);
+}
+
+void SubspaceVectors::release(size_t first, size_t last, size_t begin, size_t end) const {
+    // modified pages are kept in the page cache and written back to the file by the kernel
+    advise(first, last, begin, end, MADV_DONTNEED);
+}
+
+void SubspaceVectors::advise(size_t first, size_t last, size_t begin, size_t end,
+                             int advice) const {
+    if (not out_of_core_ or (begin >= end))
+        return;
+    // the vectors start on a page boundary and stride_ is a multiple of the page size, so the
+    // rounded range never leaves the vector
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE)) / sizeof(double);
+    size_t page_begin = begin / page_size * page_size;
+    size_t page_end = std::min(stride_, (end + page_size - 1) / page_size * page_size);
+    for (size_t n = first; n < std::min(last, nvec_); ++n) {
+        madvise(const_cast<double*>((*this)[n]) + page_begin,
+                (page_end - page_begin) * sizeof(double), advice);
+    }
+}
+} // namespace forte
@@ -0,0 +1,133 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER,
+ * AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _subspace_vectors_h_
+#define _subspace_vectors_h_
+
+#include <string>
+#include <vector>
+
+#include "helpers/numa_memory.h"
+
+namespace forte {
+
+/**
+ * @brief The SubspaceVectors class
+ * Stores a set of nvec vectors of dimension size, either in memory or in a memory-mapped
+ * scratch file. The out-of-core storage is meant for iterative solvers whose subspace does
+ * not fit in memory: the vectors are accessed one at a time and the caller signals with
+ * prefetch() which vector is needed next and with release() which vector is no longer needed.
+ * For in-memory storage these two functions do nothing.
+ *
+ * Example use:
+ *
+ *     SubspaceVectors b("b", nvec, size, out_of_core);
+ *     for (size_t i = 0; i < nvec; ++i) {
+ *         if (i + 1 < nvec)
+ *             b.prefetch(i + 1);                 // start reading the next vector
+ *         double* b_i = b[i];                    // work on b_i
+ *         ...
+ *         b.release(i);                          // b_i does not need to stay in memory
+ *     }
+ */
+class SubspaceVectors {
+  public:
+    // ==> Class Constructor and Destructor <==
+
+    /// Allocate nvec zero vectors of dimension size. If out_of_core is true the vectors are
+    /// stored in a file in the psi4 scratch directory that is removed when the object is
+    /// destroyed
+    SubspaceVectors(const std::string& name, size_t nvec, size_t size, bool out_of_core);
+
+    /// Destructor
+    ~SubspaceVectors();
+
+    SubspaceVectors(const SubspaceVectors&) = delete;
+    SubspaceVectors& operator=(const SubspaceVectors&) = delete;
+
+    // ==> Class Interface <==
+
+    /// Return the number of vectors
+    size_t nvec() const { return nvec_; }
+    /// Return the dimension of the vectors
+    size_t size() const { return size_; }
+    /// Are the vectors stored in a scratch file?
+    bool out_of_core() const { return out_of_core_; }
+    /// Return the distance between the beginning of two consecutive vectors
+    size_t stride() const { return stride_; }
+    /// Return the number of bytes used to store the vectors
+    size_t memory() const { return nvec_ * stride_ * sizeof(double); }
+
+    /// Return a pointer to the n-th vector
+    double* operator[](size_t n) { return data_ + n * stride_; }
+    const double* operator[](size_t n) const { return data_ + n * stride_; }
+    /// Return pointers to the first n vectors
+    std::vector<double*> pointers(size_t n);
+
+    /// Copy the n-th vector to v
+    void get(size_t n, double* v) const;
+    /// Copy v to the n-th vector
+    void set(size_t n, const double* v);
+    /// Zero the n-th vector
+    void zero(size_t n);
+
+    /// Start reading the n-th vector from disk. This call does not wait for the data
+    void prefetch(size_t n) const;
+    /// Allow the n-th vector to be evicted from memory
+    void release(size_t n) const;
+    /// Start reading the elements [begin, end) of the vectors first, ..., last - 1
+    void prefetch(size_t first, size_t last, size_t begin, size_t end) const;
+    /// Allow the elements [begin, end) of the vectors first, ..., last - 1 to be evicted
+    void release(size_t first, size_t last, size_t begin, size_t end) const;
+
+  private:
+    /// Call madvise on the pages that contain the elements [begin, end) of the vectors
+    /// first, ..., last - 1
+    void advise(size_t first, size_t last, size_t begin, size_t end, int advice) const;
+
+    /// The name of the vectors
+    std::string name_;
+    /// The number of vectors
+    size_t nvec_;
+    /// The dimension of the vectors
+    size_t size_;
+    /// The distance between two vectors. Out-of-core vectors start on a page boundary
+    size_t stride_;
+    /// Store the vectors in a scratch file?
+    bool out_of_core_;
+    /// The in-memory storage. Each vector is split among the threads as in a static loop
+    first_touch_vector<double> memory_;
+    /// The file descriptor of the scratch file
+    int fd_ = -1;
+    /// The beginning of the vectors
+    double* data_ = nullptr;
+};
+} // namespace forte
+
+#endif // _subspace_vectors_h_
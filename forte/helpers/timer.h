@@ -34,6 +34,8 @@
 
 #include <chrono>
 
+#include "helpers/profiler.h"
+
 namespace forte {
 
 /**
@@ -68,12 +70,12 @@ class local_timer {
  *
  * This class uses the psi4 functions timer_on/timer_off and a local_timer object
  * to track time. The function stop() will return the elapsed time and stop the psi4
- * timer.
+ * timer. The timed section is also recorded as a region of the Profiler (if enabled).
  */
 class timer {
   public:
     /// constructor. Create a timer with label name
-    timer(const std::string& name) : name_(name) {
+    timer(const std::string& name) : name_(name), region_(name) {
         psi::timer_on(name_);
         t_ = local_timer();
     }
@@ -84,6 +86,7 @@ class timer {
         if (running_) {
             running_ = false;
             psi::timer_off(name_);
+            region_.stop();
             return t_.get();
         }
         return 0.0;
@@ -92,6 +95,7 @@ class timer {
   private:
     std::string name_;
     bool running_ = true;
+    ProfileRegion region_;
     local_timer t_;
 };
 
@@ -103,7 +107,8 @@ class timer {
  */
 class parallel_timer {
   public:
-    parallel_timer(const std::string& name, int rank) : name_(name), rank_(rank) {
+    parallel_timer(const std::string& name, int rank)
+        : name_(name), rank_(rank), region_(name) {
         psi::parallel_timer_on(name_, rank_);
     }
     ~parallel_timer() { stop(); }
@@ -113,6 +118,7 @@ class parallel_timer {
         if (running_) {
             running_ = false;
             psi::parallel_timer_off(name_, rank_);
+            region_.stop();
         }
     }
 
@@ -120,6 +126,7 @@ class parallel_timer {
     std::string name_;
     int rank_;
     bool running_ = true;
+    ProfileRegion region_;
 };
 } // namespace forte
 
@@ -26,7 +26,12 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
 
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
@@ -38,6 +43,20 @@
 
 namespace forte {
 
+namespace {
+/// The largest memory (in bytes) used by the tables of single excitation integrals
+constexpr size_t max_single_tables_memory = 256 * 1024 * 1024;
+
+/// Return the sum of row[p] over the orbitals p set in bits
+double masked_sum(String bits, const double* row) {
+    double sum = 0.0;
+    for (int n = bits.count(); n > 0; --n) {
+        sum += row[bits.find_and_clear_first_one()];
+    }
+    return sum;
+}
+} // namespace
+
 ActiveSpaceIntegrals::ActiveSpaceIntegrals(std::shared_ptr<ForteIntegrals> ints,
                                            const std::vector<size_t>& active_mo,
                                            const std::vector<int>& active_mo_symmetry,
@@ -178,6 +197,7 @@ void ActiveSpaceIntegrals::startup() {
     tei_bb_.resize(nmo4_);
     diag_tei_aa_.resize(nmo2_);
     diag_tei_ab_.resize(nmo2_);
+    diag_tei_ba_.resize(nmo2_);
     diag_tei_bb_.resize(nmo2_);
     frozen_core_energy_ = ints_->frozen_core_energy();
 }
@@ -188,6 +208,191 @@ void ActiveSpaceIntegrals::set_active_integrals(const ambit::Tensor& act_aa,
     tei_aa_ = act_aa.data();
     tei_ab_ = act_ab.data();
     tei_bb_ = act_bb.data();
+    packed_ = false;
+    low_rank_ = false;
+    compute_diagonal_integrals();
+    compute_single_excitation_tables();
+}
+
+void ActiveSpaceIntegrals::compute_diagonal_integrals() {
+    diag_tei_aa_.resize(nmo2_);
+    diag_tei_ab_.resize(nmo2_);
+    diag_tei_ba_.resize(nmo2_);
+    diag_tei_bb_.resize(nmo2_);
+    for (size_t p = 0; p < nmo_; ++p) {
+        for (size_t q = 0; q < nmo_; ++q) {
+            diag_tei_aa_[p * nmo_ + q] = tei_aa(p, q, p, q);
+            diag_tei_ab_[p * nmo_ + q] = tei_ab(p, q, p, q);
+            diag_tei_ba_[q * nmo_ + p] = tei_ab(p, q, p, q);
+            diag_tei_bb_[p * nmo_ + q] = tei_bb(p, q, p, q);
+        }
+    }
+}
+
+void ActiveSpaceIntegrals::compute_single_excitation_tables() {
+    const size_t size = nmo3_;
+    single_tables_ = 4 * size * sizeof(double) <= max_single_tables_memory;
+    if (not single_tables_) {
+        std::vector<double>().swap(single_aa_);
+        std::vector<double>().swap(single_ab_);
+        std::vector<double>().swap(single_ba_);
+        std::vector<double>().swap(single_bb_);
+        return;
+    }
+    single_aa_.resize(size);
+    single_ab_.resize(size);
+    single_ba_.resize(size);
+    single_bb_.resize(size);
+#pragma omp parallel for
+    for (size_t ia = 0; ia < nmo2_; ++ia) {
+        const size_t i = ia / nmo_;
+        const size_t a = ia % nmo_;
+        double* row_aa = single_aa_.data() + ia * nmo_;
+        double* row_ab = single_ab_.data() + ia * nmo_;
+        double* row_ba = single_ba_.data() + ia * nmo_;
+        double* row_bb = single_bb_.data() + ia * nmo_;
+        for (size_t p = 0; p < nmo_; ++p) {
+            row_aa[p] = tei_aa(i, p, a, p);
+            row_ab[p] = tei_ab(i, p, a, p);
+            row_ba[p] = tei_ab(p, i, p, a);
+            row_bb[p] = tei_bb(i, p, a, p);
+        }
+    }
+}
+
+void ActiveSpaceIntegrals::pack_integrals() {
+    if (packed_ or low_rank_ or ints_->spin_restriction() != IntegralSpinRestriction::Restricted)
+        return;
+
+    int nirrep = 1;
+    for (int h : active_mo_symmetry_) {
+        nirrep = std::max(nirrep, h + 1);
+    }
+    // nirrep must be a power of two for the irrep of a pair to be h_p ^ h_q
+    while (nirrep & (nirrep - 1))
+        nirrep++;
+
+    pair_irrep_.assign(nmo2_, 0);
+    pair_index_.assign(nmo2_, 0);
+    packed_pairs_.assign(nirrep, {});
+    for (size_t p = 0; p < nmo_; ++p) {
+        for (size_t q = 0; q <= p; ++q) {
+            const int h = active_mo_symmetry_[p] ^ active_mo_symmetry_[q];
+            pair_irrep_[p * nmo_ + q] = pair_irrep_[q * nmo_ + p] = h;
+            pair_index_[p * nmo_ + q] = pair_index_[q * nmo_ + p] = packed_pairs_[h].size();
+            packed_pairs_[h].emplace_back(p, q);
+        }
+    }
+
+    packed_offset_.assign(nirrep, 0);
+    size_t size = 0;
+    for (int h = 0; h < nirrep; ++h) {
+        packed_offset_[h] = size;
+        size += packed_pairs_[h].size() * packed_pairs_[h].size();
+    }
+
+    // (pq|rs) = <pr|qs>
+    packed_tei_.resize(size);
+    for (int h = 0; h < nirrep; ++h) {
+        const auto& pairs = packed_pairs_[h];
+        const size_t npairs = pairs.size();
+#pragma omp parallel for
+        for (size_t pq = 0; pq < npairs; ++pq) {
+            const auto [p, q] = pairs[pq];
+            double* row = packed_tei_.data() + packed_offset_[h] + pq * npairs;
+            for (size_t rs = 0; rs < npairs; ++rs) {
+                const auto [r, s] = pairs[rs];
+                row[rs] = tei_ab_[tei_index(p, r, q, s)];
+            }
+        }
+    }
+
+    std::vector<double>().swap(tei_aa_);
+    std::vector<double>().swap(tei_ab_);
+    std::vector<double>().swap(tei_bb_);
+    packed_ = true;
+
+    psi::outfile->Printf("\n  Packed the active space integrals: %zu elements (%.2f MB).", size,
+                         size * sizeof(double) / 1048576.0);
+}
+
+void ActiveSpaceIntegrals::factorize_integrals(double tolerance) {
+    if (low_rank_ or ints_->spin_restriction() != IntegralSpinRestriction::Restricted)
+        return;
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t p = 0; p < nmo_; ++p) {
+        for (size_t q = 0; q <= p; ++q) {
+            pairs.emplace_back(p, q);
+        }
+    }
+    const size_t npairs = pairs.size();
+
+    // pivoted Cholesky decomposition of (pq|rs), the vectors are stored as L[n][pq]
+    std::vector<double> diag(npairs);
+    for (size_t pq = 0; pq < npairs; ++pq) {
+        const auto [p, q] = pairs[pq];
+        diag[pq] = tei_chem(p, q, p, q);
+    }
+    std::vector<std::vector<double>> L;
+    while (L.size() < npairs) {
+        const size_t pivot = std::max_element(diag.begin(), diag.end()) - diag.begin();
+        const double dmax = diag[pivot];
+        if (dmax < tolerance)
+            break;
+        const auto [r, s] = pairs[pivot];
+        std::vector<double> col(npairs);
+#pragma omp parallel for
+        for (size_t pq = 0; pq < npairs; ++pq) {
+            const auto [p, q] = pairs[pq];
+            double value = tei_chem(p, q, r, s);
+            for (const auto& Ln : L) {
+                value -= Ln[pq] * Ln[pivot];
+            }
+            col[pq] = value / std::sqrt(dmax);
+        }
+        for (size_t pq = 0; pq < npairs; ++pq) {
+            diag[pq] -= col[pq] * col[pq];
+        }
+        // the pivot is exactly decomposed, avoid picking it again because of round-off
+        diag[pivot] = 0.0;
+        L.push_back(std::move(col));
+    }
+
+    low_rank_nvec_ = L.size();
+    low_rank_B_.assign(nmo2_ * low_rank_nvec_, 0.0);
+    for (size_t pq = 0; pq < npairs; ++pq) {
+        const auto [p, q] = pairs[pq];
+        double* Bpq = low_rank_B_.data() + (p * nmo_ + q) * low_rank_nvec_;
+        double* Bqp = low_rank_B_.data() + (q * nmo_ + p) * low_rank_nvec_;
+        for (size_t n = 0; n < low_rank_nvec_; ++n) {
+            Bpq[n] = Bqp[n] = L[n][pq];
+        }
+    }
+
+    std::vector<double>().swap(tei_aa_);
+    std::vector<double>().swap(tei_ab_);
+    std::vector<double>().swap(tei_bb_);
+    std::vector<double>().swap(packed_tei_);
+    packed_ = false;
+    low_rank_ = true;
+    // the energies and couplings must be consistent with the factorized integrals
+    compute_diagonal_integrals();
+    compute_single_excitation_tables();
+
+    psi::outfile->Printf("\n  Factorized the active space integrals: %zu vectors (%.2f MB).",
+                         low_rank_nvec_, low_rank_B_.size() * sizeof(double) / 1048576.0);
+}
+
+void ActiveSpaceIntegrals::check_dense() const {
+    if (packed_) {
+        throw std::runtime_error("ActiveSpaceIntegrals: the dense two-electron integrals are not "
+                                 "available after pack_integrals()");
+    }
+    if (low_rank_) {
+        throw std::runtime_error("ActiveSpaceIntegrals: the dense two-electron integrals are not "
+                                 "available after factorize_integrals()");
+    }
 }
 
 void ActiveSpaceIntegrals::compute_restricted_one_body_operator() {
@@ -205,6 +410,10 @@ void ActiveSpaceIntegrals::set_active_integrals_and_restricted_docc() {
     tei_aa_ = act_aa.data();
     tei_ab_ = act_ab.data();
     tei_bb_ = act_bb.data();
+    packed_ = false;
+    low_rank_ = false;
+    compute_diagonal_integrals();
+    compute_single_excitation_tables();
     RestrictedOneBodyOperator(oei_a_, oei_b_);
 }
 
@@ -229,32 +438,139 @@ double ActiveSpaceIntegrals::energy(const Determinant& det) const {
         int p = Ia.find_and_clear_first_one();
         energy += oei_a_[p * nmo_ + p];
 
+        const double* d_aa = diag_tei_aa_.data() + p * nmo_;
+        const double* d_ab = diag_tei_ab_.data() + p * nmo_;
         Iac = Ia;
         for (int AA = A + 1; AA < naocc; ++AA) {
             int q = Iac.find_and_clear_first_one();
-            energy += tei_aa_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+            energy += d_aa[q];
         }
 
         Ibc = Ib;
         for (int B = 0; B < nbocc; ++B) {
             int q = Ibc.find_and_clear_first_one();
-            energy += tei_ab_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+            energy += d_ab[q];
         }
     }
 
     for (int B = 0; B < nbocc; ++B) {
         int p = Ib.find_and_clear_first_one();
         energy += oei_b_[p * nmo_ + p];
+        const double* d_bb = diag_tei_bb_.data() + p * nmo_;
         Ibc = Ib;
         for (int BB = B + 1; BB < nbocc; ++BB) {
             int q = Ibc.find_and_clear_first_one();
-            energy += tei_bb_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+            energy += d_bb[q];
         }
     }
 
     return energy;
 }
 
+void ActiveSpaceIntegrals::orbital_energies(const Determinant& det, std::vector<double>& eps_a,
+                                            std::vector<double>& eps_b) const {
+    eps_a.resize(nmo_);
+    eps_b.resize(nmo_);
+    double* ea = eps_a.data();
+    double* eb = eps_b.data();
+    for (size_t p = 0; p < nmo_; ++p) {
+        ea[p] = oei_a_[p * nmo_ + p];
+        eb[p] = oei_b_[p * nmo_ + p];
+    }
+    const size_t n = nmo_;
+    // each occupied alpha orbital q adds <pq||pq> to eps_a[p] and <qp|qp> to eps_b[p]
+    String Ia = det.get_alfa_bits();
+    for (int A = 0, naocc = Ia.count(); A < naocc; ++A) {
+        const size_t q = Ia.find_and_clear_first_one();
+        const double* d_aa = diag_tei_aa_.data() + q * nmo_;
+        const double* d_ab = diag_tei_ab_.data() + q * nmo_;
+#pragma omp simd
+        for (size_t p = 0; p < n; ++p) {
+            ea[p] += d_aa[p];
+            eb[p] += d_ab[p];
+        }
+    }
+    // each occupied beta orbital q adds <pq||pq> to eps_b[p] and <pq|pq> to eps_a[p]
+    String Ib = det.get_beta_bits();
+    for (int B = 0, nbocc = Ib.count(); B < nbocc; ++B) {
+        const size_t q = Ib.find_and_clear_first_one();
+        const double* d_bb = diag_tei_bb_.data() + q * nmo_;
+        const double* d_ba = diag_tei_ba_.data() + q * nmo_;
+#pragma omp simd
+        for (size_t p = 0; p < n; ++p) {
+            eb[p] += d_bb[p];
+            ea[p] += d_ba[p];
+        }
+    }
+}
+
+double ActiveSpaceIntegrals::orbital_energy_a(const Determinant& det, size_t p) const {
+    double eps = oei_a_[p * nmo_ + p];
+    const double* d_aa = diag_tei_aa_.data() + p * nmo_;
+    const double* d_ab = diag_tei_ab_.data() + p * nmo_;
+    String Ia = det.get_alfa_bits();
+    for (int A = 0, naocc = Ia.count(); A < naocc; ++A) {
+        eps += d_aa[Ia.find_and_clear_first_one()];
+    }
+    String Ib = det.get_beta_bits();
+    for (int B = 0, nbocc = Ib.count(); B < nbocc; ++B) {
+        eps += d_ab[Ib.find_and_clear_first_one()];
+    }
+    return eps;
+}
+
+double ActiveSpaceIntegrals::orbital_energy_b(const Determinant& det, size_t p) const {
+    double eps = oei_b_[p * nmo_ + p];
+    const double* d_bb = diag_tei_bb_.data() + p * nmo_;
+    const double* d_ba = diag_tei_ba_.data() + p * nmo_;
+    String Ib = det.get_beta_bits();
+    for (int B = 0, nbocc = Ib.count(); B < nbocc; ++B) {
+        eps += d_bb[Ib.find_and_clear_first_one()];
+    }
+    String Ia = det.get_alfa_bits();
+    for (int A = 0, naocc = Ia.count(); A < naocc; ++A) {
+        eps += d_ba[Ia.find_and_clear_first_one()];
+    }
+    return eps;
+}
+
+double ActiveSpaceIntegrals::energy_from_parent_a(double E, const Determinant& parent, size_t i,
+                                                  size_t a) const {
+    return E + orbital_energy_a(parent, a) - orbital_energy_a(parent, i) -
+           diag_tei_aa_[a * nmo_ + i];
+}
+
+double ActiveSpaceIntegrals::energy_from_parent_b(double E, const Determinant& parent, size_t i,
+                                                  size_t a) const {
+    return E + orbital_energy_b(parent, a) - orbital_energy_b(parent, i) -
+           diag_tei_bb_[a * nmo_ + i];
+}
+
+double ActiveSpaceIntegrals::energy_from_parent_aa(double E, const Determinant& parent, size_t i,
+                                                   size_t j, size_t a, size_t b) const {
+    const auto& d = diag_tei_aa_;
+    return E + orbital_energy_a(parent, a) + orbital_energy_a(parent, b) -
+           orbital_energy_a(parent, i) - orbital_energy_a(parent, j) + d[i * nmo_ + j] +
+           d[a * nmo_ + b] - d[a * nmo_ + i] - d[a * nmo_ + j] - d[b * nmo_ + i] -
+           d[b * nmo_ + j];
+}
+
+double ActiveSpaceIntegrals::energy_from_parent_ab(double E, const Determinant& parent, size_t i,
+                                                   size_t j, size_t a, size_t b) const {
+    const auto& d = diag_tei_ab_;
+    return energy_from_parent_b(energy_from_parent_a(E, parent, i, a), parent, j, b) +
+           d[i * nmo_ + j] - d[a * nmo_ + j] - d[i * nmo_ + b] + d[a * nmo_ + b];
+}
+
+double ActiveSpaceIntegrals::energy_from_parent_bb(double E, const Determinant& parent, size_t i,
+                                                   size_t j, size_t a, size_t b) const {
+    const auto& d = diag_tei_bb_;
+    return E + orbital_energy_b(parent, a) + orbital_energy_b(parent, b) -
+           orbital_energy_b(parent, i) - orbital_energy_b(parent, j) + d[i * nmo_ + j] +
+           d[a * nmo_ + b] - d[a * nmo_ + i] - d[a * nmo_ + j] - d[b * nmo_ + i] -
+           d[b * nmo_ + j];
+}
+
 double ActiveSpaceIntegrals::slater_rules(const Determinant& lhs, const Determinant& rhs) const {
     // we first check that the two determinants have equal Ms
     if ((lhs.count_alfa() != rhs.count_alfa()) or (lhs.count_beta() != rhs.count_beta()))
@@ -289,11 +605,11 @@ double ActiveSpaceIntegrals::slater_rules(const Determinant& lhs, const Determin
                 matrix_element += oei_b_[p * nmo_ + p];
             for (size_t q = 0; q < nmo_; ++q) {
                 if (lhs.get_alfa_bit(p) and lhs.get_alfa_bit(q))
-                    matrix_element += 0.5 * tei_aa_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+                    matrix_element += 0.5 * tei_aa(p, q, p, q);
                 if (lhs.get_beta_bit(p) and lhs.get_beta_bit(q))
-                    matrix_element += 0.5 * tei_bb_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+                    matrix_element += 0.5 * tei_bb(p, q, p, q);
                 if (lhs.get_alfa_bit(p) and lhs.get_beta_bit(q))
-                    matrix_element += tei_ab_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+                    matrix_element += tei_ab(p, q, p, q);
             }
         }
     }
@@ -311,15 +627,9 @@ double ActiveSpaceIntegrals::slater_rules(const Determinant& lhs, const Determin
         }
         // double sign = SlaterSign(I, i, j);
         double sign = lhs.slater_sign_aa(i, j);
-        matrix_element = sign * oei_a_[i * nmo_ + j];
-        for (size_t p = 0; p < nmo_; ++p) {
-            if (lhs.get_alfa_bit(p) and rhs.get_alfa_bit(p)) {
-                matrix_element += sign * tei_aa_[i * nmo3_ + p * nmo2_ + j * nmo_ + p];
-            }
-            if (lhs.get_beta_bit(p) and rhs.get_beta_bit(p)) {
-                matrix_element += sign * tei_ab_[i * nmo3_ + p * nmo2_ + j * nmo_ + p];
-            }
-        }
+        matrix_element = sign * single_alpha_coupling(lhs.get_alfa_bits() & rhs.get_alfa_bits(),
+                                                      lhs.get_beta_bits() & rhs.get_beta_bits(),
+                                                      i, j);
     }
     // Slater rule 2 PhiI = j_b^+ i_b PhiJ
     if ((nadiff == 0) and (nbdiff == 1)) {
@@ -334,15 +644,9 @@ double ActiveSpaceIntegrals::slater_rules(const Determinant& lhs, const Determin
         }
         // double sign = SlaterSign(I, nmo_ + i, nmo_ + j);
         double sign = lhs.slater_sign_bb(i, j);
-        matrix_element = sign * oei_b_[i * nmo_ + j];
-        for (size_t p = 0; p < nmo_; ++p) {
-            if (lhs.get_alfa_bit(p) and rhs.get_alfa_bit(p)) {
-                matrix_element += sign * tei_ab_[p * nmo3_ + i * nmo2_ + p * nmo_ + j];
-            }
-            if (lhs.get_beta_bit(p) and rhs.get_beta_bit(p)) {
-                matrix_element += sign * tei_bb_[i * nmo3_ + p * nmo2_ + j * nmo_ + p];
-            }
-        }
+        matrix_element = sign * single_beta_coupling(lhs.get_alfa_bits() & rhs.get_alfa_bits(),
+                                                     lhs.get_beta_bits() & rhs.get_beta_bits(),
+                                                     i, j);
     }
 
     // Slater rule 3 PhiI = k_a^+ l_a^+ j_a i_a PhiJ
@@ -370,7 +674,7 @@ double ActiveSpaceIntegrals::slater_rules(const Determinant& lhs, const Determin
         }
         // double sign = SlaterSign(I, i, j, k, l);
         double sign = lhs.slater_sign_aaaa(i, j, k, l);
-        matrix_element = sign * tei_aa_[i * nmo3_ + j * nmo2_ + k * nmo_ + l];
+        matrix_element = sign * tei_aa(i, j, k, l);
     }
 
     // Slater rule 3 PhiI = k_a^+ l_a^+ j_a i_a PhiJ
@@ -399,7 +703,7 @@ double ActiveSpaceIntegrals::slater_rules(const Determinant& lhs, const Determin
         }
         // double sign = SlaterSign(I, nmo_ + i, nmo_ + j, nmo_ + k, nmo_ + l);
         double sign = lhs.slater_sign_bbbb(i, j, k, l);
-        matrix_element = sign * tei_bb_[i * nmo3_ + j * nmo2_ + k * nmo_ + l];
+        matrix_element = sign * tei_bb(i, j, k, l);
     }
 
     // Slater rule 3 PhiI = j_a^+ i_a PhiJ
@@ -420,70 +724,78 @@ double ActiveSpaceIntegrals::slater_rules(const Determinant& lhs, const Determin
         //  double sign = SlaterSign(I, i, nmo_ + j, k, nmo_ + l);
         // double sign = lhs.slater_sign(i, nmo_ + j, k, nmo_ + l);
         double sign = lhs.slater_sign_aa(i, k) * lhs.slater_sign_bb(j, l);
-        matrix_element = sign * tei_ab_[i * nmo3_ + j * nmo2_ + k * nmo_ + l];
+        matrix_element = sign * tei_ab(i, j, k, l);
     }
 #endif
     return (matrix_element);
 }
 
-double ActiveSpaceIntegrals::slater_rules_single_alpha(const Determinant& det, int i, int a) const {
-    // Slater rule 2 PhiI = j_a^+ i_a PhiJ
-    double sign = det.slater_sign_aa(i, a);
+double ActiveSpaceIntegrals::single_alpha_coupling(const String& Ia, const String& Ib, size_t i,
+                                                   size_t a) const {
     double matrix_element = oei_a_[i * nmo_ + a];
-    for (size_t p = 0; p < nmo_; ++p) {
-        if (det.get_alfa_bit(p)) {
-            matrix_element += tei_aa_[i * nmo3_ + p * nmo2_ + a * nmo_ + p];
-        }
-        if (det.get_beta_bit(p)) {
-            matrix_element += tei_ab_[i * nmo3_ + p * nmo2_ + a * nmo_ + p];
-        }
+    if (single_tables_) {
+        const size_t ia = (i * nmo_ + a) * nmo_;
+        matrix_element += masked_sum(Ia, single_aa_.data() + ia);
+        matrix_element += masked_sum(Ib, single_ab_.data() + ia);
+        return matrix_element;
+    }
+    String I = Ia;
+    for (int n = I.count(); n > 0; --n) {
+        const size_t p = I.find_and_clear_first_one();
+        matrix_element += tei_aa(i, p, a, p);
+    }
+    I = Ib;
+    for (int n = I.count(); n > 0; --n) {
+        const size_t p = I.find_and_clear_first_one();
+        matrix_element += tei_ab(i, p, a, p);
     }
-    return sign * matrix_element;
+    return matrix_element;
+}
+
+double ActiveSpaceIntegrals::single_beta_coupling(const String& Ia, const String& Ib, size_t i,
+                                                  size_t a) const {
+    double matrix_element = oei_b_[i * nmo_ + a];
+    if (single_tables_) {
+        const size_t ia = (i * nmo_ + a) * nmo_;
+        matrix_element += masked_sum(Ia, single_ba_.data() + ia);
+        matrix_element += masked_sum(Ib, single_bb_.data() + ia);
+        return matrix_element;
+    }
+    String I = Ia;
+    for (int n = I.count(); n > 0; --n) {
+        const size_t p = I.find_and_clear_first_one();
+        matrix_element += tei_ab(p, i, p, a);
+    }
+    I = Ib;
+    for (int n = I.count(); n > 0; --n) {
+        const size_t p = I.find_and_clear_first_one();
+        matrix_element += tei_bb(i, p, a, p);
+    }
+    return matrix_element;
+}
+
+double ActiveSpaceIntegrals::slater_rules_single_alpha(const Determinant& det, int i, int a) const {
+    // Slater rule 2 PhiI = j_a^+ i_a PhiJ
+    return det.slater_sign_aa(i, a) *
+           single_alpha_coupling(det.get_alfa_bits(), det.get_beta_bits(), i, a);
 }
 
 double ActiveSpaceIntegrals::slater_rules_single_alpha_abs(const Determinant& det, int i,
                                                            int a) const {
     // Slater rule 2 PhiI = j_a^+ i_a PhiJ
-    double matrix_element = oei_a_[i * nmo_ + a];
-    for (size_t p = 0; p < nmo_; ++p) {
-        if (det.get_alfa_bit(p)) {
-            matrix_element += tei_aa_[i * nmo3_ + p * nmo2_ + a * nmo_ + p];
-        }
-        if (det.get_beta_bit(p)) {
-            matrix_element += tei_ab_[i * nmo3_ + p * nmo2_ + a * nmo_ + p];
-        }
-    }
-    return matrix_element;
+    return single_alpha_coupling(det.get_alfa_bits(), det.get_beta_bits(), i, a);
 }
 
 double ActiveSpaceIntegrals::slater_rules_single_beta(const Determinant& det, int i, int a) const {
     // Slater rule 2 PhiI = j_a^+ i_a PhiJ
-    double sign = det.slater_sign_bb(i, a);
-    double matrix_element = oei_b_[i * nmo_ + a];
-    for (size_t p = 0; p < nmo_; ++p) {
-        if (det.get_alfa_bit(p)) {
-            matrix_element += tei_ab_[p * nmo3_ + i * nmo2_ + p * nmo_ + a];
-        }
-        if (det.get_beta_bit(p)) {
-            matrix_element += tei_bb_[i * nmo3_ + p * nmo2_ + a * nmo_ + p];
-        }
-    }
-    return sign * matrix_element;
+    return det.slater_sign_bb(i, a) *
+           single_beta_coupling(det.get_alfa_bits(), det.get_beta_bits(), i, a);
 }
 
 double ActiveSpaceIntegrals::slater_rules_single_beta_abs(const Determinant& det, int i,
                                                           int a) const {
     // Slater rule 2 PhiI = j_a^+ i_a PhiJ
-    double matrix_element = oei_b_[i * nmo_ + a];
-    for (size_t p = 0; p < nmo_; ++p) {
-        if (det.get_alfa_bit(p)) {
-            matrix_element += tei_ab_[p * nmo3_ + i * nmo2_ + p * nmo_ + a];
-        }
-        if (det.get_beta_bit(p)) {
-            matrix_element += tei_bb_[i * nmo3_ + p * nmo2_ + a * nmo_ + p];
-        }
-    }
-    return matrix_element;
+    return single_beta_coupling(det.get_alfa_bits(), det.get_beta_bits(), i, a);
 }
 
 void ActiveSpaceIntegrals::print() {
@@ -545,6 +857,75 @@ void ActiveSpaceIntegrals::print() {
     }
 }
 
+namespace {
+/// An ActiveSpaceIntegrals object made by make_active_space_ints
+struct ActiveSpaceIntsCacheEntry {
+    std::weak_ptr<ForteIntegrals> ints;
+    std::vector<size_t> active_mo;
+    std::vector<size_t> core_mo;
+    size_t fingerprint;
+    std::weak_ptr<ActiveSpaceIntegrals> as_ints;
+};
+/// The objects made by make_active_space_ints that may still be in use
+std::vector<ActiveSpaceIntsCacheEntry> as_ints_cache;
+/// Serializes the access to the cache
+std::mutex as_ints_cache_mutex;
+
+void hash_combine(size_t& seed, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    seed ^= std::hash<uint64_t>()(bits) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+/// A fingerprint of the integrals that enter the active space integrals: the orbitals, the
+/// scalar energies, the one-electron integrals of the active and core orbitals, and the diagonal
+/// two-electron integrals of the active orbitals
+size_t integrals_fingerprint(std::shared_ptr<ForteIntegrals> ints,
+                             const std::vector<size_t>& active_mo,
+                             const std::vector<size_t>& core_mo) {
+    size_t seed = 0;
+    for (const auto& C : {ints->Ca(), ints->Cb()}) {
+        if (not C)
+            continue;
+        for (int h = 0; h < C->nirrep(); ++h) {
+            const size_t size = static_cast<size_t>(C->rowspi(h)) * C->colspi(h);
+            const double* c = size > 0 ? C->pointer(h)[0] : nullptr;
+            for (size_t n = 0; n < size; ++n) {
+                hash_combine(seed, c[n]);
+            }
+        }
+    }
+    hash_combine(seed, ints->nuclear_repulsion_energy());
+    hash_combine(seed, ints->frozen_core_energy());
+    hash_combine(seed, ints->scalar());
+    std::vector<size_t> mos(active_mo);
+    mos.insert(mos.end(), core_mo.begin(), core_mo.end());
+    for (size_t p : mos) {
+        for (size_t q : mos) {
+            hash_combine(seed, ints->oei_a(p, q));
+            hash_combine(seed, ints->oei_b(p, q));
+        }
+    }
+    for (size_t p : active_mo) {
+        for (size_t q : active_mo) {
+            hash_combine(seed, ints->aptei_ab(p, q, p, q));
+        }
+    }
+    return seed;
+}
+} // namespace
+
+std::shared_ptr<ActiveSpaceIntegrals>
+detach_active_space_ints(std::shared_ptr<ActiveSpaceIntegrals> as_ints) {
+    std::lock_guard<std::mutex> lock(as_ints_cache_mutex);
+    for (const auto& entry : as_ints_cache) {
+        if (entry.as_ints.lock() == as_ints) {
+            return std::make_shared<ActiveSpaceIntegrals>(*as_ints);
+        }
+    }
+    return as_ints;
+}
+
 std::shared_ptr<ActiveSpaceIntegrals>
 make_active_space_ints(std::shared_ptr<MOSpaceInfo> mo_space_info,
                        std::shared_ptr<ForteIntegrals> ints, const std::string& active_space,
@@ -559,6 +940,26 @@ make_active_space_ints(std::shared_ptr<MOSpaceInfo> mo_space_info,
         core_mo.insert(core_mo.end(), mos.begin(), mos.end());
     }
 
+    // reuse an object made for the same integrals that is still in use
+    const size_t fingerprint = integrals_fingerprint(ints, active_mo, core_mo);
+    {
+        std::lock_guard<std::mutex> lock(as_ints_cache_mutex);
+        // forget the objects that are no longer used
+        as_ints_cache.erase(std::remove_if(as_ints_cache.begin(), as_ints_cache.end(),
+                                           [](const ActiveSpaceIntsCacheEntry& entry) {
+                                               return entry.as_ints.expired() or
+                                                      entry.ints.expired();
+                                           }),
+                            as_ints_cache.end());
+        for (const auto& entry : as_ints_cache) {
+            if ((entry.ints.lock() == ints) and (entry.fingerprint == fingerprint) and
+                (entry.active_mo == active_mo) and (entry.core_mo == core_mo)) {
+                if (auto as_ints = entry.as_ints.lock())
+                    return as_ints;
+            }
+        }
+    }
+
     // allocate the active space integral object
     auto as_ints =
         std::make_shared<ActiveSpaceIntegrals>(ints, active_mo, active_mo_symmetry, core_mo);
@@ -577,6 +978,9 @@ make_active_space_ints(std::shared_ptr<MOSpaceInfo> mo_space_info,
         as_ints->set_active_integrals(tei_active_aa, tei_active_ab, tei_active_bb);
     }
     as_ints->compute_restricted_one_body_operator();
+
+    std::lock_guard<std::mutex> lock(as_ints_cache_mutex);
+    as_ints_cache.push_back({ints, active_mo, core_mo, fingerprint, as_ints});
     return as_ints;
 }
 
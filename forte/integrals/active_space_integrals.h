@@ -84,6 +84,62 @@ class ActiveSpaceIntegrals {
     /// Compute a determinant's energy
     double energy(const Determinant& det) const;
 
+    /**
+     * @brief Compute the alpha and beta orbital energies of a determinant
+     *
+     * eps_a[p] = h_pp + sum_q <pq||pq> n^alpha_q + sum_q <pq|pq> n^beta_q (and similarly for
+     * beta). These are the only quantities needed to obtain the energy of all the single and
+     * double excitations of det with the energy_from_parent() functions in O(1) each.
+     */
+    void orbital_energies(const Determinant& det, std::vector<double>& eps_a,
+                          std::vector<double>& eps_b) const;
+
+    /// The energy of parent with the alpha excitation i -> a, given its energy E and its
+    /// orbital energies
+    double energy_from_parent_a(double E, const std::vector<double>& eps_a, size_t i,
+                                size_t a) const {
+        return E + eps_a[a] - eps_a[i] - diag_tei_aa_[a * nmo_ + i];
+    }
+    /// The energy of parent with the beta excitation i -> a
+    double energy_from_parent_b(double E, const std::vector<double>& eps_b, size_t i,
+                                size_t a) const {
+        return E + eps_b[a] - eps_b[i] - diag_tei_bb_[a * nmo_ + i];
+    }
+    /// The energy of parent with the alpha-alpha excitation ij -> ab
+    double energy_from_parent_aa(double E, const std::vector<double>& eps_a, size_t i, size_t j,
+                                 size_t a, size_t b) const {
+        return E + delta_same_spin(eps_a, diag_tei_aa_, i, j, a, b);
+    }
+    /// The energy of parent with the alpha-beta excitation i(alpha) j(beta) -> a(alpha) b(beta)
+    double energy_from_parent_ab(double E, const std::vector<double>& eps_a,
+                                 const std::vector<double>& eps_b, size_t i, size_t j, size_t a,
+                                 size_t b) const {
+        return energy_from_parent_b(energy_from_parent_a(E, eps_a, i, a), eps_b, j, b) +
+               diag_tei_ab_[i * nmo_ + j] - diag_tei_ab_[a * nmo_ + j] -
+               diag_tei_ab_[i * nmo_ + b] + diag_tei_ab_[a * nmo_ + b];
+    }
+    /// The energy of parent with the beta-beta excitation ij -> ab
+    double energy_from_parent_bb(double E, const std::vector<double>& eps_b, size_t i, size_t j,
+                                 size_t a, size_t b) const {
+        return E + delta_same_spin(eps_b, diag_tei_bb_, i, j, a, b);
+    }
+
+    /// The energy of parent with the alpha excitation i -> a, computed in O(n_occ) from the
+    /// energy E of parent. Use orbital_energies() when many excitations of parent are needed
+    double energy_from_parent_a(double E, const Determinant& parent, size_t i, size_t a) const;
+    /// The energy of parent with the beta excitation i -> a in O(n_occ)
+    double energy_from_parent_b(double E, const Determinant& parent, size_t i, size_t a) const;
+    /// The energy of parent with the alpha-alpha excitation ij -> ab in O(n_occ)
+    double energy_from_parent_aa(double E, const Determinant& parent, size_t i, size_t j,
+                                 size_t a, size_t b) const;
+    /// The energy of parent with the alpha-beta excitation i(alpha) j(beta) -> a(alpha) b(beta)
+    /// in O(n_occ)
+    double energy_from_parent_ab(double E, const Determinant& parent, size_t i, size_t j,
+                                 size_t a, size_t b) const;
+    /// The energy of parent with the beta-beta excitation ij -> ab in O(n_occ)
+    double energy_from_parent_bb(double E, const Determinant& parent, size_t i, size_t j,
+                                 size_t a, size_t b) const;
+
     /// Compute the matrix element of the Hamiltonian between this determinant
     /// and a given one
     double slater_rules(const Determinant& lhs, const Determinant& rhs) const;
@@ -104,40 +160,112 @@ class ActiveSpaceIntegrals {
     double oei_a(size_t p, size_t q) const { return oei_a_[p * nmo_ + q]; }
     /// Return the beta effective one-electron integral
     double oei_b(size_t p, size_t q) const { return oei_b_[p * nmo_ + q]; }
-    std::vector<double> oei_a_vector() { return oei_a_; }
-    std::vector<double> oei_b_vector() { return oei_b_; }
+    /// Return a vector of alpha effective one-electron integrals
+    const std::vector<double>& oei_a_vector() const { return oei_a_; }
+    /// Return a vector of beta effective one-electron integrals
+    const std::vector<double>& oei_b_vector() const { return oei_b_; }
 
     /// Return the alpha-alpha antisymmetrized two-electron integral <pq||rs>
     double tei_aa(size_t p, size_t q, size_t r, size_t s) const {
+        if (packed_)
+            return tei_chem_packed(p, r, q, s) - tei_chem_packed(p, s, q, r);
+        if (low_rank_)
+            return tei_chem_low_rank(p, r, q, s) - tei_chem_low_rank(p, s, q, r);
         return tei_aa_[nmo3_ * p + nmo2_ * q + nmo_ * r + s];
     }
     /// Return the alpha-beta two-electron integral <pq|rs>
     double tei_ab(size_t p, size_t q, size_t r, size_t s) const {
+        if (packed_)
+            return tei_chem_packed(p, r, q, s);
+        if (low_rank_)
+            return tei_chem_low_rank(p, r, q, s);
         return tei_ab_[nmo3_ * p + nmo2_ * q + nmo_ * r + s];
     }
     /// Return the beta-beta antisymmetrized two-electron integral <pq||rs>
     double tei_bb(size_t p, size_t q, size_t r, size_t s) const {
+        if (packed_)
+            return tei_chem_packed(p, r, q, s) - tei_chem_packed(p, s, q, r);
+        if (low_rank_)
+            return tei_chem_low_rank(p, r, q, s) - tei_chem_low_rank(p, s, q, r);
         return tei_bb_[nmo3_ * p + nmo2_ * q + nmo_ * r + s];
     }
+    /// Return the spatial two-electron integral in chemist notation (pq|rs) = <pr|qs>
+    double tei_chem(size_t p, size_t q, size_t r, size_t s) const {
+        if (packed_)
+            return tei_chem_packed(p, q, r, s);
+        if (low_rank_)
+            return tei_chem_low_rank(p, q, r, s);
+        return tei_ab_[nmo3_ * p + nmo2_ * r + nmo_ * q + s];
+    }
 
     /// Return a vector of alpha-alpha antisymmetrized two-electron integrals
-    const std::vector<double>& tei_aa_vector() const { return tei_aa_; }
+    const std::vector<double>& tei_aa_vector() const {
+        check_dense();
+        return tei_aa_;
+    }
     /// Return a vector of alpha-beta antisymmetrized two-electron integrals
-    const std::vector<double>& tei_ab_vector() const { return tei_ab_; }
+    const std::vector<double>& tei_ab_vector() const {
+        check_dense();
+        return tei_ab_;
+    }
     /// Return a vector of beta-beta antisymmetrized two-electron integrals
-    const std::vector<double>& tei_bb_vector() const { return tei_bb_; }
+    const std::vector<double>& tei_bb_vector() const {
+        check_dense();
+        return tei_bb_;
+    }
 
     /// Return the alpha-alpha antisymmetrized two-electron integral <pq||pq>
-    double diag_tei_aa(size_t p, size_t q) const {
-        return tei_aa_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+    double diag_tei_aa(size_t p, size_t q) const { return diag_tei_aa_[p * nmo_ + q]; }
+    /// Return the alpha-beta two-electron integral <pq|pq>
+    double diag_tei_ab(size_t p, size_t q) const { return diag_tei_ab_[p * nmo_ + q]; }
+    /// Return the beta-beta antisymmetrized two-electron integral <pq||pq>
+    double diag_tei_bb(size_t p, size_t q) const { return diag_tei_bb_[p * nmo_ + q]; }
+
+    /**
+     * @brief Replace the dense two-electron integrals by a symmetry-packed copy of (pq|rs)
+     *
+     * Only the pairs p >= q are stored, and for each irrep h of the pair pq only the block
+     * (pq|rs) with rs of the same irrep, as a square npairs(h) x npairs(h) matrix. This uses
+     * 4-fold permutational and point-group symmetry and reduces the memory of the three dense
+     * nmo^4 arrays by about 12 x nirrep, while keeping the rows (pq|**) contiguous.
+     * The dense vectors (tei_aa_vector(), ...) are no longer available after this call.
+     * Unrestricted integrals are left dense.
+     */
+    void pack_integrals();
+    /// Return true if the two-electron integrals are stored in packed form
+    bool packed() const { return packed_; }
+    /**
+     * @brief Replace the two-electron integrals by a low-rank factorization
+     *        (pq|rs) = sum_L B^L_pq B^L_rs
+     *
+     * The vectors B^L are obtained by a pivoted Cholesky decomposition of the matrix (pq|rs)
+     * over the pairs p >= q, stopped when the largest remaining diagonal element is smaller
+     * than tolerance. The number of vectors grows as O(nmo), so the memory is O(nmo^3) instead
+     * of nmo^4. Integrals are then computed on the fly with a dot product of length nvec.
+     * The dense vectors (tei_aa_vector(), ...) are no longer available after this call.
+     * Unrestricted integrals are left as they are.
+     */
+    void factorize_integrals(double tolerance);
+    /// Return true if the two-electron integrals are stored in low-rank form
+    bool low_rank() const { return low_rank_; }
+    /// Return the number of low-rank vectors (0 if the integrals are not factorized)
+    size_t low_rank_nvec() const { return low_rank_nvec_; }
+    /// Return the low-rank vector B^L_pq for all pairs pq as a row pq of length nvec
+    const double* low_rank_row(size_t p, size_t q) const {
+        return low_rank_B_.data() + (p * nmo_ + q) * low_rank_nvec_;
     }
-    /// Return the alpha-beta two-electron integral <pq|rs>
-    double diag_tei_ab(size_t p, size_t q) const {
-        return tei_ab_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+    /// Return the list of pairs (p, q) with p >= q of irrep h, in packed row order
+    const std::vector<std::pair<size_t, size_t>>& packed_pairs(int h) const {
+        return packed_pairs_[h];
     }
-    /// Return the beta-beta antisymmetrized two-electron integral <pq||rs>
-    double diag_tei_bb(size_t p, size_t q) const {
-        return tei_bb_[p * nmo3_ + q * nmo2_ + p * nmo_ + q];
+    /**
+     * @brief Return a pointer to the packed row (pq|rs) for all the pairs rs in
+     *        packed_pairs(h), h being the irrep of pq. Requires packed() == true.
+     */
+    const double* packed_row(size_t p, size_t q) const {
+        const size_t pq = p * nmo_ + q;
+        const int h = pair_irrep_[pq];
+        return packed_tei_.data() + packed_offset_[h] + pair_index_[pq] * packed_pairs_[h].size();
     }
     IntegralType get_integral_type() { return integral_type_; }
     /// Set the active integrals
@@ -162,6 +290,27 @@ class ActiveSpaceIntegrals {
     void print();
 
   private:
+    /// Fill the tables of diagonal two-electron integrals from the current integrals
+    void compute_diagonal_integrals();
+    /// Fill the tables of single excitation integrals from the current integrals, if they fit in
+    /// memory
+    void compute_single_excitation_tables();
+    /// The coupling h_ia + sum_p <ip||ap> n^alpha_p + sum_p <ip|ap> n^beta_p of an alpha
+    /// excitation i -> a, where the occupation numbers are given by Ia and Ib (without sign)
+    double single_alpha_coupling(const String& Ia, const String& Ib, size_t i, size_t a) const;
+    /// The coupling of a beta excitation i -> a (without sign)
+    double single_beta_coupling(const String& Ia, const String& Ib, size_t i, size_t a) const;
+    /// The alpha (beta) orbital energy eps_p of a determinant (see orbital_energies())
+    double orbital_energy_a(const Determinant& det, size_t p) const;
+    double orbital_energy_b(const Determinant& det, size_t p) const;
+    /// The energy change of a same-spin excitation ij -> ab from the orbital energies and the
+    /// diagonal integrals <pq||pq> of that spin
+    double delta_same_spin(const std::vector<double>& eps, const std::vector<double>& d, size_t i,
+                           size_t j, size_t a, size_t b) const {
+        return eps[a] + eps[b] - eps[i] - eps[j] + d[i * nmo_ + j] + d[a * nmo_ + b] -
+               d[a * nmo_ + i] - d[a * nmo_ + j] - d[b * nmo_ + i] - d[b * nmo_ + j];
+    }
+
     // ==> Class Private Data <==
 
     /// The number of MOs
@@ -193,15 +342,20 @@ class ActiveSpaceIntegrals {
     /// The beta-beta antisymmetrized two-electron integrals in physicist
     /// notation
     std::vector<double> tei_bb_;
-    /// The diagonal alpha-alpha antisymmetrized two-electron integrals in
-    /// physicist notation
+    /// The diagonal alpha-alpha antisymmetrized two-electron integrals <pq||pq> (p * nmo + q)
     std::vector<double> diag_tei_aa_;
-    /// The diagonal alpha-beta antisymmetrized two-electron integrals in
-    /// physicist notation
+    /// The diagonal alpha-beta two-electron integrals <pq|pq> (p * nmo + q)
     std::vector<double> diag_tei_ab_;
-    /// The diagonal beta-beta antisymmetrized two-electron integrals in
-    /// physicist notation
+    /// The transpose of diag_tei_ab_, <qp|qp> stored as p * nmo + q
+    std::vector<double> diag_tei_ba_;
+    /// The diagonal beta-beta antisymmetrized two-electron integrals <pq||pq> (p * nmo + q)
     std::vector<double> diag_tei_bb_;
+    /// Are the tables of single excitation integrals available?
+    bool single_tables_ = false;
+    /// The integrals <ip||ap> (aa, bb), <ip|ap> (ab), and <pi|pa> (ba) of the single excitations
+    /// i -> a, stored as rows (i * nmo + a) * nmo + p so that the coupling of a single excitation
+    /// is a sum of table entries over the occupied orbitals
+    std::vector<double> single_aa_, single_ab_, single_ba_, single_bb_;
     /// A vector of indices for the active molecular orbitals
     std::vector<size_t> active_mo_;
     /// A vector of the symmetry ofthe active molecular orbitals
@@ -209,21 +363,80 @@ class ActiveSpaceIntegrals {
     /// A Vector of indices for the restricted_docc molecular orbitals
     std::vector<size_t> restricted_docc_mo_;
 
+    /// Are the two-electron integrals stored in packed form?
+    bool packed_ = false;
+    /// The irrep of each pair pq (stored for all p, q)
+    std::vector<int> pair_irrep_;
+    /// The position of each pair pq (stored for all p, q) in the list packed_pairs_[h]
+    std::vector<size_t> pair_index_;
+    /// The pairs (p, q) with p >= q of each irrep
+    std::vector<std::vector<std::pair<size_t, size_t>>> packed_pairs_;
+    /// The offset of the block of irrep h in packed_tei_
+    std::vector<size_t> packed_offset_;
+    /// The packed integrals (pq|rs), one square block per irrep of pq
+    std::vector<double> packed_tei_;
+
+    /// Are the two-electron integrals stored in low-rank form?
+    bool low_rank_ = false;
+    /// The number of low-rank vectors
+    size_t low_rank_nvec_ = 0;
+    /// The low-rank vectors stored as B[pq][L] for all p, q
+    std::vector<double> low_rank_B_;
+
     // ==> Class Private Functions <==
 
     inline size_t tei_index(size_t p, size_t q, size_t r, size_t s) const {
         return nmo3_ * p + nmo2_ * q + nmo_ * r + s;
     }
+    /// Look up (pq|rs) in the packed storage
+    inline double tei_chem_packed(size_t p, size_t q, size_t r, size_t s) const {
+        const size_t pq = p * nmo_ + q;
+        const size_t rs = r * nmo_ + s;
+        const int h = pair_irrep_[pq];
+        if (h != pair_irrep_[rs])
+            return 0.0;
+        return packed_tei_[packed_offset_[h] + pair_index_[pq] * packed_pairs_[h].size() +
+                           pair_index_[rs]];
+    }
+    /// Compute (pq|rs) from the low-rank vectors
+    inline double tei_chem_low_rank(size_t p, size_t q, size_t r, size_t s) const {
+        const double* Bpq = low_rank_B_.data() + (p * nmo_ + q) * low_rank_nvec_;
+        const double* Brs = low_rank_B_.data() + (r * nmo_ + s) * low_rank_nvec_;
+        double value = 0.0;
+        for (size_t L = 0; L < low_rank_nvec_; ++L) {
+            value += Bpq[L] * Brs[L];
+        }
+        return value;
+    }
+    /// Throw if the dense integrals are not available
+    void check_dense() const;
     /// F^{closed}_{uv} = h_{uv} + \sum_{i = frozen_core}^{restricted_core} 2(uv|ii) - (ui|vi)
     void RestrictedOneBodyOperator(std::vector<double>& oei_a, std::vector<double>& oei_b);
     void startup();
 };
 
+/**
+ * @brief Make an ActiveSpaceIntegrals object for the orbitals of active_space
+ *
+ * The objects are cached: a call with the same ForteIntegrals object, the same orbitals, and
+ * integrals with the same fingerprint (orbitals, one-electron integrals, and diagonal
+ * two-electron integrals) returns the object made by a previous call if it is still in use.
+ * The cache does not keep the objects alive. Call detach_active_space_ints() before modifying
+ * the object returned.
+ */
 std::shared_ptr<ActiveSpaceIntegrals>
 make_active_space_ints(std::shared_ptr<forte::MOSpaceInfo> mo_space_info,
                        std::shared_ptr<ForteIntegrals> ints, const std::string& active_space,
                        const std::vector<std::string>& core_spaces);
 
+/**
+ * @brief Copy-on-write for the objects returned by make_active_space_ints
+ * @return a copy of as_ints if it is shared through the cache of make_active_space_ints,
+ *         otherwise as_ints itself. The object returned is never shared through the cache
+ */
+std::shared_ptr<ActiveSpaceIntegrals>
+detach_active_space_ints(std::shared_ptr<ActiveSpaceIntegrals> as_ints);
+
 } // namespace forte
 
 #endif // _active_space_integrals_
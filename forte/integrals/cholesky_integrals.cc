@@ -26,26 +26,35 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 
 #include "psi4/libpsi4util/process.h"
 #include "psi4/libmints/basisset.h"
 #include "psi4/libmints/wavefunction.h"
 #include "psi4/libmints/integral.h"
 #include "psi4/libmints/matrix.h"
+#include "psi4/libmints/molecule.h"
 #include "psi4/libmints/sieve.h"
 #include "psi4/lib3index/cholesky.h"
 #include "psi4/libpsio/psio.hpp"
 #include "psi4/libqt/qt.h"
 #include "psi4/psifiles.h"
 
+#include "forte-def.h"
 #include "helpers/timer.h"
 #include "helpers/printing.h"
 #include "helpers/memory.h"
+#include "helpers/numa_memory.h"
+#include "helpers/disk_io.h"
 
 #include "base_classes/forte_options.h"
 
+#include "integral_trace.h"
 #include "cholesky_integrals.h"
 
 using namespace ambit;
@@ -103,36 +112,48 @@ ambit::Tensor CholeskyIntegrals::aptei_aa_block(const std::vector<size_t>& p,
                                                 const std::vector<size_t>& q,
                                                 const std::vector<size_t>& r,
                                                 const std::vector<size_t>& s) {
-    ambit::Tensor ReturnTensor =
-        ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
-    ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
-        value = aptei_aa(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_aa_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(0, p, q, r, s, [&]() {
+        ambit::Tensor ReturnTensor =
+            ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
+        ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
+            value = aptei_aa(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+        });
+        return ReturnTensor;
     });
-    return ReturnTensor;
 }
 
 ambit::Tensor CholeskyIntegrals::aptei_ab_block(const std::vector<size_t>& p,
                                                 const std::vector<size_t>& q,
                                                 const std::vector<size_t>& r,
                                                 const std::vector<size_t>& s) {
-    ambit::Tensor ReturnTensor =
-        ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
-    ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
-        value = aptei_ab(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_ab_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(1, p, q, r, s, [&]() {
+        ambit::Tensor ReturnTensor =
+            ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
+        ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
+            value = aptei_ab(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+        });
+        return ReturnTensor;
     });
-    return ReturnTensor;
 }
 
 ambit::Tensor CholeskyIntegrals::aptei_bb_block(const std::vector<size_t>& p,
                                                 const std::vector<size_t>& q,
                                                 const std::vector<size_t>& r,
                                                 const std::vector<size_t>& s) {
-    ambit::Tensor ReturnTensor =
-        ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
-    ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
-        value = aptei_bb(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_bb_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(2, p, q, r, s, [&]() {
+        ambit::Tensor ReturnTensor =
+            ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
+        ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
+            value = aptei_bb(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+        });
+        return ReturnTensor;
     });
-    return ReturnTensor;
 }
 
 double CholeskyIntegrals::three_integral(size_t A, size_t p, size_t q) const {
@@ -144,6 +165,8 @@ double** CholeskyIntegrals::three_integral_pointer() { return ThreeIntegral_->po
 ambit::Tensor CholeskyIntegrals::three_integral_block(const std::vector<size_t>& A,
                                                       const std::vector<size_t>& p,
                                                       const std::vector<size_t>& q) {
+    IntegralTraceScope trace_scope(trace_.get(), "three_integral_block",
+                                   {A.size(), p.size(), q.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {A.size(), p.size(), q.size()});
     ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
@@ -175,7 +198,35 @@ void CholeskyIntegrals::gather_integrals() {
     std::shared_ptr<CholeskyERI> Ch(new CholeskyERI(std::shared_ptr<TwoBodyAOInt>(integral->eri()),
                                                     options_->get_double("INTS_TOLERANCE"), tol_cd,
                                                     psi::Process::environment.get_memory()));
-    if (options_->get_str("DF_INTS_IO") == "LOAD") {
+    // selects the decomposition algorithm
+    auto choleskify = [&]() {
+        if (options_->get_str("CHOLESKY_ALGORITHM") == "THREADED") {
+            threaded_cholesky(tol_cd);
+        } else {
+            Ch->choleskify();
+            nthree_ = Ch->Q();
+            L_ao_ = Ch->L();
+        }
+    };
+
+    // The AO Cholesky vectors do not depend on the orbitals: reuse them if they were already
+    // computed for this basis and geometry, in this job or in a previous one
+    std::string key = cholesky_cache_key(tol_cd);
+    std::string cache_dir = options_->get_str("CHOLESKY_CACHE_DIR");
+    std::string cache_file =
+        cache_dir.empty() ? "" : cache_dir + "/forte.cholesky." + key + ".bin";
+    bool cached = false;
+    if (L_ao_ and (key == cd_key_)) {
+        if (print_) {
+            outfile->Printf("\n  Reusing the Cholesky vectors computed for this geometry");
+        }
+        cached = true;
+    } else if (not cache_file.empty() and read_cholesky_cache(cache_file)) {
+        if (print_) {
+            outfile->Printf("\n  Read the Cholesky vectors from %s", cache_file.c_str());
+        }
+        cached = true;
+    } else if (options_->get_str("DF_INTS_IO") == "LOAD") {
         std::shared_ptr<ERISieve> sieve(
             new ERISieve(primary, options_->get_double("INTS_TOLERANCE")));
         const std::vector<std::pair<int, int>>& function_pairs = sieve->function_pairs();
@@ -218,9 +269,7 @@ void CholeskyIntegrals::gather_integrals() {
             if (print_) {
                 outfile->Printf("\n  Computing CD Integrals");
             }
-            Ch->choleskify();
-            nthree_ = Ch->Q();
-            L_ao_ = Ch->L();
+            choleskify();
             if (print_) {
                 print_timing("cholesky transformation", timer.get());
             }
@@ -229,13 +278,15 @@ void CholeskyIntegrals::gather_integrals() {
         if (print_) {
             outfile->Printf("\n  Computing CD Integrals");
         }
-        Ch->choleskify();
-        nthree_ = Ch->Q();
-        L_ao_ = Ch->L();
+        choleskify();
         if (print_) {
             print_timing("cholesky transformation", timer.get());
         }
     }
+    if (not cached and not cache_file.empty()) {
+        write_cholesky_cache(cache_file);
+    }
+    cd_key_ = key;
 
     // The number of vectors required to do cholesky factorization
     if (print_) {
@@ -252,6 +303,211 @@ void CholeskyIntegrals::gather_integrals() {
     transform_integrals();
 }
 
+std::string CholeskyIntegrals::cholesky_cache_key(double tol_cd) const {
+    // 64-bit FNV-1a hash of everything that determines the AO Cholesky vectors
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    };
+    auto add_double = [&](double x) { add(&x, sizeof(double)); };
+
+    std::shared_ptr<psi::BasisSet> primary = wfn_->basisset();
+    const std::string& name = primary->name();
+    add(name.data(), name.size());
+    const int nbf = primary->nbf();
+    const int nshell = primary->nshell();
+    add(&nbf, sizeof(int));
+    add(&nshell, sizeof(int));
+    for (int M = 0; M < nshell; ++M) {
+        const int am = primary->shell(M).am();
+        const int ncenter = primary->shell(M).ncenter();
+        add(&am, sizeof(int));
+        add(&ncenter, sizeof(int));
+    }
+    std::shared_ptr<psi::Molecule> mol = primary->molecule();
+    for (int A = 0; A < mol->natom(); ++A) {
+        add_double(mol->Z(A));
+        add_double(mol->x(A));
+        add_double(mol->y(A));
+        add_double(mol->z(A));
+    }
+    add_double(tol_cd);
+    add_double(options_->get_double("INTS_TOLERANCE"));
+
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+    return std::string(key);
+}
+
+bool CholeskyIntegrals::read_cholesky_cache(const std::string& filename) {
+    if (not std::ifstream(filename).good()) {
+        return false;
+    }
+    size_t nbf = wfn_->basisset()->nbf();
+    TensorBlockReader reader(filename);
+    const auto& dims = reader.dims();
+    if (dims.size() != 3 or dims[1] != nbf or dims[2] != nbf) {
+        outfile->Printf("\n  The Cholesky cache file %s does not match this basis, ignoring it",
+                        filename.c_str());
+        return false;
+    }
+    nthree_ = dims[0];
+    L_ao_ = std::make_shared<psi::Matrix>("Partial Cholesky", nthree_, nbf * nbf);
+    std::vector<double> block;
+    for (size_t P = 0; P < nthree_; ++P) {
+        reader.read_block(P, block);
+        std::copy(block.begin(), block.end(), L_ao_->pointer()[P]);
+    }
+    return true;
+}
+
+void CholeskyIntegrals::write_cholesky_cache(const std::string& filename) const {
+    size_t nbf = wfn_->basisset()->nbf();
+    TensorBlockWriter writer(filename, {nthree_, nbf, nbf});
+    for (size_t P = 0; P < nthree_; ++P) {
+        writer.write_block(L_ao_->pointer()[P]);
+    }
+    writer.close();
+    if (print_) {
+        outfile->Printf("\n  Saved the Cholesky vectors to %s", filename.c_str());
+    }
+}
+
+void CholeskyIntegrals::threaded_cholesky(double tol_cd) {
+    std::shared_ptr<psi::BasisSet> basis = wfn_->basisset();
+    const size_t nbf = basis->nbf();
+    const size_t nshell = basis->nshell();
+    const size_t npair = nbf * (nbf + 1) / 2;
+    const int nthread = omp_get_max_threads();
+
+    // the function pairs m >= n are stored as m * (m + 1) / 2 + n
+    std::vector<size_t> pair_m(npair), pair_n(npair);
+    for (size_t m = 0, mn = 0; m < nbf; ++m) {
+        for (size_t n = 0; n <= m; ++n, ++mn) {
+            pair_m[mn] = m;
+            pair_n[mn] = n;
+        }
+    }
+    std::vector<std::pair<size_t, size_t>> shell_pairs;
+    for (size_t M = 0; M < nshell; ++M) {
+        for (size_t N = 0; N <= M; ++N) {
+            shell_pairs.emplace_back(M, N);
+        }
+    }
+
+    auto factory = std::make_shared<psi::IntegralFactory>(basis, basis, basis, basis);
+    std::vector<std::shared_ptr<psi::TwoBodyAOInt>> eri;
+    for (int t = 0; t < nthread; ++t) {
+        eri.push_back(std::shared_ptr<psi::TwoBodyAOInt>(factory->eri()));
+    }
+
+    // Loop over the shell pairs (MN|PQ) and store the integrals (mn|pq) with m >= n in col
+    auto compute_column = [&](size_t P, size_t Q, size_t p, size_t q, std::vector<double>& col) {
+        const size_t np = basis->shell(P).nfunction();
+        const size_t nq = basis->shell(Q).nfunction();
+        const size_t ip = p - basis->shell(P).function_index();
+        const size_t iq = q - basis->shell(Q).function_index();
+#pragma omp parallel for num_threads(nthread) schedule(dynamic)
+        for (size_t MN = 0; MN < shell_pairs.size(); ++MN) {
+            const int thread = omp_get_thread_num();
+            const auto [M, N] = shell_pairs[MN];
+            const size_t nm = basis->shell(M).nfunction();
+            const size_t nn = basis->shell(N).nfunction();
+            const size_t om = basis->shell(M).function_index();
+            const size_t on = basis->shell(N).function_index();
+            eri[thread]->compute_shell(M, N, P, Q);
+            const double* buffer = eri[thread]->buffer();
+            for (size_t m = 0; m < nm; ++m) {
+                for (size_t n = 0; n < nn; ++n) {
+                    if (om + m >= on + n) {
+                        const size_t mn = (om + m) * (om + m + 1) / 2 + on + n;
+                        col[mn] = buffer[((m * nn + n) * np + ip) * nq + iq];
+                    }
+                }
+            }
+        }
+    };
+
+    // The diagonal (mn|mn)
+    std::vector<double> diag(npair, 0.0);
+#pragma omp parallel for num_threads(nthread) schedule(dynamic)
+    for (size_t MN = 0; MN < shell_pairs.size(); ++MN) {
+        const int thread = omp_get_thread_num();
+        const auto [M, N] = shell_pairs[MN];
+        const size_t nm = basis->shell(M).nfunction();
+        const size_t nn = basis->shell(N).nfunction();
+        const size_t om = basis->shell(M).function_index();
+        const size_t on = basis->shell(N).function_index();
+        eri[thread]->compute_shell(M, N, M, N);
+        const double* buffer = eri[thread]->buffer();
+        for (size_t m = 0; m < nm; ++m) {
+            for (size_t n = 0; n < nn; ++n) {
+                if (om + m >= on + n) {
+                    const size_t mn = m * nn + n;
+                    diag[(om + m) * (om + m + 1) / 2 + on + n] = buffer[mn * nm * nn + mn];
+                }
+            }
+        }
+    }
+
+    // The pivoted decomposition, the vectors are stored contiguously as L[Q][mn]
+    const size_t max_vec =
+        std::min(npair, psi::Process::environment.get_memory() / (2 * npair * sizeof(double)));
+    std::vector<double> L;
+    std::vector<double> col(npair), Lpiv;
+    size_t nvec = 0;
+    while (nvec < max_vec) {
+        size_t piv = std::max_element(diag.begin(), diag.end()) - diag.begin();
+        const double Dmax = diag[piv];
+        if (Dmax < tol_cd) {
+            break;
+        }
+        const size_t p = pair_m[piv];
+        const size_t q = pair_n[piv];
+        compute_column(basis->function_to_shell(p), basis->function_to_shell(q), p, q, col);
+
+        // col -= sum_k L[k][piv] L[k]
+        if (nvec > 0) {
+            Lpiv.resize(nvec);
+            for (size_t k = 0; k < nvec; ++k) {
+                Lpiv[k] = L[k * npair + piv];
+            }
+            C_DGEMV('T', nvec, npair, -1.0, L.data(), npair, Lpiv.data(), 1, 1.0, col.data(), 1);
+        }
+
+        // the new vector and the update of the diagonal
+        const double scale = 1.0 / std::sqrt(Dmax);
+        L.resize((nvec + 1) * npair);
+        double* Lnew = L.data() + nvec * npair;
+#pragma omp parallel for num_threads(nthread)
+        for (size_t mn = 0; mn < npair; ++mn) {
+            Lnew[mn] = col[mn] * scale;
+            diag[mn] -= Lnew[mn] * Lnew[mn];
+        }
+        diag[piv] = 0.0;
+        nvec++;
+    }
+    if (nvec == max_vec and nvec < npair) {
+        outfile->Printf("\n  Warning: the Cholesky decomposition was stopped after %zu vectors "
+                        "because of the memory limit",
+                        nvec);
+    }
+
+    nthree_ = nvec;
+    L_ao_ = std::make_shared<psi::Matrix>("Partial Cholesky", nthree_, nbf * nbf);
+    double** Lp = L_ao_->pointer();
+#pragma omp parallel for num_threads(nthread)
+    for (size_t P = 0; P < nthree_; ++P) {
+        for (size_t mn = 0; mn < npair; ++mn) {
+            Lp[P][pair_m[mn] * nbf + pair_n[mn]] = Lp[P][pair_n[mn] * nbf + pair_m[mn]] =
+                L[P * npair + mn];
+        }
+    }
+}
+
 void CholeskyIntegrals::transform_integrals() {
     TensorType tensor_type = CoreTensor;
 
@@ -290,6 +546,7 @@ void CholeskyIntegrals::transform_integrals() {
         value = L_ao_->get(i[0], i[1] * nso_ + i[2]);
     });
     std::shared_ptr<psi::Matrix> ThreeInt(new psi::Matrix("Lmo", (nmo_) * (nmo_), nthree_));
+    place_pages(ThreeInt->get_pointer(), 1, nmo_ * nmo_ * nthree_ * sizeof(double));
     ThreeIntegral_ = ThreeInt;
 
     ThreeIntegral("L,p,q") = ThreeIntegral_ao("L,m,n") * Cpq_tensor("m,p") * Cpq_tensor("n,q");
@@ -331,6 +588,11 @@ void CholeskyIntegrals::resort_three(std::shared_ptr<psi::Matrix>& threeint,
     threeint->copy(temp_threeint);
 }
 
+bool CholeskyIntegrals::rotate_two_electron_integrals(const std::vector<double>& U) {
+    rotate_three_index(*ThreeIntegral_, aptei_idx_, U);
+    return true;
+}
+
 void CholeskyIntegrals::set_tei(size_t, size_t, size_t, size_t, double, bool, bool) {
     outfile->Printf("\n If you are using this, you are ruining the advantages of DF/CD");
     throw psi::PSIEXCEPTION("Don't use DF/CD if you use set_tei");
@@ -88,16 +88,27 @@ class CholeskyIntegrals : public Psi4Integrals {
 
     std::shared_ptr<psi::Matrix> ThreeIntegral_;
     size_t nthree_ = 0;
+    /// The key (basis set, geometry, and tolerances) of the Cholesky vectors stored in L_ao_
+    std::string cd_key_;
 
     // ==> Class private functions <==
 
     void resort_three(std::shared_ptr<psi::Matrix>& threeint, std::vector<size_t>& map);
     void transform_integrals();
+    /// @return a hash of the basis set, geometry, and tolerances that determine L_ao_
+    std::string cholesky_cache_key(double tol_cd) const;
+    /// Read L_ao_ from the cache file, return false if it does not exist or does not match
+    bool read_cholesky_cache(const std::string& filename);
+    /// Write L_ao_ to the cache file
+    void write_cholesky_cache(const std::string& filename) const;
+    /// Pivoted Cholesky decomposition of the AO integrals with threaded column and diagonal updates
+    void threaded_cholesky(double tol_cd);
 
     // ==> Class private virtual functions <==
 
     void gather_integrals() override;
     void resort_integrals_after_freezing() override;
+    bool rotate_two_electron_integrals(const std::vector<double>& U) override;
 };
 
 } // namespace forte
@@ -31,17 +31,25 @@
 #include "psi4/psi4-dec.h"
 #include "psi4/psifiles.h"
 #include "psi4/libdpd/dpd.h"
+#include "psi4/libmints/basisset.h"
+#include "psi4/libmints/integral.h"
 #include "psi4/libmints/mintshelper.h"
 #include "psi4/libmints/matrix.h"
+#include "psi4/libmints/twobody.h"
+#include "psi4/libmints/wavefunction.h"
+#include "psi4/libpsi4util/process.h"
+#include "psi4/libqt/qt.h"
 #include "psi4/libpsio/psio.hpp"
 #include "psi4/libtrans/integraltransform.h"
 
+#include "forte-def.h"
 #include "base_classes/mo_space_info.h"
 
 #include "helpers/blockedtensorfactory.h"
 #include "helpers/timer.h"
 #include "helpers/printing.h"
 
+#include "integral_trace.h"
 #include "conventional_integrals.h"
 
 #define ID(x) integral_transform->DPD_ID(x)
@@ -53,8 +61,10 @@ namespace forte {
 ConventionalIntegrals::ConventionalIntegrals(std::shared_ptr<ForteOptions> options,
                                              std::shared_ptr<psi::Wavefunction> ref_wfn,
                                              std::shared_ptr<MOSpaceInfo> mo_space_info,
-                                             IntegralSpinRestriction restricted)
-    : Psi4Integrals(options, ref_wfn, mo_space_info, Conventional, restricted) {
+                                             IntegralSpinRestriction restricted,
+                                             bool incore_transform)
+    : Psi4Integrals(options, ref_wfn, mo_space_info, Conventional, restricted),
+      incore_transform_(incore_transform) {
     initialize();
 }
 
@@ -122,6 +132,8 @@ ambit::Tensor ConventionalIntegrals::aptei_aa_block(const std::vector<size_t>& p
                                                     const std::vector<size_t>& q,
                                                     const std::vector<size_t>& r,
                                                     const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_aa_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
     ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
@@ -134,6 +146,8 @@ ambit::Tensor ConventionalIntegrals::aptei_ab_block(const std::vector<size_t>& p
                                                     const std::vector<size_t>& q,
                                                     const std::vector<size_t>& r,
                                                     const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_ab_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
     ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
@@ -146,6 +160,8 @@ ambit::Tensor ConventionalIntegrals::aptei_bb_block(const std::vector<size_t>& p
                                                     const std::vector<size_t>& q,
                                                     const std::vector<size_t>& r,
                                                     const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_bb_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
     ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
@@ -170,9 +186,6 @@ void ConventionalIntegrals::gather_integrals() {
         outfile->Printf("\n  Computing Conventional Integrals");
     }
     local_timer timer;
-    MintsHelper mints = MintsHelper(wfn_->basisset());
-    mints.integrals();
-    auto integral_transform = transform_integrals();
 
     if (print_ > 0) {
         outfile->Printf("\n  Reading the two-electron integrals from disk");
@@ -188,32 +201,14 @@ void ConventionalIntegrals::gather_integrals() {
     if (spin_restriction_ == IntegralSpinRestriction::Restricted) {
         std::vector<double> two_electron_integrals(num_tei_, 0.0);
 
-        // Read the integrals
-        dpdbuf4 K;
-        std::shared_ptr<PSIO> psio(_default_psio_lib_);
-        psio->open(PSIF_LIBTRANS_DPD, PSIO_OPEN_OLD);
-        // To only process the permutationally unique integrals, change the
-        // ID("[A,A]") to ID("[A>=A]+")
-        global_dpd_->buf4_init(&K, PSIF_LIBTRANS_DPD, 0, ID("[A,A]"), ID("[A,A]"), ID("[A>=A]+"),
-                               ID("[A>=A]+"), 0, "MO Ints (AA|AA)");
-        for (int h = 0; h < nirrep_; ++h) {
-            global_dpd_->buf4_mat_irrep_init(&K, h);
-            global_dpd_->buf4_mat_irrep_rd(&K, h);
-            for (int pq = 0; pq < K.params->rowtot[h]; ++pq) {
-                int p = K.params->roworb[h][pq][0];
-                int q = K.params->roworb[h][pq][1];
-                for (int rs = 0; rs < K.params->coltot[h]; ++rs) {
-                    int r = K.params->colorb[h][rs][0];
-                    int s = K.params->colorb[h][rs][1];
-                    two_electron_integrals[INDEX4(p, q, r, s)] = K.matrix[h][pq][rs];
-                }
-            }
-            global_dpd_->buf4_mat_irrep_close(&K, h);
+        if (incore_transform_) {
+            transform_integrals_incore(two_electron_integrals);
+        } else {
+            read_libtrans_integrals(two_electron_integrals);
         }
-        global_dpd_->buf4_close(&K);
-        psio->close(PSIF_LIBTRANS_DPD, PSIO_OPEN_OLD);
 
         // Store the integrals
+#pragma omp parallel for
         for (size_t p = 0; p < nmo_; ++p) {
             for (size_t q = 0; q < nmo_; ++q) {
                 for (size_t r = 0; r < nmo_; ++r) {
@@ -239,6 +234,212 @@ void ConventionalIntegrals::gather_integrals() {
     }
 }
 
+void ConventionalIntegrals::read_libtrans_integrals(std::vector<double>& tei) {
+    MintsHelper mints = MintsHelper(wfn_->basisset());
+    mints.integrals();
+    auto integral_transform = transform_integrals();
+
+    // Read the integrals
+    dpdbuf4 K;
+    std::shared_ptr<PSIO> psio(_default_psio_lib_);
+    psio->open(PSIF_LIBTRANS_DPD, PSIO_OPEN_OLD);
+    // To only process the permutationally unique integrals, change the
+    // ID("[A,A]") to ID("[A>=A]+")
+    global_dpd_->buf4_init(&K, PSIF_LIBTRANS_DPD, 0, ID("[A,A]"), ID("[A,A]"), ID("[A>=A]+"),
+                           ID("[A>=A]+"), 0, "MO Ints (AA|AA)");
+    for (int h = 0; h < nirrep_; ++h) {
+        global_dpd_->buf4_mat_irrep_init(&K, h);
+        global_dpd_->buf4_mat_irrep_rd(&K, h);
+        for (int pq = 0; pq < K.params->rowtot[h]; ++pq) {
+            int p = K.params->roworb[h][pq][0];
+            int q = K.params->roworb[h][pq][1];
+            for (int rs = 0; rs < K.params->coltot[h]; ++rs) {
+                int r = K.params->colorb[h][rs][0];
+                int s = K.params->colorb[h][rs][1];
+                tei[INDEX4(p, q, r, s)] = K.matrix[h][pq][rs];
+            }
+        }
+        global_dpd_->buf4_mat_irrep_close(&K, h);
+    }
+    global_dpd_->buf4_close(&K);
+    psio->close(PSIF_LIBTRANS_DPD, PSIO_OPEN_OLD);
+}
+
+void ConventionalIntegrals::transform_integrals_incore(std::vector<double>& tei) {
+    local_timer timer;
+    auto basis = wfn_->basisset();
+    const size_t nao = basis->nbf();
+    const size_t nshell = basis->nshell();
+    const size_t nmo = nmo_;
+    const int nthread = omp_get_max_threads();
+
+    // the MO coefficients in the AO basis (Pitzer order)
+    auto aotoso = wfn_->aotoso();
+    auto Ca_ao = std::make_shared<psi::Matrix>("Ca_ao", nao, nmo);
+    std::vector<int> mo_sym(nmo);
+    std::vector<size_t> mo_offset(nirrep_ + 1, 0);
+    for (int h = 0, index = 0; h < nirrep_; ++h) {
+        int nso = nsopi_[h];
+        mo_offset[h + 1] = mo_offset[h] + nmopi_[h];
+        for (int i = 0; i < nmopi_[h]; ++i, ++index) {
+            C_DGEMV('N', nao, nso, 1.0, aotoso->pointer(h)[0], nso, &Ca_->pointer(h)[0][i],
+                    nmopi_[h], 0.0, &Ca_ao->pointer()[0][index], nmo);
+            mo_sym[index] = h;
+        }
+    }
+    double* C = Ca_ao->pointer()[0];
+
+    // the shell pairs M >= N
+    std::vector<std::pair<size_t, size_t>> shell_pairs;
+    size_t max_pair_size = 0;
+    for (size_t M = 0; M < nshell; ++M) {
+        for (size_t N = 0; N <= M; ++N) {
+            shell_pairs.emplace_back(M, N);
+            size_t pair_size = basis->shell(M).nfunction() * basis->shell(N).nfunction();
+            max_pair_size = std::max(max_pair_size, pair_size);
+        }
+    }
+
+    // ERI objects, one per thread
+    auto factory = std::make_shared<psi::IntegralFactory>(basis, basis, basis, basis);
+    std::vector<std::shared_ptr<psi::TwoBodyAOInt>> eri;
+    for (int t = 0; t < nthread; ++t) {
+        eri.push_back(std::shared_ptr<psi::TwoBodyAOInt>(factory->eri()));
+    }
+
+    // batch the MO pairs r >= s so that the half-transformed integrals (mn|rs) fit in memory
+    const size_t npairs = nmo * (nmo + 1) / 2;
+    const size_t nao2 = nao * nao;
+    const size_t thread_mem = max_pair_size * nao * (nao + nmo) + nmo * nmo + nao * nmo;
+    const size_t used_mem = (3 * num_aptei_ + num_tei_ + nthread * thread_mem) * sizeof(double);
+    const size_t total_mem = psi::Process::environment.get_memory();
+    size_t batch_size = npairs;
+    if (used_mem + npairs * nao2 * sizeof(double) > total_mem) {
+        size_t avail = total_mem > used_mem ? total_mem - used_mem : 0;
+        batch_size = std::max(size_t(1), avail / (nao2 * sizeof(double)));
+    }
+    const size_t nbatch = (npairs + batch_size - 1) / batch_size;
+    if (print_ > 0) {
+        outfile->Printf("\n  In-core integral transformation: %zu AO, %zu MO, %zu batch(es)", nao,
+                        nmo, nbatch);
+    }
+
+    std::vector<std::pair<size_t, size_t>> mo_pairs;
+    for (size_t r = 0; r < nmo; ++r) {
+        for (size_t s = 0; s <= r; ++s) {
+            mo_pairs.emplace_back(r, s);
+        }
+    }
+
+    std::vector<double> half;
+    for (size_t batch = 0; batch < nbatch; ++batch) {
+        const size_t rs_begin = batch * batch_size;
+        const size_t rs_end = std::min(npairs, rs_begin + batch_size);
+        half.assign((rs_end - rs_begin) * nao2, 0.0);
+
+        // first half: (mn|ls) -> (mn|rs) for the AO pairs of one shell pair at a time
+#pragma omp parallel num_threads(nthread)
+        {
+            const int thread = omp_get_thread_num();
+            std::vector<double> G(max_pair_size * nao2);
+            std::vector<double> GC(max_pair_size * nao * nmo);
+            std::vector<double> X(nmo * nmo);
+
+#pragma omp for schedule(dynamic)
+            for (size_t MN = 0; MN < shell_pairs.size(); ++MN) {
+                const auto [M, N] = shell_pairs[MN];
+                const size_t nm = basis->shell(M).nfunction();
+                const size_t nn = basis->shell(N).nfunction();
+                const size_t om = basis->shell(M).function_index();
+                const size_t on = basis->shell(N).function_index();
+
+                // G[mn][l][s] = (mn|ls)
+                for (size_t L = 0; L < nshell; ++L) {
+                    const size_t nl = basis->shell(L).nfunction();
+                    const size_t ol = basis->shell(L).function_index();
+                    for (size_t S = 0; S <= L; ++S) {
+                        const size_t ns = basis->shell(S).nfunction();
+                        const size_t os = basis->shell(S).function_index();
+                        eri[thread]->compute_shell(M, N, L, S);
+                        const double* buffer = eri[thread]->buffer();
+                        for (size_t m = 0; m < nm; ++m) {
+                            for (size_t n = 0; n < nn; ++n) {
+                                double* Gmn = G.data() + (m * nn + n) * nao2;
+                                for (size_t l = 0; l < nl; ++l) {
+                                    for (size_t k = 0; k < ns; ++k) {
+                                        Gmn[(l + ol) * nao + k + os] =
+                                            Gmn[(k + os) * nao + l + ol] = *buffer++;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // GC[mn][l][s] = sum_k G[mn][l][k] C[k][s], then X = C^T GC[mn]
+                C_DGEMM('N', 'N', nm * nn * nao, nmo, nao, 1.0, G.data(), nao, C, nmo, 0.0,
+                        GC.data(), nmo);
+                for (size_t m = 0; m < nm; ++m) {
+                    for (size_t n = 0; n < nn; ++n) {
+                        if (M == N and n > m)
+                            continue;
+                        C_DGEMM('T', 'N', nmo, nmo, nao, 1.0, C, nmo,
+                                GC.data() + (m * nn + n) * nao * nmo, nmo, 0.0, X.data(), nmo);
+                        const size_t mu = m + om;
+                        const size_t nu = n + on;
+                        for (size_t rs = rs_begin; rs < rs_end; ++rs) {
+                            const auto [r, s] = mo_pairs[rs];
+                            double* H = half.data() + (rs - rs_begin) * nao2;
+                            H[mu * nao + nu] = H[nu * nao + mu] = X[r * nmo + s];
+                        }
+                    }
+                }
+            }
+        }
+
+        // second half: (mn|rs) -> (pq|rs), only for the blocks of symmetry h(p) x h(q) = h(rs)
+#pragma omp parallel num_threads(nthread)
+        {
+            std::vector<double> T(nao * nmo);
+            std::vector<double> Y(nmo * nmo);
+
+#pragma omp for schedule(dynamic)
+            for (size_t rs = rs_begin; rs < rs_end; ++rs) {
+                const auto [r, s] = mo_pairs[rs];
+                const int h_rs = mo_sym[r] ^ mo_sym[s];
+                double* H = half.data() + (rs - rs_begin) * nao2;
+                C_DGEMM('N', 'N', nao, nmo, nao, 1.0, H, nao, C, nmo, 0.0, T.data(), nmo);
+                for (int hp = 0; hp < nirrep_; ++hp) {
+                    const int hq = hp ^ h_rs;
+                    if (hq > hp)
+                        continue;
+                    const size_t np = nmopi_[hp];
+                    const size_t nq = nmopi_[hq];
+                    if (np == 0 or nq == 0)
+                        continue;
+                    const size_t op = mo_offset[hp];
+                    const size_t oq = mo_offset[hq];
+                    C_DGEMM('T', 'N', np, nq, nao, 1.0, C + op, nmo, T.data() + oq, nmo, 0.0,
+                            Y.data(), nq);
+                    // each unique (pq|rs) is written by the pair with the larger index
+                    for (size_t p = 0; p < np; ++p) {
+                        for (size_t q = 0; q < nq; ++q) {
+                            const size_t pp = p + op;
+                            const size_t qq = q + oq;
+                            if (qq > pp or pp * (pp + 1) / 2 + qq < rs)
+                                continue;
+                            tei[INDEX4(pp, qq, r, s)] = Y[p * nq + q];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (print_ > 0) {
+        outfile->Printf("\n  In-core integral transformation done. %8.8f s", timer.get());
+    }
+}
+
 void ConventionalIntegrals::resort_integrals_after_freezing() {
     if (print_ > 0) {
         outfile->Printf("\n  Resorting integrals after freezing core.");
@@ -43,14 +43,17 @@ namespace forte {
  * integrals.
  *
  * This class assumes the two-electron integrals can be stored in memory.
+ * The AO -> MO transformation is done either by Psi4's disk-based IntegralTransform or, for
+ * INT_TYPE = INCORE, by a threaded in-core transformation (transform_integrals_incore).
  */
 class ConventionalIntegrals : public Psi4Integrals {
   public:
     /// Contructor of ConventionalIntegrals
+    /// @param incore_transform if true, use the in-core threaded transformation
     ConventionalIntegrals(std::shared_ptr<ForteOptions> options,
                           std::shared_ptr<psi::Wavefunction> ref_wfn,
                           std::shared_ptr<MOSpaceInfo> mo_space_info,
-                          IntegralSpinRestriction restricted);
+                          IntegralSpinRestriction restricted, bool incore_transform = false);
 
     void initialize() override;
 
@@ -76,10 +79,25 @@ class ConventionalIntegrals : public Psi4Integrals {
   private:
     // ==> Class data <==
 
+    /// Transform the integrals in core instead of using psi::IntegralTransform?
+    bool incore_transform_ = false;
+
     // ==> Class private functions <==
 
     /// Transform the integrals
     std::shared_ptr<psi::IntegralTransform> transform_integrals();
+    /**
+     * @brief Transform the AO two-electron integrals to the MO basis in core
+     *
+     * The AO integrals (mn|ls) are computed for one shell pair MN at a time and half-transformed
+     * to (mn|rs) with DGEMMs, for a batch of MO pairs r >= s that fits in memory. The second
+     * half-transformation is done for each pair rs with DGEMMs over the blocks of orbitals p, q
+     * of irreps such that (pq|rs) is totally symmetric. Both steps are threaded.
+     * @param tei the integrals (pq|rs) stored with the INDEX4 compound index
+     */
+    void transform_integrals_incore(std::vector<double>& tei);
+    /// Transform the integrals with psi::IntegralTransform and read them from the DPD file
+    void read_libtrans_integrals(std::vector<double>& tei);
     void resort_four(std::vector<double>& tei, std::vector<size_t>& map);
 
     // ==> Class private virtual functions <==
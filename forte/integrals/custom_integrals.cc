@@ -42,6 +42,7 @@
 #include "helpers/timer.h"
 #include "helpers/printing.h"
 
+#include "integral_trace.h"
 #include "custom_integrals.h"
 
 #define IOFFINDEX(i) (i * (i + 1) / 2)
@@ -97,6 +98,8 @@ ambit::Tensor CustomIntegrals::aptei_aa_block(const std::vector<size_t>& p,
                                               const std::vector<size_t>& q,
                                               const std::vector<size_t>& r,
                                               const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_aa_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
     ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
@@ -109,6 +112,8 @@ ambit::Tensor CustomIntegrals::aptei_ab_block(const std::vector<size_t>& p,
                                               const std::vector<size_t>& q,
                                               const std::vector<size_t>& r,
                                               const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_ab_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
     ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
@@ -121,6 +126,8 @@ ambit::Tensor CustomIntegrals::aptei_bb_block(const std::vector<size_t>& p,
                                               const std::vector<size_t>& q,
                                               const std::vector<size_t>& r,
                                               const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_bb_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
     ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
@@ -50,7 +50,9 @@
 #include "helpers/printing.h"
 #include "helpers/timer.h"
 #include "helpers/memory.h"
+#include "helpers/numa_memory.h"
 
+#include "integral_trace.h"
 #include "df_integrals.h"
 
 using namespace ambit;
@@ -117,36 +119,48 @@ ambit::Tensor DFIntegrals::aptei_aa_block(const std::vector<size_t>& p,
                                           const std::vector<size_t>& q,
                                           const std::vector<size_t>& r,
                                           const std::vector<size_t>& s) {
-    ambit::Tensor ReturnTensor =
-        ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
-    ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
-        value = aptei_aa(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_aa_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(0, p, q, r, s, [&]() {
+        ambit::Tensor ReturnTensor =
+            ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
+        ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
+            value = aptei_aa(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+        });
+        return ReturnTensor;
     });
-    return ReturnTensor;
 }
 
 ambit::Tensor DFIntegrals::aptei_ab_block(const std::vector<size_t>& p,
                                           const std::vector<size_t>& q,
                                           const std::vector<size_t>& r,
                                           const std::vector<size_t>& s) {
-    ambit::Tensor ReturnTensor =
-        ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
-    ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
-        value = aptei_ab(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_ab_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(1, p, q, r, s, [&]() {
+        ambit::Tensor ReturnTensor =
+            ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
+        ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
+            value = aptei_ab(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+        });
+        return ReturnTensor;
     });
-    return ReturnTensor;
 }
 
 ambit::Tensor DFIntegrals::aptei_bb_block(const std::vector<size_t>& p,
                                           const std::vector<size_t>& q,
                                           const std::vector<size_t>& r,
                                           const std::vector<size_t>& s) {
-    ambit::Tensor ReturnTensor =
-        ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
-    ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
-        value = aptei_bb(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_bb_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(2, p, q, r, s, [&]() {
+        ambit::Tensor ReturnTensor =
+            ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
+        ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
+            value = aptei_bb(p[i[0]], q[i[1]], r[i[2]], s[i[3]]);
+        });
+        return ReturnTensor;
     });
-    return ReturnTensor;
 }
 
 double DFIntegrals::three_integral(size_t A, size_t p, size_t q) {
@@ -158,6 +172,8 @@ double** DFIntegrals::three_integral_pointer() { return ThreeIntegral_->pointer(
 ambit::Tensor DFIntegrals::three_integral_block(const std::vector<size_t>& A,
                                                 const std::vector<size_t>& p,
                                                 const std::vector<size_t>& q) {
+    IntegralTraceScope trace_scope(trace_.get(), "three_integral_block",
+                                   {A.size(), p.size(), q.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {A.size(), p.size(), q.size()});
     ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
@@ -268,6 +284,8 @@ void DFIntegrals::gather_integrals() {
 
     // Store as transpose for now
     ThreeIntegral_ = Bpq->transpose()->clone();
+    place_pages(ThreeIntegral_->get_pointer(), 1,
+                ThreeIntegral_->rowdim() * ThreeIntegral_->coldim() * sizeof(double));
 }
 
 void DFIntegrals::resort_three(std::shared_ptr<psi::Matrix>& threeint, std::vector<size_t>& map) {
@@ -291,6 +309,8 @@ void DFIntegrals::resort_three(std::shared_ptr<psi::Matrix>& threeint, std::vect
     // This copies the resorted integrals and the data is changed to the sorted
     // matrix
     threeint->copy(temp_threeint);
+    place_pages(threeint->get_pointer(), 1,
+                threeint->rowdim() * threeint->coldim() * sizeof(double));
 }
 
 void DFIntegrals::resort_integrals_after_freezing() {
@@ -306,6 +326,11 @@ void DFIntegrals::resort_integrals_after_freezing() {
     }
 }
 
+bool DFIntegrals::rotate_two_electron_integrals(const std::vector<double>& U) {
+    rotate_three_index(*ThreeIntegral_, aptei_idx_, U);
+    return true;
+}
+
 size_t DFIntegrals::nthree() const { return nthree_; }
 
 } // namespace forte
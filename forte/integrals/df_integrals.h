@@ -90,6 +90,7 @@ class DFIntegrals : public Psi4Integrals {
 
     void gather_integrals() override;
     void resort_integrals_after_freezing() override;
+    bool rotate_two_electron_integrals(const std::vector<double>& U) override;
 };
 
 } // namespace forte
@@ -26,16 +26,24 @@
  * @END LICENSE
  */
 
+#include <cerrno>
 #include <cmath>
+#include <cstring>
 #include <numeric>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "psi4/libpsi4util/process.h"
 #include "psi4/libmints/basisset.h"
 #include "psi4/libmints/matrix.h"
 #include "psi4/libmints/vector.h"
 #include "psi4/libmints/wavefunction.h"
 #include "psi4/libqt/qt.h"
+#include "psi4/libpsio/psio.hpp"
 
+#include "base_classes/forte_options.h"
 #include "base_classes/mo_space_info.h"
 
 #ifdef HAVE_GA
@@ -48,6 +56,7 @@
 #include "helpers/helpers.h"
 #include "helpers/printing.h"
 #include "helpers/timer.h"
+#include "integral_trace.h"
 #include "diskdf_integrals.h"
 
 using namespace ambit;
@@ -60,9 +69,17 @@ DISKDFIntegrals::DISKDFIntegrals(std::shared_ptr<ForteOptions> options,
                                  std::shared_ptr<MOSpaceInfo> mo_space_info,
                                  IntegralSpinRestriction restricted)
     : Psi4Integrals(options, ref_wfn, mo_space_info, DiskDF, restricted) {
+    use_mmap_ = options->get_bool("DISKDF_MMAP");
     initialize();
 }
 
+DISKDFIntegrals::~DISKDFIntegrals() {
+    if (prefetch_.valid()) {
+        prefetch_.wait();
+    }
+    release_mmap();
+}
+
 void DISKDFIntegrals::initialize() {
     print_info();
 
@@ -79,6 +96,13 @@ void DISKDFIntegrals::initialize() {
 }
 
 double DISKDFIntegrals::aptei_aa(size_t p, size_t q, size_t r, size_t s) {
+    if (use_mmap_) {
+        const double* B = mapped_B();
+        return C_DDOT(nthree_, B + (p * aptei_idx_ + r) * nthree_, 1,
+                      B + (q * aptei_idx_ + s) * nthree_, 1) -
+               C_DDOT(nthree_, B + (p * aptei_idx_ + s) * nthree_, 1,
+                      B + (q * aptei_idx_ + r) * nthree_, 1);
+    }
     size_t pn, qn, rn, sn;
 
     if (frzcpi_.sum() > 0 && ncmo_ == aptei_idx_) {
@@ -105,6 +129,7 @@ double DISKDFIntegrals::aptei_aa(size_t p, size_t q, size_t r, size_t s) {
     std::shared_ptr<psi::Matrix> B1(new psi::Matrix(1, nthree_));
     std::shared_ptr<psi::Matrix> B2(new psi::Matrix(1, nthree_));
 
+    std::lock_guard<std::mutex> lock(df_mutex_);
     df_->fill_tensor("B", B1, A_range, p_range, r_range);
     df_->fill_tensor("B", B2, A_range, q_range, s_range);
 
@@ -122,6 +147,11 @@ double DISKDFIntegrals::aptei_aa(size_t p, size_t q, size_t r, size_t s) {
 }
 
 double DISKDFIntegrals::aptei_ab(size_t p, size_t q, size_t r, size_t s) {
+    if (use_mmap_) {
+        const double* B = mapped_B();
+        return C_DDOT(nthree_, B + (p * aptei_idx_ + r) * nthree_, 1,
+                      B + (q * aptei_idx_ + s) * nthree_, 1);
+    }
     size_t pn, qn, rn, sn;
     if (frzcpi_.sum() > 0 && ncmo_ == aptei_idx_) {
         pn = cmotomo_[p];
@@ -144,6 +174,7 @@ double DISKDFIntegrals::aptei_ab(size_t p, size_t q, size_t r, size_t s) {
     std::shared_ptr<psi::Matrix> B1(new psi::Matrix(1, nthree_));
     std::shared_ptr<psi::Matrix> B2(new psi::Matrix(1, nthree_));
 
+    std::lock_guard<std::mutex> lock(df_mutex_);
     df_->fill_tensor("B", B1, A_range, p_range, r_range);
     df_->fill_tensor("B", B2, A_range, q_range, s_range);
 
@@ -153,6 +184,9 @@ double DISKDFIntegrals::aptei_ab(size_t p, size_t q, size_t r, size_t s) {
 }
 
 double DISKDFIntegrals::aptei_bb(size_t p, size_t q, size_t r, size_t s) {
+    if (use_mmap_) {
+        return aptei_aa(p, q, r, s);
+    }
     size_t pn, qn, rn, sn;
 
     if (frzcpi_.sum() > 0 && ncmo_ == aptei_idx_) {
@@ -178,6 +212,7 @@ double DISKDFIntegrals::aptei_bb(size_t p, size_t q, size_t r, size_t s) {
     std::shared_ptr<psi::Matrix> B1(new psi::Matrix(1, nthree_));
     std::shared_ptr<psi::Matrix> B2(new psi::Matrix(1, nthree_));
 
+    std::lock_guard<std::mutex> lock(df_mutex_);
     df_->fill_tensor("B", B1, A_range, p_range, r_range);
     df_->fill_tensor("B", B2, A_range, q_range, s_range);
 
@@ -198,99 +233,159 @@ ambit::Tensor DISKDFIntegrals::aptei_aa_block(const std::vector<size_t>& p,
                                               const std::vector<size_t>& q,
                                               const std::vector<size_t>& r,
                                               const std::vector<size_t>& s) {
-    auto p_size = p.size();
-    auto q_size = q.size();
-    auto r_size = r.size();
-    auto s_size = s.size();
-
-    std::vector<size_t> Avec(nthree_);
-    std::iota(Avec.begin(), Avec.end(), 0);
-
-    auto Qpr = three_integral_block(Avec, p, r);
-    auto Qqs = three_integral_block(Avec, q, s);
-
-    auto out = ambit::Tensor::build(tensor_type_, "out_aa", {p_size, q_size, r_size, s_size});
-    out("p,q,r,s") = Qpr("A,p,r") * Qqs("A,q,s");
-
-    /// If p != q != r !=s need to form the Exchange part separately
-    if (r != s) {
-        auto Qps_K = ambit::Tensor::build(tensor_type_, "Qps_K", {nthree_, p_size, s_size});
-        auto Qqr_K = ambit::Tensor::build(tensor_type_, "Qqr_K", {nthree_, q_size, r_size});
-        Qps_K = three_integral_block(Avec, p, s);
-        Qqr_K = three_integral_block(Avec, q, r);
-        out("p,q,r,s") -= Qps_K("A,p,s") * Qqr_K("A,q,r");
-    } else {
-        out("p,q,r,s") -= Qpr("A,p,s") * Qqs("A,q,r");
-    }
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_aa_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(0, p, q, r, s, [&]() {
+        auto p_size = p.size();
+        auto q_size = q.size();
+        auto r_size = r.size();
+        auto s_size = s.size();
+
+        std::vector<size_t> Avec(nthree_);
+        std::iota(Avec.begin(), Avec.end(), 0);
+
+        auto Qpr = three_integral_block(Avec, p, r);
+        auto Qqs = three_integral_block(Avec, q, s);
+
+        auto out = ambit::Tensor::build(tensor_type_, "out_aa", {p_size, q_size, r_size, s_size});
+        out("p,q,r,s") = Qpr("A,p,r") * Qqs("A,q,s");
+
+        /// If p != q != r !=s need to form the Exchange part separately
+        if (r != s) {
+            auto Qps_K = ambit::Tensor::build(tensor_type_, "Qps_K", {nthree_, p_size, s_size});
+            auto Qqr_K = ambit::Tensor::build(tensor_type_, "Qqr_K", {nthree_, q_size, r_size});
+            Qps_K = three_integral_block(Avec, p, s);
+            Qqr_K = three_integral_block(Avec, q, r);
+            out("p,q,r,s") -= Qps_K("A,p,s") * Qqr_K("A,q,r");
+        } else {
+            out("p,q,r,s") -= Qpr("A,p,s") * Qqs("A,q,r");
+        }
 
-    return out;
+        return out;
+    });
 }
 
 ambit::Tensor DISKDFIntegrals::aptei_ab_block(const std::vector<size_t>& p,
                                               const std::vector<size_t>& q,
                                               const std::vector<size_t>& r,
                                               const std::vector<size_t>& s) {
-    auto p_size = p.size();
-    auto q_size = q.size();
-    auto r_size = r.size();
-    auto s_size = s.size();
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_ab_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(1, p, q, r, s, [&]() {
+        auto p_size = p.size();
+        auto q_size = q.size();
+        auto r_size = r.size();
+        auto s_size = s.size();
+
+        std::vector<size_t> Avec(nthree_);
+        std::iota(Avec.begin(), Avec.end(), 0);
+
+        auto out = ambit::Tensor::build(tensor_type_, "out_ab", {p_size, q_size, r_size, s_size});
+
+        if (p == q and r == s) {
+            auto Q = three_integral_block(Avec, p, r);
+            out("p,q,r,s") = Q("A,p,r") * Q("A,q,s");
+            return out;
+        }
 
-    std::vector<size_t> Avec(nthree_);
-    std::iota(Avec.begin(), Avec.end(), 0);
+        auto Qpr = three_integral_block(Avec, p, r);
+        auto Qqs = three_integral_block(Avec, q, s);
 
-    auto out = ambit::Tensor::build(tensor_type_, "out_ab", {p_size, q_size, r_size, s_size});
+        out("p,q,r,s") = Qpr("A,p,r") * Qqs("A,q,s");
 
-    if (p == q and r == s) {
-        auto Q = three_integral_block(Avec, p, r);
-        out("p,q,r,s") = Q("A,p,r") * Q("A,q,s");
         return out;
-    }
-
-    auto Qpr = three_integral_block(Avec, p, r);
-    auto Qqs = three_integral_block(Avec, q, s);
-
-    out("p,q,r,s") = Qpr("A,p,r") * Qqs("A,q,s");
-
-    return out;
+    });
 }
 
 ambit::Tensor DISKDFIntegrals::aptei_bb_block(const std::vector<size_t>& p,
                                               const std::vector<size_t>& q,
                                               const std::vector<size_t>& r,
                                               const std::vector<size_t>& s) {
-    auto p_size = p.size();
-    auto q_size = q.size();
-    auto r_size = r.size();
-    auto s_size = s.size();
-
-    std::vector<size_t> Avec(nthree_);
-    std::iota(Avec.begin(), Avec.end(), 0);
-
-    auto Qpr = three_integral_block(Avec, p, r);
-    auto Qqs = three_integral_block(Avec, q, s);
-
-    auto out = ambit::Tensor::build(tensor_type_, "out_bb", {p_size, q_size, r_size, s_size});
-    out("p,q,r,s") = Qpr("A,p,r") * Qqs("A,q,s");
-
-    /// If p != q != r !=s need to form the Exchane part separately
-    if (r != s) {
-        auto Qps_K = ambit::Tensor::build(tensor_type_, "Qps_K", {nthree_, p_size, s_size});
-        auto Qqr_K = ambit::Tensor::build(tensor_type_, "Qqr_K", {nthree_, q_size, r_size});
-        Qps_K = three_integral_block(Avec, p, s);
-        Qqr_K = three_integral_block(Avec, q, r);
-        out("p,q,r,s") -= Qps_K("A,p,s") * Qqr_K("A,q,r");
-    } else {
-        out("p,q,r,s") -= Qpr("A,p,s") * Qqs("A,q,r");
-    }
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_bb_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(2, p, q, r, s, [&]() {
+        auto p_size = p.size();
+        auto q_size = q.size();
+        auto r_size = r.size();
+        auto s_size = s.size();
+
+        std::vector<size_t> Avec(nthree_);
+        std::iota(Avec.begin(), Avec.end(), 0);
+
+        auto Qpr = three_integral_block(Avec, p, r);
+        auto Qqs = three_integral_block(Avec, q, s);
+
+        auto out = ambit::Tensor::build(tensor_type_, "out_bb", {p_size, q_size, r_size, s_size});
+        out("p,q,r,s") = Qpr("A,p,r") * Qqs("A,q,s");
+
+        /// If p != q != r !=s need to form the Exchane part separately
+        if (r != s) {
+            auto Qps_K = ambit::Tensor::build(tensor_type_, "Qps_K", {nthree_, p_size, s_size});
+            auto Qqr_K = ambit::Tensor::build(tensor_type_, "Qqr_K", {nthree_, q_size, r_size});
+            Qps_K = three_integral_block(Avec, p, s);
+            Qqr_K = three_integral_block(Avec, q, r);
+            out("p,q,r,s") -= Qps_K("A,p,s") * Qqr_K("A,q,r");
+        } else {
+            out("p,q,r,s") -= Qpr("A,p,s") * Qqs("A,q,r");
+        }
 
-    return out;
+        return out;
+    });
 }
 
-double** DISKDFIntegrals::three_integral_pointer() { return (ThreeIntegral_->pointer()); }
+double** DISKDFIntegrals::three_integral_pointer() {
+    if (use_mmap_) {
+        mapped_B();
+        return mmap_rows_.data();
+    }
+    return (ThreeIntegral_->pointer());
+}
 
 ambit::Tensor DISKDFIntegrals::three_integral_block(const std::vector<size_t>& Q_vec,
                                                     const std::vector<size_t>& p_vec,
                                                     const std::vector<size_t>& q_vec) {
+    IntegralTraceScope trace_scope(trace_.get(), "three_integral_block",
+                                   {Q_vec.size(), p_vec.size(), q_vec.size()});
+    if (use_mmap_) {
+        return mapped_three_integral_block(Q_vec, p_vec, q_vec);
+    }
+    if (prefetch_.valid() and prefetch_indices_[0] == Q_vec and prefetch_indices_[1] == p_vec and
+        prefetch_indices_[2] == q_vec) {
+        if (trace_)
+            trace_->record_cache("diskdf_prefetch", true);
+        auto out = prefetch_.get();
+        prefetch_next_block();
+        return out;
+    }
+    if (trace_ and prefetch_.valid())
+        trace_->record_cache("diskdf_prefetch", false);
+    return read_three_integral_block(Q_vec, p_vec, q_vec);
+}
+
+void DISKDFIntegrals::set_three_integral_block_sequence(
+    const std::vector<std::array<std::vector<size_t>, 3>>& blocks) {
+    if (prefetch_.valid()) {
+        prefetch_.wait();
+        prefetch_ = std::future<ambit::Tensor>();
+    }
+    block_sequence_.assign(blocks.begin(), blocks.end());
+    prefetch_next_block();
+}
+
+void DISKDFIntegrals::prefetch_next_block() {
+    if (block_sequence_.empty())
+        return;
+    prefetch_indices_ = std::move(block_sequence_.front());
+    block_sequence_.pop_front();
+    prefetch_ = std::async(std::launch::async, [this]() {
+        return read_three_integral_block(prefetch_indices_[0], prefetch_indices_[1],
+                                         prefetch_indices_[2]);
+    });
+}
+
+ambit::Tensor DISKDFIntegrals::read_three_integral_block(const std::vector<size_t>& Q_vec,
+                                                         const std::vector<size_t>& p_vec,
+                                                         const std::vector<size_t>& q_vec) {
     std::string func_name = "DISKDFIntegrals::three_integral_block: ";
 
     auto Qsize = Q_vec.size();
@@ -351,6 +446,7 @@ ambit::Tensor DISKDFIntegrals::three_integral_block(const std::vector<size_t>& Q
 
     auto& out_data = out.data();
 
+    std::lock_guard<std::mutex> lock(df_mutex_);
     if (p_contiguous and q_contiguous) {
         std::vector<size_t> p_range{cmotomo[p_vec[0]], cmotomo[p_vec[0]] + psize};
         std::vector<size_t> q_range{cmotomo[q_vec[0]], cmotomo[q_vec[0]] + qsize};
@@ -456,7 +552,131 @@ void DISKDFIntegrals::set_tei(size_t, size_t, size_t, size_t, double, bool, bool
     throw psi::PSIEXCEPTION("DISKDFIntegrals::set_tei : DISKDF integrals are read only");
 }
 
+const double* DISKDFIntegrals::mapped_B() {
+    std::lock_guard<std::mutex> lock(df_mutex_);
+    if (mmap_data_ == nullptr) {
+        build_mmap();
+    }
+    return mmap_data_;
+}
+
+void DISKDFIntegrals::build_mmap() {
+    local_timer timer;
+    auto throw_system_error = [](const std::string& msg) {
+        throw std::runtime_error("DISKDFIntegrals: " + msg + " (" + std::strerror(errno) + ")");
+    };
+
+    const size_t n = aptei_idx_;
+    mmap_size_ = n * n * nthree_ * sizeof(double);
+    outfile->Printf("\n  Mapping the DF integrals to a scratch file (%.2f MB).",
+                    mmap_size_ / 1048576.0);
+
+    // create the scratch file and unlink it right away, so that it is removed when it is closed
+    std::string filename = psi::PSIOManager::shared_object()->get_default_path() + "psi." +
+                           std::to_string(getpid()) + ".forte.diskdf.XXXXXX";
+    std::vector<char> filename_buffer(filename.begin(), filename.end());
+    filename_buffer.push_back('\0');
+    mmap_fd_ = mkstemp(filename_buffer.data());
+    if (mmap_fd_ == -1) {
+        throw_system_error("cannot create the scratch file " + filename);
+    }
+    unlink(filename_buffer.data());
+    if (ftruncate(mmap_fd_, static_cast<off_t>(mmap_size_)) == -1) {
+        release_mmap();
+        throw_system_error("cannot allocate " + std::to_string(mmap_size_) + " bytes on disk");
+    }
+    void* data = mmap(nullptr, mmap_size_, PROT_READ | PROT_WRITE, MAP_SHARED, mmap_fd_, 0);
+    if (data == MAP_FAILED) {
+        release_mmap();
+        throw_system_error("cannot map the scratch file");
+    }
+    mmap_data_ = static_cast<double*>(data);
+
+    // take care of frozen orbitals
+    std::vector<size_t> cmotomo;
+    if (frzcpi_.sum() && aptei_idx_ == ncmo_) {
+        cmotomo = cmotomo_;
+    } else {
+        cmotomo.resize(nmo_);
+        std::iota(cmotomo.begin(), cmotomo.end(), 0);
+    }
+
+    // copy B(Q|pq) one p at a time and store it as B(pq|Q)
+    auto Aq = std::make_shared<psi::Matrix>("Aq", nthree_, nmo_);
+    for (size_t p = 0; p < n; ++p) {
+        df_->fill_tensor("B", Aq, {0, nthree_}, {cmotomo[p], cmotomo[p] + 1}, {0, nmo_});
+        double** Aq_p = Aq->pointer();
+#pragma omp parallel for
+        for (size_t q = 0; q < n; ++q) {
+            double* row = mmap_data_ + (p * n + q) * nthree_;
+            const size_t nq = cmotomo[q];
+            for (size_t A = 0; A < nthree_; ++A) {
+                row[A] = Aq_p[A][nq];
+            }
+        }
+    }
+    mprotect(mmap_data_, mmap_size_, PROT_READ);
+
+    mmap_rows_.resize(n * n);
+    for (size_t pq = 0; pq < n * n; ++pq) {
+        mmap_rows_[pq] = mmap_data_ + pq * nthree_;
+    }
+    print_timing("mapping density-fitted integrals", timer.get());
+}
+
+void DISKDFIntegrals::release_mmap() {
+    if (mmap_data_ != nullptr) {
+        munmap(mmap_data_, mmap_size_);
+        mmap_data_ = nullptr;
+    }
+    if (mmap_fd_ != -1) {
+        close(mmap_fd_);
+        mmap_fd_ = -1;
+    }
+    mmap_rows_.clear();
+}
+
+ambit::Tensor DISKDFIntegrals::mapped_three_integral_block(const std::vector<size_t>& Q_vec,
+                                                           const std::vector<size_t>& p_vec,
+                                                           const std::vector<size_t>& q_vec) {
+    std::string func_name = "DISKDFIntegrals::three_integral_block: ";
+
+    auto Qsize = Q_vec.size();
+    auto psize = p_vec.size();
+    auto qsize = q_vec.size();
+    auto pqsize = psize * qsize;
+
+    auto out = ambit::Tensor::build(tensor_type_, "Return", {Qsize, psize, qsize});
+    if (Qsize == 0 or psize == 0 or qsize == 0) {
+        return out;
+    }
+    if (*std::max_element(Q_vec.begin(), Q_vec.end()) >= nthree_) {
+        throw std::runtime_error(func_name + "auxiliary indices out of range");
+    }
+    if (*std::max_element(p_vec.begin(), p_vec.end()) >= aptei_idx_) {
+        throw std::runtime_error(func_name + "MO indices p_vec out of range");
+    }
+    if (*std::max_element(q_vec.begin(), q_vec.end()) >= aptei_idx_) {
+        throw std::runtime_error(func_name + "MO indices q_vec out of range");
+    }
+
+    const double* B = mapped_B();
+    auto& out_data = out.data();
+#pragma omp parallel for
+    for (size_t p = 0; p < psize; ++p) {
+        for (size_t q = 0; q < qsize; ++q) {
+            const double* row = B + (p_vec[p] * aptei_idx_ + q_vec[q]) * nthree_;
+            for (size_t A = 0; A < Qsize; ++A) {
+                out_data[A * pqsize + p * qsize + q] = row[Q_vec[A]];
+            }
+        }
+    }
+    return out;
+}
+
 void DISKDFIntegrals::gather_integrals() {
+    // the mapped tensor is rebuilt from the new integrals when needed
+    release_mmap();
     outfile->Printf("\n Computing density fitted integrals\n");
 
     std::shared_ptr<psi::BasisSet> primary = wfn_->basisset();
@@ -543,6 +763,8 @@ void DISKDFIntegrals::resort_integrals_after_freezing() {
 ambit::Tensor DISKDFIntegrals::three_integral_block_two_index(const std::vector<size_t>& A,
                                                               size_t p,
                                                               const std::vector<size_t>& q) {
+    IntegralTraceScope trace_scope(trace_.get(), "three_integral_block_two_index",
+                                   {A.size(), size_t(1), q.size()});
 
     ambit::Tensor ReturnTensor = ambit::Tensor::build(tensor_type_, "Return", {A.size(), q.size()});
 
@@ -564,7 +786,10 @@ ambit::Tensor DISKDFIntegrals::three_integral_block_two_index(const std::vector<
         std::vector<size_t> prange = {p_min, p_max};
 
         std::shared_ptr<psi::Matrix> Aq(new psi::Matrix("Aq", nthree_, nmo_));
-        df_->fill_tensor("B", Aq, arange, prange, qrange);
+        {
+            std::lock_guard<std::mutex> lock(df_mutex_);
+            df_->fill_tensor("B", Aq, arange, prange, qrange);
+        }
 
         if (frozen_core) {
             ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
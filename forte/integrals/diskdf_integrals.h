@@ -30,6 +30,10 @@
 #ifndef _diskdf_integrals_h_
 #define _diskdf_integrals_h_
 
+#include <deque>
+#include <future>
+#include <mutex>
+
 #include "psi4/lib3index/dfhelper.h"
 #include "integrals.h"
 
@@ -40,12 +44,16 @@ namespace forte {
 /// DF_Helper
 /// Aptei_xy are extremely slow -> Try to use three_electron_block.  Much faster
 /// Reading individual elements is slow
+/// With DISKDF_MMAP, the B tensor is instead copied once to a scratch file in the (pq|Q) layout of
+/// DFIntegrals and memory mapped, so that reads go through the OS page cache and
+/// three_integral_pointer() is available without an in-core copy
 class DISKDFIntegrals : public Psi4Integrals {
   public:
     /// Contructor of DISKDFIntegrals
     DISKDFIntegrals(std::shared_ptr<ForteOptions> options,
                     std::shared_ptr<psi::Wavefunction> ref_wfn,
                     std::shared_ptr<MOSpaceInfo> mo_space_info, IntegralSpinRestriction restricted);
+    ~DISKDFIntegrals() override;
 
     void initialize() override;
     /// aptei_xy functions are slow.  try to use three_integral_block
@@ -76,6 +84,9 @@ class DISKDFIntegrals : public Psi4Integrals {
     /// return ambit tensor of size A by q
     ambit::Tensor three_integral_block_two_index(const std::vector<size_t>& A, size_t p,
                                                  const std::vector<size_t>& q) override;
+    /// Read the declared blocks ahead on a background thread (one block at a time)
+    void set_three_integral_block_sequence(
+        const std::vector<std::array<std::vector<size_t>, 3>>& blocks) override;
 
     void set_tei(size_t p, size_t q, size_t r, size_t s, double value, bool alpha1,
                  bool alpha2) override;
@@ -90,6 +101,44 @@ class DISKDFIntegrals : public Psi4Integrals {
     std::shared_ptr<psi::Matrix> ThreeIntegral_;
     size_t nthree_ = 0;
 
+    /// Serializes the reads of the DFHelper file
+    std::mutex df_mutex_;
+    /// The blocks declared by set_three_integral_block_sequence not yet read
+    std::deque<std::array<std::vector<size_t>, 3>> block_sequence_;
+    /// The indices of the block being read ahead
+    std::array<std::vector<size_t>, 3> prefetch_indices_;
+    /// The block being read ahead
+    std::future<ambit::Tensor> prefetch_;
+
+    /// Read a block of the DFIntegrals from disk (synchronously)
+    ambit::Tensor read_three_integral_block(const std::vector<size_t>& A,
+                                            const std::vector<size_t>& p,
+                                            const std::vector<size_t>& q);
+    /// Start reading the next declared block, if any
+    void prefetch_next_block();
+
+    /// Map the B tensor in memory?
+    bool use_mmap_ = false;
+    /// The file descriptor of the mapped B tensor (-1 if not mapped)
+    int mmap_fd_ = -1;
+    /// The size of the mapped B tensor in bytes
+    size_t mmap_size_ = 0;
+    /// The mapped B tensor, stored as B(pq|Q) with pq = p * aptei_idx_ + q
+    double* mmap_data_ = nullptr;
+    /// Pointers to the rows B(pq|*) of the mapped tensor
+    std::vector<double*> mmap_rows_;
+
+    /// Return the mapped B tensor, building it on the first call after the integrals changed
+    const double* mapped_B();
+    /// Copy the B tensor from the DFHelper file to a mapped scratch file
+    void build_mmap();
+    /// Unmap and close the scratch file
+    void release_mmap();
+    /// Read a block of the mapped B tensor
+    ambit::Tensor mapped_three_integral_block(const std::vector<size_t>& A,
+                                              const std::vector<size_t>& p,
+                                              const std::vector<size_t>& q);
+
     // ==> Class private virtual functions <==
 
     void gather_integrals() override;
@@ -28,64 +28,49 @@
 
 #ifdef HAVE_GA
 
-#include <cassert>
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 
-#include "integrals.h"
 #include "psi4/libmints/basisset.h"
 #include "psi4/libmints/matrix.h"
+#include "psi4/libpsi4util/process.h"
 #include "psi4/libqt/qt.h"
 
-#ifdef _OPENMP
-#include <omp.h>
-#else
-#define omp_get_max_threads() 1
-#define omp_get_thread_num() 0
-#define omp_get_num_threads() 1
-#endif
+#include "forte-def.h"
+#include "base_classes/forte_options.h"
+#include "base_classes/mo_space_info.h"
+#include "helpers/timer.h"
 
-#ifdef HAVE_GA
 #include "paralleldfmo.h"
-#include "helpers/timer.h"
+#include "df_integrals.h"
+#include "integral_trace.h"
+#include "distribute_df_integrals.h"
+
 #include <ga.h>
 #include <macdecls.h>
 #include <mpi.h>
-#endif
-
-#include "helpers/blockedtensorfactory.h"
 
 using namespace ambit;
+using namespace psi;
 
 namespace forte {
 
 DistDFIntegrals::DistDFIntegrals(std::shared_ptr<ForteOptions> options,
                                  std::shared_ptr<psi::Wavefunction> ref_wfn,
-                                 IntegralSpinRestriction restricted,
-                                 IntegralFrozenCore resort_frozen_core,
-                                 std::shared_ptr<MOSpaceInfo> mo_space_info)
-    : Psi4Integrals(psi::Options, ref_wfn, restricted, resort_frozen_core, mo_space_info) {
-    initialize()
+                                 std::shared_ptr<MOSpaceInfo> mo_space_info,
+                                 IntegralSpinRestriction restricted)
+    : Psi4Integrals(options, ref_wfn, mo_space_info, DistDF, restricted) {
+    initialize();
 }
 
 void DistDFIntegrals::initialize() {
-
-    wfn_ = ref_wfn;
-
-    integral_type_ = DistDF;
     outfile->Printf("\n  DistDFIntegrals overall time with %d MPI Process and %d threads",
                     GA_Nnodes(), omp_get_max_threads());
     local_timer DFInt;
-#define omp_get_max_threads() 1
-    allocate();
-
-    int my_proc = 0;
-#ifdef HAVE_GA
-    my_proc = GA_Nodeid();
-#endif
 
     gather_integrals();
-    if (my_proc == 0) {
+    if (GA_Nodeid() == 0 and print_ > 2) {
         test_distributed_integrals();
     }
     freeze_core_orbitals();
@@ -94,350 +79,206 @@ void DistDFIntegrals::initialize() {
 }
 
 void DistDFIntegrals::test_distributed_integrals() {
-    outfile->Printf("\n Computing Density fitted integrals \n");
+    outfile->Printf("\n  Testing the distributed DF integrals against DFIntegrals");
 
-    std::shared_ptr<psi::BasisSet> primary = wfn_->basisset();
-    if (options_.get_str("DF_BASIS_MP2").length() == 0) {
-        outfile->Printf("\n Please set a DF_BASIS_MP2 option to a specified "
-                        "auxiliary basis set");
-        throw psi::PSIEXCEPTION("Select a DF_BASIS_MP2 for use with DFIntegrals");
-    }
+    /// Test whether DFIntegrals is same as DistributedDF
+    auto test_int = std::make_shared<DFIntegrals>(options_, wfn_, mo_space_info_,
+                                                  IntegralSpinRestriction::Restricted);
+    std::vector<size_t> Avec(nthree_);
+    std::iota(Avec.begin(), Avec.end(), 0);
+    std::vector<size_t> Apartial(nthree_ / 2);
+    std::iota(Apartial.begin(), Apartial.end(), 0);
+    std::vector<size_t> p(aptei_idx_);
+    std::iota(p.begin(), p.end(), 0);
+    auto rdocc = mo_space_info_->corr_absolute_mo("RESTRICTED_DOCC");
+    auto active = mo_space_info_->corr_absolute_mo("ACTIVE");
 
-    // std::shared_ptr<psi::BasisSet> auxiliary =
-    // psi::BasisSet::pyconstruct_orbital(primary->molecule(),
-    // "DF_BASIS_MP2",options_.get_str("DF_BASIS_MP2"));
+    auto test = [&](const std::string& label, const std::vector<size_t>& A,
+                    const std::vector<size_t>& p1, const std::vector<size_t>& p2) {
+        ambit::Tensor b_df = test_int->three_integral_block(A, p1, p2);
+        ambit::Tensor b_dist = three_integral_block(A, p1, p2);
+        b_df("Q, p, q") -= b_dist("Q, p, q");
+        outfile->Printf("\n  Test %-12s: %8.8f", label.c_str(), b_df.norm(2.0));
+        if (b_df.norm(2.0) > 1.0e-6)
+            throw psi::PSIEXCEPTION("three_integral_block does not work for " + label);
+    };
+    test("entire A", Avec, p, p);
+    test("partial A", Apartial, p, p);
+    test("B_00", Avec, {0}, {0});
+    test("B_mn", Avec, rdocc, rdocc);
+    test("B_mu", Avec, rdocc, active);
+
+    ambit::Tensor v_df = test_int->aptei_aa_block(active, active, active, active);
+    ambit::Tensor v_dist = aptei_aa_block(active, active, active, active);
+    v_df("p,q,r,s") -= v_dist("p,q,r,s");
+    outfile->Printf("\n  Test %-12s: %8.8f", "V_uvxy", v_df.norm(2.0));
+    if (v_df.norm(2.0) > 1.0e-6)
+        throw psi::PSIEXCEPTION("aptei_aa_block does not work for V_uvxy");
+}
 
-    std::shared_ptr<psi::BasisSet> auxiliary = wfn_->get_basisset("DF_BASIS_MP2");
+size_t DistDFIntegrals::absolute_mo(size_t p) const {
+    return (frzcpi_.sum() && aptei_idx_ == ncmo_) ? cmotomo_[p] : p;
+}
 
-    size_t nprim = primary->nbf();
-    size_t naux = auxiliary->nbf();
-    nthree_ = naux;
-    outfile->Printf("\n Number of auxiliary basis functions:  %u", naux);
-    outfile->Printf("\n Need %8.6f GB to store DF integrals\n",
-                    (nprim * nprim * naux * sizeof(double) / 1073741824.0));
-    int_mem_ = (nprim * nprim * naux * sizeof(double));
+DistDFIntegrals::Tile DistDFIntegrals::tile(size_t p) {
+    const size_t pn = absolute_mo(p);
+    std::lock_guard<std::mutex> lock(tile_mutex_);
+    auto it = tiles_.find(pn);
+    if (trace_)
+        trace_->record_cache("distdf_tiles", it != tiles_.end());
+    if (it != tiles_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.second);
+        return it->second.first;
+    }
 
-    psi::Dimension nsopi_ = wfn_->nsopi();
-    std::shared_ptr<psi::Matrix> aotoso = wfn_->aotoso();
-    std::shared_ptr<psi::Matrix> Ca = wfn_->Ca();
-    std::shared_ptr<psi::Matrix> Ca_ao(new psi::Matrix("Ca_ao", nso_, nmopi_.sum()));
+    // fetch the columns p * nmo + q for all Q and q, the tile is stored as B[Q][q]
+    auto buffer = std::make_shared<std::vector<double>>(nthree_ * nmo_);
+    int lo[2] = {0, static_cast<int>(pn * nmo_)};
+    int hi[2] = {static_cast<int>(nthree_) - 1, static_cast<int>((pn + 1) * nmo_) - 1};
+    int ld[1] = {static_cast<int>(nmo_)};
+    NGA_Get(DistDF_ga_, lo, hi, buffer->data(), ld);
 
-    // Transform from the SO to the AO basis
-    for (int h = 0, index = 0; h < nirrep_; ++h) {
-        for (int i = 0; i < nmopi_[h]; ++i) {
-            size_t nao = nso_;
-            size_t nso = nsopi_[h];
+    if (tiles_.size() >= max_tiles_) {
+        tiles_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(pn);
+    Tile t = buffer;
+    tiles_[pn] = std::make_pair(t, lru_.begin());
+    return t;
+}
 
-            if (!nso)
-                continue;
+void DistDFIntegrals::clear_tiles() {
+    std::lock_guard<std::mutex> lock(tile_mutex_);
+    tiles_.clear();
+    lru_.clear();
+    // keep at most a quarter of the memory in tiles, but enough for the four-index accessors
+    size_t tile_size = std::max(size_t(1), nthree_ * nmo_ * sizeof(double));
+    max_tiles_ = std::max(size_t(4), psi::Process::environment.get_memory() / (4 * tile_size));
+}
 
-            C_DGEMV('N', nao, nso, 1.0, aotoso->pointer(h)[0], nso, &Ca->pointer(h)[0][i],
-                    nmopi_[h], 0.0, &Ca_ao->pointer()[0][index], nmopi_.sum());
+double DistDFIntegrals::aptei_aa(size_t p, size_t q, size_t r, size_t s) {
+    Tile tp = tile(p);
+    Tile tq = tile(q);
+    const size_t rn = absolute_mo(r), sn = absolute_mo(s);
+    double vpqrsC = C_DDOT(nthree_, tp->data() + rn, nmo_, tq->data() + sn, nmo_);
+    double vpqrsE = C_DDOT(nthree_, tp->data() + sn, nmo_, tq->data() + rn, nmo_);
+    return vpqrsC - vpqrsE;
+}
 
-            index += 1;
-        }
-    }
+double DistDFIntegrals::aptei_ab(size_t p, size_t q, size_t r, size_t s) {
+    Tile tp = tile(p);
+    Tile tq = tile(q);
+    return C_DDOT(nthree_, tp->data() + absolute_mo(r), nmo_, tq->data() + absolute_mo(s), nmo_);
+}
 
-    // B_{pq}^Q -> MO without frozen core
-
-    // Constructs the DF function
-    // I used this version of build as this doesn't build all the apces and
-    // assume a RHF/UHF reference
-    std::shared_ptr<DFERI> df = DFERI::build(primary, auxiliary, options_);
-
-    // Pushes a C matrix that is ordered in pitzer ordering
-    // into the C_matrix object
-    df->set_C(Ca_ao);
-    // set_C clears all the orbital spaces, so this creates the space
-    // This space creates the total nmo_.
-    // This assumes that everything is correlated.
-    df->add_space("ALL", 0, nmo_);
-    // Does not add the pair_space, but says which one is should use
-    df->add_pair_space("B", "ALL", "ALL");
-    df->set_memory(psi::Process::environment.get_memory() / sizeof(double));
-
-    // Finally computes the df integrals
-    // Does the timings also
-    local_timer timer;
-    std::string str = "Computing DF Integrals";
-    outfile->Printf("\n    %-36s ...", str.c_str());
-    df->compute();
-    outfile->Printf("...Done. Timing %15.6f s", timer.get());
-
-    std::shared_ptr<Tensor> B = df->ints()["B"];
-    B_ = B;
-    df.reset();
-    int dim[2], chunk[2];
-    dim[0] = nthree_;
-    dim[1] = nmo_ * nmo_;
-    chunk[0] = -1;
-    chunk[1] = nmo_ * nmo_;
-
-    int MY_DF = NGA_Create(C_DBL, 2, dim, (char*)"DistributedDF", chunk);
-    if (MY_DF == 0)
-        GA_Error("DistributedDF failed on creating the tensor", 1);
-    // GA_Print_distribution(MY_DF);
-    // GA_Print_distribution(DistDF_ga_);
-    int my_proc = GA_Nodeid();
-    int num_proc = GA_Nnodes();
-    if (my_proc == 0) {
-        for (int iproc = 0; iproc < num_proc; iproc++) {
-            int begin_offset[2];
-            int end_offset[2];
-            int stride[1];
-            stride[0] = nmo_ * nmo_;
-            NGA_Distribution(MY_DF, iproc, begin_offset, end_offset);
-            std::vector<int> begin_offset_vec = {begin_offset[0], begin_offset[1]};
-            std::vector<int> end_offset_vec = {end_offset[0], end_offset[1]};
-            ambit::Tensor B_per_process = read_integral_chunk(B_, begin_offset_vec, end_offset_vec);
-            NGA_Put(MY_DF, begin_offset, end_offset, &(B_per_process.data()[0]), stride);
-        }
-    }
-    double positive_one = 1.0;
-    double negative_one = -1.0;
-    GA_Add(&positive_one, MY_DF, &negative_one, DistDF_ga_, MY_DF);
-    std::vector<double> my_df_norm(2, 0.0);
-    GA_Norm_infinity(MY_DF, &my_df_norm[0]);
-    for (auto my_norm : my_df_norm) {
-        outfile->Printf("\n ||SERIAL_DF - DistDF||_{\infinity} = %4.16f", my_norm);
-        if (my_norm > 1e-4)
-            throw psi::PSIEXCEPTION("DF and DistDF do not agree");
-    }
-    /// Test getting entire three_integral_object
-    std::vector<size_t> Avec(nthree_, 0);
-    std::vector<size_t> p(nmo_, 0);
-    std::iota(Avec.begin(), Avec.end(), 0);
-    std::iota(p.begin(), p.end(), 0);
+double DistDFIntegrals::aptei_bb(size_t p, size_t q, size_t r, size_t s) {
+    return aptei_aa(p, q, r, s);
+}
 
-    /// Test whether DFIntegrals is same as DistributedDF
-    ForteIntegrals* test_int =
-        new DFIntegrals(options_, wfn_, UnrestrictedMOs, RemoveFrozenMOs, mo_space_info_);
-    ambit::Tensor entire_b_df = test_int->three_integral_block(Avec, p, p);
-    ambit::Tensor entire_b_dist = three_integral_block(Avec, p, p);
-    entire_b_df("Q, p, q") -= entire_b_dist("Q, p, q");
-    outfile->Printf("\n Test read entire A: %8.8f", entire_b_df.norm(2.0));
-    if (entire_b_df.norm(2.0) > 1.0e-6)
-        throw psi::PSIEXCEPTION("three_integral_block for all integrals does not work");
-
-    /// Test partial nthree
-    int block = nthree_ / 2;
-    std::vector<size_t> Apartial(block, 0);
-    std::iota(Apartial.begin(), Apartial.end(), 0);
-    ambit::Tensor partial_b_df = test_int->three_integral_block(Apartial, p, p);
-    ambit::Tensor partial_b_dist = three_integral_block(Apartial, p, p);
-    partial_b_df("Q, p, q") -= partial_b_dist("Q, p, q");
-    outfile->Printf("\n Test partial A: %8.8f", partial_b_df.norm(2.0));
-    if (partial_b_df.norm(2.0) > 1.0e-6)
-        throw psi::PSIEXCEPTION("three_integral_block for partial nthree integrals does not work");
-    /// Test rdocc
-
-    ambit::Tensor b_zero_df = test_int->three_integral_block(Avec, {0}, {0});
-    ambit::Tensor b_zero_dist = three_integral_block(Avec, {0}, {0});
-    b_zero_df("Q, p, q") -= b_zero_dist("Q, p, q");
-    outfile->Printf("\n Test Q_00: %8.8f", b_zero_df.norm(2.0));
-    if (b_zero_df.norm(2.0) > 1.0e-6)
-        throw psi::PSIEXCEPTION("three_integral_block for B_00");
-
-    ambit::Tensor b_one_df = test_int->three_integral_block(Avec, {1}, {1});
-    ambit::Tensor b_one_dist = three_integral_block(Avec, {1}, {1});
-    b_one_df("Q, p, q") -= b_one_dist("Q, p, q");
-    outfile->Printf("\n Test Q_{11}: %8.8f", b_one_df.norm(2.0));
-    if (b_one_df.norm(2.0) > 1.0e-6)
-        throw psi::PSIEXCEPTION("three_integral_block for B_11");
+double DistDFIntegrals::diag_aptei_aa(size_t p, size_t q) { return aptei_aa(p, q, p, q); }
 
-    auto rdocc = mo_space_info_->corr_absolute_mo("RESTRICTED_DOCC");
-    auto active = mo_space_info_->corr_absolute_mo("ACTIVE");
-    ambit::Tensor b_mn_df = test_int->three_integral_block(Avec, rdocc, rdocc);
-    ambit::Tensor b_mn_dist = three_integral_block(Avec, rdocc, rdocc);
-    b_mn_df("Q, p, q") -= b_mn_dist("Q, p, q");
-    outfile->Printf("\n Test Q_mn: %8.8f", b_mn_df.norm(2.0));
-    if (b_mn_df.norm(2.0) > 1.0e-6)
-        throw psi::PSIEXCEPTION("three_integral_block for B_mn");
-
-    ambit::Tensor b_mu_df = test_int->three_integral_block(Avec, rdocc, active);
-    ambit::Tensor b_mu_dist = three_integral_block(Avec, rdocc, active);
-    b_mu_df("Q, p, q") -= b_mu_dist("Q, p, q");
-    outfile->Printf("\n Test Q_{mu}: %8.8f", b_mu_df.norm(2.0));
-    if (b_mu_df.norm(2.0) > 1.0e-6)
-        throw psi::PSIEXCEPTION("three_integral_block for B_11");
-
-    delete test_int;
+double DistDFIntegrals::diag_aptei_ab(size_t p, size_t q) { return aptei_ab(p, q, p, q); }
+
+double DistDFIntegrals::diag_aptei_bb(size_t p, size_t q) { return aptei_bb(p, q, p, q); }
+
+double DistDFIntegrals::three_integral(size_t A, size_t p, size_t q) {
+    return (*tile(p))[A * nmo_ + absolute_mo(q)];
 }
 
-ambit::Tensor DistDFIntegrals::read_integral_chunk(std::shared_ptr<Tensor>& B, std::vector<int>& lo,
-                                                   std::vector<int>& hi) {
-    assert(lo.size() == 2);
-    assert(hi.size() == 2);
-    /// This tells what block of naux is on the processor that calls this
-    size_t naux_block_size = hi[0] - lo[0] + 1;
+ambit::Tensor DistDFIntegrals::aptei_block(const std::vector<size_t>& p,
+                                           const std::vector<size_t>& q,
+                                           const std::vector<size_t>& r,
+                                           const std::vector<size_t>& s, bool antisymmetrize) {
+    std::vector<size_t> Avec(nthree_);
+    std::iota(Avec.begin(), Avec.end(), 0);
     ambit::Tensor ReturnTensor =
-        ambit::Tensor::build(tensor_type_, "Return", {naux_block_size, nmo_, nmo_});
-    std::vector<double>& ReturnTensorV = ReturnTensor.data();
-    /// Allocate a vector that is blocked via naux dimension
-    std::vector<size_t> naux(naux_block_size, 0);
-    /// Fill the tensor starting from start of block and end once it hits end
-    std::iota(naux.begin(), naux.end(), lo[0]);
-    // If p and q are not just nmo_, this map corrects that.
-    // If orbital 0, 5, 10, 15 is frozen, this corresponds to 0, 1, 2, 3.
-    // This map says p_map[5] = 1.
-    // Used in correct ordering for the tensor.
-
-    std::vector<size_t> all_mos = mo_space_info_->corr_absolute_mo("ALL");
-    int p_idx = 0;
-    int q_idx = 0;
-    std::vector<size_t> p_map(nmo_);
-    std::vector<size_t> q_map(nmo_);
-
-    // for(size_t p_block : all_mos)
-    //{
-    //    p_map[p_block] = p_idx;
-    //    p_idx++;
-    //}
-    // for(size_t q_block : all_mos)
-    //{
-    //    q_map[q_block] = q_idx;
-    //    q_idx++;
-    //}
-
-    for (size_t p_block = 0; p_block < nmo_; p_block++) {
-        size_t pn = p_block;
-        for (size_t q_block = 0; q_block < nmo_; q_block++) {
-            size_t qn = q_block;
-            double* A_chunk = new double[naux_block_size];
-            size_t offset = pn * nthree_ * nmo_ + qn * nthree_ + naux[0];
-            fseek(B_->file_pointer(), offset * sizeof(double), SEEK_SET);
-            fread(&(A_chunk[0]), sizeof(double), naux_block_size, B_->file_pointer());
-            for (size_t a = 0; a < naux_block_size; a++) {
-                // Weird way the tensor is formatted
-                // Fill the tensor for every chunk of A
-                // ReturnTensorV[a * nmo_ * nmo_ + p_map[p_block] * nmo_ +
-                // q_map[q_block]] = A_chunk[a];
-                ReturnTensorV[a * nmo_ * nmo_ + p_block * nmo_ + q_block] = A_chunk[a];
-            }
-            delete[] A_chunk;
-        }
+        ambit::Tensor::build(tensor_type_, "Return", {p.size(), q.size(), r.size(), s.size()});
+    ambit::Tensor B1 = three_integral_block(Avec, p, r);
+    ambit::Tensor B2 = three_integral_block(Avec, q, s);
+    ReturnTensor("p,q,r,s") = B1("Q,p,r") * B2("Q,q,s");
+    if (antisymmetrize) {
+        B1 = three_integral_block(Avec, p, s);
+        B2 = three_integral_block(Avec, q, r);
+        ReturnTensor("p,q,r,s") -= B1("Q,p,s") * B2("Q,q,r");
     }
     return ReturnTensor;
 }
-void DistDFIntegrals::deallocate() {
-    GA_Destroy(DistDF_ga_);
-    // delete[] diagonal_aphys_tei_aa;
-    // delete[] diagonal_aphys_tei_ab;
-    // delete[] diagonal_aphys_tei_bb;
+
+ambit::Tensor DistDFIntegrals::aptei_aa_block(const std::vector<size_t>& p,
+                                              const std::vector<size_t>& q,
+                                              const std::vector<size_t>& r,
+                                              const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_aa_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(0, p, q, r, s, [&]() { return aptei_block(p, q, r, s, true); });
+}
+
+ambit::Tensor DistDFIntegrals::aptei_ab_block(const std::vector<size_t>& p,
+                                              const std::vector<size_t>& q,
+                                              const std::vector<size_t>& r,
+                                              const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_ab_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(1, p, q, r, s, [&]() { return aptei_block(p, q, r, s, false); });
 }
-void DistDFIntegrals::allocate() {
-    diagonal_aphys_tei_aa = new double[nmo_ * nmo_];
-    diagonal_aphys_tei_ab = new double[nmo_ * nmo_];
-    diagonal_aphys_tei_bb = new double[nmo_ * nmo_];
+
+ambit::Tensor DistDFIntegrals::aptei_bb_block(const std::vector<size_t>& p,
+                                              const std::vector<size_t>& q,
+                                              const std::vector<size_t>& r,
+                                              const std::vector<size_t>& s) {
+    IntegralTraceScope trace_scope(trace_.get(), "aptei_bb_block",
+                                   {p.size(), q.size(), r.size(), s.size()});
+    return cached_aptei_block(2, p, q, r, s, [&]() { return aptei_block(p, q, r, s, true); });
 }
-// double DistDFIntegrals::aptei_aa(size_t p, size_t q, size_t r, size_t s)
-//{
-//    ambit::Tensor pqrs = aptei_aa_block({p}, {q}, {r}, {s});
-//    return pqrs.data()[0];
-//}
-// double DistDFIntegrals::aptei_ab(size_t p, size_t q, size_t r, size_t s)
-//{
-//    ambit::Tensor pqrs = aptei_ab_block({p}, {q}, {r}, {s});
-//    return pqrs.data()[0];
-//}
-// double DistDFIntegrals::aptei_bb(size_t p, size_t q, size_t r, size_t s)
-//{
-//    ambit::Tensor pqrs = aptei_bb_block({p}, {q}, {r}, {s});
-//    return pqrs.data()[0];
-//}
+
 ambit::Tensor DistDFIntegrals::three_integral_block(const std::vector<size_t>& A,
                                                     const std::vector<size_t>& p,
                                                     const std::vector<size_t>& q) {
+    IntegralTraceScope trace_scope(trace_.get(), "three_integral_block",
+                                   {A.size(), p.size(), q.size()});
     ambit::Tensor ReturnTensor =
         ambit::Tensor::build(tensor_type_, "Return", {A.size(), p.size(), q.size()});
     std::vector<double>& ReturnTensorV = ReturnTensor.data();
-    bool frozen_core = false;
-
-    if (frzcpi_.sum() && aptei_idx_ == ncmo_)
-        frozen_core = true;
-
-    size_t pn, qn;
-    /// DistDF_ga_ is distributed via A dimension.
-    /// A lot of logic needs to be done to figure out where information lies
-    int subscript_begin[2];
-    int subscript_end[2];
-    /// If user wants blocking in A
-    // GA_Print_distribution(DistDF_ga_);
-    if (p.size() == nmo_ && q.size() == nmo_ && A.size() < nthree_) {
-        int ld[1];
-        ld[0] = nmo_ * nmo_;
-        subscript_begin[0] = A[0];
-        subscript_begin[1] = 0;
-        subscript_end[0] = A[A.size() - 1];
-        subscript_end[1] = nmo_ * nmo_ - 1;
-        for (int i = 0; i < 2; i++)
-            outfile->Printf("\n subscript[%d] = (%d, %d)", i, subscript_begin[i], subscript_end[i]);
-        NGA_Get(DistDF_ga_, subscript_begin, subscript_end, &ReturnTensorV[0], ld);
-        return ReturnTensor;
-    } else if (p.size() == nmo_ && q.size() == nmo_ && A.size() == nthree_) {
-        int ld[1];
-        ld[0] = nmo_ * nmo_;
-        subscript_begin[0] = 0;
-        subscript_begin[1] = 0;
-        subscript_end[0] = nthree_ - 1;
-        subscript_end[1] = nmo_ * nmo_ - 1;
-        for (int i = 0; i < 2; i++)
-            outfile->Printf("\n subscript[%d] = (%d, %d)", i, subscript_begin[i], subscript_end[i]);
-        NGA_Get(DistDF_ga_, subscript_begin, subscript_end, &ReturnTensorV[0], ld);
-        return ReturnTensor;
-    } else if (A.size() == nthree_ and (p.size() != nmo_ or q.size() != nmo_)) {
-        /// DF_Tensor is packed in like (NAUX, p, q) where fast dimension is q.
-        /// To read tensor from ga, I will assume in that auxiliary index is
-        /// nthree_
-        /// Let's say I want (nthree_,1,nmo_), I have to translate that to lo
-        /// and hi index.
-        /// lo[0] = 0, hi[0] = nthree_ - 1
-        /// lo[1] = 1 * nmo_ + 0
-        /// hi[1] = 1 * nmo_ + nmo_
-        /// This means lo[1] = p[idx] * nmo_ + q[idx_min]
-        ///                           hi[1] = p[idx] * nmo_ + q[idx_max]
-        /// Few ways to do this:  Read all of q (ignore q vector) for every p
-        /// Then put the select bits into the tensor
-        /// Slower way:  Read only 1 entry at a time for p and q
-        /// No reason to do this.  Maybe if you want a dumb algorithm
-
-        int ld[1];
-        ld[0] = nmo_;
-        subscript_begin[0] = 0;
-        subscript_end[0] = nthree_ - 1;
-        std::vector<std::vector<double>> ga_buf_vector;
-        for (size_t plist = 0; plist < p.size(); plist++) {
-            std::vector<double> ga_buf(nthree_ * nmo_);
-            size_t p_index = p[plist];
-            subscript_begin[1] = (p_index * nmo_);
-            subscript_end[1] = (p_index + 1) * nmo_ - 1;
-            for (int i = 0; i < 2; i++)
-                outfile->Printf("\n subscript[%d] = (%d, %d)", i, subscript_begin[i],
-                                subscript_end[i]);
-
-            NGA_Get(DistDF_ga_, subscript_begin, subscript_end, &ga_buf[0], ld);
-            ga_buf_vector.push_back(ga_buf);
-            // for(int qlist = 0; qlist < q.size(); qlist++){
-            //    size_t q_index = q[qlist];
-
-            //}
-            // ReturnTensorV = ga_buf;
+    std::vector<size_t> qn(q.size());
+    for (size_t iq = 0; iq < q.size(); ++iq) {
+        qn[iq] = absolute_mo(q[iq]);
+    }
+
+    /// One tile per p holds B[Q][q] for all Q and q; copy the requested A and q
+    const size_t np = p.size(), nq = q.size();
+    for (size_t ip = 0; ip < np; ++ip) {
+        Tile tp = tile(p[ip]);
+        const double* B = tp->data();
+        for (size_t a = 0; a < A.size(); ++a) {
+            const double* BA = B + A[a] * nmo_;
+            double* R = &ReturnTensorV[(a * np + ip) * nq];
+            for (size_t iq = 0; iq < nq; ++iq) {
+                R[iq] = BA[qn[iq]];
+            }
+        }
+    }
+    return ReturnTensor;
+}
+
+ambit::Tensor DistDFIntegrals::three_integral_block_two_index(const std::vector<size_t>& A,
+                                                              size_t p,
+                                                              const std::vector<size_t>& q) {
+    IntegralTraceScope trace_scope(trace_.get(), "three_integral_block_two_index",
+                                   {A.size(), size_t(1), q.size()});
+    ambit::Tensor ReturnTensor =
+        ambit::Tensor::build(tensor_type_, "Return", {A.size(), q.size()});
+    std::vector<double>& ReturnTensorV = ReturnTensor.data();
+    Tile tp = tile(p);
+    for (size_t a = 0; a < A.size(); ++a) {
+        for (size_t iq = 0; iq < q.size(); ++iq) {
+            ReturnTensorV[a * q.size() + iq] = (*tp)[A[a] * nmo_ + absolute_mo(q[iq])];
         }
-        ReturnTensor.iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t p_index = p[i[1]];
-            size_t q_index = q[i[2]];
-            size_t A_index = A[i[0]];
-            value = ga_buf_vector[i[1]][A_index * nmo_ + q[i[2]]];
-        });
-
-        return ReturnTensor;
-    } else if (A.size() != nthree_ and p.size() != nmo_ and q.size() != nmo_) {
     }
+    return ReturnTensor;
 }
+
 void DistDFIntegrals::gather_integrals() {
-    // std::shared_ptr<psi::BasisSet> auxiliary =
-    // psi::BasisSet::pyconstruct_orbital(wfn_->molecule(),
-    // "DF_BASIS_MP2",options_.get_str("DF_BASIS_MP2"));
     std::shared_ptr<psi::BasisSet> auxiliary = wfn_->get_basisset("DF_BASIS_MP2");
     std::shared_ptr<psi::Matrix> Ca = wfn_->Ca();
     std::shared_ptr<psi::Matrix> Ca_ao(new psi::Matrix("CA_AO", wfn_->nso(), wfn_->nmo()));
@@ -459,29 +300,12 @@ void DistDFIntegrals::gather_integrals() {
     ParallelDFMO DFMO = ParallelDFMO(wfn_->basisset(), auxiliary);
     DFMO.set_C(Ca_ao);
     DFMO.compute_integrals();
+    /// Note:  The GA (Q|pq) always stores all the orbitals, distributed over Q.
+    /// Frozen core does not gain any benefits in storage; the accessors convert
+    /// the correlated indices to absolute ones.
     DistDF_ga_ = DFMO.Q_PQ();
-    int dim[3];
-    int chunk[3];
-    /// Note:  I assume that we always store all the 3index integrals
-    /// Frozen core does not gain any benefits in storage
-    /// Accessing elements needs to use absolute index.  Will convert to
-    /// absolute in API
-    dim[0] = nthree_;
-    dim[1] = nmo_;
-    dim[2] = nmo_;
-    chunk[0] = -1;
-    chunk[1] = nmo_;
-    chunk[2] = nmo_;
-}
-void DistDFIntegrals::retransform_integrals() {
-    aptei_idx_ = nmo_;
-    transform_one_electron_integrals();
-    int my_proc = 0;
-    my_proc = GA_Nodeid();
-    outfile->Printf("\n Integrals are about to be computed.");
-    gather_integrals();
-    outfile->Printf("\n Integrals are about to be updated.");
-    freeze_core_orbitals();
+    nthree_ = auxiliary->nbf();
+    clear_tiles();
 }
 } // namespace forte
 
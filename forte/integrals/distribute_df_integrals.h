@@ -27,85 +27,108 @@
  * @END LICENSE
  */
 
-#ifndef _conventional_integrals_h_
-#define _conventional_integrals_h_
+#ifndef _distribute_df_integrals_h_
+#define _distribute_df_integrals_h_
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 #include "integrals.h"
 
 namespace forte {
 
 #ifdef HAVE_GA
+/**
+ * @brief The DistDFIntegrals class stores the DF integrals (Q|pq) in a Global Array
+ *
+ * The GA is distributed over the auxiliary index.  The integral accessors gather the remote
+ * tiles B[Q][q] (all Q and q for a given p) on demand and keep the most recently used tiles in a
+ * local cache, so the full ForteIntegrals interface is available on top of multi-node memory.
+ */
 class DistDFIntegrals : public Psi4Integrals {
   public:
     DistDFIntegrals(std::shared_ptr<ForteOptions> options,
-                    std::shared_ptr<psi::Wavefunction> ref_wfn, IntegralSpinRestriction restricted,
-                    std::shared_ptr<MOSpaceInfo> mo_space_info);
+                    std::shared_ptr<psi::Wavefunction> ref_wfn,
+                    std::shared_ptr<MOSpaceInfo> mo_space_info,
+                    IntegralSpinRestriction restricted);
 
     void initialize() override;
-    virtual void retransform_integrals();
+
     /// aptei_xy functions are slow.  try to use three_integral_block
+    double aptei_aa(size_t p, size_t q, size_t r, size_t s) override;
+    double aptei_ab(size_t p, size_t q, size_t r, size_t s) override;
+    double aptei_bb(size_t p, size_t q, size_t r, size_t s) override;
 
-    virtual double aptei_aa(size_t /*p*/, size_t /*q*/, size_t /*r*/, size_t /*s*/) {}
-    virtual double aptei_ab(size_t /*p*/, size_t /*q*/, size_t /*r*/, size_t /*s*/) {}
-    virtual double aptei_bb(size_t /*p*/, size_t /*q*/, size_t /*r*/, size_t /*s*/) {}
-
-    /// Reads the antisymmetrized alpha-alpha chunck and returns an
-    /// ambit::Tensor
-    virtual ambit::Tensor aptei_aa_block(const std::vector<size_t>& p, const std::vector<size_t>& q,
-                                         const std::vector<size_t>& r,
-                                         const std::vector<size_t>& s) {}
-    virtual ambit::Tensor aptei_ab_block(const std::vector<size_t>& p, const std::vector<size_t>& q,
-                                         const std::vector<size_t>& r,
-                                         const std::vector<size_t>& s) {}
-    virtual ambit::Tensor aptei_bb_block(const std::vector<size_t>& p, const std::vector<size_t>& q,
-                                         const std::vector<size_t>& r,
-                                         const std::vector<size_t>& s) {}
-
-    virtual double diag_aptei_aa(size_t, size_t) {}
-    virtual double diag_aptei_ab(size_t, size_t) {}
-    virtual double diag_aptei_bb(size_t, size_t) {}
-    virtual double three_integral(size_t, size_t, size_t) {}
-    virtual double** three_integral_pointer() {
+    /// Return the antisymmetrized alpha-alpha chunck as an ambit::Tensor
+    ambit::Tensor aptei_aa_block(const std::vector<size_t>& p, const std::vector<size_t>& q,
+                                 const std::vector<size_t>& r,
+                                 const std::vector<size_t>& s) override;
+    /// Return the antisymmetrized alpha-beta chunck as an ambit::Tensor
+    ambit::Tensor aptei_ab_block(const std::vector<size_t>& p, const std::vector<size_t>& q,
+                                 const std::vector<size_t>& r,
+                                 const std::vector<size_t>& s) override;
+    /// Return the antisymmetrized beta-beta chunck as an ambit::Tensor
+    ambit::Tensor aptei_bb_block(const std::vector<size_t>& p, const std::vector<size_t>& q,
+                                 const std::vector<size_t>& r,
+                                 const std::vector<size_t>& s) override;
+
+    double diag_aptei_aa(size_t p, size_t q);
+    double diag_aptei_ab(size_t p, size_t q);
+    double diag_aptei_bb(size_t p, size_t q);
+    double three_integral(size_t A, size_t p, size_t q);
+    double** three_integral_pointer() override {
         throw psi::PSIEXCEPTION("Integrals are distributed.  Pointer does not exist");
     }
     /// Read a block of the DFIntegrals and return an Ambit tensor of size A by
     /// p by q
-    virtual ambit::Tensor three_integral_block(const std::vector<size_t>& /*A*/,
-                                               const std::vector<size_t>& /*p*/,
-                                               const std::vector<size_t>& /*q*/);
+    ambit::Tensor three_integral_block(const std::vector<size_t>& A, const std::vector<size_t>& p,
+                                       const std::vector<size_t>& q) override;
     /// return ambit tensor of size A by q
-    virtual ambit::Tensor three_integral_block_two_index(const std::vector<size_t>& /*A*/,
-                                                         size_t /*p*/,
-                                                         const std::vector<size_t>& /*q*/) {}
+    ambit::Tensor three_integral_block_two_index(const std::vector<size_t>& A, size_t p,
+                                                 const std::vector<size_t>& q) override;
 
-    virtual void set_tei(size_t, size_t, size_t, size_t, double, bool, bool) {
-        outfile->Printf("DistributedDF will not work with set_tei");
+    void set_tei(size_t, size_t, size_t, size_t, double, bool, bool) override {
+        psi::outfile->Printf("DistributedDF will not work with set_tei");
         throw psi::PSIEXCEPTION("DistDF can not use set_tei");
     }
 
-    /// Make a Fock matrix computed with respect to a given determinant
-    virtual size_t nthree() const { return nthree_; }
-    virtual int ga_handle() { return DistDF_ga_; }
+    size_t nthree() const override { return nthree_; }
+    int ga_handle() override { return DistDF_ga_; }
 
   private:
-    virtual void gather_integrals();
-    virtual void resort_integrals_after_freezing() {}
+    void gather_integrals() override;
+    void resort_integrals_after_freezing() override {}
 
     /// This is the handle for GA
-    int DistDF_ga_;
-
-    std::shared_ptr<psi::Matrix> ThreeIntegral_;
+    int DistDF_ga_ = 0;
     size_t nthree_ = 0;
-    /// Assuming integrals are stored on disk
-    /// Reads the block of integrals present for each process
-    ambit::Tensor read_integral_chunk(std::shared_ptr<Tensor>& B, std::vector<int>& lo,
-                                      std::vector<int>& hi);
-    /// Distributes tensor according to naux dimension
-    void create_dist_df();
+
+    /// A tile of the GA: B[Q][q] for a given (absolute) orbital p
+    using Tile = std::shared_ptr<std::vector<double>>;
+    /// The maximum number of tiles kept in the cache
+    size_t max_tiles_ = 0;
+    /// The cached tiles and their position in the LRU list
+    std::unordered_map<size_t, std::pair<Tile, std::list<size_t>::iterator>> tiles_;
+    /// The cached orbitals, most recently used first
+    std::list<size_t> lru_;
+    /// Serializes the GA reads and the cache updates
+    std::mutex tile_mutex_;
+
+    /// @return the tile for the correlated orbital p, fetched from the GA if it is not cached
+    Tile tile(size_t p);
+    /// Empty the tile cache (the integrals changed)
+    void clear_tiles();
+    /// @return the absolute index of the correlated orbital p
+    size_t absolute_mo(size_t p) const;
+    /// The (antisymmetrized) block of integrals (pq|rs) [- (ps|qr)] built from the DF tiles
+    ambit::Tensor aptei_block(const std::vector<size_t>& p, const std::vector<size_t>& q,
+                              const std::vector<size_t>& r, const std::vector<size_t>& s,
+                              bool antisymmetrize);
     void test_distributed_integrals();
 };
 #endif
 
 } // namespace forte
 
-#endif // _conventional_integrals_h_
+#endif // _distribute_df_integrals_h_
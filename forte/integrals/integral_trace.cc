@@ -0,0 +1,151 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <numeric>
+
+#include "psi4/libpsi4util/PsiOutStream.h"
+
+#include "integral_trace.h"
+
+using namespace psi;
+
+namespace forte {
+
+namespace {
+thread_local std::string trace_label;
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' or c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+} // namespace
+
+IntegralTrace::IntegralTrace(const std::string& integral_type, const std::string& filename)
+    : integral_type_(integral_type), filename_(filename) {}
+
+IntegralTrace::~IntegralTrace() {
+    try {
+        print_summary();
+        if (not filename_.empty()) {
+            write_summary(filename_);
+        }
+    } catch (...) {
+        // never throw from a destructor
+    }
+}
+
+const std::string& IntegralTrace::label() { return trace_label; }
+
+void IntegralTrace::set_label(const std::string& label) { trace_label = label; }
+
+void IntegralTrace::record(const char* function, const std::vector<size_t>& shape,
+                           double seconds) {
+    size_t nelements =
+        std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = entries_[std::make_tuple(trace_label, std::string(function), shape)];
+    entry.calls += 1;
+    entry.bytes += nelements * sizeof(double);
+    entry.seconds += seconds;
+}
+
+void IntegralTrace::record_cache(const std::string& cache, bool hit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& counts = caches_[cache];
+    if (hit) {
+        counts.first += 1;
+    } else {
+        counts.second += 1;
+    }
+}
+
+void IntegralTrace::print_summary(size_t max_entries) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<Key, Entry>> sorted(entries_.begin(), entries_.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.second.seconds > b.second.seconds; });
+
+    outfile->Printf("\n\n  ==> Integral requests (%s) <==\n", integral_type_.c_str());
+    outfile->Printf("\n    %-32s %-30s %-20s %10s %12s %10s", "Call site", "Function", "Shape",
+                    "Calls", "MB", "Time (s)");
+    outfile->Printf("\n    %s", std::string(119, '-').c_str());
+    for (size_t n = 0; n < std::min(max_entries, sorted.size()); n++) {
+        const auto& [key, entry] = sorted[n];
+        std::string shape;
+        for (size_t d : std::get<2>(key)) {
+            shape += (shape.empty() ? "" : "x") + std::to_string(d);
+        }
+        const std::string& site = std::get<0>(key);
+        outfile->Printf("\n    %-32s %-30s %-20s %10zu %12.3f %10.3f",
+                        site.empty() ? "-" : site.c_str(), std::get<1>(key).c_str(),
+                        shape.c_str(), entry.calls, entry.bytes / 1048576.0, entry.seconds);
+    }
+    for (const auto& [cache, counts] : caches_) {
+        size_t total = counts.first + counts.second;
+        outfile->Printf("\n    Cache %-26s hits: %zu misses: %zu hit rate: %.1f%%", cache.c_str(),
+                        counts.first, counts.second,
+                        total > 0 ? 100.0 * counts.first / total : 0.0);
+    }
+    outfile->Printf("\n");
+}
+
+void IntegralTrace::write_summary(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream file(filename);
+    file << "{\n  \"integral_type\": " << json_string(integral_type_) << ",\n  \"requests\": [";
+    bool first = true;
+    for (const auto& [key, entry] : entries_) {
+        file << (first ? "\n" : ",\n") << "    {\"label\": " << json_string(std::get<0>(key))
+             << ", \"function\": " << json_string(std::get<1>(key)) << ", \"shape\": [";
+        const auto& shape = std::get<2>(key);
+        for (size_t i = 0; i < shape.size(); i++) {
+            file << (i > 0 ? ", " : "") << shape[i];
+        }
+        file << "], \"calls\": " << entry.calls << ", \"bytes\": " << entry.bytes
+             << ", \"seconds\": " << entry.seconds << "}";
+        first = false;
+    }
+    file << "\n  ],\n  \"caches\": [";
+    first = true;
+    for (const auto& [cache, counts] : caches_) {
+        file << (first ? "\n" : ",\n") << "    {\"name\": " << json_string(cache)
+             << ", \"hits\": " << counts.first << ", \"misses\": " << counts.second << "}";
+        first = false;
+    }
+    file << "\n  ]\n}\n";
+}
+
+} // namespace forte
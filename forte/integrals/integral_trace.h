@@ -0,0 +1,139 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _integral_trace_h_
+#define _integral_trace_h_
+
+#include <chrono>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace forte {
+
+/**
+ * @brief Statistics of the integral requests made to a ForteIntegrals object
+ *
+ * Each request is keyed by the call site label (see IntegralTraceLabel), the integral function,
+ * and the shape of the block. For each key the number of calls, the number of bytes returned,
+ * and the wall time are accumulated. Hits and misses of the integral caches are also counted.
+ * The summary is printed and written to a JSON file when the object is destroyed.
+ */
+class IntegralTrace {
+  public:
+    /**
+     * @param integral_type a label for the integral type
+     * @param filename the JSON file written at the end of the job
+     */
+    IntegralTrace(const std::string& integral_type, const std::string& filename);
+    ~IntegralTrace();
+
+    /// Record one request of a block of the given shape that took seconds
+    void record(const char* function, const std::vector<size_t>& shape, double seconds);
+    /// Record a hit or a miss of a cache
+    void record_cache(const std::string& cache, bool hit);
+
+    /// Print the most expensive requests to the output file
+    void print_summary(size_t max_entries = 20) const;
+    /// Write all the statistics to a JSON file
+    void write_summary(const std::string& filename) const;
+
+    /// @return the call site label of this thread
+    static const std::string& label();
+    /// Set the call site label of this thread
+    static void set_label(const std::string& label);
+
+  private:
+    struct Entry {
+        size_t calls = 0;
+        size_t bytes = 0;
+        double seconds = 0.0;
+    };
+    using Key = std::tuple<std::string, std::string, std::vector<size_t>>;
+
+    std::string integral_type_;
+    std::string filename_;
+    mutable std::mutex mutex_;
+    std::map<Key, Entry> entries_;
+    /// cache name -> (hits, misses)
+    std::map<std::string, std::pair<size_t, size_t>> caches_;
+};
+
+/**
+ * @brief Times one integral request and records it when it goes out of scope
+ *
+ * Does nothing if trace is nullptr, so it can be left in the integral classes.
+ */
+class IntegralTraceScope {
+  public:
+    IntegralTraceScope(IntegralTrace* trace, const char* function,
+                       std::initializer_list<size_t> shape)
+        : trace_(trace), function_(function) {
+        if (trace_) {
+            shape_ = shape;
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~IntegralTraceScope() {
+        if (trace_) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+            trace_->record(function_, shape_, elapsed.count());
+        }
+    }
+
+  private:
+    IntegralTrace* trace_;
+    const char* function_;
+    std::vector<size_t> shape_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Label the integral requests made by this thread while in scope
+ *
+ * Usage:
+ *   IntegralTraceLabel label("SA_MRPT2::compute_Hbar0_CCVV");
+ *   auto V = ints->three_integral_block(...);
+ */
+class IntegralTraceLabel {
+  public:
+    IntegralTraceLabel(const std::string& label) : previous_(IntegralTrace::label()) {
+        IntegralTrace::set_label(label);
+    }
+    ~IntegralTraceLabel() { IntegralTrace::set_label(previous_); }
+
+  private:
+    std::string previous_;
+};
+
+} // namespace forte
+
+#endif // _integral_trace_h_
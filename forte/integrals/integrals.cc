@@ -33,6 +33,7 @@
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/wavefunction.h"
 #include "psi4/libmints/matrix.h"
+#include "psi4/libqt/qt.h"
 
 #include "helpers/blockedtensorfactory.h"
 #include "base_classes/forte_options.h"
@@ -40,6 +41,7 @@
 #include "helpers/printing.h"
 #include "helpers/timer.h"
 #include "integrals.h"
+#include "integral_trace.h"
 #include "memory.h"
 
 #ifdef HAVE_GA
@@ -85,6 +87,12 @@ ForteIntegrals::ForteIntegrals(std::shared_ptr<ForteOptions> options,
 void ForteIntegrals::common_initialize() {
     read_information();
 
+    if (options_->get_bool("INTEGRAL_TRACE")) {
+        trace_ = std::make_shared<IntegralTrace>(int_type_label[integral_type_],
+                                                 options_->get_str("INTEGRAL_TRACE_FILE"));
+    }
+    block_cache_max_ = static_cast<size_t>(options_->get_int("APTEI_BLOCK_CACHE_MB")) << 20;
+
     if (not skip_build_) {
         allocate();
     }
@@ -152,11 +160,17 @@ double ForteIntegrals::nuclear_repulsion_energy() const { return nucrep_; }
 
 std::shared_ptr<psi::Wavefunction> ForteIntegrals::wfn() { return wfn_; }
 
-std::shared_ptr<psi::JK> ForteIntegrals::jk() { return JK_; }
+std::shared_ptr<psi::JK> ForteIntegrals::jk() {
+    jk_restore();
+    return JK_;
+}
 
 ForteIntegrals::JKStatus ForteIntegrals::jk_status() { return JK_status_; }
 
 void ForteIntegrals::jk_finalize() {
+    // keep the AO DF/CD tensors of JK for the next Fock builds (e.g., relaxation, MCSCF)
+    if (options_->get_bool("JK_KEEP_ALIVE"))
+        return;
     if (JK_status_ == JKStatus::initialized) {
         JK_->finalize();
         // nothing done in finalize() for PKJK and MemDFJK
@@ -500,12 +514,71 @@ void ForteIntegrals::rotate_orbitals(std::shared_ptr<psi::Matrix> Ua,
     update_orbitals(Ca_rotated, Cb_rotated);
 }
 
+ambit::Tensor ForteIntegrals::cached_aptei_block(int spin, const std::vector<size_t>& p,
+                                                 const std::vector<size_t>& q,
+                                                 const std::vector<size_t>& r,
+                                                 const std::vector<size_t>& s,
+                                                 const std::function<ambit::Tensor()>& build) {
+    if (block_cache_max_ == 0) {
+        return build();
+    }
+
+    BlockCacheKey key{spin, {p, q, r, s}};
+    {
+        std::lock_guard<std::mutex> lock(block_cache_mutex_);
+        auto it = block_cache_map_.find(key);
+        if (trace_)
+            trace_->record_cache("aptei_blocks", it != block_cache_map_.end());
+        if (it != block_cache_map_.end()) {
+            block_cache_.splice(block_cache_.begin(), block_cache_, it->second);
+            return it->second->second.clone();
+        }
+    }
+
+    // build outside of the lock, blocks are independent of each other
+    ambit::Tensor block = build();
+    size_t bytes = block.numel() * sizeof(double);
+    if (bytes > block_cache_max_) {
+        return block;
+    }
+
+    std::lock_guard<std::mutex> lock(block_cache_mutex_);
+    if (block_cache_map_.count(key) == 0) {
+        while (block_cache_size_ + bytes > block_cache_max_) {
+            auto& last = block_cache_.back();
+            block_cache_size_ -= last.second.numel() * sizeof(double);
+            block_cache_map_.erase(last.first);
+            block_cache_.pop_back();
+        }
+        block_cache_.emplace_front(key, block);
+        block_cache_map_[key] = block_cache_.begin();
+        block_cache_size_ += bytes;
+    }
+    return block.clone();
+}
+
+void ForteIntegrals::clear_block_cache() {
+    std::lock_guard<std::mutex> lock(block_cache_mutex_);
+    block_cache_.clear();
+    block_cache_map_.clear();
+    block_cache_size_ = 0;
+}
+
 // The following functions throw an error by default
 
 void ForteIntegrals::update_orbitals(std::shared_ptr<psi::Matrix>, std::shared_ptr<psi::Matrix>) {
     _undefined_function("update_orbitals");
 }
 
+void ForteIntegrals::jk_initialize(double, int) { _undefined_function("jk_initialize"); }
+
+void ForteIntegrals::jk_restore() {
+    if (JK_status_ == JKStatus::finalized) {
+        outfile->Printf("\n  JK object had beed finalized. JK is about to be initialized.\n");
+        jk_initialize(0.7);
+    }
+}
+
 void ForteIntegrals::compute_frozen_one_body_operator() {
     _undefined_function("compute_frozen_one_body_operator");
 }
@@ -528,6 +601,68 @@ ambit::Tensor ForteIntegrals::three_integral_block_two_index(const std::vector<s
     return ambit::Tensor();
 }
 
+bool ForteIntegrals::rotate_two_electron_integrals(const std::vector<double>&) { return false; }
+
+std::tuple<psi::SharedMatrix, psi::SharedMatrix, double>
+ForteIntegrals::make_fock_inactive_active_restricted(psi::Dimension dim_start,
+                                                     psi::Dimension dim_end, psi::SharedMatrix D) {
+    auto fock_closed = make_fock_inactive(dim_start, dim_end);
+    auto F_active = make_fock_active_restricted(D);
+    return std::make_tuple(std::get<0>(fock_closed), F_active, std::get<2>(fock_closed));
+}
+
+void ForteIntegrals::rotate_three_index(psi::Matrix& B, size_t n, const std::vector<double>& U) {
+    const size_t nQ = B.coldim();
+
+    // the orbitals changed by the rotation
+    std::vector<size_t> changed;
+    for (size_t q = 0; q < n; ++q) {
+        for (size_t p = 0; p < n; ++p) {
+            if (std::fabs(U[p * n + q] - (p == q ? 1.0 : 0.0)) > 1.0e-12) {
+                changed.push_back(q);
+                break;
+            }
+        }
+    }
+    const size_t nc = changed.size();
+    if (nc == 0)
+        return;
+
+    std::vector<double> Uc(n * nc);
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t i = 0; i < nc; ++i) {
+            Uc[r * nc + i] = U[r * n + changed[i]];
+        }
+    }
+    double* Bp = B.pointer()[0];
+
+    // first index: B(pq|Q) <- sum_r U(r, p) B(rq|Q) for the changed p
+    {
+        std::vector<double> X(nc * n * nQ);
+        C_DGEMM('T', 'N', nc, n * nQ, n, 1.0, Uc.data(), nc, Bp, n * nQ, 0.0, X.data(), n * nQ);
+        for (size_t i = 0; i < nc; ++i) {
+            std::copy_n(X.data() + i * n * nQ, n * nQ, Bp + changed[i] * n * nQ);
+        }
+    }
+
+    // second index: B(pq|Q) <- sum_s U(s, q) B(ps|Q) for the changed q
+#pragma omp parallel
+    {
+        std::vector<double> Y(nc * nQ);
+#pragma omp for
+        for (size_t p = 0; p < n; ++p) {
+            double* Bpq = Bp + p * n * nQ;
+            C_DGEMM('T', 'N', nc, nQ, n, 1.0, Uc.data(), nc, Bpq, nQ, 0.0, Y.data(), nQ);
+            for (size_t i = 0; i < nc; ++i) {
+                std::copy_n(Y.data() + i * nQ, nQ, Bpq + changed[i] * nQ);
+            }
+        }
+    }
+}
+
+void ForteIntegrals::set_three_integral_block_sequence(
+    const std::vector<std::array<std::vector<size_t>, 3>>&) {}
+
 double** ForteIntegrals::three_integral_pointer() {
     _undefined_function("three_integral_pointer");
     return nullptr;
@@ -30,6 +30,11 @@
 #ifndef _integrals_h_
 #define _integrals_h_
 
+#include <array>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
 #include <vector>
 
 #include "psi4/libfock/jk.h"
@@ -50,6 +55,7 @@ class BasisSet;
 namespace forte {
 
 class ForteOptions;
+class IntegralTrace;
 class MOSpaceInfo;
 
 /**
@@ -145,14 +151,14 @@ class ForteIntegrals {
     /// temporary solution for not having a Wavefunction
     std::shared_ptr<psi::Wavefunction> wfn();
 
-    /// Return the Pis4 JK object
+    /// Return the Psi4 JK object, initialized again if it had been finalized
     std::shared_ptr<psi::JK> jk();
 
     /// Enum class for the status of Pis4 JK
     enum class JKStatus { empty, initialized, finalized };
     /// Return the status of Psi4 JK object
     JKStatus jk_status();
-    /// Finalize Psi4 JK object
+    /// Finalize Psi4 JK object (skipped if JK_KEEP_ALIVE is set)
     void jk_finalize();
 
     // The number of symmetry-adapted orbitals
@@ -254,6 +260,17 @@ class ForteIntegrals {
     virtual ambit::Tensor three_integral_block_two_index(const std::vector<size_t>& A, size_t p,
                                                          const std::vector<size_t>&);
 
+    /**
+     * @brief Declare the blocks that the next calls of three_integral_block will request
+     *
+     * Backends that read the three-index integrals from disk use this list to read the next
+     * block while the caller works on the current one. Calls that do not match the head of the
+     * list are served synchronously. The default implementation does nothing.
+     * @param blocks the {A, p, q} index lists of the blocks, in the order they will be requested
+     */
+    virtual void set_three_integral_block_sequence(
+        const std::vector<std::array<std::vector<size_t>, 3>>& blocks);
+
     /// Expert Option: just try and use three_integral
     virtual double** three_integral_pointer();
 
@@ -293,6 +310,16 @@ class ForteIntegrals {
     virtual std::tuple<psi::SharedMatrix, psi::SharedMatrix>
     make_fock_active_unrestricted(psi::SharedMatrix Da, psi::SharedMatrix Db) = 0;
 
+    /// Make the closed-shell and the active Fock matrices (restricted) in MO basis
+    /// @param dim_start Dimension for the starting index (per irrep) of closed-shell orbitals
+    /// @param dim_end Dimension for the ending index (per irrep) of closed-shell orbitals
+    /// @param D The spin-summed 1RDM in psi::SharedMatrix form
+    /// @return closed-shell Fock, active Fock, and closed-shell energy
+    /// The default implementation calls make_fock_inactive and make_fock_active_restricted.
+    virtual std::tuple<psi::SharedMatrix, psi::SharedMatrix, double>
+    make_fock_inactive_active_restricted(psi::Dimension dim_start, psi::Dimension dim_end,
+                                         psi::SharedMatrix D);
+
     /// Set Fock matrix
     void set_fock_matrix(psi::SharedMatrix fa, psi::SharedMatrix fb);
 
@@ -354,6 +381,9 @@ class ForteIntegrals {
 
     virtual int ga_handle();
 
+    /// @return the integral request statistics (nullptr unless INTEGRAL_TRACE is set)
+    IntegralTrace* integral_trace() const { return trace_.get(); }
+
     /// Print the details of the integral transformation
     void print_info();
     /// Print the one- and two-electron integrals to the output
@@ -485,6 +515,22 @@ class ForteIntegrals {
     double int_mem_;
     /// Control printing of timings
     int print_ = 1;
+    /// Statistics of the integral requests, written at the end of the job (optional)
+    std::shared_ptr<IntegralTrace> trace_;
+
+    /// The key of a cached antisymmetrized block: (spin case, {p, q, r, s} indices)
+    using BlockCacheKey = std::pair<int, std::array<std::vector<size_t>, 4>>;
+    /// Maximum memory (in bytes) used by the cache of antisymmetrized blocks (0 = disabled)
+    size_t block_cache_max_ = 0;
+    /// Memory (in bytes) currently used by the cache of antisymmetrized blocks
+    size_t block_cache_size_ = 0;
+    /// The cached blocks, the front of the list is the most recently used
+    std::list<std::pair<BlockCacheKey, ambit::Tensor>> block_cache_;
+    /// Map from a key to its position in block_cache_
+    std::map<BlockCacheKey, std::list<std::pair<BlockCacheKey, ambit::Tensor>>::iterator>
+        block_cache_map_;
+    /// Guards the block cache
+    std::mutex block_cache_mutex_;
 
     /// The One Electron Integrals (T + V) in SO Basis
     std::shared_ptr<psi::Matrix> OneBody_symm_;
@@ -538,6 +584,41 @@ class ForteIntegrals {
     /// Remove the doubly occupied and virtual orbitals and resort the rest so
     /// that we are left only with ncmo = nmo - nfzc - nfzv
     virtual void resort_integrals_after_freezing() = 0;
+
+    /**
+     * @brief Apply an orbital rotation to the stored two-electron integrals, if supported
+     * @param U the rotation of the aptei_idx_ orbitals (row-major, new orbital q =
+     *        sum_p U(p, q) old orbital p)
+     * @return true if the integrals were rotated, false if they must be recomputed
+     */
+    virtual bool rotate_two_electron_integrals(const std::vector<double>& U);
+
+    /**
+     * @brief Rotate a three-index tensor stored as B(pq|Q) with pq = p * n + q
+     *
+     * B(pq|Q) <- sum_{rs} U(r, p) U(s, q) B(rs|Q), done with DGEMMs only for the orbitals
+     * p with U(*, p) different from the unit vector.
+     */
+    void rotate_three_index(psi::Matrix& B, size_t n, const std::vector<double>& U);
+
+    /**
+     * @brief Return an antisymmetrized block from the LRU cache or build and store it
+     * @param spin the spin case (0 = aa, 1 = ab, 2 = bb)
+     * @param build a function that computes the block when it is not cached
+     * @return a copy of the block that the caller is free to modify
+     */
+    ambit::Tensor cached_aptei_block(int spin, const std::vector<size_t>& p,
+                                     const std::vector<size_t>& q, const std::vector<size_t>& r,
+                                     const std::vector<size_t>& s,
+                                     const std::function<ambit::Tensor()>& build);
+
+    /// Drop all the cached antisymmetrized blocks (called when the integrals change)
+    void clear_block_cache();
+
+    /// Call JK intialize
+    virtual void jk_initialize(double mem_percentage = 0.8, int print_level = 1);
+    /// Initialize the JK object again if it had been finalized
+    void jk_restore();
 };
 
 /**
@@ -567,6 +648,11 @@ class Psi4Integrals : public ForteIntegrals {
     std::tuple<psi::SharedMatrix, psi::SharedMatrix>
     make_fock_active_unrestricted(psi::SharedMatrix Da, psi::SharedMatrix Db) override;
 
+    /// Make the closed-shell and the active Fock matrices with a single JK build
+    std::tuple<psi::SharedMatrix, psi::SharedMatrix, double>
+    make_fock_inactive_active_restricted(psi::Dimension dim_start, psi::Dimension dim_end,
+                                         psi::SharedMatrix D) override;
+
   private:
     void base_initialize_psi4();
     void setup_psi4_ints();
@@ -576,6 +662,10 @@ class Psi4Integrals : public ForteIntegrals {
     //    void rotate_orbitals(std::shared_ptr<psi::Matrix> Ua, std::shared_ptr<psi::Matrix> Ub)
     //    override;
     void update_orbitals(std::shared_ptr<psi::Matrix> Ca, std::shared_ptr<psi::Matrix> Cb) override;
+    /// Rotate the stored integrals by U = C_old^T S C_new instead of recomputing them
+    /// @return false if the backend cannot do it or the rotation mixes frozen and correlated
+    ///         orbitals, in which case nothing was changed
+    bool update_integrals_incremental(const psi::Matrix& U);
     void rotate_mos() override;
     std::vector<std::shared_ptr<psi::Matrix>> mo_dipole_ints(const bool& alpha,
                                                              const bool& resort) override;
@@ -586,12 +676,68 @@ class Psi4Integrals : public ForteIntegrals {
     /// Make a shared pointer to a Psi4 JK object
     void make_psi4_JK();
     /// Call JK intialize
-    void jk_initialize(double mem_percentage = 0.8, int print_level = 1);
+    void jk_initialize(double mem_percentage = 0.8, int print_level = 1) override;
 
     /// AO Fock control
     enum class FockAOStatus { none, inactive, generalized };
     FockAOStatus fock_ao_level_ = FockAOStatus::none;
 
+    /**
+     * Fock matrices kept for reuse (FOCK_CACHE). They depend on the orbitals only through the
+     * AO densities, which do not change when the orbitals are rotated within their spaces (as
+     * in semicanonicalization). A cached MO matrix F is then moved to the new orbitals as
+     * U^T F U with U = C_old^T S C_new.
+     */
+    struct FockCache {
+        /// AO densities the matrices were built from (empty if nothing is cached)
+        std::vector<psi::SharedMatrix> D;
+        /// Orbitals of the MO matrices
+        psi::SharedMatrix Ca, Cb;
+        /// MO matrices (Fb is Fa if they were built as the same matrix)
+        psi::SharedMatrix Fa, Fb;
+        /// AO Fock matrices of wfn_ after the build (Fb_ao is null if wfn_ shares them)
+        psi::SharedMatrix Fa_ao, Fb_ao;
+        /// AO Fock level of wfn_ after the build
+        FockAOStatus ao_level = FockAOStatus::none;
+        /// Energy returned with the matrices
+        double energy = 0.0;
+    };
+    /// Cache of the generalized Fock matrix built by make_fock_matrix
+    FockCache fock_cache_;
+    /// Cache of the closed-shell Fock matrix built by make_fock_inactive
+    FockCache fock_inactive_cache_;
+
+    /// @return C[:, start:start+dim] g C[:, start:start+dim]^T, or without g if it is null
+    psi::SharedMatrix ao_density(psi::SharedMatrix C, const psi::Dimension& start,
+                                 const psi::Dimension& dim, psi::SharedMatrix g = nullptr);
+    /// Fill the cache with the current matrices, the current orbitals, and the AO Fock of wfn_
+    void store_fock_cache(FockCache& cache, std::vector<psi::SharedMatrix> D, psi::SharedMatrix Fa,
+                          psi::SharedMatrix Fb, double energy);
+    /**
+     * @brief Look up the cache for the AO densities D
+     * @return false if the cache was built for other densities; otherwise true, with Fa and Fb
+     *         moved to the current orbitals and the AO Fock of wfn_ restored
+     */
+    bool load_fock_cache(FockCache& cache, const std::vector<psi::SharedMatrix>& D,
+                         psi::SharedMatrix& Fa, psi::SharedMatrix& Fb);
+
+    /// @return true if the active Fock matrix should be built from the MO three-index integrals
+    bool use_three_index_fock() const;
+    /**
+     * @brief Build Coulomb and exchange matrices in the MO basis from the three-index integrals
+     * @param Dj the active density used for the Coulomb matrix
+     * @param Dk the active densities used for the exchange matrices
+     * @return {J[Dj], K[Dk[0]], K[Dk[1]], ...}, where J_pq = sum_uv (pq|uv) D_uv and
+     *         K_pq = sum_uv (pu|qv) D_uv
+     *
+     * The auxiliary index is processed in batches that fit in memory and the contractions are
+     * done with DGEMV/DGEMM calls over each batch. This is shared by all the DF/CD classes.
+     */
+    std::vector<psi::SharedMatrix> three_index_jk(psi::SharedMatrix Dj,
+                                                  const std::vector<psi::SharedMatrix>& Dk);
+    /// Add the contribution of an MO-basis active Fock matrix to the AO Fock stored in wfn_
+    void add_active_fock_to_ao(psi::SharedMatrix Fa, psi::SharedMatrix Fb);
+
   protected:
     void freeze_core_orbitals() override;
 }; // namespace forte
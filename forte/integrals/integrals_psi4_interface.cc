@@ -26,6 +26,8 @@
  * @END LICENSE
  */
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
@@ -39,6 +41,7 @@
 #include "psi4/libmints/molecule.h"
 #include "psi4/libmints/wavefunction.h"
 #include "psi4/libpsi4util/process.h"
+#include "psi4/libqt/qt.h"
 
 #include "base_classes/mo_space_info.h"
 #include "helpers/printing.h"
@@ -260,6 +263,14 @@ void Psi4Integrals::compute_frozen_one_body_operator() {
 
 void Psi4Integrals::update_orbitals(std::shared_ptr<psi::Matrix> Ca,
                                     std::shared_ptr<psi::Matrix> Cb) {
+    clear_block_cache();
+
+    // 0. The rotation from the old to the new orbitals, used to update the integrals in place
+    std::shared_ptr<psi::Matrix> U;
+    if (options_->get_bool("INCREMENTAL_ORBITAL_UPDATE") and
+        spin_restriction_ == IntegralSpinRestriction::Restricted) {
+        U = psi::linalg::triplet(Ca_, wfn_->S(), Ca, true, false, false);
+    }
 
     // 1. Copy orbitals and, if necessary, test they meet the spin restriction condition
     Ca_->copy(Ca);
@@ -280,6 +291,9 @@ void Psi4Integrals::update_orbitals(std::shared_ptr<psi::Matrix> Ca,
     wfn_->Cb()->copy(Cb_);
 
     // 3. Re-transform the integrals
+    if (U and update_integrals_incremental(*U)) {
+        return;
+    }
     aptei_idx_ = nmo_;
     transform_one_electron_integrals();
     int my_proc = 0;
@@ -295,6 +309,69 @@ void Psi4Integrals::update_orbitals(std::shared_ptr<psi::Matrix> Ca,
     }
 }
 
+bool Psi4Integrals::update_integrals_incremental(const psi::Matrix& U) {
+    local_timer int_timer;
+
+    // the rotation of the correlated orbitals (frozen orbitals must not mix with them)
+    std::vector<int> mo_irrep(nmo_);
+    std::vector<int> mo_relative(nmo_);
+    for (int h = 0, p = 0; h < nirrep_; ++h) {
+        for (int i = 0; i < nmopi_[h]; ++i, ++p) {
+            mo_irrep[p] = h;
+            mo_relative[p] = i;
+        }
+    }
+    auto U_mo = [&](size_t p, size_t q) {
+        int h = mo_irrep[p];
+        return h == mo_irrep[q] ? U.get(h, mo_relative[p], mo_relative[q]) : 0.0;
+    };
+
+    const size_t n = aptei_idx_;
+    std::vector<size_t> cmotomo(n);
+    for (size_t p = 0; p < n; ++p) {
+        cmotomo[p] = (n == ncmo_) ? cmotomo_[p] : p;
+    }
+    std::vector<bool> correlated(nmo_, false);
+    for (size_t p : cmotomo) {
+        correlated[p] = true;
+    }
+
+    const double tolerance = 1.0e-10;
+    for (size_t p = 0; p < nmo_; ++p) {
+        for (size_t q = 0; q < nmo_; ++q) {
+            if (correlated[p] != correlated[q] and std::fabs(U_mo(p, q)) > tolerance)
+                return false;
+        }
+    }
+    std::vector<double> Uc(n * n);
+    for (size_t p = 0; p < n; ++p) {
+        for (size_t q = 0; q < n; ++q) {
+            Uc[p * n + q] = U_mo(cmotomo[p], cmotomo[q]);
+        }
+    }
+    // U must be orthogonal, i.e., the new orbitals span the space of the old ones
+    for (size_t p = 0; p < n; ++p) {
+        for (size_t q = 0; q < n; ++q) {
+            double overlap = 0.0;
+            for (size_t r = 0; r < n; ++r) {
+                overlap += Uc[r * n + p] * Uc[r * n + q];
+            }
+            if (std::fabs(overlap - (p == q ? 1.0 : 0.0)) > tolerance)
+                return false;
+        }
+    }
+
+    if (not rotate_two_electron_integrals(Uc))
+        return false;
+
+    transform_one_electron_integrals();
+    if (ncmo_ < nmo_) {
+        compute_frozen_one_body_operator();
+    }
+    outfile->Printf("\n  Integrals rotated in place in %9.3f s.", int_timer.get());
+    return true;
+}
+
 void Psi4Integrals::freeze_core_orbitals() {
     local_timer freeze_timer;
     if (ncmo_ < nmo_) {
@@ -440,8 +517,35 @@ Psi4Integrals::dipole_ints_mo_helper(std::shared_ptr<psi::Matrix> Cao, psi::Shar
 }
 
 void Psi4Integrals::make_fock_matrix(ambit::Tensor gamma_a, ambit::Tensor gamma_b) {
-    // build inactive Fock
     auto rdoccpi = mo_space_info_->dimension("INACTIVE_DOCC");
+
+    // AO densities that determine the Fock matrices
+    std::vector<psi::SharedMatrix> D;
+    bool use_cache = options_->get_bool("FOCK_CACHE");
+    if (use_cache) {
+        auto nactvpi = mo_space_info_->dimension("ACTIVE");
+        auto nactv = mo_space_info_->size("ACTIVE");
+        auto zero = psi::Dimension(nirrep_);
+        for (const auto& [C, gamma] :
+             {std::make_pair(Ca_, gamma_a), std::make_pair(Cb_, gamma_b)}) {
+            auto g1 = std::make_shared<psi::Matrix>("1RDM", nactvpi, nactvpi);
+            const auto& data = gamma.data();
+            for (int h = 0, offset = 0; h < nirrep_; ++h) {
+                for (int i = 0; i < nactvpi[h]; ++i) {
+                    for (int j = 0; j < nactvpi[h]; ++j) {
+                        g1->set(h, i, j, data[(i + offset) * nactv + j + offset]);
+                    }
+                }
+                offset += nactvpi[h];
+            }
+            D.push_back(ao_density(C, zero, rdoccpi));
+            D.push_back(ao_density(C, rdoccpi, nactvpi, g1));
+        }
+        if (load_fock_cache(fock_cache_, D, fock_a_, fock_b_))
+            return;
+    }
+
+    // build inactive Fock
     auto fock_closed = make_fock_inactive(psi::Dimension(nirrep_), rdoccpi);
 
     // build active Fock
@@ -463,6 +567,9 @@ void Psi4Integrals::make_fock_matrix(ambit::Tensor gamma_a, ambit::Tensor gamma_
         fock_b_->add(std::get<1>(fock_active));
         fock_b_->set_name("Fock beta");
     }
+
+    if (use_cache)
+        store_fock_cache(fock_cache_, D, fock_a_, fock_b_, 0.0);
 }
 
 std::tuple<psi::SharedMatrix, psi::SharedMatrix, double>
@@ -474,12 +581,20 @@ Psi4Integrals::make_fock_inactive(psi::Dimension dim_start, psi::Dimension dim_e
      *
      * u,v,r,s: AO indices; i: MO indices
      */
-    if (JK_status_ == JKStatus::finalized) {
-        outfile->Printf("\n  JK object had beed finalized. JK is about to be initialized.\n");
-        jk_initialize(0.7);
+    auto dim = dim_end - dim_start;
+
+    std::vector<psi::SharedMatrix> D;
+    bool use_cache = options_->get_bool("FOCK_CACHE");
+    if (use_cache) {
+        D.push_back(ao_density(Ca_, dim_start, dim));
+        if (spin_restriction_ != IntegralSpinRestriction::Restricted)
+            D.push_back(ao_density(Cb_, dim_start, dim));
+        psi::SharedMatrix Fa, Fb;
+        if (load_fock_cache(fock_inactive_cache_, D, Fa, Fb))
+            return std::make_tuple(Fa, Fb, fock_inactive_cache_.energy);
     }
 
-    auto dim = dim_end - dim_start;
+    jk_restore();
 
     if (spin_restriction_ == IntegralSpinRestriction::Restricted) {
         auto Csub = std::make_shared<psi::Matrix>("Ca_sub", nsopi_, dim);
@@ -521,6 +636,9 @@ Psi4Integrals::make_fock_inactive(psi::Dimension dim_start, psi::Dimension dim_e
             fock_ao_level_ = FockAOStatus::inactive;
         }
 
+        if (use_cache)
+            store_fock_cache(fock_inactive_cache_, D, F_closed, F_closed, e_closed);
+
         return std::make_tuple(F_closed, F_closed, e_closed);
     } else {
         auto Ca_sub = std::make_shared<psi::Matrix>("Ca_sub", nsopi_, dim);
@@ -582,6 +700,9 @@ Psi4Integrals::make_fock_inactive(psi::Dimension dim_start, psi::Dimension dim_e
             fock_ao_level_ = FockAOStatus::inactive;
         }
 
+        if (use_cache)
+            store_fock_cache(fock_inactive_cache_, D, Fa_closed, Fb_closed, e_closed);
+
         return std::make_tuple(Fa_closed, Fb_closed, e_closed);
     }
 }
@@ -658,11 +779,18 @@ std::tuple<psi::SharedMatrix, psi::SharedMatrix> Psi4Integrals::make_fock_active
 }
 
 psi::SharedMatrix Psi4Integrals::make_fock_active_restricted(psi::SharedMatrix g1) {
-    if (JK_status_ == JKStatus::finalized) {
-        outfile->Printf("\n  JK object had beed finalized. JK is about to be initialized.\n");
-        jk_initialize(0.7);
+    if (use_three_index_fock()) {
+        // F_active = J[g1] - 0.5 K[g1]
+        auto JK = three_index_jk(g1, {g1});
+        auto F_active = JK[0];
+        F_active->axpy(-0.5, JK[1]);
+        F_active->set_name("Fock_active");
+        add_active_fock_to_ao(F_active, F_active);
+        return F_active;
     }
 
+    jk_restore();
+
     auto nactvpi = mo_space_info_->dimension("ACTIVE");
     auto ndoccpi = mo_space_info_->dimension("INACTIVE_DOCC");
 
@@ -707,13 +835,106 @@ psi::SharedMatrix Psi4Integrals::make_fock_active_restricted(psi::SharedMatrix g
     return F_active;
 }
 
+std::tuple<psi::SharedMatrix, psi::SharedMatrix, double>
+Psi4Integrals::make_fock_inactive_active_restricted(psi::Dimension dim_start,
+                                                    psi::Dimension dim_end, psi::SharedMatrix g1) {
+    /* Same as make_fock_inactive followed by make_fock_active_restricted, but the closed-shell
+     * and the active densities are passed to a single JK build:
+     *   C_left = {C_closed, C_actv}, C_right = {C_closed, C_actv * g1}
+     * such that the AO integrals (or the DF three-index integrals) are traversed only once.
+     */
+    if (spin_restriction_ != IntegralSpinRestriction::Restricted or use_three_index_fock() or
+        options_->get_bool("FOCK_CACHE")) {
+        return ForteIntegrals::make_fock_inactive_active_restricted(dim_start, dim_end, g1);
+    }
+
+    jk_restore();
+
+    auto dim = dim_end - dim_start;
+    auto nactvpi = mo_space_info_->dimension("ACTIVE");
+    auto ndoccpi = mo_space_info_->dimension("INACTIVE_DOCC");
+
+    // grab sub-blocks of Ca
+    auto Csub = std::make_shared<psi::Matrix>("Ca_sub", nsopi_, dim);
+    auto Cactv = std::make_shared<psi::Matrix>("Ca_actv", nsopi_, nactvpi);
+
+    for (int h = 0; h < nirrep_; ++h) {
+        for (int p = 0, offset = dim_start[h]; p < dim[h]; ++p) {
+            Csub->set_column(h, p, Ca_->get_column(h, p + offset));
+        }
+        for (int p = 0, offset = ndoccpi[h]; p < nactvpi[h]; ++p) {
+            Cactv->set_column(h, p, Ca_->get_column(h, p + offset));
+        }
+    }
+
+    // dress Cactv by one-density, which will the C_right for JK
+    auto Cactv_dressed = psi::linalg::doublet(Cactv, g1, false, false);
+
+    // JK build
+    JK_->set_do_K(true);
+    std::vector<std::shared_ptr<psi::Matrix>>& Cls = JK_->C_left();
+    std::vector<std::shared_ptr<psi::Matrix>>& Crs = JK_->C_right();
+    Cls.clear();
+    Crs.clear();
+
+    Cls.push_back(Csub);
+    Crs.push_back(Csub);
+    Cls.push_back(Cactv);
+    Crs.push_back(Cactv_dressed);
+
+    JK_->compute();
+
+    // closed-shell part: 2J - K + H
+    auto J = JK_->J()[0];
+    J->scale(2.0);
+    J->subtract(JK_->K()[0]);
+    J->add(wfn_->H());
+
+    auto F_closed = psi::linalg::triplet(Ca_, J, Ca_, true, false, false);
+    F_closed->set_name("Fock_closed");
+
+    // active part: J - 0.5 K
+    auto K = JK_->K()[1];
+    K->scale(-0.5);
+    K->add(JK_->J()[1]);
+
+    auto F_active = psi::linalg::triplet(Ca_, K, Ca_, true, false, false);
+    F_active->set_name("Fock_active");
+
+    // compute closed-shell energy
+    J->add(wfn_->H());
+    double e_closed = J->vector_dot(psi::linalg::doublet(Csub, Csub, false, true));
+
+    // pass AO fock to psi4 Wavefunction
+    if (wfn_->Fa() != nullptr) {
+        wfn_->Fa()->copy(J);
+        wfn_->Fa()->add(K);
+        wfn_->Fb() = wfn_->Fa();
+        fock_ao_level_ = FockAOStatus::generalized;
+    }
+
+    return std::make_tuple(F_closed, F_active, e_closed);
+}
+
 std::tuple<psi::SharedMatrix, psi::SharedMatrix>
 Psi4Integrals::make_fock_active_unrestricted(psi::SharedMatrix g1a, psi::SharedMatrix g1b) {
-    if (JK_status_ == JKStatus::finalized) {
-        outfile->Printf("\n  JK object had beed finalized. JK is about to be initialized.\n");
-        jk_initialize(0.7);
+    if (use_three_index_fock()) {
+        // F_active(sigma) = J[g1a + g1b] - K[g1(sigma)]
+        auto g1 = g1a->clone();
+        g1->add(g1b);
+        auto JK = three_index_jk(g1, {g1a, g1b});
+        auto Fa_active = JK[0]->clone();
+        Fa_active->subtract(JK[1]);
+        Fa_active->set_name("Fock_active alpha");
+        auto Fb_active = JK[0];
+        Fb_active->subtract(JK[2]);
+        Fb_active->set_name("Fock_active beta");
+        add_active_fock_to_ao(Fa_active, Fb_active);
+        return {Fa_active, Fb_active};
     }
 
+    jk_restore();
+
     auto nactvpi = mo_space_info_->dimension("ACTIVE");
     auto ndoccpi = mo_space_info_->dimension("INACTIVE_DOCC");
 
@@ -778,4 +999,206 @@ Psi4Integrals::make_fock_active_unrestricted(psi::SharedMatrix g1a, psi::SharedM
 
     return {Fa_active, Fb_active};
 }
+bool Psi4Integrals::use_three_index_fock() const {
+    if (options_->get_str("ACTIVE_FOCK_BUILD") != "THREE_INDEX")
+        return false;
+    if (integral_type_ != DF and integral_type_ != DiskDF and integral_type_ != Cholesky)
+        return false;
+    // the three-index integrals must span all the MOs with the same alpha and beta orbitals,
+    // and the AO Fock must be recoverable from the MO one (no linear dependencies)
+    if (spin_restriction_ != IntegralSpinRestriction::Restricted or frzcpi_.sum() > 0 or
+        frzvpi_.sum() > 0 or aptei_idx_ != nmo_)
+        return false;
+    if (fock_ao_level_ == FockAOStatus::inactive and nsopi_ != nmopi_)
+        return false;
+    return true;
+}
+
+std::vector<psi::SharedMatrix>
+Psi4Integrals::three_index_jk(psi::SharedMatrix Dj, const std::vector<psi::SharedMatrix>& Dk) {
+    const auto actv = mo_space_info_->corr_absolute_mo("ACTIVE");
+    const auto nactvpi = mo_space_info_->dimension("ACTIVE");
+    const size_t nactv = actv.size();
+    const size_t n = nmo_;
+    const size_t n2 = n * n;
+    const size_t nQ = nthree();
+    const size_t nK = Dk.size();
+
+    // unpack the densities into nactv x nactv matrices in the order of actv
+    auto unpack = [&](const psi::SharedMatrix& D) {
+        std::vector<double> d(nactv * nactv, 0.0);
+        for (int h = 0, offset = 0; h < nirrep_; ++h) {
+            for (int u = 0; u < nactvpi[h]; ++u) {
+                for (int v = 0; v < nactvpi[h]; ++v) {
+                    d[(u + offset) * nactv + v + offset] = D->get(h, u, v);
+                }
+            }
+            offset += nactvpi[h];
+        }
+        return d;
+    };
+    std::vector<double> dj = unpack(Dj);
+    std::vector<std::vector<double>> dk;
+    for (const auto& D : Dk) {
+        dk.push_back(unpack(D));
+    }
+
+    // size the batches of auxiliary functions to use a quarter of the memory
+    const size_t batch_mem = (n2 + (2 + nK) * n * nactv + 1) * sizeof(double);
+    const size_t memory = psi::Process::environment.get_memory() / 4;
+    const size_t batch_size = std::max(size_t(1), std::min(nQ, memory / batch_mem));
+
+    std::vector<double> J(n2, 0.0);
+    std::vector<std::vector<double>> K(nK, std::vector<double>(n2, 0.0));
+    std::vector<size_t> all(n);
+    std::iota(all.begin(), all.end(), 0);
+    std::vector<double> dQ, Bt, Y, Yt;
+    for (size_t Q0 = 0; Q0 < nQ; Q0 += batch_size) {
+        const size_t nb = std::min(batch_size, nQ - Q0);
+        std::vector<size_t> Qvec(nb);
+        std::iota(Qvec.begin(), Qvec.end(), Q0);
+        ambit::Tensor B = three_integral_block(Qvec, all, all);
+        const auto& Bd = B.data();
+
+        // J_pq += sum_Q B^Q_pq d_Q with d_Q = sum_uv B^Q_uv D_uv
+        dQ.assign(nb, 0.0);
+#pragma omp parallel for
+        for (size_t Q = 0; Q < nb; ++Q) {
+            double sum = 0.0;
+            for (size_t u = 0; u < nactv; ++u) {
+                for (size_t v = 0; v < nactv; ++v) {
+                    sum += Bd[Q * n2 + actv[u] * n + actv[v]] * dj[u * nactv + v];
+                }
+            }
+            dQ[Q] = sum;
+        }
+        C_DGEMV('T', nb, n2, 1.0, const_cast<double*>(Bd.data()), n2, dQ.data(), 1, 1.0, J.data(),
+                1);
+
+        if (nK == 0)
+            continue;
+
+        // Bt[q][Q][v] = B^Q_qv for active v
+        Bt.resize(n * nb * nactv);
+#pragma omp parallel for
+        for (size_t q = 0; q < n; ++q) {
+            for (size_t Q = 0; Q < nb; ++Q) {
+                for (size_t v = 0; v < nactv; ++v) {
+                    Bt[(q * nb + Q) * nactv + v] = Bd[Q * n2 + q * n + actv[v]];
+                }
+            }
+        }
+        // K_pq += sum_Qv (sum_u B^Q_pu D_uv) B^Q_qv = [Bt D] Bt^T
+        Y.resize(n * nb * nactv);
+        for (size_t k = 0; k < nK; ++k) {
+            C_DGEMM('N', 'N', n * nb, nactv, nactv, 1.0, Bt.data(), nactv, dk[k].data(), nactv,
+                    0.0, Y.data(), nactv);
+            C_DGEMM('N', 'T', n, n, nb * nactv, 1.0, Y.data(), nb * nactv, Bt.data(), nb * nactv,
+                    1.0, K[k].data(), n);
+        }
+    }
+
+    // pack the results into symmetry-blocked matrices
+    auto pack = [&](const std::vector<double>& M, const std::string& name) {
+        auto F = std::make_shared<psi::Matrix>(name, nmopi_, nmopi_);
+        for (int h = 0, offset = 0; h < nirrep_; ++h) {
+            for (int p = 0; p < nmopi_[h]; ++p) {
+                for (int q = 0; q < nmopi_[h]; ++q) {
+                    F->set(h, p, q, M[(p + offset) * n + q + offset]);
+                }
+            }
+            offset += nmopi_[h];
+        }
+        return F;
+    };
+    std::vector<psi::SharedMatrix> result{pack(J, "J active")};
+    for (size_t k = 0; k < nK; ++k) {
+        result.push_back(pack(K[k], "K active"));
+    }
+    return result;
+}
+
+void Psi4Integrals::add_active_fock_to_ao(psi::SharedMatrix Fa, psi::SharedMatrix Fb) {
+    if (fock_ao_level_ != FockAOStatus::inactive)
+        return;
+    // C^T S C = 1, so the AO matrix is S C F C^T S
+    auto S = wfn_->S();
+    auto SCa = psi::linalg::doublet(S, Ca_, false, false);
+    auto Fa_ao = psi::linalg::triplet(SCa, Fa, SCa, false, false, true);
+    if (wfn_->Fa() == wfn_->Fb()) {
+        if (Fb != Fa) {
+            Fa_ao->add(psi::linalg::triplet(SCa, Fb, SCa, false, false, true));
+            Fa_ao->scale(0.5);
+        }
+        wfn_->Fa()->add(Fa_ao);
+    } else {
+        wfn_->Fa()->add(Fa_ao);
+        wfn_->Fb()->add(psi::linalg::triplet(SCa, Fb, SCa, false, false, true));
+    }
+    fock_ao_level_ = FockAOStatus::generalized;
+}
+
+psi::SharedMatrix Psi4Integrals::ao_density(psi::SharedMatrix C, const psi::Dimension& start,
+                                            const psi::Dimension& dim, psi::SharedMatrix g) {
+    auto Csub = std::make_shared<psi::Matrix>("C_sub", nsopi_, dim);
+    for (int h = 0; h < nirrep_; ++h) {
+        for (int p = 0; p < dim[h]; ++p) {
+            Csub->set_column(h, p, C->get_column(h, p + start[h]));
+        }
+    }
+    if (g == nullptr)
+        return psi::linalg::doublet(Csub, Csub, false, true);
+    return psi::linalg::triplet(Csub, g, Csub, false, false, true);
+}
+
+void Psi4Integrals::store_fock_cache(FockCache& cache, std::vector<psi::SharedMatrix> D,
+                                     psi::SharedMatrix Fa, psi::SharedMatrix Fb, double energy) {
+    cache.D = std::move(D);
+    cache.Ca = Ca_->clone();
+    cache.Cb = Cb_->clone();
+    cache.Fa = Fa->clone();
+    cache.Fb = (Fb == Fa) ? cache.Fa : Fb->clone();
+    cache.Fa_ao = cache.Fb_ao = nullptr;
+    if (wfn_->Fa() != nullptr) {
+        cache.Fa_ao = wfn_->Fa()->clone();
+        if (wfn_->Fb() != wfn_->Fa())
+            cache.Fb_ao = wfn_->Fb()->clone();
+    }
+    cache.ao_level = fock_ao_level_;
+    cache.energy = energy;
+}
+
+bool Psi4Integrals::load_fock_cache(FockCache& cache, const std::vector<psi::SharedMatrix>& D,
+                                    psi::SharedMatrix& Fa, psi::SharedMatrix& Fb) {
+    if (cache.D.size() != D.size())
+        return false;
+    for (size_t i = 0, n = D.size(); i < n; ++i) {
+        auto diff = D[i]->clone();
+        diff->subtract(cache.D[i]);
+        if (diff->absmax() > 1.0e-12)
+            return false;
+    }
+
+    // U = C_old^T S C_new is the rotation within the MO space, so F_new = U^T F_old U
+    auto rotate = [&](psi::SharedMatrix C_old, psi::SharedMatrix C_new, psi::SharedMatrix F) {
+        auto U = psi::linalg::triplet(C_old, wfn_->S(), C_new, true, false, false);
+        auto F_new = psi::linalg::triplet(U, F, U, true, false, false);
+        F_new->set_name(F->name());
+        return F_new;
+    };
+    Fa = rotate(cache.Ca, Ca_, cache.Fa);
+    Fb = (cache.Fb == cache.Fa) ? Fa : rotate(cache.Cb, Cb_, cache.Fb);
+
+    // the AO Fock matrices of wfn_ do not depend on the orbitals
+    if (cache.Fa_ao != nullptr and wfn_->Fa() != nullptr) {
+        wfn_->Fa()->copy(cache.Fa_ao);
+        if (cache.Fb_ao == nullptr) {
+            wfn_->Fb() = wfn_->Fa();
+        } else {
+            wfn_->Fb()->copy(cache.Fb_ao);
+        }
+        fock_ao_level_ = cache.ao_level;
+    }
+    return true;
+}
 } // namespace forte
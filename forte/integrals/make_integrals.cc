@@ -32,12 +32,14 @@
 #include "base_classes/forte_options.h"
 #include "helpers/timer.h"
 #include "helpers/string_algorithms.h"
+#include "helpers/fcidump.h"
 #include "integrals/integrals.h"
 #include "integrals/cholesky_integrals.h"
 #include "integrals/custom_integrals.h"
 #include "integrals/df_integrals.h"
 #include "integrals/diskdf_integrals.h"
 #include "integrals/conventional_integrals.h"
+#include "integrals/distribute_df_integrals.h"
 
 #include "make_integrals.h"
 
@@ -64,9 +66,10 @@ make_forte_integrals_from_psi4(std::shared_ptr<psi::Wavefunction> ref_wfn,
     } else if (int_type == "DISKDF") {
         ints = std::make_shared<DISKDFIntegrals>(options, ref_wfn, mo_space_info,
                                                  IntegralSpinRestriction::Restricted);
-    } else if (int_type == "CONVENTIONAL") {
+    } else if (int_type == "CONVENTIONAL" or int_type == "INCORE") {
         ints = std::make_shared<ConventionalIntegrals>(options, ref_wfn, mo_space_info,
-                                                       IntegralSpinRestriction::Restricted);
+                                                       IntegralSpinRestriction::Restricted,
+                                                       int_type == "INCORE");
     } else if (int_type == "DISTDF") {
 #ifdef HAVE_GA
         ints = std::make_shared<DistDFIntegrals>(options, ref_wfn, mo_space_info,
@@ -74,7 +77,7 @@ make_forte_integrals_from_psi4(std::shared_ptr<psi::Wavefunction> ref_wfn,
 #endif
     } else {
         psi::outfile->Printf("\n Please check your int_type. Choices are CHOLESKY, DF, DISKDF , "
-                             "DISTRIBUTEDDF, or CONVENTIONAL");
+                             "DISTRIBUTEDDF, CONVENTIONAL, or INCORE");
         throw std::runtime_error("INT_TYPE is not correct.  Check options");
     }
 
@@ -97,4 +100,31 @@ make_custom_forte_integrals(std::shared_ptr<ForteOptions> options,
                                              oei_b, tei_aa, tei_ab, tei_bb);
 }
 
+std::shared_ptr<ForteIntegrals>
+make_custom_forte_integrals_from_fcidump(std::shared_ptr<ForteOptions> options,
+                                         std::shared_ptr<MOSpaceInfo> mo_space_info,
+                                         const FCIDUMP& fcidump) {
+    // unpack the integrals and go from chemists' to antisymmetrized physicists' notation
+    const size_t n = fcidump.norb();
+    const size_t n2 = n * n;
+    std::vector<double> tei_aa(n2 * n2), tei_ab(n2 * n2);
+#pragma omp parallel for collapse(2)
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            for (size_t k = 0; k < n; k++) {
+                for (size_t l = 0; l < n; l++) {
+                    // <ij||kl> = (ik|jl) - (il|jk)
+                    size_t ijkl = i * n * n2 + j * n2 + k * n + l;
+                    double direct = fcidump.eri(i, k, j, l);
+                    tei_ab[ijkl] = direct;
+                    tei_aa[ijkl] = direct - fcidump.eri(i, l, j, k);
+                }
+            }
+        }
+    }
+    return std::make_shared<CustomIntegrals>(
+        options, mo_space_info, IntegralSpinRestriction::Restricted, fcidump.enuc(),
+        fcidump.hcore(), fcidump.hcore(), tei_aa, tei_ab, tei_aa);
+}
+
 } // namespace forte
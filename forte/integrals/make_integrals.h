@@ -31,6 +31,9 @@
 #define _make_integrals_h_
 
 namespace forte {
+
+class FCIDUMP;
+
 /**
  *  @brief Make a ForteIntegrals object with the help of psi4
  *
@@ -52,6 +55,14 @@ make_custom_forte_integrals(std::shared_ptr<ForteOptions> options,
                             const std::vector<double>& tei_aa, const std::vector<double>& tei_ab,
                             const std::vector<double>& tei_bb);
 
+/**
+ *  @brief Make a ForteIntegrals object from the integrals read from a FCIDUMP file
+ */
+std::shared_ptr<ForteIntegrals>
+make_custom_forte_integrals_from_fcidump(std::shared_ptr<ForteOptions> options,
+                                         std::shared_ptr<MOSpaceInfo> mo_space_info,
+                                         const FCIDUMP& fcidump);
+
 } // namespace forte
 
 #endif // _make_integrals_h_
@@ -51,6 +51,7 @@
 #include <macdecls.h>
 #endif
 
+using namespace psi;
 
 namespace forte {
 
@@ -79,29 +80,6 @@ void ParallelDFMO::transform_integrals() {
     nthread = omp_get_max_threads();
 #endif
 
-    // > Maximum orbital sizes < //
-
-    size_t max1 = nmo_;
-    size_t max12 = max1 * max1;
-
-    // > Row requirements < //
-
-    unsigned long int per_row = 0L;
-    // (Q|mn)
-    per_row += nso * (unsigned long int)nso;
-    // (Q|mi)
-    per_row += max1 * (unsigned long int)nso;
-    // (Q|ia)
-    per_row += max12;
-
-    // > Maximum number of rows < //
-
-    unsigned long int max_rows = (memory_ / per_row);
-    // max_rows = 3L * auxiliary_->max_function_per_shell(); // Debug
-    if (max_rows < auxiliary_->max_function_per_shell()) {
-        throw psi::PSIEXCEPTION("Out of memory in DFERI.");
-    }
-    max_rows = (max_rows > auxiliary_->nbf() ? auxiliary_->nbf() : max_rows);
     int shell_per_process = 0;
     int shell_start = -1;
     int shell_end = -1;
@@ -109,11 +87,7 @@ void ParallelDFMO::transform_integrals() {
     int my_rank = GA_Nodeid();
     int num_proc = GA_Nnodes();
 
-    if (auxiliary_->nbf() == max_rows) {
-        shell_per_process = auxiliary_->nshell() / num_proc;
-    } else {
-        throw psi::PSIEXCEPTION("Have not implemented memory bound df integrals");
-    }
+    shell_per_process = auxiliary_->nshell() / num_proc;
     /// Have first proc be from 0 to shell_per_process
     /// Last proc is shell_per_process * my_rank to naux
     if (my_rank != (num_proc - 1)) {
@@ -149,7 +123,7 @@ void ParallelDFMO::transform_integrals() {
     int dims[2];
     int chunk[2];
     dims[0] = naux;
-    dims[1] = nso * nso;
+    dims[1] = nmo_ * nmo_;
     chunk[0] = GA_Nnodes();
     chunk[1] = 1;
     int map[GA_Nnodes() + 1];
@@ -198,136 +172,155 @@ void ParallelDFMO::transform_integrals() {
     const std::vector<std::pair<int, int>>& shell_pairs = sieve->shell_pairs();
     long int nshell_pairs = (long int)shell_pairs.size();
 
-    // => Temporary Tensors <= //
+    // => Batches of auxiliary shells <= //
+
+    // Each batch needs two (A|mn) buffers (one is filled while the other is transformed) and
+    // one (A|pq) buffer. Every thread also has its own (mi) scratch.
+    size_t nso2 = nso * static_cast<size_t>(nso);
+    size_t nmo2 = nmo_ * nmo_;
+    size_t per_row = 2 * nso2 + nmo2;
+    size_t scratch = nthread * nso * nmo_;
+    size_t memory_doubles = memory_ / sizeof(double);
+    if (memory_doubles < scratch + per_row * auxiliary_->max_function_per_shell()) {
+        throw psi::PSIEXCEPTION("Out of memory in ParallelDFMO.");
+    }
+    size_t max_rows = (memory_doubles - scratch) / per_row;
+
+    auto function_offset = [&](int P) {
+        return P == auxiliary_->nshell() ? naux : auxiliary_->shell(P).function_index();
+    };
+
+    std::vector<int> batch_shells{shell_start};
+    size_t batch_rows = 0;
+    for (int P = shell_start; P < shell_end; P++) {
+        size_t np = auxiliary_->shell(P).nfunction();
+        if (batch_rows + np > max_rows) {
+            batch_shells.push_back(P);
+            batch_rows = 0;
+        }
+        batch_rows += np;
+    }
+    batch_shells.push_back(shell_end);
+    size_t nbatch = batch_shells.size() - 1;
+
+    size_t max_batch_rows = 0;
+    for (size_t b = 0; b < nbatch; b++) {
+        size_t rows = function_offset(batch_shells[b + 1]) - function_offset(batch_shells[b]);
+        max_batch_rows = std::max(max_batch_rows, rows);
+    }
 
-    // > Three-index buffers < //
-    std::shared_ptr<psi::Matrix> Amn(new psi::Matrix("(A|mn)", max_rows, nso * (unsigned long int)nso));
-    std::shared_ptr<psi::Matrix> Ami(new psi::Matrix("(A|mi)", max_rows, nso * (unsigned long int)max1));
-    std::shared_ptr<psi::Matrix> Aia(new psi::Matrix("(A|ia)", naux, max12));
-    double** Amnp = Amn->pointer();
-    double** Amip = Ami->pointer();
-    double** Aiap = Aia->pointer();
+    // => Buffers <= //
 
-    // > C-matrix weirdness < //
+    std::vector<std::vector<double>> Amn(2, std::vector<double>(max_batch_rows * nso2));
+    std::vector<double> Aia(max_batch_rows * nmo2);
+    std::vector<std::vector<double>> Ami(nthread, std::vector<double>(nso * nmo_));
 
     double** Cp = Ca_->pointer();
     int lda = nmo_;
 
-    //// ==> Master Loop <== //
+    // ==> Pipelined loop <== //
 
-    int Aia_begin[2];
-    int Aia_end[2];
-    /// SIMD
-    /// shell_start represents the start of shells for this processor
-    /// shell_end represents the end of shells for this processor
-    /// NOTE:  This code will have terrible load balance (shells do not
-    /// correspond to equal number of functions
+    // Step b computes the (A|mn) integrals of batch b while the (A|mn) of batch b - 1 are
+    // transformed to (A|pq) and written to the GA. The first ntransform threads start on the
+    // transformation, the other threads on the ERIs, and each side helps the other when done.
+    // NOTE: the shells are divided among the processes, the load balance is not perfect
+    int ntransform = std::max(1, nthread / 4);
     local_timer compute_Aia;
-    {
-        int Pstart = shell_start;
-        int Pstop = shell_end;
-        int nPshell = Pstop - Pstart;
-        int pstart = auxiliary_->shell(Pstart).function_index();
-        int pstop = (Pstop == auxiliary_->nshell() ? auxiliary_->nbf()
-                                                   : auxiliary_->shell(Pstop).function_index());
-        int rows = pstop - pstart;
+    for (size_t b = 0; b <= nbatch; b++) {
+        bool compute = b < nbatch;
+        bool transform = b > 0;
 
-        // > (Q|mn) ERIs < //
+        int Pstart = compute ? batch_shells[b] : 0;
+        int Pstop = compute ? batch_shells[b + 1] : 0;
+        long int nPshell = Pstop - Pstart;
+        int pstart = compute ? function_offset(Pstart) : 0;
+        size_t rows = compute ? function_offset(Pstop) - pstart : 0;
+        double* Amn_new = Amn[b % 2].data();
 
-        ::memset((void*)Amnp[0], '\0', sizeof(double) * rows * nso * nso);
+        int pstart_old = transform ? function_offset(batch_shells[b - 1]) : 0;
+        size_t rows_old = transform ? function_offset(batch_shells[b]) - pstart_old : 0;
+        const double* Amn_old = Amn[(b + 1) % 2].data();
 
-#pragma omp parallel for schedule(dynamic) num_threads(nthread)
-        for (long int PMN = 0L; PMN < nPshell * nshell_pairs; PMN++) {
+        std::fill(Amn_new, Amn_new + rows * nso2, 0.0);
 
+        long int neri = nPshell * nshell_pairs;
+        std::atomic<long int> next_eri(0);
+        std::atomic<size_t> next_row(0);
+
+#pragma omp parallel num_threads(nthread)
+        {
             int thread = 0;
 #ifdef _OPENMP
             thread = omp_get_thread_num();
 #endif
-
-            int P = PMN / nshell_pairs + Pstart;
-            int MN = PMN % nshell_pairs;
-            std::pair<int, int> pair = shell_pairs[MN];
-            int M = pair.first;
-            int N = pair.second;
-
-            eri[thread]->compute_shell(P, 0, M, N);
-
-            int nm = primary_->shell(M).nfunction();
-            int nn = primary_->shell(N).nfunction();
-            int np = auxiliary_->shell(P).nfunction();
-            int om = primary_->shell(M).function_index();
-            int on = primary_->shell(N).function_index();
-            int op = auxiliary_->shell(P).function_index();
-
-            const double* buffer = eri[thread]->buffer();
-
-            for (int p = 0; p < np; p++) {
-                for (int m = 0; m < nm; m++) {
-                    for (int n = 0; n < nn; n++) {
-                        Amnp[p + op - pstart][(m + om) * nso + (n + on)] =
-                            Amnp[p + op - pstart][(n + on) * nso + (m + om)] = (*buffer++);
+            // > (Q|mn) ERIs of one (P|MN) shell triplet < //
+            auto compute_eri = [&]() {
+                long int PMN = next_eri++;
+                if (PMN >= neri)
+                    return false;
+                int P = PMN / nshell_pairs + Pstart;
+                int MN = PMN % nshell_pairs;
+                int M = shell_pairs[MN].first;
+                int N = shell_pairs[MN].second;
+
+                eri[thread]->compute_shell(P, 0, M, N);
+
+                int nm = primary_->shell(M).nfunction();
+                int nn = primary_->shell(N).nfunction();
+                int np = auxiliary_->shell(P).nfunction();
+                int om = primary_->shell(M).function_index();
+                int on = primary_->shell(N).function_index();
+                int op = auxiliary_->shell(P).function_index();
+
+                const double* buffer = eri[thread]->buffer();
+
+                for (int p = 0; p < np; p++) {
+                    double* Ap = Amn_new + (p + op - pstart) * nso2;
+                    for (int m = 0; m < nm; m++) {
+                        for (int n = 0; n < nn; n++) {
+                            Ap[(m + om) * nso + (n + on)] = Ap[(n + on) * nso + (m + om)] =
+                                (*buffer++);
+                        }
                     }
                 }
+                return true;
+            };
+
+            // > (Q|pq) = C^T (Q|mn) C for one auxiliary function < //
+            auto transform_row = [&]() {
+                size_t Q = next_row++;
+                if (Q >= rows_old)
+                    return false;
+                double* Amip = Ami[thread].data();
+                C_DGEMM('N', 'N', nso, nmo_, nso, 1.0, const_cast<double*>(Amn_old) + Q * nso2,
+                        nso, Cp[0], lda, 0.0, Amip, nmo_);
+                C_DGEMM('T', 'N', nmo_, nmo_, nso, 1.0, Amip, nmo_, Cp[0], lda, 0.0,
+                        Aia.data() + Q * nmo2, nmo_);
+                return true;
+            };
+
+            if (thread < ntransform) {
+                while (transform_row()) {
+                }
+                while (compute_eri()) {
+                }
+            } else {
+                while (compute_eri()) {
+                }
+                while (transform_row()) {
+                }
             }
         }
 
-        // for (int ind1 = 0; ind1 < tasks.size(); ind1++) {
-
-        //    std::string space1 = pair_spaces_[tasks[ind1][0]].first;
-        //    int start1 = spaces_[space1].first;
-        //    int end1   = spaces_[space1].second;
-        //    int n1      = end1 - start1;
-        //    double* C1p = &Cp[0][start1];
-        int start1 = 0;
-        int end1 = nmo_;
-        int n1 = end1 - start1;
-        double* C1p = &Cp[0][start1];
-
-        C_DGEMM('N', 'N', rows * nso, n1, nso, 1.0, Amnp[0], nso, C1p, lda, 0.0, Amip[0], n1);
-
-        // for (int ind2 = 0; ind2 < tasks[ind1].size(); ind2++) {
-        // std::string space2 = pair_spaces_[tasks[ind1][ind2]].second;
-        // int start2 = spaces_[space2].first;
-        // int end2   = spaces_[space2].second;
-        // int n2      = end2 - start2;
-        // double* C2p = &Cp[0][start2];
-        int n2 = nmo_;
-        double* C2p = &Cp[0][0];
-
-        size_t n12 = n1 * (size_t)n2;
-        size_t no1 = nso * (size_t)n1;
-
-        // std::string name = tasks[ind1][ind2];
-        bool transpose12 = false;
-
-        if (transpose12) {
-#pragma omp parallel for num_threads(nthread)
-            for (int Q = 0; Q < rows; Q++) {
-                C_DGEMM('T', 'N', n2, n1, nso, 1.0, C2p, lda, Amip[0] + Q * no1, n1, 0.0,
-                        Aiap[0] + Q * n12, n1);
-            }
-        } else {
-#pragma omp parallel for num_threads(nthread)
-            for (int Q = 0; Q < rows; Q++) {
-                C_DGEMM('T', 'N', n1, n2, nso, 1.0, Amip[0] + Q * no1, n1, C2p, lda, 0.0,
-                        Aiap[0] + Q * n12, n2);
-            }
+        // > Write the (A|pq) tile of batch b - 1 directly into the GA < //
+        if (rows_old > 0) {
+            int lo[2] = {pstart_old, 0};
+            int hi[2] = {pstart_old + static_cast<int>(rows_old) - 1, static_cast<int>(nmo2) - 1};
+            int ld = nmo2;
+            NGA_Put(Aia_ga, lo, hi, Aia.data(), &ld);
         }
-
-        // Amn->print();
-        // Ami->print();
-        // Aia->print();
-
-        // std::shared_ptr<Tensor> A = ints_[name + "_temp"];
-        // FILE* fh = A->file_pointer();
-        // fwrite(Aiap[0],sizeof(double),rows*n12,fh);
-        int ld = nmo_ * nmo_;
-
-        NGA_Distribution(Aia_ga, GA_Nodeid(), Aia_begin, Aia_end);
-        NGA_Put(Aia_ga, Aia_begin, Aia_end, Aiap[0], &(ld));
-        //}
-        //}
     }
+    GA_Sync();
     printf("\n  P%d Aia took %8.6f s.", GA_Nodeid(), compute_Aia.get());
 
     local_timer J_one_half_time;
@@ -57,5 +57,4 @@ class ParallelDFMO {
     size_t memory_;
     size_t nmo_;
 };
-}
-}
+} // namespace forte
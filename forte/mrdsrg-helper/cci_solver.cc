@@ -7,7 +7,7 @@
 #include "cci_solver.h"
 #include "base_classes/active_space_solver.h"
 #include "base_classes/active_space_method.h"
-#include "base_classes/reference.h"
+#include "base_classes/rdms.h"
 #include "helpers/helpers.h"
 #include "integrals/active_space_integrals.h"
 
@@ -35,10 +35,13 @@ void ContractedCISolver::compute_Heff() {
         throw psi::PSIEXCEPTION("3-body integrals not implemented in ActiveSpaceIntegrals.");
     }
 
-    auto inner_product = [](std::vector<double>& vec1, std::vector<double>& vec2) {
+    auto inner_product = [](const std::vector<double>& vec1, const std::vector<double>& vec2) {
         return std::inner_product(vec1.begin(), vec1.end(), vec2.begin(), 0.0);
     };
 
+    double scalar_energy = as_ints_->nuclear_repulsion_energy() + as_ints_->scalar_energy() +
+                           as_ints_->frozen_core_energy();
+
     auto method_vec = as_solver_->get_method_vec();
     int i_state = 0;
     for (const auto& state_weights: as_solver_->get_state_weights_list()) {
@@ -53,36 +56,52 @@ void ContractedCISolver::compute_Heff() {
         print_h2("Building Effective Hamiltonian for " + state_name);
         psi::Matrix Heff("Heff " + state_name, nroots, nroots);
 
+        // compute the transition rdms <A|sqop|B> of all the pairs A <= B in one call
+        std::vector<std::pair<size_t, size_t>> root_list;
         for (int A = 0; A < nroots; ++A) {
             for (int B = A; B < nroots; ++B) {
-                // just compute transition rdms of <A|sqop|B>
-                std::vector<std::pair<size_t, size_t>> root_list{std::make_pair(A, B)};
-                RDMs rdms = method->reference(root_list)[0];
-
-                double H_AB = 0.0;
-                H_AB += inner_product(oei_a, rdms.g1a().data());
-                H_AB += inner_product(oei_b, rdms.g1b().data());
-
-                H_AB += 0.25 * inner_product(tei_aa, rdms.g2aa().data());
-                H_AB += 0.25 * inner_product(tei_bb, rdms.g2bb().data());
-                H_AB += inner_product(tei_ab, rdms.g2ab().data());
-
-                //                if (do_three_body) {
-                //                    H_AB += (1.0 / 36.0) * inner_product(tei_aaa,
-                //                    rdms.g3aaa().data()); H_AB += (1.0 / 36.0) *
-                //                    inner_product(tei_bbb, rdms.g3bbb().data()); H_AB += 0.25
-                //                    * inner_product(tei_aab, rdms.g3aab().data()); H_AB +=
-                //                    0.25 * inner_product(tei_abb, rdms.g3abb().data());
-                //                }
-
-                if (A == B) {
-                    H_AB += as_ints_->nuclear_repulsion_energy() + as_ints_->scalar_energy() +
-                            as_ints_->frozen_core_energy();
-                    Heff.set(A, B, H_AB);
-                } else {
-                    Heff.set(A, B, H_AB);
-                    Heff.set(B, A, H_AB);
-                }
+                root_list.emplace_back(A, B);
+            }
+        }
+        std::vector<RDMs> rdms_list = method->rdms(root_list, 2);
+
+        // form all the spin cases first (they may be built from g1a and g2ab with ambit)
+        int npairs = static_cast<int>(root_list.size());
+        std::vector<std::vector<ambit::Tensor>> rdms_blocks(npairs);
+        for (int n = 0; n < npairs; ++n) {
+            auto& rdms = rdms_list[n];
+            rdms_blocks[n] = {rdms.g1a(), rdms.g1b(), rdms.g2aa(), rdms.g2bb(), rdms.g2ab()};
+        }
+
+        // contract the rdms with the integrals, each pair is independent
+#pragma omp parallel for schedule(dynamic)
+        for (int n = 0; n < npairs; ++n) {
+            int A = root_list[n].first;
+            int B = root_list[n].second;
+            const auto& blocks = rdms_blocks[n];
+
+            double H_AB = 0.0;
+            H_AB += inner_product(oei_a, blocks[0].data());
+            H_AB += inner_product(oei_b, blocks[1].data());
+
+            H_AB += 0.25 * inner_product(tei_aa, blocks[2].data());
+            H_AB += 0.25 * inner_product(tei_bb, blocks[3].data());
+            H_AB += inner_product(tei_ab, blocks[4].data());
+
+            //                if (do_three_body) {
+            //                    H_AB += (1.0 / 36.0) * inner_product(tei_aaa,
+            //                    rdms.g3aaa().data()); H_AB += (1.0 / 36.0) *
+            //                    inner_product(tei_bbb, rdms.g3bbb().data()); H_AB += 0.25
+            //                    * inner_product(tei_aab, rdms.g3aab().data()); H_AB +=
+            //                    0.25 * inner_product(tei_abb, rdms.g3abb().data());
+            //                }
+
+            if (A == B) {
+                H_AB += scalar_energy;
+                Heff.set(A, B, H_AB);
+            } else {
+                Heff.set(A, B, H_AB);
+                Heff.set(B, A, H_AB);
             }
         }
 
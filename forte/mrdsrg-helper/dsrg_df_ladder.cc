@@ -0,0 +1,154 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "psi4/libqt/qt.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
+#include "dsrg_df_ladder.h"
+
+namespace forte {
+
+void df_pp_ladder(ambit::Tensor Br, ambit::Tensor Bs, ambit::Tensor T2, double alpha,
+                  ambit::Tensor C2, size_t max_memory) {
+    const auto& dims_r = Br.dims();
+    const auto& dims_s = Bs.dims();
+    const auto& dims_t = T2.dims();
+    size_t nL = dims_r[0], na = dims_r[1], nr = dims_r[2];
+    size_t nb = dims_s[1], ns = dims_s[2];
+    size_t no2 = dims_t[0] * dims_t[1];
+
+    if (nL * na * nb * nr * ns * no2 == 0) {
+        return;
+    }
+
+    const auto& Br_data = Br.data();
+    const auto& Bs_data = Bs.data();
+    const auto& T2_data = T2.data();
+    auto& C2_data = C2.data();
+
+    // pairs (ij) with nonzero amplitudes, pairs zeroed by screening are skipped
+    std::vector<size_t> pairs;
+    for (size_t ij = 0; ij < no2; ++ij) {
+        auto first = T2_data.begin() + ij * na * nb;
+        if (std::any_of(first, first + na * nb, [](double t) { return t != 0.0; })) {
+            pairs.push_back(ij);
+        }
+    }
+    size_t np = pairs.size();
+    if (np == 0) {
+        return;
+    }
+    bool compressed = np < no2;
+
+    // T2[(ij),a,b] -> Tt[a,(ij),b] for the nonzero pairs
+    std::vector<double> Tt(na * np * nb);
+#pragma omp parallel for
+    for (size_t p = 0; p < np; ++p) {
+        for (size_t a = 0; a < na; ++a) {
+            std::copy_n(T2_data.begin() + (pairs[p] * na + a) * nb, nb,
+                        Tt.begin() + (a * np + p) * nb);
+        }
+    }
+
+    // B[g,b,s] -> Bt[b,g,s]
+    std::vector<double> Bt(nb * nL * ns);
+#pragma omp parallel for
+    for (size_t g = 0; g < nL; ++g) {
+        for (size_t b = 0; b < nb; ++b) {
+            std::copy_n(Bs_data.begin() + (g * nb + b) * ns, ns, Bt.begin() + (b * nL + g) * ns);
+        }
+    }
+
+    // number of threads allowed by the per-thread intermediates
+    size_t nele_thread = np * nb * nL + nL * na + (compressed ? np * ns : 0);
+    size_t nthread_mem = std::max(max_memory / (nele_thread * sizeof(double)), size_t(1));
+    size_t nthread_max = static_cast<size_t>(omp_get_max_threads());
+    int nthread = static_cast<int>(std::min(nthread_max, nthread_mem));
+
+#pragma omp parallel num_threads(nthread)
+    {
+        std::vector<double> Bra(nL * na), X(np * nb * nL), Y(compressed ? np * ns : 0);
+
+#pragma omp for schedule(dynamic)
+        for (size_t r = 0; r < nr; ++r) {
+            // Bra[g,a] = B[g,a,r]
+            for (size_t g = 0; g < nL; ++g) {
+                for (size_t a = 0; a < na; ++a) {
+                    Bra[g * na + a] = Br_data[(g * na + a) * nr + r];
+                }
+            }
+
+            // X[(ij),b,g] = sum_{a} T2[(ij),a,b] * B[g,a,r]
+            C_DGEMM('T', 'T', np * nb, nL, na, 1.0, Tt.data(), np * nb, Bra.data(), na, 0.0,
+                    X.data(), nL);
+
+            // C2[(ij),r,s] += alpha * sum_{b,g} X[(ij),b,g] * B[g,b,s]
+            if (not compressed) {
+                C_DGEMM('N', 'N', no2, ns, nb * nL, alpha, X.data(), nb * nL, Bt.data(), ns, 1.0,
+                        C2_data.data() + r * ns, nr * ns);
+                continue;
+            }
+            C_DGEMM('N', 'N', np, ns, nb * nL, alpha, X.data(), nb * nL, Bt.data(), ns, 0.0,
+                    Y.data(), ns);
+            for (size_t p = 0; p < np; ++p) {
+                double* C2_ptr = C2_data.data() + (pairs[p] * nr + r) * ns;
+                for (size_t s = 0; s < ns; ++s) {
+                    C2_ptr[s] += Y[p * ns + s];
+                }
+            }
+        }
+    }
+}
+
+void df_pp_ladder(ambit::BlockedTensor& B, ambit::BlockedTensor& T2, double alpha,
+                  ambit::BlockedTensor& C2, size_t max_memory) {
+    for (const std::string& C2label : C2.block_labels()) {
+        for (const std::string& T2label : T2.block_labels()) {
+            if (T2label.substr(0, 2) != C2label.substr(0, 2))
+                continue;
+
+            std::string Brlabel{'L', T2label[2], C2label[2]};
+            std::string Bslabel{'L', T2label[3], C2label[3]};
+            if (not(B.is_block(Brlabel) and B.is_block(Bslabel)))
+                continue;
+
+            df_pp_ladder(B.block(Brlabel), B.block(Bslabel), T2.block(T2label), alpha,
+                         C2.block(C2label), max_memory);
+        }
+    }
+}
+} // namespace forte
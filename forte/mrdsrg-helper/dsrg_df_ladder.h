@@ -0,0 +1,63 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _dsrg_df_ladder_h_
+#define _dsrg_df_ladder_h_
+
+#include <cstddef>
+
+#include "ambit/blocked_tensor.h"
+
+namespace forte {
+
+/**
+ * Add the DF particle-particle ladder term to a block of C2
+ *   C2[ijrs] += alpha * sum_{g,a,b} B[gar] * B[gbs] * T2[ijab]
+ * without forming the four-index integrals (ar|bs).
+ * The r index is distributed over threads, each holding an intermediate of size ni*nj*nb*nL.
+ * @param Br the three-index block B[g,a,r]
+ * @param Bs the three-index block B[g,b,s]
+ * @param T2 the amplitude block T2[i,j,a,b]
+ * @param alpha the prefactor
+ * @param C2 the target block C2[i,j,r,s]
+ * @param max_memory the max memory (in bytes) for the per-thread intermediates
+ */
+void df_pp_ladder(ambit::Tensor Br, ambit::Tensor Bs, ambit::Tensor T2, double alpha,
+                  ambit::Tensor C2, size_t max_memory);
+
+/**
+ * Add the DF particle-particle ladder term to all blocks of C2
+ *   C2[ijrs] += alpha * sum_{g,a,b} B[gar] * B[gbs] * T2[ijab]
+ * where the sum runs over all T2 blocks sharing the "ij" labels of a C2 block.
+ * Only core tensors are supported.
+ */
+void df_pp_ladder(ambit::BlockedTensor& B, ambit::BlockedTensor& T2, double alpha,
+                  ambit::BlockedTensor& C2, size_t max_memory);
+} // namespace forte
+
+#endif // _dsrg_df_ladder_h_
@@ -92,6 +92,18 @@ size_t DSRG_MEM::compute_memory(const std::vector<std::string>& labels_vec, int
     return multiple * total;
 }
 
+size_t DSRG_MEM::max_batch_size(size_t mem_per_index, size_t mem_reserved, double fraction) {
+    if (mem_avai_ <= 0 or static_cast<size_t>(mem_avai_) <= mem_reserved or mem_per_index == 0) {
+        return 1;
+    }
+    size_t max_size = (mem_avai_ - mem_reserved) * fraction / mem_per_index;
+    return std::max(max_size, static_cast<size_t>(1));
+}
+
+void DSRG_MEM::add_plan_entry(const std::string& des, const std::string& choice) {
+    plan_.push_back(std::make_pair(des, choice));
+}
+
 void DSRG_MEM::print(const std::string& name) {
     print_h2(name + " Memory Information");
 
@@ -102,6 +114,10 @@ void DSRG_MEM::print(const std::string& name) {
                              xb_pair.second.c_str());
     }
 
+    for (const auto& pair : plan_) {
+        psi::outfile->Printf("\n    %-45s %10s", pair.first.c_str(), pair.second.c_str());
+    }
+
     auto max_local = max_local_memory();
     auto local_xb_pair = to_xb(max_local, 1);
     double local_value = local_xb_pair.first;
@@ -76,6 +76,23 @@ class DSRG_MEM {
     /// Compute the memory requirement of a given labels
     size_t compute_memory(const std::vector<std::string>& labels_vec, int multiple = 1);
 
+    /// Return true if mem_use bytes fit in the memory currently available
+    bool fits(size_t mem_use) {
+        return mem_avai_ > 0 and mem_use <= static_cast<size_t>(mem_avai_);
+    }
+
+    /**
+     * @brief Largest number of indices that can be processed in one batch
+     * @param mem_per_index the memory (in bytes) needed for each index of a batch
+     * @param mem_reserved the memory (in bytes) held back for other purposes
+     * @param fraction the fraction of the remaining memory used by the batch
+     * @return the batch size, at least 1
+     */
+    size_t max_batch_size(size_t mem_per_index, size_t mem_reserved = 0, double fraction = 0.8);
+
+    /// Record a decision of the memory plan, printed along with the memory information
+    void add_plan_entry(const std::string& des, const std::string& choice);
+
     /// Print the current data
     void print(const std::string& name);
 
@@ -91,6 +108,9 @@ class DSRG_MEM {
 
     /// Map from MO labels to sizes
     std::map<char, size_t> label_to_size_;
+
+    /// Decisions of the memory plan: description to choice
+    std::vector<std::pair<std::string, std::string>> plan_;
 };
 } // namespace forte
 
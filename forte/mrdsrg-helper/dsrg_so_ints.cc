@@ -0,0 +1,80 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <string>
+
+#include "integrals/integrals.h"
+
+#include "dsrg_so_ints.h"
+
+namespace forte {
+
+void fill_so_aptei(ambit::BlockedTensor& V, std::shared_ptr<ForteIntegrals> ints,
+                   const std::map<char, std::vector<size_t>>& space_mos) {
+    for (const std::string& block : V.block_labels()) {
+        const auto& p = space_mos.at(block[0]);
+        const auto& q = space_mos.at(block[1]);
+        const auto& r = space_mos.at(block[2]);
+        const auto& s = space_mos.at(block[3]);
+        size_t np = p.size(), nq = q.size(), nr = r.size(), ns = s.size();
+        if (np * nq * nr * ns == 0)
+            continue;
+
+        auto& vdata = V.block(block).data();
+        size_t d1 = 2 * nq, d2 = 2 * nr, d3 = 2 * ns;
+
+        // copy A into the spin block of V starting at (op,oq,or,os),
+        // where A is stored with p<->q and/or r<->s swapped if requested
+        auto scatter = [&](ambit::Tensor A, double sign, bool swap_pq, bool swap_rs, size_t op,
+                           size_t oq, size_t or_, size_t os) {
+            const auto& adata = A.data();
+            const auto& adims = A.dims();
+            for (size_t P = 0; P < np; ++P) {
+                for (size_t Q = 0; Q < nq; ++Q) {
+                    size_t a01 = swap_pq ? Q * adims[1] + P : P * adims[1] + Q;
+                    size_t v01 = (P + op) * d1 + Q + oq;
+                    for (size_t R = 0; R < nr; ++R) {
+                        for (size_t S = 0; S < ns; ++S) {
+                            size_t a = swap_rs ? (a01 * adims[2] + S) * adims[3] + R
+                                               : (a01 * adims[2] + R) * adims[3] + S;
+                            vdata[(v01 * d2 + R + or_) * d3 + S + os] = sign * adata[a];
+                        }
+                    }
+                }
+            }
+        };
+
+        scatter(ints->aptei_aa_block(p, q, r, s), 1.0, false, false, 0, 0, 0, 0);
+        scatter(ints->aptei_bb_block(p, q, r, s), 1.0, false, false, np, nq, nr, ns);
+        scatter(ints->aptei_ab_block(p, q, r, s), 1.0, false, false, 0, nq, 0, ns);
+        scatter(ints->aptei_ab_block(p, q, s, r), -1.0, false, true, 0, nq, nr, 0);
+        scatter(ints->aptei_ab_block(q, p, r, s), -1.0, true, false, np, 0, 0, ns);
+        scatter(ints->aptei_ab_block(q, p, s, r), 1.0, true, true, np, 0, nr, 0);
+    }
+}
+} // namespace forte
@@ -0,0 +1,57 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _dsrg_so_ints_h_
+#define _dsrg_so_ints_h_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "ambit/blocked_tensor.h"
+
+namespace forte {
+
+class ForteIntegrals;
+
+/**
+ * Fill a spin-orbital BlockedTensor with antisymmetrized two-electron integrals.
+ *
+ * Each elementary space of V is assumed to hold the alpha orbitals followed by the same
+ * orbitals with beta spin. Integrals are requested block by block through aptei_xx_block,
+ * so conventional, Cholesky and DF integrals are all handled by the integral class.
+ * Only core tensors are supported.
+ * @param V the spin-orbital two-electron tensor (zeroed on entry)
+ * @param ints the integral object
+ * @param space_mos the correlated MO indices (of one spin) of each elementary space label
+ */
+void fill_so_aptei(ambit::BlockedTensor& V, std::shared_ptr<ForteIntegrals> ints,
+                   const std::map<char, std::vector<size_t>>& space_mos);
+} // namespace forte
+
+#endif // _dsrg_so_ints_h_
@@ -26,6 +26,8 @@
  * @END LICENSE
  */
 
+#include <stdexcept>
+
 #include "dsrg_source.h"
 
 namespace forte {
@@ -33,6 +35,74 @@ namespace forte {
 DSRG_SOURCE::DSRG_SOURCE(double s, double taylor_threshold)
     : s_(s), taylor_threshold_(taylor_threshold) {}
 
+void DSRG_SOURCE::scale_block(double* data, const std::vector<size_t>& dims,
+                              const std::vector<std::vector<double>>& F, SourceScaling type) {
+    size_t rank = dims.size();
+    if (rank != 2 and rank != 4) {
+        throw std::runtime_error("DSRG_SOURCE::scale_block: only 2- and 4-index blocks");
+    }
+
+    size_t nlast = dims[rank - 1];
+    if (nlast == 0)
+        return;
+    size_t nrows = 1;
+    for (size_t n = 0; n < rank - 1; ++n) {
+        nrows *= dims[n];
+    }
+    const std::vector<double>& F_last = F[rank - 1];
+
+#pragma omp parallel
+    {
+        std::vector<double> D(nlast), f(nlast);
+
+#pragma omp for
+        for (size_t row = 0; row < nrows; ++row) {
+            double F_row;
+            if (rank == 2) {
+                F_row = F[0][row];
+            } else {
+                size_t i2 = row % dims[2];
+                size_t i1 = (row / dims[2]) % dims[1];
+                size_t i0 = row / (dims[1] * dims[2]);
+                F_row = F[0][i0] + F[1][i1] + F[2][i2];
+            }
+            for (size_t k = 0; k < nlast; ++k) {
+                D[k] = F_row + F_last[k];
+            }
+
+            double* v = data + row * nlast;
+            switch (type) {
+            case SourceScaling::RenormalizedDenominator:
+                compute_renormalized_denominator_batch(D.data(), f.data(), nlast);
+                break;
+            case SourceScaling::Renormalized:
+                compute_renormalized_batch(D.data(), f.data(), nlast);
+                break;
+            case SourceScaling::OnePlusRenormalized:
+                compute_renormalized_batch(D.data(), f.data(), nlast);
+                for (size_t k = 0; k < nlast; ++k) {
+                    f[k] += 1.0;
+                }
+                break;
+            case SourceScaling::Denominator:
+                for (size_t k = 0; k < nlast; ++k) {
+                    f[k] = D[k];
+                }
+                break;
+            case SourceScaling::InverseDenominator:
+                for (size_t k = 0; k < nlast; ++k) {
+                    f[k] = 1.0 / D[k];
+                }
+                break;
+            }
+
+            for (size_t k = 0; k < nlast; ++k) {
+                v[k] *= f[k];
+            }
+        }
+    }
+}
+
 STD_SOURCE::STD_SOURCE(double s, double taylor_threshold) : DSRG_SOURCE(s, taylor_threshold) {}
 
 LABS_SOURCE::LABS_SOURCE(double s, double taylor_threshold) : DSRG_SOURCE(s, taylor_threshold) {}
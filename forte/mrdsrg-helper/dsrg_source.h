@@ -29,11 +29,33 @@
 #ifndef _dsrg_source_h_
 #define _dsrg_source_h_
 
+#include <algorithm>
 #include <cmath>
-
+#include <cstddef>
+#include <vector>
 
 namespace forte {
 
+/// Return h(x) = [1 - exp(-x)] / x for x >= 0 without branches, so that loops calling it can
+/// be vectorized. The series is used for small x, where 1 - exp(-x) loses digits.
+#pragma omp declare simd
+inline double h_branch_free(double x) {
+    const double h_series =
+        1.0 - x * (0.5 - x * (1.0 / 6.0 - x * (1.0 / 24.0 - x * (1.0 / 120.0 - x / 720.0))));
+    const double x_safe = x < 1.0e-2 ? 1.0 : x;
+    const double h_exact = (1.0 - std::exp(-x_safe)) / x_safe;
+    return x < 1.0e-2 ? h_series : h_exact;
+}
+
+/// Factors of the source operator that DSRG_SOURCE::scale_block can apply
+enum class SourceScaling {
+    RenormalizedDenominator,
+    Renormalized,
+    OnePlusRenormalized,
+    Denominator,
+    InverseDenominator
+};
+
 class DSRG_SOURCE {
   public:
     /**
@@ -50,6 +72,45 @@ class DSRG_SOURCE {
     /// Renormalize denominator
     virtual double compute_renormalized_denominator(const double& D) = 0;
 
+    /// Compute r[i] = compute_renormalized(D[i]) for n denominators
+    virtual void compute_renormalized_batch(const double* D, double* r, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = compute_renormalized(D[i]);
+        }
+    }
+    /// Compute r[i] = compute_renormalized_denominator(D[i]) for n denominators
+    virtual void compute_renormalized_denominator_batch(const double* D, double* r, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = compute_renormalized_denominator(D[i]);
+        }
+    }
+
+    /**
+     * @brief Compute the second-order energy weights of n denominators
+     * @param D the denominators
+     * @param w on return w[i] = compute_renormalized_denominator(D[i]) *
+     *          (1 + compute_renormalized(D[i])), the factor of V^2 in E = <[V, T2]>
+     */
+    virtual void compute_energy_weights(const double* D, double* w, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            w[i] = compute_renormalized_denominator(D[i]) * (1.0 + compute_renormalized(D[i]));
+        }
+    }
+
+    /**
+     * @brief Scale a dense 2- or 4-index block by a factor of its denominators
+     * @param data the block elements, stored row major
+     * @param dims the dimensions of the block
+     * @param F the orbital energies of each index, already carrying the sign they have in the
+     *        denominator, e.g., D = F[0][p] + F[1][q] + F[2][r] + F[3][s] for element pqrs
+     * @param type the factor f(D) applied to each element
+     *
+     * Denominators are formed for a whole row of the last index at a time and passed to the
+     * batched functions, so that no per-element index lookup is needed.
+     */
+    void scale_block(double* data, const std::vector<size_t>& dims,
+                     const std::vector<std::vector<double>>& F, SourceScaling type);
+
   protected:
     /// Flow parameter
     double s_;
@@ -78,6 +139,34 @@ class STD_SOURCE : public DSRG_SOURCE {
         }
     }
 
+    /// Return exp(-s * D^2) in a loop that the compiler can vectorize
+    void compute_renormalized_batch(const double* D, double* r, size_t n) override {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = std::exp(-s_ * D[i] * D[i]);
+        }
+    }
+
+    /// Return [1 - exp(-s D^2)] / D = s D h(x), with x = s D^2, without branches
+    void compute_renormalized_denominator_batch(const double* D, double* r, size_t n) override {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            const double x = s_ * D[i] * D[i];
+            r[i] = s_ * D[i] * h_branch_free(x);
+        }
+    }
+
+    /// Return [1 - exp(-2 s D^2)] / D = 2 s D h(x), with h(x) = [1 - exp(-x)] / x and
+    /// x = 2 s D^2, in a branch-free loop that the compiler can vectorize
+    void compute_energy_weights(const double* D, double* w, size_t n) override {
+        const double two_s = 2.0 * s_;
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            const double x = two_s * D[i] * D[i];
+            w[i] = two_s * D[i] * h_branch_free(x);
+        }
+    }
+
   private:
     /// Order of the Taylor expansion
     int taylor_order_ = static_cast<int>(0.5 * (15.0 / taylor_threshold_ + 1)) + 1;
@@ -121,6 +210,23 @@ class LABS_SOURCE : public DSRG_SOURCE {
         }
     }
 
+    /// Return exp(-s * |D|) in a loop that the compiler can vectorize
+    void compute_renormalized_batch(const double* D, double* r, size_t n) override {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = std::exp(-s_ * std::fabs(D[i]));
+        }
+    }
+
+    /// Return [1 - exp(-s |D|)] / D = s sign(D) h(y), with y = s |D|, without branches
+    void compute_renormalized_denominator_batch(const double* D, double* r, size_t n) override {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            const double y = s_ * std::fabs(D[i]);
+            r[i] = (D[i] < 0.0 ? -s_ : s_) * h_branch_free(y);
+        }
+    }
+
   private:
     /// Order of the Taylor expansion
     int taylor_order_ = static_cast<int>(15.0 / taylor_threshold_ + 1) + 1;
@@ -163,6 +269,20 @@ class DYSON_SOURCE : public DSRG_SOURCE {
     virtual double compute_renormalized_denominator(const double& D) {
         return s_ * D / (1.0 + s_ * D * D);
     }
+
+    void compute_renormalized_batch(const double* D, double* r, size_t n) override {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = 1.0 / (1.0 + s_ * D[i] * D[i]);
+        }
+    }
+
+    void compute_renormalized_denominator_batch(const double* D, double* r, size_t n) override {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = s_ * D[i] / (1.0 + s_ * D[i] * D[i]);
+        }
+    }
 };
 
 /// MP2 denominator
@@ -175,6 +295,17 @@ class MP2_SOURCE : public DSRG_SOURCE {
     virtual double compute_renormalized(const double&) { return 1.0; }
 
     virtual double compute_renormalized_denominator(const double& D) { return 1.0 / D; }
+
+    void compute_renormalized_batch(const double*, double* r, size_t n) override {
+        std::fill(r, r + n, 1.0);
+    }
+
+    void compute_renormalized_denominator_batch(const double* D, double* r, size_t n) override {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = 1.0 / D[i];
+        }
+    }
 };
 }
 
@@ -27,6 +27,7 @@
  */
 
 #include <algorithm>
+#include <fstream>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 
@@ -45,6 +46,8 @@ DSRG_TIME::DSRG_TIME() {
 
     // initialize timing vector
     timing_ = std::vector<double>(code_.size(), 0.0);
+    flops_ = std::vector<double>(code_.size(), 0.0);
+    memory_ = std::vector<size_t>(code_.size(), 0);
 
     // map code to time index
     for (size_t i = 0; i < code_.size(); ++i) {
@@ -64,6 +67,25 @@ void DSRG_TIME::add(const std::string& code, const double& t) {
     }
 }
 
+void DSRG_TIME::add_flops(const std::string& code, const double& flops) {
+    if (test_code(code)) {
+        if (code_to_tidx_.find(code) == code_to_tidx_.end()) {
+            create_code(code);
+        }
+        flops_[code_to_tidx_[code]] += flops;
+    }
+}
+
+void DSRG_TIME::add_memory(const std::string& code, const size_t& bytes) {
+    if (test_code(code)) {
+        if (code_to_tidx_.find(code) == code_to_tidx_.end()) {
+            create_code(code);
+        }
+        size_t& peak = memory_[code_to_tidx_[code]];
+        peak = std::max(peak, bytes);
+    }
+}
+
 void DSRG_TIME::subtract(const std::string& code, const double& t) {
     if (test_code(code)) {
         auto iter = std::find(code_.begin(), code_.end(), code);
@@ -80,6 +102,12 @@ void DSRG_TIME::reset() {
     for (auto& t : timing_) {
         t = 0.0;
     }
+    for (auto& f : flops_) {
+        f = 0.0;
+    }
+    for (auto& m : memory_) {
+        m = 0;
+    }
 }
 
 void DSRG_TIME::reset(const std::string& code) {
@@ -87,6 +115,8 @@ void DSRG_TIME::reset(const std::string& code) {
         auto iter = std::find(code_.begin(), code_.end(), code);
         if (iter != code_.end()) {
             timing_[code_to_tidx_[code]] = 0.0;
+            flops_[code_to_tidx_[code]] = 0.0;
+            memory_[code_to_tidx_[code]] = 0;
         } else {
             print_h2("Echo from DSRG_TIME", "!!!", "!!!");
             outfile->Printf("  Cannot find time code %s. Reset nothing.", code.c_str());
@@ -100,6 +130,8 @@ void DSRG_TIME::create_code(const std::string& code) {
         if (iter == code_.end()) {
             code_.emplace_back(code);
             timing_.emplace_back(0.0);
+            flops_.emplace_back(0.0);
+            memory_.emplace_back(0);
             size_t size = code_.size();
             code_to_tidx_[code_.back()] = size - 1;
         } else {
@@ -116,9 +148,11 @@ void DSRG_TIME::delete_code(const std::string& code) {
             print_h2("Echo from DSRG_TIME", "!!!", "!!!");
             outfile->Printf("  Cannot find time code %s. Delete nothing.", code.c_str());
         } else {
-            code_.erase(iter);
             const size_t offset = iter - code_.begin();
+            code_.erase(iter);
             timing_.erase(timing_.begin() + offset);
+            flops_.erase(flops_.begin() + offset);
+            memory_.erase(memory_.begin() + offset);
             auto it = code_to_tidx_.find(code);
             code_to_tidx_.erase(it, code_to_tidx_.end());
             for (size_t i = offset; i < code_.size(); ++i) {
@@ -170,6 +204,7 @@ void DSRG_TIME::print_comm_time() {
                                ' ' % timing_[8] % timing_[9] % timing_[10]);
         output += indent + dash + "\n";
         outfile->Printf("\n%s", output.c_str());
+        print_comm_flops();
     } else {
         //        print_h2("Echo from DSRG_TIME", "!!!", "!!!");
         //        outfile->Printf("  Wrong size of \"timing\". Print nothing.");
@@ -177,6 +212,44 @@ void DSRG_TIME::print_comm_time() {
     }
 }
 
+void DSRG_TIME::print_comm_flops() {
+    if (std::all_of(flops_.begin(), flops_.end(), [](double f) { return f == 0.0; }))
+        return;
+
+    outfile->Printf("\n  ==> Estimated Cost of Commutators <==\n");
+    std::string dash(60, '-');
+    outfile->Printf("\n    %-16s %10s %10s %10s %10s", "Commutator", "Time (s)", "GFLOP",
+                    "GFLOP/s", "Peak MB");
+    outfile->Printf("\n    %s", dash.c_str());
+    for (size_t i = 0, size = code_.size(); i < size; ++i) {
+        const auto& code = code_[i];
+        std::string name = "[H" + code.substr(0, 1) + ",T" + code.substr(1, 1) + "] -> C" + code[2];
+        double gflops = flops_[i] / 1.0e9;
+        outfile->Printf("\n    %-16s %10.3f %10.3f %10.3f %10.3f", name.c_str(), timing_[i], gflops,
+                        timing_[i] > 0.0 ? gflops / timing_[i] : 0.0, memory_[i] / 1048576.0);
+    }
+    outfile->Printf("\n    %s\n", dash.c_str());
+}
+
+void DSRG_TIME::write_json(const std::string& filename) {
+    std::ofstream file(filename);
+    if (not file.good()) {
+        print_h2("Echo from DSRG_TIME", "!!!", "!!!");
+        outfile->Printf("  Cannot open file %s. Write nothing.", filename.c_str());
+        return;
+    }
+
+    file << "{\n  \"commutators\": [";
+    for (size_t i = 0, size = code_.size(); i < size; ++i) {
+        double gflops = flops_[i] / 1.0e9;
+        file << (i ? ",\n" : "\n") << "    {\"code\": \"" << code_[i]
+             << "\", \"seconds\": " << timing_[i] << ", \"gflop\": " << gflops
+             << ", \"gflop_per_second\": " << (timing_[i] > 0.0 ? gflops / timing_[i] : 0.0)
+             << ", \"peak_bytes\": " << memory_[i] << "}";
+    }
+    file << "\n  ]\n}\n";
+}
+
 bool DSRG_TIME::test_code(const std::string& code) {
     bool out = true;
     if (code.size() != 3) {
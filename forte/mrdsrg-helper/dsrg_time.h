@@ -45,6 +45,12 @@ class DSRG_TIME {
     /// Accumulate timings
     void add(const std::string& code, const double& t);
 
+    /// Accumulate estimated floating-point operations
+    void add_flops(const std::string& code, const double& flops);
+
+    /// Record the size (in bytes) of intermediates, keeping the largest value
+    void add_memory(const std::string& code, const size_t& bytes);
+
     /// Subtract timings
     void subtract(const std::string& code, const double& t);
 
@@ -65,11 +71,19 @@ class DSRG_TIME {
     void print();
     void print(const std::string& code);
 
+    /// Print estimated GFLOPs, GFLOP/s, and peak intermediate memory
+    void print_comm_flops();
+
+    /// Write timings, estimated FLOPs, and peak memory to a JSON file
+    void write_json(const std::string& filename);
+
     /// Clear all the private variables
     void clear() {
         code_.clear();
         code_to_tidx_.clear();
         timing_.clear();
+        flops_.clear();
+        memory_.clear();
     }
 
   private:
@@ -87,6 +101,12 @@ class DSRG_TIME {
     /// Timings for commutators
     std::vector<double> timing_;
 
+    /// Estimated FLOPs for commutators
+    std::vector<double> flops_;
+
+    /// Peak memory (in bytes) of intermediates for commutators
+    std::vector<size_t> memory_;
+
     /// Test code
     bool test_code(const std::string& code);
 };
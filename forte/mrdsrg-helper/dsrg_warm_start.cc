@@ -0,0 +1,145 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/wavefunction.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+
+#include "base_classes/mo_space_info.h"
+#include "helpers/disk_io.h"
+#include "integrals/integrals.h"
+#include "dsrg_warm_start.h"
+
+namespace forte {
+
+namespace {
+std::string orbital_record(bool alpha, int h) {
+    return std::string(alpha ? "Ca " : "Cb ") + std::to_string(h);
+}
+} // namespace
+
+void write_warm_start_amps(const std::string& filename, std::shared_ptr<ForteIntegrals> ints,
+                           const std::vector<std::pair<std::string, ambit::BlockedTensor>>& amps) {
+    ChunkedFileWriter writer(filename, DiskCompression::Lossless);
+
+    for (bool alpha : {true, false}) {
+        auto C = alpha ? ints->Ca() : ints->Cb();
+        for (int h = 0; h < C->nirrep(); ++h) {
+            size_t n = static_cast<size_t>(C->rowdim(h)) * C->coldim(h);
+            writer.write(orbital_record(alpha, h), n ? C->pointer(h)[0] : nullptr, n);
+        }
+    }
+
+    for (const auto& name_T : amps) {
+        auto T = name_T.second;
+        for (const std::string& block : T.block_labels()) {
+            writer.write(name_T.first + " " + block, T.block(block).data());
+        }
+    }
+    writer.close();
+}
+
+bool read_warm_start_amps(const std::string& filename, std::shared_ptr<ForteIntegrals> ints,
+                          std::shared_ptr<MOSpaceInfo> mo_space_info, double threshold,
+                          ambit::BlockedTensor& U,
+                          std::vector<std::pair<std::string, ambit::BlockedTensor>>& amps) {
+    ChunkedFileReader reader(filename);
+
+    // the MO overlap (old by new)
+    auto S = ints->wfn()->S();
+    std::map<bool, std::shared_ptr<psi::Matrix>> Smo;
+    for (bool alpha : {true, false}) {
+        auto C = alpha ? ints->Ca() : ints->Cb();
+        auto Cold = C->clone();
+        for (int h = 0; h < C->nirrep(); ++h) {
+            auto name = orbital_record(alpha, h);
+            size_t n = static_cast<size_t>(C->rowdim(h)) * C->coldim(h);
+            if (not reader.has(name) or reader.size(name) != n) {
+                psi::outfile->Printf("\n  Warm start: the saved orbitals do not match.");
+                return false;
+            }
+            if (n)
+                reader.read(name, Cold->pointer(h)[0]);
+        }
+        Smo[alpha] = psi::linalg::triplet(Cold, S, C, true, false, false);
+    }
+
+    // the rotation within each orbital space
+    std::map<char, std::string> space_names{
+        {'c', "RESTRICTED_DOCC"}, {'a', "ACTIVE"}, {'v', "RESTRICTED_UOCC"}};
+    double min_proj = 1.0;
+    for (const std::string& block : U.block_labels()) {
+        bool alpha = std::islower(block[0]);
+        auto relmo = mo_space_info->relative_mo(space_names.at(std::tolower(block[0])));
+        size_t n = relmo.size();
+
+        auto& data = U.block(block).data();
+        std::vector<double> proj(n, 0.0);
+        for (size_t p = 0; p < n; ++p) {
+            for (size_t q = 0; q < n; ++q) {
+                double value = 0.0;
+                if (relmo[p].first == relmo[q].first) {
+                    value = Smo[alpha]->get(relmo[p].first, relmo[p].second, relmo[q].second);
+                }
+                data[p * n + q] = value;
+                proj[q] += value * value;
+            }
+        }
+        for (double x : proj) {
+            min_proj = std::min(min_proj, x);
+        }
+    }
+    if (min_proj < threshold) {
+        psi::outfile->Printf("\n  Warm start: the orbitals changed too much (min. projection "
+                             "%.6f < %.6f).",
+                             min_proj, threshold);
+        return false;
+    }
+
+    // the amplitudes in the saved orbitals
+    for (auto& name_T : amps) {
+        auto& T = name_T.second;
+        for (const std::string& block : T.block_labels()) {
+            auto name = name_T.first + " " + block;
+            auto& data = T.block(block).data();
+            if (not reader.has(name) or reader.size(name) != data.size()) {
+                psi::outfile->Printf("\n  Warm start: the saved amplitudes do not match.");
+                return false;
+            }
+            reader.read(name, data.data());
+        }
+    }
+    return true;
+}
+
+} // namespace forte
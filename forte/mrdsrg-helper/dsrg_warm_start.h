@@ -0,0 +1,81 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+
+#ifndef _dsrg_warm_start_h_
+#define _dsrg_warm_start_h_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ambit/blocked_tensor.h"
+
+namespace forte {
+
+class ForteIntegrals;
+class MOSpaceInfo;
+
+/**
+ * @brief Save amplitudes together with the orbitals they are expressed in
+ * @param filename The file name
+ * @param ints The integrals, which hold the current MO coefficients
+ * @param amps The amplitudes, as pairs of a name and a tensor
+ *
+ * The alpha and beta MO coefficients and all the blocks of the amplitudes are written as
+ * records of a ChunkedFileWriter file (lossless compression).
+ */
+void write_warm_start_amps(const std::string& filename, std::shared_ptr<ForteIntegrals> ints,
+                           const std::vector<std::pair<std::string, ambit::BlockedTensor>>& amps);
+
+/**
+ * @brief Read amplitudes written by write_warm_start_amps and the rotation to the current orbitals
+ * @param filename The file name
+ * @param ints The integrals, which hold the current MO coefficients
+ * @param mo_space_info The MOSpaceInfo object
+ * @param threshold The minimum squared norm of the projection of each current orbital onto the
+ *        saved orbitals of the same space (core, active, or virtual)
+ * @param U The overlap <old|new> of the orbitals of each space, filled here. Its block labels
+ *        ("cc", "aa", "vv", and "CC", "AA", "VV" if spin-integrated) select the spaces.
+ * @param amps The amplitudes in the saved orbitals, filled here for all the record names and
+ *        block labels of the tensors
+ * @return false if the file does not match the current orbital spaces and amplitudes, or if the
+ *         orbitals changed too much (the amplitudes are then not usable as a guess)
+ *
+ * The amplitudes are rotated to the current orbitals by the caller, for example
+ * T1["jb"] = U["ij"] * T1old["ia"] * U["ab"].
+ */
+bool read_warm_start_amps(const std::string& filename, std::shared_ptr<ForteIntegrals> ints,
+                          std::shared_ptr<MOSpaceInfo> mo_space_info, double threshold,
+                          ambit::BlockedTensor& U,
+                          std::vector<std::pair<std::string, ambit::BlockedTensor>>& amps);
+
+} // namespace forte
+
+#endif // _dsrg_warm_start_h_
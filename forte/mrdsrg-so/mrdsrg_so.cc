@@ -36,6 +36,7 @@
 #include "base_classes/mo_space_info.h"
 #include "helpers/printing.h"
 #include "helpers/timer.h"
+#include "mrdsrg-helper/dsrg_so_ints.h"
 #include "mrdsrg_so.h"
 
 using namespace psi;
@@ -167,30 +168,7 @@ void MRDSRG_SO::startup() {
 
     // prepare two-electron integrals
     V = BTF_->build(tensor_type_, "V", {"gggg"});
-    V.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>&, double& value) {
-        bool spin0 = i[0] < nmo;
-        bool spin1 = i[1] < nmo;
-        bool spin2 = i[2] < nmo;
-        bool spin3 = i[3] < nmo;
-        if (spin0 && spin1 && spin2 && spin3) {
-            value = ints_->aptei_aa(i[0], i[1], i[2], i[3]);
-        }
-        if ((!spin0) && (!spin1) && (!spin2) && (!spin3)) {
-            value = ints_->aptei_bb(i[0] - nmo, i[1] - nmo, i[2] - nmo, i[3] - nmo);
-        }
-        if (spin0 && (!spin1) && spin2 && (!spin3)) {
-            value = ints_->aptei_ab(i[0], i[1] - nmo, i[2], i[3] - nmo);
-        }
-        if (spin1 && (!spin0) && spin3 && (!spin2)) {
-            value = ints_->aptei_ab(i[1], i[0] - nmo, i[3], i[2] - nmo);
-        }
-        if (spin0 && (!spin1) && spin3 && (!spin2)) {
-            value = -ints_->aptei_ab(i[0], i[1] - nmo, i[3], i[2] - nmo);
-        }
-        if (spin1 && (!spin0) && spin2 && (!spin3)) {
-            value = -ints_->aptei_ab(i[1], i[0] - nmo, i[2], i[3] - nmo);
-        }
-    });
+    fill_so_aptei(V, ints_, {{'c', acore_sos}, {'a', aactv_sos}, {'v', avirt_sos}});
 
     // prepare density matrices
     Gamma1 = BTF_->build(tensor_type_, "Gamma1", {"hh"});
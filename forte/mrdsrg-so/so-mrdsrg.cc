@@ -38,6 +38,7 @@
 #include "helpers/blockedtensorfactory.h"
 #include "helpers/printing.h"
 #include "helpers/helpers.h"
+#include "mrdsrg-helper/dsrg_so_ints.h"
 #include "so-mrdsrg.h"
 
 #define ISA(x) (x < nactv)
@@ -175,31 +176,7 @@ void SOMRDSRG::startup() {
     });
 
     // Fill in the two-electron operator (V)
-    V.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if ((spin[0] == AlphaSpin) and (spin[1] == AlphaSpin) and (spin[2] == AlphaSpin) and
-            (spin[3] == AlphaSpin))
-            value = +ints_->aptei_aa(i[0], i[1], i[2], i[3]);
-
-        if ((spin[0] == AlphaSpin) and (spin[1] == BetaSpin) and (spin[2] == AlphaSpin) and
-            (spin[3] == BetaSpin))
-            value = +ints_->aptei_ab(i[0], i[1], i[2], i[3]);
-
-        if ((spin[0] == AlphaSpin) and (spin[1] == BetaSpin) and (spin[2] == BetaSpin) and
-            (spin[3] == AlphaSpin))
-            value = -ints_->aptei_ab(i[0], i[1], i[3], i[2]);
-
-        if ((spin[0] == BetaSpin) and (spin[1] == AlphaSpin) and (spin[2] == AlphaSpin) and
-            (spin[3] == BetaSpin))
-            value = -ints_->aptei_ab(i[1], i[0], i[2], i[3]);
-
-        if ((spin[0] == BetaSpin) and (spin[1] == AlphaSpin) and (spin[2] == BetaSpin) and
-            (spin[3] == AlphaSpin))
-            value = +ints_->aptei_ab(i[1], i[0], i[3], i[2]);
-
-        if ((spin[0] == BetaSpin) and (spin[1] == BetaSpin) and (spin[2] == BetaSpin) and
-            (spin[3] == BetaSpin))
-            value = +ints_->aptei_bb(i[0], i[1], i[2], i[3]);
-    });
+    fill_so_aptei(V, ints_, {{'c', rdocc}, {'a', actv}, {'v', ruocc}});
 
     ambit::Tensor Gamma1_cc = Gamma1.block("cc");
     ambit::Tensor Gamma1_aa = Gamma1.block("aa");
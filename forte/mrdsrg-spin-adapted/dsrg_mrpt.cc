@@ -54,7 +54,12 @@ DSRG_MRPT::DSRG_MRPT(RDMs rdms, std::shared_ptr<SCFInfo> scf_info,
 
 DSRG_MRPT::~DSRG_MRPT() { cleanup(); }
 
-void DSRG_MRPT::cleanup() { dsrg_time_.print_comm_time(); }
+void DSRG_MRPT::cleanup() {
+    dsrg_time_.print_comm_time();
+    if (foptions_->get_bool("DSRG_COMM_JSON")) {
+        dsrg_time_.write_json(foptions_->get_str("DSRG_COMM_JSON_FILE"));
+    }
+}
 
 void DSRG_MRPT::read_options() {
     print_ = foptions_->get_int("PRINT");
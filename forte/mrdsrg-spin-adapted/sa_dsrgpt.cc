@@ -126,16 +126,7 @@ void SA_DSRGPT::compute_t2_full() {
     }
 
     // build T2
-    for (const std::string& block : T2blocks) {
-        T2_.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            double denom = Fdiag_[i0] + Fdiag_[i1] - Fdiag_[i2] - Fdiag_[i3];
-            value *= dsrg_source_->compute_renormalized_denominator(denom);
-        });
-    }
+    scale_by_source(T2_, T2blocks, SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -187,13 +178,7 @@ void SA_DSRGPT::compute_t1() {
     }
 
     // build T1
-    for (const std::string& block : T1blocks) {
-        T1_.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            value *= dsrg_source_->compute_renormalized_denominator(Fdiag_[i0] - Fdiag_[i1]);
-        });
-    }
+    scale_by_source(T1_, T1blocks, SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -226,27 +211,9 @@ void SA_DSRGPT::renormalize_integrals(bool add) {
     }
 
     if (add) {
-        for (const std::string& block : Vblocks) {
-            V_.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-                size_t i0 = label_to_spacemo_[block[0]][i[0]];
-                size_t i1 = label_to_spacemo_[block[1]][i[1]];
-                size_t i2 = label_to_spacemo_[block[2]][i[2]];
-                size_t i3 = label_to_spacemo_[block[3]][i[3]];
-                double denom = Fdiag_[i0] + Fdiag_[i1] - Fdiag_[i2] - Fdiag_[i3];
-                value *= 1.0 + dsrg_source_->compute_renormalized(denom);
-            });
-        }
+        scale_by_source(V_, Vblocks, SourceScaling::OnePlusRenormalized);
     } else {
-        for (const std::string& block : Vblocks) {
-            V_.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-                size_t i0 = label_to_spacemo_[block[0]][i[0]];
-                size_t i1 = label_to_spacemo_[block[1]][i[1]];
-                size_t i2 = label_to_spacemo_[block[2]][i[2]];
-                size_t i3 = label_to_spacemo_[block[3]][i[3]];
-                double denom = Fdiag_[i0] + Fdiag_[i1] - Fdiag_[i2] - Fdiag_[i3];
-                value *= dsrg_source_->compute_renormalized(denom);
-            });
-        }
+        scale_by_source(V_, Vblocks, SourceScaling::Renormalized);
     }
 
     // transform back if necessary
@@ -279,10 +246,7 @@ void SA_DSRGPT::renormalize_integrals(bool add) {
     }
 
     // scale by exp(-s * D^2)
-    temp.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>&, double& value) {
-        double denom = Fdiag_[i[0]] - Fdiag_[i[1]];
-        value *= dsrg_source_->compute_renormalized(denom);
-    });
+    scale_by_source(temp, temp.block_labels(), SourceScaling::Renormalized);
 
     // transform back if necessary
     if (!semi_canonical_) {
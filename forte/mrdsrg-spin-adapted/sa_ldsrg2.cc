@@ -28,6 +28,7 @@
  */
 
 #include <cctype>
+#include <cstdio>
 
 #include "psi4/libdiis/diismanager.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
@@ -129,7 +130,7 @@ double SA_MRDSRG::compute_energy_ldsrg2() {
             outfile->Printf("  S");
 
             if ((cycle - diis_start_) % diis_freq_ == 0 and
-                diis_manager_->subspace_size() >= diis_min_vec_) {
+                diis_subspace_size() >= diis_min_vec_) {
                 diis_manager_extrapolate();
                 outfile->Printf("/E");
             }
@@ -178,6 +179,9 @@ double SA_MRDSRG::compute_energy_ldsrg2() {
     // fail to converge
     if (!converged) {
         clean_checkpoints(); // clean amplitudes in scratch directory
+        if (warm_start_) {
+            remove(warm_start_file_.c_str());
+        }
         throw psi::PSIEXCEPTION("The MR-LDSRG(2) computation does not converge.");
     }
     final.stop();
@@ -298,6 +302,7 @@ void SA_MRDSRG::compute_hbar() {
 }
 
 void SA_MRDSRG::compute_hbar_sequential() {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     if (print_ > 2) {
         outfile->Printf("\n\n  ==> Computing the DSRG Transformed Hamiltonian <==\n");
     }
@@ -305,7 +310,7 @@ void SA_MRDSRG::compute_hbar_sequential() {
     timer rotation("Hbar T1 rotation");
 
     ambit::BlockedTensor A1;
-    A1 = BTF_->build(tensor_type_, "A1 Amplitudes", {"gg"}, true);
+    A1 = tensor_pool_.build(tensor_type_, "A1 Amplitudes", {"gg"});
     A1["ia"] = T1_["ia"];
     A1["ai"] -= T1_["ia"];
 
@@ -320,7 +325,7 @@ void SA_MRDSRG::compute_hbar_sequential() {
     A1_m->expm(3);
 
     ambit::BlockedTensor U1;
-    U1 = BTF_->build(tensor_type_, "Transformer", {"gg"}, true);
+    U1 = tensor_pool_.build(tensor_type_, "Transformer", {"gg"});
     U1.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>&, double& value) {
         value = A1_m->get(i[0], i[1]);
     });
@@ -347,10 +352,10 @@ void SA_MRDSRG::compute_hbar_sequential() {
     // Hbar1 becomes "Fock"
     ambit::BlockedTensor B;
     if (eri_df_) {
-        B = BTF_->build(tensor_type_, "B 3-idx", {"Lgg"}, true);
+        B = tensor_pool_.build(tensor_type_, "B 3-idx", {"Lgg"});
         B["grs"] = U1["rp"] * B_["gpq"] * U1["sq"];
 
-        BlockedTensor temp = BTF_->build(tensor_type_, "B temp", {"L"}, true);
+        BlockedTensor temp = tensor_pool_.build(tensor_type_, "B temp", {"L"});
         temp["g"] = B["gmn"] * D1c["mn"];
         temp["g"] += B["guv"] * L1_["uv"];
         Hbar1_["pq"] += temp["g"] * B["gpq"];
@@ -482,6 +487,7 @@ void SA_MRDSRG::compute_hbar_sequential() {
 }
 
 void SA_MRDSRG::compute_hbar_qc() {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     // initialize Hbar with bare H
     Hbar0_ = 0.0;
     Hbar1_["ia"] = F_["ia"];
@@ -492,7 +498,7 @@ void SA_MRDSRG::compute_hbar_qc() {
     }
 
     // compute S1 = H + 0.5 * [H, A]
-    BlockedTensor S1 = BTF_->build(tensor_type_, "S1", {"gg"}, true);
+    BlockedTensor S1 = tensor_pool_.build(tensor_type_, "S1", {"gg"});
     H1_T1_C1(F_, T1_, 0.5, S1);
     H1_T2_C1(F_, T2_, 0.5, S1);
     if (eri_df_) {
@@ -503,7 +509,7 @@ void SA_MRDSRG::compute_hbar_qc() {
         H2_T2_C1(V_, T2_, DT2_, 0.5, S1);
     }
 
-    auto temp = BTF_->build(tensor_type_, "temp", {"gg"}, true);
+    auto temp = tensor_pool_.build(tensor_type_, "temp", {"gg"});
     temp["pq"] = S1["pq"];
     S1["pq"] += temp["qp"];
 
@@ -518,18 +524,18 @@ void SA_MRDSRG::compute_hbar_qc() {
     H1_T2_C2(S1, T2_, 1.0, Hbar2_);
 
     //   Step 2: [S1, T]_{ij}^{ab}
-    temp = BTF_->build(tensor_type_, "temp", {"ph"}, true);
+    temp = tensor_pool_.build(tensor_type_, "temp", {"ph"});
     H1_T1_C1(S1, T1_, 1.0, temp);
     H1_T2_C1(S1, T2_, 1.0, temp);
     Hbar1_["ia"] += temp["ai"];
 
-    temp = BTF_->build(tensor_type_, "temp", {"pphh"}, true);
+    temp = tensor_pool_.build(tensor_type_, "temp", {"pphh"});
     H1_T2_C2(S1, T2_, 1.0, temp);
     Hbar2_["ijab"] += temp["abij"];
 
     // compute S2 = H + 0.5 * [H, A]
     // 0.5 * [H, T]
-    BlockedTensor S2 = BTF_->build(tensor_type_, "S2", {"gggg"}, true);
+    BlockedTensor S2 = tensor_pool_.build(tensor_type_, "S2", {"gggg"});
     H1_T2_C2(F_, T2_, 0.5, S2);
     if (eri_df_) {
         V_T1_C2_DF(B_, T1_, 0.5, S2);
@@ -564,7 +570,7 @@ void SA_MRDSRG::compute_hbar_qc() {
     H2_T2_C2(S2, T2_, DT2_, 1.0, temp);
     Hbar2_["ijab"] += temp["abij"];
 
-    temp = BTF_->build(tensor_type_, "temp", {"ph"}, true);
+    temp = tensor_pool_.build(tensor_type_, "temp", {"ph"});
     H2_T1_C1(S2, T1_, 1.0, temp);
     H2_T2_C1(S2, T2_, DT2_, 1.0, temp);
     Hbar1_["ia"] += temp["ai"];
@@ -574,8 +580,8 @@ void SA_MRDSRG::setup_ldsrg2_tensors() {
     BlockedTensor::set_expert_mode(true);
 
     if (corrlv_string_ == "LDSRG2_QC") {
-        Hbar1_ = BTF_->build(tensor_type_, "Hbar1", {"hp"});
-        Hbar2_ = BTF_->build(tensor_type_, "Hbar2", {"hhpp"});
+        Hbar1_ = BTF_->build(tensor_type_, "Hbar1", symmetry_allowed({"hp"}));
+        Hbar2_ = BTF_->build(tensor_type_, "Hbar2", symmetry_allowed({"hhpp"}));
     } else {
         if (nivo_) {
             // Generate blocks for Hbar2_, O2_ and C2_
@@ -584,18 +590,23 @@ void SA_MRDSRG::setup_ldsrg2_tensors() {
             O2_ = BTF_->build(tensor_type_, "O2", blocks_exclude_V3);
             C2_ = BTF_->build(tensor_type_, "C2", blocks_exclude_V3);
         } else {
-            Hbar2_ = BTF_->build(tensor_type_, "Hbar2", {"gggg"});
-            O2_ = BTF_->build(tensor_type_, "O2", {"gggg"});
-            C2_ = BTF_->build(tensor_type_, "C2", {"gggg"});
+            // With DF, the bare Hamiltonian stays factored in B and enters the first commutator
+            // through the DF kernels, and only the blocks with < 3 virtual indices of Hbar2 are
+            // used afterwards (amplitudes, energy, and active-space Hbar). The vvvv-like blocks
+            // of Hbar2 are thus never stored; O2 and C2 still need them for nested commutators.
+            Hbar2_ = BTF_->build(tensor_type_, "Hbar2",
+                                 eri_df_ ? nivo_labels() : symmetry_allowed({"gggg"}));
+            O2_ = BTF_->build(tensor_type_, "O2", symmetry_allowed({"gggg"}));
+            C2_ = BTF_->build(tensor_type_, "C2", symmetry_allowed({"gggg"}));
         }
 
-        Hbar1_ = BTF_->build(tensor_type_, "Hbar1", {"gg"});
-        O1_ = BTF_->build(tensor_type_, "O1", {"gg"});
-        C1_ = BTF_->build(tensor_type_, "C1", {"gg"});
+        Hbar1_ = BTF_->build(tensor_type_, "Hbar1", symmetry_allowed({"gg"}));
+        O1_ = BTF_->build(tensor_type_, "O1", symmetry_allowed({"gg"}));
+        C1_ = BTF_->build(tensor_type_, "C1", symmetry_allowed({"gg"}));
     }
 
-    DT1_ = BTF_->build(tensor_type_, "DT1", {"hp"});
-    DT2_ = BTF_->build(tensor_type_, "DT2", {"hhpp"});
+    DT1_ = BTF_->build(tensor_type_, "DT1", symmetry_allowed({"hp"}));
+    DT2_ = BTF_->build(tensor_type_, "DT2", symmetry_allowed({"hhpp"}));
 }
 
 void SA_MRDSRG::add_hermitian_conjugate(BlockedTensor& H2) {
@@ -66,6 +66,7 @@ void SA_MRDSRG::read_options() {
 
     sequential_Hbar_ = foptions_->get_bool("DSRG_HBAR_SEQ");
     nivo_ = foptions_->get_bool("DSRG_NIVO");
+    t2_pair_screen_ = foptions_->get_double("DSRG_T2_PAIR_SCREEN");
 
     rsc_ncomm_ = foptions_->get_int("DSRG_RSC_NCOMM");
     rsc_conv_ = foptions_->get_double("DSRG_RSC_THRESHOLD");
@@ -75,6 +76,7 @@ void SA_MRDSRG::read_options() {
     r_conv_ = foptions_->get_double("R_CONVERGENCE");
 
     restart_amps_ = foptions_->get_bool("DSRG_RESTART_AMPS");
+    warm_start_ = foptions_->get_bool("DSRG_WARM_START");
 }
 
 void SA_MRDSRG::startup() {
@@ -101,6 +103,7 @@ void SA_MRDSRG::startup() {
         t1_file_chk_ = restart_file_prefix_ + ".mrdsrg.adapted.t1.bin";
         t2_file_chk_ = restart_file_prefix_ + ".mrdsrg.adapted.t2.bin";
     }
+    warm_start_file_ = restart_file_prefix_ + ".mrdsrg.adapted.warm.bin";
 
     t1_file_cwd_ = "forte.mrdsrg.adapted.t1.bin";
     t2_file_cwd_ = "forte.mrdsrg.adapted.t2.bin";
@@ -123,14 +126,16 @@ void SA_MRDSRG::print_options() {
         {"Residual convergence threshold", r_conv_},
         {"Recursive single commutator threshold", rsc_conv_},
         {"Taylor expansion threshold", pow(10.0, -double(taylor_threshold_))},
-        {"Intruder amplitudes threshold", intruder_tamp_}};
+        {"Intruder amplitudes threshold", intruder_tamp_},
+        {"T2 pair screening threshold", t2_pair_screen_}};
 
     std::vector<std::pair<std::string, std::string>> calculation_info_string{
         {"Correlation level", corrlv_string_},
         {"Integral type", ints_type_},
         {"Source operator", source_},
         {"Reference relaxation", relax_ref_},
-        {"Core-Virtual source type", ccvv_source_}};
+        {"Core-Virtual source type", ccvv_source_},
+        {"DIIS storage", diis_storage_}};
 
     if (internal_amp_ != "NONE") {
         calculation_info_string.push_back({"Internal amplitudes levels", internal_amp_});
@@ -139,6 +144,7 @@ void SA_MRDSRG::print_options() {
 
     std::vector<std::pair<std::string, bool>> calculation_info_bool{
         {"Restart amplitudes", restart_amps_},
+        {"Warm start amplitudes", warm_start_},
         {"Sequential DSRG transformation", sequential_Hbar_},
         {"Omit blocks of >= 3 virtual indices", nivo_},
         {"Read amplitudes from current dir", read_amps_cwd_},
@@ -166,6 +172,9 @@ void SA_MRDSRG::check_memory() {
         dsrg_mem_.add_entry("1-body Hbar and intermediates", {"gg"}, 3);
         if (nivo_) {
             dsrg_mem_.add_entry("2-body Hbar and intermediates", nivo_labels(), 3);
+        } else if (eri_df_) {
+            dsrg_mem_.add_entry("2-body Hbar (< 3 virtual indices)", nivo_labels());
+            dsrg_mem_.add_entry("2-body intermediates", {"gggg"}, 2);
         } else {
             dsrg_mem_.add_entry("2-body Hbar and intermediates", {"gggg"}, 3);
         }
@@ -173,7 +182,12 @@ void SA_MRDSRG::check_memory() {
         if (sequential_Hbar_) {
             size_t mem_seq =
                 eri_df_ ? dsrg_mem_.compute_memory({"Lgg"}) : dsrg_mem_.compute_memory({"gggg"});
-            dsrg_mem_.add_entry("Local intermediates for sequential Hbar", mem_seq, false);
+            if (memory_plan_ and !dsrg_mem_.fits(mem_seq)) {
+                sequential_Hbar_ = false;
+                dsrg_mem_.add_plan_entry("Sequential Hbar (memory plan)", "FALSE");
+            } else {
+                dsrg_mem_.add_entry("Local intermediates for sequential Hbar", mem_seq, false);
+            }
         }
     }
 
@@ -184,6 +198,8 @@ void SA_MRDSRG::check_memory() {
     }
     dsrg_mem_.add_entry("Local intermediates for commutators", mem_comm, false);
 
+    plan_cu3_memory();
+
     dsrg_mem_.print("MR-DSRG (" + corrlv_string_ + ")");
 }
 
@@ -217,8 +233,8 @@ void SA_MRDSRG::build_ints() {
 
 double SA_MRDSRG::compute_energy() {
     // build initial amplitudes
-    T1_ = BTF_->build(tensor_type_, "T1 Amplitudes", {"hp"});
-    T2_ = BTF_->build(tensor_type_, "T2 Amplitudes", {"hhpp"});
+    T1_ = BTF_->build(tensor_type_, "T1 Amplitudes", symmetry_allowed({"hp"}));
+    T2_ = BTF_->build(tensor_type_, "T2 Amplitudes", symmetry_allowed({"hhpp"}));
     guess_t(V_, T2_, F_, T1_, B_);
 
     // get reference energy
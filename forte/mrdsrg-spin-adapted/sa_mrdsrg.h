@@ -38,6 +38,8 @@ using namespace ambit;
 
 namespace forte {
 
+class CompressedDIIS;
+
 class SA_MRDSRG : public SADSRG {
   public:
     /**
@@ -82,12 +84,22 @@ class SA_MRDSRG : public SADSRG {
     /// Omitting blocks with >= 3 virtual indices?
     bool nivo_;
 
+    /// Threshold of the pair norm of T2 below which the amplitudes of a hole pair are zeroed
+    double t2_pair_screen_;
+
     /// Read amplitudes from previous reference relaxation step
     bool restart_amps_;
 
     /// Prefix for file name for restart
     std::string restart_file_prefix_;
 
+    /// Start from the amplitudes of the last computation rotated to the current orbitals?
+    bool warm_start_;
+    /// The file of the warm-start amplitudes (kept across computations, see write_warm_start_amps)
+    std::string warm_start_file_;
+    /// Read the warm-start amplitudes into T1 and T2, return false if they are not usable
+    bool read_warm_start(BlockedTensor& T1, BlockedTensor& T2);
+
     /// Dump the converged amplitudes to disk
     void dump_amps_to_disk() override;
 
@@ -176,6 +188,8 @@ class SA_MRDSRG : public SADSRG {
 
     /// Shared pointer of DIISManager object from Psi4
     std::shared_ptr<psi::DIISManager> diis_manager_;
+    /// DIIS with compact storage, used instead of diis_manager_ unless DSRG_DIIS_STORAGE is PSI4
+    std::shared_ptr<CompressedDIIS> compressed_diis_;
     /// Amplitudes pointers
     std::vector<double*> amp_ptrs_;
     /// Residual pointers
@@ -188,6 +202,8 @@ class SA_MRDSRG : public SADSRG {
     void diis_manager_extrapolate();
     /// Clean up for pointers used for DIIS
     void diis_manager_cleanup();
+    /// Return the number of stored DIIS vectors
+    int diis_subspace_size();
 
     /// Compute MR-LDSRG(2)
     double compute_energy_ldsrg2();
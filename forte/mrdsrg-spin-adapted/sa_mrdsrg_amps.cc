@@ -34,6 +34,7 @@
 
 #include "helpers/timer.h"
 #include "helpers/printing.h"
+#include "mrdsrg-helper/dsrg_warm_start.h"
 #include "sa_mrdsrg.h"
 
 using namespace psi;
@@ -44,12 +45,59 @@ void SA_MRDSRG::guess_t(BlockedTensor& V, BlockedTensor& T2, BlockedTensor& F, B
                         BlockedTensor& B) {
     print_h2("Build Initial Amplitudes Guesses");
 
+    if (warm_start_ and !read_amps_cwd_ and read_warm_start(T1, T2)) {
+        analyze_amplitudes("Initial", T1_, T2_);
+        return;
+    }
+
     guess_t2(V, T2, B);
     guess_t1(F, T2, T1);
 
     analyze_amplitudes("Initial", T1_, T2_);
 }
 
+bool SA_MRDSRG::read_warm_start(BlockedTensor& T1, BlockedTensor& T2) {
+    struct stat buf;
+    if (stat(warm_start_file_.c_str(), &buf) != 0) {
+        return false;
+    }
+
+    BlockedTensorPool::Scope scope(tensor_pool_);
+    local_timer timer;
+
+    auto U = tensor_pool_.build(tensor_type_, "U warm start", {"cc", "aa", "vv"});
+    std::vector<std::pair<std::string, BlockedTensor>> amps{
+        {"T1", tensor_pool_.build(tensor_type_, "T1 warm start", T1.block_labels())},
+        {"T2", tensor_pool_.build(tensor_type_, "T2 warm start", T2.block_labels())}};
+    double threshold = foptions_->get_double("DSRG_WARM_START_THRESHOLD");
+    if (!read_warm_start_amps(warm_start_file_, ints_, mo_space_info_, threshold, U, amps)) {
+        return false;
+    }
+
+    print_contents("Rotating amplitudes of the last computation");
+    auto& T1old = amps[0].second;
+    auto& T2old = amps[1].second;
+    T1["jb"] = U["ij"] * T1old["ia"] * U["ab"];
+
+    auto temp = tensor_pool_.build(tensor_type_, "Temp T2", T2.block_labels());
+    temp["klab"] = U["ik"] * U["jl"] * T2old["ijab"];
+    T2["ijcd"] = temp["ijab"] * U["bd"] * U["ac"];
+
+    // zero internal amplitudes
+    internal_amps_T1(T1);
+    internal_amps_T2(T2);
+
+    T1max_ = T1.norm(0);
+    T1norm_ = T1.norm();
+    T1rms_ = 0.0;
+    T2max_ = T2.norm(0);
+    T2norm_ = T2.norm();
+    T2rms_ = 0.0;
+
+    print_done(timer.get());
+    return true;
+}
+
 void SA_MRDSRG::update_t() {
     update_t2();
     update_t1();
@@ -83,10 +131,11 @@ void SA_MRDSRG::guess_t2(BlockedTensor& V, BlockedTensor& T2, BlockedTensor& B)
 }
 
 void SA_MRDSRG::guess_t2_impl(BlockedTensor& T2) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     // transform to semi-canonical basis
     BlockedTensor tempT2;
     if (!semi_canonical_) {
-        tempT2 = ambit::BlockedTensor::build(tensor_type_, "Temp T2", T2.block_labels());
+        tempT2 = tensor_pool_.build(tensor_type_, "Temp T2", T2.block_labels());
         tempT2["klab"] = U_["ki"] * U_["lj"] * T2["ijab"];
         T2["ijcd"] = tempT2["ijab"] * U_["db"] * U_["ca"];
     }
@@ -95,26 +144,10 @@ void SA_MRDSRG::guess_t2_impl(BlockedTensor& T2) {
     std::vector<std::string> T2blocks(T2.block_labels());
     if (ccvv_source_ == "ZERO") {
         T2blocks.erase(std::remove(T2blocks.begin(), T2blocks.end(), "ccvv"), T2blocks.end());
-        T2.block("ccvv").iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = core_mos_[i[0]];
-            size_t i1 = core_mos_[i[1]];
-            size_t i2 = virt_mos_[i[2]];
-            size_t i3 = virt_mos_[i[3]];
-
-            value /= Fdiag_[i0] + Fdiag_[i1] - Fdiag_[i2] - Fdiag_[i3];
-        });
+        scale_by_source(T2, {"ccvv"}, SourceScaling::InverseDenominator);
     }
 
-    for (const std::string& block : T2blocks) {
-        T2.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            double denom = Fdiag_[i0] + Fdiag_[i1] - Fdiag_[i2] - Fdiag_[i3];
-            value *= dsrg_source_->compute_renormalized_denominator(denom);
-        });
-    }
+    scale_by_source(T2, T2blocks, SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -127,6 +160,7 @@ void SA_MRDSRG::guess_t2_impl(BlockedTensor& T2) {
 }
 
 void SA_MRDSRG::guess_t1(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T1) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     struct stat buf;
@@ -148,7 +182,7 @@ void SA_MRDSRG::guess_t1(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T1)
         // transform to semi-canonical basis
         BlockedTensor tempX;
         if (!semi_canonical_) {
-            tempX = ambit::BlockedTensor::build(tensor_type_, "Temp T1", T1.block_labels());
+            tempX = tensor_pool_.build(tensor_type_, "Temp T1", T1.block_labels());
             tempX["jb"] = U_["ji"] * T1["ia"] * U_["ba"];
             T1["ia"] = tempX["ia"];
         }
@@ -157,21 +191,10 @@ void SA_MRDSRG::guess_t1(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T1)
         std::vector<std::string> T1blocks(T1.block_labels());
         if (ccvv_source_ == "ZERO") {
             T1blocks.erase(std::remove(T1blocks.begin(), T1blocks.end(), "cv"), T1blocks.end());
-            T1.block("cv").iterate([&](const std::vector<size_t>& i, double& value) {
-                size_t i0 = core_mos_[i[0]];
-                size_t i1 = virt_mos_[i[1]];
-
-                value /= Fdiag_[i0] - Fdiag_[i1];
-            });
+            scale_by_source(T1, {"cv"}, SourceScaling::InverseDenominator);
         }
 
-        for (const std::string& block : T1blocks) {
-            T1.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-                size_t i0 = label_to_spacemo_[block[0]][i[0]];
-                size_t i1 = label_to_spacemo_[block[1]][i[1]];
-                value *= dsrg_source_->compute_renormalized_denominator(Fdiag_[i0] - Fdiag_[i1]);
-            });
-        }
+        scale_by_source(T1, T1blocks, SourceScaling::RenormalizedDenominator);
 
         // transform back to non-canonical basis
         if (!semi_canonical_) {
@@ -192,8 +215,9 @@ void SA_MRDSRG::guess_t1(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T1)
 }
 
 void SA_MRDSRG::update_t2() {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     // make a copy of the active part of Hbar2 as it will be used as intermediate
-    auto Hbar2copy = BlockedTensor::build(tensor_type_, "Hbar2 active copy", {"aaaa"});
+    auto Hbar2copy = tensor_pool_.build(tensor_type_, "Hbar2 active copy", {"aaaa"});
     Hbar2copy["uvxy"] = Hbar2_["uvxy"];
 
     // special case for CCVV block
@@ -224,25 +248,10 @@ void SA_MRDSRG::update_t2() {
     timer t2("scale Hbar2 by renormalized denominator");
     // scale Hbar2 by renormalized denominator
     if (ccvv_source_ == "ZERO") {
-        DT2_.block("ccvv").iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = core_mos_[i[0]];
-            size_t i1 = core_mos_[i[1]];
-            size_t i2 = virt_mos_[i[2]];
-            size_t i3 = virt_mos_[i[3]];
-            value /= Fdiag_[i0] + Fdiag_[i1] - Fdiag_[i2] - Fdiag_[i3];
-        });
+        scale_by_source(DT2_, {"ccvv"}, SourceScaling::InverseDenominator);
     }
 
-    for (const std::string& block : T2blocks) {
-        DT2_.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            double denom = Fdiag_[i0] + Fdiag_[i1] - Fdiag_[i2] - Fdiag_[i3];
-            value *= dsrg_source_->compute_renormalized_denominator(denom);
-        });
-    }
+    scale_by_source(DT2_, T2blocks, SourceScaling::RenormalizedDenominator);
     t2.stop();
 
     // Step 2: work on T2 where Hbar2 is treated as intermediate
@@ -255,7 +264,7 @@ void SA_MRDSRG::update_t2() {
     timer t5("transform T2 to semi-canonical basis");
     // transform T2 to semi-canonical basis
     if (!semi_canonical_) {
-        auto temp = BlockedTensor::build(tensor_type_, "temp for T2 update", T2blocks);
+        auto temp = tensor_pool_.build(tensor_type_, "temp for T2 update", T2blocks);
         temp["klab"] = U_["ki"] * U_["lj"] * T2_["ijab"];
         T2_["ijcd"] = temp["ijab"] * U_["db"] * U_["ca"];
     }
@@ -263,16 +272,7 @@ void SA_MRDSRG::update_t2() {
 
     timer t6("scale T2 by delta exponential");
     // scale T2 by delta exponential
-    for (const std::string& block : T2blocks) {
-        T2_.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            double denom = Fdiag_[i0] + Fdiag_[i1] - Fdiag_[i2] - Fdiag_[i3];
-            value *= dsrg_source_->compute_renormalized(denom);
-        });
-    }
+    scale_by_source(T2_, T2blocks, SourceScaling::Renormalized);
     if (ccvv_source_ == "ZERO") {
         T2_.block("ccvv").zero();
     }
@@ -304,6 +304,14 @@ void SA_MRDSRG::update_t2() {
     T2_["ijab"] = Hbar2_["ijab"];
     T2_["ijab"] += DT2_["ijab"];
 
+    // zero the amplitudes of weakly correlated pairs, skipped by the DF ladder contraction
+    if (t2_pair_screen_ > 0.0) {
+        auto npairs = screen_t2_pairs(T2_, t2_pair_screen_);
+        if (print_ > 1) {
+            outfile->Printf("\n    Screened %zu hole pairs of T2.", npairs);
+        }
+    }
+
     // compute norm and find maximum
     T2norm_ = T2_.norm(2);
     T2max_ = T2_.norm(0);
@@ -314,8 +322,9 @@ void SA_MRDSRG::update_t2() {
 }
 
 void SA_MRDSRG::update_t1() {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     // make a copy of the active part of Hbar2 as it will be used as intermediate
-    auto Hbar1copy = BlockedTensor::build(tensor_type_, "Hbar1 active copy", {"aa"});
+    auto Hbar1copy = tensor_pool_.build(tensor_type_, "Hbar1 active copy", {"aa"});
     Hbar1copy["uv"] = Hbar1_["uv"];
 
     // special case for CV block
@@ -343,21 +352,10 @@ void SA_MRDSRG::update_t1() {
 
     // scale Hbar1 by renormalized denominator
     if (ccvv_source_ == "ZERO") {
-        DT1_.block("cv").iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = core_mos_[i[0]];
-            size_t i1 = virt_mos_[i[1]];
-            value /= Fdiag_[i0] - Fdiag_[i1];
-        });
+        scale_by_source(DT1_, {"cv"}, SourceScaling::InverseDenominator);
     }
 
-    for (const std::string& block : T1blocks) {
-        DT1_.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            double denom = Fdiag_[i0] - Fdiag_[i1];
-            value *= dsrg_source_->compute_renormalized_denominator(denom);
-        });
-    }
+    scale_by_source(DT1_, T1blocks, SourceScaling::RenormalizedDenominator);
 
     // Step 2: work on T1 where Hbar1 is treated as intermediate
 
@@ -366,21 +364,13 @@ void SA_MRDSRG::update_t1() {
 
     // transform T1 to semi-canonical basis
     if (!semi_canonical_) {
-        auto temp =
-            ambit::BlockedTensor::build(tensor_type_, "temp for T1 update", T1_.block_labels());
+        auto temp = tensor_pool_.build(tensor_type_, "temp for T1 update", T1_.block_labels());
         temp["jb"] = U_["ji"] * T1_["ia"] * U_["ba"];
         T1_["ia"] = temp["ia"];
     }
 
     // scale T1 by delta exponential
-    for (const std::string& block : T1blocks) {
-        T1_.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            double denom = Fdiag_[i0] - Fdiag_[i1];
-            value *= dsrg_source_->compute_renormalized(denom);
-        });
-    }
+    scale_by_source(T1_, T1blocks, SourceScaling::Renormalized);
     if (ccvv_source_ == "ZERO") {
         T1_.block("cv").zero();
     }
@@ -430,6 +420,14 @@ void SA_MRDSRG::dump_amps_to_disk() {
         ambit::save(T2_, t2_file_cwd_);
         print_done(lt.get());
     }
+
+    // keep amplitudes with their orbitals for the next geometry or relaxation cycle
+    if (warm_start_) {
+        local_timer lt;
+        print_contents("Dumping amplitudes for warm start");
+        write_warm_start_amps(warm_start_file_, ints_, {{"T1", T1_}, {"T2", T2_}});
+        print_done(lt.get());
+    }
 }
 
 } // namespace forte
@@ -28,6 +28,7 @@
 
 #include "psi4/libdiis/diismanager.h"
 
+#include "helpers/compressed_diis.h"
 #include "sa_mrdsrg.h"
 
 using namespace psi;
@@ -35,9 +36,6 @@ using namespace psi;
 namespace forte {
 
 void SA_MRDSRG::diis_manager_init() {
-    diis_manager_ = std::make_shared<DIISManager>(diis_max_vec_, "SA_MRDSRG DIIS",
-                                                  DIISManager::RemovalPolicy::LargestError, DIISManager::StoragePolicy::OnDisk);
-
     amp_ptrs_.clear();
     res_ptrs_.clear();
 
@@ -59,6 +57,17 @@ void SA_MRDSRG::diis_manager_init() {
         }
     }
 
+    if (diis_storage_ != "PSI4") {
+        auto precision = CompressedDIIS::precision_from_string(diis_storage_);
+        compressed_diis_ = std::make_shared<CompressedDIIS>(
+            "sa_mrdsrg.diis", diis_max_vec_, sizes, precision,
+            CompressedDIIS::RemovalPolicy::LargestError, diis_out_of_core_);
+        return;
+    }
+
+    diis_manager_ = std::make_shared<DIISManager>(diis_max_vec_, "SA_MRDSRG DIIS",
+                                                  DIISManager::RemovalPolicy::LargestError, DIISManager::StoragePolicy::OnDisk);
+
     diis_manager_->set_error_vector_size(
         18, DIISEntry::InputType::Pointer, sizes[0], DIISEntry::InputType::Pointer, sizes[1], DIISEntry::InputType::Pointer,
         sizes[2], DIISEntry::InputType::Pointer, sizes[3], DIISEntry::InputType::Pointer, sizes[4], DIISEntry::InputType::Pointer,
@@ -79,6 +88,10 @@ void SA_MRDSRG::diis_manager_init() {
 }
 
 void SA_MRDSRG::diis_manager_add_entry() {
+    if (compressed_diis_) {
+        compressed_diis_->add_entry(res_ptrs_, amp_ptrs_);
+        return;
+    }
     diis_manager_->add_entry(
         36, res_ptrs_[0], res_ptrs_[1], res_ptrs_[2], res_ptrs_[3], res_ptrs_[4], res_ptrs_[5],
         res_ptrs_[6], res_ptrs_[7], res_ptrs_[8], res_ptrs_[9], res_ptrs_[10], res_ptrs_[11],
@@ -89,6 +102,10 @@ void SA_MRDSRG::diis_manager_add_entry() {
 }
 
 void SA_MRDSRG::diis_manager_extrapolate() {
+    if (compressed_diis_) {
+        compressed_diis_->extrapolate(amp_ptrs_);
+        return;
+    }
     diis_manager_->extrapolate(
         18, amp_ptrs_[0], amp_ptrs_[1], amp_ptrs_[2], amp_ptrs_[3], amp_ptrs_[4], amp_ptrs_[5],
         amp_ptrs_[6], amp_ptrs_[7], amp_ptrs_[8], amp_ptrs_[9], amp_ptrs_[10], amp_ptrs_[11],
@@ -98,7 +115,15 @@ void SA_MRDSRG::diis_manager_extrapolate() {
 void SA_MRDSRG::diis_manager_cleanup() {
     amp_ptrs_.clear();
     res_ptrs_.clear();
+    if (compressed_diis_) {
+        compressed_diis_.reset();
+        return;
+    }
     diis_manager_->reset_subspace();
     diis_manager_->delete_diis_file();
 }
+
+int SA_MRDSRG::diis_subspace_size() {
+    return compressed_diis_ ? compressed_diis_->subspace_size() : diis_manager_->subspace_size();
+}
 } // namespace forte
@@ -27,6 +27,9 @@
  * @END LICENSE
  */
 
+#include <functional>
+#include <future>
+
 #include "psi4/libpsi4util/PsiOutStream.h"
 
 #include "forte-def.h"
@@ -39,6 +42,43 @@ using namespace psi;
 
 namespace forte {
 
+namespace {
+/**
+ * Reads a sequence of batches of 3-index integrals in a background thread, one batch ahead of
+ * the caller, so that batch n + 1 is read while the OpenMP team works on batch n.
+ */
+class BatchReader {
+  public:
+    /// @param read the function that reads batch n of the sequence
+    BatchReader(size_t nbatch, std::function<ambit::Tensor(size_t)> read)
+        : nbatch_(nbatch), read_(std::move(read)) {
+        launch(0);
+    }
+    ~BatchReader() {
+        if (next_.valid())
+            next_.wait();
+    }
+
+    /// @return the next batch of the sequence and start reading the one after
+    ambit::Tensor next() {
+        auto batch = next_.get();
+        launch(++current_);
+        return batch;
+    }
+
+  private:
+    void launch(size_t n) {
+        if (n < nbatch_)
+            next_ = std::async(std::launch::async, read_, n);
+    }
+
+    size_t nbatch_;
+    size_t current_ = 0;
+    std::function<ambit::Tensor(size_t)> read_;
+    std::future<ambit::Tensor> next_;
+};
+} // namespace
+
 SA_MRPT2::SA_MRPT2(RDMs rdms, std::shared_ptr<SCFInfo> scf_info,
                    std::shared_ptr<ForteOptions> options, std::shared_ptr<ForteIntegrals> ints,
                    std::shared_ptr<MOSpaceInfo> mo_space_info)
@@ -74,7 +114,7 @@ void SA_MRPT2::build_ints() {
     if (eri_df_) {
         std::vector<std::string> blocks{"vvaa", "aacc", "avca", "avac", "vaaa", "aaca", "aaaa"};
         V_ = BTF_->build(tensor_type_, "V", blocks);
-        if (ints_->integral_type() != DiskDF) {
+        if (!batched_df_) {
             auto B = BTF_->build(tensor_type_, "B 3-idx", {"Lph"});
             fill_three_index_ints(B);
             V_["abij"] = B["gai"] * B["gbj"];
@@ -129,7 +169,7 @@ void SA_MRPT2::build_minimal_V() {
 
     // to minimize the number of calls of ints_->three_integral_block,
     // we store as many (Q|em) as possible in memory.
-    size_t max_num = dsrg_mem_.available() * 0.8 / (sizeof(double) * (nQ * nv + na * na * nv));
+    size_t max_num = dsrg_mem_.max_batch_size(sizeof(double) * (nQ * nv + na * na * nv));
 
     // separate core indices into batches
     auto core_batches = split_indices_to_batches(core_mos_, max_num);
@@ -198,13 +238,39 @@ void SA_MRPT2::init_amps() {
 }
 
 void SA_MRPT2::check_memory() {
+    // read 3-index integrals in batches for DiskDF, or for DF if they do not fit
+    batched_df_ = ints_->integral_type() == DiskDF;
+
+    use_device_ = eri_df_ and foptions_->get_str("DSRG_PT2_DEVICE") == "GPU";
+#ifndef HAVE_CUDA
+    if (use_device_) {
+        throw std::runtime_error("SA_MRPT2: DSRG_PT2_DEVICE = GPU is not available. "
+                                 "Compile Forte with ENABLE_CUDA=ON to use it.");
+    }
+#endif
+
+    local_ccvv_ = eri_df_ and foptions_->get_bool("DSRG_PT2_LOCAL");
+    if (local_ccvv_) {
+        if (mo_space_info_->nirrep() > 1) {
+            throw std::runtime_error("SA_MRPT2: DSRG_PT2_LOCAL requires C1 symmetry.");
+        }
+        if (!semi_canonical_) {
+            throw std::runtime_error("SA_MRPT2: DSRG_PT2_LOCAL requires semicanonical orbitals.");
+        }
+        dsrg_mem_.add_entry("3-index integrals for local CCVV", {"Lvc"}, 2, false);
+    }
+
     // memory of ints and amps
     if (eri_df_) {
         std::vector<std::string> blocks{"vvaa", "aacc", "avca", "avac", "vaaa", "aaca", "aaaa"};
         auto mem_blocks = dsrg_mem_.compute_memory(blocks);
         dsrg_mem_.add_entry("2-electron (4-index) integrals", mem_blocks);
         dsrg_mem_.add_entry("T2 cluster amplitudes", 2 * mem_blocks);
-        if (ints_->integral_type() != DiskDF) {
+        if (!batched_df_ and memory_plan_ and !dsrg_mem_.fits(dsrg_mem_.compute_memory({"Lph"}))) {
+            batched_df_ = true;
+            dsrg_mem_.add_plan_entry("3-index integrals (memory plan)", "BATCHED");
+        }
+        if (!batched_df_) {
             dsrg_mem_.add_entry("3-index auxiliary integrals", {"Lph"});
         }
     } else {
@@ -218,7 +284,7 @@ void SA_MRPT2::check_memory() {
     }
 
     // local memory for computing minimal V
-    if (ints_->integral_type() == DiskDF) {
+    if (batched_df_) {
         dsrg_mem_.add_entry("Local 3-index integrals", {"Lca", "Laa", "Lav"}, 1, false);
     }
 
@@ -255,10 +321,23 @@ void SA_MRPT2::check_memory() {
                             {"avac", "aaac", "avaa", "paaa", "aaaa"}, 1, false);
     }
 
+    plan_cu3_memory();
+
     dsrg_mem_.print("DSRG-MRPT2");
 }
 
 double SA_MRPT2::compute_energy() {
+    compute_energy_cu3_independent();
+    return compute_energy_cu3_dependent();
+}
+
+double SA_MRPT2::compute_energy_pipelined(std::function<RDMs()> rdms_task) {
+    run_with_rdms_task(rdms_task, [&]() { compute_energy_cu3_independent(); });
+    print_cumulant_summary();
+    return compute_energy_cu3_dependent();
+}
+
+void SA_MRPT2::compute_energy_cu3_independent() {
     // build amplitudes
     compute_t2();
     compute_t1();
@@ -268,23 +347,37 @@ double SA_MRPT2::compute_energy() {
     renormalize_integrals(true);
 
     // compute energy
-    double Ecorr = 0.0;
+    Ecorr_partial_ = 0.0;
 
     local_timer lt;
     print_contents("Computing <0|[Fr, T1]|0>");
-    double E_FT1 = H1_T1_C0(F_, T1_, 1.0, Ecorr);
+    E_FT1_ = H1_T1_C0(F_, T1_, 1.0, Ecorr_partial_);
     print_done(lt.get());
 
     lt.reset();
     print_contents("Computing <0|[Fr, T2]|0>");
-    double E_FT2 = H1_T2_C0(F_, T2_, 1.0, Ecorr);
+    E_FT2_ = H1_T2_C0(F_, T2_, 1.0, Ecorr_partial_);
     print_done(lt.get());
 
     lt.reset();
     print_contents("Computing <0|[Vr, T1]|0>");
-    double E_VT1 = H2_T1_C0(V_, T1_, 1.0, Ecorr);
+    E_VT1_ = H2_T1_C0(V_, T1_, 1.0, Ecorr_partial_);
     print_done(lt.get());
 
+    // the DF terms with at least one core and one virtual index only need the 1-RDM
+    E_VT2_df_ = {0.0, 0.0, 0.0};
+    if (eri_df_) {
+        E_VT2_df_[0] = E_V_T2_CCVV();
+        E_VT2_df_[1] = E_V_T2_CAVV();
+        E_VT2_df_[2] = E_V_T2_CCAV();
+    }
+}
+
+double SA_MRPT2::compute_energy_cu3_dependent() {
+    double Ecorr = Ecorr_partial_;
+    double E_FT1 = E_FT1_, E_FT2 = E_FT2_, E_VT1 = E_VT1_;
+
+    local_timer lt;
     std::vector<double> E_VT2_comp;
     if (!eri_df_) {
         lt.reset();
@@ -297,9 +390,9 @@ double SA_MRPT2::compute_energy() {
         E_VT2_comp = H2_T2_C0_T2small(V_, T2_, S2_);
         print_done(lt.get());
 
-        auto Eccvv = E_V_T2_CCVV();
-        auto Ecavv = E_V_T2_CAVV();
-        auto Eccav = E_V_T2_CCAV();
+        auto Eccvv = E_VT2_df_[0];
+        auto Ecavv = E_VT2_df_[1];
+        auto Eccav = E_VT2_df_[2];
 
         E_VT2_comp[0] += Eccvv + Ecavv + Eccav;
         Ecorr += E_VT2_comp[0] + E_VT2_comp[1] + E_VT2_comp[2];
@@ -358,10 +451,7 @@ void SA_MRPT2::compute_t2_df_minimal() {
     }
 
     // build T2
-    T2_.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>&, double& value) {
-        double denom = Fdiag_[i[0]] + Fdiag_[i[1]] - Fdiag_[i[2]] - Fdiag_[i[3]];
-        value *= dsrg_source_->compute_renormalized_denominator(denom);
-    });
+    scale_by_source(T2_, T2_.block_labels(), SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -394,6 +484,17 @@ void SA_MRPT2::compute_t2() {
     t2.stop();
 }
 
+ambit::Tensor SA_MRPT2::sort_batch(ambit::Tensor B, const std::string& block) {
+    auto dims = B.dims();
+    auto X = ambit::Tensor::build(tensor_type_, B.name() + " sorted", {dims[2], dims[0], dims[1]});
+    if (semi_canonical_) {
+        X("xgp") = B("gpx");
+    } else {
+        X("xgq") = B("gpx") * U_.block(block)("qp");
+    }
+    return X;
+}
+
 std::vector<ambit::Tensor> SA_MRPT2::init_tensor_vecs(int number_of_tensors) {
     std::vector<ambit::Tensor> out;
     out.reserve(number_of_tensors);
@@ -401,7 +502,15 @@ std::vector<ambit::Tensor> SA_MRPT2::init_tensor_vecs(int number_of_tensors) {
 }
 
 double SA_MRPT2::E_V_T2_CCVV() {
-    if (ints_->integral_type() == DiskDF) {
+    if (local_ccvv_) {
+        return compute_Hbar0_CCVV_local();
+    }
+    if (use_device_) {
+#ifdef HAVE_CUDA
+        return compute_Hbar0_CCVV_device();
+#endif
+    }
+    if (batched_df_) {
         return compute_Hbar0_CCVV_diskDF();
     } else {
         return compute_Hbar0_CCVV_DF();
@@ -434,7 +543,6 @@ double SA_MRPT2::compute_Hbar0_CCVV_DF() {
     std::vector<ambit::Tensor> Bm_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> Bn_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> J_vec = init_tensor_vecs(n_threads);
-    std::vector<ambit::Tensor> JK_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> Xm_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> Xn_vec = init_tensor_vecs(n_threads);
 
@@ -443,7 +551,6 @@ double SA_MRPT2::compute_Hbar0_CCVV_DF() {
         Bm_vec.push_back(ambit::Tensor::build(tensor_type_, "Bm_thread" + t, {nQ, nv}));
         Bn_vec.push_back(ambit::Tensor::build(tensor_type_, "Bn_thread" + t, {nQ, nv}));
         J_vec.push_back(ambit::Tensor::build(tensor_type_, "J_thread" + t, {nv, nv}));
-        JK_vec.push_back(ambit::Tensor::build(tensor_type_, "(2J - K) thread" + t, {nv, nv}));
     }
     if (!semi_canonical_) {
         for (int i = 0; i < n_threads; i++) {
@@ -453,8 +560,14 @@ double SA_MRPT2::compute_Hbar0_CCVV_DF() {
         }
     }
 
+    // scratch for the fused energy pass and the virtual diagonal Fock elements
+    std::vector<std::vector<double>> W_vec(n_threads, std::vector<double>(2 * nv));
+    std::vector<double> Fv(nv);
+    for (size_t e = 0; e < nv; ++e) {
+        Fv[e] = Fdiag_[virt_mos_[e]];
+    }
+
     double E = 0.0;
-    bool complete_ccvv = (ccvv_source_ == "ZERO");
 
 #pragma omp parallel for num_threads(n_threads) reduction(+ : E)
     for (size_t m = 0; m < nc; ++m) {
@@ -487,19 +600,7 @@ double SA_MRPT2::compute_Hbar0_CCVV_DF() {
             }
 
             J_vec[thread]("ef") = Bm_vec[thread]("ge") * Bn_vec[thread]("gf");
-            JK_vec[thread]("ef") = 2.0 * J_vec[thread]("ef") - J_vec[thread]("fe");
-
-            J_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                double D = Fm + Fn - Fdiag_[virt_mos_[i[0]]] - Fdiag_[virt_mos_[i[1]]];
-                if (complete_ccvv)
-                    value /= D;
-                else {
-                    double rV = 1.0 + dsrg_source_->compute_renormalized(D);
-                    value *= dsrg_source_->compute_renormalized_denominator(D) * rV;
-                }
-            });
-
-            E += factor * J_vec[thread]("ef") * JK_vec[thread]("ef");
+            E += factor * ccvv_pair_energy(J_vec[thread].data().data(), Fm + Fn, Fv, W_vec[thread]);
         }
     }
 
@@ -507,6 +608,40 @@ double SA_MRPT2::compute_Hbar0_CCVV_DF() {
     return E;
 }
 
+double SA_MRPT2::ccvv_pair_energy(const double* J, double Fmn, const std::vector<double>& Fv,
+                                  std::vector<double>& buffer) {
+    const size_t nv = Fv.size();
+    double* D = buffer.data();
+    double* w = buffer.data() + nv;
+    const bool complete_ccvv = (ccvv_source_ == "ZERO");
+
+    double E = 0.0;
+    for (size_t e = 0; e < nv; ++e) {
+        const double Fmne = Fmn - Fv[e];
+#pragma omp simd
+        for (size_t f = 0; f < nv; ++f) {
+            D[f] = Fmne - Fv[f];
+        }
+        if (complete_ccvv) {
+#pragma omp simd
+            for (size_t f = 0; f < nv; ++f) {
+                w[f] = 1.0 / D[f];
+            }
+        } else {
+            dsrg_source_->compute_energy_weights(D, w, nv);
+        }
+
+        const double* Je = J + e * nv;
+        double Ee = 0.0;
+#pragma omp simd reduction(+ : Ee)
+        for (size_t f = 0; f < nv; ++f) {
+            Ee += Je[f] * (2.0 * Je[f] - J[f * nv + e]) * w[f];
+        }
+        E += Ee;
+    }
+    return E;
+}
+
 double SA_MRPT2::compute_Hbar0_CCVV_diskDF() {
     /**
      * Compute <[V, T2]> (C_2)^4 ccvv term
@@ -529,8 +664,9 @@ double SA_MRPT2::compute_Hbar0_CCVV_diskDF() {
                         n_threads);
     }
 
-    size_t max_num_Qv = (dsrg_mem_.available() - n_threads * mem_batched_["ccvv"]) * 0.8 /
-                        (sizeof(double) * nQ * nv * 2);
+    // the batches of m and n, and the batch read and sorted ahead
+    size_t max_num_Qv =
+        dsrg_mem_.max_batch_size(sizeof(double) * nQ * nv * 4, n_threads * mem_batched_["ccvv"]);
     if (max_num_Qv < 2) { // no point to do this batching anymore
         return compute_Hbar0_CCVV_DF();
     }
@@ -546,31 +682,39 @@ double SA_MRPT2::compute_Hbar0_CCVV_diskDF() {
     std::vector<ambit::Tensor> Bm_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> Bn_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> J_vec = init_tensor_vecs(n_threads);
-    std::vector<ambit::Tensor> JK_vec = init_tensor_vecs(n_threads);
-    std::vector<ambit::Tensor> Xm_vec = init_tensor_vecs(n_threads);
-    std::vector<ambit::Tensor> Xn_vec = init_tensor_vecs(n_threads);
 
     for (int i = 0; i < n_threads; i++) {
         std::string t = std::to_string(i);
         Bm_vec.push_back(ambit::Tensor::build(tensor_type_, "Bm_thread" + t, {nQ, nv}));
         Bn_vec.push_back(ambit::Tensor::build(tensor_type_, "Bn_thread" + t, {nQ, nv}));
         J_vec.push_back(ambit::Tensor::build(tensor_type_, "J_thread" + t, {nv, nv}));
-        JK_vec.push_back(ambit::Tensor::build(tensor_type_, "(2J - K) thread" + t, {nv, nv}));
     }
-    if (!semi_canonical_) {
-        for (int i = 0; i < n_threads; i++) {
-            std::string t = std::to_string(i);
-            Xm_vec.push_back(ambit::Tensor::build(tensor_type_, "Xm_thread" + t, {nQ, nv}));
-            Xn_vec.push_back(ambit::Tensor::build(tensor_type_, "Xn_thread" + t, {nQ, nv}));
-        }
+
+    // scratch for the fused energy pass and the virtual diagonal Fock elements
+    std::vector<std::vector<double>> W_vec(n_threads, std::vector<double>(2 * nv));
+    std::vector<double> Fv(nv);
+    for (size_t e = 0; e < nv; ++e) {
+        Fv[e] = Fdiag_[virt_mos_[e]];
     }
 
     double E = 0.0;
-    bool complete_ccvv = (ccvv_source_ == "ZERO");
 
+    // the batches are read in this order: M, then all the N > M
+    std::vector<size_t> read_sequence;
+    for (size_t Mbatch = 0; Mbatch < nbatch; ++Mbatch) {
+        for (size_t Nbatch = Mbatch; Nbatch < nbatch; ++Nbatch) {
+            read_sequence.push_back(Nbatch);
+        }
+    }
+    BatchReader reader(read_sequence.size(), [&](size_t n) {
+        auto B = ints_->three_integral_block(aux_mos_, virt_mos_, core_batches[read_sequence[n]]);
+        return sort_batch(B, "vv");
+    });
+
+    const size_t nQv = nQ * nv;
     for (size_t Mbatch = 0; Mbatch < nbatch; ++Mbatch) {
         auto Mbatch_size = core_batches[Mbatch].size();
-        auto BM = ints_->three_integral_block(aux_mos_, virt_mos_, core_batches[Mbatch]);
+        auto BM = reader.next();
         auto& BM_data = BM.data();
 
         // indices m and n belong to the same batch
@@ -580,54 +724,27 @@ double SA_MRPT2::compute_Hbar0_CCVV_diskDF() {
             double Fm = Fdiag_[im];
 
             int thread = omp_get_thread_num();
-#pragma omp critical
-            {
-                Bm_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                    value = BM_data[i[0] * Mbatch_size * nv + i[1] * Mbatch_size + m];
-                });
-                if (!semi_canonical_) {
-                    Xm_vec[thread]("gf") = Bm_vec[thread]("ge") * U_.block("vv")("fe");
-                    Bm_vec[thread]("gf") = Xm_vec[thread]("gf");
-                }
-            }
+            auto Bm_it = BM_data.begin() + m * nQv;
+            std::copy(Bm_it, Bm_it + nQv, Bm_vec[thread].data().begin());
 
             for (size_t n = m; n < Mbatch_size; ++n) {
                 auto in = core_batches[Mbatch][n];
                 double Fn = Fdiag_[in];
                 double factor = (m < n) ? 2.0 : 1.0;
 
-#pragma omp critical
-                {
-                    Bn_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                        value = BM_data[i[0] * Mbatch_size * nv + i[1] * Mbatch_size + n];
-                    });
-                    if (!semi_canonical_) {
-                        Xn_vec[thread]("gf") = Bn_vec[thread]("ge") * U_.block("vv")("fe");
-                        Bn_vec[thread]("gf") = Xn_vec[thread]("gf");
-                    }
-                }
+                auto Bn_it = BM_data.begin() + n * nQv;
+                std::copy(Bn_it, Bn_it + nQv, Bn_vec[thread].data().begin());
 
                 J_vec[thread]("ef") = Bm_vec[thread]("ge") * Bn_vec[thread]("gf");
-                JK_vec[thread]("ef") = 2.0 * J_vec[thread]("ef") - J_vec[thread]("fe");
-
-                J_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                    double D = Fm + Fn - Fdiag_[virt_mos_[i[0]]] - Fdiag_[virt_mos_[i[1]]];
-                    if (complete_ccvv)
-                        value /= D;
-                    else {
-                        double rV = 1.0 + dsrg_source_->compute_renormalized(D);
-                        value *= dsrg_source_->compute_renormalized_denominator(D) * rV;
-                    }
-                });
-
-                E += factor * J_vec[thread]("ef") * JK_vec[thread]("ef");
+                E += factor *
+                     ccvv_pair_energy(J_vec[thread].data().data(), Fm + Fn, Fv, W_vec[thread]);
             }
         }
 
         // indices m and n belong to different batches
         for (size_t Nbatch = Mbatch + 1; Nbatch < nbatch; ++Nbatch) {
             auto Nbatch_size = core_batches[Nbatch].size();
-            auto BN = ints_->three_integral_block(aux_mos_, virt_mos_, core_batches[Nbatch]);
+            auto BN = reader.next();
             auto& BN_data = BN.data();
 
 #pragma omp parallel for num_threads(n_threads) reduction(+ : E)
@@ -636,46 +753,19 @@ double SA_MRPT2::compute_Hbar0_CCVV_diskDF() {
                 double Fm = Fdiag_[im];
 
                 int thread = omp_get_thread_num();
-#pragma omp critical
-                {
-                    Bm_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                        value = BM_data[i[0] * Mbatch_size * nv + i[1] * Mbatch_size + m];
-                    });
-                    if (!semi_canonical_) {
-                        Xm_vec[thread]("gf") = Bm_vec[thread]("ge") * U_.block("vv")("fe");
-                        Bm_vec[thread]("gf") = Xm_vec[thread]("gf");
-                    }
-                }
+                auto Bm_it = BM_data.begin() + m * nQv;
+                std::copy(Bm_it, Bm_it + nQv, Bm_vec[thread].data().begin());
 
                 for (size_t n = 0; n < Nbatch_size; ++n) {
                     auto in = core_batches[Nbatch][n];
                     double Fn = Fdiag_[in];
 
-#pragma omp critical
-                    {
-                        Bn_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                            value = BN_data[i[0] * Nbatch_size * nv + i[1] * Nbatch_size + n];
-                        });
-                        if (!semi_canonical_) {
-                            Xn_vec[thread]("gf") = Bn_vec[thread]("ge") * U_.block("vv")("fe");
-                            Bn_vec[thread]("gf") = Xn_vec[thread]("gf");
-                        }
-                    }
+                    auto Bn_it = BN_data.begin() + n * nQv;
+                    std::copy(Bn_it, Bn_it + nQv, Bn_vec[thread].data().begin());
 
                     J_vec[thread]("ef") = Bm_vec[thread]("ge") * Bn_vec[thread]("gf");
-                    JK_vec[thread]("ef") = 2.0 * J_vec[thread]("ef") - J_vec[thread]("fe");
-
-                    J_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                        double D = Fm + Fn - Fdiag_[virt_mos_[i[0]]] - Fdiag_[virt_mos_[i[1]]];
-                        if (complete_ccvv)
-                            value /= D;
-                        else {
-                            double rV = 1.0 + dsrg_source_->compute_renormalized(D);
-                            value *= dsrg_source_->compute_renormalized_denominator(D) * rV;
-                        }
-                    });
-
-                    E += 2.0 * J_vec[thread]("ef") * JK_vec[thread]("ef");
+                    E += 2.0 *
+                         ccvv_pair_energy(J_vec[thread].data().data(), Fm + Fn, Fv, W_vec[thread]);
                 }
             }
         }
@@ -691,7 +781,11 @@ double SA_MRPT2::E_V_T2_CAVV() {
     auto na = actv_mos_.size();
     auto C1 = ambit::Tensor::build(tensor_type_, "C1 VT2 CAVV", {na, na});
 
-    if (ints_->integral_type() == DiskDF) {
+    if (use_device_) {
+#ifdef HAVE_CUDA
+        compute_Hbar1V_device(C1, true);
+#endif
+    } else if (batched_df_) {
         compute_Hbar1V_diskDF(C1, true);
     } else {
         compute_Hbar1V_DF(C1, true);
@@ -848,8 +942,9 @@ void SA_MRPT2::compute_Hbar1V_diskDF(ambit::Tensor& Hbar1, bool Vr) {
                         n_threads);
     }
 
-    size_t max_num_Qv = (dsrg_mem_.available() - n_threads * mem_batched_["cavv"]) * 0.8 /
-                        (sizeof(double) * nQ * nv);
+    // the current batch, and the batch read and sorted ahead
+    size_t max_num_Qv =
+        dsrg_mem_.max_batch_size(sizeof(double) * nQ * nv * 3, n_threads * mem_batched_["cavv"]);
     if (max_num_Qv < 2) { // no point to do this batching anymore
         compute_Hbar1V_DF(Hbar1, Vr);
         return;
@@ -867,7 +962,6 @@ void SA_MRPT2::compute_Hbar1V_diskDF(ambit::Tensor& Hbar1, bool Vr) {
     std::vector<ambit::Tensor> V_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> S_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> C_vec = init_tensor_vecs(n_threads);
-    std::vector<ambit::Tensor> X_vec = init_tensor_vecs(n_threads);
 
     for (int i = 0; i < n_threads; i++) {
         std::string t = std::to_string(i);
@@ -876,12 +970,6 @@ void SA_MRPT2::compute_Hbar1V_diskDF(ambit::Tensor& Hbar1, bool Vr) {
         S_vec.push_back(ambit::Tensor::build(tensor_type_, "S_thread" + t, {nv, nv, na}));
         C_vec.push_back(ambit::Tensor::build(tensor_type_, "C_thread" + t, {na, na}));
     }
-    if (!semi_canonical_) {
-        for (int i = 0; i < n_threads; i++) {
-            std::string t = std::to_string(i);
-            X_vec.push_back(ambit::Tensor::build(tensor_type_, "X_thread" + t, {nQ, nv}));
-        }
-    }
 
     auto Bva = ints_->three_integral_block(aux_mos_, virt_mos_, actv_mos_);
     if (!semi_canonical_) {
@@ -890,9 +978,15 @@ void SA_MRPT2::compute_Hbar1V_diskDF(ambit::Tensor& Hbar1, bool Vr) {
         Bva("gfv") = X("gev") * U_.block("vv")("fe");
     }
 
+    BatchReader reader(nbatch, [&](size_t n) {
+        auto B = ints_->three_integral_block(aux_mos_, virt_mos_, core_batches[n]);
+        return sort_batch(B, "vv");
+    });
+
+    const size_t nQv = nQ * nv;
     for (size_t Mbatch = 0; Mbatch < nbatch; ++Mbatch) {
         auto Mbatch_size = core_batches[Mbatch].size();
-        auto BM = ints_->three_integral_block(aux_mos_, virt_mos_, core_batches[Mbatch]);
+        auto BM = reader.next();
         auto& BM_data = BM.data();
 
 #pragma omp parallel for num_threads(n_threads)
@@ -901,16 +995,8 @@ void SA_MRPT2::compute_Hbar1V_diskDF(ambit::Tensor& Hbar1, bool Vr) {
             double Fm = Fdiag_[im];
 
             int thread = omp_get_thread_num();
-#pragma omp critical
-            {
-                Bm_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                    value = BM_data[i[0] * Mbatch_size * nv + i[1] * Mbatch_size + m];
-                });
-                if (!semi_canonical_) {
-                    X_vec[thread]("gf") = Bm_vec[thread]("ge") * U_.block("vv")("fe");
-                    Bm_vec[thread]("gf") = X_vec[thread]("gf");
-                }
-            }
+            auto Bm_it = BM_data.begin() + m * nQv;
+            std::copy(Bm_it, Bm_it + nQv, Bm_vec[thread].data().begin());
 
             V_vec[thread]("efu") = Bm_vec[thread]("ge") * Bva("gfu");
             S_vec[thread]("efu") = 2.0 * V_vec[thread]("efu") - V_vec[thread]("feu");
@@ -959,7 +1045,11 @@ double SA_MRPT2::E_V_T2_CCAV() {
     auto na = actv_mos_.size();
     auto C1 = ambit::Tensor::build(tensor_type_, "C1 VT2 CCAV", {na, na});
 
-    if (ints_->integral_type() == DiskDF) {
+    if (use_device_) {
+#ifdef HAVE_CUDA
+        compute_Hbar1C_device(C1, true);
+#endif
+    } else if (batched_df_) {
         compute_Hbar1C_diskDF(C1, true);
     } else {
         compute_Hbar1C_DF(C1, true);
@@ -1116,8 +1206,9 @@ void SA_MRPT2::compute_Hbar1C_diskDF(ambit::Tensor& Hbar1, bool Vr) {
                         n_threads);
     }
 
-    size_t max_num_Qc = (dsrg_mem_.available() - n_threads * mem_batched_["ccav"]) * 0.8 /
-                        (sizeof(double) * nQ * nc);
+    // the current batch, and the batch read and sorted ahead
+    size_t max_num_Qc =
+        dsrg_mem_.max_batch_size(sizeof(double) * nQ * nc * 3, n_threads * mem_batched_["ccav"]);
     if (max_num_Qc < 2) { // no point to do this batching anymore
         compute_Hbar1C_DF(Hbar1, Vr);
         return;
@@ -1135,7 +1226,6 @@ void SA_MRPT2::compute_Hbar1C_diskDF(ambit::Tensor& Hbar1, bool Vr) {
     std::vector<ambit::Tensor> V_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> S_vec = init_tensor_vecs(n_threads);
     std::vector<ambit::Tensor> C_vec = init_tensor_vecs(n_threads);
-    std::vector<ambit::Tensor> X_vec = init_tensor_vecs(n_threads);
 
     for (int i = 0; i < n_threads; i++) {
         std::string t = std::to_string(i);
@@ -1144,12 +1234,6 @@ void SA_MRPT2::compute_Hbar1C_diskDF(ambit::Tensor& Hbar1, bool Vr) {
         S_vec.push_back(ambit::Tensor::build(tensor_type_, "S_thread" + t, {na, nc, nc}));
         C_vec.push_back(ambit::Tensor::build(tensor_type_, "C_thread" + t, {na, na}));
     }
-    if (!semi_canonical_) {
-        for (int i = 0; i < n_threads; i++) {
-            std::string t = std::to_string(i);
-            X_vec.push_back(ambit::Tensor::build(tensor_type_, "X_thread" + t, {nQ, nc}));
-        }
-    }
 
     auto Bac = ints_->three_integral_block(aux_mos_, actv_mos_, core_mos_);
     if (!semi_canonical_) {
@@ -1158,27 +1242,25 @@ void SA_MRPT2::compute_Hbar1C_diskDF(ambit::Tensor& Hbar1, bool Vr) {
         Bac("gvn") = X("gun") * U_.block("aa")("vu");
     }
 
+    BatchReader reader(nbatch, [&](size_t n) {
+        auto B = ints_->three_integral_block(aux_mos_, core_mos_, virt_batches[n]);
+        return sort_batch(B, "cc");
+    });
+
+    const size_t nQc = nQ * nc;
     for (size_t Ebatch = 0; Ebatch < nbatch; ++Ebatch) {
         auto Ebatch_size = virt_batches[Ebatch].size();
-        auto BE = ints_->three_integral_block(aux_mos_, core_mos_, virt_batches[Ebatch]);
+        auto BE = reader.next();
         auto& BE_data = BE.data();
 
-#pragma omp parallel for num_threads(n_threads_)
+#pragma omp parallel for num_threads(n_threads)
         for (size_t e = 0; e < Ebatch_size; ++e) {
             auto ie = virt_batches[Ebatch][e];
             double Fe = Fdiag_[ie];
 
             int thread = omp_get_thread_num();
-#pragma omp critical
-            {
-                Be_vec[thread].iterate([&](const std::vector<size_t>& i, double& value) {
-                    value = BE_data[i[0] * Ebatch_size * nc + i[1] * Ebatch_size + e];
-                });
-                if (!semi_canonical_) {
-                    X_vec[thread]("gn") = Be_vec[thread]("gm") * U_.block("cc")("nm");
-                    Be_vec[thread]("gn") = X_vec[thread]("gn");
-                }
-            }
+            auto Be_it = BE_data.begin() + e * nQc;
+            std::copy(Be_it, Be_it + nQc, Be_vec[thread].data().begin());
 
             V_vec[thread]("vmn") = Bac("gvm") * Be_vec[thread]("gn");
             S_vec[thread]("vmn") = 2.0 * V_vec[thread]("vmn") - V_vec[thread]("vnm");
@@ -35,6 +35,8 @@ using namespace ambit;
 
 namespace forte {
 
+class DSRGPT2Device;
+
 class SA_MRPT2 : public SA_DSRGPT {
   public:
     /**
@@ -50,6 +52,9 @@ class SA_MRPT2 : public SA_DSRGPT {
     /// Compute the corr_level energy with fixed reference
     double compute_energy() override;
 
+    /// Compute the energy while the 3-RDM is built, see SADSRG::compute_energy_pipelined
+    double compute_energy_pipelined(std::function<RDMs()> rdms_task) override;
+
   protected:
     /// Start-up function called in the constructor
     void startup();
@@ -65,8 +70,23 @@ class SA_MRPT2 : public SA_DSRGPT {
     /// Check memory
     void check_memory();
 
+    /// Compute the amplitudes and the energy terms that do not depend on the 3-cumulant
+    void compute_energy_cu3_independent();
+    /// Compute the remaining energy terms and return the total energy
+    double compute_energy_cu3_dependent();
+
+    /// Energy terms computed by compute_energy_cu3_independent()
+    double Ecorr_partial_;
+    double E_FT1_;
+    double E_FT2_;
+    double E_VT1_;
+    /// The DF CCVV, CAVV, and CCAV energies
+    std::vector<double> E_VT2_df_;
+
     /// Memory requirements for the three batched energy terms
     std::map<std::string, size_t> mem_batched_;
+    /// Read the 3-index integrals in batches (the DiskDF algorithms) if true
+    bool batched_df_;
 
     /// Compute 1st-order T2 amplitudes
     void compute_t2();
@@ -84,6 +104,37 @@ class SA_MRPT2 : public SA_DSRGPT {
     double compute_Hbar0_CCVV_DF();
     /// Energy contribution from CCVV block using DiskDF integrals
     double compute_Hbar0_CCVV_diskDF();
+    /**
+     * @brief Fused energy pass over J(ef) = (me|nf) of one core pair
+     * @param J the nv x nv block of J, as returned by the DGEMM
+     * @param Fmn the sum of the core diagonal Fock elements Fm + Fn
+     * @param Fv the diagonal Fock elements of the virtual orbitals
+     * @param buffer scratch of size 2 * nv
+     * @return sum_ef J_ef * (2 J_ef - J_fe) * w(Fmn - Fe - Ff), with w the energy weight
+     *
+     * The denominators and weights are formed one row at a time, so J is read once while
+     * it is still in cache.
+     */
+    double ccvv_pair_energy(const double* J, double Fmn, const std::vector<double>& Fv,
+                            std::vector<double>& buffer);
+
+    /// Compute the CCVV term in localized core orbitals if true (DSRG_PT2_LOCAL)
+    bool local_ccvv_ = false;
+    /// Energy contribution from CCVV block using localized core orbitals and pair screening
+    double compute_Hbar0_CCVV_local();
+
+    /// Compute the DF contractions on the device if true (DSRG_PT2_DEVICE = GPU)
+    bool use_device_ = false;
+    /// The device backend, created when first used
+    std::shared_ptr<DSRGPT2Device> device_;
+    /// Return the device backend
+    std::shared_ptr<DSRGPT2Device> device();
+    /// Energy contribution from CCVV block computed on the device
+    double compute_Hbar0_CCVV_device();
+    /// Compute Hbar1 from core contraction on the device, renormalize V if Vr is true
+    void compute_Hbar1C_device(ambit::Tensor& Hbar1, bool Vr = true);
+    /// Compute Hbar1 from virtual contraction on the device, renormalize V if Vr is true
+    void compute_Hbar1V_device(ambit::Tensor& Hbar1, bool Vr = true);
 
     /// Compute DSRG-transformed Hamiltonian
     void compute_hbar();
@@ -102,6 +153,16 @@ class SA_MRPT2 : public SA_DSRGPT {
     /// C1 = [Vr, T2] CCAV from compute_Hbar1C_diskDF
     ambit::Tensor C1_VT2_CCAV_;
 
+    /**
+     * @brief Sort a batch of 3-index integrals B(L|p x) to B(x|L p)
+     * @param B the batch, with x the batched index
+     * @param block the block of U_ that rotates p to the semicanonical basis (e.g., "vv"),
+     *        used if the orbitals are not semicanonical
+     *
+     * The integrals of one x are then contiguous and can be copied without index arithmetic.
+     */
+    ambit::Tensor sort_batch(ambit::Tensor B, const std::string& block);
+
     /// Return a vector of empty ambit Tensor objects
     std::vector<ambit::Tensor> init_tensor_vecs(int number_of_tensors);
 
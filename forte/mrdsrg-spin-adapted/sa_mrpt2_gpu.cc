@@ -0,0 +1,209 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+
+#include "psi4/libpsi4util/PsiOutStream.h"
+
+#include "helpers/printing.h"
+#include "helpers/timer.h"
+#include "sa_mrpt2.h"
+#include "sa_mrpt2_gpu_kernels.h"
+
+using namespace psi;
+
+namespace forte {
+
+std::shared_ptr<DSRGPT2Device> SA_MRPT2::device() {
+    if (device_ == nullptr) {
+        auto source = DSRGPT2Device::Source::Standard;
+        if (source_ == "LABS") {
+            source = DSRGPT2Device::Source::Labs;
+        } else if (source_ == "DYSON") {
+            source = DSRGPT2Device::Source::Dyson;
+        }
+        device_ = std::make_shared<DSRGPT2Device>(source, s_);
+    }
+    return device_;
+}
+
+double SA_MRPT2::compute_Hbar0_CCVV_device() {
+    /**
+     * Compute <[V, T2]> (C_2)^4 ccvv term on the device (see compute_Hbar0_CCVV_DF)
+     *
+     * Batching: B(L|me) is streamed in batches of m, J(me,nf) is formed for pairs of batches
+     */
+    timer t_ccvv("Compute CCVV energy term GPU");
+    print_contents("Computing GPU <0|[Vr, T2]|0> CCVV");
+
+    auto nQ = aux_mos_.size();
+    auto nv = virt_mos_.size();
+    auto nc = core_mos_.size();
+
+    std::vector<double> Fc(nc), Fv(nv);
+    std::transform(core_mos_.begin(), core_mos_.end(), Fc.begin(),
+                   [&](size_t p) { return Fdiag_[p]; });
+    std::transform(virt_mos_.begin(), virt_mos_.end(), Fv.begin(),
+                   [&](size_t p) { return Fdiag_[p]; });
+
+    auto load = [&](size_t start, size_t n, double* data) {
+        std::vector<size_t> mos(core_mos_.begin() + start, core_mos_.begin() + start + n);
+        auto B = ints_->three_integral_block(aux_mos_, mos, virt_mos_);
+        if (!semi_canonical_) {
+            auto X = ambit::Tensor::build(tensor_type_, "X", {nQ, n, nv});
+            X("gmf") = B("gme") * U_.block("vv")("fe");
+            B = X;
+        }
+        std::copy(B.data().begin(), B.data().end(), data);
+    };
+
+    // host memory: the resident batch, the two streamed batches, and the loaded tensors
+    auto max_batch = dsrg_mem_.max_batch_size(sizeof(double) * nQ * nv * 5);
+    double E = device()->ccvv_energy(nQ, Fc, Fv, max_batch, ccvv_source_ == "ZERO", load);
+
+    print_done(t_ccvv.stop());
+    return E;
+}
+
+void SA_MRPT2::compute_Hbar1V_device(ambit::Tensor& Hbar1, bool Vr) {
+    /**
+     * Compute Hbar1["vu"] += V["efmu"] * S["mvef"] on the device (see compute_Hbar1V_DF)
+     *
+     * Batching: B(L|me) is streamed in batches of m
+     */
+    timer t("Compute C1 virtual contraction GPU");
+    print_contents("Computing GPU Hbar1 CAVV");
+
+    auto nQ = aux_mos_.size();
+    auto nv = virt_mos_.size();
+    auto nc = core_mos_.size();
+    auto na = actv_mos_.size();
+
+    std::vector<double> Fc(nc), Fa(na), Fv(nv);
+    std::transform(core_mos_.begin(), core_mos_.end(), Fc.begin(),
+                   [&](size_t p) { return Fdiag_[p]; });
+    std::transform(actv_mos_.begin(), actv_mos_.end(), Fa.begin(),
+                   [&](size_t p) { return Fdiag_[p]; });
+    std::transform(virt_mos_.begin(), virt_mos_.end(), Fv.begin(),
+                   [&](size_t p) { return Fdiag_[p]; });
+
+    auto Bva = ints_->three_integral_block(aux_mos_, virt_mos_, actv_mos_);
+    if (!semi_canonical_) {
+        auto X = ambit::Tensor::build(tensor_type_, "tempCAVV", {nQ, nv, na});
+        X("gev") = Bva("geu") * U_.block("aa")("vu");
+        Bva("gfv") = X("gev") * U_.block("vv")("fe");
+    }
+
+    auto load = [&](size_t start, size_t n, double* data) {
+        std::vector<size_t> mos(core_mos_.begin() + start, core_mos_.begin() + start + n);
+        auto B = ints_->three_integral_block(aux_mos_, mos, virt_mos_);
+        if (!semi_canonical_) {
+            auto X = ambit::Tensor::build(tensor_type_, "X", {nQ, n, nv});
+            X("gmf") = B("gme") * U_.block("vv")("fe");
+            B = X;
+        }
+        std::copy(B.data().begin(), B.data().end(), data);
+    };
+
+    auto C = ambit::Tensor::build(tensor_type_, "C1total_CAVV", {na, na});
+    auto max_batch = dsrg_mem_.max_batch_size(sizeof(double) * nQ * nv * 4,
+                                              dsrg_mem_.compute_memory({"Lva"}));
+    device()->hbar1_virtual(nQ, Fc, Fa, Fv, Bva.data().data(), max_batch, Vr, load,
+                            C.data().data());
+
+    // rotate back to original orbital basis
+    if (!semi_canonical_) {
+        auto X = ambit::Tensor::build(tensor_type_, "tempCAVV", {na, na});
+        X("xv") = C("uv") * U_.block("aa")("ux");
+        C("xy") = X("xv") * U_.block("aa")("vy");
+    }
+
+    Hbar1("uv") += C("uv");
+
+    print_done(t.stop());
+}
+
+void SA_MRPT2::compute_Hbar1C_device(ambit::Tensor& Hbar1, bool Vr) {
+    /**
+     * Compute Hbar1["vu"] += V["vemn"] * S["mnue"] on the device (see compute_Hbar1C_DF)
+     *
+     * Batching: B(L|en) is streamed in batches of e
+     */
+    timer t("Compute C1 core contraction GPU");
+    print_contents("Computing GPU Hbar1 CCAV");
+
+    auto nQ = aux_mos_.size();
+    auto nv = virt_mos_.size();
+    auto nc = core_mos_.size();
+    auto na = actv_mos_.size();
+
+    std::vector<double> Fc(nc), Fa(na), Fv(nv);
+    std::transform(core_mos_.begin(), core_mos_.end(), Fc.begin(),
+                   [&](size_t p) { return Fdiag_[p]; });
+    std::transform(actv_mos_.begin(), actv_mos_.end(), Fa.begin(),
+                   [&](size_t p) { return Fdiag_[p]; });
+    std::transform(virt_mos_.begin(), virt_mos_.end(), Fv.begin(),
+                   [&](size_t p) { return Fdiag_[p]; });
+
+    auto Bac = ints_->three_integral_block(aux_mos_, actv_mos_, core_mos_);
+    if (!semi_canonical_) {
+        auto X = ambit::Tensor::build(tensor_type_, "tempCCAV", {nQ, na, nc});
+        X("gun") = Bac("gum") * U_.block("cc")("nm");
+        Bac("gvn") = X("gun") * U_.block("aa")("vu");
+    }
+
+    auto load = [&](size_t start, size_t n, double* data) {
+        std::vector<size_t> mos(virt_mos_.begin() + start, virt_mos_.begin() + start + n);
+        auto B = ints_->three_integral_block(aux_mos_, mos, core_mos_);
+        if (!semi_canonical_) {
+            auto X = ambit::Tensor::build(tensor_type_, "X", {nQ, n, nc});
+            X("gen") = B("gem") * U_.block("cc")("nm");
+            B = X;
+        }
+        std::copy(B.data().begin(), B.data().end(), data);
+    };
+
+    auto C = ambit::Tensor::build(tensor_type_, "C1total_CCAV", {na, na});
+    auto max_batch = dsrg_mem_.max_batch_size(sizeof(double) * nQ * nc * 4,
+                                              dsrg_mem_.compute_memory({"Lac"}));
+    device()->hbar1_core(nQ, Fc, Fa, Fv, Bac.data().data(), max_batch, Vr, load,
+                         C.data().data());
+
+    // rotate back to original orbital basis
+    if (!semi_canonical_) {
+        auto X = ambit::Tensor::build(tensor_type_, "tempCCAV", {na, na});
+        X("xv") = C("uv") * U_.block("aa")("ux");
+        C("xy") = X("xv") * U_.block("aa")("vy");
+    }
+
+    Hbar1("uv") += C("uv");
+
+    print_done(t.stop());
+}
+
+} // namespace forte
@@ -0,0 +1,498 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+
+#include "sa_mrpt2_gpu_kernels.h"
+
+namespace forte {
+
+namespace {
+
+/// Number of threads per block
+constexpr unsigned int block_size = 128;
+/// Maximum number of blocks launched by a kernel (the kernels loop over the remaining work)
+constexpr size_t max_blocks = 65535;
+
+void check(cudaError_t error, const char* what) {
+    if (error != cudaSuccess) {
+        throw std::runtime_error(std::string("DSRGPT2Device: ") + what +
+                                 " failed: " + cudaGetErrorString(error));
+    }
+}
+
+void check(cublasStatus_t status, const char* what) {
+    if (status != CUBLAS_STATUS_SUCCESS) {
+        throw std::runtime_error(std::string("DSRGPT2Device: ") + what +
+                                 " failed with status " + std::to_string(status));
+    }
+}
+
+unsigned int num_blocks(size_t work) {
+    return static_cast<unsigned int>(
+        std::max<size_t>(1, std::min((work + block_size - 1) / block_size, max_blocks)));
+}
+
+/// The source operator functions of dsrg_source.h
+struct DeviceSource {
+    DSRGPT2Device::Source type;
+    double s;
+
+    /// h(x) = [1 - exp(-x)] / x
+    __device__ static double h(double x) { return x > 0.0 ? -expm1(-x) / x : 1.0; }
+
+    __device__ double renormalized(double D) const {
+        switch (type) {
+        case DSRGPT2Device::Source::Labs:
+            return exp(-s * fabs(D));
+        case DSRGPT2Device::Source::Dyson:
+            return 1.0 / (1.0 + s * D * D);
+        default:
+            return exp(-s * D * D);
+        }
+    }
+
+    __device__ double renormalized_denominator(double D) const {
+        switch (type) {
+        case DSRGPT2Device::Source::Labs:
+            return (D < 0.0 ? -s : s) * h(s * fabs(D));
+        case DSRGPT2Device::Source::Dyson:
+            return s * D / (1.0 + s * D * D);
+        default:
+            return s * D * h(s * D * D);
+        }
+    }
+
+    __device__ double energy_weight(double D) const {
+        return renormalized_denominator(D) * (1.0 + renormalized(D));
+    }
+};
+
+/// Add the partial sums of the threads of a block to E
+__device__ void block_reduce_add(double sum, double* E) {
+    __shared__ double partial[block_size];
+    partial[threadIdx.x] = sum;
+    __syncthreads();
+    for (unsigned int stride = blockDim.x / 2; stride > 0; stride /= 2) {
+        if (threadIdx.x < stride) {
+            partial[threadIdx.x] += partial[threadIdx.x + stride];
+        }
+        __syncthreads();
+    }
+    if (threadIdx.x == 0) {
+        atomicAdd(E, partial[0]);
+    }
+}
+
+/// E += sum J(me,nf) [2 J(me,nf) - J(mf,ne)] w(Fm + Fn - Fe - Ff) over the core pairs of two
+/// batches, with m <= n (and a factor of 2 for m < n) if the two batches are the same
+__global__ void ccvv_energy_kernel(DeviceSource source, bool zero_source, bool same_batch,
+                                   size_t ni, size_t nj, size_t nv, const double* J,
+                                   const double* Fi, const double* Fj, const double* Fv,
+                                   double* E) {
+    const size_t ldj = nj * nv;
+    const size_t size = ni * nv * ldj;
+    double sum = 0.0;
+    for (size_t k = blockIdx.x * size_t(blockDim.x) + threadIdx.x; k < size;
+         k += size_t(gridDim.x) * blockDim.x) {
+        const size_t f = k % nv;
+        const size_t n = (k / nv) % nj;
+        const size_t e = (k / ldj) % nv;
+        const size_t m = k / (ldj * nv);
+        double factor = 2.0;
+        if (same_batch) {
+            if (n < m)
+                continue;
+            if (n == m)
+                factor = 1.0;
+        }
+        const double D = Fi[m] + Fj[n] - Fv[e] - Fv[f];
+        const double w = zero_source ? 1.0 / D : source.energy_weight(D);
+        const double Jk = J[k];
+        sum += factor * Jk * (2.0 * Jk - J[(m * nv + f) * ldj + n * nv + e]) * w;
+    }
+    block_reduce_add(sum, E);
+}
+
+/// S(mefu) = [2 V(mefu) - V(mfeu)] rd(Fm + Fu - Fe - Ff)
+__global__ void virtual_amplitude_kernel(DeviceSource source, size_t ni, size_t nv, size_t na,
+                                         const double* V, double* S, const double* Fi,
+                                         const double* Fa, const double* Fv) {
+    const size_t size = ni * nv * nv * na;
+    for (size_t k = blockIdx.x * size_t(blockDim.x) + threadIdx.x; k < size;
+         k += size_t(gridDim.x) * blockDim.x) {
+        const size_t u = k % na;
+        const size_t f = (k / na) % nv;
+        const size_t e = (k / (na * nv)) % nv;
+        const size_t m = k / (na * nv * nv);
+        const double D = Fi[m] + Fa[u] - Fv[e] - Fv[f];
+        S[k] = (2.0 * V[k] - V[((m * nv + f) * nv + e) * na + u]) *
+               source.renormalized_denominator(D);
+    }
+}
+
+/// V(mefu) *= 1 + r(Fm + Fu - Fe - Ff)
+__global__ void virtual_renormalize_kernel(DeviceSource source, size_t ni, size_t nv, size_t na,
+                                           double* V, const double* Fi, const double* Fa,
+                                           const double* Fv) {
+    const size_t size = ni * nv * nv * na;
+    for (size_t k = blockIdx.x * size_t(blockDim.x) + threadIdx.x; k < size;
+         k += size_t(gridDim.x) * blockDim.x) {
+        const size_t u = k % na;
+        const size_t f = (k / na) % nv;
+        const size_t e = (k / (na * nv)) % nv;
+        const size_t m = k / (na * nv * nv);
+        V[k] *= 1.0 + source.renormalized(Fi[m] + Fa[u] - Fv[e] - Fv[f]);
+    }
+}
+
+/// S(vmen) = [2 V(vmen) - V(vnem)] rd(Fm + Fn - Fe - Fv)
+__global__ void core_amplitude_kernel(DeviceSource source, size_t ni, size_t nc, size_t na,
+                                      const double* V, double* S, const double* Fc,
+                                      const double* Fa, const double* Fi) {
+    const size_t size = na * nc * ni * nc;
+    for (size_t k = blockIdx.x * size_t(blockDim.x) + threadIdx.x; k < size;
+         k += size_t(gridDim.x) * blockDim.x) {
+        const size_t n = k % nc;
+        const size_t e = (k / nc) % ni;
+        const size_t m = (k / (nc * ni)) % nc;
+        const size_t v = k / (nc * ni * nc);
+        const double D = Fc[m] + Fc[n] - Fi[e] - Fa[v];
+        S[k] = (2.0 * V[k] - V[((v * nc + n) * ni + e) * nc + m]) *
+               source.renormalized_denominator(D);
+    }
+}
+
+/// V(vmen) *= 1 + r(Fm + Fn - Fe - Fv)
+__global__ void core_renormalize_kernel(DeviceSource source, size_t ni, size_t nc, size_t na,
+                                        double* V, const double* Fc, const double* Fa,
+                                        const double* Fi) {
+    const size_t size = na * nc * ni * nc;
+    for (size_t k = blockIdx.x * size_t(blockDim.x) + threadIdx.x; k < size;
+         k += size_t(gridDim.x) * blockDim.x) {
+        const size_t n = k % nc;
+        const size_t e = (k / nc) % ni;
+        const size_t m = (k / (nc * ni)) % nc;
+        const size_t v = k / (nc * ni * nc);
+        V[k] *= 1.0 + source.renormalized(Fc[m] + Fc[n] - Fi[e] - Fa[v]);
+    }
+}
+
+/// A block of doubles in device memory, freed when it goes out of scope
+class DeviceArray {
+  public:
+    explicit DeviceArray(size_t n) {
+        check(cudaMalloc(&data_, std::max<size_t>(n, 1) * sizeof(double)), "cudaMalloc");
+    }
+    DeviceArray(const double* data, size_t n) : DeviceArray(n) {
+        check(cudaMemcpy(data_, data, n * sizeof(double), cudaMemcpyHostToDevice), "cudaMemcpy");
+    }
+    explicit DeviceArray(const std::vector<double>& data) : DeviceArray(data.data(), data.size()) {}
+    ~DeviceArray() {
+        // errors are ignored since this is called by the destructor
+        cudaFree(data_);
+    }
+    DeviceArray(const DeviceArray&) = delete;
+    DeviceArray& operator=(const DeviceArray&) = delete;
+
+    double* data() { return data_; }
+
+  private:
+    double* data_ = nullptr;
+};
+
+/**
+ * Two pinned host buffers and two device blocks of batches of integrals. A batch is read by the
+ * host into one buffer and copied asynchronously while the device still works on the batch in
+ * the other one.
+ */
+class BatchStream {
+  public:
+    BatchStream(size_t size, cudaStream_t stream) : size_(size), stream_(stream) {
+        for (int i = 0; i < 2; ++i) {
+            check(cudaMallocHost(&host_[i], std::max<size_t>(size_, 1) * sizeof(double)),
+                  "cudaMallocHost");
+            check(cudaMalloc(&device_[i], std::max<size_t>(size_, 1) * sizeof(double)),
+                  "cudaMalloc");
+            check(cudaEventCreateWithFlags(&copied_[i], cudaEventDisableTiming),
+                  "cudaEventCreate");
+        }
+    }
+    ~BatchStream() {
+        // errors are ignored since this is called by the destructor
+        for (int i = 0; i < 2; ++i) {
+            cudaEventSynchronize(copied_[i]);
+            cudaEventDestroy(copied_[i]);
+            cudaFreeHost(host_[i]);
+            cudaFree(device_[i]);
+        }
+    }
+    BatchStream(const BatchStream&) = delete;
+    BatchStream& operator=(const BatchStream&) = delete;
+
+    /// Load n indices starting from start and return the device copy of the batch. The work
+    /// queued on that copy must be done by the time this function is called twice more
+    const double* load(const DSRGPT2Device::BlockLoader& loader, size_t start, size_t n,
+                       size_t per_index) {
+        const int i = next_;
+        next_ = 1 - next_;
+        // wait until the previous batch in this buffer is copied
+        check(cudaEventSynchronize(copied_[i]), "cudaEventSynchronize");
+        loader(start, n, host_[i]);
+        check(cudaMemcpyAsync(device_[i], host_[i], n * per_index * sizeof(double),
+                              cudaMemcpyHostToDevice, stream_),
+              "cudaMemcpyAsync");
+        check(cudaEventRecord(copied_[i], stream_), "cudaEventRecord");
+        return device_[i];
+    }
+
+  private:
+    size_t size_;
+    cudaStream_t stream_;
+    double* host_[2] = {nullptr, nullptr};
+    double* device_[2] = {nullptr, nullptr};
+    cudaEvent_t copied_[2];
+    int next_ = 0;
+};
+
+} // namespace
+
+DSRGPT2Device::DSRGPT2Device(Source source, double s) : source_(source), s_(s) {
+    cudaStream_t stream;
+    check(cudaStreamCreate(&stream), "cudaStreamCreate");
+    stream_ = stream;
+    cublasHandle_t handle;
+    check(cublasCreate(&handle), "cublasCreate");
+    handle_ = handle;
+    check(cublasSetStream(handle, stream), "cublasSetStream");
+}
+
+DSRGPT2Device::~DSRGPT2Device() {
+    // errors are ignored since this is the destructor
+    cublasDestroy(static_cast<cublasHandle_t>(handle_));
+    cudaStreamDestroy(static_cast<cudaStream_t>(stream_));
+}
+
+size_t DSRGPT2Device::batch_size(size_t max_batch, size_t per_index, size_t per_index2) const {
+    size_t free_bytes = 0, total_bytes = 0;
+    check(cudaMemGetInfo(&free_bytes, &total_bytes), "cudaMemGetInfo");
+    // leave some room for cuBLAS workspaces
+    const double available = 0.9 * static_cast<double>(free_bytes) / sizeof(double);
+    size_t n = max_batch;
+    while (n > 0 and static_cast<double>(per_index * n + per_index2 * n * n) > available) {
+        --n;
+    }
+    if (n == 0) {
+        throw std::runtime_error("DSRGPT2Device: not enough device memory for one batch.");
+    }
+    return n;
+}
+
+void DSRGPT2Device::gemm(bool transa, bool transb, size_t M, size_t N, size_t K, double alpha,
+                         const double* A, size_t lda, const double* B, size_t ldb, double beta,
+                         double* C, size_t ldc) {
+    for (size_t n : {M, N, K, lda, ldb, ldc}) {
+        if (n > static_cast<size_t>(INT_MAX)) {
+            throw std::runtime_error("DSRGPT2Device: matrix dimension exceeds the cuBLAS limit.");
+        }
+    }
+    // a row-major C = op(A) op(B) is the column-major C^T = op(B)^T op(A)^T
+    check(cublasDgemm(static_cast<cublasHandle_t>(handle_), transb ? CUBLAS_OP_T : CUBLAS_OP_N,
+                      transa ? CUBLAS_OP_T : CUBLAS_OP_N, static_cast<int>(N),
+                      static_cast<int>(M), static_cast<int>(K), &alpha, B, static_cast<int>(ldb),
+                      A, static_cast<int>(lda), &beta, C, static_cast<int>(ldc)),
+          "cublasDgemm");
+}
+
+double DSRGPT2Device::ccvv_energy(size_t nQ, const std::vector<double>& Fc,
+                                  const std::vector<double>& Fv, size_t max_batch,
+                                  bool zero_source, const BlockLoader& load) {
+    const size_t nc = Fc.size();
+    const size_t nv = Fv.size();
+    if (nc == 0 or nv == 0)
+        return 0.0;
+    auto stream = static_cast<cudaStream_t>(stream_);
+    const DeviceSource source{source_, s_};
+
+    // one resident batch, two streamed batches, and J(me,nf)
+    const size_t per_index = nQ * nv;
+    const size_t nb = batch_size(std::min(max_batch, nc), 3 * per_index, nv * nv);
+
+    DeviceArray dFc(Fc);
+    DeviceArray dFv(Fv);
+    DeviceArray dE(1);
+    check(cudaMemsetAsync(dE.data(), 0, sizeof(double), stream), "cudaMemsetAsync");
+    DeviceArray dBi(nb * per_index);
+    DeviceArray dJ(nb * nv * nb * nv);
+    BatchStream batches(nb * per_index, stream);
+    std::vector<double> Bi(nb * per_index);
+
+    for (size_t i = 0; i < nc; i += nb) {
+        const size_t ni = std::min(nb, nc - i);
+        load(i, ni, Bi.data());
+        // the kernels of the previous batch i may still read dBi
+        check(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+        check(cudaMemcpy(dBi.data(), Bi.data(), ni * per_index * sizeof(double),
+                         cudaMemcpyHostToDevice),
+              "cudaMemcpy");
+
+        for (size_t j = i; j < nc; j += nb) {
+            const size_t nj = std::min(nb, nc - j);
+            const double* dBj = (j == i) ? dBi.data() : batches.load(load, j, nj, per_index);
+
+            // J(me,nf) = B(Q|me) B(Q|nf)
+            gemm(true, false, ni * nv, nj * nv, nQ, 1.0, dBi.data(), ni * nv, dBj, nj * nv, 0.0,
+                 dJ.data(), nj * nv);
+            ccvv_energy_kernel<<<num_blocks(ni * nv * nj * nv), block_size, 0, stream>>>(
+                source, zero_source, j == i, ni, nj, nv, dJ.data(), dFc.data() + i,
+                dFc.data() + j, dFv.data(), dE.data());
+            check(cudaGetLastError(), "kernel launch");
+        }
+    }
+
+    double E = 0.0;
+    check(cudaMemcpyAsync(&E, dE.data(), sizeof(double), cudaMemcpyDeviceToHost, stream),
+          "cudaMemcpyAsync");
+    check(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+    return E;
+}
+
+void DSRGPT2Device::hbar1_virtual(size_t nQ, const std::vector<double>& Fc,
+                                  const std::vector<double>& Fa, const std::vector<double>& Fv,
+                                  const double* Bva, size_t max_batch, bool Vr,
+                                  const BlockLoader& load, double* C) {
+    const size_t nc = Fc.size();
+    const size_t na = Fa.size();
+    const size_t nv = Fv.size();
+    std::fill(C, C + na * na, 0.0);
+    if (nc == 0 or na == 0 or nv == 0)
+        return;
+    auto stream = static_cast<cudaStream_t>(stream_);
+    const DeviceSource source{source_, s_};
+
+    DeviceArray dFc(Fc);
+    DeviceArray dFa(Fa);
+    DeviceArray dFv(Fv);
+    DeviceArray dBva(Bva, nQ * nv * na);
+    DeviceArray dC(na * na);
+    check(cudaMemsetAsync(dC.data(), 0, na * na * sizeof(double), stream), "cudaMemsetAsync");
+
+    // two streamed batches of B(Q|me), and V(mefu) and S(mefv)
+    const size_t per_index = nQ * nv;
+    const size_t nb = batch_size(std::min(max_batch, nc), 2 * per_index + 2 * nv * nv * na, 0);
+    DeviceArray dV(nb * nv * nv * na);
+    DeviceArray dS(nb * nv * nv * na);
+    BatchStream batches(nb * per_index, stream);
+
+    for (size_t i = 0; i < nc; i += nb) {
+        const size_t ni = std::min(nb, nc - i);
+        const double* dBi = batches.load(load, i, ni, per_index);
+        const size_t size = ni * nv * nv * na;
+
+        // V(me,fu) = B(Q|me) B(Q|fu)
+        gemm(true, false, ni * nv, nv * na, nQ, 1.0, dBi, ni * nv, dBva.data(), nv * na, 0.0,
+             dV.data(), nv * na);
+        virtual_amplitude_kernel<<<num_blocks(size), block_size, 0, stream>>>(
+            source, ni, nv, na, dV.data(), dS.data(), dFc.data() + i, dFa.data(), dFv.data());
+        if (Vr) {
+            virtual_renormalize_kernel<<<num_blocks(size), block_size, 0, stream>>>(
+                source, ni, nv, na, dV.data(), dFc.data() + i, dFa.data(), dFv.data());
+        }
+        check(cudaGetLastError(), "kernel launch");
+
+        // C(v,u) += S(mef,v) V(mef,u)
+        gemm(true, false, na, na, ni * nv * nv, 1.0, dS.data(), na, dV.data(), na, 1.0,
+             dC.data(), na);
+    }
+
+    check(cudaMemcpyAsync(C, dC.data(), na * na * sizeof(double), cudaMemcpyDeviceToHost, stream),
+          "cudaMemcpyAsync");
+    check(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+}
+
+void DSRGPT2Device::hbar1_core(size_t nQ, const std::vector<double>& Fc,
+                               const std::vector<double>& Fa, const std::vector<double>& Fv,
+                               const double* Bac, size_t max_batch, bool Vr,
+                               const BlockLoader& load, double* C) {
+    const size_t nc = Fc.size();
+    const size_t na = Fa.size();
+    const size_t nv = Fv.size();
+    std::fill(C, C + na * na, 0.0);
+    if (nc == 0 or na == 0 or nv == 0)
+        return;
+    auto stream = static_cast<cudaStream_t>(stream_);
+    const DeviceSource source{source_, s_};
+
+    DeviceArray dFc(Fc);
+    DeviceArray dFa(Fa);
+    DeviceArray dFv(Fv);
+    DeviceArray dBac(Bac, nQ * na * nc);
+    DeviceArray dC(na * na);
+    check(cudaMemsetAsync(dC.data(), 0, na * na * sizeof(double), stream), "cudaMemsetAsync");
+
+    // two streamed batches of B(Q|en), and V(vmen) and S(umen)
+    const size_t per_index = nQ * nc;
+    const size_t nb = batch_size(std::min(max_batch, nv), 2 * per_index + 2 * na * nc * nc, 0);
+    DeviceArray dV(na * nc * nb * nc);
+    DeviceArray dS(na * nc * nb * nc);
+    BatchStream batches(nb * per_index, stream);
+
+    for (size_t i = 0; i < nv; i += nb) {
+        const size_t ni = std::min(nb, nv - i);
+        const double* dBi = batches.load(load, i, ni, per_index);
+        const size_t size = na * nc * ni * nc;
+
+        // V(vm,en) = B(Q|vm) B(Q|en)
+        gemm(true, false, na * nc, ni * nc, nQ, 1.0, dBac.data(), na * nc, dBi, ni * nc, 0.0,
+             dV.data(), ni * nc);
+        core_amplitude_kernel<<<num_blocks(size), block_size, 0, stream>>>(
+            source, ni, nc, na, dV.data(), dS.data(), dFc.data(), dFa.data(), dFv.data() + i);
+        if (Vr) {
+            core_renormalize_kernel<<<num_blocks(size), block_size, 0, stream>>>(
+                source, ni, nc, na, dV.data(), dFc.data(), dFa.data(), dFv.data() + i);
+        }
+        check(cudaGetLastError(), "kernel launch");
+
+        // C(v,u) += V(v,men) S(u,men)
+        const size_t K = nc * ni * nc;
+        gemm(false, true, na, na, K, 1.0, dV.data(), K, dS.data(), K, 1.0, dC.data(), na);
+    }
+
+    check(cudaMemcpyAsync(C, dC.data(), na * na * sizeof(double), cudaMemcpyDeviceToHost, stream),
+          "cudaMemcpyAsync");
+    check(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+}
+
+} // namespace forte
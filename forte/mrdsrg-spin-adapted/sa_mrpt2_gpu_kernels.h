@@ -0,0 +1,122 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _sa_mrpt2_gpu_kernels_h_
+#define _sa_mrpt2_gpu_kernels_h_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace forte {
+
+/**
+ * @brief The DSRGPT2Device class
+ * Computes the DF contractions of SA_MRPT2 (CCVV energy, CAVV and CCAV Hbar1) on the device.
+ *
+ * The three-index integrals are streamed to the device in batches of one of their orbital
+ * indices. The DGEMMs are done by cuBLAS and the renormalization by fused kernels, and the
+ * energies and Hbar1 are accumulated in device memory. A batch is read by the host (through a
+ * BlockLoader) while the device works on the previous one.
+ *
+ * Like SigmaVectorDevice, this class depends only on CUDA so that it can be compiled by nvcc
+ * without the Psi4 and ambit headers. All the pointers are host pointers and all the
+ * orbital energies are those of the semicanonical basis.
+ */
+class DSRGPT2Device {
+  public:
+    /// The DSRG source operators available on the device (see dsrg_source.h)
+    enum class Source { Standard, Labs, Dyson };
+
+    /**
+     * Fill data with the n x nQ x m block B(Q|p q) for p in [start, start + n), stored as
+     * (Q, p, q), where q runs over the m orbitals of the other index
+     */
+    using BlockLoader = std::function<void(size_t start, size_t n, double* data)>;
+
+    DSRGPT2Device(Source source, double s);
+    ~DSRGPT2Device();
+
+    DSRGPT2Device(const DSRGPT2Device&) = delete;
+    DSRGPT2Device& operator=(const DSRGPT2Device&) = delete;
+
+    /**
+     * @brief Compute sum_{mnef} (em|fn) [2 (me|nf) - (mf|ne)] w(Fm + Fn - Fe - Ff)
+     * @param nQ the number of auxiliary functions
+     * @param Fc the core orbital energies
+     * @param Fv the virtual orbital energies
+     * @param max_batch the largest number of core orbitals loaded at once
+     * @param zero_source use w(D) = 1 / D (CCVV_SOURCE = ZERO) instead of the energy weight
+     * @param load the loader of B(Q|me)
+     */
+    double ccvv_energy(size_t nQ, const std::vector<double>& Fc, const std::vector<double>& Fv,
+                       size_t max_batch, bool zero_source, const BlockLoader& load);
+
+    /**
+     * @brief Compute the CAVV Hbar1, C(v,u) = sum_{mef} S(mefv) V(mefu) (see compute_Hbar1V_DF)
+     * @param Bva the integrals B(Q|fu), stored as (Q, f, u)
+     * @param Vr scale V by [1 + exp(-s D^2)] if true
+     * @param load the loader of B(Q|me), batched over the core index
+     * @param C on return the na x na matrix C(v,u)
+     */
+    void hbar1_virtual(size_t nQ, const std::vector<double>& Fc, const std::vector<double>& Fa,
+                       const std::vector<double>& Fv, const double* Bva, size_t max_batch,
+                       bool Vr, const BlockLoader& load, double* C);
+
+    /**
+     * @brief Compute the CCAV Hbar1, C(v,u) = sum_{emn} V(vmen) S(umen) (see compute_Hbar1C_DF)
+     * @param Bac the integrals B(Q|vm), stored as (Q, v, m)
+     * @param Vr scale V by [1 + exp(-s D^2)] if true
+     * @param load the loader of B(Q|en), batched over the virtual index
+     * @param C on return the na x na matrix C(v,u)
+     */
+    void hbar1_core(size_t nQ, const std::vector<double>& Fc, const std::vector<double>& Fa,
+                    const std::vector<double>& Fv, const double* Bac, size_t max_batch, bool Vr,
+                    const BlockLoader& load, double* C);
+
+  private:
+    /// @return the largest batch (at most max_batch) such that per_index * n + per_index2 * n^2
+    ///         doubles fit in the free device memory
+    size_t batch_size(size_t max_batch, size_t per_index, size_t per_index2) const;
+
+    /// Row-major C(M x N) = alpha op(A) op(B) + beta C
+    void gemm(bool transa, bool transb, size_t M, size_t N, size_t K, double alpha,
+              const double* A, size_t lda, const double* B, size_t ldb, double beta, double* C,
+              size_t ldc);
+
+    Source source_;
+    double s_;
+    /// The cuBLAS handle (cublasHandle_t)
+    void* handle_ = nullptr;
+    /// The stream (cudaStream_t) used by all the kernels and copies
+    void* stream_ = nullptr;
+};
+
+} // namespace forte
+
+#endif // _sa_mrpt2_gpu_kernels_h_
@@ -0,0 +1,175 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <cmath>
+
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/wavefunction.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libqt/qt.h"
+
+#include "forte-def.h"
+#include "helpers/printing.h"
+#include "helpers/timer.h"
+#include "integrals/integrals.h"
+#include "orbital-helpers/localize.h"
+#include "sa_mrpt2.h"
+
+using namespace psi;
+
+namespace forte {
+
+double SA_MRPT2::compute_Hbar0_CCVV_local() {
+    /**
+     * Compute <[V, T2]> (C_2)^4 ccvv term in localized core orbitals
+     * E = (ei|fj) * [ 2 * (ie|jf) - (if|je)] * [1 - exp(-2 * s * D^2)] / D
+     *
+     * The core orbitals are localized and treated as quasi-canonical, i.e., the off-diagonal
+     * core Fock elements are neglected in D = Fii + Fjj - Fe - Ff. Pairs whose orbital
+     * centroids are farther apart than DSRG_PT2_LOCAL_PAIR_DISTANCE are skipped.
+     */
+    timer t_ccvv("Compute CCVV energy term local");
+    print_contents("Computing local DF <0|[Vr, T2]|0> CCVV");
+
+    auto nQ = aux_mos_.size();
+    auto nv = virt_mos_.size();
+    auto nc = core_mos_.size();
+    if (nc * nv == 0) {
+        print_done(t_ccvv.stop());
+        return 0.0;
+    }
+
+    // localize the core orbitals, Ua is indexed by absolute MOs
+    auto core_abs = mo_space_info_->absolute_mo("RESTRICTED_DOCC");
+    std::vector<int> space{static_cast<int>(core_abs[0]), static_cast<int>(core_abs.back())};
+    Localize localizer(foptions_, ints_, mo_space_info_);
+    localizer.set_orbital_space(space);
+    localizer.compute_transformation();
+    auto Ua = localizer.get_Ua();
+
+    auto Uloc = ambit::Tensor::build(tensor_type_, "Uloc", {nc, nc});
+    Uloc.iterate([&](const std::vector<size_t>& i, double& value) {
+        value = Ua->get(core_abs[i[0]], core_abs[i[1]]);
+    });
+    const auto& U = Uloc.data();
+
+    // diagonal Fock elements of the localized core orbitals
+    std::vector<double> Fl(nc, 0.0);
+    for (size_t i = 0; i < nc; ++i) {
+        for (size_t m = 0; m < nc; ++m) {
+            Fl[i] += U[m * nc + i] * U[m * nc + i] * Fdiag_[core_mos_[m]];
+        }
+    }
+
+    // orbital centroids from the AO dipole integrals
+    auto Cso = ints_->Ca();
+    auto aotoso = ints_->wfn()->aotoso();
+    auto nao = aotoso->rowdim(0);
+    auto nso = aotoso->coldim(0);
+    std::vector<double> Cl(nao * nc, 0.0);
+    for (size_t mu = 0; mu < nao; ++mu) {
+        for (size_t m = 0; m < nc; ++m) {
+            double c = 0.0;
+            for (size_t s = 0; s < nso; ++s) {
+                c += aotoso->get(0, mu, s) * Cso->get(0, s, core_abs[m]);
+            }
+            for (size_t i = 0; i < nc; ++i) {
+                Cl[mu * nc + i] += c * U[m * nc + i];
+            }
+        }
+    }
+
+    std::vector<std::vector<double>> centroids(nc, std::vector<double>(3, 0.0));
+    auto dipoles = ints_->ao_dipole_ints();
+    for (size_t x = 0; x < 3; ++x) {
+        auto& D = dipoles[x];
+        for (size_t mu = 0; mu < nao; ++mu) {
+            for (size_t nu = 0; nu < nao; ++nu) {
+                double d = D->get(mu, nu);
+                for (size_t i = 0; i < nc; ++i) {
+                    centroids[i][x] += Cl[mu * nc + i] * d * Cl[nu * nc + i];
+                }
+            }
+        }
+    }
+
+    // select the pairs
+    double max_distance = foptions_->get_double("DSRG_PT2_LOCAL_PAIR_DISTANCE");
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < nc; ++i) {
+        for (size_t j = i; j < nc; ++j) {
+            double r2 = 0.0;
+            for (size_t x = 0; x < 3; ++x) {
+                double d = centroids[i][x] - centroids[j][x];
+                r2 += d * d;
+            }
+            if (std::sqrt(r2) <= max_distance) {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+    outfile->Printf("\n    Kept %zu of %zu localized core pairs.", pairs.size(),
+                    nc * (nc + 1) / 2);
+
+    // B(i|L e) in localized core orbitals
+    auto Bl = ambit::Tensor::build(tensor_type_, "B local", {nc, nQ, nv});
+    {
+        auto B = ints_->three_integral_block(aux_mos_, virt_mos_, core_mos_);
+        Bl("iLe") = B("Lem") * Uloc("mi");
+    }
+    auto& Bl_data = Bl.data();
+
+    // scratch for the fused energy pass and the virtual diagonal Fock elements
+    std::vector<std::vector<double>> J_vec(n_threads_, std::vector<double>(nv * nv));
+    std::vector<std::vector<double>> W_vec(n_threads_, std::vector<double>(2 * nv));
+    std::vector<double> Fv(nv);
+    for (size_t e = 0; e < nv; ++e) {
+        Fv[e] = Fdiag_[virt_mos_[e]];
+    }
+
+    double E = 0.0;
+
+#pragma omp parallel for num_threads(n_threads_) schedule(dynamic) reduction(+ : E)
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        auto [i, j] = pairs[p];
+        int thread = omp_get_thread_num();
+        double factor = (i < j) ? 2.0 : 1.0;
+
+        // J(ef) = B(i|L e) * B(j|L f)
+        double* Bi = Bl_data.data() + i * nQ * nv;
+        double* Bj = Bl_data.data() + j * nQ * nv;
+        auto& J = J_vec[thread];
+        C_DGEMM('T', 'N', nv, nv, nQ, 1.0, Bi, nv, Bj, nv, 0.0, J.data(), nv);
+
+        E += factor * ccvv_pair_energy(J.data(), Fl[i] + Fl[j], Fv, W_vec[thread]);
+    }
+
+    print_done(t_ccvv.stop());
+    return E;
+}
+} // namespace forte
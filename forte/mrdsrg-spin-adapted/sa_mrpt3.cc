@@ -27,8 +27,11 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+
 #include "psi4/libpsi4util/PsiOutStream.h"
 
+#include "forte-def.h"
 #include "helpers/timer.h"
 #include "helpers/printing.h"
 #include "sa_mrpt3.h"
@@ -124,10 +127,17 @@ void SA_MRPT3::check_memory() {
     auto local1 = dsrg_mem_.compute_memory({"hp", "hhpp"}, 3);
     dsrg_mem_.add_entry("Local intermediates (energy part 1)", local1, false);
 
+    // the vvcc block of H1st + Hbar1st is formed from B for one core pair at a time
+    batch_ccvv_ = eri_df_ and semi_canonical_;
+
     auto local2 = dsrg_mem_.compute_memory({"ph", "pphh"});
     if (!eri_df_) {
         local2 += dsrg_mem_.compute_memory({"gggg"});
     }
+    if (batch_ccvv_) {
+        local2 -= dsrg_mem_.compute_memory({"vvcc"});
+        local2 += dsrg_mem_.compute_memory({"Lv", "Lv", "vv", "vv"}, n_threads_);
+    }
     dsrg_mem_.add_entry("Local intermediates (energy part 2)", local2, false);
 
     auto local_comm = dsrg_mem_.compute_memory({"pphh"});
@@ -282,8 +292,13 @@ double SA_MRPT3::compute_energy_pt3_2() {
     // compute 2nd-order amplitudes
     // Step 1: compute 0.5 * [H1st + Hbar1st, A1st] = [H1st, A1st] + 0.5 * [[H0th, A1st], A1st]
     //     a) keep a copy of H1st + Hbar1st
+    //        (the vvcc block is regenerated from B when batching)
+    auto X2blocks = od_two_labels_pphh();
+    if (batch_ccvv_) {
+        X2blocks.erase(std::remove(X2blocks.begin(), X2blocks.end(), "vvcc"), X2blocks.end());
+    }
     auto X1 = BTF_->build(tensor_type_, "O1 pt3 2/3", od_one_labels_ph());
-    auto X2 = BTF_->build(tensor_type_, "O2 pt3 2/3", od_two_labels_pphh());
+    auto X2 = BTF_->build(tensor_type_, "O2 pt3 2/3", X2blocks);
     X1["ai"] = F_["ai"];
     X2["abij"] = V_["abij"];
 
@@ -375,6 +390,9 @@ double SA_MRPT3::compute_energy_pt3_2() {
     H1_T2_C0(X1, T2_, 1.0, Ereturn);
     H2_T1_C0(X2, T1_, 1.0, Ereturn);
     H2_T2_C0(X2, T2_, S2_, 1.0, Ereturn);
+    if (batch_ccvv_) {
+        Ereturn += compute_energy_pt3_2_ccvv_DF();
+    }
     print_done(t2.get());
 
     if (form_Hbar_) {
@@ -390,6 +408,79 @@ double SA_MRPT3::compute_energy_pt3_2() {
     return Ereturn;
 }
 
+double SA_MRPT3::compute_energy_pt3_2_ccvv_DF() {
+    /**
+     * Compute the vvcc contribution of H2_T2_C0(H1st + Hbar1st, A2nd)
+     * E = sum_{mnef} (em|fn) * [1 + exp(-s * D^2)] * S2(2nd)_{mnef}, D = Fm + Fn - Fe - Ff
+     *
+     * Batching: for a given m and n, form J(ef) = Bm(L|e) * Bn(L|f) and scale it by the source
+     */
+    auto nQ = aux_mos_.size();
+    auto nv = virt_mos_.size();
+    auto nc = core_mos_.size();
+
+    // vvcc is not renormalized if CCVV_SOURCE is ZERO, see SA_DSRGPT::renormalize_integrals
+    bool renormalized = ccvv_source_ != "ZERO";
+
+    std::vector<double> Fv(nv);
+    for (size_t e = 0; e < nv; ++e) {
+        Fv[e] = Fdiag_[virt_mos_[e]];
+    }
+
+    // B(L|em) stored as L * nv * nc + e * nc + m
+    const auto& Bvc = B_.block("Lvc").data();
+    const auto& S2 = S2_.block("ccvv").data();
+
+    std::vector<ambit::Tensor> Bm_vec, Bn_vec, J_vec;
+    for (int i = 0; i < n_threads_; ++i) {
+        std::string t = std::to_string(i);
+        Bm_vec.push_back(ambit::Tensor::build(tensor_type_, "Bm_thread" + t, {nQ, nv}));
+        Bn_vec.push_back(ambit::Tensor::build(tensor_type_, "Bn_thread" + t, {nQ, nv}));
+        J_vec.push_back(ambit::Tensor::build(tensor_type_, "J_thread" + t, {nv, nv}));
+    }
+
+    auto fill_B = [&](std::vector<double>& B, size_t m) {
+        for (size_t L = 0; L < nQ; ++L) {
+            for (size_t e = 0; e < nv; ++e) {
+                B[L * nv + e] = Bvc[(L * nv + e) * nc + m];
+            }
+        }
+    };
+
+    double E = 0.0;
+
+#pragma omp parallel for num_threads(n_threads_) schedule(dynamic) reduction(+ : E)
+    for (size_t m = 0; m < nc; ++m) {
+        int thread = omp_get_thread_num();
+        fill_B(Bm_vec[thread].data(), m);
+
+        for (size_t n = m; n < nc; ++n) {
+            fill_B(Bn_vec[thread].data(), n);
+            J_vec[thread]("ef") = Bm_vec[thread]("ge") * Bn_vec[thread]("gf");
+
+            auto& J = J_vec[thread].data();
+            if (renormalized) {
+                std::vector<std::vector<double>> F{
+                    Fv, Fv, {-Fdiag_[core_mos_[m]]}, {-Fdiag_[core_mos_[n]]}};
+                dsrg_source_->scale_block(J.data(), {nv, nv, 1, 1}, F,
+                                          SourceScaling::OnePlusRenormalized);
+            }
+
+            // (m, n) and (n, m) contribute equally
+            double factor = (m < n) ? 2.0 : 1.0;
+            const double* S2mn = S2.data() + (m * nc + n) * nv * nv;
+            double Emn = 0.0;
+#pragma omp simd reduction(+ : Emn)
+            for (size_t ef = 0; ef < nv * nv; ++ef) {
+                Emn += J[ef] * S2mn[ef];
+            }
+            E += factor * Emn;
+        }
+    }
+
+    return E;
+}
+
 double SA_MRPT3::compute_energy_pt3_3() {
     print_h2("Computing 3rd-Order Energy Contribution (3/3)");
 
@@ -76,6 +76,10 @@ class SA_MRPT3 : public SA_DSRGPT {
     double compute_energy_pt3_1();
     /// 3rd-order energy contribution 0.5 * [H1st + Hbar1st,A2nd]
     double compute_energy_pt3_2();
+    /// Form the vvcc block of H1st + Hbar1st from B for each core pair instead of storing it
+    bool batch_ccvv_;
+    /// The vvcc part of 0.5 * [H1st + Hbar1st,A2nd], batched over core pairs with DF
+    double compute_energy_pt3_2_ccvv_DF();
     /// 3rd-order energy contribution 0.5 * [Hbar2nd,A1st]
     double compute_energy_pt3_3();
 };
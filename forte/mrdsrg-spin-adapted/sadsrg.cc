@@ -26,6 +26,7 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <numeric>
 
 #include "psi4/libmints/matrix.h"
@@ -37,6 +38,7 @@
 
 #include "forte-def.h"
 #include "helpers/helpers.h"
+#include "helpers/memory_manager.h"
 #include "helpers/printing.h"
 #include "helpers/timer.h"
 
@@ -65,6 +67,9 @@ SADSRG::SADSRG(RDMs rdms, std::shared_ptr<SCFInfo> scf_info, std::shared_ptr<For
 
 SADSRG::~SADSRG() {
     dsrg_time_.print_comm_time();
+    if (foptions_->get_bool("DSRG_COMM_JSON")) {
+        dsrg_time_.write_json(foptions_->get_str("DSRG_COMM_JSON_FILE"));
+    }
 
     if (warnings_.size() != 0) {
         print_h2("DSRG Warnings");
@@ -109,8 +114,10 @@ void SADSRG::startup() {
     // recompute reference energy from ForteIntegral
     compute_reference_energy_from_ints();
 
-    // general printing for all derived classes
-    print_cumulant_summary();
+    // general printing for all derived classes (deferred if the 3-RDM is not available yet)
+    if (!do_cu3_ or rdms_.max_rdm_level() >= 3) {
+        print_cumulant_summary();
+    }
 
     // initialize Uactv_ to identity
     Uactv_ = BTF_->build(tensor_type_, "Uactv", {"aa"});
@@ -124,6 +131,64 @@ void SADSRG::startup() {
     semi_canonical_ = check_semi_orbs();
 }
 
+double SADSRG::compute_energy_pipelined(std::function<RDMs()> rdms_task) {
+    rdms_ = rdms_task();
+    print_cumulant_summary();
+    return compute_energy();
+}
+
+void SADSRG::run_with_rdms_task(const std::function<RDMs()>& rdms_task,
+                                const std::function<void()>& task) {
+    if (n_threads_ < 2) {
+        rdms_ = rdms_task();
+        task();
+        return;
+    }
+
+    int nthreads_rdms = n_threads_ / 2;
+    int nthreads_dsrg = n_threads_ - nthreads_rdms;
+    outfile->Printf("\n  Building the RDMs with %d thread(s) while computing the DSRG terms "
+                    "independent of the 3-cumulant with %d thread(s).",
+                    nthreads_rdms, nthreads_dsrg);
+
+    int max_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(max_levels, 2));
+    int n_threads = n_threads_;
+    n_threads_ = nthreads_dsrg;
+
+    RDMs rdms;
+    std::vector<std::exception_ptr> errors(2);
+#pragma omp parallel sections num_threads(2)
+    {
+#pragma omp section
+        {
+            omp_set_num_threads(nthreads_rdms);
+            try {
+                rdms = rdms_task();
+            } catch (...) {
+                errors[0] = std::current_exception();
+            }
+        }
+#pragma omp section
+        {
+            omp_set_num_threads(nthreads_dsrg);
+            try {
+                task();
+            } catch (...) {
+                errors[1] = std::current_exception();
+            }
+        }
+    }
+
+    n_threads_ = n_threads;
+    omp_set_max_active_levels(max_levels);
+    for (const auto& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+    rdms_ = rdms;
+}
+
 void SADSRG::build_fock_from_ints() {
     local_timer lt;
     print_contents("Computing Fock matrix and cleaning JK");
@@ -170,6 +235,10 @@ void SADSRG::read_options() {
 
     do_cu3_ = foptions_->get_str("THREEPDC") != "ZERO";
 
+    symmetry_blocks_ = foptions_->get_bool("DSRG_SYMMETRY_BLOCKS");
+    threepdc_algorithm_ = foptions_->get_str("THREEPDC_ALGORITHM");
+    memory_plan_ = foptions_->get_bool("DSRG_MEMORY_PLAN");
+
     ntamp_ = foptions_->get_int("NTAMP");
     intruder_tamp_ = foptions_->get_double("INTRUDER_TAMP");
 
@@ -181,7 +250,10 @@ void SADSRG::read_options() {
 
     relax_ref_ = foptions_->get_str("RELAX_REF");
 
-    multi_state_ = foptions_->get_gen_list("AVG_STATE").size() != 0;
+    {
+        py::gil_scoped_acquire gil;
+        multi_state_ = foptions_->get_gen_list("AVG_STATE").size() != 0;
+    }
     multi_state_algorithm_ = foptions_->get_str("DSRG_MULTI_STATE");
 
     print_done(lt.get());
@@ -220,6 +292,19 @@ void SADSRG::set_ambit_MOSpace() {
     label_to_spacemo_[actv_label_[0]] = actv_mos_;
     label_to_spacemo_[virt_label_[0]] = virt_mos_;
 
+    // map space labels to the irreps spanned, an empty space may couple to any irrep
+    int all_irreps = (1 << mo_space_info_->nirrep()) - 1;
+    for (const auto& [label, space] : std::vector<std::pair<std::string, std::string>>{
+             {core_label_, "RESTRICTED_DOCC"},
+             {actv_label_, "ACTIVE"},
+             {virt_label_, "RESTRICTED_UOCC"}}) {
+        int mask = 0;
+        for (int h : mo_space_info_->symmetry(space)) {
+            mask |= 1 << h;
+        }
+        label_to_irreps_[label[0]] = mask ? mask : all_irreps;
+    }
+
     // define composite spaces
     BTF_->add_composite_mo_space("h", "i,j,k,l,h0,h1,h2,h3,h4,h5,h6,h7,h8,h9",
                                  {core_label_, actv_label_});
@@ -239,8 +324,9 @@ void SADSRG::set_ambit_MOSpace() {
 }
 
 void SADSRG::check_init_memory() {
+    // start from the memory not already registered by other Forte modules (e.g., CI vectors)
     mem_sys_ = psi::Process::environment.get_memory();
-    int64_t mem_left = mem_sys_ * 0.9;
+    int64_t mem_left = std::min(mem_sys_, MemoryManager::instance().available()) * 0.9;
     if (ints_->integral_type() != DiskDF and ints_->integral_type() != Cholesky) {
         mem_left -= ints_->jk()->memory_estimate() * sizeof(double);
     }
@@ -301,6 +387,22 @@ void SADSRG::check_init_memory() {
     }
 }
 
+void SADSRG::plan_cu3_memory() {
+    if (!memory_plan_ or !do_cu3_ or threepdc_algorithm_ == "SPARSE") {
+        return;
+    }
+
+    // the dense contraction forms an intermediate as large as the 3-cumulant,
+    // while the sparse one only keeps a slice of a single active index
+    size_t mem_dense = dsrg_mem_.compute_memory({"aaaaaa"});
+    if (dsrg_mem_.fits(mem_dense)) {
+        dsrg_mem_.add_entry("Local intermediates for 3-cumulant terms", mem_dense, false);
+    } else {
+        threepdc_algorithm_ = "SPARSE";
+        dsrg_mem_.add_plan_entry("3-cumulant algorithm (memory plan)", "SPARSE");
+    }
+}
+
 void SADSRG::init_density() {
     local_timer lt;
     print_contents("Initializing density cumulants");
@@ -349,6 +451,32 @@ void SADSRG::fill_Fdiag(BlockedTensor& F, std::vector<double>& Fa) {
     });
 }
 
+void SADSRG::scale_by_source(BlockedTensor& T, const std::vector<std::string>& blocks,
+                             SourceScaling type) {
+    for (const std::string& block : blocks) {
+        auto& data = T.block(block).data();
+        const auto& dims = T.block(block).dims();
+        size_t rank = dims.size();
+        if (data.empty())
+            continue;
+        if (rank != 2 and rank != 4) {
+            throw psi::PSIEXCEPTION("scale_by_source: only 2- and 4-index blocks are supported");
+        }
+
+        // orbital energies of each index, with the sign they carry in the denominator
+        std::vector<std::vector<double>> F(rank);
+        for (size_t n = 0; n < rank; ++n) {
+            const auto& mos = label_to_spacemo_.at(block[n]);
+            double sign = n < rank / 2 ? 1.0 : -1.0;
+            for (size_t p : mos) {
+                F[n].push_back(sign * Fdiag_[p]);
+            }
+        }
+
+        dsrg_source_->scale_block(data.data(), dims, F, type);
+    }
+}
+
 double SADSRG::compute_reference_energy_from_ints() {
     BlockedTensor H = BTF_->build(tensor_type_, "OEI", {"cc", "aa"}, true);
     H.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>&, double& value) {
@@ -29,6 +29,8 @@
 #ifndef _sadsrg_h_
 #define _sadsrg_h_
 
+#include <functional>
+
 #include "ambit/blocked_tensor.h"
 
 #include "base_classes/dynamic_correlation_solver.h"
@@ -59,6 +61,16 @@ class SADSRG : public DynamicCorrelationSolver {
     /// Compute energy
     virtual double compute_energy() = 0;
 
+    /**
+     * @brief Compute energy while the reference RDMs are built
+     * @param rdms_task builds the RDMs (up to the 3-RDM) in the basis of this object
+     *
+     * The RDMs passed to the constructor (up to the 2-RDM) are replaced by those of rdms_task.
+     * By default rdms_task is called before compute_energy(). Derived classes may instead run
+     * it concurrently with the terms that do not depend on the 3-cumulant.
+     */
+    virtual double compute_energy_pipelined(std::function<RDMs()> rdms_task);
+
     /// Compute DSRG transformed Hamiltonian
     virtual std::shared_ptr<ActiveSpaceIntegrals> compute_Heff_actv();
 
@@ -90,6 +102,8 @@ class SADSRG : public DynamicCorrelationSolver {
 
     /// Compute contributions from 3 cumulant
     bool do_cu3_;
+    /// Algorithm for the 3-cumulant contractions (THREEPDC_ALGORITHM)
+    std::string threepdc_algorithm_;
 
     /// Multi-state computation if true
     bool multi_state_;
@@ -123,15 +137,23 @@ class SADSRG : public DynamicCorrelationSolver {
     /// Number of threads
     int n_threads_;
 
+    /// Run rdms_task on half of the threads and task on the others, then store the new RDMs
+    void run_with_rdms_task(const std::function<RDMs()>& rdms_task,
+                            const std::function<void()>& task);
+
     // ==> system memory related <==
 
     /// Total memory available set by the user
     size_t mem_sys_;
     /// Memory checker and printer
     DSRG_MEM dsrg_mem_;
+    /// Adjust algorithm choices to the available memory if true
+    bool memory_plan_;
 
     /// Check initial memory
     void check_init_memory();
+    /// Pick the 3-cumulant algorithm from the memory left, call before printing dsrg_mem_
+    void plan_cu3_memory();
 
     // ==> some common energies for all DSRG levels <==
 
@@ -175,6 +197,8 @@ class SADSRG : public DynamicCorrelationSolver {
     std::shared_ptr<BlockedTensorFactory> BTF_;
     /// Tensor type for Ambit
     ambit::TensorType tensor_type_;
+    /// Pool of the temporary tensors of the commutators and amplitude updates
+    BlockedTensorPool tensor_pool_;
 
     /// Core MO label
     std::string core_label_;
@@ -189,6 +213,22 @@ class SADSRG : public DynamicCorrelationSolver {
     /// Map from space label to list of MOs
     std::map<char, std::vector<size_t>> label_to_spacemo_;
 
+    /// Omit tensor blocks that are zero by point-group symmetry
+    bool symmetry_blocks_;
+    /// Map from elementary space label to the bit mask of irreps spanned by the space
+    std::map<char, int> label_to_irreps_;
+
+    /// Test if a block (of elementary space labels) may be nonzero by point-group symmetry
+    bool is_symmetry_allowed(const std::string& block);
+    /**
+     * @brief Expand composite space labels and omit blocks that are zero by symmetry
+     * @param labels the block labels, may contain composite spaces h, p, and g
+     * @return the allowed blocks in terms of elementary spaces
+     *
+     * The input labels are returned untouched if DSRG_SYMMETRY_BLOCKS is false.
+     */
+    std::vector<std::string> symmetry_allowed(const std::vector<std::string>& labels);
+
     /// Compute diagonal blocks labels of a one-body operator
     std::vector<std::string> diag_one_labels();
     /// Compute diagonal blocks labels of a two-body operator
@@ -234,6 +274,18 @@ class SADSRG : public DynamicCorrelationSolver {
     /// Fill in diagonal elements of Fock matrix to Fdiag
     void fill_Fdiag(BlockedTensor& F, std::vector<double>& Fdiag);
 
+    /**
+     * @brief Scale blocks of a 2- or 4-index tensor by the source operator
+     * @param T the tensor, in the semicanonical basis
+     * @param blocks the blocks of T to be scaled
+     * @param type the factor f(D) applied to the element pq (or pqrs), with the denominator
+     *        D = Fdiag[p] - Fdiag[q] (or Fdiag[p] + Fdiag[q] - Fdiag[r] - Fdiag[s])
+     *
+     * The block kernel is DSRG_SOURCE::scale_block.
+     */
+    void scale_by_source(BlockedTensor& T, const std::vector<std::string>& blocks,
+                         SourceScaling type);
+
     /// Check orbitals if semicanonical
     bool check_semi_orbs();
     /// Are orbitals semi-canonicalized?
@@ -290,6 +342,13 @@ class SADSRG : public DynamicCorrelationSolver {
      * B: 3-index integrals from DF/CD
      */
 
+    /**
+     * Estimate the FLOPs of dense contractions for DSRG_TIME
+     * @param contractions the distinct ambit indices of each contraction, e.g., "ijrsab"
+     * @return 2 * sum of the products of index dimensions
+     */
+    double contraction_flops(const std::vector<std::string>& contractions);
+
     /// Compute zero-body term of commutator [H1, T1]
     double H1_T1_C0(BlockedTensor& H1, BlockedTensor& T1, const double& alpha, double& C0);
     /// Compute zero-body term of commutator [H1, T2]
@@ -384,6 +443,13 @@ class SADSRG : public DynamicCorrelationSolver {
     std::vector<std::pair<std::vector<size_t>, double>> check_t2(BlockedTensor& T2);
     /// Analyze T1 and T2 amplitudes
     void analyze_amplitudes(std::string name, BlockedTensor& T1, BlockedTensor& T2);
+    /**
+     * @brief Zero the amplitudes T2[ij**] of each block whose pair norm is below a threshold
+     * @param T2 the T2 amplitudes
+     * @param threshold the threshold of the Frobenius norm of T2[ij**]
+     * @return the number of hole pairs zeroed (counted per block)
+     */
+    size_t screen_t2_pairs(BlockedTensor& T2, double threshold);
     /// Print t1 amplitudes summary
     void print_t1_summary(const std::vector<std::pair<std::vector<size_t>, double>>& list,
                           const double& norm, const size_t& number_nonzero);
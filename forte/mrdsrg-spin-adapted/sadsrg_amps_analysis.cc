@@ -27,6 +27,7 @@
  */
 
 #include <algorithm>
+#include <numeric>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 
@@ -52,6 +53,28 @@ void SADSRG::internal_amps_T2(BlockedTensor& T2) {
     }
 }
 
+size_t SADSRG::screen_t2_pairs(BlockedTensor& T2, double threshold) {
+    size_t nscreened = 0;
+    double threshold2 = threshold * threshold;
+    for (const std::string& block : T2.block_labels()) {
+        auto& data = T2.block(block).data();
+        const auto& dims = T2.block(block).dims();
+        size_t npair = dims[0] * dims[1], nab = dims[2] * dims[3];
+        if (npair * nab == 0)
+            continue;
+
+        for (size_t ij = 0; ij < npair; ++ij) {
+            auto first = data.begin() + ij * nab, last = first + nab;
+            double norm2 = std::inner_product(first, last, first, 0.0);
+            if (norm2 != 0.0 and norm2 < threshold2) {
+                std::fill(first, last, 0.0);
+                ++nscreened;
+            }
+        }
+    }
+    return nscreened;
+}
+
 void SADSRG::analyze_amplitudes(std::string name, BlockedTensor& T1, BlockedTensor& T2) {
     if (!name.empty())
         name += " ";
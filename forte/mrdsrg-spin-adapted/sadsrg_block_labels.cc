@@ -37,7 +37,7 @@ std::vector<std::string> SADSRG::diag_one_labels() {
     for (const std::string& p : {core_label_, actv_label_, virt_label_}) {
         labels.push_back(p + p);
     }
-    return labels;
+    return symmetry_allowed(labels);
 }
 
 std::vector<std::string> SADSRG::od_one_labels_hp() {
@@ -50,7 +50,7 @@ std::vector<std::string> SADSRG::od_one_labels_hp() {
             labels.push_back(p + q);
         }
     }
-    return labels;
+    return symmetry_allowed(labels);
 }
 
 std::vector<std::string> SADSRG::od_one_labels_ph() {
@@ -83,7 +83,7 @@ std::vector<std::string> SADSRG::od_two_labels_hhpp() {
             }
         }
     }
-    return labels;
+    return symmetry_allowed(labels);
 }
 
 std::vector<std::string> SADSRG::od_two_labels_pphh() {
@@ -124,7 +124,7 @@ std::vector<std::string> SADSRG::diag_two_labels() {
     std::set_symmetric_difference(all.begin(), all.end(), od.begin(), od.end(),
                                   std::back_inserter(labels));
 
-    return labels;
+    return symmetry_allowed(labels);
 }
 
 std::vector<std::string> SADSRG::re_two_labels() {
@@ -145,7 +145,7 @@ std::vector<std::string> SADSRG::re_two_labels() {
         }
     }
 
-    return labels;
+    return symmetry_allowed(labels);
 }
 
 std::vector<std::string> SADSRG::nivo_labels() {
@@ -165,7 +165,61 @@ std::vector<std::string> SADSRG::nivo_labels() {
         }
     }
 
-    return blocks_exclude_V3;
+    return symmetry_allowed(blocks_exclude_V3);
+}
+
+bool SADSRG::is_symmetry_allowed(const std::string& block) {
+    // irreps reachable by the direct product of the spaces, bit h for irrep h
+    int reachable = 1;
+    for (char c : block) {
+        int irreps = label_to_irreps_[c];
+        int next = 0;
+        for (int h = 0; (1 << h) <= reachable; ++h) {
+            if (not(reachable & (1 << h)))
+                continue;
+            for (int g = 0; (1 << g) <= irreps; ++g) {
+                if (irreps & (1 << g))
+                    next |= 1 << (h ^ g);
+            }
+        }
+        reachable = next;
+    }
+    return reachable & 1;
+}
+
+std::vector<std::string> SADSRG::symmetry_allowed(const std::vector<std::string>& labels) {
+    if (not symmetry_blocks_) {
+        return labels;
+    }
+
+    std::map<char, std::vector<std::string>> composite{
+        {'h', {core_label_, actv_label_}},
+        {'p', {actv_label_, virt_label_}},
+        {'g', {core_label_, actv_label_, virt_label_}}};
+
+    std::vector<std::string> out;
+    for (const std::string& label : labels) {
+        std::vector<std::string> blocks{""};
+        for (char c : label) {
+            std::vector<std::string> spaces{std::string(1, c)};
+            if (composite.count(c)) {
+                spaces = composite[c];
+            }
+            std::vector<std::string> expanded;
+            for (const std::string& block : blocks) {
+                for (const std::string& space : spaces) {
+                    expanded.push_back(block + space);
+                }
+            }
+            blocks.swap(expanded);
+        }
+        for (const std::string& block : blocks) {
+            if (is_symmetry_allowed(block)) {
+                out.push_back(block);
+            }
+        }
+    }
+    return out;
 }
 
 } // namespace forte
@@ -26,23 +26,52 @@
  * @END LICENSE
  */
 #include <algorithm>
+#include <map>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 
 #include "helpers/timer.h"
+#include "mrdsrg-helper/dsrg_df_ladder.h"
 #include "sadsrg.h"
 
 using namespace psi;
 
 namespace forte {
 
+double SADSRG::contraction_flops(const std::vector<std::string>& contractions) {
+    size_t nc = core_mos_.size(), na = actv_mos_.size(), nv = virt_mos_.size();
+    std::map<char, double> dims;
+    auto set_dims = [&](const std::string& indices, size_t n) {
+        for (char c : indices)
+            dims[c] = static_cast<double>(n);
+    };
+    set_dims("mn", nc);
+    set_dims("uvwxyz", na);
+    set_dims("ef", nv);
+    set_dims("ijkl", nc + na);
+    set_dims("abcd", na + nv);
+    set_dims("pqrsto", nc + na + nv);
+    set_dims("g", aux_mos_.size());
+
+    double flops = 0.0;
+    for (const std::string& indices : contractions) {
+        double f = 2.0;
+        for (char c : indices) {
+            f *= dims.at(c);
+        }
+        flops += f;
+    }
+    return flops;
+}
+
 double SADSRG::H1_T1_C0(BlockedTensor& H1, BlockedTensor& T1, const double& alpha, double& C0) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     double E = 0.0;
     E += 2.0 * H1["am"] * T1["ma"];
 
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "Temp110", {"aa"});
+    auto temp = tensor_pool_.build(tensor_type_, "Temp110", {"aa"});
     temp["uv"] += H1["ev"] * T1["ue"];
     temp["uv"] -= H1["um"] * T1["mv"];
 
@@ -55,14 +84,16 @@ double SADSRG::H1_T1_C0(BlockedTensor& H1, BlockedTensor& T1, const double& alph
         outfile->Printf("\n    Time for [H1, T1] -> C0 : %12.3f", timer.get());
     }
     dsrg_time_.add("110", timer.get());
+    dsrg_time_.add_flops("110", contraction_flops({"am", "uve", "uvm", "uv"}));
     return E;
 }
 
 double SADSRG::H1_T2_C0(BlockedTensor& H1, BlockedTensor& T2, const double& alpha, double& C0) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     double E = 0.0;
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "Temp120", {"aaaa"});
+    auto temp = tensor_pool_.build(tensor_type_, "Temp120", {"aaaa"});
     temp["uvxy"] += H1["ex"] * T2["uvey"];
     temp["uvxy"] -= H1["vm"] * T2["muyx"];
 
@@ -75,15 +106,17 @@ double SADSRG::H1_T2_C0(BlockedTensor& H1, BlockedTensor& T2, const double& alph
         outfile->Printf("\n    Time for [H1, T2] -> C0 : %12.3f", timer.get());
     }
     dsrg_time_.add("120", timer.get());
+    dsrg_time_.add_flops("120", contraction_flops({"uvxye", "uvxym", "uvxy"}));
     return E;
 }
 
 double SADSRG::H2_T1_C0(BlockedTensor& H2, BlockedTensor& T1, const double& alpha, double& C0) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     double E = 0.0;
 
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "Temp120", {"aaaa"});
+    auto temp = tensor_pool_.build(tensor_type_, "Temp120", {"aaaa"});
     temp["uvxy"] += H2["evxy"] * T1["ue"];
     temp["uvxy"] -= H2["uvmy"] * T1["mx"];
 
@@ -96,6 +129,7 @@ double SADSRG::H2_T1_C0(BlockedTensor& H2, BlockedTensor& T1, const double& alph
         outfile->Printf("\n    Time for [H2, T1] -> C0 : %12.3f", timer.get());
     }
     dsrg_time_.add("210", timer.get());
+    dsrg_time_.add_flops("210", contraction_flops({"uvxye", "uvxym", "uvxy"}));
     return E;
 }
 
@@ -134,11 +168,14 @@ std::vector<double> SADSRG::H2_T2_C0(BlockedTensor& H2, BlockedTensor& T2, Block
         outfile->Printf("\n    Time for [H2, T2] -> C0 : %12.3f", timer.get());
     }
     dsrg_time_.add("220", timer.get());
+    dsrg_time_.add_flops("220", contraction_flops({"efmn", "efmuv", "emnuv", "efxuyv", "mnuvxy",
+                                                   "uvxyef", "uvxyme"}));
     return Eout;
 }
 
 std::vector<double> SADSRG::H2_T2_C0_T2small(BlockedTensor& H2, BlockedTensor& T2,
                                              BlockedTensor& S2) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     /**
      * Note the following blocks should be available in memory.
      * H2: vvaa, aacc, avca, avac, vaaa, aaca
@@ -155,7 +192,7 @@ std::vector<double> SADSRG::H2_T2_C0_T2small(BlockedTensor& H2, BlockedTensor& T
     E1 += 0.25 * H2["vymn"] * S2["mnux"] * Eta1_["uv"] * Eta1_["xy"];
 
     // [H2, T2] L1 from caav
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "temp_caav", {"aaaa"});
+    auto temp = tensor_pool_.build(tensor_type_, "temp_caav", {"aaaa"});
     temp["uxyv"] += 0.5 * H2["vemx"] * S2["myue"];
     temp["uxyv"] += 0.5 * H2["vexm"] * S2["ymue"];
     E1 += temp["uxyv"] * Eta1_["uv"] * L1_["xy"];
@@ -196,10 +233,30 @@ std::vector<double> SADSRG::H2_T2_C0_T2small(BlockedTensor& H2, BlockedTensor& T
 
     E2 += temp["uvxy"] * L2_["uvxy"];
 
-    // <[Hbar2, T2]> C_6 C_2
-    if (do_cu3_) {
-        E3 += H2.block("vaaa")("ewxy") * T2.block("aava")("uvez") * rdms_.SF_L3()("xyzuwv");
-        E3 -= H2.block("aaca")("uvmz") * T2.block("caaa")("mwxy") * rdms_.SF_L3()("xyzuwv");
+    // <[Hbar2, T2]> C_6 C_2, skipping the blocks omitted by symmetry
+    bool do_vaaa = H2.is_block("vaaa") and T2.is_block("aava");
+    bool do_aaca = H2.is_block("aaca") and T2.is_block("caaa");
+    if (do_cu3_ and threepdc_algorithm_ == "SPARSE" and (do_vaaa or do_aaca)) {
+        // build the intermediate for one value of x at a time and contract it with the sparse
+        // cumulant, so that no nact^6 tensor is formed
+        auto L3 = rdms_.sparse_SF_L3(foptions_->get_double("THREEPDC_SPARSE_THRESHOLD"));
+        E3 += L3.contract_blocked([&](size_t x, ambit::Tensor& A) {
+            if (do_vaaa) {
+                auto H2_vaaa_x = fix_tensor_index(H2.block("vaaa"), 2, x);
+                A("yzuwv") += H2_vaaa_x("ewy") * T2.block("aava")("uvez");
+            }
+            if (do_aaca) {
+                auto T2_caaa_x = fix_tensor_index(T2.block("caaa"), 2, x);
+                A("yzuwv") -= H2.block("aaca")("uvmz") * T2_caaa_x("mwy");
+            }
+        });
+    } else if (do_cu3_) {
+        if (do_vaaa) {
+            E3 += H2.block("vaaa")("ewxy") * T2.block("aava")("uvez") * rdms_.SF_L3()("xyzuwv");
+        }
+        if (do_aaca) {
+            E3 -= H2.block("aaca")("uvmz") * T2.block("caaa")("mwxy") * rdms_.SF_L3()("xyzuwv");
+        }
     }
 
     return {E1, E2, E3};
@@ -216,6 +273,7 @@ void SADSRG::H1_T1_C1(BlockedTensor& H1, BlockedTensor& T1, const double& alpha,
         outfile->Printf("\n    Time for [H1, T1] -> C1 : %12.3f", timer.get());
     }
     dsrg_time_.add("111", timer.get());
+    dsrg_time_.add_flops("111", contraction_flops({"ipa", "qai"}));
 }
 
 void SADSRG::H1_T2_C1(BlockedTensor& H1, BlockedTensor& T2, const double& alpha,
@@ -235,6 +293,7 @@ void SADSRG::H1_T2_C1(BlockedTensor& H1, BlockedTensor& T2, const double& alpha,
         outfile->Printf("\n    Time for [H1, T2] -> C1 : %12.3f", timer.get());
     }
     dsrg_time_.add("121", timer.get());
+    dsrg_time_.add_flops("121", contraction_flops({"iabm", "iabm", "iabuv", "iauvj"}));
 }
 
 void SADSRG::H2_T1_C1(BlockedTensor& H2, BlockedTensor& T1, const double& alpha,
@@ -254,6 +313,7 @@ void SADSRG::H2_T1_C1(BlockedTensor& H2, BlockedTensor& T1, const double& alpha,
         outfile->Printf("\n    Time for [H2, T1] -> C1 : %12.3f", timer.get());
     }
     dsrg_time_.add("211", timer.get());
+    dsrg_time_.add_flops("211", contraction_flops({"qpma", "qpma", "qpxye", "qpmuv"}));
 }
 
 void SADSRG::H2_T2_C1(BlockedTensor& H2, BlockedTensor& T2, BlockedTensor& S2, const double& alpha,
@@ -315,6 +375,8 @@ void SADSRG::H2_T2_C1(BlockedTensor& H2, BlockedTensor& T2, BlockedTensor& S2, c
         outfile->Printf("\n    Time for [H2, T2] -> C1 : %12.3f", timer.get());
     }
     dsrg_time_.add("221", timer.get());
+    dsrg_time_.add_flops("221", contraction_flops({"irabm", "irabu", "pieja", "piuja", "iruvxyj",
+                                                   "pauvxyb", "qsxyuve", "qsxyuvm"}));
 }
 
 void SADSRG::H1_T2_C2(BlockedTensor& H1, BlockedTensor& T2, const double& alpha,
@@ -331,6 +393,7 @@ void SADSRG::H1_T2_C2(BlockedTensor& H1, BlockedTensor& T2, const double& alpha,
         outfile->Printf("\n    Time for [H1, T2] -> C2 : %12.3f", timer.get());
     }
     dsrg_time_.add("122", timer.get());
+    dsrg_time_.add_flops("122", contraction_flops({"ijpba", "ijpba", "qjabi", "qjabi"}));
 }
 
 void SADSRG::H2_T1_C2(BlockedTensor& H2, BlockedTensor& T1, const double& alpha,
@@ -347,10 +410,12 @@ void SADSRG::H2_T1_C2(BlockedTensor& H2, BlockedTensor& T1, const double& alpha,
         outfile->Printf("\n    Time for [H2, T1] -> C2 : %12.3f", timer.get());
     }
     dsrg_time_.add("212", timer.get());
+    dsrg_time_.add_flops("212", contraction_flops({"irpqa", "irpqa", "rsaqi", "rsaqi"}));
 }
 
 void SADSRG::H2_T2_C2(BlockedTensor& H2, BlockedTensor& T2, BlockedTensor& S2, const double& alpha,
                       BlockedTensor& C2) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     // particle-particle contractions
@@ -374,7 +439,8 @@ void SADSRG::H2_T2_C2(BlockedTensor& H2, BlockedTensor& T2, BlockedTensor& S2, c
             blocks.push_back(block);
     }
 
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "temp", blocks);
+    auto temp = tensor_pool_.build(tensor_type_, "temp", blocks);
+    dsrg_time_.add_memory("222", temp.numel() * sizeof(double));
     temp["qjsb"] += alpha * H2["aqms"] * S2["mjab"];
     temp["qjsb"] -= alpha * H2["aqsm"] * T2["mjab"];
     temp["qjsb"] += 0.5 * alpha * L1_["xy"] * S2["yjab"] * H2["aqxs"];
@@ -393,7 +459,8 @@ void SADSRG::H2_T2_C2(BlockedTensor& H2, BlockedTensor& T2, BlockedTensor& S2, c
             blocks.push_back(block);
     }
 
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", blocks);
+    temp = tensor_pool_.build(tensor_type_, "temp", blocks);
+    dsrg_time_.add_memory("222", temp.numel() * sizeof(double));
     temp["jqsb"] -= alpha * H2["aqsm"] * T2["mjba"];
     temp["jqsb"] -= 0.5 * alpha * L1_["xy"] * T2["yjba"] * H2["aqsx"];
     temp["jqsb"] += 0.5 * alpha * L1_["xy"] * T2["ijbx"] * H2["yqsi"];
@@ -405,14 +472,17 @@ void SADSRG::H2_T2_C2(BlockedTensor& H2, BlockedTensor& T2, BlockedTensor& S2, c
         outfile->Printf("\n    Time for [H2, T2] -> C2 : %12.3f", timer.get());
     }
     dsrg_time_.add("222", timer.get());
+    dsrg_time_.add_flops("222", contraction_flops({"ijrsab", "pqabij", "qjsbam", "qjsbam",
+                                                   "jqsbam"}));
 }
 
 void SADSRG::V_T1_C0_DF(BlockedTensor& B, BlockedTensor& T1, const double& alpha, double& C0) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     double E = 0.0;
 
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp120", {"Laa"});
+    auto temp = tensor_pool_.build(tensor_type_, "DFtemp120", {"Laa"});
     temp["gux"] += B["gex"] * T1["ue"];
     temp["gux"] -= B["gum"] * T1["mx"];
 
@@ -425,17 +495,19 @@ void SADSRG::V_T1_C0_DF(BlockedTensor& B, BlockedTensor& T1, const double& alpha
         outfile->Printf("\n    Time for [H2, T1] -> C0 : %12.3f", timer.get());
     }
     dsrg_time_.add("210", timer.get());
+    dsrg_time_.add_flops("210", contraction_flops({"guxe", "guxm", "guxvy"}));
 }
 
 std::vector<double> SADSRG::V_T2_C0_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2,
                                        const double& alpha, double& C0) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     std::vector<double> Eout{0.0, 0.0, 0.0};
     double E = 0.0;
 
     // [H2, T2] (C_2)^4 from ccvv, cavv, and ccav
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "temp_220", {"Lvc"});
+    auto temp = tensor_pool_.build(tensor_type_, "temp_220", {"Lvc"});
     temp["gem"] += B["gfn"] * S2["mnef"];
     temp["gem"] += B["gfu"] * S2["mvef"] * L1_["uv"];
     temp["gem"] += B["gvn"] * S2["nmue"] * Eta1_["uv"];
@@ -444,8 +516,9 @@ std::vector<double> SADSRG::V_T2_C0_DF(BlockedTensor& B, BlockedTensor& T2, Bloc
 
     // form H2 for other blocks that fits memory
     std::vector<std::string> blocks{"aacc", "aaca", "vvaa", "vaaa", "avac", "avca"};
-    auto H2 = ambit::BlockedTensor::build(tensor_type_, "temp_H2", blocks);
+    auto H2 = tensor_pool_.build(tensor_type_, "temp_H2", blocks);
     H2["abij"] = B["gai"] * B["gbj"];
+    dsrg_time_.add_memory("220", (temp.numel() + H2.numel()) * sizeof(double));
 
     auto Esmall = H2_T2_C0_T2small(H2, T2, S2);
 
@@ -462,20 +535,23 @@ std::vector<double> SADSRG::V_T2_C0_DF(BlockedTensor& B, BlockedTensor& T2, Bloc
         outfile->Printf("\n    Time for [H2, T2] -> C0 : %12.3f", timer.get());
     }
     dsrg_time_.add("220", timer.get());
+    dsrg_time_.add_flops("220", contraction_flops({"gemnf", "gemfu", "gemnu", "gem", "efuvg",
+                                                   "uvxyef", "uvxymn"}));
     return Eout;
 }
 
 void SADSRG::V_T1_C1_DF(BlockedTensor& B, BlockedTensor& T1, const double& alpha,
                         BlockedTensor& C1) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp211", {"L"});
+    auto temp = tensor_pool_.build(tensor_type_, "DFtemp211", {"L"});
     temp["g"] += 2.0 * alpha * T1["ma"] * B["gam"];
     temp["g"] += alpha * T1["xe"] * L1_["yx"] * B["gey"];
     temp["g"] -= alpha * T1["mu"] * L1_["uv"] * B["gvm"];
     C1["qp"] += temp["g"] * B["gqp"];
 
-    temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp211", {"Lgc"});
+    temp = tensor_pool_.build(tensor_type_, "DFtemp211", {"Lgc"});
     temp["gpm"] -= alpha * T1["ma"] * B["gap"];
     temp["gpm"] += 0.5 * alpha * T1["mu"] * L1_["uv"] * B["gvp"];
     C1["qp"] += temp["gpm"] * B["gqm"];
@@ -486,14 +562,17 @@ void SADSRG::V_T1_C1_DF(BlockedTensor& B, BlockedTensor& T1, const double& alpha
         outfile->Printf("\n    Time for [H2, T1] -> C1 : %12.3f", timer.get());
     }
     dsrg_time_.add("211", timer.get());
+    dsrg_time_.add_flops("211", contraction_flops({"gma", "gqp", "gpma", "gpqm", "gpqxe"}));
 }
 
 void SADSRG::V_T2_C1_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2, const double& alpha,
                         BlockedTensor& C1) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     // [Hbar2, T2] (C_2)^3 -> C1 particle contractions
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp221", {"Lhp"});
+    auto temp = tensor_pool_.build(tensor_type_, "DFtemp221", {"Lhp"});
+    dsrg_time_.add_memory("221", temp.numel() * sizeof(double));
 
     temp["gia"] += alpha * B["gbm"] * S2["imab"];
 
@@ -541,12 +620,12 @@ void SADSRG::V_T2_C1_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2,
     C1["pa"] += temp["gia"] * B["gpi"];
 
     // [Hbar2, T2] C_4 C_2 1:3 -> C1
-    temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp221", {"Laa"});
+    temp = tensor_pool_.build(tensor_type_, "DFtemp221", {"Laa"});
     temp["gxu"] = B["gvy"] * L2_["xyuv"];
     C1["jb"] += 0.5 * alpha * B["gax"] * S2["ujab"] * temp["gxu"];
     C1["jb"] -= 0.5 * alpha * B["gui"] * S2["ijxb"] * temp["gxu"];
 
-    temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp221", {"L"});
+    temp = tensor_pool_.build(tensor_type_, "DFtemp221", {"L"});
     temp["g"] += alpha * B["gex"] * T2["uvey"] * L2_["xyuv"];
     temp["g"] -= alpha * B["gum"] * T2["mvxy"] * L2_["xyuv"];
     C1["qs"] += temp["g"] * B["gqs"];
@@ -559,6 +638,8 @@ void SADSRG::V_T2_C1_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2,
         outfile->Printf("\n    Time for [H2, T2] -> C1 : %12.3f", timer.get());
     }
     dsrg_time_.add("221", timer.get());
+    dsrg_time_.add_flops("221", contraction_flops({"giabm", "gijae", "gira", "gpai", "gjbuxa",
+                                                   "gqsex"}));
 }
 
 void SADSRG::V_T1_C2_DF(BlockedTensor& B, BlockedTensor& T1, const double& alpha,
@@ -574,17 +655,17 @@ void SADSRG::V_T1_C2_DF(BlockedTensor& B, BlockedTensor& T1, const double& alpha
         outfile->Printf("\n    Time for [H2, T1] -> C2 : %12.3f", timer.get());
     }
     dsrg_time_.add("212", timer.get());
+    dsrg_time_.add_flops("212", contraction_flops({"irpqag", "irpqag", "rsaqig", "rsaqig"}));
 }
 
 void SADSRG::V_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2, const double& alpha,
                         BlockedTensor& C2) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     local_timer timer;
 
     // particle-particle contractions
-    // TODO: need to investigate why using "r" fails when C2 does not contain all "rs"
-    C2["ijes"] += batched("e", alpha * B["gae"] * B["gbs"] * T2["ijab"]);
-    C2["ijus"] += batched("u", alpha * B["gau"] * B["gbs"] * T2["ijab"]);
-    C2["ijms"] += batched("m", alpha * B["gam"] * B["gbs"] * T2["ijab"]);
+    // C2["ijrs"] += alpha * B["gar"] * B["gbs"] * T2["ijab"], directly from B for all C2 blocks
+    df_pp_ladder(B, T2, alpha, C2, dsrg_mem_.available());
 
     std::vector<std::string> C2blocks;
     for (const std::string& block : C2.block_labels()) {
@@ -593,7 +674,8 @@ void SADSRG::V_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2,
         C2blocks.push_back(block);
     }
 
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222", C2blocks);
+    auto temp = tensor_pool_.build(tensor_type_, "DFtemp222", C2blocks);
+    dsrg_time_.add_memory("222", temp.numel() * sizeof(double));
     temp["ijes"] += batched("e", L1_["xy"] * T2["ijxb"] * B["gye"] * B["gbs"]);
     temp["ijks"] += L1_["xy"] * T2["ijxb"] * B["gyk"] * B["gbs"];
 
@@ -610,7 +692,8 @@ void SADSRG::V_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2,
             Vblocks.push_back(s);
     }
 
-    temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222", Vblocks);
+    temp = tensor_pool_.build(tensor_type_, "DFtemp222", Vblocks);
+    dsrg_time_.add_memory("222", temp.numel() * sizeof(double));
     temp["pqij"] = B["gpi"] * B["gqj"];
 
     C2["pqab"] += alpha * temp["pqij"] * T2["ijab"];
@@ -619,7 +702,7 @@ void SADSRG::V_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2,
     C2["qpba"] -= 0.5 * alpha * Eta1_["xy"] * T2["yjab"] * temp["pqxj"];
 
     // hole-particle contractions
-    temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222", {"Lhp"});
+    temp = tensor_pool_.build(tensor_type_, "DFtemp222", {"Lhp"});
     temp["gjb"] += alpha * B["gam"] * S2["mjab"];
     temp["gjb"] += 0.5 * alpha * L1_["xy"] * S2["yjab"] * B["gax"];
     temp["gjb"] -= 0.5 * alpha * L1_["xy"] * S2["ijxb"] * B["gyi"];
@@ -634,10 +717,13 @@ void SADSRG::V_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& S2,
         outfile->Printf("\n    Time for [H2, T2] -> C2 : %12.3f", timer.get());
     }
     dsrg_time_.add("222", timer.get());
+    dsrg_time_.add_flops("222", contraction_flops({"ijabrg", "ijbrsg", "pqijg", "pqabij", "gjbam",
+                                                   "qjsbg", "qjsbamg", "jqsbamg"}));
 }
 
 void SADSRG::V_T2_C2_DF_PH_X(BlockedTensor& B, BlockedTensor& T2, const double& alpha,
                              BlockedTensor& C2) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
 
     std::vector<std::string> qjsb_small, qjsb_large, jqsb_small, jqsb_large;
 
@@ -663,7 +749,7 @@ void SADSRG::V_T2_C2_DF_PH_X(BlockedTensor& B, BlockedTensor& T2, const double&
         }
     }
 
-    auto temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222PHX", qjsb_small);
+    auto temp = tensor_pool_.build(tensor_type_, "DFtemp222PHX", qjsb_small);
     temp["qjsb"] -= alpha * B["gas"] * B["gqm"] * T2["mjab"];
     temp["qjsb"] -= 0.5 * alpha * L1_["xy"] * T2["yjab"] * B["gas"] * B["gqx"];
     temp["qjsb"] += 0.5 * alpha * L1_["xy"] * T2["ijxb"] * B["gys"] * B["gqi"];
@@ -671,7 +757,7 @@ void SADSRG::V_T2_C2_DF_PH_X(BlockedTensor& B, BlockedTensor& T2, const double&
     C2["qjsb"] += temp["qjsb"];
     C2["jqbs"] += temp["qjsb"];
 
-    temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222PHX", jqsb_small);
+    temp = tensor_pool_.build(tensor_type_, "DFtemp222PHX", jqsb_small);
     temp["jqsb"] -= alpha * B["gas"] * B["gqm"] * T2["mjba"];
     temp["jqsb"] -= 0.5 * alpha * L1_["xy"] * T2["yjba"] * B["gas"] * B["gqx"];
     temp["jqsb"] += 0.5 * alpha * L1_["xy"] * T2["ijbx"] * B["gys"] * B["gqi"];
@@ -683,12 +769,12 @@ void SADSRG::V_T2_C2_DF_PH_X(BlockedTensor& B, BlockedTensor& T2, const double&
         C2["e,j,f,v0"] -= batched("e", alpha * B["g,a,f"] * B["g,e,m"] * T2["m,j,a,v0"]);
         C2["j,e,v0,f"] -= batched("e", alpha * B["g,a,f"] * B["g,e,m"] * T2["m,j,a,v0"]);
 
-        temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222PHX", {"ahpv"});
+        temp = tensor_pool_.build(tensor_type_, "DFtemp222PHX", {"ahpv"});
         temp["xjae"] = L1_["xy"] * T2["yjae"];
         C2["e,j,f,v0"] -= batched("e", 0.5 * alpha * temp["x,j,a,v0"] * B["g,a,f"] * B["g,e,x"]);
         C2["j,e,v0,f"] -= batched("e", 0.5 * alpha * temp["x,j,a,v0"] * B["g,a,f"] * B["g,e,x"]);
 
-        temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222PHX", {"hhav"});
+        temp = tensor_pool_.build(tensor_type_, "DFtemp222PHX", {"hhav"});
         temp["ijye"] = L1_["xy"] * T2["ijxe"];
         C2["e,j,f,v0"] += batched("e", 0.5 * alpha * temp["i,j,y,v0"] * B["g,y,f"] * B["g,e,i"]);
         C2["j,e,v0,f"] += batched("e", 0.5 * alpha * temp["i,j,y,v0"] * B["g,y,f"] * B["g,e,i"]);
@@ -698,12 +784,12 @@ void SADSRG::V_T2_C2_DF_PH_X(BlockedTensor& B, BlockedTensor& T2, const double&
         C2["j,e,f,v0"] -= batched("e", alpha * B["g,a,f"] * B["g,e,m"] * T2["m,j,v0,a"]);
         C2["e,j,v0,f"] -= batched("e", alpha * B["g,a,f"] * B["g,e,m"] * T2["m,j,v0,a"]);
 
-        temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222PHX", {"ahvp"});
+        temp = tensor_pool_.build(tensor_type_, "DFtemp222PHX", {"ahvp"});
         temp["xjea"] = L1_["xy"] * T2["yjea"];
         C2["j,e,f,v0"] -= batched("e", 0.5 * alpha * temp["x,j,v0,a"] * B["g,a,f"] * B["g,e,x"]);
         C2["e,j,v0,f"] -= batched("e", 0.5 * alpha * temp["x,j,v0,a"] * B["g,a,f"] * B["g,e,x"]);
 
-        temp = ambit::BlockedTensor::build(tensor_type_, "DFtemp222PHX", {"hhva"});
+        temp = tensor_pool_.build(tensor_type_, "DFtemp222PHX", {"hhva"});
         temp["ijey"] = L1_["xy"] * T2["ijex"];
         C2["j,e,f,v0"] += batched("e", 0.5 * alpha * temp["i,j,v0,y"] * B["g,y,f"] * B["g,e,i"]);
         C2["e,j,v0,f"] += batched("e", 0.5 * alpha * temp["i,j,v0,y"] * B["g,y,f"] * B["g,e,i"]);
@@ -712,13 +798,14 @@ void SADSRG::V_T2_C2_DF_PH_X(BlockedTensor& B, BlockedTensor& T2, const double&
 
 void SADSRG::H_A_Ca(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor& T1, BlockedTensor& T2,
                     BlockedTensor& S2, const double& alpha, BlockedTensor& C1, BlockedTensor& C2) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     // set up G2["pqrs"] = 2 * H2["pqrs"] - H2["pqsr"]
-    auto G2 = ambit::BlockedTensor::build(tensor_type_, "G2H", {"avac", "aaac", "avaa"});
+    auto G2 = tensor_pool_.build(tensor_type_, "G2H", {"avac", "aaac", "avaa"});
     G2["pqrs"] = 2.0 * H2["pqrs"] - H2["pqsr"];
 
     H_A_Ca_small(H1, H2, G2, T1, T2, S2, alpha, C1, C2);
 
-    auto temp = ambit::BlockedTensor::build(ambit::CoreTensor, "tempHACa", {"aa"});
+    auto temp = tensor_pool_.build(ambit::CoreTensor, "tempHACa", {"aa"});
     temp["wz"] += H2["efzm"] * S2["wmef"];
     temp["wz"] -= H2["wemn"] * S2["mnze"];
 
@@ -729,6 +816,7 @@ void SADSRG::H_A_Ca(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor& T1, Blo
 void SADSRG::H_A_Ca_small(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor& G2,
                           BlockedTensor& T1, BlockedTensor& T2, BlockedTensor& S2,
                           const double& alpha, BlockedTensor& C1, BlockedTensor& C2) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     /**
      * The following blocks should be available in memory:
      * G2: avac, aaac, avaa
@@ -737,7 +825,7 @@ void SADSRG::H_A_Ca_small(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor& G
      * S2: the same as T2
      */
 
-    auto temp = ambit::BlockedTensor::build(ambit::CoreTensor, "tempHACa", {"aa"});
+    auto temp = tensor_pool_.build(ambit::CoreTensor, "tempHACa", {"aa"});
 
     temp["uv"] += H1["ev"] * T1["ue"];
     temp["uv"] -= H1["um"] * T1["mv"];
@@ -749,7 +837,7 @@ void SADSRG::H_A_Ca_small(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor& G
     C1["uv"] += alpha * temp["uv"];
     C1["vu"] += alpha * temp["uv"];
 
-    temp = ambit::BlockedTensor::build(ambit::CoreTensor, "temp", {"aaaa"});
+    temp = tensor_pool_.build(ambit::CoreTensor, "temp", {"aaaa"});
 
     H_T_C2a_smallS(H1, H2, T1, T2, S2, temp);
 
@@ -775,6 +863,7 @@ void SADSRG::H_T_C1a_smallG(BlockedTensor& G2, BlockedTensor& T1, BlockedTensor&
 
 void SADSRG::H_T_C1a_smallS(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor& T2,
                             BlockedTensor& S2, BlockedTensor& C1) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     /**
      * The following blocks should be available in memory:
      * H2: vvaa, aacc, avca, avac, vaaa, aaca, aaaa
@@ -802,7 +891,7 @@ void SADSRG::H_T_C1a_smallS(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor&
     C1["wz"] -= H2["weum"] * S2["umze"];
     C1["wz"] -= H2["ewvu"] * S2["vuez"];
 
-    auto temp = ambit::BlockedTensor::build(ambit::CoreTensor, "temp", {"aaaa"});
+    auto temp = tensor_pool_.build(ambit::CoreTensor, "temp", {"aaaa"});
 
     // temp["wzuv"] += 0.5 * S2["wvab"] * H2["abzu"];
     temp["wzuv"] += 0.5 * S2["wvef"] * H2["efzu"];
@@ -860,6 +949,7 @@ void SADSRG::H_T_C1a_smallS(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor&
 
 void SADSRG::H_T_C2a_smallS(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor& T1,
                             BlockedTensor& T2, BlockedTensor& S2, BlockedTensor& C2) {
+    BlockedTensorPool::Scope scope(tensor_pool_);
     /**
      * The following blocks should be available in memory:
      * H2: vvaa, aacc, avca, avac, vaaa, aaca, aaaa
@@ -879,7 +969,7 @@ void SADSRG::H_T_C2a_smallS(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor&
     C2["uvxy"] += H2["vumw"] * T2["mwyx"];
     C2["uvxy"] += H2["uvmw"] * T2["mwxy"];
 
-    auto temp = ambit::BlockedTensor::build(ambit::CoreTensor, "temp", {"aaaa"});
+    auto temp = tensor_pool_.build(ambit::CoreTensor, "temp", {"aaaa"});
     temp["uvxy"] += H1["ax"] * T2["uvay"];
     temp["uvxy"] -= H1["ui"] * T2["ivxy"];
     temp["uvxy"] += T1["ua"] * H2["avxy"];
@@ -233,6 +233,8 @@ double ACTIVE_DSRGPT2::compute_energy() {
     // some preps for oscillator strength
     std::vector<std::pair<psi::SharedVector, double>> eigen0;
     ref_wfns_.clear();
+    osc_ci_rdms_.reset();
+    osc_irrep_ = -1;
 
     // real computation
     for (int h = 0; h < nirrep; ++h) {
@@ -314,7 +316,8 @@ double ACTIVE_DSRGPT2::compute_energy() {
             fci_mo_->set_root(i);
             std::vector<std::pair<size_t, size_t>> root;
             root.push_back(std::make_pair(i, i));
-            RDMs rdms = fci_mo_->rdms(root, 3)[0];
+            // only the 1-RDMs are needed to build the Fock matrix
+            RDMs rdms = fci_mo_->rdms(root, 1)[0];
             semi->semicanonicalize(rdms, 1, true, false);
 
             Uas.emplace_back(semi->Ua()->clone());
@@ -454,6 +457,9 @@ double ACTIVE_DSRGPT2::compute_energy() {
         }
     }
 
+    // release the coupling maps of the transition densities
+    osc_ci_rdms_.reset();
+
     // print results
     if (multiplicity_ == 1) {
         print_osc();
@@ -711,20 +717,29 @@ Vector4 ACTIVE_DSRGPT2::compute_td_ref_root(std::shared_ptr<ActiveSpaceIntegrals
 void ACTIVE_DSRGPT2::compute_osc_pt2(const int& irrep, const int& root, const double& Tde_x,
                                      ambit::BlockedTensor& T1_x, ambit::BlockedTensor& T2_x) {
     // compute rdms transition density
-    // step 1: combine p_space and eigenvectors if needed
+    // step 1: combine p_space and eigenvectors if needed (once per irrep)
     int n = root;
-    std::vector<Determinant> p_space(p_space_g_);
-    psi::SharedMatrix evecs = ref_wfns_[0];
-
     if (irrep != 0) {
         n += ref_wfns_[0]->ncol();
-        std::vector<Determinant> p_space1 = fci_mo_->p_space();
-        p_space.insert(p_space.end(), p_space1.begin(), p_space1.end());
-        evecs = combine_evecs(0, irrep);
+    }
+
+    if (osc_irrep_ != irrep or (not osc_ci_rdms_)) {
+        std::vector<Determinant> p_space(p_space_g_);
+        psi::SharedMatrix evecs = ref_wfns_[0];
+
+        if (irrep != 0) {
+            std::vector<Determinant> p_space1 = fci_mo_->p_space();
+            p_space.insert(p_space.end(), p_space1.begin(), p_space1.end());
+            evecs = combine_evecs(0, irrep);
+        }
+
+        osc_ci_rdms_ = std::make_shared<CI_RDMS>(fci_mo_->fci_ints(), p_space, evecs, 0, n);
+        osc_irrep_ = irrep;
     }
 
     // step 2: use CI_RDMS to compute transition density
-    CI_RDMS ci_rdms(fci_mo_->fci_ints(), p_space, evecs, 0, n);
+    CI_RDMS& ci_rdms = *osc_ci_rdms_;
+    ci_rdms.set_roots(0, n);
 
     ambit::BlockedTensor TD1, TD2, TD3;
     TD1 = ambit::BlockedTensor::build(ambit::CoreTensor, "TD1", spin_cases({"aa"}));
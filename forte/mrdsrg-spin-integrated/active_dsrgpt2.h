@@ -56,6 +56,7 @@
 
 namespace forte {
 
+class CI_RDMS;
 class FCI_MO;
 class SCFInfo;
 class ForteOptions;
@@ -200,6 +201,13 @@ class ACTIVE_DSRGPT2 {
     /// (De-normal-ordered) T2 amplitudes of the ground state
     ambit::BlockedTensor T2_g_;
 
+    /// Transition densities between the ground state and the states of irrep osc_irrep_.
+    /// Shared by all the state pairs of that irrep so that the coupling maps of the combined
+    /// determinant space are built only once.
+    std::shared_ptr<CI_RDMS> osc_ci_rdms_;
+    /// The irrep of the excited states of osc_ci_rdms_
+    int osc_irrep_ = -1;
+
     /// Compute the DSRG-PT2 oscillator strength
     void compute_osc_pt2(const int& irrep, const int& root, const double& Tde_x,
                          ambit::BlockedTensor& T1_x, ambit::BlockedTensor& T2_x);
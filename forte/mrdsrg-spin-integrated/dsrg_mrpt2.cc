@@ -1336,6 +1336,13 @@ double DSRG_MRPT2::E_VT2_6() {
     std::string str = "Computing <[V, T2]> C_6 C_2";
     outfile->Printf("\n    %-40s ...", str.c_str());
 
+    if (foptions_->get_str("THREEPDC_ALGORITHM") == "SPARSE") {
+        double E = E_VT2_6_sparse();
+        outfile->Printf("  Done. Timing %15.6f s", timer.get());
+        dsrg_time_.add("220", timer.get());
+        return E;
+    }
+
     double E = 0.0;
 
     // aaa
@@ -1407,6 +1414,114 @@ double DSRG_MRPT2::E_VT2_6() {
     return E;
 }
 
+double DSRG_MRPT2::E_VT2_6_sparse() {
+    // Same contractions as E_VT2_6, but the cumulants keep only the elements above threshold and
+    // the intermediates are built for one value of their x index at a time. Memory is nact^5
+    // instead of nact^6. Labels k and K denote the internal active indices
+    double threshold = foptions_->get_double("THREEPDC_SPARSE_THRESHOLD");
+    double E = 0.0;
+
+    // aaa and bbb
+    for (const std::string& s : {"a", "A"}) {
+        auto block = [&](const std::string& labels) {
+            std::string name(labels);
+            if (s == "A") {
+                std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+            }
+            return name;
+        };
+        auto V_aaca = V_.block(block("aaca"));
+        auto V_avaa = V_.block(block("avaa"));
+        auto V_aaaa = V_.block(block("aaaa"));
+        auto T2_caaa = T2_.block(block("caaa"));
+        auto T2_aava = T2_.block(block("aava"));
+        auto T2_aaaa = T2_.block(block("aaaa"));
+
+        auto L3 = (s == "a") ? rdms_.sparse_L3aaa(threshold) : rdms_.sparse_L3bbb(threshold);
+        E += 0.25 * L3.contract_blocked([&](size_t x, ambit::Tensor& A) {
+            auto V_avaa_x = fix_tensor_index(V_avaa, 2, x);
+            auto T2_caaa_x = fix_tensor_index(T2_caaa, 2, x);
+            A("yzuvw") += V_aaca("uvmz") * T2_caaa_x("mwy");
+            A("yzuvw") += V_avaa_x("wey") * T2_aava("uvez");
+
+            if (internal_amp_) {
+                auto V_aaaa_x = fix_tensor_index(V_aaaa, 2, x);
+                auto T2_aaaa_x = fix_tensor_index(T2_aaaa, 2, x);
+                A("yzuvw") += V_aaaa("uvkz") * T2_aaaa_x("kwy");
+                A("yzuvw") += V_aaaa_x("wky") * T2_aaaa("uvkz");
+            }
+        });
+    }
+
+    // aab
+    {
+        auto L3 = rdms_.sparse_L3aab(threshold);
+        E += 0.5 * L3.contract_blocked([&](size_t x, ambit::Tensor& A) {
+            auto T2_cAaA_x = fix_tensor_index(T2_.block("cAaA"), 2, x);
+            auto T2_caaa_x = fix_tensor_index(T2_.block("caaa"), 2, x);
+            auto T2_aCaA_x = fix_tensor_index(T2_.block("aCaA"), 2, x);
+            auto V_vAaA_x = fix_tensor_index(V_.block("vAaA"), 2, x);
+            auto V_avaa_x = fix_tensor_index(V_.block("avaa"), 2, x);
+            auto V_aVaA_x = fix_tensor_index(V_.block("aVaA"), 2, x);
+            A("yZuvW") -= V_.block("aaca")("uvmy") * T2_cAaA_x("mWZ");
+            A("yZuvW") -= V_.block("aAcA")("uWmZ") * T2_caaa_x("mvy");
+            A("yZuvW") += 2.0 * V_.block("aAaC")("uWyM") * T2_aCaA_x("vMZ");
+
+            A("yZuvW") += V_vAaA_x("eWZ") * T2_.block("aava")("uvey");
+            A("yZuvW") -= V_avaa_x("vey") * T2_.block("aAvA")("uWeZ");
+            A("yZuvW") -= 2.0 * V_aVaA_x("vEZ") * T2_.block("aAaV")("uWyE");
+
+            if (internal_amp_) {
+                auto V_aaaa_x = fix_tensor_index(V_.block("aaaa"), 2, x);
+                auto V_aAaA_x = fix_tensor_index(V_.block("aAaA"), 2, x);
+                auto T2_aaaa_x = fix_tensor_index(T2_.block("aaaa"), 2, x);
+                auto T2_aAaA_x = fix_tensor_index(T2_.block("aAaA"), 2, x);
+                A("yZuvW") -= V_.block("aaaa")("uvky") * T2_aAaA_x("kWZ");
+                A("yZuvW") -= V_.block("aAaA")("uWkZ") * T2_aaaa_x("kvy");
+                A("yZuvW") += 2.0 * V_.block("aAaA")("uWyK") * T2_aAaA_x("vKZ");
+
+                A("yZuvW") += V_aAaA_x("kWZ") * T2_.block("aaaa")("uvky");
+                A("yZuvW") -= V_aaaa_x("vky") * T2_.block("aAaA")("uWkZ");
+                A("yZuvW") -= 2.0 * V_aAaA_x("vKZ") * T2_.block("aAaA")("uWyK");
+            }
+        });
+    }
+
+    // abb
+    {
+        auto L3 = rdms_.sparse_L3abb(threshold);
+        E += 0.5 * L3.contract_blocked([&](size_t x, ambit::Tensor& A) {
+            auto T2_aCaA_x = fix_tensor_index(T2_.block("aCaA"), 2, x);
+            auto V_aAaC_x = fix_tensor_index(V_.block("aAaC"), 2, x);
+            auto T2_cAaA_x = fix_tensor_index(T2_.block("cAaA"), 2, x);
+            auto V_aVaA_x = fix_tensor_index(V_.block("aVaA"), 2, x);
+            auto T2_aAaV_x = fix_tensor_index(T2_.block("aAaV"), 2, x);
+            auto V_vAaA_x = fix_tensor_index(V_.block("vAaA"), 2, x);
+            A("YZuVW") -= V_.block("AACA")("VWMZ") * T2_aCaA_x("uMY");
+            A("YZuVW") -= V_aAaC_x("uVM") * T2_.block("CAAA")("MWYZ");
+            A("YZuVW") += 2.0 * V_.block("aAcA")("uVmZ") * T2_cAaA_x("mWY");
+
+            A("YZuVW") += V_aVaA_x("uEY") * T2_.block("AAVA")("VWEZ");
+            A("YZuVW") -= V_.block("AVAA")("WEYZ") * T2_aAaV_x("uVE");
+            A("YZuVW") -= 2.0 * V_vAaA_x("eWY") * T2_.block("aAvA")("uVeZ");
+
+            if (internal_amp_) {
+                auto V_aAaA_x = fix_tensor_index(V_.block("aAaA"), 2, x);
+                auto T2_aAaA_x = fix_tensor_index(T2_.block("aAaA"), 2, x);
+                A("YZuVW") -= V_.block("AAAA")("VWKZ") * T2_aAaA_x("uKY");
+                A("YZuVW") -= V_aAaA_x("uVK") * T2_.block("AAAA")("KWYZ");
+                A("YZuVW") += 2.0 * V_.block("aAaA")("uVkZ") * T2_aAaA_x("kWY");
+
+                A("YZuVW") += V_aAaA_x("uKY") * T2_.block("AAAA")("VWKZ");
+                A("YZuVW") -= V_.block("AAAA")("WKYZ") * T2_aAaA_x("uVK");
+                A("YZuVW") -= 2.0 * V_aAaA_x("kWY") * T2_.block("aAaA")("uVkZ");
+            }
+        });
+    }
+
+    return E;
+}
+
 void DSRG_MRPT2::print_dm_pt2() {
     print_h2("DSRG-MRPT2 (unrelaxed) Dipole Moments (a.u.)");
 
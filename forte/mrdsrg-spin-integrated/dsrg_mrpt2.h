@@ -38,6 +38,8 @@ using namespace ambit;
 
 namespace forte {
 
+class CI_RDMS;
+
 class DSRG_MRPT2 : public MASTER_DSRG {
   public:
     /**
@@ -229,6 +231,9 @@ class DSRG_MRPT2 : public MASTER_DSRG {
     double E_VT2_4HH();
     double E_VT2_4PH();
     double E_VT2_6();
+    /// E_VT2_6 contracted with the sparse 3-body cumulants, one slice of the intermediates at a
+    /// time (THREEPDC_ALGORITHM = SPARSE)
+    double E_VT2_6_sparse();
 
     // => Dipole related <= //
 
@@ -290,19 +295,19 @@ class DSRG_MRPT2 : public MASTER_DSRG {
     /// Build effective singles: T_{ia} -= T_{iu,av} * Gamma_{vu}
     void build_T1eff_deGNO();
 
-    /// Compute density cumulants
-    void compute_cumulants(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
-                           std::vector<forte::Determinant>& p_space, psi::SharedMatrix evecs,
-                           const int& root1, const int& root2);
+    /// Compute density cumulants of <root1| |root2>, the coupling maps of ci_rdms are reused
+    void compute_cumulants(CI_RDMS& ci_rdms, const int& root1, const int& root2);
     /// Compute denisty matrices and puts in Gamma1_, Lambda2_, and Lambda3_
-    void compute_rdms(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
-                      std::vector<Determinant>& p_space, psi::SharedMatrix evecs, const int& root1,
-                      const int& root2);
+    void compute_rdms(CI_RDMS& ci_rdms, const int& root1, const int& root2);
 
     /// Compute MS coupling <M|H|N>
     double compute_ms_1st_coupling(const std::string& name);
-    /// Compute MS coupling <M|HT|N>
-    double compute_ms_2nd_coupling(const std::string& name);
+    /// Build the active parts H1, H2, and H3 of [H, T] that couple to the densities.
+    /// They only depend on the amplitudes of the ket state and are shared by all bra states.
+    void build_ms_2nd_coupling(BlockedTensor& H1, BlockedTensor& H2, BlockedTensor& H3);
+    /// Compute MS coupling <M|HT|N> from the intermediates of build_ms_2nd_coupling
+    double compute_ms_2nd_coupling(const std::string& name, BlockedTensor& H1, BlockedTensor& H2,
+                                   BlockedTensor& H3);
 
     /// Rotate RDMs computed by eigens_ (in original basis) to semicanonical basis
     /// so that they are in the same basis as amplitudes (in semicanonical basis)
@@ -403,8 +403,9 @@ std::vector<std::vector<double>> DSRG_MRPT2::compute_energy_xms() {
                 ambit::Tensor D1a = L1a.clone();
                 ambit::Tensor D1b = L1b.clone();
 
+                CI_RDMS ci_rdms(fci_ints, p_space, civecs, 0, 0);
                 for (int M = 0; M < nstates; ++M) {
-                    CI_RDMS ci_rdms(fci_ints, p_space, civecs, M, M);
+                    ci_rdms.set_roots(M, M);
                     ci_rdms.compute_1rdm(D1a.data(), D1b.data());
                     L1a("pq") += D1a("pq");
                     L1b("pq") += D1b("pq");
@@ -430,13 +431,21 @@ std::vector<std::vector<double>> DSRG_MRPT2::compute_energy_xms() {
                                                        " " + irrep_symbol[irrep],
                                                    nstates, nstates));
 
+        // the coupling maps of the reference space are shared by all densities of this symmetry
+        CI_RDMS ci_rdms(fci_ints, p_space, civecs, 0, 0);
+
+        // intermediates of <N|HT|M> that only depend on the amplitudes of state M
+        BlockedTensor H1 = BTF_->build(tensor_type_, "Heff1_2nd", spin_cases({"aa"}));
+        BlockedTensor H2 = BTF_->build(tensor_type_, "Heff2_2nd", spin_cases({"aaaa"}));
+        BlockedTensor H3 = BTF_->build(tensor_type_, "Heff3_2nd", spin_cases({"aaaaaa"}));
+
         // loop over states
         for (int M = 0; M < nstates; ++M) {
 
             print_h2("Compute DSRG-MRPT2 Energy of State " + std::to_string(M));
 
             // compute the densities
-            compute_cumulants(fci_ints, p_space, civecs, M, M);
+            compute_cumulants(ci_rdms, M, M);
 
             // compute Fock
             build_fock();
@@ -465,12 +474,13 @@ std::vector<std::vector<double>> DSRG_MRPT2::compute_energy_xms() {
 
             // compute couplings between states
             print_h2("Compute Couplings with State " + std::to_string(M));
+            build_ms_2nd_coupling(H1, H2, H3);
             for (int N = 0; N < nstates; ++N) {
                 if (N == M) {
                     continue;
                 } else {
                     // compute transition densities
-                    compute_rdms(fci_ints, p_space, civecs, M, N);
+                    compute_rdms(ci_rdms, M, N);
 
                     // compute coupling of <N|H|M>
                     std::stringstream ss;
@@ -487,7 +497,7 @@ std::vector<std::vector<double>> DSRG_MRPT2::compute_energy_xms() {
                     ss.str(std::string());
                     ss.clear();
                     ss << "<" << N << "|HT|" << M << ">";
-                    double c2 = compute_ms_2nd_coupling(ss.str());
+                    double c2 = compute_ms_2nd_coupling(ss.str(), H1, H2, H3);
                     Heff->add(N, M, c2);
                     Heff_sym->add(N, M, 0.5 * c2);
                     Heff_sym->add(M, N, 0.5 * c2);
@@ -565,11 +575,12 @@ psi::SharedMatrix DSRG_MRPT2::xms_rotation(std::shared_ptr<ActiveSpaceIntegrals>
     int nstates = civecs->ncol();
     psi::SharedMatrix Fock(new psi::Matrix("Fock", nstates, nstates));
 
+    CI_RDMS ci_rdms(fci_ints, p_space, civecs, 0, 0);
     for (int M = 0; M < nstates; ++M) {
         for (int N = M; N < nstates; ++N) {
 
             // compute transition density
-            CI_RDMS ci_rdms(fci_ints, p_space, civecs, M, N);
+            ci_rdms.set_roots(M, N);
 
             ambit::Tensor D1a = Gamma1_.block("aa").clone();
             ambit::Tensor D1b = Gamma1_.block("aa").clone();
@@ -653,15 +664,14 @@ double DSRG_MRPT2::compute_ms_1st_coupling(const std::string& name) {
     return coupling;
 }
 
-double DSRG_MRPT2::compute_ms_2nd_coupling(const std::string& name) {
+void DSRG_MRPT2::build_ms_2nd_coupling(BlockedTensor& H1, BlockedTensor& H2,
+                                       BlockedTensor& H3) {
     local_timer timer;
-    std::string str = "Computing coupling of " + name;
+    std::string str = "Computing shared [H, T] intermediates";
     outfile->Printf("\n    %-40s ...", str.c_str());
 
-    double coupling = 0.0;
-
     // H1 contract with D1
-    BlockedTensor H1 = BTF_->build(tensor_type_, "Heff1_2nd", spin_cases({"aa"}));
+    H1.zero();
     H1["vu"] += Hoei_["eu"] * T1eff_["ve"];
     H1["VU"] += Hoei_["EU"] * T1eff_["VE"];
 
@@ -688,11 +698,8 @@ double DSRG_MRPT2::compute_ms_2nd_coupling(const std::string& name) {
     H1["VU"] -= V_["aVmN"] * T2_["mNaU"];
     H1["VU"] -= 0.5 * V_["AVMN"] * T2_["MNAU"];
 
-    coupling += H1["vu"] * Gamma1_["uv"];
-    coupling += H1["VU"] * Gamma1_["UV"];
-
     // H2 contract with D2
-    BlockedTensor H2 = BTF_->build(tensor_type_, "Heff2_2nd", spin_cases({"aaaa"}));
+    H2.zero();
     BlockedTensor temp = BTF_->build(tensor_type_, "temp", {"aaaa", "AAAA"}, true);
     temp["xyuv"] = V_["eyuv"] * T1eff_["xe"];
     temp["XYUV"] = V_["EYUV"] * T1eff_["XE"];
@@ -772,14 +779,27 @@ double DSRG_MRPT2::compute_ms_2nd_coupling(const std::string& name) {
     H2["xYuV"] += V_["AYMV"] * T2_["xMuA"];
     H2["xYuV"] -= V_["xAmV"] * T2_["mYuA"];
 
+    // H3 contract with D3
+    H3.zero();
+    H2_T2_C3(V_, T2_, 1.0, H3, true);
+
+    outfile->Printf("  Done. Timing %15.6f s", timer.get());
+}
+
+double DSRG_MRPT2::compute_ms_2nd_coupling(const std::string& name, BlockedTensor& H1,
+                                           BlockedTensor& H2, BlockedTensor& H3) {
+    local_timer timer;
+    std::string str = "Computing coupling of " + name;
+    outfile->Printf("\n    %-40s ...", str.c_str());
+
+    double coupling = 0.0;
+    coupling += H1["vu"] * Gamma1_["uv"];
+    coupling += H1["VU"] * Gamma1_["UV"];
+
     coupling += 0.25 * H2["xyuv"] * Lambda2_["uvxy"];
     coupling += H2["xYuV"] * Lambda2_["uVxY"];
     coupling += 0.25 * H2["XYUV"] * Lambda2_["UVXY"];
 
-    // H3 contract with D3
-    BlockedTensor H3 = BTF_->build(tensor_type_, "Heff3_2nd", spin_cases({"aaaaaa"}));
-    H2_T2_C3(V_, T2_, 1.0, H3, true);
-
     coupling += 1.0 / 36.0 * H3.block("aaaaaa")("uvwxyz") * rdms_.L3aaa()("xyzuvw");
     coupling += 1.0 / 36.0 * H3.block("AAAAAA")("UVWXYZ") * rdms_.L3bbb()("XYZUVW");
     coupling += 0.25 * H3.block("aaAaaA")("uvWxyZ") * rdms_.L3aab()("xyZuvW");
@@ -845,10 +865,8 @@ void DSRG_MRPT2::compute_Heff_2nd_coupling(double& H0, ambit::Tensor& H1a, ambit
     H3bbb = H3.block("AAAAAA");
 }
 
-void DSRG_MRPT2::compute_cumulants(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
-                                   std::vector<Determinant>& p_space, psi::SharedMatrix evecs,
-                                   const int& root1, const int& root2) {
-    CI_RDMS ci_rdms(fci_ints, p_space, evecs, root1, root2);
+void DSRG_MRPT2::compute_cumulants(CI_RDMS& ci_rdms, const int& root1, const int& root2) {
+    ci_rdms.set_roots(root1, root2);
 
     // 1 cumulant
     ambit::Tensor L1a = Gamma1_.block("aa");
@@ -957,10 +975,8 @@ void DSRG_MRPT2::compute_cumulants(std::shared_ptr<ActiveSpaceIntegrals> fci_int
     }
 }
 
-void DSRG_MRPT2::compute_rdms(std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
-                              std::vector<forte::Determinant>& p_space, psi::SharedMatrix evecs,
-                              const int& root1, const int& root2) {
-    CI_RDMS ci_rdms(fci_ints, p_space, evecs, root1, root2);
+void DSRG_MRPT2::compute_rdms(CI_RDMS& ci_rdms, const int& root1, const int& root2) {
+    ci_rdms.set_roots(root1, root2);
 
     // 1 density
     ambit::Tensor L1a = Gamma1_.block("aa");
@@ -28,6 +28,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <climits>
 #include <cmath>
 #include <numeric>
 #include <tuple>
@@ -35,6 +36,10 @@
 #include <fstream>
 #include <iostream>
 
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
 #include "psi4/libpsi4util/process.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/molecule.h"
@@ -200,6 +205,15 @@ void DSRG_MRPT3::startup() {
     }
     profile_print_ = foptions_->get_bool("PRINT_TIME_PROFILE");
 
+    // virtual batching of the DF contractions
+    int virt_batch_max = foptions_->get_int("DSRG_MRPT3_VIRT_BATCH_MAX");
+    virt_batch_max_ = virt_batch_max > 0 ? static_cast<size_t>(virt_batch_max) : 0;
+    mpi_batches_ = foptions_->get_bool("DSRG_MRPT3_MPI_BATCHES");
+#ifdef HAVE_MPI
+    nproc_ = MPI::COMM_WORLD.Get_size();
+    my_proc_ = MPI::COMM_WORLD.Get_rank();
+#endif
+
     // print calculation summary
     print_options_summary();
 
@@ -2694,11 +2708,16 @@ void DSRG_MRPT3::V_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, const double& a
         // "ab" indices in T2[ij|ab] are all active, no batching
         V_T2_C2_DF_AA(B, T2, alpha, C2);
 
+        // virtual batches below may be distributed over MPI processes
+        batches_begin(C2);
+
         // one of "ab" is virtual, batching that virtual index
         V_T2_C2_DF_AV(B, T2, alpha, C2);
 
         // "ab" indices are all virtual, batchting virtual indices
         V_T2_C2_DF_VV(B, T2, alpha, C2);
+
+        batches_end(C2);
     }
 
     // hole-particle contractions
@@ -3057,11 +3076,16 @@ void DSRG_MRPT3::V_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, const double& a
         }
         jb_lower = keep_unique(jb_lower);
 
+        // virtual batches below may be distributed over MPI processes
+        batches_begin(C2);
+
         // the "a" (contracted) index in T2[ij|ab] is virtual, "i" is core
         V_T2_C2_DF_VC_EX(B, T2, alpha, C2, qs_lower, jb_lower);
 
         // the "a" (contracted) index in T2[ij|ab] is virtual, "i" is active
         V_T2_C2_DF_VA_EX(B, T2, alpha, C2, qs_lower, jb_lower);
+
+        batches_end(C2);
     }
 
     if (print_ > 2) {
@@ -3070,6 +3094,79 @@ void DSRG_MRPT3::V_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, const double& a
     dsrg_time_.add("222", timer.get());
 }
 
+size_t DSRG_MRPT3::virtual_batch_number(size_t nvirt, const std::function<size_t(size_t)>& nele) {
+    if (nvirt == 0) {
+        return 1;
+    }
+
+    // smallest number of batches allowed by the user
+    size_t nbatch = 1;
+    if (virt_batch_max_ != 0) {
+        nbatch = (nvirt + virt_batch_max_ - 1) / virt_batch_max_;
+    }
+
+    // with the memory already exhausted (IGNORE_MEMORY_WARNINGS), only the user limit applies
+    if (mem_total_ <= 0) {
+        return nbatch;
+    }
+
+    size_t mem_batch = static_cast<size_t>(0.95 * mem_total_);
+    for (; nbatch <= nvirt; ++nbatch) {
+        size_t nvirt_batch = (nvirt + nbatch - 1) / nbatch; // size of the largest batch
+        if (nele(nvirt_batch) * sizeof(double) <= mem_batch) {
+            return nbatch;
+        }
+    }
+    return nvirt + 1;
+}
+
+std::vector<std::vector<size_t>> DSRG_MRPT3::split_virtual_batches(size_t nbatch, size_t nvirt) {
+    std::vector<std::vector<size_t>> batches;
+    size_t divisible = nvirt / nbatch;
+    size_t modulo = nvirt % nbatch;
+    for (size_t i = 0, start = 0; i < nbatch; ++i) {
+        size_t end = start + (i < modulo ? divisible + 1 : divisible);
+        std::vector<size_t> batch(end - start);
+        std::iota(batch.begin(), batch.end(), start);
+        batches.push_back(batch);
+        start = end;
+    }
+    return batches;
+}
+
+void DSRG_MRPT3::batches_begin(BlockedTensor& C2) {
+    batch_counter_ = 0;
+
+    // only the master process keeps the current C2, the others collect their batches
+    if (mpi_batches_ and nproc_ > 1 and my_proc_ != 0) {
+        C2.zero();
+    }
+}
+
+bool DSRG_MRPT3::own_next_batch() {
+    size_t batch = batch_counter_++;
+    if (not mpi_batches_ or nproc_ == 1) {
+        return true;
+    }
+    return batch % static_cast<size_t>(nproc_) == static_cast<size_t>(my_proc_);
+}
+
+void DSRG_MRPT3::batches_end(BlockedTensor& C2) {
+    if (not mpi_batches_ or nproc_ == 1) {
+        return;
+    }
+#ifdef HAVE_MPI
+    for (const std::string& block : C2.block_labels()) {
+        std::vector<double>& data = C2.block(block).data();
+        for (size_t start = 0, size = data.size(); start < size; start += INT_MAX) {
+            int count = static_cast<int>(std::min(size - start, static_cast<size_t>(INT_MAX)));
+            MPI_Allreduce(MPI_IN_PLACE, data.data() + start, count, MPI_DOUBLE, MPI_SUM,
+                          MPI_COMM_WORLD);
+        }
+    }
+#endif
+}
+
 void DSRG_MRPT3::V_T2_C2_DF_AA(BlockedTensor& B, BlockedTensor& T2, const double& alpha,
                                BlockedTensor& C2) {
 
@@ -3235,38 +3332,27 @@ void DSRG_MRPT3::V_T2_C2_DF_AV(BlockedTensor& B, BlockedTensor& T2, const double
         size_t sc = label_to_spacemo_['c'].size();
         size_t shole = (sc > sa) ? sc : sa;
         size_t smax = (sh1 > sh0) ? sh1 : sh0;
-        size_t nbatch = 1;
-        size_t svs = sv / nbatch;
-        size_t nele_total = 2 * shole * shole * sa * svs + sh0 * sh1 * sa * svs + sL * svs * smax;
-        size_t nele_batch = 2 * nele_total; // 2 for tensor resorting
-        while (nele_batch * sizeof(double) > static_cast<size_t>(0.95 * mem_total_)) {
-            nbatch += 1;
-            svs = sv / nbatch;
-            nele_batch = 2 * (2 * shole * shole * sa * svs + sh0 * sh1 * sa * svs + sL * svs * sh1);
+        auto nele_av = [&](size_t svs) {
+            // 2 for tensor resorting
+            return 2 * (2 * shole * shole * sa * svs + sh0 * sh1 * sa * svs + sL * svs * smax);
+        };
+        size_t nbatch = virtual_batch_number(sv, nele_av);
+
+        // if nbatch > sv, tensor is too large to be batched
+        if (nbatch > sv) {
+            outfile->Printf("\n    Not enough memory for batching tensor "
+                            "H2(%zu * %zu * %zu * %zu).",
+                            sh0, sh1, sa, sv);
+            throw psi::PSIEXCEPTION("Not enough memory for batching at DSRG-MRPT3 "
+                                    "V_T2_C2_DF_AV.");
         }
 
         // memory usage
+        size_t nele_batch = nele_av((sv + nbatch - 1) / nbatch);
         std::pair<double, std::string> mem_use = to_xb(nele_batch, sizeof(double));
 
         // fill the indices of sub virtuals
-        std::vector<std::vector<size_t>> sub_virt_mos; // relative virtual indices
-        size_t divisible = sv / nbatch;
-        size_t modulo = sv % nbatch;
-        for (size_t i = 0, start = 0; i < nbatch; ++i) {
-            size_t end;
-            if (i < modulo) {
-                end = start + (divisible + 1);
-            } else {
-                end = start + divisible;
-            }
-
-            std::vector<size_t> sub_virt;
-            for (size_t i = start; i < end; ++i) {
-                sub_virt.push_back(i);
-            }
-            sub_virt_mos.push_back(sub_virt);
-            start = end;
-        }
+        std::vector<std::vector<size_t>> sub_virt_mos = split_virtual_batches(nbatch, sv);
 
         // set timer
         start_ = std::chrono::system_clock::now();
@@ -3281,6 +3367,8 @@ void DSRG_MRPT3::V_T2_C2_DF_AV(BlockedTensor& B, BlockedTensor& T2, const double
 
         // loop over partitioned virtual index
         for (const auto& virt_mo_sub : sub_virt_mos) {
+            if (not own_next_batch())
+                continue;
             size_t sv_sub = virt_mo_sub.size();
 
             // contracted indices: av
@@ -3497,53 +3585,21 @@ void DSRG_MRPT3::V_T2_C2_DF_VV(BlockedTensor& B, BlockedTensor& T2, const double
         size_t sc = label_to_spacemo_['c'].size();
         size_t shole = (sc > sa) ? sc : sa;
 
-        std::vector<std::vector<size_t>> sub_virt_mos0, sub_virt_mos1; // relative virtual indices
-        size_t nbatch0 = 1, nbatch1 = 1;
-        size_t total_ele = sv * sv * (sh0 * sh1 + shole * shole) + sL * sv * (sh1 + sh0);
-        size_t nele_batch = 2 * total_ele;
-
-        while (nele_batch * sizeof(double) > static_cast<size_t>(0.95 * mem_total_)) {
-            nbatch0 += 1;
-            nele_batch = 2 * (sv * sv * (sh0 * sh1 + shole * shole) + sL * sv * (sh1 + sh0)) /
-                         nbatch0; // 2 for tensor resorting
-        }
-
-        // if sv > nbatch0, just separate the 1st virtual index
-        // otherwise we will separate the 2nd virtual index, and set nbatch0 = sv
-        if (sv > nbatch0) {
-
-            // 1st virtual index
-            size_t divisible = sv / nbatch0;
-            size_t modulo = sv % nbatch0;
-            for (size_t i = 0, start = 0; i < nbatch0; ++i) {
-                size_t end;
-                if (i < modulo) {
-                    end = start + (divisible + 1);
-                } else {
-                    end = start + divisible;
-                }
-
-                std::vector<size_t> sub0;
-                for (size_t i = start; i < end; ++i) {
-                    sub0.push_back(i);
-                }
-                sub_virt_mos0.push_back(sub0);
-                start = end;
-            }
-
-            // 2nd virtual index
-            std::vector<size_t> sub1;
-            for (size_t i = 0; i < sv; ++i) {
-                sub1.push_back(i);
-            }
-            sub_virt_mos1.push_back(sub1);
-
-        } else {
+        // first try to batch the 1st virtual index only
+        auto nele_vv0 = [&](size_t svs) {
+            // 2 for tensor resorting
+            return 2 * (svs * sv * (sh0 * sh1 + shole * shole) + sL * (svs * sh0 + sv * sh1));
+        };
+        size_t nbatch0 = virtual_batch_number(sv, nele_vv0), nbatch1 = 1;
+        size_t nele_batch = nele_vv0(nbatch0 > sv ? 1 : (sv + nbatch0 - 1) / nbatch0);
 
-            while (nbatch1 * sv < nbatch0) {
-                ++nbatch1;
-            }
+        // otherwise, batch the 2nd virtual index of a single 1st virtual index
+        if (sv > 0 and nbatch0 > sv) {
             nbatch0 = sv;
+            auto nele_vv1 = [&](size_t svs) {
+                return 2 * (svs * (sh0 * sh1 + shole * shole) + sL * (sh0 + svs * sh1));
+            };
+            nbatch1 = virtual_batch_number(sv, nele_vv1);
 
             // if nbatch1 > sv, tensor is too large to be batched
             if (nbatch1 > sv) {
@@ -3553,32 +3609,13 @@ void DSRG_MRPT3::V_T2_C2_DF_VV(BlockedTensor& B, BlockedTensor& T2, const double
                 throw psi::PSIEXCEPTION("Not enough memory for batching at "
                                         "DSRG-MRPT3 V_T2_C2_DF_VV.");
             }
-
-            // 1st virtual index
-            for (size_t i = 0; i < sv; ++i) {
-                sub_virt_mos0.push_back({i});
-            }
-
-            // 2nd virtual index
-            size_t divisible = sv / nbatch1;
-            size_t modulo = sv % nbatch1;
-            for (size_t i = 0, start = 0; i < nbatch1; ++i) {
-                size_t end;
-                if (i < modulo) {
-                    end = start + (divisible + 1);
-                } else {
-                    end = start + divisible;
-                }
-
-                std::vector<size_t> sub1;
-                for (size_t i = start; i < end; ++i) {
-                    sub1.push_back(i);
-                }
-                sub_virt_mos1.push_back(sub1);
-                start = end;
-            }
+            nele_batch = nele_vv1((sv + nbatch1 - 1) / nbatch1);
         }
 
+        // relative virtual indices
+        std::vector<std::vector<size_t>> sub_virt_mos0 = split_virtual_batches(nbatch0, sv);
+        std::vector<std::vector<size_t>> sub_virt_mos1 = split_virtual_batches(nbatch1, sv);
+
         // memory usage
         std::pair<double, std::string> mem_use = to_xb(nele_batch, sizeof(double));
 
@@ -3603,6 +3640,8 @@ void DSRG_MRPT3::V_T2_C2_DF_VV(BlockedTensor& B, BlockedTensor& T2, const double
 
             // loop over the 2nd partitioned virtual index
             for (const auto& virt_mo_sub1 : sub_virt_mos1) {
+                if (not own_next_batch())
+                    continue;
                 size_t sv_sub1 = virt_mo_sub1.size();
 
                 ambit::Tensor H2 =
@@ -3915,17 +3954,12 @@ void DSRG_MRPT3::V_T2_C2_DF_VC_EX(BlockedTensor& B, BlockedTensor& T2, const dou
         size_t ss = label_to_spacemo_[s].size();
 
         // partition the virtual index
-        size_t nbatch = 1;
-        size_t svs = sv / nbatch;
-        size_t nele_total =
-            sL * ss * svs + sq * sc * ss * svs + sq * ss * smax_jb + sc * smax_jb * svs;
-        size_t nele_batch = 2 * nele_total; // 2 for tensor resorting
-        while (nele_batch * sizeof(double) > static_cast<size_t>(0.95 * mem_total_)) {
-            nbatch += 1;
-            svs = sv / nbatch;
-            nele_batch =
-                2 * (sL * ss * svs + sq * sc * ss * svs + sq * ss * smax_jb + sc * smax_jb * svs);
-        }
+        auto nele_ex = [&](size_t svs) {
+            // 2 for tensor resorting
+            return 2 *
+                   (sL * ss * svs + sq * sc * ss * svs + sq * ss * smax_jb + sc * smax_jb * svs);
+        };
+        size_t nbatch = virtual_batch_number(sv, nele_ex);
 
         // if nbatch > sv, tensor is too large to be batched
         if (nbatch > sv) {
@@ -3935,26 +3969,10 @@ void DSRG_MRPT3::V_T2_C2_DF_VC_EX(BlockedTensor& B, BlockedTensor& T2, const dou
             throw psi::PSIEXCEPTION("Not enough memory for batching at DSRG-MRPT3 "
                                     "V_T2_C2_DF_VC_EX.");
         }
+        size_t nele_batch = nele_ex(sv > 0 ? (sv + nbatch - 1) / nbatch : 0);
 
         // fill the indices of sub virtuals
-        std::vector<std::vector<size_t>> sub_virt_mos; // relative virtual indices
-        size_t divisible = sv / nbatch;
-        size_t modulo = sv % nbatch;
-        for (size_t i = 0, start = 0; i < nbatch; ++i) {
-            size_t end;
-            if (i < modulo) {
-                end = start + (divisible + 1);
-            } else {
-                end = start + divisible;
-            }
-
-            std::vector<size_t> sub_virt;
-            for (size_t i = start; i < end; ++i) {
-                sub_virt.push_back(i);
-            }
-            sub_virt_mos.push_back(sub_virt);
-            start = end;
-        }
+        std::vector<std::vector<size_t>> sub_virt_mos = split_virtual_batches(nbatch, sv);
 
         // memory usage
         std::pair<double, std::string> mem_use = to_xb(nele_batch, sizeof(double));
@@ -3976,6 +3994,8 @@ void DSRG_MRPT3::V_T2_C2_DF_VC_EX(BlockedTensor& B, BlockedTensor& T2, const dou
 
         // loop over the partitioned virtual index
         for (const auto& virt_mo_sub : sub_virt_mos) {
+            if (not own_next_batch())
+                continue;
             size_t svs = virt_mo_sub.size();
 
             ambit::Tensor H2 = ambit::Tensor::build(tensor_type_, "H2s", {sq, ss, sc, svs});
@@ -4243,17 +4263,12 @@ void DSRG_MRPT3::V_T2_C2_DF_VA_EX(BlockedTensor& B, BlockedTensor& T2, const dou
         size_t ss = label_to_spacemo_[s].size();
 
         // partition the virtual index
-        size_t nbatch = 1;
-        size_t svs = sv / nbatch;
-        size_t nele_total =
-            sL * (ss * svs + sq * sa) + sq * sa * ss * svs + smax_jb * svs * sa + sq * ss * smax_jb;
-        size_t nele_batch = 2 * nele_total; // 2 for tensor resorting
-        while (nele_batch * sizeof(double) > static_cast<size_t>(0.95 * mem_total_)) {
-            nbatch += 1;
-            svs = sv / nbatch;
-            nele_batch = 2 * (sL * (ss * svs + sq * sa) + sq * sa * ss * svs + smax_jb * svs * sa +
-                              sq * ss * smax_jb);
-        }
+        auto nele_ex = [&](size_t svs) {
+            // 2 for tensor resorting
+            return 2 * (sL * (ss * svs + sq * sa) + sq * sa * ss * svs + smax_jb * svs * sa +
+                        sq * ss * smax_jb);
+        };
+        size_t nbatch = virtual_batch_number(sv, nele_ex);
 
         // if nbatch > sv, tensor is too large to be batched
         if (nbatch > sv) {
@@ -4263,26 +4278,10 @@ void DSRG_MRPT3::V_T2_C2_DF_VA_EX(BlockedTensor& B, BlockedTensor& T2, const dou
             throw psi::PSIEXCEPTION("Not enough memory for batching at DSRG-MRPT3 "
                                     "V_T2_C2_DF_VA_EX.");
         }
+        size_t nele_batch = nele_ex(sv > 0 ? (sv + nbatch - 1) / nbatch : 0);
 
         // fill the indices of sub virtuals
-        std::vector<std::vector<size_t>> sub_virt_mos; // relative virtual indices
-        size_t divisible = sv / nbatch;
-        size_t modulo = sv % nbatch;
-        for (size_t i = 0, start = 0; i < nbatch; ++i) {
-            size_t end;
-            if (i < modulo) {
-                end = start + (divisible + 1);
-            } else {
-                end = start + divisible;
-            }
-
-            std::vector<size_t> sub_virt;
-            for (size_t i = start; i < end; ++i) {
-                sub_virt.push_back(i);
-            }
-            sub_virt_mos.push_back(sub_virt);
-            start = end;
-        }
+        std::vector<std::vector<size_t>> sub_virt_mos = split_virtual_batches(nbatch, sv);
 
         // memory usage
         std::pair<double, std::string> mem_use = to_xb(nele_batch, sizeof(double));
@@ -4312,6 +4311,8 @@ void DSRG_MRPT3::V_T2_C2_DF_VA_EX(BlockedTensor& B, BlockedTensor& T2, const dou
 
             // loop over the partitioned virtual index
             for (const auto& virt_mo_sub : sub_virt_mos) {
+                if (not own_next_batch())
+                    continue;
                 size_t svs = virt_mo_sub.size();
 
                 ambit::Tensor H2 = ambit::Tensor::build(tensor_type_, "H2s", {sq, ss, sa, svs});
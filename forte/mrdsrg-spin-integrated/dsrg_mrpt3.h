@@ -29,6 +29,8 @@
 #ifndef _dsrg_mrpt3_h_
 #define _dsrg_mrpt3_h_
 
+#include <functional>
+
 #include "master_mrdsrg.h"
 
 using namespace ambit;
@@ -99,6 +101,34 @@ class DSRG_MRPT3 : public MASTER_DSRG {
     /// Total memory left
     int64_t mem_total_;
 
+    // => Virtual batching of the DF contractions <= //
+
+    /// Max number of virtual orbitals in one batch (0: determined by memory)
+    size_t virt_batch_max_;
+    /// Distribute the virtual batches over MPI processes
+    bool mpi_batches_;
+    /// Number of MPI processes and the rank of this process
+    int nproc_ = 1;
+    int my_proc_ = 0;
+    /// Counter of the batches visited since batches_begin
+    size_t batch_counter_ = 0;
+
+    /**
+     * Determine the number of batches of the virtual index
+     * @param nvirt The number of virtual orbitals to be partitioned
+     * @param nele The number of elements kept in memory for a given batch size
+     * @return The smallest number of batches that fits in memory, nvirt + 1 if none does
+     */
+    size_t virtual_batch_number(size_t nvirt, const std::function<size_t(size_t)>& nele);
+    /// Partition the relative indices [0, nvirt) into nbatch contiguous batches
+    std::vector<std::vector<size_t>> split_virtual_batches(size_t nbatch, size_t nvirt);
+    /// Start batched contractions to C2 whose batches are distributed over MPI processes
+    void batches_begin(BlockedTensor& C2);
+    /// Return true if the next batch is computed by this process
+    bool own_next_batch();
+    /// Sum C2 over MPI processes after batches_begin
+    void batches_end(BlockedTensor& C2);
+
     /// Fill up two-electron integrals
     void build_tei(BlockedTensor& V);
     /// Build Fock matrix and diagonal Fock matrix elements
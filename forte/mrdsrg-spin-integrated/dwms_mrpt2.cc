@@ -30,6 +30,10 @@
 #include <sstream>
 #include <iomanip>
 
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsi4util/process.h"
 #include "psi4/libmints/molecule.h"
@@ -95,6 +99,11 @@ void DWMS_DSRGPT2::read_options() {
     dwms_iterate_ = foptions_->get_bool("DWMS_ITERATE");
     dwms_maxiter_ = foptions_->get_int("DWMS_MAXITER");
     dwms_e_convergence_ = foptions_->get_double("DWMS_E_CONVERGENCE");
+    distribute_roots_ = foptions_->get_bool("DWMS_DISTRIBUTE_ROOTS");
+#ifdef HAVE_MPI
+    nproc_ = MPI::COMM_WORLD.Get_size();
+    my_proc_ = MPI::COMM_WORLD.Get_rank();
+#endif
 
     do_hbar3_ = foptions_->get_bool("FORM_HBAR3");
     max_hbar_level_ = do_hbar3_ ? 3 : 2;
@@ -116,6 +125,10 @@ void DWMS_DSRGPT2::print_options() {
         outfile->Printf("\n    DO DELTA AMPS      %10s", damps.c_str());
     }
 
+    if (distribute_roots_ and nproc_ > 1) {
+        outfile->Printf("\n    MPI PROCESSES      %10d", nproc_);
+    }
+
     if (dwms_iterate_) {
         outfile->Printf("\n    MAX ITERATION      %10d", dwms_maxiter_);
         outfile->Printf("\n    E_CONVERGENCE      %10.2e", dwms_e_convergence_);
@@ -343,8 +356,8 @@ std::shared_ptr<FCI_MO> DWMS_DSRGPT2::precompute_energy() {
                     auto filenames = fci_mo->density_filenames_generator(1, irrep, multi, A, A);
                     bool files_exist = fci_mo->check_density_files_fcimo(1, irrep, multi, A, A);
                     if (files_exist) {
-                        read_disk_vector_double(filenames[0], D1.block("aa").data());
-                        read_disk_vector_double(filenames[1], D1.block("AA").data());
+                        fci_mo->load_density(filenames[0], D1.block("aa").data());
+                        fci_mo->load_density(filenames[1], D1.block("AA").data());
                     }
                     value += oei["uv"] * D1["uv"];
                     value += oei["UV"] * D1["UV"];
@@ -352,9 +365,9 @@ std::shared_ptr<FCI_MO> DWMS_DSRGPT2::precompute_energy() {
                     filenames = fci_mo->density_filenames_generator(2, irrep, multi, A, A);
                     files_exist = fci_mo->check_density_files_fcimo(2, irrep, multi, A, A);
                     if (files_exist) {
-                        read_disk_vector_double(filenames[0], D2.block("aaaa").data());
-                        read_disk_vector_double(filenames[1], D2.block("aAaA").data());
-                        read_disk_vector_double(filenames[2], D2.block("AAAA").data());
+                        fci_mo->load_density(filenames[0], D2.block("aaaa").data());
+                        fci_mo->load_density(filenames[1], D2.block("aAaA").data());
+                        fci_mo->load_density(filenames[2], D2.block("AAAA").data());
                     }
                     value += 0.25 * tei["uvxy"] * D2["xyuv"];
                     value += 0.25 * tei["UVXY"] * D2["XYUV"];
@@ -545,6 +558,9 @@ void DWMS_DSRGPT2::compute_dwsa_energy(std::shared_ptr<FCI_MO>& fci_mo) {
         fci_ints = compute_macro_dsrg_pt(dsrg_pt, fci_mo, 0, 0);
     }
 
+    // global index of the first state of an entry, used to distribute the states
+    int root_offset = 0;
+
     // loop over symmetry entries
     for (int n = 0; n < nentry; ++n) {
         int multi, irrep, nroots;
@@ -564,6 +580,8 @@ void DWMS_DSRGPT2::compute_dwsa_energy(std::shared_ptr<FCI_MO>& fci_mo) {
 
         // loop over states of current symmetry
         for (int M = 0; M < nroots; ++M) {
+            if (not own_root(root_offset + M))
+                continue;
 
             // transform bare Hamiltonian for each root
             if (zeta_ != 0.0) {
@@ -622,6 +640,10 @@ void DWMS_DSRGPT2::compute_dwsa_energy(std::shared_ptr<FCI_MO>& fci_mo) {
             }
         }
 
+        // collect the columns of Heff computed by other processes
+        reduce_Heff(Heff);
+        root_offset += nroots;
+
         // print effective Hamiltonian
         print_h2("Effective Hamiltonian Summary");
         outfile->Printf("\n");
@@ -733,6 +755,9 @@ void DWMS_DSRGPT2::compute_dwms_energy(std::shared_ptr<FCI_MO>& fci_mo) {
         fci_ints = compute_macro_dsrg_pt(dsrg_pt2, fci_mo, 0, 0);
     }
 
+    // global index of the first state of an entry, used to distribute the states
+    int root_offset = 0;
+
     // loop over symmetry entries
     for (int n = 0; n < nentry; ++n) {
         int multi, irrep, nroots;
@@ -751,6 +776,8 @@ void DWMS_DSRGPT2::compute_dwms_energy(std::shared_ptr<FCI_MO>& fci_mo) {
 
         // loop over states of current symmetry
         for (int M = 0; M < nroots; ++M) {
+            if (not own_root(root_offset + M))
+                continue;
 
             // transform bare Hamiltonian for each root
             if (zeta_ != 0.0) {
@@ -834,6 +861,11 @@ void DWMS_DSRGPT2::compute_dwms_energy(std::shared_ptr<FCI_MO>& fci_mo) {
             }
         }
 
+        // collect the columns of Heff computed by other processes
+        reduce_Heff(Heff);
+        reduce_Heff(Heff_sym);
+        root_offset += nroots;
+
         // print effective Hamiltonian
         print_h2("Effective Hamiltonian Summary");
         outfile->Printf("\n");
@@ -1141,6 +1173,28 @@ std::vector<std::tuple<int, int, int, std::vector<double>>> DWMS_DSRGPT2::comput
     return out;
 }
 
+bool DWMS_DSRGPT2::roots_distributed() {
+    // states share the Hbar when zeta is zero, and delta amplitudes need all states
+    return distribute_roots_ and nproc_ > 1 and zeta_ != 0.0 and (not do_delta_amp_);
+}
+
+bool DWMS_DSRGPT2::own_root(int root) {
+    if (not roots_distributed()) {
+        return true;
+    }
+    return root % nproc_ == my_proc_;
+}
+
+void DWMS_DSRGPT2::reduce_Heff(psi::SharedMatrix Heff) {
+    if (not roots_distributed()) {
+        return;
+    }
+#ifdef HAVE_MPI
+    int n = Heff->rowdim() * Heff->coldim();
+    MPI_Allreduce(MPI_IN_PLACE, Heff->pointer()[0], n, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+#endif
+}
+
 void DWMS_DSRGPT2::transform_ints0() {
     print_h2("Transformation Integrals Back to Original");
     ints_->update_orbitals(Ca_copy_, Cb_copy_);
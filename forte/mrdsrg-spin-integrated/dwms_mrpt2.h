@@ -100,6 +100,18 @@ class DWMS_DSRGPT2 {
     /// DWMS energy convergence
     double dwms_e_convergence_;
 
+    /// Distribute the reference states over MPI processes
+    bool distribute_roots_;
+    /// Number of MPI processes and the rank of this process
+    int nproc_ = 1;
+    int my_proc_ = 0;
+    /// Return true if the states are distributed in the current algorithm
+    bool roots_distributed();
+    /// Return true if the state with the given global index is computed by this process
+    bool own_root(int root);
+    /// Sum the elements of Heff computed by all MPI processes
+    void reduce_Heff(psi::SharedMatrix Heff);
+
     /// form Hbar3 for DSRG-MRPT2
     bool do_hbar3_;
     /// max body of Hbar computed
@@ -138,7 +138,10 @@ void MASTER_DSRG::read_options() {
 
     relax_ref_ = foptions_->get_str("RELAX_REF");
 
-    multi_state_ = foptions_->get_gen_list("AVG_STATE").size() != 0;
+    {
+        py::gil_scoped_acquire gil;
+        multi_state_ = foptions_->get_gen_list("AVG_STATE").size() != 0;
+    }
     multi_state_algorithm_ = foptions_->get_str("DSRG_MULTI_STATE");
 
     do_dm_ = foptions_->get_bool("DSRG_DIPOLE");
@@ -1277,6 +1280,41 @@ void MASTER_DSRG::H2_T1_C1(BlockedTensor& H2, BlockedTensor& T1, const double& a
 //    dsrg_time_.add("211", timer.get());
 //}
 
+void MASTER_DSRG::begin_T2_intermediates(BlockedTensor& T2) {
+    T2_intermediates_.clear();
+    auto labels = T2.block_labels();
+    T2_cached_ = labels.empty() ? nullptr : T2.block(labels[0]).data().data();
+}
+
+void MASTER_DSRG::end_T2_intermediates() {
+    T2_intermediates_.clear();
+    T2_cached_ = nullptr;
+}
+
+BlockedTensor MASTER_DSRG::T2_intermediate(BlockedTensor& T2, const std::string& name,
+                                           const std::vector<std::string>& blocks,
+                                           const std::function<void(BlockedTensor&)>& build) {
+    bool cached = false;
+    if (T2_cached_ != nullptr) {
+        auto labels = T2.block_labels();
+        cached = (not labels.empty()) and T2.block(labels[0]).data().data() == T2_cached_;
+    }
+
+    if (cached) {
+        auto it = T2_intermediates_.find(name);
+        if (it != T2_intermediates_.end()) {
+            return it->second;
+        }
+    }
+
+    BlockedTensor X = ambit::BlockedTensor::build(tensor_type_, name, blocks);
+    build(X);
+    if (cached) {
+        T2_intermediates_[name] = X;
+    }
+    return X;
+}
+
 void MASTER_DSRG::H2_T2_C1(BlockedTensor& H2, BlockedTensor& T2, const double& alpha,
                            BlockedTensor& C1) {
     local_timer timer;
@@ -1297,8 +1335,9 @@ void MASTER_DSRG::H2_T2_C1(BlockedTensor& H2, BlockedTensor& T2, const double& a
 
     C1["ir"] += 0.5 * alpha * T2["ijux"] * Gamma1_["xy"] * Gamma1_["uv"] * H2["vyrj"];
     C1["IR"] += 0.5 * alpha * T2["IJUX"] * Gamma1_["XY"] * Gamma1_["UV"] * H2["VYRJ"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"hHaA"});
-    temp["iJvY"] = T2["iJuX"] * Gamma1_["XY"] * Gamma1_["uv"];
+    temp = T2_intermediate(T2, "T2 G1 G1 hHaA", {"hHaA"}, [&](BlockedTensor& X) {
+        X["iJvY"] = T2["iJuX"] * Gamma1_["XY"] * Gamma1_["uv"];
+    });
     C1["ir"] += alpha * temp["iJvY"] * H2["vYrJ"];
     C1["IR"] += alpha * temp["jIvY"] * H2["vYjR"];
 
@@ -1329,8 +1368,9 @@ void MASTER_DSRG::H2_T2_C1(BlockedTensor& H2, BlockedTensor& T2, const double& a
 
     C1["pa"] -= 0.5 * alpha * T2["vyab"] * Eta1_["uv"] * Eta1_["xy"] * H2["pbux"];
     C1["PA"] -= 0.5 * alpha * T2["VYAB"] * Eta1_["UV"] * Eta1_["XY"] * H2["PBUX"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"aApP"});
-    temp["uXaB"] = T2["vYaB"] * Eta1_["uv"] * Eta1_["XY"];
+    temp = T2_intermediate(T2, "T2 E1 E1 aApP", {"aApP"}, [&](BlockedTensor& X) {
+        X["uXaB"] = T2["vYaB"] * Eta1_["uv"] * Eta1_["XY"];
+    });
     C1["pa"] -= alpha * H2["pBuX"] * temp["uXaB"];
     C1["PA"] -= alpha * H2["bPuX"] * temp["uXbA"];
 
@@ -1351,15 +1391,15 @@ void MASTER_DSRG::H2_T2_C1(BlockedTensor& H2, BlockedTensor& T2, const double& a
     // [Hbar2, T2] C_4 C_2 2:2 -> C1
     C1["ir"] += 0.25 * alpha * T2["ijxy"] * Lambda2_["xyuv"] * H2["uvrj"];
     C1["IR"] += 0.25 * alpha * T2["IJXY"] * Lambda2_["XYUV"] * H2["UVRJ"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"hHaA"});
-    temp["iJuV"] = T2["iJxY"] * Lambda2_["xYuV"];
+    temp = T2_intermediate(T2, "T2 L2 hHaA", {"hHaA"},
+                           [&](BlockedTensor& X) { X["iJuV"] = T2["iJxY"] * Lambda2_["xYuV"]; });
     C1["ir"] += alpha * H2["uVrJ"] * temp["iJuV"];
     C1["IR"] += alpha * H2["uVjR"] * temp["jIuV"];
 
     C1["pa"] -= 0.25 * alpha * Lambda2_["xyuv"] * T2["uvab"] * H2["pbxy"];
     C1["PA"] -= 0.25 * alpha * Lambda2_["XYUV"] * T2["UVAB"] * H2["PBXY"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"aApP"});
-    temp["xYaB"] = T2["uVaB"] * Lambda2_["xYuV"];
+    temp = T2_intermediate(T2, "T2 L2 aApP", {"aApP"},
+                           [&](BlockedTensor& X) { X["xYaB"] = T2["uVaB"] * Lambda2_["xYuV"]; });
     C1["pa"] -= alpha * H2["pBxY"] * temp["xYaB"];
     C1["PA"] -= alpha * H2["bPxY"] * temp["xYbA"];
 
@@ -1368,24 +1408,28 @@ void MASTER_DSRG::H2_T2_C1(BlockedTensor& H2, BlockedTensor& T2, const double& a
     C1["pa"] += alpha * Lambda2_["xYvU"] * T2["vIaY"] * H2["pUxI"];
     C1["PA"] += alpha * Lambda2_["yXuV"] * T2["iVyA"] * H2["uPiX"];
 
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"hapa"});
-    temp["ixau"] += Lambda2_["xyuv"] * T2["ivay"];
-    temp["ixau"] += Lambda2_["xYuV"] * T2["iVaY"];
+    temp = T2_intermediate(T2, "T2 L2 hapa", {"hapa"}, [&](BlockedTensor& X) {
+        X["ixau"] += Lambda2_["xyuv"] * T2["ivay"];
+        X["ixau"] += Lambda2_["xYuV"] * T2["iVaY"];
+    });
     C1["ir"] += alpha * temp["ixau"] * H2["aurx"];
     C1["pa"] -= alpha * H2["puix"] * temp["ixau"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"hApA"});
-    temp["iXaU"] += Lambda2_["XYUV"] * T2["iVaY"];
-    temp["iXaU"] += Lambda2_["yXvU"] * T2["ivay"];
+    temp = T2_intermediate(T2, "T2 L2 hApA", {"hApA"}, [&](BlockedTensor& X) {
+        X["iXaU"] += Lambda2_["XYUV"] * T2["iVaY"];
+        X["iXaU"] += Lambda2_["yXvU"] * T2["ivay"];
+    });
     C1["ir"] += alpha * temp["iXaU"] * H2["aUrX"];
     C1["pa"] -= alpha * H2["pUiX"] * temp["iXaU"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"aHaP"});
-    temp["xIuA"] += Lambda2_["xyuv"] * T2["vIyA"];
-    temp["xIuA"] += Lambda2_["xYuV"] * T2["VIYA"];
+    temp = T2_intermediate(T2, "T2 L2 aHaP", {"aHaP"}, [&](BlockedTensor& X) {
+        X["xIuA"] += Lambda2_["xyuv"] * T2["vIyA"];
+        X["xIuA"] += Lambda2_["xYuV"] * T2["VIYA"];
+    });
     C1["IR"] += alpha * temp["xIuA"] * H2["uAxR"];
     C1["PA"] -= alpha * H2["uPxI"] * temp["xIuA"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"HAPA"});
-    temp["IXAU"] += Lambda2_["XYUV"] * T2["IVAY"];
-    temp["IXAU"] += Lambda2_["yXvU"] * T2["vIyA"];
+    temp = T2_intermediate(T2, "T2 L2 HAPA", {"HAPA"}, [&](BlockedTensor& X) {
+        X["IXAU"] += Lambda2_["XYUV"] * T2["IVAY"];
+        X["IXAU"] += Lambda2_["yXvU"] * T2["vIyA"];
+    });
     C1["IR"] += alpha * temp["IXAU"] * H2["AURX"];
     C1["PA"] -= alpha * H2["PUIX"] * temp["IXAU"];
 
@@ -1412,25 +1456,29 @@ void MASTER_DSRG::H2_T2_C1(BlockedTensor& H2, BlockedTensor& T2, const double& a
     C1["jb"] -= alpha * temp["XI"] * T2["jIbX"];
     C1["JB"] -= alpha * temp["XI"] * T2["IJXB"];
 
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"av"});
-    temp["xe"] += 0.5 * T2["uvey"] * Lambda2_["xyuv"];
-    temp["xe"] += T2["uVeY"] * Lambda2_["xYuV"];
+    temp = T2_intermediate(T2, "T2 L2 av", {"av"}, [&](BlockedTensor& X) {
+        X["xe"] += 0.5 * T2["uvey"] * Lambda2_["xyuv"];
+        X["xe"] += T2["uVeY"] * Lambda2_["xYuV"];
+    });
     C1["qs"] += alpha * temp["xe"] * H2["eqxs"];
     C1["QS"] += alpha * temp["xe"] * H2["eQxS"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"AV"});
-    temp["XE"] += 0.5 * T2["UVEY"] * Lambda2_["XYUV"];
-    temp["XE"] += T2["uVyE"] * Lambda2_["yXuV"];
+    temp = T2_intermediate(T2, "T2 L2 AV", {"AV"}, [&](BlockedTensor& X) {
+        X["XE"] += 0.5 * T2["UVEY"] * Lambda2_["XYUV"];
+        X["XE"] += T2["uVyE"] * Lambda2_["yXuV"];
+    });
     C1["qs"] += alpha * temp["XE"] * H2["qEsX"];
     C1["QS"] += alpha * temp["XE"] * H2["EQXS"];
 
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"ca"});
-    temp["mu"] += 0.5 * T2["mvxy"] * Lambda2_["xyuv"];
-    temp["mu"] += T2["mVxY"] * Lambda2_["xYuV"];
+    temp = T2_intermediate(T2, "T2 L2 ca", {"ca"}, [&](BlockedTensor& X) {
+        X["mu"] += 0.5 * T2["mvxy"] * Lambda2_["xyuv"];
+        X["mu"] += T2["mVxY"] * Lambda2_["xYuV"];
+    });
     C1["qs"] -= alpha * temp["mu"] * H2["uqms"];
     C1["QS"] -= alpha * temp["mu"] * H2["uQmS"];
-    temp = ambit::BlockedTensor::build(tensor_type_, "temp", {"CA"});
-    temp["MU"] += 0.5 * T2["MVXY"] * Lambda2_["XYUV"];
-    temp["MU"] += T2["vMxY"] * Lambda2_["xYvU"];
+    temp = T2_intermediate(T2, "T2 L2 CA", {"CA"}, [&](BlockedTensor& X) {
+        X["MU"] += 0.5 * T2["MVXY"] * Lambda2_["XYUV"];
+        X["MU"] += T2["vMxY"] * Lambda2_["xYvU"];
+    });
     C1["qs"] -= alpha * temp["MU"] * H2["qUsM"];
     C1["QS"] -= alpha * temp["MU"] * H2["UQMS"];
 
@@ -1496,25 +1544,48 @@ void MASTER_DSRG::H2_T2_C2(BlockedTensor& H2, BlockedTensor& T2, const double& a
 
     /// max intermediate: g * g * p * p
 
+    // T2 dressed by one-body densities, reused across commutators of the same T2
+    BlockedTensor G1p = T2_intermediate(
+        T2, "T2 G1 hhap", {"hhap", "hHaP", "hHpA", "HHAP"}, [&](BlockedTensor& X) {
+            X["ijyb"] = Gamma1_["xy"] * T2["ijxb"];
+            X["iJyB"] = Gamma1_["xy"] * T2["iJxB"];
+            X["iJbY"] = Gamma1_["XY"] * T2["iJbX"];
+            X["IJYB"] = Gamma1_["XY"] * T2["IJXB"];
+        });
+    BlockedTensor G1h = T2_intermediate(
+        T2, "T2 G1 ahpp", {"ahpp", "aHpP", "hApP", "AHPP"}, [&](BlockedTensor& X) {
+            X["xjab"] = Gamma1_["xy"] * T2["yjab"];
+            X["xJaB"] = Gamma1_["xy"] * T2["yJaB"];
+            X["jXaB"] = Gamma1_["XY"] * T2["jYaB"];
+            X["XJAB"] = Gamma1_["XY"] * T2["YJAB"];
+        });
+    BlockedTensor E1h = T2_intermediate(
+        T2, "T2 E1 ahpp", {"ahpp", "aHpP", "hApP", "AHPP"}, [&](BlockedTensor& X) {
+            X["xjab"] = Eta1_["xy"] * T2["yjab"];
+            X["xJaB"] = Eta1_["xy"] * T2["yJaB"];
+            X["jXaB"] = Eta1_["XY"] * T2["jYaB"];
+            X["XJAB"] = Eta1_["XY"] * T2["YJAB"];
+        });
+
     // particle-particle contractions
     C2["ijrs"] += 0.5 * alpha * H2["abrs"] * T2["ijab"];
     C2["iJrS"] += alpha * H2["aBrS"] * T2["iJaB"];
     C2["IJRS"] += 0.5 * alpha * H2["ABRS"] * T2["IJAB"];
 
-    C2["ijrs"] -= alpha * Gamma1_["xy"] * T2["ijxb"] * H2["ybrs"];
-    C2["iJrS"] -= alpha * Gamma1_["xy"] * T2["iJxB"] * H2["yBrS"];
-    C2["iJrS"] -= alpha * Gamma1_["XY"] * T2["iJbX"] * H2["bYrS"];
-    C2["IJRS"] -= alpha * Gamma1_["XY"] * T2["IJXB"] * H2["YBRS"];
+    C2["ijrs"] -= alpha * G1p["ijyb"] * H2["ybrs"];
+    C2["iJrS"] -= alpha * G1p["iJyB"] * H2["yBrS"];
+    C2["iJrS"] -= alpha * G1p["iJbY"] * H2["bYrS"];
+    C2["IJRS"] -= alpha * G1p["IJYB"] * H2["YBRS"];
 
     // hole-hole contractions
     C2["pqab"] += 0.5 * alpha * H2["pqij"] * T2["ijab"];
     C2["pQaB"] += alpha * H2["pQiJ"] * T2["iJaB"];
     C2["PQAB"] += 0.5 * alpha * H2["PQIJ"] * T2["IJAB"];
 
-    C2["pqab"] -= alpha * Eta1_["xy"] * T2["yjab"] * H2["pqxj"];
-    C2["pQaB"] -= alpha * Eta1_["xy"] * T2["yJaB"] * H2["pQxJ"];
-    C2["pQaB"] -= alpha * Eta1_["XY"] * T2["jYaB"] * H2["pQjX"];
-    C2["PQAB"] -= alpha * Eta1_["XY"] * T2["YJAB"] * H2["PQXJ"];
+    C2["pqab"] -= alpha * E1h["xjab"] * H2["pqxj"];
+    C2["pQaB"] -= alpha * E1h["xJaB"] * H2["pQxJ"];
+    C2["pQaB"] -= alpha * E1h["jXaB"] * H2["pQjX"];
+    C2["PQAB"] -= alpha * E1h["XJAB"] * H2["PQXJ"];
 
     // hole-particle contractions
     // figure out useful blocks of temp (assume symmetric C2 blocks, if cavv exists => acvv exists)
@@ -1539,10 +1610,10 @@ void MASTER_DSRG::H2_T2_C2(BlockedTensor& H2, BlockedTensor& T2, const double& a
         temp = ambit::BlockedTensor::build(tensor_type_, "temp", blocks);
         temp["qjsb"] += alpha * H2["aqms"] * T2["mjab"];
         temp["qjsb"] += alpha * H2["qAsM"] * T2["jMbA"];
-        temp["qjsb"] += alpha * Gamma1_["xy"] * T2["yjab"] * H2["aqxs"];
-        temp["qjsb"] += alpha * Gamma1_["XY"] * T2["jYbA"] * H2["qAsX"];
-        temp["qjsb"] -= alpha * Gamma1_["xy"] * T2["ijxb"] * H2["yqis"];
-        temp["qjsb"] -= alpha * Gamma1_["XY"] * T2["jIbX"] * H2["qYsI"];
+        temp["qjsb"] += alpha * G1h["xjab"] * H2["aqxs"];
+        temp["qjsb"] += alpha * G1h["jXbA"] * H2["qAsX"];
+        temp["qjsb"] -= alpha * G1p["ijyb"] * H2["yqis"];
+        temp["qjsb"] -= alpha * G1p["jIbY"] * H2["qYsI"];
         C2["qjsb"] += temp["qjsb"];
         C2["jqsb"] -= temp["qjsb"];
         C2["qjbs"] -= temp["qjsb"];
@@ -1568,10 +1639,10 @@ void MASTER_DSRG::H2_T2_C2(BlockedTensor& H2, BlockedTensor& T2, const double& a
         temp = ambit::BlockedTensor::build(tensor_type_, "temp", blocks);
         temp["QJSB"] += alpha * H2["AQMS"] * T2["MJAB"];
         temp["QJSB"] += alpha * H2["aQmS"] * T2["mJaB"];
-        temp["QJSB"] += alpha * Gamma1_["XY"] * T2["YJAB"] * H2["AQXS"];
-        temp["QJSB"] += alpha * Gamma1_["xy"] * T2["yJaB"] * H2["aQxS"];
-        temp["QJSB"] -= alpha * Gamma1_["XY"] * T2["IJXB"] * H2["YQIS"];
-        temp["QJSB"] -= alpha * Gamma1_["xy"] * T2["iJxB"] * H2["yQiS"];
+        temp["QJSB"] += alpha * G1h["XJAB"] * H2["AQXS"];
+        temp["QJSB"] += alpha * G1h["xJaB"] * H2["aQxS"];
+        temp["QJSB"] -= alpha * G1p["IJYB"] * H2["YQIS"];
+        temp["QJSB"] -= alpha * G1p["iJyB"] * H2["yQiS"];
         C2["QJSB"] += temp["QJSB"];
         C2["JQSB"] -= temp["QJSB"];
         C2["QJBS"] -= temp["QJSB"];
@@ -1580,25 +1651,25 @@ void MASTER_DSRG::H2_T2_C2(BlockedTensor& H2, BlockedTensor& T2, const double& a
 
     C2["qJsB"] += alpha * H2["aqms"] * T2["mJaB"];
     C2["qJsB"] += alpha * H2["qAsM"] * T2["MJAB"];
-    C2["qJsB"] += alpha * Gamma1_["xy"] * T2["yJaB"] * H2["aqxs"];
-    C2["qJsB"] += alpha * Gamma1_["XY"] * T2["YJAB"] * H2["qAsX"];
-    C2["qJsB"] -= alpha * Gamma1_["xy"] * T2["iJxB"] * H2["yqis"];
-    C2["qJsB"] -= alpha * Gamma1_["XY"] * T2["IJXB"] * H2["qYsI"];
+    C2["qJsB"] += alpha * G1h["xJaB"] * H2["aqxs"];
+    C2["qJsB"] += alpha * G1h["XJAB"] * H2["qAsX"];
+    C2["qJsB"] -= alpha * G1p["iJyB"] * H2["yqis"];
+    C2["qJsB"] -= alpha * G1p["IJYB"] * H2["qYsI"];
 
     C2["iQsB"] -= alpha * T2["iMaB"] * H2["aQsM"];
-    C2["iQsB"] -= alpha * Gamma1_["XY"] * T2["iYaB"] * H2["aQsX"];
-    C2["iQsB"] += alpha * Gamma1_["xy"] * T2["iJxB"] * H2["yQsJ"];
+    C2["iQsB"] -= alpha * G1h["iXaB"] * H2["aQsX"];
+    C2["iQsB"] += alpha * G1p["iJyB"] * H2["yQsJ"];
 
     C2["qJaS"] -= alpha * T2["mJaB"] * H2["qBmS"];
-    C2["qJaS"] -= alpha * Gamma1_["xy"] * T2["yJaB"] * H2["qBxS"];
-    C2["qJaS"] += alpha * Gamma1_["XY"] * T2["iJaX"] * H2["qYiS"];
+    C2["qJaS"] -= alpha * G1h["xJaB"] * H2["qBxS"];
+    C2["qJaS"] += alpha * G1p["iJaY"] * H2["qYiS"];
 
     C2["iQaS"] += alpha * T2["imab"] * H2["bQmS"];
     C2["iQaS"] += alpha * T2["iMaB"] * H2["BQMS"];
-    C2["iQaS"] += alpha * Gamma1_["xy"] * T2["iyab"] * H2["bQxS"];
-    C2["iQaS"] += alpha * Gamma1_["XY"] * T2["iYaB"] * H2["BQXS"];
-    C2["iQaS"] -= alpha * Gamma1_["xy"] * T2["ijax"] * H2["yQjS"];
-    C2["iQaS"] -= alpha * Gamma1_["XY"] * T2["iJaX"] * H2["YQJS"];
+    C2["iQaS"] -= alpha * G1h["xiab"] * H2["bQxS"];
+    C2["iQaS"] += alpha * G1h["iXaB"] * H2["BQXS"];
+    C2["iQaS"] += alpha * G1p["ijya"] * H2["yQjS"];
+    C2["iQaS"] -= alpha * G1p["iJaY"] * H2["YQJS"];
 
     if (print_ > 2) {
         outfile->Printf("\n    Time for [H2, T2] -> C2 : %12.3f", timer.get());
@@ -1,6 +1,9 @@
 #ifndef _master_mrdsrg_h_
 #define _master_mrdsrg_h_
 
+#include <functional>
+#include <map>
+
 #include "ambit/blocked_tensor.h"
 
 #include "base_classes/dynamic_correlation_solver.h"
@@ -427,6 +430,34 @@ class MASTER_DSRG : public DynamicCorrelationSolver {
     void H2_T2_C3(BlockedTensor& H2, BlockedTensor& T2, const double& alpha, BlockedTensor& C3,
                   const bool& active_only = true);
 
+    // => Intermediates of T2 and the reference densities <= //
+
+    /**
+     * Start caching the intermediates of T2 and the densities used by H2_T2_C1 and H2_T2_C2
+     * @param T2 the amplitudes, which must not change until end_T2_intermediates
+     *
+     * Nested commutators of the same T2 (e.g., the BCH series of LDSRG(2)) then build
+     * products such as Gamma1 * T2 or Lambda2 * T2 only once.
+     */
+    void begin_T2_intermediates(BlockedTensor& T2);
+    /// Stop caching and release the intermediates of T2
+    void end_T2_intermediates();
+    /**
+     * Return an intermediate of T2 and the densities
+     * @param T2 the amplitudes
+     * @param name the unique name of the intermediate
+     * @param blocks the block labels of the intermediate
+     * @param build the function that fills the zeroed intermediate
+     * @return the cached intermediate if T2 is cached, a newly built one otherwise
+     */
+    BlockedTensor T2_intermediate(BlockedTensor& T2, const std::string& name,
+                                  const std::vector<std::string>& blocks,
+                                  const std::function<void(BlockedTensor&)>& build);
+    /// The T2 whose intermediates are cached (identified by its first block)
+    const double* T2_cached_ = nullptr;
+    /// The cached intermediates of T2
+    std::map<std::string, BlockedTensor> T2_intermediates_;
+
     /// Compute one- and two-body off-diagonal term of commutator [[H1, A2]2d, T1+2]od
     void H1_A2_T_Cod(BlockedTensor& H1, BlockedTensor& A2, BlockedTensor& T1, BlockedTensor& T2,
                      const double& alpha, BlockedTensor& C1, BlockedTensor& C2);
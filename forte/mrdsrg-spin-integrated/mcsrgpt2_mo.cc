@@ -26,6 +26,7 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <algorithm>
 #include <ctype.h>
 #include <fstream>
@@ -326,10 +327,25 @@ void MCSRGPT2_MO::Form_Fock_DSRG(d2& A, d2& B, const bool& dsrgpt) {
     timer_off("Fock_DSRG");
 }
 
+void MCSRGPT2_MO::fetch_hhpp_integrals() {
+    timer_on("APTEI_HHPP");
+    V_hhpp_aa_ = integral_->aptei_aa_block(hole_mos_, hole_mos_, part_mos_, part_mos_);
+    V_hhpp_ab_ = integral_->aptei_ab_block(hole_mos_, hole_mos_, part_mos_, part_mos_);
+    V_hhpp_bb_ = integral_->aptei_bb_block(hole_mos_, hole_mos_, part_mos_, part_mos_);
+    timer_off("APTEI_HHPP");
+}
+
 void MCSRGPT2_MO::Form_APTEI_DSRG(const bool& dsrgpt) {
     timer_on("APTEI_DSRG");
 
     if (dsrgpt) {
+        auto& vaa = V_hhpp_aa_.data();
+        auto& vab = V_hhpp_ab_.data();
+        auto& vbb = V_hhpp_bb_.data();
+
+        // The elements are updated in this order, and each value is also copied to <ab||ij>.
+        // When all the indices are active, <ab||ij> is an element of the hhpp block that is
+        // renormalized again later in the loop, so this loop must stay sequential.
         for (size_t i = 0; i < nhole_; ++i) {
             size_t ni = hole_mos_[i];
             for (size_t j = 0; j < nhole_; ++j) {
@@ -342,22 +358,25 @@ void MCSRGPT2_MO::Form_APTEI_DSRG(const bool& dsrgpt) {
                         double Dab = Fa_[ni][ni] + Fb_[nj][nj] - Fa_[na][na] - Fb_[nb][nb];
                         double Dbb = Fb_[ni][ni] + Fb_[nj][nj] - Fb_[na][na] - Fb_[nb][nb];
 
-                        double Vaa = integral_->aptei_aa(ni, nj, na, nb);
-                        double Vab = integral_->aptei_ab(ni, nj, na, nb);
-                        double Vbb = integral_->aptei_bb(ni, nj, na, nb);
+                        size_t ijab = hhpp(i, j, a, b);
+                        double Vaa = vaa[ijab];
+                        double Vab = vab[ijab];
+                        double Vbb = vbb[ijab];
 
                         Vaa += ElementRH(source_, Daa, Vaa);
                         Vab += ElementRH(source_, Dab, Vab);
                         Vbb += ElementRH(source_, Dbb, Vbb);
 
-                        integral_->set_tei(ni, nj, na, nb, Vaa, true, true);
-                        integral_->set_tei(na, nb, ni, nj, Vaa, true, true);
-
-                        integral_->set_tei(ni, nj, na, nb, Vab, true, false);
-                        integral_->set_tei(na, nb, ni, nj, Vab, true, false);
+                        vaa[ijab] = Vaa;
+                        vab[ijab] = Vab;
+                        vbb[ijab] = Vbb;
 
-                        integral_->set_tei(ni, nj, na, nb, Vbb, false, false);
-                        integral_->set_tei(na, nb, ni, nj, Vbb, false, false);
+                        if (i < nactv_ and j < nactv_ and a < nactv_ and b < nactv_) {
+                            size_t abij = hhpp(a, b, i, j);
+                            vaa[abij] = Vaa;
+                            vab[abij] = Vab;
+                            vbb[abij] = Vbb;
+                        }
                     }
                 }
             }
@@ -451,6 +470,10 @@ double MCSRGPT2_MO::ElementT(const std::string& source, const double& D, const d
 
 void MCSRGPT2_MO::Form_T2_DSRG(d4& AA, d4& AB, d4& BB, std::string& T_ALGOR) {
     timer_on("Form T2");
+    const auto& vaa = V_hhpp_aa_.data();
+    const auto& vab = V_hhpp_ab_.data();
+    const auto& vbb = V_hhpp_bb_.data();
+#pragma omp parallel for schedule(dynamic)
     for (size_t i = 0; i < nhole_; ++i) {
         size_t ni = hole_mos_[i];
         for (size_t j = 0; j < nhole_; ++j) {
@@ -464,9 +487,10 @@ void MCSRGPT2_MO::Form_T2_DSRG(d4& AA, d4& AB, d4& BB, std::string& T_ALGOR) {
                     double Dab = Fa_[ni][ni] + Fb_[nj][nj] - Fa_[na][na] - Fb_[nb][nb];
                     double Dbb = Fb_[ni][ni] + Fb_[nj][nj] - Fb_[na][na] - Fb_[nb][nb];
 
-                    double Vaa = integral_->aptei_aa(na, nb, ni, nj);
-                    double Vab = integral_->aptei_ab(na, nb, ni, nj);
-                    double Vbb = integral_->aptei_bb(na, nb, ni, nj);
+                    size_t ijab = hhpp(i, j, a, b);
+                    double Vaa = vaa[ijab];
+                    double Vab = vab[ijab];
+                    double Vbb = vbb[ijab];
 
                     AA[i][j][a][b] = ElementT(source_, Daa, Vaa);
                     AB[i][j][a][b] = ElementT(source_, Dab, Vab);
@@ -543,10 +567,10 @@ void MCSRGPT2_MO::Form_T1_DSRG(d2& A, d2& B) {
                     double A_Db = Fb_[nx][nx] - Fb_[nu][nu];
 
                     if (t1_amp_ == "SRG") {
-                        double Vaa = integral_->aptei_aa(na, nx, ni, nu);
-                        double Vbb = integral_->aptei_bb(na, nx, ni, nu);
-                        double Vab_aa = integral_->aptei_ab(nx, na, nu, ni);
-                        double Vab_ab = integral_->aptei_ab(na, nx, ni, nu);
+                        double Vaa = V_hhpp_aa_.data()[hhpp(i, u, a, x)];
+                        double Vbb = V_hhpp_bb_.data()[hhpp(i, u, a, x)];
+                        double Vab_aa = V_hhpp_ab_.data()[hhpp(u, i, x, a)];
+                        double Vab_ab = V_hhpp_ab_.data()[hhpp(i, u, a, x)];
 
                         double factor = 0.0;
                         factor = 1.0 - exp(s_ * (2 * Da - A_Da) * A_Da);
@@ -599,9 +623,10 @@ void MCSRGPT2_MO::Form_T2_SELEC(d4& AA, d4& AB, d4& BB) {
                     double Dab = Fa_[ni][ni] + Fb_[nj][nj] - Fa_[na][na] - Fb_[nb][nb];
                     double Dbb = Fb_[ni][ni] + Fb_[nj][nj] - Fb_[na][na] - Fb_[nb][nb];
 
-                    double Vaa = integral_->aptei_aa(na, nb, ni, nj);
-                    double Vab = integral_->aptei_ab(na, nb, ni, nj);
-                    double Vbb = integral_->aptei_bb(na, nb, ni, nj);
+                    size_t ijab = hhpp(i + nactv_, j + nactv_, a, b);
+                    double Vaa = V_hhpp_aa_.data()[ijab];
+                    double Vab = V_hhpp_ab_.data()[ijab];
+                    double Vbb = V_hhpp_bb_.data()[ijab];
 
                     i += nactv_;
                     j += nactv_;
@@ -627,9 +652,10 @@ void MCSRGPT2_MO::Form_T2_SELEC(d4& AA, d4& AB, d4& BB) {
                     double Dab = Fa_[ni][ni] + Fb_[nj][nj] - Fa_[na][na] - Fb_[nb][nb];
                     double Dbb = Fb_[ni][ni] + Fb_[nj][nj] - Fb_[na][na] - Fb_[nb][nb];
 
-                    double Vaa = integral_->aptei_aa(na, nb, ni, nj);
-                    double Vab = integral_->aptei_ab(na, nb, ni, nj);
-                    double Vbb = integral_->aptei_bb(na, nb, ni, nj);
+                    size_t ijab = hhpp(i + nactv_, j + nactv_, a + nactv_, b + nactv_);
+                    double Vaa = V_hhpp_aa_.data()[ijab];
+                    double Vab = V_hhpp_ab_.data()[ijab];
+                    double Vbb = V_hhpp_bb_.data()[ijab];
 
                     i += nactv_;
                     j += nactv_;
@@ -659,9 +685,10 @@ void MCSRGPT2_MO::Form_T2_SELEC(d4& AA, d4& AB, d4& BB) {
                     double Dab = Fa_[ni][ni] + Fb_[nj][nj] - Fa_[na][na] - Fb_[nb][nb];
                     double Dbb = Fb_[ni][ni] + Fb_[nj][nj] - Fb_[na][na] - Fb_[nb][nb];
 
-                    double Vaa = integral_->aptei_aa(na, nb, ni, nj);
-                    double Vab = integral_->aptei_ab(na, nb, ni, nj);
-                    double Vbb = integral_->aptei_bb(na, nb, ni, nj);
+                    size_t ijab = hhpp(i, j, a + nactv_, b + nactv_);
+                    double Vaa = V_hhpp_aa_.data()[ijab];
+                    double Vab = V_hhpp_ab_.data()[ijab];
+                    double Vbb = V_hhpp_bb_.data()[ijab];
 
                     a += nactv_;
                     b += nactv_;
@@ -692,9 +719,10 @@ void MCSRGPT2_MO::Form_T2_ISA(d4& AA, d4& AB, d4& BB, const double& b_const) {
                     double Dab = Fa_[ni][ni] + Fb_[nj][nj] - Fa_[na][na] - Fb_[nb][nb];
                     double Dbb = Fb_[ni][ni] + Fb_[nj][nj] - Fb_[na][na] - Fb_[nb][nb];
 
-                    double scalar_aa = integral_->aptei_aa(na, nb, ni, nj);
-                    double scalar_ab = integral_->aptei_ab(na, nb, ni, nj);
-                    double scalar_bb = integral_->aptei_bb(na, nb, ni, nj);
+                    size_t ijab = hhpp(i, j, a, b);
+                    double scalar_aa = V_hhpp_aa_.data()[ijab];
+                    double scalar_ab = V_hhpp_ab_.data()[ijab];
+                    double scalar_bb = V_hhpp_bb_.data()[ijab];
 
                     AA[i][j][a][b] = scalar_aa / (Daa + b_const / Daa);
                     AB[i][j][a][b] = scalar_ab / (Dab + b_const / Dab);
@@ -1579,6 +1607,9 @@ void MCSRGPT2_MO::PrintDelta() {
 }
 
 void MCSRGPT2_MO::Form_AMP_DSRG() {
+    // Read the integrals needed for the amplitudes and the energy
+    fetch_hhpp_integrals();
+
     // Form T Amplitudes
     T2aa_ = d4(nhole_, d3(nhole_, d2(npart_, d1(npart_))));
     T2ab_ = d4(nhole_, d3(nhole_, d2(npart_, d1(npart_))));
@@ -1778,26 +1809,24 @@ void MCSRGPT2_MO::E_VT1_FT2(double& EF1, double& EF2, double& EV1, double& EV2)
     EF2 = 0.0;
     EV1 = 0.0;
     EV2 = 0.0;
+    const auto& vaa = V_hhpp_aa_.data();
+    const auto& vab = V_hhpp_ab_.data();
+    const auto& vbb = V_hhpp_bb_.data();
+#pragma omp parallel for schedule(dynamic) reduction(+ : EF1, EF2, EV1, EV2)
     for (size_t u = 0; u < nactv_; ++u) {
-        size_t nu = actv_mos_[u];
         for (size_t v = 0; v < nactv_; ++v) {
             size_t nv = actv_mos_[v];
             for (size_t x = 0; x < nactv_; ++x) {
                 size_t nx = actv_mos_[x];
                 for (size_t y = 0; y < nactv_; ++y) {
-                    size_t ny = actv_mos_[y];
 
                     for (size_t e = 0; e < nvirt_; ++e) {
                         size_t ne = virt_mos_[e];
                         size_t te = e + nactv_;
-                        EV1 +=
-                            integral_->aptei_aa(nx, ny, ne, nv) * T1a_[u][te] * L2aa_[x][y][u][v];
-                        EV1 +=
-                            integral_->aptei_bb(nx, ny, ne, nv) * T1b_[u][te] * L2bb_[x][y][u][v];
-                        EV1 += 2 * integral_->aptei_ab(nx, ny, ne, nv) * T1a_[u][te] *
-                               L2ab_[x][y][u][v];
-                        EV1 += 2 * integral_->aptei_ab(ny, nx, nv, ne) * T1b_[u][te] *
-                               L2ab_[y][x][v][u];
+                        EV1 += vaa[hhpp(x, y, te, v)] * T1a_[u][te] * L2aa_[x][y][u][v];
+                        EV1 += vbb[hhpp(x, y, te, v)] * T1b_[u][te] * L2bb_[x][y][u][v];
+                        EV1 += 2 * vab[hhpp(x, y, te, v)] * T1a_[u][te] * L2ab_[x][y][u][v];
+                        EV1 += 2 * vab[hhpp(y, x, v, te)] * T1b_[u][te] * L2ab_[y][x][v][u];
 
                         EF1 += Fa_dsrg_[ne][nx] * T2aa_[u][v][te][y] * L2aa_[x][y][u][v];
                         EF1 += Fb_dsrg_[ne][nx] * T2bb_[u][v][te][y] * L2bb_[x][y][u][v];
@@ -1808,14 +1837,10 @@ void MCSRGPT2_MO::E_VT1_FT2(double& EF1, double& EF2, double& EV1, double& EV2)
                     for (size_t m = 0; m < ncore_; ++m) {
                         size_t nm = core_mos_[m];
                         size_t tm = m + nactv_;
-                        EV2 -=
-                            integral_->aptei_aa(nm, ny, nu, nv) * T1a_[tm][x] * L2aa_[x][y][u][v];
-                        EV2 -=
-                            integral_->aptei_bb(nm, ny, nu, nv) * T1b_[tm][x] * L2bb_[x][y][u][v];
-                        EV2 -= 2 * integral_->aptei_ab(nm, ny, nu, nv) * T1a_[tm][x] *
-                               L2ab_[x][y][u][v];
-                        EV2 -= 2 * integral_->aptei_ab(ny, nm, nv, nu) * T1b_[tm][x] *
-                               L2ab_[y][x][v][u];
+                        EV2 -= vaa[hhpp(tm, y, u, v)] * T1a_[tm][x] * L2aa_[x][y][u][v];
+                        EV2 -= vbb[hhpp(tm, y, u, v)] * T1b_[tm][x] * L2bb_[x][y][u][v];
+                        EV2 -= 2 * vab[hhpp(tm, y, u, v)] * T1a_[tm][x] * L2ab_[x][y][u][v];
+                        EV2 -= 2 * vab[hhpp(y, tm, v, u)] * T1b_[tm][x] * L2ab_[y][x][v][u];
 
                         EF2 -= Fa_dsrg_[nv][nm] * T2aa_[u][tm][x][y] * L2aa_[x][y][u][v];
                         EF2 -= Fb_dsrg_[nv][nm] * T2bb_[u][tm][x][y] * L2bb_[x][y][u][v];
@@ -1833,251 +1858,183 @@ void MCSRGPT2_MO::E_VT1_FT2(double& EF1, double& EF2, double& EV1, double& EV2)
     timer_off("[F, T2] & [V, T1]");
 }
 
-void MCSRGPT2_MO::E_VT2_2(double& E) {
-    timer_on("[V, T2] C_2^4");
-    E = 0.0;
-    d4 C1aa(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    d4 C1ab(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    d4 C1bb(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    for (size_t k = 0; k < nhole_; ++k) {
-        size_t nk = hole_mos_[k];
-        for (size_t l = 0; l < nhole_; ++l) {
-            size_t nl = hole_mos_[l];
-            for (size_t a = 0; a < npart_; ++a) {
-                size_t na = part_mos_[a];
-                for (size_t d = 0; d < npart_; ++d) {
-                    size_t nd = part_mos_[d];
-                    for (size_t c = 0; c < npart_; ++c) {
-                        size_t nc = part_mos_[c];
-                        C1aa[a][d][k][l] +=
-                            integral_->aptei_aa(nk, nl, nc, nd) * (Delta(na, nc) - Da_[na][nc]);
-                        C1ab[a][d][k][l] +=
-                            integral_->aptei_ab(nk, nl, nc, nd) * (Delta(na, nc) - Da_[na][nc]);
-                        C1bb[a][d][k][l] +=
-                            integral_->aptei_bb(nk, nl, nc, nd) * (Delta(na, nc) - Db_[na][nc]);
-                    }
-                }
-            }
+namespace {
+/// The matrix M[p][q] = D[mos[p]][mos[q]] stored by rows
+std::vector<double> density_block(const d2& D, const std::vector<size_t>& mos) {
+    size_t n = mos.size();
+    std::vector<double> M(n * n);
+    for (size_t p = 0; p < n; ++p) {
+        for (size_t q = 0; q < n; ++q) {
+            M[p * n + q] = D[mos[p]][mos[q]];
         }
     }
-    d4 C2aa(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    d4 C2ab(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    d4 C2bb(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    for (size_t k = 0; k < nhole_; ++k) {
-        for (size_t l = 0; l < nhole_; ++l) {
-            for (size_t a = 0; a < npart_; ++a) {
-                for (size_t b = 0; b < npart_; ++b) {
-                    size_t nb = part_mos_[b];
-                    for (size_t d = 0; d < npart_; ++d) {
-                        size_t nd = part_mos_[d];
-                        C2aa[a][b][k][l] += C1aa[a][d][k][l] * (Delta(nb, nd) - Da_[nb][nd]);
-                        C2ab[a][b][k][l] += C1ab[a][d][k][l] * (Delta(nb, nd) - Db_[nb][nd]);
-                        C2bb[a][b][k][l] += C1bb[a][d][k][l] * (Delta(nb, nd) - Db_[nb][nd]);
-                    }
-                }
-            }
-        }
+    return M;
+}
+
+/// The matrix M[p][q] = delta_pq - D[mos[p]][mos[q]] stored by rows
+std::vector<double> hole_density_block(const d2& D, const std::vector<size_t>& mos) {
+    size_t n = mos.size();
+    std::vector<double> M = density_block(D, mos);
+    for (size_t p = 0; p < n * n; ++p) {
+        M[p] = -M[p];
     }
-    C1aa = d4(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    C1ab = d4(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    C1bb = d4(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    for (size_t b = 0; b < npart_; ++b) {
-        for (size_t l = 0; l < nhole_; ++l) {
-            for (size_t a = 0; a < npart_; ++a) {
-                for (size_t i = 0; i < nhole_; ++i) {
-                    size_t ni = hole_mos_[i];
-                    for (size_t k = 0; k < nhole_; ++k) {
-                        size_t nk = hole_mos_[k];
-                        C1aa[a][b][i][l] += C2aa[a][b][k][l] * Da_[nk][ni];
-                        C1ab[a][b][i][l] += C2ab[a][b][k][l] * Da_[nk][ni];
-                        C1bb[a][b][i][l] += C2bb[a][b][k][l] * Db_[nk][ni];
-                    }
-                }
-            }
-        }
+    for (size_t p = 0; p < n; ++p) {
+        M[p * n + p] += 1.0;
     }
-    C2aa = d4(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    C2ab = d4(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    C2bb = d4(npart_, d3(npart_, d2(nhole_, d1(nhole_))));
-    for (size_t a = 0; a < npart_; ++a) {
-        for (size_t b = 0; b < npart_; ++b) {
-            for (size_t i = 0; i < nhole_; ++i) {
-                for (size_t j = 0; j < nhole_; ++j) {
-                    size_t nj = hole_mos_[j];
-                    for (size_t l = 0; l < nhole_; ++l) {
-                        size_t nl = hole_mos_[l];
-                        C2aa[a][b][i][j] += C1aa[a][b][i][l] * Da_[nl][nj];
-                        C2ab[a][b][i][j] += C1ab[a][b][i][l] * Db_[nl][nj];
-                        C2bb[a][b][i][j] += C1bb[a][b][i][l] * Db_[nl][nj];
-                    }
-                }
+    return M;
+}
+
+/// The first n0 x n1 x n2 x n3 elements of a d4 array stored by rows
+std::vector<double> flatten(const d4& A, size_t n0, size_t n1, size_t n2, size_t n3) {
+    std::vector<double> B(n0 * n1 * n2 * n3);
+    for (size_t p = 0, pqrs = 0; p < n0; ++p) {
+        for (size_t q = 0; q < n1; ++q) {
+            for (size_t r = 0; r < n2; ++r) {
+                std::copy(A[p][q][r].begin(), A[p][q][r].begin() + n3, B.begin() + pqrs);
+                pqrs += n3;
             }
         }
     }
-    for (size_t i = 0; i < nhole_; ++i) {
-        for (size_t j = 0; j < nhole_; ++j) {
-            for (size_t a = 0; a < npart_; ++a) {
-                for (size_t b = 0; b < npart_; ++b) {
-                    E += T2aa_[i][j][a][b] * C2aa[a][b][i][j];
-                    E += 4 * T2ab_[i][j][a][b] * C2ab[a][b][i][j];
-                    E += T2bb_[i][j][a][b] * C2bb[a][b][i][j];
+    return B;
+}
+
+/**
+ * Dress the particle indices of a hole-hole-particle-particle block
+ * Y[k][l][a][b] = sum_{cd} E1[a][c] * E2[b][d] * V[k][l][c][d] for k < nk and l < nl
+ * @param V the block V[k][l][c][d] with nh x nh hole and np x np particle indices
+ * @param E1 the np x np matrix applied to the first particle index
+ * @param E2 the np x np matrix applied to the second particle index
+ * @return Y with (nk * nl) rows of np * np elements
+ */
+std::vector<double> dress_particles(std::vector<double>& V, size_t nh, size_t np, size_t nk,
+                                    size_t nl, std::vector<double>& E1, std::vector<double>& E2) {
+    const size_t np2 = np * np;
+    std::vector<double> Y(nk * nl * np2);
+#pragma omp parallel
+    {
+        std::vector<double> temp(np2);
+#pragma omp for schedule(dynamic)
+        for (size_t kl = 0; kl < nk * nl; ++kl) {
+            size_t k = kl / nl, l = kl % nl;
+            // temp[a][d] = sum_c E1[a][c] V[kl][c][d], Y[kl][a][b] = sum_d temp[a][d] E2[b][d]
+            C_DGEMM('N', 'N', np, np, np, 1.0, E1.data(), np, V.data() + (k * nh + l) * np2, np,
+                    0.0, temp.data(), np);
+            C_DGEMM('N', 'T', np, np, np, 1.0, temp.data(), np, E2.data(), np, 0.0,
+                    Y.data() + kl * np2, np);
+        }
+    }
+    return Y;
+}
+
+/**
+ * Transform the hole indices of X[k][l][q] (nh x nh hole indices, ncol columns) in place
+ * X[i][j][q] <- sum_{kl} G1[k][i] * G2[l][j] * X[k][l][q]
+ */
+void transform_holes(std::vector<double>& X, size_t nh, size_t ncol, std::vector<double>& G1,
+                     std::vector<double>& G2) {
+    const size_t nrow = nh * ncol;
+    std::vector<double> Z(X.size());
+    C_DGEMM('T', 'N', nh, nrow, nh, 1.0, G1.data(), nh, X.data(), nrow, 0.0, Z.data(), nrow);
+#pragma omp parallel for
+    for (size_t i = 0; i < nh; ++i) {
+        C_DGEMM('T', 'N', nh, ncol, nh, 1.0, G2.data(), nh, Z.data() + i * nrow, ncol, 0.0,
+                X.data() + i * nrow, ncol);
+    }
+}
+} // namespace
+
+void MCSRGPT2_MO::E_VT2_2(double& E) {
+    timer_on("[V, T2] C_2^4");
+    std::vector<double> Ea = hole_density_block(Da_, part_mos_);
+    std::vector<double> Eb = hole_density_block(Db_, part_mos_);
+    std::vector<double> Ga = density_block(Da_, hole_mos_);
+    std::vector<double> Gb = density_block(Db_, hole_mos_);
+
+    // factor * sum_{ijab} T[ij][ab] sum_{klcd} G1[k][i] G2[l][j] E1[a][c] E2[b][d] V[kl][cd]
+    auto contract = [&](ambit::Tensor& V, const d4& T, std::vector<double>& E1,
+                        std::vector<double>& E2, std::vector<double>& G1, std::vector<double>& G2,
+                        double factor) {
+        std::vector<double> Y = dress_particles(V.data(), nhole_, npart_, nhole_, nhole_, E1, E2);
+        transform_holes(Y, nhole_, npart_ * npart_, G1, G2);
+        double e = 0.0;
+#pragma omp parallel for reduction(+ : e)
+        for (size_t i = 0; i < nhole_; ++i) {
+            for (size_t j = 0; j < nhole_; ++j) {
+                for (size_t a = 0; a < npart_; ++a) {
+                    for (size_t b = 0; b < npart_; ++b) {
+                        e += T[i][j][a][b] * Y[hhpp(i, j, a, b)];
+                    }
                 }
             }
         }
-    }
+        return factor * e;
+    };
+
+    E = contract(V_hhpp_aa_, T2aa_, Ea, Ea, Ga, Ga, 1.0);
+    E += contract(V_hhpp_ab_, T2ab_, Ea, Eb, Ga, Gb, 4.0);
+    E += contract(V_hhpp_bb_, T2bb_, Eb, Eb, Gb, Gb, 1.0);
     E *= 0.25;
     timer_off("[V, T2] C_2^4");
 }
 
 void MCSRGPT2_MO::E_VT2_4PP(double& E) {
     timer_on("[V, T2] C_4 * C_2^2: PP");
-    E = 0.0;
-    d4 C1aa(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    d4 C1ab(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    d4 C1bb(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    for (size_t x = 0; x < nactv_; ++x) {
-        size_t nx = actv_mos_[x];
-        for (size_t y = 0; y < nactv_; ++y) {
-            size_t ny = actv_mos_[y];
-            for (size_t d = 0; d < npart_; ++d) {
-                size_t nd = part_mos_[d];
-                for (size_t a = 0; a < npart_; ++a) {
-                    size_t na = part_mos_[a];
-                    for (size_t c = 0; c < npart_; ++c) {
-                        size_t nc = part_mos_[c];
-                        C1aa[a][d][x][y] +=
-                            integral_->aptei_aa(nx, ny, nc, nd) * (Delta(na, nc) - Da_[na][nc]);
-                        C1ab[a][d][x][y] +=
-                            integral_->aptei_ab(nx, ny, nc, nd) * (Delta(na, nc) - Da_[na][nc]);
-                        C1bb[a][d][x][y] +=
-                            integral_->aptei_bb(nx, ny, nc, nd) * (Delta(na, nc) - Db_[na][nc]);
-                    }
-                }
-            }
-        }
-    }
-    d4 C2aa(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    d4 C2ab(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    d4 C2bb(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    for (size_t x = 0; x < nactv_; ++x) {
-        for (size_t y = 0; y < nactv_; ++y) {
-            for (size_t a = 0; a < npart_; ++a) {
-                for (size_t b = 0; b < npart_; ++b) {
-                    size_t nb = part_mos_[b];
-                    for (size_t d = 0; d < npart_; ++d) {
-                        size_t nd = part_mos_[d];
-                        C2aa[a][b][x][y] += C1aa[a][d][x][y] * (Delta(nb, nd) - Da_[nb][nd]);
-                        C2ab[a][b][x][y] += C1ab[a][d][x][y] * (Delta(nb, nd) - Db_[nb][nd]);
-                        C2bb[a][b][x][y] += C1bb[a][d][x][y] * (Delta(nb, nd) - Db_[nb][nd]);
-                    }
-                }
-            }
-        }
-    }
-    C1aa = d4(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    C1ab = d4(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    C1bb = d4(npart_, d3(npart_, d2(nactv_, d1(nactv_))));
-    for (size_t u = 0; u < nactv_; ++u) {
-        for (size_t v = 0; v < nactv_; ++v) {
-            for (size_t a = 0; a < npart_; ++a) {
-                for (size_t b = 0; b < npart_; ++b) {
-                    for (size_t x = 0; x < nactv_; ++x) {
-                        for (size_t y = 0; y < nactv_; ++y) {
-                            C1aa[a][b][u][v] += C2aa[a][b][x][y] * L2aa_[x][y][u][v];
-                            C1bb[a][b][u][v] += C2bb[a][b][x][y] * L2bb_[x][y][u][v];
-                            C1ab[a][b][u][v] += C2ab[a][b][x][y] * L2ab_[x][y][u][v];
-                        }
-                    }
-                }
-            }
-        }
-    }
-    for (size_t u = 0; u < nactv_; ++u) {
-        for (size_t v = 0; v < nactv_; ++v) {
-            for (size_t a = 0; a < npart_; ++a) {
-                for (size_t b = 0; b < npart_; ++b) {
-                    E += C1aa[a][b][u][v] * T2aa_[u][v][a][b];
-                    E += C1bb[a][b][u][v] * T2bb_[u][v][a][b];
-                    E += 8 * C1ab[a][b][u][v] * T2ab_[u][v][a][b];
-                }
-            }
-        }
-    }
+    std::vector<double> Ea = hole_density_block(Da_, part_mos_);
+    std::vector<double> Eb = hole_density_block(Db_, part_mos_);
+    const size_t na2 = nactv_ * nactv_;
+    const size_t np2 = npart_ * npart_;
+
+    // factor * sum_{xyuv} L2[xy][uv] sum_{ab} T[uv][ab] sum_{cd} E1[a][c] E2[b][d] V[xy][cd]
+    auto contract = [&](ambit::Tensor& V, const d4& T, const d4& L2, std::vector<double>& E1,
+                        std::vector<double>& E2, double factor) {
+        std::vector<double> Y = dress_particles(V.data(), nhole_, npart_, nactv_, nactv_, E1, E2);
+        std::vector<double> Tuv = flatten(T, nactv_, nactv_, npart_, npart_);
+        std::vector<double> M(na2 * na2);
+        C_DGEMM('N', 'T', na2, na2, np2, 1.0, Y.data(), np2, Tuv.data(), np2, 0.0, M.data(),
+                na2);
+        std::vector<double> L = flatten(L2, nactv_, nactv_, nactv_, nactv_);
+        return factor * std::inner_product(L.begin(), L.end(), M.begin(), 0.0);
+    };
+
+    E = contract(V_hhpp_aa_, T2aa_, L2aa_, Ea, Ea, 1.0);
+    E += contract(V_hhpp_bb_, T2bb_, L2bb_, Eb, Eb, 1.0);
+    E += contract(V_hhpp_ab_, T2ab_, L2ab_, Ea, Eb, 8.0);
     E *= 0.125;
     timer_off("[V, T2] C_4 * C_2^2: PP");
 }
 
 void MCSRGPT2_MO::E_VT2_4HH(double& E) {
     timer_on("[V, T2] C_4 * C_2^2: HH");
-    E = 0.0;
-    d4 C1aa(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    d4 C1ab(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    d4 C1bb(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    for (size_t u = 0; u < nactv_; ++u) {
-        size_t nu = actv_mos_[u];
-        for (size_t v = 0; v < nactv_; ++v) {
-            size_t nv = actv_mos_[v];
+    std::vector<double> Ga = density_block(Da_, hole_mos_);
+    std::vector<double> Gb = density_block(Db_, hole_mos_);
+    const size_t na2 = nactv_ * nactv_;
+    const size_t nh2 = nhole_ * nhole_;
+
+    // factor * sum_{ijxy} T[ij][xy] sum_{uv} L2[xy][uv] sum_{kl} G1[k][i] G2[l][j] V[kl][uv]
+    auto contract = [&](ambit::Tensor& V, const d4& T, const d4& L2, std::vector<double>& G1,
+                        std::vector<double>& G2, double factor) {
+        const auto& v = V.data();
+        std::vector<double> Q(nh2 * na2);
+        for (size_t k = 0; k < nhole_; ++k) {
             for (size_t l = 0; l < nhole_; ++l) {
-                size_t nl = hole_mos_[l];
-                for (size_t k = 0; k < nhole_; ++k) {
-                    size_t nk = hole_mos_[k];
-                    for (size_t i = 0; i < nhole_; ++i) {
-                        size_t ni = hole_mos_[i];
-                        C1aa[u][v][i][l] += integral_->aptei_aa(nk, nl, nu, nv) * Da_[nk][ni];
-                        C1ab[u][v][i][l] += integral_->aptei_ab(nk, nl, nu, nv) * Da_[nk][ni];
-                        C1bb[u][v][i][l] += integral_->aptei_bb(nk, nl, nu, nv) * Db_[nk][ni];
-                    }
-                }
-            }
-        }
-    }
-    d4 C2aa(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    d4 C2ab(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    d4 C2bb(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    for (size_t u = 0; u < nactv_; ++u) {
-        for (size_t v = 0; v < nactv_; ++v) {
-            for (size_t i = 0; i < nhole_; ++i) {
-                for (size_t l = 0; l < nhole_; ++l) {
-                    size_t nl = hole_mos_[l];
-                    for (size_t j = 0; j < nhole_; ++j) {
-                        size_t nj = hole_mos_[j];
-                        C2aa[u][v][i][j] += C1aa[u][v][i][l] * Da_[nl][nj];
-                        C2ab[u][v][i][j] += C1ab[u][v][i][l] * Db_[nl][nj];
-                        C2bb[u][v][i][j] += C1bb[u][v][i][l] * Db_[nl][nj];
-                    }
-                }
-            }
-        }
-    }
-    C1aa = d4(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    C1ab = d4(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    C1bb = d4(nactv_, d3(nactv_, d2(nhole_, d1(nhole_))));
-    for (size_t x = 0; x < nactv_; ++x) {
-        for (size_t y = 0; y < nactv_; ++y) {
-            for (size_t i = 0; i < nhole_; ++i) {
-                for (size_t j = 0; j < nhole_; ++j) {
-                    for (size_t u = 0; u < nactv_; ++u) {
-                        for (size_t v = 0; v < nactv_; ++v) {
-                            C1aa[x][y][i][j] += C2aa[u][v][i][j] * L2aa_[x][y][u][v];
-                            C1ab[x][y][i][j] += C2ab[u][v][i][j] * L2ab_[x][y][u][v];
-                            C1bb[x][y][i][j] += C2bb[u][v][i][j] * L2bb_[x][y][u][v];
-                        }
+                for (size_t x = 0; x < nactv_; ++x) {
+                    for (size_t y = 0; y < nactv_; ++y) {
+                        Q[(k * nhole_ + l) * na2 + x * nactv_ + y] = v[hhpp(k, l, x, y)];
                     }
                 }
             }
         }
-    }
-    for (size_t x = 0; x < nactv_; ++x) {
-        for (size_t y = 0; y < nactv_; ++y) {
-            for (size_t i = 0; i < nhole_; ++i) {
-                for (size_t j = 0; j < nhole_; ++j) {
-                    E += C1aa[x][y][i][j] * T2aa_[i][j][x][y];
-                    E += 8 * C1ab[x][y][i][j] * T2ab_[i][j][x][y];
-                    E += C1bb[x][y][i][j] * T2bb_[i][j][x][y];
-                }
-            }
-        }
-    }
+        transform_holes(Q, nhole_, na2, G1, G2);
+        std::vector<double> L = flatten(L2, nactv_, nactv_, nactv_, nactv_);
+        std::vector<double> P(nh2 * na2);
+        C_DGEMM('N', 'T', nh2, na2, na2, 1.0, Q.data(), na2, L.data(), na2, 0.0, P.data(), na2);
+        std::vector<double> Tij = flatten(T, nhole_, nhole_, nactv_, nactv_);
+        return factor * std::inner_product(Tij.begin(), Tij.end(), P.begin(), 0.0);
+    };
+
+    E = contract(V_hhpp_aa_, T2aa_, L2aa_, Ga, Ga, 1.0);
+    E += contract(V_hhpp_ab_, T2ab_, L2ab_, Ga, Gb, 8.0);
+    E += contract(V_hhpp_bb_, T2bb_, L2bb_, Gb, Gb, 1.0);
     E *= 0.125;
     timer_off("[V, T2] C_4 * C_2^2: HH");
 }
@@ -2085,34 +2042,29 @@ void MCSRGPT2_MO::E_VT2_4HH(double& E) {
 void MCSRGPT2_MO::E_VT2_4PH(double& E) {
     timer_on("[V, T2] C_4 * C_2^2: PH");
     E = 0.0;
+    const auto& vaa = V_hhpp_aa_.data();
+    const auto& vab = V_hhpp_ab_.data();
+    const auto& vbb = V_hhpp_bb_.data();
     d4 C11(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
     d4 C12(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
     d4 C13(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
     d4 C14(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
     d4 C19(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
     d4 C110(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
+#pragma omp parallel for schedule(dynamic)
     for (size_t x = 0; x < nactv_; ++x) {
-        size_t nx = actv_mos_[x];
         for (size_t v = 0; v < nactv_; ++v) {
-            size_t nv = actv_mos_[v];
             for (size_t j = 0; j < nhole_; ++j) {
-                size_t nj = hole_mos_[j];
                 for (size_t a = 0; a < npart_; ++a) {
                     size_t na = part_mos_[a];
                     for (size_t b = 0; b < npart_; ++b) {
                         size_t nb = part_mos_[b];
-                        C11[v][a][j][x] +=
-                            integral_->aptei_aa(nj, nx, nv, nb) * (Delta(na, nb) - Da_[na][nb]);
-                        C12[v][a][j][x] -=
-                            integral_->aptei_ab(nx, nj, nv, nb) * (Delta(na, nb) - Db_[na][nb]);
-                        C13[v][a][j][x] +=
-                            integral_->aptei_bb(nj, nx, nv, nb) * (Delta(na, nb) - Db_[na][nb]);
-                        C14[v][a][j][x] -=
-                            integral_->aptei_ab(nj, nx, nb, nv) * (Delta(na, nb) - Da_[na][nb]);
-                        C19[v][a][j][x] +=
-                            integral_->aptei_ab(nx, nj, nb, nv) * (Delta(na, nb) - Da_[na][nb]);
-                        C110[v][a][j][x] +=
-                            integral_->aptei_ab(nj, nx, nv, nb) * (Delta(na, nb) - Db_[na][nb]);
+                        C11[v][a][j][x] += vaa[hhpp(j, x, v, b)] * (Delta(na, nb) - Da_[na][nb]);
+                        C12[v][a][j][x] -= vab[hhpp(x, j, v, b)] * (Delta(na, nb) - Db_[na][nb]);
+                        C13[v][a][j][x] += vbb[hhpp(j, x, v, b)] * (Delta(na, nb) - Db_[na][nb]);
+                        C14[v][a][j][x] -= vab[hhpp(j, x, b, v)] * (Delta(na, nb) - Da_[na][nb]);
+                        C19[v][a][j][x] += vab[hhpp(x, j, b, v)] * (Delta(na, nb) - Da_[na][nb]);
+                        C110[v][a][j][x] += vab[hhpp(j, x, v, b)] * (Delta(na, nb) - Db_[na][nb]);
                     }
                 }
             }
@@ -2124,6 +2076,7 @@ void MCSRGPT2_MO::E_VT2_4PH(double& E) {
     d4 C24(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
     d4 C29(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
     d4 C210(nactv_, d3(npart_, d2(nhole_, d1(nactv_))));
+#pragma omp parallel for schedule(dynamic)
     for (size_t x = 0; x < nactv_; ++x) {
         for (size_t v = 0; v < nactv_; ++v) {
             for (size_t a = 0; a < npart_; ++a) {
@@ -2152,6 +2105,7 @@ void MCSRGPT2_MO::E_VT2_4PH(double& E) {
     d4 C38(nactv_, d3(nactv_, d2(nactv_, d1(nactv_))));
     d4 C39(nactv_, d3(nactv_, d2(nactv_, d1(nactv_))));
     d4 C310(nactv_, d3(nactv_, d2(nactv_, d1(nactv_))));
+#pragma omp parallel for schedule(dynamic)
     for (size_t u = 0; u < nactv_; ++u) {
         for (size_t y = 0; y < nactv_; ++y) {
             for (size_t x = 0; x < nactv_; ++x) {
@@ -2174,6 +2128,7 @@ void MCSRGPT2_MO::E_VT2_4PH(double& E) {
             }
         }
     }
+#pragma omp parallel for reduction(+ : E)
     for (size_t u = 0; u < nactv_; ++u) {
         for (size_t v = 0; v < nactv_; ++v) {
             for (size_t x = 0; x < nactv_; ++x) {
@@ -2199,74 +2154,70 @@ void MCSRGPT2_MO::E_VT2_6(double& E1, double& E2) {
     timer_on("[V, T2] C_6 * C_2");
     E1 = 0.0;
     E2 = 0.0;
-    for (size_t u = 0; u < nactv_; ++u) {
-        size_t nu = actv_mos_[u];
-        for (size_t v = 0; v < nactv_; ++v) {
-            size_t nv = actv_mos_[v];
-            for (size_t w = 0; w < nactv_; ++w) {
-                size_t nw = actv_mos_[w];
-                for (size_t x = 0; x < nactv_; ++x) {
-                    size_t nx = actv_mos_[x];
-                    for (size_t y = 0; y < nactv_; ++y) {
-                        size_t ny = actv_mos_[y];
-                        for (size_t z = 0; z < nactv_; ++z) {
-                            size_t nz = actv_mos_[z];
-                            for (size_t i = 0; i < nhole_; ++i) {
-                                size_t ni = hole_mos_[i];
-                                // L3aaa & L3bbb
-                                E1 += integral_->aptei_aa(ni, nz, nu, nv) * T2aa_[i][w][x][y] *
-                                      L3aaa_[x][y][z][u][v][w];
-                                E1 += integral_->aptei_bb(ni, nz, nu, nv) * T2bb_[i][w][x][y] *
-                                      L3bbb_[x][y][z][u][v][w];
-                                // L3aab
-                                E1 -= 2 * L3aab_[x][z][y][u][v][w] * T2ab_[i][w][x][y] *
-                                      integral_->aptei_aa(ni, nz, nu, nv);
-                                // L3aba & L3baa
-                                E1 -= 2 * L3aab_[x][y][z][u][w][v] * T2aa_[i][w][x][y] *
-                                      integral_->aptei_ab(ni, nz, nu, nv);
-                                E1 += 4 * L3aab_[x][z][y][u][w][v] * T2ab_[w][i][x][y] *
-                                      integral_->aptei_ab(nz, ni, nu, nv);
-                                // L3abb & L3bab
-                                E1 += 4 * L3abb_[x][y][z][u][v][w] * T2ab_[i][w][x][y] *
-                                      integral_->aptei_ab(ni, nz, nu, nv);
-                                E1 -= 2 * L3abb_[z][x][y][u][v][w] * T2bb_[i][w][x][y] *
-                                      integral_->aptei_ab(nz, ni, nu, nv);
-                                // L3bba
-                                E1 -= 2 * L3abb_[x][y][z][w][u][v] * T2ab_[w][i][x][y] *
-                                      integral_->aptei_bb(ni, nz, nu, nv);
-                            }
-                            for (size_t a = 0; a < npart_; ++a) {
-                                size_t na = part_mos_[a];
-                                // L3aaa & L3bbb
-                                E2 += integral_->aptei_aa(nx, ny, nw, na) * T2aa_[u][v][a][z] *
-                                      L3aaa_[x][y][z][u][v][w];
-                                E2 += integral_->aptei_bb(nx, ny, nw, na) * T2bb_[u][v][a][z] *
-                                      L3bbb_[x][y][z][u][v][w];
-                                // L3aab
-                                E2 += 2 * L3aab_[x][z][y][u][v][w] * T2aa_[u][v][a][z] *
-                                      integral_->aptei_ab(nx, ny, na, nw);
-                                // L3aba & L3baa
-                                E2 -= 4 * L3aab_[x][z][y][u][w][v] * T2ab_[u][v][z][a] *
-                                      integral_->aptei_ab(nx, ny, nw, na);
-                                E2 -= 2 * L3aab_[x][y][z][u][w][v] * T2ab_[u][v][a][z] *
-                                      integral_->aptei_aa(nx, ny, nw, na);
-                                // L3abb & L3bab
-                                E2 -= 4 * L3abb_[x][y][z][u][v][w] * T2ab_[u][v][a][z] *
-                                      integral_->aptei_ab(nx, ny, na, nw);
-                                E2 -= 2 * L3abb_[z][x][y][u][v][w] * T2ab_[u][v][z][a] *
-                                      integral_->aptei_bb(nx, ny, nw, na);
-                                // L3bba
-                                E2 += 2 * L3abb_[x][y][z][w][u][v] * T2bb_[u][v][a][z] *
-                                      integral_->aptei_ab(nx, ny, nw, na);
-                            }
+    const auto& vaa = V_hhpp_aa_.data();
+    const auto& vab = V_hhpp_ab_.data();
+    const auto& vbb = V_hhpp_bb_.data();
+    double e1 = 0.0, e2 = 0.0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : e1, e2)
+    for (size_t uv = 0; uv < nactv_ * nactv_; ++uv) {
+        size_t u = uv / nactv_, v = uv % nactv_;
+        for (size_t w = 0; w < nactv_; ++w) {
+            for (size_t x = 0; x < nactv_; ++x) {
+                for (size_t y = 0; y < nactv_; ++y) {
+                    for (size_t z = 0; z < nactv_; ++z) {
+                        for (size_t i = 0; i < nhole_; ++i) {
+                            // L3aaa & L3bbb
+                            e1 += vaa[hhpp(i, z, u, v)] * T2aa_[i][w][x][y] *
+                                  L3aaa_[x][y][z][u][v][w];
+                            e1 += vbb[hhpp(i, z, u, v)] * T2bb_[i][w][x][y] *
+                                  L3bbb_[x][y][z][u][v][w];
+                            // L3aab
+                            e1 -= 2 * L3aab_[x][z][y][u][v][w] * T2ab_[i][w][x][y] *
+                                  vaa[hhpp(i, z, u, v)];
+                            // L3aba & L3baa
+                            e1 -= 2 * L3aab_[x][y][z][u][w][v] * T2aa_[i][w][x][y] *
+                                  vab[hhpp(i, z, u, v)];
+                            e1 += 4 * L3aab_[x][z][y][u][w][v] * T2ab_[w][i][x][y] *
+                                  vab[hhpp(z, i, u, v)];
+                            // L3abb & L3bab
+                            e1 += 4 * L3abb_[x][y][z][u][v][w] * T2ab_[i][w][x][y] *
+                                  vab[hhpp(i, z, u, v)];
+                            e1 -= 2 * L3abb_[z][x][y][u][v][w] * T2bb_[i][w][x][y] *
+                                  vab[hhpp(z, i, u, v)];
+                            // L3bba
+                            e1 -= 2 * L3abb_[x][y][z][w][u][v] * T2ab_[w][i][x][y] *
+                                  vbb[hhpp(i, z, u, v)];
+                        }
+                        for (size_t a = 0; a < npart_; ++a) {
+                            // L3aaa & L3bbb
+                            e2 += vaa[hhpp(x, y, w, a)] * T2aa_[u][v][a][z] *
+                                  L3aaa_[x][y][z][u][v][w];
+                            e2 += vbb[hhpp(x, y, w, a)] * T2bb_[u][v][a][z] *
+                                  L3bbb_[x][y][z][u][v][w];
+                            // L3aab
+                            e2 += 2 * L3aab_[x][z][y][u][v][w] * T2aa_[u][v][a][z] *
+                                  vab[hhpp(x, y, a, w)];
+                            // L3aba & L3baa
+                            e2 -= 4 * L3aab_[x][z][y][u][w][v] * T2ab_[u][v][z][a] *
+                                  vab[hhpp(x, y, w, a)];
+                            e2 -= 2 * L3aab_[x][y][z][u][w][v] * T2ab_[u][v][a][z] *
+                                  vaa[hhpp(x, y, w, a)];
+                            // L3abb & L3bab
+                            e2 -= 4 * L3abb_[x][y][z][u][v][w] * T2ab_[u][v][a][z] *
+                                  vab[hhpp(x, y, a, w)];
+                            e2 -= 2 * L3abb_[z][x][y][u][v][w] * T2ab_[u][v][z][a] *
+                                  vbb[hhpp(x, y, w, a)];
+                            // L3bba
+                            e2 += 2 * L3abb_[x][y][z][w][u][v] * T2bb_[u][v][a][z] *
+                                  vab[hhpp(x, y, w, a)];
                         }
                     }
                 }
             }
         }
     }
-    E1 *= 0.25;
-    E2 *= 0.25;
+    E1 = 0.25 * e1;
+    E2 = 0.25 * e2;
     timer_off("[V, T2] C_6 * C_2");
 }
 
@@ -214,10 +214,20 @@ class MCSRGPT2_MO {
     d2 Fb_dsrg_;
     void Form_Fock_DSRG(d2& A, d2& B, const bool& dsrgpt);
 
+    /// Antisymmetrized two-electron integrals <ij||ab> (i, j in hole_mos_, a, b in part_mos_).
+    /// All the DSRG-PT2 terms only need this block, which is read once so that any integral type
+    /// (including DF and CD) can be used, and renormalized in place by Form_APTEI_DSRG.
+    ambit::Tensor V_hhpp_aa_;
+    ambit::Tensor V_hhpp_ab_;
+    ambit::Tensor V_hhpp_bb_;
+    /// Read the hole-hole-particle-particle integrals
+    void fetch_hhpp_integrals();
+    /// Index of the element (i, j, a, b) of V_hhpp_xx_
+    size_t hhpp(size_t i, size_t j, size_t a, size_t b) const {
+        return ((i * nhole_ + j) * npart_ + a) * npart_ + b;
+    }
+
     /// Effective Two Electron Integral
-    d4 vaa_dsrg_;
-    d4 vab_dsrg_;
-    d4 vbb_dsrg_;
     void Form_APTEI_DSRG(const bool& dsrgpt);
 
     /// Print Delta
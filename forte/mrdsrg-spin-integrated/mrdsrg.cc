@@ -89,6 +89,7 @@ void MRDSRG::read_options() {
 
     sequential_Hbar_ = foptions_->get_bool("DSRG_HBAR_SEQ");
     nivo_ = foptions_->get_bool("DSRG_NIVO");
+    diis_async_ = foptions_->get_bool("DSRG_DIIS_ASYNC");
 
     pt2_h0th_ = foptions_->get_str("DSRG_PT2_H0TH");
     if (pt2_h0th_ != "FFULL" and pt2_h0th_ != "FDIAG_VACTV" and pt2_h0th_ != "FDIAG_VDIAG") {
@@ -96,6 +97,8 @@ void MRDSRG::read_options() {
     }
 
     restart_amps_ = foptions_->get_bool("DSRG_RESTART_AMPS");
+    warm_start_ = foptions_->get_bool("DSRG_WARM_START") and
+                  corrlv_string_.find("DSRG") != std::string::npos;
 }
 
 void MRDSRG::startup() {
@@ -145,6 +148,7 @@ void MRDSRG::startup() {
         t1_file_chk_ = restart_file_prefix_ + ".mrdsrg.spin.t1.bin";
         t2_file_chk_ = restart_file_prefix_ + ".mrdsrg.spin.t2.bin";
     }
+    warm_start_file_ = restart_file_prefix_ + ".mrdsrg.spin.warm.bin";
 
     t1_file_cwd_ = "forte.mrdsrg.spin.t1.bin";
     t2_file_cwd_ = "forte.mrdsrg.spin.t2.bin";
@@ -171,7 +175,8 @@ void MRDSRG::print_options() {
         {"Adaptive DSRG flow type", foptions_->get_str("SMART_DSRG_S")},
         {"Reference relaxation", relax_ref_},
         {"DSRG transformation type", dsrg_trans_type_},
-        {"Core-Virtual source type", foptions_->get_str("CCVV_SOURCE")}};
+        {"Core-Virtual source type", foptions_->get_str("CCVV_SOURCE")},
+        {"DIIS storage", diis_storage_}};
 
     if (corrlv_string_ == "PT2") {
         calculation_info_string.push_back({"PT2 0-order Hamiltonian", pt2_h0th_});
@@ -179,8 +184,10 @@ void MRDSRG::print_options() {
 
     std::vector<std::pair<std::string, bool>> calculation_info_bool{
         {"Restart amplitudes", restart_amps_},
+        {"Warm start amplitudes", warm_start_},
         {"Sequential DSRG transformation", sequential_Hbar_},
         {"Omit blocks of >= 3 virtual indices", nivo_},
+        {"Asynchronous DIIS entries", diis_async_},
         {"Read amplitudes from current dir", read_amps_cwd_},
         {"Write amplitudes to current dir", dump_amps_cwd_}};
 
@@ -319,7 +326,9 @@ double MRDSRG::compute_energy() {
     if (initialize_T) {
         T1_ = BTF_->build(tensor_type_, "T1 Amplitudes", spin_cases({"hp"}));
         T2_ = BTF_->build(tensor_type_, "T2 Amplitudes", spin_cases({"hhpp"}));
-        if (eri_df_) {
+        if (warm_start_ and !read_amps_cwd_ and read_warm_start()) {
+            analyze_amplitudes("Initial", T1_, T2_);
+        } else if (eri_df_) {
             guess_t_df(B_, T2_, F_, T1_);
         } else {
             guess_t(V_, T2_, F_, T1_);
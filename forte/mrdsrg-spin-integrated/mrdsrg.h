@@ -29,6 +29,9 @@
 #ifndef _mrdsrg_h_
 #define _mrdsrg_h_
 
+#include <functional>
+#include <future>
+
 #include "master_mrdsrg.h"
 
 using namespace ambit;
@@ -39,6 +42,8 @@ class DIISManager;
 
 namespace forte {
 
+class CompressedDIIS;
+
 class MRDSRG : public MASTER_DSRG {
     friend class MRSRG_ODEInt;
     friend class MRSRG_Print;
@@ -97,12 +102,22 @@ class MRDSRG : public MASTER_DSRG {
     /// Omitting blocks with >= 3 virtual indices?
     bool nivo_;
 
+    /// Write DIIS entries in the background while the next Hbar is computed?
+    bool diis_async_;
+
     /// Read amplitudes from previous computations
     bool restart_amps_;
 
     /// Prefix for file name
     std::string restart_file_prefix_;
 
+    /// Start from the amplitudes of the last computation rotated to the current orbitals?
+    bool warm_start_;
+    /// The file of the warm-start amplitudes (kept across computations, see write_warm_start_amps)
+    std::string warm_start_file_;
+    /// Read the warm-start amplitudes into T1_ and T2_, return false if they are not usable
+    bool read_warm_start();
+
     /// Dump the converged amplitudes to disk
     void dump_amps_to_disk() override;
 
@@ -220,6 +235,19 @@ class MRDSRG : public MASTER_DSRG {
     /// Compute T2 amplitudes norms
     void compute_t2_norm();
 
+    /**
+     * @brief Scale blocks of a 2- or 4-index tensor by the source operator
+     * @param T the tensor, in the semicanonical basis
+     * @param blocks the blocks of T to be scaled
+     * @param type the factor f(D) applied to each element, where D is formed from Fa_ for
+     *        lowercase (alpha) labels and Fb_ for uppercase (beta) labels
+     */
+    void scale_by_source(BlockedTensor& T, const std::vector<std::string>& blocks,
+                         SourceScaling type);
+    /// Return the blocks of T excluding the ones in exclude
+    std::vector<std::string> blocks_excluding(BlockedTensor& T,
+                                              const std::vector<std::string>& exclude);
+
     /// RMS of T1
     double T1rms_ = 0.0;
     /// Norm of T1
@@ -326,6 +354,8 @@ class MRDSRG : public MASTER_DSRG {
 
     /// Shared pointer of DIISManager object from Psi4
     std::shared_ptr<psi::DIISManager> diis_manager_;
+    /// DIIS with compact storage, used instead of diis_manager_ unless DSRG_DIIS_STORAGE is PSI4
+    std::shared_ptr<CompressedDIIS> compressed_diis_;
     /// Amplitudes pointers
     std::vector<double*> amp_ptrs_;
     /// Residual pointers
@@ -334,10 +364,18 @@ class MRDSRG : public MASTER_DSRG {
     void diis_manager_init();
     /// Add entry for DIISManager
     void diis_manager_add_entry();
+    /// Pending DIIS entry written in the background
+    std::future<void> diis_pending_entry_;
+    /// Add entry for DIISManager without blocking (when DSRG_DIIS_ASYNC is on)
+    void diis_manager_add_entry_async();
+    /// Wait for the pending DIIS entry, required before amplitudes or residuals change
+    void diis_manager_wait();
     /// Extrapolate for DIISManager
     void diis_manager_extrapolate();
     /// Clean up for pointers used for DIIS
     void diis_manager_cleanup();
+    /// Return the number of stored DIIS vectors
+    int diis_subspace_size();
 
     /// Add H2's Hermitian conjugate to itself, H2 need to contain gggg (or
     /// GGGG) block
@@ -374,6 +412,19 @@ class MRDSRG : public MASTER_DSRG {
     double compute_energy_srgpt2();
     /// Time spent for each step
     double srg_time_;
+    /// The number of evaluations of d[H(s)] / d(s)
+    size_t srg_nevals_ = 0;
+    /**
+     * @brief Integrate the SRG flow equation dx/ds = flow(x, s) from s = 0 to end_time
+     *
+     * The step size is controlled by the error estimate of the integrator (SRG_ODEINT). The state
+     * is saved every SRG_CHECKPOINT_FREQ steps to SRG_CHECKPOINT_FILE, from which the flow can be
+     * restarted (SRG_RESTART). The flow is stopped before end_time if the energy changes by less
+     * than SRG_FLOW_E_CONVERGENCE per unit of s. The first element of x is the energy.
+     */
+    void integrate_srg_flow(
+        const std::function<void(const std::vector<double>&, std::vector<double>&, double)>& flow,
+        std::vector<double>& x, double end_time);
 
     /// Compute zero-body term of commutator [H1, G1]
     void H1_G1_C0(BlockedTensor& H1, BlockedTensor& G1, const double& alpha, double& C0);
@@ -38,6 +38,7 @@
 #include "helpers/disk_io.h"
 #include "helpers/printing.h"
 #include "helpers/timer.h"
+#include "mrdsrg-helper/dsrg_warm_start.h"
 #include "boost/format.hpp"
 #include "mrdsrg.h"
 
@@ -45,6 +46,21 @@ using namespace psi;
 
 namespace forte {
 
+namespace {
+/// Add the squared elements of data to norm2 and update the signed max vmax
+void accumulate_norm_max(const std::vector<double>& data, double& norm2, double& vmax) {
+    double sum = 0.0, amax = std::fabs(vmax);
+    for (double value : data) {
+        sum += value * value;
+        if (std::fabs(value) > amax) {
+            amax = std::fabs(value);
+            vmax = value;
+        }
+    }
+    norm2 += sum;
+}
+} // namespace
+
 void MRDSRG::guess_t(BlockedTensor& V, BlockedTensor& T2, BlockedTensor& F, BlockedTensor& T1) {
     print_h2("Build Initial Amplitudes Guesses");
 
@@ -87,6 +103,39 @@ void MRDSRG::guess_t(BlockedTensor& V, BlockedTensor& T2, BlockedTensor& F, Bloc
     analyze_amplitudes("Initial", T1_, T2_);
 }
 
+bool MRDSRG::read_warm_start() {
+    struct stat buf;
+    if (stat(warm_start_file_.c_str(), &buf) != 0) {
+        return false;
+    }
+
+    auto U = BTF_->build(tensor_type_, "U warm start", {"cc", "aa", "vv", "CC", "AA", "VV"});
+    std::vector<std::pair<std::string, BlockedTensor>> amps{
+        {"T1", BTF_->build(tensor_type_, "T1 warm start", T1_.block_labels())},
+        {"T2", BTF_->build(tensor_type_, "T2 warm start", T2_.block_labels())}};
+    double threshold = foptions_->get_double("DSRG_WARM_START_THRESHOLD");
+    if (!read_warm_start_amps(warm_start_file_, ints_, mo_space_info_, threshold, U, amps)) {
+        return false;
+    }
+
+    print_h2("Build Initial Amplitudes Guesses");
+    outfile->Printf("\n    Rotating amplitudes of the last computation ...");
+    auto& T1old = amps[0].second;
+    auto& T2old = amps[1].second;
+    T1_["jb"] = U["ij"] * T1old["ia"] * U["ab"];
+    T1_["JB"] = U["IJ"] * T1old["IA"] * U["AB"];
+
+    auto temp = BTF_->build(tensor_type_, "Temp T2", T2_.block_labels());
+    temp["klab"] = U["ik"] * U["jl"] * T2old["ijab"];
+    temp["kLaB"] = U["ik"] * U["JL"] * T2old["iJaB"];
+    temp["KLAB"] = U["IK"] * U["JL"] * T2old["IJAB"];
+    T2_["ijcd"] = temp["ijab"] * U["bd"] * U["ac"];
+    T2_["iJcD"] = temp["iJaB"] * U["BD"] * U["ac"];
+    T2_["IJCD"] = temp["IJAB"] * U["BD"] * U["AC"];
+    outfile->Printf(" Done.");
+    return true;
+}
+
 void MRDSRG::guess_t_df(BlockedTensor& B, BlockedTensor& T2, BlockedTensor& F, BlockedTensor& T1) {
     print_h2("Build Initial Amplitudes Guesses");
 
@@ -162,20 +211,7 @@ void MRDSRG::guess_t2_std(BlockedTensor& V, BlockedTensor& T2) {
         T2["IJCD"] = tempT2["IJAB"] * U_["DB"] * U_["CA"];
     }
 
-    T2.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if (std::fabs(value) > 1.0e-15) {
-            if ((spin[0] == AlphaSpin) && (spin[1] == AlphaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fa_[i[0]] + Fa_[i[1]] -
-                                                                        Fa_[i[2]] - Fa_[i[3]]);
-            } else if ((spin[0] == AlphaSpin) && (spin[1] == BetaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fa_[i[0]] + Fb_[i[1]] -
-                                                                        Fa_[i[2]] - Fb_[i[3]]);
-            } else if ((spin[0] == BetaSpin) && (spin[1] == BetaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fb_[i[0]] + Fb_[i[1]] -
-                                                                        Fb_[i[2]] - Fb_[i[3]]);
-            }
-        }
-    });
+    scale_by_source(T2, T2.block_labels(), SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -220,20 +256,7 @@ void MRDSRG::guess_t2_std_df(BlockedTensor& B, BlockedTensor& T2) {
         T2["IJCD"] = tempT2["IJAB"] * U_["DB"] * U_["CA"];
     }
 
-    T2.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if (std::fabs(value) > 1.0e-15) {
-            if ((spin[0] == AlphaSpin) && (spin[1] == AlphaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fa_[i[0]] + Fa_[i[1]] -
-                                                                        Fa_[i[2]] - Fa_[i[3]]);
-            } else if ((spin[0] == AlphaSpin) && (spin[1] == BetaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fa_[i[0]] + Fb_[i[1]] -
-                                                                        Fa_[i[2]] - Fb_[i[3]]);
-            } else if ((spin[0] == BetaSpin) && (spin[1] == BetaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fb_[i[0]] + Fb_[i[1]] -
-                                                                        Fb_[i[2]] - Fb_[i[3]]);
-            }
-        }
-    });
+    scale_by_source(T2, T2.block_labels(), SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -273,14 +296,7 @@ void MRDSRG::guess_t1_std(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T1
         temp["UV"] = tempG["UV"];
     }
     // scale by delta
-    temp.iterate(
-        [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-            if (spin[0] == AlphaSpin) {
-                value *= Fa_[i[0]] - Fa_[i[1]];
-            } else {
-                value *= Fb_[i[0]] - Fb_[i[1]];
-            }
-        });
+    scale_by_source(temp, temp.block_labels(), SourceScaling::Denominator);
     // transform back to non-canonical basis
     if (!semi_canonical_) {
         BlockedTensor tempG =
@@ -309,15 +325,7 @@ void MRDSRG::guess_t1_std(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T1
         T1["IA"] = tempT1["IA"];
     }
 
-    T1.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if (std::fabs(value) > 1.0e-15) {
-            if (spin[0] == AlphaSpin) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fa_[i[0]] - Fa_[i[1]]);
-            } else {
-                value *= dsrg_source_->compute_renormalized_denominator(Fb_[i[0]] - Fb_[i[1]]);
-            }
-        }
-    });
+    scale_by_source(T1, T1.block_labels(), SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -362,55 +370,13 @@ void MRDSRG::guess_t2_noccvv(BlockedTensor& V, BlockedTensor& T2) {
     std::vector<std::string> cv_blocks{acore_label_ + acore_label_ + avirt_label_ + avirt_label_,
                                        acore_label_ + bcore_label_ + avirt_label_ + bvirt_label_,
                                        bcore_label_ + bcore_label_ + bvirt_label_ + bvirt_label_};
-    std::vector<std::string> other_blocks(T2.block_labels());
-    other_blocks.erase(std::remove_if(other_blocks.begin(), other_blocks.end(),
-                                      [&](std::string i) {
-                                          return std::find(cv_blocks.begin(), cv_blocks.end(), i) !=
-                                                 cv_blocks.end();
-                                      }),
-                       other_blocks.end());
-
-    // map spin with Fock matrices
-    std::map<bool, const std::vector<double>> Fock_spin{{true, Fa_}, {false, Fb_}};
+    std::vector<std::string> other_blocks = blocks_excluding(T2, cv_blocks);
 
     // ccvv blocks
-    for (const std::string& block : cv_blocks) {
-        // spin
-        bool spin0 = islower(block[0]);
-        bool spin1 = islower(block[1]);
-
-        // diagonal Fock matrix elements
-        const std::vector<double>& F0 = Fock_spin[spin0];
-        const std::vector<double>& F1 = Fock_spin[spin1];
-
-        T2.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            value /= F0[i0] + F1[i1] - F0[i2] - F0[i3];
-        });
-    }
+    scale_by_source(T2, cv_blocks, SourceScaling::InverseDenominator);
 
     // other blocks
-    for (const std::string& block : other_blocks) {
-        // spin
-        bool spin0 = islower(block[0]);
-        bool spin1 = islower(block[1]);
-
-        // diagonal Fock matrix elements
-        const std::vector<double>& F0 = Fock_spin[spin0];
-        const std::vector<double>& F1 = Fock_spin[spin1];
-
-        T2.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            value *=
-                dsrg_source_->compute_renormalized_denominator(F0[i0] + F1[i1] - F0[i2] - F0[i3]);
-        });
-    }
+    scale_by_source(T2, other_blocks, SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -459,55 +425,13 @@ void MRDSRG::guess_t2_noccvv_df(BlockedTensor& B, BlockedTensor& T2) {
     std::vector<std::string> cv_blocks{acore_label_ + acore_label_ + avirt_label_ + avirt_label_,
                                        acore_label_ + bcore_label_ + avirt_label_ + bvirt_label_,
                                        bcore_label_ + bcore_label_ + bvirt_label_ + bvirt_label_};
-    std::vector<std::string> other_blocks(T2.block_labels());
-    other_blocks.erase(std::remove_if(other_blocks.begin(), other_blocks.end(),
-                                      [&](std::string i) {
-                                          return std::find(cv_blocks.begin(), cv_blocks.end(), i) !=
-                                                 cv_blocks.end();
-                                      }),
-                       other_blocks.end());
-
-    // map spin with Fock matrices
-    std::map<bool, const std::vector<double>> Fock_spin{{true, Fa_}, {false, Fb_}};
+    std::vector<std::string> other_blocks = blocks_excluding(T2, cv_blocks);
 
     // ccvv blocks
-    for (const std::string& block : cv_blocks) {
-        // spin
-        bool spin0 = islower(block[0]);
-        bool spin1 = islower(block[1]);
-
-        // diagonal Fock matrix elements
-        const std::vector<double>& F0 = Fock_spin[spin0];
-        const std::vector<double>& F1 = Fock_spin[spin1];
-
-        T2.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            value /= F0[i0] + F1[i1] - F0[i2] - F0[i3];
-        });
-    }
+    scale_by_source(T2, cv_blocks, SourceScaling::InverseDenominator);
 
     // other blocks
-    for (const std::string& block : other_blocks) {
-        // spin
-        bool spin0 = islower(block[0]);
-        bool spin1 = islower(block[1]);
-
-        // diagonal Fock matrix elements
-        const std::vector<double>& F0 = Fock_spin[spin0];
-        const std::vector<double>& F1 = Fock_spin[spin1];
-
-        T2.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            value *=
-                dsrg_source_->compute_renormalized_denominator(F0[i0] + F1[i1] - F0[i2] - F0[i3]);
-        });
-    }
+    scale_by_source(T2, other_blocks, SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -545,14 +469,7 @@ void MRDSRG::guess_t1_nocv(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T
         temp["uv"] = tempG["uv"];
         temp["UV"] = tempG["UV"];
     }
-    temp.iterate(
-        [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-            if (spin[0] == AlphaSpin) {
-                value *= Fa_[i[0]] - Fa_[i[1]];
-            } else {
-                value *= Fb_[i[0]] - Fb_[i[1]];
-            }
-        });
+    scale_by_source(temp, temp.block_labels(), SourceScaling::Denominator);
     if (!semi_canonical_) {
         BlockedTensor tempG =
             ambit::BlockedTensor::build(tensor_type_, "Temp Gamma", spin_cases({"aa"}));
@@ -582,40 +499,13 @@ void MRDSRG::guess_t1_nocv(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T
 
     // labels for ccvv blocks and the rest blocks
     std::vector<std::string> cv_blocks{acore_label_ + avirt_label_, bcore_label_ + bvirt_label_};
-    std::vector<std::string> other_blocks(T1.block_labels());
-    other_blocks.erase(std::remove_if(other_blocks.begin(), other_blocks.end(),
-                                      [&](std::string i) {
-                                          return std::find(cv_blocks.begin(), cv_blocks.end(), i) !=
-                                                 cv_blocks.end();
-                                      }),
-                       other_blocks.end());
-
-    // map spin with Fock matrices
-    std::map<bool, const std::vector<double>> Fock_spin{{true, Fa_}, {false, Fb_}};
+    std::vector<std::string> other_blocks = blocks_excluding(T1, cv_blocks);
 
     // cv blocks
-    for (const std::string& block : cv_blocks) {
-        bool spin0 = islower(block[0]);
-        const std::vector<double>& F0 = Fock_spin[spin0];
-
-        T1.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            value /= F0[i0] - F0[i1];
-        });
-    }
+    scale_by_source(T1, cv_blocks, SourceScaling::InverseDenominator);
 
     // other blocks
-    for (const std::string& block : other_blocks) {
-        bool spin0 = islower(block[0]);
-        const std::vector<double>& F0 = Fock_spin[spin0];
-
-        T1.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            value *= dsrg_source_->compute_renormalized_denominator(F0[i0] - F0[i1]);
-        });
-    }
+    scale_by_source(T1, other_blocks, SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -636,8 +526,6 @@ void MRDSRG::guess_t1_nocv(BlockedTensor& F, BlockedTensor& T2, BlockedTensor& T
 }
 
 void MRDSRG::update_t2_std() {
-    T2max_ = 0.0, t2aa_norm_ = 0.0, t2ab_norm_ = 0.0, t2bb_norm_ = 0.0;
-
     /**
      * Update T2 using delta_t algorithm
      * T2(new) = T2(old) + DT2
@@ -672,19 +560,7 @@ void MRDSRG::update_t2_std() {
 
     timer t2("scale Hbar2 by renormalized denominator");
     // scale Hbar2 by renormalized denominator
-    DT2_.iterate(
-        [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-            if ((spin[0] == AlphaSpin) && (spin[1] == AlphaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fa_[i[0]] + Fa_[i[1]] -
-                                                                        Fa_[i[2]] - Fa_[i[3]]);
-            } else if ((spin[0] == AlphaSpin) && (spin[1] == BetaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fa_[i[0]] + Fb_[i[1]] -
-                                                                        Fa_[i[2]] - Fb_[i[3]]);
-            } else if ((spin[0] == BetaSpin) && (spin[1] == BetaSpin)) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fb_[i[0]] + Fb_[i[1]] -
-                                                                        Fb_[i[2]] - Fb_[i[3]]);
-            }
-        });
+    scale_by_source(DT2_, DT2_.block_labels(), SourceScaling::RenormalizedDenominator);
     t2.stop();
 
     // Step 2: work on T2 where Hbar2 is treated as intermediate
@@ -711,19 +587,7 @@ void MRDSRG::update_t2_std() {
 
     timer t6("scale T2 by delta exponential");
     // scale T2 by delta exponential
-    T2_.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin,
-                    double& value) {
-        if ((spin[0] == AlphaSpin) && (spin[1] == AlphaSpin)) {
-            value *=
-                dsrg_source_->compute_renormalized(Fa_[i[0]] + Fa_[i[1]] - Fa_[i[2]] - Fa_[i[3]]);
-        } else if ((spin[0] == AlphaSpin) && (spin[1] == BetaSpin)) {
-            value *=
-                dsrg_source_->compute_renormalized(Fa_[i[0]] + Fb_[i[1]] - Fa_[i[2]] - Fb_[i[3]]);
-        } else if ((spin[0] == BetaSpin) && (spin[1] == BetaSpin)) {
-            value *=
-                dsrg_source_->compute_renormalized(Fb_[i[0]] + Fb_[i[1]] - Fb_[i[2]] - Fb_[i[3]]);
-        }
-    });
+    scale_by_source(T2_, T2_.block_labels(), SourceScaling::Renormalized);
     t6.stop();
 
     timer t7("minus the renormalized T2 from renormalized Hbar2");
@@ -736,7 +600,7 @@ void MRDSRG::update_t2_std() {
     timer t8("zero internal amplitudes");
     // zero internal amplitudes
     for (const std::string& block : {"aaaa", "aAaA", "AAAA"}) {
-        DT2_.block(block).iterate([&](const std::vector<size_t>&, double& value) { value = 0.0; });
+        DT2_.block(block).zero();
     }
     t8.stop();
 
@@ -765,22 +629,7 @@ void MRDSRG::update_t2_std() {
     T2_["IJAB"] += DT2_["IJAB"];
 
     // compute norm and find maximum
-    T2_.iterate([&](const std::vector<size_t>&, const std::vector<SpinType>& spin, double& value) {
-        if ((spin[0] == AlphaSpin) && (spin[1] == AlphaSpin)) {
-            t2aa_norm_ += value * value;
-        } else if ((spin[0] == AlphaSpin) && (spin[1] == BetaSpin)) {
-            t2ab_norm_ += value * value;
-        } else if ((spin[0] == BetaSpin) && (spin[1] == BetaSpin)) {
-            t2bb_norm_ += value * value;
-        }
-        if (std::fabs(value) > std::fabs(T2max_))
-            T2max_ = value;
-    });
-
-    T2norm_ = std::sqrt(t2aa_norm_ + t2bb_norm_ + 4 * t2ab_norm_);
-    t2aa_norm_ = std::sqrt(t2aa_norm_);
-    t2ab_norm_ = std::sqrt(t2ab_norm_);
-    t2bb_norm_ = std::sqrt(t2bb_norm_);
+    compute_t2_norm();
     t10.stop();
 
     // reset the active part of Hbar2
@@ -790,8 +639,6 @@ void MRDSRG::update_t2_std() {
 }
 
 void MRDSRG::update_t1_std() {
-    T1max_ = 0.0, t1a_norm_ = 0.0, t1b_norm_ = 0.0;
-
     /**
      * Update T1 using delta_t algorithm
      * T1(new) = T1(old) + DT1
@@ -819,14 +666,7 @@ void MRDSRG::update_t1_std() {
     DT1_["IA"] = Hbar1_["IA"];
 
     // scale Hbar1 by renormalized denominator
-    DT1_.iterate(
-        [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-            if (spin[0] == AlphaSpin) {
-                value *= dsrg_source_->compute_renormalized_denominator(Fa_[i[0]] - Fa_[i[1]]);
-            } else {
-                value *= dsrg_source_->compute_renormalized_denominator(Fb_[i[0]] - Fb_[i[1]]);
-            }
-        });
+    scale_by_source(DT1_, DT1_.block_labels(), SourceScaling::RenormalizedDenominator);
 
     // Step 2: work on T1 where Hbar1 is treated as intermediate
 
@@ -845,14 +685,7 @@ void MRDSRG::update_t1_std() {
     }
 
     // scale T1 by delta exponential
-    T1_.iterate(
-        [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-            if (spin[0] == AlphaSpin) {
-                value *= dsrg_source_->compute_renormalized(Fa_[i[0]] - Fa_[i[1]]);
-            } else {
-                value *= dsrg_source_->compute_renormalized(Fb_[i[0]] - Fb_[i[1]]);
-            }
-        });
+    scale_by_source(T1_, T1_.block_labels(), SourceScaling::Renormalized);
 
     // minus the renormalized T1 from renormalized Hbar1
     DT1_["ia"] -= T1_["ia"];
@@ -860,7 +693,7 @@ void MRDSRG::update_t1_std() {
 
     // zero internal amplitudes
     for (const std::string& block : {"aa", "AA"}) {
-        DT1_.block(block).iterate([&](const std::vector<size_t>&, double& value) { value = 0.0; });
+        DT1_.block(block).zero();
     }
 
     // compute RMS
@@ -881,19 +714,7 @@ void MRDSRG::update_t1_std() {
     T1_["IA"] += DT1_["IA"];
 
     // compute norm and find maximum
-    T1_.iterate([&](const std::vector<size_t>&, const std::vector<SpinType>& spin, double& value) {
-        if (spin[0] == AlphaSpin) {
-            t1a_norm_ += value * value;
-        } else {
-            t1b_norm_ += value * value;
-        }
-        if (std::fabs(value) > std::fabs(T1max_))
-            T1max_ = value;
-    });
-
-    T1norm_ = std::sqrt(t1a_norm_ + t1b_norm_);
-    t1a_norm_ = std::sqrt(t1a_norm_);
-    t1b_norm_ = std::sqrt(t1b_norm_);
+    compute_t1_norm();
 
     // reset the active part of Hbar2
     Hbar1_["uv"] = Hbar1copy["uv"];
@@ -901,8 +722,6 @@ void MRDSRG::update_t1_std() {
 }
 
 void MRDSRG::update_t2_noccvv() {
-    T2max_ = 0.0, t2aa_norm_ = 0.0, t2ab_norm_ = 0.0, t2bb_norm_ = 0.0;
-
     // create a temporary tensor
     BlockedTensor R2 = ambit::BlockedTensor::build(tensor_type_, "R2", spin_cases({"hhpp"}));
     R2["ijab"] = T2_["ijab"];
@@ -928,15 +747,7 @@ void MRDSRG::update_t2_noccvv() {
         Hbar2_["iJcD"] = tempH2["iJaB"] * U_["DB"] * U_["ca"];
         Hbar2_["IJCD"] = tempH2["IJAB"] * U_["DB"] * U_["CA"];
     }
-    R2.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if ((spin[0] == AlphaSpin) && (spin[1] == AlphaSpin)) {
-            value *= Fa_[i[0]] + Fa_[i[1]] - Fa_[i[2]] - Fa_[i[3]];
-        } else if ((spin[0] == AlphaSpin) && (spin[1] == BetaSpin)) {
-            value *= Fa_[i[0]] + Fb_[i[1]] - Fa_[i[2]] - Fb_[i[3]];
-        } else if ((spin[0] == BetaSpin) && (spin[1] == BetaSpin)) {
-            value *= Fb_[i[0]] + Fb_[i[1]] - Fb_[i[2]] - Fb_[i[3]];
-        }
-    });
+    scale_by_source(R2, R2.block_labels(), SourceScaling::Denominator);
     R2["ijab"] += Hbar2_["ijab"];
     R2["iJaB"] += Hbar2_["iJaB"];
     R2["IJAB"] += Hbar2_["IJAB"];
@@ -945,74 +756,13 @@ void MRDSRG::update_t2_noccvv() {
     std::vector<std::string> cv_blocks{acore_label_ + acore_label_ + avirt_label_ + avirt_label_,
                                        acore_label_ + bcore_label_ + avirt_label_ + bvirt_label_,
                                        bcore_label_ + bcore_label_ + bvirt_label_ + bvirt_label_};
-    std::vector<std::string> other_blocks(R2.block_labels());
-    other_blocks.erase(std::remove_if(other_blocks.begin(), other_blocks.end(),
-                                      [&](std::string i) {
-                                          return std::find(cv_blocks.begin(), cv_blocks.end(), i) !=
-                                                 cv_blocks.end();
-                                      }),
-                       other_blocks.end());
-
-    // map spin with Fock matrices
-    std::map<bool, const std::vector<double>> Fock_spin{{true, Fa_}, {false, Fb_}};
+    std::vector<std::string> other_blocks = blocks_excluding(R2, cv_blocks);
 
     // ccvv blocks
-    for (const std::string& block : cv_blocks) {
-        // spin
-        bool spin0 = islower(block[0]);
-        bool spin1 = islower(block[1]);
-
-        // diagonal Fock matrix elements
-        const std::vector<double>& F0 = Fock_spin[spin0];
-        const std::vector<double>& F1 = Fock_spin[spin1];
-
-        R2.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            value /= F0[i0] + F1[i1] - F0[i2] - F0[i3];
-            if (spin0 && spin1) {
-                t2aa_norm_ += value * value;
-            } else if (spin0 && !spin1) {
-                t2ab_norm_ += value * value;
-            } else if (!spin0 && !spin1) {
-                t2bb_norm_ += value * value;
-            }
-            if (std::fabs(value) > std::fabs(T2max_))
-                T2max_ = value;
-        });
-    }
+    scale_by_source(R2, cv_blocks, SourceScaling::InverseDenominator);
 
     // other blocks
-    for (const std::string& block : other_blocks) {
-        // spin
-        bool spin0 = islower(block[0]);
-        bool spin1 = islower(block[1]);
-
-        // diagonal Fock matrix elements
-        const std::vector<double>& F0 = Fock_spin[spin0];
-        const std::vector<double>& F1 = Fock_spin[spin1];
-
-        R2.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            size_t i2 = label_to_spacemo_[block[2]][i[2]];
-            size_t i3 = label_to_spacemo_[block[3]][i[3]];
-            value *=
-                dsrg_source_->compute_renormalized_denominator(F0[i0] + F1[i1] - F0[i2] - F0[i3]);
-
-            if (spin0 && spin1) {
-                t2aa_norm_ += value * value;
-            } else if (spin0 && !spin1) {
-                t2ab_norm_ += value * value;
-            } else if (!spin0 && !spin1) {
-                t2bb_norm_ += value * value;
-            }
-            if (std::fabs(value) > std::fabs(T2max_))
-                T2max_ = value;
-        });
-    }
+    scale_by_source(R2, other_blocks, SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -1027,18 +777,9 @@ void MRDSRG::update_t2_noccvv() {
     }
 
     // zero internal amplitudes
-    R2.block("aaaa").iterate([&](const std::vector<size_t>&, double& value) {
-        t2aa_norm_ -= value * value;
-        value = 0.0;
-    });
-    R2.block("aAaA").iterate([&](const std::vector<size_t>&, double& value) {
-        t2ab_norm_ -= value * value;
-        value = 0.0;
-    });
-    R2.block("AAAA").iterate([&](const std::vector<size_t>&, double& value) {
-        t2bb_norm_ -= value * value;
-        value = 0.0;
-    });
+    for (const std::string& block : {"aaaa", "aAaA", "AAAA"}) {
+        R2.block(block).zero();
+    }
 
     // compute RMS
     DT2_["ijab"] = T2_["ijab"] - R2["ijab"];
@@ -1052,15 +793,10 @@ void MRDSRG::update_t2_noccvv() {
     T2_["IJAB"] = R2["IJAB"];
 
     // norms
-    T2norm_ = std::sqrt(t2aa_norm_ + t2bb_norm_ + 4 * t2ab_norm_);
-    t2aa_norm_ = std::sqrt(t2aa_norm_);
-    t2ab_norm_ = std::sqrt(t2ab_norm_);
-    t2bb_norm_ = std::sqrt(t2bb_norm_);
+    compute_t2_norm();
 }
 
 void MRDSRG::update_t1_nocv() {
-    T1max_ = 0.0, t1a_norm_ = 0.0, t1b_norm_ = 0.0;
-
     // create a temporary tensor
     BlockedTensor R1 = ambit::BlockedTensor::build(tensor_type_, "R1", spin_cases({"hp"}));
     R1["ia"] = T1_["ia"];
@@ -1081,67 +817,19 @@ void MRDSRG::update_t1_nocv() {
         Hbar1_["ia"] = tempH1["ia"];
         Hbar1_["IA"] = tempH1["IA"];
     }
-    R1.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if (spin[0] == AlphaSpin) {
-            value *= Fa_[i[0]] - Fa_[i[1]];
-        } else {
-            value *= Fb_[i[0]] - Fb_[i[1]];
-        }
-    });
+    scale_by_source(R1, R1.block_labels(), SourceScaling::Denominator);
     R1["ia"] += Hbar1_["ia"];
     R1["IA"] += Hbar1_["IA"];
 
     // block labels
     std::vector<std::string> cv_blocks{acore_label_ + avirt_label_, bcore_label_ + bvirt_label_};
-    std::vector<std::string> other_blocks(R1.block_labels());
-    other_blocks.erase(std::remove_if(other_blocks.begin(), other_blocks.end(),
-                                      [&](std::string i) {
-                                          return std::find(cv_blocks.begin(), cv_blocks.end(), i) !=
-                                                 cv_blocks.end();
-                                      }),
-                       other_blocks.end());
-
-    // map spin with Fock matrices
-    std::map<bool, const std::vector<double>> Fock_spin{{true, Fa_}, {false, Fb_}};
+    std::vector<std::string> other_blocks = blocks_excluding(R1, cv_blocks);
 
     // cv blocks
-    for (const std::string& block : cv_blocks) {
-        bool spin0 = islower(block[0]);
-        const std::vector<double>& F0 = Fock_spin[spin0];
-
-        R1.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            value /= F0[i0] - F0[i1];
-            if (spin0) {
-                t1a_norm_ += value * value;
-            } else if (!spin0) {
-                t1b_norm_ += value * value;
-            }
-            if (std::fabs(value) > std::fabs(T1max_))
-                T1max_ = value;
-        });
-    }
+    scale_by_source(R1, cv_blocks, SourceScaling::InverseDenominator);
 
     // other blocks
-    for (const std::string& block : other_blocks) {
-        bool spin0 = islower(block[0]);
-        const std::vector<double>& F0 = Fock_spin[spin0];
-
-        R1.block(block).iterate([&](const std::vector<size_t>& i, double& value) {
-            size_t i0 = label_to_spacemo_[block[0]][i[0]];
-            size_t i1 = label_to_spacemo_[block[1]][i[1]];
-            value *= dsrg_source_->compute_renormalized_denominator(F0[i0] - F0[i1]);
-
-            if (spin0) {
-                t1a_norm_ += value * value;
-            } else if (!spin0) {
-                t1b_norm_ += value * value;
-            }
-            if (std::fabs(value) > std::fabs(T1max_))
-                T1max_ = value;
-        });
-    }
+    scale_by_source(R1, other_blocks, SourceScaling::RenormalizedDenominator);
 
     // transform back to non-canonical basis
     if (!semi_canonical_) {
@@ -1154,14 +842,9 @@ void MRDSRG::update_t1_nocv() {
     }
 
     // zero internal amplitudes
-    R1.block("aa").iterate([&](const std::vector<size_t>&, double& value) {
-        t1a_norm_ -= value * value;
-        value = 0.0;
-    });
-    R1.block("AA").iterate([&](const std::vector<size_t>&, double& value) {
-        t1b_norm_ -= value * value;
-        value = 0.0;
-    });
+    for (const std::string& block : {"aa", "AA"}) {
+        R1.block(block).zero();
+    }
 
     // compute RMS
     DT1_["ia"] = T1_["ia"] - R1["ia"];
@@ -1173,23 +856,53 @@ void MRDSRG::update_t1_nocv() {
     T1_["IA"] = R1["IA"];
 
     // norms
-    T1norm_ = std::sqrt(t1a_norm_ + t1b_norm_);
-    t1a_norm_ = std::sqrt(t1a_norm_);
-    t1b_norm_ = std::sqrt(t1b_norm_);
+    compute_t1_norm();
+}
+
+void MRDSRG::scale_by_source(BlockedTensor& T, const std::vector<std::string>& blocks,
+                             SourceScaling type) {
+    for (const std::string& block : blocks) {
+        auto& data = T.block(block).data();
+        const auto& dims = T.block(block).dims();
+        size_t rank = dims.size();
+        if (data.empty())
+            continue;
+        if (rank != 2 and rank != 4) {
+            throw psi::PSIEXCEPTION("scale_by_source: only 2- and 4-index blocks are supported");
+        }
+
+        // orbital energies of each index, with the sign they carry in the denominator
+        std::vector<std::vector<double>> F(rank);
+        for (size_t n = 0; n < rank; ++n) {
+            const std::vector<double>& Fspin = islower(block[n]) ? Fa_ : Fb_;
+            double sign = n < rank / 2 ? 1.0 : -1.0;
+            for (size_t p : label_to_spacemo_[block[n]]) {
+                F[n].push_back(sign * Fspin[p]);
+            }
+        }
+
+        dsrg_source_->scale_block(data.data(), dims, F, type);
+    }
+}
+
+std::vector<std::string> MRDSRG::blocks_excluding(BlockedTensor& T,
+                                                  const std::vector<std::string>& exclude) {
+    std::vector<std::string> blocks;
+    for (const std::string& block : T.block_labels()) {
+        if (std::find(exclude.begin(), exclude.end(), block) == exclude.end()) {
+            blocks.push_back(block);
+        }
+    }
+    return blocks;
 }
 
 void MRDSRG::compute_t1_norm() {
     T1max_ = 0.0, t1a_norm_ = 0.0, t1b_norm_ = 0.0;
 
-    T1_.iterate([&](const std::vector<size_t>&, const std::vector<SpinType>& spin, double& value) {
-        if (spin[0] == AlphaSpin) {
-            t1a_norm_ += value * value;
-        } else {
-            t1b_norm_ += value * value;
-        }
-        if (std::fabs(value) > std::fabs(T1max_))
-            T1max_ = value;
-    });
+    for (const std::string& block : T1_.block_labels()) {
+        double& norm = islower(block[0]) ? t1a_norm_ : t1b_norm_;
+        accumulate_norm_max(T1_.block(block).data(), norm, T1max_);
+    }
 
     T1norm_ = std::sqrt(t1a_norm_ + t1b_norm_);
     t1a_norm_ = std::sqrt(t1a_norm_);
@@ -1199,17 +912,12 @@ void MRDSRG::compute_t1_norm() {
 void MRDSRG::compute_t2_norm() {
     T2max_ = 0.0, t2aa_norm_ = 0.0, t2ab_norm_ = 0.0, t2bb_norm_ = 0.0;
 
-    T2_.iterate([&](const std::vector<size_t>&, const std::vector<SpinType>& spin, double& value) {
-        if ((spin[0] == AlphaSpin) && (spin[1] == AlphaSpin)) {
-            t2aa_norm_ += value * value;
-        } else if ((spin[0] == AlphaSpin) && (spin[1] == BetaSpin)) {
-            t2ab_norm_ += value * value;
-        } else if ((spin[0] == BetaSpin) && (spin[1] == BetaSpin)) {
-            t2bb_norm_ += value * value;
-        }
-        if (std::fabs(value) > std::fabs(T2max_))
-            T2max_ = value;
-    });
+    for (const std::string& block : T2_.block_labels()) {
+        bool spin0 = islower(block[0]);
+        bool spin1 = islower(block[1]);
+        double& norm = spin0 ? (spin1 ? t2aa_norm_ : t2ab_norm_) : t2bb_norm_;
+        accumulate_norm_max(T2_.block(block).data(), norm, T2max_);
+    }
 
     T2norm_ = std::sqrt(t2aa_norm_ + t2bb_norm_ + 4 * t2ab_norm_);
     t2aa_norm_ = std::sqrt(t2aa_norm_);
@@ -1538,5 +1246,12 @@ void MRDSRG::dump_amps_to_disk() {
         ambit::save(T2_, t2_file_cwd_);
         outfile->Printf(" Done.");
     }
+
+    // keep amplitudes with their orbitals for the next geometry or relaxation cycle
+    if (warm_start_) {
+        outfile->Printf("\n    Dumping amplitudes for warm start ...");
+        write_warm_start_amps(warm_start_file_, ints_, {{"T1", T1_}, {"T2", T2_}});
+        outfile->Printf(" Done.");
+    }
 }
 } // namespace forte
@@ -33,9 +33,11 @@
 #include "boost/format.hpp"
 
 #include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libpsi4util/process.h"
 
 #include "base_classes/mo_space_info.h"
 #include "helpers/timer.h"
+#include "mrdsrg-helper/dsrg_df_ladder.h"
 #include "mrdsrg.h"
 
 using namespace psi;
@@ -601,11 +603,10 @@ void MRDSRG::H2_T2_C2_DF(BlockedTensor& B, BlockedTensor& T2, const double& alph
 
     // particle-particle contractions
     forte::timer pp("H2_T2_C2 pp");
-    C2["ijrs"] += batched("r", 0.5 * alpha * B["gar"] * B["gbs"] * T2["ijab"]);
-    C2["ijrs"] -= batched("s", 0.5 * alpha * B["gas"] * B["gbr"] * T2["ijab"]);
-    C2["iJrS"] += batched("r", alpha * B["gar"] * B["gBS"] * T2["iJaB"]);
-    C2["IJRS"] += batched("R", 0.5 * alpha * B["gAR"] * B["gBS"] * T2["IJAB"]);
-    C2["IJRS"] -= batched("S", 0.5 * alpha * B["gAS"] * B["gBR"] * T2["IJAB"]);
+    // ladder term C2["ijrs"] += alpha * B["gar"] * B["gbs"] * T2["ijab"] (same for ab and bb),
+    // where the antisymmetry of T2 replaces the explicit antisymmetrization of (ar|bs).
+    // It is computed directly from B, using at most 1/4 of the memory for the intermediates.
+    df_pp_ladder(B, T2, alpha, C2, psi::Process::environment.get_memory() / 4);
 
     C2["ijrs"] -= alpha * Gamma1_["xy"] * B["gyr"] * B["gbs"] * T2["ijxb"];
     C2["ijrs"] += alpha * Gamma1_["xy"] * B["gys"] * B["gbr"] * T2["ijxb"];
@@ -29,6 +29,7 @@
 #include "psi4/libdiis/diismanager.h"
 #include "ambit/blocked_tensor.h"
 
+#include "helpers/compressed_diis.h"
 #include "mrdsrg.h"
 
 using namespace psi;
@@ -100,9 +101,6 @@ void MRDSRG::return_amp_diis(BlockedTensor& T1, const std::vector<std::string>&
 }
 
 void MRDSRG::diis_manager_init() {
-    diis_manager_ = std::make_shared<DIISManager>(diis_max_vec_, "MRDSRG DIIS",
-                                                  DIISManager::RemovalPolicy::LargestError, DIISManager::StoragePolicy::OnDisk);
-
     amp_ptrs_.clear();
     res_ptrs_.clear();
 
@@ -127,6 +125,17 @@ void MRDSRG::diis_manager_init() {
         }
     }
 
+    if (diis_storage_ != "PSI4") {
+        auto precision = CompressedDIIS::precision_from_string(diis_storage_);
+        compressed_diis_ = std::make_shared<CompressedDIIS>(
+            "mrdsrg.diis", diis_max_vec_, sizes, precision,
+            CompressedDIIS::RemovalPolicy::LargestError, diis_out_of_core_);
+        return;
+    }
+
+    diis_manager_ = std::make_shared<DIISManager>(diis_max_vec_, "MRDSRG DIIS",
+                                                  DIISManager::RemovalPolicy::LargestError, DIISManager::StoragePolicy::OnDisk);
+
     diis_manager_->set_error_vector_size(
         51, DIISEntry::InputType::Pointer, sizes[0], DIISEntry::InputType::Pointer, sizes[1], DIISEntry::InputType::Pointer,
         sizes[2], DIISEntry::InputType::Pointer, sizes[3], DIISEntry::InputType::Pointer, sizes[4], DIISEntry::InputType::Pointer,
@@ -169,6 +178,10 @@ void MRDSRG::diis_manager_init() {
 }
 
 void MRDSRG::diis_manager_add_entry() {
+    if (compressed_diis_) {
+        compressed_diis_->add_entry(res_ptrs_, amp_ptrs_);
+        return;
+    }
     diis_manager_->add_entry(
         102, res_ptrs_[0], res_ptrs_[1], res_ptrs_[2], res_ptrs_[3], res_ptrs_[4], res_ptrs_[5],
         res_ptrs_[6], res_ptrs_[7], res_ptrs_[8], res_ptrs_[9], res_ptrs_[10], res_ptrs_[11],
@@ -189,7 +202,29 @@ void MRDSRG::diis_manager_add_entry() {
         amp_ptrs_[45], amp_ptrs_[46], amp_ptrs_[47], amp_ptrs_[48], amp_ptrs_[49], amp_ptrs_[50]);
 }
 
+void MRDSRG::diis_manager_add_entry_async() {
+    diis_manager_wait();
+    if (diis_async_) {
+        // Hbar only reads T1_, T2_, DT1_, and DT2_, so the entry can be copied and written to
+        // disk while the next Hbar is built
+        diis_pending_entry_ =
+            std::async(std::launch::async, &MRDSRG::diis_manager_add_entry, this);
+    } else {
+        diis_manager_add_entry();
+    }
+}
+
+void MRDSRG::diis_manager_wait() {
+    if (diis_pending_entry_.valid()) {
+        diis_pending_entry_.get();
+    }
+}
+
 void MRDSRG::diis_manager_extrapolate() {
+    if (compressed_diis_) {
+        compressed_diis_->extrapolate(amp_ptrs_);
+        return;
+    }
     diis_manager_->extrapolate(
         51, amp_ptrs_[0], amp_ptrs_[1], amp_ptrs_[2], amp_ptrs_[3], amp_ptrs_[4], amp_ptrs_[5],
         amp_ptrs_[6], amp_ptrs_[7], amp_ptrs_[8], amp_ptrs_[9], amp_ptrs_[10], amp_ptrs_[11],
@@ -203,9 +238,18 @@ void MRDSRG::diis_manager_extrapolate() {
 }
 
 void MRDSRG::diis_manager_cleanup() {
+    diis_manager_wait();
     amp_ptrs_.clear();
     res_ptrs_.clear();
+    if (compressed_diis_) {
+        compressed_diis_.reset();
+        return;
+    }
     diis_manager_->reset_subspace();
     diis_manager_->delete_diis_file();
 }
+
+int MRDSRG::diis_subspace_size() {
+    return compressed_diis_ ? compressed_diis_->subspace_size() : diis_manager_->subspace_size();
+}
 } // namespace forte
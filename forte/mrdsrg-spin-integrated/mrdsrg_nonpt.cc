@@ -29,6 +29,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
 #include <map>
 #include <memory>
 #include <vector>
@@ -83,6 +84,8 @@ void MRDSRG::compute_hbar() {
     std::string dsrg_op = foptions_->get_str("DSRG_TRANS_TYPE");
 
     // compute Hbar recursively
+    // intermediates of T2 and the densities are shared by all nested commutators
+    begin_T2_intermediates(T2_);
     for (int n = 1; n <= maxn; ++n) {
         // prefactor before n-nested commutator
         double factor = 1.0 / n;
@@ -212,6 +215,7 @@ void MRDSRG::compute_hbar() {
             break;
         }
     }
+    end_T2_intermediates();
     if (!converged) {
         outfile->Printf("\n    Warning! Hbar is not converged in %3d-nested commutators!", maxn);
         outfile->Printf("\n    Please increase DSRG_RSC_NCOMM.");
@@ -334,6 +338,8 @@ void MRDSRG::compute_hbar_sequential() {
     converged = false;
 
     // compute Hbar recursively
+    // intermediates of T2 and the densities are shared by all nested commutators
+    begin_T2_intermediates(T2_);
     for (int n = 1; n <= maxn; ++n) {
         // prefactor before n-nested commutator
         double factor = 1.0 / n;
@@ -406,6 +412,7 @@ void MRDSRG::compute_hbar_sequential() {
             break;
         }
     }
+    end_T2_intermediates();
     if (!converged) {
         outfile->Printf("\n    Warning! Hbar is not converged in %3d-nested commutators!", maxn);
         outfile->Printf("\n    Please increase DSRG_RSC_NCOMM.");
@@ -576,6 +583,8 @@ void MRDSRG::compute_hbar_sequential_rotation() {
     converged = false;
 
     // compute Hbar recursively
+    // intermediates of T2 and the densities are shared by all nested commutators
+    begin_T2_intermediates(T2_);
     for (int n = 1; n <= maxn; ++n) {
         // prefactor before n-nested commutator
         double factor = 1.0 / n;
@@ -661,6 +670,7 @@ void MRDSRG::compute_hbar_sequential_rotation() {
             break;
         }
     }
+    end_T2_intermediates();
     if (!converged) {
         outfile->Printf("\n    Warning! Hbar is not converged in %3d-nested commutators!", maxn);
         outfile->Printf("\n    Please increase DSRG_RSC_NCOMM.");
@@ -763,6 +773,7 @@ double MRDSRG::compute_energy_ldsrg2() {
 
         // update amplitudes
         local_timer t_amp;
+        diis_manager_wait();
         update_t();
         double time_amp = t_amp.get();
         od.stop();
@@ -775,13 +786,16 @@ double MRDSRG::compute_energy_ldsrg2() {
         timer diis("DIIS");
         // DIIS amplitudes
         if (diis_start_ > 0 and cycle >= diis_start_) {
-            diis_manager_add_entry();
-            outfile->Printf("  S");
-
-            if ((cycle - diis_start_) % diis_freq_ == 0 and
-                diis_manager_->subspace_size() >= diis_min_vec_) {
+            // the entry must be stored before extrapolating, otherwise it overlaps the next Hbar
+            int nvec = diis_subspace_size() + 1;
+            nvec = std::min(nvec, diis_max_vec_);
+            if ((cycle - diis_start_) % diis_freq_ == 0 and nvec >= diis_min_vec_) {
+                diis_manager_add_entry();
                 diis_manager_extrapolate();
-                outfile->Printf("/E");
+                outfile->Printf("  S/E");
+            } else {
+                diis_manager_add_entry_async();
+                outfile->Printf("  S");
             }
         }
         diis.stop();
@@ -828,6 +842,9 @@ double MRDSRG::compute_energy_ldsrg2() {
     // fail to converge
     if (!converged) {
         clean_checkpoints(); // clean amplitudes in scratch directory
+        if (warm_start_) {
+            remove(warm_start_file_.c_str());
+        }
         throw psi::PSIEXCEPTION("The MR-LDSRG(2) computation does not converge.");
     }
     final.stop();
@@ -1062,7 +1079,7 @@ double MRDSRG::compute_energy_ldsrg2_qc() {
             outfile->Printf("  S");
 
             if ((cycle - diis_start_) % diis_freq_ == 0 and
-                diis_manager_->subspace_size() >= diis_min_vec_) {
+                diis_subspace_size() >= diis_min_vec_) {
                 diis_manager_extrapolate();
                 outfile->Printf("/E");
             }
@@ -1109,6 +1126,9 @@ double MRDSRG::compute_energy_ldsrg2_qc() {
     // fail to converge
     if (!converged) {
         clean_checkpoints(); // clean amplitudes in scratch directory
+        if (warm_start_) {
+            remove(warm_start_file_.c_str());
+        }
         throw psi::PSIEXCEPTION("The MR-LDSRG(2)-QC computation does not converge.");
     }
 
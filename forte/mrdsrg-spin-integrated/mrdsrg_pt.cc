@@ -309,7 +309,7 @@ std::vector<std::pair<std::string, double>> MRDSRG::compute_energy_pt2_FdiagV()
             outfile->Printf("  S");
 
             if ((cycle - diis_start_) % diis_freq_ == 0 and
-                diis_manager_->subspace_size() >= diis_min_vec_) {
+                diis_subspace_size() >= diis_min_vec_) {
                 diis_manager_extrapolate();
                 outfile->Printf("/E");
             }
@@ -535,7 +535,7 @@ std::vector<std::pair<std::string, double>> MRDSRG::compute_energy_pt2_Ffull() {
             outfile->Printf("  S");
 
             if ((cycle - diis_start_) % diis_freq_ == 0 and
-                diis_manager_->subspace_size() >= diis_min_vec_) {
+                diis_subspace_size() >= diis_min_vec_) {
                 diis_manager_extrapolate();
                 outfile->Printf("/E");
             }
@@ -699,7 +699,7 @@ std::vector<std::pair<std::string, double>> MRDSRG::compute_energy_pt2_Ffull() {
             outfile->Printf("  S");
 
             if ((cycle - diis_start_) % diis_freq_ == 0 and
-                diis_manager_->subspace_size() >= diis_min_vec_) {
+                diis_subspace_size() >= diis_min_vec_) {
                 diis_manager_extrapolate();
                 outfile->Printf("/E");
             }
@@ -28,10 +28,14 @@
  */
 
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sys/stat.h>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 
 #include "base_classes/mo_space_info.h"
+#include "helpers/disk_io.h"
 #include "boost/format.hpp"
 #include "boost/numeric/odeint.hpp"
 #include "mrdsrg.h"
@@ -140,6 +144,7 @@ void MRSRG_ODEInt::operator()(const odeint_state_type& x, odeint_state_type& dxd
     auto t_end = std::chrono::high_resolution_clock::now();
     auto t_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_start).count();
     mrdsrg_obj_.srg_time_ += t_ms / 1000.0;
+    mrdsrg_obj_.srg_nevals_ += 1;
 }
 
 void MRSRG_Print::operator()(const odeint_state_type& x, const double t) {
@@ -164,6 +169,103 @@ void MRSRG_Print::operator()(const odeint_state_type& x, const double t) {
     mrdsrg_obj_.Hbar0_ = x[0];
 }
 
+void MRDSRG::integrate_srg_flow(
+    const std::function<void(const std::vector<double>&, std::vector<double>&, double)>& flow,
+    std::vector<double>& x, double end_time) {
+    double t = 0.0;
+    double dt = foptions_->get_double("SRG_DT");
+    std::string srg_odeint = foptions_->get_str("SRG_ODEINT");
+    double absolute_error = foptions_->get_double("SRG_ODEINT_ABSERR");
+    double relative_error = foptions_->get_double("SRG_ODEINT_RELERR");
+    double e_convergence = foptions_->get_double("SRG_FLOW_E_CONVERGENCE");
+    std::string checkpoint_file = foptions_->get_str("SRG_CHECKPOINT_FILE");
+    size_t checkpoint_freq = std::max(1, foptions_->get_int("SRG_CHECKPOINT_FREQ"));
+
+    // a snapshot of the flow is stored as [s, ds, x]
+    struct stat buf;
+    if (foptions_->get_bool("SRG_RESTART") and (not checkpoint_file.empty()) and
+        (stat(checkpoint_file.c_str(), &buf) == 0)) {
+        std::vector<double> snapshot;
+        read_disk_vector_double(checkpoint_file, snapshot);
+        if ((snapshot.size() == x.size() + 2) and (snapshot[0] < end_time)) {
+            t = snapshot[0];
+            dt = snapshot[1];
+            std::copy(snapshot.begin() + 2, snapshot.end(), x.begin());
+            outfile->Printf("\n    Restarting the flow from %s at s = %.6f",
+                            checkpoint_file.c_str(), t);
+        } else {
+            outfile->Printf("\n    The SRG checkpoint %s does not match this flow. It will not "
+                            "be used.",
+                            checkpoint_file.c_str());
+        }
+    }
+    auto save_snapshot = [&]() {
+        std::vector<double> snapshot{t, dt};
+        snapshot.insert(snapshot.end(), x.begin(), x.end());
+        std::string tmp_file = checkpoint_file + ".tmp";
+        write_disk_vector_double(tmp_file, snapshot, true);
+        if (std::rename(tmp_file.c_str(), checkpoint_file.c_str()) != 0) {
+            outfile->Printf("\n    Cannot write the SRG checkpoint %s", checkpoint_file.c_str());
+        }
+    };
+
+    MRSRG_Print printer(*this);
+    size_t naccepted = 0, nrejected = 0;
+    srg_nevals_ = 0;
+
+    auto propagate = [&](auto stepper) {
+        const size_t max_rejected_in_row = 500;
+        size_t rejected_in_row = 0;
+        printer(x, t);
+        while (t < end_time) {
+            double t_old = t;
+            double E_old = x[0];
+            double ds = std::min(dt, end_time - t);
+            if (stepper.try_step(flow, x, t, ds) == fail) {
+                // ds has been reduced by the stepper
+                dt = ds;
+                nrejected++;
+                if (++rejected_in_row > max_rejected_in_row) {
+                    throw std::runtime_error("SRG flow: the step size cannot be reduced further. "
+                                             "Increase SRG_ODEINT_ABSERR/SRG_ODEINT_RELERR.");
+                }
+                continue;
+            }
+            // ds is now the step suggested for the next step
+            dt = ds;
+            rejected_in_row = 0;
+            naccepted++;
+            printer(x, t);
+
+            if ((not checkpoint_file.empty()) and (naccepted % checkpoint_freq == 0)) {
+                save_snapshot();
+            }
+            if ((e_convergence > 0.0) and (std::fabs(x[0] - E_old) < e_convergence * (t - t_old))) {
+                outfile->Printf("\n    The flow has converged at s = %.6f", t);
+                break;
+            }
+        }
+    };
+
+    if (srg_odeint == "FEHLBERG78") {
+        propagate(make_controlled(absolute_error, relative_error,
+                                  runge_kutta_fehlberg78<odeint_state_type>()));
+    } else if (srg_odeint == "CASHKARP") {
+        propagate(make_controlled(absolute_error, relative_error,
+                                  runge_kutta_cash_karp54<odeint_state_type>()));
+    } else if (srg_odeint == "DOPRI5") {
+        // the last evaluation of a step is reused as the first of the next one (FSAL)
+        propagate(make_controlled(absolute_error, relative_error,
+                                  runge_kutta_dopri5<odeint_state_type>()));
+    }
+    if (not checkpoint_file.empty()) {
+        save_snapshot();
+    }
+    if (nrejected > 0) {
+        outfile->Printf("\n    Rejected steps: %zu", nrejected);
+    }
+}
+
 double MRDSRG::compute_energy_lsrg2() {
     // print title
     outfile->Printf("\n\n  ==> Computing MR-LSRG(2) Energy <==\n");
@@ -173,7 +275,6 @@ double MRDSRG::compute_energy_lsrg2() {
         outfile->Printf("\n    Skip Lambda3 contributions in [O2, T2].");
     }
 
-    double start_time = 0.0;
     double end_time = foptions_->get_double("DSRG_S");
     if (end_time > 1000.0) {
         end_time = 1000.0;
@@ -222,32 +323,15 @@ double MRDSRG::compute_energy_lsrg2() {
         x.push_back(value);
     });
 
-    double absolute_error = foptions_->get_double("SRG_ODEINT_ABSERR");
-    double relative_error = foptions_->get_double("SRG_ODEINT_RELERR");
     srg_time_ = 0.0;
     MRSRG_ODEInt mrsrg_flow_computer(*this);
-    MRSRG_Print mrsrg_printer(*this);
 
     // start iterations
-    if (srg_odeint == "FEHLBERG78") {
-        integrate_adaptive(make_controlled(absolute_error, relative_error,
-                                           runge_kutta_fehlberg78<odeint_state_type>()),
-                           mrsrg_flow_computer, x, start_time, end_time, initial_step,
-                           mrsrg_printer);
-    } else if (srg_odeint == "CASHKARP") {
-        integrate_adaptive(make_controlled(absolute_error, relative_error,
-                                           runge_kutta_cash_karp54<odeint_state_type>()),
-                           mrsrg_flow_computer, x, start_time, end_time, initial_step,
-                           mrsrg_printer);
-    } else if (srg_odeint == "DOPRI5") {
-        integrate_adaptive(make_controlled(absolute_error, relative_error,
-                                           runge_kutta_dopri5<odeint_state_type>()),
-                           mrsrg_flow_computer, x, start_time, end_time, initial_step,
-                           mrsrg_printer);
-    }
+    integrate_srg_flow(mrsrg_flow_computer, x, end_time);
 
     // print summary
     outfile->Printf("\n    %s", dash.c_str());
+    outfile->Printf("\n    Evaluations of dH/ds: %zu", srg_nevals_);
     outfile->Printf("\n\n  ==> MR-LSRG(2) Energy Summary <==\n");
     std::vector<std::pair<std::string, double>> energy;
     energy.push_back({"E0 (reference)", Eref_});
@@ -373,6 +457,7 @@ void SRGPT2_ODEInt::operator()(const odeint_state_type& x, odeint_state_type& dx
     auto t_end = std::chrono::high_resolution_clock::now();
     auto t_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_start).count();
     mrdsrg_obj_.srg_time_ += t_ms / 1000.0;
+    mrdsrg_obj_.srg_nevals_ += 1;
 }
 
 double MRDSRG::compute_energy_srgpt2() {
@@ -384,7 +469,6 @@ double MRDSRG::compute_energy_srgpt2() {
         outfile->Printf("\n    Skip Lambda3 contributions in [O2, T2].");
     }
 
-    double start_time = 0.0;
     double end_time = foptions_->get_double("DSRG_S");
     if (end_time > 1000.0) {
         end_time = 1000.0;
@@ -412,7 +496,11 @@ double MRDSRG::compute_energy_srgpt2() {
 
     // some options
     std::string Hzero = foptions_->get_str("DSRG_PT2_H0TH");
-    bool multi_state = foptions_->get_gen_list("AVG_STATE").size() != 0;
+    bool multi_state;
+    {
+        py::gil_scoped_acquire gil;
+        multi_state = foptions_->get_gen_list("AVG_STATE").size() != 0;
+    }
 
     bool relax_ref = foptions_->get_str("RELAX_REF") != "NONE" || multi_state;
 
@@ -476,32 +564,15 @@ double MRDSRG::compute_energy_srgpt2() {
         });
     }
 
-    double absolute_error = foptions_->get_double("SRG_ODEINT_ABSERR");
-    double relative_error = foptions_->get_double("SRG_ODEINT_RELERR");
     srg_time_ = 0.0;
     SRGPT2_ODEInt mrsrg_flow_computer(*this, Hzero, relax_ref);
-    MRSRG_Print mrsrg_printer(*this);
 
     // start iterations
-    if (srg_odeint == "FEHLBERG78") {
-        integrate_adaptive(make_controlled(absolute_error, relative_error,
-                                           runge_kutta_fehlberg78<odeint_state_type>()),
-                           mrsrg_flow_computer, x, start_time, end_time, initial_step,
-                           mrsrg_printer);
-    } else if (srg_odeint == "CASHKARP") {
-        integrate_adaptive(make_controlled(absolute_error, relative_error,
-                                           runge_kutta_cash_karp54<odeint_state_type>()),
-                           mrsrg_flow_computer, x, start_time, end_time, initial_step,
-                           mrsrg_printer);
-    } else if (srg_odeint == "DOPRI5") {
-        integrate_adaptive(make_controlled(absolute_error, relative_error,
-                                           runge_kutta_dopri5<odeint_state_type>()),
-                           mrsrg_flow_computer, x, start_time, end_time, initial_step,
-                           mrsrg_printer);
-    }
+    integrate_srg_flow(mrsrg_flow_computer, x, end_time);
 
     // print summary
     outfile->Printf("\n    %s", dash.c_str());
+    outfile->Printf("\n    Evaluations of dH/ds: %zu", srg_nevals_);
     outfile->Printf("\n\n  ==> SRG-MRPT2 Energy Summary <==\n");
     std::vector<std::pair<std::string, double>> energy;
     energy.push_back({"E0 (reference)", Eref_});
@@ -28,6 +28,9 @@
  */
 
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <map>
 #include <numeric>
 #include <string>
 #include <sstream>
@@ -57,6 +60,7 @@
 
 #include "orbital-helpers/ao_helper.h"
 #include "helpers/blockedtensorfactory.h"
+#include "helpers/memory_manager.h"
 #include "helpers/printing.h"
 #include "helpers/timer.h"
 #include "fci/fci_solver.h"
@@ -1246,7 +1250,10 @@ double THREE_DSRG_MRPT2::E_VT2_2() {
     // TODO: Make this smarter and automatically switch to right algorithm for size
     // Small size -> use core algorithm
     // Large size -> use fly_ambit
-    if (ccvv_algorithm == "CORE") {
+    if (ccvv_algorithm == "AUTO") {
+        if (my_proc == 0)
+            Eccvv = E_VT2_2_auto();
+    } else if (ccvv_algorithm == "CORE") {
         if (my_proc == 0)
             Eccvv = E_VT2_2_core();
     } else if (ccvv_algorithm == "FLY_LOOP") {
@@ -1287,7 +1294,7 @@ double THREE_DSRG_MRPT2::E_VT2_2() {
 #endif
     } else {
         outfile->Printf("\n Specify a correct algorithm string");
-        throw psi::PSIEXCEPTION("Specify either CORE FLY_LOOP FLY_AMBIT BATCH_CORE "
+        throw psi::PSIEXCEPTION("Specify either AUTO CORE FLY_LOOP FLY_AMBIT BATCH_CORE "
                                 "BATCH_VIRTUAL BATCH_CORE_MPI BATCH_VIRTUAL_MPI or "
                                 "other algorihm");
     }
@@ -1546,130 +1553,8 @@ double THREE_DSRG_MRPT2::E_VT2_6() {
 
             E += 0.50 * temp.block("aAAaAA")("uVWxYZ") * rdms_.L3abb()("xYZuVW");
 
-        } else if (foptions_->get_str("THREEPDC_ALGORITHM") == "BATCH") {
-
-            outfile->Printf("\n  Temporarily disabled by York.");
-
-            /** TODO:
-             * 3-cumulant files: handled by reference codes (FCI, CAS)
-             * 3-cumulant files: cirdm code should NOT return full spin cases
-             * temp tensor should also be written to files
-             **/
-
-            //            BlockedTensor Lambda3 = BTF_->build(tensor_type_, "Lambda3_",
-            //            spin_cases({"aaaaaa"}));
-
-            //            ambit::Tensor Lambda3_aaa = Lambda3.block("aaaaaa");
-            //            ambit::Tensor Lambda3_aaA = Lambda3.block("aaAaaA");
-            //            ambit::Tensor Lambda3_aAA = Lambda3.block("aAAaAA");
-            //            ambit::Tensor Lambda3_AAA = Lambda3.block("AAAAAA");
-            //            Lambda3_aaa("pqrstu") = rdms_.L3aaa()("pqrstu");
-            //            Lambda3_aaA("pqrstu") = rdms_.L3aab()("pqrstu");
-            //            Lambda3_aAA("pqrstu") = rdms_.L3abb()("pqrstu");
-            //            Lambda3_AAA("pqrstu") = rdms_.L3bbb()("pqrstu");
-
-            //            if (print_ > 3){
-            //                Lambda3.print(stdout);
-            //            }
-
-            //            Lambda3_aaa("pqrstu") = rdms_.L3aaa()("pqrstu");
-            //            Lambda3_aaA("pqrstu") = rdms_.L3aab()("pqrstu");
-            //            Lambda3_aAA("pqrstu") = rdms_.L3abb()("pqrstu");
-            //            Lambda3_AAA("pqrstu") = rdms_.L3bbb()("pqrstu");
-            //            size_t size = Lambda3_aaa.data().size();
-            //            std::string path = PSIOManager::shared_object()->get_default_path();
-            //            FILE* fl3aaa = fopen((path + "forte.l3aaa.bin").c_str(), "w+");
-            //            FILE* fl3aAA = fopen((path + "forte.l3aAA.bin").c_str(), "w+");
-            //            FILE* fl3aaA = fopen((path + "forte.l3aaA.bin").c_str(), "w+");
-            //            FILE* fl3AAA = fopen((path + "forte.l3AAA.bin").c_str(), "w+");
-
-            //            fwrite(&Lambda3_aaa.data()[0], sizeof(double), size, fl3aaa);
-            //            fwrite(&Lambda3_aAA.data()[0], sizeof(double), size, fl3aAA);
-            //            fwrite(&Lambda3_aaA.data()[0], sizeof(double), size, fl3aaA);
-            //            fwrite(&Lambda3_AAA.data()[0], sizeof(double), size, fl3AAA);
-
-            //            temp["uvwxyz"] += V_["uviz"] * T2_["iwxy"];
-            //            temp["uvwxyz"] += V_["waxy"] * T2_["uvaz"]; //  aaaaaa from particle
-            //            temp["UVWXYZ"] += V_["UVIZ"] * T2_["IWXY"]; //  AAAAAA from hole
-            //            temp["UVWXYZ"] += V_["WAXY"] * T2_["UVAZ"]; //  AAAAAA from particle
-            //            // E += 0.25 * temp["uvwxyz"] * Lambda3["xyzuvw"];
-            //            // E += 0.25 * temp["UVWXYZ"] * Lambda3["XYZUVW"];
-
-            //            temp["uvWxyZ"] -= V_["uviy"] * T2_["iWxZ"]; //  aaAaaA from hole
-            //            temp["uvWxyZ"] -= V_["uWiZ"] * T2_["ivxy"]; //  aaAaaA from hole
-            //            temp["uvWxyZ"] += V_["uWyI"] * T2_["vIxZ"]; //  aaAaaA from hole
-            //            temp["uvWxyZ"] += V_["uWyI"] * T2_["vIxZ"]; //  aaAaaA from hole
-
-            //            temp["uvWxyZ"] += V_["aWxZ"] * T2_["uvay"]; //  aaAaaA from particle
-            //            temp["uvWxyZ"] -= V_["vaxy"] * T2_["uWaZ"]; //  aaAaaA from particle
-            //            temp["uvWxyZ"] -= V_["vAxZ"] * T2_["uWyA"]; //  aaAaaA from particle
-            //            temp["uvWxyZ"] -= V_["vAxZ"] * T2_["uWyA"]; //  aaAaaA from particle
-
-            //            E += 0.50 * temp["uvWxyZ"] * Lambda3["xyZuvW"];
-
-            //            temp["uVWxYZ"] -= V_["VWIZ"] * T2_["uIxY"]; //  aAAaAA from hole
-            //            temp["uVWxYZ"] -= V_["uVxI"] * T2_["IWYZ"]; //  aAAaAA from hole
-            //            temp["uVWxYZ"] += V_["uViZ"] * T2_["iWxY"]; //  aAAaAA from hole
-            //            temp["uVWxYZ"] += V_["uViZ"] * T2_["iWxY"]; //  aAAaAA from hole
-
-            //            temp["uVWxYZ"] += V_["uAxY"] * T2_["VWAZ"]; //  aAAaAA from particle
-            //            temp["uVWxYZ"] -= V_["WAYZ"] * T2_["uVxA"]; //  aAAaAA from particle
-            //            temp["uVWxYZ"] -= V_["aWxY"] * T2_["uVaZ"]; //  aAAaAA from particle
-            //            temp["uVWxYZ"] -= V_["aWxY"] * T2_["uVaZ"]; //  aAAaAA from particle
-
-            //            // E += 0.5 * temp["uVWxYZ"] * Lambda3["xYZuVW"];
-            //            double Econtrib = 0.5 * temp["uVWxYZ"] * Lambda3["xYZuVW"];
-            //            outfile->Printf("\n  Econtrib: %8.8f", Econtrib);
-            //            outfile->Printf("\n  L3aAANorm: %8.8f",
-            //                            Lambda3.block("aAAaAA").norm(2.0) *
-            //                                Lambda3.block("aAAaAA").norm(2.0));
-            //            outfile->Printf("\n  temp: %8.8f",
-            //                            temp.block("aAAaAA").norm(2.0) *
-            //                                temp.block("aAAaAA").norm(2.0));
-            //            ambit::Tensor temp_uVWz = ambit::Tensor::build(
-            //                tensor_type_, "VWxz", {active_, active_, active_, active_});
-            //            std::vector<double>& temp_uVWz_data = temp.block("aAAaAA").data();
-            //            ambit::Tensor L3_ZuVW = ambit::Tensor::build(
-            //                tensor_type_, "L3Slice", {active_, active_, active_, active_});
-            //            size_t active2 = active_ * active_;
-            //            size_t active3 = active2 * active_;
-            //            size_t active4 = active3 * active_;
-            //            size_t active5 = active4 * active_;
-            //            double normTemp = 0.0;
-            //            double normCumulant = 0.0;
-            //            double Econtrib2 = 0.0;
-            //            for (size_t x = 0; x < active_; x++) {
-            //                for (size_t y = 0; y < active_; y++) {
-
-            //                    BlockedTensor V_wa =
-            //                        BTF_->build(tensor_type_, "V_wa", {"ah", "AH"}, true);
-            //                    BlockedTensor T_iw =
-            //                        BTF_->build(tensor_type_, "T_iw", {"ha", "HA"}, true);
-
-            //                    BlockedTensor temp_uvwz =
-            //                        BTF_->build(tensor_type_, "T_uvwz", {"AAAA", "aaaa"});
-            //                    BlockedTensor L3_zuvw =
-            //                        BTF_->build(tensor_type_, "L3_zuvw", {"AAAA", "aaaa"});
-            //                    temp_uvwz["uvwz"] += V_["uviz"] * T_iw["iw"];
-            //                    temp_uvwz["uvwz"] += V_wa["wa"] * T2_["uvaz"];
-            //                    temp_uvwz["UVWZ"] += T_iw["IW"] * V_["UVIZ"];
-            //                    temp_uvwz["uvwz"] += V_wa["WA"] * T2_["UVAZ"];
-
-            //                    fseek(fl3aaa, (x * active5 + y * active4) * sizeof(double),
-            //                          SEEK_SET);
-            //                    fread(&(L3_zuvw.block("aaaa").data()[0]), sizeof(double),
-            //                          active4, fl3aaa);
-            //                    fseek(fl3AAA, (x * active5 + y * active4) * sizeof(double),
-            //                          SEEK_SET);
-            //                    fread(&(L3_zuvw.block("AAAA").data()[0]), sizeof(double),
-            //                          active4, fl3AAA);
-            //                    E += 0.25 * temp_uvwz["uvwz"] * L3_zuvw["zuvw"];
-            //                    E += 0.25 * temp_uvwz["UVWZ"] * L3_zuvw["ZUVW"];
-            //                }
-            //            }
-            //            outfile->Printf("\n  Econtrib2: %8.8f", Econtrib2);
-            //            outfile->Printf("\n  Temp: %8.8f Cumulant: %8.8f", normTemp,
-            //                            normCumulant);
+        } else {
+            E = E_VT2_6_batched(foptions_->get_str("THREEPDC_ALGORITHM") == "SPARSE");
         }
     }
 
@@ -1677,7 +1562,237 @@ double THREE_DSRG_MRPT2::E_VT2_6() {
     return E;
 }
 
+namespace {
+/// A contribution factor * X(...x...) * Y(...) to the intermediate of the [V, T2] λ3 term. X is
+/// V ('V') or T2 ('T') with the batch index x at position 2, and X and Y share one hole (i, I)
+/// or particle (a, A) index. The other indices are active
+struct VT2_6_Term {
+    double factor;
+    char x_tensor;
+    std::string x_indices;
+    char y_tensor;
+    std::string y_indices;
+};
+
+/**
+ * @brief Copy the blocks of T(indices) to a dense array with the indices in a given order
+ * @param k the hole or particle index, which runs over the core and active orbitals (hole) or
+ *        the active and virtual orbitals (particle). All the other indices are active
+ * @param space_size the number of orbitals of the core ('c'), active ('a'), and virtual ('v')
+ *        spaces. Missing blocks are left as zero
+ */
+std::vector<double> gather_composite_block(ambit::BlockedTensor& T, const std::string& indices,
+                                           const std::string& order, char k,
+                                           const std::map<char, size_t>& space_size) {
+    const bool hole = std::tolower(k) == 'i';
+    const std::string k_spaces = hole ? "ca" : "av";
+    const size_t nact = space_size.at('a');
+    const size_t K = space_size.at(k_spaces[0]) + space_size.at(k_spaces[1]);
+
+    std::vector<size_t> out_stride(4);
+    for (size_t n = 4, stride = 1; n-- > 0;) {
+        out_stride[n] = stride;
+        stride *= order[n] == k ? K : nact;
+    }
+    std::vector<size_t> stride(4);
+    for (size_t p = 0; p < 4; ++p) {
+        stride[p] = out_stride[order.find(indices[p])];
+    }
+
+    std::vector<double> out(nact * nact * nact * K, 0.0);
+    size_t offset = 0;
+    for (char space : k_spaces) {
+        std::string label;
+        std::vector<size_t> dims;
+        for (char c : indices) {
+            char s = (c == k) ? space : 'a';
+            label += std::isupper(c) ? static_cast<char>(std::toupper(s)) : s;
+            dims.push_back(c == k ? space_size.at(space) : nact);
+        }
+        if (T.is_block(label)) {
+            const auto& data = T.block(label).data();
+            size_t shift = 0;
+            for (size_t p = 0; p < 4; ++p) {
+                if (indices[p] == k)
+                    shift = offset * stride[p];
+            }
+            size_t n = 0;
+            for (size_t p0 = 0; p0 < dims[0]; ++p0) {
+                for (size_t p1 = 0; p1 < dims[1]; ++p1) {
+                    for (size_t p2 = 0; p2 < dims[2]; ++p2) {
+                        const size_t pos =
+                            shift + p0 * stride[0] + p1 * stride[1] + p2 * stride[2];
+                        for (size_t p3 = 0; p3 < dims[3]; ++p3, ++n) {
+                            out[pos + p3 * stride[3]] = data[n];
+                        }
+                    }
+                }
+            }
+        }
+        offset += space_size.at(space);
+    }
+    return out;
+}
+} // namespace
+
+double THREE_DSRG_MRPT2::E_VT2_6_batched(bool sparse) {
+    // The intermediate temp(uvw, xyz) of the CORE algorithm is built one slice A_x(yzuvw) at a
+    // time, where x is the leading index of the cumulant L3(xyzuvw). Each contribution to A_x
+    // is a matrix product of a slice of one of V and T2 (a nact^2 x K matrix, K = number of hole
+    // or particle orbitals) with the other one (K x nact^3). The slices are distributed among the
+    // threads and each thread needs two nact^5 buffers
+    ProfileRegion region("THREE_DSRG_MRPT2::E_VT2_6_batched");
+    const std::map<char, size_t> space_size{{'c', ncore_}, {'a', nactive_}, {'v', nvirtual_}};
+    const size_t na = nactive_;
+    const size_t na2 = na * na;
+    const size_t na3 = na2 * na;
+    const size_t na5 = na3 * na2;
+    const double threshold = foptions_->get_double("THREEPDC_SPARSE_THRESHOLD");
+
+    const size_t thread_memory = 2 * na5 * sizeof(double);
+    const size_t nthreads = std::max<size_t>(
+        1, std::min<size_t>(num_threads_, MemoryManager::instance().budget(0.5) / thread_memory));
+
+    struct SpinCase {
+        double factor;
+        std::string out;
+        std::vector<VT2_6_Term> terms;
+    };
+    // clang-format off
+    std::vector<SpinCase> spin_cases{
+        {0.25, "yzuvw", {{1.0, 'T', "iwxy", 'V', "uviz"},
+                         {1.0, 'V', "waxy", 'T', "uvaz"}}},
+        {0.25, "YZUVW", {{1.0, 'T', "IWXY", 'V', "UVIZ"},
+                         {1.0, 'V', "WAXY", 'T', "UVAZ"}}},
+        {0.50, "yZuvW", {{-1.0, 'T', "iWxZ", 'V', "uviy"},
+                         {-1.0, 'T', "ivxy", 'V', "uWiZ"},
+                         {2.0, 'T', "vIxZ", 'V', "uWyI"},
+                         {1.0, 'V', "aWxZ", 'T', "uvay"},
+                         {-1.0, 'V', "vaxy", 'T', "uWaZ"},
+                         {-2.0, 'V', "vAxZ", 'T', "uWyA"}}},
+        {0.50, "YZuVW", {{-1.0, 'T', "uIxY", 'V', "VWIZ"},
+                         {-1.0, 'V', "uVxI", 'T', "IWYZ"},
+                         {2.0, 'T', "iWxY", 'V', "uViZ"},
+                         {1.0, 'V', "uAxY", 'T', "VWAZ"},
+                         {-1.0, 'T', "uVxA", 'V', "WAYZ"},
+                         {-2.0, 'V', "aWxY", 'T', "uVaZ"}}}};
+    // clang-format on
+
+    double E = 0.0;
+    for (size_t c = 0; c < spin_cases.size(); ++c) {
+        const auto& spin_case = spin_cases[c];
+
+        // the cumulant, dense or sparse
+        ambit::Tensor L3;
+        SparseRDM3 L3_sparse;
+        if (c == 0) {
+            L3 = rdms_.L3aaa();
+        } else if (c == 1) {
+            L3 = rdms_.L3bbb();
+        } else if (c == 2) {
+            L3 = rdms_.L3aab();
+        } else {
+            L3 = rdms_.L3abb();
+        }
+        if (sparse) {
+            L3_sparse = SparseRDM3(L3, threshold);
+            L3 = ambit::Tensor();
+        }
+
+        // the operands of each term, X(x, g1, g2, k) and Y(k, f1, f2, f3), and the strides of
+        // g1, g2, f1, f2, f3 in A_x
+        struct Operands {
+            std::vector<double> X;
+            std::vector<double> Y;
+            size_t K;
+            std::array<size_t, 5> stride;
+        };
+        std::vector<Operands> operands;
+        for (const auto& term : spin_case.terms) {
+            const std::string& xi = term.x_indices;
+            const std::string& yi = term.y_indices;
+            char k = 0;
+            for (char l : xi) {
+                if (yi.find(l) != std::string::npos)
+                    k = l;
+            }
+            std::string g, f;
+            for (size_t p = 0; p < 4; ++p) {
+                if (p != 2 and xi[p] != k)
+                    g += xi[p];
+                if (yi[p] != k)
+                    f += yi[p];
+            }
+            auto& X = term.x_tensor == 'V' ? V_ : T2_;
+            auto& Y = term.y_tensor == 'V' ? V_ : T2_;
+            Operands op;
+            op.X = gather_composite_block(X, xi, std::string(1, xi[2]) + g + k, k, space_size);
+            op.Y = gather_composite_block(Y, yi, std::string(1, k) + f, k, space_size);
+            op.K = op.Y.size() / na3;
+            const std::string free = g + f;
+            for (size_t p = 0; p < 5; ++p) {
+                size_t pos = spin_case.out.find(free[p]);
+                op.stride[p] = 1;
+                for (size_t q = pos + 1; q < 5; ++q) {
+                    op.stride[p] *= na;
+                }
+            }
+            operands.push_back(std::move(op));
+        }
+
+        double Ecase = 0.0;
+#pragma omp parallel num_threads(static_cast<int>(nthreads)) reduction(+ : Ecase)
+        {
+            std::vector<double> P(na5);
+            std::vector<double> A(na5);
+#pragma omp for schedule(dynamic)
+            for (size_t x = 0; x < na; ++x) {
+                if (sparse and L3_sparse.empty_block(x))
+                    continue;
+                std::fill(A.begin(), A.end(), 0.0);
+                for (size_t t = 0; t < operands.size(); ++t) {
+                    auto& op = operands[t];
+                    if (op.K == 0)
+                        continue;
+                    // P(g1 g2, f1 f2 f3) = X_x(g1 g2, k) Y(k, f1 f2 f3)
+                    const int K = static_cast<int>(op.K);
+                    C_DGEMM('N', 'N', static_cast<int>(na2), static_cast<int>(na3), K, 1.0,
+                            op.X.data() + x * na2 * op.K, K, op.Y.data(), static_cast<int>(na3),
+                            0.0, P.data(), static_cast<int>(na3));
+                    const double factor = spin_case.terms[t].factor;
+                    const auto& s = op.stride;
+                    size_t n = 0;
+                    for (size_t g1 = 0; g1 < na; ++g1) {
+                        for (size_t g2 = 0; g2 < na; ++g2) {
+                            for (size_t f1 = 0; f1 < na; ++f1) {
+                                for (size_t f2 = 0; f2 < na; ++f2) {
+                                    double* a = A.data() + g1 * s[0] + g2 * s[1] + f1 * s[2] +
+                                                f2 * s[3];
+                                    for (size_t f3 = 0; f3 < na; ++f3, ++n) {
+                                        a[f3 * s[4]] += factor * P[n];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+                if (sparse) {
+                    Ecase += L3_sparse.dot_block(x, A.data());
+                } else {
+                    const double* L3_x = L3.data().data() + x * na5;
+                    for (size_t n = 0; n < na5; ++n) {
+                        Ecase += A[n] * L3_x[n];
+                    }
+                }
+            }
+        }
+        E += spin_case.factor * Ecase;
+    }
+    return E;
+}
+
 double THREE_DSRG_MRPT2::E_VT2_2_fly_openmp() {
+    ProfileRegion region("THREE_DSRG_MRPT2::E_VT2_2_fly_openmp");
     double Eflyalpha = 0.0;
     double Eflybeta = 0.0;
     double Eflymixed = 0.0;
@@ -1764,6 +1879,7 @@ double THREE_DSRG_MRPT2::E_VT2_2_fly_openmp() {
 }
 
 double THREE_DSRG_MRPT2::E_VT2_2_ambit() {
+    ProfileRegion region("THREE_DSRG_MRPT2::E_VT2_2_ambit");
     /**
      * Compute <[V, T2]> (C_2)^4 ccvv term
      * E = 0.25 * <mn||ef> * <mn||ef> * [1 - e^(-2 * s * D)] / D
@@ -2009,6 +2125,7 @@ double THREE_DSRG_MRPT2::E_VT2_2_ambit() {
 }
 
 double THREE_DSRG_MRPT2::E_VT2_2_batch_core() {
+    ProfileRegion region("THREE_DSRG_MRPT2::E_VT2_2_batch_core");
     bool debug_print = foptions_->get_bool("DSRG_MRPT2_DEBUG");
     double Ealpha = 0.0;
     double Emixed = 0.0;
@@ -2244,6 +2361,134 @@ double THREE_DSRG_MRPT2::E_VT2_2_batch_core() {
     return (Ealpha + Ebeta + Emixed);
 }
 
+double THREE_DSRG_MRPT2::E_VT2_2_auto() {
+    int nthread = 1;
+#ifdef _OPENMP
+    nthread = omp_get_max_threads();
+#endif
+    // memory (in doubles) for the B blocks and the (o1 i1|o2 i2) intermediates
+    size_t memory = psi::Process::environment.get_memory() * 0.75 / sizeof(double);
+
+    // memory per outer orbital in a batch: two B(Q|oi) blocks and one M(i, o2 i) matrix
+    auto batch_size = [&](size_t no, size_t ni) {
+        size_t per_orbital = 2 * nthree_ * ni + ni * ni;
+        return std::max(size_t(1), std::min(no, memory / std::max(per_orbital, size_t(1))));
+    };
+    size_t core_batch = batch_size(ncore_, nvirtual_);
+    size_t virt_batch = batch_size(nvirtual_, ncore_);
+    size_t core_passes = (ncore_ + core_batch - 1) / core_batch;
+    size_t virt_passes = (nvirtual_ + virt_batch - 1) / virt_batch;
+
+    // Core-outer gives the largest DGEMMs (V x nV x Q) and is used unless virtual-outer needs
+    // fewer passes over B (i.e., when B does not fit in memory and there are few virtuals)
+    bool core_outer = core_passes <= virt_passes;
+
+    size_t batch = core_outer ? core_batch : virt_batch;
+    size_t nouter = core_outer ? ncore_ : nvirtual_;
+    int user_batches = foptions_->get_int("CCVV_BATCH_NUMBER");
+    if (user_batches > 0) {
+        batch = std::max(size_t(1), (nouter + user_batches - 1) / user_batches);
+    }
+
+    outfile->Printf("\n    CCVV AUTO: %s-outer batches of %zu orbitals (%zu batches, %d threads)",
+                    core_outer ? "core" : "virtual", batch, (nouter + batch - 1) / batch,
+                    nthread);
+    return E_VT2_2_batched(core_outer, batch);
+}
+
+double THREE_DSRG_MRPT2::E_VT2_2_batched(bool core_outer, size_t batch_size) {
+    ProfileRegion region("THREE_DSRG_MRPT2::E_VT2_2_batched");
+    const std::vector<size_t>& outer = core_outer ? core_mos_ : virt_mos_;
+    const std::vector<size_t>& inner = core_outer ? virt_mos_ : core_mos_;
+    const size_t no = outer.size();
+    const size_t ni = inner.size();
+    // D = Fa[m] + Fa[n] - Fa[e] - Fa[f] = sign * (F[o1] + F[o2] - F[i1] - F[i2])
+    const double sign = core_outer ? 1.0 : -1.0;
+    if (no == 0 or ni == 0)
+        return 0.0;
+
+    std::vector<double> Fao(no), Fbo(no), Fai(ni), Fbi(ni);
+    for (size_t o = 0; o < no; ++o) {
+        Fao[o] = Fa_[outer[o]];
+        Fbo[o] = Fb_[outer[o]];
+    }
+    for (size_t i = 0; i < ni; ++i) {
+        Fai[i] = Fa_[inner[i]];
+        Fbi[i] = Fb_[inner[i]];
+    }
+
+    auto read_block = [&](size_t start, size_t size) {
+        std::vector<size_t> batch(outer.begin() + start, outer.begin() + start + size);
+        // B(Q|o i), stored as Q x (o i)
+        return ints_->three_integral_block(aux_mos_, batch, inner);
+    };
+
+    double Ealpha = 0.0;
+    double Emixed = 0.0;
+    const size_t nbatch = (no + batch_size - 1) / batch_size;
+    std::vector<double> M(ni * batch_size * ni);
+
+    for (size_t b1 = 0; b1 < nbatch; ++b1) {
+        const size_t start1 = b1 * batch_size;
+        const size_t size1 = std::min(batch_size, no - start1);
+        ambit::Tensor B1 = read_block(start1, size1);
+        const double* B1p = B1.data().data();
+
+        for (size_t b2 = 0; b2 <= b1; ++b2) {
+            const size_t start2 = b2 * batch_size;
+            const size_t size2 = std::min(batch_size, no - start2);
+            ambit::Tensor B2 = (b2 == b1) ? B1 : read_block(start2, size2);
+            const double* B2p = B2.data().data();
+
+            for (size_t o1 = 0; o1 < size1; ++o1) {
+                // only pairs o2 <= o1 are computed, the others are included by the factor 2
+                const size_t n2 = (b2 == b1) ? o1 + 1 : size2;
+
+                // M(i1, o2 i2) = sum_Q B(Q|o1 i1) B(Q|o2 i2), threaded DGEMM
+                C_DGEMM('T', 'N', ni, n2 * ni, nthree_, 1.0, const_cast<double*>(B1p) + o1 * ni,
+                        size1 * ni, const_cast<double*>(B2p), size2 * ni, 0.0, M.data(),
+                        n2 * ni);
+
+                // fused pass over (o2, i1) that applies the denominators to each row of M
+                // while it is in cache
+                const size_t a = start1 + o1;
+#pragma omp parallel reduction(+ : Ealpha, Emixed)
+                {
+                    std::vector<double> Daa(ni), Dab(ni), waa(ni), wab(ni);
+#pragma omp for schedule(dynamic)
+                    for (size_t o2i1 = 0; o2i1 < n2 * ni; ++o2i1) {
+                        const size_t o2 = o2i1 / ni;
+                        const size_t i1 = o2i1 % ni;
+                        const size_t c = start2 + o2;
+                        const double factor = (a == c) ? 1.0 : 2.0;
+                        const double Faa = Fao[a] + Fao[c] - Fai[i1];
+                        const double Fab = Fao[a] + Fbo[c] - Fai[i1];
+                        for (size_t i2 = 0; i2 < ni; ++i2) {
+                            Daa[i2] = sign * (Faa - Fai[i2]);
+                            Dab[i2] = sign * (Fab - Fbi[i2]);
+                        }
+                        dsrg_source_->compute_energy_weights(Daa.data(), waa.data(), ni);
+                        dsrg_source_->compute_energy_weights(Dab.data(), wab.data(), ni);
+
+                        const double* Mrow = M.data() + i1 * n2 * ni + o2 * ni;
+                        double ea = 0.0;
+                        double em = 0.0;
+                        for (size_t i2 = 0; i2 < ni; ++i2) {
+                            const double v = Mrow[i2];
+                            const double vx = M[i2 * n2 * ni + o2 * ni + i1];
+                            ea += (v * v - v * vx) * waa[i2];
+                            em += v * v * wab[i2];
+                        }
+                        Ealpha += factor * ea;
+                        Emixed += factor * em;
+                    }
+                }
+            }
+        }
+    }
+    return Ealpha + Emixed;
+}
+
 double THREE_DSRG_MRPT2::E_VT2_2_AO_Slow() {
     /// E_{DSRG} -> Conventional basis
 
@@ -2362,6 +2607,7 @@ double THREE_DSRG_MRPT2::E_VT2_2_AO_Slow() {
     return (0.25 * Ealpha + 0.25 * Ebeta + Emixed);
 }
 double THREE_DSRG_MRPT2::E_VT2_2_batch_virtual() {
+    ProfileRegion region("THREE_DSRG_MRPT2::E_VT2_2_batch_virtual");
     bool debug_print = foptions_->get_bool("DSRG_MRPT2_DEBUG");
     double Ealpha = 0.0;
     double Emixed = 0.0;
@@ -201,6 +201,19 @@ class THREE_DSRG_MRPT2 : public MASTER_DSRG {
     double E_VT2_2_batch_core();
     /// batch_core Reads only E*F (where M and N are size of virtual batches)
     double E_VT2_2_batch_virtual();
+    /// auto -> Chooses the outer index (core or virtual) and the batch size from the memory,
+    /// the number of threads, and the DF rank, then calls E_VT2_2_batched
+    double E_VT2_2_auto();
+    /**
+     * @brief Batched ccvv term with one threaded DGEMM per outer index and a fused energy pass
+     * @param core_outer if true the outer pair is (m,n) and the inner (e,f), else the opposite
+     * @param batch_size the number of outer orbitals whose B(Q|oi) are held in memory at once
+     *
+     * For each outer pair (o1, o2), M_{i1,i2} = (o1 i1|o2 i2) is obtained from
+     * B(Q|o1 i1)^T B(Q|o2 i2), for all o2 in a batch with a single DGEMM. The exchange integral
+     * is the transpose of M in both cases.
+     */
+    double E_VT2_2_batched(bool core_outer, size_t batch_size);
     /// Core MPI parallel algorithms (MPI -> distriubuted B)
     /// ga->distrubuted B with Global Arrays API
     /// rep->Broadcast B (debug version)
@@ -215,6 +228,9 @@ class THREE_DSRG_MRPT2 : public MASTER_DSRG {
     double E_VT2_4HH();
     double E_VT2_4PH();
     double E_VT2_6();
+    /// The [V, T2] λ3 term batched over the leading index of the cumulant and threaded over the
+    /// batches (THREEPDC_ALGORITHM BATCH). If sparse, the thresholded cumulants are used
+    double E_VT2_6_batched(bool sparse);
 
     void de_normal_order();
 
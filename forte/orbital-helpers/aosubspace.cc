@@ -43,6 +43,7 @@ namespace py = pybind11;
 #include "psi4/libmints/petitelist.h"
 #include "psi4/libmints/vector.h"
 #include "psi4/libmints/wavefunction.h"
+#include "psi4/libqt/qt.h"
 #include "psi4/masses.h"
 
 #include "boost/format.hpp"
@@ -97,23 +98,27 @@ psi::SharedMatrix make_aosubspace_projector(psi::SharedWavefunction wfn,
     // Create an AOSubspace object
     AOSubspace aosub(subspace_str, molecule, min_basis, atom_to_normal);
 
-    // build the projector
-    Ps = aosub.build_projector(wfn->basisset());
+    // build the projector from its low-rank factor
+    auto Xso = aosub.build_projector_factor(wfn->basisset());
+    Ps = psi::linalg::doublet(Xso, Xso, true, false);
+    Ps->set_name("PSO");
 
-    // print the overlap of the projector
-    psi::SharedMatrix CPsC = Ps->clone();
-    CPsC->transform(wfn->Ca());
+    // print the overlap of the projector: <phi|P|phi> = |Xso phi|^2
+    auto XC = psi::linalg::doublet(Xso, wfn->Ca(), false, false);
     double print_threshold = 1.0e-3;
     auto irrep_labels = molecule->irrep_labels();
     outfile->Printf("\n  ==> Orbital Overlap with AO Subspace (> %.2e) <==\n", print_threshold);
     outfile->Printf("\n    =======================");
     outfile->Printf("\n    Irrep   MO  <phi|P|phi>");
     outfile->Printf("\n    -----------------------");
-    for (int h = 0, nirrep = CPsC->nirrep(); h < nirrep; h++) {
-        for (int i = 0, size = CPsC->rowspi(h); i < size; i++) {
-            if (CPsC->get(h, i, i) > print_threshold) {
-                outfile->Printf("\n    %4s  %4d  %10.6f", irrep_labels[h].c_str(), i + 1,
-                                CPsC->get(h, i, i));
+    for (int h = 0, nirrep = XC->nirrep(); h < nirrep; h++) {
+        for (int i = 0, size = XC->colspi(h); i < size; i++) {
+            double overlap = 0.0;
+            for (int s = 0, nsub = XC->rowspi(h); s < nsub; s++) {
+                overlap += XC->get(h, s, i) * XC->get(h, s, i);
+            }
+            if (overlap > print_threshold) {
+                outfile->Printf("\n    %4s  %4d  %10.6f", irrep_labels[h].c_str(), i + 1, overlap);
             }
         }
     }
@@ -391,6 +396,17 @@ bool AOSubspace::parse_subspace_entry(const std::string& s) {
 
 std::shared_ptr<psi::Matrix>
 AOSubspace::build_projector(const std::shared_ptr<psi::BasisSet>& large_basis) {
+    auto Xso = build_projector_factor(large_basis);
+    auto Pso = psi::linalg::doublet(Xso, Xso, true, false);
+    Pso->set_name("PSO");
+    if (debug_) {
+        Pso->print();
+    }
+    return Pso;
+}
+
+std::shared_ptr<psi::Matrix>
+AOSubspace::build_projector_factor(const std::shared_ptr<psi::BasisSet>& large_basis) {
     // compute the overlap matrix between minimal (MINAO) orbitals
     auto ints_mm =
         std::make_unique<IntegralFactory>(min_basis_, min_basis_, min_basis_, min_basis_);
@@ -440,8 +456,14 @@ AOSubspace::build_projector(const std::shared_ptr<psi::BasisSet>& large_basis) {
     auto Sml = std::make_shared<psi::Matrix>("Sml", nbf_m, nbf_l);
     ao_ml->compute(Sml);
 
-    auto Ssl = psi::linalg::doublet(Cms, Sml, true, false);
-    Ssl->set_name("Ssl");
+    // Ssl = Cms^T Sml, only the MINAO functions in the subspace contribute
+    auto Ssl = std::make_shared<psi::Matrix>("Ssl", nbf_s, nbf_l);
+    for (const auto& tup : subspace_) {
+        int m, s;
+        double c;
+        std::tie(m, s, c) = tup;
+        C_DAXPY(nbf_l, c, Sml->pointer()[m], 1, Ssl->pointer()[s], 1);
+    }
     if (debug_) {
         Ssl->print();
     }
@@ -457,25 +479,29 @@ AOSubspace::build_projector(const std::shared_ptr<psi::BasisSet>& large_basis) {
         Sss_clone->print();
     }
 
-    auto Pao = psi::linalg::doublet(Xsl, Xsl, true, false);
-    Pao->set_name("PAO");
-    if (debug_) {
-        Pao->print();
-    }
-
-    // transform AO projector to account for symmetry
+    // transform the factor to the SO basis: Xso_h = Xsl U_h, so that Pso_h = U_h^T Pao U_h
     auto ints_ll =
         std::make_shared<IntegralFactory>(large_basis, large_basis, large_basis, large_basis);
     auto plist = std::make_unique<psi::PetiteList>(large_basis, ints_ll);
     auto ao_to_so = plist->aotoso();
 
     auto dim = plist->SO_basisdim();
-    auto Pso = std::make_shared<psi::Matrix>("PSO", dim, dim);
-    Pso->apply_symmetry(Pao, ao_to_so);
+    int nirrep = dim.n();
+    psi::Dimension subpi(nirrep);
+    for (int h = 0; h < nirrep; ++h) {
+        subpi[h] = nbf_s;
+    }
+    auto Xso = std::make_shared<psi::Matrix>("Xso", subpi, dim);
+    for (int h = 0; h < nirrep; ++h) {
+        if (dim[h] == 0 or nbf_s == 0)
+            continue;
+        C_DGEMM('N', 'N', nbf_s, dim[h], nbf_l, 1.0, Xsl->pointer()[0], nbf_l,
+                ao_to_so->pointer(h)[0], dim[h], 0.0, Xso->pointer(h)[0], dim[h]);
+    }
     if (debug_) {
-        Pso->print();
+        Xso->print();
     }
 
-    return Pso;
+    return Xso;
 }
 } // namespace forte
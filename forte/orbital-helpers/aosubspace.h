@@ -170,6 +170,12 @@ class AOSubspace {
     /// @return: the projector in SO basis
     std::shared_ptr<psi::Matrix> build_projector(const std::shared_ptr<psi::BasisSet>& large_basis);
 
+    /// Build the factor Xso = Sss^-1/2 Ssl of the projector, so that Pso = Xso^T Xso
+    /// @param large_basis: the large computational basis set
+    /// @return: the factor with one row per subspace orbital (in each irrep) and SO columns
+    std::shared_ptr<psi::Matrix>
+    build_projector_factor(const std::shared_ptr<psi::BasisSet>& large_basis);
+
   private:
     /// The vector of subspace descriptors passed by the user
     std::vector<std::string> subspace_str_;
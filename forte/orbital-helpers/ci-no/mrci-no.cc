@@ -483,38 +483,30 @@ MRCINO::diagonalize_hamiltonian(const std::vector<Determinant>& dets, int nsolut
 /// Build the density matrix
 std::pair<psi::SharedMatrix, psi::SharedMatrix>
 MRCINO::build_density_matrix(const std::vector<Determinant>& dets, psi::SharedMatrix evecs, int n) {
-    std::vector<double> average_a_(ncmo2_);
-    std::vector<double> average_b_(ncmo2_);
-    std::vector<double> template_a_;
-    std::vector<double> template_b_;
     std::vector<double> ordm_a_(ncmo2_);
     std::vector<double> ordm_b_(ncmo2_);
 
-    for (int i = 0; i < n; ++i) {
-        template_a_.clear();
-        template_b_.clear();
-
-        CI_RDMS ci_rdms_(fci_ints_, dets, evecs, i, i);
-        ci_rdms_.set_max_rdm(rdm_level_);
-        if (rdm_level_ >= 1) {
-            local_timer one_r;
-            ci_rdms_.compute_1rdm(template_a_, template_b_);
-            outfile->Printf("\n  1-RDM  took %2.6f s (determinant)", one_r.get());
-        }
-        // Add template value to average vector
-        for (size_t i = 0; i < ncmo2_; ++i) {
-            average_a_[i] += template_a_[i];
+    if (rdm_level_ >= 1) {
+        // Compute the 1-RDMs of all the solutions in one threaded sweep over coupling lists
+        // that are built only once
+        local_timer one_r;
+        DeterminantHashVec detmap(dets);
+        CI_RDMS ci_rdms_(detmap, fci_ints_, evecs, 0, 0);
+        std::vector<std::pair<size_t, size_t>> root_pairs;
+        for (int i = 0; i < n; ++i) {
+            root_pairs.emplace_back(i, i);
         }
-        for (size_t i = 0; i < ncmo2_; ++i) {
-            average_b_[i] += template_b_[i];
+        std::vector<std::array<std::vector<double>, 5>> rdms;
+        ci_rdms_.compute_rdms_op_root_pairs(root_pairs, 1, rdms);
+
+        // Average over the solutions
+        for (const auto& rdm : rdms) {
+            for (size_t i = 0; i < ncmo2_; ++i) {
+                ordm_a_[i] += rdm[0][i] / n;
+                ordm_b_[i] += rdm[1][i] / n;
+            }
         }
-    }
-    // Divided by the number of solutions
-    for (size_t i = 0; i < ncmo2_; ++i) {
-        ordm_a_[i] = average_a_[i] / n;
-    }
-    for (size_t i = 0; i < ncmo2_; ++i) {
-        ordm_b_[i] = average_b_[i] / n;
+        outfile->Printf("\n  1-RDM  took %2.6f s (%d solutions)", one_r.get(), n);
     }
     // Invert vector to matrix
     //    psi::Dimension nmopi = reference_wavefunction_->nmopi();
@@ -25,7 +25,9 @@
  *
  * @END LICENSE
  */
+#include <cmath>
 #include <map>
+#include <mutex>
 #include <numeric>
 #include <regex>
 #include <vector>
@@ -48,6 +50,35 @@ using namespace psi;
 
 namespace forte {
 
+namespace {
+/// The projector of the last call, keyed by the fragment definition and the geometry
+struct FragmentProjectorCache {
+    std::string basis_name;
+    int nbf = -1;
+    int natom_A = -1;
+    int nbf_A = -1;
+    psi::SharedMatrix geometry;
+    psi::SharedMatrix Pf;
+    /// serializes the calls that read and update the cache
+    std::mutex mutex;
+};
+FragmentProjectorCache projector_cache;
+
+bool same_geometry(const psi::Matrix& g1, const psi::Matrix& g2) {
+    if ((g1.rowspi(0) != g2.rowspi(0)) or (g1.colspi(0) != g2.colspi(0))) {
+        return false;
+    }
+    for (int i = 0; i < g1.rowspi(0); ++i) {
+        for (int j = 0; j < g1.colspi(0); ++j) {
+            if (std::fabs(g1.get(i, j) - g2.get(i, j)) > 1.0e-12) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
 std::pair<psi::SharedMatrix, int> make_fragment_projector(SharedWavefunction wfn,
                                                           std::shared_ptr<ForteOptions> options) {
     // Run this code only if user specified fragments
@@ -69,9 +100,28 @@ std::pair<psi::SharedMatrix, int> make_fragment_projector(SharedWavefunction wfn
     // Create a fragmentprojector with the second constructor if we want to project to minAO or use
     // IAO procedure FragmentProjector FP(molecule, prime_basis, minao_basis);
 
-    // Compute and return the projector matrix
-    psi::SharedMatrix Pf = FP.build_f_projector(prime_basis);
+    // Reuse the projector of the previous call if the fragment definition and the geometry did
+    // not change (the caller transforms Pf in place, so always hand out a copy)
     int nbfA = FP.get_nbf_A();
+    psi::Matrix geometry = molecule->geometry();
+    auto& cache = projector_cache;
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    psi::SharedMatrix Pf;
+    if (cache.Pf and (cache.basis_name == prime_basis->name()) and
+        (cache.nbf == prime_basis->nbf()) and (cache.natom_A == FP.get_natom_A()) and
+        (cache.nbf_A == nbfA) and same_geometry(*cache.geometry, geometry)) {
+        outfile->Printf("\n  Reusing the fragment projector of the previous call.\n");
+        Pf = cache.Pf->clone();
+    } else {
+        // Compute and return the projector matrix
+        Pf = FP.build_f_projector(prime_basis);
+        cache.basis_name = prime_basis->name();
+        cache.nbf = prime_basis->nbf();
+        cache.natom_A = FP.get_natom_A();
+        cache.nbf_A = nbfA;
+        cache.geometry = std::make_shared<psi::Matrix>(geometry);
+        cache.Pf = Pf->clone();
+    }
     std::pair<psi::SharedMatrix, int> Projector = std::make_pair(Pf, nbfA);
 
     return Projector;
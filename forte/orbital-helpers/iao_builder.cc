@@ -27,6 +27,10 @@
 
 #include <algorithm>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "boost/format.hpp"
 
 #include "psi4/psi4-dec.h"
@@ -97,6 +101,7 @@ std::shared_ptr<IAOBuilder> IAOBuilder::build(std::shared_ptr<psi::BasisSet> pri
 
     std::vector<int> stars;
 
+    py::gil_scoped_acquire gil;
     py::list rotate_mos_list = options->get_gen_list("LOCAL_IBO_STARS");
     for (size_t ind = 0; ind < rotate_mos_list.size(); ind++) {
         stars.push_back(py::cast<int>(rotate_mos_list[ind]) - 1);
@@ -164,6 +169,7 @@ std::map<std::string, psi::SharedMatrix> IAOBuilder::build_iaos() {
 
     double** S12p = S12->pointer();
     double** S12fp = S12f->pointer();
+#pragma omp parallel for
     for (int m = 0; m < primary_->nbf(); m++) {
         for (size_t p = 0; p < true_iaos_.size(); p++) {
             S12p[m][p] = S12fp[m][true_iaos_[p]];
@@ -172,6 +178,7 @@ std::map<std::string, psi::SharedMatrix> IAOBuilder::build_iaos() {
 
     double** S22p = S22->pointer();
     double** S22fp = S22f->pointer();
+#pragma omp parallel for
     for (size_t p = 0; p < true_iaos_.size(); p++) {
         for (size_t q = 0; q < true_iaos_.size(); q++) {
             S22p[p][q] = S22fp[true_iaos_[p]][true_iaos_[q]];
@@ -181,18 +188,31 @@ std::map<std::string, psi::SharedMatrix> IAOBuilder::build_iaos() {
     // => Metric Inverses <= //
 
     psi::SharedMatrix S11_m12(S11->clone());
-    psi::SharedMatrix S22_m12(S22->clone());
     S11_m12->copy(S11);
-    S22_m12->copy(S22);
     S11_m12->power(-1.0 / 2.0, condition_);
-    S22_m12->power(-1.0 / 2.0, condition_);
+
+    // The minimal-basis projector S12 S22^-1 S21 is applied through the Cholesky factor of the
+    // (well conditioned) minimal-basis overlap: W = S12 S22^-1 is obtained by solving
+    // S22 W^T = S21 with the factor, so no nbf x nbf intermediate is formed
+    int nmin = static_cast<int>(true_iaos_.size());
+    int nbf = primary_->nbf();
+    psi::SharedMatrix W(S12->clone());
+    if (nmin > 0) {
+        psi::SharedMatrix S22_chol(S22->clone());
+        int info = C_DPOTRF('L', nmin, S22_chol->pointer()[0], nmin);
+        if (info != 0) {
+            throw psi::PSIEXCEPTION("IAO: the minimal basis overlap is not positive definite.");
+        }
+        // In column-major order the rows of W are the columns of S21
+        C_DPOTRS('L', nmin, nbf, S22_chol->pointer()[0], nmin, W->pointer()[0], nmin);
+    }
 
     // => Tilde C <= //
 
     psi::SharedMatrix C = C_;
-    psi::SharedMatrix T1 = psi::linalg::doublet(S22_m12, S12, false, true);
     psi::SharedMatrix T2 = psi::linalg::doublet(
-        S11_m12, psi::linalg::triplet(T1, T1, C, true, false, false), false, false);
+        S11_m12, psi::linalg::doublet(W, psi::linalg::doublet(S12, C, true, false)), false,
+        false);
     psi::SharedMatrix T3 = psi::linalg::doublet(T2, T2, true, false);
     T3->power(-1.0 / 2.0, condition_);
     psi::SharedMatrix Ctilde = psi::linalg::triplet(S11_m12, T2, T3, false, false, false);
@@ -482,11 +502,28 @@ IAOBuilder::ibo_localizer(psi::SharedMatrix L, const std::vector<std::vector<int
     if (power != 2 && power != 4)
         throw psi::PSIEXCEPTION("IAO: Invalid metric power.");
 
+    // Group the rotations in batches of disjoint pairs. Each pair is placed in the first batch
+    // after the last ones that touch i or j, so the rotations within a batch act on different
+    // rows of L and U and can be carried out concurrently.
+    std::vector<std::vector<std::pair<int, int>>> batches;
+    {
+        std::vector<size_t> next_batch(nocc, 0);
+        for (const auto& ij : rot_inds) {
+            size_t b = std::max(next_batch[ij.first], next_batch[ij.second]);
+            if (b == batches.size()) {
+                batches.emplace_back();
+            }
+            batches[b].push_back(ij);
+            next_batch[ij.first] = next_batch[ij.second] = b + 1;
+        }
+    }
+
     outfile->Printf("    @IBO %4s: %24s %14s\n", "Iter", "Metric", "Gradient");
 
     for (int iter = 1; iter <= maxiter; iter++) {
 
         double metric = 0.0;
+#pragma omp parallel for reduction(+ : metric)
         for (int i = 0; i < nocc; i++) {
             for (size_t A = 0; A < minao_inds.size(); A++) {
                 double Lval = 0.0;
@@ -500,40 +537,43 @@ IAOBuilder::ibo_localizer(psi::SharedMatrix L, const std::vector<std::vector<int
         metric = pow(metric, 1.0 / power);
 
         double gradient = 0.0;
-        for (size_t ind = 0; ind < rot_inds.size(); ind++) {
-            int i = rot_inds[ind].first;
-            int j = rot_inds[ind].second;
-
-            double Aij = 0.0;
-            double Bij = 0.0;
-            for (size_t A = 0; A < minao_inds.size(); A++) {
-                double Qii = 0.0;
-                double Qij = 0.0;
-                double Qjj = 0.0;
-                for (size_t m = 0; m < minao_inds[A].size(); m++) {
-                    int mind = minao_inds[A][m];
-                    Qii += Lp[i][mind] * Lp[i][mind];
-                    Qij += Lp[i][mind] * Lp[j][mind];
-                    Qjj += Lp[j][mind] * Lp[j][mind];
+        for (const auto& batch : batches) {
+#pragma omp parallel for schedule(dynamic) reduction(+ : gradient)
+            for (size_t ind = 0; ind < batch.size(); ind++) {
+                int i = batch[ind].first;
+                int j = batch[ind].second;
+
+                double Aij = 0.0;
+                double Bij = 0.0;
+                for (size_t A = 0; A < minao_inds.size(); A++) {
+                    double Qii = 0.0;
+                    double Qij = 0.0;
+                    double Qjj = 0.0;
+                    for (size_t m = 0; m < minao_inds[A].size(); m++) {
+                        int mind = minao_inds[A][m];
+                        Qii += Lp[i][mind] * Lp[i][mind];
+                        Qij += Lp[i][mind] * Lp[j][mind];
+                        Qjj += Lp[j][mind] * Lp[j][mind];
+                    }
+                    if (power == 2) {
+                        Aij += 4.0 * Qij * Qij - (Qii - Qjj) * (Qii - Qjj);
+                        Bij += 4.0 * Qij * (Qii - Qjj);
+                    } else {
+                        Aij += (-1.0) * Qii * Qii * Qii * Qii - Qjj * Qjj * Qjj * Qjj +
+                               6.0 * (Qii * Qii + Qjj * Qjj) * Qij * Qij + Qii * Qii * Qii * Qjj +
+                               Qii * Qjj * Qjj * Qjj;
+                        Bij += 4.0 * Qij * (Qii * Qii * Qii - Qjj * Qjj * Qjj);
+                    }
                 }
-                if (power == 2) {
-                    Aij += 4.0 * Qij * Qij - (Qii - Qjj) * (Qii - Qjj);
-                    Bij += 4.0 * Qij * (Qii - Qjj);
-                } else {
-                    Aij += (-1.0) * Qii * Qii * Qii * Qii - Qjj * Qjj * Qjj * Qjj +
-                           6.0 * (Qii * Qii + Qjj * Qjj) * Qij * Qij + Qii * Qii * Qii * Qjj +
-                           Qii * Qjj * Qjj * Qjj;
-                    Bij += 4.0 * Qij * (Qii * Qii * Qii - Qjj * Qjj * Qjj);
-                }
-            }
-            double phi = 0.25 * atan2(Bij, -Aij);
-            double c = cos(phi);
-            double s = sin(phi);
+                double phi = 0.25 * atan2(Bij, -Aij);
+                double c = cos(phi);
+                double s = sin(phi);
 
-            C_DROT(nmin, Lp[i], 1, Lp[j], 1, c, s);
-            C_DROT(nocc, Up[i], 1, Up[j], 1, c, s);
+                C_DROT(nmin, Lp[i], 1, Lp[j], 1, c, s);
+                C_DROT(nocc, Up[i], 1, Up[j], 1, c, s);
 
-            gradient += Bij * Bij;
+                gradient += Bij * Bij;
+            }
         }
         gradient = sqrt(gradient);
 
@@ -777,6 +817,8 @@ psi::SharedMatrix IAOBuilder::orbital_charges(psi::SharedMatrix L) {
     psi::SharedMatrix Q(new psi::Matrix("Q", natom, nocc));
     double** Qp = Q->pointer();
 
+    // Each orbital fills its own column of Q
+#pragma omp parallel for
     for (int i = 0; i < nocc; i++) {
         for (int m = 0; m < nmin; m++) {
             Qp[iaos_to_atoms_[m]][i] += Lp[i][m] * Lp[i][m];
@@ -26,16 +26,27 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/matrix.h"
 #include "psi4/libmints/vector.h"
+#include "psi4/libmints/basisset.h"
+#include "psi4/libmints/molecule.h"
+#include "psi4/libqt/qt.h"
 
 #include "helpers/printing.h"
 #include "base_classes/rdms.h"
 
 #include "localize.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace psi;
 
 namespace forte {
@@ -50,10 +61,14 @@ Localize::Localize(std::shared_ptr<ForteOptions> options, std::shared_ptr<ForteI
 
     orbital_spaces_ = options->get_int_list("LOCALIZE_SPACE");
     local_method_ = options->get_str("LOCALIZE");
+    local_engine_ = options->get_str("LOCALIZE_ENGINE");
+    maxiter_ = options->get_int("LOCALIZE_MAXITER");
+    conv_ = options->get_double("LOCALIZE_CONVERGENCE");
 
     print_h2("Orbital Localizer");
 
     outfile->Printf("\n  Localize method: %s", local_method_.c_str());
+    outfile->Printf("\n  Localize engine: %s", local_engine_.c_str());
 }
 
 void Localize::set_orbital_space(std::vector<int>& orbital_spaces) {
@@ -117,14 +132,17 @@ void Localize::compute_transformation() {
             Ca_loc->set_column(0, i, col);
         }
 
-        // localize
-        std::shared_ptr<psi::BasisSet> primary = ints_->wfn()->basisset();
-        std::shared_ptr<psi::Localizer> loc_a =
-            psi::Localizer::build(local_method_, primary, Ca_loc);
-        loc_a->localize();
-
-        // Grab the transformation and localized matrices
-        psi::SharedMatrix Ua_loc = loc_a->U();
+        // localize and grab the transformation matrix
+        psi::SharedMatrix Ua_loc;
+        if (local_engine_ == "FORTE") {
+            Ua_loc = jacobi_localize(Ca_loc);
+        } else {
+            std::shared_ptr<psi::BasisSet> primary = ints_->wfn()->basisset();
+            std::shared_ptr<psi::Localizer> loc_a =
+                psi::Localizer::build(local_method_, primary, Ca_loc);
+            loc_a->localize();
+            Ua_loc = loc_a->U();
+        }
 
         // Set Ua, Ub
         for (size_t i = 0; i < orb_dim; ++i) {
@@ -136,6 +154,159 @@ void Localize::compute_transformation() {
     }
 }
 
+psi::SharedMatrix Localize::jacobi_localize(psi::SharedMatrix C) {
+    const size_t nbf = C->rowdim();
+    const size_t norb = C->coldim();
+    const bool boys = local_method_ == "BOYS";
+
+    // Boys: maximize sum_i sum_x <i|x|i>^2 with the AO dipole integrals
+    // Pipek-Mezey: maximize sum_i sum_A (Q^A_ii)^2 with the Mulliken charges
+    // Q^A_ij = 1/2 sum_{mu in A} [C_mu,i (SC)_mu,j + C_mu,j (SC)_mu,i]
+    std::vector<psi::SharedMatrix> ao_ops;
+    if (boys) {
+        ao_ops = ints_->ao_dipole_ints();
+    } else {
+        ao_ops.push_back(ints_->wfn()->S());
+    }
+    const size_t nops = ao_ops.size();
+
+    std::shared_ptr<psi::BasisSet> primary = ints_->wfn()->basisset();
+    const size_t natom = primary->molecule()->natom();
+    std::vector<size_t> bf_to_atom(nbf);
+    for (size_t mu = 0; mu < nbf; ++mu) {
+        bf_to_atom[mu] = primary->function_to_center(mu);
+    }
+
+    // All quantities are stored orbital-major, so that a rotation of the pair (i,j) only
+    // touches the rows i and j. Disjoint pairs can then be rotated concurrently.
+    std::vector<double> Ct(norb * nbf);
+    for (size_t mu = 0; mu < nbf; ++mu) {
+        for (size_t i = 0; i < norb; ++i) {
+            Ct[i * nbf + mu] = C->get(mu, i);
+        }
+    }
+    // OCt[k] = (O_k C)^T = C^T O_k
+    std::vector<std::vector<double>> OCt(nops, std::vector<double>(norb * nbf));
+    for (size_t k = 0; k < nops; ++k) {
+        C_DGEMM('T', 'N', norb, nbf, nbf, 1.0, C->pointer()[0], norb, ao_ops[k]->pointer()[0],
+                nbf, 0.0, OCt[k].data(), nbf);
+    }
+    // Ut[i * norb + p] = U_pi
+    std::vector<double> Ut(norb * norb, 0.0);
+    for (size_t i = 0; i < norb; ++i) {
+        Ut[i * norb + i] = 1.0;
+    }
+
+    // The metric components of the pair (i,j): z_ii, z_jj, and z_ij for each of the ncomp
+    // operators (dipole components or atoms)
+    const size_t ncomp = boys ? nops : natom;
+    auto pair_components = [&](size_t i, size_t j, std::vector<double>& z) {
+        std::fill(z.begin(), z.end(), 0.0);
+        const double* Ci = &Ct[i * nbf];
+        const double* Cj = &Ct[j * nbf];
+        for (size_t k = 0; k < nops; ++k) {
+            const double* Oi = &OCt[k][i * nbf];
+            const double* Oj = &OCt[k][j * nbf];
+            for (size_t mu = 0; mu < nbf; ++mu) {
+                size_t c = boys ? k : bf_to_atom[mu];
+                z[3 * c] += Ci[mu] * Oi[mu];
+                z[3 * c + 1] += Cj[mu] * Oj[mu];
+                z[3 * c + 2] += 0.5 * (Ci[mu] * Oj[mu] + Cj[mu] * Oi[mu]);
+            }
+        }
+    };
+
+    auto rotate_rows = [](double* x, double* y, size_t n, double c, double s) {
+        for (size_t mu = 0; mu < n; ++mu) {
+            double xi = x[mu];
+            double yj = y[mu];
+            x[mu] = c * xi + s * yj;
+            y[mu] = -s * xi + c * yj;
+        }
+    };
+
+    auto compute_metric = [&]() {
+        double metric = 0.0;
+#pragma omp parallel for reduction(+ : metric)
+        for (size_t i = 0; i < norb; ++i) {
+            std::vector<double> z(3 * ncomp);
+            pair_components(i, i, z);
+            for (size_t c = 0; c < ncomp; ++c) {
+                metric += z[3 * c] * z[3 * c];
+            }
+        }
+        return metric;
+    };
+
+    // Round-robin schedule: norb (rounded up to even) - 1 rounds of disjoint pairs
+    const size_t nslots = norb + (norb % 2);
+    std::vector<size_t> slots(nslots);
+    std::iota(slots.begin(), slots.end(), 0);
+
+    double metric = compute_metric();
+    outfile->Printf("\n\n    Iter            Metric          Change  Rotations");
+    outfile->Printf("\n    %4d  %16.10f", 0, metric);
+
+    bool converged = false;
+    for (int iter = 1; iter <= maxiter_; ++iter) {
+        size_t nrotations = 0;
+        for (size_t round = 0; round + 1 < nslots; ++round) {
+#pragma omp parallel for schedule(dynamic) reduction(+ : nrotations)
+            for (size_t p = 0; p < nslots / 2; ++p) {
+                size_t i = slots[p];
+                size_t j = slots[nslots - 1 - p];
+                if (i >= norb or j >= norb)
+                    continue;
+                std::vector<double> z(3 * ncomp);
+                pair_components(i, j, z);
+                double A = 0.0, B = 0.0;
+                for (size_t c = 0; c < ncomp; ++c) {
+                    double zii = z[3 * c], zjj = z[3 * c + 1], zij = z[3 * c + 2];
+                    A += zij * zij - 0.25 * (zii - zjj) * (zii - zjj);
+                    B += zij * (zii - zjj);
+                }
+                // the optimal rotation increases the metric by A + sqrt(A^2 + B^2)
+                double gain = A + std::sqrt(A * A + B * B);
+                if (gain < 1.0e-14)
+                    continue;
+                double gamma = 0.25 * std::atan2(B, -A);
+                double c = std::cos(gamma);
+                double s = std::sin(gamma);
+                rotate_rows(&Ct[i * nbf], &Ct[j * nbf], nbf, c, s);
+                for (size_t k = 0; k < nops; ++k) {
+                    rotate_rows(&OCt[k][i * nbf], &OCt[k][j * nbf], nbf, c, s);
+                }
+                rotate_rows(&Ut[i * norb], &Ut[j * norb], norb, c, s);
+                nrotations++;
+            }
+            // keep slot 0 fixed and cycle the others
+            std::rotate(slots.begin() + 1, slots.end() - 1, slots.end());
+        }
+
+        double new_metric = compute_metric();
+        double change = new_metric - metric;
+        metric = new_metric;
+        outfile->Printf("\n    %4d  %16.10f  %14.6e  %9zu", iter, metric, change, nrotations);
+        if (nrotations == 0 or std::fabs(change) < conv_ * std::fabs(metric)) {
+            converged = true;
+            break;
+        }
+    }
+    outfile->Printf("\n");
+    if (not converged) {
+        outfile->Printf("\n  Warning: Jacobi localization did not converge in %d sweeps.",
+                        maxiter_);
+    }
+
+    auto U = std::make_shared<psi::Matrix>("U", norb, norb);
+    for (size_t i = 0; i < norb; ++i) {
+        for (size_t p = 0; p < norb; ++p) {
+            U->set(p, i, Ut[i * norb + p]);
+        }
+    }
+    return U;
+}
+
 psi::SharedMatrix Localize::get_Ua() { return Ua_; }
 psi::SharedMatrix Localize::get_Ub() { return Ub_; }
 
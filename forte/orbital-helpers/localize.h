@@ -72,6 +72,26 @@ class Localize : public OrbitalTransform {
 
     // Pipek-Mezey or Boys
     std::string local_method_;
+
+    // PSI4 or FORTE
+    std::string local_engine_;
+
+    // Maximum number of Jacobi sweeps
+    int maxiter_;
+
+    // Convergence threshold on the relative change of the metric
+    double conv_;
+
+    /**
+     * @brief Localize a set of orbitals with Jacobi sweeps
+     *
+     * Each sweep visits all orbital pairs in the round-robin order, so that every round is made
+     * of disjoint pairs that are rotated in parallel. Pairs whose optimal rotation does not
+     * increase the metric are skipped.
+     * @param C the orbitals to localize (nbf x norb)
+     * @return the rotation U (norb x norb) such that C U are the localized orbitals
+     */
+    psi::SharedMatrix jacobi_localize(psi::SharedMatrix C);
 };
 } // namespace forte
 
@@ -26,6 +26,11 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <tuple>
+
 #include "ambit/blocked_tensor.h"
 
 #include "psi4/libpsio/psio.h"
@@ -35,6 +40,8 @@
 #include "psi4/libmints/vector.h"
 
 #include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libpsi4util/process.h"
+#include "psi4/libqt/qt.h"
 #include "helpers/helpers.h"
 
 #include "helpers/blockedtensorfactory.h"
@@ -120,100 +127,146 @@ void MP2_NOS::compute_transformation() {
     // for (size_t p = 0; p < b_vir_mos.size(); ++p) mos_to_bvir[b_vir_mos[p]] =
     // p;
 
-    BlockedTensor::add_mo_space("o", "ijklmn", a_occ_mos, AlphaSpin);
-    BlockedTensor::add_mo_space("O", "IJKLMN", b_occ_mos, BetaSpin);
-    BlockedTensor::add_mo_space("v", "abcdef", a_vir_mos, AlphaSpin);
-    BlockedTensor::add_mo_space("V", "ABCDEF", b_vir_mos, BetaSpin);
-    BlockedTensor::add_composite_mo_space("i", "pqrstuvwxyz", {"o", "v"});
-    BlockedTensor::add_composite_mo_space("I", "PQRSTUVWXYZ", {"O", "V"});
-
-    BlockedTensor G1 = BlockedTensor::build(CoreTensor, "G1", spin_cases({"oo"}));
-    BlockedTensor D1 = BlockedTensor::build(CoreTensor, "D1", spin_cases({"oo", "vv"}));
-    BlockedTensor H = BlockedTensor::build(CoreTensor, "H", spin_cases({"ii"}));
-    BlockedTensor F = BlockedTensor::build(CoreTensor, "F", spin_cases({"ii"}));
-    BlockedTensor V = BlockedTensor::build(CoreTensor, "V", spin_cases({"iiii"}));
-    BlockedTensor T2 = BlockedTensor::build(CoreTensor, "T2", spin_cases({"oovv"}));
-    BlockedTensor InvD2 = BlockedTensor::build(CoreTensor, "Inverse D2", spin_cases({"oovv"}));
-
-    // Fill in the one-electron operator (H)
-    H.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if (spin[0] == AlphaSpin)
-            value = ints_->oei_a(i[0], i[1]);
-        else
-            value = ints_->oei_b(i[0], i[1]);
-    });
+    // The closed-shell DF-MP2 path never builds four-index integrals. It requires a restricted
+    // reference and integrals that expose a three-index factorization.
+    auto int_type = ints_->integral_type();
+    bool three_index_ints = (int_type == DF) or (int_type == DiskDF) or (int_type == Cholesky);
+    bool use_df = options_->get_bool("MP2_NOS_DF") and three_index_ints and (soccpi.sum() == 0);
+    bool virtual_only = options_->get_bool("MP2_NOS_VIRTUAL_ONLY");
+
+    psi::SharedMatrix D1oo, D1OO, D1vv, D1VV;
+    double mp2_correlation_energy = 0.0;
+
+    if (use_df) {
+        outfile->Printf("\n  Computing the MP2 density with three-index integrals.");
+        ambit::Tensor Doo, Dvv;
+        std::tie(mp2_correlation_energy, Doo, Dvv) =
+            compute_df_mp2_opdm(a_occ_mos, a_vir_mos, virtual_only);
+        D1oo = tensor_to_matrix(Doo, aoccpi);
+        D1vv = tensor_to_matrix(Dvv, avirpi);
+        D1OO = D1oo->clone();
+        D1VV = D1vv->clone();
+    } else {
+        BlockedTensor::add_mo_space("o", "ijklmn", a_occ_mos, AlphaSpin);
+        BlockedTensor::add_mo_space("O", "IJKLMN", b_occ_mos, BetaSpin);
+        BlockedTensor::add_mo_space("v", "abcdef", a_vir_mos, AlphaSpin);
+        BlockedTensor::add_mo_space("V", "ABCDEF", b_vir_mos, BetaSpin);
+        BlockedTensor::add_composite_mo_space("i", "pqrstuvwxyz", {"o", "v"});
+        BlockedTensor::add_composite_mo_space("I", "PQRSTUVWXYZ", {"O", "V"});
+
+        BlockedTensor G1 = BlockedTensor::build(CoreTensor, "G1", spin_cases({"oo"}));
+        BlockedTensor D1 = BlockedTensor::build(CoreTensor, "D1", spin_cases({"oo", "vv"}));
+        BlockedTensor H = BlockedTensor::build(CoreTensor, "H", spin_cases({"ii"}));
+        BlockedTensor F = BlockedTensor::build(CoreTensor, "F", spin_cases({"ii"}));
+        BlockedTensor V = BlockedTensor::build(CoreTensor, "V", spin_cases({"iiii"}));
+        BlockedTensor T2 = BlockedTensor::build(CoreTensor, "T2", spin_cases({"oovv"}));
+        BlockedTensor InvD2 = BlockedTensor::build(CoreTensor, "Inverse D2", spin_cases({"oovv"}));
+
+        // Fill in the one-electron operator (H)
+        H.iterate(
+            [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
+                if (spin[0] == AlphaSpin)
+                    value = ints_->oei_a(i[0], i[1]);
+                else
+                    value = ints_->oei_b(i[0], i[1]);
+            });
+
+        // Fill in the two-electron operator (V)
+        V.iterate(
+            [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
+                if ((spin[0] == AlphaSpin) and (spin[1] == AlphaSpin))
+                    value = ints_->aptei_aa(i[0], i[1], i[2], i[3]);
+                if ((spin[0] == AlphaSpin) and (spin[1] == BetaSpin))
+                    value = ints_->aptei_ab(i[0], i[1], i[2], i[3]);
+                if ((spin[0] == BetaSpin) and (spin[1] == BetaSpin))
+                    value = ints_->aptei_bb(i[0], i[1], i[2], i[3]);
+            });
+
+        H.iterate(
+            [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
+                if (spin[0] == AlphaSpin)
+                    value = ints_->oei_a(i[0], i[1]);
+                else
+                    value = ints_->oei_b(i[0], i[1]);
+            });
+
+        G1.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>&, double& value) {
+            value = i[0] == i[1] ? 1.0 : 0.0;
+        });
 
-    // Fill in the two-electron operator (V)
-    V.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if ((spin[0] == AlphaSpin) and (spin[1] == AlphaSpin))
-            value = ints_->aptei_aa(i[0], i[1], i[2], i[3]);
-        if ((spin[0] == AlphaSpin) and (spin[1] == BetaSpin))
-            value = ints_->aptei_ab(i[0], i[1], i[2], i[3]);
-        if ((spin[0] == BetaSpin) and (spin[1] == BetaSpin))
-            value = ints_->aptei_bb(i[0], i[1], i[2], i[3]);
-    });
+        D1.block("oo").iterate(
+            [&](const std::vector<size_t>& i, double& value) { value = i[0] == i[1] ? 1.0 : 0.0; });
 
-    H.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if (spin[0] == AlphaSpin)
-            value = ints_->oei_a(i[0], i[1]);
-        else
-            value = ints_->oei_b(i[0], i[1]);
-    });
+        D1.block("OO").iterate(
+            [&](const std::vector<size_t>& i, double& value) { value = i[0] == i[1] ? 1.0 : 0.0; });
 
-    G1.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>&, double& value) {
-        value = i[0] == i[1] ? 1.0 : 0.0;
-    });
+        // Form the Fock matrix
+        F["ij"] = H["ij"];
+        F["ab"] = H["ab"];
+        F["pq"] += V["prqs"] * G1["sr"];
+        F["pq"] += V["pRqS"] * G1["SR"];
 
-    D1.block("oo").iterate(
-        [&](const std::vector<size_t>& i, double& value) { value = i[0] == i[1] ? 1.0 : 0.0; });
+        F["IJ"] += H["IJ"];
+        F["AB"] += H["AB"];
+        F["PQ"] += V["rPsQ"] * G1["sr"];
+        F["PQ"] += V["PRQS"] * G1["SR"];
 
-    D1.block("OO").iterate(
-        [&](const std::vector<size_t>& i, double& value) { value = i[0] == i[1] ? 1.0 : 0.0; });
+        size_t ncmo_ = mo_space_info_->size("CORRELATED");
+        std::vector<double> Fa(ncmo_);
+        std::vector<double> Fb(ncmo_);
 
-    // Form the Fock matrix
-    F["ij"] = H["ij"];
-    F["ab"] = H["ab"];
-    F["pq"] += V["prqs"] * G1["sr"];
-    F["pq"] += V["pRqS"] * G1["SR"];
+        F.iterate(
+            [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
+                if (spin[0] == AlphaSpin and (i[0] == i[1])) {
+                    Fa[i[0]] = value;
+                }
+                if (spin[0] == BetaSpin and (i[0] == i[1])) {
+                    Fb[i[0]] = value;
+                }
+            });
+
+        InvD2.iterate(
+            [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
+                if ((spin[0] == AlphaSpin) and (spin[1] == AlphaSpin)) {
+                    value = 1.0 / (Fa[i[0]] + Fa[i[1]] - Fa[i[2]] - Fa[i[3]]);
+                } else if ((spin[0] == AlphaSpin) and (spin[1] == BetaSpin)) {
+                    value = 1.0 / (Fa[i[0]] + Fb[i[1]] - Fa[i[2]] - Fb[i[3]]);
+                } else if ((spin[0] == BetaSpin) and (spin[1] == BetaSpin)) {
+                    value = 1.0 / (Fb[i[0]] + Fb[i[1]] - Fb[i[2]] - Fb[i[3]]);
+                }
+            });
 
-    F["IJ"] += H["IJ"];
-    F["AB"] += H["AB"];
-    F["PQ"] += V["rPsQ"] * G1["sr"];
-    F["PQ"] += V["PRQS"] * G1["SR"];
+        T2["ijab"] = V["ijab"] * InvD2["ijab"];
+        T2["iJaB"] = V["iJaB"] * InvD2["iJaB"];
+        T2["IJAB"] = V["IJAB"] * InvD2["IJAB"];
 
-    size_t ncmo_ = mo_space_info_->size("CORRELATED");
-    std::vector<double> Fa(ncmo_);
-    std::vector<double> Fb(ncmo_);
+        double Eaa = 0.25 * T2["ijab"] * V["ijab"];
+        double Eab = T2["iJaB"] * V["iJaB"];
+        double Ebb = 0.25 * T2["IJAB"] * V["IJAB"];
 
-    F.iterate([&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-        if (spin[0] == AlphaSpin and (i[0] == i[1])) {
-            Fa[i[0]] = value;
-        }
-        if (spin[0] == BetaSpin and (i[0] == i[1])) {
-            Fb[i[0]] = value;
-        }
-    });
+        mp2_correlation_energy = Eaa + Eab + Ebb;
 
-    InvD2.iterate(
-        [&](const std::vector<size_t>& i, const std::vector<SpinType>& spin, double& value) {
-            if ((spin[0] == AlphaSpin) and (spin[1] == AlphaSpin)) {
-                value = 1.0 / (Fa[i[0]] + Fa[i[1]] - Fa[i[2]] - Fa[i[3]]);
-            } else if ((spin[0] == AlphaSpin) and (spin[1] == BetaSpin)) {
-                value = 1.0 / (Fa[i[0]] + Fb[i[1]] - Fa[i[2]] - Fb[i[3]]);
-            } else if ((spin[0] == BetaSpin) and (spin[1] == BetaSpin)) {
-                value = 1.0 / (Fb[i[0]] + Fb[i[1]] - Fb[i[2]] - Fb[i[3]]);
-            }
-        });
+        D1["ab"] += 0.5 * T2["ijbc"] * T2["ijac"];
+        D1["ab"] += 1.0 * T2["iJbC"] * T2["iJaC"];
+
+        D1["AB"] += 0.5 * T2["IJCB"] * T2["IJCA"];
+        D1["AB"] += 1.0 * T2["iJcB"] * T2["iJcA"];
 
-    T2["ijab"] = V["ijab"] * InvD2["ijab"];
-    T2["iJaB"] = V["iJaB"] * InvD2["iJaB"];
-    T2["IJAB"] = V["IJAB"] * InvD2["IJAB"];
+        if (not virtual_only) {
+            D1["ij"] -= 0.5 * T2["ikab"] * T2["jkab"];
+            D1["ij"] -= 1.0 * T2["iKaB"] * T2["jKaB"];
 
-    double Eaa = 0.25 * T2["ijab"] * V["ijab"];
-    double Eab = T2["iJaB"] * V["iJaB"];
-    double Ebb = 0.25 * T2["IJAB"] * V["IJAB"];
+            D1["IJ"] -= 0.5 * T2["IKAB"] * T2["JKAB"];
+            D1["IJ"] -= 1.0 * T2["kIaB"] * T2["kJaB"];
+        }
+
+        // Copy the density matrix to matrix objects
+        D1oo = tensor_to_matrix(D1.block("oo"), aoccpi);
+        D1OO = tensor_to_matrix(D1.block("OO"), boccpi);
+        D1vv = tensor_to_matrix(D1.block("vv"), avirpi);
+        D1VV = tensor_to_matrix(D1.block("VV"), bvirpi);
+    }
 
-    double mp2_correlation_energy = Eaa + Eab + Ebb;
     double ref_energy = scf_info_->reference_energy();
     outfile->Printf("\n\n    SCF energy                            = %20.15f", ref_energy);
     outfile->Printf("\n    MP2 correlation energy                = %20.15f",
@@ -221,24 +274,6 @@ void MP2_NOS::compute_transformation() {
     outfile->Printf("\n  * MP2 total energy                      = %20.15f\n\n",
                     ref_energy + mp2_correlation_energy);
 
-    D1["ab"] += 0.5 * T2["ijbc"] * T2["ijac"];
-    D1["ab"] += 1.0 * T2["iJbC"] * T2["iJaC"];
-
-    D1["AB"] += 0.5 * T2["IJCB"] * T2["IJCA"];
-    D1["AB"] += 1.0 * T2["iJcB"] * T2["iJcA"];
-
-    D1["ij"] -= 0.5 * T2["ikab"] * T2["jkab"];
-    D1["ij"] -= 1.0 * T2["iKaB"] * T2["jKaB"];
-
-    D1["IJ"] -= 0.5 * T2["IKAB"] * T2["JKAB"];
-    D1["IJ"] -= 1.0 * T2["kIaB"] * T2["kJaB"];
-
-    // Copy the density matrix to matrix objects
-    auto D1oo = tensor_to_matrix(D1.block("oo"), aoccpi);
-    auto D1OO = tensor_to_matrix(D1.block("OO"), boccpi);
-    auto D1vv = tensor_to_matrix(D1.block("vv"), avirpi);
-    auto D1VV = tensor_to_matrix(D1.block("VV"), bvirpi);
-
     Matrix D1oo_evecs("D1oo_evecs", aoccpi, aoccpi);
     Matrix D1OO_evecs("D1OO_evecs", boccpi, boccpi);
     Matrix D1vv_evecs("D1vv_evecs", avirpi, avirpi);
@@ -409,4 +444,124 @@ void MP2_NOS::compute_transformation() {
     // Erase all mo_space information
     BlockedTensor::reset_mo_spaces();
 }
+
+std::tuple<double, ambit::Tensor, ambit::Tensor>
+MP2_NOS::compute_df_mp2_opdm(const std::vector<size_t>& occ_mos,
+                             const std::vector<size_t>& vir_mos, bool virtual_only) {
+    const size_t no = occ_mos.size();
+    const size_t nv = vir_mos.size();
+    const size_t nv2 = nv * nv;
+    const size_t nQ = ints_->nthree();
+
+    // Orbital energies from the diagonal of the closed-shell Fock matrix (one JK build)
+    int nirrep = ints_->nirrep();
+    psi::Dimension frzcpi = mo_space_info_->dimension("FROZEN_DOCC");
+    psi::Dimension ncmopi = mo_space_info_->dimension("CORRELATED");
+    psi::SharedMatrix Fock;
+    std::tie(Fock, std::ignore, std::ignore) =
+        ints_->make_fock_inactive(psi::Dimension(nirrep), scf_info_->doccpi());
+    std::vector<double> eps;
+    for (int h = 0; h < nirrep; ++h) {
+        for (int p = 0; p < ncmopi[h]; ++p) {
+            eps.push_back(Fock->get(h, frzcpi[h] + p, frzcpi[h] + p));
+        }
+    }
+    std::vector<double> eps_o(no), eps_v(nv);
+    for (size_t i = 0; i < no; ++i)
+        eps_o[i] = eps[occ_mos[i]];
+    for (size_t a = 0; a < nv; ++a)
+        eps_v[a] = eps[vir_mos[a]];
+
+    std::vector<size_t> Qs(nQ);
+    std::iota(Qs.begin(), Qs.end(), 0);
+
+    // (Q|ia) stays in core for the whole computation
+    auto Bov = ints_->three_integral_block(Qs, occ_mos, vir_mos);
+
+    // Pick the number of k indices whose (Q|kb) block is read at once. Besides (Q|ia), the
+    // fixed intermediates are the (ia|kb) integrals and two amplitude buffers of a single k.
+    const size_t max_doubles = psi::Process::environment.get_memory() / sizeof(double);
+    const size_t fixed_doubles = nQ * no * nv + 3 * no * nv2 + no * no + nv2;
+    size_t nk = 1;
+    if (max_doubles > fixed_doubles) {
+        nk = std::max(size_t(1), (max_doubles - fixed_doubles) / std::max(size_t(1), nQ * nv));
+    } else {
+        outfile->Printf("\n  Warning: DF-MP2 requires %zu doubles, more than the available %zu.",
+                        fixed_doubles, max_doubles);
+    }
+    nk = std::min(nk, no);
+
+    std::vector<std::vector<size_t>> k_batches;
+    std::vector<std::array<std::vector<size_t>, 3>> sequence;
+    for (size_t k0 = 0; k0 < no; k0 += nk) {
+        k_batches.emplace_back(occ_mos.begin() + k0, occ_mos.begin() + std::min(no, k0 + nk));
+        sequence.push_back({Qs, k_batches.back(), vir_mos});
+    }
+    if (k_batches.size() > 1) {
+        ints_->set_three_integral_block_sequence(sequence);
+    }
+    outfile->Printf("\n  Occupied indices are processed in %zu batch(es) of up to %zu.",
+                    k_batches.size(), nk);
+
+    auto Doo = ambit::Tensor::build(ambit::CoreTensor, "D1oo", {no, no});
+    auto Dvv = ambit::Tensor::build(ambit::CoreTensor, "D1vv", {nv, nv});
+    Doo.iterate([&](const std::vector<size_t>& i, double& value) {
+        value = i[0] == i[1] ? 1.0 : 0.0;
+    });
+
+    std::vector<double> K(no * nv2), T(no * nv2), Tt(no * nv2);
+    double* Bov_p = Bov.data().data();
+    double* Doo_p = Doo.data().data();
+    double* Dvv_p = Dvv.data().data();
+    double e_mp2 = 0.0;
+
+    size_t k = 0;
+    for (const auto& kmos : k_batches) {
+        const size_t nkb = kmos.size();
+        ambit::Tensor Bk = nkb == no ? Bov : ints_->three_integral_block(Qs, kmos, vir_mos);
+        double* Bk_p = Bk.data().data();
+        for (size_t kk = 0; kk < nkb; ++kk, ++k) {
+            // (ia|kc) = sum_Q (Q|ia) (Q|kc)
+            C_DGEMM('T', 'N', no * nv, nv, nQ, 1.0, Bov_p, no * nv, Bk_p + kk * nv, nkb * nv, 0.0,
+                    K.data(), nv);
+
+            // t_ik^ac and the antisymmetrized same-spin amplitudes t_ik^ac - t_ik^ca
+#pragma omp parallel for reduction(+ : e_mp2)
+            for (size_t i = 0; i < no; ++i) {
+                const double* Ki = K.data() + i * nv2;
+                double* Ti = T.data() + i * nv2;
+                double* Tti = Tt.data() + i * nv2;
+                double e_ik = 0.0;
+                for (size_t a = 0; a < nv; ++a) {
+                    for (size_t c = 0; c < nv; ++c) {
+                        double denom = eps_o[i] + eps_o[k] - eps_v[a] - eps_v[c];
+                        double t_ac = Ki[a * nv + c] / denom;
+                        double t_ca = Ki[c * nv + a] / denom;
+                        Ti[a * nv + c] = t_ac;
+                        Tti[a * nv + c] = t_ac - t_ca;
+                        e_ik += Ki[a * nv + c] * (2.0 * t_ac - t_ca);
+                    }
+                }
+                e_mp2 += e_ik;
+            }
+
+            // D_ab += sum_ic [0.5 tt_ik^ac tt_ik^bc + t_ik^ac t_ik^bc]
+            for (size_t i = 0; i < no; ++i) {
+                C_DGEMM('N', 'T', nv, nv, nv, 0.5, Tt.data() + i * nv2, nv, Tt.data() + i * nv2,
+                        nv, 1.0, Dvv_p, nv);
+                C_DGEMM('N', 'T', nv, nv, nv, 1.0, T.data() + i * nv2, nv, T.data() + i * nv2, nv,
+                        1.0, Dvv_p, nv);
+            }
+
+            // D_ij -= sum_ab [0.5 tt_ik^ab tt_jk^ab + t_ik^ab t_jk^ab]
+            if (not virtual_only) {
+                C_DGEMM('N', 'T', no, no, nv2, -0.5, Tt.data(), nv2, Tt.data(), nv2, 1.0, Doo_p,
+                        no);
+                C_DGEMM('N', 'T', no, no, nv2, -1.0, T.data(), nv2, T.data(), nv2, 1.0, Doo_p, no);
+            }
+        }
+    }
+
+    return std::make_tuple(e_mp2, Doo, Dvv);
+}
 } // namespace forte
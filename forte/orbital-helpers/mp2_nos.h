@@ -29,6 +29,7 @@
 #ifndef _mp2_nos_h_
 #define _mp2_nos_h_
 
+#include <tuple>
 
 #include "psi4/libmints/wavefunction.h"
 
@@ -58,6 +59,21 @@ class MP2_NOS : public OrbitalTransform {
     std::shared_ptr<ForteOptions> options_;
     psi::SharedMatrix Ua_;
     psi::SharedMatrix Ub_;
+
+    /**
+     * @brief Compute the closed-shell MP2 energy and unrelaxed 1-RDM from three-index integrals
+     *
+     * The amplitudes are built one occupied index k at a time from (Q|ia) and (Q|kb), so no
+     * four-index tensor is stored. The (Q|kb) blocks are read in batches that fit in memory.
+     * @param occ_mos the correlated occupied MOs
+     * @param vir_mos the correlated virtual MOs
+     * @param virtual_only if true, only the virtual-virtual block is computed and the
+     *        occupied-occupied block is left as the identity
+     * @return the MP2 correlation energy and the oo and vv blocks of the alpha 1-RDM
+     */
+    std::tuple<double, ambit::Tensor, ambit::Tensor>
+    compute_df_mp2_opdm(const std::vector<size_t>& occ_mos, const std::vector<size_t>& vir_mos,
+                        bool virtual_only);
 };
 } // namespace forte
 
@@ -34,6 +34,7 @@
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/integral.h"
 #include "psi4/libpsio/psio.hpp"
+#include "psi4/libqt/qt.h"
 
 #include "pao_builder.h"
 
@@ -57,17 +58,15 @@ void PAObuilder::startup() {
     // Build D
     outfile->Printf("\n ****** Build Density ******");
 
+    // D_uv = sum_i C_ui C_vi, one DGEMM per irrep on the occupied columns of C
     SharedMatrix D(new Matrix("Density pq", nirrep_, nmopi_, nmopi_));
     for (int h = 0; h < nirrep_; ++h) {
-        for (int u = 0; u < nmopi_[h]; ++u) {
-            for (int v = 0; v < nmopi_[h]; ++v) {
-                double d_value = 0.0;
-                for (int i = 0; i < noccpi_[h]; ++i) {
-                    d_value += C_->get(h, u, i) * C_->get(h, v, i);
-                }
-                D->set(h, u, v, d_value);
-            }
+        if (nmopi_[h] == 0 or noccpi_[h] == 0) {
+            continue;
         }
+        C_DGEMM('N', 'T', nmopi_[h], nmopi_[h], noccpi_[h], 1.0, C_->pointer(h)[0],
+                C_->colspi(h), C_->pointer(h)[0], C_->colspi(h), 0.0, D->pointer(h)[0],
+                nmopi_[h]);
     }
     D_ = D;
 
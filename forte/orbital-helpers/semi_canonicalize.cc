@@ -113,27 +113,67 @@ RDMs SemiCanonical::semicanonicalize(RDMs& rdms, const int& max_rdm_level, const
                                      const bool& transform) {
     local_timer SemiCanonicalize;
 
-    // 1. Build the Fock matrix from ForteIntegral
+    // 1. Build the Fock matrix from ForteIntegral, unless it is known for these orbitals and RDMs
+    bool fock_from_inputs = false;
     if (build_fock) {
-        local_timer FockTime;
-        ints_->make_fock_matrix(rdms.g1a(), rdms.g1b());
-        outfile->Printf("\n  Took %8.6f s to build Fock matrix", FockTime.get());
+        if (fingerprint_matches(rdms)) {
+            if (ints_->get_fock_a(false) != cache_fock_a_ or
+                ints_->get_fock_b(false) != cache_fock_b_) {
+                ints_->set_fock_matrix(cache_fock_a_, cache_fock_b_);
+            }
+            outfile->Printf("\n  Reusing the Fock matrix of the same orbitals and 1-RDMs.");
+        } else {
+            local_timer FockTime;
+            ints_->make_fock_matrix(rdms.g1a(), rdms.g1b());
+            outfile->Printf("\n  Took %8.6f s to build Fock matrix", FockTime.get());
+            store_fingerprint(rdms);
+        }
+        fock_from_inputs = true;
     }
 
-    // Check Fock matrix
-    bool semi = check_fock_matrix();
+    // Check Fock matrix, or reuse the results of the last call for the same Fock matrix
+    auto fock_a = ints_->get_fock_a(false);
+    auto fock_b = ints_->get_fock_b(false);
+    bool semi;
+    if (fock_a == cache_fock_a_ and fock_b == cache_fock_b_) {
+        semi = cache_semi_;
+        if (semi)
+            set_U_to_identity();
+    } else {
+        semi = check_fock_matrix();
+        if (semi) {
+            set_U_to_identity();
+        } else {
+            // 2. Build transformation matrices from diagononalizing blocks in F
+            build_transformation_matrices();
+        }
+        cache_fock_a_ = fock_a;
+        cache_fock_b_ = fock_b;
+        cache_semi_ = semi;
+        fingerprint_valid_ = fingerprint_valid_ and fock_from_inputs;
+    }
 
     if (semi) {
         outfile->Printf("\n  Orbitals are already semicanonicalized.");
-        set_U_to_identity();
     } else {
-        // 2. Build transformation matrices from diagononalizing blocks in F
-        build_transformation_matrices();
-
         // 3. Retransform integrals and cumulants/RDMs
         if (transform) {
             ints_->rotate_orbitals(Ua_, Ub_);
             rdms = transform_rdms(Ua_t_, Ub_t_, rdms, max_rdm_level);
+
+            // The Fock matrix of the new orbitals is U^T F U: hand it to ints_ and record it, so
+            // that a call with the semicanonical orbitals and RDMs needs no Fock build
+            if (fingerprint_valid_ and max_rdm_level >= 1) {
+                auto Fa = psi::linalg::triplet(Ua_, fock_a, Ua_, true, false, false);
+                auto Fb = (fock_a == fock_b)
+                              ? Fa
+                              : psi::linalg::triplet(Ub_, fock_b, Ub_, true, false, false);
+                ints_->set_fock_matrix(Fa, Fb);
+                store_fingerprint(rdms);
+                cache_fock_a_ = Fa;
+                cache_fock_b_ = Fb;
+                cache_semi_ = true;
+            }
         }
         print_timing("semi-canonicalization", SemiCanonicalize.get());
     }
@@ -190,6 +230,26 @@ bool SemiCanonical::check_fock_matrix() {
     return semi;
 }
 
+bool SemiCanonical::fingerprint_matches(RDMs& rdms) {
+    if (not fingerprint_valid_)
+        return false;
+    auto same_matrix = [](psi::SharedMatrix A, psi::SharedMatrix B) {
+        auto D = A->clone();
+        D->subtract(B);
+        return D->absmax() == 0.0;
+    };
+    return same_matrix(ints_->Ca(), cache_Ca_) and same_matrix(ints_->Cb(), cache_Cb_) and
+           rdms.g1a().data() == cache_g1a_ and rdms.g1b().data() == cache_g1b_;
+}
+
+void SemiCanonical::store_fingerprint(RDMs& rdms) {
+    cache_Ca_ = ints_->Ca()->clone();
+    cache_Cb_ = ints_->Cb()->clone();
+    cache_g1a_ = rdms.g1a().data();
+    cache_g1b_ = rdms.g1b().data();
+    fingerprint_valid_ = true;
+}
+
 void SemiCanonical::set_U_to_identity() {
     Ua_->identity();
     Ub_->identity();
@@ -214,30 +274,47 @@ void SemiCanonical::build_transformation_matrices() {
     if (fock_a != fock_b)
         spin_cases.push_back("beta");
 
+    // gather the diagonal blocks that need to be diagonalized
+    std::vector<std::pair<std::string, std::string>> blocks;
     for (const std::string& spin : spin_cases) {
-        bool is_alpha = (spin == "alpha");
-
-        auto& fock = is_alpha ? fock_a : fock_b;
-        auto& U = is_alpha ? Ua_ : Ub_;
-
-        // loop over orbital spaces
         for (const auto& name_dim_pair : mo_dims_) {
-            const std::string& name = name_dim_pair.first;
-            psi::Dimension npi = name_dim_pair.second;
+            if (checked_results_[name_dim_pair.first + spin]) {
+                blocks.emplace_back(name_dim_pair.first, spin);
+            }
+        }
+    }
 
-            if (checked_results_[name + spin]) {
-                // build Fock matrix of this diagonal block
-                auto slice = mo_space_info_->range(name);
-                auto Fsub = fock->get_block(slice, slice);
-                Fsub->set_name("Fock " + name + " " + spin);
+    // diagonalize the blocks concurrently (each one is diagonalized irrep by irrep)
+    std::vector<psi::SharedMatrix> Usubs(blocks.size());
+#pragma omp parallel for schedule(dynamic)
+    for (size_t n = 0; n < blocks.size(); ++n) {
+        const std::string& name = blocks[n].first;
+        const std::string& spin = blocks[n].second;
+        auto& fock = (spin == "alpha") ? fock_a : fock_b;
+        psi::Dimension npi = mo_dims_.at(name);
+
+        // build Fock matrix of this diagonal block
+        auto slice = mo_space_info_->range(name);
+        auto Fsub = fock->get_block(slice, slice);
+        Fsub->set_name("Fock " + name + " " + spin);
+
+        // diagonalize this Fock block
+        auto Usub = std::make_shared<psi::Matrix>("U " + name + " " + spin, npi, npi);
+        auto evals = std::make_shared<psi::Vector>("evals" + name + " " + spin, npi);
+        Fsub->diagonalize(Usub, evals);
+        Usubs[n] = Usub;
+    }
 
-                // diagonalize this Fock block
-                auto Usub = std::make_shared<psi::Matrix>("U " + name + " " + spin, npi, npi);
-                auto evals = std::make_shared<psi::Vector>("evals" + name + " " + spin, npi);
-                Fsub->diagonalize(Usub, evals);
+    for (const std::string& spin : spin_cases) {
+        bool is_alpha = (spin == "alpha");
+
+        auto& U = is_alpha ? Ua_ : Ub_;
 
-                // fill in Ua or Ub
-                U->set_block(slice, slice, Usub);
+        // fill in Ua or Ub
+        for (size_t n = 0; n < blocks.size(); ++n) {
+            if (blocks[n].second == spin) {
+                auto slice = mo_space_info_->range(blocks[n].first);
+                U->set_block(slice, slice, Usubs[n]);
             }
         }
 
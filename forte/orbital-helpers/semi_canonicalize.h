@@ -122,6 +122,25 @@ class SemiCanonical {
 
     /// Builds unitary matrices used to diagonalize diagonal blocks of Fock
     void build_transformation_matrices();
+
+    /// Is the fingerprint (orbitals and 1-RDMs) of cache_fock_a_ and cache_fock_b_ valid?
+    bool fingerprint_valid_ = false;
+    /// Orbitals of the cached Fock matrices
+    psi::SharedMatrix cache_Ca_;
+    psi::SharedMatrix cache_Cb_;
+    /// 1-RDMs of the cached Fock matrices
+    std::vector<double> cache_g1a_;
+    std::vector<double> cache_g1b_;
+    /// Fock matrices (the objects ints_ returned) for which Ua_, Ub_, and cache_semi_ are valid
+    psi::SharedMatrix cache_fock_a_;
+    psi::SharedMatrix cache_fock_b_;
+    /// Were the cached Fock matrices already semicanonical?
+    bool cache_semi_ = false;
+
+    /// Return true if the current orbitals and the given 1-RDMs match the fingerprint
+    bool fingerprint_matches(RDMs& rdms);
+    /// Store the current orbitals and the given 1-RDMs as the fingerprint
+    void store_fingerprint(RDMs& rdms);
 };
 } // namespace forte
 
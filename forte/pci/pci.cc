@@ -44,6 +44,7 @@
 #include "sparse_ci/ci_reference.h"
 #include "sparse_ci/determinant_functions.hpp"
 #include "pci.h"
+#include "pci_mpi.h"
 #include "pci_sigma.h"
 
 #define USE_HASH 1
@@ -215,6 +216,58 @@ void ProjectorCI::sortHashVecByCoefficient(det_hashvec& dets_hashvec, std::vecto
     C = std::move(new_C);
 }
 
+void ProjectorCI::bucketHashVecByCoefficient(det_hashvec& dets_hashvec, std::vector<double>& C) {
+    const size_t dets_size = dets_hashvec.size();
+    if (dets_size == 0)
+        return;
+    // Bucket b holds the coefficients with 2^-(b + 1) <= |C| / max_C < 2^-b (and max_C itself
+    // for b = 0). The last bucket also holds all the smaller coefficients
+    constexpr int nbucket = 64;
+    auto max_it = std::max_element(C.begin(), C.begin() + dets_size,
+                                   [](double a, double b) { return std::fabs(a) < std::fabs(b); });
+    const size_t max_I = static_cast<size_t>(max_it - C.begin());
+    const double max_C = std::fabs(*max_it);
+    std::vector<unsigned char> bucket(dets_size, nbucket - 1);
+    if (max_C > 0.0) {
+#pragma omp parallel for
+        for (size_t I = 0; I < dets_size; ++I) {
+            double ratio = std::fabs(C[I]) / max_C;
+            if (ratio > 0.0) {
+                int exponent;
+                std::frexp(ratio, &exponent); // ratio = f * 2^exponent with 0.5 <= f < 1
+                int b = ratio == 1.0 ? 0 : -exponent;
+                bucket[I] = static_cast<unsigned char>(std::min(b, nbucket - 1));
+            }
+        }
+    }
+    std::vector<size_t> offset(nbucket + 1, 0);
+    for (size_t I = 0; I < dets_size; ++I) {
+        ++offset[bucket[I] + 1];
+    }
+    for (int b = 0; b < nbucket; ++b) {
+        offset[b + 1] += offset[b];
+    }
+    // Place the largest determinant first and the others in the order they have in each bucket
+    std::vector<size_t> order_map(dets_size);
+    order_map[max_I] = offset[bucket[max_I]]++;
+    for (size_t I = 0; I < dets_size; ++I) {
+        if (I != max_I)
+            order_map[I] = offset[bucket[I]]++;
+    }
+    bool identity = true;
+    for (size_t I = 0; I < dets_size and identity; ++I) {
+        identity = (order_map[I] == I);
+    }
+    if (identity)
+        return;
+    dets_hashvec.map_order(order_map);
+    std::vector<double> new_C(dets_size);
+    for (size_t I = 0; I < dets_size; ++I) {
+        new_C[order_map[I]] = C[I];
+    }
+    C = std::move(new_C);
+}
+
 ProjectorCI::ProjectorCI(StateInfo state, size_t nroot, std::shared_ptr<SCFInfo> scf_info,
                          std::shared_ptr<ForteOptions> options,
                          std::shared_ptr<MOSpaceInfo> mo_space_info,
@@ -294,11 +347,16 @@ void ProjectorCI::set_options(std::shared_ptr<ForteOptions> options) {
     energy_estimate_freq_ = options->get_int("PCI_ENERGY_ESTIMATE_FREQ");
 
     fast_variational_estimate_ = options->get_bool("PCI_FAST_EVAR");
+    incremental_variational_estimate_ = options->get_bool("PCI_INCREMENTAL_EVAR");
     do_shift_ = options->get_bool("PCI_USE_SHIFT");
     use_inter_norm_ = options->get_bool("PCI_USE_INTER_NORM");
     do_perturb_analysis_ = options->get_bool("PCI_PERTURB_ANALYSIS");
     stop_higher_new_low_ = options->get_bool("PCI_STOP_HIGHER_NEW_LOW");
     chebyshev_order_ = options->get_int("PCI_CHEBYSHEV_ORDER");
+    lanczos_high_energy_ = options->get_str("PCI_HIGH_ENERGY_ESTIMATE") == "LANCZOS";
+    lanczos_maxiter_ = options->get_int("PCI_LANCZOS_MAXITER");
+    lanczos_spawning_threshold_ = options->get_double("PCI_LANCZOS_SPAWNING_THRESHOLD");
+    lanczos_convergence_ = options->get_double("PCI_LANCZOS_CONVERGENCE");
     krylov_order_ = options->get_int("PCI_KRYLOV_ORDER");
 
     variational_estimate_ = options->get_bool("PCI_VAR_ESTIMATE");
@@ -420,8 +478,10 @@ void ProjectorCI::print_info() {
         {"Generator type", generator_description_},
         {"Importance functional", functional_description_},
         {"Shift the energy", do_shift_ ? "YES" : "NO"},
+        {"Highest energy estimate", lanczos_high_energy_ ? "LANCZOS" : "GERSHGORIN"},
         {"Use intermediate normalization", use_inter_norm_ ? "YES" : "NO"},
         {"Fast variational estimate", fast_variational_estimate_ ? "YES" : "NO"},
+        {"Incremental variational estimate", incremental_variational_estimate_ ? "YES" : "NO"},
         {"Result perturbation analysis", do_perturb_analysis_ ? "YES" : "NO"},
         {"Using OpenMP", have_omp_ ? "YES" : "NO"},
     };
@@ -598,10 +658,125 @@ double ProjectorCI::estimate_high_energy() {
     psi::outfile->Printf("\n  %s", str(high_det).c_str());
     psi::outfile->Printf("\n  Determinant Energy                    :  %.12f",
                          as_ints_->energy(high_det));
-    psi::outfile->Printf("\n  Highest Energy Gershgorin circle Est. :  %.12f", lambda_h_);
+    psi::outfile->Printf("\n  Highest Energy Gershgorin circle Est. :  %.12f", lambda_h_G);
+
+    if (lanczos_high_energy_) {
+        auto [ritz, bound] = estimate_high_energy_lanczos(high_det);
+        // the Ritz value is a lower bound to the highest eigenvalue, so it overrides a Gershgorin
+        // estimate that is too low. Otherwise use the tighter of the two upper estimates
+        lambda_h_ = std::max(ritz, std::min(lambda_h_G, bound));
+        psi::outfile->Printf("\n  Highest Energy Lanczos Ritz value     :  %.12f", ritz);
+        psi::outfile->Printf("\n  Highest Energy Lanczos bound          :  %.12f", bound);
+        psi::outfile->Printf("\n  Highest Energy Est.                   :  %.12f", lambda_h_);
+    }
     return lambda_h_;
 }
 
+std::pair<double, double> ProjectorCI::estimate_high_energy_lanczos(const Determinant& high_det) {
+    local_timer timer;
+    // the screened space is grown from the Ritz vector a few times, each time adding the
+    // determinants strongly coupled to it, until the estimate stops changing
+    const int max_refinements = 4;
+    const std::vector<std::pair<det_hashvec, std::vector<double>>> no_roots;
+
+    det_hashvec dets;
+    dets.add(high_det);
+    std::vector<double> ref_C(1, 1.0);
+
+    double ritz = as_ints_->energy(high_det);
+    double bound = ritz;
+    for (int refinement = 0; refinement < max_refinements; ++refinement) {
+        // the sigma vector adds the determinants spawned from ref_C to dets
+        PCISigmaVector sigma_vector(dets, ref_C, lanczos_spawning_threshold_, as_ints_,
+                                    prescreen_H_CI_, important_H_CI_CJ_, a_couplings_,
+                                    b_couplings_, aa_couplings_, ab_couplings_, bb_couplings_,
+                                    dets_max_couplings_, dets_single_max_coupling_,
+                                    dets_double_max_coupling_, no_roots);
+        size_t size = sigma_vector.size();
+
+        // Lanczos with full reorthogonalization, the screened space is small
+        std::vector<std::vector<double>> basis;
+        std::vector<double> alpha, beta;
+        std::vector<double> v(ref_C);
+        v.resize(size, 0.0);
+        normalize(v);
+
+        psi::SharedVector b = std::make_shared<psi::Vector>(size);
+        psi::SharedVector sigma = std::make_shared<psi::Vector>(size);
+        double old_ritz = ritz;
+        std::vector<double> ritz_vector;
+        for (int k = 0; k < lanczos_maxiter_ and k < static_cast<int>(size); ++k) {
+            basis.push_back(v);
+            set_psi_Vector(b, v);
+            sigma_vector.compute_sigma(sigma, b);
+            std::vector<double> w = to_std_vector(sigma);
+
+            double a = 0.0;
+            for (size_t I = 0; I < size; ++I) {
+                a += v[I] * w[I];
+            }
+            alpha.push_back(a);
+            for (const auto& u : basis) {
+                double overlap = 0.0;
+                for (size_t I = 0; I < size; ++I) {
+                    overlap += u[I] * w[I];
+                }
+                for (size_t I = 0; I < size; ++I) {
+                    w[I] -= overlap * u[I];
+                }
+            }
+            double norm = 0.0;
+            for (size_t I = 0; I < size; ++I) {
+                norm += w[I] * w[I];
+            }
+            norm = std::sqrt(norm);
+
+            // largest eigenvalue of the tridiagonal matrix and its residual norm
+            int dim = k + 1;
+            auto T = std::make_shared<psi::Matrix>("T", dim, dim);
+            auto evecs = std::make_shared<psi::Matrix>("T evecs", dim, dim);
+            auto evals = std::make_shared<psi::Vector>("T evals", dim);
+            for (int i = 0; i < dim; ++i) {
+                T->set(i, i, alpha[i]);
+                if (i > 0) {
+                    T->set(i, i - 1, beta[i - 1]);
+                    T->set(i - 1, i, beta[i - 1]);
+                }
+            }
+            T->diagonalize(evecs, evals);
+            ritz = evals->get(dim - 1);
+            double residual = std::fabs(norm * evecs->get(dim - 1, dim - 1));
+            bound = ritz + residual;
+
+            ritz_vector.assign(size, 0.0);
+            for (int i = 0; i < dim; ++i) {
+                double s = evecs->get(i, dim - 1);
+                for (size_t I = 0; I < size; ++I) {
+                    ritz_vector[I] += s * basis[i][I];
+                }
+            }
+
+            if (residual < lanczos_convergence_ or norm < 1.0e-12) {
+                break;
+            }
+            beta.push_back(norm);
+            for (size_t I = 0; I < size; ++I) {
+                v[I] = w[I] / norm;
+            }
+        }
+        add_sigma_build_timings(sigma_vector.get_sigma_build_timings());
+
+        psi::outfile->Printf("\n  Lanczos estimate on %10zu determinants: %.12f (bound %.12f)",
+                             size, ritz, bound);
+        if (std::fabs(ritz - old_ritz) < lanczos_convergence_ and refinement > 0) {
+            break;
+        }
+        ref_C.swap(ritz_vector);
+    }
+    psi::outfile->Printf("\n  Lanczos high energy estimate took %.3f s", timer.get());
+    return std::make_pair(ritz, bound);
+}
+
 void ProjectorCI::convergence_analysis() {
     estimate_high_energy();
     compute_characteristic_function();
@@ -619,6 +794,12 @@ void ProjectorCI::compute_characteristic_function() {
     }
 }
 
+void ProjectorCI::add_sigma_build_timings(const std::map<std::string, double>& timings) {
+    for (const auto& [phase, time] : timings) {
+        sigma_build_timings_[phase] += time;
+    }
+}
+
 void ProjectorCI::print_characteristic_function() {
     psi::outfile->Printf("\n\n  ==> Characteristic Function <==");
     print_polynomial(cha_func_coefs_);
@@ -643,6 +824,9 @@ void ProjectorCI::pre_iter_preparation() {
 
     dets_hashvec_.clear();
     C_.clear();
+    incremental_var_energy_ = std::numeric_limits<double>::quiet_NaN();
+    step_ref_C_.clear();
+    step_ref_sigma_.clear();
 
     psi::timer_on("PCI:Couplings");
     double factor = std::max(1.0, std::pow(2.0, 1.0 / functional_order_ - 0.5));
@@ -657,7 +841,7 @@ void ProjectorCI::pre_iter_preparation() {
     proj_energy_ = var_energy_;
 
     psi::timer_on("PCI:sort");
-    sortHashVecByCoefficient(dets_hashvec_, C_);
+    bucketHashVecByCoefficient(dets_hashvec_, C_);
     psi::timer_off("PCI:sort");
 
     //    print_wfn(dets_hashvec_, C_, 1); TODO: re-enable [sci_cleanup]
@@ -724,8 +908,17 @@ void ProjectorCI::diagonalize_PQ_space() {
     normalize(C_);
     psi::timer_off("PCI:Ortho");
 
+    // Update the variational energy before the determinants are reordered
+    if (variational_estimate_ and incremental_variational_estimate_ and
+        step_ref_C_.size() == C_.size()) {
+        psi::timer_on("PCI:<E>vi");
+        incremental_var_energy_ =
+            estimate_var_energy_incremental(dets_hashvec_, C_, energy_estimate_threshold_);
+        psi::timer_off("PCI:<E>vi");
+    }
+
     psi::timer_on("PCI:sort");
-    sortHashVecByCoefficient(dets_hashvec_, C_);
+    bucketHashVecByCoefficient(dets_hashvec_, C_);
     psi::timer_off("PCI:sort");
 }
 
@@ -817,6 +1010,10 @@ void ProjectorCI::post_iter_process() {
     psi::outfile->Printf("\n\n  ==> Post-Iterations <==\n");
     psi::outfile->Printf("\n  * Size of CI space                    = %zu", C_.size());
     psi::outfile->Printf("\n  * Number of off-diagonal elements     = %zu", num_off_diag_elem_);
+    for (const auto& [phase, time] : sigma_build_timings_) {
+        psi::outfile->Printf("\n  * Sigma build time (%-8s)          = %10.3f s", phase.c_str(),
+                             time);
+    }
     psi::outfile->Printf("\n  * ProjectorCI Approximate Energy    = %18.12f Eh", 1, approx_energy_);
     psi::outfile->Printf("\n  * ProjectorCI Projective  Energy    = %18.12f Eh", 1, proj_energy_);
 
@@ -944,6 +1141,7 @@ double ProjectorCI::initial_guess(det_hashvec& dets_hashvec, std::vector<double>
     sigma_vector.compute_sigma(sigma_psi, C_psi);
     C = to_std_vector(sigma_psi);
     num_off_diag_elem_ = sigma_vector.get_num_off_diag();
+    add_sigma_build_timings(sigma_vector.get_sigma_build_timings());
 
     //    apply_tau_H_symm(time_step_, initial_guess_spawning_threshold_, dets_hashvec, start_C, C,
     //    0.0,
@@ -1050,9 +1248,16 @@ void ProjectorCI::propagate_wallCh(det_hashvec& dets_hashvec, std::vector<double
                       sigma_psi = std::make_shared<psi::Vector>(sigma_vector.size());
     set_psi_Vector(C_psi, ref_C);
     sigma_vector.compute_sigma(sigma_psi, C_psi);
+    if (variational_estimate_ and incremental_variational_estimate_) {
+        // keep H C0 for the incremental variational energy (see diagonalize_PQ_space)
+        step_ref_sigma_ = to_std_vector(sigma_psi);
+        step_ref_C_ = ref_C;
+        step_ref_C_.resize(sigma_vector.size(), 0.0);
+    }
     sigma_psi->scale(-1.0);
     C = to_std_vector(sigma_psi);
     num_off_diag_elem_ = sigma_vector.get_num_off_diag();
+    add_sigma_build_timings(sigma_vector.get_sigma_build_timings());
 
     double S = range_ * root + shift_;
 #pragma omp parallel for
@@ -1151,6 +1356,7 @@ void ProjectorCI::propagate_DL(det_hashvec& dets_hashvec, std::vector<double>& C
         det_map, sigma_vector, nroot_, state_.multiplicity());
 
     current_davidson_iter_ = sigma_vector->get_sigma_build_count();
+    add_sigma_build_timings(sigma_vector->get_sigma_build_timings());
     old_approx_energy_ = approx_energy_;
     approx_energy_ = PQ_evals_->get(0) + as_ints_->scalar_energy() + nuclear_repulsion_energy_;
     C.resize(result_size);
@@ -1169,7 +1375,9 @@ std::map<std::string, double> ProjectorCI::estimate_energy(const det_hashvec& de
     psi::timer_off("PCI:<E>p");
 
     if (variational_estimate_) {
-        if (fast_variational_estimate_) {
+        if (incremental_variational_estimate_ and not std::isnan(incremental_var_energy_)) {
+            results["VARIATIONAL ENERGY"] = incremental_var_energy_;
+        } else if (fast_variational_estimate_) {
             psi::timer_on("PCI:<E>vs");
             results["VARIATIONAL ENERGY"] =
                 estimate_var_energy_sparse(dets_hashvec, C, energy_estimate_threshold_);
@@ -1194,12 +1402,15 @@ double ProjectorCI::estimate_proj_energy(const det_hashvec& dets_hashvec, std::v
     size_t J = std::distance(C.begin(), result);
     double CJ = C[J];
 
-    // Compute the projective energy
+    // Compute the projective energy (the determinants are distributed cyclically over the ranks)
+    int rank, nproc;
+    std::tie(rank, nproc) = pci_mpi_rank_size();
     double projective_energy_estimator = 0.0;
-    for (int I = 0, max_I = dets_hashvec.size(); I < max_I; ++I) {
+    for (int I = rank, max_I = dets_hashvec.size(); I < max_I; I += nproc) {
         double HIJ = as_ints_->slater_rules(dets_hashvec[I], dets_hashvec[J]);
         projective_energy_estimator += HIJ * C[I] / CJ;
     }
+    pci_mpi_sum(&projective_energy_estimator, 1, nproc);
     return projective_energy_estimator + nuclear_repulsion_energy_ + as_ints_->scalar_energy();
 }
 
@@ -1207,9 +1418,11 @@ double ProjectorCI::estimate_var_energy(const det_hashvec& dets_hashvec, std::ve
                                         double tollerance) {
     // Compute a variational estimator of the energy
     size_t size = dets_hashvec.size();
+    int rank, nproc;
+    std::tie(rank, nproc) = pci_mpi_rank_size();
     double variational_energy_estimator = 0.0;
-#pragma omp parallel for reduction(+ : variational_energy_estimator)
-    for (size_t I = 0; I < size; ++I) {
+#pragma omp parallel for reduction(+ : variational_energy_estimator) schedule(dynamic)
+    for (size_t I = rank; I < size; I += nproc) {
         const Determinant& detI = dets_hashvec[I];
         variational_energy_estimator += C[I] * C[I] * as_ints_->energy(detI);
         for (size_t J = I + 1; J < size; ++J) {
@@ -1219,9 +1432,55 @@ double ProjectorCI::estimate_var_energy(const det_hashvec& dets_hashvec, std::ve
             }
         }
     }
+    pci_mpi_sum(&variational_energy_estimator, 1, nproc);
     return variational_energy_estimator + nuclear_repulsion_energy_ + as_ints_->scalar_energy();
 }
 
+double ProjectorCI::estimate_var_energy_incremental(const det_hashvec& dets_hashvec,
+                                                    const std::vector<double>& C,
+                                                    double tollerance) {
+    size_t size = dets_hashvec.size();
+    std::vector<double> dC(size);
+    double max_dC = 0.0;
+    double ref_energy = 0.0;
+    double first_order = 0.0;
+#pragma omp parallel for reduction(+ : ref_energy, first_order) reduction(max : max_dC)
+    for (size_t I = 0; I < size; ++I) {
+        dC[I] = C[I] - step_ref_C_[I];
+        max_dC = std::max(max_dC, std::fabs(dC[I]));
+        ref_energy += step_ref_C_[I] * step_ref_sigma_[I];
+        first_order += 2.0 * dC[I] * step_ref_sigma_[I];
+    }
+
+    // only the determinants with |dC_I| max|dC| > tollerance can contribute to <dC|H|dC>
+    std::vector<size_t> changed;
+    for (size_t I = 0; I < size; ++I) {
+        if (std::fabs(dC[I]) * max_dC > tollerance) {
+            changed.push_back(I);
+        }
+    }
+
+    int rank, nproc;
+    std::tie(rank, nproc) = pci_mpi_rank_size();
+    size_t nchanged = changed.size();
+    double second_order = 0.0;
+#pragma omp parallel for reduction(+ : second_order) schedule(dynamic)
+    for (size_t i = rank; i < nchanged; i += nproc) {
+        size_t I = changed[i];
+        second_order += dC[I] * dC[I] * as_ints_->energy(dets_hashvec[I]);
+        for (size_t j = i + 1; j < nchanged; ++j) {
+            size_t J = changed[j];
+            if (std::fabs(dC[I] * dC[J]) > tollerance) {
+                double HIJ = as_ints_->slater_rules(dets_hashvec[I], dets_hashvec[J]);
+                second_order += 2.0 * dC[I] * HIJ * dC[J];
+            }
+        }
+    }
+    pci_mpi_sum(&second_order, 1, nproc);
+    return ref_energy + first_order + second_order + nuclear_repulsion_energy_ +
+           as_ints_->scalar_energy();
+}
+
 double ProjectorCI::estimate_var_energy_within_error(const det_hashvec& dets_hashvec,
                                                      std::vector<double>& C, double max_error) {
     // Compute a variational estimator of the energy
@@ -1244,9 +1503,11 @@ double ProjectorCI::estimate_var_energy_within_error(const det_hashvec& dets_has
     psi::outfile->Printf(
         "\n  Variational energy estimated with %zu determinants to meet the max error %e",
         cut_index + 1, max_error);
+    int rank, nproc;
+    std::tie(rank, nproc) = pci_mpi_rank_size();
     double variational_energy_estimator = 0.0;
-#pragma omp parallel for reduction(+ : variational_energy_estimator)
-    for (size_t I = 0; I <= cut_index; ++I) {
+#pragma omp parallel for reduction(+ : variational_energy_estimator) schedule(dynamic)
+    for (size_t I = rank; I <= cut_index; I += nproc) {
         const Determinant& detI = dets_hashvec[I];
         variational_energy_estimator += C[I] * C[I] * as_ints_->energy(detI);
         for (size_t J = I + 1; J <= cut_index; ++J) {
@@ -1254,6 +1515,7 @@ double ProjectorCI::estimate_var_energy_within_error(const det_hashvec& dets_has
             variational_energy_estimator += 2.0 * C[I] * HIJ * C[J];
         }
     }
+    pci_mpi_sum(&variational_energy_estimator, 1, nproc);
     variational_energy_estimator /= 1.0 - cume_ignore;
     return variational_energy_estimator + nuclear_repulsion_energy_ + as_ints_->scalar_energy();
 }
@@ -1330,13 +1592,16 @@ double ProjectorCI::estimate_var_energy_sparse(const det_hashvec& dets_hashvec,
     double variational_energy_estimator = 0.0;
     std::vector<double> energy(num_threads_, 0.0);
 
+    int rank, nproc;
+    std::tie(rank, nproc) = pci_mpi_rank_size();
     size_t full_num_off_diag_elem = 0;
 #pragma omp parallel for reduction(+ : full_num_off_diag_elem)
-    for (size_t I = 0; I <= cut_index; ++I) {
+    for (size_t I = rank; I <= cut_index; I += nproc) {
         size_t thread_num_off_diag_elem = 0;
         energy[omp_get_thread_num()] += form_H_C(dets_hashvec, C, I, thread_num_off_diag_elem);
         full_num_off_diag_elem += thread_num_off_diag_elem;
     }
+    pci_mpi_sum(energy.data(), energy.size(), nproc);
     psi::outfile->Printf("\n  * Subspace Hamiltonian number of off-diagonal elements = %zu",
                          full_num_off_diag_elem);
     for (int t = 0; t < num_threads_; ++t) {
@@ -32,6 +32,8 @@
 
 #include <fstream>
 #include <functional>
+#include <map>
+#include <string>
 
 #include "psi4/libmints/wavefunction.h"
 
@@ -41,6 +43,7 @@
 #include "forte-def.h"
 #include "base_classes/forte_options.h"
 #include "helpers/hash_vector.h"
+#include "helpers/flat_hash_vector.h"
 #include "base_classes/mo_space_info.h"
 #include "integrals/integrals.h"
 #include "sparse_ci/sparse_ci_solver.h"
@@ -53,7 +56,11 @@ class SCFInfo;
 
 enum GeneratorType { WallChebyshevGenerator, DLGenerator };
 
+#ifdef ENABLE_FLAT_HASH_VECTOR
+using det_hashvec = FlatHashVector<Determinant, Determinant::Hash>;
+#else
 using det_hashvec = HashVector<Determinant, Determinant::Hash>;
+#endif
 
 /**
  * @brief The SparsePathIntegralCI class
@@ -209,12 +216,22 @@ class ProjectorCI : public SelectedCIMethod {
     size_t aa_couplings_size_, ab_couplings_size_, bb_couplings_size_, a_couplings_size_,
         b_couplings_size_;
     size_t num_off_diag_elem_;
+    /// The time (in seconds) spent in each phase of the sigma builds
+    std::map<std::string, double> sigma_build_timings_;
 
     // * Energy estimation
     /// Estimate the variational energy?
     bool variational_estimate_;
     /// Estimate the variational energy via a fast procedure?
     bool fast_variational_estimate_;
+    /// Update the variational energy estimate from the change of the coefficients?
+    bool incremental_variational_estimate_;
+    /// The wave function at the beginning of the last step and its sigma vector (computed by the
+    /// first Chebyshev factor), in the order of the determinants of the new wave function
+    std::vector<double> step_ref_C_;
+    std::vector<double> step_ref_sigma_;
+    /// The incremental variational energy of the last step (NaN if not available)
+    double incremental_var_energy_;
     /// The frequency of approximate variational estimation of the energy
     int energy_estimate_freq_;
     /// The max allowed error for variational energy
@@ -252,6 +269,14 @@ class ProjectorCI : public SelectedCIMethod {
     double lambda_1_;
     /// Highest possible e-value
     double lambda_h_;
+    /// Refine the Gershgorin estimate of lambda_h_ with a Lanczos iteration?
+    bool lanczos_high_energy_;
+    /// The maximum number of Lanczos iterations of the high energy estimate
+    int lanczos_maxiter_;
+    /// The spawning threshold of the screened Hamiltonian used by the Lanczos estimate
+    double lanczos_spawning_threshold_;
+    /// The convergence threshold of the Lanczos estimate
+    double lanczos_convergence_;
     /// Characteristic function coefficients
     std::vector<double> cha_func_coefs_;
     /// Do result perturbation analysis
@@ -318,6 +343,11 @@ class ProjectorCI : public SelectedCIMethod {
     /// C_J| < tollerance
     double estimate_var_energy(const det_hashvec& dets_hashvec, std::vector<double>& C,
                                double tollerance = 1.0e-14);
+    /// Estimates the variational energy of C from the wave function at the beginning of the step
+    /// (step_ref_C_) and its sigma vector: E = <C0|H|C0> + 2 <dC|H|C0> + <dC|H|dC>, with dC = C -
+    /// C0. Only the last term requires matrix elements, screened with |dC_I dC_J| > tollerance
+    double estimate_var_energy_incremental(const det_hashvec& dets_hashvec,
+                                           const std::vector<double>& C, double tollerance);
     /// Estimates the variational energy within a given error
     /// @param dets The set of determinants that form the wave function
     /// @param C The wave function coefficients
@@ -347,12 +377,18 @@ class ProjectorCI : public SelectedCIMethod {
 
     /// Estimate the highest possible energy
     double estimate_high_energy();
+    /// Estimate the highest eigenvalue with a Lanczos iteration on a screened Hamiltonian, started
+    /// from the highest excited determinant. Returns the largest Ritz value and its upper bound
+    /// (Ritz value + residual norm)
+    std::pair<double, double> estimate_high_energy_lanczos(const Determinant& high_det);
     /// Convergence estimation
     void convergence_analysis();
     /// Compute the characteristic function for projector
     void compute_characteristic_function();
     /// Print the characteristic function
     void print_characteristic_function();
+    /// Add the timings of the sigma builds of a PCISigmaVector to sigma_build_timings_
+    void add_sigma_build_timings(const std::map<std::string, double>& timings);
 
     /// Test the convergence of calculation
     bool converge_test();
@@ -370,6 +406,15 @@ class ProjectorCI : public SelectedCIMethod {
 
     /// Sort the determinants by coefficients
     void sortHashVecByCoefficient(det_hashvec& dets_hashvec, std::vector<double>& C);
+    /**
+     * @brief Order the determinants approximately by coefficients
+     *
+     * The determinants are grouped in buckets of |C| that differ by a factor of two, in order of
+     * decreasing |C|, and the largest determinant is placed first. The order within a bucket is
+     * kept, so determinants that were already sorted stay nearly sorted across iterations. This
+     * takes linear time and is enough for the tail truncations of the energy estimators.
+     */
+    void bucketHashVecByCoefficient(det_hashvec& dets_hashvec, std::vector<double>& C);
 };
 } // namespace forte
 
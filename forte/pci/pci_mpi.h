@@ -0,0 +1,187 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _pci_mpi_h_
+#define _pci_mpi_h_
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include "sparse_ci/concurrent_det_accumulator.h"
+#include "sparse_ci/determinant.h"
+
+namespace forte {
+
+/**
+ * Helpers for the distributed-memory PCI propagation
+ *
+ * When Forte is compiled with MPI, the determinants are hash-partitioned across the ranks: each
+ * rank applies H only to the determinants it owns, the amplitudes spawned onto new determinants
+ * are sent in batches to the rank that owns them, and the contributions to the determinants of
+ * the current space and to the energy estimators are summed over the ranks. Without MPI these
+ * functions reduce to the serial case (one rank that owns everything).
+ */
+
+/// The rank of this process and the number of ranks
+inline std::pair<int, int> pci_mpi_rank_size() {
+    int rank = 0;
+    int nproc = 1;
+#ifdef HAVE_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+#endif
+    return std::make_pair(rank, nproc);
+}
+
+/// The rank that owns a determinant
+inline int pci_mpi_owner(const Determinant& det, int nproc) {
+    return nproc == 1 ? 0 : static_cast<int>(Determinant::Hash()(det) % nproc);
+}
+
+/// Sum an array of doubles over all the ranks (in place)
+inline void pci_mpi_sum(double* data, size_t n, int nproc) {
+#ifdef HAVE_MPI
+    if (nproc > 1) {
+        MPI_Allreduce(MPI_IN_PLACE, data, static_cast<int>(n), MPI_DOUBLE, MPI_SUM,
+                      MPI_COMM_WORLD);
+    }
+#else
+    (void)data;
+    (void)n;
+    (void)nproc;
+#endif
+}
+
+/// Take the logical or of an array of flags over all the ranks (in place)
+inline void pci_mpi_or(std::vector<unsigned char>& flags, int nproc) {
+#ifdef HAVE_MPI
+    if (nproc > 1) {
+        MPI_Allreduce(MPI_IN_PLACE, flags.data(), static_cast<int>(flags.size()),
+                      MPI_UNSIGNED_CHAR, MPI_MAX, MPI_COMM_WORLD);
+    }
+#else
+    (void)flags;
+    (void)nproc;
+#endif
+}
+
+#ifdef HAVE_MPI
+/// The maximum number of spawned amplitudes sent to one rank in one exchange
+constexpr size_t pci_mpi_batch_size = 1 << 20;
+#endif
+
+/**
+ * @brief Collect the amplitudes spawned onto new determinants by all the ranks
+ *
+ * The amplitudes are sent in batches to the owner of each determinant, which accumulates them.
+ * The accumulated list is then gathered on all the ranks in rank order, so that every rank adds
+ * the new determinants to its space in the same order.
+ */
+inline std::vector<std::pair<Determinant, double>>
+pci_mpi_collect_spawned(ConcurrentDetAccumulator& spawned, int nproc) {
+    std::vector<std::pair<Determinant, double>> result = spawned.collect();
+    if (nproc == 1) {
+        return result;
+    }
+#ifdef HAVE_MPI
+    static_assert(std::is_trivially_copyable<Determinant>::value,
+                  "Determinant must be trivially copyable to be sent with MPI");
+    using Record = std::pair<Determinant, double>;
+
+    // Sort the spawned amplitudes by owner
+    std::vector<std::vector<Record>> send_lists(nproc);
+    for (const auto& det_C : result) {
+        send_lists[pci_mpi_owner(det_C.first, nproc)].push_back(det_C);
+    }
+    result.clear();
+    size_t max_list = 0;
+    for (const auto& list : send_lists) {
+        max_list = std::max(max_list, list.size());
+    }
+    unsigned long long nbatch_local = (max_list + pci_mpi_batch_size - 1) / pci_mpi_batch_size;
+    unsigned long long nbatch = 0;
+    MPI_Allreduce(&nbatch_local, &nbatch, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+
+    // Exchange the amplitudes in batches and accumulate the ones owned by this rank
+    det_hash<double> owned;
+    for (size_t batch = 0; batch < nbatch; ++batch) {
+        std::vector<int> send_counts(nproc), send_displs(nproc), recv_counts(nproc),
+            recv_displs(nproc);
+        std::vector<Record> send_buffer;
+        for (int r = 0; r < nproc; ++r) {
+            size_t begin = std::min(batch * pci_mpi_batch_size, send_lists[r].size());
+            size_t end = std::min(begin + pci_mpi_batch_size, send_lists[r].size());
+            send_displs[r] = static_cast<int>(send_buffer.size() * sizeof(Record));
+            send_counts[r] = static_cast<int>((end - begin) * sizeof(Record));
+            send_buffer.insert(send_buffer.end(), send_lists[r].begin() + begin,
+                               send_lists[r].begin() + end);
+        }
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT,
+                     MPI_COMM_WORLD);
+        size_t recv_size = 0;
+        for (int r = 0; r < nproc; ++r) {
+            recv_displs[r] = static_cast<int>(recv_size);
+            recv_size += recv_counts[r];
+        }
+        std::vector<Record> recv_buffer(recv_size / sizeof(Record));
+        MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displs.data(), MPI_BYTE,
+                      recv_buffer.data(), recv_counts.data(), recv_displs.data(), MPI_BYTE,
+                      MPI_COMM_WORLD);
+        for (const auto& det_C : recv_buffer) {
+            owned[det_C.first] += det_C.second;
+        }
+    }
+    send_lists.clear();
+
+    // Gather the accumulated amplitudes on all the ranks
+    std::vector<Record> local(owned.begin(), owned.end());
+    owned.clear();
+    int local_count = static_cast<int>(local.size() * sizeof(Record));
+    std::vector<int> counts(nproc), displs(nproc);
+    MPI_Allgather(&local_count, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    size_t total_size = 0;
+    for (int r = 0; r < nproc; ++r) {
+        displs[r] = static_cast<int>(total_size);
+        total_size += counts[r];
+    }
+    result.resize(total_size / sizeof(Record));
+    MPI_Allgatherv(local.data(), local_count, MPI_BYTE, result.data(), counts.data(),
+                   displs.data(), MPI_BYTE, MPI_COMM_WORLD);
+#endif
+    return result;
+}
+
+} // namespace forte
+
+#endif // _pci_mpi_h_
@@ -33,8 +33,11 @@
 #include <algorithm>
 
 #include "psi4/libmints/vector.h"
+#include "psi4/libqt/qt.h"
 
+#include "helpers/timer.h"
 #include "integrals/active_space_integrals.h"
+#include "pci_mpi.h"
 #include "pci_sigma.h"
 
 namespace forte {
@@ -45,12 +48,6 @@ namespace forte {
 #define omp_get_thread_num() 0
 #endif
 
-void add(const det_hashvec& A, std::vector<double>& Ca, double beta, const det_hashvec& B,
-         const std::vector<double> Cb);
-
-double dot(const det_hashvec& A, const std::vector<double> Ca, const det_hashvec& B,
-           const std::vector<double> Cb);
-
 std::vector<double> to_std_vector(psi::SharedVector c) {
     const size_t c_size = c->dim();
     std::vector<double> c_vec(c_size);
@@ -62,6 +59,86 @@ void set_psi_Vector(psi::SharedVector c_psi, const std::vector<double>& c_vec) {
     std::memcpy(c_psi->pointer(), c_vec.data(), c_vec.size() * sizeof(double));
 }
 
+PCIExcitationTable::PCIExcitationTable(
+    const std::vector<std::tuple<int, double, std::vector<std::tuple<int, double>>>>& couplings) {
+    rows.reserve(couplings.size());
+    for (const auto& [i, max_coupling, sub_couplings] : couplings) {
+        size_t begin = entries.size();
+        for (const auto& [a, coupling] : sub_couplings) {
+            entries.push_back({a, -1, coupling});
+        }
+        rows.push_back({i, -1, max_coupling, begin, entries.size()});
+    }
+}
+
+PCIExcitationTable::PCIExcitationTable(
+    const std::vector<std::tuple<int, int, double, std::vector<std::tuple<int, int, double>>>>&
+        couplings) {
+    rows.reserve(couplings.size());
+    for (const auto& [i, j, max_coupling, sub_couplings] : couplings) {
+        size_t begin = entries.size();
+        for (const auto& [a, b, coupling] : sub_couplings) {
+            entries.push_back({a, b, coupling});
+        }
+        rows.push_back({i, j, max_coupling, begin, entries.size()});
+    }
+}
+
+namespace {
+/// Return the end of the entries of a row that pass the prescreening. The entries are sorted by
+/// decreasing |coupling| and the prescreening is monotonic in |coupling|, so the entries that
+/// pass it are a prefix of the row
+size_t prescreened_end(const PCIExcitationTable& table, const PCIExcitationTable::Row& row,
+                       const std::function<bool(double, double, double)>& prescreen, double CI,
+                       double spawning_threshold) {
+    auto end = std::partition_point(
+        table.entries.begin() + row.begin, table.entries.begin() + row.end,
+        [&](const PCIExcitationTable::Entry& e) {
+            return prescreen(e.coupling, CI, spawning_threshold);
+        });
+    return static_cast<size_t>(end - table.entries.begin());
+}
+
+/// Call f(i, a) for the single excitations i -> a of a table allowed by the occupation occ
+template <class Occupied, class F>
+void scan_singles(const PCIExcitationTable& table, Occupied occ,
+                  const std::function<bool(double, double, double)>& prescreen, double CI,
+                  double spawning_threshold, F&& f) {
+    for (const auto& row : table.rows) {
+        if (std::fabs(row.max_coupling * CI) < spawning_threshold)
+            break;
+        if (not occ(row.i))
+            continue;
+        const size_t end = prescreened_end(table, row, prescreen, CI, spawning_threshold);
+        for (size_t e = row.begin; e < end; ++e) {
+            const int a = table.entries[e].a;
+            if (not occ(a))
+                f(row.i, a);
+        }
+    }
+}
+
+/// Call f(i, j, a, b, H) for the double excitations ij -> ab of a table allowed by the
+/// occupations occ1 (orbitals i and a) and occ2 (orbitals j and b)
+template <class Occupied1, class Occupied2, class F>
+void scan_doubles(const PCIExcitationTable& table, Occupied1 occ1, Occupied2 occ2,
+                  const std::function<bool(double, double, double)>& prescreen, double CI,
+                  double spawning_threshold, F&& f) {
+    for (const auto& row : table.rows) {
+        if (std::fabs(row.max_coupling * CI) < spawning_threshold)
+            break;
+        if (not(occ1(row.i) and occ2(row.j)))
+            continue;
+        const size_t end = prescreened_end(table, row, prescreen, CI, spawning_threshold);
+        for (size_t e = row.begin; e < end; ++e) {
+            const auto& entry = table.entries[e];
+            if (not(occ1(entry.a) or occ2(entry.b)))
+                f(row.i, row.j, entry.a, entry.b, entry.coupling);
+        }
+    }
+}
+} // namespace
+
 PCISigmaVector::PCISigmaVector(
     det_hashvec& dets_hashvec, std::vector<double>& ref_C, double spawning_threshold,
     std::shared_ptr<ActiveSpaceIntegrals> as_ints,
@@ -83,20 +160,21 @@ PCISigmaVector::PCISigmaVector(
       dets_(dets_hashvec), spawning_threshold_(spawning_threshold), as_ints_(as_ints),
       prescreen_H_CI_(prescreen_H_CI), important_H_CI_CJ_(important_H_CI_CJ),
       dets_max_couplings_(dets_max_couplings), dets_single_max_coupling_(dets_single_max_coupling),
-      a_couplings_(a_couplings), b_couplings_(b_couplings), a_couplings_size_(a_couplings.size()),
-      b_couplings_size_(b_couplings.size()), dets_double_max_coupling_(dets_double_max_coupling),
-      aa_couplings_(aa_couplings), ab_couplings_(ab_couplings), bb_couplings_(bb_couplings),
-      aa_couplings_size_(aa_couplings.size()), ab_couplings_size_(ab_couplings.size()),
-      bb_couplings_size_(bb_couplings.size()), bad_roots_(bad_roots),
+      dets_double_max_coupling_(dets_double_max_coupling), a_table_(a_couplings),
+      b_table_(b_couplings), aa_table_(aa_couplings), ab_table_(ab_couplings),
+      bb_table_(bb_couplings), bad_roots_(bad_roots),
       num_threads_(omp_get_max_threads()) {
+    std::tie(rank_, nproc_) = pci_mpi_rank_size();
     reset(ref_C);
 }
 
 void PCISigmaVector::reset(std::vector<double>& ref_C) {
     sigma_build_count_ = 0;
     ref_size_ = ref_C.size();
-    orthogonalize(dets_, ref_C, bad_roots_);
+    build_solution_block(dets_);
+    orthogonalize(ref_C.data(), 1);
     apply_tau_H_symm(spawning_threshold_, dets_, ref_C, first_sigma_vec_, ref_size_);
+    build_solution_block(dets_);
     ref_C_ = ref_C;
     size_ = dets_.size();
 
@@ -106,24 +184,75 @@ void PCISigmaVector::reset(std::vector<double>& ref_C) {
     }
 }
 
+bool PCISigmaVector::is_first_sigma(psi::SharedVector b) {
+    return (not first_sigma_vec_.empty()) and
+           0 == std::memcmp(ref_C_.data(), b->pointer(), ref_size_) and
+           std::all_of(b->pointer() + ref_size_, b->pointer() + b->dim(),
+                       [](double x) { return x == 0; });
+}
+
 void PCISigmaVector::compute_sigma(psi::SharedVector sigma, psi::SharedVector b) {
-    if ((not first_sigma_vec_.empty()) and
-        0 == std::memcmp(ref_C_.data(), b->pointer(), ref_size_) and
-        std::all_of(b->pointer() + ref_size_, b->pointer() + b->dim(),
-                    [](double x) { return x == 0; })) {
+    if (is_first_sigma(b)) {
         set_psi_Vector(sigma, first_sigma_vec_);
         first_sigma_vec_.clear();
     } else {
         std::vector<double> b_vec = to_std_vector(b);
-        orthogonalize(dets_, b_vec, bad_roots_);
+        orthogonalize(b_vec.data(), 1);
         set_psi_Vector(b, b_vec);
         std::vector<double> sigma_vec;
-        apply_tau_H_ref_C_symm(spawning_threshold_, dets_, ref_C_, b_vec, sigma_vec, ref_size_);
+        apply_tau_H_ref_C_symm(spawning_threshold_, dets_, ref_C_, b_vec.data(), 1, sigma_vec,
+                               ref_size_);
         set_psi_Vector(sigma, sigma_vec);
     }
     ++sigma_build_count_;
 }
 
+void PCISigmaVector::compute_sigma_block(const std::vector<psi::SharedVector>& sigma,
+                                         const std::vector<psi::SharedVector>& b) {
+    if (sigma.size() != b.size()) {
+        throw std::runtime_error("PCISigmaVector::compute_sigma_block: the number of sigma (" +
+                                 std::to_string(sigma.size()) + ") and b (" +
+                                 std::to_string(b.size()) + ") vectors do not match");
+    }
+    // the vectors that are not the first sigma build are processed together
+    std::vector<size_t> block;
+    for (size_t n = 0, nvec = b.size(); n < nvec; ++n) {
+        if (is_first_sigma(b[n])) {
+            compute_sigma(sigma[n], b[n]);
+        } else {
+            block.push_back(n);
+        }
+    }
+    const size_t nvec = block.size();
+    if (nvec == 0)
+        return;
+    if (nvec == 1) {
+        compute_sigma(sigma[block[0]], b[block[0]]);
+        return;
+    }
+
+    // store the vectors interleaved, b_block[I * nvec + n] = b[n][I]
+    std::vector<double> b_block(size_ * nvec);
+#pragma omp parallel for
+    for (size_t I = 0; I < size_; ++I) {
+        for (size_t n = 0; n < nvec; ++n) {
+            b_block[I * nvec + n] = b[block[n]]->get(I);
+        }
+    }
+    orthogonalize(b_block.data(), nvec);
+    std::vector<double> sigma_block;
+    apply_tau_H_ref_C_symm(spawning_threshold_, dets_, ref_C_, b_block.data(), nvec, sigma_block,
+                           ref_size_);
+#pragma omp parallel for
+    for (size_t I = 0; I < size_; ++I) {
+        for (size_t n = 0; n < nvec; ++n) {
+            b[block[n]]->set(I, b_block[I * nvec + n]);
+            sigma[block[n]]->set(I, sigma_block[I * nvec + n]);
+        }
+    }
+    sigma_build_count_ += nvec;
+}
+
 void PCISigmaVector::get_diagonal(psi::Vector& diag) {
     std::memcpy(diag.pointer(), diag_.data(), size_);
 }
@@ -144,61 +273,131 @@ size_t PCISigmaVector::get_num_off_diag() { return num_off_diag_elem_; }
 
 size_t PCISigmaVector::get_sigma_build_count() { return sigma_build_count_; }
 
-void PCISigmaVector::orthogonalize(
-    const det_hashvec& space, std::vector<double>& C,
-    const std::vector<std::pair<det_hashvec, std::vector<double>>>& solutions) {
-    for (size_t n = 0, solution_size = solutions.size(); n < solution_size; ++n) {
-        double dot_prod = dot(space, C, solutions[n].first, solutions[n].second);
-        add(space, C, -dot_prod, solutions[n].first, solutions[n].second);
+const std::map<std::string, double>& PCISigmaVector::get_sigma_build_timings() {
+    return timings_;
+}
+
+void PCISigmaVector::build_solution_block(const det_hashvec& space) {
+    const size_t nsol = bad_roots_.size();
+    const size_t space_size = space.size();
+    solution_coefs_.assign(nsol * space_size, 0.0);
+    solution_overlaps_.assign(nsol * nsol, 0.0);
+    if (nsol == 0 or space_size == 0)
+        return;
+    for (size_t m = 0; m < nsol; ++m) {
+        const auto& [sol_dets, sol_C] = bad_roots_[m];
+        const size_t sol_size = sol_dets.size();
+        double* S_m = solution_coefs_.data() + m * space_size;
+#pragma omp parallel for
+        for (size_t I = 0; I < space_size; ++I) {
+            size_t index = sol_dets.find(space[I]);
+            if (index < sol_size)
+                S_m[I] = sol_C[index];
+        }
     }
+    C_DGEMM('N', 'T', nsol, nsol, space_size, 1.0, solution_coefs_.data(), space_size,
+            solution_coefs_.data(), space_size, 0.0, solution_overlaps_.data(), nsol);
+}
+
+void PCISigmaVector::orthogonalize(double* C, size_t nvec) {
+    const size_t nsol = bad_roots_.size();
+    const size_t space_size = solution_coefs_.size() / std::max(nsol, size_t(1));
+    if (nsol == 0 or space_size == 0)
+        return;
+    // overlaps of the vectors with the solutions, O = S C
+    std::vector<double> O(nsol * nvec);
+    C_DGEMM('N', 'N', nsol, nvec, space_size, 1.0, solution_coefs_.data(), space_size, C, nvec,
+            0.0, O.data(), nvec);
+    // the coefficients of a sequential (modified) Gram-Schmidt projection of the solutions,
+    // o_m <- o_m - sum_{k < m} <s_k|s_m> o_k
+    for (size_t m = 1; m < nsol; ++m) {
+        for (size_t k = 0; k < m; ++k) {
+            const double G_km = solution_overlaps_[k * nsol + m];
+            for (size_t n = 0; n < nvec; ++n) {
+                O[m * nvec + n] -= G_km * O[k * nvec + n];
+            }
+        }
+    }
+    // C <- C - S^T O
+    C_DGEMM('T', 'N', space_size, nvec, nsol, -1.0, solution_coefs_.data(), space_size, O.data(),
+            nvec, 1.0, C, nvec);
 }
 
 void PCISigmaVector::apply_tau_H_symm(double spawning_threshold, det_hashvec& ref_dets,
                                       std::vector<double>& ref_C, std::vector<double>& result_C,
                                       size_t& overlap_size) {
-
+    local_timer t_spawn;
     size_t ref_size = ref_dets.size();
-    //    result_dets.clear();
     result_C.clear();
-    //    det_hashvec result_dets(ref_dets);
-    det_hashvec extra_dets;
-    std::vector<double> extra_C;
     result_C.resize(ref_size, DBL_MIN);
 
-    std::vector<std::vector<std::pair<Determinant, double>>> thread_det_C_vecs(num_threads_);
-    num_off_diag_elem_ = 0;
+    // The threads accumulate the spawned amplitudes directly in a lock-free table
+    ConcurrentDetAccumulator extra_dets_C;
+    extra_dets_C.reserve(ref_size);
 
+    // Read the coupling bounds of the determinants. The map is not modified in the loop below, so
+    // it can be searched concurrently
+    max_couplings_.assign(ref_size, std::make_pair(0.0, 0.0));
 #pragma omp parallel for
     for (size_t I = 0; I < ref_size; ++I) {
-        std::pair<double, double> max_coupling;
-        size_t current_rank = omp_get_thread_num();
-#pragma omp critical(dets_coupling)
-        { max_coupling = dets_max_couplings_[ref_dets[I]]; }
-        if (max_coupling.first == 0.0 or max_coupling.second == 0.0) {
-            thread_det_C_vecs[current_rank].clear();
-            apply_tau_H_symm_det_dynamic_HBCI_2(spawning_threshold, ref_dets, ref_C, I, ref_C[I],
-                                                result_C, thread_det_C_vecs[current_rank],
-                                                max_coupling);
-#pragma omp critical(merge_extra)
-            {
-                merge(extra_dets, extra_C, thread_det_C_vecs[current_rank],
-                      std::function<double(double, double)>(std::plus<double>()), 0.0, false);
-            }
-#pragma omp critical(dets_coupling)
-            { dets_max_couplings_[ref_dets[I]] = max_coupling; }
-        } else {
-            thread_det_C_vecs[current_rank].clear();
-            apply_tau_H_symm_det_dynamic_HBCI_2(spawning_threshold, ref_dets, ref_C, I, ref_C[I],
-                                                result_C, thread_det_C_vecs[current_rank],
-                                                max_coupling);
-#pragma omp critical(merge_extra)
-            {
-                merge(extra_dets, extra_C, thread_det_C_vecs[current_rank],
-                      std::function<double(double, double)>(std::plus<double>()), 0.0, false);
-            }
+        auto it = dets_max_couplings_.find(ref_dets[I]);
+        if (it != dets_max_couplings_.end())
+            max_couplings_[I] = it->second;
+    }
+    std::vector<unsigned char> new_max_couplings(ref_size, 0);
+
+    std::vector<std::vector<std::pair<Determinant, double>>> thread_det_C_vecs(num_threads_);
+    size_t num_off_diag = 0;
+
+    // Each MPI rank applies H to the determinants that it owns
+#pragma omp parallel for schedule(dynamic, 64) reduction(+ : num_off_diag)
+    for (size_t I = 0; I < ref_size; ++I) {
+        if (pci_mpi_owner(ref_dets[I], nproc_) != rank_)
+            continue;
+        std::pair<double, double>& max_coupling = max_couplings_[I];
+        new_max_couplings[I] = (max_coupling.first == 0.0 or max_coupling.second == 0.0);
+        auto& det_C_vec = thread_det_C_vecs[omp_get_thread_num()];
+        det_C_vec.clear();
+        apply_tau_H_symm_det_dynamic_HBCI_2(spawning_threshold, ref_dets, ref_C, I, ref_C[I],
+                                            result_C, det_C_vec, max_coupling, num_off_diag);
+        for (const auto& det_C : det_C_vec) {
+            extra_dets_C.add(det_C.first, det_C.second);
         }
     }
+    num_off_diag_elem_ = num_off_diag;
 
+    // Store the bounds found for the first time
+    for (size_t I = 0; I < ref_size; ++I) {
+        if (new_max_couplings[I])
+            dets_max_couplings_[ref_dets[I]] = max_couplings_[I];
+    }
+    timings_["spawn"] += t_spawn.get();
+
+    // Sum the contributions of all the ranks. The determinants that were not reached by any rank
+    // keep the value DBL_MIN and are removed below
+    local_timer t_reduce;
+    if (nproc_ > 1) {
+        std::vector<unsigned char> reached(ref_size);
+        for (size_t I = 0; I < ref_size; ++I) {
+            reached[I] = (result_C[I] != DBL_MIN);
+            if (not reached[I])
+                result_C[I] = 0.0;
+        }
+        pci_mpi_or(reached, nproc_);
+        pci_mpi_sum(result_C.data(), ref_size, nproc_);
+        for (size_t I = 0; I < ref_size; ++I) {
+            if (not reached[I])
+                result_C[I] = DBL_MIN;
+        }
+        double num_off_diag_sum = static_cast<double>(num_off_diag_elem_);
+        pci_mpi_sum(&num_off_diag_sum, 1, nproc_);
+        num_off_diag_elem_ = static_cast<size_t>(num_off_diag_sum);
+    }
+    auto spawned_dets_C = pci_mpi_collect_spawned(extra_dets_C, nproc_);
+    timings_["reduce"] += t_reduce.get();
+
+    // Remove the determinants that were not reached and append the spawned ones
+    local_timer t_update;
     std::vector<size_t> removing_indices;
     for (size_t I = 0; I < ref_size; ++I) {
         if (result_C[I] == DBL_MIN) {
@@ -206,28 +405,42 @@ void PCISigmaVector::apply_tau_H_symm(double spawning_threshold, det_hashvec& re
         }
     }
     ref_dets.erase_by_index(removing_indices);
-    std::reverse(removing_indices.begin(), removing_indices.end());
-    for (size_t I : removing_indices) {
-        result_C.erase(result_C.begin() + I);
-        ref_C.erase(ref_C.begin() + I);
+    size_t kept = 0;
+    for (size_t I = 0; I < ref_size; ++I) {
+        if (result_C[I] != DBL_MIN) {
+            result_C[kept] = result_C[I];
+            ref_C[kept] = ref_C[I];
+            max_couplings_[kept] = max_couplings_[I];
+            ++kept;
+        }
     }
+    result_C.resize(kept);
+    ref_C.resize(kept);
+    max_couplings_.resize(kept);
     overlap_size = ref_dets.size();
-    ref_dets.merge(extra_dets);
-    result_C.insert(result_C.end(), extra_C.begin(), extra_C.end());
+    ref_dets.reserve(overlap_size + spawned_dets_C.size());
+    result_C.reserve(overlap_size + spawned_dets_C.size());
+    for (const auto& det_C : spawned_dets_C) {
+        ref_dets.add(det_C.first);
+        result_C.push_back(det_C.second);
+    }
+    timings_["update"] += t_update.get();
 
+    local_timer t_diag;
     diag_.resize(ref_dets.size());
 #pragma omp parallel for
     for (size_t I = 0; I < overlap_size; ++I) {
         diag_[I] = as_ints_->energy(ref_dets[I]);
         result_C[I] += diag_[I] * ref_C[I];
     }
+    timings_["diagonal"] += t_diag.get();
 }
 
 void PCISigmaVector::apply_tau_H_symm_det_dynamic_HBCI_2(
     double spawning_threshold, const det_hashvec& dets_hashvec, const std::vector<double>& pre_C,
     size_t I, double CI, std::vector<double>& result_C,
     std::vector<std::pair<Determinant, double>>& new_det_C_vec,
-    std::pair<double, double>& max_coupling) {
+    std::pair<double, double>& max_coupling, size_t& num_off_diag) {
 
     const Determinant& detI = dets_hashvec[I];
     size_t pre_C_size = pre_C.size();
@@ -240,549 +453,87 @@ void PCISigmaVector::apply_tau_H_symm_det_dynamic_HBCI_2(
     bool do_doubles = std::fabs(max_coupling.second * CI) >= spawning_threshold;
 
     // Diagonal contributions
-    // parallel_timer_on("PCI:diagonal", omp_get_thread_num());
     bool diagonal_flag = false;
     double diagonal_contribution = 0.0;
-    // parallel_timer_off("PCI:diagonal", omp_get_thread_num());
-
-    Determinant detJ(detI);
-    if (do_singles) {
-        // parallel_timer_on("PCI:singles", omp_get_thread_num());
-        // Generate alpha excitations
-        for (size_t x = 0; x < a_couplings_size_; ++x) {
-            double HJI_max = std::get<1>(a_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(a_couplings_[x]);
-            if (detI.get_alfa_bit(i)) {
-                const std::vector<std::tuple<int, double>>& sub_couplings =
-                    std::get<2>(a_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a;
-                    double HJI_bound;
-                    std::tie(a, HJI_bound) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI_bound, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!detI.get_alfa_bit(a)) {
-                        Determinant detJ(detI);
-
-                        double HJI = as_ints_->slater_rules_single_alpha_abs(detJ, i, a);
-
-                        if (prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                            HJI *= detJ.single_excitation_a(i, a);
-
-                            size_t index = dets_hashvec.find(detJ);
-                            if (index > I) {
-                                if (index >= pre_C_size) {
-                                    if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                        new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                        diagonal_flag = true;
-#pragma omp atomic
-                                        num_off_diag_elem_ += 2;
-                                    }
-                                } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                              spawning_threshold)) {
-#pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_flag = true;
-                                    diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            }
-
-                            detJ.set_alfa_bit(i, true);
-                            detJ.set_alfa_bit(a, false);
-                        }
-                    }
-                }
-            }
-        }
-        // Generate beta excitations
-        for (size_t x = 0; x < b_couplings_size_; ++x) {
-            double HJI_max = std::get<1>(b_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(b_couplings_[x]);
-            if (detI.get_beta_bit(i)) {
-                const std::vector<std::tuple<int, double>>& sub_couplings =
-                    std::get<2>(b_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a;
-                    double HJI_bound;
-                    std::tie(a, HJI_bound) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI_bound, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!detI.get_beta_bit(a)) {
-                        Determinant detJ(detI);
-
-                        double HJI = as_ints_->slater_rules_single_beta_abs(detJ, i, a);
-                        if (prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                            HJI *= detJ.single_excitation_b(i, a);
 
-                            size_t index = dets_hashvec.find(detJ);
-                            if (index > I) {
-                                if (index >= pre_C_size) {
-                                    if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                        new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                        diagonal_flag = true;
-#pragma omp atomic
-                                        num_off_diag_elem_ += 2;
-                                    }
-                                } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                              spawning_threshold)) {
-#pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_flag = true;
-                                    diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            }
-
-                            detJ.set_beta_bit(i, true);
-                            detJ.set_beta_bit(a, false);
-                        }
-                    }
+    // Add the contribution of a coupled determinant
+    auto spawn = [&](const Determinant& detJ, double HJI) {
+        size_t index = dets_hashvec.find(detJ);
+        if (index > I) {
+            if (index >= pre_C_size) {
+                if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
+                    new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
+                    diagonal_flag = true;
+                    num_off_diag += 2;
                 }
-            }
-        }
-        // parallel_timer_off("PCI:singles", omp_get_thread_num());
-    } else if (do_singles_1) {
-        // parallel_timer_on("PCI:singles", omp_get_thread_num());
-        // Generate alpha excitations
-        for (size_t x = 0; x < a_couplings_size_; ++x) {
-            double HJI_max = std::get<1>(a_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(a_couplings_[x]);
-            if (detI.get_alfa_bit(i)) {
-                const std::vector<std::tuple<int, double>>& sub_couplings =
-                    std::get<2>(a_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a;
-                    double HJI_bound;
-                    std::tie(a, HJI_bound) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI_bound, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!detI.get_alfa_bit(a)) {
-                        Determinant detJ(detI);
-
-                        double HJI = as_ints_->slater_rules_single_alpha_abs(detJ, i, a);
-
-                        max_coupling.first = std::max(max_coupling.first, std::fabs(HJI));
-                        if (prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                            HJI *= detJ.single_excitation_a(i, a);
-
-                            size_t index = dets_hashvec.find(detJ);
-                            if (index > I) {
-                                if (index >= pre_C_size) {
-                                    if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                        new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                        diagonal_flag = true;
-#pragma omp atomic
-                                        num_off_diag_elem_ += 2;
-                                    }
-                                } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                              spawning_threshold)) {
+            } else if (important_H_CI_CJ_(HJI, CI, pre_C[index], spawning_threshold)) {
 #pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_flag = true;
-                                    diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            }
-
-                            detJ.set_alfa_bit(i, true);
-                            detJ.set_alfa_bit(a, false);
-                        }
-                    }
-                }
+                result_C[index] += HJI * CI;
+                diagonal_flag = true;
+                diagonal_contribution += HJI * pre_C[index];
+                num_off_diag += 2;
             }
         }
-        // Generate beta excitations
-        for (size_t x = 0; x < b_couplings_size_; ++x) {
-            double HJI_max = std::get<1>(b_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(b_couplings_[x]);
-            if (detI.get_beta_bit(i)) {
-                const std::vector<std::tuple<int, double>>& sub_couplings =
-                    std::get<2>(b_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a;
-                    double HJI_bound;
-                    std::tie(a, HJI_bound) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI_bound, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!detI.get_beta_bit(a)) {
-                        Determinant detJ(detI);
-
-                        double HJI = as_ints_->slater_rules_single_beta_abs(detJ, i, a);
-
-                        max_coupling.first = std::max(max_coupling.first, std::fabs(HJI));
-                        if (prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                            HJI *= detJ.single_excitation_b(i, a);
-
-                            size_t index = dets_hashvec.find(detJ);
-                            if (index > I) {
-                                if (index >= pre_C_size) {
-                                    if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                        new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                        diagonal_flag = true;
-#pragma omp atomic
-                                        num_off_diag_elem_ += 2;
-                                    }
-                                } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                              spawning_threshold)) {
-#pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_flag = true;
-                                    diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            }
-
-                            detJ.set_beta_bit(i, true);
-                            detJ.set_beta_bit(a, false);
-                        }
-                    }
-                }
-            }
-        }
-        // parallel_timer_off("PCI:singles", omp_get_thread_num());
+    };
+    auto alfa_occ = [&detI](int p) { return detI.get_alfa_bit(p); };
+    auto beta_occ = [&detI](int p) { return detI.get_beta_bit(p); };
+
+    if (do_singles or do_singles_1) {
+        // the bound on the single couplings of this determinant is found on the first visit
+        const bool update_max = not do_singles;
+        scan_singles(a_table_, alfa_occ, prescreen_H_CI_, CI, spawning_threshold,
+                     [&](int i, int a) {
+                         Determinant detJ(detI);
+                         double HJI = as_ints_->slater_rules_single_alpha_abs(detJ, i, a);
+                         if (update_max)
+                             max_coupling.first = std::max(max_coupling.first, std::fabs(HJI));
+                         if (prescreen_H_CI_(HJI, CI, spawning_threshold)) {
+                             HJI *= detJ.single_excitation_a(i, a);
+                             spawn(detJ, HJI);
+                         }
+                     });
+        scan_singles(b_table_, beta_occ, prescreen_H_CI_, CI, spawning_threshold,
+                     [&](int i, int a) {
+                         Determinant detJ(detI);
+                         double HJI = as_ints_->slater_rules_single_beta_abs(detJ, i, a);
+                         if (update_max)
+                             max_coupling.first = std::max(max_coupling.first, std::fabs(HJI));
+                         if (prescreen_H_CI_(HJI, CI, spawning_threshold)) {
+                             HJI *= detJ.single_excitation_b(i, a);
+                             spawn(detJ, HJI);
+                         }
+                     });
     }
 
-    if (do_doubles) {
-        // parallel_timer_on("PCI:doubles", omp_get_thread_num());
-        // Generate alpha-alpha excitations
-        for (size_t x = 0; x < aa_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(aa_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(aa_couplings_[x]);
-            int j = std::get<1>(aa_couplings_[x]);
-            if (detI.get_alfa_bit(i) and detI.get_alfa_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(aa_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_alfa_bit(a) or detI.get_alfa_bit(b))) {
-                        //                        Determinant detJ(detI);
-                        HJI *= detJ.double_excitation_aa(i, j, a, b);
-
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index >= pre_C_size) {
-                                if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                    new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                    diagonal_flag = true;
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                          spawning_threshold)) {
-#pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_flag = true;
-                                diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                num_off_diag_elem_ += 2;
-                            }
-                        }
-
-                        detJ.set_alfa_bit(i, true);
-                        detJ.set_alfa_bit(j, true);
-                        detJ.set_alfa_bit(a, false);
-                        detJ.set_alfa_bit(b, false);
-                    }
-                }
-            }
-        }
-        // Generate alpha-beta excitations
-        for (size_t x = 0; x < ab_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(ab_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(ab_couplings_[x]);
-            int j = std::get<1>(ab_couplings_[x]);
-            if (detI.get_alfa_bit(i) and detI.get_beta_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(ab_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_alfa_bit(a) or detI.get_beta_bit(b))) {
-                        //                        Determinant detJ(detI);
-                        HJI *= detJ.double_excitation_ab(i, j, a, b);
-
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index >= pre_C_size) {
-                                if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                    new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                    diagonal_flag = true;
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                          spawning_threshold)) {
-#pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_flag = true;
-                                diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                num_off_diag_elem_ += 2;
-                            }
-                        }
-
-                        detJ.set_alfa_bit(i, true);
-                        detJ.set_beta_bit(j, true);
-                        detJ.set_alfa_bit(a, false);
-                        detJ.set_beta_bit(b, false);
-                    }
-                }
-            }
-        }
-        // Generate beta-beta excitations
-        for (size_t x = 0; x < bb_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(bb_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(bb_couplings_[x]);
-            int j = std::get<1>(bb_couplings_[x]);
-            if (detI.get_beta_bit(i) and detI.get_beta_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(bb_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_beta_bit(a) or detI.get_beta_bit(b))) {
-                        //                        Determinant detJ(detI);
-                        HJI *= detJ.double_excitation_bb(i, j, a, b);
-
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index >= pre_C_size) {
-                                if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                    new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                    diagonal_flag = true;
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                          spawning_threshold)) {
-#pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_flag = true;
-                                diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                num_off_diag_elem_ += 2;
-                            }
-                        }
-
-                        detJ.set_beta_bit(i, true);
-                        detJ.set_beta_bit(j, true);
-                        detJ.set_beta_bit(a, false);
-                        detJ.set_beta_bit(b, false);
-                    }
-                }
-            }
-        }
-        // parallel_timer_off("PCI:doubles", omp_get_thread_num());
-    } else if (do_doubles_1) {
-        // parallel_timer_on("PCI:doubles", omp_get_thread_num());
-        // Generate alpha-alpha excitations
-        for (size_t x = 0; x < aa_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(aa_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(aa_couplings_[x]);
-            int j = std::get<1>(aa_couplings_[x]);
-            if (detI.get_alfa_bit(i) and detI.get_alfa_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(aa_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_alfa_bit(a) or detI.get_alfa_bit(b))) {
-                        max_coupling.second = std::max(max_coupling.second, std::fabs(HJI));
-                        //                        Determinant detJ(detI);
-                        HJI *= detJ.double_excitation_aa(i, j, a, b);
-
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index >= pre_C_size) {
-                                if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                    new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                    diagonal_flag = true;
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                          spawning_threshold)) {
-#pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_flag = true;
-                                diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                num_off_diag_elem_ += 2;
-                            }
-                        }
-
-                        detJ.set_alfa_bit(i, true);
-                        detJ.set_alfa_bit(j, true);
-                        detJ.set_alfa_bit(a, false);
-                        detJ.set_alfa_bit(b, false);
-                    }
-                }
-            }
-        }
-        // Generate alpha-beta excitations
-        for (size_t x = 0; x < ab_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(ab_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(ab_couplings_[x]);
-            int j = std::get<1>(ab_couplings_[x]);
-            if (detI.get_alfa_bit(i) and detI.get_beta_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(ab_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_alfa_bit(a) or detI.get_beta_bit(b))) {
-                        max_coupling.second = std::max(max_coupling.second, std::fabs(HJI));
-                        //                        Determinant detJ(detI);
-                        HJI *= detJ.double_excitation_ab(i, j, a, b);
-
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index >= pre_C_size) {
-                                if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                    new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                    diagonal_flag = true;
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                          spawning_threshold)) {
-#pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_flag = true;
-                                diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                num_off_diag_elem_ += 2;
-                            }
-                        }
-
-                        detJ.set_alfa_bit(i, true);
-                        detJ.set_beta_bit(j, true);
-                        detJ.set_alfa_bit(a, false);
-                        detJ.set_beta_bit(b, false);
-                    }
-                }
-            }
-        }
-        // Generate beta-beta excitations
-        for (size_t x = 0; x < bb_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(bb_couplings_[x]);
-            if (std::fabs(HJI_max * CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(bb_couplings_[x]);
-            int j = std::get<1>(bb_couplings_[x]);
-            if (detI.get_beta_bit(i) and detI.get_beta_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(bb_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_beta_bit(a) or detI.get_beta_bit(b))) {
-                        max_coupling.second = std::max(max_coupling.second, std::fabs(HJI));
-                        //                        Determinant detJ(detI);
-                        HJI *= detJ.double_excitation_bb(i, j, a, b);
-
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index >= pre_C_size) {
-                                if (important_H_CI_CJ_(HJI, CI, 0.0, spawning_threshold)) {
-                                    new_det_C_vec.push_back(std::make_pair(detJ, HJI * CI));
-                                    diagonal_flag = true;
-#pragma omp atomic
-                                    num_off_diag_elem_ += 2;
-                                }
-                            } else if (important_H_CI_CJ_(HJI, CI, pre_C[index],
-                                                          spawning_threshold)) {
-#pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_flag = true;
-                                diagonal_contribution += HJI * pre_C[index];
-#pragma omp atomic
-                                num_off_diag_elem_ += 2;
-                            }
-                        }
-
-                        detJ.set_beta_bit(i, true);
-                        detJ.set_beta_bit(j, true);
-                        detJ.set_beta_bit(a, false);
-                        detJ.set_beta_bit(b, false);
-                    }
-                }
-            }
-        }
-        // parallel_timer_off("PCI:doubles", omp_get_thread_num());
+    if (do_doubles or do_doubles_1) {
+        // the bound on the double couplings of this determinant is found on the first visit
+        const bool update_max = not do_doubles;
+        scan_doubles(aa_table_, alfa_occ, alfa_occ, prescreen_H_CI_, CI, spawning_threshold,
+                     [&](int i, int j, int a, int b, double HJI) {
+                         if (update_max)
+                             max_coupling.second = std::max(max_coupling.second, std::fabs(HJI));
+                         Determinant detJ(detI);
+                         HJI *= detJ.double_excitation_aa(i, j, a, b);
+                         spawn(detJ, HJI);
+                     });
+        scan_doubles(ab_table_, alfa_occ, beta_occ, prescreen_H_CI_, CI, spawning_threshold,
+                     [&](int i, int j, int a, int b, double HJI) {
+                         if (update_max)
+                             max_coupling.second = std::max(max_coupling.second, std::fabs(HJI));
+                         Determinant detJ(detI);
+                         HJI *= detJ.double_excitation_ab(i, j, a, b);
+                         spawn(detJ, HJI);
+                     });
+        scan_doubles(bb_table_, beta_occ, beta_occ, prescreen_H_CI_, CI, spawning_threshold,
+                     [&](int i, int j, int a, int b, double HJI) {
+                         if (update_max)
+                             max_coupling.second = std::max(max_coupling.second, std::fabs(HJI));
+                         Determinant detJ(detI);
+                         HJI *= detJ.double_excitation_bb(i, j, a, b);
+                         spawn(detJ, HJI);
+                     });
     }
+
     if (diagonal_flag) {
         if (std::fabs(diagonal_contribution) > DBL_MIN) {
 #pragma omp atomic
@@ -794,288 +545,122 @@ void PCISigmaVector::apply_tau_H_symm_det_dynamic_HBCI_2(
     }
 }
 
-void PCISigmaVector::apply_tau_H_ref_C_symm(
-    double spawning_threshold, const det_hashvec& result_dets, const std::vector<double>& ref_C,
-    const std::vector<double>& pre_C, std::vector<double>& result_C, const size_t overlap_size) {
+void PCISigmaVector::apply_tau_H_ref_C_symm(double spawning_threshold,
+                                            const det_hashvec& result_dets,
+                                            const std::vector<double>& ref_C, const double* pre_C,
+                                            size_t nvec, std::vector<double>& result_C,
+                                            const size_t overlap_size) {
 
+    local_timer t_sigma;
     const size_t result_size = result_dets.size();
-    result_C.clear();
-    result_C.resize(result_size, 0.0);
+    result_C.assign(result_size * nvec, 0.0);
+    std::vector<std::vector<double>> thread_diagonal(num_threads_, std::vector<double>(nvec));
 
-#pragma omp parallel for
+    // Each MPI rank applies H to the determinants that it owns. The coupling bounds of the
+    // determinants of the reference space were stored by apply_tau_H_symm
+#pragma omp parallel for schedule(dynamic, 64)
     for (size_t I = 0; I < overlap_size; ++I) {
-        std::pair<double, double> max_coupling;
-        max_coupling = dets_max_couplings_[result_dets[I]];
-        apply_tau_H_ref_C_symm_det_dynamic_HBCI_2(spawning_threshold, result_dets, pre_C, ref_C, I,
-                                                  pre_C[I], ref_C[I], overlap_size, result_C,
-                                                  max_coupling);
+        if (pci_mpi_owner(result_dets[I], nproc_) != rank_)
+            continue;
+        apply_tau_H_ref_C_symm_det_dynamic_HBCI_2(
+            spawning_threshold, result_dets, pre_C, ref_C, I, nvec, ref_C[I], overlap_size,
+            result_C.data(), thread_diagonal[omp_get_thread_num()].data(), max_couplings_[I]);
     }
+    timings_["sigma"] += t_sigma.get();
+
+    local_timer t_reduce;
+    pci_mpi_sum(result_C.data(), result_size * nvec, nproc_);
+    timings_["reduce"] += t_reduce.get();
 
 #pragma omp parallel for
     for (size_t I = 0; I < result_size; ++I) {
-        result_C[I] += diag_[I] * pre_C[I];
+        for (size_t n = 0; n < nvec; ++n) {
+            result_C[I * nvec + n] += diag_[I] * pre_C[I * nvec + n];
+        }
     }
 }
 
 void PCISigmaVector::apply_tau_H_ref_C_symm_det_dynamic_HBCI_2(
-    double spawning_threshold, const det_hashvec& dets_hashvec, const std::vector<double>& pre_C,
-    const std::vector<double>& ref_C, size_t I, double CI, double ref_CI, const size_t overlap_size,
-    std::vector<double>& result_C, const std::pair<double, double>& max_coupling) {
+    double spawning_threshold, const det_hashvec& dets_hashvec, const double* pre_C,
+    const std::vector<double>& ref_C, size_t I, size_t nvec, double ref_CI,
+    const size_t overlap_size, double* result_C, double* diagonal_contribution,
+    const std::pair<double, double>& max_coupling) {
 
     const Determinant& detI = dets_hashvec[I];
+    const size_t result_size = dets_hashvec.size();
+    const double* CI = pre_C + I * nvec;
 
     bool do_singles = std::fabs(max_coupling.first * ref_CI) >= spawning_threshold;
     bool do_doubles = std::fabs(max_coupling.second * ref_CI) >= spawning_threshold;
 
     // Diagonal contributions
-    // parallel_timer_on("PCI:diagonal", omp_get_thread_num());
-    double diagonal_contribution = 0.0;
-    // parallel_timer_off("PCI:diagonal", omp_get_thread_num());
-
-    Determinant detJ(detI);
-    if (do_singles) {
-        // parallel_timer_on("PCI:singles", omp_get_thread_num());
-        // Generate alpha excitations
-        for (size_t x = 0; x < a_couplings_size_; ++x) {
-            double HJI_max = std::get<1>(a_couplings_[x]);
-            if (std::fabs(HJI_max * ref_CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(a_couplings_[x]);
-            if (detI.get_alfa_bit(i)) {
-                const std::vector<std::tuple<int, double>>& sub_couplings =
-                    std::get<2>(a_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a;
-                    double HJI_bound;
-                    std::tie(a, HJI_bound) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI_bound, ref_CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!detI.get_alfa_bit(a)) {
-                        Determinant detJ(detI);
-
-                        double HJI = as_ints_->slater_rules_single_alpha_abs(detJ, i, a);
-
-                        if (prescreen_H_CI_(HJI, ref_CI, spawning_threshold)) {
-                            HJI *= detJ.single_excitation_a(i, a);
-
-                            size_t index = dets_hashvec.find(detJ);
-                            if (index > I) {
-                                if (index < overlap_size) {
-                                    if (important_H_CI_CJ_(HJI, ref_CI, ref_C[index],
-                                                           spawning_threshold)) {
-#pragma omp atomic
-                                        result_C[index] += HJI * CI;
-                                        diagonal_contribution += HJI * pre_C[index];
-                                    }
-                                } else if (important_H_CI_CJ_(HJI, ref_CI, 0.0,
-                                                              spawning_threshold)) {
-#pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_contribution += HJI * pre_C[index];
-                                }
-                            }
-                            detJ.set_alfa_bit(i, true);
-                            detJ.set_alfa_bit(a, false);
-                        }
-                    }
+    std::fill(diagonal_contribution, diagonal_contribution + nvec, 0.0);
+
+    // Add the contribution of a coupled determinant. The screening depends only on the reference
+    // coefficients, so each coupling is applied to all the vectors of the block
+    auto spawn = [&](const Determinant& detJ, double HJI) {
+        size_t index = dets_hashvec.find(detJ);
+        if ((index > I) and (index < result_size)) {
+            double ref_CJ = index < overlap_size ? ref_C[index] : 0.0;
+            if (important_H_CI_CJ_(HJI, ref_CI, ref_CJ, spawning_threshold)) {
+                const double* CJ = pre_C + index * nvec;
+                double* sigma_J = result_C + index * nvec;
+                for (size_t n = 0; n < nvec; ++n) {
+#pragma omp atomic
+                    sigma_J[n] += HJI * CI[n];
+                    diagonal_contribution[n] += HJI * CJ[n];
                 }
             }
         }
-        // Generate beta excitations
-        for (size_t x = 0; x < b_couplings_size_; ++x) {
-            double HJI_max = std::get<1>(b_couplings_[x]);
-            if (std::fabs(HJI_max * ref_CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(b_couplings_[x]);
-            if (detI.get_beta_bit(i)) {
-                const std::vector<std::tuple<int, double>>& sub_couplings =
-                    std::get<2>(b_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a;
-                    double HJI_bound;
-                    std::tie(a, HJI_bound) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI_bound, ref_CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!detI.get_beta_bit(a)) {
-                        Determinant detJ(detI);
-
-                        double HJI = as_ints_->slater_rules_single_beta_abs(detJ, i, a);
+    };
+    auto alfa_occ = [&detI](int p) { return detI.get_alfa_bit(p); };
+    auto beta_occ = [&detI](int p) { return detI.get_beta_bit(p); };
 
-                        if (prescreen_H_CI_(HJI, ref_CI, spawning_threshold)) {
-                            HJI *= detJ.single_excitation_b(i, a);
-
-                            size_t index = dets_hashvec.find(detJ);
-                            if (index > I) {
-                                if (index < overlap_size) {
-                                    if (important_H_CI_CJ_(HJI, ref_CI, ref_C[index],
-                                                           spawning_threshold)) {
-#pragma omp atomic
-                                        result_C[index] += HJI * CI;
-                                        diagonal_contribution += HJI * pre_C[index];
-                                    }
-                                } else if (important_H_CI_CJ_(HJI, ref_CI, 0.0,
-                                                              spawning_threshold)) {
-#pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_contribution += HJI * pre_C[index];
-                                }
-                            }
-                            detJ.set_beta_bit(i, true);
-                            detJ.set_beta_bit(a, false);
-                        }
-                    }
-                }
-            }
-        }
-        // parallel_timer_off("PCI:singles", omp_get_thread_num());
+    if (do_singles) {
+        scan_singles(a_table_, alfa_occ, prescreen_H_CI_, ref_CI, spawning_threshold,
+                     [&](int i, int a) {
+                         Determinant detJ(detI);
+                         double HJI = as_ints_->slater_rules_single_alpha_abs(detJ, i, a);
+                         if (prescreen_H_CI_(HJI, ref_CI, spawning_threshold)) {
+                             HJI *= detJ.single_excitation_a(i, a);
+                             spawn(detJ, HJI);
+                         }
+                     });
+        scan_singles(b_table_, beta_occ, prescreen_H_CI_, ref_CI, spawning_threshold,
+                     [&](int i, int a) {
+                         Determinant detJ(detI);
+                         double HJI = as_ints_->slater_rules_single_beta_abs(detJ, i, a);
+                         if (prescreen_H_CI_(HJI, ref_CI, spawning_threshold)) {
+                             HJI *= detJ.single_excitation_b(i, a);
+                             spawn(detJ, HJI);
+                         }
+                     });
     }
 
     if (do_doubles) {
-        // parallel_timer_on("PCI:doubles", omp_get_thread_num());
-        // Generate alpha-alpha excitations
-        for (size_t x = 0; x < aa_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(aa_couplings_[x]);
-            if (std::fabs(HJI_max * ref_CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(aa_couplings_[x]);
-            int j = std::get<1>(aa_couplings_[x]);
-            if (detI.get_alfa_bit(i) and detI.get_alfa_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(aa_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, ref_CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_alfa_bit(a) or detI.get_alfa_bit(b))) {
-                        HJI *= detJ.double_excitation_aa(i, j, a, b);
-
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index < overlap_size) {
-                                if (important_H_CI_CJ_(HJI, ref_CI, ref_C[index],
-                                                       spawning_threshold)) {
-#pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_contribution += HJI * pre_C[index];
-                                }
-                            } else if (important_H_CI_CJ_(HJI, ref_CI, 0.0, spawning_threshold)) {
-#pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_contribution += HJI * pre_C[index];
-                            }
-                        }
-                        detJ.set_alfa_bit(i, true);
-                        detJ.set_alfa_bit(j, true);
-                        detJ.set_alfa_bit(a, false);
-                        detJ.set_alfa_bit(b, false);
-                    }
-                }
-            }
-        }
-        // Generate alpha-beta excitations
-        for (size_t x = 0; x < ab_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(ab_couplings_[x]);
-            if (std::fabs(HJI_max * ref_CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(ab_couplings_[x]);
-            int j = std::get<1>(ab_couplings_[x]);
-            if (detI.get_alfa_bit(i) and detI.get_beta_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(ab_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, ref_CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_alfa_bit(a) or detI.get_beta_bit(b))) {
-                        HJI *= detJ.double_excitation_ab(i, j, a, b);
-
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index < overlap_size) {
-                                if (important_H_CI_CJ_(HJI, ref_CI, ref_C[index],
-                                                       spawning_threshold)) {
-#pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_contribution += HJI * pre_C[index];
-                                }
-                            } else if (important_H_CI_CJ_(HJI, ref_CI, 0.0, spawning_threshold)) {
-#pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_contribution += HJI * pre_C[index];
-                            }
-                        }
-                        detJ.set_alfa_bit(i, true);
-                        detJ.set_beta_bit(j, true);
-                        detJ.set_alfa_bit(a, false);
-                        detJ.set_beta_bit(b, false);
-                    }
-                }
-            }
-        }
-        // Generate beta-beta excitations
-        for (size_t x = 0; x < bb_couplings_size_; ++x) {
-            double HJI_max = std::get<2>(bb_couplings_[x]);
-            if (std::fabs(HJI_max * ref_CI) < spawning_threshold) {
-                break;
-            }
-            int i = std::get<0>(bb_couplings_[x]);
-            int j = std::get<1>(bb_couplings_[x]);
-            if (detI.get_beta_bit(i) and detI.get_beta_bit(j)) {
-                const std::vector<std::tuple<int, int, double>>& sub_couplings =
-                    std::get<3>(bb_couplings_[x]);
-                size_t sub_couplings_size = sub_couplings.size();
-                for (size_t y = 0; y < sub_couplings_size; ++y) {
-                    int a, b;
-                    double HJI;
-                    std::tie(a, b, HJI) = sub_couplings[y];
-                    if (!prescreen_H_CI_(HJI, ref_CI, spawning_threshold)) {
-                        break;
-                    }
-                    if (!(detI.get_beta_bit(a) or detI.get_beta_bit(b))) {
-                        HJI *= detJ.double_excitation_bb(i, j, a, b);
+        scan_doubles(aa_table_, alfa_occ, alfa_occ, prescreen_H_CI_, ref_CI, spawning_threshold,
+                     [&](int i, int j, int a, int b, double HJI) {
+                         Determinant detJ(detI);
+                         HJI *= detJ.double_excitation_aa(i, j, a, b);
+                         spawn(detJ, HJI);
+                     });
+        scan_doubles(ab_table_, alfa_occ, beta_occ, prescreen_H_CI_, ref_CI, spawning_threshold,
+                     [&](int i, int j, int a, int b, double HJI) {
+                         Determinant detJ(detI);
+                         HJI *= detJ.double_excitation_ab(i, j, a, b);
+                         spawn(detJ, HJI);
+                     });
+        scan_doubles(bb_table_, beta_occ, beta_occ, prescreen_H_CI_, ref_CI, spawning_threshold,
+                     [&](int i, int j, int a, int b, double HJI) {
+                         Determinant detJ(detI);
+                         HJI *= detJ.double_excitation_bb(i, j, a, b);
+                         spawn(detJ, HJI);
+                     });
+    }
 
-                        size_t index = dets_hashvec.find(detJ);
-                        if (index > I) {
-                            if (index < overlap_size) {
-                                if (important_H_CI_CJ_(HJI, ref_CI, ref_C[index],
-                                                       spawning_threshold)) {
-#pragma omp atomic
-                                    result_C[index] += HJI * CI;
-                                    diagonal_contribution += HJI * pre_C[index];
-                                }
-                            } else if (important_H_CI_CJ_(HJI, ref_CI, 0.0, spawning_threshold)) {
+    for (size_t n = 0; n < nvec; ++n) {
 #pragma omp atomic
-                                result_C[index] += HJI * CI;
-                                diagonal_contribution += HJI * pre_C[index];
-                            }
-                        }
-                        detJ.set_beta_bit(i, true);
-                        detJ.set_beta_bit(j, true);
-                        detJ.set_beta_bit(a, false);
-                        detJ.set_beta_bit(b, false);
-                    }
-                }
-            }
-        }
-        // parallel_timer_off("PCI:doubles", omp_get_thread_num());
+        result_C[I * nvec + n] += diagonal_contribution[n];
     }
-#pragma omp atomic
-    result_C[I] += diagonal_contribution;
 }
 } // namespace forte
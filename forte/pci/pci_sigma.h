@@ -30,10 +30,50 @@
 #ifndef _pci_sigma_h_
 #define _pci_sigma_h_
 
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
 #include "sparse_ci/sigma_vector.h"
 
 namespace forte {
 
+/**
+ * @brief A table of excitations sorted by the magnitude of their couplings
+ *
+ * Each row holds the occupied orbitals (i, j) of a group of excitations and the largest coupling
+ * of the group; the rows are sorted by decreasing largest coupling. The entries of a row hold the
+ * virtual orbitals (a, b) and the coupling (or an upper bound to it) in order of decreasing
+ * magnitude. The entries of all the rows are stored contiguously. For single excitations j and b
+ * are not used.
+ */
+struct PCIExcitationTable {
+    struct Row {
+        int i;
+        int j;
+        double max_coupling;
+        size_t begin;
+        size_t end;
+    };
+    struct Entry {
+        int a;
+        int b;
+        double coupling;
+    };
+    std::vector<Row> rows;
+    std::vector<Entry> entries;
+
+    /// Build the table from the single excitation couplings of ProjectorCI
+    explicit PCIExcitationTable(
+        const std::vector<std::tuple<int, double, std::vector<std::tuple<int, double>>>>&
+            couplings);
+    /// Build the table from the double excitation couplings of ProjectorCI
+    explicit PCIExcitationTable(
+        const std::vector<std::tuple<int, int, double, std::vector<std::tuple<int, int, double>>>>&
+            couplings);
+};
+
 class PCISigmaVector : public SigmaVector {
   public:
     PCISigmaVector(
@@ -56,6 +96,10 @@ class PCISigmaVector : public SigmaVector {
         double dets_single_max_coupling, double dets_double_max_coupling,
         const std::vector<std::pair<det_hashvec, std::vector<double>>>& bad_roots);
     void compute_sigma(psi::SharedVector sigma, psi::SharedVector b) override;
+    /// Compute the sigma vectors of a block of vectors. The couplings of each determinant are
+    /// screened once and applied to all the vectors
+    void compute_sigma_block(const std::vector<psi::SharedVector>& sigma,
+                             const std::vector<psi::SharedVector>& b) override;
     void get_diagonal(psi::Vector& diag) override;
     void add_bad_roots(std::vector<std::vector<std::pair<size_t, double>>>& bad_states) override;
     double compute_spin(const std::vector<double>& c) override { return 0.0; }
@@ -64,6 +108,8 @@ class PCISigmaVector : public SigmaVector {
     void compute_sigma_with_diag(psi::SharedVector sigma, psi::SharedVector b);
     size_t get_num_off_diag();
     size_t get_sigma_build_count();
+    /// The time (in seconds) spent in each phase of the sigma builds
+    const std::map<std::string, double>& get_sigma_build_timings();
 
   private:
     det_hashvec& dets_;
@@ -86,14 +132,18 @@ class PCISigmaVector : public SigmaVector {
     std::unordered_map<Determinant, std::pair<double, double>, Determinant::Hash>&
         dets_max_couplings_;
     double dets_single_max_coupling_;
-    const std::vector<std::tuple<int, double, std::vector<std::tuple<int, double>>>>&a_couplings_,
-        &b_couplings_;
-    size_t a_couplings_size_, b_couplings_size_;
     double dets_double_max_coupling_;
-    const std::vector<std::tuple<int, int, double, std::vector<std::tuple<int, int, double>>>>
-        &aa_couplings_, &ab_couplings_, &bb_couplings_;
-    size_t aa_couplings_size_, ab_couplings_size_, bb_couplings_size_;
+    /// The alpha and beta single excitations, sorted by the bound on their couplings
+    const PCIExcitationTable a_table_, b_table_;
+    /// The aa, ab, and bb double excitations, sorted by |<ij||ab>|
+    const PCIExcitationTable aa_table_, ab_table_, bb_table_;
     const std::vector<std::pair<det_hashvec, std::vector<double>>>& bad_roots_;
+    /// The previous solutions restricted to the current space, S[m * size + I], and their
+    /// overlaps <s_m|s_k>
+    std::vector<double> solution_coefs_;
+    std::vector<double> solution_overlaps_;
+    /// The coupling bounds of the determinants of the reference space, in the order of dets_
+    std::vector<std::pair<double, double>> max_couplings_;
 
     std::vector<double> first_sigma_vec_;
     /// The diagonal elements
@@ -102,12 +152,21 @@ class PCISigmaVector : public SigmaVector {
     size_t num_off_diag_elem_;
     /// The number of off-diagonal elements
     size_t sigma_build_count_;
+    /// The time (in seconds) spent in each phase of the sigma builds
+    std::map<std::string, double> timings_;
     /// The maximum number of threads
     int num_threads_;
+    /// The MPI rank of this process and the number of ranks (see pci_mpi.h)
+    int rank_;
+    int nproc_;
 
-    /// Orthogonalize the wave function to previous solutions
-    void orthogonalize(const det_hashvec& space, std::vector<double>& C,
-                       const std::vector<std::pair<det_hashvec, std::vector<double>>>& solutions);
+    /// Is b the reference vector, whose sigma vector was computed by reset()?
+    bool is_first_sigma(psi::SharedVector b);
+    /// Store the previous solutions restricted to a space (see solution_coefs_)
+    void build_solution_block(const det_hashvec& space);
+    /// Orthogonalize a block of nvec vectors, stored interleaved (C[I * nvec + n]), to the
+    /// previous solutions. Equivalent to projecting the solutions out one after the other
+    void orthogonalize(double* C, size_t nvec);
 
     /// Apply symmetric approx tau H to a set of determinants with selection
     /// according to reference coefficients
@@ -123,20 +182,22 @@ class PCISigmaVector : public SigmaVector {
                                         const std::vector<double>& pre_C, size_t I, double CI,
                                         std::vector<double>& result_C,
                                         std::vector<std::pair<Determinant, double>>& new_det_C_vec,
-                                        std::pair<double, double>& max_coupling);
-    /// Apply symmetric approx tau H to a set of determinants with selection
-    /// according to reference coefficients
+                                        std::pair<double, double>& max_coupling,
+                                        size_t& num_off_diag);
+    /// Apply symmetric approx tau H to a block of nvec vectors, stored interleaved
+    /// (pre_C[I * nvec + n]), with selection according to reference coefficients
     void apply_tau_H_ref_C_symm(double spawning_threshold, const det_hashvec& result_dets,
-                                const std::vector<double>& ref_C, const std::vector<double>& pre_C,
-                                std::vector<double>& result_C, const size_t overlap_size);
+                                const std::vector<double>& ref_C, const double* pre_C,
+                                size_t nvec, std::vector<double>& result_C,
+                                const size_t overlap_size);
 
     /// Apply symmetric approx tau H to a determinant using dynamic screening
     /// with selection according to a reference coefficient
     /// and with HBCI sorting scheme with singles screening
     void apply_tau_H_ref_C_symm_det_dynamic_HBCI_2(
-        double spawning_threshold, const det_hashvec& dets_hashvec,
-        const std::vector<double>& pre_C, const std::vector<double>& ref_C, size_t I, double CI,
-        double ref_CI, const size_t overlap_size, std::vector<double>& result_C,
+        double spawning_threshold, const det_hashvec& dets_hashvec, const double* pre_C,
+        const std::vector<double>& ref_C, size_t I, size_t nvec, double ref_CI,
+        const size_t overlap_size, double* result_C, double* diagonal_contribution,
         const std::pair<double, double>& max_coupling);
 };
 } // namespace forte
@@ -27,19 +27,243 @@
  * @END LICENSE
  */
 
+#include <vector>
+
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsi4util/process.h"
+#include "psi4/libqt/qt.h"
 
 #include "base_classes/forte_options.h"
 #include "helpers/printing.h"
 #include "helpers/helpers.h"
 #include "post_process/spin_corr.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace psi;
 
 namespace forte {
 
+namespace {
+
+/// Build the spin correlation functions from the diagonal of the 1-RDMs (na, nb) and the pair
+/// elements of the 2-RDMs: Paa_ij = G2aa[ijij], Pbb_ij = G2bb[ijij], Pab_ij = G2ab[ijij], and
+/// Qab_ij = G2ab[ijji]
+SpinCorrelation spin_correlation_from_pairs(size_t nact, const std::vector<double>& na,
+                                            const std::vector<double>& nb,
+                                            const std::vector<double>& Paa,
+                                            const std::vector<double>& Pbb,
+                                            const std::vector<double>& Pab,
+                                            const std::vector<double>& Qab) {
+    SpinCorrelation sc;
+    sc.spin_corr = ambit::Tensor::build(ambit::CoreTensor, "Spin Correlation", {nact, nact});
+    sc.spin_fluct = ambit::Tensor::build(ambit::CoreTensor, "Spin Fluctuation", {nact, nact});
+    sc.spin_z = ambit::Tensor::build(ambit::CoreTensor, "Spin-z Correlation", {nact, nact});
+    auto& corr = sc.spin_corr.data();
+    auto& fluct = sc.spin_fluct.data();
+    auto& z = sc.spin_z.data();
+    for (size_t i = 0; i < nact; ++i) {
+        const double mi = na[i] - nb[i];
+        for (size_t j = 0; j < nact; ++j) {
+            const size_t ij = i * nact + j;
+            const size_t ji = j * nact + i;
+            const double mj = na[j] - nb[j];
+            // 4 <S_z,i S_z,j> - delta_ij (n_i)
+            const double zz = Paa[ij] + Pbb[ij] - Pab[ij] - Pab[ji];
+            const double nii = i == j ? na[i] + nb[i] : 0.0;
+            z[ij] = zz + nii + mi * mj;
+            corr[ij] = 0.75 * nii - 0.5 * (Qab[ij] + Qab[ji]) + 0.25 * zz;
+            fluct[ij] = corr[ij] - 0.25 * mi * mj;
+        }
+    }
+    return sc;
+}
+
+/// Compute the pair elements P_ij = G'[ijij] and (optionally) Q_ij = G'[ijji] of the 2-RDM G
+/// transformed with G'[ijkl] = sum_abcd U1[ai] U2[bj] U3[ck] U4[dl] G[abcd]
+void transformed_pairs(size_t n, const std::vector<double>& G, const std::vector<double>& U1,
+                       const std::vector<double>& U2, const std::vector<double>& U3,
+                       const std::vector<double>& U4, std::vector<double>& P,
+                       std::vector<double>* Q) {
+    const size_t n3 = n * n * n;
+    // T1[i,bcd] = sum_a U1[a,i] G[a,bcd]
+    std::vector<double> T1(n * n3);
+    C_DGEMM('T', 'N', n, n3, n, 1.0, const_cast<double*>(U1.data()), n,
+            const_cast<double*>(G.data()), n3, 0.0, T1.data(), n3);
+    // T2[ibc,l] = sum_d T1[ibc,d] U4[d,l]
+    std::vector<double> T2(n3 * n);
+    C_DGEMM('N', 'N', n3, n, n, 1.0, T1.data(), n, const_cast<double*>(U4.data()), n, 0.0,
+            T2.data(), n);
+    T1 = std::vector<double>();
+
+    P.assign(n * n, 0.0);
+    if (Q)
+        Q->assign(n * n, 0.0);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < n; ++i) {
+        const double* T2_i = T2.data() + i * n3;
+        for (size_t j = 0; j < n; ++j) {
+            double p = 0.0;
+            double q = 0.0;
+            for (size_t b = 0; b < n; ++b) {
+                const double* T2_ib = T2_i + b * n * n;
+                double pb = 0.0;
+                double qb = 0.0;
+                for (size_t c = 0; c < n; ++c) {
+                    pb += U3[c * n + i] * T2_ib[c * n + j];
+                    qb += U3[c * n + j] * T2_ib[c * n + i];
+                }
+                p += U2[b * n + j] * pb;
+                q += U2[b * n + j] * qb;
+            }
+            P[i * n + j] = p;
+            if (Q)
+                (*Q)[i * n + j] = q;
+        }
+    }
+}
+
+/// The diagonal of the transformed 1-RDM, n_i = sum_ab U[ai] G[ab] U[bi]
+std::vector<double> transformed_occupations(size_t n, const std::vector<double>& G,
+                                            const std::vector<double>& U) {
+    std::vector<double> occ(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t a = 0; a < n; ++a) {
+            for (size_t b = 0; b < n; ++b) {
+                occ[i] += U[a * n + i] * G[a * n + b] * U[b * n + i];
+            }
+        }
+    }
+    return occ;
+}
+} // namespace
+
+SpinCorrelation compute_spin_correlation(RDMs& rdms, ambit::Tensor Ua, ambit::Tensor Ub) {
+    const size_t n = rdms.g1a().dim(0);
+    const auto& ua = Ua.data();
+    const auto& ub = Ub.data();
+    std::vector<double> Paa, Pbb, Pab, Qab;
+    transformed_pairs(n, rdms.g2aa().data(), ua, ua, ua, ua, Paa, nullptr);
+    transformed_pairs(n, rdms.g2bb().data(), ub, ub, ub, ub, Pbb, nullptr);
+    transformed_pairs(n, rdms.g2ab().data(), ua, ub, ua, ub, Pab, &Qab);
+    return spin_correlation_from_pairs(n, transformed_occupations(n, rdms.g1a().data(), ua),
+                                       transformed_occupations(n, rdms.g1b().data(), ub), Paa,
+                                       Pbb, Pab, Qab);
+}
+
+SpinCorrelation compute_spin_correlation(RDMs& rdms) {
+    const size_t n = rdms.g1a().dim(0);
+    const size_t n2 = n * n;
+    const size_t n3 = n * n2;
+    const auto& g1a = rdms.g1a().data();
+    const auto& g1b = rdms.g1b().data();
+    const auto& g2aa = rdms.g2aa().data();
+    const auto& g2ab = rdms.g2ab().data();
+    const auto& g2bb = rdms.g2bb().data();
+    std::vector<double> na(n), nb(n), Paa(n2), Pbb(n2), Pab(n2), Qab(n2);
+    for (size_t i = 0; i < n; ++i) {
+        na[i] = g1a[i * n + i];
+        nb[i] = g1b[i * n + i];
+        for (size_t j = 0; j < n; ++j) {
+            const size_t ijij = i * n3 + j * n2 + i * n + j;
+            const size_t ijji = i * n3 + j * n2 + j * n + i;
+            Paa[i * n + j] = g2aa[ijij];
+            Pbb[i * n + j] = g2bb[ijij];
+            Pab[i * n + j] = g2ab[ijij];
+            Qab[i * n + j] = g2ab[ijji];
+        }
+    }
+    return spin_correlation_from_pairs(n, na, nb, Paa, Pbb, Pab, Qab);
+}
+
+SpinCorrelation compute_spin_correlation(const StateVector& state, size_t nact) {
+    const size_t n2 = nact * nact;
+    std::vector<const std::pair<Determinant, double>*> terms;
+    terms.reserve(state.size());
+    for (const auto& term : state) {
+        terms.push_back(&term);
+    }
+
+    // <S_z,i S_z,j>, <S_z,i>, <S+_i S-_j>, and <n_ia n_ib>
+    std::vector<double> zz(n2, 0.0), sz(nact, 0.0), flip(n2, 0.0), pair(nact, 0.0);
+#pragma omp parallel
+    {
+        std::vector<double> zz_t(n2, 0.0), sz_t(nact, 0.0), flip_t(n2, 0.0), pair_t(nact, 0.0);
+        std::vector<double> m(nact);
+#pragma omp for schedule(dynamic, 64)
+        for (size_t I = 0; I < terms.size(); ++I) {
+            const Determinant& d = terms[I]->first;
+            const double cI = terms[I]->second;
+            const double w = cI * cI;
+            for (size_t i = 0; i < nact; ++i) {
+                m[i] = 0.5 * (double(d.get_alfa_bit(i)) - double(d.get_beta_bit(i)));
+                sz_t[i] += w * m[i];
+                if (d.get_alfa_bit(i) and d.get_beta_bit(i))
+                    pair_t[i] += w;
+            }
+            for (size_t i = 0; i < nact; ++i) {
+                if (m[i] == 0.0)
+                    continue;
+                for (size_t j = 0; j < nact; ++j) {
+                    zz_t[i * nact + j] += w * m[i] * m[j];
+                }
+            }
+            // S+_i S-_j = a+_ia a-_ib a+_jb a-_ja connects d to determinants in which an alpha
+            // electron in j and a beta electron in i (both singly occupied) swap their spin
+            for (size_t j = 0; j < nact; ++j) {
+                if (m[j] <= 0.0)
+                    continue;
+                for (size_t i = 0; i < nact; ++i) {
+                    if (m[i] >= 0.0)
+                        continue;
+                    Determinant J(d);
+                    double sign = J.destroy_alfa_bit(j);
+                    sign *= J.create_beta_bit(j);
+                    sign *= J.destroy_beta_bit(i);
+                    sign *= J.create_alfa_bit(i);
+                    auto it = state.find(J);
+                    if (it != state.end())
+                        flip_t[i * nact + j] += it->second * sign * cI;
+                }
+            }
+        }
+#pragma omp critical
+        {
+            for (size_t k = 0; k < n2; ++k) {
+                zz[k] += zz_t[k];
+                flip[k] += flip_t[k];
+            }
+            for (size_t i = 0; i < nact; ++i) {
+                sz[i] += sz_t[i];
+                pair[i] += pair_t[i];
+            }
+        }
+    }
+
+    // express the expectation values in terms of the pair elements of the 2-RDMs
+    std::vector<double> na(nact), nb(nact), Paa(n2, 0.0), Pbb(n2, 0.0), Pab(n2), Qab(n2);
+    for (const auto& [d, c] : state) {
+        for (size_t i = 0; i < nact; ++i) {
+            na[i] += c * c * double(d.get_alfa_bit(i));
+            nb[i] += c * c * double(d.get_beta_bit(i));
+        }
+    }
+    for (size_t i = 0; i < nact; ++i) {
+        for (size_t j = 0; j < nact; ++j) {
+            const size_t ij = i * nact + j;
+            // with Paa = Pbb = 0: 4 <S_z,i S_z,j> - delta_ij n_i = -(Pab_ij + Pab_ji)
+            double value = 4.0 * zz[ij] - (i == j ? na[i] + nb[i] : 0.0);
+            Pab[ij] = -0.5 * value;
+            // with i != j: <S+_i S-_j> = -Qab_ij
+            Qab[ij] = i == j ? pair[i] : -flip[ij];
+        }
+    }
+    return spin_correlation_from_pairs(nact, na, nb, Paa, Pbb, Pab, Qab);
+}
+
 SpinCorr::SpinCorr(RDMs rdms, std::shared_ptr<ForteOptions> options,
                    std::shared_ptr<MOSpaceInfo> mo_space_info,
                    std::shared_ptr<ActiveSpaceIntegrals> as_ints)
@@ -110,8 +334,6 @@ std::pair<psi::SharedMatrix, psi::SharedMatrix> SpinCorr::compute_nos() {
 
 void SpinCorr::spin_analysis() {
     size_t nact = static_cast<unsigned long>(nact_);
-    size_t nact2 = nact * nact;
-    size_t nact3 = nact * nact2;
 
     psi::SharedMatrix UA(new psi::Matrix(nact, nact));
     psi::SharedMatrix UB(new psi::Matrix(nact, nact));
@@ -218,84 +440,27 @@ void SpinCorr::spin_analysis() {
         UA->identity();
         UB->identity();
     }
-    ambit::Tensor Ua = ambit::Tensor::build(ambit::CoreTensor, "U", {nact, nact});
-    ambit::Tensor Ub = ambit::Tensor::build(ambit::CoreTensor, "U", {nact, nact});
-    Ua.iterate([&](const std::vector<size_t>& i, double& value) { value = UA->get(i[0], i[1]); });
-    Ub.iterate([&](const std::vector<size_t>& i, double& value) { value = UB->get(i[0], i[1]); });
-
-    //    new_dim = nact;
-    // 1 rdms first
-    ambit::Tensor L1aT = ambit::Tensor::build(ambit::CoreTensor, "Transformed L1a", {nact, nact});
-    ambit::Tensor L1bT = ambit::Tensor::build(ambit::CoreTensor, "Transformed L1b", {nact, nact});
-
-    auto ordm_a = rdms_.g1a();
-    auto ordm_b = rdms_.g1b();
-
-    auto trdm_aa = rdms_.g2aa();
-    auto trdm_ab = rdms_.g2ab();
-    auto trdm_bb = rdms_.g2bb();
-
-    L1aT("pq") = Ua("ap") * ordm_a("ab") * Ua("bq");
-    L1bT("pq") = Ub("ap") * ordm_b("ab") * Ub("bq");
-    // 2 rdms
-    ambit::Tensor L2aaT =
-        ambit::Tensor::build(ambit::CoreTensor, "Transformed L2aa", {nact, nact, nact, nact});
-    ambit::Tensor L2abT =
-        ambit::Tensor::build(ambit::CoreTensor, "Transformed L2ab", {nact, nact, nact, nact});
-    ambit::Tensor L2bbT =
-        ambit::Tensor::build(ambit::CoreTensor, "Transformed L2bb", {nact, nact, nact, nact});
-
-    L2aaT("pqrs") = Ua("ap") * Ua("bq") * trdm_aa("abcd") * Ua("cr") * Ua("ds");
-    L2abT("pqrs") = Ua("ap") * Ub("bq") * trdm_ab("abcd") * Ua("cr") * Ub("ds");
-    L2bbT("pqrs") = Ub("ap") * Ub("bq") * trdm_bb("abcd") * Ub("cr") * Ub("ds");
-
-    // Now form the spin correlation
+    SpinCorrelation sc;
+    if (options_->get_str("SPIN_BASIS") == "CANONICAL") {
+        sc = compute_spin_correlation(rdms_);
+    } else {
+        ambit::Tensor Ua = ambit::Tensor::build(ambit::CoreTensor, "U", {nact, nact});
+        ambit::Tensor Ub = ambit::Tensor::build(ambit::CoreTensor, "U", {nact, nact});
+        Ua.iterate(
+            [&](const std::vector<size_t>& i, double& value) { value = UA->get(i[0], i[1]); });
+        Ub.iterate(
+            [&](const std::vector<size_t>& i, double& value) { value = UB->get(i[0], i[1]); });
+        sc = compute_spin_correlation(rdms_, Ua, Ub);
+    }
+
     psi::SharedMatrix spin_corr(new psi::Matrix("Spin Correlation", nact, nact));
     psi::SharedMatrix spin_fluct(new psi::Matrix("Spin Fluctuation", nact, nact));
     psi::SharedMatrix spin_z(new psi::Matrix("Spin-z Correlation", nact, nact));
-
-    std::vector<double> l1a(L1aT.data());
-    std::vector<double> l1b(L1bT.data());
-    std::vector<double> l2aa(L2aaT.data());
-    std::vector<double> l2ab(L2abT.data());
-    std::vector<double> l2bb(L2bbT.data());
-    for (size_t i = 0; i < nact; ++i) {
-        for (size_t j = 0; j < nact; ++j) {
-            double value = (l2aa[i * nact3 + j * nact2 + i * nact + j] +
-                            l2bb[i * nact3 + j * nact2 + i * nact + j] -
-                            l2ab[i * nact3 + j * nact2 + i * nact + j] -
-                            l2ab[j * nact3 + i * nact2 + j * nact + i]);
-            if (i == j) {
-                value += (l1a[nact * i + j] + l1b[nact * i + j]);
-            }
-
-            value +=
-                (l1a[nact * i + i] - l1b[nact * i + i]) * (l1a[nact * j + j] - l1b[nact * j + j]);
-
-            spin_z->set(i, j, value);
-        }
-    }
-
     for (size_t i = 0; i < nact; ++i) {
         for (size_t j = 0; j < nact; ++j) {
-            double value = 0.0;
-            if (i == j) {
-                value += 0.75 * (l1a[nact * i + j] + l1b[nact * i + j]);
-            }
-            value -= 0.5 * (l2ab[i * nact3 + j * nact2 + j * nact + i] +
-                            l2ab[j * nact3 + i * nact2 + i * nact + j]);
-
-            value += 0.25 * (l2aa[i * nact3 + j * nact2 + i * nact + j] +
-                             l2bb[i * nact3 + j * nact2 + i * nact + j] -
-                             l2ab[i * nact3 + j * nact2 + i * nact + j] -
-                             l2ab[j * nact3 + i * nact2 + j * nact + i]);
-
-            spin_corr->set(i, j, value);
-            value -=
-                0.25 *
-                (l1a[i * nact + i] * l1a[j * nact + j] + l1b[i * nact + i] * l1b[j * nact + j] -
-                 l1a[i * nact + i] * l1b[j * nact + j] - l1b[i * nact + i] * l1a[j * nact + j]);
-            spin_fluct->set(i, j, value);
+            spin_corr->set(i, j, sc.spin_corr.data()[i * nact + j]);
+            spin_fluct->set(i, j, sc.spin_fluct.data()[i * nact + j]);
+            spin_z->set(i, j, sc.spin_z.data()[i * nact + j]);
         }
     }
 
@@ -322,10 +487,10 @@ void SpinCorr::spin_analysis() {
         }
         file.close();
         std::ofstream file2;
-        file.open("spin_fluct.txt", std::ofstream::out | std::ofstream::trunc);
+        file2.open("spin_fluct.txt", std::ofstream::out | std::ofstream::trunc);
         for (size_t i = 0; i < nact; ++i) {
             for (size_t j = 0; j < nact; ++j) {
-                file << std::setw(12) << std::setprecision(6) << spin_fluct->get(i, j) << " ";
+                file2 << std::setw(12) << std::setprecision(6) << spin_fluct->get(i, j) << " ";
             }
             file2 << "\n";
         }
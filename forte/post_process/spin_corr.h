@@ -36,11 +36,42 @@
 #include "ci_rdm/ci_rdms.h"
 #include "integrals/active_space_integrals.h"
 #include "sparse_ci/determinant.h"
+#include "sparse_ci/sparse_state_vector.h"
 #include "orbital-helpers/iao_builder.h"
 #include "orbital-helpers/localize.h"
 
 namespace forte {
 
+/**
+ * @brief The spin correlation functions of all pairs of active orbitals (nact x nact tensors)
+ */
+struct SpinCorrelation {
+    /// <S_i . S_j>
+    ambit::Tensor spin_corr;
+    /// <S_i . S_j> - <S_z,i> <S_z,j>
+    ambit::Tensor spin_fluct;
+    /// 4 <S_z,i S_z,j> + 4 <S_z,i> <S_z,j>
+    ambit::Tensor spin_z;
+};
+
+/**
+ * @brief Compute the spin correlation functions from the 1- and 2-RDMs in the orbital basis
+ * defined by the rotations Ua and Ub (phi_i = sum_a phi_a U_ai). Only the elements of the
+ * 2-RDMs with indices (ijij) and (ijji) are transformed, using two matrix products over the
+ * full 2-RDM instead of a four-index transformation.
+ */
+SpinCorrelation compute_spin_correlation(RDMs& rdms, ambit::Tensor Ua, ambit::Tensor Ub);
+
+/// @brief Compute the spin correlation functions from the 1- and 2-RDMs in the basis of the RDMs
+SpinCorrelation compute_spin_correlation(RDMs& rdms);
+
+/**
+ * @brief Compute the spin correlation functions directly from a normalized CI vector in the
+ * basis of the determinants, without building the 2-RDMs
+ * @param state the CI vector
+ * @param nact the number of active orbitals
+ */
+SpinCorrelation compute_spin_correlation(const StateVector& state, size_t nact);
 
 /**
  * @brief The SpinCorr class
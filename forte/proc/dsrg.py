@@ -111,13 +111,20 @@ class ProcedureDSRG:
         self.energies = []  # energies along the relaxation steps
         self.energies_environment = {}  # energies pushed to Psi4 environment globals
 
+        # Build the 3-RDM while the first DSRG computation starts (only the 1- and 2-RDMs are needed to set it up)
+        self.pipeline_rdms = (
+            options.get_bool("DSRG_PIPELINE_RDMS") and self.max_rdm_level == 3 and self.do_semicanonical and
+            self.solver_type in ["SA-MRDSRG", "SA_MRDSRG"] and options.get_str("CORR_LEVEL") == "PT2"
+        )
+
         # Compute RDMs from initial ActiveSpaceSolver
-        self.rdms = active_space_solver.compute_average_rdms(state_weights_map, self.max_rdm_level)
+        rdm_level = 2 if self.pipeline_rdms else self.max_rdm_level
+        self.rdms = active_space_solver.compute_average_rdms(state_weights_map, rdm_level)
 
         # Semi-canonicalize orbitals and rotation matrices
         self.semi = forte.SemiCanonical(mo_space_info, ints, options)
         if self.do_semicanonical:
-            self.semi.semicanonicalize(self.rdms, self.max_rdm_level)
+            self.semi.semicanonicalize(self.rdms, rdm_level)
         self.Ua, self.Ub = self.semi.Ua_t(), self.semi.Ub_t()
 
     def make_dsrg_solver(self):
@@ -166,7 +173,12 @@ class ProcedureDSRG:
         # Perform the initial un-relaxed DSRG
         self.make_dsrg_solver()
         self.dsrg_setup()
-        e_dsrg = self.dsrg_solver.compute_energy()
+        if self.pipeline_rdms:
+            e_dsrg = self.dsrg_solver.compute_energy_pipelined(
+                self.active_space_solver, self.state_weights_map, self.semi, self.max_rdm_level
+            )
+        else:
+            e_dsrg = self.dsrg_solver.compute_energy()
         psi4.core.set_scalar_variable("UNRELAXED ENERGY", e_dsrg)
 
         self.energies_environment[0] = {k: v for k, v in psi4.core.variables().items()
@@ -259,6 +259,16 @@ def _irrep_map_inverse(symm):
     return np.array(irrep_map, dtype='int')
 
 
+def _convert_irreps_to_psi4(intdump):
+    """Convert the orbital and state symmetries of a FCIDUMP dictionary to the ordering used in psi4
+    """
+    if ('pntgrp' in intdump) and ('orbsym' in intdump):
+        irrep_map_inverse = _irrep_map_inverse(intdump['pntgrp'])
+        psi4_irrep_map = map(lambda x: irrep_map_inverse[x], intdump['orbsym'])
+        intdump['orbsym'] = list(psi4_irrep_map)
+        intdump['isym'] = irrep_map_inverse[intdump['isym']]
+
+
 def fcidump_from_file(fname, convert_to_psi4=False):
     """Function to read in a FCIDUMP file.
 
@@ -306,11 +316,8 @@ def fcidump_from_file(fname, convert_to_psi4=False):
 
             intdump[key.lower()] = value
 
-    if convert_to_psi4 and ('pntgrp' in intdump) and ('orbsym' in intdump):
-        irrep_map_inverse = _irrep_map_inverse(intdump['pntgrp'])
-        psi4_irrep_map = map(lambda x: irrep_map_inverse[x], intdump['orbsym'])
-        intdump['orbsym'] = list(psi4_irrep_map)
-        intdump['isym'] = irrep_map_inverse[intdump['isym']]
+    if convert_to_psi4:
+        _convert_irreps_to_psi4(intdump)
 
     # Read the data and index, skip header
     raw_ints = np.genfromtxt(fname, skip_header=skiplines)
@@ -362,3 +369,43 @@ def fcidump_from_file(fname, convert_to_psi4=False):
     intdump['eri'] = eri
 
     return intdump
+
+
+def fcidump_from_file_native(fname, convert_to_psi4=False):
+    """Function to read in a FCIDUMP file with the C++ reader (forte.FCIDUMP).
+
+    The integral lines are parsed in parallel and the file can also be in the binary format
+    written by forte.FCIDUMP.save_binary.
+
+    :returns: a dictionary with the same keys as fcidump_from_file, except that 'eri'
+    is the forte.FCIDUMP object, which stores the symmetry-packed integrals and
+    can be indexed as eri[i, j, k, l]
+
+    :param fname: FCIDUMP file name
+    :param convert_to_psi4: If turned on and the FCIDUMP
+    file contains the PNTGRP label, the orbital symmetries will
+    be converted to the ordering used in psi4
+    """
+    import forte
+
+    native = forte.FCIDUMP(str(fname))
+    intdump = {
+        'norb': native.norb(),
+        'nelec': native.nelec(),
+        'ms2': native.ms2(),
+        'isym': native.isym(),
+        'uhf': native.uhf(),
+        'orbsym': list(native.orbsym()) if len(native.orbsym()) > 0 else [1] * native.norb(),
+        'enuc': native.enuc(),
+        'hcore': native.hcore(),
+        'eri': native
+    }
+    if native.pntgrp():
+        intdump['pntgrp'] = native.pntgrp()
+    if len(native.epsilon()) > 0:
+        intdump['epsilon'] = native.epsilon()
+
+    if convert_to_psi4:
+        _convert_irreps_to_psi4(intdump)
+
+    return intdump
@@ -1,8 +1,6 @@
 import itertools
 import functools
 import time
-import math
-import copy
 
 import numpy as np
 
@@ -360,189 +358,22 @@ def solve_cc_equations(
         The maximum number of iterations
     Returns
     -------
-    tuple(t, e, e_proj, micro_iter + 1, exp.timings())
+    tuple(t, e, e_proj, iterations, timings)
         Returns the a tuple containign the converged amplitudes, the energy, the projective energy,
         the number of iterations, and timings information
     """
-    diis = DIIS(t,diis_start)
-    ham = forte.SparseHamiltonian(as_ints)
-    if cc_type == "cc" or cc_type == "ucc":
-        exp = forte.SparseExp()
-    if cc_type == "dcc" or cc_type == "ducc":
-        exp = forte.SparseFactExp()
-
-    old_e_micro = 0.0
-
-    for micro_iter in range(maxiter):
-        micro_start = time.time()
-        t_old = copy.deepcopy(t)
-        residual, e, e_proj = residual_equations(
-            cc_type, t, op, selected_op, ref, ham, exp, compute_threshold,on_the_fly,linked,maxk
-        )
-
-        residual_norm = 0.0
-        for l in range(selected_op.size()):
-            t[l] -= residual[op_pool[l]] / denominators[op_pool[l]]
-            residual_norm += residual[op_pool[l]] ** 2
-
-        residual_norm = math.sqrt(residual_norm)
-
-        t = diis.update(t, t_old)
-
-        delta_e_micro = e - old_e_micro
-
-        print(
-            f"    {micro_iter:4d} {e:20.12f}   {delta_e_micro:+6e}   {residual_norm:+6e}   {time.time() - micro_start:8.3f}",
-            flush=True,
-        )
-
-        if (
-            micro_iter > 2
-            and (abs(delta_e_micro) < e_convergence)
-            and (residual_norm < r_convergence)
-        ):
-            break
-
-        old_e_micro = e
-
-    return (t, e, e_proj, micro_iter + 1, exp.timings())
-
-def residual_equations(
-    cc_type, t, op, sop, ref, ham, exp, compute_threshold, on_the_fly=False, linked=True,maxk=19
-):
-    """Evaluate the residual equations
-
-    Parameters
-    ----------
-    antihermitian : bool
-        Is this operator antihermitian?
-    max_exc : int
-        The maximum excitation level (defaul: None)
-    naelpi : psi4 Dimension
-        The number of alpha electrons per irrep
-    psi4_wfn : psi4 Wavefunction
-        A psi4 Wavefunction object (to read the number of alpha/beta electrons)
-    on_the_fly : bool
-        Use the on-the-fly algorithms? By default this code uses a caching algorithm
-        that can be faster when using very small compute threshold values (default = False)
-    linked : bool
-        Use a linked formulation of the CC equations (a commutator series)?
-    Returns
-    -------
-    tuple(list,float,float)
-        Returns the a tuple containign the residual (indexed as the operators/amplitudes),
-        the average energy, and the projective energy
-    """
-    # update the amplitudes
-    sop.set_coefficients(t)
-
-    c0 = 0.0
-    if on_the_fly:
-        if cc_type == "cc" or cc_type == "ucc":
-            wfn = exp.compute(sop, ref,algorithm='onthefly',screen_thresh=compute_threshold,maxk=maxk)
-            Hwfn = ham.compute_on_the_fly(wfn, compute_threshold)
-            R = exp.compute(sop, Hwfn, scaling_factor=-1.0,algorithm='onthefly',screen_thresh=compute_threshold,maxk=maxk)
-        elif cc_type == "dcc" or cc_type == "ducc":
-            wfn = exp.compute(sop, ref,algorithm='onthefly',screen_thresh=compute_threshold)
-            Hwfn = ham.compute_on_the_fly(wfn, compute_threshold)
-            R = exp.compute(sop, Hwfn, inverse=True,algorithm='onthefly',screen_thresh=compute_threshold)
-        else:
-            raise ValueError("Incorrect value for cc_type")
-    else:
-        if cc_type == "cc" or cc_type == "ucc":
-            wfn = exp.compute(sop, ref,screen_thresh=compute_threshold,maxk=maxk)
-            Hwfn = ham.compute(wfn, compute_threshold)
-            R = exp.compute(sop, Hwfn, scaling_factor=-1.0,screen_thresh=compute_threshold,maxk=maxk)
-        elif cc_type == "dcc" or cc_type == "ducc":
-            wfn = exp.compute(sop, ref,screen_thresh=compute_threshold)
-            Hwfn = ham.compute(wfn, compute_threshold)
-            R = exp.compute(sop, Hwfn, inverse=True,screen_thresh=compute_threshold)
-        else:
-            raise ValueError("Incorrect value for cc_type")
-
-    # compute <ref|Psi>
-    for d, c in ref.items():
-        c0 += c * wfn[d]
-    energy = 0.0
-    energy_proj = 0.0
-    if linked:
-        # compute Eavg = <Psi|H|Psi> = <ref|U^+ H U|ref>
-        for d, c in ref.items():
-            energy += c * R[d]
-        # compute Eproj = <ref|H|Psi> / <ref|Psi> = <ref|H U|ref> / <ref|U|ref> 
-        for d, c in ref.items():
-            energy_proj += c * Hwfn[d] / c0
-        # compute R = <exc|U^+ H U|ref>
-        residual = forte.get_projection(op, ref, R)
-    else:
-        # compute the energy as the expectation value = <exc|U^+ H U|ref> / <exc|U^+U|ref>
-        N2 = 0.0
-        for d, c in wfn.items():
-            N2 += c**2
-            energy += c * Hwfn[d]
-        energy = energy / N2
-        # compute the projective energy as the expectation value = <ref|H U|ref> / <ref|U|ref>
-        for d, c in ref.items():
-            energy_proj += c * Hwfn[d] / c0
-        # compute R = <exc|H U|ref> - E_proj <exc|U|ref>
-        for d, c in wfn.items():
-            Hwfn[d] -= c * energy_proj  
-        residual = forte.get_projection(op, ref, Hwfn)
-
-    return (residual, energy, energy_proj)
-
-class DIIS:
-    """A class that implements DIIS for CC theory 
-
-        Parameters
-    ----------
-    diis_start : int
-        Start the iterations when the DIIS dimension is greather than this parameter (default = 3)
-    """  
-    def __init__(self, t, diis_start=3):
-        self.t_diis = [t]
-        self.e_diis = []
-        self.diis_start = diis_start
-
-    def update(self, t, t_old):
-        """Update the DIIS object and return extrapolted amplitudes
-
-        Parameters
-        ----------
-        t : list
-            The updated amplitudes
-        t_old : list
-            The previous set of amplitudes            
-        Returns
-        -------
-        list
-            The extrapolated amplitudes
-        """
-
-        if self.diis_start == -1:
-            return t
-
-        self.t_diis.append(t)
-        self.e_diis.append(np.subtract(t, t_old))
-
-        diis_dim = len(self.t_diis) - 1
-        if (diis_dim >= self.diis_start) and (diis_dim < len(t)):
-            # consturct diis B matrix (following Crawford Group github tutorial)
-            B = np.ones((diis_dim + 1, diis_dim + 1)) * -1.0
-            bsol = np.zeros(diis_dim + 1)
-            B[-1, -1] = 0.0
-            bsol[-1] = -1.0
-            for i in range(len(self.e_diis)):
-                for j in range(i, len(self.e_diis)):
-                    B[i, j] = np.dot(np.real(self.e_diis[i]), np.real(self.e_diis[j]))
-                    if i != j:
-                        B[j, i] = B[i, j]
-            B[:-1, :-1] /= np.abs(B[:-1, :-1]).max()
-            x = np.linalg.solve(B, bsol)
-            t_new = np.zeros((len(t)))
-            for l in range(diis_dim):
-                temp_ary = x[l] * np.asarray(self.t_diis[l + 1])
-                t_new = np.add(t_new, temp_ary)
-            return copy.deepcopy(list(np.real(t_new)))
-
-        return t
+    # the amplitude equations are solved by the C++ solver, which keeps the amplitudes, the
+    # states, and the couplings cached by the exponential in memory during all the iterations
+    selected_op.set_coefficients(t)
+    solver = forte.SparseCCSolver(as_ints, cc_type, selected_op, [denominators[l] for l in op_pool], ref)
+    solver.set_compute_threshold(compute_threshold)
+    solver.set_e_convergence(e_convergence)
+    solver.set_r_convergence(r_convergence)
+    solver.set_on_the_fly(on_the_fly)
+    solver.set_linked(linked)
+    solver.set_maxk(maxk)
+    solver.set_diis_start(diis_start)
+    solver.set_maxiter(maxiter)
+    e = solver.compute_energy()
+
+    return (list(solver.amplitudes()), e, solver.proj_energy(), solver.iterations(), solver.timings())
@@ -274,7 +274,14 @@ def prepare_forte_objects_from_fcidump(options, path='.'):
     fcidump_file = options.get_str('FCIDUMP_FILE')
     filename = pathlib.Path(path) / fcidump_file
     psi4.core.print_out(f'\n  Reading integral information from FCIDUMP file {filename}')
-    fcidump = forte.proc.fcidump_from_file(filename, convert_to_psi4=True)
+    if options.get_str('FCIDUMP_READER') == 'NATIVE':
+        fcidump = forte.proc.fcidump_from_file_native(filename, convert_to_psi4=True)
+        binary_file = options.get_str('FCIDUMP_SAVE_BINARY')
+        if binary_file:
+            psi4.core.print_out(f'\n  Saving the FCIDUMP integrals in binary format to {binary_file}')
+            fcidump['eri'].save_binary(binary_file)
+    else:
+        fcidump = forte.proc.fcidump_from_file(filename, convert_to_psi4=True)
 
     irrep_size = {'c1': 1, 'ci': 2, 'c2': 2, 'cs': 2, 'd2': 4, 'c2v': 4, 'c2h': 4, 'd2h': 8}
 
@@ -354,6 +361,10 @@ def prepare_forte_objects_from_fcidump(options, path='.'):
 
 
 def make_ints_from_fcidump(fcidump, options, mo_space_info):
+    # the native reader keeps the symmetry-packed integrals in C++
+    if isinstance(fcidump['eri'], forte.FCIDUMP):
+        return forte.make_custom_ints_from_fcidump(options, mo_space_info, fcidump['eri'])
+
     # transform two-electron integrals from chemist to physicist notation
     eri = fcidump['eri']
     nmo = fcidump['norb']
@@ -440,10 +451,18 @@ def forte_driver(state_weights_map, scf_info, options, ints, mo_space_info):
     # create an active space solver object and compute the energy
     active_space_solver_type = options.get_str('ACTIVE_SPACE_SOLVER')
     as_ints = forte.make_active_space_ints(mo_space_info, ints, "ACTIVE", ["RESTRICTED_DOCC"])
+    if options.get_str('ACTIVE_SPACE_INTS_STORAGE') == 'PACKED':
+        as_ints = forte.detach_active_space_ints(as_ints)
+        as_ints.pack_integrals()
+    elif options.get_str('ACTIVE_SPACE_INTS_STORAGE') == 'LOW_RANK':
+        as_ints = forte.detach_active_space_ints(as_ints)
+        as_ints.factorize_integrals(options.get_double('ACTIVE_SPACE_INTS_LOW_RANK_TOLERANCE'))
     active_space_solver = forte.make_active_space_solver(
         active_space_solver_type, state_map, scf_info, mo_space_info, as_ints, options
     )
+    forte.memory_begin_phase("Active space solver")
     state_energies_list = active_space_solver.compute_energy()
+    forte.memory_end_phase()
 
     if options.get_bool('SPIN_ANALYSIS'):
         rdms = active_space_solver.compute_average_rdms(state_weights_map, 2)
@@ -453,13 +472,18 @@ def forte_driver(state_weights_map, scf_info, options, ints, mo_space_info):
     correlation_solver_type = options.get_str('CORRELATION_SOLVER')
     if correlation_solver_type != 'NONE':
         dsrg_proc = ProcedureDSRG(active_space_solver, state_weights_map, mo_space_info, ints, options, scf_info)
+        forte.memory_begin_phase("Dynamic correlation")
         return_en = dsrg_proc.compute_energy()
+        forte.memory_end_phase()
         dsrg_proc.print_summary()
         dsrg_proc.push_to_psi4_environment()
     else:
         average_energy = forte.compute_average_state_energy(state_energies_list, state_weights_map)
         return_en = average_energy
 
+    if options.get_int('PRINT') > 0:
+        forte.print_memory_summary()
+
     return return_en
 
 
@@ -481,6 +505,17 @@ def run_forte(name, **kwargs):
     # Print the banner
     forte.banner()
 
+    forte.set_numa_memory_options(
+        options.get_bool('NUMA_FIRST_TOUCH'), options.get_bool('HUGE_PAGES'),
+        options.get_int('HUGE_PAGES_MIN_SIZE') * 1024 * 1024
+    )
+
+    profile = options.get_bool('PROFILE')
+    forte.profiler_enable(profile)
+    if profile:
+        forte.profiler_enable_counters(options.get_bool('PROFILE_COUNTERS'))
+        profile_region = forte.profiler_begin('Forte')
+
     # Prepare Forte objects: state_weights_map, mo_space_info, scf_info
     forte_objects = prepare_forte_objects(options, name, **kwargs)
     ref_wfn, state_weights_map, mo_space_info, scf_info, fcidump = forte_objects
@@ -536,6 +571,12 @@ def run_forte(name, **kwargs):
 
     end = time.time()
 
+    if profile:
+        forte.profiler_end(profile_region)
+        forte.profiler_print_summary()
+        if options.get_str('PROFILE_FILE') != '':
+            forte.profiler_write_chrome_trace(options.get_str('PROFILE_FILE'))
+
     # Close ambit, etc.
     # forte.cleanup()
 
@@ -641,10 +682,15 @@ def gradient_forte(name, **kwargs):
 
     time_pre_deriv = time.time()
 
-    derivobj = psi4.core.Deriv(ref_wfn)
-    derivobj.set_deriv_density_backtransformed(True)
-    derivobj.set_ignore_reference(True)
-    grad = derivobj.compute(psi4.core.DerivCalcType.Correlated)
+    if psi4.core.has_array_variable("FORTE DF GRADIENT"):
+        # the gradient was computed in core with DF derivative integrals
+        grad = psi4.core.variable("FORTE DF GRADIENT")
+        psi4.core.del_array_variable("FORTE DF GRADIENT")
+    else:
+        derivobj = psi4.core.Deriv(ref_wfn)
+        derivobj.set_deriv_density_backtransformed(True)
+        derivobj.set_ignore_reference(True)
+        grad = derivobj.compute(psi4.core.DerivCalcType.Correlated)
     ref_wfn.set_gradient(grad)
     optstash.restore()
 
@@ -671,6 +717,49 @@ def gradient_forte(name, **kwargs):
     return ref_wfn
 
 
+def run_forte_scan(name, points, molecule=None, **kwargs):
+    r"""Compute the Forte energy along a scan of the geometry, reusing the setup of each point
+    in the next one.
+
+    The orbitals of each point are passed as the reference of the next one (Forte orthogonalizes
+    them at the new geometry) and as the SCF guess (GUESS READ). The FCI string lists and the
+    Davidson-Liu subspace are kept in memory (REUSE_SETUP), so the CI of each point starts from
+    the converged vectors of the previous one. The integrals and the JK objects depend on the
+    geometry and are recomputed at each point.
+
+    >>> energies = run_forte_scan('forte', [{'R': r} for r in [0.9, 1.0, 1.1]])
+
+    :param name: the name of the method passed to psi4.energy
+    :param points: a list of dictionaries {variable: value} with the values of the variables
+        of the molecule (e.g., the Z-matrix coordinates) at each point
+    :param molecule: the molecule to scan (default: the active molecule)
+    :return: the list of energies
+    """
+    molecule = molecule or psi4.core.get_active_molecule()
+    kwargs = p4util.kwargs_lower(kwargs)
+    kwargs.pop('return_wfn', None)
+    ref_wfn = kwargs.pop('ref_wfn', None)
+
+    optstash = p4util.OptionsState(['SCF', 'GUESS'], ['FORTE', 'REUSE_SETUP'])
+    psi4.core.set_local_option('FORTE', 'REUSE_SETUP', True)
+
+    energies = []
+    for n, point in enumerate(points):
+        for variable, value in point.items():
+            molecule.set_variable(variable, value)
+        molecule.update_geometry()
+        if ref_wfn is not None:
+            psi4.core.set_local_option('SCF', 'GUESS', 'READ')
+        energy, wfn = psi4.energy(name, molecule=molecule, ref_wfn=ref_wfn, return_wfn=True, **kwargs)
+        psi4.core.print_out(f'\n  Scan point {n}: {point}  energy = {energy:.12f}\n')
+        energies.append(energy)
+        if isinstance(wfn, psi4.core.Wavefunction):
+            ref_wfn = wfn
+
+    optstash.restore()
+    return energies
+
+
 # Integration with driver routines
 psi4.driver.procedures['energy']['forte'] = run_forte
 psi4.driver.procedures['gradient']['forte'] = gradient_forte
@@ -83,6 +83,29 @@ def register_driver_options(options):
 
     options.add_int("PRINT", 1, "Set the print level.")
 
+    options.add_bool("PROFILE", False, "Record the timed regions of Forte and print a profile at the end")
+
+    options.add_str(
+        "PROFILE_FILE", "", "If PROFILE is true, also write the profile to this file in the Chrome trace"
+        " (JSON) format"
+    )
+
+    options.add_bool(
+        "PROFILE_COUNTERS", False, "If PROFILE is true, also record the hardware counters (cycles, instructions,"
+        " cache misses) of each region (Linux perf_event)"
+    )
+
+    options.add_bool(
+        "NUMA_FIRST_TOUCH", True, "Place the pages of the large arrays (CI vectors, Davidson-Liu subspace, DF"
+        " integrals) on the NUMA node of the threads that work on them"
+    )
+
+    options.add_bool(
+        "HUGE_PAGES", False, "Request 2 MB transparent huge pages for the arrays larger than HUGE_PAGES_MIN_SIZE"
+    )
+
+    options.add_int("HUGE_PAGES_MIN_SIZE", 64, "The size (in MB) of the smallest array that uses huge pages")
+
     options.add_bool("READ_ORBITALS", False, "Read orbitals from file if true")
 
     options.add_bool("DUMP_ORBITALS", False, "Save orbitals to file if true")
@@ -191,6 +214,11 @@ def register_embedding_options(options):
         "EMBEDDING_ADJUST_B_UOCC", 0, "Adjust number of virtual orbitals between A and B, +: move to B, -: move to A"
     )
     options.add_str("EMBEDDING_VIRTUAL_SPACE", "ASET", ["ASET", "PAO", "IAO"], "Vitual space scheme")
+    options.add_bool(
+        "EMBEDDING_FOLLOW_PARTITION", False,
+        "Follow the system orbitals of the previous embedding call (e.g., along a scan) by their overlap"
+        " and keep the number of system orbitals fixed"
+    )
     options.add_double("PAO_THRESHOLD", 1e-8, "Virtual space truncation threshold for PAO.")
     options.add_bool(
         "PAO_FIX_VIRTUAL_NUMBER", False,
@@ -250,14 +278,39 @@ def register_active_space_solver_options(options):
 
     options.add_bool("DUMP_ACTIVE_WFN", False, "Save CI wave function of ActiveSpaceSolver to disk")
 
+    options.add_bool(
+        "ACTIVE_SPACE_SOLVER_CONCURRENT", False,
+        "Solve the CI and compute the RDMs and contracted energies of different state symmetries concurrently,"
+        " each with a subgroup of threads (FCI only)"
+    )
+
     options.add_bool("READ_ACTIVE_WFN_GUESS", False, "Read CI wave function of ActiveSpaceSolver from disk")
 
+    options.add_bool(
+        "REUSE_SETUP", False, "Keep the FCI string lists and Davidson-Liu subspace in memory and reuse them"
+        " in the next computation with the same active space (e.g., the points of a scan)"
+    )
+
     options.add_bool("TRANSITION_DIPOLES", False, "Compute the transition dipole momemnts and oscillator strengths")
 
 
 def register_pt2_options(options):
     options.set_group("PT2")
     options.add_double("PT2_MAX_MEM", 1.0, "Maximum size of the determinant hash (GB)")
+    options.add_bool("PT2_STOCHASTIC", False, "Compute the full PT2 energy semistochastically?")
+    options.add_double(
+        "PT2_DETERMINISTIC_WEIGHT", 0.9,
+        "The fraction of the norm of the reference covered by the largest determinants treated"
+        " deterministically in semistochastic PT2"
+    )
+    options.add_int(
+        "PT2_STOCHASTIC_NSAMPLE", 200, "The number of reference determinants drawn in each sample of"
+        " semistochastic PT2"
+    )
+    options.add_int("PT2_STOCHASTIC_BATCH_SIZE", 16, "The number of samples computed between convergence checks")
+    options.add_int("PT2_STOCHASTIC_MAX_SAMPLES", 1000, "The maximum number of samples in semistochastic PT2")
+    options.add_double("PT2_STOCHASTIC_ERROR", 1.0e-5, "The target statistical error of semistochastic PT2 (Eh)")
+    options.add_int("PT2_STOCHASTIC_SEED", 0, "The seed of the random number generator of semistochastic PT2")
 
 
 def register_pci_options(options):
@@ -292,6 +345,11 @@ def register_pci_options(options):
 
     options.add_bool("PCI_FAST_EVAR", False, "Use a fast (sparse) estimate of the energy?")
 
+    options.add_bool(
+        "PCI_INCREMENTAL_EVAR", False, "Update the variational energy estimate from the change of the"
+        " coefficients in each step? Only the wall-Chebyshev generator supports it"
+    )
+
     options.add_double("PCI_EVAR_MAX_ERROR", 0.0, "The max allowed error for variational energy")
 
     options.add_int("PCI_ENERGY_ESTIMATE_FREQ", 1, "Iterations in between variational estimation of the energy")
@@ -332,6 +390,23 @@ def register_pci_options(options):
 
     options.add_int("PCI_CHEBYSHEV_ORDER", 5, "The order of Chebyshev truncation")
 
+    options.add_str(
+        "PCI_HIGH_ENERGY_ESTIMATE", "GERSHGORIN", ["GERSHGORIN", "LANCZOS"],
+        "How the highest eigenvalue used by the Chebyshev generators is estimated. LANCZOS refines the"
+        " Gershgorin estimate with a Lanczos iteration on a screened Hamiltonian"
+    )
+
+    options.add_int("PCI_LANCZOS_MAXITER", 20, "The maximum number of Lanczos iterations of the high energy estimate")
+
+    options.add_double(
+        "PCI_LANCZOS_SPAWNING_THRESHOLD", 0.01, "The spawning threshold of the screened Hamiltonian used by"
+        " the Lanczos high energy estimate"
+    )
+
+    options.add_double(
+        "PCI_LANCZOS_CONVERGENCE", 1.0e-3, "The convergence threshold on the Lanczos high energy estimate"
+    )
+
     options.add_int("PCI_KRYLOV_ORDER", 5, "The order of Krylov truncation")
 
     options.add_double("PCI_COLINEAR_THRESHOLD", 1.0e-6, "The minimum norm of orthogonal vector")
@@ -354,6 +429,27 @@ def register_fci_options(options):
     options.add_bool('FCI_TEST_RDMS', False, 'Test the FCI reduced density matrices?')
     options.add_bool('PRINT_NO', False, 'Print the NO from the rdm of FCI')
     options.add_int('NTRIAL_PER_ROOT', 10, 'The number of trial guess vectors to generate per root')
+    options.add_str(
+        'FCI_SIGMA_ALGORITHM', 'LISTS', ['LISTS', 'DGEMM'],
+        'The algorithm used to compute the alpha-beta term of the FCI sigma vector.'
+        ' DGEMM uses matrix multiplications and is faster for large active spaces'
+    )
+    options.add_str(
+        'FCI_SIGMA_PRECISION', 'DOUBLE', ['DOUBLE', 'MIXED'],
+        'The precision of the FCI sigma vector intermediates. MIXED stores the intermediates of'
+        ' the alpha-beta term (LISTS algorithm) in single precision until the residual is below'
+        ' FCI_MIXED_PRECISION_SWITCH, and then uses double precision'
+    )
+    options.add_double(
+        'FCI_MIXED_PRECISION_SWITCH', 1.0e-4,
+        'The residual norm below which the FCI sigma vectors are built in double precision'
+        ' (for FCI_SIGMA_PRECISION = MIXED)'
+    )
+    options.add_double(
+        'FCI_HOLE_LISTS_MAX_MEM', 1.0,
+        'The maximum memory (GB) used by the 1-, 2-, and 3-hole string lists.'
+        ' The lists are generated on demand and released after use when they exceed this size'
+    )
 
 
 def register_sci_options(options):
@@ -368,8 +464,10 @@ def register_sci_options(options):
     )
 
     options.add_str(
-        "SCI_EXCITED_ALGORITHM", "NONE", ['AVERAGE', 'ROOT_ORTHOGONALIZE', 'ROOT_COMBINE', 'MULTISTATE'],
-        "The selected CI excited state algorithm"
+        "SCI_EXCITED_ALGORITHM", "NONE", ['AVERAGE', 'ROOT_FOLLOW', 'ROOT_ORTHOGONALIZE', 'ROOT_COMBINE', 'MULTISTATE'],
+        "The selected CI excited state algorithm. AVERAGE and ROOT_FOLLOW compute all the roots together from a shared"
+        " P space (one screening of the first-order space and one set of coupling lists per cycle). ROOT_FOLLOW in"
+        " addition keeps the order of the roots between cycles by their overlap with the roots of the previous cycle"
     )
 
     options.add_int("SCI_MAX_CYCLE", 20, "Maximum number of cycles")
@@ -388,14 +486,29 @@ def register_sci_options(options):
 
     options.add_bool("SCI_CORE_EX", False, "Use core excitation algorithm")
 
+    options.add_bool(
+        "SCI_CHECKPOINT", False, "Write the P space, its coefficients, and the energy history to a"
+        " checkpoint file at the end of each selected CI cycle"
+    )
+
+    options.add_str("SCI_CHECKPOINT_FILE", "forte.sci.chk", "The name of the selected CI checkpoint file")
+
+    options.add_str(
+        "SCI_RESTART", "NONE", ['NONE', 'RESUME', 'GUESS'],
+        "Read the selected CI checkpoint file: RESUME continues an interrupted calculation from the"
+        " last completed cycle, GUESS uses the stored P space as the initial guess (e.g., at a new"
+        " geometry)"
+    )
+
 
 def register_aci_options(options):
     options.set_group("ACI")
     options.add_double("ACI_CONVERGENCE", 1e-9, "ACI Convergence threshold")
 
     options.add_str(
-        "ACI_SCREEN_ALG", "AVERAGE", ['AVERAGE', 'SR', 'RESTRICTED', 'CORE', 'BATCH_HASH', 'BATCH_VEC'],
-        "The screening algorithm to use"
+        "ACI_SCREEN_ALG", "AVERAGE",
+        ['AVERAGE', 'SR', 'RESTRICTED', 'CORE', 'BATCH_HASH', 'BATCH_VEC', 'BATCH_EXTERNAL', 'MPI'],
+        "The screening algorithm to use (MPI requires Forte compiled with ENABLE_MPI)"
     )
 
     options.add_double("SIGMA", 0.01, "The energy selection threshold for the P space")
@@ -404,6 +517,11 @@ def register_aci_options(options):
 
     options.add_double("ACI_PRESCREEN_THRESHOLD", 1e-12, "The SD space prescreening threshold")
 
+    options.add_bool(
+        "ACI_HEAT_BATH", False, "Generate the doubly excited determinants of the SD space from"
+        " integrals sorted by magnitude, stopping at ACI_PRESCREEN_THRESHOLD (heat-bath screening)"
+    )
+
     options.add_str(
         "ACI_PQ_FUNCTION", "AVERAGE", ['AVERAGE', 'MAX'], "Function of q-space criteria, per root for SA-ACI"
     )
@@ -480,7 +598,10 @@ def register_aci_options(options):
 
     options.add_int("ACTIVE_GUESS_SIZE", 1000, "Number of determinants for CI guess")
 
-    options.add_str("DIAG_ALGORITHM", "SPARSE", ["DYNAMIC", "FULL", "SPARSE"], "The diagonalization method")
+    options.add_str("DIAG_ALGORITHM", "SPARSE", ["DYNAMIC", "FULL", "SPARSE", "GPU", "INCREMENTAL"],
+                    "The diagonalization method (GPU requires Forte compiled with ENABLE_CUDA)."
+                    " INCREMENTAL stores the Hamiltonian couplings and reuses them across the"
+                    " ACI iterations")
 
     options.add_bool("FORCE_DIAG_METHOD", False, "Force the diagonalization procedure?")
 
@@ -513,6 +634,32 @@ def register_davidson_liu_options(options):
 
     options.add_int("DL_SUBSPACE_PER_ROOT", 10, "The maxim number of trial vectors")
 
+    options.add_bool(
+        "DL_OUT_OF_CORE", False, "Store the Davidson-Liu trial and sigma vectors in memory-mapped"
+        " scratch files instead of memory"
+    )
+
+    options.add_int(
+        "DL_PRECONDITIONER_BLOCK_SIZE", 0, "The maximum number of determinants treated exactly by"
+        " the Davidson-Liu preconditioner (0 = use the diagonal of the Hamiltonian)"
+    )
+
+    options.add_bool(
+        "DL_SPIN_ADAPT", False, "Run the Davidson-Liu algorithm in a basis of configuration state functions with the"
+        " target multiplicity built from the determinant space (the block preconditioner is not used)"
+    )
+
+    options.add_bool(
+        "DL_CHECKPOINT", False, "Save the Davidson-Liu subspace to disk after each iteration and"
+        " restart from it when available (e.g., in the next CASSCF iteration or after a restart)"
+    )
+
+    options.add_str(
+        "DL_EIGENSOLVER", "DAVIDSON", ["DAVIDSON", "LOBPCG"],
+        "The iterative eigensolver used by the sparse CI solver. LOBPCG keeps only three blocks of"
+        " nroot vectors in memory and is useful when the Davidson-Liu subspace does not fit in memory"
+    )
+
     options.add_int(
         "SIGMA_VECTOR_MAX_MEMORY", 67108864,
         "The maximum number of doubles stored in memory in the sigma vector algorithm"
@@ -540,6 +687,16 @@ def register_fci_mo_options(options):
 
     options.add_double("FCIMO_PRINT_CIVEC", 0.05, "The printing threshold for CI vectors")
 
+    options.add_double(
+        "FCIMO_RDM_CACHE_MAX_MEM", 1.0, "The maximum memory (in GB) used to keep the (transition) RDMs in memory"
+    )
+
+    options.add_bool(
+        "FCIMO_RDM_CACHE_SPILL", True,
+        "Write the (transition) RDMs that do not fit in the memory cache to the scratch directory"
+        " (otherwise they are recomputed when needed)"
+    )
+
     # options.add_bool("FCIMO_IAO_ANALYSIS", False, "Intrinsic atomic orbital analysis")
 
 
@@ -552,15 +709,23 @@ def register_detci_options(options):
 def register_integral_options(options):
     options.set_group("Integrals")
     options.add_str(
-        "INT_TYPE", "CONVENTIONAL", ["CONVENTIONAL", "CHOLESKY", "DF", "DISKDF", "FCIDUMP"],
+        "INT_TYPE", "CONVENTIONAL", ["CONVENTIONAL", "INCORE", "CHOLESKY", "DF", "DISKDF", "FCIDUMP"],
         "The type of molecular integrals used in a computation"
         "- CONVENTIONAL Conventional four-index two-electron integrals"
+        "- INCORE Conventional integrals transformed in core with threaded DGEMMs"
         "- DF Density fitted two-electron integrals"
         "- CHOLESKY Cholesky decomposed two-electron integrals"
         "- FCIDUMP Read integrals from a file in the FCIDUMP format"
     )
 
     options.add_str('FCIDUMP_FILE', 'INTDUMP', 'The file that stores the FCIDUMP integrals')
+    options.add_str(
+        'FCIDUMP_READER', 'NATIVE', ['NATIVE', 'PYTHON'],
+        'The FCIDUMP reader (NATIVE: parallel C++ reader that also reads the binary format, PYTHON: numpy reader)'
+    )
+    options.add_str(
+        'FCIDUMP_SAVE_BINARY', '', 'Save the integrals read by the NATIVE reader to this file in the binary format'
+    )
     options.add_int_list(
         'FCIDUMP_DOCC',
         'The number of doubly occupied orbitals assumed for a FCIDUMP file. This information is used to build orbital energies.'
@@ -572,8 +737,62 @@ def register_integral_options(options):
 
     options.add_double("INTEGRAL_SCREENING", 1.0e-12, "The screening threshold for JK builds and DF libraries")
     options.add_double("CHOLESKY_TOLERANCE", 1.0e-6, "The tolerance for cholesky integrals")
+    options.add_str(
+        "CHOLESKY_ALGORITHM", "PSI4", ["PSI4", "THREADED"],
+        "The Cholesky decomposition of the AO integrals (PSI4: CholeskyERI, THREADED: pivoted"
+        " decomposition with threaded integral columns and diagonal updates)"
+    )
+    options.add_str(
+        "CHOLESKY_CACHE_DIR", "",
+        "Directory where the AO Cholesky vectors are saved and reused, keyed by a hash of the basis"
+        " set, geometry, and tolerances (e.g., /dev/shm to share them between jobs on a node)"
+    )
     options.add_double("INTS_TOLERANCE", 1.0e-12, "The tolerance for cholesky integrals")
     options.add_bool("PRINT_INTS", False, "Print the one- and two-electron integrals?")
+    options.add_bool(
+        "INTEGRAL_TRACE", False,
+        "Collect statistics (calls, bytes, time, cache hits) of integral block requests and print them at the end"
+    )
+    options.add_str(
+        "INTEGRAL_TRACE_FILE", "forte_integral_trace.json", "The JSON file where integral request statistics are saved"
+    )
+    options.add_int(
+        "APTEI_BLOCK_CACHE_MB", 0,
+        "Memory (in MB) of the LRU cache of antisymmetrized integral blocks built by the DF/CD backends"
+        " (0 = no caching). The cache is cleared when the orbitals are updated"
+    )
+    options.add_bool(
+        "FOCK_CACHE", False, "Reuse the Fock matrices when the orbitals were only rotated within their spaces and"
+        " the densities did not change (e.g., semicanonicalization in DSRG reference relaxation)"
+    )
+    options.add_bool(
+        "INCREMENTAL_ORBITAL_UPDATE", False,
+        "Rotate the stored DF/CD three-index integrals when the orbitals are updated instead of recomputing them"
+    )
+    options.add_bool(
+        "JK_KEEP_ALIVE", False,
+        "Keep the JK object and its AO DF/CD tensors when a method asks to release them, so that later Fock builds"
+        " (e.g., in relaxation loops or MCSCF) do not repeat the AO integral setup"
+    )
+    options.add_str(
+        "ACTIVE_FOCK_BUILD", "JK", ["JK", "THREE_INDEX"],
+        "How the active Fock matrix is built (JK: psi4 JK object, THREE_INDEX: batched contraction of the MO"
+        " DF/CD three-index integrals, used when no orbitals are frozen)"
+    )
+    options.add_bool(
+        "DISKDF_MMAP", False, "Copy the DISKDF B tensor to a memory-mapped scratch file in the (pq|Q) layout of DF?"
+    )
+    options.add_str(
+        "ACTIVE_SPACE_INTS_STORAGE", "DENSE", ["DENSE", "PACKED", "LOW_RANK"],
+        "The storage of the active space two-electron integrals"
+        "- DENSE Three dense nmo^4 arrays (fastest lookup)"
+        "- PACKED (pq|rs) with permutational and point-group symmetry (restricted integrals only)"
+        "- LOW_RANK Cholesky vectors of (pq|rs), O(nmo^3) memory (restricted integrals only)"
+    )
+    options.add_double(
+        "ACTIVE_SPACE_INTS_LOW_RANK_TOLERANCE", 1.0e-10,
+        "The tolerance of the Cholesky decomposition used by ACTIVE_SPACE_INTS_STORAGE LOW_RANK"
+    )
 
 
 def register_dsrg_options(options):
@@ -646,6 +865,15 @@ def register_dsrg_options(options):
 
     options.add_bool("PRINT_TIME_PROFILE", False, "Print detailed timings in dsrg-mrpt3")
 
+    options.add_bool(
+        "DSRG_COMM_JSON", False,
+        "Dump the timings, estimated FLOPs, and peak intermediate memory of DSRG commutators to JSON"
+    )
+
+    options.add_str(
+        "DSRG_COMM_JSON_FILE", "forte_dsrg_commutators.json", "The JSON file where DSRG commutator costs are saved"
+    )
+
     options.add_str(
         "DSRG_MULTI_STATE", "SA_FULL", ["SA_FULL", "SA_SUB", "MS", "XMS"],
         "Multi-state DSRG options (MS and XMS recouple states after single-state computations)\n"
@@ -695,21 +923,54 @@ def register_dsrg_options(options):
         "Definition of source operator: special treatment for the CCVV term"
     )
 
+    options.add_str(
+        "DSRG_PT2_DEVICE", "CPU", ["CPU", "GPU"],
+        "Where the DF/CD CCVV, CAVV, and CCAV terms of SA-DSRG-MRPT2 are computed"
+        " (GPU requires Forte compiled with ENABLE_CUDA)"
+    )
+
+    options.add_bool(
+        "DSRG_PT2_LOCAL",
+        False,
+        "Compute the DF/CD CCVV term of SA-DSRG-MRPT2 in localized core orbitals, skipping distant pairs"
+        " (C1 symmetry, quasi-canonical core: off-diagonal core Fock elements are neglected)",
+    )
+
+    options.add_bool(
+        "DSRG_PIPELINE_RDMS",
+        False,
+        "Build the reference RDMs on half of the threads while SA-DSRG-MRPT2 computes the amplitudes and the"
+        " terms that do not depend on the 3-cumulant (DF/CD CCVV, CAVV, and CCAV) on the other half",
+    )
+
+    options.add_double(
+        "DSRG_PT2_LOCAL_PAIR_DISTANCE",
+        15.0,
+        "Skip pairs of localized core orbitals with centroids farther apart (bohr) if DSRG_PT2_LOCAL",
+    )
+
     options.add_str(
         "CCVV_ALGORITHM", "FLY_AMBIT", [
-            "CORE", "FLY_AMBIT", "FLY_LOOP", "BATCH_CORE", "BATCH_VIRTUAL", "BATCH_CORE_GA", "BATCH_VIRTUAL_GA",
-            "BATCH_VIRTUAL_MPI", "BATCH_CORE_MPI", "BATCH_CORE_REP", "BATCH_VIRTUAL_REP"
-        ], "Algorithm to compute the CCVV term in DSRG-MRPT2 (only in three-dsrg-mrpt2 code)"
+            "AUTO", "CORE", "FLY_AMBIT", "FLY_LOOP", "BATCH_CORE", "BATCH_VIRTUAL", "BATCH_CORE_GA",
+            "BATCH_VIRTUAL_GA", "BATCH_VIRTUAL_MPI", "BATCH_CORE_MPI", "BATCH_CORE_REP", "BATCH_VIRTUAL_REP"
+        ], "Algorithm to compute the CCVV term in DSRG-MRPT2 (only in three-dsrg-mrpt2 code). AUTO chooses"
+        " core- or virtual-outer batching and the batch size from the memory, threads, and DF rank"
     )
 
     options.add_bool("AO_DSRG_MRPT2", False, "Do AO-DSRG-MRPT2 if true (not available)")
 
-    options.add_int("CCVV_BATCH_NUMBER", -1, "Batches for CCVV_ALGORITHM")
+    options.add_int("CCVV_BATCH_NUMBER", -1, "Batches for CCVV_ALGORITHM (-1: chosen from the memory)")
 
     options.add_bool("DSRG_MRPT2_DEBUG", False, "Excssive printing for three-dsrg-mrpt2")
 
     options.add_str(
-        "THREEPDC_ALGORITHM", "CORE", ["CORE", "BATCH"], "Algorithm for evaluating 3-body cumulants in three-dsrg-mrpt2"
+        "THREEPDC_ALGORITHM", "CORE", ["CORE", "BATCH", "SPARSE"],
+        "Algorithm for evaluating 3-body cumulants (BATCH: threaded batches over the leading cumulant index"
+        " in three-dsrg-mrpt2; SPARSE: thresholded cumulants in DSRG-MRPT2, SA-DSRG, and three-dsrg-mrpt2)"
+    )
+
+    options.add_double(
+        "THREEPDC_SPARSE_THRESHOLD", 1.0e-12, "Threshold for the 3-body cumulant elements kept by THREEPDC_ALGORITHM SPARSE"
     )
 
     options.add_bool("THREE_MRPT2_TIMINGS", False, "Detailed printing (if true) in three-dsrg-mrpt2")
@@ -722,12 +983,38 @@ def register_dsrg_options(options):
 
     options.add_bool("DSRG_NIVO", False, "NIVO approximation: Omit tensor blocks with >= 3 virtual indices if true")
 
+    options.add_double(
+        "DSRG_T2_PAIR_SCREEN",
+        0.0,
+        "Zero the T2 amplitudes of hole pairs (ij) whose norm is below this threshold"
+        " in SA-MRDSRG iterations (0.0 = no screening)",
+    )
+
+    options.add_bool(
+        "DSRG_SYMMETRY_BLOCKS", True, "Omit tensor blocks of SA-DSRG that vanish by point-group symmetry"
+    )
+
     options.add_bool("PRINT_1BODY_EVALS", False, "Print eigenvalues of 1-body effective H")
 
     options.add_bool("DSRG_MRPT3_BATCHED", False, "Force running the DSRG-MRPT3 code using the batched algorithm")
 
+    options.add_int(
+        "DSRG_MRPT3_VIRT_BATCH_MAX", 0, "Max number of virtual orbitals in one batch of the batched"
+        " DF DSRG-MRPT3 contractions (0: determined by memory)"
+    )
+
+    options.add_bool(
+        "DSRG_MRPT3_MPI_BATCHES", False, "Distribute the virtual batches of the batched DF DSRG-MRPT3"
+        " contractions over MPI processes"
+    )
+
     options.add_bool("IGNORE_MEMORY_WARNINGS", False, "Force running the DSRG-MRPT3 code using the batched algorithm")
 
+    options.add_bool(
+        "DSRG_MEMORY_PLAN", False, "Let the spin-adapted DSRG codes pick the 3-cumulant algorithm,"
+        " the DF integral storage, and sequential Hbar according to the available memory"
+    )
+
     options.add_int(
         "DSRG_DIIS_START", 2, "Iteration cycle to start adding error vectors for"
         " DSRG DIIS (< 1 for not doing DIIS)"
@@ -739,8 +1026,35 @@ def register_dsrg_options(options):
 
     options.add_int("DSRG_DIIS_MAX_VEC", 6, "Maximum size of DIIS vectors")
 
+    options.add_str(
+        "DSRG_DIIS_STORAGE", "PSI4", ["PSI4", "DOUBLE", "FLOAT"],
+        "Storage of the DSRG DIIS vectors: PSI4 uses the DIISManager of Psi4, DOUBLE and FLOAT keep only the"
+        " latest amplitudes in full and the others as differences from them in the given precision"
+    )
+
+    options.add_bool(
+        "DSRG_DIIS_OUT_OF_CORE", False, "Keep the DSRG DIIS history in a scratch file (DSRG_DIIS_STORAGE DOUBLE"
+        " or FLOAT only)"
+    )
+
+    options.add_bool(
+        "DSRG_DIIS_ASYNC", False, "Write MR-LDSRG(2) DIIS vectors in a background thread while the Hbar of the"
+        " next iteration is computed"
+    )
+
     options.add_bool("DSRG_RESTART_AMPS", True, "Restart DSRG amplitudes from a previous step")
 
+    options.add_bool(
+        "DSRG_WARM_START", False,
+        "Start MR-DSRG iterations from the amplitudes of the last computation (previous geometry or reference"
+        " relaxation cycle), rotated to the current orbitals by the MO overlap"
+    )
+
+    options.add_double(
+        "DSRG_WARM_START_THRESHOLD", 0.9,
+        "Minimum squared projection of each orbital onto the saved orbitals of the same space for DSRG_WARM_START"
+    )
+
     options.add_bool("DSRG_READ_AMPS", False, "Read initial amplitudes from the current directory")
 
     options.add_bool("DSRG_DUMP_AMPS", False, "Dump converged amplitudes to the current directory")
@@ -796,11 +1110,25 @@ def register_dwms_options(options):
 
     options.add_double("DWMS_E_CONVERGENCE", 1.0e-7, "Energy convergence criteria for DWMS iteration")
 
+    options.add_bool(
+        "DWMS_DISTRIBUTE_ROOTS", False, "Distribute the state-specific DSRG computations of the MS and SA"
+        " algorithms over MPI processes (requires DWMS_ZETA > 0)"
+    )
+
 
 def register_localize_options(options):
     options.set_group("Localize")
     options.add_str("LOCALIZE", "PIPEK_MEZEY", ["PIPEK_MEZEY", "BOYS"], "The method used to localize the orbitals")
     options.add_int_list("LOCALIZE_SPACE", "Sets the orbital space for localization")
+    options.add_str(
+        "LOCALIZE_ENGINE", "PSI4", ["PSI4", "FORTE"], "The localizer implementation. FORTE uses parallel"
+        " Jacobi sweeps over disjoint orbital pairs"
+    )
+    options.add_int("LOCALIZE_MAXITER", 100, "The maximum number of Jacobi sweeps (LOCALIZE_ENGINE = FORTE)")
+    options.add_double(
+        "LOCALIZE_CONVERGENCE", 1.0e-12, "The convergence threshold on the relative change of the"
+        " localization metric (LOCALIZE_ENGINE = FORTE)"
+    )
 
 
 def register_casscf_options(options):
@@ -841,6 +1169,24 @@ def register_casscf_options(options):
 
     options.add_str("CASSCF_CI_SOLVER", "FCI", "The active space solver to use in CASSCF")
 
+    options.add_bool(
+        "CASSCF_CI_WARM_START", True,
+        "Restart the Davidson-Liu solver (FCI and DETCI) of two-step MCSCF from the subspace of the previous"
+        " macro iteration. For ACI, the P space of the previous macro iteration is the initial P space"
+    )
+
+    options.add_double(
+        "CASSCF_SCI_RDM_TRUNCATION", 0.0,
+        "The weight of the selected CI wave function discarded when computing the RDMs of two-step MCSCF"
+        " macro iterations far from convergence (0 = full RDMs)"
+    )
+
+    options.add_double(
+        "CASSCF_CI_CONV_FACTOR", 0.1,
+        "The CI residual threshold in two-step MCSCF macro iterations relative to the RMS of the orbital gradient"
+        " (0 = thresholds from the energy change)"
+    )
+
     options.add_int(
         "CASSCF_CI_FREQ", 1, "How often to solve CI?\n"
         "< 1: do CI in the first macro iteration ONLY\n"
@@ -863,7 +1209,28 @@ def register_casscf_options(options):
     options.add_double("CASSCF_MAX_ROTATION", 0.5, "Max value in orbital update vector")
 
     options.add_str(
-        "ORB_ROTATION_ALGORITHM", "DIAGONAL", ["DIAGONAL", "AUGMENTED_HESSIAN"], "Orbital rotation algorithm"
+        "ORB_ROTATION_ALGORITHM", "DIAGONAL", ["DIAGONAL", "AUGMENTED_HESSIAN"],
+        "Orbital rotation algorithm of two-step MCSCF: L-BFGS with diagonal Hessian (DIAGONAL) or"
+        " augmented-Hessian Newton steps with exact Hessian-vector products (AUGMENTED_HESSIAN)."
+        " For JOB_TYPE = CASSCF, DIAGONAL uses approximate diagonal-Hessian steps with DIIS"
+    )
+
+    options.add_int(
+        "CASSCF_AH_MICRO_MAXITER", 4, "The maximum number of augmented-Hessian steps per MCSCF macro iteration"
+    )
+
+    options.add_double(
+        "CASSCF_HESS_VEC_STEP", 1.0e-4, "The finite-difference step (norm) of orbital Hessian-vector products"
+    )
+
+    options.add_bool(
+        "CASSCF_DF_TEI", True, "Build (pu|xy) from the three-index integrals for DF/CD instead of JK builds"
+    )
+
+    options.add_bool(
+        "CASSCF_DF_GRADIENT", True,
+        "Compute DF (not CD) CASSCF gradients in core with three-index derivative integrals instead of"
+        " the disk-based TPDM back-transformation (no frozen orbitals)"
     )
 
     options.add_bool("CASSCF_DO_DIIS", True, "Use DIIS in CASSCF orbital optimization")
@@ -871,6 +1238,10 @@ def register_casscf_options(options):
     options.add_int("CASSCF_DIIS_MAX_VEC", 8, "Maximum size of DIIS vectors for orbital rotations")
     options.add_int("CASSCF_DIIS_START", 2, "Iteration number to start adding error vectors (< 1 will not do DIIS)")
     options.add_int("CASSCF_DIIS_FREQ", 1, "How often to do DIIS extrapolation")
+    options.add_str(
+        "CASSCF_DIIS_STORAGE", "PSI4", ["PSI4", "DOUBLE", "FLOAT"],
+        "Storage of the CASSCF DIIS vectors (see DSRG_DIIS_STORAGE)"
+    )
     options.add_double("CASSCF_DIIS_NORM", 1e-3, "Do DIIS when the orbital gradient norm is below this value")
 
     options.add_bool("CASSCF_CI_STEP", False, "Do a CAS step for every CASSCF_CI_FREQ")
@@ -892,6 +1263,16 @@ def register_old_options(options):
 
     options.add_bool("NAT_ACT", False, "Use Natural Orbitals to suggest active space?")
 
+    options.add_bool(
+        "MP2_NOS_DF", True, "Compute MP2 natural orbitals from three-index integrals (DF, DiskDF, or Cholesky)"
+        " for restricted closed-shell references, without building four-index integrals"
+    )
+
+    options.add_bool(
+        "MP2_NOS_VIRTUAL_ONLY", False,
+        "Compute only the virtual-virtual block of the MP2 density; occupied orbitals are left unchanged"
+    )
+
     options.add_bool("MEMORY_SUMMARY", False, "Print summary of memory")
 
     options.add_str("REFERENCE", "", "The SCF refernce type")
@@ -926,6 +1307,14 @@ def register_old_options(options):
     #    /*- The end value of the integration parameter s -*/
     options.add_double("SRG_SMAX", 10.0, "The end value of the integration parameter s")
 
+    options.add_double(
+        "SRG_FLOW_E_CONVERGENCE", 0.0, "Stop the SRG flow when the energy changes by less than this value per unit of"
+        " s (0 = integrate up to DSRG_S)"
+    )
+    options.add_str("SRG_CHECKPOINT_FILE", "", "Save snapshots of the SRG flow to this file (empty = no snapshots)")
+    options.add_int("SRG_CHECKPOINT_FREQ", 10, "The number of accepted SRG steps between two snapshots")
+    options.add_bool("SRG_RESTART", False, "Restart the SRG flow from the snapshot in SRG_CHECKPOINT_FILE")
+
 
 def register_psi_options(options):
     options.add_str('BASIS', '', 'The primary basis set')
@@ -1143,6 +1532,11 @@ def register_gas_options(options):
 #    /*- Whether or not to create intermediary MPS checkpoints -*/
 #    options.add_bool("MPS_CHKPT", False)
 
+#    /*- Whether or not to restart the DMRG sweeps of each DMRGSCF iteration
+#     * from the MPS of the previous one. Only the last instruction of the
+#     * convergence scheme is repeated when the MPS is reused. -*/
+#    options.add_bool("DMRG_REUSE_MPS", True)
+
 #    /*- Convergence threshold for the gradient norm. -*/
 #    options.add_double("DMRG_CONVERGENCE", 1e-6)
 
@@ -40,6 +40,8 @@
 #include "helpers/helpers.h"
 #include "ci_rdm/ci_rdms.h"
 #include "sparse_ci/ci_reference.h"
+#include "sparse_ci/sigma_vector_incremental.h"
+#include "sci/sci_checkpoint.h"
 
 #include "mrpt2.h"
 #include "aci.h"
@@ -60,6 +62,60 @@ bool pairComp(const std::pair<double, Determinant> E1, const std::pair<double, D
     return E1.first < E2.first;
 }
 
+/**
+ * @brief Partition a list of (criterion, determinant) pairs for an aimed selection
+ *
+ * Moves to the front of the list the determinants excluded by the selection, that is, the
+ * determinants with the smallest criteria such that the sum of weight(criterion) (plus an initial
+ * sum) is less than a threshold. Instead of sorting the whole list, the boundary is found with a
+ * sequence of nth_element calls on a shrinking range (O(N) on average). The excluded determinants
+ * are not sorted.
+ *
+ * @return the number of excluded determinants and the sum of their weights (plus the initial sum)
+ */
+template <class Weight>
+static std::pair<size_t, double>
+partition_excluded(std::vector<std::pair<double, Determinant>>& list, double initial_sum,
+                   double threshold, Weight weight) {
+    size_t lo = 0;
+    size_t hi = list.size();
+    double sum = initial_sum;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        std::nth_element(list.begin() + lo, list.begin() + mid, list.begin() + hi, pairComp);
+        double block_sum = 0.0;
+        for (size_t I = lo; I <= mid; ++I) {
+            block_sum += weight(list[I].first);
+        }
+        if (sum + block_sum < threshold) {
+            // all the elements up to mid are excluded
+            sum += block_sum;
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return std::make_pair(lo, sum);
+}
+
+/// Return the excluded determinants of a partitioned list that have the same criterion as the
+/// smallest included one (see partition_excluded)
+static std::vector<Determinant>
+aimed_degenerate_determinants(const std::vector<std::pair<double, Determinant>>& list,
+                              size_t num_excluded) {
+    std::vector<Determinant> dets;
+    if (num_excluded == 0 or num_excluded == list.size())
+        return dets;
+    double boundary =
+        std::min_element(list.begin() + num_excluded, list.end(), pairComp)->first;
+    for (size_t I = 0; I < num_excluded; ++I) {
+        if (std::fabs(boundary - list[I].first) < 1.0e-9) {
+            dets.push_back(list[I].second);
+        }
+    }
+    return dets;
+}
+
 AdaptiveCI::AdaptiveCI(StateInfo state, size_t nroot, std::shared_ptr<SCFInfo> scf_info,
                        std::shared_ptr<ForteOptions> options,
                        std::shared_ptr<MOSpaceInfo> mo_space_info,
@@ -73,6 +129,7 @@ void AdaptiveCI::startup() {
     sigma_ = options_->get_double("SIGMA");
     gamma_ = options_->get_double("GAMMA");
     screen_thresh_ = options_->get_double("ACI_PRESCREEN_THRESHOLD");
+    heat_bath_ = options_->get_bool("ACI_HEAT_BATH");
     add_aimed_degenerate_ = options_->get_bool("ACI_ADD_AIMED_DEGENERATE");
     project_out_spin_contaminants_ = options_->get_bool("SCI_PROJECT_OUT_SPIN_CONTAMINANTS");
 
@@ -216,7 +273,7 @@ void AdaptiveCI::find_q_space() {
         screen_alg = "SR";
     }
 
-    if ((ex_alg_ == "AVERAGE") and (screen_alg != "CORE")) {
+    if (shared_roots() and (screen_alg != "CORE") and (screen_alg != "MPI")) {
         screen_alg = "AVERAGE";
     }
 
@@ -225,26 +282,17 @@ void AdaptiveCI::find_q_space() {
     // Get the excited determiants
     double remainder = 0.0;
 
+    // In a GAS calculation the excitation generator only produces the allowed determinants
     if (screen_alg == "AVERAGE") {
-        if (gas_iteration_) {
-            get_gas_excited_determinants_avg(nroot_, P_evecs_, P_evals_, P_space_, F_space);
-        }
         // multiroot
-        else {
-            get_excited_determinants_avg(nroot_, P_evecs_, P_evals_, P_space_, F_space);
-        }
+        get_excited_determinants_avg(nroot_, P_evecs_, P_evals_, P_space_, F_space);
     } else if (screen_alg == "SR") {
-        if (gas_iteration_) {
-            get_gas_excited_determinants_sr(P_evecs_, P_evals_, P_space_, F_space);
-        } else {
-            // single-root optimized
-            get_excited_determinants_sr(P_evecs_, P_evals_, P_space_, F_space);
-            //    } else if ( (screen_alg == "RESTRICTED")){
-            //        // restricted
-            //        get_excited_determinants_restrict(nroot_, P_evecs_, P_evals_, P_space_,
-            //        F_space);
-        }
-
+        // single-root optimized
+        get_excited_determinants_sr(P_evecs_, P_evals_, P_space_, F_space);
+        //    } else if ( (screen_alg == "RESTRICTED")){
+        //        // restricted
+        //        get_excited_determinants_restrict(nroot_, P_evecs_, P_evals_, P_space_,
+        //        F_space);
     } else if (screen_alg == "CORE") {
         get_excited_determinants_core(P_evecs_, P_evals_, P_space_, F_space);
     } else if (screen_alg == "BATCH_HASH" or screen_alg == "BATCH_CORE") {
@@ -253,6 +301,12 @@ void AdaptiveCI::find_q_space() {
     } else if (screen_alg == "BATCH_VEC") {
         // vec batch
         remainder = get_excited_determinants_batch_vecsort(P_evecs_, P_evals_, P_space_, F_space);
+    } else if (screen_alg == "BATCH_EXTERNAL") {
+        // external sort with bounded memory
+        remainder = get_excited_determinants_external(P_evecs_, P_evals_, P_space_, F_space);
+    } else if (screen_alg == "MPI") {
+        // distributed memory
+        remainder = get_excited_determinants_mpi(P_evecs_, P_evals_, P_space_, F_space);
     } else {
         std::string except = screen_alg + " is not a valid screening algorithm";
         throw std::runtime_error(except);
@@ -261,40 +315,26 @@ void AdaptiveCI::find_q_space() {
     // Add P_space determinants
     PQ_space_.swap(P_space_);
 
-    std::sort(F_space.begin(), F_space.end(), pairComp);
-
+    // Select the determinants without sorting the F space
     local_timer screen;
-    double ept2 = 0.0 - remainder;
-    double sum = remainder;
-    size_t last_excluded = 0;
-    for (size_t I = 0, max_I = F_space.size(); I < max_I; ++I) {
-        double& energy = F_space[I].first;
-        Determinant& det = F_space[I].second;
-        if (sum + energy < sigma_) {
-            sum += energy;
-            ept2 -= energy;
-            last_excluded = I;
-
-        } else {
-            PQ_space_.add(det);
-        }
+    size_t num_excluded;
+    double sum;
+    std::tie(num_excluded, sum) =
+        partition_excluded(F_space, remainder, sigma_, [](double energy) { return energy; });
+    double ept2 = -sum;
+    for (size_t I = num_excluded, max_I = F_space.size(); I < max_I; ++I) {
+        PQ_space_.add(F_space[I].second);
     }
-    // Add missing determinants
 
+    // Add missing determinants
     if (add_aimed_degenerate_) {
-        size_t num_extra = 0;
-        for (size_t I = 0, max_I = last_excluded; I < max_I; ++I) {
-            size_t J = last_excluded - I;
-            if (std::fabs(F_space[last_excluded + 1].first - F_space[J].first) < 1.0e-9) {
-                PQ_space_.add(F_space[J].second);
-                num_extra++;
-            } else {
-                break;
-            }
+        auto extra_dets = aimed_degenerate_determinants(F_space, num_excluded);
+        for (const auto& det : extra_dets) {
+            PQ_space_.add(det);
         }
-        if (num_extra > 0 and (!quiet_mode_)) {
+        if (extra_dets.size() > 0 and (!quiet_mode_)) {
             outfile->Printf("\n  Added %zu missing determinants in aimed selection (find_q_space).",
-                            num_extra);
+                            extra_dets.size());
         }
     }
 
@@ -390,7 +430,7 @@ void AdaptiveCI::prune_q_space(DeterminantHashVec& PQ_space, DeterminantHashVec&
     const det_hashvec& detmap = PQ_space.wfn_hash();
     for (size_t i = 0, max_i = detmap.size(); i < max_i; ++i) {
         double criterion = 0.0;
-        if ((nroot_ > 1) and (ex_alg_ == "AVERAGE" or cycle_ < pre_iter_)) {
+        if ((nroot_ > 1) and (shared_roots() or cycle_ < pre_iter_)) {
             for (int n = 0; n < naverage_; ++n) {
                 if (average_function_ == AverageFunction::MaxF) {
                     criterion = std::max(criterion, std::fabs(evecs->get(i, n + average_offset_)));
@@ -412,39 +452,23 @@ void AdaptiveCI::prune_q_space(DeterminantHashVec& PQ_space, DeterminantHashVec&
     // Include all determinants such that
     // sum_I |C_I|^2 < tau_p, where the sum runs over all the excluded
     // determinants
-    // Sort the CI coefficients in ascending order
-    std::sort(dm_det_list.begin(), dm_det_list.end());
-
-    double sum = 0.0;
-    size_t last_excluded = 0;
-    for (size_t I = 0, max_I = PQ_space.size(); I < max_I; ++I) {
-        double dsum = std::pow(dm_det_list[I].first, 2.0);
-        if (sum + dsum < tau_p) { // exclude small contributions that sum to
-                                  // less than tau_p
-            sum += dsum;
-            last_excluded = I;
-        } else {
-            P_space.add(dm_det_list[I].second);
-        }
+    size_t num_excluded =
+        partition_excluded(dm_det_list, 0.0, tau_p, [](double c) { return c * c; }).first;
+    for (size_t I = num_excluded, max_I = dm_det_list.size(); I < max_I; ++I) {
+        P_space.add(dm_det_list[I].second);
     }
 
     // add missing determinants that have the same weight as the last one
     // included
     if (add_aimed_degenerate_) {
-        size_t num_extra = 0;
-        for (size_t I = 0, max_I = last_excluded; I < max_I; ++I) {
-            size_t J = last_excluded - I;
-            if (std::fabs(dm_det_list[last_excluded + 1].first - dm_det_list[J].first) < 1.0e-9) {
-                P_space.add(dm_det_list[J].second);
-                num_extra += 1;
-            } else {
-                break;
-            }
+        auto extra_dets = aimed_degenerate_determinants(dm_det_list, num_excluded);
+        for (const auto& det : extra_dets) {
+            P_space.add(det);
         }
-        if (num_extra > 0 and !quiet_mode_) {
+        if (extra_dets.size() > 0 and !quiet_mode_) {
             outfile->Printf(
                 "\n  Added %zu missing determinants in aimed selection (prune_q_space).",
-                num_extra);
+                extra_dets.size());
         }
     }
 }
@@ -541,7 +565,84 @@ int AdaptiveCI::root_follow(DeterminantHashVec& P_ref, std::vector<double>& P_re
     return new_root;
 }
 
+void AdaptiveCI::follow_roots(DeterminantHashVec& space, psi::SharedMatrix evecs,
+                              psi::SharedVector evals, std::vector<double>& spin,
+                              bool update_refs) {
+    size_t nroot = evecs->coldim();
+    if (root_refs_.size() == nroot) {
+        // the overlap of the roots of the previous cycle (m) with the current roots (n)
+        std::vector<double> S(nroot * nroot);
+#pragma omp parallel for schedule(dynamic)
+        for (size_t mn = 0; mn < nroot * nroot; ++mn) {
+            size_t m = mn / nroot, n = mn % nroot;
+            S[mn] = root_refs_[m].overlap(root_refs_evecs_[m], space, evecs, n);
+        }
+
+        // assign the pairs with the largest overlap first
+        std::vector<size_t> perm(nroot, nroot);
+        std::vector<bool> assigned(nroot, false);
+        for (size_t k = 0; k < nroot; ++k) {
+            double max_S = -1.0;
+            size_t max_m = 0, max_n = 0;
+            for (size_t m = 0; m < nroot; ++m) {
+                if (perm[m] != nroot)
+                    continue;
+                for (size_t n = 0; n < nroot; ++n) {
+                    if ((not assigned[n]) and (S[m * nroot + n] > max_S)) {
+                        max_S = S[m * nroot + n];
+                        max_m = m;
+                        max_n = n;
+                    }
+                }
+            }
+            perm[max_m] = max_n;
+            assigned[max_n] = true;
+        }
+
+        bool reordered = false;
+        for (size_t m = 0; m < nroot; ++m) {
+            reordered = reordered or (perm[m] != m);
+        }
+        if (reordered) {
+            auto old_evecs = evecs->clone();
+            std::vector<double> old_evals(nroot);
+            for (size_t n = 0; n < nroot; ++n) {
+                old_evals[n] = evals->get(n);
+            }
+            std::vector<double> old_spin = spin;
+            double** C = evecs->pointer();
+            double** old_C = old_evecs->pointer();
+            for (size_t m = 0; m < nroot; ++m) {
+                evals->set(m, old_evals[perm[m]]);
+                if (perm[m] < old_spin.size() and m < spin.size()) {
+                    spin[m] = old_spin[perm[m]];
+                }
+                for (size_t I = 0, maxI = space.size(); I < maxI; ++I) {
+                    C[I][m] = old_C[I][perm[m]];
+                }
+                if (!quiet_mode_ and (perm[m] != m)) {
+                    outfile->Printf("\n  Root %zu of the previous cycle -> root %zu "
+                                    "(overlap = %.6f)",
+                                    m, perm[m], S[m * nroot + perm[m]]);
+                }
+            }
+        }
+    }
+
+    if (update_refs) {
+        size_t dim = std::min(space.size(), size_t(1000));
+        root_refs_.assign(nroot, DeterminantHashVec());
+        root_refs_evecs_.assign(nroot, std::vector<double>());
+        for (size_t n = 0; n < nroot; ++n) {
+            root_refs_[n].subspace(space, evecs, root_refs_evecs_[n], dim, n);
+        }
+    }
+}
+
 void AdaptiveCI::pre_iter_preparation() {
+    root_refs_.clear();
+    root_refs_evecs_.clear();
+
     // Build the reference determinant and compute its energy
 
     CI_Reference ref(scf_info_, options_, mo_space_info_, as_ints_, multiplicity_, twice_ms_,
@@ -633,6 +734,11 @@ void AdaptiveCI::pre_iter_preparation() {
     sparse_solver_->set_num_vecs(options_->get_int("N_GUESS_VEC"));
     sparse_solver_->set_ncollapse_per_root(options_->get_int("DL_COLLAPSE_PER_ROOT"));
     sparse_solver_->set_nsubspace_per_root(options_->get_int("DL_SUBSPACE_PER_ROOT"));
+    sparse_solver_->set_dl_out_of_core(options_->get_bool("DL_OUT_OF_CORE"));
+    sparse_solver_->set_dl_preconditioner_block_size(
+        options_->get_int("DL_PRECONDITIONER_BLOCK_SIZE"));
+    sparse_solver_->set_spin_adapt(options_->get_bool("DL_SPIN_ADAPT"));
+    sparse_solver_->set_eigensolver(options_->get_str("DL_EIGENSOLVER"));
     sparse_solver_->set_spin_project_full(
         (gas_iteration_ and sigma_ == 0.0) ? true : options_->get_bool("SPIN_PROJECT_FULL"));
 }
@@ -674,7 +780,7 @@ void AdaptiveCI::diagonalize_P_space() {
     sparse_solver_->manual_guess(false);
     local_timer diag;
 
-    auto sigma_vector = make_sigma_vector(P_space_, as_ints_, max_memory_, sigma_vector_type_);
+    auto sigma_vector = make_aci_sigma_vector(P_space_);
     std::tie(P_evals_, P_evecs_) = sparse_solver_->diagonalize_hamiltonian(
         P_space_, sigma_vector, num_ref_roots_, multiplicity_);
     auto spin = sparse_solver_->spin();
@@ -697,6 +803,11 @@ void AdaptiveCI::diagonalize_P_space() {
         ref_root_ = root_follow(P_ref_, P_ref_evecs_, P_space_, P_evecs_, num_ref_roots_);
     }
 
+    // Keep all the roots in the order of the previous cycle
+    if ((ex_alg_ == "ROOT_FOLLOW") and (num_ref_roots_ > 1)) {
+        follow_roots(P_space_, P_evecs_, P_evals_, spin, false);
+    }
+
     // Print the energy
     if (!quiet_mode_) {
         outfile->Printf("\n");
@@ -715,6 +826,16 @@ void AdaptiveCI::diagonalize_P_space() {
         print_wfn(P_space_, P_evecs_, num_ref_roots_);
 }
 
+std::shared_ptr<SigmaVector> AdaptiveCI::make_aci_sigma_vector(DeterminantHashVec& space) {
+    if (sigma_vector_type_ == SigmaVectorType::Incremental) {
+        if (!incremental_hamiltonian_) {
+            incremental_hamiltonian_ = std::make_shared<IncrementalHamiltonian>();
+        }
+        return std::make_shared<SigmaVectorIncremental>(space, as_ints_, incremental_hamiltonian_);
+    }
+    return make_sigma_vector(space, as_ints_, max_memory_, sigma_vector_type_);
+}
+
 void AdaptiveCI::diagonalize_PQ_space() {
     print_h2("Diagonalizing the Hamiltonian in the P + Q space");
 
@@ -729,7 +850,7 @@ void AdaptiveCI::diagonalize_PQ_space() {
 
     outfile->Printf("\n  Number of reference roots: %d", num_ref_roots_);
 
-    auto sigma_vector = make_sigma_vector(PQ_space_, as_ints_, max_memory_, sigma_vector_type_);
+    auto sigma_vector = make_aci_sigma_vector(PQ_space_);
     std::tie(PQ_evals_, PQ_evecs_) = sparse_solver_->diagonalize_hamiltonian(
         PQ_space_, sigma_vector, num_ref_roots_, multiplicity_);
 
@@ -742,6 +863,9 @@ void AdaptiveCI::diagonalize_PQ_space() {
     //        old_evecs = PQ_evecs->clone();
 
     auto spin = sparse_solver_->spin();
+    if ((ex_alg_ == "ROOT_FOLLOW") and (num_ref_roots_ > 1)) {
+        follow_roots(PQ_space_, PQ_evecs_, PQ_evals_, spin, true);
+    }
     PQ_spin2_ = spin;
 
     if (!quiet_mode_) {
@@ -817,6 +941,39 @@ void AdaptiveCI::prune_PQ_to_P() {
     }
 }
 
+void AdaptiveCI::save_checkpoint(SCICheckpoint& checkpoint) {
+    store_P_space(checkpoint, P_space_, PQ_space_, PQ_evecs_, num_ref_roots_);
+    checkpoint.root = root_;
+    checkpoint.energy_history = energy_history_;
+    // parameters: the reference root, sigma, and the P space energy of each cycle
+    checkpoint.parameters = {static_cast<double>(ref_root_), sigma_};
+    checkpoint.parameters.insert(checkpoint.parameters.end(), P_energies_.begin(),
+                                 P_energies_.end());
+}
+
+bool AdaptiveCI::load_checkpoint(const SCICheckpoint& checkpoint, bool resume) {
+    if (checkpoint.dets.empty() or
+        (resume and ((checkpoint.root != static_cast<size_t>(root_)) or
+                     (checkpoint.parameters.size() < 2)))) {
+        return false;
+    }
+    P_space_ = DeterminantHashVec(checkpoint.dets);
+    if (not resume)
+        return true;
+
+    energy_history_ = checkpoint.energy_history;
+    ref_root_ = static_cast<int>(checkpoint.parameters[0]);
+    sigma_ = checkpoint.parameters[1];
+    P_energies_.assign(checkpoint.parameters.begin() + 2, checkpoint.parameters.end());
+
+    // rebuild the root-following reference from the stored P space
+    if ((checkpoint.cycle >= pre_iter_) and (static_cast<size_t>(ref_root_) < checkpoint.nroot)) {
+        size_t dim = std::min(checkpoint.dets.size(), static_cast<size_t>(1000));
+        P_ref_.subspace(P_space_, checkpoint_evecs(checkpoint), P_ref_evecs_, dim, ref_root_);
+    }
+    return true;
+}
+
 void AdaptiveCI::add_bad_roots(DeterminantHashVec& dets) {
     bad_roots_.clear();
 
@@ -1250,6 +1407,8 @@ void AdaptiveCI::post_iter_process() {
     //    }
     print_nos();
     full_mrpt2();
+    // release the stored couplings
+    incremental_hamiltonian_.reset();
 }
 
 } // namespace forte
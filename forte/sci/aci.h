@@ -31,6 +31,7 @@
 
 #include <fstream>
 #include <iomanip>
+#include <tuple>
 
 #include "sci/sci.h"
 #include "sparse_ci/sparse_ci_solver.h"
@@ -41,6 +42,8 @@ using d2 = std::vector<d1>;
 
 namespace forte {
 
+class ExcitationGenerator;
+class IncrementalHamiltonian;
 class Reference;
 
 enum class AverageFunction { MaxF, AvgF };
@@ -87,6 +90,9 @@ class AdaptiveCI : public SelectedCIMethod {
     void prune_PQ_to_P() override;
     /// Post-iter process
     void post_iter_process() override;
+
+    void save_checkpoint(SCICheckpoint& checkpoint) override;
+    bool load_checkpoint(const SCICheckpoint& checkpoint, bool resume) override;
     /// Full PT2 correction
     void full_mrpt2();
 
@@ -128,6 +134,10 @@ class AdaptiveCI : public SelectedCIMethod {
     std::vector<std::vector<double>> energy_history_;
     int num_ref_roots_;
     bool follow_;
+    /// The most important determinants of each root of the previous cycle (ROOT_FOLLOW)
+    std::vector<DeterminantHashVec> root_refs_;
+    /// The coefficients of root_refs_
+    std::vector<std::vector<double>> root_refs_evecs_;
     local_timer cycle_time_;
 
     // Temporarily added interface to ExcitedStateSolver
@@ -151,6 +161,10 @@ class AdaptiveCI : public SelectedCIMethod {
     double gamma_;
     /// The prescreening threshold
     double screen_thresh_;
+    /// Generate the doubly excited determinants from integrals sorted by magnitude (heat-bath)?
+    bool heat_bath_ = false;
+    /// The generator of the singly and doubly excited determinants used by the screening
+    std::shared_ptr<ExcitationGenerator> excitation_generator_;
     /// Use threshold from perturbation theory?
     bool perturb_select_;
 
@@ -196,6 +210,10 @@ class AdaptiveCI : public SelectedCIMethod {
     psi::SharedMatrix evecs_;
 
     bool build_lists_;
+    /// The Hamiltonian couplings reused across iterations by the INCREMENTAL sigma vector
+    std::shared_ptr<IncrementalHamiltonian> incremental_hamiltonian_;
+    /// Make the sigma vector used to diagonalize the Hamiltonian in space
+    std::shared_ptr<SigmaVector> make_aci_sigma_vector(DeterminantHashVec& space);
 
     /// A map of determinants in the P space
     std::unordered_map<Determinant, int, Determinant::Hash> P_space_map_;
@@ -249,6 +267,10 @@ class AdaptiveCI : public SelectedCIMethod {
     /// Get criteria for a specific root
     double root_select(int nroot, std::vector<double>& C1, std::vector<double>& E2);
 
+    /// Return the excitation generator, (re)built if the integrals have changed. It uses the
+    /// heat-bath lists if heat_bath_ is true and the GAS criteria in a GAS calculation
+    const ExcitationGenerator& excitation_generator();
+
     /// Basic determinant generator (threaded, no batching, all determinants stored)
     void get_excited_determinants_avg(int nroot, psi::SharedMatrix evecs, psi::SharedVector evals,
                                       DeterminantHashVec& P_space,
@@ -275,29 +297,33 @@ class AdaptiveCI : public SelectedCIMethod {
                                           DeterminantHashVec& P_space,
                                           std::vector<std::pair<double, Determinant>>& F_space);
 
+    /// Distributed-memory screening. Each MPI rank generates the excitations of a slice of the
+    /// (replicated) P space and owns a hash partition of the F space. The candidates are
+    /// exchanged in batched all-to-all messages and only the determinants that survive a global
+    /// screening threshold are gathered in F_space. Returns the screened-out energy
+    double get_excited_determinants_mpi(psi::SharedMatrix evecs, psi::SharedVector evals,
+                                        DeterminantHashVec& P_space,
+                                        std::vector<std::pair<double, Determinant>>& F_space);
+
+    /// Single-root screening with bounded memory. The couplings are written to disk as sorted
+    /// runs that are merged twice: first to histogram the selection criteria and find a global
+    /// screening threshold, then to collect the determinants above it. Returns the screened-out
+    /// energy
+    double get_excited_determinants_external(psi::SharedMatrix evecs, psi::SharedVector evals,
+                                             DeterminantHashVec& P_space,
+                                             std::vector<std::pair<double, Determinant>>& F_space);
+
     // Gets excited determinants using sorting of vectors
     double
     get_excited_determinants_batch_vecsort(psi::SharedMatrix evecs, psi::SharedVector evals,
                                            DeterminantHashVec& P_space,
                                            std::vector<std::pair<double, Determinant>>& F_space);
 
-    // Optimized for a single root, in GAS
-    void get_gas_excited_determinants_sr(psi::SharedMatrix evecs, psi::SharedVector evals,
-                                         DeterminantHashVec& P_space,
-                                         std::vector<std::pair<double, Determinant>>& F_space);
-
-    /// Basic determinant generator (threaded, no batching, all determinants stored), in GAS
-    void get_gas_excited_determinants_avg(int nroot, psi::SharedMatrix evecs,
-                                          psi::SharedVector evals, DeterminantHashVec& P_space,
-                                          std::vector<std::pair<double, Determinant>>& F_space);
-
-    void get_gas_excited_determinants_core(psi::SharedMatrix evecs, psi::SharedVector evals,
-                                           DeterminantHashVec& P_space,
-                                           std::vector<std::pair<double, Determinant>>& F_space);
-
     /// (DEFAULT)  Builds excited determinants for a bin, uses all threads, hash-based
-    det_hash<double> get_bin_F_space(int bin, int nbin, double E0, psi::SharedMatrix evecs,
-                                     DeterminantHashVec& P_space);
+    /// and returns the coupling and the diagonal energy of each determinant
+    det_hash<std::pair<double, double>> get_bin_F_space(int bin, int nbin, double E0,
+                                                        psi::SharedMatrix evecs,
+                                                        DeterminantHashVec& P_space);
 
     /// Builds core excited determinants for a bin, uses all threads, hash-based
     det_hash<double> get_bin_F_space_core(int bin, int nbin, double E0, psi::SharedMatrix evecs,
@@ -323,6 +349,14 @@ class AdaptiveCI : public SelectedCIMethod {
     int root_follow(DeterminantHashVec& P_ref, std::vector<double>& P_ref_evecs,
                     DeterminantHashVec& P_space, psi::SharedMatrix P_evecs, int num_ref_roots);
 
+    /// Are all the roots selected together from a shared P space (AVERAGE and ROOT_FOLLOW)?
+    bool shared_roots() const { return (ex_alg_ == "AVERAGE") or (ex_alg_ == "ROOT_FOLLOW"); }
+
+    /// Reorder the roots so that root n has the largest overlap with root n of the previous
+    /// cycle (see root_refs_). Optionally store the roots as the references of the next cycle
+    void follow_roots(DeterminantHashVec& space, psi::SharedMatrix evecs, psi::SharedVector evals,
+                      std::vector<double>& spin, bool update_refs);
+
     /// Add roots to be projected out in DL
     void add_bad_roots(DeterminantHashVec& dets);
 
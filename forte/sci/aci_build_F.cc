@@ -28,15 +28,26 @@
  */
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/matrix.h"
+#include "psi4/libpsi4util/process.h"
 
 #include "base_classes/forte_options.h"
 #include "base_classes/mo_space_info.h"
 
 #include "forte-def.h"
 #include "sci/aci.h"
+#include "sci/excitation_generator.h"
+#include "sparse_ci/concurrent_det_hash.h"
+#include "sparse_ci/determinant_external_sort.h"
 
 using namespace psi;
 
@@ -51,6 +62,30 @@ bool pair_compd(const std::pair<Determinant, double> E1, const std::pair<Determi
     return E1.first < E2.first;
 }
 
+const ExcitationGenerator& AdaptiveCI::excitation_generator() {
+    if ((excitation_generator_ != nullptr) and (excitation_generator_->as_ints() == as_ints_)) {
+        return *excitation_generator_;
+    }
+    excitation_generator_ =
+        std::make_shared<ExcitationGenerator>(as_ints_, mo_symmetry_, screen_thresh_);
+    if (heat_bath_) {
+        local_timer t;
+        excitation_generator_->set_heat_bath();
+        if (!quiet_mode_) {
+            const size_t nexcitations = excitation_generator_->num_heat_bath_excitations();
+            outfile->Printf("\n  Heat-bath lists: %zu excitations (%.2f MB) built in %.6f s",
+                            nexcitations,
+                            nexcitations * sizeof(std::tuple<int, int, double>) / (1024. * 1024.),
+                            t.get());
+        }
+    }
+    if (gas_iteration_) {
+        excitation_generator_->set_gas(gas_num_, relative_gas_mo_, gas_single_criterion_,
+                                       gas_double_criterion_);
+    }
+    return *excitation_generator_;
+}
+
 void AdaptiveCI::get_excited_determinants_sr(SharedMatrix evecs, SharedVector evals,
                                              DeterminantHashVec& P_space,
                                              std::vector<std::pair<double, Determinant>>& F_space) {
@@ -58,7 +93,9 @@ void AdaptiveCI::get_excited_determinants_sr(SharedMatrix evecs, SharedVector ev
     size_t max_P = P_space.size();
     const det_hashvec& P_dets = P_space.wfn_hash();
 
-    det_hash<double> V_hash;
+    // The coupling and the diagonal energy of each excited determinant
+    det_hash<std::pair<double, double>> V_hash;
+    const auto& generator = excitation_generator();
 // Loop over reference determinants
 #pragma omp parallel
     {
@@ -72,121 +109,21 @@ void AdaptiveCI::get_excited_determinants_sr(SharedMatrix evecs, SharedVector ev
                 : (max_P % num_thread) * (bin_size + 1) + (tid - (max_P % num_thread)) * bin_size;
         size_t end_idx = start_idx + bin_size;
 
-        det_hash<double> V_hash_t;
+        det_hash<std::pair<double, double>> V_hash_t;
+        ExcitationGenerator::Workspace ws;
         for (size_t P = start_idx; P < end_idx; ++P) {
             local_timer single;
             const Determinant& det(P_dets[P]);
             double Cp = evecs->get(P, ref_root_);
 
-            std::vector<int> aocc = det.get_alfa_occ(nact_); // TODO check size
-            std::vector<int> bocc = det.get_beta_occ(nact_); // TODO check size
-            std::vector<int> avir = det.get_alfa_vir(nact_); // TODO check size
-            std::vector<int> bvir = det.get_beta_vir(nact_); // TODO check size
-
-            size_t noalpha = aocc.size();
-            size_t nobeta = bocc.size();
-            size_t nvalpha = avir.size();
-            size_t nvbeta = bvir.size();
-            Determinant new_det(det);
-            //            outfile->Printf("\n  %s", str(det, nact_).c_str());
-            // Generate alpha excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t a = 0; a < nvalpha; ++a) {
-                    size_t aa = avir[a];
-                    if ((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) {
-                        double HIJ = as_ints_->slater_rules_single_alpha(det, ii, aa) * Cp;
-                        if (std::abs(HIJ) >= screen_thresh_) {
-                            new_det = det;
-                            new_det.set_alfa_bit(ii, false);
-                            new_det.set_alfa_bit(aa, true);
-                            V_hash_t[new_det] += HIJ;
-                        }
-                    }
-                }
-            }
-            // Generate beta excitations
-            for (size_t i = 0; i < nobeta; ++i) {
-                size_t ii = bocc[i];
-                for (size_t a = 0; a < nvbeta; ++a) {
-                    size_t aa = bvir[a];
-                    if ((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) {
-                        double HIJ = as_ints_->slater_rules_single_beta(det, ii, aa) * Cp;
-                        if (std::abs(HIJ) >= screen_thresh_) {
-                            new_det = det;
-                            new_det.set_beta_bit(ii, false);
-                            new_det.set_beta_bit(aa, true);
-                            V_hash_t[new_det] += HIJ;
-                        }
-                    }
-                }
-            }
-            // Generate aa excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t j = i + 1; j < noalpha; ++j) {
-                    size_t jj = aocc[j];
-                    for (size_t a = 0; a < nvalpha; ++a) {
-                        size_t aa = avir[a];
-                        for (size_t b = a + 1; b < nvalpha; ++b) {
-                            size_t bb = avir[b];
-                            if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                 mo_symmetry_[bb]) == 0) {
-                                double HIJ = as_ints_->tei_aa(ii, jj, aa, bb) * Cp;
-                                if (std::abs(HIJ) >= screen_thresh_) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_aa(ii, jj, aa, bb);
-                                    V_hash_t[new_det] += HIJ;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            // Generate ab excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t j = 0; j < nobeta; ++j) {
-                    size_t jj = bocc[j];
-                    for (size_t a = 0; a < nvalpha; ++a) {
-                        size_t aa = avir[a];
-                        for (size_t b = 0; b < nvbeta; ++b) {
-                            size_t bb = bvir[b];
-                            if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                 mo_symmetry_[bb]) == 0) {
-                                double HIJ = as_ints_->tei_ab(ii, jj, aa, bb) * Cp;
-                                if (std::abs(HIJ) >= screen_thresh_) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_ab(ii, jj, aa, bb);
-                                    V_hash_t[new_det] += HIJ;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            // Generate bb excitations
-            for (size_t i = 0; i < nobeta; ++i) {
-                size_t ii = bocc[i];
-                for (size_t j = i + 1; j < nobeta; ++j) {
-                    size_t jj = bocc[j];
-                    for (size_t a = 0; a < nvbeta; ++a) {
-                        size_t aa = bvir[a];
-                        for (size_t b = a + 1; b < nvbeta; ++b) {
-                            size_t bb = bvir[b];
-                            if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                 mo_symmetry_[bb]) == 0) {
-                                double HIJ = as_ints_->tei_bb(ii, jj, aa, bb) * Cp;
-                                if (std::abs(HIJ) >= screen_thresh_) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_bb(ii, jj, aa, bb);
-                                    V_hash_t[new_det] += HIJ;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            generator.for_each_excitation_energy(
+                det, as_ints_->energy(det), std::fabs(Cp), ws,
+                [](const Determinant&) { return true; },
+                [&](const Determinant& new_det, double HIJ, double E) {
+                    auto& entry = V_hash_t[new_det];
+                    entry.first += HIJ * Cp;
+                    entry.second = E;
+                });
         }
         if (tid == 0)
             outfile->Printf("\n  Time spent forming F space: %20.6f", build.get());
@@ -194,8 +131,9 @@ void AdaptiveCI::get_excited_determinants_sr(SharedMatrix evecs, SharedVector ev
 #pragma omp critical
         {
             for (auto& pair : V_hash_t) {
-                const Determinant& det = pair.first;
-                V_hash[det] += pair.second;
+                auto& entry = V_hash[pair.first];
+                entry.first += pair.second.first;
+                entry.second = pair.second.second;
             }
         }
         if (tid == 0)
@@ -221,8 +159,8 @@ void AdaptiveCI::get_excited_determinants_sr(SharedMatrix evecs, SharedVector ev
         size_t N = 0;
         for (const auto& I : V_hash) {
             if (N % num_thread == tid) {
-                double delta = as_ints_->energy(I.first) - evals->get(ref_root_);
-                double V = I.second;
+                double delta = I.second.second - evals->get(ref_root_);
+                double V = I.second.first;
                 double criteria = 0.5 * (delta - sqrt(delta * delta + V * V * 4.0));
                 F_space[N] = std::make_pair(std::fabs(criteria), I.first);
             }
@@ -239,7 +177,16 @@ void AdaptiveCI::get_excited_determinants_avg(
     size_t max_P = P_space.size();
     const det_hashvec& P_dets = P_space.wfn_hash();
 
-    det_hash<std::vector<double>> V_hash;
+    // The threads accumulate the couplings of the excited determinants directly in V_hash. The
+    // last element of each vector is the diagonal energy of the determinant
+    ConcurrentDetHash<std::vector<double>> V_hash;
+    auto add_coupling = [nroot](std::vector<double>& V, const std::vector<double>& coupling) {
+        for (int n = 0; n < nroot; ++n) {
+            V[n] += coupling[n];
+        }
+        V[nroot] = coupling[nroot];
+    };
+    const auto& generator = excitation_generator();
 // Loop over reference determinants
 #pragma omp parallel
     {
@@ -250,434 +197,129 @@ void AdaptiveCI::get_excited_determinants_avg(
         size_t start_idx =
             (tid < (max_P % num_thread))
                 ? tid * bin_size
-                : (max_P % num_thread) * (bin_size + 1) + (tid - (max_P % num_thread)) * bin_size;
-        size_t end_idx = start_idx + bin_size;
-
-        if (omp_get_thread_num() == 0 and !quiet_mode_) {
-            outfile->Printf("\n  Using %d thread(s).", num_thread);
-        }
-        // This will store the excited determinant info for each thread
-        std::vector<std::pair<Determinant, std::vector<double>>> thread_ex_dets;
-
-        for (size_t P = start_idx; P < end_idx; ++P) {
-            const Determinant& det(P_dets[P]);
-            double evecs_P_row_norm = evecs->get_row(0, P)->norm();
-
-            std::vector<int> aocc = det.get_alfa_occ(nact_);
-            std::vector<int> bocc = det.get_beta_occ(nact_);
-            std::vector<int> avir = det.get_alfa_vir(nact_);
-            std::vector<int> bvir = det.get_beta_vir(nact_);
-
-            size_t noalpha = aocc.size();
-            size_t nobeta = bocc.size();
-            size_t nvalpha = avir.size();
-            size_t nvbeta = bvir.size();
-            Determinant new_det(det);
-
-            // Generate alpha excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t a = 0; a < nvalpha; ++a) {
-                    size_t aa = avir[a];
-                    if ((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) {
-                        double HIJ = as_ints_->slater_rules_single_alpha(det, ii, aa);
-                        if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                            //      if( std::abs(HIJ * evecs->get(0, P)) >
-                            //      screen_thresh_ ){
-                            new_det = det;
-                            new_det.set_alfa_bit(ii, false);
-                            new_det.set_alfa_bit(aa, true);
-                            if (!(P_space.has_det(new_det))) {
-                                std::vector<double> coupling(nroot, 0.0);
-                                for (int n = 0; n < nroot; ++n) {
-                                    coupling[n] += HIJ * evecs->get(P, n);
-                                }
-                                // thread_ex_dets[i * noalpha + a] =
-                                // std::make_pair(new_det,coupling);
-                                thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Generate beta excitations
-            for (size_t i = 0; i < nobeta; ++i) {
-                size_t ii = bocc[i];
-                for (size_t a = 0; a < nvbeta; ++a) {
-                    size_t aa = bvir[a];
-                    if ((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) {
-                        double HIJ = as_ints_->slater_rules_single_beta(det, ii, aa);
-                        if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                            // if( std::abs(HIJ * evecs->get(0, P)) > screen_thresh_ ){
-                            new_det = det;
-                            new_det.set_beta_bit(ii, false);
-                            new_det.set_beta_bit(aa, true);
-                            if (!(P_space.has_det(new_det))) {
-                                std::vector<double> coupling(nroot, 0.0);
-                                for (int n = 0; n < nroot; ++n) {
-                                    coupling[n] += HIJ * evecs->get(P, n);
-                                }
-                                // thread_ex_dets[i * nobeta + a] =
-                                // std::make_pair(new_det,coupling);
-                                thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Generate aa excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t j = i + 1; j < noalpha; ++j) {
-                    size_t jj = aocc[j];
-                    for (size_t a = 0; a < nvalpha; ++a) {
-                        size_t aa = avir[a];
-                        for (size_t b = a + 1; b < nvalpha; ++b) {
-                            size_t bb = avir[b];
-                            if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                 mo_symmetry_[bb]) == 0) {
-                                double HIJ = as_ints_->tei_aa(ii, jj, aa, bb);
-                                if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_aa(ii, jj, aa, bb);
-                                    // if( std::abs(HIJ * evecs->get(0, P)) >
-                                    // screen_thresh_ ){
-
-                                    if (!(P_space.has_det(new_det))) {
-                                        std::vector<double> coupling(nroot, 0.0);
-                                        for (int n = 0; n < nroot; ++n) {
-                                            coupling[n] += HIJ * evecs->get(P, n);
-                                        }
-                                        // thread_ex_dets[i *
-                                        // noalpha*noalpha*nvalpha +
-                                        // j*nvalpha*noalpha +  a*nvalpha + b ]
-                                        // = std::make_pair(new_det,coupling);
-                                        thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Generate ab excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t j = 0; j < nobeta; ++j) {
-                    size_t jj = bocc[j];
-                    for (size_t a = 0; a < nvalpha; ++a) {
-                        size_t aa = avir[a];
-                        for (size_t b = 0; b < nvbeta; ++b) {
-                            size_t bb = bvir[b];
-                            if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                 mo_symmetry_[bb]) == 0) {
-                                double HIJ = as_ints_->tei_ab(ii, jj, aa, bb);
-                                if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_ab(ii, jj, aa, bb);
-                                    // if( std::abs(HIJ * evecs->get(0, P)) >
-                                    // screen_thresh_ ){
-
-                                    if (!(P_space.has_det(new_det))) {
-                                        std::vector<double> coupling(nroot, 0.0);
-                                        for (int n = 0; n < nroot; ++n) {
-                                            coupling[n] += HIJ * evecs->get(P, n);
-                                        }
-                                        // thread_ex_dets[i * nobeta * nvalpha
-                                        // *nvbeta + j * bvalpha * nvbeta + a *
-                                        // nvalpha]
-                                        thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Generate bb excitations
-            for (size_t i = 0; i < nobeta; ++i) {
-                size_t ii = bocc[i];
-                for (size_t j = i + 1; j < nobeta; ++j) {
-                    size_t jj = bocc[j];
-                    for (size_t a = 0; a < nvbeta; ++a) {
-                        size_t aa = bvir[a];
-                        for (size_t b = a + 1; b < nvbeta; ++b) {
-                            size_t bb = bvir[b];
-                            if ((mo_symmetry_[ii] ^
-                                 (mo_symmetry_[jj] ^ (mo_symmetry_[aa] ^ mo_symmetry_[bb]))) == 0) {
-                                double HIJ = as_ints_->tei_bb(ii, jj, aa, bb);
-                                if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                                    // if( std::abs(HIJ * evecs->get(0, P)) >=
-                                    // screen_thresh_ ){
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_bb(ii, jj, aa, bb);
-
-                                    if (!(P_space.has_det(new_det))) {
-                                        std::vector<double> coupling(nroot, 0.0);
-                                        for (int n = 0; n < nroot; ++n) {
-                                            coupling[n] += HIJ * evecs->get(P, n);
-                                        }
-                                        thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-#pragma omp critical
-        {
-            for (size_t I = 0, maxI = thread_ex_dets.size(); I < maxI; ++I) {
-                std::vector<double>& coupling = thread_ex_dets[I].second;
-                Determinant& det = thread_ex_dets[I].first;
-                if (V_hash.count(det) != 0) {
-                    for (int n = 0; n < nroot; ++n) {
-                        V_hash[det][n] += coupling[n];
-                    }
-                } else {
-                    V_hash[det] = coupling;
-                }
-            }
-        }
-    } // Close threads
-
-    F_space.resize(V_hash.size());
-    outfile->Printf("\n  Size of F space: %zu", F_space.size());
-
-    local_timer convert;
-
-#pragma omp parallel
-    {
-        size_t tid = omp_get_thread_num();
-        size_t ntd = omp_get_num_threads();
-        size_t N = 0;
-        for (const auto& detpair : V_hash) {
-            if (N % ntd == tid) {
-                double EI = as_ints_->energy(detpair.first);
-                std::vector<double> criteria(nroot, 0.0);
-                for (int n = 0; n < nroot; ++n) {
-                    double V = detpair.second[n];
-                    double delta = EI - evals->get(n);
-                    double criterion = 0.5 * (delta - sqrt(delta * delta + V * V * 4.0));
-                    criteria[n] = std::fabs(criterion);
-                }
-                double value = average_q_values(criteria);
-                F_space[N] = std::make_pair(value, detpair.first);
-            }
-            N++;
-        }
-    }
-    outfile->Printf("\n  Time spent building sorting list: %1.6f", convert.get());
-}
-
-void AdaptiveCI::get_excited_determinants_core(
-    SharedMatrix evecs, SharedVector evals, DeterminantHashVec& P_space,
-    std::vector<std::pair<double, Determinant>>& F_space) {
-    size_t max_P = P_space.size();
-    const det_hashvec& P_dets = P_space.wfn_hash();
-    int nroot = 1;
-    det_hash<std::vector<double>> V_hash;
-// Loop over reference determinants
-#pragma omp parallel
-    {
-        int num_thread = omp_get_num_threads();
-        int tid = omp_get_thread_num();
-        size_t bin_size = max_P / num_thread;
-        bin_size += (tid < (max_P % num_thread)) ? 1 : 0;
-        size_t start_idx =
-            (tid < (max_P % num_thread))
-                ? tid * bin_size
-                : (max_P % num_thread) * (bin_size + 1) + (tid - (max_P % num_thread)) * bin_size;
-        size_t end_idx = start_idx + bin_size;
-
-        if (omp_get_thread_num() == 0 and !quiet_mode_) {
-            outfile->Printf("\n  Using %d threads.", num_thread);
-        }
-        // This will store the excited determinant info for each thread
-        std::vector<std::pair<Determinant, std::vector<double>>>
-            thread_ex_dets; //( noalpha * nvalpha  );
-
-        for (size_t P = start_idx; P < end_idx; ++P) {
-            const Determinant& det(P_dets[P]);
-            double evecs_P_row_norm = evecs->get_row(0, P)->norm();
-
-            std::vector<int> aocc = det.get_alfa_occ(nact_); // TODO check size
-            std::vector<int> bocc = det.get_beta_occ(nact_); // TODO check size
-            std::vector<int> avir = det.get_alfa_vir(nact_); // TODO check size
-            std::vector<int> bvir = det.get_beta_vir(nact_); // TODO check size
-
-            size_t noalpha = aocc.size();
-            size_t nobeta = bocc.size();
-            size_t nvalpha = avir.size();
-            size_t nvbeta = bvir.size();
-            Determinant new_det(det);
-
-            // Generate alpha excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t a = 0; a < nvalpha; ++a) {
-                    size_t aa = avir[a];
-                    if (((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) and
-                        ((aa != hole_) or (!det.get_beta_bit(aa)))) {
-                        double HIJ = as_ints_->slater_rules_single_alpha(det, ii, aa);
-                        if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                            //      if( std::abs(HIJ * evecs->get(0, P)) >
-                            //      screen_thresh_ ){
-                            new_det = det;
-                            new_det.set_alfa_bit(ii, false);
-                            new_det.set_alfa_bit(aa, true);
-                            if (!(P_space.has_det(new_det))) {
-                                std::vector<double> coupling(nroot, 0.0);
-                                for (int n = 0; n < nroot; ++n) {
-                                    coupling[n] += HIJ * evecs->get(P, n);
-                                }
-                                // thread_ex_dets[i * noalpha + a] =
-                                // std::make_pair(new_det,coupling);
-                                thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                            }
-                        }
-                    }
-                }
-            }
-            // Generate beta excitations
-            for (size_t i = 0; i < nobeta; ++i) {
-                size_t ii = bocc[i];
-                for (size_t a = 0; a < nvbeta; ++a) {
-                    size_t aa = bvir[a];
-                    if (((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) and
-                        ((aa != hole_) or (!det.get_alfa_bit(aa)))) {
-                        double HIJ = as_ints_->slater_rules_single_beta(det, ii, aa);
-                        if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                            // if( std::abs(HIJ * evecs->get(0, P)) > screen_thresh_ ){
-                            new_det = det;
-                            new_det.set_beta_bit(ii, false);
-                            new_det.set_beta_bit(aa, true);
-                            if (!(P_space.has_det(new_det))) {
-                                std::vector<double> coupling(nroot, 0.0);
-                                for (int n = 0; n < nroot; ++n) {
-                                    coupling[n] += HIJ * evecs->get(P, n);
-                                }
-                                // thread_ex_dets[i * nobeta + a] =
-                                // std::make_pair(new_det,coupling);
-                                thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                            }
-                        }
-                    }
-                }
+                : (max_P % num_thread) * (bin_size + 1) + (tid - (max_P % num_thread)) * bin_size;
+        size_t end_idx = start_idx + bin_size;
+
+        if (omp_get_thread_num() == 0 and !quiet_mode_) {
+            outfile->Printf("\n  Using %d thread(s).", num_thread);
+        }
+        ExcitationGenerator::Workspace ws;
+        std::vector<double> coupling(nroot + 1);
+        const int ncol = evecs->coldim();
+        for (size_t P = start_idx; P < end_idx; ++P) {
+            const Determinant& det(P_dets[P]);
+            // the coefficients of all the roots are read once per reference determinant
+            const double* evecs_P = evecs->pointer()[P];
+            double evecs_P_row_norm = 0.0;
+#pragma omp simd reduction(+ : evecs_P_row_norm)
+            for (int n = 0; n < ncol; ++n) {
+                evecs_P_row_norm += evecs_P[n] * evecs_P[n];
             }
+            evecs_P_row_norm = std::sqrt(evecs_P_row_norm);
+
+            generator.for_each_excitation_energy(
+                det, as_ints_->energy(det), evecs_P_row_norm, ws,
+                [&](const Determinant& new_det) { return !P_space.has_det(new_det); },
+                [&](const Determinant& new_det, double HIJ, double E) {
+                    double* c = coupling.data();
+#pragma omp simd
+                    for (int n = 0; n < nroot; ++n) {
+                        c[n] = HIJ * evecs_P[n];
+                    }
+                    coupling[nroot] = E;
+                    V_hash.insert_or_accumulate(new_det, coupling, add_coupling);
+                });
+        }
+    } // Close threads
 
-            // Generate aa excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t j = i + 1; j < noalpha; ++j) {
-                    size_t jj = aocc[j];
-                    for (size_t a = 0; a < nvalpha; ++a) {
-                        size_t aa = avir[a];
-                        for (size_t b = a + 1; b < nvalpha; ++b) {
-                            size_t bb = avir[b];
-                            if (((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                  mo_symmetry_[bb]) == 0) and
-                                (aa != hole_ and bb != hole_)) {
-                                double HIJ = as_ints_->tei_aa(ii, jj, aa, bb);
-                                if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_aa(ii, jj, aa, bb);
-                                    // if( std::abs(HIJ * evecs->get(0, P)) >
-                                    // screen_thresh_ ){
+    F_space.resize(V_hash.size());
+    outfile->Printf("\n  Size of F space: %zu", F_space.size());
 
-                                    if (!(P_space.has_det(new_det))) {
-                                        std::vector<double> coupling(nroot, 0.0);
-                                        for (int n = 0; n < nroot; ++n) {
-                                            coupling[n] += HIJ * evecs->get(P, n);
-                                        }
-                                        // thread_ex_dets[i *
-                                        // noalpha*noalpha*nvalpha +
-                                        // j*nvalpha*noalpha +  a*nvalpha + b ]
-                                        // = std::make_pair(new_det,coupling);
-                                        thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                                    }
-                                }
-                            }
-                        }
-                    }
+    local_timer convert;
+
+    // The criteria of all the roots are evaluated in one vectorized pass over the roots
+    std::vector<double> E0(nroot);
+    for (int n = 0; n < nroot; ++n) {
+        E0[n] = evals->get(n);
+    }
+    std::vector<size_t> shard_offsets = V_hash.shard_offsets();
+#pragma omp parallel
+    {
+        std::vector<double> criteria(nroot, 0.0);
+        const double* E0_ptr = E0.data();
+#pragma omp for schedule(dynamic)
+        for (size_t s = 0; s < V_hash.num_shards(); ++s) {
+            size_t N = shard_offsets[s];
+            for (const auto& detpair : V_hash.shard(s)) {
+                const double* V = detpair.second.data();
+                double* crit = criteria.data();
+                double EI = V[nroot];
+#pragma omp simd
+                for (int n = 0; n < nroot; ++n) {
+                    double delta = EI - E0_ptr[n];
+                    double criterion = 0.5 * (delta - std::sqrt(delta * delta + V[n] * V[n] * 4.0));
+                    crit[n] = std::fabs(criterion);
                 }
+                F_space[N] = std::make_pair(average_q_values(criteria), detpair.first);
+                N++;
             }
+        }
+    }
+    outfile->Printf("\n  Time spent building sorting list: %1.6f", convert.get());
+}
 
-            // Generate ab excitations
-            for (size_t i = 0; i < noalpha; ++i) {
-                size_t ii = aocc[i];
-                for (size_t j = 0; j < nobeta; ++j) {
-                    size_t jj = bocc[j];
-                    for (size_t a = 0; a < nvalpha; ++a) {
-                        size_t aa = avir[a];
-                        for (size_t b = 0; b < nvbeta; ++b) {
-                            size_t bb = bvir[b];
-                            if (((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                  mo_symmetry_[bb]) == 0) and
-                                (aa != hole_ and bb != hole_)) {
-                                double HIJ = as_ints_->tei_ab(ii, jj, aa, bb);
-                                if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_ab(ii, jj, aa, bb);
-                                    // if( std::abs(HIJ * evecs->get(0, P)) >
-                                    // screen_thresh_ ){
+void AdaptiveCI::get_excited_determinants_core(
+    SharedMatrix evecs, SharedVector evals, DeterminantHashVec& P_space,
+    std::vector<std::pair<double, Determinant>>& F_space) {
+    size_t max_P = P_space.size();
+    const det_hashvec& P_dets = P_space.wfn_hash();
+    int nroot = 1;
+    det_hash<std::vector<double>> V_hash;
+    const auto& generator = excitation_generator();
+// Loop over reference determinants
+#pragma omp parallel
+    {
+        int num_thread = omp_get_num_threads();
+        int tid = omp_get_thread_num();
+        size_t bin_size = max_P / num_thread;
+        bin_size += (tid < (max_P % num_thread)) ? 1 : 0;
+        size_t start_idx =
+            (tid < (max_P % num_thread))
+                ? tid * bin_size
+                : (max_P % num_thread) * (bin_size + 1) + (tid - (max_P % num_thread)) * bin_size;
+        size_t end_idx = start_idx + bin_size;
 
-                                    if (!(P_space.has_det(new_det))) {
-                                        std::vector<double> coupling(nroot, 0.0);
-                                        for (int n = 0; n < nroot; ++n) {
-                                            coupling[n] += HIJ * evecs->get(P, n);
-                                        }
-                                        // thread_ex_dets[i * nobeta * nvalpha
-                                        // *nvbeta + j * bvalpha * nvbeta + a *
-                                        // nvalpha]
-                                        thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+        if (omp_get_thread_num() == 0 and !quiet_mode_) {
+            outfile->Printf("\n  Using %d threads.", num_thread);
+        }
+        // This will store the excited determinant info for each thread
+        std::vector<std::pair<Determinant, std::vector<double>>>
+            thread_ex_dets; //( noalpha * nvalpha  );
+        ExcitationGenerator::Workspace ws;
 
-            // Generate bb excitations
-            for (size_t i = 0; i < nobeta; ++i) {
-                size_t ii = bocc[i];
-                for (size_t j = i + 1; j < nobeta; ++j) {
-                    size_t jj = bocc[j];
-                    for (size_t a = 0; a < nvbeta; ++a) {
-                        size_t aa = bvir[a];
-                        for (size_t b = a + 1; b < nvbeta; ++b) {
-                            size_t bb = bvir[b];
-                            if (((mo_symmetry_[ii] ^
-                                  (mo_symmetry_[jj] ^ (mo_symmetry_[aa] ^ mo_symmetry_[bb]))) ==
-                                 0) and
-                                (aa != hole_ and bb != hole_)) {
-                                double HIJ = as_ints_->tei_bb(ii, jj, aa, bb);
-                                if ((std::fabs(HIJ) * evecs_P_row_norm >= screen_thresh_)) {
-                                    // if( std::abs(HIJ * evecs->get(0, P)) >=
-                                    // screen_thresh_ ){
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_bb(ii, jj, aa, bb);
+        for (size_t P = start_idx; P < end_idx; ++P) {
+            const Determinant& det(P_dets[P]);
+            double evecs_P_row_norm = evecs->get_row(0, P)->norm();
 
-                                    if (!(P_space.has_det(new_det))) {
-                                        std::vector<double> coupling(nroot, 0.0);
-                                        for (int n = 0; n < nroot; ++n) {
-                                            coupling[n] += HIJ * evecs->get(P, n);
-                                        }
-                                        thread_ex_dets.push_back(std::make_pair(new_det, coupling));
-                                    }
-                                }
-                            }
-                        }
+            // Exclude the single excitations that doubly occupy the hole and the double
+            // excitations into the hole
+            generator.for_each_excitation(
+                det, evecs_P_row_norm, ws,
+                [&](const Determinant& new_det) { return !P_space.has_det(new_det); },
+                [&](const Determinant& new_det, double HIJ, int aa, int bb) {
+                    if (bb < 0) {
+                        if ((aa == static_cast<int>(hole_)) and new_det.get_alfa_bit(aa) and
+                            new_det.get_beta_bit(aa))
+                            return;
+                    } else if ((aa == static_cast<int>(hole_)) or (bb == static_cast<int>(hole_))) {
+                        return;
                     }
-                }
-            }
+                    std::vector<double> coupling(nroot, 0.0);
+                    for (int n = 0; n < nroot; ++n) {
+                        coupling[n] += HIJ * evecs->get(P, n);
+                    }
+                    thread_ex_dets.push_back(std::make_pair(new_det, coupling));
+                });
         }
 #pragma omp critical
         {
@@ -901,7 +543,9 @@ AdaptiveCI::get_excited_determinants_batch(SharedMatrix evecs, SharedVector eval
         //        total_excluded += prescreen_F(bin,nbin,evals->get(0), evecs,P_space);
 
         // 1. Build the full bin-subset // all threading in here
-        det_hash<double> A_b = get_bin_F_space(bin, nbin, evals->get(0), evecs, P_space);
+        // The coupling and the diagonal energy of each determinant in the bin
+        det_hash<std::pair<double, double>> A_b =
+            get_bin_F_space(bin, nbin, evals->get(0), evecs, P_space);
         outfile->Printf("\n    Build F                %10.6f ", sp.get());
 
         // 2. Put the dets/vals in a sortable list (F_tmp)
@@ -919,8 +563,8 @@ AdaptiveCI::get_excited_determinants_batch(SharedMatrix evecs, SharedVector eval
             for (auto& pair : A_b) {
                 if ((idx % ntd) == tid) {
                     auto& det = pair.first;
-                    double& V = pair.second;
-                    double delta = as_ints_->energy(det) - E0;
+                    double V = pair.second.first;
+                    double delta = pair.second.second - E0;
 
                     F_tmp[idx] = std::make_pair(
                         std::fabs(0.5 * (delta - sqrt(delta * delta + V * V * 4.0))), det);
@@ -961,17 +605,346 @@ AdaptiveCI::get_excited_determinants_batch(SharedMatrix evecs, SharedVector eval
     return total_excluded;
 }
 
-det_hash<double> AdaptiveCI::get_bin_F_space(int bin, int nbin, double E0, SharedMatrix evecs,
-                                             DeterminantHashVec& P_space) {
+#ifdef HAVE_MPI
+namespace {
+/// Number of P determinants processed by each rank between two all-to-all exchanges
+constexpr size_t mpi_batch_size = 1024;
+} // namespace
+#endif
 
-    det_hash<double> bin_f_space;
+double AdaptiveCI::get_excited_determinants_mpi(
+    SharedMatrix evecs, SharedVector evals, DeterminantHashVec& P_space,
+    std::vector<std::pair<double, Determinant>>& F_space) {
+#ifndef HAVE_MPI
+    (void)evecs;
+    (void)evals;
+    (void)P_space;
+    (void)F_space;
+    throw std::runtime_error("The MPI screening algorithm requires Forte compiled with ENABLE_MPI");
+#else
+    static_assert(std::is_trivially_copyable<Determinant>::value,
+                  "Determinant must be trivially copyable to be sent with MPI");
+    int my_proc = 0;
+    int nproc = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_proc);
+    MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+
+    // State-averaged screening uses the couplings to all the roots, otherwise only the reference
+    const bool average = shared_roots() and (nroot_ > 1);
+    const int nroot = average ? nroot_ : 1;
+    const int first_root = average ? 0 : ref_root_;
+
+    const auto& generator = excitation_generator();
+
+    // A record is a determinant followed by its couplings to the nroot roots
+    const size_t record_size = sizeof(Determinant) + nroot * sizeof(double);
+    const size_t max_P = P_space.size();
+    const det_hashvec& P_dets = P_space.wfn_hash();
+    Determinant::Hash hasher;
+
+    // The couplings of the determinants owned by this rank (hash(det) % nproc == my_proc)
+    det_hash<std::vector<double>> V_hash;
+
+    // Rank r generates the excitations of P determinants r, r + nproc, ... in batches
+    const size_t nP_rank = (max_P + nproc - 1) / nproc;
+    const size_t nbatch = (nP_rank + mpi_batch_size - 1) / mpi_batch_size;
+    local_timer build;
+    for (size_t batch = 0; batch < nbatch; ++batch) {
+        const size_t begin = batch * mpi_batch_size;
+        const size_t end = std::min(begin + mpi_batch_size, nP_rank);
+        // the couplings generated in this batch, one map per destination rank
+        std::vector<det_hash<std::vector<double>>> send_hash(nproc);
+#pragma omp parallel
+        {
+            std::vector<det_hash<std::vector<double>>> send_hash_t(nproc);
+            ExcitationGenerator::Workspace ws;
+            auto add = [&](const Determinant& new_det, double HIJ, size_t P) {
+                auto& V = send_hash_t[hasher(new_det) % nproc][new_det];
+                V.resize(nroot, 0.0);
+                for (int n = 0; n < nroot; ++n) {
+                    V[n] += HIJ * evecs->get(P, first_root + n);
+                }
+            };
+#pragma omp for schedule(dynamic)
+            for (size_t k = begin; k < end; ++k) {
+                const size_t P = k * nproc + my_proc;
+                if (P >= max_P)
+                    continue;
+                const Determinant& det(P_dets[P]);
+                const double scale = average ? evecs->get_row(0, P)->norm()
+                                             : std::fabs(evecs->get(P, ref_root_));
+
+                generator.for_each_excitation(det, scale, ws,
+                                              [&](const Determinant& new_det, double HIJ, int,
+                                                  int) { add(new_det, HIJ, P); });
+            }
+#pragma omp critical
+            {
+                for (int r = 0; r < nproc; ++r) {
+                    for (auto& [det, V] : send_hash_t[r]) {
+                        auto& V_r = send_hash[r][det];
+                        V_r.resize(nroot, 0.0);
+                        for (int n = 0; n < nroot; ++n) {
+                            V_r[n] += V[n];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Pack the records by destination and exchange them
+        std::vector<int> send_counts(nproc), send_displs(nproc), recv_counts(nproc),
+            recv_displs(nproc);
+        size_t send_size = 0;
+        for (int r = 0; r < nproc; ++r) {
+            send_counts[r] = static_cast<int>(send_hash[r].size() * record_size);
+            send_displs[r] = static_cast<int>(send_size);
+            send_size += send_counts[r];
+        }
+        std::vector<char> send_buffer(send_size);
+        for (int r = 0; r < nproc; ++r) {
+            char* ptr = send_buffer.data() + send_displs[r];
+            for (const auto& [det, V] : send_hash[r]) {
+                std::memcpy(ptr, &det, sizeof(Determinant));
+                std::memcpy(ptr + sizeof(Determinant), V.data(), nroot * sizeof(double));
+                ptr += record_size;
+            }
+            send_hash[r].clear();
+        }
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT,
+                     MPI_COMM_WORLD);
+        size_t recv_size = 0;
+        for (int r = 0; r < nproc; ++r) {
+            recv_displs[r] = static_cast<int>(recv_size);
+            recv_size += recv_counts[r];
+        }
+        std::vector<char> recv_buffer(recv_size);
+        MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displs.data(), MPI_BYTE,
+                      recv_buffer.data(), recv_counts.data(), recv_displs.data(), MPI_BYTE,
+                      MPI_COMM_WORLD);
+
+        // Accumulate the couplings of the determinants owned by this rank
+        Determinant det;
+        std::vector<double> V(nroot);
+        for (size_t offset = 0; offset < recv_size; offset += record_size) {
+            std::memcpy(&det, recv_buffer.data() + offset, sizeof(Determinant));
+            std::memcpy(V.data(), recv_buffer.data() + offset + sizeof(Determinant),
+                        nroot * sizeof(double));
+            auto& V_det = V_hash[det];
+            V_det.resize(nroot, 0.0);
+            for (int n = 0; n < nroot; ++n) {
+                V_det[n] += V[n];
+            }
+        }
+    }
+    if (!quiet_mode_) {
+        outfile->Printf("\n  Time spent forming and exchanging the F space: %1.6f", build.get());
+    }
+
+    // Remove the P space and compute the criteria of the determinants owned by this rank
+    for (const auto& det : P_dets) {
+        V_hash.erase(det);
+    }
+    std::vector<std::pair<double, Determinant>> F_local;
+    F_local.reserve(V_hash.size());
+    for (const auto& [det, V] : V_hash) {
+        const double EI = as_ints_->energy(det);
+        std::vector<double> criteria(nroot, 0.0);
+        for (int n = 0; n < nroot; ++n) {
+            const double delta = EI - evals->get(first_root + n);
+            criteria[n] = std::fabs(0.5 * (delta - sqrt(delta * delta + V[n] * V[n] * 4.0)));
+        }
+        F_local.push_back(std::make_pair(average ? average_q_values(criteria) : criteria[0], det));
+    }
+    V_hash.clear();
+    std::sort(F_local.begin(), F_local.end(), pair_comp);
+
+    // Find by bisection a threshold t such that the sum of all the criteria smaller than t is
+    // below sigma. These determinants are excluded locally, the remaining ones are gathered on all
+    // ranks and the selection is completed by find_q_space()
+    std::vector<double> partial_sums(F_local.size() + 1, 0.0);
+    for (size_t I = 0; I < F_local.size(); ++I) {
+        partial_sums[I + 1] = partial_sums[I] + F_local[I].first;
+    }
+    auto num_below = [&](double t) {
+        return static_cast<size_t>(
+            std::lower_bound(F_local.begin(), F_local.end(), t,
+                             [](const std::pair<double, Determinant>& p, double value) {
+                                 return p.first < value;
+                             }) -
+            F_local.begin());
+    };
+    double local_max = F_local.empty() ? 0.0 : F_local.back().first;
+    double t_hi = 0.0;
+    MPI_Allreduce(&local_max, &t_hi, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    t_hi = 2.0 * t_hi + 1.0;
+    double t_lo = 0.0;
+    for (int iter = 0; iter < 64; ++iter) {
+        const double t = 0.5 * (t_lo + t_hi);
+        double local_sum = partial_sums[num_below(t)];
+        double sum = 0.0;
+        MPI_Allreduce(&local_sum, &sum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        if (sum < sigma_) {
+            t_lo = t;
+        } else {
+            t_hi = t;
+        }
+    }
+    const size_t nexcluded = num_below(t_lo);
+    double local_excluded = partial_sums[nexcluded];
+    double excluded = 0.0;
+    MPI_Allreduce(&local_excluded, &excluded, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+    // Gather the determinants that were not excluded on all the ranks
+    const size_t kept_record_size = sizeof(Determinant) + sizeof(double);
+    int local_count = static_cast<int>((F_local.size() - nexcluded) * kept_record_size);
+    std::vector<int> counts(nproc), displs(nproc);
+    MPI_Allgather(&local_count, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    size_t total_size = 0;
+    for (int r = 0; r < nproc; ++r) {
+        displs[r] = static_cast<int>(total_size);
+        total_size += counts[r];
+    }
+    std::vector<char> local_buffer(local_count);
+    for (size_t I = nexcluded, k = 0; I < F_local.size(); ++I, k += kept_record_size) {
+        std::memcpy(local_buffer.data() + k, &F_local[I].first, sizeof(double));
+        std::memcpy(local_buffer.data() + k + sizeof(double), &F_local[I].second,
+                    sizeof(Determinant));
+    }
+    F_local.clear();
+    std::vector<char> buffer(total_size);
+    MPI_Allgatherv(local_buffer.data(), local_count, MPI_BYTE, buffer.data(), counts.data(),
+                   displs.data(), MPI_BYTE, MPI_COMM_WORLD);
+    F_space.resize(total_size / kept_record_size);
+    for (size_t I = 0; I < F_space.size(); ++I) {
+        std::memcpy(&F_space[I].first, buffer.data() + I * kept_record_size, sizeof(double));
+        std::memcpy(&F_space[I].second, buffer.data() + I * kept_record_size + sizeof(double),
+                    sizeof(Determinant));
+    }
+    if (!quiet_mode_) {
+        outfile->Printf("\n  Determinants selected on %d ranks: %zu (%1.10f Eh screened out)",
+                        nproc, F_space.size(), excluded);
+    }
+    return excluded;
+#endif
+}
+
+double AdaptiveCI::get_excited_determinants_external(
+    SharedMatrix evecs, SharedVector evals, DeterminantHashVec& P_space,
+    std::vector<std::pair<double, Determinant>>& F_space) {
+    using Record = DeterminantExternalSorter::Record;
+    const size_t max_P = P_space.size();
+    const det_hashvec& P_dets = P_space.wfn_hash();
+
+    // The buffers used to generate the sorted runs and to merge them take at most this memory
+    const size_t max_memory = psi::Process::environment.get_memory() / 2;
+    const size_t buffer_size =
+        std::max<size_t>(1, max_memory / (omp_get_max_threads() * sizeof(Record)));
+
+    const auto& generator = excitation_generator();
+
+    // 1. Generate the couplings and store them as sorted runs on disk
+    local_timer build;
+    DeterminantExternalSorter sorter("aci_f_space");
+#pragma omp parallel
+    {
+        std::vector<Record> buffer;
+        ExcitationGenerator::Workspace ws;
+        buffer.reserve(buffer_size);
+        auto add = [&](const Determinant& new_det, double V) {
+            buffer.push_back({new_det, V});
+            if (buffer.size() == buffer_size) {
+                sorter.add_run(buffer);
+            }
+        };
+#pragma omp for schedule(dynamic, 16)
+        for (size_t P = 0; P < max_P; ++P) {
+            const Determinant& det(P_dets[P]);
+            const double Cp = evecs->get(P, ref_root_);
+
+            generator.for_each_excitation(
+                det, std::fabs(Cp), ws,
+                [&](const Determinant& new_det, double HIJ, int, int) { add(new_det, HIJ * Cp); });
+        }
+        sorter.add_run(buffer);
+    }
+    if (!quiet_mode_) {
+        outfile->Printf("\n  Stored %zu couplings in %zu sorted runs (%.2f MB on disk) in %1.6f s",
+                        sorter.num_records(), sorter.num_runs(),
+                        sorter.disk_size() / (1024. * 1024.), build.get());
+    }
+
+    // The criteria are binned on a logarithmic scale with bins_per_octave bins per
+    // factor of two. Bin k contains the criteria e with floor(bins_per_octave * log2(e)) = k
+    constexpr int bins_per_octave = 64;
+    constexpr int min_bin = -bins_per_octave * 128;
+    constexpr int max_bin = bins_per_octave * 32;
+    auto bin_index = [&](double e) {
+        if (e <= 0.0)
+            return 0;
+        int k = static_cast<int>(std::floor(bins_per_octave * std::log2(e)));
+        return std::min(std::max(k, min_bin), max_bin) - min_bin;
+    };
+    const double E0 = evals->get(ref_root_);
+    auto criterion = [&](const Determinant& det, double V) {
+        double delta = as_ints_->energy(det) - E0;
+        return std::fabs(0.5 * (delta - sqrt(delta * delta + V * V * 4.0)));
+    };
+
+    // 2. Merge the runs and accumulate the sum of the criteria in each bin
+    local_timer merge;
+    std::vector<double> bin_sum(max_bin - min_bin + 1, 0.0);
+    size_t nunique = 0;
+    sorter.merge(max_memory, [&](const Determinant& det, double V) {
+        if (P_space.has_det(det))
+            return;
+        double e = criterion(det, V);
+        bin_sum[bin_index(e)] += e;
+        nunique++;
+    });
+
+    // 3. Find the first bin such that the sum of the criteria in all the bins below is greater
+    // than sigma. The determinants in the lower bins are excluded and the rest are passed to
+    // find_q_space(), which completes the selection
+    size_t first_kept_bin = 0;
+    double sum = 0.0;
+    while ((first_kept_bin < bin_sum.size()) and (sum + bin_sum[first_kept_bin] < sigma_)) {
+        sum += bin_sum[first_kept_bin];
+        first_kept_bin++;
+    }
+
+    // 4. Merge the runs again and keep the determinants in the upper bins
+    double excluded = 0.0;
+    sorter.merge(max_memory, [&](const Determinant& det, double V) {
+        if (P_space.has_det(det))
+            return;
+        double e = criterion(det, V);
+        if (static_cast<size_t>(bin_index(e)) < first_kept_bin) {
+            excluded += e;
+        } else {
+            F_space.push_back(std::make_pair(e, det));
+        }
+    });
+    if (!quiet_mode_) {
+        outfile->Printf("\n  Merged %zu unique determinants and kept %zu in %1.6f s", nunique,
+                        F_space.size(), merge.get());
+        outfile->Printf("\n  Screened out %1.10f Eh of correlation", excluded);
+    }
+    return excluded;
+}
+
+det_hash<std::pair<double, double>> AdaptiveCI::get_bin_F_space(int bin, int nbin, double E0,
+                                                                SharedMatrix evecs,
+                                                                DeterminantHashVec& P_space) {
+
+    det_hash<std::pair<double, double>> bin_f_space;
     local_timer build;
 
     const size_t n_dets = P_space.size();
     const det_hashvec& dets = P_space.wfn_hash();
-    std::vector<int> act_mo = mo_space_info_->dimension("ACTIVE").blocks();
+    const auto& generator = excitation_generator();
 
-    std::vector<det_hash<double>> A_b_t;
+    std::vector<det_hash<std::pair<double, double>>> A_b_t;
     double value = 0.0;
 
 #pragma omp parallel reduction(+ : value)
@@ -985,7 +958,8 @@ det_hash<double> AdaptiveCI::get_bin_F_space(int bin, int nbin, double E0, Share
             // E_b_t.resize(n_threads);
         }
 
-        det_hash<double>& A_b = A_b_t[thread_id];
+        det_hash<std::pair<double, double>>& A_b = A_b_t[thread_id];
+        ExcitationGenerator::Workspace ws;
         // det_hash<double>& E_b = E_b_t[thread_id];
 
         size_t bin_size = n_dets / n_threads;
@@ -1009,195 +983,17 @@ det_hash<double> AdaptiveCI::get_bin_F_space(int bin, int nbin, double E0, Share
         for (size_t I = start_idx; I < end_idx; ++I) {
             double c_I = evecs->get(I, 0);
             const Determinant& det = dets[I];
-            std::vector<std::vector<int>> noalpha = get_asym_occ(det, act_mo);
-            std::vector<std::vector<int>> nobeta = get_bsym_occ(det, act_mo);
-            std::vector<std::vector<int>> nvalpha = get_asym_vir(det, act_mo);
-            std::vector<std::vector<int>> nvbeta = get_bsym_vir(det, act_mo);
-
-            Determinant new_det(det);
-            // Generate alpha excitations
-            for (size_t h = 0; h < nirrep_; ++h) {
-                // Precompute indices
-                const auto& noalpha_h = noalpha[h];
-                const auto& nvalpha_h = nvalpha[h];
-
-                for (auto& ii : noalpha_h) {
-                    new_det.set_alfa_bit(ii, false);
-                    for (auto& aa : nvalpha_h) {
-                        new_det.set_alfa_bit(aa, true);
-                        size_t hash_val = Determinant::Hash()(new_det);
-                        if ((hash_val % nbin) == bin) {
-                            double HIJ = as_ints_->slater_rules_single_alpha(det, ii, aa) * c_I;
-                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                A_b[new_det] += HIJ;
-                                //} else if (std::fabs(HIJ) >= 1e-12) {
-                                //    E_b[new_det] += HIJ;
-                            }
-                        }
-                        new_det.set_alfa_bit(aa, false);
-                    }
-                    new_det.set_alfa_bit(ii, true);
-                }
-                // Generate beta excitations
-                const auto& nobeta_h = nobeta[h];
-                const auto& nvbeta_h = nvbeta[h];
-                for (auto& ii : nobeta_h) {
-                    new_det.set_beta_bit(ii, false);
-                    for (auto& aa : nvbeta_h) {
-                        new_det.set_beta_bit(aa, true);
-                        size_t hash_val = Determinant::Hash()(new_det);
-                        if ((hash_val % nbin) == bin) {
-                            double HIJ = as_ints_->slater_rules_single_beta(det, ii, aa) * c_I;
-                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                A_b[new_det] += HIJ;
-                                //} else if (std::fabs(HIJ) >= 1e-12) {
-                                //    E_b[new_det] += HIJ;
-                            }
-                        }
-                        new_det.set_beta_bit(aa, false);
-                    }
-                    new_det.set_beta_bit(ii, true);
-                }
-            }
-            for (size_t p = 0; p < nirrep_; ++p) {
-                const auto& noalpha_p = noalpha[p];
-                for (size_t q = p; q < nirrep_; ++q) {
-                    const auto& noalpha_q = noalpha[q];
-                    for (size_t r = 0; r < nirrep_; ++r) {
-                        size_t sp = p ^ q ^ r;
-                        if (sp < r)
-                            continue;
-
-                        // Precompute index lists
-                        const auto& nvalpha_r = nvalpha[r];
-                        const auto& nvalpha_s = nvalpha[sp];
-
-                        size_t max_i = noalpha_p.size();
-                        size_t max_j = noalpha_q.size();
-                        size_t max_a = nvalpha_r.size();
-                        size_t max_b = nvalpha_s.size();
-
-                        // Generate aa excitations
-                        for (size_t i = 0; i < max_i; ++i) {
-                            size_t ii = noalpha_p[i];
-                            new_det.set_alfa_bit(ii, false);
-                            for (size_t j = (p == q ? i + 1 : 0); j < max_j; ++j) {
-                                size_t jj = noalpha_q[j];
-                                new_det.set_alfa_bit(jj, false);
-                                for (size_t a = 0; a < max_a; ++a) {
-                                    size_t aa = nvalpha_r[a];
-                                    new_det.set_alfa_bit(aa, true);
-                                    for (size_t b = (r == sp ? a + 1 : 0); b < max_b; ++b) {
-                                        size_t bb = nvalpha_s[b];
-                                        new_det.set_alfa_bit(bb, true);
-                                        size_t hash_val = Determinant::Hash()(new_det);
-                                        if ((hash_val % nbin) == bin) {
-                                            double HIJ = as_ints_->tei_aa(ii, jj, aa, bb) * c_I;
-                                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                                A_b[new_det] +=
-                                                    (HIJ * det.slater_sign_aaaa(ii, jj, aa, bb));
-                                                //} else if (std::fabs(HIJ) >= 1e-12) {
-                                                //    E_b[new_det] += HIJ *
-                                                //    det.slater_sign_aaaa(ii, jj, aa,
-                                                //    bb);
-                                            }
-                                        }
-                                        new_det.set_alfa_bit(bb, false);
-                                    }
-                                    new_det.set_alfa_bit(aa, false);
-                                }
-                                new_det.set_alfa_bit(jj, true);
-                            }
-                            new_det.set_alfa_bit(ii, true);
-                        }
-                        // Generate bb excitations
-                        const auto& nobeta_p = nobeta[p];
-                        const auto& nobeta_q = nobeta[q];
-                        const auto& nvbeta_r = nvbeta[r];
-                        const auto& nvbeta_s = nvbeta[sp];
-
-                        max_i = nobeta_p.size();
-                        max_j = nobeta_q.size();
-                        max_a = nvbeta_r.size();
-                        max_b = nvbeta_s.size();
-
-                        for (size_t i = 0; i < max_i; ++i) {
-                            size_t ii = nobeta_p[i];
-                            new_det.set_beta_bit(ii, false);
-                            for (size_t j = (p == q ? i + 1 : 0); j < max_j; ++j) {
-                                size_t jj = nobeta_q[j];
-                                new_det.set_beta_bit(jj, false);
-                                for (size_t a = 0; a < max_a; ++a) {
-                                    size_t aa = nvbeta_r[a];
-                                    new_det.set_beta_bit(aa, true);
-                                    for (size_t b = (r == sp ? a + 1 : 0); b < max_b; ++b) {
-                                        size_t bb = nvbeta_s[b];
-                                        new_det.set_beta_bit(bb, true);
-                                        // Check if the determinant goes in this bin
-                                        size_t hash_val = Determinant::Hash()(new_det);
-                                        if ((hash_val % nbin) == bin) {
-                                            double HIJ = as_ints_->tei_bb(ii, jj, aa, bb) * c_I;
-                                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                                A_b[new_det] +=
-                                                    (HIJ * det.slater_sign_bbbb(ii, jj, aa, bb));
-                                                //} else if (std::fabs(HIJ) >= 1e-12) {
-                                                //    E_b[new_det] += HIJ *
-                                                //    det.slater_sign_bbbb(ii, jj, aa,
-                                                //    bb);
-                                            }
-                                        }
-                                        new_det.set_beta_bit(bb, false);
-                                    }
-                                    new_det.set_beta_bit(aa, false);
-                                }
-                                new_det.set_beta_bit(jj, true);
-                            }
-                            new_det.set_beta_bit(ii, true);
-                        }
-                    }
-                }
-            }
-            for (size_t p = 0; p < nirrep_; ++p) {
-                const auto& noalpha_p = noalpha[p];
-                for (size_t q = 0; q < nirrep_; ++q) {
-                    const auto& nobeta_q = nobeta[q];
-                    for (size_t r = 0; r < nirrep_; ++r) {
-                        size_t sp = p ^ q ^ r;
-                        const auto& nvalpha_r = nvalpha[r];
-                        const auto& nvbeta_s = nvbeta[sp];
-                        // Generate ab excitations
-                        for (auto& ii : noalpha_p) {
-                            new_det.set_alfa_bit(ii, false);
-                            for (auto& aa : nvalpha_r) {
-                                new_det.set_alfa_bit(aa, true);
-                                for (auto& jj : nobeta_q) {
-                                    new_det.set_beta_bit(jj, false);
-                                    for (auto& bb : nvbeta_s) {
-                                        new_det.set_beta_bit(bb, true);
-                                        size_t hash_val = Determinant::Hash()(new_det);
-                                        if ((hash_val % nbin) == bin) {
-                                            double HIJ = as_ints_->tei_ab(ii, jj, aa, bb) * c_I;
-                                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                                A_b[new_det] +=
-                                                    (HIJ * new_det.slater_sign_aa(ii, aa) *
-                                                     new_det.slater_sign_bb(jj, bb));
-                                                //} else if (std::fabs(HIJ) >= 1e-12) {
-                                                //    E_b[new_det] += HIJ *
-                                                //    new_det.slater_sign_aa(ii, aa) *
-                                                //    new_det.slater_sign_bb(jj, bb);
-                                            }
-                                        }
-                                        new_det.set_beta_bit(bb, false);
-                                    }
-                                    new_det.set_beta_bit(jj, true);
-                                }
-                                new_det.set_alfa_bit(aa, false);
-                            }
-                            new_det.set_alfa_bit(ii, true);
-                        }
-                    }
-                }
-            }
+            // Only the determinants that belong to this bin are kept
+            generator.for_each_excitation_energy(
+                det, as_ints_->energy(det), std::fabs(c_I), ws,
+                [&](const Determinant& new_det) {
+                    return (Determinant::Hash()(new_det) % nbin) == static_cast<size_t>(bin);
+                },
+                [&](const Determinant& new_det, double HIJ, double E) {
+                    auto& entry = A_b[new_det];
+                    entry.first += HIJ * c_I;
+                    entry.second = E;
+                });
         } // end loop over reference
 
         // outfile->Printf("\n  Added %zu dets", A_b.size());
@@ -1213,7 +1009,9 @@ det_hash<double> AdaptiveCI::get_bin_F_space(int bin, int nbin, double E0, Share
 #pragma omp critical
         {
             for (auto& pair : A_b_t[thread_id]) {
-                bin_f_space[pair.first] += pair.second;
+                auto& entry = bin_f_space[pair.first];
+                entry.first += pair.second.first;
+                entry.second = pair.second.second;
             }
         }
         //#pragma omp critical
@@ -1253,7 +1051,7 @@ AdaptiveCI::get_bin_F_space_vecsort(int bin, int nbin, SharedMatrix evecs,
     const size_t n_dets = P_space.size();
     const det_hashvec& dets = P_space.wfn_hash();
     int nmo = as_ints_->nmo();
-    std::vector<int> act_mo = mo_space_info_->dimension("ACTIVE").blocks();
+    const auto& generator = excitation_generator();
 
     std::vector<std::vector<std::pair<Determinant, double>>> vec_A_b_t;
     std::vector<size_t> dets_t;
@@ -1269,6 +1067,7 @@ AdaptiveCI::get_bin_F_space_vecsort(int bin, int nbin, SharedMatrix evecs,
         }
 
         std::vector<std::pair<Determinant, double>>& vec_A_b = vec_A_b_t[thread_id];
+        ExcitationGenerator::Workspace ws;
 
         size_t bin_size = n_dets / n_threads;
         bin_size += (thread_id < (n_dets % n_threads)) ? 1 : 0;
@@ -1297,183 +1096,15 @@ AdaptiveCI::get_bin_F_space_vecsort(int bin, int nbin, SharedMatrix evecs,
         for (size_t I = start_idx; I < end_idx; ++I) {
             double c_I = evecs->get(I, 0);
             const Determinant& det = dets[I];
-            std::vector<std::vector<int>> noalpha = get_asym_occ(det, act_mo);
-            std::vector<std::vector<int>> nobeta = get_bsym_occ(det, act_mo);
-            std::vector<std::vector<int>> nvalpha = get_asym_vir(det, act_mo);
-            std::vector<std::vector<int>> nvbeta = get_bsym_vir(det, act_mo);
-            Determinant new_det(det);
-
-            // Generate alpha excitations
-            for (size_t h = 0; h < nirrep_; ++h) {
-
-                // Precompute indices
-                const auto& noalpha_h = noalpha[h];
-                const auto& nvalpha_h = nvalpha[h];
-
-                for (auto& ii : noalpha_h) {
-                    new_det.set_alfa_bit(ii, false);
-                    for (auto& aa : nvalpha_h) {
-                        new_det.set_alfa_bit(aa, true);
-                        size_t hash_val = Determinant::Hash()(new_det);
-                        if ((hash_val % nbin) == bin) {
-                            double HIJ = as_ints_->slater_rules_single_alpha(det, ii, aa) * c_I;
-                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                vec_A_b.push_back(std::make_pair(new_det, HIJ));
-                            }
-                        }
-                        new_det.set_alfa_bit(aa, false);
-                    }
-                    new_det.set_alfa_bit(ii, true);
-                }
-                // Generate beta excitations
-                const auto& nobeta_h = nobeta[h];
-                const auto& nvbeta_h = nvbeta[h];
-                for (auto& ii : nobeta_h) {
-                    new_det.set_beta_bit(ii, false);
-                    for (auto& aa : nvbeta_h) {
-                        new_det.set_beta_bit(aa, true);
-                        size_t hash_val = Determinant::Hash()(new_det);
-                        if ((hash_val % nbin) == bin) {
-                            double HIJ = as_ints_->slater_rules_single_beta(det, ii, aa) * c_I;
-                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                vec_A_b.push_back(std::make_pair(new_det, HIJ));
-                            }
-                        }
-                        new_det.set_beta_bit(aa, false);
-                    }
-                    new_det.set_beta_bit(ii, true);
-                }
-            }
-            for (size_t p = 0; p < nirrep_; ++p) {
-                const auto& noalpha_p = noalpha[p];
-                for (size_t q = p; q < nirrep_; ++q) {
-                    const auto& noalpha_q = noalpha[q];
-                    for (size_t r = 0; r < nirrep_; ++r) {
-                        size_t sp = p ^ q ^ r;
-                        if (sp < r)
-                            continue;
-
-                        // Precompute index lists
-                        const auto& nvalpha_r = nvalpha[r];
-                        const auto& nvalpha_s = nvalpha[sp];
-
-                        size_t max_i = noalpha_p.size();
-                        size_t max_j = noalpha_q.size();
-                        size_t max_a = nvalpha_r.size();
-                        size_t max_b = nvalpha_s.size();
-
-                        // Generate aa excitations
-                        for (size_t i = 0; i < max_i; ++i) {
-                            size_t ii = noalpha_p[i];
-                            new_det.set_alfa_bit(ii, false);
-                            for (size_t j = (p == q ? i + 1 : 0); j < max_j; ++j) {
-                                size_t jj = noalpha_q[j];
-                                new_det.set_alfa_bit(jj, false);
-                                for (size_t a = 0; a < max_a; ++a) {
-                                    size_t aa = nvalpha_r[a];
-                                    new_det.set_alfa_bit(aa, true);
-                                    for (size_t b = (r == sp ? a + 1 : 0); b < max_b; ++b) {
-                                        size_t bb = nvalpha_s[b];
-                                        new_det.set_alfa_bit(bb, true);
-                                        size_t hash_val = Determinant::Hash()(new_det);
-                                        if ((hash_val % nbin) == bin) {
-                                            double HIJ = as_ints_->tei_aa(ii, jj, aa, bb) * c_I;
-                                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                                vec_A_b.push_back(std::make_pair(
-                                                    new_det,
-                                                    (HIJ * det.slater_sign_aaaa(ii, jj, aa, bb))));
-                                            }
-                                        }
-                                        new_det.set_alfa_bit(bb, false);
-                                    }
-                                    new_det.set_alfa_bit(aa, false);
-                                }
-                                new_det.set_alfa_bit(jj, true);
-                            }
-                            new_det.set_alfa_bit(ii, true);
-                        }
-                        // Generate bb excitations
-                        const auto& nobeta_p = nobeta[p];
-                        const auto& nobeta_q = nobeta[q];
-                        const auto& nvbeta_r = nvbeta[r];
-                        const auto& nvbeta_s = nvbeta[sp];
-
-                        max_i = nobeta_p.size();
-                        max_j = nobeta_q.size();
-                        max_a = nvbeta_r.size();
-                        max_b = nvbeta_s.size();
-
-                        for (size_t i = 0; i < max_i; ++i) {
-                            size_t ii = nobeta_p[i];
-                            new_det.set_beta_bit(ii, false);
-                            for (size_t j = (p == q ? i + 1 : 0); j < max_j; ++j) {
-                                size_t jj = nobeta_q[j];
-                                new_det.set_beta_bit(jj, false);
-                                for (size_t a = 0; a < max_a; ++a) {
-                                    size_t aa = nvbeta_r[a];
-                                    new_det.set_beta_bit(aa, true);
-                                    for (size_t b = (r == sp ? a + 1 : 0); b < max_b; ++b) {
-                                        size_t bb = nvbeta_s[b];
-                                        new_det.set_beta_bit(bb, true);
-                                        // Check if the determinant goes in this bin
-                                        size_t hash_val = Determinant::Hash()(new_det);
-                                        if ((hash_val % nbin) == bin) {
-                                            double HIJ = as_ints_->tei_bb(ii, jj, aa, bb) * c_I;
-                                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                                vec_A_b.push_back(std::make_pair(
-                                                    new_det,
-                                                    (HIJ * det.slater_sign_bbbb(ii, jj, aa, bb))));
-                                            }
-                                        }
-                                        new_det.set_beta_bit(bb, false);
-                                    }
-                                    new_det.set_beta_bit(aa, false);
-                                }
-                                new_det.set_beta_bit(jj, true);
-                            }
-                            new_det.set_beta_bit(ii, true);
-                        }
-                    }
-                }
-            }
-
-            for (size_t p = 0; p < nirrep_; ++p) {
-                const auto& noalpha_p = noalpha[p];
-                for (size_t q = 0; q < nirrep_; ++q) {
-                    const auto& nobeta_q = nobeta[q];
-                    for (size_t r = 0; r < nirrep_; ++r) {
-                        size_t sp = p ^ q ^ r;
-                        const auto& nvalpha_r = nvalpha[r];
-                        const auto& nvbeta_s = nvbeta[sp];
-                        // Generate ab excitations
-                        for (auto& ii : noalpha_p) {
-                            new_det.set_alfa_bit(ii, false);
-                            for (auto& aa : nvalpha_r) {
-                                new_det.set_alfa_bit(aa, true);
-                                for (auto& jj : nobeta_q) {
-                                    new_det.set_beta_bit(jj, false);
-                                    for (auto& bb : nvbeta_s) {
-                                        new_det.set_beta_bit(bb, true);
-                                        size_t hash_val = Determinant::Hash()(new_det);
-                                        if ((hash_val % nbin) == bin) {
-                                            double HIJ = as_ints_->tei_ab(ii, jj, aa, bb) * c_I;
-                                            if ((std::fabs(HIJ) >= screen_thresh_)) {
-                                                vec_A_b.push_back(std::make_pair(
-                                                    new_det, (HIJ * new_det.slater_sign_aa(ii, aa) *
-                                                              new_det.slater_sign_bb(jj, bb))));
-                                            }
-                                        }
-                                        new_det.set_beta_bit(bb, false);
-                                    }
-                                    new_det.set_beta_bit(jj, true);
-                                }
-                                new_det.set_alfa_bit(aa, false);
-                            }
-                            new_det.set_alfa_bit(ii, true);
-                        }
-                    }
-                }
-            }
+            // Only the determinants that belong to this bin are kept
+            generator.for_each_excitation(
+                det, std::fabs(c_I), ws,
+                [&](const Determinant& new_det) {
+                    return (Determinant::Hash()(new_det) % nbin) == static_cast<size_t>(bin);
+                },
+                [&](const Determinant& new_det, double HIJ, int, int) {
+                    vec_A_b.push_back(std::make_pair(new_det, HIJ * c_I));
+                });
         } // end loop over reference
 
         size_t num_new_dets = vec_A_b.size();
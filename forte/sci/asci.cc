@@ -39,6 +39,8 @@
 #include "helpers/helpers.h"
 #include "ci_rdm/ci_rdms.h"
 #include "sparse_ci/ci_reference.h"
+#include "sci/excitation_generator.h"
+#include "sci/sci_checkpoint.h"
 
 #include "mrpt2.h"
 #include "asci.h"
@@ -235,7 +237,8 @@ void ASCI::find_q_space() {
 
     local_timer build_sort;
     size_t N = 0;
-    if (options_->get_str("SCI_EXCITED_ALGORITHM") == "AVERAGE") {
+    const auto ex_alg = options_->get_str("SCI_EXCITED_ALGORITHM");
+    if ((ex_alg == "AVERAGE") or (ex_alg == "ROOT_FOLLOW")) {
         for (const auto& I : V_hash) {
             double criteria = 0.0;
             for (size_t n = 0; n < nroot_; ++n) {
@@ -339,6 +342,37 @@ void ASCI::prune_PQ_to_P() {
     }
 }
 
+void ASCI::save_checkpoint(SCICheckpoint& checkpoint) {
+    store_P_space(checkpoint, P_space_, PQ_space_, PQ_evecs_, num_ref_roots_);
+    checkpoint.root = root_;
+    checkpoint.energy_history = energy_history_;
+    // parameters: the reference root, and the P space energy of each cycle
+    checkpoint.parameters = {static_cast<double>(ref_root_)};
+    checkpoint.parameters.insert(checkpoint.parameters.end(), P_energies_.begin(),
+                                 P_energies_.end());
+}
+
+bool ASCI::load_checkpoint(const SCICheckpoint& checkpoint, bool resume) {
+    if (checkpoint.dets.empty() or
+        (resume and ((checkpoint.root != root_) or checkpoint.parameters.empty()))) {
+        return false;
+    }
+    P_space_ = DeterminantHashVec(checkpoint.dets);
+    if (not resume)
+        return true;
+
+    energy_history_ = checkpoint.energy_history;
+    ref_root_ = static_cast<size_t>(checkpoint.parameters[0]);
+    P_energies_.assign(checkpoint.parameters.begin() + 1, checkpoint.parameters.end());
+
+    // rebuild the root-following reference from the stored P space
+    if ((checkpoint.cycle >= pre_iter_) and (ref_root_ < checkpoint.nroot)) {
+        size_t dim = std::min(checkpoint.dets.size(), static_cast<size_t>(1000));
+        P_ref_.subspace(P_space_, checkpoint_evecs(checkpoint), P_ref_evecs_, dim, ref_root_);
+    }
+    return true;
+}
+
 void ASCI::print_nos() {
     print_h2("NATURAL ORBITALS");
 
@@ -403,6 +437,7 @@ void ASCI::get_excited_determinants_sr(psi::SharedMatrix evecs, DeterminantHashV
     size_t max_P = P_space.size();
     const det_hashvec& P_dets = P_space.wfn_hash();
     double screen_thresh_ = options_->get_double("ASCI_PRESCREEN_THRESHOLD");
+    ExcitationGenerator generator(as_ints_, mo_symmetry_, screen_thresh_);
 
 // Loop over reference determinants
 #pragma omp parallel
@@ -418,119 +453,15 @@ void ASCI::get_excited_determinants_sr(psi::SharedMatrix evecs, DeterminantHashV
         size_t end_idx = start_idx + bin_size;
 
         det_hash<double> V_hash_t;
+        ExcitationGenerator::Workspace ws;
         for (size_t P = start_idx; P < end_idx; ++P) {
             const Determinant& det(P_dets[P]);
             double Cp = evecs->get(P, 0);
 
-            std::vector<int> aocc = det.get_alfa_occ(nact_); // TODO check size
-            std::vector<int> bocc = det.get_beta_occ(nact_); // TODO check size
-            std::vector<int> avir = det.get_alfa_vir(nact_); // TODO check size
-            std::vector<int> bvir = det.get_beta_vir(nact_); // TODO check size
-
-            int noalpha = aocc.size();
-            int nobeta = bocc.size();
-            int nvalpha = avir.size();
-            int nvbeta = bvir.size();
-            Determinant new_det(det);
-            // Generate alpha excitations
-            for (int i = 0; i < noalpha; ++i) {
-                int ii = aocc[i];
-                for (int a = 0; a < nvalpha; ++a) {
-                    int aa = avir[a];
-                    if ((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) {
-                        double HIJ = as_ints_->slater_rules_single_alpha(det, ii, aa) * Cp;
-                        if (std::abs(HIJ) >= screen_thresh_) {
-                            new_det = det;
-                            new_det.set_alfa_bit(ii, false);
-                            new_det.set_alfa_bit(aa, true);
-                            V_hash_t[new_det] += HIJ;
-                        }
-                    }
-                }
-            }
-            // Generate beta excitations
-            for (int i = 0; i < nobeta; ++i) {
-                int ii = bocc[i];
-                for (int a = 0; a < nvbeta; ++a) {
-                    int aa = bvir[a];
-                    if ((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) {
-                        double HIJ = as_ints_->slater_rules_single_beta(det, ii, aa) * Cp;
-                        if (std::abs(HIJ) >= screen_thresh_) {
-                            new_det = det;
-                            new_det.set_beta_bit(ii, false);
-                            new_det.set_beta_bit(aa, true);
-                            V_hash_t[new_det] += HIJ;
-                        }
-                    }
-                }
-            }
-            // Generate aa excitations
-            for (int i = 0; i < noalpha; ++i) {
-                int ii = aocc[i];
-                for (int j = i + 1; j < noalpha; ++j) {
-                    int jj = aocc[j];
-                    for (int a = 0; a < nvalpha; ++a) {
-                        int aa = avir[a];
-                        for (int b = a + 1; b < nvalpha; ++b) {
-                            int bb = avir[b];
-                            if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                 mo_symmetry_[bb]) == 0) {
-                                double HIJ = as_ints_->tei_aa(ii, jj, aa, bb) * Cp;
-                                if (std::abs(HIJ) >= screen_thresh_) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_aa(ii, jj, aa, bb);
-                                    V_hash_t[new_det] += HIJ;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            // Generate ab excitations
-            for (int i = 0; i < noalpha; ++i) {
-                int ii = aocc[i];
-                for (int j = 0; j < nobeta; ++j) {
-                    int jj = bocc[j];
-                    for (int a = 0; a < nvalpha; ++a) {
-                        int aa = avir[a];
-                        for (int b = 0; b < nvbeta; ++b) {
-                            int bb = bvir[b];
-                            if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                 mo_symmetry_[bb]) == 0) {
-                                double HIJ = as_ints_->tei_ab(ii, jj, aa, bb) * Cp;
-                                if (std::abs(HIJ) >= screen_thresh_) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_ab(ii, jj, aa, bb);
-                                    V_hash_t[new_det] += HIJ;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Generate bb excitations
-            for (int i = 0; i < nobeta; ++i) {
-                int ii = bocc[i];
-                for (int j = i + 1; j < nobeta; ++j) {
-                    int jj = bocc[j];
-                    for (int a = 0; a < nvbeta; ++a) {
-                        int aa = bvir[a];
-                        for (int b = a + 1; b < nvbeta; ++b) {
-                            int bb = bvir[b];
-                            if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                                 mo_symmetry_[bb]) == 0) {
-                                double HIJ = as_ints_->tei_bb(ii, jj, aa, bb) * Cp;
-                                if (std::abs(HIJ) >= screen_thresh_) {
-                                    new_det = det;
-                                    HIJ *= new_det.double_excitation_bb(ii, jj, aa, bb);
-                                    V_hash_t[new_det] += HIJ;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            generator.for_each_excitation(det, std::fabs(Cp), ws,
+                                          [&](const Determinant& new_det, double HIJ, int, int) {
+                                              V_hash_t[new_det] += HIJ * Cp;
+                                          });
         }
         if (tid == 0)
             outfile->Printf("\n  Time spent forming F space: %20.6f", build.get());
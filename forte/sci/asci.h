@@ -76,6 +76,9 @@ class ASCI : public SelectedCIMethod {
     void diagonalize_PQ_space() override;
     void post_iter_process() override;
 
+    void save_checkpoint(SCICheckpoint& checkpoint) override;
+    bool load_checkpoint(const SCICheckpoint& checkpoint, bool resume) override;
+
     void set_method_variables(
         std::string ex_alg, size_t nroot_method, size_t root,
         const std::vector<std::vector<std::pair<Determinant, double>>>& old_roots) override;
@@ -1,7 +1,5 @@
 #include <algorithm>
 #include <cstdio>
-#include <fstream>
-#include <iomanip>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsi4util/process.h"
@@ -13,6 +11,7 @@
 #include "helpers/timer.h"
 #include "helpers/printing.h"
 #include "helpers/string_algorithms.h"
+#include "base_classes/wave_function_file.h"
 #include "sparse_ci/ci_reference.h"
 #include "detci.h"
 
@@ -58,6 +57,11 @@ void DETCI::set_options(std::shared_ptr<ForteOptions> options) {
 
     ncollapse_per_root_ = options->get_int("DL_COLLAPSE_PER_ROOT");
     nsubspace_per_root_ = options->get_int("DL_SUBSPACE_PER_ROOT");
+    dl_out_of_core_ = options->get_bool("DL_OUT_OF_CORE");
+    dl_preconditioner_block_size_ = options->get_int("DL_PRECONDITIONER_BLOCK_SIZE");
+    dl_spin_adapt_ = options->get_bool("DL_SPIN_ADAPT");
+    dl_eigensolver_ = options->get_str("DL_EIGENSOLVER");
+    dl_checkpoint_ = options->get_bool("DL_CHECKPOINT");
 
     sigma_vector_type_ = string_to_sigma_vector_type(options->get_str("DIAG_ALGORITHM"));
     sigma_max_memory_ = options_->get_int("SIGMA_VECTOR_MAX_MEMORY");
@@ -97,7 +101,9 @@ double DETCI::compute_energy() {
     compute_permanent_dipole();
 
     // save wave functions by default
-    dump_wave_function(wfn_filename_);
+    if (not wfn_filename_.empty()) {
+        dump_wave_function(wfn_filename_);
+    }
 
     // push to psi4 environment
     double energy = energies_[root_];
@@ -180,6 +186,14 @@ std::shared_ptr<SparseCISolver> DETCI::prepare_ci_solver() {
 
     solver->set_ncollapse_per_root(ncollapse_per_root_);
     solver->set_nsubspace_per_root(nsubspace_per_root_);
+    solver->set_dl_out_of_core(dl_out_of_core_);
+    solver->set_dl_preconditioner_block_size(dl_preconditioner_block_size_);
+    solver->set_spin_adapt(dl_spin_adapt_);
+    solver->set_eigensolver(dl_eigensolver_);
+    if (dl_checkpoint_ and (not wfn_filename_.empty())) {
+        solver->set_dl_checkpoint_file(wfn_filename_.substr(0, wfn_filename_.find_last_of('.')) +
+                                       ".dl");
+    }
 
     if (read_wfn_guess_) {
         outfile->Printf("\n  Reading wave function from disk as initial guess:");
@@ -324,83 +338,8 @@ void DETCI::print_ci_wfn() {
 }
 
 void DETCI::dump_wave_function(const std::string& filename) {
-    std::ofstream file(filename);
-    file << "# DETCI: " << state_.str() << std::endl;
-    file << p_space_.size() << " " << nroot_ << std::endl;
-    for (size_t I = 0, Isize = p_space_.size(); I < Isize; ++I) {
-        std::string det_str = str(p_space_.get_det(I), nactv_);
-        file << det_str;
-        for (size_t n = 0; n < nroot_; ++n) {
-            file << ", " << std::scientific << std::setprecision(12) << evecs_->get(I, n);
-        }
-        file << std::endl;
-    }
-    file.close();
-}
-
-std::tuple<size_t, std::vector<Determinant>, psi::SharedMatrix>
-DETCI::read_wave_function(const std::string& filename) {
-    std::string line;
-    std::ifstream file(filename);
-
-    if (not file.is_open()) {
-        outfile->Printf("\n  DETCI Error: Failed to open wave function file!");
-        return {0, std::vector<Determinant>(), std::make_shared<psi::Matrix>()};
-    }
-
-    // read first line
-    std::getline(file, line);
-    if (line.find("DETCI") == std::string::npos) {
-        outfile->Printf("\n  DETCI Error: Wave function file not from a previous DETCI!");
-        std::runtime_error("Failed read wave function: file not generated from DETCI.");
-    }
-
-    // read second line for number of determinants and number of roots
-    std::getline(file, line);
-    size_t ndets, nroots;
-    stringstream ss;
-    ss << line;
-    ss >> ndets >> nroots;
-
-    std::vector<Determinant> det_space;
-    det_space.reserve(ndets);
-    auto evecs = std::make_shared<psi::Matrix>("evecs " + filename, ndets, nroots);
-
-    size_t norbs = 0; // number of active orbitals
-    size_t I = 0;     // index to keep track of determinant
-    std::string delimiter = ", ";
-
-    while (std::getline(file, line)) {
-        // get the determinant, format in file: e.g., |220ab002>
-        size_t next = line.find(delimiter);
-        auto det_str = line.substr(0, next);
-        norbs = det_str.size() - 2;
-
-        // form determinant
-        std::vector<bool> alpha(norbs, false), beta(norbs, false);
-        for (size_t i = 0; i < norbs; ++i) {
-            char x = det_str[i + 1];
-            if (x == '2' or x == '+') {
-                alpha[i] = true;
-            }
-            if (x == '2' or x == '-') {
-                beta[i] = true;
-            }
-        }
-        det_space.emplace_back(alpha, beta);
-
-        size_t last = next + 1, n = 0;
-        while ((next = line.find(delimiter, last)) != string::npos) {
-            evecs->set(I, n, std::stod(line.substr(last, next - last)));
-            n++;
-            last = next + 1;
-        }
-        evecs->set(I, n, std::stod(line.substr(last)));
-
-        I++;
-    }
-
-    return {norbs, det_space, evecs};
+    write_wave_function_file(filename, nactv_, "DETCI: " + state_.str(), p_space_.determinants(),
+                             evecs_);
 }
 
 bool DETCI::read_initial_guess(const std::string& filename) {
@@ -408,9 +347,14 @@ bool DETCI::read_initial_guess(const std::string& filename) {
     size_t norbs;
     std::vector<Determinant> dets;
     SharedMatrix evecs;
-    std::tie(norbs, dets, evecs) = read_wave_function(filename);
+    try {
+        std::tie(norbs, dets, evecs) = read_wave_function(filename);
+    } catch (const std::exception& e) {
+        outfile->Printf("\n  DETCI Error: %s", e.what());
+        return false;
+    }
 
-    // failed to open the file or empty file
+    // empty file
     auto ndets = dets.size();
     if (ndets == 0)
         return false;
@@ -463,26 +407,80 @@ std::vector<RDMs> DETCI::rdms(const std::vector<std::pair<size_t, size_t>>& root
         throw std::runtime_error("Invalid max_rdm_level, required 1 <= max_rdm_level <= 3.");
     }
 
-    std::vector<RDMs> rdms;
-
-    for (auto& root_pair : root_list) {
-        auto root1 = root_pair.first;
-        auto root2 = root_pair.second;
+    if (root_list.size() == 1) {
+        auto root1 = root_list[0].first;
+        auto root2 = root_list[0].second;
 
         auto D1 = compute_trans_1rdms_sosd(root1, root2);
+        if (max_rdm_level == 1) {
+            return {RDMs(D1[0], D1[1])};
+        }
+
+        auto D2 = compute_trans_2rdms_sosd(root1, root2);
+        if (max_rdm_level == 2) {
+            return {RDMs(D1[0], D1[1], D2[0], D2[1], D2[2])};
+        }
+
+        auto D3 = compute_trans_3rdms_sosd(root1, root2);
+        return {RDMs(D1[0], D1[1], D2[0], D2[1], D2[2], D3[0], D3[1], D3[2], D3[3])};
+    }
+
+    // compute the 1- and 2-RDMs of all the root pairs in one sweep
+    return compute_root_pairs_rdms(p_space_, evecs_, root_list, max_rdm_level,
+                                   options_->get_str("THREEPDC") == "MK", "D");
+}
+
+std::vector<RDMs>
+DETCI::compute_root_pairs_rdms(DeterminantHashVec& dets, psi::SharedMatrix evecs,
+                               const std::vector<std::pair<size_t, size_t>>& root_pairs,
+                               int max_rdm_level, bool do_3rdm, const std::string& prefix) {
+    CI_RDMS ci_rdms(dets, as_ints_, evecs, 0, 0);
+    ci_rdms.set_print(print_ci_rdms_);
+
+    std::vector<std::array<std::vector<double>, 5>> rdms_12;
+    ci_rdms.compute_rdms_op_root_pairs(root_pairs, std::min(max_rdm_level, 2), rdms_12);
+
+    std::vector<std::array<std::vector<double>, 4>> rdms_3;
+    if (max_rdm_level == 3 and do_3rdm) {
+        ci_rdms.compute_3rdm_op_root_pairs(root_pairs, rdms_3);
+    }
+
+    auto to_tensor = [&](const std::string& name, size_t rank, std::vector<double>& data) {
+        auto t = ambit::Tensor::build(CoreTensor, prefix + name, std::vector<size_t>(rank, nactv_));
+        if (not data.empty()) {
+            t.data().swap(data);
+        }
+        return t;
+    };
+
+    std::vector<RDMs> rdms;
+    for (size_t n = 0, npairs = root_pairs.size(); n < npairs; ++n) {
+        auto& blocks = rdms_12[n];
+        auto a = to_tensor("1a", 2, blocks[0]);
+        auto b = to_tensor("1b", 2, blocks[1]);
 
         if (max_rdm_level == 1) {
-            rdms.emplace_back(D1[0], D1[1]);
-        } else {
-            auto D2 = compute_trans_2rdms_sosd(root1, root2);
-
-            if (max_rdm_level == 2) {
-                rdms.emplace_back(D1[0], D1[1], D2[0], D2[1], D2[2]);
-            } else {
-                auto D3 = compute_trans_3rdms_sosd(root1, root2);
-                rdms.emplace_back(D1[0], D1[1], D2[0], D2[1], D2[2], D3[0], D3[1], D3[2], D3[3]);
-            }
+            rdms.emplace_back(a, b);
+            continue;
+        }
+
+        auto aa = to_tensor("2aa", 4, blocks[2]);
+        auto ab = to_tensor("2ab", 4, blocks[3]);
+        auto bb = to_tensor("2bb", 4, blocks[4]);
+
+        if (max_rdm_level == 2) {
+            rdms.emplace_back(a, b, aa, ab, bb);
+            continue;
         }
+
+        std::array<std::vector<double>, 4> empty;
+        auto& blocks3 = rdms_3.empty() ? empty : rdms_3[n];
+        auto aaa = to_tensor("3aaa", 6, blocks3[0]);
+        auto aab = to_tensor("3aab", 6, blocks3[1]);
+        auto abb = to_tensor("3abb", 6, blocks3[2]);
+        auto bbb = to_tensor("3bbb", 6, blocks3[3]);
+
+        rdms.emplace_back(a, b, aa, ab, bb, aaa, aab, abb, bbb);
     }
 
     return rdms;
@@ -698,61 +696,12 @@ std::vector<RDMs> DETCI::transition_rdms(const std::vector<std::pair<size_t, siz
         }
     }
 
-    // loop over roots and compute the transition RDMs
-    std::vector<RDMs> rdms;
+    // compute the transition RDMs of all the root pairs in one sweep
+    std::vector<std::pair<size_t, size_t>> root_pairs;
     for (const auto& roots_pair : root_list) {
-        size_t root1 = roots_pair.first;
-        size_t root2 = roots_pair.second + nroot_;
-
-        CI_RDMS ci_rdms(dets, as_ints_, evecs, root1, root2);
-        ci_rdms.set_print(false);
-
-        // compute 1-RDM
-        auto a = ambit::Tensor::build(CoreTensor, "TD1a", std::vector<size_t>(2, nactv_));
-        auto b = ambit::Tensor::build(CoreTensor, "TD1b", std::vector<size_t>(2, nactv_));
-        auto& a_data = a.data();
-        auto& b_data = b.data();
-
-        ci_rdms.compute_1rdm_op(a_data, b_data);
-
-        if (max_rdm_level == 1) {
-            rdms.emplace_back(a, b);
-        } else {
-            ci_rdms.set_print(true);
-
-            // compute 2-RDM
-            std::vector<size_t> dim4(4, nactv_);
-            auto aa = ambit::Tensor::build(CoreTensor, "TD2aa", dim4);
-            auto ab = ambit::Tensor::build(CoreTensor, "TD2ab", dim4);
-            auto bb = ambit::Tensor::build(CoreTensor, "TD2bb", dim4);
-            auto& aa_data = aa.data();
-            auto& ab_data = ab.data();
-            auto& bb_data = bb.data();
-
-            ci_rdms.compute_2rdm_op(aa_data, ab_data, bb_data);
-
-            if (max_rdm_level == 2) {
-                rdms.emplace_back(a, b, aa, ab, bb);
-            } else {
-                // compute 3-RDM
-                std::vector<size_t> dim6(6, nactv_);
-                auto aaa = ambit::Tensor::build(CoreTensor, "TD3aaa", dim6);
-                auto aab = ambit::Tensor::build(CoreTensor, "TD3aab", dim6);
-                auto abb = ambit::Tensor::build(CoreTensor, "TD3abb", dim6);
-                auto bbb = ambit::Tensor::build(CoreTensor, "TD3bbb", dim6);
-                auto& aaa_data = aaa.data();
-                auto& aab_data = aab.data();
-                auto& abb_data = abb.data();
-                auto& bbb_data = bbb.data();
-
-                ci_rdms.compute_3rdm_op(aaa_data, aab_data, abb_data, bbb_data);
-
-                rdms.emplace_back(a, b, aa, ab, bb, aaa, aab, abb, bbb);
-            }
-        }
+        root_pairs.emplace_back(roots_pair.first, roots_pair.second + nroot_);
     }
-
-    return rdms;
+    return compute_root_pairs_rdms(dets, evecs, root_pairs, max_rdm_level, true, "TD");
 }
 
 } // namespace forte
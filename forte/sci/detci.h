@@ -56,14 +56,9 @@ class DETCI : public ActiveSpaceMethod {
         initial_guess_ = guess;
     }
 
-    /// Dump wave function to disk
+    /// Dump wave function to disk (see WaveFunctionFile)
     void dump_wave_function(const std::string& filename) override;
 
-    /// Read wave function from disk
-    /// Return the number of active orbitals, set of determinants, CI coefficients
-    std::tuple<size_t, std::vector<Determinant>, psi::SharedMatrix>
-    read_wave_function(const std::string& filename) override;
-
   private:
     /// SCFInfo object
     std::shared_ptr<SCFInfo> scf_info_;
@@ -113,6 +108,14 @@ class DETCI : public ActiveSpaceMethod {
     int ncollapse_per_root_;
     /// Number of trial vectors per root for Davidson-Liu
     int nsubspace_per_root_;
+    /// Store the Davidson-Liu subspace vectors in scratch files?
+    bool dl_out_of_core_;
+    /// The size of the block of determinants treated exactly by the preconditioner
+    int dl_preconditioner_block_size_;
+    /// Run the Davidson-Liu algorithm in a basis of CSFs?
+    bool dl_spin_adapt_;
+    /// The iterative eigensolver (DAVIDSON or LOBPCG)
+    std::string dl_eigensolver_;
 
     /// Diagonalize the Hamiltonian
     void diagoanlize_hamiltonian();
@@ -145,6 +148,14 @@ class DETCI : public ActiveSpaceMethod {
     std::vector<ambit::Tensor> compute_trans_2rdms_sosd(int root1, int root2);
     /// Compute the (transition) 3RDMs, same orbital, same set of determinants
     std::vector<ambit::Tensor> compute_trans_3rdms_sosd(int root1, int root2);
+    /// Compute the (transition) RDMs of several root pairs of the eigenvectors evecs of dets
+    /// with one traversal of the coupling lists for the 1- and 2-RDMs, and one build of the
+    /// three-body lists for the 3-RDMs (zero if do_3rdm is false). The tensor names start
+    /// with prefix
+    std::vector<RDMs>
+    compute_root_pairs_rdms(DeterminantHashVec& dets, psi::SharedMatrix evecs,
+                            const std::vector<std::pair<size_t, size_t>>& root_pairs,
+                            int max_rdm_level, bool do_3rdm, const std::string& prefix);
 
     /// Printing for CI_RDMs
     bool print_ci_rdms_ = true;
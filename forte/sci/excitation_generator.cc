@@ -0,0 +1,209 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+
+#include "sci/excitation_generator.h"
+
+namespace forte {
+
+ExcitationGenerator::ExcitationGenerator(std::shared_ptr<ActiveSpaceIntegrals> as_ints,
+                                         std::vector<int> mo_symmetry, double screen_thresh)
+    : as_ints_(as_ints), mo_symmetry_(std::move(mo_symmetry)), nact_(mo_symmetry_.size()),
+      screen_thresh_(screen_thresh) {
+    nirrep_ = 1;
+    for (int h : mo_symmetry_) {
+        // the irreps of D2h and its subgroups are closed under XOR
+        while (h >= nirrep_)
+            nirrep_ *= 2;
+    }
+}
+
+void ExcitationGenerator::set_heat_bath() {
+    heat_bath_ = true;
+    heat_bath_aa_.assign(nact_ * nact_, {});
+    heat_bath_ab_.assign(nact_ * nact_, {});
+    heat_bath_bb_.assign(nact_ * nact_, {});
+
+    auto sort_excitations = [](std::vector<std::tuple<int, int, double>>& excitations) {
+        std::stable_sort(excitations.begin(), excitations.end(),
+                         [](const std::tuple<int, int, double>& e1,
+                            const std::tuple<int, int, double>& e2) {
+                             return std::fabs(std::get<2>(e1)) > std::fabs(std::get<2>(e2));
+                         });
+    };
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t ij = 0; ij < nact_ * nact_; ++ij) {
+        const int i = ij / nact_;
+        const int j = ij % nact_;
+        for (int a = 0; a < static_cast<int>(nact_); ++a) {
+            for (int b = 0; b < static_cast<int>(nact_); ++b) {
+                if ((mo_symmetry_[i] ^ mo_symmetry_[j] ^ mo_symmetry_[a] ^ mo_symmetry_[b]) != 0)
+                    continue;
+                if ((a != i) and (b != j)) {
+                    const double V = as_ints_->tei_ab(i, j, a, b);
+                    if (V != 0.0)
+                        heat_bath_ab_[ij].emplace_back(a, b, V);
+                }
+                if ((i < j) and (a < b) and (a != i) and (a != j) and (b != i) and (b != j)) {
+                    const double Vaa = as_ints_->tei_aa(i, j, a, b);
+                    if (Vaa != 0.0)
+                        heat_bath_aa_[ij].emplace_back(a, b, Vaa);
+                    const double Vbb = as_ints_->tei_bb(i, j, a, b);
+                    if (Vbb != 0.0)
+                        heat_bath_bb_[ij].emplace_back(a, b, Vbb);
+                }
+            }
+        }
+        sort_excitations(heat_bath_aa_[ij]);
+        sort_excitations(heat_bath_ab_[ij]);
+        sort_excitations(heat_bath_bb_[ij]);
+    }
+}
+
+size_t ExcitationGenerator::num_heat_bath_excitations() const {
+    size_t nexcitations = 0;
+    for (size_t ij = 0, maxij = heat_bath_aa_.size(); ij < maxij; ++ij) {
+        nexcitations +=
+            heat_bath_aa_[ij].size() + heat_bath_ab_[ij].size() + heat_bath_bb_[ij].size();
+    }
+    return nexcitations;
+}
+
+void ExcitationGenerator::set_gas(size_t ngas, const std::vector<std::vector<size_t>>& gas_mo,
+                                  const GASSingleCriterion& single,
+                                  const GASDoubleCriterion& doubles) {
+    ngas_ = ngas;
+    gas_dim_ = ngas + 1;
+    orbital_gas_.assign(nact_, ngas);
+    for (size_t g = 0; g < ngas; ++g) {
+        for (size_t p : gas_mo[g]) {
+            orbital_gas_[p] = g;
+        }
+    }
+
+    gas_config_index_.clear();
+    gas_tables_.clear();
+    auto table = [&](const std::vector<int>& config) -> GASTable& {
+        auto it = gas_config_index_.find(config);
+        if (it == gas_config_index_.end()) {
+            it = gas_config_index_.emplace(config, gas_tables_.size()).first;
+            GASTable t;
+            t.a.assign(gas_dim_ * gas_dim_, 0);
+            t.b.assign(gas_dim_ * gas_dim_, 0);
+            t.aa.assign(gas_dim_ * gas_dim_ * gas_dim_ * gas_dim_, 0);
+            t.bb.assign(gas_dim_ * gas_dim_ * gas_dim_ * gas_dim_, 0);
+            t.ab.assign(gas_dim_ * gas_dim_ * gas_dim_ * gas_dim_, 0);
+            gas_tables_.push_back(std::move(t));
+        }
+        return gas_tables_[it->second];
+    };
+
+    for (const auto& [config, pairs] : single.first) {
+        auto& t = table(config);
+        for (const auto& [g1, g2] : pairs)
+            t.a[gas_pair(g1, g2)] = 1;
+    }
+    for (const auto& [config, pairs] : single.second) {
+        auto& t = table(config);
+        for (const auto& [g1, g2] : pairs)
+            t.b[gas_pair(g1, g2)] = 1;
+    }
+    // The same-spin criteria are stored with g1 <= g2 and g3 <= g4, while the generator visits
+    // the pairs of orbitals in any order
+    auto set_same_spin = [&](std::vector<char>& allowed, size_t g1, size_t g2, size_t g3,
+                             size_t g4) {
+        allowed[gas_quad(g1, g2, g3, g4)] = 1;
+        allowed[gas_quad(g2, g1, g3, g4)] = 1;
+        allowed[gas_quad(g1, g2, g4, g3)] = 1;
+        allowed[gas_quad(g2, g1, g4, g3)] = 1;
+    };
+    for (const auto& [config, quads] : std::get<0>(doubles)) {
+        auto& t = table(config);
+        for (const auto& [g1, g2, g3, g4] : quads)
+            set_same_spin(t.aa, g1, g2, g3, g4);
+    }
+    for (const auto& [config, quads] : std::get<1>(doubles)) {
+        auto& t = table(config);
+        for (const auto& [g1, g2, g3, g4] : quads)
+            set_same_spin(t.bb, g1, g2, g3, g4);
+    }
+    for (const auto& [config, quads] : std::get<2>(doubles)) {
+        auto& t = table(config);
+        for (const auto& [g1, g2, g3, g4] : quads)
+            t.ab[gas_quad(g1, g2, g3, g4)] = 1;
+    }
+}
+
+void ExcitationGenerator::fill_orbitals(const Determinant& det, Workspace& ws) const {
+    ws.aocc.resize(nirrep_);
+    ws.bocc.resize(nirrep_);
+    ws.avir.resize(nirrep_);
+    ws.bvir.resize(nirrep_);
+    for (int h = 0; h < nirrep_; ++h) {
+        ws.aocc[h].clear();
+        ws.bocc[h].clear();
+        ws.avir[h].clear();
+        ws.bvir[h].clear();
+    }
+    ws.aocc_all.clear();
+    ws.bocc_all.clear();
+    for (size_t p = 0; p < nact_; ++p) {
+        const int h = mo_symmetry_[p];
+        if (det.get_alfa_bit(p)) {
+            ws.aocc[h].push_back(p);
+            ws.aocc_all.push_back(p);
+        } else {
+            ws.avir[h].push_back(p);
+        }
+        if (det.get_beta_bit(p)) {
+            ws.bocc[h].push_back(p);
+            ws.bocc_all.push_back(p);
+        } else {
+            ws.bvir[h].push_back(p);
+        }
+    }
+}
+
+const ExcitationGenerator::GASTable*
+ExcitationGenerator::find_gas_table(const Determinant& det, Workspace& ws) const {
+    // The GAS occupation is stored as (na_1, nb_1, na_2, nb_2, ...) for six GAS spaces
+    ws.gas_config.assign(12, 0);
+    for (size_t p = 0; p < nact_; ++p) {
+        const size_t g = orbital_gas_[p];
+        if (g == ngas_)
+            continue;
+        ws.gas_config[2 * g] += det.get_alfa_bit(p);
+        ws.gas_config[2 * g + 1] += det.get_beta_bit(p);
+    }
+    auto it = gas_config_index_.find(ws.gas_config);
+    return it == gas_config_index_.end() ? nullptr : &gas_tables_[it->second];
+}
+
+} // namespace forte
@@ -0,0 +1,437 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _excitation_generator_h_
+#define _excitation_generator_h_
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "integrals/active_space_integrals.h"
+#include "sparse_ci/determinant.h"
+
+namespace forte {
+
+/**
+ * @brief The ExcitationGenerator class
+ *
+ * Enumerates the singly and doubly excited determinants of a determinant together with their
+ * Hamiltonian couplings. This is the candidate generator shared by the selected CI screeners
+ * (ACI, GASACI, ASCI) and by the MRPT2 correction.
+ *
+ * The occupied and virtual orbitals of a determinant are grouped by irrep, so the double
+ * excitation loops only visit symmetry-allowed quadruples. Optionally, the double excitations
+ * are read from heat-bath lists sorted by decreasing |<ij||ab>|, and/or they are restricted to
+ * those allowed by a set of generalized active space (GAS) occupation criteria.
+ *
+ * The generation itself does not allocate memory: each thread passes its own Workspace, whose
+ * vectors keep their capacity from one determinant to the next.
+ */
+class ExcitationGenerator {
+  public:
+    /// The GAS pairs (g1, g2) into which a single alpha/beta excitation is allowed, indexed by
+    /// the GAS occupation of the determinant (see CI_Reference::gas_single_criterion)
+    using GASSingleCriterion =
+        std::pair<std::map<std::vector<int>, std::vector<std::pair<size_t, size_t>>>,
+                  std::map<std::vector<int>, std::vector<std::pair<size_t, size_t>>>>;
+    /// The GAS quadruples (g1, g2, g3, g4) of the allowed aa, bb, and ab double excitations
+    /// (see CI_Reference::gas_double_criterion)
+    using GASDoubleCriterion = std::tuple<
+        std::map<std::vector<int>, std::vector<std::tuple<size_t, size_t, size_t, size_t>>>,
+        std::map<std::vector<int>, std::vector<std::tuple<size_t, size_t, size_t, size_t>>>,
+        std::map<std::vector<int>, std::vector<std::tuple<size_t, size_t, size_t, size_t>>>>;
+
+    /// Per-thread scratch space
+    struct Workspace {
+        /// The occupied/virtual alpha/beta orbitals of each irrep
+        std::vector<std::vector<int>> aocc, bocc, avir, bvir;
+        /// All the occupied alpha/beta orbitals (used by the heat-bath loops)
+        std::vector<int> aocc_all, bocc_all;
+        /// The GAS occupation of the determinant
+        std::vector<int> gas_config;
+        /// The alpha/beta orbital energies of the determinant (see for_each_excitation_energy)
+        std::vector<double> eps_a, eps_b;
+    };
+
+    /**
+     * @brief ExcitationGenerator
+     * @param as_ints the active space integrals
+     * @param mo_symmetry the irrep of each active orbital
+     * @param screen_thresh excitations with |HIJ| * scale < screen_thresh are skipped
+     */
+    ExcitationGenerator(std::shared_ptr<ActiveSpaceIntegrals> as_ints,
+                        std::vector<int> mo_symmetry, double screen_thresh);
+
+    /// The integrals used to compute the couplings
+    std::shared_ptr<ActiveSpaceIntegrals> as_ints() const { return as_ints_; }
+
+    /// Build the heat-bath lists and use them to generate the double excitations
+    void set_heat_bath();
+
+    /// The number of double excitations stored in the heat-bath lists
+    size_t num_heat_bath_excitations() const;
+
+    /**
+     * @brief Restrict the excitations to those allowed by the GAS occupation criteria
+     * @param ngas the number of GAS spaces in use
+     * @param gas_mo the active orbitals of each GAS
+     * @param single the allowed single excitations
+     * @param doubles the allowed double excitations
+     */
+    void set_gas(size_t ngas, const std::vector<std::vector<size_t>>& gas_mo,
+                 const GASSingleCriterion& single, const GASDoubleCriterion& doubles);
+
+    /**
+     * @brief Call f(new_det, HIJ, a, b) for all the excitations of det with |HIJ| * scale >=
+     * screen_thresh and accept(new_det) true. a and b are the orbitals excited into (b = -1 for
+     * single excitations). The excitations are generated in the order a, b, aa, ab, bb.
+     *
+     * accept is evaluated before computing the couplings of single excitations, so it can be
+     * used to cheaply discard determinants (e.g. those that do not belong to a bin)
+     */
+    template <typename Accept, typename Function>
+    void for_each_excitation(const Determinant& det, double scale, Workspace& ws, Accept accept,
+                             Function f) const {
+        generate<false>(det, 0.0, scale, ws, accept,
+                        [&](const Determinant& new_det, double HIJ, int a, int b, double) {
+                            f(new_det, HIJ, a, b);
+                        });
+    }
+
+    /// Call f(new_det, HIJ, a, b) for all the excitations of det with |HIJ| * scale >=
+    /// screen_thresh
+    template <typename Function>
+    void for_each_excitation(const Determinant& det, double scale, Workspace& ws,
+                             Function f) const {
+        for_each_excitation(
+            det, scale, ws, [](const Determinant&) { return true; }, f);
+    }
+
+    /**
+     * @brief Same as for_each_excitation, but call f(new_det, HIJ, E_new) where E_new is the
+     * diagonal energy <new_det|H|new_det>.
+     *
+     * The energies of all the excitations of det are obtained from E_det = <det|H|det> and the
+     * orbital energies of det (see ActiveSpaceIntegrals::orbital_energies), which reduces the
+     * cost of each energy to a few table lookups.
+     */
+    template <typename Accept, typename Function>
+    void for_each_excitation_energy(const Determinant& det, double E_det, double scale,
+                                    Workspace& ws, Accept accept, Function f) const {
+        generate<true>(det, E_det, scale, ws, accept,
+                       [&](const Determinant& new_det, double HIJ, int, int, double E_new) {
+                           f(new_det, HIJ, E_new);
+                       });
+    }
+
+  private:
+    /// The implementation of for_each_excitation. If compute_energy is true, f is passed the
+    /// energy of the excited determinant, otherwise zero
+    template <bool compute_energy, typename Accept, typename Function>
+    void generate(const Determinant& det, double E_det, double scale, Workspace& ws,
+                  Accept accept, Function f) const;
+
+    /// The allowed excitations between GAS spaces for a given GAS occupation
+    struct GASTable {
+        std::vector<char> a, b;
+        std::vector<char> aa, bb, ab;
+    };
+
+    /// Fill the orbital lists of the workspace
+    void fill_orbitals(const Determinant& det, Workspace& ws) const;
+    /// Return the GAS table of det (nullptr if the GAS occupation of det is not allowed)
+    const GASTable* find_gas_table(const Determinant& det, Workspace& ws) const;
+
+    size_t gas_pair(int g1, int g2) const { return g1 * gas_dim_ + g2; }
+    size_t gas_quad(int g1, int g2, int g3, int g4) const {
+        return ((g1 * gas_dim_ + g2) * gas_dim_ + g3) * gas_dim_ + g4;
+    }
+
+    /// The active space integrals
+    std::shared_ptr<ActiveSpaceIntegrals> as_ints_;
+    /// The irrep of each active orbital
+    std::vector<int> mo_symmetry_;
+    /// The number of active orbitals
+    size_t nact_;
+    /// The number of irreps
+    int nirrep_;
+    /// The screening threshold
+    double screen_thresh_;
+
+    /// Use the heat-bath lists?
+    bool heat_bath_ = false;
+    /// The double excitations of each pair of occupied orbitals (i, j) (indexed as i * nact + j)
+    /// sorted by decreasing |V|
+    std::vector<std::vector<std::tuple<int, int, double>>> heat_bath_aa_, heat_bath_ab_,
+        heat_bath_bb_;
+
+    /// The number of GAS spaces (zero if the excitations are not restricted)
+    size_t ngas_ = 0;
+    /// The dimension of the GAS tables (ngas_ + 1, the last entry is for orbitals not in any GAS)
+    size_t gas_dim_ = 0;
+    /// The GAS of each active orbital (ngas_ if not in any GAS)
+    std::vector<int> orbital_gas_;
+    /// Map from a GAS occupation to its index in gas_tables_
+    std::map<std::vector<int>, size_t> gas_config_index_;
+    /// The allowed excitations of each GAS occupation
+    std::vector<GASTable> gas_tables_;
+};
+
+template <bool compute_energy, typename Accept, typename Function>
+void ExcitationGenerator::generate(const Determinant& det, double E_det, double scale,
+                                   Workspace& ws, Accept accept, Function f) const {
+    const GASTable* gas = nullptr;
+    if (ngas_ > 0) {
+        gas = find_gas_table(det, ws);
+        if (gas == nullptr)
+            return;
+    }
+    fill_orbitals(det, ws);
+    if constexpr (compute_energy) {
+        as_ints_->orbital_energies(det, ws.eps_a, ws.eps_b);
+    }
+    // The energies of the excited determinants (zero if not requested)
+    const auto& ints = *as_ints_;
+    auto E_a = [&](int i, int a) {
+        return compute_energy ? ints.energy_from_parent_a(E_det, ws.eps_a, i, a) : 0.0;
+    };
+    auto E_b = [&](int i, int a) {
+        return compute_energy ? ints.energy_from_parent_b(E_det, ws.eps_b, i, a) : 0.0;
+    };
+    auto E_aa = [&](int i, int j, int a, int b) {
+        return compute_energy ? ints.energy_from_parent_aa(E_det, ws.eps_a, i, j, a, b) : 0.0;
+    };
+    auto E_ab = [&](int i, int j, int a, int b) {
+        return compute_energy ? ints.energy_from_parent_ab(E_det, ws.eps_a, ws.eps_b, i, j, a, b)
+                              : 0.0;
+    };
+    auto E_bb = [&](int i, int j, int a, int b) {
+        return compute_energy ? ints.energy_from_parent_bb(E_det, ws.eps_b, i, j, a, b) : 0.0;
+    };
+    const auto& og = orbital_gas_;
+    Determinant new_det(det);
+
+    // Generate alpha excitations
+    for (int h = 0; h < nirrep_; ++h) {
+        for (int ii : ws.aocc[h]) {
+            for (int aa : ws.avir[h]) {
+                if (gas and !gas->a[gas_pair(og[ii], og[aa])])
+                    continue;
+                new_det = det;
+                new_det.set_alfa_bit(ii, false);
+                new_det.set_alfa_bit(aa, true);
+                if (!accept(new_det))
+                    continue;
+                double HIJ = as_ints_->slater_rules_single_alpha(det, ii, aa);
+                if (std::fabs(HIJ) * scale >= screen_thresh_)
+                    f(new_det, HIJ, aa, -1, E_a(ii, aa));
+            }
+        }
+    }
+    // Generate beta excitations
+    for (int h = 0; h < nirrep_; ++h) {
+        for (int ii : ws.bocc[h]) {
+            for (int aa : ws.bvir[h]) {
+                if (gas and !gas->b[gas_pair(og[ii], og[aa])])
+                    continue;
+                new_det = det;
+                new_det.set_beta_bit(ii, false);
+                new_det.set_beta_bit(aa, true);
+                if (!accept(new_det))
+                    continue;
+                double HIJ = as_ints_->slater_rules_single_beta(det, ii, aa);
+                if (std::fabs(HIJ) * scale >= screen_thresh_)
+                    f(new_det, HIJ, aa, -1, E_b(ii, aa));
+            }
+        }
+    }
+
+    if (heat_bath_) {
+        // The excitations of each pair are sorted by decreasing |V|, so the loops stop at the
+        // first excitation below the threshold
+        const auto& aocc = ws.aocc_all;
+        const auto& bocc = ws.bocc_all;
+        for (size_t i = 0, maxi = aocc.size(); i < maxi; ++i) {
+            for (size_t j = i + 1; j < maxi; ++j) {
+                const int ii = aocc[i], jj = aocc[j];
+                for (const auto& [aa, bb, V] : heat_bath_aa_[ii * nact_ + jj]) {
+                    if (std::fabs(V) * scale < screen_thresh_)
+                        break;
+                    if (det.get_alfa_bit(aa) or det.get_alfa_bit(bb))
+                        continue;
+                    if (gas and !gas->aa[gas_quad(og[ii], og[jj], og[aa], og[bb])])
+                        continue;
+                    new_det = det;
+                    double sign = new_det.double_excitation_aa(ii, jj, aa, bb);
+                    if (accept(new_det))
+                        f(new_det, sign * V, aa, bb, E_aa(ii, jj, aa, bb));
+                }
+            }
+        }
+        for (int ii : aocc) {
+            for (int jj : bocc) {
+                for (const auto& [aa, bb, V] : heat_bath_ab_[ii * nact_ + jj]) {
+                    if (std::fabs(V) * scale < screen_thresh_)
+                        break;
+                    if (det.get_alfa_bit(aa) or det.get_beta_bit(bb))
+                        continue;
+                    if (gas and !gas->ab[gas_quad(og[ii], og[jj], og[aa], og[bb])])
+                        continue;
+                    new_det = det;
+                    double sign = new_det.double_excitation_ab(ii, jj, aa, bb);
+                    if (accept(new_det))
+                        f(new_det, sign * V, aa, bb, E_ab(ii, jj, aa, bb));
+                }
+            }
+        }
+        for (size_t i = 0, maxi = bocc.size(); i < maxi; ++i) {
+            for (size_t j = i + 1; j < maxi; ++j) {
+                const int ii = bocc[i], jj = bocc[j];
+                for (const auto& [aa, bb, V] : heat_bath_bb_[ii * nact_ + jj]) {
+                    if (std::fabs(V) * scale < screen_thresh_)
+                        break;
+                    if (det.get_beta_bit(aa) or det.get_beta_bit(bb))
+                        continue;
+                    if (gas and !gas->bb[gas_quad(og[ii], og[jj], og[aa], og[bb])])
+                        continue;
+                    new_det = det;
+                    double sign = new_det.double_excitation_bb(ii, jj, aa, bb);
+                    if (accept(new_det))
+                        f(new_det, sign * V, aa, bb, E_bb(ii, jj, aa, bb));
+                }
+            }
+        }
+        return;
+    }
+
+    // Generate aa excitations. The pairs of occupied (p,q) and virtual (r,s) irreps are visited
+    // once with p <= q and r <= s
+    for (int p = 0; p < nirrep_; ++p) {
+        for (int q = p; q < nirrep_; ++q) {
+            for (int r = 0; r < nirrep_; ++r) {
+                const int s = p ^ q ^ r;
+                if (s < r)
+                    continue;
+                const auto& occ_p = ws.aocc[p];
+                const auto& occ_q = ws.aocc[q];
+                const auto& vir_r = ws.avir[r];
+                const auto& vir_s = ws.avir[s];
+                for (size_t i = 0, maxi = occ_p.size(); i < maxi; ++i) {
+                    const int ii = occ_p[i];
+                    for (size_t j = (p == q ? i + 1 : 0), maxj = occ_q.size(); j < maxj; ++j) {
+                        const int jj = occ_q[j];
+                        for (size_t a = 0, maxa = vir_r.size(); a < maxa; ++a) {
+                            const int aa = vir_r[a];
+                            for (size_t b = (r == s ? a + 1 : 0), maxb = vir_s.size(); b < maxb;
+                                 ++b) {
+                                const int bb = vir_s[b];
+                                if (gas and !gas->aa[gas_quad(og[ii], og[jj], og[aa], og[bb])])
+                                    continue;
+                                double HIJ = as_ints_->tei_aa(ii, jj, aa, bb);
+                                if (std::fabs(HIJ) * scale < screen_thresh_)
+                                    continue;
+                                new_det = det;
+                                HIJ *= new_det.double_excitation_aa(ii, jj, aa, bb);
+                                if (accept(new_det))
+                                    f(new_det, HIJ, aa, bb, E_aa(ii, jj, aa, bb));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    // Generate ab excitations
+    for (int p = 0; p < nirrep_; ++p) {
+        for (int q = 0; q < nirrep_; ++q) {
+            for (int r = 0; r < nirrep_; ++r) {
+                const int s = p ^ q ^ r;
+                for (int ii : ws.aocc[p]) {
+                    for (int jj : ws.bocc[q]) {
+                        for (int aa : ws.avir[r]) {
+                            for (int bb : ws.bvir[s]) {
+                                if (gas and !gas->ab[gas_quad(og[ii], og[jj], og[aa], og[bb])])
+                                    continue;
+                                double HIJ = as_ints_->tei_ab(ii, jj, aa, bb);
+                                if (std::fabs(HIJ) * scale < screen_thresh_)
+                                    continue;
+                                new_det = det;
+                                HIJ *= new_det.double_excitation_ab(ii, jj, aa, bb);
+                                if (accept(new_det))
+                                    f(new_det, HIJ, aa, bb, E_ab(ii, jj, aa, bb));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    // Generate bb excitations
+    for (int p = 0; p < nirrep_; ++p) {
+        for (int q = p; q < nirrep_; ++q) {
+            for (int r = 0; r < nirrep_; ++r) {
+                const int s = p ^ q ^ r;
+                if (s < r)
+                    continue;
+                const auto& occ_p = ws.bocc[p];
+                const auto& occ_q = ws.bocc[q];
+                const auto& vir_r = ws.bvir[r];
+                const auto& vir_s = ws.bvir[s];
+                for (size_t i = 0, maxi = occ_p.size(); i < maxi; ++i) {
+                    const int ii = occ_p[i];
+                    for (size_t j = (p == q ? i + 1 : 0), maxj = occ_q.size(); j < maxj; ++j) {
+                        const int jj = occ_q[j];
+                        for (size_t a = 0, maxa = vir_r.size(); a < maxa; ++a) {
+                            const int aa = vir_r[a];
+                            for (size_t b = (r == s ? a + 1 : 0), maxb = vir_s.size(); b < maxb;
+                                 ++b) {
+                                const int bb = vir_s[b];
+                                if (gas and !gas->bb[gas_quad(og[ii], og[jj], og[aa], og[bb])])
+                                    continue;
+                                double HIJ = as_ints_->tei_bb(ii, jj, aa, bb);
+                                if (std::fabs(HIJ) * scale < screen_thresh_)
+                                    continue;
+                                new_det = det;
+                                HIJ *= new_det.double_excitation_bb(ii, jj, aa, bb);
+                                if (accept(new_det))
+                                    f(new_det, HIJ, aa, bb, E_bb(ii, jj, aa, bb));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace forte
+
+#endif // _excitation_generator_h_
@@ -178,6 +178,11 @@ void FCI_MO::read_options() {
     // IP / EA
     ipea_ = options_->get_str("FCIMO_IPEA");
 
+    // memory cache of the densities
+    density_cache_max_bytes_ =
+        static_cast<size_t>(options_->get_double("FCIMO_RDM_CACHE_MAX_MEM") * 1073741824.0);
+    density_cache_spill_ = options_->get_bool("FCIMO_RDM_CACHE_SPILL");
+
     // print level
     print_ = options_->get_int("PRINT");
 
@@ -414,8 +419,8 @@ void FCI_MO::form_det() {
     if (!quiet_) {
         outfile->Printf("\n  %-35s ...", "Forming alpha and beta strings");
     }
-    std::vector<std::vector<std::vector<bool>>> a_string = Form_String(na_a);
-    std::vector<std::vector<std::vector<bool>>> b_string = Form_String(nb_a);
+    std::vector<std::vector<String>> a_string = Form_String(na_a);
+    std::vector<std::vector<String>> b_string = Form_String(nb_a);
     if (!quiet_) {
         outfile->Printf("  Done. Timing %15.6f s", tstrings.get());
     }
@@ -438,6 +443,11 @@ void FCI_MO::form_det() {
             }
         }
     } else {
+        size_t ndets = 0;
+        for (int i = 0; i != nirrep_; ++i) {
+            ndets += a_string[i].size() * b_string[i ^ root_sym_].size();
+        }
+        determinant_.reserve(determinant_.size() + ndets);
         for (int i = 0; i != nirrep_; ++i) {
             int j = i ^ root_sym_;
             size_t sa = a_string[i].size();
@@ -454,47 +464,41 @@ void FCI_MO::form_det() {
     }
 }
 
-std::vector<std::vector<std::vector<bool>>> FCI_MO::Form_String(const int& active_elec,
+std::vector<std::vector<String>> FCI_MO::Form_String(const int& active_elec,
                                                                 const bool& print) {
     timer_on("FORM String");
-    std::vector<std::vector<std::vector<bool>>> String(nirrep_, std::vector<std::vector<bool>>());
-
-    // initalize the string (only active)
-    int symmetry = 0;
-    bool* I_init = new bool[nactv_];
-    for (size_t i = 0; i < nactv_; ++i)
-        I_init[i] = 0;
-    for (size_t i = nactv_ - active_elec; i < nactv_; ++i)
-        I_init[i] = 1;
+    std::vector<std::vector<String>> strings(nirrep_);
 
+    // permute the occupation of the active orbitals in lexicographic order
+    std::vector<char> occ(nactv_, 0);
+    std::fill(occ.end() - active_elec, occ.end(), 1);
     do {
-        // permute the active
-        std::vector<bool> string_a;
-        int sym = symmetry;
+        String string_a;
+        string_a.zero();
+        int sym = 0;
         for (size_t i = 0; i < nactv_; ++i) {
-            string_a.push_back(I_init[i]);
-            if (I_init[i] == 1) {
+            if (occ[i]) {
+                string_a.set_bit(i, true);
                 sym ^= sym_actv_[i];
             }
         }
-        String[sym].push_back(string_a);
-    } while (std::next_permutation(I_init, I_init + nactv_));
+        strings[sym].push_back(string_a);
+    } while (std::next_permutation(occ.begin(), occ.end()));
 
     if (print == true && !quiet_) {
-        print_occupation_strings_perirrep("Possible Strings", String);
+        print_occupation_strings_perirrep("Possible Strings", strings);
     }
 
-    delete[] I_init;
     timer_off("FORM String");
-    return String;
+    return strings;
 }
 
 void FCI_MO::form_det_cis() {
     // reference string
-    std::vector<bool> string_ref = Form_String_Ref();
+    String string_ref = Form_String_Ref();
 
     // singles string
-    std::vector<std::vector<std::vector<bool>>> string_singles;
+    std::vector<std::vector<String>> string_singles;
     if (ipea_ == "IP") {
         string_singles = Form_String_IP(string_ref);
     } else if (ipea_ == "EA") {
@@ -506,7 +510,7 @@ void FCI_MO::form_det_cis() {
     // symmetry of ref (just active)
     int symmetry = 0;
     for (size_t i = 0; i < nactv_; ++i) {
-        if (string_ref[i]) {
+        if (string_ref.get_bit(i)) {
             symmetry ^= sym_actv_[i];
         }
     }
@@ -536,11 +540,11 @@ void FCI_MO::form_det_cis() {
 
 void FCI_MO::form_det_cisd() {
     // reference string
-    std::vector<bool> string_ref = Form_String_Ref();
+    String string_ref = Form_String_Ref();
 
     // singles string
-    std::vector<std::vector<std::vector<bool>>> string_singles = Form_String_Singles(string_ref);
-    std::vector<std::vector<std::vector<bool>>> string_singles_ipea;
+    std::vector<std::vector<String>> string_singles = Form_String_Singles(string_ref);
+    std::vector<std::vector<String>> string_singles_ipea;
     if (ipea_ == "IP") {
         string_singles_ipea = Form_String_IP(string_ref);
     } else if (ipea_ == "EA") {
@@ -548,12 +552,12 @@ void FCI_MO::form_det_cisd() {
     }
 
     // doubles string
-    std::vector<std::vector<std::vector<bool>>> string_doubles = Form_String_Doubles(string_ref);
+    std::vector<std::vector<String>> string_doubles = Form_String_Doubles(string_ref);
 
     // symmetry of ref (just active)
     int symmetry = 0;
     for (size_t i = 0; i < nactv_; ++i) {
-        if (string_ref[i]) {
+        if (string_ref.get_bit(i)) {
             symmetry ^= sym_actv_[i];
         }
     }
@@ -621,34 +625,34 @@ void FCI_MO::form_det_cisd() {
     }
 }
 
-std::vector<bool> FCI_MO::Form_String_Ref(const bool& print) {
+String FCI_MO::Form_String_Ref(const bool& print) {
     timer_on("FORM String Ref");
 
-    std::vector<bool> String;
-    for (int h = 0; h < nirrep_; ++h) {
-        int act_docc = actv_hole_dim_[h];
-        int act = actv_dim_[h];
-        for (int i = 0; i < act; ++i) {
-            String.push_back(i < act_docc);
+    String string_ref;
+    string_ref.zero();
+    for (int h = 0, offset = 0; h < nirrep_; ++h) {
+        for (int i = 0; i < actv_hole_dim_[h]; ++i) {
+            string_ref.set_bit(offset + i, true);
         }
+        offset += actv_dim_[h];
     }
 
     if (print) {
         print_h2("Reference String");
         outfile->Printf("    ");
-        for (bool b : String) {
-            outfile->Printf("%d ", b);
+        for (size_t i = 0; i < nactv_; ++i) {
+            outfile->Printf("%d ", string_ref.get_bit(i));
         }
     }
 
     timer_off("FORM String Ref");
-    return String;
+    return string_ref;
 }
 
-std::vector<std::vector<std::vector<bool>>>
-FCI_MO::Form_String_Singles(const std::vector<bool>& ref_string, const bool& print) {
+std::vector<std::vector<String>>
+FCI_MO::Form_String_Singles(const String& ref_string, const bool& print) {
     timer_on("FORM String Singles");
-    std::vector<std::vector<std::vector<bool>>> String(nirrep_, std::vector<std::vector<bool>>());
+    std::vector<std::vector<String>> strings(nirrep_);
 
     // occupied and unoccupied indices, symmetry (active)
     int symmetry = 0;
@@ -659,7 +663,7 @@ FCI_MO::Form_String_Singles(const std::vector<bool>& ref_string, const bool& pri
             continue;
         }
 
-        if (ref_string[i]) {
+        if (ref_string.get_bit(i)) {
             occ.push_back(i);
             symmetry ^= sym_actv_[i];
         } else {
@@ -669,37 +673,37 @@ FCI_MO::Form_String_Singles(const std::vector<bool>& ref_string, const bool& pri
 
     // singles
     for (const int& a : uocc) {
-        std::vector<bool> string_local(ref_string);
-        string_local[a] = true;
+        String string_local(ref_string);
+        string_local.set_bit(a, true);
         int sym = symmetry ^ sym_actv_[a];
         for (const int& i : occ) {
-            string_local[i] = false;
+            string_local.set_bit(i, false);
             sym ^= sym_actv_[i];
-            String[sym].push_back(string_local);
+            strings[sym].push_back(string_local);
             // need to reset
-            string_local[i] = true;
+            string_local.set_bit(i, true);
             sym ^= sym_actv_[i];
         }
     }
 
     if (print) {
-        print_occupation_strings_perirrep("Singles Strings", String);
+        print_occupation_strings_perirrep("Singles Strings", strings);
     }
 
     timer_off("FORM String Singles");
-    return String;
+    return strings;
 }
 
-std::vector<std::vector<std::vector<bool>>>
-FCI_MO::Form_String_IP(const std::vector<bool>& ref_string, const bool& print) {
+std::vector<std::vector<String>>
+FCI_MO::Form_String_IP(const String& ref_string, const bool& print) {
     timer_on("FORM String Singles IP");
-    std::vector<std::vector<std::vector<bool>>> String(nirrep_, std::vector<std::vector<bool>>());
+    std::vector<std::vector<String>> strings(nirrep_);
 
     // occupied and unoccupied indices, symmetry (active)
     int symmetry = 0;
     std::vector<int> occ;
     for (size_t i = 0; i < nactv_; ++i) {
-        if (ref_string[i]) {
+        if (ref_string.get_bit(i)) {
             occ.push_back(i);
             symmetry ^= sym_actv_[i];
         }
@@ -707,32 +711,32 @@ FCI_MO::Form_String_IP(const std::vector<bool>& ref_string, const bool& print) {
 
     // singles
     for (const int& i : occ) {
-        std::vector<bool> string_local(ref_string);
-        string_local[idx_diffused_] = true;
+        String string_local(ref_string);
+        string_local.set_bit(idx_diffused_, true);
 
-        string_local[i] = false;
+        string_local.set_bit(i, false);
         int sym = symmetry ^ sym_actv_[i];
-        String[sym].push_back(string_local);
+        strings[sym].push_back(string_local);
     }
 
     if (print) {
-        print_occupation_strings_perirrep("Singles Strings IP", String);
+        print_occupation_strings_perirrep("Singles Strings IP", strings);
     }
 
     timer_off("FORM String Singles IP");
-    return String;
+    return strings;
 }
 
-std::vector<std::vector<std::vector<bool>>>
-FCI_MO::Form_String_EA(const std::vector<bool>& ref_string, const bool& print) {
+std::vector<std::vector<String>>
+FCI_MO::Form_String_EA(const String& ref_string, const bool& print) {
     timer_on("FORM String Singles EA");
-    std::vector<std::vector<std::vector<bool>>> String(nirrep_, std::vector<std::vector<bool>>());
+    std::vector<std::vector<String>> strings(nirrep_);
 
     // occupied and unoccupied indices, symmetry (active)
     int symmetry = 0;
     std::vector<int> uocc;
     for (size_t i = 0; i < nactv_; ++i) {
-        if (!ref_string[i]) {
+        if (!ref_string.get_bit(i)) {
             uocc.push_back(i);
         } else {
             symmetry ^= sym_actv_[i];
@@ -741,26 +745,26 @@ FCI_MO::Form_String_EA(const std::vector<bool>& ref_string, const bool& print) {
 
     // singles
     for (const int& a : uocc) {
-        std::vector<bool> string_local(ref_string);
-        string_local[a] = true;
+        String string_local(ref_string);
+        string_local.set_bit(a, true);
         int sym = symmetry ^ sym_actv_[a];
 
-        string_local[idx_diffused_] = false;
-        String[sym].push_back(string_local);
+        string_local.set_bit(idx_diffused_, false);
+        strings[sym].push_back(string_local);
     }
 
     if (print) {
-        print_occupation_strings_perirrep("Singles Strings EA", String);
+        print_occupation_strings_perirrep("Singles Strings EA", strings);
     }
 
     timer_off("FORM String Singles EA");
-    return String;
+    return strings;
 }
 
-std::vector<std::vector<std::vector<bool>>>
-FCI_MO::Form_String_Doubles(const std::vector<bool>& ref_string, const bool& print) {
+std::vector<std::vector<String>>
+FCI_MO::Form_String_Doubles(const String& ref_string, const bool& print) {
     timer_on("FORM String Doubles");
-    std::vector<std::vector<std::vector<bool>>> String(nirrep_, std::vector<std::vector<bool>>());
+    std::vector<std::vector<String>> strings(nirrep_);
 
     // occupied and unoccupied indices, symmetry (active)
     int symmetry = 0;
@@ -771,7 +775,7 @@ FCI_MO::Form_String_Doubles(const std::vector<bool>& ref_string, const bool& pri
             continue;
         }
 
-        if (ref_string[i]) {
+        if (ref_string.get_bit(i)) {
             occ.push_back(i);
             symmetry ^= sym_actv_[i];
         } else {
@@ -781,27 +785,27 @@ FCI_MO::Form_String_Doubles(const std::vector<bool>& ref_string, const bool& pri
 
     // doubles
     for (const int& a : uocc) {
-        std::vector<bool> string_a(ref_string);
-        string_a[a] = true;
+        String string_a(ref_string);
+        string_a.set_bit(a, true);
         int sym_a = symmetry ^ sym_actv_[a];
 
         for (const int& b : uocc) {
             if (b > a) {
-                std::vector<bool> string_b(string_a);
-                string_b[b] = true;
+                String string_b(string_a);
+                string_b.set_bit(b, true);
                 int sym_b = sym_a ^ sym_actv_[b];
 
                 for (const int& i : occ) {
-                    std::vector<bool> string_i(string_b);
-                    string_i[i] = false;
+                    String string_i(string_b);
+                    string_i.set_bit(i, false);
                     int sym_i = sym_b ^ sym_actv_[i];
 
                     for (const int& j : occ) {
                         if (j > i) {
-                            std::vector<bool> string_j(string_i);
-                            string_j[j] = false;
+                            String string_j(string_i);
+                            string_j.set_bit(j, false);
                             int sym_j = sym_i ^ sym_actv_[j];
-                            String[sym_j].push_back(string_j);
+                            strings[sym_j].push_back(string_j);
                         }
                     }
                 }
@@ -810,11 +814,11 @@ FCI_MO::Form_String_Doubles(const std::vector<bool>& ref_string, const bool& pri
     }
 
     if (print) {
-        print_occupation_strings_perirrep("Doubles Strings", String);
+        print_occupation_strings_perirrep("Doubles Strings", strings);
     }
 
     timer_off("FORM String Doubles");
-    return String;
+    return strings;
 }
 
 std::vector<double> FCI_MO::compute_T1_percentage() {
@@ -842,7 +846,7 @@ std::vector<double> FCI_MO::compute_T1_percentage() {
 void FCI_MO::Diagonalize_H_noHF(const vecdet& p_space, const int& multi, const int& nroot,
                                 std::vector<std::pair<psi::SharedVector, double>>& eigen) {
     // recompute RHF determinant
-    std::vector<bool> string_ref = Form_String_Ref();
+    String string_ref = Form_String_Ref();
     Determinant rhf(string_ref, string_ref);
 
     // test if RHF determinant is the last one in det
@@ -1755,12 +1759,7 @@ bool FCI_MO::check_density_files(int rdm_level, int root1, int root2, const Stat
 void FCI_MO::remove_density_files(int rdm_level, int root1, int root2, const StateInfo& state2) {
     auto fullnames = generate_rdm_file_names(rdm_level, root1, root2, state2);
     for (const std::string& filename : fullnames) {
-        density_files_.erase(filename);
-        if (remove(filename.c_str()) != 0) {
-            std::stringstream ss;
-            ss << "Error deleting file " << filename << ": No such file or directory";
-            throw psi::PSIEXCEPTION(ss.str());
-        }
+        remove_density(filename);
     }
 
     std::string level = std::to_string(rdm_level);
@@ -2378,12 +2377,7 @@ std::vector<std::string> FCI_MO::density_filenames_generator(int rdm_level, int
 void FCI_MO::remove_density_files_fcimo(int rdm_level, int irrep, int multi, int root1, int root2) {
     auto fullnames = density_filenames_generator(rdm_level, irrep, multi, root1, root2);
     for (const std::string& filename : fullnames) {
-        density_files_.erase(filename);
-        if (remove(filename.c_str()) != 0) {
-            std::stringstream ss;
-            ss << "Error deleting file " << filename << ": No such file or directory";
-            throw psi::PSIEXCEPTION(ss.str());
-        }
+        remove_density(filename);
     }
 
     std::string level = std::to_string(rdm_level);
@@ -2393,14 +2387,62 @@ void FCI_MO::remove_density_files_fcimo(int rdm_level, int irrep, int multi, int
 }
 
 void FCI_MO::clean_all_density_files() {
-    for (const std::string& filename : density_files_) {
-        if (remove(filename.c_str()) != 0) {
-            std::stringstream ss;
-            ss << "Error deleting file " << filename << ": No such file or directory";
-            throw psi::PSIEXCEPTION(ss.str());
+    std::vector<std::string> filenames(density_files_.begin(), density_files_.end());
+    for (const std::string& filename : filenames) {
+        remove_density(filename);
+    }
+}
+
+void FCI_MO::store_densities(const std::vector<std::string>& names,
+                             std::vector<ambit::Tensor>& densities) {
+    size_t nbytes = 0;
+    for (const auto& d : densities) {
+        nbytes += d.numel() * sizeof(double);
+    }
+
+    if (density_cache_bytes_ + nbytes <= density_cache_max_bytes_) {
+        for (size_t i = 0, n = names.size(); i < n; ++i) {
+            density_cache_[names[i]] = densities[i].data();
+            density_files_.insert(names[i]);
+        }
+        density_cache_bytes_ += nbytes;
+    } else if (density_cache_spill_) {
+        outfile->Printf("Writing ... ");
+        for (size_t i = 0, n = names.size(); i < n; ++i) {
+            write_disk_vector_double(names[i], densities[i].data());
+            density_files_.insert(names[i]);
         }
     }
-    density_files_.clear();
+}
+
+void FCI_MO::load_densities(const std::vector<std::string>& names,
+                            std::vector<ambit::Tensor>& densities) {
+    for (size_t i = 0, n = names.size(); i < n; ++i) {
+        load_density(names[i], densities[i].data());
+    }
+}
+
+void FCI_MO::load_density(const std::string& name, std::vector<double>& data) {
+    auto it = density_cache_.find(name);
+    if (it != density_cache_.end()) {
+        data = it->second;
+    } else {
+        outfile->Printf("Reading ... ");
+        read_disk_vector_double(name, data);
+    }
+}
+
+void FCI_MO::remove_density(const std::string& name) {
+    density_files_.erase(name);
+    auto it = density_cache_.find(name);
+    if (it != density_cache_.end()) {
+        density_cache_bytes_ -= it->second.size() * sizeof(double);
+        density_cache_.erase(it);
+    } else if (remove(name.c_str()) != 0) {
+        std::stringstream ss;
+        ss << "Error deleting file " << name << ": No such file or directory";
+        throw psi::PSIEXCEPTION(ss.str());
+    }
 }
 
 void FCI_MO::set_sa_info(const std::vector<std::tuple<int, int, int, std::vector<double>>>& info) {
@@ -2518,10 +2560,7 @@ std::vector<ambit::Tensor> FCI_MO::compute_n_rdm(const vecdet& p_space, psi::Sha
     bool files_exist = check_density_files(rdm_level, root1, root2, state2);
 
     if (safe_to_read_density_files_ && files_exist) {
-        outfile->Printf("Reading ... ");
-        for (int i = 0; i < ntensors; ++i) {
-            read_disk_vector_double(filenames[i], out[i].data());
-        }
+        load_densities(filenames, out);
     } else {
         // Important! need to shift root2 when two states are different
         int root2_shifted = (state2 == state_) ? root2 : nroot_ + root2;
@@ -2541,11 +2580,7 @@ std::vector<ambit::Tensor> FCI_MO::compute_n_rdm(const vecdet& p_space, psi::Sha
         }
 
         if (disk) {
-            outfile->Printf("Writing ... ");
-            for (int i = 0; i < ntensors; ++i) {
-                write_disk_vector_double(filenames[i], out[i].data());
-                density_files_.insert(filenames[i]);
-            }
+            store_densities(filenames, out);
         }
     }
 
@@ -2590,10 +2625,7 @@ std::vector<ambit::Tensor> FCI_MO::compute_n_rdm(const vecdet& p_space, psi::Sha
     bool files_exist = check_density_files_fcimo(rdm_level, irrep, multi, root1, root2);
 
     if (safe_to_read_density_files_ && files_exist) {
-        outfile->Printf("Reading ... ");
-        for (int i = 0; i < ntensors; ++i) {
-            read_disk_vector_double(filenames[i], out[i].data());
-        }
+        load_densities(filenames, out);
     } else {
         CI_RDMS ci_rdms(fci_ints_, p_space, evecs, root1, root2);
 
@@ -2610,11 +2642,7 @@ std::vector<ambit::Tensor> FCI_MO::compute_n_rdm(const vecdet& p_space, psi::Sha
         }
 
         if (disk) {
-            outfile->Printf("Writing ... ");
-            for (int i = 0; i < ntensors; ++i) {
-                write_disk_vector_double(filenames[i], out[i].data());
-                density_files_.insert(filenames[i]);
-            }
+            store_densities(filenames, out);
         }
     }
 
@@ -2687,17 +2715,17 @@ void FCI_MO::print_det(const vecdet& dets) {
     outfile->Printf("\n");
 }
 
-void FCI_MO::print_occupation_strings_perirrep(
-    std::string name, const vector<std::vector<std::vector<bool>>>& string) {
+void FCI_MO::print_occupation_strings_perirrep(std::string name,
+                                               const std::vector<std::vector<String>>& strings) {
     print_h2(name);
-    for (size_t i = 0; i != string.size(); ++i) {
-        if (string[i].size() != 0) {
+    for (size_t i = 0; i != strings.size(); ++i) {
+        if (strings[i].size() != 0) {
             outfile->Printf("\n  symmetry = %lu \n", i);
         }
-        for (size_t j = 0; j != string[i].size(); ++j) {
+        for (const auto& s : strings[i]) {
             outfile->Printf("    ");
-            for (bool b : string[i][j]) {
-                outfile->Printf("%d ", b);
+            for (size_t p = 0; p < nactv_; ++p) {
+                outfile->Printf("%d ", s.get_bit(p));
             }
             outfile->Printf("\n");
         }
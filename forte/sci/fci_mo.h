@@ -34,6 +34,7 @@
 #include <tuple>
 #include <vector>
 #include <utility>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "ambit/tensor.h"
@@ -147,6 +148,9 @@ class FCI_MO : public ActiveSpaceMethod {
                                                          int root1, int root2);
     bool check_density_files_fcimo(int rdm_level, int irrep, int multi, int root1, int root2);
     void remove_density_files_fcimo(int rdm_level, int irrep, int multi, int root1, int root2);
+    /// Read a density stored under a name returned by density_filenames_generator (from the
+    /// memory cache or from disk)
+    void load_density(const std::string& name, std::vector<double>& data);
 
     /// Generate density file names at a certain RDM level
     std::vector<std::string> generate_rdm_file_names(int rdm_level, int root1, int root2,
@@ -364,18 +368,17 @@ class FCI_MO : public ActiveSpaceMethod {
     /// Size of Singles Determinants
     size_t singles_size_;
 
-    /// Orbital Strings
-    std::vector<std::vector<std::vector<bool>>> Form_String(const int& active_elec,
-                                                            const bool& print = false);
-    std::vector<bool> Form_String_Ref(const bool& print = false);
-    std::vector<std::vector<std::vector<bool>>>
-    Form_String_Singles(const std::vector<bool>& ref_string, const bool& print = false);
-    std::vector<std::vector<std::vector<bool>>>
-    Form_String_Doubles(const std::vector<bool>& ref_string, const bool& print = false);
-    std::vector<std::vector<std::vector<bool>>> Form_String_IP(const std::vector<bool>& ref_string,
-                                                               const bool& print = false);
-    std::vector<std::vector<std::vector<bool>>> Form_String_EA(const std::vector<bool>& ref_string,
-                                                               const bool& print = false);
+    /// Orbital Strings (bit strings of the active orbitals, grouped by irrep)
+    std::vector<std::vector<String>> Form_String(const int& active_elec, const bool& print = false);
+    String Form_String_Ref(const bool& print = false);
+    std::vector<std::vector<String>> Form_String_Singles(const String& ref_string,
+                                                         const bool& print = false);
+    std::vector<std::vector<String>> Form_String_Doubles(const String& ref_string,
+                                                         const bool& print = false);
+    std::vector<std::vector<String>> Form_String_IP(const String& ref_string,
+                                                    const bool& print = false);
+    std::vector<std::vector<String>> Form_String_EA(const String& ref_string,
+                                                    const bool& print = false);
 
     /// State Average Information (tuple of irrep, multi, nstates, weights)
     std::vector<std::tuple<int, int, int, std::vector<double>>> sa_info_;
@@ -420,11 +423,28 @@ class FCI_MO : public ActiveSpaceMethod {
     ambit::Tensor L3abb_;
     ambit::Tensor L3bbb_;
 
-    /// File Names of Densities Stored on Disk
+    /// File Names of Densities Stored (in the memory cache or on disk)
     std::unordered_set<std::string> density_files_;
     bool safe_to_read_density_files_ = false;
     void clean_all_density_files();
 
+    /// Densities kept in memory, keyed by their file names
+    std::unordered_map<std::string, std::vector<double>> density_cache_;
+    /// The memory (in bytes) used by density_cache_
+    size_t density_cache_bytes_ = 0;
+    /// The maximum memory (in bytes) used by density_cache_
+    size_t density_cache_max_bytes_ = 1073741824;
+    /// Write the densities that do not fit in density_cache_ to disk?
+    bool density_cache_spill_ = true;
+    /// Store the densities in the memory cache or, if it is full, on disk
+    void store_densities(const std::vector<std::string>& names,
+                         std::vector<ambit::Tensor>& densities);
+    /// Read densities stored by store_densities
+    void load_densities(const std::vector<std::string>& names,
+                        std::vector<ambit::Tensor>& densities);
+    /// Remove a density from the memory cache or from disk
+    void remove_density(const std::string& name);
+
     /// Prepare eigen vectors for RDM or TRDM (within current symmetry) computations
     psi::SharedMatrix prepare_for_rdm();
 
@@ -508,9 +528,8 @@ class FCI_MO : public ActiveSpaceMethod {
     void print_det(const vecdet& dets);
 
     /// Print occupations of strings
-    void
-    print_occupation_strings_perirrep(std::string name,
-                                      const std::vector<std::vector<std::vector<bool>>>& string);
+    void print_occupation_strings_perirrep(std::string name,
+                                           const std::vector<std::vector<String>>& strings);
 };
 } // namespace forte
 
@@ -27,7 +27,12 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/vector.h"
@@ -58,6 +63,8 @@ MRPT2::MRPT2(std::shared_ptr<ForteOptions> options, std::shared_ptr<ActiveSpaceI
     //    print_method_banner(
     //        {"Deterministic MR-PT2", "Jeff Schriber"});
     mo_symmetry_ = mo_space_info_->symmetry("ACTIVE");
+    // all the couplings are included, so there is no screening threshold
+    excitation_generator_ = std::make_shared<ExcitationGenerator>(as_ints_, mo_symmetry_, 0.0);
 }
 
 MRPT2::~MRPT2() {}
@@ -67,11 +74,22 @@ std::vector<double> MRPT2::compute_energy() {
                     reference_.size());
 
     std::vector<double> pt2_en;
+    pt2_error_.clear();
 
     local_timer en;
+    const bool stochastic = options_->get_bool("PT2_STOCHASTIC");
     for (int n = 0; n < nroot_; ++n) {
-        pt2_en.push_back(compute_pt2_energy(n));
-        outfile->Printf("\n  Root %d PT2 energy:  %1.12f", n, pt2_en[n]);
+        if (stochastic) {
+            outfile->Printf("\n\n  Semistochastic PT2 for root %d", n);
+            auto [energy, error] = compute_semistochastic_energy(n);
+            pt2_en.push_back(energy);
+            pt2_error_.push_back(error);
+            outfile->Printf("\n  Root %d PT2 energy:  %1.12f +/- %.3e", n, energy, error);
+        } else {
+            pt2_en.push_back(compute_pt2_energy(n));
+            pt2_error_.push_back(0.0);
+            outfile->Printf("\n  Root %d PT2 energy:  %1.12f", n, pt2_en[n]);
+        }
     }
     //  double scalar = as_ints_->scalar_energy() + molecule_->nuclear_repulsion_energy();
     //  double energy = pt2_energy + scalar + evals_->get(0);
@@ -82,8 +100,14 @@ std::vector<double> MRPT2::compute_energy() {
 }
 
 double MRPT2::compute_pt2_energy(int root) {
+    std::vector<size_t> dets(reference_.size());
+    std::iota(dets.begin(), dets.end(), 0);
+    return compute_deterministic_energy(root, dets);
+}
+
+double MRPT2::compute_deterministic_energy(int root, const std::vector<size_t>& dets) {
     double energy = 0.0;
-    const size_t n_dets = reference_.size();
+    const size_t n_dets = dets.size();
     int nmo = as_ints_->nmo();
     double max_mem = options_->get_double("PT2_MAX_MEM");
 
@@ -114,172 +138,174 @@ double MRPT2::compute_pt2_energy(int root) {
         int end_idx = start_idx + batch_size;
 
         for (int bin = start_idx; bin < end_idx; ++bin) {
-            energy += energy_kernel(bin, nbin, root);
+            energy += energy_kernel(bin, nbin, root, dets);
         }
     }
     return energy;
 }
 
-double MRPT2::energy_kernel(int bin, int nbin, int root) {
-    size_t nact = mo_space_info_->size("ACTIVE");
-    double E_0 = evals_->get(root);
-    double energy = 0.0;
+std::pair<double, double> MRPT2::compute_semistochastic_energy(int root) {
     const size_t n_dets = reference_.size();
-    const det_hashvec& dets = reference_.wfn_hash();
-    det_hash<double> A_I;
+    const double weight = options_->get_double("PT2_DETERMINISTIC_WEIGHT");
+    const int nsample = options_->get_int("PT2_STOCHASTIC_NSAMPLE");
+    const int batch_size = options_->get_int("PT2_STOCHASTIC_BATCH_SIZE");
+    const int max_samples = options_->get_int("PT2_STOCHASTIC_MAX_SAMPLES");
+    const double target_error = options_->get_double("PT2_STOCHASTIC_ERROR");
+    const int seed = options_->get_int("PT2_STOCHASTIC_SEED");
+    if ((nsample < 2) or (batch_size < 1) or (max_samples < 2)) {
+        throw std::runtime_error("MRPT2: PT2_STOCHASTIC_NSAMPLE and PT2_STOCHASTIC_MAX_SAMPLES "
+                                 "must be at least 2 and PT2_STOCHASTIC_BATCH_SIZE at least 1");
+    }
+
+    // The deterministic space contains the determinants with the largest coefficients that
+    // account for a fraction weight of the norm of the reference
+    std::vector<size_t> order(n_dets);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t I, size_t J) {
+        return std::fabs(evecs_->get(I, root)) > std::fabs(evecs_->get(J, root));
+    });
+    double norm = 0.0;
     for (size_t I = 0; I < n_dets; ++I) {
-        double c_I = evecs_->get(I, root);
-        const Determinant& det = dets[I];
-        std::vector<int> aocc = det.get_alfa_occ(nact);
-        std::vector<int> bocc = det.get_beta_occ(nact);
-        std::vector<int> avir = det.get_alfa_vir(nact);
-        std::vector<int> bvir = det.get_beta_vir(nact);
-
-        int noalpha = aocc.size();
-        int nobeta = bocc.size();
-        int nvalpha = avir.size();
-        int nvbeta = bvir.size();
-        Determinant new_det(det);
-
-        // Generate alpha excitations
-        for (int i = 0; i < noalpha; ++i) {
-            int ii = aocc[i];
-            for (int a = 0; a < nvalpha; ++a) {
-                int aa = avir[a];
-                if ((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) {
-                    new_det = det;
-                    new_det.set_alfa_bit(ii, false);
-                    new_det.set_alfa_bit(aa, true);
-                    if (reference_.has_det(new_det))
-                        continue;
-
-                    // Check if the determinant goes in this bin
-                    size_t hash_val = Determinant::Hash()(new_det);
-                    if ((hash_val % nbin) == bin) {
-                        double coupling =
-                            as_ints_->slater_rules_single_alpha(new_det, ii, aa) * c_I;
-                        if (A_I.find(new_det) != A_I.end()) {
-                            coupling += A_I[new_det];
-                        }
-                        A_I[new_det] = coupling;
-                    }
-                }
-            }
-        }
-        // Generate beta excitations
-        for (int i = 0; i < nobeta; ++i) {
-            int ii = bocc[i];
-            for (int a = 0; a < nvbeta; ++a) {
-                int aa = bvir[a];
-                if ((mo_symmetry_[ii] ^ mo_symmetry_[aa]) == 0) {
-                    new_det = det;
-                    new_det.set_beta_bit(ii, false);
-                    new_det.set_beta_bit(aa, true);
-                    if (reference_.has_det(new_det))
-                        continue;
-                    // Check if the determinant goes in this bin
-                    size_t hash_val = Determinant::Hash()(new_det);
-                    if ((hash_val % nbin) == bin) {
-                        double coupling = as_ints_->slater_rules_single_beta(new_det, ii, aa) * c_I;
-                        if (A_I.find(new_det) != A_I.end()) {
-                            coupling += A_I[new_det];
-                        }
-                        A_I[new_det] = coupling;
-                    }
-                }
-            }
-        }
-        // Generate ab excitations
-        for (int i = 0; i < noalpha; ++i) {
-            int ii = aocc[i];
-            for (int j = 0; j < nobeta; ++j) {
-                int jj = bocc[j];
-                for (int a = 0; a < nvalpha; ++a) {
-                    int aa = avir[a];
-                    for (int b = 0; b < nvbeta; ++b) {
-                        int bb = bvir[b];
-                        if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                             mo_symmetry_[bb]) == 0) {
-                            new_det = det;
-                            double sign = new_det.double_excitation_ab(ii, jj, aa, bb);
-                            if (reference_.has_det(new_det))
-                                continue;
-
-                            // Check if the determinant goes in this bin
-                            size_t hash_val = Determinant::Hash()(new_det);
-                            if ((hash_val % nbin) == bin) {
-
-                                double coupling = sign * c_I * as_ints_->tei_ab(ii, jj, aa, bb);
-                                if (A_I.find(new_det) != A_I.end()) {
-                                    coupling += A_I[new_det];
-                                }
-                                A_I[new_det] = coupling;
-                            }
-                        }
-                    }
-                }
+        norm += evecs_->get(I, root) * evecs_->get(I, root);
+    }
+    std::vector<size_t> det_space;
+    std::vector<bool> in_det_space(n_dets, false);
+    double det_norm = 0.0;
+    for (size_t I : order) {
+        if (det_norm >= weight * norm)
+            break;
+        det_norm += evecs_->get(I, root) * evecs_->get(I, root);
+        det_space.push_back(I);
+        in_det_space[I] = true;
+    }
+    outfile->Printf("\n  Deterministic space: %zu determinants (%.6f of the norm)",
+                    det_space.size(), det_norm / norm);
+
+    local_timer t_det;
+    const double E_det = det_space.empty() ? 0.0 : compute_deterministic_energy(root, det_space);
+    outfile->Printf("\n  Deterministic PT2 energy:  %1.12f (%.3f s)", E_det, t_det.get());
+    if (det_space.size() == n_dets) {
+        return std::make_pair(E_det, 0.0);
+    }
+
+    // The determinants are sampled with probability proportional to the absolute value of their
+    // coefficient
+    std::vector<double> prob(n_dets);
+    double sum_abs = 0.0;
+    for (size_t I = 0; I < n_dets; ++I) {
+        prob[I] = std::fabs(evecs_->get(I, root));
+        sum_abs += prob[I];
+    }
+    for (auto& p : prob) {
+        p /= sum_abs;
+    }
+    const std::discrete_distribution<size_t> distribution(prob.begin(), prob.end());
+
+    // Each sample is computed with its own random number generator, so the samples do not
+    // depend on the number of threads
+    outfile->Printf("\n\n    Samples   Stochastic PT2       Error        Time (s)");
+    outfile->Printf("\n  -------------------------------------------------------");
+    std::vector<double> samples;
+    double mean = 0.0;
+    double error = 0.0;
+    local_timer t_sto;
+    while (static_cast<int>(samples.size()) < max_samples) {
+        const int first = samples.size();
+        const int nbatch = std::min(batch_size, max_samples - first);
+        std::vector<double> batch(nbatch);
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int k = 0; k < nbatch; ++k) {
+            std::seed_seq seq{seed, root, first + k};
+            std::mt19937_64 gen(seq);
+            auto dist = distribution;
+            det_hash<int> counts;
+            for (int n = 0; n < nsample; ++n) {
+                counts[reference_.wfn_hash()[dist(gen)]]++;
             }
+            batch[k] = stochastic_kernel(root, nsample, counts, prob, in_det_space);
         }
-        // Generate aa excitations
-        for (int i = 0; i < noalpha; ++i) {
-            int ii = aocc[i];
-            for (int j = i + 1; j < noalpha; ++j) {
-                int jj = aocc[j];
-                for (int a = 0; a < nvalpha; ++a) {
-                    int aa = avir[a];
-                    for (int b = a + 1; b < nvalpha; ++b) {
-                        int bb = avir[b];
-                        if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                             mo_symmetry_[bb]) == 0) {
-                            new_det = det;
-                            double sign = new_det.double_excitation_aa(ii, jj, aa, bb);
-                            if (reference_.has_det(new_det))
-                                continue;
-
-                            // Check if the determinant goes in this bin
-                            size_t hash_val = Determinant::Hash()(new_det);
-                            if ((hash_val % nbin) == bin) {
-                                double coupling = sign * c_I * as_ints_->tei_aa(ii, jj, aa, bb);
-                                if (A_I.find(new_det) != A_I.end()) {
-                                    coupling += A_I[new_det];
-                                }
-                                A_I[new_det] = coupling;
-                            }
-                        }
-                    }
-                }
-            }
+        samples.insert(samples.end(), batch.begin(), batch.end());
+
+        const double nsamples = samples.size();
+        mean = std::accumulate(samples.begin(), samples.end(), 0.0) / nsamples;
+        double var = 0.0;
+        for (double x : samples) {
+            var += (x - mean) * (x - mean);
         }
-        // Generate bb excitations
-        for (int i = 0; i < nobeta; ++i) {
-            int ii = bocc[i];
-            for (int j = i + 1; j < nobeta; ++j) {
-                int jj = bocc[j];
-                for (int a = 0; a < nvbeta; ++a) {
-                    int aa = bvir[a];
-                    for (int b = a + 1; b < nvbeta; ++b) {
-                        int bb = bvir[b];
-                        if ((mo_symmetry_[ii] ^ mo_symmetry_[jj] ^ mo_symmetry_[aa] ^
-                             mo_symmetry_[bb]) == 0) {
-                            new_det = det;
-                            double sign = new_det.double_excitation_bb(ii, jj, aa, bb);
-                            if (reference_.has_det(new_det))
-                                continue;
-
-                            // Check if the determinant goes in this bin
-                            size_t hash_val = Determinant::Hash()(new_det);
-                            if ((hash_val % nbin) == bin) {
-                                double coupling = sign * c_I * as_ints_->tei_bb(ii, jj, aa, bb);
-                                if (A_I.find(new_det) != A_I.end()) {
-                                    coupling += A_I[new_det];
-                                }
-                                A_I[new_det] = coupling;
-                            }
-                        }
-                    }
+        error = nsamples > 1 ? std::sqrt(var / (nsamples * (nsamples - 1.0))) : 0.0;
+        outfile->Printf("\n    %7zu  %16.12f  %12.3e  %11.3f", samples.size(), mean, error,
+                        t_sto.get());
+        if ((samples.size() > 1) and (error < target_error))
+            break;
+    }
+    outfile->Printf("\n  -------------------------------------------------------");
+    if (error >= target_error) {
+        outfile->Printf("\n  Warning: the target error (%.3e Eh) was not reached with %zu samples",
+                        target_error, samples.size());
+    }
+    return std::make_pair(E_det + mean, error);
+}
+
+double MRPT2::stochastic_kernel(int root, int nsample, const det_hash<int>& counts,
+                                const std::vector<double>& prob,
+                                const std::vector<bool>& in_det_space) {
+    const double E_0 = evals_->get(root);
+    const double Nd = nsample;
+
+    // For each external determinant a accumulate the sums over the sampled determinants I of
+    // w_I c_I H_aI / p_I and of (w_I (Nd - 1) / p_I - w_I^2 / p_I^2) c_I^2 H_aI^2, for all the
+    // sampled determinants and for those in the deterministic space
+    det_hash<std::array<double, 4>> A_I;
+    ExcitationGenerator::Workspace ws;
+    for (const auto& [det, w_I] : counts) {
+        const size_t I = reference_.get_idx(det);
+        const double c_I = evecs_->get(I, root);
+        const double p_I = prob[I];
+        const double w = w_I;
+        const double f1 = w * c_I / p_I;
+        const double f2 = (w * (Nd - 1.0) / p_I - w * w / (p_I * p_I)) * c_I * c_I;
+        const bool det_I = in_det_space[I];
+        excitation_generator_->for_each_excitation(
+            det, 1.0, ws,
+            [&](const Determinant& new_det) { return not reference_.has_det(new_det); },
+            [&](const Determinant& new_det, double H_aI, int, int) {
+                auto& sums = A_I[new_det];
+                sums[0] += f1 * H_aI;
+                sums[1] += f2 * H_aI * H_aI;
+                if (det_I) {
+                    sums[2] += f1 * H_aI;
+                    sums[3] += f2 * H_aI * H_aI;
                 }
-            }
-        }
+            });
+    }
+
+    // The estimator of the PT2 energy minus that of the deterministic part
+    double energy = 0.0;
+    for (const auto& [det, sums] : A_I) {
+        const double numerator = sums[0] * sums[0] + sums[1] - sums[2] * sums[2] - sums[3];
+        energy += numerator / (E_0 - as_ints_->energy(det));
+    }
+    return energy / (Nd * (Nd - 1.0));
+}
+
+double MRPT2::energy_kernel(int bin, int nbin, int root, const std::vector<size_t>& dets) {
+    double E_0 = evals_->get(root);
+    double energy = 0.0;
+    const det_hashvec& ref_dets = reference_.wfn_hash();
+    det_hash<double> A_I;
+    // Accept the external determinants that belong to this bin
+    auto in_bin = [&](const Determinant& new_det) {
+        if (reference_.has_det(new_det))
+            return false;
+        size_t hash_val = Determinant::Hash()(new_det);
+        return (hash_val % nbin) == static_cast<size_t>(bin);
+    };
+    ExcitationGenerator::Workspace ws;
+    for (size_t I : dets) {
+        const double c_I = evecs_->get(I, root);
+        excitation_generator_->for_each_excitation(
+            ref_dets[I], 1.0, ws, in_bin,
+            [&](const Determinant& new_det, double H_aI, int, int) { A_I[new_det] += H_aI * c_I; });
     }
 
     for (auto& det : A_I) {
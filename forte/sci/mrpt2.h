@@ -34,6 +34,7 @@
 #include "integrals/active_space_integrals.h"
 #include "sparse_ci/determinant_hashvector.h"
 #include "sparse_ci/determinant_substitution_lists.h"
+#include "sci/excitation_generator.h"
 
 namespace forte {
 
@@ -56,6 +57,9 @@ class MRPT2 {
     // Computes the PT2 energy correction
     std::vector<double> compute_energy();
 
+    // The statistical error of the PT2 energy of each root (zero if computed deterministically)
+    const std::vector<double>& pt2_error() const { return pt2_error_; }
+
   private:
     // The active space integrals
     std::shared_ptr<ActiveSpaceIntegrals> as_ints_;
@@ -69,14 +73,31 @@ class MRPT2 {
     psi::SharedVector evals_;
     // the orbital symmetry labels
     std::vector<int> mo_symmetry_;
+    // The generator of the excited determinants
+    std::shared_ptr<ExcitationGenerator> excitation_generator_;
     // Number of reference roots
     int nroot_;
+    // The statistical error of the PT2 energy of each root
+    std::vector<double> pt2_error_;
 
     // Computes the total energy correction for a given root
     double compute_pt2_energy(int root);
+    // Computes the energy correction for a given root from a subset of the reference
+    // determinants
+    double compute_deterministic_energy(int root, const std::vector<size_t>& dets);
+    // Computes the energy correction for a given root as the sum of the deterministic energy of
+    // the reference determinants with the largest coefficients and a stochastic estimate of the
+    // remainder. Returns the energy and its statistical error
+    std::pair<double, double> compute_semistochastic_energy(int root);
+    // Computes one sample of the stochastic estimate of the energy not included in the
+    // deterministic part. counts contains the number of times each reference determinant was
+    // drawn out of nsample, and prob the probability of drawing each determinant
+    double stochastic_kernel(int root, int nsample, const det_hash<int>& counts,
+                             const std::vector<double>& prob,
+                             const std::vector<bool>& in_det_space);
     // Computes the energy contribution from a subset of excited
     // determinants
-    double energy_kernel(int bin, int nbin, int root);
+    double energy_kernel(int bin, int nbin, int root, const std::vector<size_t>& dets);
 };
 } // namespace forte
 
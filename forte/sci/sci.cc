@@ -28,6 +28,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/matrix.h"
@@ -36,6 +37,7 @@
 
 #include "helpers/timer.h"
 #include "sparse_ci/sparse_ci_solver.h"
+#include "sci_checkpoint.h"
 #include "sci.h"
 
 namespace forte {
@@ -81,6 +83,9 @@ void SelectedCIMethod::base_startup() {
     spin_complete_ = options_->get_bool("SCI_ENFORCE_SPIN_COMPLETE");
     spin_complete_P_ = options_->get_bool("SCI_ENFORCE_SPIN_COMPLETE_P");
     project_out_spin_contaminants_ = options_->get_bool("SCI_PROJECT_OUT_SPIN_CONTAMINANTS");
+    write_checkpoint_ = options_->get_bool("SCI_CHECKPOINT");
+    restart_ = options_->get_str("SCI_RESTART");
+    checkpoint_filename_ = options_->get_str("SCI_CHECKPOINT_FILE");
 }
 
 double SelectedCIMethod::compute_energy() {
@@ -92,7 +97,31 @@ double SelectedCIMethod::compute_energy() {
     // Pre-iter Preparation
     pre_iter_preparation();
 
-    for (cycle_ = 0; cycle_ < max_cycle_; ++cycle_) {
+    // Restart from a checkpoint (replaces the initial P space)
+    size_t first_cycle = 0;
+    if ((restart_ != "NONE") and (not one_cycle_)) {
+        bool resume = (restart_ == "RESUME");
+        SCICheckpoint checkpoint = read_sci_checkpoint(checkpoint_filename_);
+        if ((checkpoint.nact == nact_) and load_checkpoint(checkpoint, resume)) {
+            first_cycle = resume ? checkpoint.cycle : 0;
+            psi::outfile->Printf("\n  Read %zu determinants from the checkpoint file %s",
+                                 checkpoint.dets.size(), checkpoint_filename_.c_str());
+            if (resume)
+                psi::outfile->Printf("\n  Resuming the calculation at cycle %zu", first_cycle);
+        } else {
+            psi::outfile->Printf("\n  The checkpoint file %s does not match this calculation. It "
+                                 "will not be used.",
+                                 checkpoint_filename_.c_str());
+        }
+    } else if (guess_ and (not one_cycle_)) {
+        if ((guess_->nact == nact_) and load_checkpoint(*guess_, false)) {
+            psi::outfile->Printf("\n  Initial P space: %zu determinants from a previous guess",
+                                 guess_->dets.size());
+        }
+    }
+    guess_.reset();
+
+    for (cycle_ = first_cycle; cycle_ < max_cycle_; ++cycle_) {
 
         // Step 1. Diagonalize the Hamiltonian in the P space
         diagonalize_P_space();
@@ -109,6 +138,14 @@ double SelectedCIMethod::compute_energy() {
 
         // Step 5. Prune the P + Q space to get an updated P space
         prune_PQ_to_P();
+
+        if (write_checkpoint_) {
+            SCICheckpoint checkpoint;
+            checkpoint.cycle = cycle_ + 1;
+            checkpoint.nact = nact_;
+            save_checkpoint(checkpoint);
+            write_sci_checkpoint(checkpoint_filename_, checkpoint);
+        }
     }
 
     if (one_cycle_) {
@@ -120,6 +157,42 @@ double SelectedCIMethod::compute_energy() {
     return 0.0;
 }
 
+void SelectedCIMethod::save_checkpoint(SCICheckpoint&) {
+    throw std::runtime_error("SelectedCIMethod::save_checkpoint: this selected CI method does not "
+                             "support checkpoints (SCI_CHECKPOINT)");
+}
+
+bool SelectedCIMethod::load_checkpoint(const SCICheckpoint&, bool) {
+    throw std::runtime_error("SelectedCIMethod::load_checkpoint: this selected CI method does not "
+                             "support restarts (SCI_RESTART)");
+}
+
+void SelectedCIMethod::store_P_space(SCICheckpoint& checkpoint, const DeterminantHashVec& P_space,
+                                     const DeterminantHashVec& PQ_space, psi::SharedMatrix PQ_evecs,
+                                     size_t nroot) const {
+    size_t ndets = P_space.size();
+    checkpoint.nroot = nroot;
+    checkpoint.dets = P_space.determinants();
+    checkpoint.coefficients.assign(ndets * nroot, 0.0);
+    for (size_t I = 0; I < ndets; ++I) {
+        size_t idx = PQ_space.get_idx(checkpoint.dets[I]);
+        for (size_t n = 0; n < nroot; ++n) {
+            checkpoint.coefficients[n * ndets + I] = PQ_evecs->get(idx, n);
+        }
+    }
+}
+
+psi::SharedMatrix SelectedCIMethod::checkpoint_evecs(const SCICheckpoint& checkpoint) const {
+    size_t ndets = checkpoint.dets.size();
+    auto evecs = std::make_shared<psi::Matrix>("P evecs", ndets, checkpoint.nroot);
+    for (size_t I = 0; I < ndets; ++I) {
+        for (size_t n = 0; n < checkpoint.nroot; ++n) {
+            evecs->set(I, n, checkpoint.coefficients[n * ndets + I]);
+        }
+    }
+    return evecs;
+}
+
 size_t SelectedCIMethod::get_cycle() { return cycle_; }
 
 SigmaVectorType SelectedCIMethod::sigma_vector_type() const { return sigma_vector_type_; }
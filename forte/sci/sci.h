@@ -52,6 +52,7 @@ class MOSpaceInfo;
 class Reference;
 class SCFInfo;
 class SparseCISolver;
+struct SCICheckpoint;
 
 class SelectedCIMethod {
   public:
@@ -90,6 +91,17 @@ class SelectedCIMethod {
     /// Post-iter process
     virtual void post_iter_process() = 0;
 
+    // Checkpoint interface (optional)
+    /// Store the current P space and the data needed to resume the next cycle. The base class
+    /// sets the cycle and the number of active orbitals.
+    virtual void save_checkpoint(SCICheckpoint& checkpoint);
+    /// Restore the P space from a checkpoint. If resume is false, only the determinants are used
+    /// as an initial guess. Returns false if the checkpoint cannot be used by this calculation.
+    virtual bool load_checkpoint(const SCICheckpoint& checkpoint, bool resume);
+    /// Use the P space of a checkpoint as the initial guess of the next compute_energy() call
+    /// (e.g., the P space of the previous MCSCF macro iteration)
+    void set_initial_guess(std::shared_ptr<SCICheckpoint> checkpoint) { guess_ = checkpoint; }
+
     // Temporarily added interface to ExcitedStateSolver
     /// Set the class variable
     virtual void set_method_variables(
@@ -105,6 +117,13 @@ class SelectedCIMethod {
     virtual size_t get_cycle();
 
     void base_startup();
+    /// Copy the determinants of a P space, and their coefficients in a P + Q space, to a checkpoint
+    void store_P_space(SCICheckpoint& checkpoint, const DeterminantHashVec& P_space,
+                       const DeterminantHashVec& PQ_space, std::shared_ptr<psi::Matrix> PQ_evecs,
+                       size_t nroot) const;
+    /// Return the coefficients stored in a checkpoint as a (number of determinants) x (number of
+    /// roots) matrix
+    std::shared_ptr<psi::Matrix> checkpoint_evecs(const SCICheckpoint& checkpoint) const;
     void print_wfn(DeterminantHashVec& space, std::shared_ptr<psi::Matrix> evecs, int nroot,
                    size_t max_dets_to_print = 20);
 
@@ -158,6 +177,15 @@ class SelectedCIMethod {
     /// Control amount of printing
     bool quiet_mode_;
 
+    /// Write a checkpoint at the end of each cycle?
+    bool write_checkpoint_ = false;
+    /// The restart mode (NONE, RESUME, or GUESS)
+    std::string restart_;
+    /// The name of the checkpoint file
+    std::string checkpoint_filename_;
+    /// The initial guess of the P space (used once, ignored when restarting from a file)
+    std::shared_ptr<SCICheckpoint> guess_;
+
     /// Add missing degenerate determinants excluded from the aimed selection?
     bool project_out_spin_contaminants_;
 
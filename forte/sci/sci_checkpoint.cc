@@ -0,0 +1,151 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "sci_checkpoint.h"
+
+namespace forte {
+
+namespace {
+/// The file signature and format version
+constexpr char sci_checkpoint_magic[8] = {'F', 'O', 'R', 'T', 'E', 'S', 'C', 'I'};
+constexpr uint64_t sci_checkpoint_version = 1;
+
+/// The fields of the header, after the signature
+enum SCICheckpointHeader : size_t {
+    Version,
+    DetBytes,
+    Nact,
+    Cycle,
+    Root,
+    Nroot,
+    Ndets,
+    Nparams,
+    Nhistory,
+    HeaderSize
+};
+
+static_assert(sizeof(Determinant) % sizeof(uint64_t) == 0,
+              "The determinants are not 8-byte aligned in the checkpoint file");
+} // namespace
+
+void write_sci_checkpoint(const std::string& filename, const SCICheckpoint& checkpoint) {
+    size_t ndets = checkpoint.dets.size();
+    if (checkpoint.coefficients.size() != ndets * checkpoint.nroot) {
+        throw std::runtime_error("write_sci_checkpoint: the number of coefficients does not match "
+                                 "the number of determinants and roots");
+    }
+    uint64_t header[HeaderSize];
+    header[Version] = sci_checkpoint_version;
+    header[DetBytes] = sizeof(Determinant);
+    header[Nact] = checkpoint.nact;
+    header[Cycle] = checkpoint.cycle;
+    header[Root] = checkpoint.root;
+    header[Nroot] = checkpoint.nroot;
+    header[Ndets] = ndets;
+    header[Nparams] = checkpoint.parameters.size();
+    header[Nhistory] = checkpoint.energy_history.size();
+
+    // write to a temporary file first, so that an interrupted write does not corrupt a checkpoint
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream out(tmp_filename, std::ios_base::binary);
+    out.write(sci_checkpoint_magic, sizeof(sci_checkpoint_magic));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(checkpoint.dets.data()), ndets * sizeof(Determinant));
+    out.write(reinterpret_cast<const char*>(checkpoint.coefficients.data()),
+              checkpoint.coefficients.size() * sizeof(double));
+    out.write(reinterpret_cast<const char*>(checkpoint.parameters.data()),
+              checkpoint.parameters.size() * sizeof(double));
+    // the energy history is stored as the length of each row followed by all the energies
+    for (const auto& energies : checkpoint.energy_history) {
+        uint64_t n = energies.size();
+        out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    }
+    for (const auto& energies : checkpoint.energy_history) {
+        out.write(reinterpret_cast<const char*>(energies.data()), energies.size() * sizeof(double));
+    }
+    out.close();
+    if (not out or (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)) {
+        throw std::runtime_error("write_sci_checkpoint: cannot write " + filename);
+    }
+}
+
+SCICheckpoint read_sci_checkpoint(const std::string& filename) {
+    std::ifstream in(filename, std::ios_base::binary);
+    if (not in.good()) {
+        throw std::runtime_error("read_sci_checkpoint: cannot open " + filename);
+    }
+    char magic[sizeof(sci_checkpoint_magic)];
+    uint64_t header[HeaderSize];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (not in or (std::memcmp(magic, sci_checkpoint_magic, sizeof(magic)) != 0) or
+        (header[Version] != sci_checkpoint_version)) {
+        throw std::runtime_error("read_sci_checkpoint: " + filename +
+                                 " is not a selected CI checkpoint file");
+    }
+    if (header[DetBytes] != sizeof(Determinant)) {
+        throw std::runtime_error("read_sci_checkpoint: " + filename +
+                                 " was written by a build of Forte with a different MAX_DET_ORB");
+    }
+
+    SCICheckpoint checkpoint;
+    checkpoint.nact = header[Nact];
+    checkpoint.cycle = header[Cycle];
+    checkpoint.root = header[Root];
+    checkpoint.nroot = header[Nroot];
+    size_t ndets = header[Ndets];
+    checkpoint.dets.resize(ndets);
+    checkpoint.coefficients.resize(ndets * checkpoint.nroot);
+    checkpoint.parameters.resize(header[Nparams]);
+    in.read(reinterpret_cast<char*>(checkpoint.dets.data()), ndets * sizeof(Determinant));
+    in.read(reinterpret_cast<char*>(checkpoint.coefficients.data()),
+            checkpoint.coefficients.size() * sizeof(double));
+    in.read(reinterpret_cast<char*>(checkpoint.parameters.data()),
+            checkpoint.parameters.size() * sizeof(double));
+    std::vector<uint64_t> history_sizes(header[Nhistory]);
+    in.read(reinterpret_cast<char*>(history_sizes.data()), history_sizes.size() * sizeof(uint64_t));
+    for (uint64_t n : history_sizes) {
+        if (not in)
+            break;
+        std::vector<double> energies(n);
+        in.read(reinterpret_cast<char*>(energies.data()), n * sizeof(double));
+        checkpoint.energy_history.push_back(std::move(energies));
+    }
+    if (not in) {
+        throw std::runtime_error("read_sci_checkpoint: cannot read " + filename);
+    }
+    return checkpoint;
+}
+
+} // namespace forte
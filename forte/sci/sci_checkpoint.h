@@ -0,0 +1,79 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _sci_checkpoint_h_
+#define _sci_checkpoint_h_
+
+#include <string>
+#include <vector>
+
+#include "sparse_ci/determinant.h"
+
+namespace forte {
+
+/**
+ * @brief The state of a selected CI calculation at the end of a cycle
+ *
+ * A checkpoint stores the pruned P space, its coefficients, the energy history, and a few
+ * method-specific parameters (e.g., the selection threshold sigma). It is enough to resume an
+ * interrupted calculation at the next cycle, or to seed the P space of a new calculation (e.g.,
+ * at the next geometry of a scan).
+ *
+ * The file is a header of 64-bit integers followed by the raw arrays (determinants,
+ * coefficients, parameters, energy history). Every section is a multiple of 8 bytes, so the
+ * arrays are aligned and the file can be memory-mapped.
+ */
+struct SCICheckpoint {
+    /// The number of cycles completed (the cycle to resume from)
+    size_t cycle = 0;
+    /// The number of active orbitals
+    size_t nact = 0;
+    /// The root targeted by the calculation (see ExcitedStateSolver)
+    size_t root = 0;
+    /// The number of roots stored in the coefficients
+    size_t nroot = 0;
+    /// The determinants of the P space
+    std::vector<Determinant> dets;
+    /// The coefficients of the P space, stored as coefficients[n * dets.size() + I]
+    std::vector<double> coefficients;
+    /// The parameters of the selection (the meaning is defined by each method)
+    std::vector<double> parameters;
+    /// The energies of each cycle
+    std::vector<std::vector<double>> energy_history;
+};
+
+/// Write a checkpoint to a file. The file is replaced atomically.
+void write_sci_checkpoint(const std::string& filename, const SCICheckpoint& checkpoint);
+
+/// Read a checkpoint from a file. Throws if the file cannot be read or is not compatible with
+/// this build (e.g., it was written with a different MAX_DET_ORB)
+SCICheckpoint read_sci_checkpoint(const std::string& filename);
+
+} // namespace forte
+
+#endif // _sci_checkpoint_h_
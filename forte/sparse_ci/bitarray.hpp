@@ -33,6 +33,7 @@
 #include <array>
 
 #include "bitwise_operations.hpp"
+#include "bitarray_simd.hpp"
 
 namespace forte {
 
@@ -48,6 +49,9 @@ namespace forte {
  *
  *        BirArray = |--64 bits--| |--64 bits--| |--64 bits--| ...
  *                       word[0]       word[1]       word[2]
+ *
+ *        For N = 256 and 512 the comparisons, bitwise operations, and bit counts use the
+ *        AVX2/AVX-512 kernels in bitarray_simd.hpp when these instructions are enabled.
  */
 template <size_t N> class BitArray {
   public:
@@ -74,6 +78,9 @@ template <size_t N> class BitArray {
     /// the number of words used to store the bits
     static constexpr size_t nwords_ = bits_to_words(nbits);
 
+    /// are the words processed with vector instructions?
+    static constexpr bool simd_ = bitarray_simd::enabled(nwords_);
+
     // get the value of bit in position pos
     bool get_bit(size_t pos) const { return this->getword(pos) & maskbit(pos); }
 
@@ -85,6 +92,9 @@ template <size_t N> class BitArray {
     /// set a word in position pos
     void set_word(size_t pos, word_t word) { words_[pos] = word; }
 
+    /// get the word in position pos
+    word_t get_word(size_t pos) const { return words_[pos]; }
+
     /// return the number of bits
     size_t get_nbits() const { return nbits; }
 
@@ -112,6 +122,8 @@ template <size_t N> class BitArray {
             return (this->words_[0] == lhs.words_[0]);
         } else if constexpr (N == 128) {
             return ((this->words_[0] == lhs.words_[0]) and (this->words_[1] == lhs.words_[1]));
+        } else if constexpr (simd_) {
+            return bitarray_simd::equal<nwords_>(words_.data(), lhs.words_.data());
         } else if constexpr (N == 192) {
             return ((this->words_[0] == lhs.words_[0]) and (this->words_[1] == lhs.words_[1]) and
                     (this->words_[2] == lhs.words_[2]));
@@ -175,16 +187,26 @@ template <size_t N> class BitArray {
     /// Bitwise OR operator (|)
     BitArray<N> operator|(const BitArray<N>& lhs) const {
         BitArray<N> result;
-        for (size_t n = 0; n < nwords_; n++) {
-            result.words_[n] = words_[n] | lhs.words_[n];
+        if constexpr (simd_) {
+            bitarray_simd::binary_op<nwords_, bitarray_simd::Op::Or>(
+                words_.data(), lhs.words_.data(), result.words_.data());
+        } else {
+            for (size_t n = 0; n < nwords_; n++) {
+                result.words_[n] = words_[n] | lhs.words_[n];
+            }
         }
         return result;
     }
 
     /// Bitwise OR operator (|=)
-    BitArray<N> operator|=(const BitArray<N>& lhs) const {
-        for (size_t n = 0; n < nwords_; n++) {
-            words_[n] |= lhs.words_[n];
+    BitArray<N> operator|=(const BitArray<N>& lhs) {
+        if constexpr (simd_) {
+            bitarray_simd::binary_op<nwords_, bitarray_simd::Op::Or>(
+                words_.data(), lhs.words_.data(), words_.data());
+        } else {
+            for (size_t n = 0; n < nwords_; n++) {
+                words_[n] |= lhs.words_[n];
+            }
         }
         return *this;
     }
@@ -192,16 +214,26 @@ template <size_t N> class BitArray {
     /// Bitwise XOR operator (^)
     BitArray<N> operator^(const BitArray<N>& lhs) const {
         BitArray<N> result;
-        for (size_t n = 0; n < nwords_; n++) {
-            result.words_[n] = words_[n] ^ lhs.words_[n];
+        if constexpr (simd_) {
+            bitarray_simd::binary_op<nwords_, bitarray_simd::Op::Xor>(
+                words_.data(), lhs.words_.data(), result.words_.data());
+        } else {
+            for (size_t n = 0; n < nwords_; n++) {
+                result.words_[n] = words_[n] ^ lhs.words_[n];
+            }
         }
         return result;
     }
 
     /// Bitwise XOR operator (^=)
     BitArray<N> operator^=(const BitArray<N>& lhs) {
-        for (size_t n = 0; n < nwords_; n++) {
-            words_[n] ^= lhs.words_[n];
+        if constexpr (simd_) {
+            bitarray_simd::binary_op<nwords_, bitarray_simd::Op::Xor>(
+                words_.data(), lhs.words_.data(), words_.data());
+        } else {
+            for (size_t n = 0; n < nwords_; n++) {
+                words_[n] ^= lhs.words_[n];
+            }
         }
         return *this;
     }
@@ -209,16 +241,26 @@ template <size_t N> class BitArray {
     /// Bitwise AND operator (&)
     BitArray<N> operator&(const BitArray<N>& lhs) const {
         BitArray<N> result;
-        for (size_t n = 0; n < nwords_; n++) {
-            result.words_[n] = words_[n] & lhs.words_[n];
+        if constexpr (simd_) {
+            bitarray_simd::binary_op<nwords_, bitarray_simd::Op::And>(
+                words_.data(), lhs.words_.data(), result.words_.data());
+        } else {
+            for (size_t n = 0; n < nwords_; n++) {
+                result.words_[n] = words_[n] & lhs.words_[n];
+            }
         }
         return result;
     }
 
     /// Bitwise AND operator (&=)
     BitArray<N> operator&=(const BitArray<N>& lhs) {
-        for (size_t n = 0; n < nwords_; n++) {
-            words_[n] &= lhs.words_[n];
+        if constexpr (simd_) {
+            bitarray_simd::binary_op<nwords_, bitarray_simd::Op::And>(
+                words_.data(), lhs.words_.data(), words_.data());
+        } else {
+            for (size_t n = 0; n < nwords_; n++) {
+                words_[n] &= lhs.words_[n];
+            }
         }
         return *this;
     }
@@ -226,22 +268,36 @@ template <size_t N> class BitArray {
     /// Bitwise difference operator (-)
     BitArray<N> operator-(const BitArray<N>& lhs) const {
         BitArray<N> result;
-        for (size_t n = 0; n < nwords_; n++) {
-            result.words_[n] = words_[n] & (~lhs.words_[n]);
+        if constexpr (simd_) {
+            bitarray_simd::binary_op<nwords_, bitarray_simd::Op::AndNot>(
+                words_.data(), lhs.words_.data(), result.words_.data());
+        } else {
+            for (size_t n = 0; n < nwords_; n++) {
+                result.words_[n] = words_[n] & (~lhs.words_[n]);
+            }
         }
         return result;
     }
 
     /// Bitwise difference operator (-=)
-    BitArray<N> operator-=(const BitArray<N>& lhs) const {
-        for (size_t n = 0; n < nwords_; n++) {
-            words_[n] &= ~lhs.words_[n];
+    BitArray<N> operator-=(const BitArray<N>& lhs) {
+        if constexpr (simd_) {
+            bitarray_simd::binary_op<nwords_, bitarray_simd::Op::AndNot>(
+                words_.data(), lhs.words_.data(), words_.data());
+        } else {
+            for (size_t n = 0; n < nwords_; n++) {
+                words_[n] &= ~lhs.words_[n];
+            }
         }
         return *this;
     }
 
     /// Count the number of bits set to true in the words included in the range [begin,end)
     int count(size_t begin = 0, size_t end = nwords_) const {
+        if constexpr (simd_) {
+            if ((begin == 0) and (end == nwords_))
+                return bitarray_simd::count<nwords_>(words_.data());
+        }
         int c = 0;
         for (; begin < end; ++begin) {
             c += ui64_bit_count(this->words_[begin]);
@@ -303,6 +359,10 @@ template <size_t N> class BitArray {
 
     /// Implements the operation: (a & b) == b
     bool fast_a_and_b_equal_b(const BitArray<N>& b) const {
+        if constexpr (simd_) {
+            // (a & b) == b is equivalent to b & ~a == 0
+            return bitarray_simd::andnot_eq_zero<nwords_>(b.words_.data(), words_.data());
+        }
         bool result = false;
         for (size_t n = 0; n < nwords_; n++) {
             result += ((words_[n] & b.words_[n]) != b.words_[n]);
@@ -312,20 +372,26 @@ template <size_t N> class BitArray {
 
     /// Implements the operation: a - b == 0
     bool fast_a_minus_b_eq_zero(const BitArray<N>& b) const {
-        bool result = false;
+        if constexpr (simd_) {
+            return bitarray_simd::andnot_eq_zero<nwords_>(words_.data(), b.words_.data());
+        }
+        word_t result = word_t(0);
         for (size_t n = 0; n < nwords_; n++) {
-            result += words_[n] & (~b.words_[n]);
+            result |= words_[n] & (~b.words_[n]);
         }
-        return not result;
+        return result == word_t(0);
     }
 
     /// Implements the operation: a & b == 0
     bool fast_a_and_b_eq_zero(const BitArray<N>& b) const {
-        bool result = false;
+        if constexpr (simd_) {
+            return bitarray_simd::and_eq_zero<nwords_>(words_.data(), b.words_.data());
+        }
+        word_t result = word_t(0);
         for (size_t n = 0; n < nwords_; n++) {
-            result += words_[n] & b.words_[n];
+            result |= words_[n] & b.words_[n];
         }
-        return not result;
+        return result == word_t(0);
     }
 
     /// Implements the operation: count(a ^ b)
@@ -345,27 +411,37 @@ template <size_t N> class BitArray {
                    ui64_bit_count(words_[2] ^ b.words_[2]) +
                    ui64_bit_count(words_[3] ^ b.words_[3]);
         } else {
-            int c = 0;
-            for (size_t n = 0; n < nwords_; n++) {
-                c += ui64_bit_count(words_[n] ^ b.words_[n]);
-            }
-            return c;
+            return bitarray_simd::xor_count<nwords_>(words_.data(), b.words_.data());
         }
     }
 
+    /// Implements the operation: count(a & b) % 2
+    int fast_a_and_b_parity(const BitArray<N>& b) const {
+        // the parity of the bits of several words is the parity of their XOR
+        word_t x = word_t(0);
+        for (size_t n = 0; n < nwords_; n++) {
+            x ^= words_[n] & b.words_[n];
+        }
+        return ui64_bit_count(x) & 1;
+    }
+
     /// Return the sign of a_n applied to this determinant
     /// This function ignores if bit n is set or not
     double slater_sign(int n) const {
         if constexpr (N == 64) {
             return ui64_sign(words_[0], n);
         } else {
+            // only the parity of the preceeding bits matters, and the parity of the bits of
+            // several words is the parity of their XOR, so we count the bits of a single word
             size_t count = 0;
             // count all the preceeding bits only if we are looking past the first word
             if (static_cast<size_t>(n) >= bits_per_word) {
                 size_t last_full_word = whichword(n);
+                word_t x = word_t(0);
                 for (size_t k = 0; k < last_full_word; ++k) {
-                    count += ui64_bit_count(words_[k]);
+                    x ^= words_[k];
                 }
+                count = ui64_bit_count(x);
             }
             return (count % 2 == 0) ? ui64_sign(getword(n), whichbit(n))
                                     : -ui64_sign(getword(n), whichbit(n));
@@ -410,11 +486,12 @@ template <size_t N> class BitArray {
             if (word_n == word_m) {
                 return ui64_sign(words_[word_n], whichbit(n), whichbit(m));
             }
-            size_t count = 0;
-            // count the number of bits in bitween the words of m and n
+            // count the number of bits in bitween the words of m and n (only the parity matters)
+            word_t x = word_t(0);
             for (size_t k = word_m + 1; k < word_n; ++k) {
-                count += ui64_bit_count(words_[k]);
+                x ^= words_[k];
             }
+            size_t count = ui64_bit_count(x);
             // count the bits after m in word[m]
             // count the bits before n in word[n]
             double sign = ui64_sign_reverse(words_[word_m], whichbit(m)) *
@@ -437,17 +514,7 @@ template <size_t N> class BitArray {
     /// Returns a hash value for a BitArray object
     struct Hash {
         std::size_t operator()(const BitArray<N>& d) const {
-            if constexpr (N == 64) {
-                return d.words_[0];
-            } else if constexpr (N == 128) {
-                return ((d.words_[0] * 13466917) + d.words_[1]) % 1405695061;
-            } else {
-                std::uint64_t seed = nwords_;
-                for (auto& w : d.words_) {
-                    hash_combine_uint64(seed, w);
-                }
-                return seed;
-            }
+            return hash_words_uint64<nwords_>(d.words_.data());
         }
     };
 
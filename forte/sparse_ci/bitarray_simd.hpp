@@ -0,0 +1,240 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _bitarray_simd_hpp_
+#define _bitarray_simd_hpp_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "bitwise_operations.hpp"
+
+namespace forte {
+
+/**
+ * Vectorized kernels for arrays of 64-bit words used by BitArray<N>.
+ *
+ * The kernels process an array of nwords words with 256-bit (AVX2, nwords = 4 or 8) or 512-bit
+ * (AVX-512, nwords = 8) registers. If the instructions are not available, or the number of
+ * words does not fit the vector registers, they fall back to a loop over the words.
+ * The instruction set is selected at compile time (see the ENABLE_AVX2 and ENABLE_AVX512
+ * options). With AVX512VPOPCNTDQ the bit counts are also computed with vector instructions.
+ */
+namespace bitarray_simd {
+
+/// Returns true if arrays of nwords words are processed with vector instructions
+constexpr bool enabled(size_t nwords) {
+#if defined(__AVX2__) || defined(__AVX512F__)
+    return (nwords == 4) or (nwords == 8);
+#else
+    static_cast<void>(nwords);
+    return false;
+#endif
+}
+
+#if defined(__AVX2__)
+inline __m256i load256(const uint64_t* w) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w));
+}
+inline void store256(uint64_t* w, __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(w), v);
+}
+#endif
+
+#if defined(__AVX512F__)
+inline __m512i load512(const uint64_t* w) { return _mm512_loadu_si512(w); }
+inline void store512(uint64_t* w, __m512i v) { _mm512_storeu_si512(w, v); }
+#endif
+
+/// Returns a == b
+template <size_t nwords> inline bool equal(const uint64_t* a, const uint64_t* b) {
+#if defined(__AVX512F__)
+    if constexpr (nwords == 8) {
+        return _mm512_cmpneq_epu64_mask(load512(a), load512(b)) == 0;
+    }
+#endif
+#if defined(__AVX2__)
+    if constexpr (nwords % 4 == 0) {
+        __m256i x = _mm256_setzero_si256();
+        for (size_t n = 0; n < nwords; n += 4)
+            x = _mm256_or_si256(x, _mm256_xor_si256(load256(a + n), load256(b + n)));
+        return _mm256_testz_si256(x, x);
+    }
+#endif
+    uint64_t x = 0;
+    for (size_t n = 0; n < nwords; ++n)
+        x |= a[n] ^ b[n];
+    return x == 0;
+}
+
+/// Returns (a & b) == 0
+template <size_t nwords> inline bool and_eq_zero(const uint64_t* a, const uint64_t* b) {
+#if defined(__AVX512F__)
+    if constexpr (nwords == 8) {
+        return _mm512_test_epi64_mask(load512(a), load512(b)) == 0;
+    }
+#endif
+#if defined(__AVX2__)
+    if constexpr (nwords % 4 == 0) {
+        int result = 1;
+        for (size_t n = 0; n < nwords; n += 4)
+            result &= _mm256_testz_si256(load256(a + n), load256(b + n));
+        return result;
+    }
+#endif
+    uint64_t x = 0;
+    for (size_t n = 0; n < nwords; ++n)
+        x |= a[n] & b[n];
+    return x == 0;
+}
+
+/// Returns (a & ~b) == 0
+template <size_t nwords> inline bool andnot_eq_zero(const uint64_t* a, const uint64_t* b) {
+#if defined(__AVX512F__)
+    if constexpr (nwords == 8) {
+        __m512i x = _mm512_andnot_si512(load512(b), load512(a));
+        return _mm512_test_epi64_mask(x, x) == 0;
+    }
+#endif
+#if defined(__AVX2__)
+    if constexpr (nwords % 4 == 0) {
+        // testc computes (~b & a) == 0
+        int result = 1;
+        for (size_t n = 0; n < nwords; n += 4)
+            result &= _mm256_testc_si256(load256(b + n), load256(a + n));
+        return result;
+    }
+#endif
+    uint64_t x = 0;
+    for (size_t n = 0; n < nwords; ++n)
+        x |= a[n] & ~b[n];
+    return x == 0;
+}
+
+/// Returns the number of bits set in a
+template <size_t nwords> inline int count(const uint64_t* a) {
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+    if constexpr (nwords == 8) {
+        return static_cast<int>(_mm512_reduce_add_epi64(_mm512_popcnt_epi64(load512(a))));
+    }
+#endif
+    int c = 0;
+    for (size_t n = 0; n < nwords; ++n)
+        c += ui64_bit_count(a[n]);
+    return c;
+}
+
+/// Returns the number of bits set in a ^ b
+template <size_t nwords> inline int xor_count(const uint64_t* a, const uint64_t* b) {
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+    if constexpr (nwords == 8) {
+        __m512i x = _mm512_xor_si512(load512(a), load512(b));
+        return static_cast<int>(_mm512_reduce_add_epi64(_mm512_popcnt_epi64(x)));
+    }
+#endif
+    int c = 0;
+    for (size_t n = 0; n < nwords; ++n)
+        c += ui64_bit_count(a[n] ^ b[n]);
+    return c;
+}
+
+/// Returns the number of bits set in a & b
+template <size_t nwords> inline int and_count(const uint64_t* a, const uint64_t* b) {
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+    if constexpr (nwords == 8) {
+        __m512i x = _mm512_and_si512(load512(a), load512(b));
+        return static_cast<int>(_mm512_reduce_add_epi64(_mm512_popcnt_epi64(x)));
+    }
+#endif
+    int c = 0;
+    for (size_t n = 0; n < nwords; ++n)
+        c += ui64_bit_count(a[n] & b[n]);
+    return c;
+}
+
+/// The bitwise operations implemented by binary_op
+enum class Op { And, Or, Xor, AndNot };
+
+/// Computes r = a op b (AndNot computes a & ~b). r may alias a or b
+template <size_t nwords, Op op>
+inline void binary_op(const uint64_t* a, const uint64_t* b, uint64_t* r) {
+#if defined(__AVX512F__)
+    if constexpr (nwords == 8) {
+        __m512i va = load512(a);
+        __m512i vb = load512(b);
+        if constexpr (op == Op::And) {
+            store512(r, _mm512_and_si512(va, vb));
+        } else if constexpr (op == Op::Or) {
+            store512(r, _mm512_or_si512(va, vb));
+        } else if constexpr (op == Op::Xor) {
+            store512(r, _mm512_xor_si512(va, vb));
+        } else {
+            store512(r, _mm512_andnot_si512(vb, va));
+        }
+        return;
+    }
+#endif
+#if defined(__AVX2__)
+    if constexpr (nwords % 4 == 0) {
+        for (size_t n = 0; n < nwords; n += 4) {
+            __m256i va = load256(a + n);
+            __m256i vb = load256(b + n);
+            if constexpr (op == Op::And) {
+                store256(r + n, _mm256_and_si256(va, vb));
+            } else if constexpr (op == Op::Or) {
+                store256(r + n, _mm256_or_si256(va, vb));
+            } else if constexpr (op == Op::Xor) {
+                store256(r + n, _mm256_xor_si256(va, vb));
+            } else {
+                store256(r + n, _mm256_andnot_si256(vb, va));
+            }
+        }
+        return;
+    }
+#endif
+    for (size_t n = 0; n < nwords; ++n) {
+        if constexpr (op == Op::And) {
+            r[n] = a[n] & b[n];
+        } else if constexpr (op == Op::Or) {
+            r[n] = a[n] | b[n];
+        } else if constexpr (op == Op::Xor) {
+            r[n] = a[n] ^ b[n];
+        } else {
+            r[n] = a[n] & ~b[n];
+        }
+    }
+}
+
+} // namespace bitarray_simd
+} // namespace forte
+
+#endif // _bitarray_simd_hpp_
@@ -15,6 +15,45 @@ inline void hash_combine_uint64(uint64_t& seed, size_t value) {
     seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+/// multiply two 64 bit unsigned integers and fold the 128 bit product to 64 bits
+/// (the mixing step of wyhash)
+inline uint64_t hash_mum_uint64(uint64_t a, uint64_t b) {
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+/**
+ * @brief Hash an array of nwords 64 bit unsigned integers
+ * @param words a pointer to the first word
+ * @return a 64 bit hash value whose low and high bits are both well mixed
+ *
+ * Words are mixed in pairs with one 64 x 64 -> 128 bit multiplication per pair. The products of
+ * different pairs are independent, so they execute in parallel, and for more than two words they
+ * are folded together with one more multiplication. The words themselves are added to the
+ * product so that a pair with one factor equal to zero does not collapse to a constant.
+ */
+template <size_t nwords> inline uint64_t hash_words_uint64(const uint64_t* words) {
+    constexpr uint64_t s0 = 0xa0761d6478bd642fULL;
+    constexpr uint64_t s1 = 0xe7037ed1a0b428dbULL;
+    constexpr uint64_t s2 = 0x8ebc6af09c88c6e3ULL;
+    if constexpr (nwords == 1) {
+        return hash_mum_uint64(words[0] ^ s0, s1) + words[0];
+    } else if constexpr (nwords == 2) {
+        return hash_mum_uint64(words[0] ^ s0, words[1] ^ s1) + words[0] + words[1];
+    } else {
+        uint64_t h = 0;
+        for (size_t i = 0; i + 1 < nwords; i += 2) {
+            uint64_t a = words[i] ^ (s0 + i * s2);
+            uint64_t b = words[i + 1] ^ (s1 + i * s2);
+            h ^= hash_mum_uint64(a, b) + words[i] + words[i + 1];
+        }
+        if constexpr (nwords % 2 == 1) {
+            h ^= hash_mum_uint64(words[nwords - 1] ^ (s0 + nwords * s2), s1) + words[nwords - 1];
+        }
+        return hash_mum_uint64(h ^ s2, nwords ^ s1) + h;
+    }
+}
+
 /**
  * @brief Count the number of bit set to 1 in a uint64_t
  * @param x the uint64_t integer to test
@@ -508,42 +508,146 @@ void CI_Reference::build_cas_reference_full(std::vector<Determinant>& ref_space)
     ref_space.clear();
 
     // build alpha and beta strings
-    auto a_strings = build_occ_string(nact_, nalpha_, mo_symmetry_);
-    auto b_strings = build_occ_string(nact_, nbeta_, mo_symmetry_);
+    std::vector<size_t> orbs(nact_);
+    std::iota(orbs.begin(), orbs.end(), 0);
+    auto a_strings = build_strings(orbs, nalpha_, mo_symmetry_);
+    auto b_strings = build_strings(orbs, nbeta_, mo_symmetry_);
 
     // construct determinants
-    for (int ha = 0; ha != nirrep_; ++ha) {
-        int hb = ha ^ root_sym_;
-        for (size_t a = 0, a_size = a_strings[ha].size(); a < a_size; ++a) {
-            for (size_t b = 0, b_size = b_strings[hb].size(); b < b_size; ++b) {
-                ref_space.emplace_back(a_strings[ha][a], b_strings[hb][b]);
+    add_determinants(a_strings, b_strings, ref_space);
+}
+
+std::vector<std::vector<std::vector<bool>>>
+CI_Reference::build_occ_string(size_t norb, size_t nele, const std::vector<int>& symmetry) {
+    std::vector<size_t> orbs(norb);
+    std::iota(orbs.begin(), orbs.end(), 0);
+    auto strings = build_strings(orbs, nele, symmetry);
+
+    std::vector<std::vector<std::vector<bool>>> out(nirrep_);
+    for (int h = 0; h < nirrep_; ++h) {
+        for (const auto& s : strings[h]) {
+            std::vector<bool> occ(norb, false);
+            for (size_t p = 0; p < norb; ++p) {
+                occ[p] = s.get_bit(p);
             }
+            out[h].push_back(occ);
         }
     }
+    return out;
 }
 
-std::vector<std::vector<std::vector<bool>>>
-CI_Reference::build_occ_string(size_t norb, size_t nele, const std::vector<int>& symmetry) {
+std::vector<std::vector<String>> CI_Reference::build_strings(const std::vector<size_t>& orbs,
+                                                             size_t nele,
+                                                             const std::vector<int>& symmetry) {
+    size_t norb = orbs.size();
     if (nele > norb) {
         throw psi::PSIEXCEPTION("Invalid number of electron / orbital to build occ string.");
     }
 
-    std::vector<std::vector<std::vector<bool>>> out(nirrep_, std::vector<std::vector<bool>>());
+    // the orbitals of each irrep, used to get the symmetry of a string from the parity of its
+    // occupation in each irrep
+    std::vector<String> irrep_masks(nirrep_);
+    for (auto& mask : irrep_masks) {
+        mask.zero();
+    }
+    for (size_t p = 0; p < norb; ++p) {
+        irrep_masks[symmetry[p]].set_bit(orbs[p], true);
+    }
 
-    std::vector<bool> occ_tmp(norb, false);
-    for (size_t i = norb - nele; i < norb; ++i)
-        occ_tmp[i] = true;
+    // binomial coefficients C(n, k) for n <= norb and k <= nele
+    std::vector<std::vector<size_t>> binom(norb + 2, std::vector<size_t>(nele + 1, 0));
+    for (size_t n = 0; n <= norb + 1; ++n) {
+        binom[n][0] = 1;
+        for (size_t k = 1; k <= std::min(n, nele); ++k) {
+            binom[n][k] = binom[n - 1][k - 1] + binom[n - 1][k];
+        }
+    }
+    size_t nstrings = binom[norb][nele];
+
+    // The strings are enumerated as combinations c[0] < c[1] < ... of the reversed orbital
+    // indices (q = norb - 1 - p) in colexicographic order, which is the order of the occupation
+    // vectors generated by std::next_permutation. The combination of rank r is found directly,
+    // so the strings are generated in independent chunks
+    size_t max_chunks = 8 * omp_get_max_threads();
+    size_t nchunks = std::max(size_t(1), std::min(nstrings / 1024, max_chunks));
+    std::vector<std::vector<std::vector<String>>> chunk_strings(
+        nchunks, std::vector<std::vector<String>>(nirrep_));
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t chunk = 0; chunk < nchunks; ++chunk) {
+        size_t begin = nstrings * chunk / nchunks;
+        size_t end = nstrings * (chunk + 1) / nchunks;
+
+        // unrank the first combination of this chunk
+        std::vector<size_t> c(nele);
+        size_t r = begin;
+        for (size_t i = nele; i > 0; --i) {
+            size_t x = i - 1;
+            while (binom[x + 1][i] <= r) {
+                ++x;
+            }
+            c[i - 1] = x;
+            r -= binom[x][i];
+        }
 
-    do {
-        int sym = 0;
-        for (size_t p = 0; p < norb; ++p) {
-            if (occ_tmp[p])
-                sym ^= symmetry[p];
+        auto& out = chunk_strings[chunk];
+        String s;
+        for (size_t n = begin; n < end; ++n) {
+            s.zero();
+            for (size_t q : c) {
+                s.set_bit(orbs[norb - 1 - q], true);
+            }
+            int h = 0;
+            for (int g = 1; g < nirrep_; ++g) {
+                if (s.fast_a_and_b_parity(irrep_masks[g])) {
+                    h ^= g;
+                }
+            }
+            out[h].push_back(s);
+
+            // the next combination in colexicographic order
+            if (nele > 0) {
+                size_t i = 0;
+                while ((i + 1 < nele) and (c[i] + 1 == c[i + 1])) {
+                    c[i] = i;
+                    ++i;
+                }
+                ++c[i];
+            }
         }
-        out[sym].emplace_back(occ_tmp.begin(), occ_tmp.end());
-    } while (std::next_permutation(occ_tmp.begin(), occ_tmp.begin() + norb));
+    }
 
-    return out;
+    std::vector<std::vector<String>> strings(nirrep_);
+    for (int h = 0; h < nirrep_; ++h) {
+        for (auto& out : chunk_strings) {
+            strings[h].insert(strings[h].end(), out[h].begin(), out[h].end());
+        }
+    }
+    return strings;
+}
+
+void CI_Reference::add_determinants(const std::vector<std::vector<String>>& a_strings,
+                                    const std::vector<std::vector<String>>& b_strings,
+                                    std::vector<Determinant>& ref_space) {
+    size_t offset = ref_space.size();
+    size_t ndets = 0;
+    for (int ha = 0; ha < nirrep_; ++ha) {
+        ndets += a_strings[ha].size() * b_strings[ha ^ root_sym_].size();
+    }
+    ref_space.resize(offset + ndets);
+
+    for (int ha = 0; ha < nirrep_; ++ha) {
+        const auto& a = a_strings[ha];
+        const auto& b = b_strings[ha ^ root_sym_];
+        size_t na = a.size(), nb = b.size();
+#pragma omp parallel for
+        for (size_t Ia = 0; Ia < na; ++Ia) {
+            for (size_t Ib = 0; Ib < nb; ++Ib) {
+                ref_space[offset + Ia * nb + Ib] = Determinant(a[Ia], b[Ib]);
+            }
+        }
+        offset += na * nb;
+    }
 }
 
 void CI_Reference::build_doci_reference(std::vector<Determinant>& ref_space) {
@@ -553,7 +657,9 @@ void CI_Reference::build_doci_reference(std::vector<Determinant>& ref_space) {
     }
 
     ref_space.clear();
-    auto strings_per_irrep = build_occ_string(nact_, nalpha_, mo_symmetry_);
+    std::vector<size_t> orbs(nact_);
+    std::iota(orbs.begin(), orbs.end(), 0);
+    auto strings_per_irrep = build_strings(orbs, nalpha_, mo_symmetry_);
 
     // combine alpha and beta strings to form determinant
     for (int h = 0; h < nirrep_; ++h) {
@@ -563,54 +669,6 @@ void CI_Reference::build_doci_reference(std::vector<Determinant>& ref_space) {
     }
 }
 
-std::vector<std::vector<bool>>
-CI_Reference::build_gas_occ_string(const std::vector<std::vector<std::vector<bool>>>& gas_strings,
-                                   const std::vector<std::vector<size_t>>& rel_mos) {
-    int ngas = gas_strings.size();
-    if (ngas != static_cast<int>(rel_mos.size()))
-        throw psi::PSIEXCEPTION("Inconsistent numbers of gas spaces");
-
-    // compute the cartesian product of strings
-    /* For example (see Python itertools product):
-     * input:  [[gas1_occ1, gas1_occ2, gas1_occ3, ...], [gas2_occ1, gas2_occ2, ...], ...]
-     * output: [[gas1_occ1, gas2_occ1, ...], [gas1_occ1, gas2_occ2, ...],
-     *          [gas1_occ2, gas2_occ1, ...], [gas1_occ2, gas2_occ2, ...],
-     *          [gas1_occ3, gas2_occ1, ...], [gas1_occ3, gas2_occ2, ...], ...]
-     */
-    auto product = math::cartesian_product(gas_strings);
-
-    auto n_strings = product.size();
-    std::vector<std::vector<bool>> out(n_strings);
-    if (n_strings == 0)
-        return out;
-
-    // combine gas strings to a string of size nactv_orbs
-
-    size_t n_threads = omp_get_num_threads();
-    if (n_threads > n_strings)
-        n_threads = n_strings;
-
-#pragma omp parallel for num_threads(n_threads)
-    for (size_t n = 0; n < n_strings; ++n) {
-
-        const auto& strings = product[n];
-        std::vector<bool> s(nact_, false);
-
-        for (int g = 0; g < ngas; ++g) {
-            const auto& rel = rel_mos[g];
-            const auto& string = strings[g];
-            for (int p = 0, psize = string.size(); p < psize; ++p) {
-                if (string[p]) {
-                    s[rel[p]] = true;
-                }
-            }
-        }
-        out[n] = s;
-    }
-
-    return out;
-}
-
 void CI_Reference::build_gas_single(std::vector<Determinant>& ref_space) {
     // build the determinant from aufbau principle
     print_gas_scf_epsilon();
@@ -787,15 +845,18 @@ void CI_Reference::build_gas_reference(std::vector<Determinant>& ref_space) {
 
     ref_space.clear();
 
-    // relative indices within the active orbitals
+    // relative indices within the active orbitals and symmetry of the nonzero-sized GAS
+    std::vector<int> gas_index;
     std::vector<std::vector<size_t>> rel_gas_mos;
+    std::vector<std::vector<int>> gas_sym;
 
     for (int gas = 0; gas < 6; ++gas) {
         std::string space_name = "GAS" + std::to_string(gas + 1);
-        auto abs_mos = mo_space_info_->absolute_mo(space_name);
-        if (abs_mos.size() == 0)
+        if (mo_space_info_->size(space_name) == 0)
             continue;
+        gas_index.push_back(gas);
         rel_gas_mos.push_back(mo_space_info_->pos_in_space(space_name, "ACTIVE"));
+        gas_sym.push_back(mo_space_info_->symmetry(space_name));
     }
 
     int ngas = rel_gas_mos.size(); // number of nonzero-sized GAS
@@ -811,94 +872,93 @@ void CI_Reference::build_gas_reference(std::vector<Determinant>& ref_space) {
     }
     auto sym_product = math::cartesian_product(irrep_pools);
 
-    // dynamic programming for given GAS n/orbital/electron
-    std::map<std::tuple<int, size_t, size_t>, std::vector<std::vector<std::vector<bool>>>>
-        gasn_config_to_occ_string;
-
-    // loop over all GAS configurations
-    print_h2("Building GAS Determinants");
-    outfile->Printf("\n    Config.  #Determinants     Time/s");
-    outfile->Printf("\n    ---------------------------------");
-
-    timer timer_gas("Build GAS determinants");
-    for (size_t config = 0, size = gas_electrons_.size(); config < size; ++config) {
-        local_timer lt;
-        outfile->Printf("\n    %6d", config + 1);
-
-        // build alpha or beta strings (ngas of nirrep of vector of occupation)
-        std::vector<std::vector<std::vector<std::vector<bool>>>> a_tmp, b_tmp;
-
-        for (int gas = 0; gas < 6; ++gas) {
-            auto space_name = "GAS" + std::to_string(gas + 1);
-            auto norb = mo_space_info_->size(space_name);
-            if (norb == 0)
-                continue;
-
-            auto sym = mo_space_info_->symmetry(space_name);
-
-            std::tuple<int, size_t, size_t> a_key{gas, norb, gas_electrons_[config][2 * gas]};
-            if (gasn_config_to_occ_string.find(a_key) == gasn_config_to_occ_string.end()) {
-                gasn_config_to_occ_string[a_key] =
-                    build_occ_string(norb, gas_electrons_[config][2 * gas], sym);
-            }
-            a_tmp.push_back(gasn_config_to_occ_string[a_key]);
-
-            std::tuple<int, size_t, size_t> b_key{gas, norb, gas_electrons_[config][2 * gas + 1]};
-            if (gasn_config_to_occ_string.find(b_key) == gasn_config_to_occ_string.end()) {
-                gasn_config_to_occ_string[b_key] =
-                    build_occ_string(norb, gas_electrons_[config][2 * gas + 1], sym);
+    // the strings of each GAS (in the positions of the active orbitals) for a given number of
+    // electrons. These are shared by all the GAS configurations
+    size_t nconfigs = gas_electrons_.size();
+    std::map<std::pair<int, int>, std::vector<std::vector<String>>> gas_strings;
+    for (size_t config = 0; config < nconfigs; ++config) {
+        for (int g = 0; g < ngas; ++g) {
+            for (int spin = 0; spin < 2; ++spin) {
+                std::pair<int, int> key{g, gas_electrons_[config][2 * gas_index[g] + spin]};
+                if (gas_strings.find(key) == gas_strings.end()) {
+                    gas_strings[key] = build_strings(rel_gas_mos[g], key.second, gas_sym[g]);
+                }
             }
-            b_tmp.push_back(gasn_config_to_occ_string[b_key]);
         }
+    }
 
-        // alpha and beta strings (nirrep of vector of occupations)
-        std::vector<std::vector<std::vector<bool>>> a_strings(nirrep_), b_strings(nirrep_);
-
-        // loop over symmetry product
+    // combine the strings of each GAS into strings of the active orbitals (nirrep of vector of
+    // strings), in the order of the cartesian product of the symmetry and string products
+    auto combine_gas_strings = [&](size_t config, int spin) {
+        std::vector<std::vector<String>> strings(nirrep_);
+        std::vector<const std::vector<String>*> pools(ngas);
         for (const auto& sym : sym_product) {
             int irrep = 0;
-            std::vector<std::vector<std::vector<bool>>> a(ngas), b(ngas);
-
-            for (int gas = 0; gas < ngas; ++gas) {
-                int h = sym[gas];
-                irrep ^= h;
-                a[gas] = a_tmp[gas][h];
-                b[gas] = b_tmp[gas][h];
+            size_t nproduct = 1;
+            for (int g = 0; g < ngas; ++g) {
+                irrep ^= sym[g];
+                int nele = gas_electrons_[config][2 * gas_index[g] + spin];
+                pools[g] = &gas_strings.at({g, nele})[sym[g]];
+                nproduct *= pools[g]->size();
             }
+            if (nproduct == 0)
+                continue;
 
-            // alpha
-            auto strings_irrep = build_gas_occ_string(a, rel_gas_mos);
-            std::move(strings_irrep.begin(), strings_irrep.end(),
-                      std::back_inserter(a_strings[irrep]));
-
-            // beta
-            strings_irrep = build_gas_occ_string(b, rel_gas_mos);
-            std::move(strings_irrep.begin(), strings_irrep.end(),
-                      std::back_inserter(b_strings[irrep]));
-        }
-
-        // combine alpha and beta strings to form determinant
-        size_t n = 0;
-        for (int ha = 0; ha < nirrep_; ++ha) {
-            int hb = root_sym_ ^ ha;
-            for (const auto& a : a_strings[ha]) {
-                for (const auto& b : b_strings[hb]) {
-                    ref_space.emplace_back(a, b);
-                    n++;
+            auto& out = strings[irrep];
+            size_t offset = out.size();
+            out.resize(offset + nproduct);
+#pragma omp parallel for
+            for (size_t n = offset; n < offset + nproduct; ++n) {
+                // the last GAS runs fastest
+                size_t index = n - offset;
+                String s;
+                s.zero();
+                for (int g = ngas - 1; g >= 0; --g) {
+                    const auto& pool = *pools[g];
+                    s |= pool[index % pool.size()];
+                    index /= pool.size();
                 }
+                out[n] = s;
             }
         }
+        return strings;
+    };
 
-        outfile->Printf("  %14zu  %9.3e", n, lt.get());
+    // loop over all GAS configurations
+    print_h2("Building GAS Determinants");
+    outfile->Printf("\n    Config.  #Determinants     Time/s");
+    outfile->Printf("\n    ---------------------------------");
+
+    timer timer_gas("Build GAS determinants");
+    std::vector<std::vector<Determinant>> config_dets(nconfigs);
+    std::vector<double> config_times(nconfigs);
+
+    // the configurations are independent. With only one configuration, the strings and the
+    // determinants are built in parallel instead
+#pragma omp parallel for schedule(dynamic) if (nconfigs > 1)
+    for (size_t config = 0; config < nconfigs; ++config) {
+        local_timer lt;
+        auto a_strings = combine_gas_strings(config, 0);
+        auto b_strings = combine_gas_strings(config, 1);
+        add_determinants(a_strings, b_strings, config_dets[config]);
+        config_times[config] = lt.get();
+    }
+
+    size_t ndets = 0;
+    for (const auto& dets : config_dets) {
+        ndets += dets.size();
+    }
+    ref_space.reserve(ndets);
+    for (size_t config = 0; config < nconfigs; ++config) {
+        outfile->Printf("\n    %6zu  %14zu  %9.3e", config + 1, config_dets[config].size(),
+                        config_times[config]);
+        ref_space.insert(ref_space.end(), config_dets[config].begin(), config_dets[config].end());
+        std::vector<Determinant>().swap(config_dets[config]);
     }
 
     outfile->Printf("\n    ---------------------------------");
     outfile->Printf("\n    Total:  %14zu  %9.3e", ref_space.size(), timer_gas.stop());
     outfile->Printf("\n    ---------------------------------");
-    //    print_h2("GAS Determinants");
-    //    for (const auto& det : ref_space) {
-    //        outfile->Printf("\n    %s", str(det, nact_).c_str());
-    //    }
 }
 
 std::vector<std::tuple<double, int, int>> CI_Reference::sym_labeled_orbitals(std::string type) {
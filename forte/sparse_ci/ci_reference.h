@@ -114,12 +114,18 @@ class CI_Reference {
     std::vector<std::vector<std::vector<bool>>> build_occ_string(size_t norb, size_t nele,
                                                                  const std::vector<int>& symmetry);
 
-    /// Compute the cartesian product of occupation strings
-    /// @arg vector of vector of occupation
-    /// @return nirrep of vector of occupation
-    std::vector<std::vector<bool>>
-    build_gas_occ_string(const std::vector<std::vector<std::vector<bool>>>& gas_strings,
-                         const std::vector<std::vector<size_t>>& rel_mos);
+    /// Compute all the strings with nele electrons in a set of orbitals
+    /// @param orbs the position of each orbital in the string
+    /// @param symmetry the irrep of each orbital
+    /// @return nirrep of vector of strings, in the order generated by std::next_permutation
+    std::vector<std::vector<String>> build_strings(const std::vector<size_t>& orbs, size_t nele,
+                                                   const std::vector<int>& symmetry);
+
+    /// Append to ref_space all the determinants formed by the alpha strings of irrep h and the
+    /// beta strings of irrep h ^ root_sym_
+    void add_determinants(const std::vector<std::vector<String>>& a_strings,
+                          const std::vector<std::vector<String>>& b_strings,
+                          std::vector<Determinant>& ref_space);
 
   public:
     /// Default constructor
@@ -0,0 +1,231 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+
+#include "helpers/flat_hash_vector.h"
+#include "sparse_ci/compiled_sparse_operator.h"
+
+namespace forte {
+
+namespace {
+using det_index = FlatHashVector<Determinant, Determinant::Hash>;
+
+/// Flip the bits [0, orb) of mask
+void flip_lower_bits(Determinant& mask, size_t orb) {
+    for (size_t i = 0; i < orb; i++) {
+        mask.set_bit(i, not mask.get_bit(i));
+    }
+}
+
+/// @return the sign mask and the constant phase of the operator (cre)(ann) as applied by apply_op()
+/// Annihilating the orbitals q_1 < q_2 < ... in ascending order gives the sign
+///     (-1)^(count(d & below(q_1)) + count(d & below(q_2)) - 1 + ...)
+/// where below(q) is the mask of the bits preceeding q. The creation operators give a similar
+/// contribution evaluated on d without the annihilated orbitals. All the state-dependent parts
+/// are collected in sign_mask and the rest in factor
+std::pair<Determinant, double> compile_sign(const Determinant& cre, const Determinant& ann) {
+    Determinant ann_mask;
+    Determinant cre_mask;
+    Determinant temp(ann);
+    size_t nann = temp.count();
+    for (size_t i = 0; i < nann; i++) {
+        flip_lower_bits(ann_mask, temp.find_and_clear_first_one());
+    }
+    temp = cre;
+    size_t ncre = temp.count();
+    for (size_t i = 0; i < ncre; i++) {
+        flip_lower_bits(cre_mask, temp.find_and_clear_first_one());
+    }
+    // the phase due to the annihilated orbitals preceeding the next annihilation operator.
+    // For the creation operators this phase cancels with the one from reversing their order
+    size_t nflips = nann * (nann - 1) / 2;
+    // the annihilated orbitals are empty when the creation operators are applied
+    nflips += (ann & cre_mask).count();
+    Determinant sign_mask = ann_mask ^ cre_mask;
+    return {sign_mask, nflips % 2 == 0 ? 1.0 : -1.0};
+}
+} // namespace
+
+CompiledSparseOperator::CompiledSparseOperator(const SparseOperator& sop) : nterms_(sop.size()) {
+    const auto& op_list = sop.op_list();
+    std::vector<std::pair<Determinant, Term>> ann_terms;
+    ann_terms.reserve(sop.is_antihermitian() ? 2 * nterms_ : nterms_);
+    for (size_t n = 0; n < nterms_; n++) {
+        const SQOperator& sqop = op_list[n];
+        auto [sign_mask, factor] = compile_sign(sqop.cre(), sqop.ann());
+        Term term{sqop.cre(), sqop.cre() - sqop.ann(), sign_mask, 0.0, factor, n};
+        ann_terms.emplace_back(sqop.ann(), term);
+        if (sop.is_antihermitian()) {
+            auto [dexc_sign_mask, dexc_factor] = compile_sign(sqop.ann(), sqop.cre());
+            Term dexc_term{sqop.ann(), sqop.ann() - sqop.cre(), dexc_sign_mask, 0.0,
+                           -dexc_factor, n};
+            ann_terms.emplace_back(sqop.cre(), dexc_term);
+        }
+    }
+    std::stable_sort(ann_terms.begin(), ann_terms.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    terms_.reserve(ann_terms.size());
+    for (const auto& [ann, term] : ann_terms) {
+        if (groups_.empty() or groups_.back().ann != ann) {
+            groups_.push_back({ann, terms_.size(), terms_.size()});
+        }
+        terms_.push_back(term);
+        groups_.back().end = terms_.size();
+    }
+    update_coefficients(sop);
+}
+
+void CompiledSparseOperator::update_coefficients(const SparseOperator& sop) {
+    if (sop.size() != nterms_) {
+        throw std::runtime_error("CompiledSparseOperator::update_coefficients: the operator has " +
+                                 std::to_string(sop.size()) + " terms, expected " +
+                                 std::to_string(nterms_));
+    }
+    const auto& op_list = sop.op_list();
+    for (auto& term : terms_) {
+        term.coefficient = term.factor * op_list[term.index].coefficient();
+    }
+    sort_groups();
+}
+
+void CompiledSparseOperator::sort_groups() {
+    for (const auto& group : groups_) {
+        std::sort(terms_.begin() + group.begin, terms_.begin() + group.end,
+                  [](const Term& a, const Term& b) {
+                      return std::fabs(a.coefficient) > std::fabs(b.coefficient);
+                  });
+    }
+}
+
+StateVector CompiledSparseOperator::apply(const StateVector& state, double screen_thresh) const {
+    StateVector new_terms;
+    for (const auto& [d, c] : state) {
+        for (const auto& group : groups_) {
+            // check if the orbitals annihilated are occupied
+            if (not d.fast_a_and_b_equal_b(group.ann))
+                continue;
+            for (size_t n = group.begin; n < group.end; n++) {
+                const Term& term = terms_[n];
+                const double value = term.coefficient * c;
+                // the terms are sorted by decreasing |coefficient|
+                if (std::fabs(value) <= screen_thresh)
+                    break;
+                // check if the orbitals created are empty
+                if (d.fast_a_and_b_eq_zero(term.ucre)) {
+                    const Determinant d_new = (d ^ group.ann) | term.cre;
+                    new_terms[d_new] += d.fast_a_and_b_parity(term.sign_mask) ? -value : value;
+                }
+            }
+        }
+    }
+    return new_terms;
+}
+
+std::vector<StateVector> CompiledSparseOperator::apply(const std::vector<StateVector>& states,
+                                                       double screen_thresh) const {
+    const size_t nvec = states.size();
+
+    // collect the determinants of all the states and store their coefficients in a dense
+    // matrix, c[I * nvec + k] = C^k_I
+    det_index dets;
+    std::vector<double> c;
+    for (size_t k = 0; k < nvec; k++) {
+        for (const auto& [d, c_d] : states[k]) {
+            const size_t I = dets.add(d);
+            if (I * nvec == c.size()) {
+                c.resize(c.size() + nvec, 0.0);
+            }
+            c[I * nvec + k] = c_d;
+        }
+    }
+
+    // the results are stored in a dense matrix with the same layout
+    det_index new_dets;
+    std::vector<double> sigma;
+    for (size_t I = 0, maxI = dets.size(); I < maxI; I++) {
+        const Determinant& d = dets[I];
+        const double* c_I = &c[I * nvec];
+        double max_c = 0.0;
+        for (size_t k = 0; k < nvec; k++) {
+            max_c = std::max(max_c, std::fabs(c_I[k]));
+        }
+        for (const auto& group : groups_) {
+            // check if the orbitals annihilated are occupied
+            if (not d.fast_a_and_b_equal_b(group.ann))
+                continue;
+            for (size_t n = group.begin; n < group.end; n++) {
+                const Term& term = terms_[n];
+                // the terms are sorted by decreasing |coefficient|
+                if (std::fabs(term.coefficient) * max_c <= screen_thresh)
+                    break;
+                // check if the orbitals created are empty
+                if (not d.fast_a_and_b_eq_zero(term.ucre))
+                    continue;
+                const Determinant d_new = (d ^ group.ann) | term.cre;
+                const double value =
+                    d.fast_a_and_b_parity(term.sign_mask) ? -term.coefficient : term.coefficient;
+                const size_t J = new_dets.add(d_new);
+                if (J * nvec == sigma.size()) {
+                    sigma.resize(sigma.size() + nvec, 0.0);
+                }
+                double* sigma_J = &sigma[J * nvec];
+                for (size_t k = 0; k < nvec; k++) {
+                    const double value_k = value * c_I[k];
+                    if (std::fabs(value_k) > screen_thresh)
+                        sigma_J[k] += value_k;
+                }
+            }
+        }
+    }
+
+    std::vector<StateVector> new_terms(nvec);
+    for (auto& new_terms_k : new_terms) {
+        new_terms_k.reserve(new_dets.size());
+    }
+    for (size_t J = 0, maxJ = new_dets.size(); J < maxJ; J++) {
+        for (size_t k = 0; k < nvec; k++) {
+            if (sigma[J * nvec + k] != 0.0) {
+                new_terms[k][new_dets[J]] = sigma[J * nvec + k];
+            }
+        }
+    }
+    return new_terms;
+}
+
+std::vector<StateVector> apply_operator(const SparseOperator& sop,
+                                        const std::vector<StateVector>& states,
+                                        double screen_thresh) {
+    return CompiledSparseOperator(sop).apply(states, screen_thresh);
+}
+
+} // namespace forte
@@ -0,0 +1,127 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _compiled_sparse_operator_h_
+#define _compiled_sparse_operator_h_
+
+#include <vector>
+
+#include "sparse_ci/determinant.h"
+#include "sparse_ci/sparse_operator.h"
+#include "sparse_ci/sparse_state_vector.h"
+
+namespace forte {
+
+/**
+ * @brief A SparseOperator compiled into a flat list of bit masks
+ *
+ * Each term of the operator is stored with the masks needed to test if it can be applied to a
+ * determinant d, to build the new determinant, and to compute the fermionic sign with a single
+ * parity count:
+ *
+ *    d_new = (d ^ ann) | cre
+ *    sign  = (-1)^count(d & sign_mask)
+ *
+ * The constant part of the sign is included in the coefficient of each term.
+ * The terms are grouped by annihilation pattern, so that the test (d & ann) == ann is done once
+ * for all the terms that annihilate the same orbitals. Within a group, the terms are sorted by
+ * decreasing |coefficient| so that screening stops at the first term that is too small.
+ * If the operator is antihermitian, the de-excitation part (- op^dagger) is compiled as well.
+ */
+class CompiledSparseOperator {
+  public:
+    /// A compiled term
+    struct Term {
+        /// the orbitals created
+        Determinant cre;
+        /// the orbitals created that are not annihilated (must be empty in d)
+        Determinant ucre;
+        /// the bits of d that determine the sign of the term
+        Determinant sign_mask;
+        /// the coefficient times the constant part of the sign
+        double coefficient;
+        /// the constant part of the sign (-1 for the de-excitation part of the operator)
+        double factor;
+        /// the index of this term in the SparseOperator
+        size_t index;
+    };
+
+    /// A group of terms with the same annihilation operators
+    struct Group {
+        /// the orbitals annihilated (must be occupied in d)
+        Determinant ann;
+        /// the range [begin, end) of terms in this group
+        size_t begin;
+        size_t end;
+    };
+
+    /// Compile a SparseOperator
+    explicit CompiledSparseOperator(const SparseOperator& sop);
+
+    /// @brief Copy the coefficients of an operator with the same terms as the one compiled
+    /// This is useful when the amplitudes of an operator change at every iteration
+    void update_coefficients(const SparseOperator& sop);
+
+    /// @brief Apply this operator to a state
+    /// Only the terms that satisfy |t * C_I| > screen_thresh are applied
+    StateVector apply(const StateVector& state, double screen_thresh = 1.0e-12) const;
+    /// @brief Apply this operator to several states at once
+    /// The couplings of each determinant are enumerated once for all the states that contain it.
+    /// For the state k, only the terms that satisfy |t * C^k_I| > screen_thresh are applied
+    std::vector<StateVector> apply(const std::vector<StateVector>& states,
+                                   double screen_thresh = 1.0e-12) const;
+
+    /// @return the number of compiled terms
+    size_t size() const { return terms_.size(); }
+    /// @return the number of groups of terms with the same annihilation operators
+    size_t num_groups() const { return groups_.size(); }
+    /// @return the compiled terms
+    const std::vector<Term>& terms() const { return terms_; }
+    /// @return the groups of terms
+    const std::vector<Group>& groups() const { return groups_; }
+
+  private:
+    /// Sort the terms of each group by decreasing |coefficient|
+    void sort_groups();
+
+    /// the number of terms of the SparseOperator
+    size_t nterms_;
+    /// the compiled terms
+    std::vector<Term> terms_;
+    /// the groups of terms with the same annihilation operators
+    std::vector<Group> groups_;
+};
+
+/// apply an operator to several states at once, op |state_k>
+std::vector<StateVector> apply_operator(const SparseOperator& sop,
+                                        const std::vector<StateVector>& states,
+                                        double screen_thresh = 1.0e-12);
+
+} // namespace forte
+
+#endif // _compiled_sparse_operator_h_
@@ -0,0 +1,259 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _concurrent_det_accumulator_h_
+#define _concurrent_det_accumulator_h_
+
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "forte-def.h"
+#include "sparse_ci/determinant.h"
+
+namespace forte {
+
+/**
+ * @brief A thread-safe accumulator of amplitudes on determinants
+ *
+ * The accumulator is split into a power-of-two number of shards, each one an open-addressing
+ * table with linear probing. A thread claims an empty slot with a compare-and-swap on its state
+ * and adds to the amplitude of an occupied slot with an atomic compare-and-swap loop, so the
+ * threads never take a lock as long as the shards are below their maximum load. The entries
+ * that do not fit are stored in a small mutex-protected overflow map of the shard and merged
+ * with the table when the amplitudes are collected.
+ *
+ * Amplitudes can only be added while threads are running. The functions that read, resize, or
+ * clear the accumulator must be called outside of parallel regions.
+ */
+class ConcurrentDetAccumulator {
+  public:
+    /// Build an accumulator with at least nshards shards (by default, 16 per OpenMP thread)
+    explicit ConcurrentDetAccumulator(size_t nshards = 0) {
+        if (nshards == 0) {
+            nshards = 16 * static_cast<size_t>(omp_get_max_threads());
+        }
+        size_t n = 1;
+        while (n < nshards) {
+            n <<= 1;
+        }
+        shards_ = std::vector<Shard>(n);
+        shard_mask_ = n - 1;
+        for (auto& shard : shards_) {
+            shard.allocate(min_shard_capacity);
+        }
+    }
+
+    /// Add value to the amplitude of det, inserting det if it is not present
+    void add(const Determinant& det, double value) {
+        const size_t hash = Determinant::Hash()(det);
+        Shard& shard = shards_[(hash >> 40) & shard_mask_];
+        const size_t mask = shard.capacity - 1;
+        for (size_t n = 0, p = hash & mask; n < shard.capacity; ++n, p = (p + 1) & mask) {
+            Slot& slot = shard.slots[p];
+            unsigned char state = slot.state.load(std::memory_order_acquire);
+            if (state == empty) {
+                if (shard.count.load(std::memory_order_relaxed) >= shard.max_load)
+                    break;
+                if (slot.state.compare_exchange_strong(state, busy, std::memory_order_acq_rel)) {
+                    slot.det = det;
+                    slot.value.store(value, std::memory_order_relaxed);
+                    slot.state.store(full, std::memory_order_release);
+                    shard.count.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            // another thread is writing the determinant of this slot
+            while (state == busy) {
+                state = slot.state.load(std::memory_order_acquire);
+            }
+            if (slot.det == det) {
+                atomic_add(slot.value, value);
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.overflow[det] += value;
+    }
+
+    /**
+     * @brief Make room for n determinants without overflowing the tables
+     *
+     * The amplitudes already accumulated are kept.
+     */
+    void reserve(size_t n) {
+        size_t capacity = min_shard_capacity;
+        const size_t per_shard = n / shards_.size() + 1;
+        while (capacity * max_load_factor_num < per_shard * max_load_factor_den) {
+            capacity <<= 1;
+        }
+#pragma omp parallel for schedule(dynamic)
+        for (size_t s = 0; s < shards_.size(); ++s) {
+            Shard& shard = shards_[s];
+            if (shard.capacity >= capacity)
+                continue;
+            std::vector<std::pair<Determinant, double>> entries;
+            shard.move_entries(entries);
+            shard.allocate(capacity);
+            for (const auto& det_C : entries) {
+                add(det_C.first, det_C.second);
+            }
+        }
+    }
+
+    /// The number of shards
+    size_t num_shards() const { return shards_.size(); }
+
+    /**
+     * @brief Collect the determinants and their amplitudes
+     *
+     * The determinants are returned shard by shard. Consecutive calls return the same order.
+     */
+    std::vector<std::pair<Determinant, double>> collect() {
+        const size_t nshards = shards_.size();
+        std::vector<size_t> offsets(nshards + 1, 0);
+#pragma omp parallel for schedule(dynamic)
+        for (size_t s = 0; s < nshards; ++s) {
+            shards_[s].merge_overflow();
+            offsets[s + 1] = shards_[s].count.load(std::memory_order_relaxed) +
+                             shards_[s].overflow.size();
+        }
+        for (size_t s = 0; s < nshards; ++s) {
+            offsets[s + 1] += offsets[s];
+        }
+        std::vector<std::pair<Determinant, double>> result(offsets[nshards]);
+#pragma omp parallel for schedule(dynamic)
+        for (size_t s = 0; s < nshards; ++s) {
+            size_t k = offsets[s];
+            const Shard& shard = shards_[s];
+            for (size_t p = 0; p < shard.capacity; ++p) {
+                const Slot& slot = shard.slots[p];
+                if (slot.state.load(std::memory_order_relaxed) == full) {
+                    result[k++] = {slot.det, slot.value.load(std::memory_order_relaxed)};
+                }
+            }
+            for (const auto& det_C : shard.overflow) {
+                result[k++] = det_C;
+            }
+        }
+        return result;
+    }
+
+    /// Remove all the determinants. The capacity of the tables is kept
+    void clear() {
+#pragma omp parallel for schedule(dynamic)
+        for (size_t s = 0; s < shards_.size(); ++s) {
+            Shard& shard = shards_[s];
+            for (size_t p = 0; p < shard.capacity; ++p) {
+                shard.slots[p].state.store(empty, std::memory_order_relaxed);
+            }
+            shard.count.store(0, std::memory_order_relaxed);
+            shard.overflow.clear();
+        }
+    }
+
+  private:
+    enum : unsigned char { empty = 0, busy = 1, full = 2 };
+    /// The smallest number of slots of a shard
+    static constexpr size_t min_shard_capacity = 64;
+    /// The maximum load of a shard table (as a fraction)
+    static constexpr size_t max_load_factor_num = 3;
+    static constexpr size_t max_load_factor_den = 4;
+
+    struct Slot {
+        std::atomic<unsigned char> state{empty};
+        Determinant det;
+        std::atomic<double> value{0.0};
+    };
+
+    /// A shard is aligned to a cache line so that the counters of neighbors are not shared
+    struct alignas(64) Shard {
+        std::unique_ptr<Slot[]> slots;
+        size_t capacity = 0;
+        size_t max_load = 0;
+        std::atomic<size_t> count{0};
+        std::mutex mutex;
+        det_hash<double> overflow;
+
+        void allocate(size_t n) {
+            slots.reset(new Slot[n]);
+            capacity = n;
+            max_load = n * max_load_factor_num / max_load_factor_den;
+            count.store(0, std::memory_order_relaxed);
+        }
+
+        /// Move all the entries of the table and of the overflow map to a list
+        void move_entries(std::vector<std::pair<Determinant, double>>& entries) {
+            for (size_t p = 0; p < capacity; ++p) {
+                if (slots[p].state.load(std::memory_order_relaxed) == full) {
+                    entries.emplace_back(slots[p].det,
+                                         slots[p].value.load(std::memory_order_relaxed));
+                }
+            }
+            entries.insert(entries.end(), overflow.begin(), overflow.end());
+            overflow.clear();
+        }
+
+        /// Add the overflow entries that were placed in the table by another thread to the table
+        void merge_overflow() {
+            const size_t mask = capacity - 1;
+            for (auto it = overflow.begin(); it != overflow.end();) {
+                bool found = false;
+                const size_t hash = Determinant::Hash()(it->first);
+                for (size_t n = 0, p = hash & mask; n < capacity; ++n, p = (p + 1) & mask) {
+                    Slot& slot = slots[p];
+                    if (slot.state.load(std::memory_order_relaxed) == empty)
+                        break;
+                    if (slot.det == it->first) {
+                        slot.value.store(slot.value.load(std::memory_order_relaxed) + it->second,
+                                         std::memory_order_relaxed);
+                        found = true;
+                        break;
+                    }
+                }
+                it = found ? overflow.erase(it) : std::next(it);
+            }
+        }
+    };
+
+    static void atomic_add(std::atomic<double>& target, double value) {
+        double old = target.load(std::memory_order_relaxed);
+        while (not target.compare_exchange_weak(old, old + value, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::vector<Shard> shards_;
+    size_t shard_mask_;
+};
+
+} // namespace forte
+
+#endif // _concurrent_det_accumulator_h_
@@ -0,0 +1,136 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _concurrent_det_hash_h_
+#define _concurrent_det_hash_h_
+
+#include <mutex>
+#include <vector>
+
+#include "forte-def.h"
+#include "sparse_ci/determinant.h"
+
+namespace forte {
+
+/**
+ * @brief A thread-safe, insert-only map from determinants to values
+ *
+ * The map is split into a power-of-two number of shards, each one a det_hash<T> protected by its
+ * own mutex. The shard of a determinant is selected by the high bits of its hash, so threads
+ * that insert different determinants rarely wait for each other. This lets the threads of a
+ * screening loop write directly into one table instead of filling thread-local buffers that are
+ * merged serially afterwards.
+ *
+ * Entries can only be inserted or updated while threads are running. The shards can be read
+ * (for example, in parallel over shards) once all the insertions are done.
+ */
+template <typename T = double> class ConcurrentDetHash {
+  public:
+    /// Build a map with at least nshards shards (by default, 16 per OpenMP thread)
+    explicit ConcurrentDetHash(size_t nshards = 0) {
+        if (nshards == 0) {
+            nshards = 16 * static_cast<size_t>(omp_get_max_threads());
+        }
+        size_t n = 1;
+        while (n < nshards) {
+            n <<= 1;
+        }
+        shards_ = std::vector<Shard>(n);
+        shard_mask_ = n - 1;
+    }
+
+    /**
+     * @brief Insert the pair (det, value) or, if det is already present, call f(old, value)
+     * @param f a function with signature void(T& old, const T& value) that accumulates value
+     */
+    template <typename F> void insert_or_accumulate(const Determinant& det, const T& value, F&& f) {
+        Shard& shard = shards_[shard_index(det)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(det);
+        if (it == shard.map.end()) {
+            shard.map.emplace(det, value);
+        } else {
+            f(it->second, value);
+        }
+    }
+
+    /// Insert the pair (det, value) or add value to the value already stored for det
+    void insert_or_add(const Determinant& det, const T& value) {
+        insert_or_accumulate(det, value, [](T& old, const T& v) { old += v; });
+    }
+
+    /// The number of shards
+    size_t num_shards() const { return shards_.size(); }
+
+    /// The map of shard n. Not thread-safe with respect to concurrent insertions
+    const det_hash<T>& shard(size_t n) const { return shards_[n].map; }
+
+    /// The total number of determinants. Not thread-safe with respect to concurrent insertions
+    size_t size() const {
+        size_t n = 0;
+        for (const auto& shard : shards_) {
+            n += shard.map.size();
+        }
+        return n;
+    }
+
+    /// The offset of each shard in a list that stores the shards one after the other
+    std::vector<size_t> shard_offsets() const {
+        std::vector<size_t> offsets(shards_.size() + 1, 0);
+        for (size_t n = 0; n < shards_.size(); ++n) {
+            offsets[n + 1] = offsets[n] + shards_[n].map.size();
+        }
+        return offsets;
+    }
+
+    /// Remove all the determinants
+    void clear() {
+        for (auto& shard : shards_) {
+            shard.map.clear();
+        }
+    }
+
+  private:
+    /// A shard is aligned to a cache line so that locking it does not invalidate its neighbors
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        det_hash<T> map;
+    };
+
+    /// Use the high bits of the hash. std::unordered_map uses the low ones to find buckets
+    size_t shard_index(const Determinant& det) const {
+        return (Determinant::Hash()(det) >> 40) & shard_mask_;
+    }
+
+    std::vector<Shard> shards_;
+    size_t shard_mask_;
+};
+
+} // namespace forte
+
+#endif // _concurrent_det_hash_h_
@@ -30,6 +30,9 @@
 #ifndef _determinant_h_
 #define _determinant_h_
 
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
 
 #include "determinant.hpp"
@@ -46,6 +49,44 @@ using det_vec = std::vector<Determinant>;
 template <typename T = double>
 using det_hash = std::unordered_map<Determinant, T, Determinant::Hash>;
 using det_hash_it = std::unordered_map<Determinant, double, Determinant::Hash>::iterator;
+
+/**
+ * @brief Call f(std::integral_constant<size_t, W>()), where W is the smallest determinant width
+ *        (number of orbitals) that can store norb orbitals. The widths are 64, 128, 256, ...
+ *        and they are capped at Norb (MAX_DET_ORB).
+ *
+ * Code templated on the determinant type can be instantiated for all the widths and the
+ * smallest one selected at runtime from the size of the active space, for example:
+ *
+ *     dispatch_determinant_width(nactv, [&](auto w) {
+ *         using Det = DeterminantImpl<2 * decltype(w)::value>;
+ *         ...
+ *     });
+ *
+ * Throws std::runtime_error if norb > Norb.
+ */
+template <size_t W = 64, typename F>
+decltype(auto) dispatch_determinant_width(size_t norb, F&& f) {
+    if constexpr (W >= Norb) {
+        if (norb > Norb) {
+            throw std::runtime_error(
+                "This build of Forte supports determinants with at most " + std::to_string(Norb) +
+                " orbitals, but " + std::to_string(norb) +
+                " orbitals were requested. Recompile Forte with a larger MAX_DET_ORB.");
+        }
+        return f(std::integral_constant<size_t, Norb>());
+    } else {
+        if (norb <= W)
+            return f(std::integral_constant<size_t, W>());
+        return dispatch_determinant_width<2 * W>(norb, std::forward<F>(f));
+    }
+}
+
+/// Return the smallest determinant width (number of orbitals) that can store norb orbitals.
+/// Throws std::runtime_error if norb > Norb
+inline size_t determinant_width(size_t norb) {
+    return dispatch_determinant_width(norb, [](auto w) { return decltype(w)::value; });
+}
 } // namespace forte
 
 #endif // _determinant_h_
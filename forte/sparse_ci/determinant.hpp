@@ -73,6 +73,7 @@ template <size_t N> class DeterminantImpl : public BitArray<N> {
     using BitArray<N>::operator^;
     using BitArray<N>::operator&;
     using BitArray<N>::fast_a_xor_b_count;
+    using BitArray<N>::fast_a_and_b_parity;
     using BitArray<N>::fast_a_and_b_eq_zero;
 
     /// the number of bits divided by two
@@ -108,6 +109,14 @@ template <size_t N> class DeterminantImpl : public BitArray<N> {
             set_beta_bit(p, occupation_b[p]);
     }
 
+    /// Construct the determinant from the alpha and beta strings
+    DeterminantImpl(const BitArray<nbits_half>& Ia, const BitArray<nbits_half>& Ib) {
+        for (size_t i = 0; i < nwords_half; i++) {
+            words_[i] = Ia.get_word(i);
+            words_[nwords_half + i] = Ib.get_word(i);
+        }
+    }
+
     /// String constructor. Convert a std::string to a determinant.
     /// E.g. DeterminantImpl<64>("0011") gives the determinant|0011>
     DeterminantImpl(const std::string& str) { set_str(*this, str); }
@@ -367,10 +376,10 @@ template <size_t N> class DeterminantImpl : public BitArray<N> {
         // with constexpr we compile only one of these cases
         if constexpr (N == 128) {
             return ui64_bit_count(words_[0]);
-        } else if (N == 256) {
+        } else if constexpr (N == 256) {
             return ui64_bit_count(words_[0]) + ui64_bit_count(words_[1]);
         } else {
-            return count(0, nwords_half);
+            return bitarray_simd::count<nwords_half>(words_.data());
         }
     }
 
@@ -379,20 +388,16 @@ template <size_t N> class DeterminantImpl : public BitArray<N> {
         // with constexpr we compile only one of these cases
         if constexpr (N == 128) {
             return ui64_bit_count(words_[1]);
-        } else if (N == 256) {
+        } else if constexpr (N == 256) {
             return ui64_bit_count(words_[2]) + ui64_bit_count(words_[3]);
         } else {
-            return count(nwords_half, nwords_);
+            return bitarray_simd::count<nwords_half>(words_.data() + nwords_half);
         }
     };
 
     /// Return the number of alpha/beta pairs
     int npair() const {
-        int count = 0;
-        for (size_t k = 0; k < nwords_half; ++k) {
-            count += ui64_bit_count(words_[k] & words_[k + nwords_half]);
-        }
-        return count;
+        return bitarray_simd::and_count<nwords_half>(words_.data(), words_.data() + nwords_half);
     }
 
     /// Perform an alpha-alpha single excitation (i->a)
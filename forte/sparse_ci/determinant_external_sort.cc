@@ -0,0 +1,212 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "psi4/libpsio/psio.hpp"
+
+#include "sparse_ci/determinant_external_sort.h"
+
+namespace forte {
+
+namespace {
+void throw_system_error(const std::string& msg) {
+    throw std::runtime_error("DeterminantExternalSorter: " + msg + " (" + std::strerror(errno) +
+                             ")");
+}
+} // namespace
+
+static_assert(std::is_trivially_copyable<DeterminantExternalSorter::Record>::value,
+              "Records must be trivially copyable to be stored on disk");
+
+DeterminantExternalSorter::DeterminantExternalSorter(const std::string& name) : name_(name) {}
+
+DeterminantExternalSorter::~DeterminantExternalSorter() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+size_t DeterminantExternalSorter::num_records() const {
+    size_t n = 0;
+    for (const auto& run : runs_) {
+        n += run.size;
+    }
+    return n;
+}
+
+void DeterminantExternalSorter::add_run(std::vector<Record>& records) {
+    if (records.empty())
+        return;
+
+    // sort and combine the records
+    std::sort(records.begin(), records.end(),
+              [](const Record& a, const Record& b) { return a.det < b.det; });
+    size_t pos = 0;
+    for (size_t I = 1; I < records.size(); ++I) {
+        if (records[I].det == records[pos].det) {
+            records[pos].value += records[I].value;
+        } else {
+            records[++pos] = records[I];
+        }
+    }
+    const size_t size = pos + 1;
+
+    // reserve space in the file, then write the run outside of the lock
+    size_t offset = 0;
+    int fd = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ == -1) {
+            // create the scratch file and unlink it right away, so that it is removed when it is
+            // closed
+            std::string filename = psi::PSIOManager::shared_object()->get_default_path() +
+                                   "psi." + std::to_string(getpid()) + ".forte." + name_ +
+                                   ".XXXXXX";
+            std::vector<char> filename_buffer(filename.begin(), filename.end());
+            filename_buffer.push_back('\0');
+            fd_ = mkstemp(filename_buffer.data());
+            if (fd_ == -1) {
+                throw_system_error("cannot create the scratch file " + filename);
+            }
+            unlink(filename_buffer.data());
+        }
+        fd = fd_;
+        offset = end_;
+        end_ += size;
+        runs_.push_back({offset, size});
+    }
+
+    const char* data = reinterpret_cast<const char*>(records.data());
+    size_t nbytes = size * sizeof(Record);
+    off_t file_offset = static_cast<off_t>(offset * sizeof(Record));
+    while (nbytes > 0) {
+        ssize_t written = pwrite(fd, data, nbytes, file_offset);
+        if (written == -1) {
+            if (errno == EINTR)
+                continue;
+            throw_system_error("cannot write " + std::to_string(nbytes) + " bytes");
+        }
+        data += written;
+        nbytes -= written;
+        file_offset += written;
+    }
+    records.clear();
+}
+
+void DeterminantExternalSorter::read(size_t offset, size_t count, Record* buffer) const {
+    char* data = reinterpret_cast<char*>(buffer);
+    size_t nbytes = count * sizeof(Record);
+    off_t file_offset = static_cast<off_t>(offset * sizeof(Record));
+    while (nbytes > 0) {
+        ssize_t nread = pread(fd_, data, nbytes, file_offset);
+        if (nread == -1 and errno == EINTR)
+            continue;
+        if (nread <= 0) {
+            throw_system_error("cannot read " + std::to_string(nbytes) + " bytes");
+        }
+        data += nread;
+        nbytes -= nread;
+        file_offset += nread;
+    }
+}
+
+void DeterminantExternalSorter::merge(
+    size_t max_memory, const std::function<void(const Determinant&, double)>& f) const {
+    const size_t nruns = runs_.size();
+    if (nruns == 0)
+        return;
+
+    // A cursor into a run with a buffer of records read from disk
+    struct Cursor {
+        size_t next;      // offset of the next record to read from disk
+        size_t end;       // offset of the end of the run
+        size_t pos = 0;   // position of the current record in the buffer
+        std::vector<Record> buffer;
+    };
+    const size_t buffer_size = std::max<size_t>(1, max_memory / (nruns * sizeof(Record)));
+    std::vector<Cursor> cursors(nruns);
+    auto refill = [&](Cursor& c) {
+        const size_t count = std::min(buffer_size, c.end - c.next);
+        c.buffer.resize(count);
+        read(c.next, count, c.buffer.data());
+        c.next += count;
+        c.pos = 0;
+        return count > 0;
+    };
+
+    // a min-heap of the runs ordered by their current determinant
+    auto greater = [&](size_t a, size_t b) {
+        return cursors[b].buffer[cursors[b].pos].det < cursors[a].buffer[cursors[a].pos].det;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+    for (size_t r = 0; r < nruns; ++r) {
+        cursors[r].next = runs_[r].offset;
+        cursors[r].end = runs_[r].offset + runs_[r].size;
+        if (refill(cursors[r])) {
+            heap.push(r);
+        }
+    }
+
+    Determinant det;
+    double value = 0.0;
+    bool has_det = false;
+    while (not heap.empty()) {
+        size_t r = heap.top();
+        heap.pop();
+        Cursor& c = cursors[r];
+        const Record& record = c.buffer[c.pos];
+        if (has_det and (record.det == det)) {
+            value += record.value;
+        } else {
+            if (has_det) {
+                f(det, value);
+            }
+            det = record.det;
+            value = record.value;
+            has_det = true;
+        }
+        c.pos++;
+        if ((c.pos < c.buffer.size()) or refill(c)) {
+            heap.push(r);
+        }
+    }
+    if (has_det) {
+        f(det, value);
+    }
+}
+
+} // namespace forte
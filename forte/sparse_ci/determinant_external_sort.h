@@ -0,0 +1,112 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _determinant_external_sort_h_
+#define _determinant_external_sort_h_
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "sparse_ci/determinant.h"
+
+namespace forte {
+
+/**
+ * @brief The DeterminantExternalSorter class
+ * Accumulates (determinant, value) records with bounded memory. The records are collected by
+ * the caller in buffers of fixed size. Each full buffer is sorted, the values of identical
+ * determinants are summed, and the result is written to an unlinked scratch file as a sorted
+ * run. merge() then streams the union of all the runs in increasing determinant order, summing
+ * the values of the determinants that appear in more than one run (k-way merge).
+ *
+ * Example use:
+ *
+ *     DeterminantExternalSorter sorter("aci_f_space");
+ *     std::vector<DeterminantExternalSorter::Record> buffer;
+ *     ...                                        // fill the buffer
+ *     sorter.add_run(buffer);                    // can be called by several threads
+ *     sorter.merge(max_memory, [](const Determinant& det, double value) { ... });
+ */
+class DeterminantExternalSorter {
+  public:
+    /// A record stored on disk
+    struct Record {
+        Determinant det;
+        double value;
+    };
+
+    /// Create an empty sorter whose scratch file is labeled by name
+    explicit DeterminantExternalSorter(const std::string& name);
+    ~DeterminantExternalSorter();
+
+    DeterminantExternalSorter(const DeterminantExternalSorter&) = delete;
+    DeterminantExternalSorter& operator=(const DeterminantExternalSorter&) = delete;
+
+    /// Sort the records, combine identical determinants, and store them as a new run. The
+    /// records are cleared. This function is thread safe
+    void add_run(std::vector<Record>& records);
+
+    /// Call f(det, value) for each determinant stored in the runs, in increasing order, with the
+    /// sum of its values. The read buffers use at most max_memory bytes. The runs are not
+    /// modified, so this function can be called more than once
+    void merge(size_t max_memory, const std::function<void(const Determinant&, double)>& f) const;
+
+    /// @return the number of runs
+    size_t num_runs() const { return runs_.size(); }
+    /// @return the number of records stored on disk
+    size_t num_records() const;
+    /// @return the size of the scratch file in bytes
+    size_t disk_size() const { return num_records() * sizeof(Record); }
+
+  private:
+    /// A run of sorted records stored at offset (in records) in the scratch file
+    struct Run {
+        size_t offset;
+        size_t size;
+    };
+
+    /// Read count records starting from record offset
+    void read(size_t offset, size_t count, Record* buffer) const;
+
+    /// The label of the scratch file
+    std::string name_;
+    /// The file descriptor of the scratch file (-1 if no run was stored)
+    int fd_ = -1;
+    /// The number of records stored (or reserved) in the file
+    size_t end_ = 0;
+    /// The runs
+    std::vector<Run> runs_;
+    /// Protects fd_, end_, and runs_
+    std::mutex mutex_;
+};
+
+} // namespace forte
+
+#endif // _determinant_external_sort_h_
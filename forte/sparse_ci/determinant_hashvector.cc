@@ -29,6 +29,7 @@
 
 #include "psi4/libmints/matrix.h"
 
+#include "concurrent_det_hash.h"
 #include "determinant_hashvector.h"
 #include <numeric>
 #include <cmath>
@@ -78,74 +79,105 @@ const Determinant& DeterminantHashVec::get_det(const size_t value) const {
 size_t DeterminantHashVec::get_idx(const Determinant& det) const { return wfn_.find(det); }
 
 void DeterminantHashVec::make_spin_complete(int nmo) {
-    size_t ndet_added = 0;
-    std::vector<size_t> closed(nmo, 0);
-    std::vector<size_t> open(nmo, 0);
-    std::vector<size_t> open_bits(nmo, 0);
-    DeterminantHashVec new_dets;
-
-    for (det_hashvec::iterator it = wfn_.begin(), endit = wfn_.end(); it != endit; ++it) {
-        const Determinant& det = *it;
-        //        outfile->Printf("\n  Original determinant: %s",
-        //        det.str().c_str());
-        for (int i = 0; i < nmo; ++i) {
-            closed[i] = open[i] = 0;
-            open_bits[i] = false;
-        }
+    // Group the open-shell determinants by spatial occupation and number of open alpha orbitals.
+    // All the determinants of a group have the same spin partners, so each group is expanded only
+    // once. A group is represented by the determinant with the open alpha electrons in the lowest
+    // open orbitals. The spin partners have the same spatial occupation, hence the same symmetry.
+    ConcurrentDetHash<bool> groups;
+    size_t ndets = wfn_.size();
+#pragma omp parallel for schedule(static)
+    for (size_t I = 0; I < ndets; ++I) {
+        const Determinant& det = wfn_[I];
         int naopen = 0;
-        int nbopen = 0;
-        int nclosed = 0;
+        int nopen = 0;
         for (int i = 0; i < nmo; ++i) {
-            if (det.get_alfa_bit(i) and (not det.get_beta_bit(i))) {
-                open[naopen + nbopen] = i;
-                naopen += 1;
-            } else if ((not det.get_alfa_bit(i)) and det.get_beta_bit(i)) {
-                open[naopen + nbopen] = i;
-                nbopen += 1;
-            } else if (det.get_alfa_bit(i) and det.get_beta_bit(i)) {
-                closed[nclosed] = i;
-                nclosed += 1;
+            bool a = det.get_alfa_bit(i);
+            if (a != det.get_beta_bit(i)) {
+                naopen += a;
+                nopen += 1;
             }
         }
-
-        if (naopen + nbopen == 0)
+        if (nopen == 0)
             continue;
-
-        // Generate the strings 1111100000
-        //                      {nao}{nbo}
-        for (int i = 0; i < nbopen; ++i)
-            open_bits[i] = false; // 0
-        for (int i = nbopen; i < naopen + nbopen; ++i)
-            open_bits[i] = true; // 1
-        do {
-            // Determinant new_det(nmo); <- xsize
-            Determinant new_det;
-            for (int c = 0; c < nclosed; ++c) {
-                new_det.set_alfa_bit(closed[c], true);
-                new_det.set_beta_bit(closed[c], true);
-            }
-            for (int o = 0; o < naopen + nbopen; ++o) {
-                if (open_bits[o]) { //? not
-                    new_det.set_alfa_bit(open[o], true);
+        Determinant rep;
+        for (int i = 0; i < nmo; ++i) {
+            bool a = det.get_alfa_bit(i);
+            bool b = det.get_beta_bit(i);
+            if (a and b) {
+                rep.set_alfa_bit(i, true);
+                rep.set_beta_bit(i, true);
+            } else if (a or b) {
+                if (naopen > 0) {
+                    rep.set_alfa_bit(i, true);
+                    naopen--;
                 } else {
-                    new_det.set_beta_bit(open[o], true);
+                    rep.set_beta_bit(i, true);
                 }
             }
-            if (!(this->has_det(new_det)) and !(new_dets.has_det(new_det))) {
-                new_dets.add(new_det);
-                //                outfile->Printf("\n  added determinant:
-                //                %s", new_det.str().c_str());
-                ndet_added++;
+        }
+        groups.insert_or_accumulate(rep, true, [](bool&, const bool&) {});
+    }
+
+    // Generate the spin partners of each group that are not in the space. Different groups have
+    // different partners, so the shards can be processed independently
+    size_t nshards = groups.num_shards();
+    std::vector<std::vector<Determinant>> new_dets(nshards);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t s = 0; s < nshards; ++s) {
+        std::vector<int> closed;
+        std::vector<int> open;
+        std::vector<bool> open_bits;
+        for (const auto& group : groups.shard(s)) {
+            const Determinant& rep = group.first;
+            closed.clear();
+            open.clear();
+            open_bits.clear();
+            for (int i = 0; i < nmo; ++i) {
+                bool a = rep.get_alfa_bit(i);
+                bool b = rep.get_beta_bit(i);
+                if (a and b) {
+                    closed.push_back(i);
+                } else if (a or b) {
+                    open.push_back(i);
+                    open_bits.push_back(a);
+                }
             }
-        } while (std::next_permutation(open_bits.begin(), open_bits.begin() + naopen + nbopen));
+            // The strings 0000011111 ({nbo}{nao}) are enumerated in lexicographic order
+            std::sort(open_bits.begin(), open_bits.end());
+            do {
+                Determinant new_det;
+                for (int c : closed) {
+                    new_det.set_alfa_bit(c, true);
+                    new_det.set_beta_bit(c, true);
+                }
+                for (size_t o = 0, nopen = open.size(); o < nopen; ++o) {
+                    if (open_bits[o]) {
+                        new_det.set_alfa_bit(open[o], true);
+                    } else {
+                        new_det.set_beta_bit(open[o], true);
+                    }
+                }
+                if (not has_det(new_det)) {
+                    new_dets[s].push_back(new_det);
+                }
+            } while (std::next_permutation(open_bits.begin(), open_bits.end()));
+        }
+        // The order of the groups in a shard depends on the thread schedule, sort the new
+        // determinants so that the result is reproducible
+        std::sort(new_dets[s].begin(), new_dets[s].end());
+    }
+
+    // Merge the new determinants
+    size_t ndet_added = 0;
+    for (const auto& dets : new_dets) {
+        ndet_added += dets.size();
+    }
+    wfn_.reserve(ndets + ndet_added);
+    for (const auto& dets : new_dets) {
+        for (const Determinant& det : dets) {
+            wfn_.add(det);
+        }
     }
-    // if( ndet_added > 0 ){
-    //    outfile->Printf("\n\n  Determinant space is spin incomplete!");
-    //    outfile->Printf("\n  %zu more determinants were needed.", ndet_added);
-    //}else{
-    //    outfile->Printf("\n\n  Determinant space is spin complete.");
-    //}
-    this->merge(new_dets);
 }
 
 bool DeterminantHashVec::has_det(const Determinant& det) const {
@@ -33,6 +33,7 @@
 
 #include "sparse_ci/determinant.h"
 #include "helpers/hash_vector.h"
+#include "helpers/flat_hash_vector.h"
 
 namespace psi {
 class Matrix;
@@ -45,7 +46,11 @@ namespace forte {
  * Stores a hash of determinants.
  */
 
+#ifdef ENABLE_FLAT_HASH_VECTOR
+using det_hashvec = FlatHashVector<Determinant, Determinant::Hash>;
+#else
 using det_hashvec = HashVector<Determinant, Determinant::Hash>;
+#endif
 
 class DeterminantHashVec {
   public:
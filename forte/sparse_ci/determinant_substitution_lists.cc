@@ -26,7 +26,13 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
 
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/dimension.h"
@@ -48,6 +54,158 @@ using namespace psi;
 
 namespace forte {
 
+namespace {
+/// Pack the index of a determinant and the orbitals of a substitution. The sign of the
+/// substitution is folded into the first orbital index
+OneParticleCoupling make_coupling(size_t index, double sign, int p) {
+    return {static_cast<uint32_t>(index), static_cast<int16_t>(sign > 0.0 ? (p + 1) : (-p - 1))};
+}
+
+TwoParticleCoupling make_coupling(size_t index, double sign, int p, int q) {
+    return {static_cast<uint32_t>(index), static_cast<int16_t>(sign > 0.0 ? (p + 1) : (-p - 1)),
+            static_cast<int16_t>(q)};
+}
+
+/// Check that the determinant indices fit in the 32-bit fields of the coupling lists
+void check_num_determinants(const DeterminantHashVec& wfn) {
+    if (wfn.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("DeterminantSubstitutionLists: the number of determinants (" +
+                                 std::to_string(wfn.size()) +
+                                 ") exceeds the capacity of the coupling lists");
+    }
+}
+
+/// Append the groups of the lists in parts to list and release the memory of parts
+template <typename T>
+void merge_lists(CouplingList<T>& list, std::vector<CouplingList<T>>& parts) {
+    size_t num_groups = 0;
+    size_t num_couplings = 0;
+    for (const auto& part : parts) {
+        num_groups += part.size();
+        num_couplings += part.num_couplings();
+    }
+    list.reserve(num_groups, num_couplings);
+    for (auto& part : parts) {
+        list.append(part);
+        part = CouplingList<T>();
+    }
+}
+
+template <typename T>
+void merge_lists(std::vector<std::vector<T>>& list,
+                 std::vector<std::vector<std::vector<T>>>& parts) {
+    for (auto& part : parts) {
+        list.insert(list.end(), std::make_move_iterator(part.begin()),
+                    std::make_move_iterator(part.end()));
+        part = std::vector<std::vector<T>>();
+    }
+}
+
+/// Build the coupling lists of num_blocks independent blocks in parallel. build_block(n, part)
+/// adds the groups of block n to part. The groups are appended to list in the order of the
+/// blocks, so the result does not depend on the number of threads
+template <typename List, typename F>
+void build_in_parallel(size_t num_blocks, List& list, F build_block) {
+    std::vector<List> parts(num_blocks);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t n = 0; n < num_blocks; ++n) {
+        build_block(n, parts[n]);
+    }
+    merge_lists(list, parts);
+}
+
+/// Sort groups of indices by their first element
+template <typename T, typename Less>
+void sort_groups(std::vector<std::vector<T>>& groups, Less less) {
+    std::sort(groups.begin(), groups.end(),
+              [&](const auto& a, const auto& b) { return less(a.front(), b.front()); });
+}
+
+/// Group the determinants that share the same string. string(I) returns the string of
+/// determinant I. The determinants are first distributed to one shard per thread according to
+/// the hash of their string, and each thread groups the determinants of one shard.
+/// The groups are returned in order of first appearance and contain increasing indices, as
+/// in a serial loop over the determinants
+template <typename F>
+std::vector<std::vector<size_t>> group_determinants(size_t num_dets, F string) {
+    const size_t num_shards = std::max(1, omp_get_max_threads());
+    std::vector<uint32_t> shard(num_dets);
+#pragma omp parallel for
+    for (size_t I = 0; I < num_dets; ++I) {
+        shard[I] = static_cast<uint32_t>(Determinant::Hash()(string(I)) % num_shards);
+    }
+    std::vector<std::vector<std::vector<size_t>>> shard_groups(num_shards);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t s = 0; s < num_shards; ++s) {
+        auto& groups = shard_groups[s];
+        det_hash<size_t> map;
+        for (size_t I = 0; I < num_dets; ++I) {
+            if (shard[I] == s) {
+                auto it = map.emplace(string(I), groups.size());
+                if (it.second) {
+                    groups.emplace_back();
+                }
+                groups[it.first->second].push_back(I);
+            }
+        }
+    }
+    std::vector<std::vector<size_t>> groups;
+    merge_lists(groups, shard_groups);
+    sort_groups(groups, std::less<size_t>());
+    return groups;
+}
+
+/// Group the determinants by the string obtained annihilating one alpha (alfa = true) or beta
+/// electron. strings contains the groups of determinants that share the same alpha (beta)
+/// string. The groups of pairs (orbital, determinant) are returned in the same order as in a
+/// serial loop over the determinants and their occupied orbitals
+std::vector<std::vector<std::pair<int, size_t>>>
+group_annihilated_strings(const det_hashvec& dets, const std::vector<std::vector<size_t>>& strings,
+                          bool alfa, int ncmo) {
+    // find the annihilated strings of each string. There are far fewer strings than determinants
+    std::vector<std::vector<std::pair<int, size_t>>> sources;
+    det_hash<size_t> map;
+    for (size_t k = 0, max_k = strings.size(); k < max_k; ++k) {
+        Determinant det(dets[strings[k].front()]);
+        if (alfa) {
+            det.zero_beta();
+        } else {
+            det.zero_alfa();
+        }
+        const std::vector<int> occ = alfa ? det.get_alfa_occ(ncmo) : det.get_beta_occ(ncmo);
+        for (int i : occ) {
+            Determinant ann_det(det);
+            if (alfa) {
+                ann_det.set_alfa_bit(i, false);
+            } else {
+                ann_det.set_beta_bit(i, false);
+            }
+            auto it = map.emplace(ann_det, sources.size());
+            if (it.second) {
+                sources.emplace_back();
+            }
+            sources[it.first->second].emplace_back(i, k);
+        }
+    }
+    // expand the strings to determinants
+    auto less = [](const std::pair<int, size_t>& a, const std::pair<int, size_t>& b) {
+        return std::tie(a.second, a.first) < std::tie(b.second, b.first);
+    };
+    std::vector<std::vector<std::pair<int, size_t>>> groups(sources.size());
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t g = 0; g < sources.size(); ++g) {
+        for (const auto& [i, k] : sources[g]) {
+            for (size_t I : strings[k]) {
+                groups[g].emplace_back(i, I);
+            }
+        }
+        std::sort(groups[g].begin(), groups[g].end(), less);
+    }
+    sort_groups(groups, less);
+    return groups;
+}
+} // namespace
+
 DeterminantSubstitutionLists::DeterminantSubstitutionLists(
     std::shared_ptr<ActiveSpaceIntegrals> fci_ints)
     : ncmo_(fci_ints->nmo()), mo_symmetry_(fci_ints->active_mo_symmetry()), fci_ints_(fci_ints) {}
@@ -61,79 +219,23 @@ void DeterminantSubstitutionLists::build_strings(const DeterminantHashVec& wfn)
 
     // First build a map from beta strings to determinants
     const det_hashvec& wfn_map = wfn.wfn_hash();
-    {
-        det_hash<size_t> beta_str_hash;
-        size_t nbeta = 0;
-        for (size_t I = 0, max_I = wfn_map.size(); I < max_I; ++I) {
-            // Grab mutable copy of determinant
-            Determinant detI(wfn_map[I]);
-            detI.zero_alfa();
-
-            det_hash<size_t>::iterator it = beta_str_hash.find(detI);
-            size_t b_add;
-            if (it == beta_str_hash.end()) {
-                b_add = nbeta;
-                beta_str_hash[detI] = b_add;
-                nbeta++;
-            } else {
-                b_add = it->second;
-            }
-            beta_strings_.resize(nbeta);
-            beta_strings_[b_add].push_back(I);
-        }
-    }
-
-    {
-        det_hash<size_t> alfa_str_hash;
-        size_t nalfa = 0;
-        for (size_t I = 0, max_I = wfn_map.size(); I < max_I; ++I) {
-            // Grab mutable copy of determinant
-            Determinant detI(wfn_map[I]);
-            detI.zero_beta();
-
-            det_hash<size_t>::iterator it = alfa_str_hash.find(detI);
-            size_t a_add;
-            if (it == alfa_str_hash.end()) {
-                a_add = nalfa;
-                alfa_str_hash[detI] = a_add;
-                nalfa++;
-            } else {
-                a_add = it->second;
-            }
-            alpha_strings_.resize(nalfa);
-            alpha_strings_[a_add].push_back(I);
-        }
-    }
-    // Next build a map from annihilated alpha strings to determinants
-    det_hash<size_t> alfa_str_hash;
-    size_t naalpha = 0;
-    for (size_t I = 0, max_I = wfn_map.size(); I < max_I; ++I) {
-        // Grab mutable copy of determinant
+    beta_strings_ = group_determinants(wfn_map.size(), [&](size_t I) {
+        Determinant detI(wfn_map[I]);
+        detI.zero_alfa();
+        return detI;
+    });
+    alpha_strings_ = group_determinants(wfn_map.size(), [&](size_t I) {
         Determinant detI(wfn_map[I]);
         detI.zero_beta();
-        const std::vector<int>& aocc = detI.get_alfa_occ(ncmo_);
-        for (int i = 0, nalfa = aocc.size(); i < nalfa; ++i) {
-            int ii = aocc[i];
-            Determinant ann_det(detI);
-            ann_det.set_alfa_bit(ii, false);
-
-            size_t a_add;
-            det_hash<size_t>::iterator it = alfa_str_hash.find(ann_det);
-            if (it == alfa_str_hash.end()) {
-                a_add = naalpha;
-                alfa_str_hash[ann_det] = a_add;
-                naalpha++;
-            } else {
-                a_add = it->second;
-            }
-            alpha_a_strings_.resize(naalpha);
-            alpha_a_strings_[a_add].push_back(std::make_pair(ii, I));
-        }
-    }
+        return detI;
+    });
+    // Next build a map from annihilated alpha strings to determinants
+    alpha_a_strings_ = group_annihilated_strings(wfn_map, alpha_strings_, true, ncmo_);
 }
 
 void DeterminantSubstitutionLists::op_s_lists(const DeterminantHashVec& wfn) {
     timer ops("Single sub. lists");
+    check_num_determinants(wfn);
 
     if (!quiet_) {
         print_h2("Computing 1 Coupling Lists");
@@ -143,10 +245,10 @@ void DeterminantSubstitutionLists::op_s_lists(const DeterminantHashVec& wfn) {
     const det_hashvec& dets = wfn.wfn_hash();
 
     timer ann("A lists");
-    for (size_t b = 0, max_b = beta_strings_.size(); b < max_b; ++b) {
+    build_in_parallel(beta_strings_.size(), a_list_, [&](size_t b, auto& list) {
         size_t na_ann = 0;
-        std::vector<std::vector<std::pair<size_t, short>>> tmp;
-        std::vector<size_t>& c_dets = beta_strings_[b];
+        std::vector<std::vector<OneParticleCoupling>> tmp;
+        const std::vector<size_t>& c_dets = beta_strings_[b];
         det_hash<int> map_a_ann;
         for (size_t I = 0, maxI = c_dets.size(); I < maxI; ++I) {
             size_t index = c_dets[I];
@@ -170,27 +272,24 @@ void DeterminantSubstitutionLists::op_s_lists(const DeterminantHashVec& wfn) {
                 } else {
                     detJ_add = search->second;
                 }
-                tmp[detJ_add].push_back(std::make_pair(index, sign > 0.0 ? (ii + 1) : (-ii - 1)));
+                tmp[detJ_add].push_back(make_coupling(index, sign, ii));
             }
         }
-        // size_t idx = 0;
         for (auto& vec : tmp) {
             if (vec.size() > 1) {
-                a_list_.push_back(vec);
-                //  a_list_[idx] = vec;
-                //  idx++;
+                list.add_group(vec);
             }
         }
-    }
+    });
     if (!quiet_) {
         outfile->Printf("\n        α          %.3e seconds", ann.stop());
     }
 
     timer bnn("B lists");
-    for (size_t a = 0, max_a = alpha_strings_.size(); a < max_a; ++a) {
+    build_in_parallel(alpha_strings_.size(), b_list_, [&](size_t a, auto& list) {
         size_t nb_ann = 0;
-        std::vector<std::vector<std::pair<size_t, short>>> tmp;
-        std::vector<size_t>& c_dets = alpha_strings_[a];
+        std::vector<std::vector<OneParticleCoupling>> tmp;
+        const std::vector<size_t>& c_dets = alpha_strings_[a];
         det_hash<int> map_b_ann;
         for (size_t I = 0, maxI = c_dets.size(); I < maxI; ++I) {
             size_t index = c_dets[I];
@@ -213,15 +312,15 @@ void DeterminantSubstitutionLists::op_s_lists(const DeterminantHashVec& wfn) {
                 } else {
                     detJ_add = search->second;
                 }
-                tmp[detJ_add].push_back(std::make_pair(index, sign > 0.0 ? (ii + 1) : (-ii - 1)));
+                tmp[detJ_add].push_back(make_coupling(index, sign, ii));
             }
         }
         for (auto& vec : tmp) {
             if (vec.size() > 1) {
-                b_list_.push_back(vec);
+                list.add_group(vec);
             }
         }
-    }
+    });
     if (!quiet_) {
         outfile->Printf("\n        β          %.3e seconds", bnn.stop());
     }
@@ -229,6 +328,7 @@ void DeterminantSubstitutionLists::op_s_lists(const DeterminantHashVec& wfn) {
 
 void DeterminantSubstitutionLists::tp_s_lists(const DeterminantHashVec& wfn) {
     timer ops("Double sub. lists");
+    check_num_determinants(wfn);
 
     if (!quiet_) {
         print_h2("Computing 2 Coupling Lists");
@@ -239,11 +339,11 @@ void DeterminantSubstitutionLists::tp_s_lists(const DeterminantHashVec& wfn) {
     // Generate alpha-alpha coupling list
     {
         timer aa("AA lists");
-        for (size_t b = 0, max_b = beta_strings_.size(); b < max_b; ++b) {
+        build_in_parallel(beta_strings_.size(), aa_list_, [&](size_t b, auto& list) {
             size_t naa_ann = 0;
-            std::vector<std::vector<std::tuple<size_t, short, short>>> tmp;
+            std::vector<std::vector<TwoParticleCoupling>> tmp;
             det_hash<int> map_aa_ann;
-            std::vector<size_t> c_dets = beta_strings_[b];
+            const std::vector<size_t>& c_dets = beta_strings_[b];
             size_t max_I = c_dets.size();
             for (size_t I = 0; I < max_I; ++I) {
                 size_t idx = c_dets[I];
@@ -272,18 +372,17 @@ void DeterminantSubstitutionLists::tp_s_lists(const DeterminantHashVec& wfn) {
                         } else {
                             detJ_add = it->second;
                         }
-                        tmp[detJ_add].push_back(
-                            std::make_tuple(idx, (sign > 0.0) ? (ii + 1) : (-ii - 1), jj));
+                        tmp[detJ_add].push_back(make_coupling(idx, sign, ii, jj));
                     }
                 }
             }
             for (auto& vec : tmp) {
                 if (vec.size() > 1) {
-                    aa_list_.push_back(vec);
+                    list.add_group(vec);
                 }
             }
-        }
-        if (!quiet_) {
+        });
+            if (!quiet_) {
             outfile->Printf("\n        αα         %.3e seconds", aa.stop());
         }
     }
@@ -291,11 +390,11 @@ void DeterminantSubstitutionLists::tp_s_lists(const DeterminantHashVec& wfn) {
     // Generate beta-beta coupling list
     {
         timer bb("BB lists");
-        for (size_t a = 0, max_a = alpha_strings_.size(); a < max_a; ++a) {
+        build_in_parallel(alpha_strings_.size(), bb_list_, [&](size_t a, auto& list) {
             size_t nbb_ann = 0;
-            std::vector<std::vector<std::tuple<size_t, short, short>>> tmp;
+            std::vector<std::vector<TwoParticleCoupling>> tmp;
             det_hash<int> map_bb_ann;
-            std::vector<size_t>& c_dets = alpha_strings_[a];
+            const std::vector<size_t>& c_dets = alpha_strings_[a];
             size_t max_I = c_dets.size();
 
             for (size_t I = 0; I < max_I; ++I) {
@@ -327,18 +426,17 @@ void DeterminantSubstitutionLists::tp_s_lists(const DeterminantHashVec& wfn) {
                             detJ_add = it->second;
                         }
 
-                        tmp[detJ_add].push_back(
-                            std::make_tuple(idx, (sign > 0.0) ? (ii + 1) : (-ii - 1), jj));
+                        tmp[detJ_add].push_back(make_coupling(idx, sign, ii, jj));
                     }
                 }
             }
             for (auto& vec : tmp) {
                 if (vec.size() > 1) {
-                    bb_list_.push_back(vec);
+                    list.add_group(vec);
                 }
             }
-        }
-        if (!quiet_) {
+        });
+            if (!quiet_) {
             outfile->Printf("\n        ββ         %.3e seconds", bb.stop());
         }
     }
@@ -346,11 +444,11 @@ void DeterminantSubstitutionLists::tp_s_lists(const DeterminantHashVec& wfn) {
     // Generate alfa-beta coupling list
     {
         timer ab("AB lists");
-        for (size_t a = 0, max_a = alpha_a_strings_.size(); a < max_a; ++a) {
+        build_in_parallel(alpha_a_strings_.size(), ab_list_, [&](size_t a, auto& list) {
             size_t nab_ann = 0;
-            std::vector<std::vector<std::tuple<size_t, short, short>>> tmp;
+            std::vector<std::vector<TwoParticleCoupling>> tmp;
             det_hash<int> map_ab_ann;
-            std::vector<std::pair<int, size_t>>& c_dets = alpha_a_strings_[a];
+            const std::vector<std::pair<int, size_t>>& c_dets = alpha_a_strings_[a];
             size_t max_I = c_dets.size();
             for (size_t I = 0; I < max_I; ++I) {
                 size_t idx = c_dets[I].second;
@@ -378,17 +476,16 @@ void DeterminantSubstitutionLists::tp_s_lists(const DeterminantHashVec& wfn) {
                     } else {
                         detJ_add = it->second;
                     }
-                    tmp[detJ_add].push_back(
-                        std::make_tuple(idx, (sign > 0.0) ? (ii + 1) : (-ii - 1), jj));
+                    tmp[detJ_add].push_back(make_coupling(idx, sign, ii, jj));
                 }
             }
             for (auto& vec : tmp) {
                 if (vec.size() > 1) {
-                    ab_list_.push_back(vec);
+                    list.add_group(vec);
                 }
             }
-        }
-        if (!quiet_) {
+        });
+            if (!quiet_) {
             outfile->Printf("\n        αβ         %.3e seconds", ab.stop());
         }
     }
@@ -417,11 +514,11 @@ void DeterminantSubstitutionLists::three_s_lists(const DeterminantHashVec& wfn)
     /// AAA coupling
     {
         timer aaa("AAA lists");
-        for (size_t b = 0, max_b = beta_strings_.size(); b < max_b; ++b) {
+        build_in_parallel(beta_strings_.size(), aaa_list_, [&](size_t b, auto& list) {
             size_t naa_ann = 0;
             std::vector<std::vector<std::tuple<size_t, short, short, short>>> tmp;
             det_hash<int> map_aaa;
-            std::vector<size_t> c_dets = beta_strings_[b];
+            const std::vector<size_t>& c_dets = beta_strings_[b];
             size_t max_I = c_dets.size();
             for (size_t I = 0; I < max_I; ++I) {
                 size_t idx = c_dets[I];
@@ -462,10 +559,10 @@ void DeterminantSubstitutionLists::three_s_lists(const DeterminantHashVec& wfn)
             }
             for (auto& vec : tmp) {
                 if (vec.size() > 1) {
-                    aaa_list_.push_back(vec);
+                    list.push_back(vec);
                 }
             }
-        }
+        });
         if (!quiet_) {
             outfile->Printf("\n        ααα        %.3e seconds", aaa.stop());
         }
@@ -475,37 +572,11 @@ void DeterminantSubstitutionLists::three_s_lists(const DeterminantHashVec& wfn)
     {
         timer aab("AAB lists");
         // We need the beta-1 list:
-        const det_hashvec& wfn_map = wfn.wfn_hash();
-        std::vector<std::vector<std::pair<int, size_t>>> beta_string;
-        det_hash<size_t> beta_str_hash;
-        size_t nabeta = 0;
-        for (size_t I = 0, max_I = wfn_map.size(); I < max_I; ++I) {
-            // Grab mutable copy of determinant
-            Determinant detI(wfn_map[I]);
-            detI.zero_alfa();
-            std::vector<int> bocc = detI.get_beta_occ(ncmo_);
-            for (int i = 0, nbeta = bocc.size(); i < nbeta; ++i) {
-                int ii = bocc[i];
-                Determinant ann_det(detI);
-                ann_det.set_beta_bit(ii, false);
-
-                size_t b_add;
-                det_hash<size_t>::iterator it = beta_str_hash.find(ann_det);
-                if (it == beta_str_hash.end()) {
-                    b_add = nabeta;
-                    beta_str_hash[ann_det] = b_add;
-                    nabeta++;
-                } else {
-                    b_add = it->second;
-                }
-                beta_string.resize(nabeta);
-                beta_string[b_add].push_back(std::make_pair(ii, I));
-            }
-        }
-        for (size_t b = 0, max_b = beta_string.size(); b < max_b; ++b) {
+        const auto beta_string = group_annihilated_strings(dets, beta_strings_, false, ncmo_);
+        build_in_parallel(beta_string.size(), aab_list_, [&](size_t b, auto& list) {
             size_t naab_ann = 0;
             det_hash<int> aab_ann_map;
-            std::vector<std::pair<int, size_t>>& c_dets = beta_string[b];
+            const std::vector<std::pair<int, size_t>>& c_dets = beta_string[b];
             std::vector<std::vector<std::tuple<size_t, short, short, short>>> tmp;
             size_t max_I = c_dets.size();
             for (size_t I = 0; I < max_I; ++I) {
@@ -550,10 +621,10 @@ void DeterminantSubstitutionLists::three_s_lists(const DeterminantHashVec& wfn)
             }
             for (auto& vec : tmp) {
                 if (vec.size() > 1) {
-                    aab_list_.push_back(vec);
+                    list.push_back(vec);
                 }
             }
-        }
+        });
         if (!quiet_)
             outfile->Printf("\n        ααβ        %.3e seconds", aab.stop());
     }
@@ -561,10 +632,10 @@ void DeterminantSubstitutionLists::three_s_lists(const DeterminantHashVec& wfn)
     /// ABB coupling
     {
         timer abb("ABB lists");
-        for (size_t a = 0, max_a = alpha_a_strings_.size(); a < max_a; ++a) {
+        build_in_parallel(alpha_a_strings_.size(), abb_list_, [&](size_t a, auto& list) {
             size_t nabb_ann = 0;
             det_hash<int> abb_ann_map;
-            std::vector<std::pair<int, size_t>>& c_dets = alpha_a_strings_[a];
+            const std::vector<std::pair<int, size_t>>& c_dets = alpha_a_strings_[a];
             size_t max_I = c_dets.size();
             std::vector<std::vector<std::tuple<size_t, short, short, short>>> tmp;
 
@@ -610,10 +681,10 @@ void DeterminantSubstitutionLists::three_s_lists(const DeterminantHashVec& wfn)
             }
             for (auto& vec : tmp) {
                 if (vec.size() > 1) {
-                    abb_list_.push_back(vec);
+                    list.push_back(vec);
                 }
             }
-        }
+        });
         if (!quiet_)
             outfile->Printf("\n        αββ        %.3e seconds", abb.stop());
     }
@@ -621,10 +692,10 @@ void DeterminantSubstitutionLists::three_s_lists(const DeterminantHashVec& wfn)
     /// BBB coupling
     {
         timer bbb("BBB lists");
-        for (size_t a = 0, max_a = alpha_strings_.size(); a < max_a; ++a) {
+        build_in_parallel(alpha_strings_.size(), bbb_list_, [&](size_t a, auto& list) {
             size_t nbbb_ann = 0;
             det_hash<int> bbb_ann_map;
-            std::vector<size_t>& c_dets = alpha_strings_[a];
+            const std::vector<size_t>& c_dets = alpha_strings_[a];
             size_t max_I = c_dets.size();
             std::vector<std::vector<std::tuple<size_t, short, short, short>>> tmp;
 
@@ -672,10 +743,10 @@ void DeterminantSubstitutionLists::three_s_lists(const DeterminantHashVec& wfn)
             }
             for (auto& vec : tmp) {
                 if (vec.size() > 1) {
-                    bbb_list_.push_back(vec);
+                    list.push_back(vec);
                 }
             }
-        }
+        });
         if (not quiet_)
             outfile->Printf("\n        βββ        %.3e seconds", bbb.stop());
     }
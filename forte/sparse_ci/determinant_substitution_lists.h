@@ -29,6 +29,10 @@
 #ifndef _determinant_substitution_lists_h_
 #define _determinant_substitution_lists_h_
 
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
 #include "integrals/active_space_integrals.h"
 #include "sparse_ci/determinant_hashvector.h"
 #include "sparse_ci/determinant.h"
@@ -43,6 +47,98 @@ namespace forte {
 
 using wfn_hash = det_hash<double>;
 
+/// A determinant coupled through a one-particle substitution. The orbital index is stored
+/// together with the sign of the substitution as +/-(p + 1)
+struct OneParticleCoupling {
+    uint32_t index;
+    int16_t signed_p;
+    /// @return the orbital index p
+    size_t p() const { return std::abs(signed_p) - 1; }
+    /// @return the sign of the substitution
+    double sign() const { return signed_p > 0 ? 1.0 : -1.0; }
+};
+
+/// A determinant coupled through a two-particle substitution. The first orbital index is
+/// stored together with the sign of the substitution as +/-(p + 1)
+struct TwoParticleCoupling {
+    uint32_t index;
+    int16_t signed_p;
+    int16_t q;
+    /// @return the orbital index p
+    size_t p() const { return std::abs(signed_p) - 1; }
+    /// @return the sign of the substitution
+    double sign() const { return signed_p > 0 ? 1.0 : -1.0; }
+};
+
+/**
+ * @brief Groups of coupled determinants stored in a single contiguous buffer.
+ *
+ * The couplings of group K are stored in the range [offsets_[K], offsets_[K + 1]) of the
+ * buffer, which avoids the memory overhead of one vector per group.
+ */
+template <typename T> class CouplingList {
+  public:
+    /// A view of the couplings of one group
+    class Group {
+      public:
+        Group(const T* begin, const T* end) : begin_(begin), end_(end) {}
+        const T* begin() const { return begin_; }
+        const T* end() const { return end_; }
+        size_t size() const { return end_ - begin_; }
+        const T& operator[](size_t n) const { return begin_[n]; }
+
+      private:
+        const T* begin_;
+        const T* end_;
+    };
+
+    /// @return the number of groups
+    size_t size() const { return offsets_.size() - 1; }
+    /// @return the couplings of group K
+    Group operator[](size_t K) const {
+        return Group(couplings_.data() + offsets_[K], couplings_.data() + offsets_[K + 1]);
+    }
+    /// Append a group of couplings
+    void add_group(const std::vector<T>& couplings) {
+        couplings_.insert(couplings_.end(), couplings.begin(), couplings.end());
+        offsets_.push_back(couplings_.size());
+    }
+    /// Append the groups of another list
+    void append(const CouplingList& other) {
+        const size_t shift = couplings_.size();
+        couplings_.insert(couplings_.end(), other.couplings_.begin(), other.couplings_.end());
+        for (size_t K = 1; K < other.offsets_.size(); ++K) {
+            offsets_.push_back(other.offsets_[K] + shift);
+        }
+    }
+    /// Reserve memory for additional groups and couplings
+    void reserve(size_t num_groups, size_t num_couplings) {
+        offsets_.reserve(offsets_.size() + num_groups);
+        couplings_.reserve(couplings_.size() + num_couplings);
+    }
+    /// Remove all the groups
+    void clear() {
+        couplings_.clear();
+        offsets_.assign(1, 0);
+    }
+    /// @return the total number of couplings
+    size_t num_couplings() const { return couplings_.size(); }
+    /// @return a pointer to the couplings of all the groups
+    const T* data() const { return couplings_.data(); }
+    /// @return the offsets of the groups (num_groups + 1 elements)
+    const std::vector<size_t>& offsets() const { return offsets_; }
+    /// @return the memory used by this list in bytes
+    size_t memory() const {
+        return couplings_.capacity() * sizeof(T) + offsets_.capacity() * sizeof(size_t);
+    }
+
+  private:
+    /// The couplings of all the groups
+    std::vector<T> couplings_;
+    /// The offset of the first coupling of each group plus the total number of couplings
+    std::vector<size_t> offsets_ = std::vector<size_t>(1, 0);
+};
+
 class DeterminantSubstitutionLists {
   public:
     /// Default constructor
@@ -66,12 +162,14 @@ class DeterminantSubstitutionLists {
 
     void build_strings(const DeterminantHashVec& wfn);
 
-    std::vector<std::vector<std::pair<size_t, short>>> a_list_;
-    std::vector<std::vector<std::pair<size_t, short>>> b_list_;
+    /// One particle lists
+    CouplingList<OneParticleCoupling> a_list_;
+    CouplingList<OneParticleCoupling> b_list_;
 
-    std::vector<std::vector<std::tuple<size_t, short, short>>> aa_list_;
-    std::vector<std::vector<std::tuple<size_t, short, short>>> bb_list_;
-    std::vector<std::vector<std::tuple<size_t, short, short>>> ab_list_;
+    /// Two particle lists
+    CouplingList<TwoParticleCoupling> aa_list_;
+    CouplingList<TwoParticleCoupling> bb_list_;
+    CouplingList<TwoParticleCoupling> ab_list_;
 
     /// Three particle lists
     std::vector<std::vector<std::tuple<size_t, short, short, short>>> aaa_list_;
@@ -26,13 +26,122 @@
  * @END LICENSE
  */
 
+#include <algorithm>
+#include <numeric>
+
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/vector.h"
+
+#include "helpers/iterative_solvers.h"
 #include "helpers/string_algorithms.h"
 #include "integrals/active_space_integrals.h"
 #include "sigma_vector_dynamic.h"
+#include "sigma_vector_incremental.h"
 #include "sigma_vector_sparse_list.h"
+#ifdef HAVE_CUDA
+#include "sigma_vector_gpu.h"
+#endif
 
 namespace forte {
 
+namespace {
+/// Return the indices of the determinants of space with the same spatial configuration as det
+/// (det included)
+std::vector<size_t> same_configuration(const DeterminantHashVec& space, const Determinant& det,
+                                       size_t nmo) {
+    std::vector<size_t> closed, open;
+    size_t naopen = 0;
+    for (size_t p = 0; p < nmo; ++p) {
+        bool a = det.get_alfa_bit(p);
+        bool b = det.get_beta_bit(p);
+        if (a and b) {
+            closed.push_back(p);
+        } else if (a or b) {
+            open.push_back(p);
+            naopen += a;
+        }
+    }
+    // loop over all the ways to distribute the alpha electrons among the open shells
+    std::vector<bool> open_alfa(open.size(), false);
+    std::fill(open_alfa.end() - naopen, open_alfa.end(), true);
+    std::vector<size_t> indices;
+    do {
+        Determinant new_det;
+        for (size_t p : closed) {
+            new_det.set_alfa_bit(p, true);
+            new_det.set_beta_bit(p, true);
+        }
+        for (size_t o = 0; o < open.size(); ++o) {
+            if (open_alfa[o]) {
+                new_det.set_alfa_bit(open[o], true);
+            } else {
+                new_det.set_beta_bit(open[o], true);
+            }
+        }
+        if (space.has_det(new_det)) {
+            indices.push_back(space.get_idx(new_det));
+        }
+    } while (std::next_permutation(open_alfa.begin(), open_alfa.end()));
+    return indices;
+}
+} // namespace
+
+void SigmaVector::compute_sigma_block(const std::vector<std::shared_ptr<psi::Vector>>& sigma,
+                                      const std::vector<std::shared_ptr<psi::Vector>>& b) {
+    if (sigma.size() != b.size()) {
+        throw std::runtime_error("SigmaVector::compute_sigma_block: the number of sigma (" +
+                                 std::to_string(sigma.size()) + ") and b (" +
+                                 std::to_string(b.size()) + ") vectors do not match");
+    }
+    for (size_t n = 0, nvec = b.size(); n < nvec; ++n) {
+        compute_sigma(sigma[n], b[n]);
+    }
+}
+
+std::shared_ptr<DavidsonLiuPreconditioner> SigmaVector::preconditioner(size_t max_block_size) {
+    if (max_block_size == 0)
+        return nullptr;
+
+    psi::Vector diagonal("diag", size_);
+    get_diagonal(diagonal);
+
+    // sort the determinants by their diagonal energy
+    std::vector<size_t> order(size_);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t I, size_t J) {
+        return diagonal.get(I) < diagonal.get(J);
+    });
+
+    // add whole configurations to the block until it is full
+    std::vector<size_t> block;
+    std::vector<bool> in_block(size_, false);
+    const size_t nmo = fci_ints_->nmo();
+    for (size_t I : order) {
+        if (in_block[I])
+            continue;
+        auto config = same_configuration(space_, space_[I], nmo);
+        if (block.size() + config.size() > max_block_size)
+            break;
+        for (size_t J : config) {
+            in_block[J] = true;
+            block.push_back(J);
+        }
+    }
+
+    // form the Hamiltonian in the block
+    size_t n = block.size();
+    auto H_block = std::make_shared<psi::Matrix>("H block", n, n);
+    for (size_t i = 0; i < n; ++i) {
+        H_block->set(i, i, diagonal.get(block[i]));
+        for (size_t j = 0; j < i; ++j) {
+            double H_ij = fci_ints_->slater_rules(space_[block[i]], space_[block[j]]);
+            H_block->set(i, j, H_ij);
+            H_block->set(j, i, H_ij);
+        }
+    }
+    return std::make_shared<BlockPreconditioner>(diagonal, block, H_block);
+}
+
 SigmaVectorType string_to_sigma_vector_type(std::string type) {
     //    to_upper_string(type);
     if (type == "FULL") {
@@ -41,6 +150,10 @@ SigmaVectorType string_to_sigma_vector_type(std::string type) {
         return SigmaVectorType::SparseList;
     } else if (type == "DYNAMIC") {
         return SigmaVectorType::Dynamic;
+    } else if (type == "GPU") {
+        return SigmaVectorType::GPU;
+    } else if (type == "INCREMENTAL") {
+        return SigmaVectorType::Incremental;
     }
     throw std::runtime_error("string_to_sigma_vector_type() called with incorrect type: " + type);
     return SigmaVectorType::Dynamic;
@@ -53,9 +166,18 @@ std::shared_ptr<SigmaVector> make_sigma_vector(DeterminantHashVec& space,
     if (sigma_type == SigmaVectorType::Dynamic) {
         sigma_vector = std::make_shared<SigmaVectorDynamic>(space, fci_ints, max_memory);
     } else if (sigma_type == SigmaVectorType::SparseList) {
-        sigma_vector = std::make_shared<SigmaVectorSparseList>(space, fci_ints);
+        sigma_vector = std::make_shared<SigmaVectorSparseList>(space, fci_ints, max_memory);
     } else if (sigma_type == SigmaVectorType::Full) {
         sigma_vector = std::make_shared<SigmaVectorFull>(space, fci_ints);
+    } else if (sigma_type == SigmaVectorType::Incremental) {
+        sigma_vector = std::make_shared<SigmaVectorIncremental>(space, fci_ints);
+    } else if (sigma_type == SigmaVectorType::GPU) {
+#ifdef HAVE_CUDA
+        sigma_vector = std::make_shared<SigmaVectorGPU>(space, fci_ints);
+#else
+        throw std::runtime_error("make_sigma_vector(): the GPU sigma vector is not available. "
+                                 "Compile Forte with ENABLE_CUDA=ON to use it.");
+#endif
     }
     return sigma_vector;
 }
@@ -31,6 +31,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "sparse_ci/determinant_hashvector.h"
 
@@ -40,9 +41,10 @@ class Vector;
 
 namespace forte {
 
-enum class SigmaVectorType { Dynamic, SparseList, Full };
+enum class SigmaVectorType { Dynamic, SparseList, Full, GPU, Incremental };
 
 class ActiveSpaceIntegrals;
+class DavidsonLiuPreconditioner;
 class DeterminantSubstitutionLists;
 
 /**
@@ -68,7 +70,18 @@ class SigmaVector {
 
     virtual void compute_sigma(std::shared_ptr<psi::Vector> sigma,
                                std::shared_ptr<psi::Vector> b) = 0;
+    /// Compute the sigma vectors of a block of vectors, sigma[n] = H b[n]. The default
+    /// implementation calls compute_sigma() for each vector. Derived classes can override it to
+    /// traverse the Hamiltonian couplings only once for the whole block
+    virtual void compute_sigma_block(const std::vector<std::shared_ptr<psi::Vector>>& sigma,
+                                     const std::vector<std::shared_ptr<psi::Vector>>& b);
     virtual void get_diagonal(psi::Vector& diag) = 0;
+    /// Return a preconditioner for the Davidson-Liu solver built from a block of at most
+    /// max_block_size determinants, or nullptr if max_block_size is zero. The default
+    /// implementation treats the Hamiltonian exactly in the block of the lowest-energy
+    /// determinants. Determinants with the same spatial configuration are added to the block
+    /// together, so that the block is spin adapted when the space is spin complete
+    virtual std::shared_ptr<DavidsonLiuPreconditioner> preconditioner(size_t max_block_size);
     virtual void add_bad_roots(std::vector<std::vector<std::pair<size_t, double>>>& bad_states) = 0;
     virtual double compute_spin(const std::vector<double>& c) = 0;
 
@@ -0,0 +1,259 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+#include <cmath>
+#include <unordered_map>
+
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/vector.h"
+
+#include "integrals/active_space_integrals.h"
+#include "sigma_vector_csf.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#define omp_get_num_threads() 1
+#endif
+
+namespace forte {
+
+SigmaVectorCSF::SigmaVectorCSF(const DeterminantHashVec& space,
+                               std::shared_ptr<SigmaVector> det_sigma, int multiplicity)
+    : SigmaVector(space, det_sigma->as_ints(), det_sigma->sigma_vector_type(),
+                  "CSF/" + det_sigma->label()),
+      det_sigma_(det_sigma) {
+    if (det_sigma_->size() != space.size()) {
+        throw std::runtime_error("SigmaVectorCSF: the determinant sigma vector object and the "
+                                 "determinant space have different sizes");
+    }
+    build_csfs(multiplicity);
+    if (size_ == 0) {
+        throw std::runtime_error("SigmaVectorCSF: the determinant space contains no CSF with "
+                                 "multiplicity " +
+                                 std::to_string(multiplicity));
+    }
+}
+
+void SigmaVectorCSF::build_csfs(int multiplicity) {
+    const double S = 0.5 * static_cast<double>(multiplicity - 1);
+    const double target_S2 = S * (S + 1.0);
+    const double S2_threshold = 1.0e-6;
+
+    // group the determinants by spatial configuration
+    std::unordered_map<Determinant, size_t, Determinant::Hash> conf_map;
+    std::vector<std::vector<size_t>> confs;
+    const size_t ndets = space_.size();
+    for (size_t I = 0; I < ndets; ++I) {
+        const Determinant& d = space_.get_det(I);
+        const auto Ia = d.get_alfa_bits();
+        const auto Ib = d.get_beta_bits();
+        Determinant conf(Ia | Ib, Ia & Ib);
+        auto it = conf_map.find(conf);
+        if (it == conf_map.end()) {
+            conf_map[conf] = confs.size();
+            confs.push_back({I});
+        } else {
+            confs[it->second].push_back(I);
+        }
+    }
+
+    // the CSFs and the diagonal of the Hamiltonian in the CSF basis of each configuration
+    const size_t nconfs = confs.size();
+    std::vector<std::vector<double>> conf_coefs(nconfs);
+    std::vector<std::vector<double>> conf_diag(nconfs);
+    const int nthreads = fci_ints_->get_integral_type() == DiskDF ? 1 : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for (size_t n = 0; n < nconfs; ++n) {
+        const auto& dets = confs[n];
+        const size_t nd = dets.size();
+        if (nd == 1) {
+            const Determinant& d = space_.get_det(dets[0]);
+            if (std::fabs(spin2(d, d) - target_S2) < S2_threshold) {
+                conf_coefs[n] = {1.0};
+                conf_diag[n] = {fci_ints_->energy(d)};
+            }
+            continue;
+        }
+        psi::Matrix S2("S^2", nd, nd);
+        psi::Matrix H("H", nd, nd);
+        for (size_t i = 0; i < nd; ++i) {
+            const Determinant& di = space_.get_det(dets[i]);
+            for (size_t j = i; j < nd; ++j) {
+                const Determinant& dj = space_.get_det(dets[j]);
+                const double S2ij = spin2(di, dj);
+                const double Hij = fci_ints_->slater_rules(di, dj);
+                S2.set(i, j, S2ij);
+                S2.set(j, i, S2ij);
+                H.set(i, j, Hij);
+                H.set(j, i, Hij);
+            }
+        }
+        psi::Matrix S2evecs("S^2 evecs", nd, nd);
+        psi::Vector S2evals("S^2 evals", nd);
+        S2.diagonalize(S2evecs, S2evals);
+        std::vector<size_t> csfs;
+        for (size_t k = 0; k < nd; ++k) {
+            if (std::fabs(S2evals.get(k) - target_S2) < S2_threshold)
+                csfs.push_back(k);
+        }
+        const size_t nc = csfs.size();
+        auto& coefs = conf_coefs[n];
+        coefs.resize(nd * nc);
+        for (size_t i = 0; i < nd; ++i) {
+            for (size_t k = 0; k < nc; ++k) {
+                coefs[i * nc + k] = S2evecs.get(i, csfs[k]);
+            }
+        }
+        for (size_t k = 0; k < nc; ++k) {
+            double e = 0.0;
+            for (size_t i = 0; i < nd; ++i) {
+                for (size_t j = 0; j < nd; ++j) {
+                    e += coefs[i * nc + k] * H.get(i, j) * coefs[j * nc + k];
+                }
+            }
+            conf_diag[n].push_back(e);
+        }
+    }
+
+    // store the configurations with at least one CSF
+    conf_det_offset_ = {0};
+    conf_csf_offset_ = {0};
+    conf_coef_offset_ = {0};
+    diag_.clear();
+    for (size_t n = 0; n < nconfs; ++n) {
+        if (conf_diag[n].empty())
+            continue;
+        conf_dets_.insert(conf_dets_.end(), confs[n].begin(), confs[n].end());
+        coefs_.insert(coefs_.end(), conf_coefs[n].begin(), conf_coefs[n].end());
+        diag_.insert(diag_.end(), conf_diag[n].begin(), conf_diag[n].end());
+        conf_det_offset_.push_back(conf_dets_.size());
+        conf_csf_offset_.push_back(diag_.size());
+        conf_coef_offset_.push_back(coefs_.size());
+    }
+    size_ = diag_.size();
+}
+
+void SigmaVectorCSF::csf_to_det(const psi::Vector& c_csf, psi::Vector& c_det) const {
+    const double* c_csf_p = const_cast<psi::Vector&>(c_csf).pointer();
+    double* c_det_p = c_det.pointer();
+    c_det.zero();
+    const size_t nconf = nconfs();
+#pragma omp parallel for schedule(dynamic, 16)
+    for (size_t n = 0; n < nconf; ++n) {
+        const size_t nc = conf_csf_offset_[n + 1] - conf_csf_offset_[n];
+        const double* c_p = c_csf_p + conf_csf_offset_[n];
+        const double* coef_p = coefs_.data() + conf_coef_offset_[n];
+        for (size_t i = conf_det_offset_[n]; i < conf_det_offset_[n + 1]; ++i, coef_p += nc) {
+            double value = 0.0;
+            for (size_t k = 0; k < nc; ++k) {
+                value += coef_p[k] * c_p[k];
+            }
+            c_det_p[conf_dets_[i]] = value;
+        }
+    }
+}
+
+void SigmaVectorCSF::det_to_csf(const psi::Vector& c_det, psi::Vector& c_csf) const {
+    const double* c_det_p = const_cast<psi::Vector&>(c_det).pointer();
+    double* c_csf_p = c_csf.pointer();
+    const size_t nconf = nconfs();
+#pragma omp parallel for schedule(dynamic, 16)
+    for (size_t n = 0; n < nconf; ++n) {
+        const size_t nc = conf_csf_offset_[n + 1] - conf_csf_offset_[n];
+        double* c_p = c_csf_p + conf_csf_offset_[n];
+        const double* coef_p = coefs_.data() + conf_coef_offset_[n];
+        for (size_t k = 0; k < nc; ++k) {
+            c_p[k] = 0.0;
+        }
+        for (size_t i = conf_det_offset_[n]; i < conf_det_offset_[n + 1]; ++i, coef_p += nc) {
+            const double value = c_det_p[conf_dets_[i]];
+            for (size_t k = 0; k < nc; ++k) {
+                c_p[k] += coef_p[k] * value;
+            }
+        }
+    }
+}
+
+void SigmaVectorCSF::allocate_temp_vectors(size_t n) {
+    while (b_det_.size() < n) {
+        b_det_.push_back(std::make_shared<psi::Vector>("b", ndets()));
+        sigma_det_.push_back(std::make_shared<psi::Vector>("sigma", ndets()));
+    }
+}
+
+void SigmaVectorCSF::compute_sigma(std::shared_ptr<psi::Vector> sigma,
+                                   std::shared_ptr<psi::Vector> b) {
+    allocate_temp_vectors(1);
+    csf_to_det(*b, *b_det_[0]);
+    det_sigma_->compute_sigma(sigma_det_[0], b_det_[0]);
+    det_to_csf(*sigma_det_[0], *sigma);
+}
+
+void SigmaVectorCSF::compute_sigma_block(const std::vector<std::shared_ptr<psi::Vector>>& sigma,
+                                         const std::vector<std::shared_ptr<psi::Vector>>& b) {
+    const size_t nvecs = b.size();
+    allocate_temp_vectors(nvecs);
+    std::vector<std::shared_ptr<psi::Vector>> b_det(b_det_.begin(), b_det_.begin() + nvecs);
+    std::vector<std::shared_ptr<psi::Vector>> sigma_det(sigma_det_.begin(),
+                                                        sigma_det_.begin() + nvecs);
+    for (size_t n = 0; n < nvecs; ++n) {
+        csf_to_det(*b[n], *b_det[n]);
+    }
+    det_sigma_->compute_sigma_block(sigma_det, b_det);
+    for (size_t n = 0; n < nvecs; ++n) {
+        det_to_csf(*sigma_det[n], *sigma[n]);
+    }
+}
+
+void SigmaVectorCSF::get_diagonal(psi::Vector& diag) {
+    for (size_t I = 0; I < size_; ++I) {
+        diag.set(I, diag_[I]);
+    }
+}
+
+void SigmaVectorCSF::add_bad_roots(std::vector<std::vector<std::pair<size_t, double>>>& roots) {
+    det_sigma_->add_bad_roots(roots);
+}
+
+double SigmaVectorCSF::compute_spin(const std::vector<double>& c) {
+    psi::Vector c_csf("c", size_);
+    psi::Vector c_det("c", ndets());
+    for (size_t I = 0; I < size_; ++I) {
+        c_csf.set(I, c[I]);
+    }
+    csf_to_det(c_csf, c_det);
+    std::vector<double> c_det_vec(ndets());
+    for (size_t I = 0, maxI = ndets(); I < maxI; ++I) {
+        c_det_vec[I] = c_det.get(I);
+    }
+    return det_sigma_->compute_spin(c_det_vec);
+}
+
+} // namespace forte
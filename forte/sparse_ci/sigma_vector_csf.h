@@ -0,0 +1,112 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+#ifndef _sigma_vector_csf_h_
+#define _sigma_vector_csf_h_
+
+#include <memory>
+#include <vector>
+
+#include "sigma_vector.h"
+
+namespace psi {
+class Vector;
+}
+
+namespace forte {
+
+/**
+ * @brief The SigmaVectorCSF class
+ * Computes the sigma vector in a basis of configuration state functions (CSFs) with a given
+ * multiplicity.
+ *
+ * The determinants of the space are grouped by spatial configuration (the set of doubly and
+ * singly occupied orbitals). The CSFs of a configuration are the eigenvectors of S^2 within the
+ * determinants of that configuration with eigenvalue S(S + 1). They span the same space as the
+ * Gelfand-Tsetlin CSFs of the graphical unitary group approach. The sigma vector is computed from
+ * the determinant couplings of another sigma vector object as sigma = C^T H C b, where C is the
+ * block-diagonal CSF to determinant transformation. Configurations that are not spin complete
+ * in the determinant space only contribute the spin eigenfunctions that can be formed from the
+ * determinants present.
+ */
+class SigmaVectorCSF : public SigmaVector {
+  public:
+    /// @param space the determinant space
+    /// @param det_sigma a sigma vector object for the determinant space
+    /// @param multiplicity the multiplicity (2S + 1) of the CSFs
+    SigmaVectorCSF(const DeterminantHashVec& space, std::shared_ptr<SigmaVector> det_sigma,
+                   int multiplicity);
+
+    void compute_sigma(std::shared_ptr<psi::Vector> sigma, std::shared_ptr<psi::Vector> b) override;
+    void compute_sigma_block(const std::vector<std::shared_ptr<psi::Vector>>& sigma,
+                             const std::vector<std::shared_ptr<psi::Vector>>& b) override;
+    void get_diagonal(psi::Vector& diag) override;
+    /// The block preconditioner is defined in the determinant basis and it is not available
+    std::shared_ptr<DavidsonLiuPreconditioner> preconditioner(size_t) override { return nullptr; }
+    /// The roots to project out are passed to the determinant sigma vector object
+    void add_bad_roots(std::vector<std::vector<std::pair<size_t, double>>>& bad_states) override;
+    /// Compute <S^2> from the CSF coefficients
+    double compute_spin(const std::vector<double>& c) override;
+
+    /// @return the number of CSFs
+    size_t ncsf() const { return size_; }
+    /// @return the number of determinants
+    size_t ndets() const { return space_.size(); }
+    /// @return the number of spatial configurations with at least one CSF
+    size_t nconfs() const { return conf_det_offset_.size() - 1; }
+
+    /// Transform a vector from the CSF to the determinant basis, c_det = C c_csf
+    void csf_to_det(const psi::Vector& c_csf, psi::Vector& c_det) const;
+    /// Transform a vector from the determinant to the CSF basis, c_csf = C^T c_det
+    void det_to_csf(const psi::Vector& c_det, psi::Vector& c_csf) const;
+
+  private:
+    /// The sigma vector object for the determinant space
+    std::shared_ptr<SigmaVector> det_sigma_;
+    /// The determinants of each configuration are conf_dets_[conf_det_offset_[n] ...]
+    std::vector<size_t> conf_det_offset_;
+    /// The CSFs of configuration n are conf_csf_offset_[n] ...  conf_csf_offset_[n + 1] - 1
+    std::vector<size_t> conf_csf_offset_;
+    /// The coefficients of configuration n start at conf_coef_offset_[n]
+    std::vector<size_t> conf_coef_offset_;
+    /// The index of the determinants of each configuration
+    std::vector<size_t> conf_dets_;
+    /// The CSF coefficients. The block of a configuration is stored as a (ndets x ncsf) matrix
+    std::vector<double> coefs_;
+    /// Temporary vectors in the determinant basis
+    std::vector<std::shared_ptr<psi::Vector>> b_det_;
+    std::vector<std::shared_ptr<psi::Vector>> sigma_det_;
+
+    /// Build the CSF basis
+    void build_csfs(int multiplicity);
+    /// Make sure that there are at least n temporary vectors
+    void allocate_temp_vectors(size_t n);
+};
+
+} // namespace forte
+
+#endif // _sigma_vector_csf_h_
@@ -27,7 +27,10 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
 #include <thread>
 #include <future>
 
@@ -36,6 +39,7 @@
 #include "forte-def.h"
 #include "helpers/timer.h"
 #include "helpers/iterative_solvers.h"
+#include "helpers/numa_memory.h"
 #include "sigma_vector_dynamic.h"
 #include "integrals/active_space_integrals.h"
 #include "sparse_ci/determinant_functions.hpp"
@@ -95,31 +99,127 @@ SigmaVectorDynamic::SigmaVectorDynamic(const DeterminantHashVec& space,
 #pragma omp parallel
     { num_threads_ = omp_get_max_threads(); }
 
-    total_space_ = max_memory;
-    size_t space_per_thread = total_space_ / num_threads_;
-    for (int t = 0; t < num_threads_; ++t) {
-        H_IJ_list_thread_limit_.push_back((t + 1) * space_per_thread);
+    // use the same memory as a list of max_memory (H_IJ, I, J) tuples, but no more than what
+    // is left after the other Forte allocations and the temporary vectors
+    total_space_ = max_memory * sizeof(std::tuple<double, std::uint32_t, std::uint32_t>);
+    const size_t temp_space = 2 * size_ * sizeof(double);
+    const size_t free_space = MemoryManager::instance().budget(0.9);
+    if (total_space_ + temp_space > free_space) {
+        total_space_ = free_space > temp_space ? free_space - temp_space : 0;
+        outfile->Printf("\n  SigmaVectorDynamic: the storage of the couplings was reduced to the "
+                        "available memory.");
+    }
+    memory_reservation_ = MemoryReservation("CI vectors", total_space_ + temp_space);
+    const size_t words_per_thread = total_space_ / (sizeof(std::uint32_t) * num_threads_);
+    H_IJ_list_.resize(num_threads_);
+    if (numa_first_touch()) {
+        // each buffer is zeroed by a task like the one that fills it, so that its pages are
+        // placed on the node where the task runs
+        std::vector<std::future<void>> tasks;
+        for (auto& couplings : H_IJ_list_) {
+            tasks.push_back(std::async(std::launch::async,
+                                       [&couplings, words_per_thread]() {
+                                           couplings.allocate(words_per_thread);
+                                       }));
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+    } else {
+        for (auto& couplings : H_IJ_list_) {
+            couplings.allocate(words_per_thread);
+        }
+    }
+    H_IJ_aa_list_thread_start_.assign(num_threads_, 0);
+    H_IJ_aa_list_thread_end_.assign(num_threads_, 0);
+    H_IJ_bb_list_thread_start_.assign(num_threads_, 0);
+    H_IJ_bb_list_thread_end_.assign(num_threads_, 0);
+    H_IJ_abab_list_thread_start_.assign(num_threads_, 0);
+    H_IJ_abab_list_thread_end_.assign(num_threads_, 0);
 
-        H_IJ_aa_list_thread_start_.push_back(t * space_per_thread);
-        H_IJ_aa_list_thread_end_.push_back(t * space_per_thread);
+    // estimate the cost of each group from the number of determinants. For aa and bb we loop
+    // over all pairs of determinants in a group, for abab over the determinants of the group
+    // and those of all the groups connected to it
+    std::vector<double> aa_cost;
+    for (const auto& Ib : b_sorted_string_list_.sorted_half_dets()) {
+        const auto& range_I = b_sorted_string_list_.range(Ib);
+        const double n = range_I.second - range_I.first;
+        aa_cost.push_back(n * (n - 1.0) / 2.0);
+    }
+    aa_schedule_.init(aa_cost, num_threads_);
+    std::vector<double> bb_cost;
+    std::vector<double> abab_cost;
+    const double num_half_dets = a_sorted_string_list_.sorted_half_dets().size();
+    for (const auto& Ia : a_sorted_string_list_.sorted_half_dets()) {
+        const auto& range_I = a_sorted_string_list_.range(Ia);
+        const double n = range_I.second - range_I.first;
+        bb_cost.push_back(n * (n - 1.0) / 2.0);
+        abab_cost.push_back(num_half_dets * (1.0 + n));
+    }
+    bb_schedule_.init(bb_cost, num_threads_);
+    abab_schedule_.init(abab_cost, num_threads_);
+    outfile->Printf("\n\n  SigmaVectorDynamic:");
+    outfile->Printf("\n  Maximum memory   : %.2f MB",
+                    static_cast<double>(total_space_) / (1024.0 * 1024.0));
+    outfile->Printf("\n  Number of threads: %d\n", num_threads_);
+}
 
-        H_IJ_bb_list_thread_start_.push_back(t * space_per_thread);
-        H_IJ_bb_list_thread_end_.push_back(t * space_per_thread);
+SigmaVectorDynamic::~SigmaVectorDynamic() {
+    print_thread_stats();
+    print_SigmaVectorDynamic_stats();
+}
 
-        H_IJ_abab_list_thread_start_.push_back(t * space_per_thread);
-        H_IJ_abab_list_thread_end_.push_back(t * space_per_thread);
+void SigmaVectorDynamicCouplings::allocate(size_t num_words) {
+    // the end of the rows is stored as a 32-bit index
+    const size_t max_words = 3 * static_cast<size_t>(std::numeric_limits<uint32_t>::max());
+    words_.assign(std::min(num_words, max_words), 0);
+    clear();
+}
+
+void SigmaVectorDynamicCouplings::clear() {
+    num_elements_ = 0;
+    num_rows_ = 0;
+    group_elements_ = 0;
+    group_rows_ = 0;
+    group_fits_ = true;
+}
 
-        first_aa_onthefly_group_.push_back(t);
-        first_bb_onthefly_group_.push_back(t);
-        first_abab_onthefly_group_.push_back(t);
+bool SigmaVectorDynamicCouplings::commit() {
+    const bool fits = group_fits_;
+    if (fits) {
+        num_elements_ += group_elements_;
+        num_rows_ += group_rows_;
     }
-    H_IJ_list_.resize(total_space_);
-    outfile->Printf("\n\n  SigmaVectorDynamic:");
-    outfile->Printf("\n  Maximum memory   : %zu double", total_space_);
-    outfile->Printf("\n  Number of threads: %d\n", num_threads_);
+    group_elements_ = 0;
+    group_rows_ = 0;
+    group_fits_ = true;
+    return fits;
 }
 
-SigmaVectorDynamic::~SigmaVectorDynamic() { print_SigmaVectorDynamic_stats(); }
+void SigmaVectorDynamicSchedule::init(const std::vector<double>& cost, int num_threads) {
+    group_cost = cost;
+    group_storage_size.assign(cost.size(), 0);
+    onthefly_groups.resize(cost.size());
+    std::iota(onthefly_groups.begin(), onthefly_groups.end(), 0);
+    sort_groups();
+    thread_onthefly_groups.assign(num_threads, std::vector<size_t>());
+    thread_stored_groups.assign(num_threads, std::vector<size_t>());
+    thread_busy_time.assign(num_threads, 0.0);
+}
+
+void SigmaVectorDynamicSchedule::finish_store_build() {
+    onthefly_groups.clear();
+    for (const auto& groups : thread_onthefly_groups) {
+        onthefly_groups.insert(onthefly_groups.end(), groups.begin(), groups.end());
+    }
+    // use the cost measured in the first build
+    sort_groups();
+}
+
+void SigmaVectorDynamicSchedule::sort_groups() {
+    std::stable_sort(onthefly_groups.begin(), onthefly_groups.end(),
+                     [&](size_t a, size_t b) { return group_cost[a] > group_cost[b]; });
+}
 
 void SigmaVectorDynamic::compute_sigma(psi::SharedVector sigma, psi::SharedVector b) {
     sigma->zero();
@@ -141,10 +241,108 @@ void SigmaVectorDynamic::compute_sigma(psi::SharedVector sigma, psi::SharedVecto
         sabab_time += t.get();
     }
 
-    if (num_builds_ == 0) {
-        print_thread_stats();
-    }
     num_builds_ += 1;
+
+    if ((mode_ == SigmaVectorMode::Dynamic) and store_next_build_) {
+        // if some couplings did not fit in memory during the first build, select which ones
+        // to store using the cost and the number of couplings measured for each group
+        const bool all_stored = aa_schedule_.onthefly_groups.empty() and
+                                bb_schedule_.onthefly_groups.empty() and
+                                abab_schedule_.onthefly_groups.empty();
+        if ((num_builds_ == 1) and (not all_stored)) {
+            plan_storage();
+        } else {
+            store_next_build_ = false;
+            print_storage_stats();
+        }
+    }
+}
+
+void SigmaVectorDynamic::compute_sigma_block(const std::vector<psi::SharedVector>& sigma,
+                                             const std::vector<psi::SharedVector>& b) {
+    const size_t nvec = b.size();
+    const bool all_stored = (mode_ == SigmaVectorMode::Dynamic) and (not store_next_build_) and
+                            aa_schedule_.onthefly_groups.empty() and
+                            bb_schedule_.onthefly_groups.empty() and
+                            abab_schedule_.onthefly_groups.empty();
+    // the couplings computed on the fly are applied one vector at the time
+    if ((nvec == 1) or (sigma.size() != nvec) or (not all_stored)) {
+        SigmaVector::compute_sigma_block(sigma, b);
+        return;
+    }
+
+    for (size_t n = 0; n < nvec; ++n) {
+        sigma[n]->zero();
+        compute_sigma_scalar(sigma[n], b[n]);
+    }
+    {
+        local_timer t;
+        compute_sigma_block_stored(sigma, b, b_sorted_string_list_, H_IJ_aa_list_thread_start_,
+                                   H_IJ_aa_list_thread_end_, true);
+        saa_time += t.get();
+    }
+    {
+        local_timer t;
+        compute_sigma_block_stored(sigma, b, a_sorted_string_list_, H_IJ_bb_list_thread_start_,
+                                   H_IJ_bb_list_thread_end_, true);
+        sbb_time += t.get();
+    }
+    {
+        local_timer t;
+        compute_sigma_block_stored(sigma, b, a_sorted_string_list_, H_IJ_abab_list_thread_start_,
+                                   H_IJ_abab_list_thread_end_, false);
+        sabab_time += t.get();
+    }
+    num_builds_ += nvec;
+}
+
+void SigmaVectorDynamic::compute_sigma_block_stored(const std::vector<psi::SharedVector>& sigma,
+                                                    const std::vector<psi::SharedVector>& b,
+                                                    const SortedStringList& sorted_string_list,
+                                                    const std::vector<size_t>& first_row,
+                                                    const std::vector<size_t>& last_row,
+                                                    bool symmetric) {
+    const size_t nvec = b.size();
+    // store the vectors interleaved and in the order of the sorted string list
+    temp_b_block_.resize(size_ * nvec);
+    temp_sigma_block_.assign(size_ * nvec, 0.0);
+    for (size_t n = 0; n < nvec; ++n) {
+        const double* b_p = b[n]->pointer();
+        for (size_t I = 0; I < size_; ++I) {
+            temp_b_block_[I * nvec + n] = b_p[sorted_string_list.add(I)];
+        }
+    }
+    std::vector<std::future<void>> tasks;
+    for (int task_id = 0; task_id < num_threads_; ++task_id) {
+        tasks.push_back(std::async(std::launch::async,
+                                   &SigmaVectorDynamic::sigma_block_stored_task, this, task_id,
+                                   nvec, first_row[task_id], last_row[task_id], symmetric));
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+    for (size_t n = 0; n < nvec; ++n) {
+        double* sigma_p = sigma[n]->pointer();
+        for (size_t I = 0; I < size_; ++I) {
+            sigma_p[sorted_string_list.add(I)] += temp_sigma_block_[I * nvec + n];
+        }
+    }
+}
+
+void SigmaVectorDynamic::sigma_block_stored_task(size_t task_id, size_t nvec, size_t first_row,
+                                                 size_t last_row, bool symmetric) {
+    const double* b = temp_b_block_.data();
+    double* sigma = temp_sigma_block_.data();
+    H_IJ_list_[task_id].for_each(first_row, last_row, [&](size_t posI, size_t posJ, double H_IJ) {
+        for (size_t n = 0; n < nvec; ++n) {
+            sigma[posI * nvec + n] += H_IJ * b[posJ * nvec + n];
+        }
+        if (symmetric) {
+            for (size_t n = 0; n < nvec; ++n) {
+                sigma[posJ * nvec + n] += H_IJ * b[posI * nvec + n];
+            }
+        }
+    });
 }
 
 void print_SigmaVectorDynamic_stats() {
@@ -172,26 +370,112 @@ void SigmaVectorDynamic::print_thread_stats() {
 #if SIGMA_VEC_DEBUG
     outfile->Printf("\n  SigmaVectorDynamic Threads statistics:");
     outfile->Printf("\n  b-b coupling:");
-    outfile->Printf("\n Thread     start          end        limit         size        first");
+    outfile->Printf("\n Thread start row      end row     capacity    couplings    otf groups");
     for (int t = 0; t < num_threads_; ++t) {
         outfile->Printf("\n %3d %12zu %12zu %12zu %12zu %12zu", t, H_IJ_aa_list_thread_start_[t],
-                        H_IJ_aa_list_thread_end_[t], H_IJ_list_thread_limit_[t],
-                        H_IJ_aa_list_thread_end_[t] - H_IJ_aa_list_thread_start_[t],
-                        first_aa_onthefly_group_[t]);
+                        H_IJ_aa_list_thread_end_[t], H_IJ_list_[t].capacity(),
+                        H_IJ_list_[t].num_elements(H_IJ_aa_list_thread_start_[t],
+                                                   H_IJ_aa_list_thread_end_[t]),
+                        aa_schedule_.thread_onthefly_groups[t].size());
     }
     for (int t = 0; t < num_threads_; ++t) {
         outfile->Printf("\n %3d %12zu %12zu %12zu %12zu %12zu", t, H_IJ_bb_list_thread_start_[t],
-                        H_IJ_bb_list_thread_end_[t], H_IJ_list_thread_limit_[t],
-                        H_IJ_bb_list_thread_end_[t] - H_IJ_bb_list_thread_start_[t],
-                        first_bb_onthefly_group_[t]);
+                        H_IJ_bb_list_thread_end_[t], H_IJ_list_[t].capacity(),
+                        H_IJ_list_[t].num_elements(H_IJ_bb_list_thread_start_[t],
+                                                   H_IJ_bb_list_thread_end_[t]),
+                        bb_schedule_.thread_onthefly_groups[t].size());
     }
     for (int t = 0; t < num_threads_; ++t) {
         outfile->Printf("\n %3d %12zu %12zu %12zu %12zu %12zu", t, H_IJ_abab_list_thread_start_[t],
-                        H_IJ_abab_list_thread_end_[t], H_IJ_list_thread_limit_[t],
-                        H_IJ_abab_list_thread_end_[t] - H_IJ_abab_list_thread_start_[t],
-                        first_abab_onthefly_group_[t]);
+                        H_IJ_abab_list_thread_end_[t], H_IJ_list_[t].capacity(),
+                        H_IJ_list_[t].num_elements(H_IJ_abab_list_thread_start_[t],
+                                                   H_IJ_abab_list_thread_end_[t]),
+                        abab_schedule_.thread_onthefly_groups[t].size());
     }
 #endif
+    if (num_builds_ == 0)
+        return;
+    outfile->Printf("\n\n  SigmaVectorDynamic thread timings (%d builds):", num_builds_);
+    outfile->Printf("\n  Thread     aa busy     aa idle     bb busy     bb idle   abab busy"
+                    "   abab idle");
+    for (int t = 0; t < num_threads_; ++t) {
+        outfile->Printf("\n  %6d", t);
+        for (const auto* schedule : {&aa_schedule_, &bb_schedule_, &abab_schedule_}) {
+            const double busy = schedule->thread_busy_time[t];
+            outfile->Printf(" %11.3f %11.3f", busy, std::max(0.0, schedule->wall_time - busy));
+        }
+    }
+}
+
+void SigmaVectorDynamic::plan_storage() {
+    // the groups that generate couplings, sorted by decreasing cost per word stored
+    std::vector<std::tuple<double, SigmaVectorDynamicSchedule*, size_t>> candidates;
+    for (auto* schedule : {&aa_schedule_, &bb_schedule_, &abab_schedule_}) {
+        for (size_t group = 0, maxg = schedule->group_cost.size(); group < maxg; group++) {
+            const size_t n = schedule->group_storage_size[group];
+            const double cost = schedule->group_cost[group];
+            // groups without couplings cost nothing to store
+            const double cost_per_word = n > 0 ? cost / n : std::numeric_limits<double>::max();
+            candidates.emplace_back(cost_per_word, schedule, group);
+        }
+        schedule->onthefly_groups.clear();
+        for (auto& groups : schedule->thread_stored_groups) {
+            groups.clear();
+        }
+        schedule->planned = true;
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return std::get<0>(a) > std::get<0>(b);
+    });
+
+    // assign the groups to the thread with the most free memory until the memory is full
+    std::vector<size_t> free_space(num_threads_);
+    for (int t = 0; t < num_threads_; ++t) {
+        free_space[t] = H_IJ_list_[t].capacity();
+        H_IJ_list_[t].clear();
+        H_IJ_aa_list_thread_end_[t] = H_IJ_aa_list_thread_start_[t];
+    }
+    for (const auto& [cost_per_word, schedule, group] : candidates) {
+        const size_t n = schedule->group_storage_size[group];
+        const auto t = std::distance(free_space.begin(),
+                                     std::max_element(free_space.begin(), free_space.end()));
+        if (n <= free_space[t]) {
+            schedule->thread_stored_groups[t].push_back(group);
+            free_space[t] -= n;
+        } else {
+            schedule->onthefly_groups.push_back(group);
+        }
+    }
+    for (auto* schedule : {&aa_schedule_, &bb_schedule_, &abab_schedule_}) {
+        schedule->sort_groups();
+    }
+}
+
+void SigmaVectorDynamic::print_storage_stats() {
+    outfile->Printf("\n\n  SigmaVectorDynamic storage:");
+    outfile->Printf("\n  Phase      couplings   memory (MB)   stored groups   on-the-fly groups");
+    const std::vector<std::string> labels{"aa", "bb", "abab"};
+    const std::vector<const std::vector<size_t>*> starts{
+        &H_IJ_aa_list_thread_start_, &H_IJ_bb_list_thread_start_, &H_IJ_abab_list_thread_start_};
+    const std::vector<const std::vector<size_t>*> ends{
+        &H_IJ_aa_list_thread_end_, &H_IJ_bb_list_thread_end_, &H_IJ_abab_list_thread_end_};
+    const std::vector<const SigmaVectorDynamicSchedule*> schedules{&aa_schedule_, &bb_schedule_,
+                                                                   &abab_schedule_};
+    for (size_t p = 0; p < labels.size(); p++) {
+        size_t num_elements = 0;
+        size_t num_words = 0;
+        for (int t = 0; t < num_threads_; ++t) {
+            const size_t n = H_IJ_list_[t].num_elements((*starts[p])[t], (*ends[p])[t]);
+            num_elements += n;
+            num_words += 3 * n + 2 * ((*ends[p])[t] - (*starts[p])[t]);
+        }
+        const size_t num_groups = schedules[p]->group_cost.size();
+        const size_t num_onthefly = schedules[p]->onthefly_groups.size();
+        outfile->Printf("\n  %-6s %13zu %13.2f %15zu %19zu", labels[p].c_str(), num_elements,
+                        static_cast<double>(num_words * sizeof(std::uint32_t)) /
+                            (1024.0 * 1024.0),
+                        num_groups - num_onthefly, num_onthefly);
+    }
 }
 
 void SigmaVectorDynamic::add_bad_roots(std::vector<std::vector<std::pair<size_t, double>>>& roots) {
@@ -223,11 +507,14 @@ void SigmaVectorDynamic::compute_sigma_aa(psi::SharedVector sigma, psi::SharedVe
         size_t addI = b_sorted_string_list_.add(I);
         temp_b_[I] = b->get(addI);
     }
+    local_timer t;
+    const bool store = (mode_ == SigmaVectorMode::Dynamic) and store_next_build_;
+    aa_schedule_.next_group = 0;
     // launch asynchronous tasks
     std::vector<std::future<void>> tasks;
     for (int task_id = 0; task_id < num_threads_; ++task_id) {
-        if ((mode_ == SigmaVectorMode::Dynamic) and ((num_builds_ == 0))) {
-            // If running in dynamic mode, store Hamiltonian on first build
+        if (store) {
+            // If running in dynamic mode, store Hamiltonian on the first build(s)
             tasks.push_back(std::async(std::launch::async, &SigmaVectorDynamic::sigma_aa_store_task,
                                        this, task_id, num_threads_));
         } else {
@@ -240,6 +527,10 @@ void SigmaVectorDynamic::compute_sigma_aa(psi::SharedVector sigma, psi::SharedVe
     for (auto& task : tasks) {
         task.get();
     }
+    aa_schedule_.wall_time += t.get();
+    if (store) {
+        aa_schedule_.finish_store_build();
+    }
     // Add sigma using the determinant address used in the DeterminantHashVector object
     double* sigma_p = sigma->pointer();
     for (size_t I = 0; I < size_; ++I) {
@@ -248,50 +539,64 @@ void SigmaVectorDynamic::compute_sigma_aa(psi::SharedVector sigma, psi::SharedVe
     }
 }
 
-void SigmaVectorDynamic::sigma_aa_store_task(size_t task_id, size_t num_tasks) {
-    // loop over all determinants
+void SigmaVectorDynamic::sigma_aa_store_task(size_t task_id, size_t) {
+    local_timer t;
     const auto& sorted_half_dets = b_sorted_string_list_.sorted_half_dets();
-    size_t num_half_dets = sorted_half_dets.size();
-    // a temp array that can fit one row of the Hamiltonian
-    bool store = true;
-    for (size_t group = task_id; group < num_half_dets; group += num_tasks) {
+    auto& schedule = aa_schedule_;
+    auto& onthefly_groups = schedule.thread_onthefly_groups[task_id];
+    onthefly_groups.clear();
+    size_t storage_size = 0;
+    // store the groups assigned to this thread by plan_storage()
+    for (size_t group : schedule.thread_stored_groups[task_id]) {
         const auto& Ib = sorted_half_dets[group];
-        if (store) {
-            store = compute_aa_coupling_and_store(Ib, temp_b_, task_id);
-            if (store) {
-                first_aa_onthefly_group_[task_id] = group + num_tasks;
-            }
-        } else {
+        if (not compute_aa_coupling_and_store(Ib, temp_b_, task_id, storage_size)) {
+            onthefly_groups.push_back(group);
+        }
+    }
+    // loop over the other groups in order of decreasing cost. In the first build we try to
+    // store all of them and measure their cost and number of couplings
+    const size_t num_groups = schedule.onthefly_groups.size();
+    for (size_t n = schedule.next_group++; n < num_groups; n = schedule.next_group++) {
+        const size_t group = schedule.onthefly_groups[n];
+        const auto& Ib = sorted_half_dets[group];
+        if (schedule.planned) {
             compute_aa_coupling(Ib, temp_b_);
+            onthefly_groups.push_back(group);
+        } else {
+            local_timer t_group;
+            if (not compute_aa_coupling_and_store(Ib, temp_b_, task_id, storage_size)) {
+                onthefly_groups.push_back(group);
+            }
+            schedule.group_cost[group] = t_group.get();
+            schedule.group_storage_size[group] = storage_size;
         }
     }
     // update thread limits for next group of excitations
     H_IJ_bb_list_thread_start_[task_id] = H_IJ_aa_list_thread_end_[task_id];
     H_IJ_bb_list_thread_end_[task_id] = H_IJ_aa_list_thread_end_[task_id];
+    schedule.thread_busy_time[task_id] += t.get();
 }
 
-void SigmaVectorDynamic::sigma_aa_dynamic_task(size_t task_id, size_t num_tasks) {
-    // loop over all determinants
+void SigmaVectorDynamic::sigma_aa_dynamic_task(size_t task_id, size_t) {
+    local_timer t;
     const auto& sorted_half_dets = b_sorted_string_list_.sorted_half_dets();
-    size_t num_half_dets = sorted_half_dets.size();
+    auto& schedule = aa_schedule_;
 
     // compute contributions from elements stored in memory
-    double H_IJ;
-    size_t posI, posJ;
-    size_t begin_el = H_IJ_aa_list_thread_start_[task_id];
-    size_t end_el = H_IJ_aa_list_thread_end_[task_id];
-    for (size_t el = begin_el; el < end_el; ++el) {
-        std::tie(H_IJ, posI, posJ) = H_IJ_list_[el];
-        temp_sigma_[posI] += H_IJ * temp_b_[posJ];
-        temp_sigma_[posJ] += H_IJ * temp_b_[posI];
-    }
+    H_IJ_list_[task_id].for_each(H_IJ_aa_list_thread_start_[task_id],
+                                 H_IJ_aa_list_thread_end_[task_id],
+                                 [&](size_t posI, size_t posJ, double H_IJ) {
+                                     temp_sigma_[posI] += H_IJ * temp_b_[posJ];
+                                     temp_sigma_[posJ] += H_IJ * temp_b_[posI];
+                                 });
 
     // compute contributions on-the-fly
-    size_t first_group = first_aa_onthefly_group_[task_id];
-    for (size_t group = first_group; group < num_half_dets; group += num_tasks) {
-        const auto& Ib = sorted_half_dets[group];
+    const size_t num_groups = schedule.onthefly_groups.size();
+    for (size_t n = schedule.next_group++; n < num_groups; n = schedule.next_group++) {
+        const auto& Ib = sorted_half_dets[schedule.onthefly_groups[n]];
         compute_aa_coupling(Ib, temp_b_);
     }
+    schedule.thread_busy_time[task_id] += t.get();
 }
 
 void SigmaVectorDynamic::compute_sigma_bb(psi::SharedVector sigma, psi::SharedVector b) {
@@ -301,11 +606,14 @@ void SigmaVectorDynamic::compute_sigma_bb(psi::SharedVector sigma, psi::SharedVe
         size_t addI = a_sorted_string_list_.add(I);
         temp_b_[I] = b->get(addI);
     }
+    local_timer t;
+    const bool store = (mode_ == SigmaVectorMode::Dynamic) and store_next_build_;
+    bb_schedule_.next_group = 0;
     // launch asynchronous tasks
     std::vector<std::future<void>> tasks;
     for (int task_id = 0; task_id < num_threads_; ++task_id) {
-        if ((mode_ == SigmaVectorMode::Dynamic) and ((num_builds_ == 0))) {
-            // If running in dynamic mode, store Hamiltonian on first build
+        if (store) {
+            // If running in dynamic mode, store Hamiltonian on the first build(s)
             tasks.push_back(std::async(std::launch::async, &SigmaVectorDynamic::sigma_bb_store_task,
                                        this, task_id, num_threads_));
         } else {
@@ -318,6 +626,10 @@ void SigmaVectorDynamic::compute_sigma_bb(psi::SharedVector sigma, psi::SharedVe
     for (auto& task : tasks) {
         task.get();
     }
+    bb_schedule_.wall_time += t.get();
+    if (store) {
+        bb_schedule_.finish_store_build();
+    }
     // Add sigma using the determinant address used in the DeterminantHashVector object
     double* sigma_p = sigma->pointer();
     for (size_t I = 0; I < size_; ++I) {
@@ -326,49 +638,64 @@ void SigmaVectorDynamic::compute_sigma_bb(psi::SharedVector sigma, psi::SharedVe
     }
 }
 
-void SigmaVectorDynamic::sigma_bb_store_task(size_t task_id, size_t num_tasks) {
-    // loop over all determinants
+void SigmaVectorDynamic::sigma_bb_store_task(size_t task_id, size_t) {
+    local_timer t;
     const auto& sorted_half_dets = a_sorted_string_list_.sorted_half_dets();
-    size_t num_half_dets = sorted_half_dets.size();
-    bool store = true;
-    for (size_t group = task_id; group < num_half_dets; group += num_tasks) {
+    auto& schedule = bb_schedule_;
+    auto& onthefly_groups = schedule.thread_onthefly_groups[task_id];
+    onthefly_groups.clear();
+    size_t storage_size = 0;
+    // store the groups assigned to this thread by plan_storage()
+    for (size_t group : schedule.thread_stored_groups[task_id]) {
         const auto& Ia = sorted_half_dets[group];
-        if (store) {
-            store = compute_bb_coupling_and_store(Ia, temp_b_, task_id);
-            if (store) {
-                first_bb_onthefly_group_[task_id] = group + num_tasks;
-            }
-        } else {
+        if (not compute_bb_coupling_and_store(Ia, temp_b_, task_id, storage_size)) {
+            onthefly_groups.push_back(group);
+        }
+    }
+    // loop over the other groups in order of decreasing cost. In the first build we try to
+    // store all of them and measure their cost and number of couplings
+    const size_t num_groups = schedule.onthefly_groups.size();
+    for (size_t n = schedule.next_group++; n < num_groups; n = schedule.next_group++) {
+        const size_t group = schedule.onthefly_groups[n];
+        const auto& Ia = sorted_half_dets[group];
+        if (schedule.planned) {
             compute_bb_coupling(Ia, temp_b_);
+            onthefly_groups.push_back(group);
+        } else {
+            local_timer t_group;
+            if (not compute_bb_coupling_and_store(Ia, temp_b_, task_id, storage_size)) {
+                onthefly_groups.push_back(group);
+            }
+            schedule.group_cost[group] = t_group.get();
+            schedule.group_storage_size[group] = storage_size;
         }
     }
     // update thread limits for next group of excitations
     H_IJ_abab_list_thread_start_[task_id] = H_IJ_bb_list_thread_end_[task_id];
     H_IJ_abab_list_thread_end_[task_id] = H_IJ_bb_list_thread_end_[task_id];
+    schedule.thread_busy_time[task_id] += t.get();
 }
 
-void SigmaVectorDynamic::sigma_bb_dynamic_task(size_t task_id, size_t num_tasks) {
-    // loop over all determinants
+void SigmaVectorDynamic::sigma_bb_dynamic_task(size_t task_id, size_t) {
+    local_timer t;
     const auto& sorted_half_dets = a_sorted_string_list_.sorted_half_dets();
-    size_t num_half_dets = sorted_half_dets.size();
+    auto& schedule = bb_schedule_;
 
     // compute contributions from elements stored in memory
-    double H_IJ;
-    size_t posI, posJ;
-    size_t begin_el = H_IJ_bb_list_thread_start_[task_id];
-    size_t end_el = H_IJ_bb_list_thread_end_[task_id];
-    for (size_t el = begin_el; el < end_el; ++el) {
-        std::tie(H_IJ, posI, posJ) = H_IJ_list_[el];
-        temp_sigma_[posI] += H_IJ * temp_b_[posJ];
-        temp_sigma_[posJ] += H_IJ * temp_b_[posI];
-    }
+    H_IJ_list_[task_id].for_each(H_IJ_bb_list_thread_start_[task_id],
+                                 H_IJ_bb_list_thread_end_[task_id],
+                                 [&](size_t posI, size_t posJ, double H_IJ) {
+                                     temp_sigma_[posI] += H_IJ * temp_b_[posJ];
+                                     temp_sigma_[posJ] += H_IJ * temp_b_[posI];
+                                 });
 
     // compute contributions on-the-fly
-    size_t first_group = first_bb_onthefly_group_[task_id];
-    for (size_t group = first_group; group < num_half_dets; group += num_tasks) {
-        const auto& Ia = sorted_half_dets[group];
+    const size_t num_groups = schedule.onthefly_groups.size();
+    for (size_t n = schedule.next_group++; n < num_groups; n = schedule.next_group++) {
+        const auto& Ia = sorted_half_dets[schedule.onthefly_groups[n]];
         compute_bb_coupling(Ia, temp_b_);
     }
+    schedule.thread_busy_time[task_id] += t.get();
 }
 
 void SigmaVectorDynamic::compute_sigma_abab(psi::SharedVector sigma, psi::SharedVector b) {
@@ -378,11 +705,14 @@ void SigmaVectorDynamic::compute_sigma_abab(psi::SharedVector sigma, psi::Shared
         size_t addI = a_sorted_string_list_.add(I);
         temp_b_[I] = b->get(addI);
     }
+    local_timer t;
+    const bool store = (mode_ == SigmaVectorMode::Dynamic) and store_next_build_;
+    abab_schedule_.next_group = 0;
     // launch asynchronous tasks
     std::vector<std::future<void>> tasks;
     for (int task_id = 0; task_id < num_threads_; ++task_id) {
-        if ((mode_ == SigmaVectorMode::Dynamic) and ((num_builds_ == 0))) {
-            // If running in dynamic mode, store Hamiltonian on first build
+        if (store) {
+            // If running in dynamic mode, store Hamiltonian on the first build(s)
             tasks.push_back(std::async(std::launch::async,
                                        &SigmaVectorDynamic::sigma_abab_store_task, this, task_id,
                                        num_threads_));
@@ -396,6 +726,10 @@ void SigmaVectorDynamic::compute_sigma_abab(psi::SharedVector sigma, psi::Shared
     for (auto& task : tasks) {
         task.get();
     }
+    abab_schedule_.wall_time += t.get();
+    if (store) {
+        abab_schedule_.finish_store_build();
+    }
     // Add sigma using the determinant address used in the DeterminantHashVector object
     double* sigma_p = sigma->pointer();
     for (size_t I = 0; I < size_; ++I) {
@@ -404,51 +738,67 @@ void SigmaVectorDynamic::compute_sigma_abab(psi::SharedVector sigma, psi::Shared
     }
 }
 
-void SigmaVectorDynamic::sigma_abab_store_task(size_t task_id, size_t num_tasks) {
-    // loop over all determinants
+void SigmaVectorDynamic::sigma_abab_store_task(size_t task_id, size_t) {
+    local_timer t;
     const auto& sorted_half_dets = a_sorted_string_list_.sorted_half_dets();
-    size_t num_half_dets = sorted_half_dets.size();
-    bool store = true;
-    for (size_t group = task_id; group < num_half_dets; group += num_tasks) {
+    auto& schedule = abab_schedule_;
+    auto& onthefly_groups = schedule.thread_onthefly_groups[task_id];
+    onthefly_groups.clear();
+    size_t storage_size = 0;
+    // store the groups assigned to this thread by plan_storage()
+    for (size_t group : schedule.thread_stored_groups[task_id]) {
         const auto& detIa = sorted_half_dets[group];
-        if (store) {
-            store = compute_abab_coupling_and_store(detIa, temp_b_, task_id);
-            if (store) {
-                first_abab_onthefly_group_[task_id] = group + num_tasks;
-            }
-        } else {
+        if (not compute_abab_coupling_and_store(detIa, temp_b_, task_id, storage_size)) {
+            onthefly_groups.push_back(group);
+        }
+    }
+    // loop over the other groups in order of decreasing cost. In the first build we try to
+    // store all of them and measure their cost and number of couplings
+    const size_t num_groups = schedule.onthefly_groups.size();
+    for (size_t n = schedule.next_group++; n < num_groups; n = schedule.next_group++) {
+        const size_t group = schedule.onthefly_groups[n];
+        const auto& detIa = sorted_half_dets[group];
+        if (schedule.planned) {
             compute_abab_coupling(detIa, temp_b_);
+            onthefly_groups.push_back(group);
+        } else {
+            local_timer t_group;
+            if (not compute_abab_coupling_and_store(detIa, temp_b_, task_id, storage_size)) {
+                onthefly_groups.push_back(group);
+            }
+            schedule.group_cost[group] = t_group.get();
+            schedule.group_storage_size[group] = storage_size;
         }
     }
+    schedule.thread_busy_time[task_id] += t.get();
 }
 
-void SigmaVectorDynamic::sigma_abab_dynamic_task(size_t task_id, size_t num_tasks) {
+void SigmaVectorDynamic::sigma_abab_dynamic_task(size_t task_id, size_t) {
+    local_timer t;
+    auto& schedule = abab_schedule_;
+
     // compute contributions from elements stored in memory
-    double H_IJ;
-    size_t posI, posJ;
-    size_t begin_el = H_IJ_abab_list_thread_start_[task_id];
-    size_t end_el = H_IJ_abab_list_thread_end_[task_id];
-    for (size_t el = begin_el; el < end_el; ++el) {
-        std::tie(H_IJ, posI, posJ) = H_IJ_list_[el];
+    const auto& couplings = H_IJ_list_[task_id];
+    const size_t first_row = H_IJ_abab_list_thread_start_[task_id];
+    const size_t last_row = H_IJ_abab_list_thread_end_[task_id];
+    couplings.for_each(first_row, last_row, [&](size_t posI, size_t posJ, double H_IJ) {
         temp_sigma_[posI] += H_IJ * temp_b_[posJ];
-    }
+    });
 
     // compute contributions on-the-fly
     const auto& sorted_half_dets = a_sorted_string_list_.sorted_half_dets();
-    size_t num_half_dets = sorted_half_dets.size();
-    size_t first_group = first_abab_onthefly_group_[task_id];
-    for (size_t group = first_group; group < num_half_dets; group += num_tasks) {
-        const auto& detIa = sorted_half_dets[group];
+    const size_t num_groups = schedule.onthefly_groups.size();
+    for (size_t n = schedule.next_group++; n < num_groups; n = schedule.next_group++) {
+        const auto& detIa = sorted_half_dets[schedule.onthefly_groups[n]];
         compute_abab_coupling(detIa, temp_b_);
     }
+    schedule.thread_busy_time[task_id] += t.get();
 }
 
 bool SigmaVectorDynamic::compute_aa_coupling_and_store(const String& Ib,
                                                        const std::vector<double>& b,
-                                                       size_t task_id) {
-    bool stored = true;
-    size_t end = H_IJ_aa_list_thread_end_[task_id];
-    size_t limit = H_IJ_list_thread_limit_[task_id];
+                                                       size_t task_id, size_t& storage_size) {
+    auto& couplings = H_IJ_list_[task_id];
 
     const auto& sorted_dets = b_sorted_string_list_.sorted_dets();
     const auto& range_I = b_sorted_string_list_.range(Ib);
@@ -458,7 +808,6 @@ bool SigmaVectorDynamic::compute_aa_coupling_and_store(const String& Ib,
     size_t first_I = range_I.first;
     size_t last_I = range_I.second;
     double sigma_I = 0.0;
-    size_t num_elements = 0;
     for (size_t posI = first_I; posI < last_I; ++posI) {
         sigma_I = 0.0;
         Ia = sorted_dets[posI].get_alfa_bits();
@@ -475,13 +824,8 @@ bool SigmaVectorDynamic::compute_aa_coupling_and_store(const String& Ib,
                 sigma_I += H_IJ * b[posJ];
                 temp_sigma_[posJ] += H_IJ * b[posI];
                 // Add this to the Hamiltonian
-                if (end + num_elements < limit) {
-                    if (std::fabs(H_IJ) > H_threshold_) {
-                        H_IJ_list_[end + num_elements] = std::tie(H_IJ, posI, posJ);
-                        num_elements++;
-                    }
-                } else {
-                    stored = false;
+                if (std::fabs(H_IJ) > H_threshold_) {
+                    couplings.add(posI, posJ, H_IJ);
                 }
 #if SIGMA_VEC_DEBUG
                 count_aa++;
@@ -491,13 +835,8 @@ bool SigmaVectorDynamic::compute_aa_coupling_and_store(const String& Ib,
                 sigma_I += H_IJ * b[posJ];
                 temp_sigma_[posJ] += H_IJ * b[posI];
                 // Add this to the Hamiltonian
-                if (end + num_elements < limit) {
-                    if (std::fabs(H_IJ) > H_threshold_) {
-                        H_IJ_list_[end + num_elements] = std::tie(H_IJ, posI, posJ);
-                        num_elements++;
-                    }
-                } else {
-                    stored = false;
+                if (std::fabs(H_IJ) > H_threshold_) {
+                    couplings.add(posI, posJ, H_IJ);
                 }
 #if SIGMA_VEC_DEBUG
                 count_aaaa++;
@@ -506,9 +845,9 @@ bool SigmaVectorDynamic::compute_aa_coupling_and_store(const String& Ib,
         }
         temp_sigma_[posI] += sigma_I;
     }
-    if (stored) {
-        H_IJ_aa_list_thread_end_[task_id] += num_elements;
-    }
+    storage_size = couplings.group_size();
+    const bool stored = couplings.commit();
+    H_IJ_aa_list_thread_end_[task_id] = couplings.num_rows();
     return stored;
 }
 
@@ -554,10 +893,8 @@ void SigmaVectorDynamic::compute_aa_coupling(const String& Ib, const std::vector
 
 bool SigmaVectorDynamic::compute_bb_coupling_and_store(const String& Ia,
                                                        const std::vector<double>& b,
-                                                       size_t task_id) {
-    bool stored = true;
-    size_t end = H_IJ_bb_list_thread_end_[task_id];
-    size_t limit = H_IJ_list_thread_limit_[task_id];
+                                                       size_t task_id, size_t& storage_size) {
+    auto& couplings = H_IJ_list_[task_id];
 
     const auto& sorted_dets = a_sorted_string_list_.sorted_dets();
     const auto& range_I = a_sorted_string_list_.range(Ia);
@@ -567,7 +904,6 @@ bool SigmaVectorDynamic::compute_bb_coupling_and_store(const String& Ia,
     size_t first_I = range_I.first;
     size_t last_I = range_I.second;
     double sigma_I = 0.0;
-    size_t num_elements = 0;
     for (size_t posI = first_I; posI < last_I; ++posI) {
         sigma_I = 0.0;
         Ib = sorted_dets[posI].get_beta_bits();
@@ -584,13 +920,8 @@ bool SigmaVectorDynamic::compute_bb_coupling_and_store(const String& Ia,
                 sigma_I += H_IJ * b[posJ];
                 temp_sigma_[posJ] += H_IJ * b[posI];
                 // Add this to the Hamiltonian
-                if (end + num_elements < limit) {
-                    if (std::fabs(H_IJ) > H_threshold_) {
-                        H_IJ_list_[end + num_elements] = std::tie(H_IJ, posI, posJ);
-                        num_elements++;
-                    }
-                } else {
-                    stored = false;
+                if (std::fabs(H_IJ) > H_threshold_) {
+                    couplings.add(posI, posJ, H_IJ);
                 }
 #if SIGMA_VEC_DEBUG
                 count_bb++;
@@ -600,13 +931,8 @@ bool SigmaVectorDynamic::compute_bb_coupling_and_store(const String& Ia,
                 sigma_I += H_IJ * b[posJ];
                 temp_sigma_[posJ] += H_IJ * b[posI];
                 // Add this to the Hamiltonian
-                if (end + num_elements < limit) {
-                    if (std::fabs(H_IJ) > H_threshold_) {
-                        H_IJ_list_[end + num_elements] = std::tie(H_IJ, posI, posJ);
-                        num_elements++;
-                    }
-                } else {
-                    stored = false;
+                if (std::fabs(H_IJ) > H_threshold_) {
+                    couplings.add(posI, posJ, H_IJ);
                 }
 #if SIGMA_VEC_DEBUG
                 count_bbbb++;
@@ -615,9 +941,9 @@ bool SigmaVectorDynamic::compute_bb_coupling_and_store(const String& Ia,
         }
         temp_sigma_[posI] += sigma_I;
     }
-    if (stored) {
-        H_IJ_bb_list_thread_end_[task_id] += num_elements;
-    }
+    storage_size = couplings.group_size();
+    const bool stored = couplings.commit();
+    H_IJ_bb_list_thread_end_[task_id] = couplings.num_rows();
     return stored;
 }
 
@@ -663,18 +989,16 @@ void SigmaVectorDynamic::compute_bb_coupling(const String& Ia, const std::vector
 
 bool SigmaVectorDynamic::compute_abab_coupling_and_store(const String& detIa,
                                                          const std::vector<double>& b,
-                                                         size_t task_id) {
+                                                         size_t task_id, size_t& storage_size) {
     const auto& sorted_half_dets = a_sorted_string_list_.sorted_half_dets();
     const auto& sorted_dets = a_sorted_string_list_.sorted_dets();
     const auto& range_I = a_sorted_string_list_.range(detIa);
-    bool stored = true;
-    size_t end = H_IJ_abab_list_thread_end_[task_id];
-    size_t limit = H_IJ_list_thread_limit_[task_id];
+    auto& couplings = H_IJ_list_[task_id];
     String Ib;
     String Jb;
-    String IJb;
 
-    size_t group_num_elements = 0;
+    // find the alpha strings connected to detIa by a single excitation i -> a
+    std::vector<std::tuple<int, int, double, size_t, size_t>> connected;
     for (const auto& detJa : sorted_half_dets) {
         if (detIa.fast_a_xor_b_count(detJa) == 2) {
             int i, a;
@@ -686,49 +1010,41 @@ bool SigmaVectorDynamic::compute_abab_coupling_and_store(const String& detIa,
                     a = ra_p ? p : a;
                 }
             }
-            double sign_ia = detIa.slater_sign(i, a);
             const auto& range_J = a_sorted_string_list_.range(detJa);
+            connected.emplace_back(i, a, detIa.slater_sign(i, a), range_J.first, range_J.second);
+        }
+    }
 
-            size_t first_I = range_I.first;
-            size_t last_I = range_I.second;
-            size_t first_J = range_J.first;
-            size_t last_J = range_J.second;
-            double sigma_I = 0.0;
-            //    size_t num_elements = 0;
-            for (size_t posI = first_I; posI < last_I; ++posI) {
-                sigma_I = 0.0;
-                sorted_dets[posI].copy_beta_bits(Ib);
-                for (size_t posJ = first_J; posJ < last_J; ++posJ) {
-                    sorted_dets[posJ].copy_beta_bits(Jb);
+    // loop over I first so that all the couplings of I are stored in the same row
+    for (size_t posI = range_I.first; posI < range_I.second; ++posI) {
+        double sigma_I = 0.0;
+        sorted_dets[posI].copy_beta_bits(Ib);
+        for (const auto& [i, a, sign_ia, first_J, last_J] : connected) {
+            for (size_t posJ = first_J; posJ < last_J; ++posJ) {
+                sorted_dets[posJ].copy_beta_bits(Jb);
 #if SIGMA_VEC_DEBUG
-                    count_abab_total++;
+                count_abab_total++;
 #endif
-                    // find common bits
-                    if (Ib.fast_a_xor_b_count(Jb) == 2) {
-                        double H_IJ =
-                            sign_ia * slater_rules_double_alpha_beta_pre(i, a, Ib, Jb, fci_ints_);
-                        sigma_I += H_IJ * b[posJ];
-                        // Add this to the Hamiltonian
-                        if (end + group_num_elements < limit) {
-                            if (std::fabs(H_IJ) > H_threshold_) {
-                                H_IJ_list_[end + group_num_elements] = std::tie(H_IJ, posI, posJ);
-                                group_num_elements++;
-                            }
-                        } else {
-                            stored = false;
-                        }
+                // find common bits
+                if (Ib.fast_a_xor_b_count(Jb) == 2) {
+                    double H_IJ =
+                        sign_ia * slater_rules_double_alpha_beta_pre(i, a, Ib, Jb, fci_ints_);
+                    sigma_I += H_IJ * b[posJ];
+                    // Add this to the Hamiltonian
+                    if (std::fabs(H_IJ) > H_threshold_) {
+                        couplings.add(posI, posJ, H_IJ);
+                    }
 #if SIGMA_VEC_DEBUG
-                        count_abab++;
+                    count_abab++;
 #endif
-                    }
                 }
-                temp_sigma_[posI] += sigma_I;
             }
         }
+        temp_sigma_[posI] += sigma_I;
     }
-    if (stored) {
-        H_IJ_abab_list_thread_end_[task_id] += group_num_elements;
-    }
+    storage_size = couplings.group_size();
+    const bool stored = couplings.commit();
+    H_IJ_abab_list_thread_end_[task_id] = couplings.num_rows();
     return stored;
 }
 
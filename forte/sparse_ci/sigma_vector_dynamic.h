@@ -30,6 +30,11 @@
 #ifndef _sigma_vector_dynamic_h_
 #define _sigma_vector_dynamic_h_
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "helpers/memory_manager.h"
 #include "sigma_vector.h"
 #include "sorted_string_list.h"
 
@@ -41,6 +46,128 @@ namespace forte {
 
 enum class SigmaVectorMode { Dynamic, OnTheFly };
 
+/**
+ * @brief The work schedule of one contribution to sigma (aa, bb, or abab)
+ *
+ * The groups of determinants that are not stored are handed out to the threads one at the time
+ * in order of decreasing cost, so that a thread that finishes early takes work from the others.
+ * The cost of each group is estimated from its size before the first build and measured during
+ * the first build.
+ * When not all the couplings fit in memory, the groups to store are selected after the first
+ * build (see SigmaVectorDynamic::plan_storage()) and assigned to the threads in
+ * thread_stored_groups.
+ */
+struct SigmaVectorDynamicSchedule {
+    /// The groups computed on the fly, sorted by decreasing cost
+    std::vector<size_t> onthefly_groups;
+    /// The cost of each group
+    std::vector<double> group_cost;
+    /// The memory required to store each group in words (measured in the first build)
+    std::vector<size_t> group_storage_size;
+    /// The groups stored by each thread
+    std::vector<std::vector<size_t>> thread_stored_groups;
+    /// Have the groups to store been selected?
+    bool planned = false;
+    /// The groups computed on the fly by each thread during the last build that stored couplings
+    std::vector<std::vector<size_t>> thread_onthefly_groups;
+    /// The position in onthefly_groups of the next group to compute
+    std::atomic<size_t> next_group{0};
+    /// The time spent computing by each thread
+    std::vector<double> thread_busy_time;
+    /// The total time spent in this phase
+    double wall_time = 0.0;
+
+    /// Set the groups and their estimated cost
+    void init(const std::vector<double>& cost, int num_threads);
+    /// Keep only the groups that were not stored
+    void finish_store_build();
+    /// Sort the groups computed on the fly by decreasing cost
+    void sort_groups();
+};
+
+/**
+ * @brief The couplings <I|H|J> stored by one thread
+ *
+ * The couplings are stored as rows of elements (H_IJ, J) that share the same index I, so that I
+ * is stored only once per row. The elements (three 32-bit words each) grow from the front of a
+ * single buffer and the rows (I and the end of the row, two words each) grow from its back.
+ * Couplings are added one group at the time and the group is kept by commit() only if all its
+ * couplings fit in the buffer.
+ */
+class SigmaVectorDynamicCouplings {
+  public:
+    /// Allocate a buffer of num_words 32-bit words
+    void allocate(size_t num_words);
+    /// Remove all the couplings
+    void clear();
+    /// @return the size of the buffer in words
+    size_t capacity() const { return words_.size(); }
+    /// @return the number of rows stored
+    size_t num_rows() const { return num_rows_; }
+    /// @return the number of couplings stored in the rows [first_row, last_row)
+    size_t num_elements(size_t first_row, size_t last_row) const {
+        return first_row == last_row ? 0 : row_end(last_row - 1) - row_begin(first_row);
+    }
+
+    /// Add a coupling to the current group
+    void add(uint32_t I, uint32_t J, double H_IJ) {
+        if ((group_rows_ == 0) or (I != group_I_)) {
+            group_rows_++;
+            group_I_ = I;
+        }
+        group_elements_++;
+        const size_t num_elements = num_elements_ + group_elements_;
+        const size_t num_rows = num_rows_ + group_rows_;
+        if (group_fits_ and (3 * num_elements + 2 * num_rows <= words_.size())) {
+            std::memcpy(&words_[3 * (num_elements - 1)], &H_IJ, sizeof(double));
+            words_[3 * (num_elements - 1) + 2] = J;
+            const size_t row = words_.size() - 2 * num_rows;
+            words_[row] = I;
+            words_[row + 1] = static_cast<uint32_t>(num_elements);
+        } else {
+            group_fits_ = false;
+        }
+    }
+    /// @return the number of words required to store the current group
+    size_t group_size() const { return 3 * group_elements_ + 2 * group_rows_; }
+    /// Keep the current group if it fits in the buffer and start a new one
+    /// @return true if the group was kept
+    bool commit();
+
+    /// Call f(I, J, H_IJ) for all the couplings stored in the rows [first_row, last_row)
+    template <typename F> void for_each(size_t first_row, size_t last_row, F f) const {
+        size_t begin = first_row == last_row ? 0 : row_begin(first_row);
+        double H_IJ;
+        for (size_t r = first_row; r < last_row; r++) {
+            const size_t row = words_.size() - 2 * (r + 1);
+            const uint32_t I = words_[row];
+            const size_t end = words_[row + 1];
+            for (size_t e = begin; e < end; e++) {
+                std::memcpy(&H_IJ, &words_[3 * e], sizeof(double));
+                f(I, words_[3 * e + 2], H_IJ);
+            }
+            begin = end;
+        }
+    }
+
+  private:
+    size_t row_begin(size_t r) const { return r == 0 ? 0 : row_end(r - 1); }
+    size_t row_end(size_t r) const { return words_[words_.size() - 2 * (r + 1) + 1]; }
+
+    /// The buffer
+    std::vector<uint32_t> words_;
+    /// The number of elements and rows stored
+    size_t num_elements_ = 0;
+    size_t num_rows_ = 0;
+    /// The number of elements and rows of the current group
+    size_t group_elements_ = 0;
+    size_t group_rows_ = 0;
+    /// The index I of the last row of the current group
+    uint32_t group_I_ = 0;
+    /// Does the current group fit in the buffer?
+    bool group_fits_ = true;
+};
+
 /**
  * @brief The SigmaVectorDynamic class
  * Computes the sigma vector with a dynamic approach
@@ -51,6 +178,10 @@ class SigmaVectorDynamic : public SigmaVector {
                        std::shared_ptr<ActiveSpaceIntegrals> fci_ints, size_t max_memory);
     ~SigmaVectorDynamic();
     void compute_sigma(std::shared_ptr<psi::Vector> sigma, std::shared_ptr<psi::Vector> b) override;
+    /// Compute a block of sigma vectors. When all the couplings are stored they are traversed
+    /// only once for the whole block
+    void compute_sigma_block(const std::vector<std::shared_ptr<psi::Vector>>& sigma,
+                             const std::vector<std::shared_ptr<psi::Vector>>& b) override;
     void get_diagonal(psi::Vector& diag) override;
     void add_bad_roots(std::vector<std::vector<std::pair<size_t, double>>>& bad_states) override;
     double compute_spin(const std::vector<double>& c) override;
@@ -61,23 +192,31 @@ class SigmaVectorDynamic : public SigmaVector {
     SigmaVectorMode mode_ = SigmaVectorMode::Dynamic;
     /// The number of threads
     int num_threads_ = 1;
+    /// The memory used to store the couplings in bytes
     size_t total_space_ = 0;
+    /// Registers the couplings and the temporary vectors with the MemoryManager
+    MemoryReservation memory_reservation_;
     /// The number of molecular orbitals
     size_t nmo_ = 0;
     /// Number of sigma builds
     int num_builds_ = 0;
+    /// Store couplings in the next build?
+    bool store_next_build_ = true;
     double H_threshold_ = 1.0e-14;
     /// A temporary sigma vector of size N_det
     std::vector<double> temp_b_;
     /// A temporary sigma vector of size N_det
     std::vector<double> temp_sigma_;
+    /// Temporary b and sigma vectors of size N_det x N_vec used by compute_sigma_block()
+    std::vector<double> temp_b_block_;
+    std::vector<double> temp_sigma_block_;
     SortedStringList a_sorted_string_list_;
     SortedStringList b_sorted_string_list_;
 
-    /// The Hamiltonian stored as a list of pairs (H_IJ, I, J)
-    std::vector<std::tuple<double, std::uint32_t, std::uint32_t>> H_IJ_list_;
-    std::vector<size_t> H_IJ_list_thread_limit_;
+    /// The Hamiltonian couplings stored by each thread
+    std::vector<SigmaVectorDynamicCouplings> H_IJ_list_;
 
+    /// The range of rows of H_IJ_list_ that store the aa, bb, and abab couplings of each thread
     std::vector<size_t> H_IJ_aa_list_thread_start_;
     std::vector<size_t> H_IJ_aa_list_thread_end_;
 
@@ -87,11 +226,19 @@ class SigmaVectorDynamic : public SigmaVector {
     std::vector<size_t> H_IJ_abab_list_thread_start_;
     std::vector<size_t> H_IJ_abab_list_thread_end_;
 
-    std::vector<size_t> first_aa_onthefly_group_;
-    std::vector<size_t> first_bb_onthefly_group_;
-    std::vector<size_t> first_abab_onthefly_group_;
+    /// The work schedule of the aa, bb, and abab contributions
+    SigmaVectorDynamicSchedule aa_schedule_;
+    SigmaVectorDynamicSchedule bb_schedule_;
+    SigmaVectorDynamicSchedule abab_schedule_;
 
+    /// Print the storage and the busy/idle time of each thread
     void print_thread_stats();
+    /// Print the number of couplings stored and the memory used by each phase
+    void print_storage_stats();
+    /// @brief Select the groups whose couplings are stored
+    /// The groups are sorted by decreasing cost (time) of computing them on the fly per coupling
+    /// stored, and are assigned to the thread with the most free memory until memory is full
+    void plan_storage();
     /// Scalar contribution to sigma
     void compute_sigma_scalar(std::shared_ptr<psi::Vector> sigma, std::shared_ptr<psi::Vector> b);
     /// Alpha-alpha single and double excitation contributions to sigma
@@ -101,6 +248,17 @@ class SigmaVectorDynamic : public SigmaVector {
     /// Alpha-beta double excitation contributions to sigma
     void compute_sigma_abab(std::shared_ptr<psi::Vector> sigma, std::shared_ptr<psi::Vector> b);
 
+    /// Add the contribution of the stored couplings of one phase (aa, bb, or abab) to a block of
+    /// sigma vectors
+    void compute_sigma_block_stored(const std::vector<std::shared_ptr<psi::Vector>>& sigma,
+                                    const std::vector<std::shared_ptr<psi::Vector>>& b,
+                                    const SortedStringList& sorted_string_list,
+                                    const std::vector<size_t>& first_row,
+                                    const std::vector<size_t>& last_row, bool symmetric);
+    /// Task that applies the couplings stored by one thread to a block of vectors
+    void sigma_block_stored_task(size_t task_id, size_t nvec, size_t first_row, size_t last_row,
+                                 bool symmetric);
+
     /// Task to compute sigma_aa. Computes sigma and stores part of the Hamiltonian
     void sigma_aa_store_task(size_t task_id, size_t num_tasks);
     /// Task to compute sigma_aa. Computes sigma using a dynamic approach
@@ -116,12 +274,24 @@ class SigmaVectorDynamic : public SigmaVector {
     /// Task to compute sigma_abab. Computes sigma using a dynamic approach
     void sigma_abab_dynamic_task(size_t task_id, size_t num_tasks);
 
+    /// Compute the couplings of a group and store them if they fit in memory
+    /// @param storage_size the memory (in words) required to store the couplings larger than
+    /// H_threshold_ in the group
+    /// @return true if all the couplings were stored
     bool compute_aa_coupling_and_store(const String& Ib, const std::vector<double>& b,
-                                       size_t task_id);
+                                       size_t task_id, size_t& storage_size);
+    /// Compute the couplings of a group and store them if they fit in memory
+    /// @param storage_size the memory (in words) required to store the couplings larger than
+    /// H_threshold_ in the group
+    /// @return true if all the couplings were stored
     bool compute_bb_coupling_and_store(const String& Ia, const std::vector<double>& b,
-                                       size_t task_id);
+                                       size_t task_id, size_t& storage_size);
+    /// Compute the couplings of a group and store them if they fit in memory
+    /// @param storage_size the memory (in words) required to store the couplings larger than
+    /// H_threshold_ in the group
+    /// @return true if all the couplings were stored
     bool compute_abab_coupling_and_store(const String& detIa, const std::vector<double>& b,
-                                         size_t task_id);
+                                         size_t task_id, size_t& storage_size);
 
     void compute_aa_coupling(const String& detIb, const std::vector<double>& b);
     void compute_bb_coupling(const String& detIa, const std::vector<double>& b);
@@ -0,0 +1,108 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <cstddef>
+
+#include "psi4/libpsi4util/PsiOutStream.h"
+
+#include "integrals/active_space_integrals.h"
+#include "sparse_ci/determinant_substitution_lists.h"
+#include "sigma_vector_gpu.h"
+#include "sigma_vector_gpu_kernels.h"
+
+using namespace psi;
+
+namespace forte {
+
+// the substitution lists are copied to the device byte by byte
+static_assert(sizeof(OneParticleCoupling) == sizeof(DeviceOneParticleCoupling) and
+                  offsetof(OneParticleCoupling, signed_p) ==
+                      offsetof(DeviceOneParticleCoupling, signed_p),
+              "OneParticleCoupling and DeviceOneParticleCoupling must have the same layout");
+static_assert(sizeof(TwoParticleCoupling) == sizeof(DeviceTwoParticleCoupling) and
+                  offsetof(TwoParticleCoupling, signed_p) ==
+                      offsetof(DeviceTwoParticleCoupling, signed_p) and
+                  offsetof(TwoParticleCoupling, q) == offsetof(DeviceTwoParticleCoupling, q),
+              "TwoParticleCoupling and DeviceTwoParticleCoupling must have the same layout");
+
+SigmaVectorGPU::SigmaVectorGPU(const DeterminantHashVec& space,
+                               std::shared_ptr<ActiveSpaceIntegrals> fci_ints)
+    : SigmaVectorSparseList(space, fci_ints, SigmaVectorType::GPU, "SigmaVectorGPU") {
+    const size_t nmo = fci_ints_->nmo();
+    device_ = std::make_unique<SigmaVectorDevice>(size_, nmo);
+
+    device_->set_diagonal(diag_.data());
+
+    const std::vector<double> oei_a = fci_ints_->oei_a_vector();
+    const std::vector<double> oei_b = fci_ints_->oei_b_vector();
+    device_->set_integrals(oei_a.data(), oei_b.data(), fci_ints_->tei_aa_vector().data(),
+                           fci_ints_->tei_ab_vector().data(), fci_ints_->tei_bb_vector().data());
+
+    // store the occupation of the determinants as bit strings
+    const size_t nwords = (nmo + 63) / 64;
+    std::vector<uint64_t> alfa_occ(size_ * nwords, 0);
+    std::vector<uint64_t> beta_occ(size_ * nwords, 0);
+    const det_hashvec& dets = space_.wfn_hash();
+    for (size_t I = 0; I < size_; ++I) {
+        for (size_t p = 0; p < nmo; ++p) {
+            if (dets[I].get_alfa_bit(p)) {
+                alfa_occ[I * nwords + p / 64] |= uint64_t(1) << (p % 64);
+            }
+            if (dets[I].get_beta_bit(p)) {
+                beta_occ[I * nwords + p / 64] |= uint64_t(1) << (p % 64);
+            }
+        }
+    }
+    device_->set_occupations(nwords, alfa_occ.data(), beta_occ.data());
+
+    auto one_particle = [](const CouplingList<OneParticleCoupling>& list) {
+        return reinterpret_cast<const DeviceOneParticleCoupling*>(list.data());
+    };
+    auto two_particle = [](const CouplingList<TwoParticleCoupling>& list) {
+        return reinterpret_cast<const DeviceTwoParticleCoupling*>(list.data());
+    };
+    device_->set_one_particle_list(true, op_->a_list_.offsets(), one_particle(op_->a_list_));
+    device_->set_one_particle_list(false, op_->b_list_.offsets(), one_particle(op_->b_list_));
+    device_->set_two_particle_list(SigmaVectorDevice::TwoParticleList::aa,
+                                   op_->aa_list_.offsets(), two_particle(op_->aa_list_));
+    device_->set_two_particle_list(SigmaVectorDevice::TwoParticleList::ab,
+                                   op_->ab_list_.offsets(), two_particle(op_->ab_list_));
+    device_->set_two_particle_list(SigmaVectorDevice::TwoParticleList::bb,
+                                   op_->bb_list_.offsets(), two_particle(op_->bb_list_));
+
+    outfile->Printf("\n  Device memory used by the sigma vector: %.2f MB",
+                    static_cast<double>(device_->memory()) / (1024. * 1024.));
+}
+
+SigmaVectorGPU::~SigmaVectorGPU() = default;
+
+void SigmaVectorGPU::compute_sigma_kernel(size_t nvec, const double* b_p, double* sigma_p) {
+    device_->compute_sigma(nvec, b_p, sigma_p);
+}
+
+} // namespace forte
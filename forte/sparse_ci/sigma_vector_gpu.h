@@ -0,0 +1,64 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _sigma_vector_gpu_h_
+#define _sigma_vector_gpu_h_
+
+#include <memory>
+
+#include "sigma_vector_sparse_list.h"
+
+namespace forte {
+
+class SigmaVectorDevice;
+
+/**
+ * @brief The SigmaVectorGPU class
+ * Computes the sigma vector on a GPU using the substitution lists of SigmaVectorSparseList.
+ *
+ * The determinant occupations, the substitution lists, and the integrals are copied to device
+ * memory once on construction. The diagonal, singles, and aa/bb/ab doubles contributions are
+ * then computed by device kernels, while the projection of bad states and the spin are
+ * computed on the host.
+ */
+class SigmaVectorGPU : public SigmaVectorSparseList {
+  public:
+    SigmaVectorGPU(const DeterminantHashVec& space, std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    ~SigmaVectorGPU() override;
+
+  protected:
+    void compute_sigma_kernel(size_t nvec, const double* b_p, double* sigma_p) override;
+
+  private:
+    /// The data stored in device memory
+    std::unique_ptr<SigmaVectorDevice> device_;
+};
+
+} // namespace forte
+
+#endif // _sigma_vector_gpu_h_
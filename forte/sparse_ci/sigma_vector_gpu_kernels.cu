@@ -0,0 +1,290 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <cuda_runtime.h>
+
+#include "sigma_vector_gpu_kernels.h"
+
+namespace forte {
+
+namespace {
+
+/// Number of threads per block
+constexpr unsigned int block_size = 128;
+/// Maximum number of blocks launched by a kernel (the kernels loop over the remaining work)
+constexpr size_t max_blocks = 65535;
+
+void check(cudaError_t error, const char* what) {
+    if (error != cudaSuccess) {
+        throw std::runtime_error(std::string("SigmaVectorDevice: ") + what +
+                                 " failed: " + cudaGetErrorString(error));
+    }
+}
+
+unsigned int num_blocks(size_t work) {
+    return static_cast<unsigned int>(std::max<size_t>(1, std::min(work, max_blocks)));
+}
+
+__device__ inline bool occupied(const uint64_t* occ, size_t nwords, size_t I, size_t p) {
+    return (occ[I * nwords + p / 64] >> (p % 64)) & uint64_t(1);
+}
+
+__device__ inline int orbital(int16_t signed_p) {
+    return (signed_p > 0 ? signed_p : -signed_p) - 1;
+}
+
+__device__ inline double sign(int16_t signed_p) { return signed_p > 0 ? 1.0 : -1.0; }
+
+/// Add the contributions of the coupling <I|H|J> = <J|H|I> to all the vectors
+__device__ inline void add_coupling(size_t I, size_t J, double HIJ, size_t nvec, const double* b,
+                                    double* sigma) {
+    for (size_t n = 0; n < nvec; ++n) {
+        atomicAdd(&sigma[I * nvec + n], HIJ * b[J * nvec + n]);
+        atomicAdd(&sigma[J * nvec + n], HIJ * b[I * nvec + n]);
+    }
+}
+
+__global__ void diagonal_kernel(size_t size, size_t nvec, const double* diag, const double* b,
+                                double* sigma) {
+    for (size_t k = blockIdx.x * size_t(blockDim.x) + threadIdx.x; k < size * nvec;
+         k += size_t(gridDim.x) * blockDim.x) {
+        sigma[k] += diag[k / nvec] * b[k];
+    }
+}
+
+/// One-particle substitutions. Each block of threads processes a group of determinants that
+/// differ from a common string by one electron of spin alfa (true) or beta (false) and couples
+/// all the pairs in the group. The matrix element is computed as in
+/// ActiveSpaceIntegrals::slater_rules_single_alpha_abs/slater_rules_single_beta_abs
+template <bool alfa>
+__global__ void one_particle_kernel(size_t num_groups, const size_t* offsets,
+                                    const DeviceOneParticleCoupling* couplings, size_t nmo,
+                                    size_t nwords, const uint64_t* alfa_occ,
+                                    const uint64_t* beta_occ, const double* oei,
+                                    const double* tei_same, const double* tei_ab, size_t nvec,
+                                    const double* b, double* sigma) {
+    const size_t nmo2 = nmo * nmo;
+    const size_t nmo3 = nmo2 * nmo;
+    const uint64_t* same_occ = alfa ? alfa_occ : beta_occ;
+    const uint64_t* other_occ = alfa ? beta_occ : alfa_occ;
+    for (size_t K = blockIdx.x; K < num_groups; K += gridDim.x) {
+        const size_t begin = offsets[K];
+        const size_t end = offsets[K + 1];
+        for (size_t det = begin + threadIdx.x; det < end; det += blockDim.x) {
+            const DeviceOneParticleCoupling detJ = couplings[det];
+            const size_t J = detJ.index;
+            const int p = orbital(detJ.signed_p);
+            const double sign_p = sign(detJ.signed_p);
+            for (size_t det2 = det + 1; det2 < end; ++det2) {
+                const DeviceOneParticleCoupling detI = couplings[det2];
+                const int q = orbital(detI.signed_p);
+                if (p == q)
+                    continue;
+                double HIJ = oei[p * nmo + q];
+                for (size_t i = 0; i < nmo; ++i) {
+                    if (occupied(same_occ, nwords, J, i)) {
+                        HIJ += tei_same[p * nmo3 + i * nmo2 + q * nmo + i];
+                    }
+                    if (occupied(other_occ, nwords, J, i)) {
+                        HIJ += alfa ? tei_ab[p * nmo3 + i * nmo2 + q * nmo + i]
+                                    : tei_ab[i * nmo3 + p * nmo2 + i * nmo + q];
+                    }
+                }
+                HIJ *= sign_p * sign(detI.signed_p);
+                add_coupling(detI.index, J, HIJ, nvec, b, sigma);
+            }
+        }
+    }
+}
+
+/// Two-particle substitutions. Same-spin (mixed = false) substitutions couple only pairs with
+/// four distinct orbitals, while alpha-beta substitutions (mixed = true) require p != r and
+/// q != s
+template <bool mixed>
+__global__ void two_particle_kernel(size_t num_groups, const size_t* offsets,
+                                    const DeviceTwoParticleCoupling* couplings, size_t nmo,
+                                    const double* tei, size_t nvec, const double* b,
+                                    double* sigma) {
+    const size_t nmo2 = nmo * nmo;
+    const size_t nmo3 = nmo2 * nmo;
+    for (size_t K = blockIdx.x; K < num_groups; K += gridDim.x) {
+        const size_t begin = offsets[K];
+        const size_t end = offsets[K + 1];
+        for (size_t det = begin + threadIdx.x; det < end; det += blockDim.x) {
+            const DeviceTwoParticleCoupling detJ = couplings[det];
+            const size_t J = detJ.index;
+            const int p = orbital(detJ.signed_p);
+            const int q = detJ.q;
+            const double sign_p = sign(detJ.signed_p);
+            for (size_t det2 = det + 1; det2 < end; ++det2) {
+                const DeviceTwoParticleCoupling detI = couplings[det2];
+                const int r = orbital(detI.signed_p);
+                const int s = detI.q;
+                if ((p == r) or (q == s))
+                    continue;
+                if ((not mixed) and ((p == s) or (q == r)))
+                    continue;
+                const double HIJ =
+                    sign_p * sign(detI.signed_p) * tei[p * nmo3 + q * nmo2 + r * nmo + s];
+                add_coupling(detI.index, J, HIJ, nvec, b, sigma);
+            }
+        }
+    }
+}
+
+} // namespace
+
+SigmaVectorDevice::SigmaVectorDevice(size_t size, size_t nmo) : size_(size), nmo_(nmo) {
+    diag_ = static_cast<double*>(copy_to_device(nullptr, size_ * sizeof(double)));
+}
+
+SigmaVectorDevice::~SigmaVectorDevice() {
+    free(diag_);
+    free(oei_a_);
+    free(oei_b_);
+    free(tei_aa_);
+    free(tei_ab_);
+    free(tei_bb_);
+    free(alfa_occ_);
+    free(beta_occ_);
+    free(b_);
+    free(sigma_);
+    for (List* list : {&a_list_, &b_list_, &aa_list_, &ab_list_, &bb_list_}) {
+        free(list->offsets);
+        free(list->couplings);
+    }
+}
+
+void* SigmaVectorDevice::copy_to_device(const void* data, size_t n) {
+    void* ptr = nullptr;
+    check(cudaMalloc(&ptr, std::max<size_t>(n, 1)), "cudaMalloc");
+    memory_ += n;
+    if (data != nullptr) {
+        check(cudaMemcpy(ptr, data, n, cudaMemcpyHostToDevice), "cudaMemcpy");
+    }
+    return ptr;
+}
+
+void SigmaVectorDevice::free(void* ptr) {
+    // errors are ignored since this function is called by the destructor
+    if (ptr != nullptr) {
+        cudaFree(ptr);
+    }
+}
+
+void SigmaVectorDevice::set_diagonal(const double* diag) {
+    check(cudaMemcpy(diag_, diag, size_ * sizeof(double), cudaMemcpyHostToDevice), "cudaMemcpy");
+}
+
+void SigmaVectorDevice::set_integrals(const double* oei_a, const double* oei_b,
+                                      const double* tei_aa, const double* tei_ab,
+                                      const double* tei_bb) {
+    const size_t oei_size = nmo_ * nmo_ * sizeof(double);
+    const size_t tei_size = nmo_ * nmo_ * nmo_ * nmo_ * sizeof(double);
+    oei_a_ = static_cast<double*>(copy_to_device(oei_a, oei_size));
+    oei_b_ = static_cast<double*>(copy_to_device(oei_b, oei_size));
+    tei_aa_ = static_cast<double*>(copy_to_device(tei_aa, tei_size));
+    tei_ab_ = static_cast<double*>(copy_to_device(tei_ab, tei_size));
+    tei_bb_ = static_cast<double*>(copy_to_device(tei_bb, tei_size));
+}
+
+void SigmaVectorDevice::set_occupations(size_t nwords, const uint64_t* alfa,
+                                        const uint64_t* beta) {
+    nwords_ = nwords;
+    alfa_occ_ = static_cast<uint64_t*>(copy_to_device(alfa, size_ * nwords_ * sizeof(uint64_t)));
+    beta_occ_ = static_cast<uint64_t*>(copy_to_device(beta, size_ * nwords_ * sizeof(uint64_t)));
+}
+
+void SigmaVectorDevice::set_list(List& list, const std::vector<size_t>& offsets,
+                                 const void* couplings, size_t coupling_size) {
+    list.num_groups = offsets.size() - 1;
+    list.offsets = static_cast<size_t*>(
+        copy_to_device(offsets.data(), offsets.size() * sizeof(size_t)));
+    list.couplings = copy_to_device(couplings, offsets.back() * coupling_size);
+}
+
+void SigmaVectorDevice::set_one_particle_list(bool alfa, const std::vector<size_t>& offsets,
+                                              const DeviceOneParticleCoupling* couplings) {
+    set_list(alfa ? a_list_ : b_list_, offsets, couplings, sizeof(DeviceOneParticleCoupling));
+}
+
+void SigmaVectorDevice::set_two_particle_list(TwoParticleList list,
+                                              const std::vector<size_t>& offsets,
+                                              const DeviceTwoParticleCoupling* couplings) {
+    List& l = (list == TwoParticleList::aa) ? aa_list_
+                                            : ((list == TwoParticleList::ab) ? ab_list_ : bb_list_);
+    set_list(l, offsets, couplings, sizeof(DeviceTwoParticleCoupling));
+}
+
+void SigmaVectorDevice::compute_sigma(size_t nvec, const double* b, double* sigma) {
+    if (nvec > max_nvec_) {
+        free(b_);
+        free(sigma_);
+        memory_ -= 2 * max_nvec_ * size_ * sizeof(double);
+        b_ = sigma_ = nullptr;
+        max_nvec_ = 0;
+        b_ = static_cast<double*>(copy_to_device(nullptr, nvec * size_ * sizeof(double)));
+        sigma_ = static_cast<double*>(copy_to_device(nullptr, nvec * size_ * sizeof(double)));
+        max_nvec_ = nvec;
+    }
+    const size_t n = nvec * size_ * sizeof(double);
+    check(cudaMemcpy(b_, b, n, cudaMemcpyHostToDevice), "cudaMemcpy");
+    check(cudaMemcpy(sigma_, sigma, n, cudaMemcpyHostToDevice), "cudaMemcpy");
+
+    diagonal_kernel<<<num_blocks((size_ * nvec + block_size - 1) / block_size), block_size>>>(
+        size_, nvec, diag_, b_, sigma_);
+    one_particle_kernel<true><<<num_blocks(a_list_.num_groups), block_size>>>(
+        a_list_.num_groups, a_list_.offsets,
+        static_cast<const DeviceOneParticleCoupling*>(a_list_.couplings), nmo_, nwords_,
+        alfa_occ_, beta_occ_, oei_a_, tei_aa_, tei_ab_, nvec, b_, sigma_);
+    one_particle_kernel<false><<<num_blocks(b_list_.num_groups), block_size>>>(
+        b_list_.num_groups, b_list_.offsets,
+        static_cast<const DeviceOneParticleCoupling*>(b_list_.couplings), nmo_, nwords_,
+        alfa_occ_, beta_occ_, oei_b_, tei_bb_, tei_ab_, nvec, b_, sigma_);
+    two_particle_kernel<false><<<num_blocks(aa_list_.num_groups), block_size>>>(
+        aa_list_.num_groups, aa_list_.offsets,
+        static_cast<const DeviceTwoParticleCoupling*>(aa_list_.couplings), nmo_, tei_aa_, nvec,
+        b_, sigma_);
+    two_particle_kernel<false><<<num_blocks(bb_list_.num_groups), block_size>>>(
+        bb_list_.num_groups, bb_list_.offsets,
+        static_cast<const DeviceTwoParticleCoupling*>(bb_list_.couplings), nmo_, tei_bb_, nvec,
+        b_, sigma_);
+    two_particle_kernel<true><<<num_blocks(ab_list_.num_groups), block_size>>>(
+        ab_list_.num_groups, ab_list_.offsets,
+        static_cast<const DeviceTwoParticleCoupling*>(ab_list_.couplings), nmo_, tei_ab_, nvec,
+        b_, sigma_);
+    check(cudaGetLastError(), "kernel launch");
+
+    check(cudaMemcpy(sigma, sigma_, n, cudaMemcpyDeviceToHost), "cudaMemcpy");
+}
+
+} // namespace forte
@@ -0,0 +1,135 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _sigma_vector_gpu_kernels_h_
+#define _sigma_vector_gpu_kernels_h_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace forte {
+
+/// Device layout of OneParticleCoupling (see determinant_substitution_lists.h)
+struct DeviceOneParticleCoupling {
+    uint32_t index;
+    int16_t signed_p;
+};
+
+/// Device layout of TwoParticleCoupling (see determinant_substitution_lists.h)
+struct DeviceTwoParticleCoupling {
+    uint32_t index;
+    int16_t signed_p;
+    int16_t q;
+};
+
+/**
+ * @brief The SigmaVectorDevice class
+ * Holds the data needed to compute sigma vectors in device memory and launches the kernels.
+ *
+ * This class depends only on the CUDA runtime so that it can be compiled by nvcc without the
+ * Psi4 headers. All the pointers passed to its functions are host pointers and the data are
+ * copied to device memory when they are set.
+ */
+class SigmaVectorDevice {
+  public:
+    /// The two-particle substitution lists
+    enum class TwoParticleList { aa, ab, bb };
+
+    /// Allocate a device object for a space of size determinants in nmo orbitals
+    SigmaVectorDevice(size_t size, size_t nmo);
+    ~SigmaVectorDevice();
+
+    SigmaVectorDevice(const SigmaVectorDevice&) = delete;
+    SigmaVectorDevice& operator=(const SigmaVectorDevice&) = delete;
+
+    /// Set the diagonal of the Hamiltonian (size elements)
+    void set_diagonal(const double* diag);
+    /// Set the one-electron (nmo^2 elements) and two-electron (nmo^4 elements) integrals
+    void set_integrals(const double* oei_a, const double* oei_b, const double* tei_aa,
+                       const double* tei_ab, const double* tei_bb);
+    /// Set the alpha and beta occupation of the determinants, each stored as nwords 64-bit words
+    void set_occupations(size_t nwords, const uint64_t* alfa, const uint64_t* beta);
+    /// Set the alpha (alfa = true) or beta one-particle substitution list
+    void set_one_particle_list(bool alfa, const std::vector<size_t>& offsets,
+                               const DeviceOneParticleCoupling* couplings);
+    /// Set one of the two-particle substitution lists
+    void set_two_particle_list(TwoParticleList list, const std::vector<size_t>& offsets,
+                               const DeviceTwoParticleCoupling* couplings);
+
+    /// Add H b to sigma for nvec vectors stored interleaved (element I of vector n is stored at
+    /// I * nvec + n)
+    void compute_sigma(size_t nvec, const double* b, double* sigma);
+
+    /// @return the device memory used by this object in bytes
+    size_t memory() const { return memory_; }
+
+  private:
+    /// A substitution list in device memory
+    struct List {
+        size_t num_groups = 0;
+        size_t* offsets = nullptr;
+        void* couplings = nullptr;
+    };
+
+    /// Allocate device memory and copy n bytes from the host (if data is not null)
+    void* copy_to_device(const void* data, size_t n);
+    /// Copy a substitution list to device memory
+    void set_list(List& list, const std::vector<size_t>& offsets, const void* couplings,
+                  size_t coupling_size);
+    /// Free a block of device memory
+    void free(void* ptr);
+
+    size_t size_;
+    size_t nmo_;
+    size_t nwords_ = 0;
+    size_t memory_ = 0;
+
+    double* diag_ = nullptr;
+    double* oei_a_ = nullptr;
+    double* oei_b_ = nullptr;
+    double* tei_aa_ = nullptr;
+    double* tei_ab_ = nullptr;
+    double* tei_bb_ = nullptr;
+    uint64_t* alfa_occ_ = nullptr;
+    uint64_t* beta_occ_ = nullptr;
+    List a_list_;
+    List b_list_;
+    List aa_list_;
+    List ab_list_;
+    List bb_list_;
+
+    /// The b and sigma vectors, reallocated when a larger block of vectors is requested
+    size_t max_nvec_ = 0;
+    double* b_ = nullptr;
+    double* sigma_ = nullptr;
+};
+
+} // namespace forte
+
+#endif // _sigma_vector_gpu_kernels_h_
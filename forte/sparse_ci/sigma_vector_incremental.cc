@@ -0,0 +1,313 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "psi4/psi4-dec.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+
+#include "helpers/timer.h"
+#include "integrals/active_space_integrals.h"
+#include "sparse_ci/determinant_substitution_lists.h"
+#include "sigma_vector_incremental.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#define omp_get_num_threads() 1
+#endif
+
+using namespace psi;
+
+namespace forte {
+
+namespace {
+/// A coupling <I|H|J> found in the substitution lists
+struct NewCoupling {
+    uint32_t I;
+    uint32_t J;
+    double H_IJ;
+};
+
+/// Add to found[thread] the couplings between the pairs of determinants in the groups of list
+/// that involve at least one new determinant. coupling(detJ, detI) returns <I|H|J> or zero if the
+/// two determinants are not coupled by the substitutions of this list
+template <typename T, typename F>
+void find_new_couplings(const CouplingList<T>& list, const std::vector<char>& is_new,
+                        double threshold, std::vector<std::vector<NewCoupling>>& found,
+                        F coupling) {
+#pragma omp parallel
+    {
+        auto& thread_found = found[omp_get_thread_num()];
+#pragma omp for schedule(dynamic, 64)
+        for (size_t K = 0; K < list.size(); ++K) {
+            const auto c_dets = list[K];
+            bool has_new = false;
+            for (const auto& det : c_dets) {
+                if (is_new[det.index]) {
+                    has_new = true;
+                    break;
+                }
+            }
+            if (not has_new)
+                continue;
+            const size_t max_det = c_dets.size();
+            for (size_t det = 0; det < max_det; ++det) {
+                const auto& detJ = c_dets[det];
+                for (size_t det2 = det + 1; det2 < max_det; ++det2) {
+                    const auto& detI = c_dets[det2];
+                    if (not(is_new[detI.index] or is_new[detJ.index]))
+                        continue;
+                    const double H_IJ = coupling(detJ, detI);
+                    if (std::fabs(H_IJ) >= threshold) {
+                        thread_found.push_back({detI.index, detJ.index, H_IJ});
+                    }
+                }
+            }
+        }
+    }
+}
+} // namespace
+
+void IncrementalHamiltonian::clear() {
+    space_ = DeterminantHashVec();
+    fci_ints_ = nullptr;
+    row_offsets_.assign(1, 0);
+    cols_ = std::vector<uint32_t>();
+    values_ = std::vector<double>();
+    num_new_couplings_ = 0;
+}
+
+void IncrementalHamiltonian::update(const DeterminantHashVec& space,
+                                    const DeterminantSubstitutionLists& op,
+                                    std::shared_ptr<ActiveSpaceIntegrals> fci_ints) {
+    // couplings computed with different integrals cannot be reused
+    if (fci_ints != fci_ints_) {
+        clear();
+        fci_ints_ = fci_ints;
+    }
+
+    const det_hashvec& dets = space.wfn_hash();
+    const size_t num_dets = dets.size();
+    const size_t num_old_dets = size();
+    const size_t npos = std::numeric_limits<size_t>::max();
+
+    // map the determinants of the new space to the old one and back
+    std::vector<size_t> old_index(num_dets, npos);
+    std::vector<size_t> new_index(num_old_dets, npos);
+    std::vector<char> is_new(num_dets, 1);
+#pragma omp parallel for
+    for (size_t I = 0; I < num_dets; ++I) {
+        if (space_.has_det(dets[I])) {
+            old_index[I] = space_.get_idx(dets[I]);
+            new_index[old_index[I]] = I;
+            is_new[I] = 0;
+        }
+    }
+
+    // evaluate the couplings that involve at least one new determinant
+    std::vector<std::vector<NewCoupling>> found(omp_get_max_threads());
+    find_new_couplings(op.a_list_, is_new, H_threshold_, found, [&](const auto& J, const auto& I) {
+        return (J.p() != I.p())
+                   ? fci_ints_->slater_rules_single_alpha_abs(dets[J.index], J.p(), I.p()) *
+                         J.sign() * I.sign()
+                   : 0.0;
+    });
+    find_new_couplings(op.b_list_, is_new, H_threshold_, found, [&](const auto& J, const auto& I) {
+        return (J.p() != I.p())
+                   ? fci_ints_->slater_rules_single_beta_abs(dets[J.index], J.p(), I.p()) *
+                         J.sign() * I.sign()
+                   : 0.0;
+    });
+    find_new_couplings(op.aa_list_, is_new, H_threshold_, found, [&](const auto& J, const auto& I) {
+        const size_t p = J.p(), q = J.q, r = I.p(), s = I.q;
+        return ((p != r) and (q != s) and (p != s) and (q != r))
+                   ? J.sign() * I.sign() * fci_ints_->tei_aa(p, q, r, s)
+                   : 0.0;
+    });
+    find_new_couplings(op.bb_list_, is_new, H_threshold_, found, [&](const auto& J, const auto& I) {
+        const size_t p = J.p(), q = J.q, r = I.p(), s = I.q;
+        return ((p != r) and (q != s) and (p != s) and (q != r))
+                   ? J.sign() * I.sign() * fci_ints_->tei_bb(p, q, r, s)
+                   : 0.0;
+    });
+    find_new_couplings(op.ab_list_, is_new, H_threshold_, found, [&](const auto& J, const auto& I) {
+        const size_t p = J.p(), q = J.q, r = I.p(), s = I.q;
+        return ((p != r) and (q != s)) ? J.sign() * I.sign() * fci_ints_->tei_ab(p, q, r, s)
+                                       : 0.0;
+    });
+
+    // count the couplings of each row. Each coupling is stored once, in the row of one of the
+    // two determinants, so the couplings kept from the old space stay in the same row
+    std::vector<size_t> row_size(num_dets, 0);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (size_t I = 0; I < num_dets; ++I) {
+        if (old_index[I] != npos) {
+            for (size_t e = row_offsets_[old_index[I]]; e < row_offsets_[old_index[I] + 1]; ++e) {
+                row_size[I] += (new_index[cols_[e]] != npos);
+            }
+        }
+    }
+    num_new_couplings_ = 0;
+    for (const auto& thread_found : found) {
+        for (const auto& c : thread_found) {
+            row_size[c.I]++;
+        }
+        num_new_couplings_ += thread_found.size();
+    }
+
+    std::vector<size_t> row_offsets(num_dets + 1, 0);
+    for (size_t I = 0; I < num_dets; ++I) {
+        row_offsets[I + 1] = row_offsets[I] + row_size[I];
+    }
+    std::vector<uint32_t> cols(row_offsets.back());
+    std::vector<double> values(row_offsets.back());
+
+    // copy the old couplings and then append the new ones
+#pragma omp parallel for schedule(dynamic, 64)
+    for (size_t I = 0; I < num_dets; ++I) {
+        size_t pos = row_offsets[I];
+        if (old_index[I] != npos) {
+            for (size_t e = row_offsets_[old_index[I]]; e < row_offsets_[old_index[I] + 1]; ++e) {
+                const size_t J = new_index[cols_[e]];
+                if (J != npos) {
+                    cols[pos] = static_cast<uint32_t>(J);
+                    values[pos] = values_[e];
+                    pos++;
+                }
+            }
+        }
+        row_size[I] = pos;
+    }
+    for (auto& thread_found : found) {
+        for (const auto& c : thread_found) {
+            const size_t pos = row_size[c.I]++;
+            cols[pos] = c.J;
+            values[pos] = c.H_IJ;
+        }
+        thread_found = std::vector<NewCoupling>();
+    }
+
+    space_ = space;
+    row_offsets_.swap(row_offsets);
+    cols_.swap(cols);
+    values_.swap(values);
+}
+
+void IncrementalHamiltonian::compute_sigma(size_t nvec, const std::vector<double>& diag,
+                                           const double* b_p, double* sigma_p) const {
+    const size_t num_dets = size();
+    const size_t num_couplings = cols_.size();
+
+    // Each thread adds the couplings of its rows directly to sigma. Since J < I, the transposed
+    // contributions <J|H|I> b_I go either to the rows of the same thread or to rows of the
+    // threads that precede it, which are accumulated in a buffer that covers only those rows
+    int nthreads = 1;
+    std::vector<size_t> first_row;
+    std::vector<std::vector<double>> buffers;
+#pragma omp parallel
+    {
+#pragma omp single
+        {
+            // split the rows in contiguous blocks with about the same number of couplings
+            nthreads = omp_get_num_threads();
+            first_row.assign(nthreads + 1, num_dets);
+            for (int t = 1; t < nthreads; ++t) {
+                const size_t target = (num_couplings * t) / nthreads;
+                first_row[t] =
+                    std::lower_bound(row_offsets_.begin(), row_offsets_.end() - 1, target) -
+                    row_offsets_.begin();
+            }
+            first_row[0] = 0;
+            buffers.resize(nthreads);
+        }
+        const int tid = omp_get_thread_num();
+        const size_t first = first_row[tid];
+        const size_t last = first_row[tid + 1];
+        auto& buffer = buffers[tid];
+        buffer.assign(first * nvec, 0.0);
+
+        for (size_t I = first; I < last; ++I) {
+            double* sigma_I = sigma_p + I * nvec;
+            const double* b_I = b_p + I * nvec;
+            for (size_t n = 0; n < nvec; ++n) {
+                sigma_I[n] += diag[I] * b_I[n];
+            }
+            for (size_t e = row_offsets_[I], max_e = row_offsets_[I + 1]; e < max_e; ++e) {
+                const size_t J = cols_[e];
+                const double HIJ = values_[e];
+                const double* b_J = b_p + J * nvec;
+                double* sigma_J = J >= first ? sigma_p + J * nvec : buffer.data() + J * nvec;
+                for (size_t n = 0; n < nvec; ++n) {
+                    sigma_I[n] += HIJ * b_J[n];
+                    sigma_J[n] += HIJ * b_I[n];
+                }
+            }
+        }
+
+#pragma omp barrier
+        // add the buffers of the threads whose rows follow row I
+#pragma omp for schedule(static)
+        for (size_t I = 0; I < first_row[nthreads - 1]; ++I) {
+            for (int t = nthreads - 1; t > 0 and first_row[t] > I; --t) {
+                const double* buffer_I = buffers[t].data() + I * nvec;
+                for (size_t n = 0; n < nvec; ++n) {
+                    sigma_p[I * nvec + n] += buffer_I[n];
+                }
+            }
+        }
+    }
+}
+
+SigmaVectorIncremental::SigmaVectorIncremental(const DeterminantHashVec& space,
+                                               std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                                               std::shared_ptr<IncrementalHamiltonian> hamiltonian)
+    : SigmaVectorSparseList(space, fci_ints, SigmaVectorType::Incremental,
+                            "SigmaVectorIncremental"),
+      hamiltonian_(hamiltonian) {
+    local_timer t;
+    hamiltonian_->update(space_, *op_, fci_ints_);
+
+    // the one-particle lists are only needed to find the new couplings
+    op_->clear_op_s_lists();
+
+    outfile->Printf("\n  Stored %zu couplings (%zu new) using %.2f MB in %.3e seconds",
+                    hamiltonian_->num_couplings(), hamiltonian_->num_new_couplings(),
+                    hamiltonian_->memory() / (1024. * 1024.), t.get());
+}
+
+void SigmaVectorIncremental::compute_sigma_kernel(size_t nvec, const double* b_p,
+                                                  double* sigma_p) {
+    hamiltonian_->compute_sigma(nvec, diag_, b_p, sigma_p);
+}
+
+} // namespace forte
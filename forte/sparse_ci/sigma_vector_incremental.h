@@ -0,0 +1,122 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _sigma_vector_incremental_h_
+#define _sigma_vector_incremental_h_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sigma_vector_sparse_list.h"
+
+namespace forte {
+
+/**
+ * @brief The Hamiltonian couplings <I|H|J> (I > J) of a determinant space that are kept from one
+ * sigma vector object to the next.
+ *
+ * Selected CI methods diagonalize the Hamiltonian in a sequence of spaces that share most of
+ * their determinants. When the space changes, update() copies the couplings between the
+ * determinants that were already in the previous space and evaluates only the couplings that
+ * involve at least one new determinant. The couplings are stored in compressed sparse row format,
+ * indexed by the position of the determinants in the current space.
+ */
+class IncrementalHamiltonian {
+  public:
+    /// Update the couplings for a new space. op must contain the one- and two-particle
+    /// substitution lists of space
+    void update(const DeterminantHashVec& space, const DeterminantSubstitutionLists& op,
+                std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+    /// Remove all the couplings
+    void clear();
+    /// Add H b to sigma for nvec vectors stored interleaved (element I of vector n is stored at
+    /// I * nvec + n). diag contains the diagonal elements of H, which are not stored here
+    void compute_sigma(size_t nvec, const std::vector<double>& diag, const double* b_p,
+                       double* sigma_p) const;
+
+    /// @return the number of determinants in the current space
+    size_t size() const { return row_offsets_.size() - 1; }
+    /// @return the number of couplings stored
+    size_t num_couplings() const { return cols_.size(); }
+    /// @return the memory used by the couplings in bytes
+    size_t memory() const {
+        return row_offsets_.capacity() * sizeof(size_t) + cols_.capacity() * sizeof(uint32_t) +
+               values_.capacity() * sizeof(double);
+    }
+    /// @return the number of couplings evaluated in the last update
+    size_t num_new_couplings() const { return num_new_couplings_; }
+
+    /// The couplings of row I are stored in the range [row_offsets()[I], row_offsets()[I + 1])
+    const std::vector<size_t>& row_offsets() const { return row_offsets_; }
+    /// The index J < I of each coupling
+    const std::vector<uint32_t>& cols() const { return cols_; }
+    /// The value of each coupling
+    const std::vector<double>& values() const { return values_; }
+
+  private:
+    /// The space of the last update
+    DeterminantHashVec space_;
+    /// The integrals used to compute the couplings
+    std::shared_ptr<ActiveSpaceIntegrals> fci_ints_;
+    /// The couplings in compressed sparse row format
+    std::vector<size_t> row_offsets_ = std::vector<size_t>(1, 0);
+    std::vector<uint32_t> cols_;
+    std::vector<double> values_;
+    /// The number of couplings evaluated in the last update
+    size_t num_new_couplings_ = 0;
+    /// Couplings smaller than this threshold are not stored
+    double H_threshold_ = 1.0e-14;
+};
+
+/**
+ * @brief The SigmaVectorIncremental class
+ * Computes the sigma vector from the couplings stored in an IncrementalHamiltonian object.
+ *
+ * The object passed to the constructor is updated for the space of this sigma vector, so that
+ * sharing it among the sigma vectors built in successive iterations of a selected CI method
+ * avoids recomputing the couplings between the determinants that carry over.
+ */
+class SigmaVectorIncremental : public SigmaVectorSparseList {
+  public:
+    SigmaVectorIncremental(const DeterminantHashVec& space,
+                           std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                           std::shared_ptr<IncrementalHamiltonian> hamiltonian =
+                               std::make_shared<IncrementalHamiltonian>());
+
+  protected:
+    void compute_sigma_kernel(size_t nvec, const double* b_p, double* sigma_p) override;
+
+  private:
+    /// The stored couplings
+    std::shared_ptr<IncrementalHamiltonian> hamiltonian_;
+};
+
+} // namespace forte
+
+#endif // _sigma_vector_incremental_h_
@@ -27,11 +27,16 @@
  */
 
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
 
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/vector.h"
 
+#include "helpers/timer.h"
+#include "sigma_vector_incremental.h"
 #include "sigma_vector_sparse_list.h"
 #include "sparse_ci/determinant_substitution_lists.h"
 
@@ -48,8 +53,50 @@ using namespace psi;
 namespace forte {
 
 SigmaVectorSparseList::SigmaVectorSparseList(const DeterminantHashVec& space,
-                                             std::shared_ptr<ActiveSpaceIntegrals> fci_ints)
-    : SigmaVector(space, fci_ints, SigmaVectorType::SparseList, "SigmaVectorSparseList") {
+                                             std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                                             size_t max_memory)
+    : SigmaVectorSparseList(space, fci_ints, SigmaVectorType::SparseList,
+                            "SigmaVectorSparseList") {
+    if (max_memory == 0 or size_ > std::numeric_limits<uint32_t>::max())
+        return;
+
+    // an upper bound to the number of couplings: all the pairs of determinants in each group
+    size_t max_couplings = 0;
+    auto count_pairs = [&max_couplings](const auto& list) {
+        for (size_t K = 0, max_K = list.size(); K < max_K; ++K) {
+            const size_t n = list[K].size();
+            max_couplings += n * (n - 1) / 2;
+        }
+    };
+    count_pairs(op_->a_list_);
+    count_pairs(op_->b_list_);
+    count_pairs(op_->aa_list_);
+    count_pairs(op_->ab_list_);
+    count_pairs(op_->bb_list_);
+
+    // the couplings are stored as (uint32_t, double) and are collected in (I, J, H_IJ) tuples
+    // while the matrix is built
+    const size_t bytes_per_coupling =
+        2 * sizeof(uint32_t) + 2 * sizeof(double) + sizeof(std::tuple<uint32_t, uint32_t, double>);
+    if (max_couplings * bytes_per_coupling > max_memory * sizeof(double))
+        return;
+
+    local_timer t;
+    stored_hamiltonian_ = std::make_shared<IncrementalHamiltonian>();
+    stored_hamiltonian_->update(space_, *op_, fci_ints_);
+
+    // the one-particle lists are not needed anymore
+    op_->clear_op_s_lists();
+
+    outfile->Printf("\n  Stored %zu couplings using %.2f MB in %.3e seconds",
+                    stored_hamiltonian_->num_couplings(),
+                    stored_hamiltonian_->memory() / (1024. * 1024.), t.get());
+}
+
+SigmaVectorSparseList::SigmaVectorSparseList(const DeterminantHashVec& space,
+                                             std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                                             SigmaVectorType sigma_vector_type, std::string label)
+    : SigmaVector(space, fci_ints, sigma_vector_type, label) {
 
     op_ = std::make_shared<DeterminantSubstitutionLists>(fci_ints_);
     /// Build the coupling lists for 1- and 2-particle operators
@@ -80,17 +127,38 @@ void SigmaVectorSparseList::get_diagonal(psi::Vector& diag) {
 }
 
 void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVector b) {
-    auto a_list_ = op_->a_list_;
-    auto b_list_ = op_->b_list_;
-    auto aa_list_ = op_->aa_list_;
-    auto ab_list_ = op_->ab_list_;
-    auto bb_list_ = op_->bb_list_;
-
     sigma->zero();
+    project_bad_states(b->pointer());
+    compute_sigma_kernel(1, b->pointer(), sigma->pointer());
+}
 
-    double* sigma_p = sigma->pointer();
-    double* b_p = b->pointer();
+void SigmaVectorSparseList::compute_sigma_block(const std::vector<psi::SharedVector>& sigma,
+                                                const std::vector<psi::SharedVector>& b) {
+    const size_t nvec = b.size();
+    if ((nvec == 1) or (sigma.size() != nvec)) {
+        SigmaVector::compute_sigma_block(sigma, b);
+        return;
+    }
+    // store the vectors interleaved so that the couplings are traversed only once
+    std::vector<double> b_block(size_ * nvec);
+    std::vector<double> sigma_block(size_ * nvec, 0.0);
+    for (size_t n = 0; n < nvec; ++n) {
+        double* b_p = b[n]->pointer();
+        project_bad_states(b_p);
+        for (size_t I = 0; I < size_; ++I) {
+            b_block[I * nvec + n] = b_p[I];
+        }
+    }
+    compute_sigma_kernel(nvec, b_block.data(), sigma_block.data());
+    for (size_t n = 0; n < nvec; ++n) {
+        double* sigma_p = sigma[n]->pointer();
+        for (size_t I = 0; I < size_; ++I) {
+            sigma_p[I] = sigma_block[I * nvec + n];
+        }
+    }
+}
 
+void SigmaVectorSparseList::project_bad_states(double* b_p) {
     // Compute the overlap with each root
     int nbad = bad_states_.size();
     std::vector<double> overlap(nbad);
@@ -115,6 +183,20 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
             }
         }
     }
+}
+
+void SigmaVectorSparseList::compute_sigma_kernel(size_t nvec, const double* b_p,
+                                                 double* sigma_p) {
+    if (stored_hamiltonian_) {
+        stored_hamiltonian_->compute_sigma(nvec, diag_, b_p, sigma_p);
+        return;
+    }
+
+    const auto& a_list_ = op_->a_list_;
+    const auto& b_list_ = op_->b_list_;
+    const auto& aa_list_ = op_->aa_list_;
+    const auto& ab_list_ = op_->ab_list_;
+    const auto& bb_list_ = op_->bb_list_;
 
     auto& dets = space_.wfn_hash();
 
@@ -124,7 +206,14 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
         size_t tid = omp_get_thread_num();
 
         // Each thread gets local copy of sigma
-        std::vector<double> sigma_t(size_);
+        std::vector<double> sigma_t(size_ * nvec);
+        // add the contributions of the coupling <I|H|J> to all the vectors
+        auto add_coupling = [&](size_t I, size_t J, double HIJ) {
+            for (size_t n = 0; n < nvec; ++n) {
+                sigma_t[I * nvec + n] += HIJ * b_p[J * nvec + n];
+                sigma_t[J * nvec + n] += HIJ * b_p[I * nvec + n];
+            }
+        };
 
         size_t bin_size = size_ / num_thread;
         bin_size += (tid < (size_ % num_thread)) ? 1 : 0;
@@ -135,7 +224,9 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
         size_t end_idx = start_idx + bin_size;
 
         for (size_t J = start_idx; J < end_idx; ++J) {
-            sigma_p[J] += diag_[J] * b_p[J]; // Make DDOT
+            for (size_t n = 0; n < nvec; ++n) {
+                sigma_p[J * nvec + n] += diag_[J] * b_p[J * nvec + n]; // Make DDOT
+            }
         }
 
         // a singles
@@ -143,24 +234,23 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
         size_t start_a_idx = 0;
         for (size_t K = start_a_idx, max_K = end_a_idx; K < max_K; ++K) {
             if ((K % num_thread) == tid) {
-                const std::vector<std::pair<size_t, short>>& c_dets = a_list_[K];
+                const auto c_dets = a_list_[K];
                 size_t max_det = c_dets.size();
                 for (size_t det = 0; det < max_det; ++det) {
                     auto& detJ = c_dets[det];
-                    const size_t J = detJ.first;
-                    const size_t p = std::abs(detJ.second) - 1;
-                    double sign_p = detJ.second > 0.0 ? 1.0 : -1.0;
+                    const size_t J = detJ.index;
+                    const size_t p = detJ.p();
+                    double sign_p = detJ.sign();
                     for (size_t det2 = det + 1; det2 < max_det; ++det2) {
                         auto& detI = c_dets[det2];
-                        const size_t q = std::abs(detI.second) - 1;
+                        const size_t q = detI.p();
                         if (p != q) {
-                            const size_t I = detI.first;
-                            double sign_q = detI.second > 0.0 ? 1.0 : -1.0;
+                            const size_t I = detI.index;
+                            double sign_q = detI.sign();
                             const double HIJ =
                                 fci_ints_->slater_rules_single_alpha_abs(dets[J], p, q) * sign_p *
                                 sign_q;
-                            sigma_t[I] += HIJ * b_p[J];
-                            sigma_t[J] += HIJ * b_p[I];
+                            add_coupling(I, J, HIJ);
                         }
                     }
                 }
@@ -173,24 +263,23 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
         for (size_t K = start_b_idx, max_K = end_b_idx; K < max_K; ++K) {
             // aa singles
             if ((K % num_thread) == tid) {
-                const std::vector<std::pair<size_t, short>>& c_dets = b_list_[K];
+                const auto c_dets = b_list_[K];
                 size_t max_det = c_dets.size();
                 for (size_t det = 0; det < max_det; ++det) {
                     auto& detJ = c_dets[det];
-                    const size_t J = detJ.first;
-                    const size_t p = std::abs(detJ.second) - 1;
-                    double sign_p = detJ.second > 0.0 ? 1.0 : -1.0;
+                    const size_t J = detJ.index;
+                    const size_t p = detJ.p();
+                    double sign_p = detJ.sign();
                     for (size_t det2 = det + 1; det2 < max_det; ++det2) {
                         auto& detI = c_dets[det2];
-                        const size_t q = std::abs(detI.second) - 1;
+                        const size_t q = detI.p();
                         if (p != q) {
-                            const size_t I = detI.first;
-                            double sign_q = detI.second > 0.0 ? 1.0 : -1.0;
+                            const size_t I = detI.index;
+                            double sign_q = detI.sign();
                             const double HIJ =
                                 fci_ints_->slater_rules_single_beta_abs(dets[J], p, q) * sign_p *
                                 sign_q;
-                            sigma_t[I] += HIJ * b_p[J];
-                            sigma_t[J] += HIJ * b_p[I];
+                            add_coupling(I, J, HIJ);
                         }
                     }
                 }
@@ -208,24 +297,23 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
         //      size_t end_aa_idx = start_aa_idx + bin_aa_size;
         for (size_t K = 0, max_K = aa_size; K < max_K; ++K) {
             if ((K % num_thread) == tid) {
-                const std::vector<std::tuple<size_t, short, short>>& c_dets = aa_list_[K];
+                const auto c_dets = aa_list_[K];
                 size_t max_det = c_dets.size();
                 for (size_t det = 0; det < max_det; ++det) {
                     auto& detJ = c_dets[det];
-                    size_t J = std::get<0>(detJ);
-                    short p = std::abs(std::get<1>(detJ)) - 1;
-                    short q = std::get<2>(detJ);
-                    double sign_p = std::get<1>(detJ) > 0.0 ? 1.0 : -1.0;
+                    size_t J = detJ.index;
+                    short p = detJ.p();
+                    short q = detJ.q;
+                    double sign_p = detJ.sign();
                     for (size_t det2 = det + 1; det2 < max_det; ++det2) {
                         auto& detI = c_dets[det2];
-                        short r = std::abs(std::get<1>(detI)) - 1;
-                        short s = std::get<2>(detI);
+                        short r = detI.p();
+                        short s = detI.q;
                         if ((p != r) and (q != s) and (p != s) and (q != r)) {
-                            size_t I = std::get<0>(detI);
-                            double sign_q = std::get<1>(detI) > 0.0 ? 1.0 : -1.0;
+                            size_t I = detI.index;
+                            double sign_q = detI.sign();
                             double HIJ = sign_p * sign_q * fci_ints_->tei_aa(p, q, r, s);
-                            sigma_t[I] += HIJ * b_p[J];
-                            sigma_t[J] += HIJ * b_p[I];
+                            add_coupling(I, J, HIJ);
                         }
                     }
                 }
@@ -235,24 +323,23 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
         // BB doubles
         for (size_t K = 0, max_K = bb_list_.size(); K < max_K; ++K) {
             if ((K % num_thread) == tid) {
-                const std::vector<std::tuple<size_t, short, short>>& c_dets = bb_list_[K];
+                const auto c_dets = bb_list_[K];
                 size_t max_det = c_dets.size();
                 for (size_t det = 0; det < max_det; ++det) {
                     auto& detJ = c_dets[det];
-                    size_t J = std::get<0>(detJ);
-                    short p = std::abs(std::get<1>(detJ)) - 1;
-                    short q = std::get<2>(detJ);
-                    double sign_p = std::get<1>(detJ) > 0.0 ? 1.0 : -1.0;
+                    size_t J = detJ.index;
+                    short p = detJ.p();
+                    short q = detJ.q;
+                    double sign_p = detJ.sign();
                     for (size_t det2 = det + 1; det2 < max_det; ++det2) {
                         auto& detI = c_dets[det2];
-                        short r = std::abs(std::get<1>(detI)) - 1;
-                        short s = std::get<2>(detI);
+                        short r = detI.p();
+                        short s = detI.q;
                         if ((p != r) and (q != s) and (p != s) and (q != r)) {
-                            size_t I = std::get<0>(detI);
-                            double sign_q = std::get<1>(detI) > 0.0 ? 1.0 : -1.0;
+                            size_t I = detI.index;
+                            double sign_q = detI.sign();
                             double HIJ = sign_p * sign_q * fci_ints_->tei_bb(p, q, r, s);
-                            sigma_t[I] += HIJ * b_p[J];
-                            sigma_t[J] += HIJ * b_p[I];
+                            add_coupling(I, J, HIJ);
                         }
                     }
                 }
@@ -260,24 +347,23 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
         }
         for (size_t K = 0, max_K = ab_list_.size(); K < max_K; ++K) {
             if ((K % num_thread) == tid) {
-                const std::vector<std::tuple<size_t, short, short>>& c_dets = ab_list_[K];
+                const auto c_dets = ab_list_[K];
                 size_t max_det = c_dets.size();
                 for (size_t det = 0; det < max_det; ++det) {
-                    auto detJ = c_dets[det];
-                    size_t J = std::get<0>(detJ);
-                    short p = std::abs(std::get<1>(detJ)) - 1;
-                    short q = std::get<2>(detJ);
-                    double sign_p = std::get<1>(detJ) > 0.0 ? 1.0 : -1.0;
+                    auto& detJ = c_dets[det];
+                    size_t J = detJ.index;
+                    short p = detJ.p();
+                    short q = detJ.q;
+                    double sign_p = detJ.sign();
                     for (size_t det2 = det + 1; det2 < max_det; ++det2) {
                         auto& detI = c_dets[det2];
-                        short r = std::abs(std::get<1>(detI)) - 1;
-                        short s = std::get<2>(detI);
+                        short r = detI.p();
+                        short s = detI.q;
                         if ((p != r) and (q != s)) {
-                            size_t I = std::get<0>(detI);
-                            double sign_q = std::get<1>(detI) > 0.0 ? 1.0 : -1.0;
+                            size_t I = detI.index;
+                            double sign_q = detI.sign();
                             double HIJ = sign_p * sign_q * fci_ints_->tei_ab(p, q, r, s);
-                            sigma_t[I] += HIJ * b_p[J];
-                            sigma_t[J] += HIJ * b_p[I];
+                            add_coupling(I, J, HIJ);
                         }
                     }
                 }
@@ -286,7 +372,7 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
 
         //        #pragma omp critical
         //        {
-        for (size_t I = 0; I < size_; ++I) {
+        for (size_t I = 0, max_I = size_ * nvec; I < max_I; ++I) {
 #pragma omp atomic update
             sigma_p[I] += sigma_t[I];
         }
@@ -295,7 +381,7 @@ void SigmaVectorSparseList::compute_sigma(psi::SharedVector sigma, psi::SharedVe
 }
 
 double SigmaVectorSparseList::compute_spin(const std::vector<double>& c) {
-    auto ab_list_ = op_->ab_list_;
+    const auto& ab_list_ = op_->ab_list_;
 
     double S2 = 0.0;
     const det_hashvec& wfn_map = space_.wfn_hash();
@@ -317,21 +403,21 @@ double SigmaVectorSparseList::compute_spin(const std::vector<double>& c) {
     // |PhiI> = a+(qa) a+(pb) a-(qb) a-(pa) |PhiJ>
 
     for (size_t K = 0, max_K = ab_list_.size(); K < max_K; ++K) {
-        const std::vector<std::tuple<size_t, short, short>>& c_dets = ab_list_[K];
+        const auto c_dets = ab_list_[K];
         for (auto& detI : c_dets) {
-            const size_t I = std::get<0>(detI);
-            double sign_pq = std::get<1>(detI) > 0.0 ? 1.0 : -1.0;
-            short p = std::fabs(std::get<1>(detI)) - 1;
-            short q = std::get<2>(detI);
+            const size_t I = detI.index;
+            double sign_pq = detI.sign();
+            short p = detI.p();
+            short q = detI.q;
             if (p == q)
                 continue;
             for (auto& detJ : c_dets) {
-                const size_t J = std::get<0>(detJ);
+                const size_t J = detJ.index;
                 if (I == J)
                     continue;
-                double sign_rs = std::get<1>(detJ) > 0.0 ? 1.0 : -1.0;
-                short r = std::fabs(std::get<1>(detJ)) - 1;
-                short s = std::get<2>(detJ);
+                double sign_rs = detJ.sign();
+                short r = detJ.p();
+                short s = detJ.q;
                 if ((r != s) and (p == s) and (q == r)) {
                     sign_pq *= sign_rs;
                     S2 -= sign_pq * c[I] * c[J];
@@ -37,16 +37,27 @@ class Vector;
 
 namespace forte {
 
+class IncrementalHamiltonian;
+
 /**
  * @brief The SigmaVectorSparseList class
  * Computes the sigma vector from a creation list sparse Hamiltonian.
+ *
+ * When the couplings of the space fit in max_memory, they are evaluated once in the constructor
+ * and stored in compressed sparse row format (see IncrementalHamiltonian), and the sigma vector
+ * is computed as a threaded sparse matrix-vector product instead of re-evaluating the couplings
+ * at every call.
  */
 class SigmaVectorSparseList : public SigmaVector {
   public:
+    /// @param max_memory the maximum number of doubles used to store the couplings
+    ///        (0 = always compute the couplings from the substitution lists)
     SigmaVectorSparseList(const DeterminantHashVec& space,
-                          std::shared_ptr<ActiveSpaceIntegrals> fci_ints);
+                          std::shared_ptr<ActiveSpaceIntegrals> fci_ints, size_t max_memory = 0);
 
     void compute_sigma(std::shared_ptr<psi::Vector> sigma, std::shared_ptr<psi::Vector> b) override;
+    void compute_sigma_block(const std::vector<std::shared_ptr<psi::Vector>>& sigma,
+                             const std::vector<std::shared_ptr<psi::Vector>>& b) override;
     void get_diagonal(psi::Vector& diag) override;
     void add_bad_roots(std::vector<std::vector<std::pair<size_t, double>>>& bad_states_) override;
     double compute_spin(const std::vector<double>& c) override;
@@ -54,10 +65,23 @@ class SigmaVectorSparseList : public SigmaVector {
     std::vector<std::vector<std::pair<size_t, double>>> bad_states_;
 
   protected:
+    /// Constructor used by derived classes that reuse the substitution lists
+    SigmaVectorSparseList(const DeterminantHashVec& space,
+                          std::shared_ptr<ActiveSpaceIntegrals> fci_ints,
+                          SigmaVectorType sigma_vector_type, std::string label);
+
     bool print_;
     bool use_disk_ = false;
     /// Substitutions lists
     std::shared_ptr<DeterminantSubstitutionLists> op_;
+    /// The stored couplings (nullptr if they are computed at every call)
+    std::shared_ptr<IncrementalHamiltonian> stored_hamiltonian_;
+
+    /// Project the bad states out of b
+    void project_bad_states(double* b_p);
+    /// Add H b to sigma for nvec vectors stored interleaved (element I of vector n is stored at
+    /// I * nvec + n)
+    virtual void compute_sigma_kernel(size_t nvec, const double* b_p, double* sigma_p);
 };
 
 } // namespace forte
@@ -0,0 +1,187 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "psi4/psi4-dec.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+
+#include "helpers/compressed_diis.h"
+#include "helpers/timer.h"
+#include "sparse_ci/sparse_cc_solver.h"
+
+using namespace psi;
+
+namespace forte {
+
+SparseCCSolver::SparseCCSolver(std::shared_ptr<ActiveSpaceIntegrals> as_ints,
+                               const std::string& cc_type, const SparseOperator& op,
+                               const std::vector<double>& denominators, const StateVector& ref)
+    : cc_type_(cc_type), op_(op), denominators_(denominators), ref_(ref), ham_(as_ints) {
+    if (cc_type_ == "cc" or cc_type_ == "ucc") {
+        factorized_ = false;
+    } else if (cc_type_ == "dcc" or cc_type_ == "ducc") {
+        factorized_ = true;
+    } else {
+        throw std::runtime_error("SparseCCSolver: incorrect value for cc_type (" + cc_type_ +
+                                 ")");
+    }
+    if (denominators_.size() != op_.size()) {
+        throw std::runtime_error(
+            "SparseCCSolver: the number of denominators and operators do not match");
+    }
+    t_ = op_.coefficients();
+}
+
+double SparseCCSolver::compute_energy() {
+    local_timer t_total;
+    const size_t nops = op_.size();
+
+    std::unique_ptr<CompressedDIIS> diis;
+    if (diis_start_ >= 0 and nops > 0) {
+        size_t max_vec = std::max(diis_max_vec_, static_cast<size_t>(std::max(diis_start_, 1)));
+        diis = std::make_unique<CompressedDIIS>(
+            "SparseCCSolver", max_vec, std::vector<size_t>{nops},
+            CompressedDIIS::Precision::Double, CompressedDIIS::RemovalPolicy::OldestAdded, false);
+    }
+
+    std::vector<double> t_old(nops);
+    std::vector<double> dt(nops);
+    double old_energy = 0.0;
+
+    for (iterations_ = 1; iterations_ <= maxiter_; ++iterations_) {
+        local_timer t_iter;
+        t_old = t_;
+
+        compute_residual();
+
+        // Jacobi update of the amplitudes
+        double norm2 = 0.0;
+        for (size_t l = 0; l < nops; ++l) {
+            t_[l] -= residual_[l] / denominators_[l];
+            norm2 += residual_[l] * residual_[l];
+        }
+        residual_norm_ = std::sqrt(norm2);
+
+        if (diis) {
+            for (size_t l = 0; l < nops; ++l) {
+                dt[l] = t_[l] - t_old[l];
+            }
+            diis->add_entry({dt.data()}, {t_.data()});
+            const size_t ndiis = diis->subspace_size();
+            if (ndiis >= static_cast<size_t>(diis_start_) and ndiis < nops) {
+                diis->extrapolate({t_.data()});
+            }
+        }
+
+        const double delta_energy = energy_ - old_energy;
+        outfile->Printf("\n    %4d %20.12f   %+6e   %+6e   %8.3f", iterations_ - 1, energy_,
+                        delta_energy, residual_norm_, t_iter.get());
+
+        if (iterations_ > 3 and std::fabs(delta_energy) < e_convergence_ and
+            residual_norm_ < r_convergence_) {
+            break;
+        }
+        old_energy = energy_;
+    }
+    iterations_ = std::min(iterations_, maxiter_);
+
+    timings_["total"] += t_total.get();
+    return energy_;
+}
+
+StateVector SparseCCSolver::apply_exp(const StateVector& state, bool inverse) {
+    const std::string algorithm = on_the_fly_ ? "onthefly" : "cached";
+    if (factorized_) {
+        return fact_exp_.compute(op_, state, algorithm, inverse, compute_threshold_);
+    }
+    return exp_.compute(op_, state, algorithm, inverse ? -1.0 : 1.0, maxk_, compute_threshold_);
+}
+
+void SparseCCSolver::compute_residual() {
+    local_timer t;
+    op_.set_coefficients(t_);
+
+    wfn_ = apply_exp(ref_, false);
+    Hwfn_ = on_the_fly_ ? ham_.compute_on_the_fly(wfn_, compute_threshold_)
+                        : ham_.compute(wfn_, compute_threshold_);
+
+    auto lookup = [](const StateVector& state, const Determinant& d) {
+        auto it = state.find(d);
+        return it == state.end() ? 0.0 : it->second;
+    };
+
+    // compute <ref|Psi> and the projective energy <ref|H U|ref> / <ref|U|ref>
+    double c0 = 0.0;
+    double ref_H_psi = 0.0;
+    for (const auto& [d, c] : ref_) {
+        c0 += c * lookup(wfn_, d);
+        ref_H_psi += c * lookup(Hwfn_, d);
+    }
+    proj_energy_ = ref_H_psi / c0;
+
+    if (linked_) {
+        // compute R = U^-1 H U|ref>, Eavg = <ref|R>, and the residual <exc|R>
+        auto R = apply_exp(Hwfn_, true);
+        energy_ = 0.0;
+        for (const auto& [d, c] : ref_) {
+            energy_ += c * lookup(R, d);
+        }
+        residual_ = get_projection(op_, ref_, R);
+    } else {
+        // compute the energy as the expectation value <Psi|H|Psi> / <Psi|Psi> and the residual
+        // <exc|H U|ref> - E_proj <exc|U|ref>
+        double norm2 = 0.0;
+        energy_ = 0.0;
+        for (const auto& [d, c] : wfn_) {
+            norm2 += c * c;
+            energy_ += c * lookup(Hwfn_, d);
+        }
+        energy_ /= norm2;
+        for (const auto& [d, c] : wfn_) {
+            Hwfn_[d] -= c * proj_energy_;
+        }
+        residual_ = get_projection(op_, ref_, Hwfn_);
+    }
+    timings_["residual"] += t.get();
+}
+
+std::map<std::string, double> SparseCCSolver::timings() const {
+    auto result = timings_;
+    for (const auto& [label, time] : factorized_ ? fact_exp_.timings() : exp_.timings()) {
+        result["exp/" + label] = time;
+    }
+    for (const auto& [label, time] : ham_.timings()) {
+        result["ham/" + label] = time;
+    }
+    return result;
+}
+
+} // namespace forte
@@ -0,0 +1,161 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Forte: an open-source plugin to Psi4 (https://github.com/psi4/psi4)
+ * that implements a variety of quantum chemistry methods for strongly
+ * correlated electrons.
+ *
+ * Copyright (c) 2012-2021 by its authors (see COPYING, COPYING.LESSER, AUTHORS).
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _sparse_cc_solver_h_
+#define _sparse_cc_solver_h_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sparse_ci/sparse_exp.h"
+#include "sparse_ci/sparse_fact_exp.h"
+#include "sparse_ci/sparse_hamiltonian.h"
+#include "sparse_ci/sparse_operator.h"
+#include "sparse_ci/sparse_state_vector.h"
+
+namespace forte {
+
+class ActiveSpaceIntegrals;
+
+/**
+ * @brief The SparseCCSolver class
+ * This class solves the sparse coupled cluster equations for a given operator pool
+ *
+ *    <exc| U^-1 H U |ref> = 0
+ *
+ * where U = exp(T) (cc), exp(T - T^+) (ucc), or the factorized forms ... exp(t2 op2) exp(t1 op1)
+ * (dcc) and ... exp(t2 (op2 - op2^+)) exp(t1 (op1 - op1^+)) (ducc).
+ *
+ * The amplitudes are updated with a Jacobi step using the Moller-Plesset denominators and
+ * extrapolated with DIIS. The exponential and Hamiltonian objects are kept for the lifetime
+ * of the solver, so the couplings cached in the first iteration are reused in all the others.
+ */
+class SparseCCSolver {
+  public:
+    /// Constructor
+    /// @param as_ints the molecular integrals
+    /// @param cc_type the type of CC computation (cc/ucc/dcc/ducc)
+    /// @param op the operator pool. The coefficients of op are the initial amplitudes
+    /// @param denominators the Moller-Plesset denominators of each operator in op
+    /// @param ref the reference state
+    SparseCCSolver(std::shared_ptr<ActiveSpaceIntegrals> as_ints, const std::string& cc_type,
+                   const SparseOperator& op, const std::vector<double>& denominators,
+                   const StateVector& ref);
+
+    /// Solve the CC equations and return the energy
+    double compute_energy();
+
+    /// Set the threshold used to screen the exponential and the Hamiltonian
+    void set_compute_threshold(double value) { compute_threshold_ = value; }
+    /// Set the energy convergence criterion
+    void set_e_convergence(double value) { e_convergence_ = value; }
+    /// Set the residual convergence criterion
+    void set_r_convergence(double value) { r_convergence_ = value; }
+    /// Use the on-the-fly algorithms instead of the cached ones?
+    void set_on_the_fly(bool value) { on_the_fly_ = value; }
+    /// Use the linked formulation of the CC equations (a commutator series)?
+    void set_linked(bool value) { linked_ = value; }
+    /// Set the maximum order of the Taylor expansion of the exponential (cc/ucc)
+    void set_maxk(int value) { maxk_ = value; }
+    /// Set the number of DIIS vectors required to start the extrapolation (-1 = no DIIS)
+    void set_diis_start(int value) { diis_start_ = value; }
+    /// Set the maximum number of DIIS vectors
+    void set_diis_max_vec(size_t value) { diis_max_vec_ = value; }
+    /// Set the maximum number of iterations
+    void set_maxiter(int value) { maxiter_ = value; }
+
+    /// Set the amplitudes
+    void set_amplitudes(const std::vector<double>& t) { t_ = t; }
+    /// @return the amplitudes
+    const std::vector<double>& amplitudes() const { return t_; }
+    /// @return the average energy <ref|U^-1 H U|ref>
+    double energy() const { return energy_; }
+    /// @return the projective energy <ref|H U|ref> / <ref|U|ref>
+    double proj_energy() const { return proj_energy_; }
+    /// @return the norm of the residual at the last iteration
+    double residual_norm() const { return residual_norm_; }
+    /// @return the number of iterations of the last call to compute_energy()
+    int iterations() const { return iterations_; }
+    /// @return timings for this class and for the exponential and Hamiltonian objects
+    std::map<std::string, double> timings() const;
+
+  private:
+    /// Compute the residual, the energy, and the projective energy for the current amplitudes
+    void compute_residual();
+    /// Compute U|state> (inverse = false) or U^-1|state> (inverse = true)
+    StateVector apply_exp(const StateVector& state, bool inverse);
+
+    /// The type of CC computation
+    std::string cc_type_;
+    /// Is this a factorized (dcc/ducc) computation?
+    bool factorized_;
+    /// The operator pool
+    SparseOperator op_;
+    /// The Moller-Plesset denominators
+    std::vector<double> denominators_;
+    /// The reference state
+    StateVector ref_;
+    /// The Hamiltonian
+    SparseHamiltonian ham_;
+    /// The exponential (cc/ucc)
+    SparseExp exp_;
+    /// The factorized exponential (dcc/ducc)
+    SparseFactExp fact_exp_;
+
+    /// The amplitudes
+    std::vector<double> t_;
+    /// The residual
+    std::vector<double> residual_;
+    /// U|ref>
+    StateVector wfn_;
+    /// H U|ref>
+    StateVector Hwfn_;
+
+    double compute_threshold_ = 1.0e-12;
+    double e_convergence_ = 1.0e-10;
+    double r_convergence_ = 1.0e-5;
+    bool on_the_fly_ = false;
+    bool linked_ = true;
+    int maxk_ = 19;
+    int diis_start_ = 3;
+    size_t diis_max_vec_ = 8;
+    int maxiter_ = 200;
+
+    double energy_ = 0.0;
+    double proj_energy_ = 0.0;
+    double residual_norm_ = 0.0;
+    int iterations_ = 0;
+    /// Timings of the solver
+    std::map<std::string, double> timings_;
+};
+
+} // namespace forte
+
+#endif // _sparse_cc_solver_h_
@@ -32,11 +32,14 @@
 
 #include "psi4/psi4-dec.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libqt/qt.h"
 
 #include "forte-def.h"
 #include "helpers/iterative_solvers.h"
+#include "helpers/lobpcg_solver.h"
 #include "helpers/timer.h"
 #include "sparse_ci_solver.h"
+#include "sigma_vector_csf.h"
 #include "sigma_vector_dynamic.h"
 #include "determinant_functions.hpp"
 
@@ -52,6 +55,71 @@ namespace forte {
 #define omp_get_num_threads() 1
 #endif
 
+namespace {
+/**
+ * @brief Compute selected eigenpairs of a symmetric matrix with LAPACK dsyevr
+ * @param A the matrix (overwritten)
+ * @param range 'A' for all eigenpairs, 'I' for those with indices il..iu (1-based, in ascending
+ *        order), or 'V' for those with eigenvalues in the interval (vl, vu]
+ * @param evecs if not null, the eigenvectors are stored here, one per row
+ * @return the eigenvalues in ascending order
+ */
+std::vector<double> symmetric_eigensolver(psi::Matrix& A, char range, double vl, double vu,
+                                          int il, int iu, std::vector<double>* evecs) {
+    const int n = A.rowdim();
+    if (n == 0) {
+        if (evecs)
+            evecs->clear();
+        return {};
+    }
+    const char jobz = evecs ? 'V' : 'N';
+    std::vector<double> w(n);
+    std::vector<int> isuppz(2 * std::max(n, 1));
+    int m = 0;
+    double* z = nullptr;
+    if (evecs) {
+        // for range = 'V' the number of eigenvalues is not known in advance
+        evecs->assign(static_cast<size_t>(range == 'I' ? iu - il + 1 : n) * n, 0.0);
+        z = evecs->data();
+    }
+    // workspace query
+    double lwork_opt = 0.0;
+    int liwork_opt = 0;
+    C_DSYEVR(jobz, range, 'U', n, A.pointer()[0], n, vl, vu, il, iu, 0.0, &m, w.data(), z,
+             std::max(n, 1), isuppz.data(), &lwork_opt, -1, &liwork_opt, -1);
+    int lwork = static_cast<int>(lwork_opt);
+    int liwork = liwork_opt;
+    std::vector<double> work(lwork);
+    std::vector<int> iwork(liwork);
+    int info = C_DSYEVR(jobz, range, 'U', n, A.pointer()[0], n, vl, vu, il, iu, 0.0, &m, w.data(),
+                        z, std::max(n, 1), isuppz.data(), work.data(), lwork, iwork.data(), liwork);
+    if (info != 0) {
+        throw std::runtime_error("SparseCISolver: dsyevr failed with info = " +
+                                 std::to_string(info));
+    }
+    w.resize(m);
+    if (evecs) {
+        evecs->resize(static_cast<size_t>(m) * n);
+    }
+    return w;
+}
+
+/// Build the matrix of S^2 in a space of determinants
+psi::SharedMatrix build_full_spin2(const std::vector<Determinant>& space) {
+    const size_t dim_space = space.size();
+    auto S2 = std::make_shared<psi::Matrix>("S^2", dim_space, dim_space);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t I = 0; I < dim_space; ++I) {
+        for (size_t J = I; J < dim_space; ++J) {
+            double S2IJ = spin2(space[I], space[J]);
+            S2->set(I, J, S2IJ);
+            S2->set(J, I, S2IJ);
+        }
+    }
+    return S2;
+}
+} // namespace
+
 SparseCISolver::SparseCISolver() {}
 
 void SparseCISolver::set_spin_project(bool value) { spin_project_ = value; }
@@ -109,8 +177,23 @@ SparseCISolver::diagonalize_hamiltonian(const DeterminantHashVec& space,
     auto evecs = std::make_shared<psi::Matrix>("U", dim_space, nroot);
     auto evals = std::make_shared<psi::Vector>("e", nroot);
 
+    if (spin_adapt_) {
+        auto csf_sigma_vector = std::make_shared<SigmaVectorCSF>(space, sigma_vector, multiplicity);
+        if (print_details_) {
+            outfile->Printf("\n  Spin-adapted basis: %zu CSFs (2S+1 = %d) from %zu configurations"
+                            " and %zu determinants",
+                            csf_sigma_vector->ncsf(), multiplicity, csf_sigma_vector->nconfs(),
+                            dim_space);
+        }
+        sigma_vector = csf_sigma_vector;
+    }
+
     sigma_vector->add_bad_roots(bad_states_);
-    davidson_liu_solver(space, sigma_vector, evals, evecs, nroot, multiplicity);
+    if (eigensolver_ == "LOBPCG") {
+        lobpcg_solver(space, sigma_vector, evals, evecs, nroot, multiplicity);
+    } else {
+        davidson_liu_solver(space, sigma_vector, evals, evecs, nroot, multiplicity);
+    }
 
     return std::make_pair(evals, evecs);
 }
@@ -136,29 +219,20 @@ SparseCISolver::diagonalize_hamiltonian_full(const std::vector<Determinant>& spa
     auto H = build_full_hamiltonian(space, as_ints);
 
     // Build the S^2 matrix
-    auto S2 = std::make_shared<psi::Matrix>("S^2", dim_space, dim_space);
-    for (size_t I = 0; I < dim_space; ++I) {
-        for (size_t J = 0; J < dim_space; ++J) {
-            double S2IJ = spin2(space[I], space[J]);
-            S2->set(I, J, S2IJ);
-        }
-    }
+    auto S2 = build_full_spin2(space);
 
     const double target_S = 0.5 * (static_cast<double>(multiplicity) - 1.0);
-    const double target_multiplicity = static_cast<double>(multiplicity);
 
     // First, we check if this space is spin complete by looking at how much the
-    // eigenvalue of S^2 deviate from their exact values
-    auto S2vals = std::make_shared<psi::Vector>("S^2 Eigen Values", dim_space);
-    auto S2vecs = std::make_shared<psi::Matrix>("S^2 Eigen Vectors", dim_space, dim_space);
-
-    S2->diagonalize(S2vecs, S2vals);
+    // eigenvalue of S^2 deviate from their exact values. Only the eigenvalues are needed here
+    psi::Matrix S2_copy(*S2);
+    const auto S2vals = symmetric_eigensolver(S2_copy, 'A', 0.0, 0.0, 0, 0, nullptr);
 
     bool spin_complete = true;
     double Stollerance = 1.0e-4;
     std::map<int, std::vector<int>> multi_list;
     for (size_t i = 0; i < dim_space; ++i) {
-        double multi = std::sqrt(1.0 + 4.0 * S2vals->get(i));
+        double multi = std::sqrt(1.0 + 4.0 * S2vals[i]);
         double error = std::round(multi) - multi;
         if (std::fabs(error) < Stollerance) {
             int multi_round = std::llround(multi);
@@ -197,60 +271,97 @@ SparseCISolver::diagonalize_hamiltonian_full(const std::vector<Determinant>& spa
                 "Too many roots of interest in full diag. of sparce_ci_solver.");
         }
 
-        // Select sub eigen vectors of S^2 with correct multiplicity
-        psi::SharedMatrix S2vecs_sub(
-            new psi::Matrix("Spin Selected S^2 Eigen Vectors", dim_space, nfound));
-        for (int i = 0; i < nfound; ++i) {
-            auto vec = S2vecs->get_column(0, multi_list[multiplicity][i]);
-            S2vecs_sub->set_column(0, i, vec);
+        // Select the eigenvectors of S^2 with the correct multiplicity, which are the only ones
+        // with eigenvalues in a window around S(S + 1) (the spacing of S(S + 1) is >= 0.75)
+        const double target_S2 = target_S * (target_S + 1.0);
+        std::vector<double> S2vecs;
+        psi::Matrix S2_target(*S2);
+        const int nS2vecs =
+            symmetric_eigensolver(S2_target, 'V', target_S2 - 0.3, target_S2 + 0.3, 0, 0, &S2vecs)
+                .size();
+        if (nS2vecs != nfound) {
+            throw std::runtime_error("Inconsistent number of S^2 eigenvectors in full diag. of "
+                                     "sparce_ci_solver.");
         }
+        // S2vecs is stored as (nfound x dim_space), so this is the matrix (S2vecs_sub)^T
+        auto S2vecs_sub_t = std::make_shared<psi::Matrix>("Spin Selected S^2 Eigen Vectors",
+                                                          nfound, dim_space);
+        std::copy(S2vecs.begin(), S2vecs.end(), S2vecs_sub_t->pointer()[0]);
 
         // Build spin selected Hamiltonian
-        psi::SharedMatrix H = build_full_hamiltonian(space, as_ints);
-        psi::SharedMatrix Hss = psi::linalg::triplet(S2vecs_sub, H, S2vecs_sub, true, false, false);
+        psi::SharedMatrix Hss =
+            psi::linalg::triplet(S2vecs_sub_t, H, S2vecs_sub_t, false, false, true);
         Hss->set_name("Hss");
 
-        // Obtain spin selected eigen values and vectors
-        psi::SharedVector Hss_vals(new Vector("Hss Eigen Values", nfound));
-        psi::SharedMatrix Hss_vecs(new psi::Matrix("Hss Eigen Vectors", nfound, nfound));
-        Hss->diagonalize(Hss_vecs, Hss_vals);
-
-        // Project Hss_vecs back to original manifold
-        psi::SharedMatrix H_vecs = psi::linalg::doublet(S2vecs_sub, Hss_vecs);
-        H_vecs->set_name("H Eigen Vectors");
+        // Obtain the lowest nroot spin selected eigen values and vectors
+        std::vector<double> Hss_vecs;
+        const auto Hss_vals = symmetric_eigensolver(*Hss, 'I', 0.0, 0.0, 1, nroot, &Hss_vecs);
 
-        // Fill in results
+        // Project Hss_vecs back to original manifold and fill in results
         energies_.clear();
         spin_.clear();
         for (int i = 0; i < nroot; ++i) {
-            evals->set(i, Hss_vals->get(i));
-            evecs->set_column(0, i, H_vecs->get_column(0, i));
-            spin_.push_back(target_S * (target_S + 1.0));
-            energies_.push_back(Hss_vals->get(i));
+            evals->set(i, Hss_vals[i]);
+            for (size_t I = 0; I < dim_space; ++I) {
+                double C = 0.0;
+                for (int k = 0; k < nfound; ++k) {
+                    C += S2vecs[k * dim_space + I] * Hss_vecs[i * nfound + k];
+                }
+                evecs->set(I, i, C);
+            }
+            spin_.push_back(target_S2);
+            energies_.push_back(Hss_vals[i]);
         }
     } else {
+        // Compute the lowest eigenpairs of H, doubling their number until at least nroot
+        // solutions with the target multiplicity are found
+        const int dim = static_cast<int>(dim_space);
+        int nlowest = std::min(dim, std::max(4 * nroot, 20));
+        std::vector<double> full_evals;
+        std::vector<double> full_evecs;
+        std::vector<double> S2_expect;
+        while (true) {
+            psi::Matrix H_copy(*H);
+            full_evals = symmetric_eigensolver(H_copy, 'I', 0.0, 0.0, 1, nlowest, &full_evecs);
+
+            // Compute <C|S^2|C> for each solution
+            S2_expect.assign(nlowest, 0.0);
+            double** S2p = S2->pointer();
+#pragma omp parallel for
+            for (int r = 0; r < nlowest; ++r) {
+                const double* c = &full_evecs[static_cast<size_t>(r) * dim_space];
+                double value = 0.0;
+                for (size_t I = 0; I < dim_space; ++I) {
+                    value += c[I] * C_DDOT(dim_space, S2p[I], 1, const_cast<double*>(c), 1);
+                }
+                S2_expect[r] = value;
+            }
 
-        auto full_evecs = std::make_shared<psi::Matrix>("U", dim_space, dim_space);
-        auto full_evals = std::make_shared<psi::Vector>("e", dim_space);
-
-        // Diagonalize H
-        H->diagonalize(full_evecs, full_evals);
-
-        // Compute (C)^+ S^2 C
-        psi::SharedMatrix CtSC =
-            psi::linalg::triplet(full_evecs, S2, full_evecs, true, false, false);
+            int ntarget = 0;
+            for (int r = 0; r < nlowest; ++r) {
+                double S = 0.5 * (std::sqrt(1.0 + 4.0 * std::max(S2_expect[r], 0.0)) - 1.0);
+                if (std::lround(2.0 * S) == multiplicity - 1)
+                    ntarget++;
+            }
+            if (ntarget >= nroot or nlowest == dim)
+                break;
+            nlowest = std::min(dim, 2 * nlowest);
+        }
 
         // Find how each solution deviates from the target multiplicity
-        std::vector<std::tuple<double, double, size_t, double>> sorted_evals(dim_space);
+        std::vector<std::tuple<double, double, size_t, double>> sorted_evals(nlowest);
         std::map<int, std::vector<std::pair<double, size_t>>> S_vals_sorted;
 
         outfile->Printf("\n  Seeking %d roots with <S^2> = %f", nroot, target_S * (target_S + 1.0));
+        if (nlowest < dim) {
+            outfile->Printf("\n  Computed the lowest %d of %d solutions", nlowest, dim);
+        }
 
         outfile->Printf("\n     Root           Energy         <S^2>");
         outfile->Printf("\n    -------------------------------------");
-        for (size_t I = 0; I < dim_space; ++I) {
-            double avg_S2 = CtSC->get(I, I);
-            double energy = full_evals->get(I);
+        for (int I = 0; I < nlowest; ++I) {
+            double avg_S2 = S2_expect[I];
+            double energy = full_evals[I];
             double S = 0.5 * (std::sqrt(1.0 + 4.0 * avg_S2) - 1.0);
             double error = std::fabs(S - target_S);
             double S_rounded = 0.5 * std::lround(2.0 * S);
@@ -301,7 +412,7 @@ SparseCISolver::diagonalize_hamiltonian_full(const std::vector<Determinant>& spa
             evals->set(i, energy);
             spin_.push_back(S * (S + 1.0));
             for (size_t J = 0; J < dim_space; ++J) {
-                double C = full_evecs->get(J, I);
+                double C = full_evecs[I * dim_space + J];
                 evecs->set(J, i, C);
             }
         }
@@ -404,6 +515,7 @@ SparseCISolver::initial_guess(const DeterminantHashVec& space,
 
     // Form the S^2 operator matrix and diagonalize it
     Matrix S2("S^2", nguess, nguess);
+#pragma omp parallel for schedule(dynamic)
     for (size_t I = 0; I < nguess; I++) {
         for (size_t J = I; J < nguess; J++) {
             const Determinant& detI = guess_dets_pos[I].first;
@@ -417,8 +529,10 @@ SparseCISolver::initial_guess(const DeterminantHashVec& space,
     Vector S2evals("S^2", nguess);
     S2.diagonalize(S2evecs, S2evals);
 
-    // Form the Hamiltonian
+    // Form the Hamiltonian (with a single thread when running DiskDF)
     Matrix H("H", nguess, nguess);
+    const int threads = as_ints->get_integral_type() == DiskDF ? 1 : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
     for (size_t I = 0; I < nguess; I++) {
         for (size_t J = I; J < nguess; J++) {
             const Determinant& detI = guess_dets_pos[I].first;
@@ -514,14 +628,34 @@ bool SparseCISolver::davidson_liu_solver(const DeterminantHashVec& space,
     dls.set_e_convergence(e_convergence_);
     dls.set_r_convergence(r_convergence_);
     dls.set_print_level(0);
+    dls.set_out_of_core(dl_out_of_core_);
 
     // allocate vectors
     psi::SharedVector b(new Vector("b", fci_size));
     psi::SharedVector sigma(new Vector("sigma", fci_size));
 
+    // the guesses are given in the determinant basis and transformed to the CSF basis when the
+    // Davidson-Liu algorithm is spin adapted
+    auto csf_sigma_vector = std::dynamic_pointer_cast<SigmaVectorCSF>(sigma_vector);
+    psi::SharedVector b_det =
+        csf_sigma_vector ? std::make_shared<psi::Vector>("b", space.size()) : b;
+    auto set_guess_vector = [&](const std::vector<std::pair<size_t, double>>& det_C) {
+        b_det->zero();
+        for (const auto& [I, C] : det_C) {
+            b_det->set(I, C);
+        }
+        if (csf_sigma_vector) {
+            csf_sigma_vector->det_to_csf(*b_det, *b);
+            double norm = b->norm();
+            if (norm > 0.0)
+                b->scale(1.0 / norm);
+        }
+    };
+
     // get and pass diagonal
     sigma_vector->get_diagonal(*sigma);
     dls.startup(sigma);
+    dls.set_preconditioner(sigma_vector->preconditioner(dl_preconditioner_block_size_));
 
     std::vector<std::vector<std::pair<size_t, double>>> bad_roots;
     size_t guess_size = std::min(nvec_, dls.collapse_size());
@@ -533,15 +667,27 @@ bool SparseCISolver::davidson_liu_solver(const DeterminantHashVec& space,
 
     outfile->Printf("\n\n  Setting initial guess and roots to project");
 
-    if (set_guess_) {
+    // restart from the subspace saved by a previous computation
+    size_t nrestart = dl_checkpoint_file_.empty() ? 0 : dls.load_subspace(dl_checkpoint_file_);
+
+    if (nrestart > 0) {
+        if (print_details_)
+            outfile->Printf("\n  Restarting from %zu vectors read from %s", nrestart,
+                            dl_checkpoint_file_.c_str());
+        // the energy of the guesses is still used to select the solutions to project out
+        size_t nguess = 0;
+        for (const auto& g : guess) {
+            if ((std::get<0>(g) == multiplicity) and (nguess < guess_size)) {
+                guess_max_energy = std::max(guess_max_energy, std::get<1>(g));
+                nguess++;
+            }
+        }
+    } else if (set_guess_) {
         // Use previous solution as guess
         if (print_details_)
             outfile->Printf("\n  Adding %zu guess vectors by user", guess_.size());
         for (const auto& guess_root : guess_) {
-            b->zero();
-            for (size_t I = 0, max_I = guess_root.size(); I < max_I; ++I) {
-                b->set(guess_root[I].first, guess_root[I].second);
-            }
+            set_guess_vector(guess_root);
             double norm = sqrt(1.0 / b->norm());
             b->scale(norm);
             dls.add_guess(b);
@@ -563,10 +709,7 @@ bool SparseCISolver::davidson_liu_solver(const DeterminantHashVec& space,
         }
 
         for (size_t n = 0; n < nguess; ++n) {
-            b->zero();
-            for (auto& guess_vec_info : std::get<2>(guess[guess_list[n]])) {
-                b->set(guess_vec_info.first, guess_vec_info.second);
-            }
+            set_guess_vector(std::get<2>(guess[guess_list[n]]));
             int guess_multiplicity = std::get<0>(guess[guess_list[n]]);
             double guess_energy = std::get<1>(guess[guess_list[n]]);
 
@@ -578,7 +721,9 @@ bool SparseCISolver::davidson_liu_solver(const DeterminantHashVec& space,
         }
     }
 
-    if (spin_project_) {
+    if (csf_sigma_vector) {
+        outfile->Printf("\n\n  Projecting out no solutions (spin-adapted basis)");
+    } else if (spin_project_) {
         // Prepare a list of bad roots to project out and pass them to the solver
         bad_roots.clear();
         size_t rejected = 0;
@@ -617,17 +762,33 @@ bool SparseCISolver::davidson_liu_solver(const DeterminantHashVec& space,
     double old_avg_energy = 0.0;
     int real_cycle = 1;
 
+    // the sigma vectors of all the basis vectors added in one update (up to the number of
+    // collapse vectors) are computed in one block
+    const size_t max_block_size = std::max(size_t(1), dls.collapse_size());
+    std::vector<psi::SharedVector> b_block{b};
+    std::vector<psi::SharedVector> sigma_block{sigma};
+
     for (int cycle = 0; cycle < maxiter_davidson_; ++cycle) {
         bool add_sigma = true;
         do {
-            dls.get_b(b);
-            sigma_vector->compute_sigma(sigma, b);
-
-            add_sigma = dls.add_sigma(sigma);
+            const size_t block_size = std::min(max_block_size, dls.num_pending_sigma());
+            while (b_block.size() < block_size) {
+                b_block.push_back(std::make_shared<psi::Vector>("b", fci_size));
+                sigma_block.push_back(std::make_shared<psi::Vector>("sigma", fci_size));
+            }
+            b_block.resize(block_size);
+            sigma_block.resize(block_size);
+            dls.get_b_block(b_block);
+            sigma_vector->compute_sigma_block(sigma_block, b_block);
+            add_sigma = dls.add_sigma_block(sigma_block);
         } while (add_sigma);
 
         converged = dls.update();
 
+        if (not dl_checkpoint_file_.empty()) {
+            dls.save_subspace(dl_checkpoint_file_);
+        }
+
         if (converged != SolverStatus::Collapse) {
             // compute the average energy
             double avg_energy = 0.0;
@@ -670,10 +831,23 @@ bool SparseCISolver::davidson_liu_solver(const DeterminantHashVec& space,
     spin_.clear();
     psi::SharedVector evals = dls.eigenvalues();
     psi::SharedMatrix evecs = dls.eigenvectors();
+    psi::Vector c_csf("c", fci_size);
+    psi::Vector c_det("c", space.size());
     for (int r = 0; r < nroot; ++r) {
         Eigenvalues->set(r, evals->get(r));
-        for (size_t I = 0; I < fci_size; ++I) {
-            Eigenvectors->set(I, r, evecs->get(r, I));
+        if (csf_sigma_vector) {
+            // transform the solutions back to the determinant basis
+            for (size_t I = 0; I < fci_size; ++I) {
+                c_csf.set(I, evecs->get(r, I));
+            }
+            csf_sigma_vector->csf_to_det(c_csf, c_det);
+            for (size_t I = 0, max_I = space.size(); I < max_I; ++I) {
+                Eigenvectors->set(I, r, c_det.get(I));
+            }
+        } else {
+            for (size_t I = 0; I < fci_size; ++I) {
+                Eigenvectors->set(I, r, evecs->get(r, I));
+            }
         }
         energies_.push_back(evals->get(r));
         std::vector<double> c(sigma_vector->size());
@@ -689,4 +863,123 @@ bool SparseCISolver::davidson_liu_solver(const DeterminantHashVec& space,
 
     return true;
 }
+
+bool SparseCISolver::lobpcg_solver(const DeterminantHashVec& space,
+                                   std::shared_ptr<SigmaVector> sigma_vector,
+                                   psi::SharedVector Eigenvalues, psi::SharedMatrix Eigenvectors,
+                                   int nroot, int multiplicity) {
+    local_timer t;
+    size_t fci_size = sigma_vector->size();
+    LOBPCGSolver solver(fci_size, nroot);
+    solver.set_e_convergence(e_convergence_);
+    solver.set_r_convergence(r_convergence_);
+    solver.set_maxiter(maxiter_davidson_);
+    solver.set_print(print_details_);
+
+    // the guesses are given in the determinant basis and transformed to the CSF basis when the
+    // basis is spin adapted
+    auto csf_sigma_vector = std::dynamic_pointer_cast<SigmaVectorCSF>(sigma_vector);
+    auto b = std::make_shared<psi::Vector>("b", fci_size);
+    psi::SharedVector b_det =
+        csf_sigma_vector ? std::make_shared<psi::Vector>("b", space.size()) : b;
+    auto add_guess = [&](const std::vector<std::pair<size_t, double>>& det_C) {
+        b_det->zero();
+        for (const auto& [I, C] : det_C) {
+            b_det->set(I, C);
+        }
+        if (csf_sigma_vector) {
+            csf_sigma_vector->det_to_csf(*b_det, *b);
+        }
+        solver.add_guess(b);
+    };
+
+    auto diagonal = std::make_shared<psi::Vector>("diagonal", fci_size);
+    sigma_vector->get_diagonal(*diagonal);
+    solver.startup(diagonal);
+    solver.set_preconditioner(sigma_vector->preconditioner(dl_preconditioner_block_size_));
+
+    outfile->Printf("\n\n  Setting initial guess and roots to project");
+    auto guess = initial_guess(space, sigma_vector, nroot, multiplicity);
+    double guess_max_energy = -1.0e10;
+    if (set_guess_) {
+        if (print_details_)
+            outfile->Printf("\n  Adding %zu guess vectors by user", guess_.size());
+        for (const auto& guess_root : guess_) {
+            add_guess(guess_root);
+        }
+    } else {
+        // the initial Rayleigh-Ritz step uses up to ncollapse_per_root_ guesses per root
+        const size_t guess_size = std::min(nvec_, nroot * static_cast<size_t>(ncollapse_per_root_));
+        size_t nguess = 0;
+        for (const auto& g : guess) {
+            if ((std::get<0>(g) == multiplicity) and (nguess < guess_size)) {
+                add_guess(std::get<2>(g));
+                guess_max_energy = std::max(guess_max_energy, std::get<1>(g));
+                nguess++;
+            }
+        }
+        if (nguess == 0) {
+            throw psi::PSIEXCEPTION("\n\n  Found zero FCI guesses with the "
+                                    "requested multiplicity.\n\n");
+        }
+    }
+
+    if (spin_project_ and (not csf_sigma_vector)) {
+        // project out the guesses with different multiplicity and lower energy
+        std::vector<std::vector<std::pair<size_t, double>>> bad_roots;
+        for (const auto& g : guess) {
+            if ((std::get<0>(g) != multiplicity) and (std::get<1>(g) <= guess_max_energy)) {
+                bad_roots.push_back(std::get<2>(g));
+            }
+        }
+        outfile->Printf("\n\n  Projecting out %zu solutions", bad_roots.size());
+        solver.set_project_out(bad_roots);
+    }
+
+    if (print_details_) {
+        outfile->Printf("\n\n  ==> Diagonalizing Hamiltonian (LOBPCG) <==\n");
+        outfile->Printf("\n  Energy   convergence: %.2e", e_convergence_);
+        outfile->Printf("\n  Residual convergence: %.2e", r_convergence_);
+    }
+
+    auto status = solver.solve(
+        [&](const std::vector<psi::SharedVector>& sigma, const std::vector<psi::SharedVector>& b) {
+            sigma_vector->compute_sigma_block(sigma, b);
+        });
+    if (status != SolverStatus::Converged) {
+        throw std::runtime_error("\n  The LOBPCG algorithm did not converge! Consider increasing "
+                                 "the option DL_MAXITER.");
+    }
+
+    spin_.clear();
+    const auto& evals = solver.eigenvalues();
+    psi::SharedMatrix evecs = solver.eigenvectors();
+    psi::Vector c_csf("c", fci_size);
+    psi::Vector c_det("c", space.size());
+    for (int r = 0; r < nroot; ++r) {
+        Eigenvalues->set(r, evals[r]);
+        std::vector<double> c(fci_size);
+        for (size_t I = 0; I < fci_size; ++I) {
+            c[I] = evecs->get(r, I);
+        }
+        if (csf_sigma_vector) {
+            // transform the solutions back to the determinant basis
+            std::copy(c.begin(), c.end(), c_csf.pointer());
+            csf_sigma_vector->csf_to_det(c_csf, c_det);
+            for (size_t I = 0, max_I = space.size(); I < max_I; ++I) {
+                Eigenvectors->set(I, r, c_det.get(I));
+            }
+        } else {
+            for (size_t I = 0; I < fci_size; ++I) {
+                Eigenvectors->set(I, r, c[I]);
+            }
+        }
+        energies_.push_back(evals[r]);
+        spin_.push_back(sigma_vector->compute_spin(c));
+    }
+    if (print_details_) {
+        outfile->Printf("\n  LOBPCG procedure took  %1.6f s", t.get());
+    }
+    return true;
+}
 } // namespace forte
@@ -96,6 +96,12 @@ class SparseCISolver {
     /// Enable/disable spin projection in full algorithm
     void set_spin_project_full(bool value);
 
+    /// Run the Davidson-Liu algorithm in a basis of CSFs with the target multiplicity
+    void set_spin_adapt(bool value) { spin_adapt_ = value; }
+
+    /// Set the iterative eigensolver (DAVIDSON or LOBPCG)
+    void set_eigensolver(const std::string& value) { eigensolver_ = value; }
+
     /// Enable/disable root projection
     void set_root_project(bool value);
 
@@ -111,6 +117,15 @@ class SparseCISolver {
     void set_ncollapse_per_root(int value);
     void set_nsubspace_per_root(int value);
 
+    /// Store the Davidson-Liu subspace vectors in scratch files
+    void set_dl_out_of_core(bool value) { dl_out_of_core_ = value; }
+
+    /// Set the size of the block of determinants treated exactly by the preconditioner
+    void set_dl_preconditioner_block_size(size_t value) { dl_preconditioner_block_size_ = value; }
+
+    /// Set the file used to save the Davidson-Liu subspace and restart from it (empty = none)
+    void set_dl_checkpoint_file(const std::string& value) { dl_checkpoint_file_ = value; }
+
     /// Build the full Hamiltonian matrix
     std::shared_ptr<psi::Matrix>
     build_full_hamiltonian(const std::vector<Determinant>& space,
@@ -141,6 +156,10 @@ class SparseCISolver {
                              std::shared_ptr<psi::Matrix> Eigenvectors, int nroot,
                              int multiplicity);
 
+    bool lobpcg_solver(const DeterminantHashVec& space, std::shared_ptr<SigmaVector> sigma_vector,
+                       std::shared_ptr<psi::Vector> Eigenvalues,
+                       std::shared_ptr<psi::Matrix> Eigenvectors, int nroot, int multiplicity);
+
     /// The energy of each state
     std::vector<double> energies_;
     /// The expectation value of S^2 for each state
@@ -153,6 +172,10 @@ class SparseCISolver {
     bool spin_project_ = false;
     /// Project solutions onto given multiplicity in full algorithm?
     bool spin_project_full_ = true;
+    /// Run the Davidson-Liu algorithm in a basis of CSFs?
+    bool spin_adapt_ = false;
+    /// The iterative eigensolver (DAVIDSON or LOBPCG)
+    std::string eigensolver_ = "DAVIDSON";
     /// Project solutions onto given root?
     bool root_project_ = false;
     /// The energy convergence threshold
@@ -165,6 +188,12 @@ class SparseCISolver {
     int nsubspace_per_root_ = 4;
     /// Maximum number of iterations in the Davidson-Liu algorithm
     int maxiter_davidson_ = 100;
+    /// Store the Davidson-Liu subspace vectors in scratch files?
+    bool dl_out_of_core_ = false;
+    /// The size of the block of determinants treated exactly by the preconditioner
+    size_t dl_preconditioner_block_size_ = 0;
+    /// The file used to save the Davidson-Liu subspace and restart from it
+    std::string dl_checkpoint_file_;
     /// Number of determinants used to form guess vector per root
     size_t dl_guess_ = 50;
     /// Options for forcing diagonalization method
@@ -29,12 +29,41 @@
 #include <algorithm>
 #include <cmath>
 
+#include "forte-def.h"
 #include "sparse_ci/sparse_exp.h"
 
 namespace forte {
 
-size_t num_attempts_ = 0;
-size_t num_success_ = 0;
+namespace {
+/// The minimum number of determinants for which we apply an operator in parallel
+constexpr size_t min_parallel_dets = 256;
+
+/// @return the number of threads used to process n determinants
+int num_threads_for(size_t n) { return n < min_parallel_dets ? 1 : omp_get_max_threads(); }
+
+/// @return a list of (|C_I|, C_I, Phi_I) sorted by decreasing |C_I|
+std::vector<std::tuple<double, double, Determinant>> sort_state(const StateVector& state0) {
+    std::vector<std::tuple<double, double, Determinant>> state_sorted(state0.size());
+    size_t k = 0;
+    for (const auto& det_c : state0) {
+        state_sorted[k] = std::make_tuple(std::fabs(det_c.second), det_c.second, det_c.first);
+        ++k;
+    }
+    std::sort(state_sorted.rbegin(), state_sorted.rend());
+    return state_sorted;
+}
+
+/// Sum the states computed by each thread into the first one
+StateVector reduce_states(std::vector<StateVector>& thread_terms) {
+    StateVector& result = thread_terms[0];
+    for (size_t t = 1; t < thread_terms.size(); t++) {
+        for (const auto& det_c : thread_terms[t]) {
+            result[det_c.first] += det_c.second;
+        }
+    }
+    return std::move(result);
+}
+} // namespace
 
 StateVector SparseExp::compute(const SparseOperator& sop, const StateVector& state0,
                                const std::string& algorithm, double scaling_factor, int maxk,
@@ -51,6 +80,7 @@ StateVector SparseExp::compute(const SparseOperator& sop, const StateVector& sta
     auto state = apply_exp_operator(sop, state0, scaling_factor, maxk, screen_thresh, alg);
 
     timings_["total"] = t.get();
+    timings_["threads"] = omp_get_max_threads();
     return state;
 }
 
@@ -85,171 +115,136 @@ StateVector SparseExp::apply_exp_operator(const SparseOperator& sop, const State
         if (inf_norm < convergence_threshold_) {
             break;
         }
-        state = new_terms;
+        state = std::move(new_terms);
     }
     return exp_state;
 }
 
+void SparseExp::add_couplings(const SparseOperator& sop,
+                              const std::vector<std::tuple<double, double, Determinant>>& state,
+                              size_t nsel, bool dexc) {
+    local_timer t_couplings;
+    auto& couplings = dexc ? couplings_dexc_ : couplings_;
+    const auto& op_list = sop.op_list();
+
+    // find the determinants that have no coupling list
+    std::vector<Determinant> new_dets;
+    for (size_t I = 0; I < nsel; I++) {
+        const Determinant& d = std::get<2>(state[I]);
+        if (couplings.find(d) == couplings.end()) {
+            new_dets.push_back(d);
+        }
+    }
+
+    // build the coupling lists in parallel
+    std::vector<std::vector<std::tuple<size_t, Determinant, double>>> new_couplings(
+        new_dets.size());
+#pragma omp parallel for schedule(dynamic, 16) num_threads(num_threads_for(new_dets.size()))
+    for (size_t I = 0; I < new_dets.size(); I++) {
+        const Determinant& d = new_dets[I];
+        Determinant d_new;
+        auto& d_couplings = new_couplings[I];
+        // loop over all the operators
+        for (size_t n = 0, maxn = op_list.size(); n < maxn; n++) {
+            const SQOperator& sqop = op_list[n];
+            // excitations: the determinant must contain the annihilated orbitals and none of the
+            // created orbitals that are not preceeded by annihilation operators.
+            // de-excitations: the role of the creation and annihilation operators is exchanged
+            const Determinant& cre = dexc ? sqop.ann() : sqop.cre();
+            const Determinant& ann = dexc ? sqop.cre() : sqop.ann();
+            const Determinant ucre = cre - ann;
+            // check if this operator can be applied
+            if (d.fast_a_and_b_equal_b(ann) and d.fast_a_and_b_eq_zero(ucre)) {
+                d_new = d;
+                double value = apply_op_safe(d_new, cre, ann);
+                d_couplings.push_back(std::make_tuple(n, d_new, value));
+            }
+        }
+    }
+
+    for (size_t I = 0; I < new_dets.size(); I++) {
+        couplings[new_dets[I]] = std::move(new_couplings[I]);
+    }
+    timings_["couplings"] += t_couplings.get();
+}
+
 StateVector SparseExp::apply_operator_cached(const SparseOperator& sop, const StateVector& state0,
                                              double screen_thresh) {
-    // make a copy of the state
-    std::vector<std::tuple<double, double, Determinant>> state_sorted(state0.size());
-    size_t k = 0;
-    for (const auto& det_c : state0) {
-        const Determinant& d = det_c.first;
-        const double c = det_c.second;
-        state_sorted[k] = std::make_tuple(std::fabs(c), c, d);
-        ++k;
-    }
-    std::sort(state_sorted.rbegin(), state_sorted.rend());
+    const auto state_sorted = sort_state(state0);
+
+    // the number of determinants with |C_I| > screen_thresh
+    const auto last = std::find_if(state_sorted.begin(), state_sorted.end(), [&](const auto& x) {
+        return std::get<0>(x) <= screen_thresh;
+    });
+    const size_t nsel = std::distance(state_sorted.begin(), last);
 
     const auto& op_list = sop.op_list();
+    const bool antihermitian = sop.is_antihermitian();
 
-    StateVector new_terms;
-    Determinant d_new;
-
-    // loop over all determinants
-    for (const auto& absc_c_det : state_sorted) {
-        const double absc = std::get<0>(absc_c_det);
-        if (absc > screen_thresh) {
-            const double c = std::get<1>(absc_c_det);
-            const Determinant& d = std::get<2>(absc_c_det);
-
-            auto search = couplings_.find(d);
-
-            if (search == couplings_.end()) {
-                local_timer t_couplings;
-                // we have to build the coupling list for this determinant
-                std::vector<std::tuple<size_t, Determinant, double>> d_couplings;
-                // loop over all the operators
-                for (size_t n = 0, maxn = op_list.size(); n < maxn; n++) {
-                    const SQOperator& sqop = op_list[n];
-                    // create a mask for screening determinants according to the creation operators
-                    // This mask looks only at creation operators that are not preceeded by
-                    // annihilation operators
-                    const Determinant ucre = sqop.cre() - sqop.ann();
-                    // check if this operator can be applied
-                    if (d.fast_a_and_b_equal_b(sqop.ann()) and d.fast_a_and_b_eq_zero(ucre)) {
-                        d_new = d;
-                        double value = apply_op_safe(d_new, sqop.cre(), sqop.ann());
-                        d_couplings.push_back(std::make_tuple(n, d_new, value));
-                    }
-                }
-                couplings_[d] = d_couplings;
-                timings_["couplings"] += t_couplings.get();
-            }
-            local_timer t_sum;
-            // apply the operator
-            const auto& d_couplings = couplings_[d];
-            for (const auto& op_d_f : d_couplings) {
+    add_couplings(sop, state_sorted, nsel, false);
+    if (antihermitian) {
+        add_couplings(sop, state_sorted, nsel, true);
+    }
+
+    local_timer t_sum;
+    const int nthreads = num_threads_for(nsel);
+    std::vector<StateVector> thread_terms(nthreads);
+
+    // each thread applies the operator to a subset of the determinants and stores the result in
+    // its own state. The coupling lists are only read here
+#pragma omp parallel num_threads(nthreads)
+    {
+        const int thread_id = omp_get_thread_num();
+        StateVector& new_terms = thread_terms[thread_id];
+        for (size_t I = thread_id; I < nsel; I += nthreads) {
+            const double c = std::get<1>(state_sorted[I]);
+            const Determinant& d = std::get<2>(state_sorted[I]);
+            for (const auto& op_d_f : couplings_.find(d)->second) {
                 const double value =
                     op_list[std::get<0>(op_d_f)].coefficient() * std::get<2>(op_d_f) * c;
                 if (std::fabs(value) > screen_thresh)
                     new_terms[std::get<1>(op_d_f)] += value;
             }
-            timings_["exp"] += t_sum.get();
-        } else {
-            break;
-        }
-    }
-
-    if (sop.is_antihermitian()) {
-        for (const auto& absc_c_det : state_sorted) {
-            const double absc = std::get<0>(absc_c_det);
-            if (absc > screen_thresh) {
-                const double c = std::get<1>(absc_c_det);
-                const Determinant& d = std::get<2>(absc_c_det);
-
-                auto search = couplings_dexc_.find(d);
-
-                if (search == couplings_dexc_.end()) {
-                    local_timer t_couplings;
-                    // we have to build the coupling list for this determinant
-                    std::vector<std::tuple<size_t, Determinant, double>> d_couplings;
-                    // loop over all the operators
-                    for (size_t n = 0, maxn = op_list.size(); n < maxn; n++) {
-                        const SQOperator& sqop = op_list[n];
-                        // create a mask for screening determinants according to the annihilation
-                        // operators. This mask looks only at annihilation operators that are not
-                        // preceeded by creation operators
-                        const Determinant ucre = sqop.ann() - sqop.cre();
-                        // check if this operator can be applied
-                        if (d.fast_a_and_b_equal_b(sqop.cre()) and d.fast_a_and_b_eq_zero(ucre)) {
-                            d_new = d;
-                            double value = apply_op_safe(d_new, sqop.ann(), sqop.cre());
-                            d_couplings.push_back(std::make_tuple(n, d_new, value));
-                        }
-                    }
-                    couplings_dexc_[d] = d_couplings;
-                    timings_["couplings"] += t_couplings.get();
-                }
-                local_timer t_sum;
-                // apply the operator
-                const auto& d_couplings = couplings_dexc_[d];
-                for (const auto& op_d_f : d_couplings) {
+            if (antihermitian) {
+                for (const auto& op_d_f : couplings_dexc_.find(d)->second) {
                     const double value =
                         op_list[std::get<0>(op_d_f)].coefficient() * std::get<2>(op_d_f) * c;
                     if (std::fabs(value) > screen_thresh)
                         new_terms[std::get<1>(op_d_f)] -= value;
                 }
-                timings_["exp"] += t_sum.get();
-            } else {
-                break;
             }
         }
     }
+    timings_["exp"] += t_sum.get();
+
+    local_timer t_reduce;
+    StateVector new_terms = reduce_states(thread_terms);
+    timings_["reduce"] += t_reduce.get();
     return new_terms;
 }
 
 StateVector SparseExp::apply_operator_sorted(const SparseOperator& sop, const StateVector& state0,
                                              double screen_thresh) {
-    // make a copy of the state
-    std::vector<std::tuple<double, double, Determinant>> state_sorted(state0.size());
-    size_t k = 0;
-    for (const auto& det_c : state0) {
-        const Determinant& d = det_c.first;
-        const double c = det_c.second;
-        state_sorted[k] = std::make_tuple(std::fabs(c), c, d);
-        ++k;
-    }
-    std::sort(state_sorted.rbegin(), state_sorted.rend());
+    const auto state_sorted = sort_state(state0);
 
     const auto& op_list = sop.op_list();
+    const bool antihermitian = sop.is_antihermitian();
 
-    StateVector new_terms;
+    const int nthreads = num_threads_for(state_sorted.size());
+    std::vector<StateVector> thread_terms(nthreads);
 
-    Determinant d;
-    double c;
-    double absc;
-
-    // loop over all the operators
-    for (const SQOperator& sqop : op_list) {
-        if (sqop.coefficient() == 0.0)
-            continue;
-        // create a mask for screening determinants according to the creation operators
-        // this mask looks only at creation operators that are not preceeded by annihilation
-        // operators
-        const Determinant ucre = sqop.cre() - sqop.ann();
-        // loop over all determinants
-        for (const auto& absc_c_det : state_sorted) {
-            num_attempts_++;
-            std::tie(absc, c, d) = absc_c_det;
-            // screen according to the product tau * c
-            if (std::fabs(sqop.coefficient() * c) > screen_thresh) {
-                // check if this operator can be applied
-                if (d.fast_a_and_b_equal_b(sqop.ann()) and d.fast_a_and_b_eq_zero(ucre)) {
-                    const double value =
-                        apply_op_safe(d, sqop.cre(), sqop.ann()) * sqop.coefficient() * c;
-                    new_terms[d] += value;
-                    num_success_++;
-                }
-            } else {
-                break;
-            }
-        }
-    }
+    // each thread processes the determinants I = thread_id, thread_id + nthreads, ...
+    // This subset is still sorted by |C_I|, so a thread can stop as soon as |t * C_I| is below
+    // the threshold
+#pragma omp parallel num_threads(nthreads)
+    {
+        const int thread_id = omp_get_thread_num();
+        StateVector& new_terms = thread_terms[thread_id];
+
+        Determinant d;
+        double c;
+        double absc;
 
-    if (sop.is_antihermitian()) {
         // loop over all the operators
         for (const SQOperator& sqop : op_list) {
             if (sqop.coefficient() == 0.0)
@@ -257,63 +252,75 @@ StateVector SparseExp::apply_operator_sorted(const SparseOperator& sop, const St
             // create a mask for screening determinants according to the creation operators
             // this mask looks only at creation operators that are not preceeded by annihilation
             // operators
-            const Determinant ucre = sqop.ann() - sqop.cre();
+            const Determinant ucre = sqop.cre() - sqop.ann();
             // loop over all determinants
-            for (const auto& absc_c_det : state_sorted) {
-                num_attempts_++;
-
-                std::tie(absc, c, d) = absc_c_det;
+            for (size_t I = thread_id; I < state_sorted.size(); I += nthreads) {
+                std::tie(absc, c, d) = state_sorted[I];
                 // screen according to the product tau * c
                 if (std::fabs(sqop.coefficient() * c) > screen_thresh) {
                     // check if this operator can be applied
-                    if (d.fast_a_and_b_equal_b(sqop.cre()) and d.fast_a_and_b_eq_zero(ucre)) {
-                        double value = apply_op_safe(d, sqop.ann(), sqop.cre()) * sqop.coefficient() * c;
-                        new_terms[d] -= value;
-                        num_success_++;
+                    if (d.fast_a_and_b_equal_b(sqop.ann()) and d.fast_a_and_b_eq_zero(ucre)) {
+                        const double value =
+                            apply_op_safe(d, sqop.cre(), sqop.ann()) * sqop.coefficient() * c;
+                        new_terms[d] += value;
                     }
                 } else {
                     break;
                 }
             }
         }
+
+        if (antihermitian) {
+            // loop over all the operators
+            for (const SQOperator& sqop : op_list) {
+                if (sqop.coefficient() == 0.0)
+                    continue;
+                // create a mask for screening determinants according to the creation operators
+                // this mask looks only at creation operators that are not preceeded by
+                // annihilation operators
+                const Determinant ucre = sqop.ann() - sqop.cre();
+                // loop over all determinants
+                for (size_t I = thread_id; I < state_sorted.size(); I += nthreads) {
+                    std::tie(absc, c, d) = state_sorted[I];
+                    // screen according to the product tau * c
+                    if (std::fabs(sqop.coefficient() * c) > screen_thresh) {
+                        // check if this operator can be applied
+                        if (d.fast_a_and_b_equal_b(sqop.cre()) and d.fast_a_and_b_eq_zero(ucre)) {
+                            double value =
+                                apply_op_safe(d, sqop.ann(), sqop.cre()) * sqop.coefficient() * c;
+                            new_terms[d] -= value;
+                        }
+                    } else {
+                        break;
+                    }
+                }
+            }
+        }
     }
+
+    local_timer t_reduce;
+    StateVector new_terms = reduce_states(thread_terms);
+    timings_["reduce"] += t_reduce.get();
     return new_terms;
 }
 
 StateVector SparseExp::apply_operator_std(const SparseOperator& sop, const StateVector& state0,
                                           double screen_thresh) {
-    local_timer t;
     const auto& op_list = sop.op_list();
+    const bool antihermitian = sop.is_antihermitian();
 
-    StateVector new_terms;
+    const size_t nstate = state0.size();
+    const int nthreads = num_threads_for(nstate);
+    std::vector<StateVector> thread_terms(nthreads);
 
-    // loop over all the operators
-    for (const SQOperator& sqop : op_list) {
-        if (sqop.coefficient() == 0.0)
-            continue;
-        // create a mask for screening determinants according to the creation operators
-        // this mask looks only at creation operators that are not preceeded by annihilation
-        // operators
-        const Determinant ucre = sqop.cre() - sqop.ann();
-        Determinant new_d;
-        // loop over all determinants
-        for (const auto& det_c : state0) {
-            const Determinant& d = det_c.first;
-            const double c = det_c.second;
-            // test if we can apply this operator to this determinant
-            // screen according to the product tau * c
-            if (std::fabs(sqop.coefficient() * c) > screen_thresh) {
-                // check if this operator can be applied
-                if (d.fast_a_and_b_equal_b(sqop.ann()) and d.fast_a_and_b_eq_zero(ucre)) {
-                    new_d = d;
-                    double value = apply_op_safe(new_d, sqop.cre(), sqop.ann()) * sqop.coefficient() * c;
-                    new_terms[new_d] += value;
-                }
-            }
-        }
-    }
+    // each thread applies the operator to a contiguous block of determinants
+#pragma omp parallel num_threads(nthreads)
+    {
+        const int thread_id = omp_get_thread_num();
+        StateVector& new_terms = thread_terms[thread_id];
+        const auto first = state0.begin() + (nstate * thread_id) / nthreads;
+        const auto last = state0.begin() + (nstate * (thread_id + 1)) / nthreads;
 
-    if (sop.is_antihermitian()) {
         // loop over all the operators
         for (const SQOperator& sqop : op_list) {
             if (sqop.coefficient() == 0.0)
@@ -321,26 +328,59 @@ StateVector SparseExp::apply_operator_std(const SparseOperator& sop, const State
             // create a mask for screening determinants according to the creation operators
             // this mask looks only at creation operators that are not preceeded by annihilation
             // operators
-            const Determinant ucre = sqop.ann() - sqop.cre();
+            const Determinant ucre = sqop.cre() - sqop.ann();
             Determinant new_d;
             // loop over all determinants
-            for (const auto& det_c : state0) {
-                const Determinant& d = det_c.first;
-                const double c = det_c.second;
+            for (auto it = first; it != last; ++it) {
+                const Determinant& d = it->first;
+                const double c = it->second;
                 // test if we can apply this operator to this determinant
                 // screen according to the product tau * c
                 if (std::fabs(sqop.coefficient() * c) > screen_thresh) {
                     // check if this operator can be applied
-                    if (d.fast_a_and_b_equal_b(sqop.cre()) and d.fast_a_and_b_eq_zero(ucre)) {
+                    if (d.fast_a_and_b_equal_b(sqop.ann()) and d.fast_a_and_b_eq_zero(ucre)) {
                         new_d = d;
                         double value =
-                            apply_op_safe(new_d, sqop.ann(), sqop.cre()) * sqop.coefficient() * c;
-                        new_terms[new_d] -= value;
+                            apply_op_safe(new_d, sqop.cre(), sqop.ann()) * sqop.coefficient() * c;
+                        new_terms[new_d] += value;
+                    }
+                }
+            }
+        }
+
+        if (antihermitian) {
+            // loop over all the operators
+            for (const SQOperator& sqop : op_list) {
+                if (sqop.coefficient() == 0.0)
+                    continue;
+                // create a mask for screening determinants according to the creation operators
+                // this mask looks only at creation operators that are not preceeded by
+                // annihilation operators
+                const Determinant ucre = sqop.ann() - sqop.cre();
+                Determinant new_d;
+                // loop over all determinants
+                for (auto it = first; it != last; ++it) {
+                    const Determinant& d = it->first;
+                    const double c = it->second;
+                    // test if we can apply this operator to this determinant
+                    // screen according to the product tau * c
+                    if (std::fabs(sqop.coefficient() * c) > screen_thresh) {
+                        // check if this operator can be applied
+                        if (d.fast_a_and_b_equal_b(sqop.cre()) and d.fast_a_and_b_eq_zero(ucre)) {
+                            new_d = d;
+                            double value = apply_op_safe(new_d, sqop.ann(), sqop.cre()) *
+                                           sqop.coefficient() * c;
+                            new_terms[new_d] -= value;
+                        }
                     }
                 }
             }
         }
     }
+
+    local_timer t_reduce;
+    StateVector new_terms = reduce_states(thread_terms);
+    timings_["reduce"] += t_reduce.get();
     return new_terms;
 }
 
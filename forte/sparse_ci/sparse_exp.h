@@ -44,7 +44,9 @@ namespace forte {
  * This class implements an algorithm to apply the exponential of an operator to a state
  * 
  *    |state> -> exp(op) |state>
- * 
+ *
+ * The determinants of the state are distributed among the OpenMP threads. Each thread
+ * accumulates its contributions in a private state and these are summed at the end.
  */
 class SparseExp {
     enum class Algorithm { Cached, OnTheFlySorted, OnTheFlyStd };
@@ -75,7 +77,8 @@ class SparseExp {
     StateVector compute(const SparseOperator& sop, const StateVector& state,
                         const std::string& algorithm = "cached", double scaling_factor = 1.0,
                         int maxk = 19, double screen_thresh = 1.0e-12);
-    /// @return timings for this class
+    /// @return timings for this class. The entry "threads" reports the number of threads used
+    /// to apply the operator
     std::map<std::string, double> timings() const;
 
   private:
@@ -88,6 +91,11 @@ class SparseExp {
                                       double screen_thresh);
     StateVector apply_operator_std(const SparseOperator& sop, const StateVector& state0,
                                    double screen_thresh);
+    /// Build the coupling lists of the first nsel determinants of a sorted state that are not
+    /// already cached. If dexc is true, the de-excitation part of the operator is used
+    void add_couplings(const SparseOperator& sop,
+                       const std::vector<std::tuple<double, double, Determinant>>& state,
+                       size_t nsel, bool dexc);
 
 
     std::map<std::string, double> timings_;
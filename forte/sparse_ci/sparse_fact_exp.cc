@@ -27,11 +27,18 @@
  */
 
 #include <cmath>
+#include <unordered_set>
 
+#include "forte-def.h"
 #include "sparse_ci/sparse_fact_exp.h"
 
 namespace forte {
 
+namespace {
+/// The minimum number of determinants for which the couplings are computed in parallel
+constexpr size_t min_parallel_dets = 256;
+} // namespace
+
 SparseFactExp::SparseFactExp(bool phaseless) : phaseless_(phaseless) {}
 
 StateVector SparseFactExp::compute(const SparseOperator& sop, const StateVector& state,
@@ -82,67 +89,74 @@ void SparseFactExp::compute_couplings(const SparseOperator& sop, const StateVect
                                       bool inverse) {
     local_timer t;
     const auto& op_list = sop.op_list();
+    const size_t nterms = sop.size();
+    couplings_.resize(nterms);
 
     // initialize a state object
     StateVector state(state0);
     StateVector new_terms;
+    // the pairs (d, op d, phase) found by each thread
+    std::vector<std::vector<std::tuple<Determinant, Determinant, double>>> thread_couplings;
+    // the determinants d of the pairs already stored for the current operator
+    std::unordered_set<size_t> stored;
 
-    // loop over all operators
-    for (size_t m = 0, nterms = sop.size(); m < nterms; m++) {
+    // loop over all operators in the order they are applied
+    for (size_t m = 0; m < nterms; m++) {
         size_t n = inverse ? nterms - m - 1 : m;
 
-        std::vector<std::tuple<size_t, size_t, double>> d_couplings;
-
         // zero the new terms
         new_terms.clear();
 
         const SQOperator& sqop = op_list[n];
         const Determinant ucre = sqop.cre() - sqop.ann();
         const Determinant uann = sqop.ann() - sqop.cre();
-        const double sign = inverse ? -1.0 : 1.0;
-        Determinant new_d;
-        // loop over all determinants
-        if (phaseless_) {
-            for (const auto& det_c : state) {
-                const Determinant& d = det_c.first;
 
+        // find the pairs in parallel. Each thread processes a contiguous block of
+        // determinants, so concatenating the thread lists gives the same order as a serial loop.
+        // A determinant can be the one op acts on (d) or the one op creates (op d), and in both
+        // cases the pair is stored as (d, op d, phase of op d)
+        const size_t nstate = state.size();
+        const int nthreads = nstate < min_parallel_dets ? 1 : omp_get_max_threads();
+        thread_couplings.resize(nthreads);
+#pragma omp parallel num_threads(nthreads)
+        {
+            const int thread_id = omp_get_thread_num();
+            auto& t_couplings = thread_couplings[thread_id];
+            t_couplings.clear();
+            const auto first = state.begin() + (nstate * thread_id) / nthreads;
+            const auto last = state.begin() + (nstate * (thread_id + 1)) / nthreads;
+            Determinant new_d;
+            for (auto it = first; it != last; ++it) {
+                const Determinant& d = it->first;
                 // test if we can apply this operator to this determinant
                 if (d.fast_a_and_b_equal_b(sqop.ann()) and d.fast_a_and_b_eq_zero(ucre)) {
                     new_d = d;
-                    // we ignore the phase here
-                    apply_op(new_d, sqop.cre(), sqop.ann());
-                    size_t d_idx = exp_hash_.add(d);
-                    size_t new_d_idx = exp_hash_.add(new_d);
-                    d_couplings.emplace_back(d_idx, new_d_idx, sign);
-                    new_terms[new_d] += 1.0;
+                    double f = apply_op(new_d, sqop.cre(), sqop.ann());
+                    // in the phaseless case we ignore the phase here
+                    t_couplings.emplace_back(d, new_d, phaseless_ ? 1.0 : f);
                 } else if (d.fast_a_and_b_equal_b(sqop.cre()) and d.fast_a_and_b_eq_zero(uann)) {
                     new_d = d;
-                    // we ignore the phase here
-                    apply_op(new_d, sqop.ann(), sqop.cre());
-                    size_t d_idx = exp_hash_.add(d);
-                    size_t new_d_idx = exp_hash_.add(new_d);
-                    d_couplings.emplace_back(d_idx, new_d_idx, -sign);
-                    new_terms[new_d] += 1.0;
+                    // <d|op|new_d> = <new_d|op^+|d>
+                    double f = apply_op(new_d, sqop.ann(), sqop.cre());
+                    t_couplings.emplace_back(new_d, d, phaseless_ ? 1.0 : f);
                 }
             }
-        } else {
-            for (const auto& det_c : state) {
-                const Determinant& d = det_c.first;
+        }
 
-                // test if we can apply this operator to this determinant
-                if (d.fast_a_and_b_equal_b(sqop.ann()) and d.fast_a_and_b_eq_zero(ucre)) {
-                    new_d = d;
-                    double f = sign * apply_op(new_d, sqop.cre(), sqop.ann());
-                    size_t d_idx = exp_hash_.add(d);
-                    size_t new_d_idx = exp_hash_.add(new_d);
-                    d_couplings.emplace_back(d_idx, new_d_idx, f);
-                    new_terms[new_d] += 1.0;
-                } else if (d.fast_a_and_b_equal_b(sqop.cre()) and d.fast_a_and_b_eq_zero(uann)) {
-                    new_d = d;
-                    double f = -sign * apply_op(new_d, sqop.ann(), sqop.cre());
-                    size_t d_idx = exp_hash_.add(d);
+        // add the pairs that are not already stored. Those found when applying the
+        // exponential in the other direction are shared
+        auto& d_couplings = couplings_[n];
+        stored.clear();
+        for (const auto& coupling : d_couplings) {
+            stored.insert(std::get<0>(coupling));
+        }
+        for (const auto& t_couplings : thread_couplings) {
+            for (const auto& [d, new_d, f] : t_couplings) {
+                size_t d_idx = exp_hash_.add(d);
+                if (stored.insert(d_idx).second) {
                     size_t new_d_idx = exp_hash_.add(new_d);
                     d_couplings.emplace_back(d_idx, new_d_idx, f);
+                    new_terms[d] += 1.0;
                     new_terms[new_d] += 1.0;
                 }
             }
@@ -150,14 +164,10 @@ void SparseFactExp::compute_couplings(const SparseOperator& sop, const StateVect
         for (const auto& d_c : new_terms) {
             state[d_c.first] = 1.0;
         }
-        if (inverse) {
-            inverse_couplings_.push_back(d_couplings);
-        } else {
-            couplings_.push_back(d_couplings);
-        }
     }
     timings_["total"] += t.get();
     timings_["couplings"] += t.get();
+    timings_["threads"] = omp_get_max_threads();
 }
 
 StateVector SparseFactExp::compute_exp(const SparseOperator& sop, const StateVector& state0,
@@ -167,9 +177,6 @@ StateVector SparseFactExp::compute_exp(const SparseOperator& sop, const StateVec
     // create and fill in the state vector
     std::vector<double> state_c(exp_hash_.size(), 0.0);
 
-    // temporary space to store new elements
-    std::vector<std::pair<size_t, double>> new_terms(100);
-
     for (const auto& det_c : state0) {
         const Determinant& d = det_c.first;
         double c = det_c.second;
@@ -178,44 +185,39 @@ StateVector SparseFactExp::compute_exp(const SparseOperator& sop, const StateVec
     }
 
     // loop over all operators
+    const double sign = inverse ? -1.0 : 1.0;
     for (size_t m = 0, nterms = sop.size(); m < nterms; m++) {
         size_t n = inverse ? nterms - m - 1 : m;
 
-        double amp = sop.term(n).coefficient();
-
-        const std::vector<std::tuple<size_t, size_t, double>>& d_couplings =
-            inverse ? inverse_couplings_[m] : couplings_[m];
+        const double amp = sign * sop.term(n).coefficient();
+        const auto& d_couplings = couplings_[n];
 
-        // zero the new terms
-        size_t k = 0;
-        const size_t vec_size = new_terms.size();
-        for (const auto& coupling : d_couplings) {
-            const size_t d_idx = std::get<0>(coupling);
-            const size_t new_d_idx = std::get<1>(coupling);
-            const double f = amp * std::get<2>(coupling);
+        // each determinant belongs to at most one pair of an operator, so the 2 x 2 rotations
+        // exp(amp (op - op^+)) of the pairs are independent and can be applied in place
+        const size_t npairs = d_couplings.size();
+#pragma omp parallel for if (npairs > min_parallel_dets)
+        for (size_t p = 0; p < npairs; ++p) {
+            const auto& [d_idx, new_d_idx, phase] = d_couplings[p];
+            const double theta = amp * phase;
             const double c = state_c[d_idx];
-            // do not apply this operator to this determinant if we expect the new determinant
-            // to have an amplitude less than screen_thresh
-            // (here we use the approximation sin(x) ~ x, for x small)
-            if (std::fabs(f * c) > screen_thresh) {
-                if (k < vec_size) {
-                    new_terms[k] = std::make_pair(d_idx, c * (std::cos(f) - 1.0));
-                    new_terms[k + 1] = std::make_pair(new_d_idx, c * std::sin(f));
-                } else {
-                    new_terms.push_back(std::make_pair(d_idx, c * (std::cos(f) - 1.0)));
-                    new_terms.push_back(std::make_pair(new_d_idx, c * std::sin(f)));
-                }
-                k += 2;
+            const double new_c = state_c[new_d_idx];
+            // do not rotate this pair if we expect the change in the coefficients to be less
+            // than screen_thresh (here we use the approximation sin(x) ~ x, for x small)
+            if (std::fabs(theta) * (std::fabs(c) + std::fabs(new_c)) > screen_thresh) {
+                const double cos_theta = std::cos(theta);
+                const double sin_theta = std::sin(theta);
+                state_c[d_idx] = c * cos_theta - new_c * sin_theta;
+                state_c[new_d_idx] = new_c * cos_theta + c * sin_theta;
             }
         }
-        for (size_t j = 0; j < k; j++) {
-            state_c[new_terms[j].first] += new_terms[j].second;
-        }
     }
+    // only the determinants with a nonzero coefficient are returned
     StateVector state;
+    state.reserve(exp_hash_.size());
     for (size_t idx = 0, maxidx = exp_hash_.size(); idx < maxidx; idx++) {
-        const Determinant& d = exp_hash_.get_det(idx);
-        state[d] = state_c[idx];
+        if (state_c[idx] != 0.0) {
+            state[exp_hash_.get_det(idx)] = state_c[idx];
+        }
     }
     timings_["total"] += t.get();
     timings_["exp"] += t.get();
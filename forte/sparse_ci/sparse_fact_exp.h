@@ -98,10 +98,10 @@ class SparseFactExp {
     bool initialized_inverse_ = false;
     /// A map to store the determinants generated by the exponential
     DeterminantHashVec exp_hash_;
-    /// A vector of determinant couplings
+    /// The pairs of determinants coupled by each operator, stored as (d, op d, phase of op d).
+    /// The pairs found when applying the exponential and its inverse are stored together, and
+    /// each pair is applied as a rotation with angle +/- t * phase
     std::vector<std::vector<std::tuple<size_t, size_t, double>>> couplings_;
-    /// A vector of determinant couplings used when applying the inverse exponential
-    std::vector<std::vector<std::tuple<size_t, size_t, double>>> inverse_couplings_;
     /// A map that stores timing information
     std::map<std::string, double> timings_;
 };
@@ -36,23 +36,53 @@ SparseHamiltonian::SparseHamiltonian(std::shared_ptr<ActiveSpaceIntegrals> as_in
     : as_ints_(as_ints) {}
 
 StateVector SparseHamiltonian::compute(const StateVector& state, double screen_thresh) {
-    // store a list of determinants that we have never encountered before
-    std::vector<Determinant> new_dets;
+    ++num_calls_;
 
-    // find new determinants
+    // store a list of determinants whose couplings are missing or were screened with a larger
+    // threshold, and mark the other ones as used
+    std::vector<Determinant> new_dets;
     for (const auto& det_c : state) {
         const Determinant& det = det_c.first;
-        // if we already have precomputed this det add it to the list of new dets
-        if (not state_hash_.has_det(det)) {
+        auto it = couplings_.find(det);
+        if (it == couplings_.end() or it->second.screen_thresh > screen_thresh) {
             new_dets.push_back(det);
+        } else {
+            it->second.last_used = num_calls_;
+            lru_.splice(lru_.begin(), lru_, it->second.lru_it);
         }
     }
+    timings_["cached_dets"] += static_cast<double>(state.size() - new_dets.size());
+    timings_["new_dets"] += static_cast<double>(new_dets.size());
 
     // compute the new couplings
     compute_new_couplings(new_dets, screen_thresh);
 
     // compute sigma
-    return compute_sigma(state, screen_thresh);
+    StateVector sigma = compute_sigma(state, screen_thresh);
+
+    evict_couplings();
+    return sigma;
+}
+
+void SparseHamiltonian::evict_couplings() {
+    if (max_cached_couplings_ == 0)
+        return;
+    while (num_cached_couplings_ > max_cached_couplings_ and not lru_.empty()) {
+        auto it = couplings_.find(lru_.back());
+        // the remaining determinants were all used in this call
+        if (it->second.last_used == num_calls_)
+            break;
+        num_cached_couplings_ -= it->second.couplings.size();
+        couplings_.erase(it);
+        lru_.pop_back();
+    }
+}
+
+void SparseHamiltonian::clear_cache() {
+    couplings_.clear();
+    lru_.clear();
+    sigma_hash_.clear();
+    num_cached_couplings_ = 0;
 }
 
 void SparseHamiltonian::compute_new_couplings(const std::vector<Determinant>& new_dets,
@@ -182,7 +212,19 @@ void SparseHamiltonian::compute_new_couplings(const std::vector<Determinant>& ne
         sort(begin(det_couplings), end(det_couplings), [](auto const& a, auto const& b) {
             return std::fabs(a.second) > std::fabs(b.second);
         });
-        couplings_[det] = det_couplings;
+        num_cached_couplings_ += det_couplings.size();
+        auto it = couplings_.find(det);
+        if (it == couplings_.end()) {
+            lru_.push_front(det);
+            couplings_[det] = {std::move(det_couplings), screen_thresh, num_calls_, lru_.begin()};
+        } else {
+            // replace couplings that were screened with a larger threshold
+            num_cached_couplings_ -= it->second.couplings.size();
+            it->second.couplings = std::move(det_couplings);
+            it->second.screen_thresh = screen_thresh;
+            it->second.last_used = num_calls_;
+            lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+        }
     }
     timings_["coupling_time"] += t.get();
     timings_["time"] += t.get();
@@ -197,7 +239,7 @@ StateVector SparseHamiltonian::compute_sigma(const StateVector& state, double sc
     for (const auto& det_c : state) {
         const auto& det = det_c.first;
         const double c = det_c.second;
-        for (const auto& new_det_HIJ : couplings_[det]) {
+        for (const auto& new_det_HIJ : couplings_[det].couplings) {
             const size_t new_det_idx = new_det_HIJ.first;
             const double h = new_det_HIJ.second;
             // since the couplings are sorted in decreasing magnitude
@@ -211,10 +253,13 @@ StateVector SparseHamiltonian::compute_sigma(const StateVector& state, double sc
         }
     }
 
-    // copy data to a StateVector object
+    // copy data to a StateVector object, skipping determinants that are not coupled to this
+    // state (sigma_hash_ holds the determinants coupled to all the states seen so far)
     StateVector sigma;
     for (size_t n = 0, maxn = sigma_hash_.size(); n < maxn; n++) {
-        sigma[sigma_hash_.get_det(n)] = sigma_c[n];
+        if (sigma_c[n] != 0.0) {
+            sigma[sigma_hash_.get_det(n)] = sigma_c[n];
+        }
     }
 
     timings_["total"] += t.get();
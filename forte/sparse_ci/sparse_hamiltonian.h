@@ -29,6 +29,8 @@
 #ifndef _sparse_hamiltonian_h_
 #define _sparse_hamiltonian_h_
 
+#include <list>
+
 #include "integrals/active_space_integrals.h"
 #include "helpers/timer.h"
 
@@ -54,6 +56,9 @@ class SparseHamiltonian {
     /// iterative procedure
     /// This function applies only those elements of H that satisfy the condition:
     ///     |H_IJ C_J| > screen_thresh
+    /// The couplings of a determinant are computed the first time it is encountered and reused
+    /// in later calls with the same or a larger screen_thresh. A smaller screen_thresh
+    /// triggers a recomputation.
     /// @param state the state to which the Hamiltonian will be applied
     /// @param screen_thresh a threshold to select which elements of H are applied to the state
     StateVector compute(const StateVector& state, double screen_thresh);
@@ -65,24 +70,52 @@ class SparseHamiltonian {
     /// @param screen_thresh a threshold to select which elements of H are applied to the state
     StateVector compute_on_the_fly(const StateVector& state, double screen_thresh);
 
-    /// @return timings for this class    
+    /// @brief Set the maximum number of couplings kept in the cache (0 = no limit)
+    /// When the limit is exceeded, the couplings of the least recently used determinants are
+    /// discarded. The couplings needed by the current call to compute() are never discarded.
+    void set_max_cached_couplings(size_t n) { max_cached_couplings_ = n; }
+    /// @return the number of couplings kept in the cache
+    size_t num_cached_couplings() const { return num_cached_couplings_; }
+    /// @brief Discard all the cached couplings
+    void clear_cache();
+
+    /// @return timings for this class
     std::map<std::string, double> timings() const;
 
   private:
+    /// The couplings of a determinant stored in the cache
+    struct CachedCouplings {
+        /// The couplings (index in sigma_hash_, H_IJ) sorted by decreasing |H_IJ|
+        std::vector<std::pair<size_t, double>> couplings;
+        /// The threshold used to screen the couplings
+        double screen_thresh;
+        /// The number of the last call to compute() that used these couplings
+        size_t last_used;
+        /// The position of this determinant in the LRU list
+        std::list<Determinant>::iterator lru_it;
+    };
+
     /// Compute couplings for new determinants
     void compute_new_couplings(const std::vector<Determinant>& new_dets, double screen_thresh);
     /// Compute sigma using the couplings
     StateVector compute_sigma(const StateVector& state, double screen_thresh);
+    /// Discard least recently used couplings until the cache fits in max_cached_couplings_
+    void evict_couplings();
 
     /// The integral object
     std::shared_ptr<ActiveSpaceIntegrals> as_ints_;
-    /// A map that holds the list of the determinants to which we apply H
-    DeterminantHashVec state_hash_;
     /// A map that holds the list of the determinants obtained after applying H
     DeterminantHashVec sigma_hash_;
-    /// A vector of determinant couplings
-    std::map<Determinant,std::vector<std::pair<size_t, double>>> couplings_;
-    // std::vector<std::tuple<size_t, size_t, double>> couplings_;
+    /// The cached couplings of each determinant
+    det_hash<CachedCouplings> couplings_;
+    /// The cached determinants, from the most to the least recently used
+    std::list<Determinant> lru_;
+    /// The number of calls to compute()
+    size_t num_calls_ = 0;
+    /// The total number of couplings in the cache
+    size_t num_cached_couplings_ = 0;
+    /// The maximum number of couplings in the cache (0 = no limit)
+    size_t max_cached_couplings_ = 0;
     /// A map that stores timing information
     std::map<std::string,double> timings_;
 };
@@ -28,7 +28,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <fstream>
 #include <numeric>
+#include <stdexcept>
 
 #include "helpers/timer.h"
 #include "helpers/string_algorithms.h"
@@ -38,7 +40,21 @@
 
 namespace forte {
 
-StateVector::StateVector(const det_hash<double>& state_vec) : state_vec_(state_vec) {}
+StateVector::StateVector(const det_hash<double>& state_vec) {
+    reserve(state_vec.size());
+    for (const auto& det_c : state_vec) {
+        dets_.add(det_c.first);
+        terms_.push_back(det_c);
+    }
+}
+
+void StateVector::clear() {
+    // keep the hash table sized for the previous content, so that refilling it does not rehash
+    size_t n = terms_.size();
+    dets_.clear();
+    terms_.clear();
+    dets_.reserve(n);
+}
 
 bool StateVector::operator==(const StateVector& lhs) const {
     double zero = 1.0e-14;
@@ -61,7 +77,7 @@ std::string StateVector::str(int n) const {
         n = Determinant::norb();
     }
     std::string s;
-    for (const auto& c_d : state_vec_) {
+    for (const auto& c_d : terms_) {
         if (std::fabs(c_d.second) > 1.0e-12) {
             s += forte::str(c_d.first, n) + " * " + std::to_string(c_d.second) + "\n";
         }
@@ -215,4 +231,179 @@ double overlap(StateVector& left_state, StateVector& right_state) {
     return overlap;
 }
 
+SortedStateVector::SortedStateVector(const StateVector& state) {
+    std::vector<std::pair<Determinant, double>> terms(state.begin(), state.end());
+    std::sort(terms.begin(), terms.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    dets_.reserve(terms.size());
+    coefs_.reserve(terms.size());
+    for (const auto& det_c : terms) {
+        dets_.push_back(det_c.first);
+        coefs_.push_back(det_c.second);
+    }
+}
+
+SortedStateVector::SortedStateVector(const std::vector<Determinant>& dets,
+                                     const std::vector<double>& coefs) {
+    if (dets.size() != coefs.size()) {
+        throw std::runtime_error("SortedStateVector: the number of determinants (" +
+                                 std::to_string(dets.size()) +
+                                 ") and coefficients (" + std::to_string(coefs.size()) +
+                                 ") do not match");
+    }
+    std::vector<size_t> order(dets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t i, size_t j) { return dets[i] < dets[j]; });
+    dets_.reserve(dets.size());
+    coefs_.reserve(dets.size());
+    for (size_t i : order) {
+        if (not dets_.empty() and dets_.back() == dets[i]) {
+            coefs_.back() += coefs[i];
+        } else {
+            dets_.push_back(dets[i]);
+            coefs_.push_back(coefs[i]);
+        }
+    }
+}
+
+StateVector SortedStateVector::to_state_vector() const {
+    StateVector state;
+    state.reserve(size());
+    for (size_t n = 0, maxn = size(); n < maxn; ++n) {
+        state[dets_[n]] = coefs_[n];
+    }
+    return state;
+}
+
+double SortedStateVector::coefficient(const Determinant& d) const {
+    auto it = std::lower_bound(dets_.begin(), dets_.end(), d);
+    if (it != dets_.end() and *it == d) {
+        return coefs_[it - dets_.begin()];
+    }
+    return 0.0;
+}
+
+double SortedStateVector::norm() const {
+    double norm2 = 0.0;
+    for (double c : coefs_) {
+        norm2 += c * c;
+    }
+    return std::sqrt(norm2);
+}
+
+void SortedStateVector::scale(double a) {
+    for (double& c : coefs_) {
+        c *= a;
+    }
+}
+
+void SortedStateVector::axpy(double a, const SortedStateVector& x) {
+    *this = add(1.0, *this, a, x);
+}
+
+void SortedStateVector::prune(double threshold) {
+    size_t k = 0;
+    for (size_t n = 0, maxn = size(); n < maxn; ++n) {
+        if (std::fabs(coefs_[n]) > threshold) {
+            dets_[k] = dets_[n];
+            coefs_[k] = coefs_[n];
+            k++;
+        }
+    }
+    dets_.resize(k);
+    coefs_.resize(k);
+}
+
+void SortedStateVector::save(const std::string& filename) const {
+    // the file contains the number of terms, the determinants, and the coefficients
+    std::ofstream out(filename.c_str(), std::ios_base::binary);
+    if (!out.good()) {
+        throw std::runtime_error("SortedStateVector: cannot open " + filename);
+    }
+    size_t nbits = Determinant::nbits;
+    size_t data_size = size();
+    out.write(reinterpret_cast<const char*>(&nbits), sizeof(size_t));
+    out.write(reinterpret_cast<const char*>(&data_size), sizeof(size_t));
+    out.write(reinterpret_cast<const char*>(dets_.data()), data_size * sizeof(Determinant));
+    out.write(reinterpret_cast<const char*>(coefs_.data()), data_size * sizeof(double));
+    out.close();
+}
+
+SortedStateVector SortedStateVector::load(const std::string& filename) {
+    std::ifstream in(filename.c_str(), std::ios_base::binary);
+    if (!in.good()) {
+        throw std::runtime_error("SortedStateVector: file " + filename + " does not exist");
+    }
+    size_t nbits, data_size;
+    in.read(reinterpret_cast<char*>(&nbits), sizeof(size_t));
+    if (nbits != Determinant::nbits) {
+        throw std::runtime_error("SortedStateVector: " + filename + " stores determinants with " +
+                                 std::to_string(nbits) + " bits, but this version of forte uses " +
+                                 std::to_string(Determinant::nbits));
+    }
+    in.read(reinterpret_cast<char*>(&data_size), sizeof(size_t));
+    SortedStateVector state;
+    state.dets_.resize(data_size);
+    state.coefs_.resize(data_size);
+    in.read(reinterpret_cast<char*>(state.dets_.data()), data_size * sizeof(Determinant));
+    in.read(reinterpret_cast<char*>(state.coefs_.data()), data_size * sizeof(double));
+    in.close();
+    return state;
+}
+
+double dot(const SortedStateVector& left_state, const SortedStateVector& right_state) {
+    const auto& ldets = left_state.dets();
+    const auto& rdets = right_state.dets();
+    const auto& lc = left_state.coefficients();
+    const auto& rc = right_state.coefficients();
+    double overlap = 0.0;
+    size_t i = 0, j = 0;
+    const size_t maxi = ldets.size(), maxj = rdets.size();
+    while (i < maxi and j < maxj) {
+        if (ldets[i] < rdets[j]) {
+            ++i;
+        } else if (rdets[j] < ldets[i]) {
+            ++j;
+        } else {
+            overlap += lc[i] * rc[j];
+            ++i;
+            ++j;
+        }
+    }
+    return overlap;
+}
+
+SortedStateVector add(double a, const SortedStateVector& x, double b, const SortedStateVector& y) {
+    SortedStateVector result;
+    const size_t maxi = x.size(), maxj = y.size();
+    result.dets_.reserve(maxi + maxj);
+    result.coefs_.reserve(maxi + maxj);
+    size_t i = 0, j = 0;
+    while (i < maxi and j < maxj) {
+        if (x.dets_[i] < y.dets_[j]) {
+            result.dets_.push_back(x.dets_[i]);
+            result.coefs_.push_back(a * x.coefs_[i]);
+            ++i;
+        } else if (y.dets_[j] < x.dets_[i]) {
+            result.dets_.push_back(y.dets_[j]);
+            result.coefs_.push_back(b * y.coefs_[j]);
+            ++j;
+        } else {
+            result.dets_.push_back(x.dets_[i]);
+            result.coefs_.push_back(a * x.coefs_[i] + b * y.coefs_[j]);
+            ++i;
+            ++j;
+        }
+    }
+    for (; i < maxi; ++i) {
+        result.dets_.push_back(x.dets_[i]);
+        result.coefs_.push_back(a * x.coefs_[i]);
+    }
+    for (; j < maxj; ++j) {
+        result.dets_.push_back(y.dets_[j]);
+        result.coefs_.push_back(b * y.coefs_[j]);
+    }
+    return result;
+}
+
 } // namespace forte
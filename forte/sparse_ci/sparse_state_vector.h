@@ -29,9 +29,12 @@
 #ifndef _sparse_state_vector_h_
 #define _sparse_state_vector_h_
 
-#include <vector>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "helpers/flat_hash_vector.h"
 #include "sparse_ci/determinant.h"
 #include "sparse_ci/sparse_operator.h"
 
@@ -39,46 +42,154 @@ namespace forte {
 
 class ActiveSpaceIntegrals;
 
+/**
+ * @brief A sparse state vector, a map from determinants to coefficients
+ *
+ * The terms are stored contiguously in insertion order and indexed by an open-addressing hash
+ * table, so adding a determinant does not allocate a node on the heap. clear() keeps the
+ * allocated memory, so a StateVector that is cleared and refilled at every iteration allocates
+ * only when it grows past its largest size.
+ */
 class StateVector {
   public:
+    using container = std::vector<std::pair<Determinant, double>>;
+
     /// Constructor
     StateVector() = default;
     /// Constructor from a map/dictionary (python friendly)
     StateVector(const det_hash<double>& state_vec);
+    /// Copy constructor
+    StateVector(const StateVector&) = default;
+    /// Move constructor
+    StateVector(StateVector&&) = default;
+    /// Copy assignment
+    StateVector& operator=(const StateVector&) = default;
+    /// Move assignment
+    StateVector& operator=(StateVector&&) = default;
 
-    /// @return the map that holds the determinants
-    det_hash<double>& map() { return state_vec_; }
     /// @return true if the two states are identical
     bool operator==(const StateVector& lhs) const;
 
     /// @return a string representation of the object
     std::string str(int n = 0) const;
     /// @return the number of elements (determinants)
-    auto size() const { return state_vec_.size(); }
-    /// @brief reset this state
-    void clear() { state_vec_.clear(); }
+    size_t size() const { return terms_.size(); }
+    /// @brief reserve memory for n determinants
+    void reserve(size_t n) {
+        dets_.reserve(n);
+        terms_.reserve(n);
+    }
+    /// @brief reset this state, keeping the memory allocated for its determinants
+    void clear();
+    /// @brief exchange the content of this state with another one
+    void swap(StateVector& other) {
+        dets_.swap(other.dets_);
+        terms_.swap(other.terms_);
+    }
+    /// @return 1 if the determinant d is in this state, 0 otherwise
+    size_t count(const Determinant& d) const { return dets_.find(d) != det_index::npos; }
     /// @brief find and return the element corresponding to a determinant
     /// @param d the determinant to search for
-    /// @return the element found
-    auto find(const Determinant& d) const { return state_vec_.find(d); }
+    /// @return the element found or end() if d is not in this state
+    container::const_iterator find(const Determinant& d) const {
+        size_t idx = dets_.find(d);
+        return idx == det_index::npos ? terms_.end() : terms_.begin() + idx;
+    }
 
     /// @return the beginning of the map
-    auto begin() { return state_vec_.begin(); }
+    container::iterator begin() { return terms_.begin(); }
     /// @return the beginning of the map (const)
-    auto begin() const { return state_vec_.begin(); }
+    container::const_iterator begin() const { return terms_.begin(); }
     /// @return the end of the map
-    auto end() { return state_vec_.end(); }
+    container::iterator end() { return terms_.end(); }
     /// @return the end of the map (const)
-    auto end() const { return state_vec_.end(); }
-    /// @return the coefficient corresponding to a determinant
+    container::const_iterator end() const { return terms_.end(); }
+    /// @return the coefficient corresponding to a determinant (added with a zero coefficient
+    ///         if not present). The reference is invalidated when another determinant is added.
     /// @param d the determinant to search
-    double& operator[](const Determinant& d) { return state_vec_[d]; }
+    double& operator[](const Determinant& d) {
+        size_t idx = dets_.add(d);
+        if (idx == terms_.size()) {
+            terms_.emplace_back(d, 0.0);
+        }
+        return terms_[idx].second;
+    }
+
+  private:
+    using det_index = FlatHashVector<Determinant, Determinant::Hash>;
+    /// The position of each determinant in terms_
+    det_index dets_;
+    /// The determinants and their coefficients in insertion order
+    container terms_;
+};
+
+/**
+ * @brief A sparse state vector with its determinants sorted in contiguous arrays
+ *
+ * The determinants and the coefficients are stored in two separate arrays sorted by
+ * determinant. Combining two sorted states (dot, axpy, add) is a linear merge instead of one hash
+ * probe per term, and the coefficient array can be written to disk or viewed from numpy without
+ * copying. Lookups of single determinants use a binary search.
+ */
+class SortedStateVector {
+  public:
+    /// Constructor
+    SortedStateVector() = default;
+    /// Constructor from a StateVector (the terms are sorted)
+    explicit SortedStateVector(const StateVector& state);
+    /// Constructor from a list of determinants and coefficients. Repeated determinants are summed
+    SortedStateVector(const std::vector<Determinant>& dets, const std::vector<double>& coefs);
+
+    /// @return a StateVector with the same terms
+    StateVector to_state_vector() const;
+
+    /// @return the number of elements (determinants)
+    size_t size() const { return dets_.size(); }
+    /// @return the sorted determinants
+    const std::vector<Determinant>& dets() const { return dets_; }
+    /// @return the coefficients, in the same order as the determinants
+    const std::vector<double>& coefficients() const { return coefs_; }
+    /// @return the coefficients, in the same order as the determinants
+    std::vector<double>& coefficients() { return coefs_; }
+    /// @return the coefficient of the determinant d (zero if d is not in this state)
+    double coefficient(const Determinant& d) const;
+    /// @brief reset this state
+    void clear() {
+        dets_.clear();
+        coefs_.clear();
+    }
+
+    /// @return the 2-norm of this state
+    double norm() const;
+    /// @brief multiply this state by a
+    void scale(double a);
+    /// @brief this = this + a * x
+    void axpy(double a, const SortedStateVector& x);
+    /// @brief remove the terms with absolute coefficient smaller than or equal to threshold
+    void prune(double threshold);
+
+    /// @brief save this state to a binary file
+    void save(const std::string& filename) const;
+    /// @brief read a state saved with save()
+    static SortedStateVector load(const std::string& filename);
+
+    /// @return a * x + b * y
+    friend SortedStateVector add(double a, const SortedStateVector& x, double b,
+                                 const SortedStateVector& y);
 
   private:
-    /// Holds an unordered map Determinant -> double
-    det_hash<double> state_vec_;
+    /// The determinants, sorted
+    std::vector<Determinant> dets_;
+    /// The coefficients
+    std::vector<double> coefs_;
 };
 
+/// compute the overlap value <left_state|right_state> of two sorted states
+double dot(const SortedStateVector& left_state, const SortedStateVector& right_state);
+
+/// @return a * x + b * y
+SortedStateVector add(double a, const SortedStateVector& x, double b, const SortedStateVector& y);
+
 // Functions to apply operators, gop |state>
 
 /// apply the number projection operator P^alpha_na P^beta_nb |state>
@@ -31,6 +31,10 @@
 
 #include "boost/format.hpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "psi4/liboptions/liboptions.h"
 #include "psi4/libmints/dimension.h"
 #include "psi4/libmints/molecule.h"
@@ -87,6 +91,11 @@ void V2RDM::startup() {
         offset_rel += active_[h];
         offset_abs += nmopi_[h];
     }
+    size_t nactv = mo_space_info_->size("ACTIVE");
+    rel_index_.assign(nmopi_.sum(), nactv);
+    for (const auto& [abs_idx, rel] : abs_to_rel_) {
+        rel_index_[abs_idx] = rel;
+    }
 
     // read 2-pdm
     read_2pdm();
@@ -112,6 +121,20 @@ void V2RDM::startup() {
     }
 }
 
+template <typename T>
+std::vector<T> V2RDM::read_density_file(unsigned int file, const std::string& name) {
+    std::shared_ptr<PSIO> psio(new PSIO());
+    long int nline;
+    psio->open(file, PSIO_OPEN_OLD);
+    psio->read_entry(file, "length", (char*)&nline, sizeof(long int));
+    std::vector<T> buffer(nline);
+    if (nline > 0) {
+        psio->read_entry(file, name.c_str(), (char*)buffer.data(), nline * sizeof(T));
+    }
+    psio->close(file, 1);
+    return buffer;
+}
+
 void V2RDM::read_2pdm() {
     // map file names
     std::map<unsigned int, std::string> filename;
@@ -136,54 +159,43 @@ void V2RDM::read_2pdm() {
     size_t nactv2 = nactv * nactv;
     size_t nactv3 = nactv * nactv2;
 
-    // test if active orbitals are consistent in forte and v2rdm-casscf
-    long int nab;
-    psio_address addr_ab = PSIO_ZERO;
-    psio->open(PSIF_V2RDM_D2AB, PSIO_OPEN_OLD);
-    psio->read_entry(PSIF_V2RDM_D2AB, "length", (char*)&nab, sizeof(long int));
-
-    size_t nsymgem = 0; // number of totally symmetric geminals
-    for (size_t h = 0; h < nirrep_; ++h) {
-        nsymgem += active_[h] * active_[h];
-    }
-    for (size_t n = 0; n < nsymgem; ++n) {
-        tpdm d2;
-        psio->read(PSIF_V2RDM_D2AB, "D2ab", (char*)&d2, sizeof(tpdm), addr_ab, &addr_ab);
-        size_t l = static_cast<size_t>(d2.l);
-        if (abs_to_rel_.find(l) == abs_to_rel_.end()) {
-            outfile->Printf("\n  The active block of FORTE is different from "
-                            "V2RDM-CASSCF.");
-            outfile->Printf("\n  Please check the input file and make the "
-                            "active block consistent.");
-            throw psi::PSIEXCEPTION("The active block of FORTE is different from V2RDM-CASSCF.");
-        }
-    }
-    psio->close(PSIF_V2RDM_D2AB, 1);
-
-    // Read 2RDM
+    // Read 2RDM: each file is read in one block and then sorted in parallel
     str = "Reading 2RDMs";
     outfile->Printf("\n  %-45s ...", str.c_str());
+    size_t nmo = rel_index_.size();
     for (const auto& file : {PSIF_V2RDM_D2AA, PSIF_V2RDM_D2AB, PSIF_V2RDM_D2BB}) {
         ambit::Tensor D2 =
             ambit::Tensor::build(ambit::CoreTensor, filename[file], {nactv, nactv, nactv, nactv});
-
-        long int nline;
-        psio_address addr = PSIO_ZERO;
-        psio->open(file, PSIO_OPEN_OLD);
-        psio->read_entry(file, "length", (char*)&nline, sizeof(long int));
-
-        for (int n = 0; n < nline; ++n) {
-            tpdm d2;
-            psio->read(file, filename[file].c_str(), (char*)&d2, sizeof(tpdm), addr, &addr);
-            size_t i = abs_to_rel_[static_cast<size_t>(d2.i)];
-            size_t j = abs_to_rel_[static_cast<size_t>(d2.j)];
-            size_t k = abs_to_rel_[static_cast<size_t>(d2.k)];
-            size_t l = abs_to_rel_[static_cast<size_t>(d2.l)];
-
-            size_t idx = i * nactv3 + j * nactv2 + k * nactv + l;
-            D2.data()[idx] = d2.val;
+        std::vector<tpdm> buffer = read_density_file<tpdm>(file, filename[file]);
+
+        // test if active orbitals are consistent in forte and v2rdm-casscf
+        bool consistent = true;
+        size_t nline = buffer.size();
+        std::vector<double>& data = D2.data();
+#pragma omp parallel for reduction(&& : consistent)
+        for (size_t n = 0; n < nline; ++n) {
+            const tpdm& d2 = buffer[n];
+            size_t idx[4] = {static_cast<size_t>(d2.i), static_cast<size_t>(d2.j),
+                             static_cast<size_t>(d2.k), static_cast<size_t>(d2.l)};
+            size_t rel[4];
+            bool active = true;
+            for (int p = 0; p < 4; ++p) {
+                rel[p] = idx[p] < nmo ? rel_index_[idx[p]] : nactv;
+                active = active and rel[p] < nactv;
+            }
+            if (not active) {
+                consistent = false;
+                continue;
+            }
+            data[rel[0] * nactv3 + rel[1] * nactv2 + rel[2] * nactv + rel[3]] = d2.val;
+        }
+        if (not consistent) {
+            outfile->Printf("\n  The active block of FORTE is different from "
+                            "V2RDM-CASSCF.");
+            outfile->Printf("\n  Please check the input file and make the "
+                            "active block consistent.");
+            throw psi::PSIEXCEPTION("The active block of FORTE is different from V2RDM-CASSCF.");
         }
-        psio->close(file, 1);
 
         D2_.push_back(D2);
     }
@@ -231,6 +243,7 @@ void V2RDM::build_opdm() {
     ambit::Tensor& D2bb = D2_[2];
 
     // compute OPDM
+#pragma omp parallel for
     for (size_t u = 0; u < nactv; ++u) {
         for (size_t v = 0; v < nactv; ++v) {
 
@@ -291,49 +304,33 @@ void V2RDM::read_3pdm() {
     size_t nactv4 = nactv * nactv3;
     size_t nactv5 = nactv * nactv4;
 
-    // Read 3RDM
+    // Read 3RDM: each file is read in one block and then sorted in parallel
     str = "Reading 3RDMs";
     outfile->Printf("\n  %-45s ...", str.c_str());
     for (const auto& file :
          {PSIF_V2RDM_D3AAA, PSIF_V2RDM_D3AAB, PSIF_V2RDM_D3BBA, PSIF_V2RDM_D3BBB}) {
         ambit::Tensor D3 = ambit::Tensor::build(ambit::CoreTensor, filename[file],
                                                 {nactv, nactv, nactv, nactv, nactv, nactv});
-
-        long int nline;
-        psio_address addr = PSIO_ZERO;
-        psio->open(file, PSIO_OPEN_OLD);
-        psio->read_entry(file, "length", (char*)&nline, sizeof(long int));
-
-        if (file != PSIF_V2RDM_D3BBA) {
-            for (int nl = 0; nl < nline; ++nl) {
-                dm3 d3;
-                psio->read(file, filename[file].c_str(), (char*)&d3, sizeof(dm3), addr, &addr);
-                size_t i = abs_to_rel_[static_cast<size_t>(d3.i)];
-                size_t j = abs_to_rel_[static_cast<size_t>(d3.j)];
-                size_t k = abs_to_rel_[static_cast<size_t>(d3.k)];
-                size_t l = abs_to_rel_[static_cast<size_t>(d3.l)];
-                size_t m = abs_to_rel_[static_cast<size_t>(d3.m)];
-                size_t n = abs_to_rel_[static_cast<size_t>(d3.n)];
-
-                size_t idx = i * nactv5 + j * nactv4 + k * nactv3 + l * nactv2 + m * nactv + n;
-                D3.data()[idx] = d3.val;
-            }
-        } else {
-            for (int nl = 0; nl < nline; ++nl) {
-                dm3 d3;
-                psio->read(file, filename[file].c_str(), (char*)&d3, sizeof(dm3), addr, &addr);
-                size_t i = abs_to_rel_[static_cast<size_t>(d3.i)];
-                size_t j = abs_to_rel_[static_cast<size_t>(d3.j)];
-                size_t k = abs_to_rel_[static_cast<size_t>(d3.k)];
-                size_t l = abs_to_rel_[static_cast<size_t>(d3.l)];
-                size_t m = abs_to_rel_[static_cast<size_t>(d3.m)];
-                size_t n = abs_to_rel_[static_cast<size_t>(d3.n)];
-
-                size_t idx = k * nactv5 + i * nactv4 + j * nactv3 + n * nactv2 + l * nactv + m;
-                D3.data()[idx] = d3.val;
-            }
+        std::vector<dm3> buffer = read_density_file<dm3>(file, filename[file]);
+
+        // the bba file is stored as D3[k][i][j][n][l][m] of the abb block
+        bool bba = file == PSIF_V2RDM_D3BBA;
+        size_t nline = buffer.size();
+        std::vector<double>& data = D3.data();
+#pragma omp parallel for
+        for (size_t nl = 0; nl < nline; ++nl) {
+            const dm3& d3 = buffer[nl];
+            size_t i = rel_index_[static_cast<size_t>(d3.i)];
+            size_t j = rel_index_[static_cast<size_t>(d3.j)];
+            size_t k = rel_index_[static_cast<size_t>(d3.k)];
+            size_t l = rel_index_[static_cast<size_t>(d3.l)];
+            size_t m = rel_index_[static_cast<size_t>(d3.m)];
+            size_t n = rel_index_[static_cast<size_t>(d3.n)];
+
+            size_t idx = bba ? k * nactv5 + i * nactv4 + j * nactv3 + n * nactv2 + l * nactv + m
+                             : i * nactv5 + j * nactv4 + k * nactv3 + l * nactv2 + m * nactv + n;
+            data[idx] = d3.val;
         }
-        psio->close(file, 1);
 
         D3_.push_back(D3);
     }
@@ -465,7 +462,7 @@ RDMs V2RDM::reference() {
     outfile->Printf("\n  %-45s ...", str.c_str());
     // if 3-RDMs are needed
     if (options_.get_str("THREEPDC") != "ZERO") {
-        RDMs return_ref(D1a_, D1b_, D2_[0], D2_[1], D2_[3], D3_[0], D3_[1], D3_[2], D3_[3]);   
+        RDMs return_ref(D1a_, D1b_, D2_[0], D2_[1], D2_[2], D3_[0], D3_[1], D3_[2], D3_[3]);
         if (options_.get_str("WRITE_DENSITY_TYPE") == "CUMULANT") {
             write_density_to_file();
         }
@@ -473,8 +470,7 @@ RDMs V2RDM::reference() {
         outfile->Printf("    Done.");
         return return_ref;
     } else {
-        
-        RDMs return_ref(D1a_, D1b_, D2_[0], D2_[1], D2_[3]);   
+        RDMs return_ref(D1a_, D1b_, D2_[0], D2_[1], D2_[2]);
         if (options_.get_str("WRITE_DENSITY_TYPE") == "CUMULANT") {
             write_density_to_file();
         }
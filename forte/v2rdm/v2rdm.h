@@ -90,12 +90,19 @@ class V2RDM : public psi::Wavefunction {
     psi::Dimension active_;
     /// Map active absolute index to relative index
     std::map<size_t, size_t> abs_to_rel_;
+    /// The relative index of each absolute index (the number of active orbitals if not active).
+    /// Used to sort the densities in parallel
+    std::vector<size_t> rel_index_;
 
     /// List of core MOs
     std::vector<size_t> core_mos_;
     /// List of active MOs
     std::vector<size_t> actv_mos_;
 
+    /// Read the "length" entry and then all the elements of a density file in one read
+    template <typename T>
+    std::vector<T> read_density_file(unsigned int file, const std::string& name);
+
     /// Read two particle density
     void read_2pdm();
     /// Build one particle density
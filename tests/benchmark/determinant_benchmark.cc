@@ -1,5 +1,7 @@
 #include <iostream>
 #include <fstream> // std::filebuf
+#include <cmath>
+#include <vector>
 
 #include "hayai/hayai.hpp"
 #include "hayai/hayai_main.hpp"
@@ -8,6 +10,7 @@
 
 using namespace forte;
 
+void print_hash_quality();
 
 int main(int argc, char* argv[]) {
     std::filebuf fb;
@@ -22,6 +25,8 @@ int main(int argc, char* argv[]) {
     if (result)
         return result;
 
+    print_hash_quality();
+
     //    hayai::ConsoleOutputter consoleOutputter;
     //    hayai::JsonOutputter JSONOutputter(json);
 
@@ -81,3 +86,77 @@ BENCHMARK_P(Determinant, sign_aaaa, 10, 100000, (int i, int j, int a, int b)) {
 BENCHMARK_P_INSTANCE(Determinant, sign_aaaa, (1, 4, 32, 63));
 BENCHMARK_P_INSTANCE(Determinant, sign_aaaa, (1, 4, 63, 32));
 BENCHMARK_P_INSTANCE(Determinant, sign_aaaa, (63, 32, 1, 4));
+
+Determinant det_test2 =
+    make_det_from_string("1001010000000000000000000000000000000000000000000000000000010000",
+                         "0001000000000000001000000000000000000000000000000000000000000011");
+
+BENCHMARK(Determinant, equal, 10, 100000) { bool eq = (det_test == det_test2); (void)eq; }
+
+BENCHMARK(Determinant, a_xor_b_count, 10, 100000) { det_test.fast_a_xor_b_count(det_test2); }
+
+BENCHMARK(Determinant, a_and_b_eq_zero, 10, 100000) { det_test.fast_a_and_b_eq_zero(det_test2); }
+
+BENCHMARK(Determinant, a_xor_b, 10, 100000) { det_test ^ det_test2; }
+
+// the hash values are stored to keep the compiler from removing the hashing
+volatile size_t hash_sink = 0;
+
+BENCHMARK(Determinant, hash, 10, 100000) { hash_sink = Determinant::Hash()(det_test); }
+
+String string_test = det_test.get_alfa_bits();
+
+BENCHMARK(String, hash, 10, 100000) { hash_sink = String::Hash()(string_test); }
+
+/// All determinants with nel alpha and nel beta electrons in the first norb orbitals
+std::vector<Determinant> make_cas_space(size_t norb, size_t nel) {
+    std::vector<uint64_t> strings;
+    for (uint64_t s = 0; s < (uint64_t(1) << norb); ++s) {
+        if (static_cast<size_t>(__builtin_popcountll(s)) == nel)
+            strings.push_back(s);
+    }
+    std::vector<Determinant> dets;
+    for (uint64_t a : strings) {
+        for (uint64_t b : strings) {
+            Determinant d;
+            for (size_t i = 0; i < norb; ++i) {
+                d.set_alfa_bit(i, (a >> i) & 1);
+                d.set_beta_bit(i, (b >> i) & 1);
+            }
+            dets.push_back(d);
+        }
+    }
+    return dets;
+}
+
+std::vector<Determinant> cas_space = make_cas_space(12, 4);
+
+BENCHMARK(Determinant, hash_cas_space, 10, 10) {
+    size_t h = 0;
+    for (const auto& d : cas_space) {
+        h ^= Determinant::Hash()(d);
+    }
+    hash_sink = h;
+}
+
+/// Compare the bucket occupation of a power-of-two hash table with that of an ideal hash
+void print_hash_quality() {
+    size_t nbucket = 1;
+    while (nbucket < cas_space.size())
+        nbucket <<= 1;
+    std::vector<size_t> count(nbucket, 0);
+    for (const auto& d : cas_space) {
+        count[Determinant::Hash()(d) & (nbucket - 1)]++;
+    }
+    size_t occupied = 0;
+    size_t max_count = 0;
+    for (size_t c : count) {
+        occupied += (c > 0);
+        max_count = std::max(max_count, c);
+    }
+    double load = static_cast<double>(cas_space.size()) / nbucket;
+    std::cout << "Determinant::Hash on " << cas_space.size() << " determinants in " << nbucket
+              << " buckets: occupied fraction " << static_cast<double>(occupied) / nbucket
+              << " (ideal " << 1.0 - std::exp(-load) << "), longest chain " << max_count
+              << std::endl;
+}
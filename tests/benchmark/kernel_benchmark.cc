@@ -0,0 +1,177 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "hayai/hayai.hpp"
+#include "hayai/hayai_main.hpp"
+
+#include "forte/helpers/hash_vector.h"
+#include "forte/mrdsrg-helper/dsrg_source.h"
+#include "forte/sparse_ci/determinant.h"
+#include "forte/sparse_ci/sparse_operator.h"
+#include "forte/sparse_ci/sparse_state_vector.h"
+
+// Kernel benchmarks on fixed synthetic inputs. The inputs do not depend on integrals so that
+// the timings are reproducible from build to build. Run with "-o json:kernels.json" and compare
+// against a baseline with tests/benchmark/run_kernel_benchmarks.py.
+
+using namespace forte;
+
+int main(int argc, char* argv[]) {
+    hayai::MainRunner runner;
+
+    int result = runner.ParseArgs(argc, argv);
+    if (result)
+        return result;
+
+    return runner.Run();
+}
+
+/// All determinants with nel alpha and nel beta electrons in the first norb orbitals
+std::vector<Determinant> make_cas_space(size_t norb, size_t nel) {
+    std::vector<uint64_t> strings;
+    for (uint64_t s = 0; s < (uint64_t(1) << norb); ++s) {
+        if (static_cast<size_t>(__builtin_popcountll(s)) == nel)
+            strings.push_back(s);
+    }
+    std::vector<Determinant> dets;
+    for (uint64_t a : strings) {
+        for (uint64_t b : strings) {
+            Determinant d;
+            for (size_t i = 0; i < norb; ++i) {
+                d.set_alfa_bit(i, (a >> i) & 1);
+                d.set_beta_bit(i, (b >> i) & 1);
+            }
+            dets.push_back(d);
+        }
+    }
+    return dets;
+}
+
+// keeps the compiler from removing the work done in the benchmarks
+volatile double double_sink = 0.0;
+volatile size_t size_sink = 0;
+
+// ==> HashVector <==
+
+std::vector<Determinant> hash_space = make_cas_space(12, 4);
+
+BENCHMARK(HashVector, insert, 5, 5) {
+    HashVector<Determinant, Determinant::Hash> hv;
+    hv.reserve(hash_space.size());
+    for (const auto& d : hash_space) {
+        hv.add(d);
+    }
+    size_sink = hv.size();
+}
+
+HashVector<Determinant, Determinant::Hash> hash_table(hash_space);
+
+BENCHMARK(HashVector, find, 5, 5) {
+    size_t n = 0;
+    for (const auto& d : hash_space) {
+        n += hash_table.find(d);
+    }
+    size_sink = n;
+}
+
+// ==> StateVector apply <==
+
+const size_t apply_norb = 8;
+const size_t apply_nel = 4;
+
+/// A particle-number conserving operator with all alpha/beta single and alpha-beta double
+/// excitations among norb orbitals, with coefficients that depend only on the indices
+SparseOperator make_apply_operator(size_t norb) {
+    SparseOperator sop;
+    auto coef = [](size_t a, size_t b, size_t c, size_t d) {
+        return 0.01 * std::cos(double(1 + a + 3 * b + 7 * c + 11 * d));
+    };
+    for (size_t i = 0; i < norb; ++i) {
+        for (size_t a = 0; a < norb; ++a) {
+            if (a == i)
+                continue;
+            std::string si = std::to_string(i), sa = std::to_string(a);
+            sop.add_term_from_str("[" + sa + "a+ " + si + "a-]", coef(a, i, 0, 0));
+            sop.add_term_from_str("[" + sa + "b+ " + si + "b-]", coef(a, i, 1, 0));
+        }
+    }
+    for (size_t i = 0; i < norb; ++i) {
+        for (size_t j = 0; j < norb; ++j) {
+            for (size_t a = 0; a < norb; ++a) {
+                for (size_t b = 0; b < norb; ++b) {
+                    if (a == i and b == j)
+                        continue;
+                    sop.add_term_from_str("[" + std::to_string(a) + "a+ " + std::to_string(b) +
+                                              "b+ " + std::to_string(j) + "b- " +
+                                              std::to_string(i) + "a-]",
+                                          coef(a, b, i, j));
+                }
+            }
+        }
+    }
+    return sop;
+}
+
+/// A normalized-ish state spanning the full (nel, nel, norb) space with fixed coefficients
+StateVector make_apply_state(size_t norb, size_t nel) {
+    StateVector state;
+    size_t k = 0;
+    for (const auto& d : make_cas_space(norb, nel)) {
+        state[d] = std::sin(double(1 + k++));
+    }
+    return state;
+}
+
+SparseOperator apply_sop = make_apply_operator(apply_norb);
+StateVector apply_state = make_apply_state(apply_norb, apply_nel);
+
+BENCHMARK(StateVector, apply_operator, 5, 2) {
+    auto result = apply_operator(apply_sop, apply_state);
+    size_sink = result.size();
+}
+
+// ==> DSRG source <==
+
+const size_t dsrg_ndenom = 1 << 20;
+
+/// A fixed grid of denominators in [-2, 2] Eh, including values close to zero where the
+/// Taylor expansion of the regularized denominator is used
+std::vector<double> make_denominators(size_t n) {
+    std::vector<double> D(n);
+    for (size_t i = 0; i < n; ++i) {
+        D[i] = -2.0 + 4.0 * (static_cast<double>(i) + 0.5) / static_cast<double>(n);
+    }
+    return D;
+}
+
+std::vector<double> dsrg_denom = make_denominators(dsrg_ndenom);
+std::vector<double> dsrg_result(dsrg_ndenom);
+STD_SOURCE dsrg_source(0.5, 1.0e-3);
+
+BENCHMARK(DSRG_SOURCE, renormalized, 5, 10) {
+    double sum = 0.0;
+    for (size_t i = 0; i < dsrg_ndenom; ++i) {
+        sum += dsrg_source.compute_renormalized(dsrg_denom[i]);
+    }
+    double_sink = sum;
+}
+
+BENCHMARK(DSRG_SOURCE, renormalized_denominator, 5, 10) {
+    double sum = 0.0;
+    for (size_t i = 0; i < dsrg_ndenom; ++i) {
+        sum += dsrg_source.compute_renormalized_denominator(dsrg_denom[i]);
+    }
+    double_sink = sum;
+}
+
+BENCHMARK(DSRG_SOURCE, renormalized_batch, 5, 10) {
+    dsrg_source.compute_renormalized_batch(dsrg_denom.data(), dsrg_result.data(), dsrg_ndenom);
+    double_sink = dsrg_result[dsrg_ndenom / 2];
+}
+
+BENCHMARK(DSRG_SOURCE, renormalized_denominator_batch, 5, 10) {
+    dsrg_source.compute_renormalized_denominator_batch(dsrg_denom.data(), dsrg_result.data(),
+                                                       dsrg_ndenom);
+    double_sink = dsrg_result[dsrg_ndenom / 2];
+}
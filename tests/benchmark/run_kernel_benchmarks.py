@@ -0,0 +1,207 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""
+Kernel benchmarks for Forte with a throughput regression check.
+
+The kernels that need integrals (FCI sigma builds, the Dynamic and SparseList sigma vectors,
+the CI RDMs, and DF integral blocks) are timed here on a fixed H10 chain in the STO-3G basis.
+The kernels that do not need integrals are timed by kernel_benchmark.cc; pass its hayai JSON
+output with --hayai to collect both sets of timings in one file.
+
+Usage:
+    python run_kernel_benchmarks.py --output bench.json
+    python run_kernel_benchmarks.py --hayai kernels.json --compare baseline.json --tolerance 0.15
+
+With --compare, the script exits with status 1 if the throughput of any kernel drops below
+(1 - tolerance) times the baseline value.
+"""
+
+import argparse
+import itertools
+import json
+import statistics
+import sys
+import time
+
+
+def time_kernel(func, repeat):
+    """Run func repeat times after one warmup call and return the median wall time in seconds"""
+    func()
+    times = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        func()
+        times.append(time.perf_counter() - start)
+    return statistics.median(times)
+
+
+def record(results, name, seconds, work, unit):
+    """Store the timing of a kernel together with its throughput in work units per second"""
+    results[name] = {'seconds': seconds, 'work': work, 'unit': unit, 'throughput': work / seconds}
+    print(f'  {name:<45} {seconds:12.6f} s {work / seconds:14.4e} {unit}/s')
+
+
+def run_forte_kernels(results, repeat):
+    import psi4
+    import forte
+    from forte import forte_options
+
+    psi4.core.clean()
+    forte.clean_options()
+    psi4.core.be_quiet()
+
+    natom = 10
+    geom = '\n'.join([f'H 0.0 0.0 {1.0 * i:.1f}' for i in range(natom)])
+    psi4.geometry(f"""
+    {geom}
+    units angstrom
+    symmetry c1
+    """)
+
+    psi4.set_options(
+        {
+            'basis': 'sto-3g',
+            'scf_type': 'df',
+            'df_basis_scf': 'cc-pvdz-jkfit',
+            'df_basis_mp2': 'cc-pvdz-ri',
+            'forte__int_type': 'df',
+            'forte__active_space_solver': 'fci',
+            'forte__active': [natom],
+        }
+    )
+    E_scf, wfn = psi4.energy('scf', return_wfn=True)
+
+    psi4_options = psi4.core.get_options()
+    psi4_options.set_current_module('FORTE')
+    forte_options.get_options_from_psi4(psi4_options)
+
+    nmopi = wfn.nmopi()
+    point_group = wfn.molecule().point_group().symbol()
+    mo_space_info = forte.make_mo_space_info(nmopi, point_group, forte_options)
+    ints = forte.make_ints_from_psi4(wfn, forte_options, mo_space_info)
+    as_ints = forte.make_active_space_ints(mo_space_info, ints, 'ACTIVE', ['RESTRICTED_DOCC'])
+    scf_info = forte.SCFInfo(wfn)
+
+    # the full determinant space of the active orbitals
+    nmo = wfn.nmo()
+    na = wfn.nalpha()
+    nb = wfn.nbeta()
+    dets = []
+    for astr in itertools.combinations(range(nmo), na):
+        for bstr in itertools.combinations(range(nmo), nb):
+            d = forte.Determinant()
+            for a in astr:
+                d.create_alfa_bit(a)
+            for b in bstr:
+                d.create_beta_bit(b)
+            dets.append(d)
+    ndets = len(dets)
+
+    # sigma vector setup and a Davidson-Liu diagonalization from a fixed guess. The throughput is
+    # measured in determinants per second, which is comparable between runs with the same number of
+    # Davidson-Liu iterations
+    max_memory = 1024 * 1024 * 1024
+    for name, sigma_type in [('Dynamic', forte.SigmaVectorType.Dynamic),
+                             ('SparseList', forte.SigmaVectorType.SparseList)]:
+
+        def build():
+            return forte.make_sigma_vector(dets, as_ints, max_memory, sigma_type)
+
+        record(results, f'sigma_build.{name}', time_kernel(build, repeat), ndets, 'dets')
+
+        sigma = build()
+        solver = forte.SparseCISolver()
+        record(
+            results, f'sparse_ci.{name}',
+            time_kernel(lambda: solver.diagonalize_hamiltonian(dets, sigma, 1, 1), repeat), ndets, 'dets'
+        )
+
+    # string-based FCI and its RDMs
+    state_weights_map = forte.make_state_weights_map(forte_options, mo_space_info)
+    state_map = forte.to_state_nroots_map(state_weights_map)
+    fci = forte.make_active_space_solver('FCI', state_map, scf_info, mo_space_info, as_ints, forte_options)
+    record(results, 'fci.compute_energy', time_kernel(fci.compute_energy, repeat), ndets, 'dets')
+    for level in [1, 2, 3]:
+        record(
+            results, f'fci.rdms_{level}',
+            time_kernel(lambda: fci.compute_average_rdms(state_weights_map, level), repeat), ndets, 'dets'
+        )
+
+    # DF integral blocks over all correlated orbitals
+    ncmo = ints.ncmo()
+    orbs = list(range(ncmo))
+    record(
+        results, 'df_ints.tei_ab_block',
+        time_kernel(lambda: ints.tei_ab_block(orbs, orbs, orbs, orbs), repeat), ncmo**4, 'elements'
+    )
+    record(
+        results, 'df_ints.tei_aa_block',
+        time_kernel(lambda: ints.tei_aa_block(orbs, orbs, orbs, orbs), repeat), ncmo**4, 'elements'
+    )
+
+
+def read_hayai(results, filename):
+    """Read the JSON output of a hayai benchmark binary (-o json:filename)"""
+    with open(filename) as f:
+        data = json.load(f)
+    for bench in data['benchmarks']:
+        if bench.get('disabled', False):
+            continue
+        name = f"{bench['fixture']}.{bench['name']}"
+        params = [p['value'] for p in bench.get('parameters', [])]
+        if params:
+            name += '(' + ','.join(params) + ')'
+        # durations are in ms per run
+        runs = [run['duration'] / 1000.0 for run in bench['runs']]
+        seconds = statistics.median(runs) / bench['iterations_per_run']
+        record(results, name, seconds, 1, 'calls')
+
+
+def compare(results, baseline_file, tolerance):
+    """Return the list of kernels whose throughput dropped below (1 - tolerance) x baseline"""
+    with open(baseline_file) as f:
+        baseline = json.load(f)['benchmarks']
+    regressions = []
+    print(f'\n  {"Kernel":<45} {"baseline":>14} {"current":>14} {"ratio":>8}')
+    for name, res in sorted(results.items()):
+        if name not in baseline:
+            continue
+        ratio = res['throughput'] / baseline[name]['throughput']
+        flag = ''
+        if ratio < 1.0 - tolerance:
+            regressions.append(name)
+            flag = '  <-- regression'
+        print(f'  {name:<45} {baseline[name]["throughput"]:14.4e} {res["throughput"]:14.4e} {ratio:8.3f}{flag}')
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Run the Forte kernel benchmarks')
+    parser.add_argument('--output', default='kernel_benchmarks.json', help='file where the results are saved')
+    parser.add_argument('--hayai', nargs='*', default=[], help='JSON files written by the C++ benchmarks')
+    parser.add_argument('--compare', default=None, help='baseline results to compare against')
+    parser.add_argument('--tolerance', type=float, default=0.15, help='allowed relative throughput loss')
+    parser.add_argument('--repeat', type=int, default=5, help='number of timed calls per kernel')
+    parser.add_argument('--no-forte', action='store_true', help='skip the kernels that require psi4')
+    args = parser.parse_args()
+
+    results = {}
+    print(f'\n  {"Kernel":<45} {"time":>14} {"throughput":>16}')
+    for filename in args.hayai:
+        read_hayai(results, filename)
+    if not args.no_forte:
+        run_forte_kernels(results, args.repeat)
+
+    with open(args.output, 'w') as f:
+        json.dump({'format_version': 1, 'benchmarks': results}, f, indent=2)
+
+    if args.compare:
+        regressions = compare(results, args.compare, args.tolerance)
+        if regressions:
+            print(f'\n  Throughput regressions larger than {100 * args.tolerance:.0f}%: {", ".join(regressions)}')
+            return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
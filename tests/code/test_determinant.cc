@@ -8,6 +8,9 @@
 #include "forte/sparse_ci/determinant.h"
 #include "forte/sparse_ci/determinant.hpp"
 #include "forte/sparse_ci/bitarray.hpp"
+#include "forte/helpers/hash_vector.h"
+#include "forte/helpers/flat_hash_vector.h"
+#include "forte/sparse_ci/concurrent_det_hash.h"
 #include "test_determinant.hpp"
 
 using namespace forte;
@@ -100,6 +103,16 @@ TEST_CASE("Set/get [BitArray]", "[BitArray]") {
     test_bitarray_setget<1024>();
 }
 
+TEST_CASE("Bitwise operations [BitArray]", "[BitArray]") {
+    test_bitarray_bitwise_functions<64>();
+    test_bitarray_bitwise_functions<128>();
+    test_bitarray_bitwise_functions<192>();
+    test_bitarray_bitwise_functions<256>();
+    test_bitarray_bitwise_functions<320>();
+    test_bitarray_bitwise_functions<512>();
+    test_bitarray_bitwise_functions<1024>();
+}
+
 TEST_CASE("Set/get [DeterminantImpl]", "[DeterminantImpl]") {
     test_determinantimpl_setget<128>();
     test_determinantimpl_setget<256>();
@@ -127,6 +140,17 @@ TEST_CASE("Determinant count [DeterminantImpl]", "[DeterminantImpl]") {
     test_determinantimpl_count_functions<1024>();
 }
 
+TEST_CASE("Determinant width", "[Determinant]") {
+    REQUIRE(determinant_width(1) == std::min(size_t(64), Norb));
+    REQUIRE(determinant_width(Norb) == Norb);
+    if (Norb > 64)
+        REQUIRE(determinant_width(65) == std::min(size_t(128), Norb));
+    REQUIRE_THROWS_AS(determinant_width(Norb + 1), std::runtime_error);
+    size_t nbits = dispatch_determinant_width(
+        40, [](auto w) { return DeterminantImpl<2 * decltype(w)::value>::nbits; });
+    REQUIRE(nbits == 2 * std::min(size_t(64), Norb));
+}
+
 TEST_CASE("Empty determinant", "[Determinant]") {
     Determinant det_test;
     Determinant det_ref =
@@ -244,3 +268,88 @@ TEST_CASE("Full determinant", "[Determinant]") {
     REQUIRE(det_test.slater_sign_b(6) == 1.0);
     REQUIRE(det_test.slater_sign_b(7) == -1.0);
 }
+
+TEST_CASE("Hash vector backends", "[Determinant]") {
+    // build the same insertion-ordered sets with both backends and compare them
+    HashVector<Determinant, Determinant::Hash> hvec;
+    FlatHashVector<Determinant, Determinant::Hash> fvec;
+    std::vector<Determinant> dets;
+    size_t nbits = std::min(size_t(16), Norb);
+    for (size_t k = 0; k < 3000; ++k) {
+        Determinant d;
+        for (size_t i = 0; i < nbits; ++i) {
+            d.set_alfa_bit(i, ((k * 2654435761u) >> i) & 1);
+            d.set_beta_bit(i, ((k * 40503u + 7) >> (i % 8)) & 1);
+        }
+        dets.push_back(d);
+        REQUIRE(fvec.add(d) == hvec.add(d));
+    }
+    REQUIRE(fvec.size() == hvec.size());
+    for (const auto& d : dets) {
+        REQUIRE(fvec.find(d) == hvec.find(d));
+    }
+
+    // erase some keys and check that indices stay consistent
+    for (size_t k = 0; k < 200; k += 3) {
+        auto ref = hvec.erase_by_key_move_last(dets[k]);
+        REQUIRE(fvec.erase_by_key_move_last(dets[k]) == ref);
+    }
+    hvec.erase_by_key(std::vector<Determinant>(dets.begin() + 500, dets.begin() + 600));
+    fvec.erase_by_key(std::vector<Determinant>(dets.begin() + 500, dets.begin() + 600));
+    hvec.erase_by_index(7);
+    fvec.erase_by_index(7);
+    REQUIRE(fvec.size() == hvec.size());
+    for (size_t i = 0; i < hvec.size(); ++i) {
+        REQUIRE(fvec[i] == hvec[i]);
+        REQUIRE(fvec.find(hvec[i]) == i);
+    }
+    for (size_t k = 500; k < 600; ++k) {
+        REQUIRE(fvec.find(dets[k]) == fvec.npos);
+    }
+
+    // reordering the keys must keep lookups valid
+    auto index_map = fvec.optimize();
+    for (size_t i = 0; i < hvec.size(); ++i) {
+        REQUIRE(fvec[index_map[i]] == hvec[i]);
+        REQUIRE(fvec.find(hvec[i]) == index_map[i]);
+    }
+    fvec.shrink_to_fit();
+    REQUIRE(fvec.load_factor() <= fvec.max_load_factor());
+    for (const auto& d : dets) {
+        REQUIRE((fvec.find(d) == fvec.npos) == (hvec.find(d) == hvec.npos));
+    }
+    fvec.clear();
+    REQUIRE(fvec.size() == 0);
+    REQUIRE(fvec.find(dets[1]) == fvec.npos);
+}
+
+TEST_CASE("Concurrent determinant hash", "[Determinant]") {
+    // accumulate the same values serially and from many threads
+    std::vector<Determinant> dets;
+    for (size_t k = 0; k < 1000; ++k) {
+        Determinant d;
+        for (size_t i = 0; i < 10; ++i) {
+            d.set_alfa_bit(i, (k >> i) & 1);
+            d.set_beta_bit(i, ((k * 7) >> i) & 1);
+        }
+        dets.push_back(d);
+    }
+    det_hash<double> ref;
+    for (size_t k = 0; k < 20000; ++k) {
+        ref[dets[(k * 31) % dets.size()]] += 1.0;
+    }
+    ConcurrentDetHash<double> V(8);
+    REQUIRE(V.num_shards() == 8);
+#pragma omp parallel for
+    for (size_t k = 0; k < 20000; ++k) {
+        V.insert_or_add(dets[(k * 31) % dets.size()], 1.0);
+    }
+    REQUIRE(V.size() == ref.size());
+    std::vector<size_t> offsets = V.shard_offsets();
+    REQUIRE(offsets.back() == ref.size());
+    for (size_t s = 0; s < V.num_shards(); ++s) {
+        for (const auto& det_V : V.shard(s)) {
+            REQUIRE(det_V.second == ref[det_V.first]);
+        }
+    }
+}
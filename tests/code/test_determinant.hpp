@@ -360,4 +360,62 @@ template <size_t N> void test_determinantimpl_count_functions() {
     }
 }
 
+template <size_t N> void test_bitarray_bitwise_functions() {
+    std::mt19937 mersenne_engine(42);
+    std::uniform_int_distribution<int> dist{0, 3};
+    auto random_bitarray = [&](int zero_fraction) {
+        BitArray<N> b;
+        for (size_t i = 0; i < N; i++)
+            b.set_bit(i, dist(mersenne_engine) >= zero_fraction);
+        return b;
+    };
+    for (int ntest = 0; ntest < 200; ntest++) {
+        BitArray<N> a = random_bitarray(ntest % 4);
+        BitArray<N> b = random_bitarray((ntest / 4) % 4);
+        if (ntest % 7 == 0)
+            b = a;
+
+        BitArray<N> a_or_b = a | b;
+        BitArray<N> a_xor_b = a ^ b;
+        BitArray<N> a_and_b = a & b;
+        BitArray<N> a_minus_b = a - b;
+        BitArray<N> c = a;
+        c ^= b;
+        REQUIRE(c == a_xor_b);
+        c = a;
+        c &= b;
+        REQUIRE(c == a_and_b);
+        c = a;
+        c |= b;
+        REQUIRE(c == a_or_b);
+        c = a;
+        c -= b;
+        REQUIRE(c == a_minus_b);
+
+        int na = 0, nxor = 0;
+        bool and_zero = true, minus_zero = true, and_equal_b = true, equal = true;
+        for (size_t i = 0; i < N; i++) {
+            bool ai = a.get_bit(i);
+            bool bi = b.get_bit(i);
+            REQUIRE(a_or_b.get_bit(i) == (ai or bi));
+            REQUIRE(a_xor_b.get_bit(i) == (ai != bi));
+            REQUIRE(a_and_b.get_bit(i) == (ai and bi));
+            REQUIRE(a_minus_b.get_bit(i) == (ai and not bi));
+            na += ai;
+            nxor += (ai != bi);
+            and_zero = and_zero and not(ai and bi);
+            minus_zero = minus_zero and not(ai and not bi);
+            and_equal_b = and_equal_b and ((ai and bi) == bi);
+            equal = equal and (ai == bi);
+        }
+        REQUIRE(a.count() == na);
+        REQUIRE(a.fast_a_xor_b_count(b) == nxor);
+        REQUIRE(a.fast_a_and_b_eq_zero(b) == and_zero);
+        REQUIRE(a.fast_a_minus_b_eq_zero(b) == minus_zero);
+        REQUIRE(a.fast_a_and_b_equal_b(b) == and_equal_b);
+        REQUIRE((a == b) == equal);
+        REQUIRE((a != b) == not equal);
+    }
+}
+
 #endif // _test_determinant_
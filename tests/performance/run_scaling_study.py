@@ -0,0 +1,350 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""
+Strong- and weak-scaling study of Forte.
+
+For each method (FCI, ACI, PCI, SA-DSRG-PT2, CASSCF), this script writes psi4 inputs for a
+linear hydrogen chain H_n with n active electrons in n active orbitals, runs them for a sweep of
+thread counts, active-space sizes, and basis sets, and collects the total wall time together with
+the per-phase times recorded by the Forte profiler (PROFILE_FILE). The results are printed as
+strong-scaling tables (fixed size, increasing number of threads) and weak-scaling tables (size
+and number of threads increased together) and saved as JSON so that they can be compared against
+the baseline of a previous release.
+
+Examples:
+    python run_scaling_study.py --psi4 psi4 --methods fci casscf --threads 1 2 4 8 16 32 64
+    python run_scaling_study.py --methods sa-dsrg-pt2 --sizes 6 --bases cc-pvdz cc-pvtz
+    python run_scaling_study.py --methods aci --weak 8:1 10:8 12:64 --output aci.json
+    python run_scaling_study.py --baseline scaling-v0.3.json
+
+Weak scaling pairs are given as SIZE:THREADS. The weak-scaling efficiency reported is
+T(first pair) / T(pair), so the pairs should be chosen such that the work per thread is roughly
+constant for the method being studied.
+"""
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import time
+
+# Forte options of each method. {n} is replaced by the size of the active space.
+methods = {
+    'fci': """
+  active_space_solver  fci
+  restricted_docc      [0]
+  active               [{n}]
+""",
+    'aci': """
+  active_space_solver  aci
+  restricted_docc      [0]
+  active               [{n}]
+  sigma                0.001
+  sci_enforce_spin_complete true
+""",
+    'pci': """
+  active_space_solver  pci
+  restricted_docc      [0]
+  active               [{n}]
+  pci_spawning_threshold 0.0001
+  pci_generator        wall-chebyshev
+  pci_e_convergence    6
+""",
+    'sa-dsrg-pt2': """
+  active_space_solver  fci
+  correlation_solver   sa-mrdsrg
+  corr_level           pt2
+  int_type             df
+  restricted_docc      [0]
+  active               [{n}]
+  avg_state            [[0,1,2]]
+  dsrg_s               0.5
+""",
+    'casscf': """
+  job_type             casscf
+  casscf_reference     true
+  casscf_ci_solver     fci
+  restricted_docc      [0]
+  active               [{n}]
+  casscf_maxiter       50
+""",
+}
+
+input_template = """#! Scaling study input generated by run_scaling_study.py
+
+import forte
+
+memory {memory}
+
+molecule {{
+0 1
+{geometry}
+symmetry c1
+units angstrom
+}}
+
+set {{
+  basis          {basis}
+  df_basis_scf   {jkfit}
+  df_basis_mp2   {ri}
+  scf_type       df
+  reference      rhf
+  e_convergence  10
+  d_convergence  8
+}}
+
+set forte {{
+{method_options}
+  print          0
+  profile        true
+  profile_file   profile.json
+}}
+
+energy('forte')
+"""
+
+timing_re = re.compile(r"Psi4 wall time for execution: (\d+):(\d+):(\d+\.\d+)")
+
+
+def auxiliary_bases(basis):
+    """Return the JK and RI fitting bases for an orbital basis"""
+    if basis.lower().startswith(('cc-', 'aug-cc-')):
+        return basis + '-jkfit', basis + '-ri'
+    return 'cc-pvdz-jkfit', 'cc-pvdz-ri'
+
+
+def hydrogen_chain(n, r=1.0):
+    return '\n'.join([f'H 0.0 0.0 {r * i:.4f}' for i in range(n)])
+
+
+def write_input(path, method, size, basis, memory):
+    jkfit, ri = auxiliary_bases(basis)
+    os.makedirs(path, exist_ok=True)
+    with open(os.path.join(path, 'input.dat'), 'w') as f:
+        f.write(
+            input_template.format(
+                memory=memory,
+                geometry=hydrogen_chain(size),
+                basis=basis,
+                jkfit=jkfit,
+                ri=ri,
+                method_options=methods[method].format(n=size).strip('\n')
+            )
+        )
+
+
+def read_phases(filename, max_depth):
+    """
+    Sum the durations (in s) of the regions recorded by the profiler of the main thread, grouped
+    by their path up to a given depth
+    """
+    if not os.path.isfile(filename):
+        return {}
+    with open(filename) as f:
+        events = json.load(f)['traceEvents']
+    # the main thread is the one that records the outermost region
+    main_tid = min(events, key=lambda e: (e['ts'], -e['dur']))['tid'] if events else None
+    phases = {}
+    for event in events:
+        path = event['args']['path']
+        if event['tid'] != main_tid or path.count('/') >= max_depth:
+            continue
+        phases[path] = phases.get(path, 0.0) + event['dur'] * 1.0e-6
+    return phases
+
+
+def run(psi4, root, method, size, basis, nthreads, args):
+    """Run one calculation (or reuse its output) and return a dictionary with its timings"""
+    path = os.path.join(root, method, f'n{size}_{basis}_t{nthreads}')
+    output = os.path.join(path, 'output.dat')
+    if not (args.reuse and os.path.isfile(output)):
+        write_input(path, method, size, basis, args.memory)
+        if args.dry_run:
+            return None
+        env = dict(os.environ, OMP_NUM_THREADS=str(nthreads))
+        start = time.perf_counter()
+        subprocess.call([psi4, '-n', str(nthreads), 'input.dat', 'output.dat'], cwd=path, env=env)
+        elapsed = time.perf_counter() - start
+    else:
+        elapsed = None
+    text = open(output).read() if os.path.isfile(output) else ''
+    m = timing_re.search(text)
+    if m:
+        h, mi, s = m.groups()
+        elapsed = 3600 * int(h) + 60 * int(mi) + float(s)
+    status = 'ok' if m and 'PsiException' not in text and 'Traceback' not in text else 'failed'
+    result = {
+        'method': method,
+        'size': size,
+        'basis': basis,
+        'threads': nthreads,
+        'wall_time': elapsed,
+        'status': status,
+        'phases': read_phases(os.path.join(path, 'profile.json'), args.depth),
+    }
+    wall = f'{elapsed:10.2f} s' if elapsed is not None else ' ' * 12
+    print(f'  {method:<12} n = {size:<3} {basis:<10} {nthreads:4d} threads {wall}  {status}')
+    return result
+
+
+def strong_scaling(results):
+    """Speedup and efficiency relative to the smallest thread count of each (method, size, basis)"""
+    tables = {}
+    for r in results:
+        if r['status'] != 'ok':
+            continue
+        key = f"{r['method']}/n{r['size']}/{r['basis']}"
+        tables.setdefault(key, []).append(r)
+    for key, rows in tables.items():
+        rows.sort(key=lambda r: r['threads'])
+        ref = rows[0]
+        table = []
+        for r in rows:
+            speedup = ref['wall_time'] / r['wall_time']
+            phases = {
+                p: ref['phases'][p] / t
+                for p, t in r['phases'].items()
+                if p in ref['phases'] and t > 0.0
+            }
+            table.append(
+                {
+                    'threads': r['threads'],
+                    'wall_time': r['wall_time'],
+                    'speedup': speedup,
+                    'efficiency': speedup * ref['threads'] / r['threads'],
+                    'phase_speedup': phases,
+                }
+            )
+        tables[key] = table
+    return tables
+
+
+def weak_scaling(results, pairs):
+    tables = {}
+    for method in sorted({r['method'] for r in results}):
+        for basis in sorted({r['basis'] for r in results}):
+            rows = []
+            for size, nthreads in pairs:
+                for r in results:
+                    if (r['method'], r['basis'], r['size'], r['threads']) == (method, basis, size, nthreads) \
+                            and r['status'] == 'ok':
+                        rows.append(r)
+            if len(rows) < 2:
+                continue
+            ref = rows[0]
+            tables[f'{method}/{basis}'] = [
+                {
+                    'size': r['size'],
+                    'threads': r['threads'],
+                    'wall_time': r['wall_time'],
+                    'efficiency': ref['wall_time'] / r['wall_time'],
+                } for r in rows
+            ]
+    return tables
+
+
+def print_tables(strong, weak):
+    for key, table in strong.items():
+        print(f'\n  Strong scaling: {key}')
+        print(f'  {"threads":>8} {"time (s)":>12} {"speedup":>9} {"efficiency":>11}  worst phase')
+        for row in table:
+            worst = ''
+            if row['phase_speedup']:
+                phase, s = min(row['phase_speedup'].items(), key=lambda x: x[1])
+                worst = f'{phase} ({s:.2f}x)'
+            print(
+                f"  {row['threads']:8d} {row['wall_time']:12.2f} {row['speedup']:9.2f} {row['efficiency']:11.2f}"
+                f"  {worst}"
+            )
+    for key, table in weak.items():
+        print(f'\n  Weak scaling: {key}')
+        print(f'  {"size":>6} {"threads":>8} {"time (s)":>12} {"efficiency":>11}')
+        for row in table:
+            print(f"  {row['size']:6d} {row['threads']:8d} {row['wall_time']:12.2f} {row['efficiency']:11.2f}")
+
+
+def compare(results, baseline_file):
+    """Print the wall time of each calculation relative to a baseline"""
+    with open(baseline_file) as f:
+        baseline = json.load(f)['runs']
+
+    def key(r):
+        return (r['method'], r['size'], r['basis'], r['threads'])
+
+    base = {key(r): r for r in baseline if r['status'] == 'ok'}
+    print(f'\n  Comparison with {baseline_file} (ratio > 1 means slower than the baseline)')
+    for r in results:
+        if r['status'] == 'ok' and key(r) in base:
+            ratio = r['wall_time'] / base[key(r)]['wall_time']
+            print(f"  {r['method']:<12} n = {r['size']:<3} {r['basis']:<10} {r['threads']:4d} threads {ratio:8.3f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Strong- and weak-scaling study of Forte')
+    parser.add_argument('--psi4', default='psi4', help='the psi4 executable')
+    parser.add_argument('--methods', nargs='+', default=list(methods), choices=list(methods))
+    parser.add_argument('--threads', nargs='+', type=int, default=[1, 2, 4, 8, 16, 32, 64, 128])
+    parser.add_argument('--sizes', nargs='+', type=int, default=[8], help='active space sizes (H_n chain)')
+    parser.add_argument('--bases', nargs='+', default=['cc-pvdz'], help='orbital basis sets')
+    parser.add_argument('--weak', nargs='*', default=[], help='weak scaling pairs SIZE:THREADS')
+    parser.add_argument('--depth', type=int, default=2, help='depth of the profiler regions reported')
+    parser.add_argument('--memory', default='8 gb', help='memory given to psi4')
+    parser.add_argument('--workdir', default='scaling', help='directory where the calculations are run')
+    parser.add_argument('--output', default=None, help='JSON file with the results')
+    parser.add_argument('--baseline', default=None, help='JSON results of a previous study')
+    parser.add_argument('--reuse', action='store_true', help='reuse the output of previous runs')
+    parser.add_argument('--dry-run', action='store_true', help='only write the input files')
+    args = parser.parse_args()
+
+    pairs = [tuple(int(x) for x in p.split(':')) for p in args.weak]
+
+    calculations = set()
+    for method in args.methods:
+        for basis in args.bases:
+            for size in args.sizes:
+                for nthreads in args.threads:
+                    calculations.add((method, size, basis, nthreads))
+            for size, nthreads in pairs:
+                calculations.add((method, size, basis, nthreads))
+
+    print(f'\n  Running {len(calculations)} calculations in {args.workdir}\n')
+    results = []
+    for method, size, basis, nthreads in sorted(calculations):
+        r = run(args.psi4, args.workdir, method, size, basis, nthreads, args)
+        if r is not None:
+            results.append(r)
+    if args.dry_run:
+        return 0
+
+    strong = strong_scaling(results)
+    weak = weak_scaling(results, pairs)
+    print_tables(strong, weak)
+
+    if args.baseline:
+        compare(results, args.baseline)
+
+    now = datetime.datetime.now()
+    output = args.output or f'scaling-{now.strftime("%Y-%m-%d-%H:%M")}.json'
+    with open(output, 'w') as f:
+        json.dump(
+            {
+                'date': now.isoformat(),
+                'host': platform.node(),
+                'cpu_count': os.cpu_count(),
+                'runs': results,
+                'strong_scaling': strong,
+                'weak_scaling': weak,
+            },
+            f,
+            indent=2
+        )
+    print(f'\n  Results saved to {output}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -247,5 +247,47 @@ def test_sparse_ci3():
     assert wfn[det("+20-")] == pytest.approx(-1.0, abs=1e-9)
 
 
+
+def test_compiled_sparse_operator():
+    import forte
+    import pytest
+    from forte import det
+
+    # compare the compiled operator with apply_operator for an antihermitian operator
+    op = forte.SparseOperator(antihermitian=True)
+    op.add_term_from_str('[2a+ 0a-]', 0.1)
+    op.add_term_from_str('[3b+ 1b-]', -0.2)
+    op.add_term_from_str('[2a+ 3b+ 1b- 0a-]', 0.3)
+    op.add_term_from_str('[2a+ 3a+ 1a- 0a-]', 0.4)
+    op.add_term_from_str('[2a+ 2a-]', 0.5)
+    ref = forte.StateVector({det("2200"): 0.8, det("2020"): -0.6, det("+-20"): 0.1})
+    cop = forte.CompiledSparseOperator(op)
+    assert cop.size() == 10
+    wfn = forte.apply_operator(op, ref, 0.0)
+    wfn_compiled = cop.apply(ref, 0.0)
+    for d, c in wfn.items():
+        assert wfn_compiled[d] == pytest.approx(c, abs=1e-12)
+    for d, c in wfn_compiled.items():
+        assert wfn[d] == pytest.approx(c, abs=1e-12)
+
+    # update the coefficients
+    op.set_coefficients([0.5, 0.4, 0.3, 0.2, 0.1])
+    cop.update_coefficients(op)
+    wfn = forte.apply_operator(op, ref, 0.0)
+    wfn_compiled = cop.apply(ref, 0.0)
+    for d, c in wfn.items():
+        assert wfn_compiled[d] == pytest.approx(c, abs=1e-12)
+
+    # apply the operator to several states at once
+    refs = [ref, forte.StateVector({det("2200"): 1.0}), forte.StateVector({det("-+02"): 0.5})]
+    wfns = forte.apply_operator(op, refs, 0.0)
+    assert len(wfns) == 3
+    for ref_k, wfn_k in zip(refs, wfns):
+        wfn = forte.apply_operator(op, ref_k, 0.0)
+        for d, c in wfn.items():
+            assert wfn_k[d] == pytest.approx(c, abs=1e-12)
+
+
 if __name__ == "__main__":
     test_sparse_ci3()
+    test_compiled_sparse_operator()
@@ -38,5 +38,37 @@ def test_sparse_vector():
     assert proj4 == test_proj4
 
 
+def test_sorted_sparse_vector():
+    import pytest
+    import forte
+    from forte import det
+
+    ref = forte.StateVector({det(""): 1.0, det("+"): 1.0, det("-"): 1.0, det("2"): 1.0, det("02"): 1.0})
+    ref2 = forte.StateVector({det("02"): 0.3, det("002"): 0.5})
+    sref = forte.SortedStateVector(ref)
+    sref2 = forte.SortedStateVector(ref2)
+    assert len(sref) == 5
+    assert forte.dot(sref, sref) == pytest.approx(forte.overlap(ref, ref), abs=1e-9)
+    assert forte.dot(sref, sref2) == pytest.approx(0.3, abs=1e-9)
+    assert sref.coefficient(det("02")) == pytest.approx(1.0, abs=1e-9)
+    assert sref.coefficient(det("0002")) == pytest.approx(0.0, abs=1e-9)
+
+    # a * x + b * y is a merge of the two lists
+    s = forte.add(2.0, sref, -1.0, sref2)
+    assert len(s) == 6
+    assert s.coefficient(det("02")) == pytest.approx(1.7, abs=1e-9)
+    assert s.coefficient(det("002")) == pytest.approx(-0.5, abs=1e-9)
+    sref.axpy(-1.0, sref)
+    sref.prune(1.0e-12)
+    assert len(sref) == 0
+
+    # the coefficients are a view of the data
+    c = sref2.coefficients()
+    c[:] = 2.0 * c
+    assert sref2.norm() == pytest.approx(2.0 * (0.3**2 + 0.5**2)**0.5, abs=1e-9)
+    assert sref2.to_state_vector() == forte.StateVector({det("02"): 0.6, det("002"): 1.0})
+
+
 if __name__ == "__main__":
     test_sparse_vector()
+    test_sorted_sparse_vector()